@@ -79,6 +79,73 @@ func (db *reindexerImpl) modifyItem(ctx context.Context, namespace string, ns *r
 	return 0, err
 }
 
+// modifyItemsBatch modifies the items by the single binding call, if the binding supports it, or one by one otherwise
+func (db *reindexerImpl) modifyItemsBatch(ctx context.Context, namespace string, items []interface{}, mode int) (errs []error, err error) {
+	ns, err := db.getNS(namespace)
+	if err != nil {
+		return nil, err
+	}
+
+	errs = make([]error, len(items))
+	batchModifier, ok := db.binding.(bindings.RawBindingBatchModifier)
+	if !ok {
+		for i, item := range items {
+			_, errs[i] = db.modifyItem(ctx, namespace, ns, item, nil, mode)
+		}
+		return errs, nil
+	}
+
+	for tryCount := 0; tryCount < 2; tryCount++ {
+		sers := make([]*cjson.Serializer, len(items))
+		data := make([][]byte, len(items))
+		defer func() {
+			for _, ser := range sers {
+				if ser != nil {
+					ser.Close()
+				}
+			}
+		}()
+
+		format := 0
+		stateToken := 0
+		for i, item := range items {
+			sers[i] = cjson.NewPoolSerializer()
+			itemFormat, itemStateToken := 0, 0
+			if itemFormat, itemStateToken, err = packItem(ns, item, nil, sers[i]); err != nil {
+				return nil, err
+			}
+			if i == 0 {
+				format, stateToken = itemFormat, itemStateToken
+			} else if itemFormat != format {
+				return nil, ErrWrongType
+			}
+			data[i] = sers[i].Bytes()
+		}
+
+		var out bindings.RawBuffer
+		if out, err = batchModifier.ModifyItemsBatch(ctx, ns.nsHash, ns.name, format, data, mode, nil, stateToken); err != nil {
+			if rerr, ok := err.(bindings.Error); ok && rerr.Code() == bindings.ErrStateInvalidated {
+				db.query(ns.name).Limit(0).ExecCtx(ctx).Close()
+				continue
+			}
+			return nil, err
+		}
+
+		defer out.Free()
+
+		rdSer := cjson.NewSerializer(out.GetBuf())
+		for i := range items {
+			if code := int(rdSer.GetVarUInt()); code != 0 {
+				errs[i] = bindings.NewError("rq:"+rdSer.GetVString(), code)
+			} else if id := int(rdSer.GetVarInt()); id >= 0 {
+				ns.cacheItems.Remove(id)
+			}
+		}
+		return errs, nil
+	}
+	return nil, err
+}
+
 func packItem(ns *reindexerNamespace, item interface{}, json []byte, ser *cjson.Serializer) (format int, stateToken int, err error) {
 
 	if item != nil {
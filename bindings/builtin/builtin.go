@@ -274,6 +274,42 @@ func (binding *Builtin) ModifyItem(ctx context.Context, nsHash int, namespace st
 	return ret2go(C.reindexer_modify_item_packed(binding.rx, buf2c(packedArgs), buf2c(data), ctxInfo.cCtx))
 }
 
+func (binding *Builtin) ModifyItemsBatch(ctx context.Context, nsHash int, namespace string, format int, data [][]byte, mode int, precepts []string, stateToken int) (bindings.RawBuffer, error) {
+	if withLimiter, err := binding.awaitLimiter(ctx); err != nil {
+		return nil, err
+	} else if withLimiter {
+		defer func() { <-binding.cgoLimiter }()
+	}
+
+	ser1 := cjson.NewPoolSerializer()
+	defer ser1.Close()
+	ser1.PutVString(namespace)
+	ser1.PutVarCUInt(format)
+	ser1.PutVarCUInt(mode)
+	ser1.PutVarCUInt(stateToken)
+
+	ser1.PutVarCUInt(len(precepts))
+	for _, precept := range precepts {
+		ser1.PutVString(precept)
+	}
+	packedArgs := ser1.Bytes()
+
+	ser2 := cjson.NewPoolSerializer()
+	defer ser2.Close()
+	ser2.PutVarCUInt(len(data))
+	for _, item := range data {
+		ser2.PutVBytes(item)
+	}
+
+	ctxInfo, err := binding.StartWatchOnCtx(ctx)
+	if err != nil {
+		return nil, err
+	}
+	defer binding.ctxWatcher.StopWatchOnCtx(ctxInfo)
+
+	return ret2go(C.reindexer_modify_items_packed_batch(binding.rx, buf2c(packedArgs), buf2c(ser2.Bytes()), ctxInfo.cCtx))
+}
+
 func (binding *Builtin) ModifyItemTx(txCtx *bindings.TxCtx, format int, data []byte, mode int, precepts []string, stateToken int) error {
 	select {
 	case <-txCtx.UserCtx.Done():
@@ -190,6 +190,10 @@ func (server *BuiltinServer) ModifyItem(ctx context.Context, nsHash int, namespa
 	return server.builtin.ModifyItem(ctx, nsHash, namespace, format, data, mode, percepts, stateToken)
 }
 
+func (server *BuiltinServer) ModifyItemsBatch(ctx context.Context, nsHash int, namespace string, format int, data [][]byte, mode int, percepts []string, stateToken int) (bindings.RawBuffer, error) {
+	return server.builtin.ModifyItemsBatch(ctx, nsHash, namespace, format, data, mode, percepts, stateToken)
+}
+
 func (server *BuiltinServer) BeginTx(ctx context.Context, namespace string) (bindings.TxCtx, error) {
 	return server.builtin.BeginTx(ctx, namespace)
 }
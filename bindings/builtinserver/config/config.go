@@ -7,10 +7,25 @@ import (
 )
 
 type StorageConf struct {
-	Path            string `yaml:"path"`
-	Engine          string `yaml:"engine"`
-	StartWithErrors bool   `yaml:"startwitherrors"`
-	Autorepair      bool   `yaml:"autorepair"`
+	Path            string      `yaml:"path"`
+	Engine          string      `yaml:"engine"`
+	StartWithErrors bool        `yaml:"startwitherrors"`
+	Autorepair      bool        `yaml:"autorepair"`
+	RocksDB         RocksDBConf `yaml:"rocksdb,omitempty"`
+}
+
+// RocksDBConf - tuning of the RocksDB storages. Zero values mean defaults
+type RocksDBConf struct {
+	// Compaction style: 'level' (default) or 'universal'
+	CompactionStyle string `yaml:"compaction_style,omitempty"`
+	// Compression: 'none', 'snappy' (default), 'lz4' or 'zstd'
+	Compression string `yaml:"compression,omitempty"`
+	// Bits per key of the bloom filter. 0 - bloom filter is disabled
+	BloomFilterBits int `yaml:"bloom_filter_bits,omitempty"`
+	// Size of the block cache in bytes, which is shared by all of the storages. 0 - each storage has its own default cache
+	BlockCacheSize int64 `yaml:"block_cache_size,omitempty"`
+	// Size of the memtable of each storage in bytes. 0 - RocksDB default
+	WriteBufferSize int64 `yaml:"write_buffer_size,omitempty"`
 }
 
 type NetConf struct {
@@ -38,8 +53,9 @@ type DebugConf struct {
 }
 type MetricsConf struct {
 	Prometheus    bool  `yaml:"prometheus"`
-	CollectPeriod int64 `yaml:"collect_period"`
-	ClientsStats  bool  `yaml:"clientsstats"`
+	CollectPeriod  int64 `yaml:"collect_period"`
+	MemstatsPeriod int64 `yaml:"memstats_period"`
+	ClientsStats   bool  `yaml:"clientsstats"`
 }
 type ServerConfig struct {
 	Storage StorageConf `yaml:"storage"`
@@ -18,18 +18,21 @@ const (
 	EMPTY   = 9
 	LIKE    = 10
 	DWITHIN = 11
+	KNN     = 12
 
 	ERROR   = 1
 	WARNING = 2
 	INFO    = 3
 	TRACE   = 4
 
-	AggSum      = 0
-	AggAvg      = 1
-	AggFacet    = 2
-	AggMin      = 3
-	AggMax      = 4
-	AggDistinct = 5
+	AggSum                 = 0
+	AggAvg                 = 1
+	AggFacet               = 2
+	AggMin                 = 3
+	AggMax                 = 4
+	AggDistinct            = 5
+	AggApproxCountDistinct = 8
+	AggQuantile            = 9
 
 	CollateNone    = 0
 	CollateASCII   = 1
@@ -82,6 +85,9 @@ const (
 	QueryUpdateFieldV2          = 25
 	QueryBetweenFieldsCondition = 26
 	QueryAlwaysFalseCondition   = 27
+	QueryParallelScan           = 28
+	QueryWaitLSN                = 29
+	QueryBestEffort             = 30
 
 	LeftJoin    = 0
 	InnerJoin   = 1
@@ -107,17 +113,23 @@ const (
 	QueryResultEnd         = 0
 	QueryResultAggregation = 1
 	QueryResultExplain     = 2
+	QueryResultIncomplete  = 3
 
 	QueryStrictModeNotSet  = 0
 	QueryStrictModeNone    = 1
 	QueryStrictModeNames   = 2
 	QueryStrictModeIndexes = 3
 
+	QueryParallelScanNotSet = 0
+	QueryParallelScanOff    = 1
+	QueryParallelScanOn     = 2
+
 	ResultsFormatMask = 0xF
 	ResultsPure       = 0x0
 	ResultsPtrs       = 0x1
 	ResultsCJson      = 0x2
 	ResultsJson       = 0x3
+	ResultsItemViews  = 0x5
 
 	ResultsWithPayloadTypes   = 0x10
 	ResultsWithItemID         = 0x20
@@ -125,12 +137,18 @@ const (
 	ResultsWithNsID           = 0x80
 	ResultsWithJoined         = 0x100
 	ResultsSupportIdleTimeout = 0x2000
-
-	IndexOptPK         = 1 << 7
-	IndexOptArray      = 1 << 6
-	IndexOptDense      = 1 << 5
-	IndexOptAppendable = 1 << 4
-	IndexOptSparse     = 1 << 3
+	ResultsJoinedRefs         = 0x4000
+
+	IndexOptTrigram     = 1 << 9
+	IndexOptBloomFilter = 1 << 8
+	IndexOptPK          = 1 << 7
+	IndexOptArray       = 1 << 6
+	IndexOptDense       = 1 << 5
+	IndexOptAppendable  = 1 << 4
+	IndexOptSparse      = 1 << 3
+	IndexOptColumnar    = 1 << 2
+	IndexOptFlatHash    = 1 << 1
+	IndexOptLearned     = 1 << 0
 
 	StorageOptEnabled               = 1
 	StorageOptDropOnFileFormatError = 1 << 1
@@ -159,4 +177,5 @@ const (
 	ErrTimeout          = 19
 	ErrCanceled         = 20
 	ErrTagsMissmatch    = 21
+	ErrQuotaExceeded    = 27
 )
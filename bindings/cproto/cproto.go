@@ -322,7 +322,7 @@ func (binding *NetCProto) Select(ctx context.Context, query string, asJson bool,
 	if asJson {
 		flags |= bindings.ResultsJson
 	} else {
-		flags |= bindings.ResultsCJson | bindings.ResultsWithPayloadTypes | bindings.ResultsWithItemID
+		flags |= bindings.ResultsCJson | bindings.ResultsWithPayloadTypes | bindings.ResultsWithItemID | bindings.ResultsJoinedRefs
 	}
 	flags |= bindings.ResultsSupportIdleTimeout
 
@@ -345,7 +345,7 @@ func (binding *NetCProto) SelectQuery(ctx context.Context, data []byte, asJson b
 	if asJson {
 		flags |= bindings.ResultsJson
 	} else {
-		flags |= bindings.ResultsCJson | bindings.ResultsWithPayloadTypes | bindings.ResultsWithItemID
+		flags |= bindings.ResultsCJson | bindings.ResultsWithPayloadTypes | bindings.ResultsWithItemID | bindings.ResultsJoinedRefs
 	}
 	flags |= bindings.ResultsSupportIdleTimeout
 
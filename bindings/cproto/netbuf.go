@@ -25,7 +25,7 @@ func (buf *NetBuffer) Fetch(ctx context.Context, offset, limit int, asJson bool)
 	if asJson {
 		flags |= bindings.ResultsJson
 	} else {
-		flags |= bindings.ResultsCJson | bindings.ResultsWithItemID
+		flags |= bindings.ResultsCJson | bindings.ResultsWithItemID | bindings.ResultsJoinedRefs
 	}
 	flags |= bindings.ResultsSupportIdleTimeout
 	// fmt.Printf("cmdFetchResults(reqId=%d, offset=%d, limit=%d, json=%v, flags=%v)\n", buf.reqID, offset, limit, asJson, flags)
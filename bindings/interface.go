@@ -10,19 +10,24 @@ import (
 )
 
 type IndexDef struct {
-	Name        string      `json:"name"`
-	JSONPaths   []string    `json:"json_paths"`
-	IndexType   string      `json:"index_type"`
-	FieldType   string      `json:"field_type"`
-	IsPK        bool        `json:"is_pk"`
-	IsArray     bool        `json:"is_array"`
-	IsDense     bool        `json:"is_dense"`
-	IsSparse    bool        `json:"is_sparse"`
-	CollateMode string      `json:"collate_mode"`
-	SortOrder   string      `json:"sort_order_letters"`
-	ExpireAfter int         `json:"expire_after"`
-	Config      interface{} `json:"config"`
-	RTreeType   string      `json:"rtree_type"`
+	Name          string      `json:"name"`
+	JSONPaths     []string    `json:"json_paths"`
+	IndexType     string      `json:"index_type"`
+	FieldType     string      `json:"field_type"`
+	IsPK          bool        `json:"is_pk"`
+	IsArray       bool        `json:"is_array"`
+	IsDense       bool        `json:"is_dense"`
+	IsSparse      bool        `json:"is_sparse"`
+	IsColumnar    bool        `json:"is_columnar,omitempty"`
+	IsFlatHash    bool        `json:"is_flat_hash,omitempty"`
+	IsLearned     bool        `json:"is_learned,omitempty"`
+	IsBloomFilter bool        `json:"is_bloom_filter,omitempty"`
+	IsTrigram     bool        `json:"is_trigram,omitempty"`
+	CollateMode   string      `json:"collate_mode"`
+	SortOrder     string      `json:"sort_order_letters"`
+	ExpireAfter   int         `json:"expire_after"`
+	Config        interface{} `json:"config"`
+	RTreeType     string      `json:"rtree_type"`
 }
 
 type FieldDef struct {
@@ -206,6 +211,14 @@ type RawBindingChanging interface {
 	OnChangeCallback(f func())
 }
 
+// RawBindingBatchModifier is implemented by the bindings, which are able to modify the batch of items by the single call.
+// Items are packed with the same format and state token. Result buffer contains status of each item
+// (error code, followed by the error message or by the item's ID, which is -1 if the item was not modified)
+// and then query results with the modified items
+type RawBindingBatchModifier interface {
+	ModifyItemsBatch(ctx context.Context, nsHash int, namespace string, format int, data [][]byte, mode int, percepts []string, stateToken int) (RawBuffer, error)
+}
+
 var availableBindings = make(map[string]RawBinding)
 
 func RegisterBinding(name string, binding RawBinding) {
@@ -244,6 +244,21 @@ func (s *Serializer) GetVString() (v string) {
 	return v
 }
 
+// GetAlignedBytes - skips padding up to the address, aligned by align, and returns next sz bytes without copying
+func (s *Serializer) GetAlignedBytes(align int, sz int) (v []byte) {
+	if sz == 0 {
+		return nil
+	}
+	addr := uintptr(unsafe.Pointer(&s.buf[0])) + uintptr(s.pos)
+	s.pos += int((uintptr(align) - addr%uintptr(align)) % uintptr(align))
+	if s.pos+sz > len(s.buf) {
+		panic(fmt.Errorf("Internal error: serializer need %d bytes, but only %d available", sz, len(s.buf)-s.pos))
+	}
+	v = s.buf[s.pos : s.pos+sz]
+	s.pos += sz
+	return v
+}
+
 func (s *Serializer) Eof() bool {
 	return s.pos == len(s.buf)
 }
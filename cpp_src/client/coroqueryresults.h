@@ -58,6 +58,8 @@ public:
 	bool HaveRank() const { return queryParams_.flags & kResultsWithRank; }
 	bool NeedOutputRank() const { return queryParams_.flags & kResultsNeedOutputRank; }
 	const string& GetExplainResults() const { return queryParams_.explainResults; }
+	/// Deadline of the best-effort query was exceeded and only the part of the results is returned
+	bool IsIncomplete() const noexcept { return queryParams_.incomplete; }
 	const vector<AggregationResult>& GetAggregationResults() const { return queryParams_.aggResults; }
 	Error Status() { return status_; }
 	h_vector<std::string_view, 1> GetNamespaces() const;
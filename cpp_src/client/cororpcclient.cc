@@ -178,7 +178,8 @@ Error CoroRPCClient::subscribeImpl(bool subscribe) {
 		UpdatesFilters filter = observers_.GetMergedFilter();
 		WrSerializer ser;
 		filter.GetJSON(ser);
-		err = conn_.Call(mkCommand(cproto::kCmdSubscribeUpdates), 1, ser.Slice()).Status();
+		// Servers, which don't support batching, ignore this option and push the updates one by one
+		err = conn_.Call(mkCommand(cproto::kCmdSubscribeUpdates), 1, ser.Slice(), int(SubscriptionOpts().BatchedUpdates().options)).Status();
 		if (err.ok()) {
 			conn_.SetUpdatesHandler([this](const CoroRPCAnswer& ans) { onUpdates(ans); });
 			subscribed_ = true;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <mutex>
+
+namespace reindexer {
+namespace client {
+
+/// Keeps latencies of the recent requests to estimate their percentiles
+class LatencyTracker {
+public:
+	/// Count of the recent requests, which are taken into account
+	static constexpr size_t kWindowSize = 256;
+	/// Percentiles are not estimated until this count of the requests is collected
+	static constexpr size_t kMinSamples = 32;
+
+	void Add(std::chrono::microseconds latency) {
+		std::lock_guard<std::mutex> lck(mtx_);
+		samples_[next_] = latency.count();
+		next_ = (next_ + 1) % kWindowSize;
+		if (count_ < kWindowSize) ++count_;
+	}
+	/// Returns zero, if there are not enough samples yet
+	/// @param p - percentile in range (0, 1)
+	std::chrono::microseconds Percentile(double p) const {
+		std::array<int64_t, kWindowSize> samples;
+		size_t count;
+		{
+			std::lock_guard<std::mutex> lck(mtx_);
+			count = count_;
+			if (count < kMinSamples) return std::chrono::microseconds(0);
+			std::copy_n(samples_.begin(), count, samples.begin());
+		}
+		const size_t n = std::min(count - 1, size_t(p * count));
+		std::nth_element(samples.begin(), samples.begin() + n, samples.begin() + count);
+		return std::chrono::microseconds(samples[n]);
+	}
+
+private:
+	mutable std::mutex mtx_;
+	std::array<int64_t, kWindowSize> samples_;
+	size_t next_ = 0;
+	size_t count_ = 0;
+};
+
+}  // namespace client
+}  // namespace reindexer
@@ -49,6 +49,9 @@ Error Reindexer::PutMeta(std::string_view nsName, const string& key, std::string
 Error Reindexer::EnumMeta(std::string_view nsName, vector<string>& keys) { return impl_->EnumMeta(nsName, keys, ctx_); }
 Error Reindexer::Delete(const Query& q, QueryResults& result) { return impl_->Delete(q, result, ctx_); }
 Error Reindexer::Select(std::string_view query, QueryResults& result) { return impl_->Select(query, result, ctx_, nullptr); }
+Error Reindexer::Select(std::string_view query, const VariantArray& params, QueryResults& result) {
+	return impl_->Select(query, params, result, ctx_, nullptr);
+}
 Error Reindexer::Select(const Query& q, QueryResults& result) { return impl_->Select(q, result, ctx_, nullptr); }
 Error Reindexer::Commit(std::string_view nsName) { return impl_->Commit(nsName); }
 Error Reindexer::AddIndex(std::string_view nsName, const IndexDef& idx) { return impl_->AddIndex(nsName, idx, ctx_); }
@@ -65,6 +68,8 @@ Error Reindexer::GetSqlSuggestions(const std::string_view sqlQuery, int pos, vec
 	return impl_->GetSqlSuggestions(sqlQuery, pos, suggests);
 }
 Error Reindexer::Status() { return impl_->Status(); }
+ResultsCacheStat Reindexer::GetResultsCacheStat() { return impl_->GetResultsCacheStat(); }
+ReplicaRoutingStat Reindexer::GetReplicaRoutingStat() { return impl_->GetReplicaRoutingStat(); }
 
 Transaction Reindexer::NewTransaction(std::string_view nsName) { return impl_->NewTransaction(nsName, ctx_); }
 Error Reindexer::CommitTransaction(Transaction& tr) { return impl_->CommitTransaction(tr, ctx_); }
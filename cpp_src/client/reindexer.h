@@ -132,6 +132,12 @@ public:
 	/// @param query - SQL query. Only "SELECT" semantic is supported
 	/// @param result - QueryResults with found items
 	Error Select(std::string_view query, QueryResults &result);
+	/// Execute SQL Query with the '?' placeholders in WHERE clause. Server caches parsed query by its text
+	/// May be used with completion
+	/// @param query - SQL query, e.g. "SELECT * FROM items WHERE id = ?"
+	/// @param params - values of the placeholders in the order of their appearance in query
+	/// @param result - QueryResults with found items
+	Error Select(std::string_view query, const VariantArray &params, QueryResults &result);
 	/// Execute Query and return results
 	/// May be used with completion
 	/// @param query - Query object with query attributes
@@ -174,6 +180,10 @@ public:
 	Error GetSqlSuggestions(std::string_view sqlQuery, int pos, vector<string> &suggestions);
 	/// Get curret connection status
 	Error Status();
+	/// Get statistics of the client-side results cache (see ReindexerConfig::ResultsCacheSize)
+	ResultsCacheStat GetResultsCacheStat();
+	/// Get statistics of the routing of the reads to the replicas (see ReindexerConfig::ReplicaDSNs)
+	ReplicaRoutingStat GetReplicaRoutingStat();
 	/// Allocate new transaction for namespace
 	/// @param nsName - Name of namespace
 	Transaction NewTransaction(std::string_view nsName);
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <string>
+#include <vector>
 
 namespace reindexer {
 namespace client {
@@ -11,7 +12,7 @@ using std::chrono::seconds;
 struct ReindexerConfig {
 	ReindexerConfig(int _ConnPoolSize = 4, int _WorkerThreads = 1, int _FetchAmount = 10000, int _ReconnectAttempts = 0,
 					seconds _ConnectTimeout = seconds(0), seconds _RequestTimeout = seconds(0), bool _EnableCompression = false,
-					std::string _appName = "CPP-client", unsigned int _syncRxCoroCount = 10)
+					std::string _appName = "CPP-client", unsigned int _syncRxCoroCount = 10, bool _HedgedSelects = false)
 		: ConnPoolSize(_ConnPoolSize),
 		  WorkerThreads(_WorkerThreads),
 		  FetchAmount(_FetchAmount),
@@ -20,7 +21,8 @@ struct ReindexerConfig {
 		  RequestTimeout(_RequestTimeout),
 		  EnableCompression(_EnableCompression),
 		  AppName(std::move(_appName)),
-		  rxClientCoroCount(_syncRxCoroCount) {}
+		  rxClientCoroCount(_syncRxCoroCount),
+		  HedgedSelects(_HedgedSelects) {}
 
 	int ConnPoolSize;
 	int WorkerThreads;
@@ -31,6 +33,42 @@ struct ReindexerConfig {
 	bool EnableCompression;
 	std::string AppName;
 	unsigned int rxClientCoroCount;
+	/// Synchronous select, which is not answered within the 95th percentile of the recent selects latency, is duplicated
+	/// on another connection of the pool. First answer is used. Requires ConnPoolSize > 1
+	bool HedgedSelects;
+	/// Size limit of the client-side cache of the selects' results in bytes (0 - cache is disabled). Results of the synchronous selects
+	/// of ResultsCacheNamespaces are cached and invalidated by the updates, which are pushed by the server (see SubscribeUpdates),
+	/// so they may lag behind the server by the delivery time of the update
+	size_t ResultsCacheSize = 0;
+	std::vector<std::string> ResultsCacheNamespaces;
+	/// DSNs of the replicas (slaves) of the master, which the client is connected to. Synchronous selects by Query are routed to the
+	/// replica with the least latency, which has applied the client's own writes to the query's namespaces and lags behind the master
+	/// by no more than ReplicaMaxLag. Master serves the rest of the reads and all the writes
+	std::vector<std::string> ReplicaDSNs;
+	/// Max lag of the replica's namespace behind the master's one in the count of the WAL records (negative - unbounded)
+	int64_t ReplicaMaxLag = -1;
+	/// Period of the poll of the namespaces' LSNs from the master and the replicas
+	std::chrono::milliseconds ReplicaPollPeriod = std::chrono::milliseconds(1000);
+};
+
+struct ResultsCacheStat {
+	size_t totalSize = 0;
+	size_t itemsCount = 0;
+	size_t hitsCount = 0;
+	size_t missesCount = 0;
+	size_t invalidationsCount = 0;
+};
+
+struct ReplicaRoutingStat {
+	struct Replica {
+		std::string dsn;
+		size_t readsCount = 0;
+		int64_t avgLatencyUs = 0;
+		// Replica has answered the last poll of the LSNs
+		bool available = false;
+	};
+	size_t masterReadsCount = 0;
+	std::vector<Replica> replicas;
 };
 
 enum ConnectOpt {
@@ -0,0 +1,105 @@
+#include "client/replicarouter.h"
+#include <algorithm>
+
+namespace reindexer {
+namespace client {
+
+uint64_t ReplicaRouter::BeginPoll() noexcept {
+	std::lock_guard<std::mutex> lck(mtx_);
+	return ++pollSeq_;
+}
+
+void ReplicaRouter::SetLSNs(int idx, uint64_t pollSeq, LSNs &&lsns) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	Node &n = node(idx);
+	// Answers of the polls may be reordered
+	if (pollSeq < n.pollSeq) return;
+	n.pollSeq = pollSeq;
+	n.lsns = std::move(lsns);
+	n.valid = true;
+	if (idx != kMaster) return;
+	for (auto &w : writes_) {
+		if (w.second.lsn >= 0 || w.second.pollSeq >= pollSeq) continue;
+		// Poll was started after the write, so the master's LSN covers it
+		auto it = master_.lsns.find(w.first);
+		w.second.lsn = it == master_.lsns.end() ? 0 : it->second;
+	}
+}
+
+void ReplicaRouter::SetFailed(int idx) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	Node &n = node(idx);
+	n.lsns.clear();
+	n.valid = false;
+}
+
+void ReplicaRouter::OnWrite(std::string_view nsName, int64_t lsn) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	auto it = writes_.find(nsName);
+	if (it == writes_.end()) it = writes_.emplace(std::string(nsName), Write()).first;
+	Write &w = it->second;
+	if (lsn >= 0) {
+		// Unresolved previous write is covered by the later one
+		w.lsn = std::max(w.lsn, lsn);
+	} else {
+		w.lsn = -1;
+		w.pollSeq = pollSeq_;
+	}
+}
+
+int ReplicaRouter::Choose(const h_vector<std::string_view, 2> &nsNames) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	int best = kMaster;
+	for (size_t i = 0; i < replicas_.size(); ++i) {
+		const Node &replica = replicas_[i];
+		if (!replica.valid) continue;
+		bool ok = true;
+		for (auto nsName : nsNames) {
+			if (!fresh(replica, nsName)) {
+				ok = false;
+				break;
+			}
+		}
+		// Replica without the measured latency is tried first
+		if (ok && (best == kMaster || replica.latencyUs < replicas_[best].latencyUs)) best = int(i);
+	}
+	++node(best).readsCount;
+	return best;
+}
+
+void ReplicaRouter::AddLatency(int idx, std::chrono::microseconds latency) {
+	static constexpr double kWeight = 0.1;
+	std::lock_guard<std::mutex> lck(mtx_);
+	Node &n = node(idx);
+	n.latencyUs = n.latencyUs ? n.latencyUs * (1 - kWeight) + latency.count() * kWeight : latency.count();
+}
+
+ReplicaRoutingStat ReplicaRouter::GetStat() const {
+	std::lock_guard<std::mutex> lck(mtx_);
+	ReplicaRoutingStat stat;
+	stat.masterReadsCount = master_.readsCount;
+	stat.replicas.reserve(replicas_.size());
+	for (const auto &replica : replicas_) {
+		ReplicaRoutingStat::Replica r;
+		r.readsCount = replica.readsCount;
+		r.avgLatencyUs = int64_t(replica.latencyUs);
+		r.available = replica.valid;
+		stat.replicas.emplace_back(std::move(r));
+	}
+	return stat;
+}
+
+bool ReplicaRouter::fresh(const Node &replica, std::string_view nsName) const {
+	auto it = replica.lsns.find(nsName);
+	if (it == replica.lsns.end()) return false;
+	const int64_t lsn = it->second;
+	auto wit = writes_.find(nsName);
+	if (wit != writes_.end() && (wit->second.lsn < 0 || lsn < wit->second.lsn)) return false;
+	if (maxLag_ < 0) return true;
+	if (!master_.valid) return false;
+	auto mit = master_.lsns.find(nsName);
+	return mit != master_.lsns.end() && mit->second - lsn <= maxLag_;
+}
+
+}  // namespace client
+}  // namespace reindexer
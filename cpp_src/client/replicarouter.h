@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "client/reindexerconfig.h"
+#include "estl/fast_hash_map.h"
+#include "estl/h_vector.h"
+#include "tools/stringstools.h"
+
+namespace reindexer {
+namespace client {
+
+/// Routes the reads between the master and its replicas by the LSNs of the namespaces. LSNs are polled periodically, so the known LSN of
+/// the replica is its lower bound and its lag behind the master is measured at the moments of the polls. Replica is chosen for the read
+/// only if it has applied the client's own writes to the namespaces of the query (read-your-writes) and its lag is within the bound
+class ReplicaRouter {
+public:
+	/// Index of the master in the calls below
+	static constexpr int kMaster = -1;
+	/// LSN counters of the namespaces. Namespace without the records has the counter -1
+	using LSNs = fast_hash_map<std::string, int64_t, nocase_hash_str, nocase_equal_str>;
+
+	/// @param replicasCount - Count of the replicas
+	/// @param maxLag - Max lag of the replica's namespace behind the master's one in the LSN counter units (negative - unbounded)
+	ReplicaRouter(size_t replicasCount, int64_t maxLag) : replicas_(replicasCount), maxLag_(maxLag) {}
+
+	/// Starts the poll of the LSNs
+	/// @return sequence number of the poll, which is passed to SetLSNs with its answer
+	uint64_t BeginPoll() noexcept;
+	/// Sets the polled LSNs of the master or the replica
+	void SetLSNs(int idx, uint64_t pollSeq, LSNs &&lsns);
+	/// Resets the LSNs of the failed replica, so it's not chosen until it answers the poll again
+	void SetFailed(int idx);
+	/// Records the client's own write, which must be visible to its following reads
+	/// @param lsn - LSN counter of the write or negative, if it's unknown. Unknown LSN is resolved by the next poll of the master
+	void OnWrite(std::string_view nsName, int64_t lsn);
+	/// Chooses the replica with the least latency among the ones, which are fresh enough for all the namespaces
+	/// @return index of the replica or kMaster
+	int Choose(const h_vector<std::string_view, 2> &nsNames);
+	void AddLatency(int idx, std::chrono::microseconds latency);
+	/// DSNs of the replicas are not known here and are left empty
+	ReplicaRoutingStat GetStat() const;
+
+private:
+	struct Node {
+		LSNs lsns;
+		bool valid = false;
+		uint64_t pollSeq = 0;
+		// Exponential moving average of the reads' latency
+		double latencyUs = 0;
+		size_t readsCount = 0;
+	};
+	struct Write {
+		// Negative - the write is not resolved by the poll of the master yet
+		int64_t lsn = -1;
+		// Sequence number of the last poll, which was started before the write
+		uint64_t pollSeq = 0;
+	};
+
+	Node &node(int idx) { return idx == kMaster ? master_ : replicas_[idx]; }
+	bool fresh(const Node &replica, std::string_view nsName) const;
+
+	mutable std::mutex mtx_;
+	Node master_;
+	std::vector<Node> replicas_;
+	fast_hash_map<std::string, Write, nocase_hash_str, nocase_equal_str> writes_;
+	uint64_t pollSeq_ = 0;
+	const int64_t maxLag_;
+};
+
+}  // namespace client
+}  // namespace reindexer
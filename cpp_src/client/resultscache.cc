@@ -0,0 +1,58 @@
+#include "client/resultscache.h"
+
+namespace reindexer {
+namespace client {
+
+ResultsCache::ResultsCache(size_t sizeLimit, const std::vector<std::string> &namespaces)
+	: cache_(sizeLimit, 1), versions_(namespaces.size()) {
+	for (auto &nsName : namespaces) nsIdx_.emplace(nsName, nsIdx_.size());
+}
+
+UpdatesFilters ResultsCache::Filters() const {
+	UpdatesFilters filters;
+	for (auto &ns : nsIdx_) filters.AddFilter(ns.first, UpdatesFilters::Filter());
+	return filters;
+}
+
+std::shared_ptr<const std::string> ResultsCache::Get(const std::string &query, const Versions &versions) {
+	auto res = cache_.Get(ResultsCacheKey{query});
+	if (res.valid && res.val.raw && res.val.versions == versions) {
+		hits_.fetch_add(1, std::memory_order_relaxed);
+		return std::move(res.val.raw);
+	}
+	misses_.fetch_add(1, std::memory_order_relaxed);
+	return nullptr;
+}
+
+void ResultsCache::Invalidate(std::string_view nsName) {
+	auto it = nsIdx_.find(nsName);
+	if (it == nsIdx_.end()) return;
+	// Stale entries are not erased here: they are never hit again and are evicted by the LRU
+	versions_[it->second].fetch_add(1, std::memory_order_acq_rel);
+	invalidations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ResultsCache::OnConnectionState(const Error &err) {
+	// Updates may be lost while the subscription is broken, so nothing cached before is trusted after it
+	active_.store(err.ok(), std::memory_order_release);
+	invalidateAll();
+}
+
+ResultsCacheStat ResultsCache::GetStat() {
+	auto memStat = cache_.GetMemStat();
+	ResultsCacheStat stat;
+	stat.totalSize = memStat.totalSize;
+	stat.itemsCount = memStat.itemsCount;
+	stat.hitsCount = hits_.load(std::memory_order_relaxed);
+	stat.missesCount = misses_.load(std::memory_order_relaxed);
+	stat.invalidationsCount = invalidations_.load(std::memory_order_relaxed);
+	return stat;
+}
+
+void ResultsCache::invalidateAll() {
+	for (auto &v : versions_) v.fetch_add(1, std::memory_order_acq_rel);
+	invalidations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace client
+}  // namespace reindexer
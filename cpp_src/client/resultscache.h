@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "client/reindexerconfig.h"
+#include "core/lrucache.h"
+#include "estl/fast_hash_map.h"
+#include "estl/h_vector.h"
+#include "replicator/updatesobserver.h"
+
+namespace reindexer {
+namespace client {
+
+struct ResultsCacheKey {
+	size_t Size() const noexcept { return query.size(); }
+
+	// Serialized query with the fetch flags
+	std::string query;
+};
+
+struct ResultsCacheVal {
+	size_t Size() const noexcept { return raw ? raw->capacity() + versions.size() * sizeof(uint64_t) : 0; }
+
+	// Raw answer of the server, which contains all the results of the query
+	std::shared_ptr<const std::string> raw;
+	// Versions of the query's namespaces at the moment of the request
+	h_vector<uint64_t, 2> versions;
+};
+
+struct HashResultsCacheKey {
+	size_t operator()(const ResultsCacheKey &k) const noexcept { return std::hash<std::string>()(k.query); }
+};
+
+struct EqResultsCacheKey {
+	bool operator()(const ResultsCacheKey &lhs, const ResultsCacheKey &rhs) const noexcept { return lhs.query == rhs.query; }
+};
+
+/// Client-side cache of the selects' results. Every cached namespace has the version, which is bumped by the updates pushed by the
+/// server and by the client's own modifications. Entry is valid only while the versions of all its namespaces are unchanged.
+/// Cache is used only while the updates subscription is alive, because the updates may be missed without it
+class ResultsCache : public IUpdatesObserver {
+public:
+	using Versions = h_vector<uint64_t, 2>;
+
+	ResultsCache(size_t sizeLimit, const std::vector<std::string> &namespaces);
+
+	/// Filters of the updates subscription, which covers the cached namespaces
+	UpdatesFilters Filters() const;
+	/// Gets the current versions of the namespaces
+	/// @return false, if any of the namespaces is not cached or the cache is inactive
+	template <typename NsNames>
+	bool Snapshot(const NsNames &nsNames, Versions &versions) const {
+		if (!active_.load(std::memory_order_acquire)) return false;
+		versions.clear();
+		for (const auto &nsName : nsNames) {
+			auto it = nsIdx_.find(nsName);
+			if (it == nsIdx_.end()) return false;
+			versions.push_back(versions_[it->second].load(std::memory_order_acquire));
+		}
+		return true;
+	}
+	/// Returns the raw answer, if it's cached with the same versions of the namespaces
+	std::shared_ptr<const std::string> Get(const std::string &query, const Versions &versions);
+	/// Puts the raw answer, if the namespaces are not changed since the snapshot
+	template <typename NsNames>
+	void Put(std::string query, std::string_view raw, const NsNames &nsNames, const Versions &versions) {
+		Versions cur;
+		if (!Snapshot(nsNames, cur) || cur != versions) return;
+		cache_.Put(ResultsCacheKey{std::move(query)}, ResultsCacheVal{std::make_shared<const std::string>(raw), versions});
+	}
+	void Invalidate(std::string_view nsName);
+	ResultsCacheStat GetStat();
+
+	void OnWALUpdate(LSNPair, std::string_view nsName, const WALRecord &) override { Invalidate(nsName); }
+	void OnUpdatesLost(std::string_view nsName) override { Invalidate(nsName); }
+	void OnConnectionState(const Error &err) override;
+
+private:
+	void invalidateAll();
+
+	LRUCache<ResultsCacheKey, ResultsCacheVal, HashResultsCacheKey, EqResultsCacheKey> cache_;
+	fast_hash_map<std::string, size_t, nocase_hash_str, nocase_equal_str> nsIdx_;
+	std::vector<std::atomic<uint64_t>> versions_;
+	std::atomic<bool> active_ = {false};
+	std::atomic<size_t> hits_ = {0}, misses_ = {0}, invalidations_ = {0};
+};
+
+}  // namespace client
+}  // namespace reindexer
@@ -41,6 +41,9 @@ void ResultSerializer::GetRawQueryParams(ResultSerializer::QueryParams& ret, std
 			case QueryResultExplain:
 				ret.explainResults = string(data);
 				break;
+			case QueryResultIncomplete:
+				ret.incomplete = true;
+				break;
 		}
 	}
 }
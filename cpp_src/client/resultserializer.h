@@ -28,6 +28,7 @@ public:
 		int flags = 0;
 		std::vector<AggregationResult> aggResults;
 		string explainResults;
+		bool incomplete = false;
 	};
 
 	void GetRawQueryParams(QueryParams &ret, std::function<void(int nsId)> updatePayloadFunc);
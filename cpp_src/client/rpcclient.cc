@@ -1,7 +1,10 @@
 #include "client/rpcclient.h"
 #include <stdio.h>
+#include <condition_variable>
 #include <functional>
+#include <limits>
 #include "client/itemimpl.h"
+#include "core/lsn.h"
 #include "core/namespacedef.h"
 #include "gason/gason.h"
 #include "tools/errors.h"
@@ -15,22 +18,40 @@ namespace reindexer {
 namespace client {
 
 using reindexer::net::cproto::RPCAnswer;
+using namespace std::string_view_literals;
+
+// LSN counter of the raw LSN or -1 for the empty one
+static int64_t lsnCounter(int64_t rawLsn) {
+	const lsn_t lsn(rawLsn);
+	return lsn.isEmpty() ? -1 : lsn.Counter();
+}
 
 RPCClient::RPCClient(const ReindexerConfig& config) : workers_(config.WorkerThreads), config_(config), updatesConn_(nullptr) {
 	if (config_.ConnectTimeout > config_.RequestTimeout) {
 		config_.RequestTimeout = config_.ConnectTimeout;
 	}
 	curConnIdx_ = 0;
+	if (config_.ResultsCacheSize && !config_.ResultsCacheNamespaces.empty()) {
+		resultsCache_ = std::make_unique<ResultsCache>(config_.ResultsCacheSize, config_.ResultsCacheNamespaces);
+	}
 }
 
 RPCClient::~RPCClient() { Stop(); }
 
 Error RPCClient::startWorkers() {
+	Error err = addReplicas();
+	if (!err.ok()) return err;
 	connections_.resize(config_.ConnPoolSize);
 	for (size_t i = 0; i < workers_.size(); i++) {
 		workers_[i].thread_ = std::thread([this](size_t id) { this->run(id); }, i);
 		while (!workers_[i].running) std::this_thread::sleep_for(std::chrono::milliseconds(10));
 	}
+	if (resultsCache_) {
+		// Failed subscription is retried by checkSubscribes, which activates the cache on success
+		if (SubscribeUpdates(resultsCache_.get(), resultsCache_->Filters()).ok()) {
+			resultsCache_->OnConnectionState(errOK);
+		}
+	}
 	return errOK;
 }
 
@@ -49,6 +70,29 @@ Error RPCClient::addConnectEntry(const string& dsn, const client::ConnectOpts& o
 	return errOK;
 }
 
+Error RPCClient::addReplicas() {
+	replicas_.clear();
+	replicaRouter_.reset();
+	if (config_.ReplicaDSNs.empty()) return errOK;
+	for (auto& dsn : config_.ReplicaDSNs) {
+		auto replica = std::make_unique<Replica>();
+		replica->dsn = dsn;
+		replica->connectData.entries = std::vector<cproto::ClientConnection::ConnectData::Entry>(1);
+		auto& connectEntry = replica->connectData.entries[0];
+		if (!connectEntry.uri.parse(dsn)) {
+			return Error(errParams, "%s is not valid uri", dsn);
+		}
+		if (connectEntry.uri.scheme() != "cproto") {
+			return Error(errParams, "Scheme must be cproto");
+		}
+		connectEntry.opts = cproto::ClientConnection::Options(config_.ConnectTimeout, config_.RequestTimeout, false, false, -1,
+															  config_.ReconnectAttempts, config_.EnableCompression, config_.AppName);
+		replicas_.emplace_back(std::move(replica));
+	}
+	replicaRouter_ = std::make_unique<ReplicaRouter>(replicas_.size(), config_.ReplicaMaxLag);
+	return errOK;
+}
+
 Error RPCClient::Connect(const string& dsn, const client::ConnectOpts& opts) {
 	if (connections_.size()) {
 		return Error(errLogic, "Client is already started");
@@ -85,6 +129,7 @@ Error RPCClient::Stop() {
 		}
 	}
 	connections_.clear();
+	if (resultsCache_) resultsCache_->OnConnectionState(Error(errNetwork, "Client is stopped"));
 	return errOK;
 }
 
@@ -106,10 +151,20 @@ void RPCClient::run(size_t thIdx) {
 	}
 
 	ev::periodic checker;
+	ev::periodic replicasPoller;
 	if (thIdx == 0) {
 		checker.set(workers_[thIdx].loop_);
 		checker.set([this](ev::periodic&, int) { checkSubscribes(); });
 		checker.start(5, 5);
+		if (replicaRouter_) {
+			for (auto& replica : replicas_) {
+				replica->conn.reset(new cproto::ClientConnection(workers_[thIdx].loop_, &replica->connectData));
+			}
+			const double period = std::chrono::duration<double>(config_.ReplicaPollPeriod).count();
+			replicasPoller.set(workers_[thIdx].loop_);
+			replicasPoller.set([this](ev::periodic&, int) { pollReplicas(); });
+			replicasPoller.start(0, period);
+		}
 	}
 
 	workers_[thIdx].running.store(true);
@@ -124,12 +179,22 @@ void RPCClient::run(size_t thIdx) {
 					doTerminate = false;
 				}
 			}
+			if (thIdx == 0) {
+				replicasPoller.stop();
+				for (auto& replica : replicas_) {
+					replica->conn->SetTerminateFlag();
+					if (replica->conn->PendingCompletions()) doTerminate = false;
+				}
+			}
 		}
 		if (doTerminate) break;
 	}
 	for (size_t i = thIdx; int(i) < config_.ConnPoolSize; i += config_.WorkerThreads) {
 		connections_[i].reset();
 	}
+	if (thIdx == 0) {
+		for (auto& replica : replicas_) replica->conn.reset();
+	}
 	workers_[thIdx].running.store(false);
 }
 
@@ -156,15 +221,21 @@ Error RPCClient::CloseNamespace(std::string_view nsName, const InternalRdxContex
 }
 
 Error RPCClient::DropNamespace(std::string_view nsName, const InternalRdxContext& ctx) {
-	return getConn()->Call(mkCommand(cproto::kCmdDropNamespace, &ctx), nsName).Status();
+	auto status = getConn()->Call(mkCommand(cproto::kCmdDropNamespace, &ctx), nsName).Status();
+	invalidateResults(nsName);
+	return status;
 }
 
 Error RPCClient::TruncateNamespace(std::string_view nsName, const InternalRdxContext& ctx) {
-	return getConn()->Call(mkCommand(cproto::kCmdTruncateNamespace, &ctx), nsName).Status();
+	auto status = getConn()->Call(mkCommand(cproto::kCmdTruncateNamespace, &ctx), nsName).Status();
+	invalidateResults(nsName);
+	return status;
 }
 
 Error RPCClient::RenameNamespace(std::string_view srcNsName, const std::string& dstNsName, const InternalRdxContext& ctx) {
 	auto status = getConn()->Call(mkCommand(cproto::kCmdRenameNamespace, &ctx), srcNsName, dstNsName).Status();
+	invalidateResults(srcNsName);
+	invalidateResults(dstNsName);
 
 	if (!status.ok()) return status;
 
@@ -222,6 +293,7 @@ Error RPCClient::modifyItem(std::string_view nsName, Item& item, int mode, secon
 		auto netDeadline = conn->Now() + netTimeout;
 		auto ret = conn->Call(mkCommand(cproto::kCmdModifyItem, netTimeout, &ctx), nsName, int(FormatCJson), item.GetCJSON(), mode,
 							  ser.Slice(), item.GetStateToken(), 0);
+		invalidateResults(nsName);
 		if (!ret.Status().ok()) {
 			if (ret.Status().code() != errStateInvalidated || tryCount > 2) return ret.Status();
 			if (withNetTimeout) {
@@ -247,9 +319,11 @@ Error RPCClient::modifyItem(std::string_view nsName, Item& item, int mode, secon
 		try {
 			auto args = ret.GetArgs(2);
 			NsArray nsArray{getNamespace(nsName)};
-			return QueryResults(conn, std::move(nsArray), nullptr, p_string(args[0]), int(args[1]), 0, config_.FetchAmount,
-								config_.RequestTimeout)
-				.Status();
+			QueryResults qr(conn, std::move(nsArray), nullptr, p_string(args[0]), int(args[1]), 0, config_.FetchAmount,
+							config_.RequestTimeout);
+			// LSN of the modified item is the read-your-writes token for the replicas
+			if (replicaRouter_ && qr.Status().ok() && qr.Count()) replicaRouter_->OnWrite(nsName, lsnCounter(qr.begin().GetLSN()));
+			return qr.Status();
 		} catch (const Error& err) {
 			return err;
 		}
@@ -271,6 +345,7 @@ Error RPCClient::modifyItemAsync(std::string_view nsName, Item* item, int mode,
 	auto deadline = netTimeout.count() ? conn->Now() + netTimeout : seconds(0);
 	conn->Call(
 		[this, ns, mode, item, deadline, ctx](const net::cproto::RPCAnswer& ret, cproto::ClientConnection* conn) -> void {
+			invalidateResults(ns);
 			if (!ret.Status().ok()) {
 				if (ret.Status().code() != errStateInvalidated) return ctx.cmpl()(ret.Status());
 				seconds netTimeout(0);
@@ -319,11 +394,13 @@ Error RPCClient::subscribeImpl(bool subscribe) {
 		UpdatesFilters filter = observers_.GetMergedFilter();
 		WrSerializer ser;
 		filter.GetJSON(ser);
+		// Servers, which don't support batching, ignore this option and push the updates one by one
+		const int opts = SubscriptionOpts().BatchedUpdates().options;
 		if (updatesConn) {
-			err = updatesConn->Call(mkCommand(cproto::kCmdSubscribeUpdates), 1, ser.Slice()).Status();
+			err = updatesConn->Call(mkCommand(cproto::kCmdSubscribeUpdates), 1, ser.Slice(), opts).Status();
 		} else {
 			auto conn = getConn();
-			err = conn->Call(mkCommand(cproto::kCmdSubscribeUpdates), 1, ser.Slice()).Status();
+			err = conn->Call(mkCommand(cproto::kCmdSubscribeUpdates), 1, ser.Slice(), opts).Status();
 			if (err.ok()) {
 				updatesConn_ = conn;
 			}
@@ -401,6 +478,7 @@ Error RPCClient::Delete(const Query& query, QueryResults& result, const Internal
 	};
 
 	auto ret = conn->Call(mkCommand(cproto::kCmdDeleteQuery, &ctx), ser.Slice(), kResultsWithItemID);
+	invalidateResults(query._namespace);
 	icompl(ret, conn);
 	return ret.Status();
 }
@@ -429,18 +507,25 @@ Error RPCClient::Update(const Query& query, QueryResults& result, const Internal
 
 	auto ret =
 		conn->Call(mkCommand(cproto::kCmdUpdateQuery, &ctx), ser.Slice(), kResultsWithItemID | kResultsWithPayloadTypes | kResultsCJson);
+	invalidateResults(query._namespace);
 	icompl(ret, conn);
 	return ret.Status();
 }
 
-Error RPCClient::selectImpl(std::string_view query, QueryResults& result, cproto::ClientConnection* conn, seconds netTimeout,
-							const InternalRdxContext& ctx) {
+Error RPCClient::selectImpl(std::string_view query, const VariantArray& params, QueryResults& result, cproto::ClientConnection* conn,
+							seconds netTimeout, const InternalRdxContext& ctx) {
 	int flags = result.fetchFlags_ ? (result.fetchFlags_ & ~kResultsFormatMask) | kResultsJson : kResultsJson;
 
-	WrSerializer pser;
+	WrSerializer pser, paramsSer;
 	h_vector<int32_t, 4> vers;
 	vec2pack(vers, pser);
+	// Empty pack means the query without placeholders
+	if (!params.empty()) {
+		paramsSer.PutVarUint(params.size());
+		for (const auto& p : params) paramsSer.PutVariant(p);
+	}
 
+	const bool hedged = config_.HedgedSelects && !conn && !ctx.cmpl();
 	if (!conn) conn = getConn();
 
 	result = QueryResults(conn, {}, ctx.cmpl(), result.fetchFlags_, config_.FetchAmount, config_.RequestTimeout);
@@ -459,11 +544,17 @@ Error RPCClient::selectImpl(std::string_view query, QueryResults& result, cproto
 	};
 
 	if (!ctx.cmpl()) {
-		auto ret = conn->Call(mkCommand(cproto::kCmdSelectSQL, netTimeout, &ctx), query, flags, config_.FetchAmount, pser.Slice());
+		auto ret = hedged ? hedgedCall(conn, mkCommand(cproto::kCmdSelectSQL, netTimeout, &ctx), query, flags, config_.FetchAmount,
+									   pser.Slice(), paramsSer.Slice())
+						  : conn->Call(mkCommand(cproto::kCmdSelectSQL, netTimeout, &ctx), query, flags, config_.FetchAmount, pser.Slice(),
+									   paramsSer.Slice());
+		// Results are fetched from the connection, which has answered
+		result.conn_ = conn;
 		icompl(ret, conn);
 		return ret.Status();
 	} else {
-		conn->Call(icompl, mkCommand(cproto::kCmdSelectSQL, netTimeout, &ctx), query, flags, config_.FetchAmount, pser.Slice());
+		conn->Call(icompl, mkCommand(cproto::kCmdSelectSQL, netTimeout, &ctx), query, flags, config_.FetchAmount, pser.Slice(),
+				   paramsSer.Slice());
 		return errOK;
 	}
 }
@@ -495,6 +586,35 @@ Error RPCClient::selectImpl(const Query& query, QueryResults& result, cproto::Cl
 	}
 	vec2pack(vers, pser);
 
+	// Only the synchronous selects of the cached namespaces are cached
+	std::string cacheKey;
+	ResultsCache::Versions cacheVersions;
+	h_vector<std::string_view, 2> nsNames;
+	if (resultsCache_ && !conn && !ctx.cmpl()) {
+		for (auto ns : nsArray) nsNames.push_back(ns->name_);
+		if (resultsCache_->Snapshot(nsNames, cacheVersions)) {
+			cacheKey.reserve(qser.Len() + sizeof(flags));
+			cacheKey.append(qser.Slice()).append(reinterpret_cast<const char*>(&flags), sizeof(flags));
+			if (auto raw = resultsCache_->Get(cacheKey, cacheVersions)) {
+				result = QueryResults(getConn(), std::move(nsArray), nullptr, *raw, -1, result.fetchFlags_, config_.FetchAmount,
+									  config_.RequestTimeout);
+				return result.Status();
+			}
+		}
+	}
+
+	int replicaIdx = ReplicaRouter::kMaster;
+	if (replicaRouter_ && !conn && !ctx.cmpl()) {
+		h_vector<std::string_view, 2> routedNs;
+		for (auto ns : nsArray) routedNs.push_back(ns->name_);
+		// System namespaces of the replica describe the replica itself
+		if (std::none_of(routedNs.begin(), routedNs.end(), [](std::string_view ns) { return !ns.empty() && ns[0] == '#'; })) {
+			replicaIdx = replicaRouter_->Choose(routedNs);
+			if (replicaIdx != ReplicaRouter::kMaster) conn = replicas_[replicaIdx]->conn.get();
+		}
+	}
+
+	const bool hedged = config_.HedgedSelects && !conn && !ctx.cmpl();
 	if (!conn) conn = getConn();
 
 	result = QueryResults(conn, std::move(nsArray), ctx.cmpl(), result.fetchFlags_, config_.FetchAmount, config_.RequestTimeout);
@@ -512,8 +632,27 @@ Error RPCClient::selectImpl(const Query& query, QueryResults& result, cproto::Cl
 	};
 
 	if (!ctx.cmpl()) {
-		auto ret = conn->Call(mkCommand(cproto::kCmdSelect, netTimeout, &ctx), qser.Slice(), flags, config_.FetchAmount, pser.Slice());
+		const auto start = std::chrono::steady_clock::now();
+		auto ret = hedged ? hedgedCall(conn, mkCommand(cproto::kCmdSelect, netTimeout, &ctx), qser.Slice(), flags, config_.FetchAmount,
+									   pser.Slice())
+						  : conn->Call(mkCommand(cproto::kCmdSelect, netTimeout, &ctx), qser.Slice(), flags, config_.FetchAmount, pser.Slice());
+		if (replicaRouter_) {
+			if (replicaIdx != ReplicaRouter::kMaster && ret.Status().code() == errNetwork) {
+				// Unavailable replica is not chosen until it answers the poll again, so the retry goes to another node
+				replicaRouter_->SetFailed(replicaIdx);
+				return selectImpl(query, result, nullptr, netTimeout, ctx);
+			}
+			replicaRouter_->AddLatency(replicaIdx,
+									   std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+		}
+		result.conn_ = conn;
 		icompl(ret, conn);
+		// Results, which are not fetched completely by the first answer, are not cached. Results of the replica may be older than
+		// the versions of the cache
+		if (!cacheKey.empty() && replicaIdx == ReplicaRouter::kMaster && ret.Status().ok() && result.status_.ok() && result.queryID_ < 0 &&
+			!result.IsIncomplete()) {
+			resultsCache_->Put(std::move(cacheKey), p_string(ret.GetArgs(2)[0]), nsNames, cacheVersions);
+		}
 		return ret.Status();
 	} else {
 		conn->Call(icompl, mkCommand(cproto::kCmdSelect, netTimeout, &ctx), qser.Slice(), flags, config_.FetchAmount, pser.Slice());
@@ -617,6 +756,9 @@ void RPCClient::checkSubscribes() {
 
 	auto updatesConn = updatesConn_.load();
 	if (subscribe && !updatesConn_) {
+		// Empty filters JSON is required to pass the subscription options
+		WrSerializer ser;
+		UpdatesFilters().GetJSON(ser);
 		getConn()->Call(
 			[this](const RPCAnswer& ans, cproto::ClientConnection* conn) {
 				if (ans.Status().ok()) {
@@ -625,13 +767,69 @@ void RPCClient::checkSubscribes() {
 					conn->SetUpdatesHandler([this](RPCAnswer&& ans, cproto::ClientConnection* conn) { onUpdates(ans, conn); });
 				}
 			},
-			mkCommand(cproto::kCmdSubscribeUpdates), 1);
+			mkCommand(cproto::kCmdSubscribeUpdates), 1, ser.Slice(), int(SubscriptionOpts().BatchedUpdates().options));
 	} else if (!subscribe && updatesConn) {
 		updatesConn->Call([](const RPCAnswer&, cproto::ClientConnection*) {}, mkCommand(cproto::kCmdSubscribeUpdates), 0);
 		updatesConn_ = nullptr;
 	}
 }
 
+void RPCClient::pollReplicas() {
+	const uint64_t pollSeq = replicaRouter_->BeginPoll();
+	pollLSNs(getConn(), ReplicaRouter::kMaster, pollSeq);
+	for (size_t i = 0; i < replicas_.size(); ++i) pollLSNs(replicas_[i]->conn.get(), int(i), pollSeq);
+}
+
+void RPCClient::pollLSNs(cproto::ClientConnection* conn, int replicaIdx, uint64_t pollSeq) {
+	WrSerializer pser;
+	vec2pack({}, pser);
+	// Replica applies the master's records with their LSNs, which are reported as the upstream ones
+	const std::string_view lsnField = replicaIdx == ReplicaRouter::kMaster ? "last_lsn"sv : "last_upstream_lsn"sv;
+	conn->Call(
+		[this, replicaIdx, pollSeq, lsnField](const RPCAnswer& ret, cproto::ClientConnection* conn) {
+			ReplicaRouter::LSNs lsns;
+			try {
+				if (!ret.Status().ok()) throw ret.Status();
+				auto args = ret.GetArgs(2);
+				// All the results are in the answer, so the iteration doesn't fetch on the connection's loop
+				QueryResults qr(conn, {}, nullptr, p_string(args[0]), int(args[1]), kResultsJson, INT_MAX, config_.RequestTimeout);
+				if (!qr.Status().ok()) throw qr.Status();
+				WrSerializer ser;
+				for (auto it : qr) {
+					ser.Reset();
+					Error err = it.GetJSON(ser, false);
+					if (!err.ok()) throw err;
+					gason::JsonParser parser;
+					auto root = parser.Parse(ser.Slice());
+					const auto& lsnNode = root["replication"][lsnField];
+					lsn_t lsn;
+					if (lsnNode.value.getTag() == gason::JSON_OBJECT) {
+						lsn.FromJSON(lsnNode);
+					} else {
+						lsn = lsn_t(lsnNode.As<int64_t>(-1));
+					}
+					lsns.emplace(root["name"].As<std::string>(), lsnCounter(int64_t(lsn)));
+				}
+			} catch (const Error& err) {
+				logPrintf(LogTrace, "Poll of the LSNs of the replica %d failed: %s", replicaIdx, err.what());
+				return replicaRouter_->SetFailed(replicaIdx);
+			} catch (const gason::Exception& ex) {
+				logPrintf(LogTrace, "Poll of the LSNs of the replica %d failed: %s", replicaIdx, ex.what());
+				return replicaRouter_->SetFailed(replicaIdx);
+			}
+			replicaRouter_->SetLSNs(replicaIdx, pollSeq, std::move(lsns));
+		},
+		mkCommand(cproto::kCmdSelectSQL), "SELECT name, replication FROM #memstats"sv, kResultsJson, INT_MAX, pser.Slice(),
+		std::string_view());
+}
+
+ReplicaRoutingStat RPCClient::GetReplicaRoutingStat() {
+	if (!replicaRouter_) return ReplicaRoutingStat();
+	auto stat = replicaRouter_->GetStat();
+	for (size_t i = 0; i < stat.replicas.size() && i < replicas_.size(); ++i) stat.replicas[i].dsn = replicas_[i]->dsn;
+	return stat;
+}
+
 Namespace* RPCClient::getNamespace(std::string_view nsName) {
 	nsMutex_.lock_shared();
 	auto nsIt = namespaces_.find(nsName);
@@ -651,13 +849,86 @@ Namespace* RPCClient::getNamespace(std::string_view nsName) {
 	return nsIt->second.get();
 }
 
-net::cproto::ClientConnection* RPCClient::getConn() {
+net::cproto::ClientConnection* RPCClient::getConn(const net::cproto::ClientConnection* exclude) {
 	assertrx(connections_.size());
-	auto conn = connections_.at(curConnIdx_++ % connections_.size()).get();
-	assertrx(conn);
+	// Search starts from the next connection, so the calls are distributed between the equally loaded connections
+	const size_t start = curConnIdx_++;
+	net::cproto::ClientConnection* conn = nullptr;
+	int minInFlight = std::numeric_limits<int>::max();
+	for (size_t i = 0; i < connections_.size(); ++i) {
+		auto cur = connections_[(start + i) % connections_.size()].get();
+		assertrx(cur);
+		if (cur == exclude && connections_.size() > 1) continue;
+		const int inFlight = cur->InFlight();
+		if (inFlight < minInFlight) {
+			conn = cur;
+			minInFlight = inFlight;
+			if (!inFlight) break;
+		}
+	}
 	return conn;
 }
 
+template <typename... Argss>
+RPCAnswer RPCClient::hedgedCall(cproto::ClientConnection*& conn, const cproto::CommandParams& opts, Argss... argss) {
+	// Shared with the completions, because the late answer comes after the return
+	struct State {
+		std::mutex mtx;
+		std::condition_variable cond;
+		RPCAnswer ans{Error()};
+		cproto::ClientConnection* conn = nullptr;
+		int pending = 0;
+		bool done = false;
+	};
+	auto state = std::make_shared<State>();
+	auto cmpl = [state](RPCAnswer&& ans, cproto::ClientConnection* conn) {
+		std::unique_lock<std::mutex> lck(state->mtx);
+		--state->pending;
+		if (state->done) {
+			lck.unlock();
+			if (ans.Status().ok()) {
+				// Results of the late answer are not needed
+				try {
+					auto args = ans.GetArgs(2);
+					if (int(args[1]) >= 0) {
+						conn->Call([](RPCAnswer&&, cproto::ClientConnection*) {}, mkCommand(cproto::kCmdCloseResults, seconds(0), nullptr),
+								   int(args[1]));
+					}
+				} catch (const Error&) {
+				}
+			}
+			return;
+		}
+		// Failed call waits for the answer of its duplicate
+		if (!ans.Status().ok() && state->pending) return;
+		state->ans = std::move(ans);
+		state->ans.EnsureHold();
+		state->conn = conn;
+		state->done = true;
+		state->cond.notify_all();
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto hedgeDelay = selectLatency_.Percentile(0.95);
+	{
+		std::lock_guard<std::mutex> lck(state->mtx);
+		++state->pending;
+	}
+	conn->Call(cmpl, opts, argss...);
+
+	std::unique_lock<std::mutex> lck(state->mtx);
+	if (hedgeDelay.count() && connections_.size() > 1 && !state->cond.wait_for(lck, hedgeDelay, [&state] { return state->done; })) {
+		++state->pending;
+		lck.unlock();
+		getConn(conn)->Call(cmpl, opts, argss...);
+		lck.lock();
+	}
+	state->cond.wait(lck, [&state] { return state->done; });
+	selectLatency_.Add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+	conn = state->conn;
+	return std::move(state->ans);
+}
+
 cproto::CommandParams RPCClient::mkCommand(cproto::CmdCode cmd, const InternalRdxContext* ctx) const noexcept {
 	return mkCommand(cmd, config_.RequestTimeout, ctx);
 }
@@ -782,6 +1053,7 @@ Transaction RPCClient::NewTransaction(std::string_view nsName, const InternalRdx
 Error RPCClient::CommitTransaction(Transaction& tr, const InternalRdxContext& ctx) {
 	if (tr.conn_) {
 		auto ret = tr.conn_->Call(mkCommand(cproto::kCmdCommitTx, &ctx), tr.txId_).Status();
+		invalidateResults(tr.nsName_);
 		tr.clear();
 		return ret;
 	}
@@ -8,9 +8,12 @@
 #include <vector>
 #include "client/internalrdxcontext.h"
 #include "client/item.h"
+#include "client/latencytracker.h"
 #include "client/namespace.h"
 #include "client/queryresults.h"
 #include "client/reindexerconfig.h"
+#include "client/replicarouter.h"
+#include "client/resultscache.h"
 #include "client/transaction.h"
 #include "core/keyvalue/p_string.h"
 #include "core/namespacedef.h"
@@ -66,7 +69,11 @@ public:
 	Error Delete(const Query &query, QueryResults &result, const InternalRdxContext &ctx);
 	Error Update(const Query &query, QueryResults &result, const InternalRdxContext &ctx);
 	Error Select(std::string_view query, QueryResults &result, const InternalRdxContext &ctx, cproto::ClientConnection *conn = nullptr) {
-		return selectImpl(query, result, conn, config_.RequestTimeout, ctx);
+		return selectImpl(query, {}, result, conn, config_.RequestTimeout, ctx);
+	}
+	Error Select(std::string_view query, const VariantArray &params, QueryResults &result, const InternalRdxContext &ctx,
+				 cproto::ClientConnection *conn = nullptr) {
+		return selectImpl(query, params, result, conn, config_.RequestTimeout, ctx);
 	}
 	Error Select(const Query &query, QueryResults &result, const InternalRdxContext &ctx, cproto::ClientConnection *conn = nullptr) {
 		return selectImpl(query, result, conn, config_.RequestTimeout, ctx);
@@ -85,6 +92,9 @@ public:
 	Error CommitTransaction(Transaction &tr, const InternalRdxContext &ctx);
 	Error RollBackTransaction(Transaction &tr, const InternalRdxContext &ctx);
 
+	ResultsCacheStat GetResultsCacheStat() { return resultsCache_ ? resultsCache_->GetStat() : ResultsCacheStat(); }
+	ReplicaRoutingStat GetReplicaRoutingStat();
+
 protected:
 	struct worker {
 		worker() : running(false) {}
@@ -93,7 +103,8 @@ protected:
 		ev::async stop_;
 		atomic_bool running;
 	};
-	Error selectImpl(std::string_view query, QueryResults &result, cproto::ClientConnection *, seconds netTimeout,
+	Error selectImpl(std::string_view query, const VariantArray &params, QueryResults &result, cproto::ClientConnection *,
+					 seconds netTimeout,
 					 const InternalRdxContext &ctx);
 	Error selectImpl(const Query &query, QueryResults &result, cproto::ClientConnection *, seconds netTimeout,
 					 const InternalRdxContext &ctx);
@@ -104,13 +115,28 @@ protected:
 	Namespace *getNamespace(std::string_view nsName);
 	Error startWorkers();
 	Error addConnectEntry(const string &dsn, const client::ConnectOpts &opts, size_t idx);
+	Error addReplicas();
 	void run(size_t thIdx);
 	void onUpdates(net::cproto::RPCAnswer &ans, cproto::ClientConnection *conn);
 	bool onConnectionFail(int failedDsnIndex);
 
 	void checkSubscribes();
+	/// Polls the LSNs of the namespaces from the master and the replicas
+	void pollReplicas();
+	void pollLSNs(cproto::ClientConnection *conn, int replicaIdx, uint64_t pollSeq);
+	/// Invalidates the cached results of the namespace after the client's own modification, so they are not read before the update
+	/// is pushed back by the server. Reads of the namespace are not routed to the replicas until they apply the modification
+	void invalidateResults(std::string_view nsName) {
+		if (resultsCache_) resultsCache_->Invalidate(nsName);
+		if (replicaRouter_) replicaRouter_->OnWrite(nsName, -1);
+	}
 
-	net::cproto::ClientConnection *getConn();
+	/// Returns the connection with the least count of the calls in flight
+	/// @param exclude - connection, which must not be returned, if there are any others
+	net::cproto::ClientConnection *getConn(const net::cproto::ClientConnection *exclude = nullptr);
+	/// Sync call, which is duplicated on another connection, if it's not answered in time. Conn is set to the answered connection
+	template <typename... Argss>
+	cproto::RPCAnswer hedgedCall(cproto::ClientConnection *&conn, const cproto::CommandParams &opts, Argss... argss);
 	cproto::CommandParams mkCommand(cproto::CmdCode cmd, const InternalRdxContext *ctx = nullptr) const noexcept;
 	static cproto::CommandParams mkCommand(cproto::CmdCode cmd, seconds reqTimeout, const InternalRdxContext *ctx) noexcept;
 
@@ -126,6 +152,16 @@ protected:
 	std::atomic<net::cproto::ClientConnection *> updatesConn_;
 	vector<net::cproto::RPCAnswer> delayedUpdates_;
 	cproto::ClientConnection::ConnectData connectData_;
+	LatencyTracker selectLatency_;
+	std::unique_ptr<ResultsCache> resultsCache_;
+	struct Replica {
+		string dsn;
+		cproto::ClientConnection::ConnectData connectData;
+		// Connection is served by the first worker
+		std::unique_ptr<cproto::ClientConnection> conn;
+	};
+	std::vector<std::unique_ptr<Replica>> replicas_;
+	std::unique_ptr<ReplicaRouter> replicaRouter_;
 };
 
 void vec2pack(const h_vector<int32_t, 4> &vec, WrSerializer &ser);
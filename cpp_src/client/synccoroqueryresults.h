@@ -62,6 +62,8 @@ public:
 	bool HaveRank() const { return results_.queryParams_.flags & kResultsWithRank; }
 	bool NeedOutputRank() const { return results_.queryParams_.flags & kResultsNeedOutputRank; }
 	const string& GetExplainResults() const { return results_.queryParams_.explainResults; }
+	/// Deadline of the best-effort query was exceeded and only the part of the results is returned
+	bool IsIncomplete() const noexcept { return results_.queryParams_.incomplete; }
 	const vector<AggregationResult>& GetAggregationResults() const { return results_.queryParams_.aggResults; }
 	Error Status() { return results_.status_; }
 	h_vector<std::string_view, 1> GetNamespaces() const;
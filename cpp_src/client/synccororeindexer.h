@@ -15,6 +15,9 @@ class SyncCoroReindexerImpl;
 
 class SyncCoroReindexer {
 public:
+	/// Completion routine
+	typedef std::function<void(const Error &err)> Completion;
+
 	/// Create Reindexer database object
 	SyncCoroReindexer(const ReindexerConfig & = ReindexerConfig());
 	SyncCoroReindexer(SyncCoroReindexer &&rdx) noexcept;
@@ -161,6 +164,13 @@ public:
 		return SyncCoroReindexer(impl_, ctx_.WithCancelContext(cancelCtx));
 	}
 
+	/// Add completion to the next call. The call returns immediately and completion is called from the client's loop thread after the
+	/// server's response. Thousands of requests may be in flight simultaneously this way without extra threads.
+	/// Arguments, passed by reference (items and query results), must stay valid until the completion is called.
+	/// Completion must not block and must not call other methods of the same client (including the results iteration)
+	/// @param cmpl - Optional async completion routine. If nullptr function will work syncronously
+	SyncCoroReindexer WithCompletion(Completion cmpl) { return SyncCoroReindexer(impl_, ctx_.WithCompletion(cmpl)); }
+
 	/// Add execution timeout to the next query
 	/// @param timeout - Optional server-side execution timeout for each subquery
 	SyncCoroReindexer WithTimeout(milliseconds timeout) { return SyncCoroReindexer(impl_, ctx_.WithTimeout(timeout)); }
@@ -73,27 +73,40 @@ Error SyncCoroReindexerImpl::EnumDatabases(vector<string> &dbList, const Interna
 	return sendCommand<Error>(DbCmdEnumDatabases, dbList, ctx);
 }
 Error SyncCoroReindexerImpl::Insert(std::string_view nsName, Item &item, const InternalRdxContext &ctx) {
+	if (ctx.cmpl()) return modifyItemAsync(nsName, item, ModeInsert, ctx);
 	return sendCommand<Error>(DbCmdInsert, std::forward<std::string_view>(nsName), item, ctx);
 }
 Error SyncCoroReindexerImpl::Update(std::string_view nsName, Item &item, const InternalRdxContext &ctx) {
+	if (ctx.cmpl()) return modifyItemAsync(nsName, item, ModeUpdate, ctx);
 	return sendCommand<Error>(DbCmdUpdate, std::forward<std::string_view>(nsName), item, ctx);
 }
 Error SyncCoroReindexerImpl::Upsert(std::string_view nsName, Item &item, const InternalRdxContext &ctx) {
+	if (ctx.cmpl()) return modifyItemAsync(nsName, item, ModeUpsert, ctx);
 	return sendCommand<Error>(DbCmdUpsert, std::forward<std::string_view>(nsName), item, ctx);
 }
 Error SyncCoroReindexerImpl::Update(const Query &query, SyncCoroQueryResults &result, const InternalRdxContext &ctx) {
 	return sendCommand<Error>(DbCmdUpdateQ, query, result.results_, ctx);
 }
 Error SyncCoroReindexerImpl::Delete(std::string_view nsName, Item &item, const InternalRdxContext &ctx) {
+	if (ctx.cmpl()) return modifyItemAsync(nsName, item, ModeDelete, ctx);
 	return sendCommand<Error>(DbCmdDelete, std::forward<std::string_view>(nsName), item, ctx);
 }
 Error SyncCoroReindexerImpl::Delete(const Query &query, SyncCoroQueryResults &result, const InternalRdxContext &ctx) {
 	return sendCommand<Error>(DbCmdDeleteQ, query, result.results_, ctx);
 }
 Error SyncCoroReindexerImpl::Select(std::string_view query, SyncCoroQueryResults &result, const InternalRdxContext &ctx) {
+	if (ctx.cmpl()) {
+		sendAsyncCommand(
+			[query = std::string(query), &result, ctx](CoroRPCClient &rx) { ctx.cmpl()(rx.Select(query, result.results_, ctx)); });
+		return errOK;
+	}
 	return sendCommand<Error>(DbCmdSelectS, std::forward<std::string_view>(query), result, ctx);
 }
 Error SyncCoroReindexerImpl::Select(const Query &query, SyncCoroQueryResults &result, const InternalRdxContext &ctx) {
+	if (ctx.cmpl()) {
+		sendAsyncCommand([query, &result, ctx](CoroRPCClient &rx) { ctx.cmpl()(rx.Select(query, result.results_, ctx)); });
+		return errOK;
+	}
 	return sendCommand<Error>(DbCmdSelectQ, query, result, ctx);
 }
 Error SyncCoroReindexerImpl::Commit(std::string_view nsName) {
@@ -140,6 +153,28 @@ Error SyncCoroReindexerImpl::fetchResults(int flags, SyncCoroQueryResults &resul
 	return sendCommand<Error>(DbCmdFetchResults, std::forward<int>(flags), result);
 }
 
+Error SyncCoroReindexerImpl::modifyItemAsync(std::string_view nsName, Item &item, ItemModifyMode mode, const InternalRdxContext &ctx) {
+	sendAsyncCommand([nsName = std::string(nsName), &item, mode, ctx](CoroRPCClient &rx) {
+		Error err;
+		switch (mode) {
+			case ModeInsert:
+				err = rx.Insert(nsName, item, ctx);
+				break;
+			case ModeUpdate:
+				err = rx.Update(nsName, item, ctx);
+				break;
+			case ModeUpsert:
+				err = rx.Upsert(nsName, item, ctx);
+				break;
+			case ModeDelete:
+				err = rx.Delete(nsName, item, ctx);
+				break;
+		}
+		ctx.cmpl()(err);
+	});
+	return errOK;
+}
+
 Error SyncCoroReindexerImpl::addTxItem(SyncCoroTransaction &tr, Item &&item, ItemModifyMode mode) {
 	return sendCommand<Error>(DbCmdAddTxItem, tr.tr_, std::move(item), std::forward<ItemModifyMode>(mode));
 }
@@ -173,12 +208,14 @@ void SyncCoroReindexerImpl::threadLoopFun(std::promise<Error> &&isRunning, const
 		reindexer::client::CoroRPCClient rx(conf_);
 		auto err = rx.Connect(dsn, loop_, opts);
 		isRunning.set_value(err);
-		coroutine::wait_group wg;
+		coroutine::wait_group wg, asyncWg;
 		wg.add(conf_.rxClientCoroCount);
 		for (unsigned n = 0; n < conf_.rxClientCoroCount; n++) {
-			loop_.spawn(std::bind(&SyncCoroReindexerImpl::coroInterpreter, this, std::ref(rx), std::ref(chCommand), std::ref(wg)));
+			loop_.spawn(std::bind(&SyncCoroReindexerImpl::coroInterpreter, this, std::ref(rx), std::ref(chCommand), std::ref(wg),
+								  std::ref(asyncWg)));
 		}
 		wg.wait();
+		asyncWg.wait();
 	};
 	loop_.spawn(coro);
 
@@ -189,7 +226,7 @@ void SyncCoroReindexerImpl::threadLoopFun(std::promise<Error> &&isRunning, const
 }
 
 void SyncCoroReindexerImpl::coroInterpreter(reindexer::client::CoroRPCClient &rx, coroutine::channel<DatabaseCommandBase *> &chCommand,
-											coroutine::wait_group &wg) {
+											coroutine::wait_group &wg, coroutine::wait_group &asyncWg) {
 	using namespace std::placeholders;
 	coroutine::wait_group_guard wgg(wg);
 	for (std::pair<DatabaseCommandBase *, bool> v = chCommand.pop(); v.second == true; v = chCommand.pop()) {
@@ -444,6 +481,15 @@ void SyncCoroReindexerImpl::coroInterpreter(reindexer::client::CoroRPCClient &rx
 				cd->ret.set_value(err);
 				break;
 			}
+			case DbCmdAsync: {
+				asyncWg.add(1);
+				loop_.spawn([&rx, &asyncWg, cmd = static_cast<AsyncCommand *>(v.first)] {
+					coroutine::wait_group_guard wgg(asyncWg);
+					std::unique_ptr<AsyncCommand> guard(cmd);
+					cmd->fun(rx);
+				});
+				break;
+			}
 			default:
 				break;
 		}
@@ -14,6 +14,8 @@ namespace client {
 class SyncCoroTransaction;
 class SyncCoroReindexerImpl {
 public:
+	using Completion = InternalRdxContext::Completion;
+
 	/// Create Reindexer database object
 	SyncCoroReindexerImpl(const ReindexerConfig & = ReindexerConfig());
 	/// Destrory Reindexer database object
@@ -65,6 +67,7 @@ private:
 	Item newItemTx(CoroTransaction &tr);
 	Error execAddTxItem(CoroTransaction &tr, Item &item, ItemModifyMode mode);
 	void threadLoopFun(std::promise<Error> &&isRunning, const string &dsn, const client::ConnectOpts &opts);
+	Error modifyItemAsync(std::string_view nsName, Item &item, ItemModifyMode mode, const InternalRdxContext &ctx);
 
 	bool exit_ = false;
 	enum CmdName {
@@ -103,6 +106,7 @@ private:
 		DbCmdNewItemTx,
 		DbCmdAddTxItem,
 		DbCmdModifyTx,
+		DbCmdAsync,
 	};
 
 	struct DatabaseCommandBase {
@@ -140,6 +144,17 @@ private:
 		}
 	}
 
+	/// Command of the call with completion. It is executed in its own coroutine, so the count of the requests in flight is not limited
+	/// by rxClientCoroCount. Completion is called from the loop thread
+	struct AsyncCommand : public DatabaseCommandBase {
+		AsyncCommand(std::function<void(CoroRPCClient &)> &&f) : DatabaseCommandBase(DbCmdAsync), fun(std::move(f)) {}
+		std::function<void(CoroRPCClient &)> fun;
+	};
+
+	void sendAsyncCommand(std::function<void(CoroRPCClient &)> &&fun) {
+		commandsQueue_.Push(commandAsync_, new AsyncCommand(std::move(fun)));
+	}
+
 	class CommandsQueue {
 	public:
 		CommandsQueue() {}
@@ -159,7 +174,7 @@ private:
 	net::ev::async closeAsync_;
 	const ReindexerConfig conf_;
 	void coroInterpreter(reindexer::client::CoroRPCClient &rx, coroutine::channel<DatabaseCommandBase *> &chCommand,
-						 coroutine::wait_group &wg);
+						 coroutine::wait_group &wg, coroutine::wait_group &asyncWg);
 };
 
 }  // namespace client
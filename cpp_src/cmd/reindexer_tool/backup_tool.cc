@@ -0,0 +1,280 @@
+#include "backup_tool.h"
+#include <snappy.h>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "core/storage/idatastorage.h"
+#include "core/storage/storagefactory.h"
+#include "tools/fsops.h"
+#include "tools/serializer.h"
+#include "tools/stringstools.h"
+
+namespace reindexer_tool {
+
+using reindexer::datastorage::IDataStorage;
+using reindexer::datastorage::StorageFactory;
+using reindexer::datastorage::UpdatesCollection;
+using reindexer::Serializer;
+using reindexer::WrSerializer;
+
+const char kStoragePlaceholderFilename[] = ".reindexer.storage";
+const char kBackupFileExt[] = ".rxbackup";
+constexpr uint32_t kBackupMagic = 0x4B425852;  // "RXBK"
+constexpr uint32_t kBackupVersion = 1;
+constexpr uint32_t kBackupFlagSnappy = 1;
+constexpr size_t kBackupHeaderSize = 4 * sizeof(uint32_t);
+constexpr size_t kBlockHeaderSize = 2 * sizeof(uint32_t);
+// Records are grouped into the blocks, which are compressed and written to storage by the single batch
+constexpr size_t kBlockSize = 4 << 20;
+
+struct FileCloser {
+	void operator()(FILE* f) const noexcept { fclose(f); }
+};
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+static Error readStorageType(const std::string& dbPath, StorageType& storageType) {
+	std::string content;
+	if (reindexer::fs::ReadFile(reindexer::fs::JoinPath(dbPath, kStoragePlaceholderFilename), content) < 0) {
+		return Error(errNotFound, "'%s' - directory doesn't contain valid reindexer placeholder", dbPath);
+	}
+	try {
+		storageType = reindexer::datastorage::StorageTypeFromString(content);
+	} catch (const Error& err) {
+		return err;
+	}
+	return errOK;
+}
+
+static Error getDbPath(const std::string& dsn, std::string& path) {
+	if (dsn.compare(0, 10, "builtin://") != 0) {
+		return Error(errParams, "Invalid DSN format for binary backup: %s. Must begin from builtin://", dsn);
+	}
+	path = dsn.substr(10);
+	return errOK;
+}
+
+Error BackupTool::Backup(const std::string& dsn, const std::string& backupPath, unsigned threads, bool compress) noexcept {
+	try {
+		std::string dbPath;
+		auto err = getDbPath(dsn, dbPath);
+		if (!err.ok()) return err;
+		StorageType storageType;
+		err = readStorageType(dbPath, storageType);
+		if (!err.ok()) return err;
+
+		std::vector<reindexer::fs::DirEntry> entries;
+		if (reindexer::fs::ReadDir(dbPath, entries) < 0) {
+			return Error(errParams, "Can't read database dir: %s", dbPath);
+		}
+		std::vector<std::string> names;
+		for (auto& entry : entries) {
+			if (entry.isDir && reindexer::validateObjectName(entry.name, true)) names.emplace_back(entry.name);
+		}
+		if (reindexer::fs::MkDirAll(backupPath) < 0) {
+			return Error(errParams, "Can't create backup dir '%s': %s", backupPath, strerror(errno));
+		}
+
+		std::cout << "Starting backup of " << names.size() << " namespaces..." << std::endl;
+		return forEachNamespace(names, threads, [&](const std::string& name) {
+			return backupNamespace(reindexer::fs::JoinPath(dbPath, name), reindexer::fs::JoinPath(backupPath, name + kBackupFileExt),
+								   storageType, compress);
+		});
+	} catch (const Error& err) {
+		return err;
+	}
+}
+
+Error BackupTool::Restore(const std::string& dsn, const std::string& backupPath, unsigned threads) noexcept {
+	try {
+		std::string dbPath;
+		auto err = getDbPath(dsn, dbPath);
+		if (!err.ok()) return err;
+
+		std::vector<reindexer::fs::DirEntry> entries;
+		if (reindexer::fs::ReadDir(backupPath, entries) < 0) {
+			return Error(errParams, "Can't read backup dir: %s", backupPath);
+		}
+		const std::string_view ext(kBackupFileExt);
+		std::vector<std::string> names;
+		for (auto& entry : entries) {
+			const std::string_view name(entry.name);
+			if (!entry.isDir && name.size() > ext.size() && name.substr(name.size() - ext.size()) == ext) {
+				names.emplace_back(name.substr(0, name.size() - ext.size()));
+			}
+		}
+
+		// Existing database keeps its storage type, new one is created with the default storage type
+		StorageType storageType = StorageType::LevelDB;
+		err = readStorageType(dbPath, storageType);
+		if (err.code() == errNotFound) {
+			if (reindexer::fs::MkDirAll(dbPath) < 0) {
+				return Error(errParams, "Can't create database dir '%s': %s", dbPath, strerror(errno));
+			}
+			if (reindexer::fs::WriteFile(reindexer::fs::JoinPath(dbPath, kStoragePlaceholderFilename),
+										 reindexer::datastorage::StorageTypeToString(storageType)) < 0) {
+				return Error(errParams, "Can't create storage placeholder in '%s': %s", dbPath, strerror(errno));
+			}
+		} else if (!err.ok()) {
+			return err;
+		}
+		for (auto& name : names) {
+			if (reindexer::fs::Stat(reindexer::fs::JoinPath(dbPath, name)) != reindexer::fs::StatError) {
+				return Error(errConflict, "Namespace '%s' already exists in '%s'", name, dbPath);
+			}
+		}
+
+		std::cout << "Starting restore of " << names.size() << " namespaces..." << std::endl;
+		return forEachNamespace(names, threads, [&](const std::string& name) {
+			return restoreNamespace(reindexer::fs::JoinPath(backupPath, name + kBackupFileExt), reindexer::fs::JoinPath(dbPath, name),
+									storageType);
+		});
+	} catch (const Error& err) {
+		return err;
+	}
+}
+
+Error BackupTool::forEachNamespace(const std::vector<std::string>& names, unsigned threads,
+								   const std::function<Error(const std::string&)>& handler) noexcept {
+	std::atomic<size_t> next = {0};
+	std::atomic<bool> hasErrors = {false};
+	std::mutex outMtx;
+	auto worker = [&] {
+		for (size_t i = next++; i < names.size(); i = next++) {
+			auto err = handler(names[i]);
+			std::lock_guard<std::mutex> lck(outMtx);
+			if (err.ok()) {
+				std::cout << "Namespace '" << names[i] << "' done" << std::endl;
+			} else {
+				hasErrors = true;
+				std::cerr << "Namespace '" << names[i] << "' error: " << err.what() << std::endl;
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	threads = std::max(1u, std::min<unsigned>(threads, names.size()));
+	for (unsigned i = 1; i < threads; ++i) workers.emplace_back(worker);
+	worker();
+	for (auto& th : workers) th.join();
+	return hasErrors ? Error(errParams, "Some of namespaces had errors") : errOK;
+}
+
+Error BackupTool::backupNamespace(const std::string& nsPath, const std::string& filePath, StorageType storageType,
+								  bool compress) noexcept {
+	try {
+		std::unique_ptr<IDataStorage> storage(StorageFactory::create(storageType));
+		StorageOpts opts;
+		auto err = storage->Open(nsPath, opts.Enabled());
+		if (!err.ok()) return err;
+		FilePtr file(fopen(filePath.c_str(), "wb"));
+		if (!file) return Error(errParams, "Can't create '%s': %s", filePath, strerror(errno));
+
+		WrSerializer block, hdr;
+		std::string compressed;
+		auto writeBlock = [&]() -> Error {
+			std::string_view data = block.Slice();
+			if (compress && !data.empty()) {
+				snappy::Compress(data.data(), data.size(), &compressed);
+				data = compressed;
+			}
+			hdr.Reset();
+			hdr.PutUInt32(block.Len());
+			hdr.PutUInt32(data.size());
+			if (fwrite(hdr.Buf(), hdr.Len(), 1, file.get()) != 1 ||
+				(!data.empty() && fwrite(data.data(), data.size(), 1, file.get()) != 1)) {
+				return Error(errParams, "Can't write '%s': %s", filePath, strerror(errno));
+			}
+			block.Reset();
+			return errOK;
+		};
+
+		hdr.PutUInt32(kBackupMagic);
+		hdr.PutUInt32(kBackupVersion);
+		hdr.PutUInt32(uint32_t(storageType));
+		hdr.PutUInt32(compress ? kBackupFlagSnappy : 0);
+		if (fwrite(hdr.Buf(), hdr.Len(), 1, file.get()) != 1) return Error(errParams, "Can't write '%s': %s", filePath, strerror(errno));
+
+		opts.FillCache(false);
+		std::unique_ptr<reindexer::datastorage::Cursor> dbIter(storage->GetCursor(opts));
+		for (dbIter->SeekToFirst(); dbIter->Valid(); dbIter->Next()) {
+			block.PutVString(dbIter->Key());
+			block.PutVString(dbIter->Value());
+			if (block.Len() >= kBlockSize) {
+				err = writeBlock();
+				if (!err.ok()) return err;
+			}
+		}
+		dbIter.reset();
+		if (block.Len()) {
+			err = writeBlock();
+			if (!err.ok()) return err;
+		}
+		// Empty block is the end of the namespace records
+		err = writeBlock();
+		if (!err.ok()) return err;
+		if (fflush(file.get()) != 0) return Error(errParams, "Can't write '%s': %s", filePath, strerror(errno));
+	} catch (const Error& err) {
+		return err;
+	}
+	return errOK;
+}
+
+Error BackupTool::restoreNamespace(const std::string& filePath, const std::string& nsPath, StorageType storageType) noexcept {
+	try {
+		FilePtr file(fopen(filePath.c_str(), "rb"));
+		if (!file) return Error(errParams, "Can't open '%s': %s", filePath, strerror(errno));
+
+		char hdrBuf[kBackupHeaderSize];
+		if (fread(hdrBuf, sizeof(hdrBuf), 1, file.get()) != 1) return Error(errParseBin, "Backup file '%s' is truncated", filePath);
+		Serializer hdr(hdrBuf, sizeof(hdrBuf));
+		if (hdr.GetUInt32() != kBackupMagic) return Error(errParseBin, "'%s' is not a reindexer backup file", filePath);
+		const uint32_t version = hdr.GetUInt32();
+		if (version != kBackupVersion) return Error(errParseBin, "Unsupported version %d of backup file '%s'", version, filePath);
+		hdr.GetUInt32();  // Source storage type. Records don't depend on it
+		const bool compressed = hdr.GetUInt32() & kBackupFlagSnappy;
+
+		std::unique_ptr<IDataStorage> storage(StorageFactory::create(storageType));
+		StorageOpts opts;
+		auto err = storage->Open(nsPath, opts.Enabled().CreateIfMissing());
+		if (!err.ok()) return err;
+		std::unique_ptr<UpdatesCollection> batch(storage->GetUpdatesCollection());
+
+		std::string data, uncompressed;
+		for (;;) {
+			char blockHdrBuf[kBlockHeaderSize];
+			if (fread(blockHdrBuf, sizeof(blockHdrBuf), 1, file.get()) != 1) {
+				return Error(errParseBin, "Backup file '%s' is truncated", filePath);
+			}
+			Serializer blockHdr(blockHdrBuf, sizeof(blockHdrBuf));
+			const uint32_t rawLen = blockHdr.GetUInt32();
+			const uint32_t storedLen = blockHdr.GetUInt32();
+			if (!rawLen) break;
+
+			data.resize(storedLen);
+			if (fread(&data[0], storedLen, 1, file.get()) != 1) return Error(errParseBin, "Backup file '%s' is truncated", filePath);
+			std::string_view records = data;
+			if (compressed) {
+				if (!snappy::Uncompress(data.data(), data.size(), &uncompressed) || uncompressed.size() != rawLen) {
+					return Error(errParseBin, "Can't decompress block of backup file '%s'", filePath);
+				}
+				records = uncompressed;
+			}
+
+			Serializer rdser(records);
+			while (!rdser.Eof()) {
+				std::string_view key = rdser.GetVString();
+				batch->Put(key, rdser.GetVString());
+			}
+			err = storage->Write(opts, *batch);
+			if (!err.ok()) return err;
+			batch->Clear();
+		}
+		storage->Flush();
+	} catch (const Error& err) {
+		return err;
+	}
+	return errOK;
+}
+
+}  // namespace reindexer_tool
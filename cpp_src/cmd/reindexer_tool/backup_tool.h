@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "core/storage/storagetype.h"
+#include "tools/errors.h"
+
+namespace reindexer_tool {
+
+using reindexer::datastorage::StorageType;
+using reindexer::Error;
+
+/// Binary backup of the builtin database. Records of the each namespace storage (items CJSON, WAL, metadata, indexes definitions
+/// and replication state) are streamed as is into the separate file of the backup directory, so restore just writes them back and
+/// namespaces are loaded by the regular storage loading on the next database start. Database must not be used by any other process
+class BackupTool {
+public:
+	static Error Backup(const std::string& dsn, const std::string& backupPath, unsigned threads, bool compress) noexcept;
+	static Error Restore(const std::string& dsn, const std::string& backupPath, unsigned threads) noexcept;
+
+private:
+	static Error backupNamespace(const std::string& nsPath, const std::string& filePath, StorageType storageType, bool compress) noexcept;
+	static Error restoreNamespace(const std::string& filePath, const std::string& nsPath, StorageType storageType) noexcept;
+	static Error forEachNamespace(const std::vector<std::string>& names, unsigned threads,
+								  const std::function<Error(const std::string&)>& handler) noexcept;
+};
+
+}  // namespace reindexer_tool
@@ -1,4 +1,5 @@
 #include "commandsexecutor.h"
+#include <deque>
 #include <iomanip>
 #include "client/cororeindexer.h"
 #include "core/cjson/jsonbuilder.h"
@@ -28,6 +29,8 @@ const string kBenchNamespace = "rxtool_bench";
 const string kBenchIndex = "id";
 
 constexpr int kSingleThreadCoroCount = 200;
+constexpr size_t kRestoreBatchSize = 10000;
+constexpr size_t kDumpFlushSize = 0x100000;
 constexpr int kBenchItemsCount = 10000;
 constexpr int kBenchDefaultTime = 5;
 constexpr size_t k24KStack = 24 * 1024;
@@ -98,6 +101,10 @@ Error CommandsExecutor<DBInterface>::fromFileImpl(std::istream& in) {
 	using reindexer::coroutine::wait_group;
 	using reindexer::coroutine::wait_group_guard;
 
+	if (numThreads_ > 1) {
+		return fromFileParallel(in);
+	}
+
 	struct LineData {
 		std::string str;
 		int64_t lineNum = 1;
@@ -171,6 +178,179 @@ Error CommandsExecutor<DBInterface>::fromFileImpl(std::istream& in) {
 	return lastErr;
 }
 
+template <typename DBInterface>
+Error CommandsExecutor<DBInterface>::fromFileParallel(std::istream& in) {
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<RestoreBatch> queue;
+	bool finished = false;
+	bool stopped = false;
+	Error lastErr;
+	const size_t maxQueued = 2 * numThreads_;
+
+	// Returns false, if restoring has to be stopped
+	auto handleResultFn = [&](Error err, int64_t lineNum) {
+		if (err.ok()) return true;
+		std::lock_guard<std::mutex> lck(mtx);
+		const bool fatal = err.code() == errCanceled || err.code() == errNetwork;
+		if (!fatal || lastErr.ok()) {
+			std::cerr << "LINE: " << lineNum << " ERROR: " << err.what() << std::endl;
+		}
+		lastErr = err;
+		if (fatal) {
+			stopped = true;
+			cv.notify_all();
+		}
+		return !fatal;
+	};
+	auto workerFn = [&](DBInterface& rx) -> Error {
+		for (;;) {
+			RestoreBatch batch;
+			{
+				std::unique_lock<std::mutex> lck(mtx);
+				cv.wait(lck, [&] { return !queue.empty() || finished || stopped; });
+				if (stopped || queue.empty()) return errOK;
+				batch = std::move(queue.front());
+				queue.pop_front();
+			}
+			cv.notify_all();
+			auto err = restoreBatch(rx, batch, handleResultFn);
+			if (!handleResultFn(err, batch.firstLineNum)) return errOK;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(numThreads_);
+	for (int i = 0; i < numThreads_; ++i) {
+		workers.emplace_back(startWorker(workerFn, [&](const Error& err) {
+			if (err.ok()) return;
+			std::lock_guard<std::mutex> lck(mtx);
+			std::cerr << "ERROR: " << err.what() << std::endl;
+			lastErr = err;
+			stopped = true;
+			cv.notify_all();
+		}));
+	}
+
+	RestoreBatch batch;
+	auto pushBatchFn = [&] {
+		std::unique_lock<std::mutex> lck(mtx);
+		if (!batch.lines.empty()) {
+			cv.wait(lck, [&] { return queue.size() < maxQueued || stopped; });
+			queue.emplace_back(std::move(batch));
+			batch = RestoreBatch();
+			cv.notify_all();
+		}
+		return !stopped;
+	};
+
+	std::string line;
+	int64_t lineNum = 0;
+	while (GetStatus().running && std::getline(in, line)) {
+		++lineNum;
+		if (reindexer::checkIfStartsWith("\\upsert ", line)) {
+			LineParser parser(line);
+			parser.NextToken();
+			auto nsName = reindexer::unescapeString(parser.NextToken());
+			if (nsName != batch.nsName || batch.lines.size() >= kRestoreBatchSize) {
+				if (!pushBatchFn()) break;
+				batch.nsName = std::move(nsName);
+				batch.firstLineNum = lineNum;
+			}
+			batch.lines.emplace_back(std::move(line));
+		} else {
+			// Lines of the batch have to be consecutive, so the line numbers of the errors are known
+			if (!pushBatchFn()) break;
+			auto err = processImpl(line);
+			if (!handleResultFn(err, lineNum)) break;
+		}
+	}
+	pushBatchFn();
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		finished = true;
+	}
+	cv.notify_all();
+	for (auto& w : workers) w.join();
+
+	return lastErr;
+}
+
+template <typename DBInterface>
+Error CommandsExecutor<DBInterface>::restoreBatch(DBInterface& rx, RestoreBatch& batch,
+												 const std::function<bool(Error, int64_t)>& handleResult) {
+	auto tx = rx.NewTransaction(batch.nsName);
+	if (!tx.Status().ok()) return tx.Status();
+
+	for (size_t i = 0; i < batch.lines.size(); ++i) {
+		LineParser parser(batch.lines[i]);
+		parser.NextToken();
+		parser.NextToken();
+
+		auto item = tx.NewItem();
+		Error err = item.Status();
+		if (err.ok()) err = item.Unsafe().FromJSON(parser.CurPtr());
+		if (err.ok() && !parser.CurPtr().empty() && (parser.CurPtr())[0] == '[') {
+			err = Error(errParams, "Impossible to update entire item with array - only objects are allowed");
+		}
+		if (err.ok()) {
+			if constexpr (std::is_void_v<decltype(tx.Upsert(std::move(item)))>) {
+				tx.Upsert(std::move(item));
+				err = tx.Status();
+			} else {
+				err = tx.Upsert(std::move(item));
+			}
+		}
+		if (!handleResult(err, batch.firstLineNum + int64_t(i))) {
+			rx.RollBackTransaction(tx);
+			return err;
+		}
+	}
+	return commitTransaction(rx, tx);
+}
+
+template <>
+Error CommandsExecutor<reindexer::client::CoroReindexer>::commitTransaction(reindexer::client::CoroReindexer& rx, TransactionT& tx) {
+	return rx.CommitTransaction(tx);
+}
+
+template <>
+Error CommandsExecutor<reindexer::Reindexer>::commitTransaction(reindexer::Reindexer& rx, TransactionT& tx) {
+	reindexer::QueryResults qr;
+	return rx.CommitTransaction(tx, qr);
+}
+
+template <>
+std::thread CommandsExecutor<reindexer::client::CoroReindexer>::startWorker(
+	std::function<Error(reindexer::client::CoroReindexer&)> fn, std::function<void(const Error&)> onDone) {
+	return std::thread([this, fn = std::move(fn), onDone = std::move(onDone)] {
+		reindexer::net::ev::dynamic_loop loop;
+		loop.spawn([this, &loop, &fn, &onDone] {
+			reindexer::client::CoroReindexer rx;
+			const auto dsn = getCurrentDsn(true);
+			auto err = rx.Connect(dsn, loop);
+			if (err.ok()) {
+				auto ctxRx = rx.WithContext(&cancelCtx_);
+				err = fn(ctxRx);
+			} else {
+				err = Error(err.code(), "Unable to connect with provided DSN '" + dsn + "': " + err.what());
+			}
+			rx.Stop();
+			onDone(err);
+		});
+		loop.run();
+	});
+}
+
+template <>
+std::thread CommandsExecutor<reindexer::Reindexer>::startWorker(std::function<Error(reindexer::Reindexer&)> fn,
+															   std::function<void(const Error&)> onDone) {
+	return std::thread([this, fn = std::move(fn), onDone = std::move(onDone)] {
+		auto rx = db();
+		onDone(fn(rx));
+	});
+}
+
 template <typename DBInterface>
 reindexer::Error CommandsExecutor<DBInterface>::execCommand(IExecutorsCommand& cmd) {
 	std::unique_lock<std::mutex> lck_(mtx_);
@@ -560,6 +740,11 @@ Error CommandsExecutor<DBInterface>::commandSelect(const string& command) {
 						}
 						output_() << "Returned " << agg.distincts.size() << " values" << std::endl;
 						break;
+					case AggQuantile:
+						assertrx(agg.fields.size() == 2);
+						output_() << agg.aggTypeToStr(agg.type) << "(" << agg.fields[0] << ", " << agg.fields[1] << ") = " << agg.value
+								  << std::endl;
+						break;
 					default:
 						assertrx(agg.fields.size() == 1);
 						output_() << agg.aggTypeToStr(agg.type) << "(" << agg.fields.front() << ") = " << agg.value << std::endl;
@@ -677,59 +862,112 @@ Error CommandsExecutor<DBInterface>::commandDump(const string& command) {
 		doNsDefs = std::move(allNsDefs);
 	}
 
+	// skip system namespaces, except #config
+	doNsDefs.erase(std::remove_if(doNsDefs.begin(), doNsDefs.end(),
+								  [](const NamespaceDef& nsDef) {
+									  return !nsDef.name.empty() && nsDef.name[0] == '#' && nsDef.name != "#config";
+								  }),
+				   doNsDefs.end());
+
 	reindexer::WrSerializer wrser;
 
 	wrser << "-- Reindexer DB backup file" << '\n';
 	wrser << "-- VERSION 1.0" << '\n';
 
-	for (auto& nsDef : doNsDefs) {
-		// skip system namespaces, except #config
-		if (nsDef.name.length() > 0 && nsDef.name[0] == '#' && nsDef.name != "#config") continue;
+	if (numThreads_ <= 1 || doNsDefs.size() <= 1) {
+		auto flushFn = [this](WrSerializer& ser) {
+			output_() << ser.Slice();
+			ser.Reset();
+		};
+		auto rx = db();
+		for (auto& nsDef : doNsDefs) {
+			err = dumpNamespace(rx, nsDef, wrser, flushFn);
+			if (!err.ok()) return err;
+		}
+		flushFn(wrser);
+		return errOK;
+	}
+
+	// Namespaces are dumped concurrently by the separate connections. Blocks of the complete lines are written to the output, so the
+	// lines of the different namespaces may be interleaved, but each namespace definition precedes its items
+	output_() << wrser.Slice();
+	std::mutex mtx;
+	std::atomic<size_t> nextNs = {0};
+	std::atomic<bool> failed = {false};
+	Error lastErr;
+	auto flushFn = [this, &mtx](WrSerializer& ser) {
+		std::lock_guard<std::mutex> lck(mtx);
+		output_() << ser.Slice();
+		ser.Reset();
+	};
+	auto workerFn = [&](DBInterface& rx) -> Error {
+		WrSerializer ser;
+		for (size_t i = nextNs++; i < doNsDefs.size() && !failed; i = nextNs++) {
+			auto err = dumpNamespace(rx, doNsDefs[i], ser, flushFn);
+			if (!err.ok()) return err;
+			flushFn(ser);
+		}
+		return errOK;
+	};
+	auto onDoneFn = [&](const Error& err) {
+		if (err.ok()) return;
+		std::lock_guard<std::mutex> lck(mtx);
+		if (lastErr.ok()) lastErr = err;
+		failed = true;
+	};
+
+	std::vector<std::thread> workers;
+	const size_t workersCount = std::min(size_t(numThreads_), doNsDefs.size());
+	workers.reserve(workersCount);
+	for (size_t i = 0; i < workersCount; ++i) workers.emplace_back(startWorker(workerFn, onDoneFn));
+	for (auto& w : workers) w.join();
 
-		wrser << "-- Dumping namespace '" << nsDef.name << "' ..." << '\n';
+	return lastErr;
+}
 
-		wrser << "\\NAMESPACES ADD " << reindexer::escapeString(nsDef.name) << " ";
-		nsDef.GetJSON(wrser);
-		wrser << '\n';
+template <typename DBInterface>
+Error CommandsExecutor<DBInterface>::dumpNamespace(DBInterface& rx, NamespaceDef& nsDef, WrSerializer& wrser,
+												  const std::function<void(WrSerializer&)>& flush) {
+	wrser << "-- Dumping namespace '" << nsDef.name << "' ..." << '\n';
 
-		vector<string> meta;
-		err = db().WithContext(&cancelCtx_).EnumMeta(nsDef.name, meta);
+	wrser << "\\NAMESPACES ADD " << reindexer::escapeString(nsDef.name) << " ";
+	nsDef.GetJSON(wrser);
+	wrser << '\n';
+
+	vector<string> meta;
+	auto err = rx.EnumMeta(nsDef.name, meta);
+	if (err) {
+		return err;
+	}
+
+	for (auto& mkey : meta) {
+		string mdata;
+		err = rx.GetMeta(nsDef.name, mkey, mdata);
 		if (err) {
 			return err;
 		}
 
-		for (auto& mkey : meta) {
-			string mdata;
-			err = db().WithContext(&cancelCtx_).GetMeta(nsDef.name, mkey, mdata);
-			if (err) {
-				return err;
-			}
-
-			wrser << "\\META PUT " << reindexer::escapeString(nsDef.name) << " " << reindexer::escapeString(mkey) << " "
-				  << reindexer::escapeString(mdata) << '\n';
-		}
+		wrser << "\\META PUT " << reindexer::escapeString(nsDef.name) << " " << reindexer::escapeString(mkey) << " "
+			  << reindexer::escapeString(mdata) << '\n';
+	}
 
-		typename DBInterface::QueryResultsT itemResults;
-		err = db().WithContext(&cancelCtx_).Select(Query(nsDef.name), itemResults);
+	typename DBInterface::QueryResultsT itemResults;
+	err = rx.Select(Query(nsDef.name), itemResults);
 
-		if (!err.ok()) return err;
+	if (!err.ok()) return err;
 
-		for (auto it : itemResults) {
-			if (!it.Status().ok()) return it.Status();
-			if (cancelCtx_.IsCancelled()) {
-				return Error(errCanceled, "Canceled");
-			}
-			wrser << "\\UPSERT " << reindexer::escapeString(nsDef.name) << ' ';
-			it.GetJSON(wrser, false);
-			wrser << '\n';
-			if (wrser.Len() > 0x100000) {
-				output_() << wrser.Slice();
-				wrser.Reset();
-			}
+	for (auto it : itemResults) {
+		if (!it.Status().ok()) return it.Status();
+		if (cancelCtx_.IsCancelled()) {
+			return Error(errCanceled, "Canceled");
+		}
+		wrser << "\\UPSERT " << reindexer::escapeString(nsDef.name) << ' ';
+		it.GetJSON(wrser, false);
+		wrser << '\n';
+		if (wrser.Len() > kDumpFlushSize) {
+			flush(wrser);
 		}
 	}
-	output_() << wrser.Slice();
-
 	return errOK;
 }
 
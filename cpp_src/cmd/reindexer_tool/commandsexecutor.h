@@ -1,7 +1,9 @@
 #pragma once
 
 #include <condition_variable>
+#include <thread>
 #include <unordered_map>
+#include "core/namespacedef.h"
 #include "core/rdxcontext.h"
 #include "coroutine/channel.h"
 #include "iotools.h"
@@ -55,8 +57,22 @@ public:
 	Status GetStatus();
 
 protected:
+	// Consecutive '\upsert' lines of the same namespace, which are restored by the single transaction
+	struct RestoreBatch {
+		std::string nsName;
+		std::vector<std::string> lines;
+		int64_t firstLineNum = 0;
+	};
+	using TransactionT = decltype(std::declval<DBInterface&>().NewTransaction(std::string_view()));
+
 	void setStatus(Status&& status);
 	Error fromFileImpl(std::istream& in);
+	Error fromFileParallel(std::istream& in);
+	Error restoreBatch(DBInterface& db, RestoreBatch& batch, const std::function<bool(Error, int64_t)>& handleResult);
+	Error commitTransaction(DBInterface& db, TransactionT& tx);
+	// Starts the thread, which executes the function with its own connection to the database. Result of the function (or the error of
+	// the connection) is passed to 'onDone' 
+	std::thread startWorker(std::function<Error(DBInterface&)> fn, std::function<void(const Error&)> onDone);
 	Error execCommand(IExecutorsCommand& cmd);
 	template <typename... Args>
 	Error runImpl(const string& dsn, Args&&... args);
@@ -85,6 +101,8 @@ protected:
 	Error commandDelete(const string& command);
 	Error commandDeleteSQL(const string& command);
 	Error commandDump(const string& command);
+	Error dumpNamespace(DBInterface& db, reindexer::NamespaceDef& nsDef, WrSerializer& wrser,
+						const std::function<void(WrSerializer&)>& flush);
 	Error commandNamespaces(const string& command);
 	Error commandMeta(const string& command);
 	Error commandHelp(const string& command);
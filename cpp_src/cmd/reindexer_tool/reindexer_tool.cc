@@ -1,6 +1,7 @@
 #include <csignal>
 #include <limits>
 #include "args/args.hpp"
+#include "backup_tool.h"
 #include "client/cororeindexer.h"
 #include "commandsprocessor.h"
 #include "core/reindexer.h"
@@ -55,8 +56,8 @@ int main(int argc, char* argv[]) {
 	args::ValueFlag<string> outFileName(progOptions, "FILENAME", "send query results to file", {'o', "output"}, "",
 										Options::Single | Options::Global);
 
-	args::ValueFlag<int> connThreads(progOptions, "INT", "Number of threads(connections) used by db connector", {'t', "threads"}, 1,
-									 Options::Single | Options::Global);
+	args::ValueFlag<int> connThreads(progOptions, "INT", "Number of threads(connections) used by bench, dump and restore",
+									 {'t', "threads"}, 1, Options::Single | Options::Global);
 
 	args::Flag createDBF(progOptions, "", "Enable created database if missed", {"createdb"});
 
@@ -67,6 +68,12 @@ int main(int argc, char* argv[]) {
 
 	args::Flag repair(progOptions, "", "Repair database", {'r', "repair"});
 
+	args::ValueFlag<string> backupDir(progOptions, "DIRNAME", "Make binary backup of builtin database into directory", {"backup"}, "",
+									  Options::Single | Options::Global);
+	args::ValueFlag<string> restoreDir(progOptions, "DIRNAME", "Restore builtin database from binary backup directory", {"restore"}, "",
+									   Options::Single | Options::Global);
+	args::Flag compressBackup(progOptions, "", "Compress binary backup with snappy", {"compress"});
+
 	args::ValueFlag<string> appName(progOptions, "Application name", "Application name which will be used in login info", {'a', "appname"},
 									"reindexer_tool", Options::Single | Options::Global);
 
@@ -116,6 +123,21 @@ int main(int argc, char* argv[]) {
 		return 0;
 	}
 
+	if (!args::get(backupDir).empty() || !args::get(restoreDir).empty()) {
+		// Namespaces are processed by the separate workers
+		const unsigned workers = std::max(1, args::get(connThreads));
+		if (!args::get(backupDir).empty()) {
+			err = BackupTool::Backup(dsn, args::get(backupDir), workers, compressBackup && args::get(compressBackup));
+		} else {
+			err = BackupTool::Restore(dsn, args::get(restoreDir), workers);
+		}
+		if (!err.ok()) {
+			std::cerr << err.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
 	if (!args::get(command).length() && !args::get(fileName).length()) {
 		std::cout << "Reindexer command line tool version " << REINDEX_VERSION << std::endl;
 	}
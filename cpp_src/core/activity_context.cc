@@ -86,7 +86,10 @@ void Activity::GetJSON(WrSerializer& ser) const {
 	ss << buffer << '.' << std::setw(3) << std::setfill('0') << (duration_cast<milliseconds>(startTime.time_since_epoch()).count() % 1000);
 	builder.Put("query_start", ss.str());
 	builder.Put("state", DescribeState(state));
-	if (state == WaitLock) builder.Put("lock_description", "Wait lock for " + string(description));
+	if (state == WaitLock) {
+		builder.Put("lock_description", "Wait lock for " + string(description));
+		builder.Put("lock_wait_us", lockWaitTime.count());
+	}
 	builder.End();
 }
 
@@ -107,7 +110,8 @@ RdxActivityContext::RdxActivityContext(std::string_view activityTracer, std::str
 RdxActivityContext::RdxActivityContext(RdxActivityContext&& other)
 	: data_(other.data_),
 	  state_(other.state_.load(std::memory_order_relaxed)),
-	  parent_(other.parent_)
+	  parent_(other.parent_),
+	  lockWaitStart_(other.lockWaitStart_.load(std::memory_order_relaxed))
 #ifndef NDEBUG
 	  ,
 	  refCount_(0u)
@@ -122,6 +126,11 @@ RdxActivityContext::operator Activity() const {
 	const auto state = deserializeState(state_.load(std::memory_order_relaxed));
 	ret.state = state.first;
 	ret.description = state.second;
+	if (ret.state == Activity::WaitLock) {
+		using std::chrono::steady_clock;
+		const steady_clock::time_point waitStart{steady_clock::duration(lockWaitStart_.load(std::memory_order_relaxed))};
+		ret.lockWaitTime = std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() - waitStart);
+	}
 	return ret;
 }
 
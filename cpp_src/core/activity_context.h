@@ -24,6 +24,8 @@ struct Activity {
 	std::chrono::system_clock::time_point startTime;
 	enum State : unsigned { InProgress = 0, WaitLock, Sending, IndexesLookup, SelectLoop } state;
 	std::string_view description;
+	// Time of the current lock waiting, if state is WaitLock
+	std::chrono::microseconds lockWaitTime{0};
 	void GetJSON(WrSerializer&) const;
 	static std::string_view DescribeState(State) noexcept;
 };
@@ -66,6 +68,7 @@ class RdxActivityContext {
 		}
 		Ward(RdxActivityContext* cont, MutexMark mutexMark) : context_(cont) {
 			if (context_) {
+				context_->lockWaitStart_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
 				prevState_ = context_->state_.exchange(serializeState(mutexMark), std::memory_order_relaxed);
 #ifndef NDEBUG
 				context_->refCount_.fetch_add(1u, std::memory_order_relaxed);
@@ -122,6 +125,7 @@ private:
 	const Activity data_;
 	std::atomic<unsigned> state_ = {serializeState(Activity::InProgress)};	// kStateShift lower bits for state, other for details
 	ActivityContainer* parent_ = nullptr;
+	std::atomic<std::chrono::steady_clock::rep> lockWaitStart_ = {0};
 	std::atomic<unsigned> refCount_ = {0};
 };
 
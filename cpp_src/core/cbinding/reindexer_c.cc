@@ -49,6 +49,7 @@ static reindexer_ret ret2c(const Error& err_, const reindexer_resbuffer& out) {
 
 static string str2c(reindexer_string gs) { return string(reinterpret_cast<const char*>(gs.p), gs.n); }
 static std::string_view str2cv(reindexer_string gs) { return std::string_view(reinterpret_cast<const char*>(gs.p), gs.n); }
+static std::string_view buf2cv(reindexer_buffer buf) { return std::string_view(reinterpret_cast<const char*>(buf.data), buf.len); }
 
 struct QueryResultsWrapper : QueryResults {
 	WrResultSerializer ser;
@@ -87,7 +88,7 @@ static query_results_ptr new_results() { return res_pool.get(serializedResultsCo
 
 static void results2c(std::unique_ptr<QueryResultsWrapper> result, struct reindexer_resbuffer* out, int as_json = 0,
 					  int32_t* pt_versions = nullptr, int pt_versions_count = 0) {
-	int flags = as_json ? kResultsJson : (kResultsPtrs | kResultsWithItemID);
+	int flags = as_json ? kResultsJson : (kResultsItemViews | kResultsWithItemID | kResultsJoinedRefs);
 
 	flags |= (pt_versions && as_json == 0) ? kResultsWithPayloadTypes : 0;
 
@@ -123,19 +124,19 @@ reindexer_error reindexer_ping(uintptr_t rx) {
 	return error2c(db ? Error(errOK) : err_not_init);
 }
 
-static void procces_packed_item(Item& item, int mode, int state_token, reindexer_buffer data, const vector<string>& precepts, int format,
+static void procces_packed_item(Item& item, int mode, int state_token, std::string_view data, const vector<string>& precepts, int format,
 								Error& err) {
 	if (item.Status().ok()) {
 		switch (format) {
 			case FormatJson:
-				err = item.FromJSON(std::string_view(reinterpret_cast<const char*>(data.data), data.len), 0, mode == ModeDelete);
+				err = item.FromJSON(data, 0, mode == ModeDelete);
 				break;
 			case FormatCJson:
 				if (item.GetStateToken() != state_token) {
 					err = Error(errStateInvalidated, "stateToken mismatch:  %08X, need %08X. Can't process item", state_token,
 								item.GetStateToken());
 				} else {
-					err = item.FromCJSON(std::string_view(reinterpret_cast<const char*>(data.data), data.len), mode == ModeDelete);
+					err = item.FromCJSON(data, mode == ModeDelete);
 				}
 				break;
 			default:
@@ -170,12 +171,12 @@ reindexer_error reindexer_modify_item_packed_tx(uintptr_t rx, uintptr_t tr, rein
 	}
 	Error err = err_not_init;
 	auto item = trw->tr_.NewItem();
-	procces_packed_item(item, mode, state_token, data, precepts, format, err);
+	procces_packed_item(item, mode, state_token, buf2cv(data), precepts, format, err);
 	if (err.code() == errTagsMissmatch) {
 		item = db->NewItem(trw->tr_.GetName());
 		err = item.Status();
 		if (err.ok()) {
-			procces_packed_item(item, mode, state_token, data, precepts, format, err);
+			procces_packed_item(item, mode, state_token, buf2cv(data), precepts, format, err);
 		}
 	}
 	if (err.ok()) {
@@ -204,7 +205,7 @@ reindexer_ret reindexer_modify_item_packed(uintptr_t rx, reindexer_buffer args,
 
 		Item item = rdxKeeper.db().NewItem(ns);
 
-		procces_packed_item(item, mode, state_token, data, precepts, format, err);
+		procces_packed_item(item, mode, state_token, buf2cv(data), precepts, format, err);
 
 		const bool needSaveItemValueInQR = !precepts.empty();
 		query_results_ptr res;
@@ -259,6 +260,71 @@ reindexer_ret reindexer_modify_item_packed(uintptr_t rx, reindexer_buffer args,
 	return ret2c(err, out);
 }
 
+reindexer_ret reindexer_modify_items_packed_batch(uintptr_t rx, reindexer_buffer args, reindexer_buffer data,
+												 reindexer_ctx_info ctx_info) {
+	Serializer ser(args.data, args.len);
+	std::string_view ns = ser.GetVString();
+	int format = ser.GetVarUint();
+	int mode = ser.GetVarUint();
+	int state_token = ser.GetVarUint();
+	unsigned preceptsCount = ser.GetVarUint();
+	vector<string> precepts;
+	while (preceptsCount--) {
+		precepts.push_back(string(ser.GetVString()));
+	}
+
+	reindexer_resbuffer out = {0, 0, 0};
+	Error err = err_not_init;
+	if (rx) {
+		CGORdxCtxKeeper rdxKeeper(rx, ctx_info, ctx_pool);
+
+		Serializer dataSer(data.data, data.len);
+		const size_t count = dataSer.GetVarUint();
+		vector<Item> items;
+		vector<Error> itemsErrors(count);
+		// Position of each item in the items vector, or -1 if the item is not parsed
+		vector<int> itemsIdx(count, -1);
+		items.reserve(count);
+		err = Error();
+		for (size_t i = 0; i < count; ++i) {
+			Item item = rdxKeeper.db().NewItem(ns);
+			procces_packed_item(item, mode, state_token, dataSer.GetVString(), precepts, format, itemsErrors[i]);
+			// All of the items are packed with the same state, so the client has to refresh it and repeat the whole batch
+			if (itemsErrors[i].code() == errStateInvalidated) return ret2c(itemsErrors[i], out);
+			if (itemsErrors[i].ok()) {
+				itemsIdx[i] = items.size();
+				items.emplace_back(std::move(item));
+			}
+		}
+
+		auto res = new_results();
+		if (!res) {
+			return ret2c(err_too_many_queries, out);
+		}
+		vector<Error> modifyErrors(items.size());
+		rdxKeeper.db().ModifyItems(ns, items, ItemModifyMode(mode), modifyErrors);
+
+		// Statuses of the items are followed by the results of the modified items
+		bool tmUpdated = false;
+		for (size_t i = 0; i < count; ++i) {
+			const int idx = itemsIdx[i];
+			if (idx >= 0) itemsErrors[i] = std::move(modifyErrors[idx]);
+			res->ser.PutVarUint(itemsErrors[i].code());
+			if (itemsErrors[i].ok()) {
+				res->ser.PutVarint(items[idx].GetID());
+				res->AddItem(items[idx], !precepts.empty());
+				tmUpdated = tmUpdated || items[idx].IsTagsUpdated();
+			} else {
+				res->ser.PutVString(itemsErrors[i].what());
+			}
+		}
+		int32_t ptVers = -1;
+		results2c(std::move(res), &out, 0, tmUpdated ? &ptVers : nullptr, tmUpdated ? 1 : 0);
+	}
+
+	return ret2c(err, out);
+}
+
 reindexer_tx_ret reindexer_start_transaction(uintptr_t rx, reindexer_string nsName) {
 	auto db = reinterpret_cast<Reindexer*>(rx);
 	reindexer_tx_ret ret{0, {nullptr, 0}};
@@ -38,6 +38,8 @@ reindexer_ret reindexer_commit_transaction(uintptr_t rx, uintptr_t tr, reindexer
 reindexer_error reindexer_rollback_transaction(uintptr_t rx, uintptr_t tr);
 
 reindexer_ret reindexer_modify_item_packed(uintptr_t rx, reindexer_buffer args, reindexer_buffer data, reindexer_ctx_info ctx_info);
+reindexer_ret reindexer_modify_items_packed_batch(uintptr_t rx, reindexer_buffer args, reindexer_buffer data,
+												 reindexer_ctx_info ctx_info);
 reindexer_ret reindexer_select(uintptr_t rx, reindexer_string query, int as_json, int32_t *pt_versions, int pt_versions_count,
 							   reindexer_ctx_info ctx_info);
 
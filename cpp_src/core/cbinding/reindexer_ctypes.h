@@ -19,6 +19,16 @@ typedef struct reindexer_resbuffer {
 
 } reindexer_resbuffer;
 
+// Fixed layout view of the query results' item, which is read by the builtin binding directly from the results buffer.
+// Payload (cptr) points to the item's data, which is pinned by the query results until reindexer_free_buffer
+typedef struct reindexer_item_view {
+	uint64_t cptr;
+	int64_t lsn;
+	int32_t id;
+	uint16_t nsid;
+	uint16_t proc;
+} reindexer_item_view;
+
 typedef struct reindexer_error {
 	const char *what;
 	int code;
@@ -2,11 +2,16 @@
 #include "core/cjson/tagsmatcher.h"
 #include "core/queryresults/joinresults.h"
 #include "core/queryresults/queryresults.h"
+#include "reindexer_ctypes.h"
 #include "tools/logger.h"
 
 namespace reindexer {
 
+// Views are aligned by the absolute address, so the client reads them in place. Must be the same in the Go binding
+constexpr size_t kItemViewsAlignment = 8;
+
 WrResultSerializer::WrResultSerializer(const ResultFetchOpts& opts) : WrSerializer(), opts_(opts) {}
+WrResultSerializer::WrResultSerializer(chunk&& ch, const ResultFetchOpts& opts) : WrSerializer(std::move(ch)), opts_(opts) {}
 
 void WrResultSerializer::putQueryParams(const QueryResults* results) {
 	// Flags of present objects
@@ -59,6 +64,10 @@ void WrResultSerializer::putExtraParams(const QueryResults* results) {
 		PutVarUint(QueryResultExplain);
 		PutSlice(results->explainResults);
 	}
+	if (results->incomplete) {
+		PutVarUint(QueryResultIncomplete);
+		PutSlice(std::string_view());
+	}
 	PutVarUint(QueryResultEnd);
 }
 
@@ -124,7 +133,24 @@ void WrResultSerializer::putPayloadType(const QueryResults* results, int nsid) {
 	t->serialize(*this);
 }
 
-bool WrResultSerializer::PutResults(const QueryResults* result) {
+void WrResultSerializer::putItemViews(const QueryResults* result) {
+	// Whole buffer is reserved at once, so the aligned views are not moved by the reallocation
+	grow(kItemViewsAlignment + opts_.fetchLimit * sizeof(reindexer_item_view));
+	while (uintptr_t(buf_ + len_) % kItemViewsAlignment) buf_[len_++] = 0;
+	for (unsigned i = 0; i < opts_.fetchLimit; ++i) {
+		const ItemRef& itemRef = result->Items()[i + opts_.fetchOffset];
+		reindexer_item_view view;
+		view.cptr = uintptr_t(itemRef.Value().Ptr());
+		view.lsn = itemRef.Value().GetLSN();
+		view.id = itemRef.Id();
+		view.nsid = itemRef.Nsid();
+		view.proc = itemRef.Proc();
+		memcpy(buf_ + len_, &view, sizeof(view));
+		len_ += sizeof(view);
+	}
+}
+
+void WrResultSerializer::adjustOpts(const QueryResults* result) {
 	if (opts_.fetchOffset > result->Count()) {
 		opts_.fetchOffset = result->Count();
 	}
@@ -147,36 +173,119 @@ bool WrResultSerializer::PutResults(const QueryResults* result) {
 	if ((opts_.flags & kResultsFormatMask) == kResultsJson || (opts_.flags & kResultsFormatMask) == kResultsMsgPack) {
 		opts_.flags &= ~(kResultsWithJoined | kResultsWithPayloadTypes);
 	}
+	// Views have no room for the joined and raw items, so such results are passed as the pointers
+	if ((opts_.flags & kResultsFormatMask) == kResultsItemViews && (opts_.flags & (kResultsWithJoined | kResultsWithRaw))) {
+		opts_.flags = (opts_.flags & ~kResultsFormatMask) | kResultsPtrs;
+	}
+	if (!(opts_.flags & kResultsWithJoined)) opts_.flags &= ~kResultsJoinedRefs;
+}
+
+void WrResultSerializer::putItem(const QueryResults* result, unsigned idx) {
+	// Put Item ID and version
+	putItemParams(result, idx, true);
+
+	if (opts_.flags & kResultsWithJoined) {
+		auto rowIt = result->begin() + (idx + opts_.fetchOffset);
+		auto jIt = rowIt.GetJoined();
+		PutVarUint(jIt.getJoinedItemsCount() > 0 ? jIt.getJoinedFieldsCount() : 0);
+		if (jIt.getJoinedItemsCount() > 0) {
+			size_t joinedField = rowIt.qr_->joined_.size();
+			for (size_t ns = 0; ns < rowIt.GetItemRef().Nsid(); ++ns) {
+				joinedField += rowIt.qr_->joined_[ns].GetJoinedSelectorsCount();
+			}
+			for (auto it = jIt.begin(); it != jIt.end(); ++it, ++joinedField) {
+				PutVarUint(it.ItemsCount());
+				if (it.ItemsCount() == 0) continue;
+				QueryResults qr = it.ToQueryResults();
+				qr.addNSContext(result->getPayloadType(joinedField), result->getTagsMatcher(joinedField),
+								result->getFieldsFilter(joinedField), result->getSchema(joinedField));
+				for (size_t i = 0; i < qr.Count(); i++) putJoinedItem(&qr, i, joinedField);
+			}
+		}
+	}
+}
+
+void WrResultSerializer::putJoinedItem(const QueryResults* joined, int idx, unsigned joinedField) {
+	if (opts_.flags & kResultsJoinedRefs) {
+		// Many left items may be joined with the same right one. It's put once, and then it's referred by its number in the page
+		// (starting from 1), while 0 is followed by the new item
+		const uint64_t key = (uint64_t(joinedField) << 32) | uint32_t(joined->Items()[idx].Id());
+		const auto res = joinedRefs_.emplace(key, joinedRefs_.size() + 1);
+		if (!res.second) {
+			PutVarUint(res.first->second);
+			return;
+		}
+		PutVarUint(0);
+	}
+	putItemParams(joined, idx, false);
+}
+
+bool WrResultSerializer::PutResults(const QueryResults* result) {
+	adjustOpts(result);
+	joinedRefs_.clear();
 
 	putQueryParams(result);
+	if ((opts_.flags & kResultsFormatMask) == kResultsItemViews) {
+		putItemViews(result);
+		return opts_.fetchOffset + opts_.fetchLimit >= result->Count();
+	}
 	size_t saveLen = len_;
 
 	for (unsigned i = 0; i < opts_.fetchLimit; ++i) {
-		// Put Item ID and version
-		putItemParams(result, i, true);
-
-		if (opts_.flags & kResultsWithJoined) {
-			auto rowIt = result->begin() + (i + opts_.fetchOffset);
-			auto jIt = rowIt.GetJoined();
-			PutVarUint(jIt.getJoinedItemsCount() > 0 ? jIt.getJoinedFieldsCount() : 0);
-			if (jIt.getJoinedItemsCount() > 0) {
-				size_t joinedField = rowIt.qr_->joined_.size();
-				for (size_t ns = 0; ns < rowIt.GetItemRef().Nsid(); ++ns) {
-					joinedField += rowIt.qr_->joined_[ns].GetJoinedSelectorsCount();
-				}
-				for (auto it = jIt.begin(); it != jIt.end(); ++it, ++joinedField) {
-					PutVarUint(it.ItemsCount());
-					if (it.ItemsCount() == 0) continue;
-					QueryResults qr = it.ToQueryResults();
-					qr.addNSContext(result->getPayloadType(joinedField), result->getTagsMatcher(joinedField),
-									result->getFieldsFilter(joinedField), result->getSchema(joinedField));
-					for (size_t idx = 0; idx < qr.Count(); idx++) putItemParams(&qr, idx, false);
-				}
-			}
-		}
+		putItem(result, i);
 		if (i == 0) grow((opts_.fetchLimit - 1) * (len_ - saveLen));
 	}
 	return opts_.fetchOffset + opts_.fetchLimit >= result->Count();
 }
 
+SpilledQueryResults::SpilledQueryResults(const QueryResults& results, int flags, unsigned offset)
+	: flags_(flags & ~kResultsWithPayloadTypes), totalCount_(results.totalCount), count_(results.Count()) {
+	WrResultSerializer ser(ResultFetchOpts{flags_, {}, offset, unsigned(count_)});
+	ser.adjustOpts(&results);
+	// Pages are cut from the spilled items at any offset, so each item has to be self-contained
+	ser.opts_.flags &= ~kResultsJoinedRefs;
+	resultFlags_ = ser.opts_.flags;
+	offset_ = ser.opts_.fetchOffset;
+
+	ser.putExtraParams(&results);
+	itemsBegin_ = ser.Len();
+	itemsEnds_.reserve(ser.opts_.fetchLimit);
+	for (unsigned i = 0; i < ser.opts_.fetchLimit; ++i) {
+		ser.putItem(&results, i);
+		itemsEnds_.emplace_back(ser.Len());
+	}
+	size_ = ser.Len();
+	data_ = ser.DetachBuf();
+}
+
+bool SpilledQueryResults::CanSpill(int flags) noexcept {
+	const int format = flags & kResultsFormatMask;
+	return format != kResultsPtrs && format != kResultsItemViews;
+}
+
+bool SpilledQueryResults::PutResults(WrSerializer& ser, ResultFetchOpts opts) const {
+	if ((opts.flags & ~kResultsWithPayloadTypes) != flags_) {
+		throw Error(errParams, "Query results were spilled with the fetch flags %d and can not be fetched with the flags %d", flags_,
+					opts.flags);
+	}
+	opts.fetchOffset = std::min(size_t(opts.fetchOffset), count_);
+	opts.fetchLimit = std::min(size_t(opts.fetchLimit), count_ - opts.fetchOffset);
+	if (opts.fetchOffset < offset_ && opts.fetchLimit) {
+		throw Error(errParams, "Query results were spilled from the item %d, so the item %d can not be fetched", offset_, opts.fetchOffset);
+	}
+
+	ser.PutVarUint(resultFlags_);
+	ser.PutVarUint(totalCount_);
+	ser.PutVarUint(count_);
+	ser.PutVarUint(opts.fetchLimit);
+	const auto data = std::string_view(reinterpret_cast<const char*>(data_.get()), size_);
+	ser.Write(data.substr(0, itemsBegin_));
+	if (opts.fetchLimit) {
+		const size_t first = opts.fetchOffset - offset_;
+		const size_t begin = first ? itemsEnds_[first - 1] : itemsBegin_;
+		ser.Write(data.substr(begin, itemsEnds_[first + opts.fetchLimit - 1] - begin));
+	}
+	return opts.fetchOffset + opts.fetchLimit >= count_;
+}
+
 }  // namespace reindexer
@@ -1,4 +1,7 @@
 #pragma once
+#include <memory>
+#include <vector>
+#include "estl/fast_hash_map.h"
 #include "estl/h_vector.h"
 #include "estl/span.h"
 #include "tools/serializer.h"
@@ -16,16 +19,58 @@ struct ResultFetchOpts {
 class WrResultSerializer : public WrSerializer {
 public:
 	WrResultSerializer(const ResultFetchOpts& opts = {0, {}, 0, 0});
+	/// Results are appended to the existing data of the chunk
+	WrResultSerializer(chunk&& ch, const ResultFetchOpts& opts);
 
 	bool PutResults(const QueryResults* results);
 	void SetOpts(const ResultFetchOpts& opts) { opts_ = opts; }
 
 private:
+	friend class SpilledQueryResults;
+
+	void adjustOpts(const QueryResults* result);
+	void putItem(const QueryResults* result, unsigned idx);
 	void putQueryParams(const QueryResults* query);
 	void putItemParams(const QueryResults* result, int idx, bool useOffset);
 	void putExtraParams(const QueryResults* query);
 	void putPayloadType(const QueryResults* results, int nsId);
+	void putItemViews(const QueryResults* results);
+	void putJoinedItem(const QueryResults* joined, int idx, unsigned joinedField);
 	ResultFetchOpts opts_;
+	// Numbers of the joined items put into the current page by the joined field and the item id
+	fast_hash_map<uint64_t, unsigned> joinedRefs_;
+};
+
+/// Remaining items of the query results, which are serialized in advance in the format of the following fetches. Spilled results don't
+/// refer the namespaces' payloads, so the long-lived cursor doesn't pin them
+class SpilledQueryResults {
+public:
+	/// @param results - Results to spill
+	/// @param flags - Flags of the fetches. Payload types are sent with the first page only, so this flag is ignored
+	/// @param offset - Index of the first spilled item. Previous items can not be fetched from the spilled results
+	SpilledQueryResults(const QueryResults& results, int flags, unsigned offset);
+
+	/// @return true, if the items of this format are serialized by the value (not by the pointers to the namespaces' payloads)
+	static bool CanSpill(int flags) noexcept;
+	int Flags() const noexcept { return flags_; }
+	unsigned Offset() const noexcept { return offset_; }
+	size_t Count() const noexcept { return count_; }
+	size_t Size() const noexcept { return size_ + itemsEnds_.size() * sizeof(itemsEnds_[0]); }
+	/// Puts the page of the results in the same format as WrResultSerializer::PutResults does
+	/// @return true, if the last item of the results was put
+	bool PutResults(WrSerializer& ser, ResultFetchOpts opts) const;
+
+private:
+	int flags_;
+	int resultFlags_;
+	unsigned offset_;
+	size_t totalCount_;
+	size_t count_;
+	// Extra params of the results are followed by the items
+	std::unique_ptr<uint8_t[]> data_;
+	size_t size_ = 0;
+	size_t itemsBegin_ = 0;
+	std::vector<size_t> itemsEnds_;
 };
 
 }  // namespace reindexer
@@ -4,8 +4,10 @@
 #include "cjsonbuilder.h"
 #include "cjsontools.h"
 #include "core/keyvalue/p_string.h"
+#include "core/namespace/coldtuples.h"
 #include "jsonbuilder.h"
 #include "msgpackbuilder.h"
+#include "pathsextractor.h"
 #include "protobufbuilder.h"
 #include "tagsmatcher.h"
 #include "tools/serializer.h"
@@ -16,6 +18,20 @@ template <typename Builder>
 BaseEncoder<Builder>::BaseEncoder(const TagsMatcher* tagsMatcher, const FieldsSet* filter) : tagsMatcher_(tagsMatcher), filter_(filter) {
 	static_assert(std::numeric_limits<decltype(objectScalarIndexes_)>::digits >= maxIndexes,
 				  "objectScalarIndexes_ needs to provide 'maxIndexes' bits or more");
+	if (!filter_) return;
+	for (size_t i = 0; i < filter_->getTagsPathsLength(); ++i) {
+		const int rootTag = filter_->isTagsPathIndexed(i)
+								? (filter_->getIndexedTagsPath(i).empty() ? 0 : filter_->getIndexedTagsPath(i).front().NameTag())
+								: (filter_->getTagsPath(i).empty() ? 0 : filter_->getTagsPath(i).front());
+		if (!rootTag) {
+			// Whole tuple is matched by the empty path
+			filterRootTags_.clear();
+			return;
+		}
+		if (std::find(filterRootTags_.begin(), filterRootTags_.end(), rootTag) == filterRootTags_.end()) {
+			filterRootTags_.push_back(rootTag);
+		}
+	}
 }
 
 template <typename Builder>
@@ -28,7 +44,8 @@ void BaseEncoder<Builder>::Encode(std::string_view tuple, Builder& builder, IAdd
 	(void)begTag;
 	assertrx(begTag.Type() == TAG_OBJECT);
 	Builder objNode = builder.Object(nullptr);
-	while (encode(nullptr, rdser, objNode, true))
+	encodedRootTags_ = 0;
+	while (encode(nullptr, rdser, objNode, true) && !allFilteredTagsEncoded())
 		;
 	if (ds) {
 		assertrx(!ds->GetJoinsDatasource());
@@ -51,7 +68,8 @@ void BaseEncoder<Builder>::Encode(ConstPayload* pl, Builder& builder, IAdditiona
 	(void)begTag;
 	assertrx(begTag.Type() == TAG_OBJECT);
 	Builder objNode = builder.Object(nullptr);
-	while (encode(pl, rdser, objNode, true))
+	encodedRootTags_ = 0;
+	while (encode(pl, rdser, objNode, true) && !allFilteredTagsEncoded())
 		;
 
 	if (ds) {
@@ -132,7 +150,15 @@ bool BaseEncoder<Builder>::encode(ConstPayload* pl, Serializer& rdser, Builder&
 	TagsPathScope<TagsPath> pathScope(curTagsPath_, tagName);
 	TagsPathScope<IndexedTagsPath> indexedPathScope(indexedTagsPath_, tagName);
 	if (tagName && filter_) {
+		if (visible && curTagsPath_.size() == 1 &&
+			std::find(filterRootTags_.begin(), filterRootTags_.end(), tagName) != filterRootTags_.end()) {
+			++encodedRootTags_;
+		}
 		visible = visible && filter_->match(indexedTagsPath_);
+		if (!visible) {
+			skip(tag, rdser);
+			return true;
+		}
 	}
 
 	const int tagField = tag.Field();
@@ -218,6 +244,40 @@ bool BaseEncoder<Builder>::encode(ConstPayload* pl, Serializer& rdser, Builder&
 	return true;
 }
 
+template <typename Builder>
+void BaseEncoder<Builder>::skip(ctag tag, Serializer& rdser) {
+	const int tagType = tag.Type();
+	const int tagField = tag.Field();
+	if (tagField >= 0) {
+		objectScalarIndexes_ |= (1ULL << tagField);
+		if (tagType == TAG_ARRAY) {
+			fieldsoutcnt_[tagField] += rdser.GetVarUint();
+		} else if (tagType != TAG_NULL) {
+			++fieldsoutcnt_[tagField];
+		}
+		return;
+	}
+	switch (tagType) {
+		case TAG_ARRAY: {
+			const carraytag atag = rdser.GetUInt32();
+			for (int i = 0; i < atag.Count(); i++) {
+				if (atag.Tag() == TAG_OBJECT) {
+					skip(rdser.GetVarUint(), rdser);
+				} else {
+					rdser.GetRawVariant(KeyValueType(atag.Tag()));
+				}
+			}
+			break;
+		}
+		case TAG_OBJECT:
+			objectScalarIndexes_ = 0;
+			for (ctag otag = rdser.GetVarUint(); otag.Type() != TAG_END; otag = rdser.GetVarUint()) skip(otag, rdser);
+			break;
+		default:
+			rdser.GetRawVariant(KeyValueType(tagType));
+	}
+}
+
 template <typename Builder>
 bool BaseEncoder<Builder>::collectTagsSizes(ConstPayload* pl, Serializer& rdser) {
 	const ctag tag = rdser.GetVarUint();
@@ -294,7 +354,7 @@ std::string_view BaseEncoder<Builder>::getPlTuple(ConstPayload* pl) {
 		return tmpPlTuple_.Slice();
 	}
 
-	return std::string_view(tuple);
+	return ColdTuples::Resolve(pl->Type(), tuple, coldTuple_);
 }
 
 template class BaseEncoder<JsonBuilder>;
@@ -302,5 +362,6 @@ template class BaseEncoder<CJsonBuilder>;
 template class BaseEncoder<MsgPackBuilder>;
 template class BaseEncoder<ProtobufBuilder>;
 template class BaseEncoder<FieldsExtractor>;
+template class BaseEncoder<PathsExtractor>;
 
 }  // namespace reindexer
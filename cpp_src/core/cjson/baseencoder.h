@@ -47,6 +47,10 @@ public:
 protected:
 	bool encode(ConstPayload *pl, Serializer &rdser, Builder &builder, bool visible);
 	void encodeJoinedItems(Builder &builder, IEncoderDatasourceWithJoins *ds, size_t joinedIdx);
+	// Skips the subtree, which is not matched by the filter, without the builder calls
+	void skip(ctag tag, Serializer &rdser);
+	// Tuple is not read after all of the top-level fields, requested by the filter, are encoded
+	bool allFilteredTagsEncoded() const noexcept { return !filterRootTags_.empty() && encodedRootTags_ == filterRootTags_.size(); }
 	bool collectTagsSizes(ConstPayload *pl, Serializer &rdser);
 	void collectJoinedItemsTagsSizes(IEncoderDatasourceWithJoins *ds, size_t rowid);
 
@@ -56,10 +60,13 @@ protected:
 	int fieldsoutcnt_[maxIndexes];
 	const FieldsSet *filter_;
 	WrSerializer tmpPlTuple_;
+	key_string coldTuple_;
 	TagsPath curTagsPath_;
 	IndexedTagsPath indexedTagsPath_;
 	TagsLengths tagsLengths_;
 	uint64_t objectScalarIndexes_ = 0;
+	h_vector<int, 4> filterRootTags_;
+	size_t encodedRootTags_ = 0;
 };
 
 using JsonEncoder = BaseEncoder<JsonBuilder>;
@@ -6,6 +6,8 @@
 
 namespace reindexer {
 
+constexpr int kVarintsBatchSize = 64;
+
 CJsonDecoder::CJsonDecoder(TagsMatcher &tagsMatcher) : tagsMatcher_(tagsMatcher), filter_(nullptr), lastErr_(errOK) {}
 CJsonDecoder::CJsonDecoder(TagsMatcher &tagsMatcher, const FieldsSet *filter)
 	: tagsMatcher_(tagsMatcher), filter_(filter), lastErr_(errOK) {}
@@ -56,9 +58,21 @@ bool CJsonDecoder::decodeCJson(Payload *pl, Serializer &rdser, WrSerializer &wrs
 			if (tagType == TAG_ARRAY) {
 				carraytag atag = rdser.GetUInt32();
 				int ofs = pl->ResizeArray(field, atag.Count(), true);
-				for (int count = 0; count < atag.Count() && err.ok(); count++) {
-					ctag tag = atag.Tag() != TAG_OBJECT ? atag.Tag() : rdser.GetVarUint();
-					pl->Set(field, ofs + count, cjsonValueToVariant(tag.Type(), rdser, fieldType, err));
+				if (atag.Tag() == TAG_VARINT) {
+					// Integer arrays are read by the batches
+					int64_t values[kVarintsBatchSize];
+					for (int count = 0; count < atag.Count() && err.ok();) {
+						const int batchSize = std::min(atag.Count() - count, kVarintsBatchSize);
+						rdser.GetVarints(span<int64_t>(values, batchSize));
+						for (int i = 0; i < batchSize && err.ok(); ++i, ++count) {
+							pl->Set(field, ofs + count, cjsonVarintToVariant(values[i], fieldType, err));
+						}
+					}
+				} else {
+					for (int count = 0; count < atag.Count() && err.ok(); count++) {
+						ctag tag = atag.Tag() != TAG_OBJECT ? atag.Tag() : rdser.GetVarUint();
+						pl->Set(field, ofs + count, cjsonValueToVariant(tag.Type(), rdser, fieldType, err));
+					}
 				}
 				if (err.ok()) {
 					wrser.PutVarUint(static_cast<int>(ctag(tagType, tagName, field)));
@@ -37,6 +37,7 @@ Error CJsonModifier::SetFieldValue(std::string_view tuple, IndexedTagsPath field
 		return Error(errLogic, kWrongFieldsAmountMsg);
 	}
 	try {
+		if (patchScalarField(tuple, fieldPath, val, ser)) return errOK;
 		tagsPath_.clear();
 		Context ctx(fieldPath, val, ser, tuple, FieldModeSet, nullptr);
 		fieldPath_ = std::move(fieldPath);
@@ -78,6 +79,51 @@ Error CJsonModifier::RemoveField(std::string_view tuple, IndexedTagsPath fieldPa
 	return errOK;
 }
 
+bool CJsonModifier::patchScalarField(std::string_view tuple, const IndexedTagsPath &fieldPath, const VariantArray &val, WrSerializer &ser) {
+	if (val.size() != 1 || val.IsArrayValue()) return false;
+	switch (val.front().Type()) {
+		case KeyValueInt:
+		case KeyValueInt64:
+		case KeyValueDouble:
+		case KeyValueBool:
+		case KeyValueString:
+			break;
+		default:
+			return false;
+	}
+	for (const IndexedPathNode &node : fieldPath) {
+		if (node.IsArrayNode()) return false;
+	}
+
+	// Looks for the field through the nested objects only: fields in arrays of objects and fields to insert are left for the full rebuild
+	Serializer rdser(tuple);
+	if (rdser.Eof() || ctag(rdser.GetVarUint()).Type() != TAG_OBJECT) return false;
+	size_t level = 0;
+	while (!rdser.Eof()) {
+		const size_t tagPos = rdser.Pos();
+		const ctag tag = rdser.GetVarUint();
+		if (tag.Type() == TAG_END) return false;
+		if (tag.Name() != fieldPath[level].NameTag()) {
+			skipCjsonTag(tag, rdser);
+			continue;
+		}
+		if (tag.Field() >= 0) return false;
+		if (level + 1 < fieldPath.size()) {
+			if (tag.Type() != TAG_OBJECT) return false;
+			++level;
+			continue;
+		}
+		skipCjsonTag(tag, rdser);
+		const int tagType = kvType2Tag(val.front().Type());
+		ser.Write(tuple.substr(0, tagPos));
+		ser.PutVarUint(static_cast<int>(ctag(tagType, tag.Name())));
+		copyCJsonValue(tagType, val.front(), ser);
+		ser.Write(tuple.substr(rdser.Pos()));
+		return true;
+	}
+	return false;
+}
+
 void CJsonModifier::updateObject(Context &ctx, int tagName) {
 	JsonDecoder jsonDecoder(tagsMatcher_);
 	if (ctx.value.IsArrayValue()) {
@@ -13,6 +13,9 @@ public:
 
 protected:
 	struct Context;
+	// Replaces the value of the existing non-indexed field by the single scalar value, copying the rest of the tuple as is.
+	// Returns false, if the tuple has to be rebuilt
+	bool patchScalarField(std::string_view tuple, const IndexedTagsPath &fieldPath, const VariantArray &val, WrSerializer &ser);
 	bool updateFieldInTuple(Context &ctx);
 	bool dropFieldInTuple(Context &ctx);
 	bool buildCJSON(Context &ctx);
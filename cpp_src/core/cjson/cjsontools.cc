@@ -138,6 +138,17 @@ Variant cjsonValueToVariant(int tag, Serializer &rdser, KeyValueType dstType, Er
 	return Variant();
 }
 
+Variant cjsonVarintToVariant(int64_t value, KeyValueType dstType, Error &err) {
+	try {
+		if (dstType == KeyValueInt) return Variant(int(value));
+		return Variant(value).convert(dstType);
+	} catch (const Error &e) {
+		err = e;
+	}
+
+	return Variant();
+}
+
 template <typename T>
 void buildPayloadTuple(const PayloadIface<T> *pl, const TagsMatcher *tagsMatcher, WrSerializer &wrser) {
 	CJsonBuilder builder(wrser, ObjType::TypeObject);
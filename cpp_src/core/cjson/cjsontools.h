@@ -16,5 +16,7 @@ void putCJsonValue(int tagType, int tagName, const VariantArray &values, WrSeria
 int kvType2Tag(KeyValueType kvType);
 void skipCjsonTag(ctag tag, Serializer &rdser);
 Variant cjsonValueToVariant(int tag, Serializer &rdser, KeyValueType dstType, Error &err);
+// Same as cjsonValueToVariant for the already read value of TAG_VARINT
+Variant cjsonVarintToVariant(int64_t value, KeyValueType dstType, Error &err);
 
 }  // namespace reindexer
@@ -78,6 +78,7 @@ Error JsonSchemaChecker::createTypeTable(const std::string& json) {
 	auto root = schema_.GetRoot();
 
 	addSimpleType("any");
+	anyTypeIndex_ = indexes_["any"];
 	addSimpleType("string");
 	addSimpleType("number");
 	addSimpleType("integer");
@@ -88,6 +89,8 @@ Error JsonSchemaChecker::createTypeTable(const std::string& json) {
 	} catch (const Error& e) {
 		return e;
 	}
+	auto rootIt = indexes_.find(rootTypeName_);
+	if (rootIt != indexes_.end()) rootTypeIndex_ = rootIt->second;
 
 	valAppearance_.reserve(typesTable_.size());
 	for (unsigned int i = 0; i < typesTable_.size(); ++i) {
@@ -106,27 +109,22 @@ Error JsonSchemaChecker::Check(gason::JsonNode node) {
 		return Error(errParseJson, "Node [%s] should JSON_OBJECT.", node.key);
 	}
 
-	auto indxIt = indexes_.find(rootTypeName_);
-	if (indxIt == indexes_.end()) return Error(errParseJson, "Type '%s' not found.", rootTypeName_);
-	int nType = indxIt->second;
-	std::string path;
-	path.reserve(512);
-	return checkScheme(node, nType, path, rootTypeName_);
+	if (rootTypeIndex_ < 0) return Error(errParseJson, "Type '%s' not found.", rootTypeName_);
+	PathStack path;
+	return checkScheme(node, rootTypeIndex_, path, rootTypeName_);
 }
 
-struct PathPop {
-	PathPop(std::string& path) : pathStack(path), len(path.size()) {}
-	~PathPop() { pathStack.resize(len); }
-	std::string& pathStack;
-	size_t len;
-};
-
-Error JsonSchemaChecker::checkScheme(const gason::JsonNode& node, int typeIndex, std::string& path, const std::string& elementName) {
-	PathPop popPath(path);
-	if (!path.empty()) {
-		path += ".";
+std::string JsonSchemaChecker::pathToString(const PathStack& path) {
+	std::string res;
+	for (std::string_view name : path) {
+		if (!res.empty()) res += ".";
+		res += name;
 	}
-	path += elementName;
+	return res;
+}
+
+Error JsonSchemaChecker::checkScheme(const gason::JsonNode& node, int typeIndex, PathStack& path, std::string_view elementName) {
+	path.push_back(elementName);
 	const TypeDescr& descr = typesTable_[typeIndex];
 	h_vector<ValAppearance, 16> mmVals(valAppearance_[typeIndex].begin(), valAppearance_[typeIndex].end());
 	Error err;
@@ -134,50 +132,48 @@ Error JsonSchemaChecker::checkScheme(const gason::JsonNode& node, int typeIndex,
 		auto subElemIndex = descr.subElementsIndex.find(std::string_view(elem.key));
 		if (subElemIndex == descr.subElementsIndex.end()) {
 			if (!descr.allowAdditionalProps)
-				return Error(errParseJson, "Key [%s] not allowed in [%s] object.", elem.key, path);
+				return Error(errParseJson, "Key [%s] not allowed in [%s] object.", elem.key, pathToString(path));
 			else
 				continue;
 		}
 		err = checkExists(elem.key, &mmVals[subElemIndex->second], path);
 		if (!err.ok()) return err;
+		const auto& subElement = descr.subElementsTable[subElemIndex->second];
+		if (subElement.second.typeIndex == anyTypeIndex_) continue;
 		if (elem.value.getTag() == gason::JSON_OBJECT) {
-			if (descr.subElementsTable[subElemIndex->second].second.typeName != "any") {
-				err = checkScheme(elem, descr.subElementsTable[subElemIndex->second].second.typeIndex, path,
-								  descr.subElementsTable[subElemIndex->second].first);
-				if (!err.ok()) return err;
-			}
+			err = checkScheme(elem, subElement.second.typeIndex, path, subElement.first);
+			if (!err.ok()) return err;
 		} else if (elem.value.getTag() == gason::JSON_ARRAY) {
-			if (descr.subElementsTable[subElemIndex->second].second.typeName != "any") {
-				if (!descr.subElementsTable[subElemIndex->second].second.array) {
-					return Error(errParseJson, "Element [%s] should array in [%s].", elem.key, path);
-				}
-				for (auto entry : elem.value) {
-					if (entry->value.getTag() == gason::JSON_ARRAY || entry->value.getTag() == gason::JSON_OBJECT) {
-						err = checkScheme(*entry, descr.subElementsTable[subElemIndex->second].second.typeIndex, path,
-										  descr.subElementsTable[subElemIndex->second].first);
-						if (!err.ok()) return err;
-					}
+			if (!subElement.second.array) {
+				return Error(errParseJson, "Element [%s] should array in [%s].", elem.key, pathToString(path));
+			}
+			for (auto entry : elem.value) {
+				if (entry->value.getTag() == gason::JSON_ARRAY || entry->value.getTag() == gason::JSON_OBJECT) {
+					err = checkScheme(*entry, subElement.second.typeIndex, path, subElement.first);
+					if (!err.ok()) return err;
 				}
 			}
 		}
 	}
 	err = checkRequired(mmVals, typeIndex, path);
+	path.pop_back();
 	return err;
 }
 
-Error JsonSchemaChecker::checkExists(std::string_view name, ValAppearance* element, const std::string& path) {
+Error JsonSchemaChecker::checkExists(std::string_view name, ValAppearance* element, const PathStack& path) {
 	if (!element->notExist) {
-		return Error(errParseJson, "Key [%s] can occur only once in [%s] object.", std::string(name), path);
+		return Error(errParseJson, "Key [%s] can occur only once in [%s] object.", std::string(name), pathToString(path));
 	}
 	element->notExist = false;
 	element->required = false;
 	return Error();
 }
 
-Error JsonSchemaChecker::checkRequired(const h_vector<ValAppearance, 16>& elementAppearances, int typeNum, const std::string& path) {
+Error JsonSchemaChecker::checkRequired(const h_vector<ValAppearance, 16>& elementAppearances, int typeNum, const PathStack& path) {
 	for (unsigned int k = 0; k < elementAppearances.size(); k++) {
 		if (elementAppearances[k].required) {
-			return Error(errParseJson, "Key [%s] must occur in [%s] object.", typesTable_[typeNum].subElementsTable[k].first, path);
+			return Error(errParseJson, "Key [%s] must occur in [%s] object.", typesTable_[typeNum].subElementsTable[k].first,
+						 pathToString(path));
 		}
 	}
 	return Error();
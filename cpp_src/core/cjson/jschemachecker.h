@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include "core/schema.h"
 #include "estl/fast_hash_map.h"
+#include "estl/h_vector.h"
 #include "gason/gason.h"
 #include "tools/errors.h"
 
@@ -43,19 +44,25 @@ private:
 		std::vector<std::pair<std::string, SubElement>> subElementsTable;
 	};
 
-	Error checkScheme(const gason::JsonNode& node, int typeIndex, std::string& path, const std::string& elementName);
+	// Names of the nested objects from the root to the checked one. Path string is built only for the error message
+	using PathStack = h_vector<std::string_view, 16>;
+
+	Error checkScheme(const gason::JsonNode& node, int typeIndex, PathStack& path, std::string_view elementName);
 	std::string createType(const PrefixTree::PrefixTreeNode* node, const std::string& typeName = "");
 	Error createTypeTable(const std::string& json);
 	static bool isSimpleType(std::string_view tp);
 	void addSimpleType(std::string tpName);
-	Error checkExists(std::string_view name, ValAppearance* element, const std::string& path);
-	Error checkRequired(const h_vector<ValAppearance, 16>& elementAppearances, int typeNum, const std::string& path);
+	Error checkExists(std::string_view name, ValAppearance* element, const PathStack& path);
+	Error checkRequired(const h_vector<ValAppearance, 16>& elementAppearances, int typeNum, const PathStack& path);
+	static std::string pathToString(const PathStack& path);
 
 	Schema schema_;
 	std::vector<TypeDescr> typesTable_;
 	std::unordered_map<std::string, unsigned int> indexes_;
 	std::vector<std::vector<ValAppearance>> valAppearance_;
 	int typeIndex_ = 0;
+	int anyTypeIndex_ = -1;
+	int rootTypeIndex_ = -1;
 	std::string rootTypeName_;
 	bool isInit = false;
 };
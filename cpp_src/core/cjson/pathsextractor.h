@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/keyvalue/variant.h"
+#include "tagspath.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+class TagsMatcher;
+
+/// Builder, which extracts values of several tags paths by the single pass of BaseEncoder over the tuple.
+/// Values of each path are the same, as the ones extracted by FieldsExtractor for this path alone (without the type conversion),
+/// including the values nested deeper than the path. Arrays of values are not marked as objects
+class PathsExtractor {
+public:
+	PathsExtractor() = default;
+	PathsExtractor(const std::vector<TagsPath> *paths, std::vector<VariantArray> *values) noexcept : paths_(paths), values_(values) {}
+
+	void SetTagsMatcher(const TagsMatcher *) noexcept {}
+	void SetTagsPath(const TagsPath *tagsPath) noexcept { tagsPath_ = tagsPath; }
+
+	PathsExtractor Object(int) const noexcept { return nested(); }
+	PathsExtractor Object(std::string_view) const noexcept { return nested(); }
+	PathsExtractor Object(std::nullptr_t) const noexcept { return nested(); }
+	PathsExtractor Array(int) const noexcept { return nested(); }
+	PathsExtractor Array(std::string_view) const noexcept { return nested(); }
+
+	template <typename T>
+	void Array(int, span<T> data, int) {
+		for (auto d : data) Put(0, Variant(d));
+	}
+	void Array(int, Serializer &ser, int tagType, int count) {
+		for (int i = 0; i < count; ++i) Put(0, ser.GetRawVariant(KeyValueType(tagType)));
+	}
+
+	PathsExtractor &Put(int, const Variant &arg) {
+		if (!paths_) return *this;
+		for (size_t i = 0; i < paths_->size(); ++i) {
+			const TagsPath &path = (*paths_)[i];
+			if (depth_ < path.size() || !isPrefix(path)) continue;
+			(*values_)[i].push_back(arg);
+		}
+		return *this;
+	}
+
+	PathsExtractor &Null(int) noexcept { return *this; }
+
+private:
+	PathsExtractor nested() const noexcept {
+		PathsExtractor res(paths_, values_);
+		res.tagsPath_ = tagsPath_;
+		res.depth_ = depth_ + 1;
+		return res;
+	}
+	// Current path and the requested one match the same way, as the filter of encoder matches them
+	bool isPrefix(const TagsPath &path) const noexcept {
+		const size_t count = std::min(path.size(), tagsPath_->size());
+		for (size_t i = 0; i < count; ++i) {
+			if (path[i] != (*tagsPath_)[i]) return false;
+		}
+		return true;
+	}
+
+	const std::vector<TagsPath> *paths_ = nullptr;
+	std::vector<VariantArray> *values_ = nullptr;
+	const TagsPath *tagsPath_ = nullptr;
+	// Count of the objects and arrays, which enclose the current value (including the root object)
+	size_t depth_ = 0;
+};
+
+}  // namespace reindexer
@@ -5,7 +5,18 @@ namespace reindexer {
 
 ProtobufBuilder::ProtobufBuilder(WrSerializer* wrser, ObjType type, const Schema* schema, const TagsMatcher* tm, const TagsPath* tagsPath,
 								 int fieldIdx)
-	: type_(type), ser_(wrser), tm_(tm), tagsPath_(tagsPath), schema_(schema), sizeHelper_(), itemsFieldIndex_(fieldIdx) {
+	: ProtobufBuilder(schema ? &schema->GetFieldTypesTree() : nullptr, wrser, type, schema, tm, tagsPath, fieldIdx) {}
+
+ProtobufBuilder::ProtobufBuilder(const SchemaFieldTypesNode* typesNode, WrSerializer* wrser, ObjType type, const Schema* schema,
+								 const TagsMatcher* tm, const TagsPath* tagsPath, int fieldIdx)
+	: type_(type),
+	  ser_(wrser),
+	  tm_(tm),
+	  tagsPath_(tagsPath),
+	  schema_(schema),
+	  typesNode_(typesNode),
+	  sizeHelper_(),
+	  itemsFieldIndex_(fieldIdx) {
 	switch (type_) {
 		case ObjType::TypeArray:
 		case ObjType::TypeObject:
@@ -65,13 +76,18 @@ int ProtobufBuilder::getFieldTag(int fieldIdx) const {
 	return fieldIdx;
 }
 
-bool ProtobufBuilder::getExpectedFieldType(KeyValueType& expectedType) {
-	if (schema_ && tagsPath_) {
-		bool isArray = false;
-		expectedType = schema_->GetFieldType(*tagsPath_, isArray);
-		if (expectedType != KeyValueUndefined) {
-			return true;
-		}
+const SchemaFieldTypesNode* ProtobufBuilder::childTypesNode(int fieldIdx) const noexcept {
+	if (!typesNode_) return nullptr;
+	// Items of arrays have the type of the array field itself
+	if (type_ == ObjType::TypeArray || type_ == ObjType::TypeObjectArray) return typesNode_;
+	return typesNode_->Child(fieldIdx);
+}
+
+bool ProtobufBuilder::getExpectedFieldType(int fieldIdx, KeyValueType& expectedType) const noexcept {
+	const SchemaFieldTypesNode* node = childTypesNode(fieldIdx);
+	if (node && node->type.type_ != KeyValueUndefined) {
+		expectedType = node->type.type_;
+		return true;
 	}
 	return false;
 }
@@ -82,7 +98,7 @@ void ProtobufBuilder::put(int fieldIdx, bool val) { return put(fieldIdx, int(val
 
 void ProtobufBuilder::put(int fieldIdx, int val) {
 	KeyValueType expectedType;
-	if (getExpectedFieldType(expectedType)) {
+	if (getExpectedFieldType(fieldIdx, expectedType)) {
 		switch (expectedType) {
 			case KeyValueInt:
 			case KeyValueBool:
@@ -103,7 +119,7 @@ void ProtobufBuilder::put(int fieldIdx, int val) {
 
 void ProtobufBuilder::put(int fieldIdx, int64_t val) {
 	KeyValueType expectedType;
-	if (getExpectedFieldType(expectedType)) {
+	if (getExpectedFieldType(fieldIdx, expectedType)) {
 		switch (expectedType) {
 			case KeyValueInt64:
 				break;
@@ -124,7 +140,7 @@ void ProtobufBuilder::put(int fieldIdx, int64_t val) {
 
 void ProtobufBuilder::put(int fieldIdx, double val) {
 	KeyValueType expectedType;
-	if (getExpectedFieldType(expectedType)) {
+	if (getExpectedFieldType(fieldIdx, expectedType)) {
 		switch (expectedType) {
 			case KeyValueDouble:
 				break;
@@ -146,7 +162,7 @@ void ProtobufBuilder::put(int fieldIdx, double val) {
 
 void ProtobufBuilder::put(int fieldIdx, std::string_view val) {
 	KeyValueType expectedType;
-	if (getExpectedFieldType(expectedType)) {
+	if (getExpectedFieldType(fieldIdx, expectedType)) {
 		if (expectedType != KeyValueString) {
 			throw Error(errParams, "Expected type 'String' for field '%s'", tm_->tag2name(fieldIdx));
 		}
@@ -194,7 +210,7 @@ ProtobufBuilder ProtobufBuilder::Object(int fieldIdx, int) {
 	if (type_ == ObjType::TypePlain && fieldIdx == 0) {
 		return ProtobufBuilder(std::move(*this));
 	}
-	return ProtobufBuilder(ser_, ObjType::TypeObject, schema_, tm_, tagsPath_, getFieldTag(fieldIdx));
+	return ProtobufBuilder(childTypesNode(fieldIdx), ser_, ObjType::TypeObject, schema_, tm_, tagsPath_, getFieldTag(fieldIdx));
 }
 
 }  // namespace reindexer
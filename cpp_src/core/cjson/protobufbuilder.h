@@ -12,6 +12,7 @@ namespace reindexer {
 
 class Schema;
 class TagsMatcher;
+struct SchemaFieldTypesNode;
 
 const int kNameBit = 0x3;
 const int kTypeMask = 0x7;
@@ -31,6 +32,7 @@ public:
 		  tm_(nullptr),
 		  tagsPath_(nullptr),
 		  schema_(nullptr),
+		  typesNode_(nullptr),
 		  sizeHelper_(),
 		  itemsFieldIndex_(-1) {}
 	ProtobufBuilder(WrSerializer* wrser, ObjType type = ObjType::TypePlain, const Schema* schema = nullptr, const TagsMatcher* tm = nullptr,
@@ -41,6 +43,7 @@ public:
 		  tm_(obj.tm_),
 		  tagsPath_(obj.tagsPath_),
 		  schema_(obj.schema_),
+		  typesNode_(obj.typesNode_),
 		  sizeHelper_(std::move(obj.sizeHelper_)),
 		  itemsFieldIndex_(obj.itemsFieldIndex_) {}
 	ProtobufBuilder(const ProtobufBuilder&) = delete;
@@ -87,12 +90,12 @@ public:
 
 	ProtobufBuilder ArrayNotPacked(int fieldIdx) {
 		assertrx(type_ != ObjType::TypeArray && type_ != ObjType::TypeObjectArray);
-		return ProtobufBuilder(ser_, ObjType::TypeObjectArray, schema_, tm_, tagsPath_, fieldIdx);
+		return ProtobufBuilder(childTypesNode(fieldIdx), ser_, ObjType::TypeObjectArray, schema_, tm_, tagsPath_, fieldIdx);
 	}
 
 	ProtobufBuilder ArrayPacked(int fieldIdx) {
 		assertrx(type_ != ObjType::TypeArray && type_ != ObjType::TypeObjectArray);
-		return ProtobufBuilder(ser_, ObjType::TypeArray, schema_, tm_, tagsPath_, fieldIdx);
+		return ProtobufBuilder(childTypesNode(fieldIdx), ser_, ObjType::TypeArray, schema_, tm_, tagsPath_, fieldIdx);
 	}
 
 	ProtobufBuilder Array(std::string_view tagName, int size = KUnknownFieldSize) { return Array(tm_->name2tag(tagName), size); }
@@ -115,7 +118,10 @@ public:
 	void End();
 
 private:
-	bool getExpectedFieldType(KeyValueType& expectedType);
+	ProtobufBuilder(const SchemaFieldTypesNode* typesNode, WrSerializer* wrser, ObjType type, const Schema* schema, const TagsMatcher* tm,
+					const TagsPath* tagsPath, int tagName);
+	const SchemaFieldTypesNode* childTypesNode(int fieldIdx) const noexcept;
+	bool getExpectedFieldType(int fieldIdx, KeyValueType& expectedType) const noexcept;
 	void checkIfInconvertibleType(int field, KeyValueType type, KeyValueType first, KeyValueType second);
 	void put(int fieldIdx, bool val);
 	void put(int fieldIdx, int val);
@@ -129,6 +135,8 @@ private:
 	const TagsMatcher* tm_;
 	const TagsPath* tagsPath_;
 	const Schema* schema_;
+	// Node of the schema types for this object or array
+	const SchemaFieldTypesNode* typesNode_;
 	WrSerializer::VStringHelper sizeHelper_;
 	int itemsFieldIndex_;
 
@@ -1,6 +1,5 @@
 #include "protobufdecoder.h"
 #include "core/schema.h"
-#include "estl/protobufparser.h"
 #include "protobufbuilder.h"
 
 namespace reindexer {
@@ -46,115 +45,184 @@ void ArraysStorage::onObjectBuilt(CJsonBuilder& parent) {
 ProtobufDecoder::ProtobufDecoder(TagsMatcher& tagsMatcher, std::shared_ptr<const Schema> schema)
 	: tm_(tagsMatcher), schema_(schema), arraysStorage_(tm_) {}
 
-void ProtobufDecoder::setValue(Payload* pl, CJsonBuilder& builder, const ProtobufValue& item) {
+constexpr int kVarintsBatchSize = 64;
+
+static int packedArraySize(std::string_view buf, KeyValueType itemType) {
+	switch (itemType) {
+		case KeyValueDouble:
+			return buf.size() / sizeof(double);
+		case KeyValueInt:
+		case KeyValueInt64:
+		case KeyValueBool:
+			// Each varint ends with the byte without the continuation bit
+			return std::count_if(buf.begin(), buf.end(), [](char c) { return !(uint8_t(c) & 0x80); });
+		default:
+			throw Error(errParseProtobuf, "Error parsing packed indexed array: unexpected type [%d]", itemType);
+	}
+}
+
+static Variant varintValue(uint64_t value, KeyValueType itemType) {
+	switch (itemType) {
+		case KeyValueBool:
+			return Variant(bool(value));
+		case KeyValueInt:
+			return Variant(int(value));
+		case KeyValueInt64:
+			return Variant(int64_t(value));
+		default:
+			return std::move(Variant(int64_t(value)).convert(itemType));
+	}
+}
+
+template <typename Fn>
+void ProtobufDecoder::readPackedArray(std::string_view buf, KeyValueType itemType, Fn&& fn) {
+	const int count = packedArraySize(buf, itemType);
+	Serializer rdser(buf);
+	if (itemType == KeyValueDouble) {
+		for (int i = 0; i < count; ++i) fn(i, rdser.GetDouble());
+		return;
+	}
+	uint64_t values[kVarintsBatchSize];
+	for (int i = 0; i < count;) {
+		const int batchSize = std::min(count - i, kVarintsBatchSize);
+		rdser.GetVarUints(span<uint64_t>(values, batchSize));
+		for (int j = 0; j < batchSize; ++j, ++i) {
+			switch (itemType) {
+				case KeyValueInt:
+					fn(i, int(values[j]));
+					break;
+				case KeyValueBool:
+					fn(i, bool(values[j]));
+					break;
+				default:
+					fn(i, int64_t(values[j]));
+			}
+		}
+	}
+}
+
+void ProtobufDecoder::setValue(Payload* pl, CJsonBuilder& builder, int tagName, bool isArray, const Variant& value) {
 	int field = tm_.tags2field(tagsPath_.data(), tagsPath_.size());
-	item.value.convert(item.itemType);
 	if (field > 0) {
-		pl->Set(field, {item.value}, true);
-		if (item.isArray) {
-			arraysStorage_.UpdateArraySize(item.tagName, field);
+		pl->Set(field, {value}, true);
+		if (isArray) {
+			arraysStorage_.UpdateArraySize(tagName, field);
 		} else {
-			builder.Ref(item.tagName, item.value, field);
+			builder.Ref(tagName, value, field);
 		}
 	} else {
-		if (item.isArray) {
-			auto& array = arraysStorage_.GetArray(item.tagName);
-			array.Put(0, item.value);
+		if (isArray) {
+			auto& array = arraysStorage_.GetArray(tagName);
+			array.Put(0, value);
 		} else {
-			builder.Put(item.tagName, item.value);
+			builder.Put(tagName, value);
 		}
 	}
 }
 
-Error ProtobufDecoder::decodeArray(Payload* pl, CJsonBuilder& builder, const ProtobufValue& item) {
-	ProtobufObject object(item.As<std::string_view>(), *schema_, tagsPath_, tm_);
-	ProtobufParser parser(object);
-	bool packed = item.IsOfPrimitiveType();
+void ProtobufDecoder::decodePackedArray(Payload* pl, CJsonBuilder& builder, std::string_view buf, int tagName, KeyValueType itemType) {
 	int field = tm_.tags2field(tagsPath_.data(), tagsPath_.size());
 	if (field > 0) {
-		if (packed) {
-			int count = 0;
-			while (!parser.IsEof()) {
-				pl->Set(field, {parser.ReadArrayItem(item.itemType)}, true);
+		int count = 0;
+		if (pl->Type().Field(field).IsArray()) {
+			const int offset = pl->ResizeArray(field, packedArraySize(buf, itemType), true);
+			readPackedArray(buf, itemType, [&](int i, auto value) {
+				pl->Set(field, offset + i, Variant(value));
 				++count;
-			}
-			builder.ArrayRef(item.tagName, field, count);
+			});
 		} else {
-			setValue(pl, builder, item);
+			readPackedArray(buf, itemType, [&](int, auto value) {
+				pl->Set(field, {Variant(value)}, true);
+				++count;
+			});
 		}
+		builder.ArrayRef(tagName, field, count);
 	} else {
-		CJsonBuilder& array = arraysStorage_.GetArray(item.tagName);
-		if (packed) {
-			while (!parser.IsEof()) {
-				array.Put(0, parser.ReadArrayItem(item.itemType));
-			}
-		} else {
-			if (item.itemType == KeyValueComposite) {
-				Error status{errOK};
-				CJsonProtobufObjectBuilder obj(array, 0, arraysStorage_);
-				while (status.ok() && !parser.IsEof()) {
-					status = decode(pl, obj, parser.ReadValue());
-				}
-			} else {
-				setValue(pl, array, item);
+		CJsonBuilder& array = arraysStorage_.GetArray(tagName);
+		readPackedArray(buf, itemType, [&array](int, auto value) { array.Put(0, value); });
+	}
+}
+
+void ProtobufDecoder::decodeLengthEncoded(Payload* pl, CJsonBuilder& builder, p_string value, int tagName,
+										  const SchemaFieldTypesNode& fieldNode) {
+	const KeyValueType itemType = fieldNode.type.type_;
+	if (fieldNode.type.isArray_) {
+		switch (itemType) {
+			case KeyValueInt:
+			case KeyValueInt64:
+			case KeyValueDouble:
+			case KeyValueBool:
+				decodePackedArray(pl, builder, value, tagName, itemType);
+				return;
+			case KeyValueComposite: {
+				CJsonProtobufObjectBuilder obj(arraysStorage_.GetArray(tagName), 0, arraysStorage_);
+				decodeObject(pl, obj, value, fieldNode);
+				return;
 			}
+			default:
+				setValue(pl, builder, tagName, true, std::move(Variant(value).convert(itemType)));
+				return;
 		}
 	}
-	return errOK;
+	switch (itemType) {
+		case KeyValueString:
+			setValue(pl, builder, tagName, false, std::move(Variant(value).convert(itemType)));
+			break;
+		case KeyValueComposite: {
+			CJsonProtobufObjectBuilder obj(builder, tagName, arraysStorage_);
+			decodeObject(pl, obj, value, fieldNode);
+			break;
+		}
+		default:
+			throw Error(errParseProtobuf, "Error parsing length-encoded type: [%s] for field [%s]", Variant::TypeName(itemType),
+						tm_.tag2name(tagName));
+	}
 }
 
-Error ProtobufDecoder::decode(Payload* pl, CJsonBuilder& builder, const ProtobufValue& item) {
-	TagsPathScope<TagsPath> tagScope(tagsPath_, item.tagName);
-	Error status;
-	switch (item.value.Type()) {
-		case KeyValueInt:
-		case KeyValueInt64:
-		case KeyValueDouble:
-		case KeyValueBool:
-			setValue(pl, builder, item);
+void ProtobufDecoder::decodeField(Payload* pl, CJsonBuilder& builder, Serializer& rdser, const SchemaFieldTypesNode& typesNode) {
+	const auto tag = rdser.GetVarUint();
+	const int tagType = (tag & kTypeMask);
+	const int tagName = (tag >> kNameBit);
+	const SchemaFieldTypesNode* fieldNode = typesNode.Child(tagName);
+	if (!fieldNode || fieldNode->type.type_ == KeyValueUndefined) {
+		throw Error(errParseProtobuf, "Field [%d] type is unknown: [%d]", tagName, KeyValueUndefined);
+	}
+	const KeyValueType itemType = fieldNode->type.type_;
+	const bool isArray = fieldNode->type.isArray_;
+
+	TagsPathScope<TagsPath> tagScope(tagsPath_, tagName);
+	switch (tagType) {
+		case PBUF_TYPE_VARINT:
+			setValue(pl, builder, tagName, isArray, varintValue(rdser.GetVarUint(), itemType));
 			break;
-		case KeyValueString: {
-			if (item.isArray) {
-				status = decodeArray(pl, builder, item);
-			} else {
-				switch (item.itemType) {
-					case KeyValueString:
-						setValue(pl, builder, item);
-						break;
-					case KeyValueComposite: {
-						CJsonProtobufObjectBuilder objBuilder(builder, item.tagName, arraysStorage_);
-						ProtobufObject object(item.As<std::string_view>(), *schema_, tagsPath_, tm_);
-						status = decodeObject(pl, objBuilder, object);
-						break;
-					}
-					default:
-						return Error(errParseProtobuf, "Error parsing length-encoded type: [%s] for field [%s]",
-									 Variant::TypeName(item.itemType), tm_.tag2name(item.tagName));
-				}
-			}
+		case PBUF_TYPE_FLOAT32:
+		case PBUF_TYPE_FLOAT64: {
+			Variant value(rdser.GetDouble());
+			if (itemType != KeyValueDouble) value.convert(itemType);
+			setValue(pl, builder, tagName, isArray, value);
 			break;
 		}
+		case PBUF_TYPE_LENGTHENCODED:
+			decodeLengthEncoded(pl, builder, rdser.GetPVString(), tagName, *fieldNode);
+			break;
 		default:
-			return Error(errParseProtobuf, "Unknown field type [%s] while parsing Protobuf", Variant::TypeName(item.value.Type()));
+			throw Error(errParseProtobuf, "Type [%d] unexpected while decoding Protobuf", tagType);
 	}
-	return status;
 }
 
-Error ProtobufDecoder::decodeObject(Payload* pl, CJsonBuilder& builder, ProtobufObject& object) {
-	Error status{errOK};
-	ProtobufParser parser(object);
-	while (status.ok() && !parser.IsEof()) {
-		status = decode(pl, builder, parser.ReadValue());
+void ProtobufDecoder::decodeObject(Payload* pl, CJsonBuilder& builder, std::string_view buf, const SchemaFieldTypesNode& typesNode) {
+	Serializer rdser(buf);
+	while (rdser.Pos() < rdser.Len()) {
+		decodeField(pl, builder, rdser, typesNode);
 	}
-	return status;
 }
 
 Error ProtobufDecoder::Decode(std::string_view buf, Payload* pl, WrSerializer& wrser) {
 	try {
 		tagsPath_.clear();
 		CJsonProtobufObjectBuilder cjsonBuilder(arraysStorage_, wrser, &tm_, 0);
-		ProtobufObject object(buf, *schema_, tagsPath_, tm_);
-		return decodeObject(pl, cjsonBuilder, object);
+		decodeObject(pl, cjsonBuilder, buf, schema_->GetFieldTypesTree());
+		return errOK;
 	} catch (Error& err) {
 		return err;
 	}
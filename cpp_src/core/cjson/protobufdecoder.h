@@ -7,8 +7,8 @@
 namespace reindexer {
 
 class Schema;
-struct ProtobufValue;
-struct ProtobufObject;
+class Serializer;
+struct SchemaFieldTypesNode;
 
 class ArraysStorage {
 public:
@@ -66,6 +66,8 @@ private:
 	ArraysStorage& arraysStorage_;
 };
 
+/// Decodes the protobuf message in the single pass. Types of the fields are resolved by the tree of the schema types, values are read
+/// from the wire directly into the payload and into the CJSON tuple, and the packed repeated fields are decoded by the batches
 class ProtobufDecoder {
 public:
 	ProtobufDecoder(TagsMatcher& tagsMatcher, std::shared_ptr<const Schema> schema);
@@ -77,10 +79,13 @@ public:
 	Error Decode(std::string_view buf, Payload* pl, WrSerializer& wrser);
 
 private:
-	void setValue(Payload* pl, CJsonBuilder& builder, const ProtobufValue& item);
-	Error decode(Payload* pl, CJsonBuilder& builder, const ProtobufValue& val);
-	Error decodeObject(Payload* pl, CJsonBuilder& builder, ProtobufObject& object);
-	Error decodeArray(Payload* pl, CJsonBuilder& builder, const ProtobufValue& val);
+	void setValue(Payload* pl, CJsonBuilder& builder, int tagName, bool isArray, const Variant& value);
+	void decodeObject(Payload* pl, CJsonBuilder& builder, std::string_view buf, const SchemaFieldTypesNode& typesNode);
+	void decodeField(Payload* pl, CJsonBuilder& builder, Serializer& rdser, const SchemaFieldTypesNode& typesNode);
+	void decodeLengthEncoded(Payload* pl, CJsonBuilder& builder, p_string value, int tagName, const SchemaFieldTypesNode& fieldNode);
+	void decodePackedArray(Payload* pl, CJsonBuilder& builder, std::string_view buf, int tagName, KeyValueType itemType);
+	template <typename Fn>
+	static void readPackedArray(std::string_view buf, KeyValueType itemType, Fn&& fn);
 
 	TagsMatcher& tm_;
 	std::shared_ptr<const Schema> schema_;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdlib>
+#include <memory>
 #include <string>
 
 #include "core/keyvalue/key_string.h"
@@ -14,8 +15,18 @@
 
 namespace reindexer {
 
+/// Immutable part of the tags dictionary. It is shared by the copies of the matcher, so the copy on write of the matcher copies only
+/// the tags, added after the last compaction
+struct TagsDictionary {
+	fast_hash_map<string, int, hash_str, equal_str> names2tags;
+	vector<string> tags2names;
+};
+
 class TagsMatcherImpl {
 public:
+	// Count of the own tags of matcher, after which they are moved to the new shared dictionary
+	static constexpr size_t kMaxOwnTags = 256;
+
 	TagsMatcherImpl() : version_(0), stateToken_(rand()) {}
 	TagsMatcherImpl(PayloadType payloadType) : payloadType_(payloadType), version_(0), stateToken_(rand()) {}
 	~TagsMatcherImpl() {}
@@ -106,6 +117,10 @@ public:
 	}
 
 	int name2tag(std::string_view name) const {
+		if (dict_) {
+			auto res = dict_->names2tags.find(name);
+			if (res != dict_->names2tags.end()) return res->second + 1;
+		}
 		auto res = names2tags_.find(name);
 		return (res == names2tags_.end()) ? 0 : res->second + 1;
 	}
@@ -114,14 +129,12 @@ public:
 		int tag = name2tag(n);
 		if (tag || !canAdd) return tag;
 
-		string name(n);
-		auto res = names2tags_.emplace(name, tags2names_.size());
-		if (res.second) {
-			tags2names_.emplace_back(std::move(name));
-			version_++;
-		}
-		updated |= res.second;
-		return res.first->second + 1;
+		tag = size();
+		addTag(string(n), tag);
+		version_++;
+		updated = true;
+		compactIfNeeded();
+		return tag + 1;
 	}
 
 	const string &tag2name(int tag) const {
@@ -129,11 +142,11 @@ public:
 		static string emptystr;
 		if (tag == 0) return emptystr;
 
-		if (tag - 1 >= int(tags2names_.size())) {
+		if (tag - 1 >= int(size())) {
 			throw Error(errTagsMissmatch, "Unknown tag %d in cjson", tag);
 		}
 
-		return tags2names_[tag - 1];
+		return (tag - 1 < int(dictSize())) ? dict_->tags2names[tag - 1] : tags2names_[tag - 1 - dictSize()];
 	}
 
 	int tags2field(const int16_t *path, size_t pathLen) const {
@@ -164,19 +177,21 @@ public:
 	}
 
 	void serialize(WrSerializer &ser) const {
-		ser.PutVarUint(tags2names_.size());
-		for (size_t tag = 0; tag < tags2names_.size(); ++tag) ser.PutVString(tags2names_[tag]);
+		ser.PutVarUint(size());
+		for (size_t tag = 1; tag <= size(); ++tag) ser.PutVString(tag2name(tag));
 	}
 
 	void deserialize(Serializer &ser) {
 		clear();
 		size_t cnt = ser.GetVarUint();
-		tags2names_.resize(cnt);
-		for (size_t tag = 0; tag < tags2names_.size(); ++tag) {
+		auto dict = std::make_shared<TagsDictionary>();
+		dict->tags2names.resize(cnt);
+		for (size_t tag = 0; tag < cnt; ++tag) {
 			string name(ser.GetVString());
-			names2tags_.emplace(name, tag);
-			tags2names_[tag] = name;
+			dict->names2tags.emplace(name, tag);
+			dict->tags2names[tag] = std::move(name);
 		}
+		dict_ = std::move(dict);
 		version_++;
 		// assert(ser.Eof());
 	}
@@ -187,37 +202,33 @@ public:
 	}
 
 	bool merge(const TagsMatcherImpl &tm) {
-		auto sz = tm.names2tags_.size();
-		auto oldSz = size();
-
-		if (tags2names_.size() < sz) tags2names_.resize(sz);
-
-		auto it = tm.names2tags_.begin();
-		auto end = tm.names2tags_.end();
-		for (; it != end; ++it) {
-			auto r = names2tags_.emplace(it->first, it->second);
-			if (!r.second && r.first->second != it->second) {
-				// name conflict
-				return false;
-			}
-			if (r.second && it->second < int(oldSz)) {
-				// tag conflict
-				return false;
-			}
+		const size_t sz = tm.size();
+		const size_t oldSz = size();
 
-			tags2names_[it->second] = it->first;
+		// Common tags are the same. The tags of the shared dictionary are not compared
+		const size_t commonDictSize = (dict_ == tm.dict_) ? dictSize() : 0;
+		for (size_t tag = commonDictSize + 1, end = std::min(sz, oldSz); tag <= end; ++tag) {
+			if (tag2name(tag) != tm.tag2name(tag)) return false;
+		}
+		for (size_t tag = oldSz + 1; tag <= sz; ++tag) {
+			const string &name = tm.tag2name(tag);
+			// name conflict
+			if (name2tag(name)) return false;
+			addTag(name, tag - 1);
 		}
+		compactIfNeeded();
 
 		version_ = std::max(version_, tm.version_) + 1;
 
 		return true;
 	}
 
-	size_t size() const { return tags2names_.size(); }
+	size_t size() const { return dictSize() + tags2names_.size(); }
 	int version() const { return version_; }
 	int stateToken() const { return stateToken_; }
 
 	void clear() {
+		dict_.reset();
 		names2tags_.clear();
 		tags2names_.clear();
 		pathCache_.clear();
@@ -225,8 +236,8 @@ public:
 	}
 	string dumpTags() const {
 		string res = "tags: [";
-		for (unsigned i = 0; i < tags2names_.size(); i++) {
-			res += std::to_string(i) + ":" + tags2names_[i] + " ";
+		for (unsigned i = 0; i < size(); i++) {
+			res += std::to_string(i) + ":" + tag2name(i + 1) + " ";
 		}
 		return res + "]";
 	}
@@ -245,6 +256,27 @@ public:
 	}
 
 protected:
+	size_t dictSize() const noexcept { return dict_ ? dict_->tags2names.size() : 0; }
+	void addTag(string name, int tag) {
+		names2tags_.emplace(name, tag);
+		tags2names_.emplace_back(std::move(name));
+	}
+	// Moves own tags to the new shared dictionary, so they are not copied by the next copies of matcher
+	void compactIfNeeded() {
+		if (tags2names_.size() < kMaxOwnTags) return;
+		auto dict = dict_ ? std::make_shared<TagsDictionary>(*dict_) : std::make_shared<TagsDictionary>();
+		dict->tags2names.reserve(dict->tags2names.size() + tags2names_.size());
+		for (auto &name : tags2names_) {
+			dict->names2tags.emplace(name, int(dict->tags2names.size()));
+			dict->tags2names.emplace_back(std::move(name));
+		}
+		dict_ = std::move(dict);
+		names2tags_.clear();
+		tags2names_.clear();
+	}
+
+	std::shared_ptr<const TagsDictionary> dict_;
+	// Tags, added after the last compaction. Their numbers follow the numbers of the shared dictionary tags
 	fast_hash_map<string, int, hash_str, equal_str> names2tags_;
 	vector<string> tags2names_;
 	PayloadType payloadType_;
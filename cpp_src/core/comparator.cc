@@ -1,8 +1,30 @@
 #include "core/comparator.h"
+#include "core/comparatorkernels.h"
+#include "core/namespace/nsitems.h"
 #include "core/payload/payloadiface.h"
 
 namespace reindexer {
 
+template <typename T>
+static void compareFieldBlock(const ComparatorVars &vars, const ComparatorImpl<T> &impl, const NsItems &items, const IdType *ids,
+							  size_t count, uint64_t *mask) {
+	// Values are gathered into the small contiguous buffer to be loaded by vector instructions
+	constexpr size_t kChunkSize = 256;
+	T values[kChunkSize];
+	const T rhs1 = impl.values_[0];
+	const T rhs2 = (vars.cond_ == CondRange) ? impl.values_[1] : rhs1;
+	for (size_t done = 0; done < count; done += kChunkSize) {
+		const size_t n = std::min(kChunkSize, count - done);
+		const IdType *chunkIds = ids + done;
+		if (vars.rawData_) {
+			for (size_t i = 0; i < n; ++i) values[i] = *reinterpret_cast<const T *>(vars.rawData_ + chunkIds[i] * vars.sizeof_);
+		} else {
+			for (size_t i = 0; i < n; ++i) values[i] = *reinterpret_cast<const T *>(items[chunkIds[i]].Ptr() + vars.offset_);
+		}
+		CompareBlock(vars.cond_, values, n, rhs1, rhs2, mask + done / 64);
+	}
+}
+
 Comparator::Comparator() {}
 Comparator::~Comparator() {}
 
@@ -16,6 +38,7 @@ Comparator::Comparator(CondType cond, KeyValueType type, const VariantArray &val
 	  cmpString(distinct),
 	  cmpGeom(distinct) {
 	if (type == KeyValueComposite) assertrx(fields_.size() > 0);
+	if (cond_ == CondKnn) throw Error(errQueryExec, "Condition KNN is supported only by hnsw indexes");
 	if (cond_ == CondEq && values.size() != 1) cond_ = CondSet;
 	if (cond_ == CondAllSet && values.size() == 1) cond_ = CondEq;
 	if (cond_ == CondDWithin) {
@@ -85,34 +108,47 @@ bool Comparator::isNumericComparison(const VariantArray &values) const {
 	return ((valuesType_ != keyType) && (valuesType_ == KeyValueString || keyType == KeyValueString));
 }
 
-bool Comparator::Compare(const PayloadValue &data, int rowId) {
+bool Comparator::compareJsonPathValues(const VariantArray &rhs) {
+	if (isNumericComparison(rhs)) {
+		// Numeric comparison is not allowed
+		return false;
+	}
+	switch (cond_) {
+		case CondEmpty:
+			return rhs.empty() || rhs[0].Type() == KeyValueNull;
+		case CondDWithin:
+			return cmpGeom.Compare(static_cast<Point>(rhs));
+		case CondAllSet:
+			clearAllSetValues();
+			break;
+		case CondAny:
+			if (rhs.empty() || rhs[0].Type() == KeyValueNull) return false;
+			break;
+		default:
+			break;
+	}
+	for (const Variant &kr : rhs) {
+		if (compare(kr)) return true;
+	}
+	return false;
+}
+
+bool Comparator::Compare(const PayloadValue &data, int rowId, JsonPathsValues &jsonValues) {
 	if (cmpEqualPosition.IsBinded()) {
 		return cmpEqualPosition.Compare(data, *this);
 	}
 	if (fields_.getTagsPathsLength() > 0) {
+		if (const VariantArray *values = jsonValues.Get(fields_.getTagsPath(0), payloadType_, data)) {
+			if (type_ == KeyValueUndefined || type_ == KeyValueComposite) return compareJsonPathValues(*values);
+			// Values are converted to the type of the sparse index the same way, as they are converted by the extraction of field
+			VariantArray rhs;
+			rhs.reserve(values->size());
+			for (const Variant &v : *values) rhs.emplace_back(v.convert(type_));
+			return compareJsonPathValues(rhs);
+		}
 		VariantArray rhs;
 		ConstPayload(payloadType_, data).GetByJsonPath(fields_.getTagsPath(0), rhs, type_);
-		if (isNumericComparison(rhs)) {
-			// Numeric comparison is not allowed
-			return false;
-		}
-		switch (cond_) {
-			case CondEmpty:
-				return rhs.empty() || rhs[0].Type() == KeyValueNull;
-			case CondDWithin:
-				return cmpGeom.Compare(static_cast<Point>(rhs));
-			case CondAllSet:
-				clearAllSetValues();
-				break;
-			case CondAny:
-				if (rhs.empty() || rhs[0].Type() == KeyValueNull) return false;
-				break;
-			default:
-				break;
-		}
-		for (const Variant &kr : rhs) {
-			if (compare(kr)) return true;
-		}
+		return compareJsonPathValues(rhs);
 	} else {
 		if (cond_ == CondAllSet) clearIndividualAllSetValues();
 		// Comparing field from payload by offset (fast path)
@@ -152,6 +188,34 @@ bool Comparator::Compare(const PayloadValue &data, int rowId) {
 	return false;
 }
 
+bool Comparator::IsBlockComparable() const noexcept {
+	if (isArray_ || cmpEqualPosition.IsBinded() || fields_.getTagsPathsLength() > 0 || !IsBlockComparableCond(cond_)) return false;
+	const size_t valuesCount = (cond_ == CondRange) ? 2 : 1;
+	switch (type_) {
+		case KeyValueInt:
+			return !cmpInt.distS_ && cmpInt.values_.size() >= valuesCount;
+		case KeyValueInt64:
+			return !cmpInt64.distS_ && cmpInt64.values_.size() >= valuesCount;
+		case KeyValueDouble:
+			return !cmpDouble.distS_ && cmpDouble.values_.size() >= valuesCount;
+		default:
+			return false;
+	}
+}
+
+void Comparator::CompareBlock(const NsItems &items, const IdType *ids, size_t count, uint64_t *mask) {
+	switch (type_) {
+		case KeyValueInt:
+			return compareFieldBlock(*this, cmpInt, items, ids, count, mask);
+		case KeyValueInt64:
+			return compareFieldBlock(*this, cmpInt64, items, ids, count, mask);
+		case KeyValueDouble:
+			return compareFieldBlock(*this, cmpDouble, items, ids, count, mask);
+		default:
+			abort();
+	}
+}
+
 void Comparator::ExcludeDistinct(const PayloadValue &data, int rowId) {
 	assertrx(!cmpEqualPosition.IsBinded());
 	if (fields_.getTagsPathsLength() > 0) {
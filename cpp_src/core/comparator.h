@@ -2,9 +2,12 @@
 
 #include "comparatorimpl.h"
 #include "compositearraycomparator.h"
+#include "core/nsselecter/jsonpathsvalues.h"
 
 namespace reindexer {
 
+class NsItems;
+
 class Comparator : public ComparatorVars {
 public:
 	Comparator();
@@ -12,7 +15,17 @@ public:
 			   const FieldsSet &fields, void *rawData = nullptr, const CollateOpts &collateOpts = CollateOpts());
 	~Comparator();
 
-	bool Compare(const PayloadValue &lhs, int rowId);
+	bool Compare(const PayloadValue &lhs, int rowId, JsonPathsValues &jsonValues);
+	/// @return tags path of the non-indexed (or sparse) field, which values are extracted from the tuple, or nullptr
+	const TagsPath *JsonPath() const noexcept {
+		return (fields_.getTagsPathsLength() > 0 && !cmpEqualPosition.IsBinded()) ? &fields_.getTagsPath(0) : nullptr;
+	}
+	/// Checks, if comparator may be evaluated by CompareBlock:
+	/// scalar int, int64 or double field by offset with simple condition and without distinct, equal positions and json paths
+	bool IsBlockComparable() const noexcept;
+	/// Compares field of the rows items[ids[i]] for each i in [0, count). Sets bit 'i' of 'mask' if the row satisfies condition
+	/// @param mask - output bitmask, must have room for (count + 63) / 64 words
+	void CompareBlock(const NsItems &items, const IdType *ids, size_t count, uint64_t *mask);
 	void ExcludeDistinct(const PayloadValue &, int rowId);
 	void Bind(PayloadType type, int field);
 	void BindEqualPosition(int field, const VariantArray &val, CondType cond);
@@ -111,6 +124,7 @@ protected:
 
 	void setValues(const VariantArray &values);
 	bool isNumericComparison(const VariantArray &values) const;
+	bool compareJsonPathValues(const VariantArray &rhs);
 
 	void clearAllSetValues() {
 		cmpInt.ClearAllSetValues();
@@ -50,6 +50,8 @@ public:
 			valuesS_.reset(new ValuesSet{});
 			allSetValuesS_.reset(new AllSetValuesSet{});
 		}
+		// Set is built once per query, so the large IN-conditions are not rehashed on the filling
+		if (valuesS_) valuesS_->reserve(values.size());
 
 		for (Variant key : values) {
 			if (key.Type() == KeyValueString) {
@@ -142,6 +144,7 @@ public:
 			valuesS_.reset(new intrusive_atomic_rc_wrapper<key_string_set>(collateOpts_));
 			allSetValuesS_.reset(new intrusive_atomic_rc_wrapper<std::unordered_set<const key_string *>>{});
 		}
+		if (valuesS_) valuesS_->reserve(values.size());
 
 		for (Variant key : values) {
 			key.convert(KeyValueString);
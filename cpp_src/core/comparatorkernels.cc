@@ -0,0 +1,261 @@
+#include "core/comparatorkernels.h"
+#include <cstdlib>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define REINDEX_CMP_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace reindexer {
+
+namespace {
+
+template <CondType cond, typename T>
+inline bool compareScalar(T v, T rhs1, T rhs2) noexcept {
+	if constexpr (cond == CondEq) {
+		return v == rhs1;
+	} else if constexpr (cond == CondLt) {
+		return v < rhs1;
+	} else if constexpr (cond == CondLe) {
+		return v <= rhs1;
+	} else if constexpr (cond == CondGt) {
+		return v > rhs1;
+	} else if constexpr (cond == CondGe) {
+		return v >= rhs1;
+	} else {
+		static_assert(cond == CondRange, "Unsupported condition");
+		return v >= rhs1 && v <= rhs2;
+	}
+}
+
+// Fills mask for the values [from, count), where 'from' is multiple of 64
+template <CondType cond, typename T>
+void compareTail(const T *values, size_t from, size_t count, T rhs1, T rhs2, uint64_t *mask) noexcept {
+	if (from == count) return;
+	uint64_t bits = 0;
+	for (size_t i = from; i < count; ++i) bits |= uint64_t(compareScalar<cond>(values[i], rhs1, rhs2)) << (i - from);
+	mask[from >> 6] = bits;
+}
+
+template <CondType cond, typename T>
+void compareGeneric(const T *values, size_t count, T rhs1, T rhs2, uint64_t *mask) noexcept {
+	const size_t full = count & ~size_t(63);
+	for (size_t base = 0; base < full; base += 64) {
+		uint64_t bits = 0;
+		for (size_t i = 0; i < 64; ++i) bits |= uint64_t(compareScalar<cond>(values[base + i], rhs1, rhs2)) << i;
+		mask[base >> 6] = bits;
+	}
+	compareTail<cond>(values, full, count, rhs1, rhs2, mask);
+}
+
+template <typename T>
+void compareBlockGeneric(CondType cond, const T *values, size_t count, T rhs1, T rhs2, uint64_t *mask) noexcept {
+	switch (cond) {
+		case CondEq:
+			return compareGeneric<CondEq>(values, count, rhs1, rhs2, mask);
+		case CondLt:
+			return compareGeneric<CondLt>(values, count, rhs1, rhs2, mask);
+		case CondLe:
+			return compareGeneric<CondLe>(values, count, rhs1, rhs2, mask);
+		case CondGt:
+			return compareGeneric<CondGt>(values, count, rhs1, rhs2, mask);
+		case CondGe:
+			return compareGeneric<CondGe>(values, count, rhs1, rhs2, mask);
+		case CondRange:
+			return compareGeneric<CondRange>(values, count, rhs1, rhs2, mask);
+		default:
+			abort();
+	}
+}
+
+#ifdef REINDEX_CMP_KERNELS_X86
+
+#define RX_TARGET_AVX2 __attribute__((target("avx2")))
+#define RX_TARGET_AVX512 __attribute__((target("avx512f")))
+
+struct Avx2Int {
+	using T = int;
+	using V = __m256i;
+	static constexpr size_t kLanes = 8;
+	static constexpr uint64_t kLanesMask = 0xFF;
+	RX_TARGET_AVX2 static V set1(T v) noexcept { return _mm256_set1_epi32(v); }
+	RX_TARGET_AVX2 static V load(const T *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+	RX_TARGET_AVX2 static uint64_t bits(V v) noexcept { return uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(v))); }
+	RX_TARGET_AVX2 static uint64_t eq(V a, V b) noexcept { return bits(_mm256_cmpeq_epi32(a, b)); }
+	RX_TARGET_AVX2 static uint64_t gt(V a, V b) noexcept { return bits(_mm256_cmpgt_epi32(a, b)); }
+	RX_TARGET_AVX2 static uint64_t lt(V a, V b) noexcept { return bits(_mm256_cmpgt_epi32(b, a)); }
+	RX_TARGET_AVX2 static uint64_t le(V a, V b) noexcept { return ~gt(a, b) & kLanesMask; }
+	RX_TARGET_AVX2 static uint64_t ge(V a, V b) noexcept { return ~lt(a, b) & kLanesMask; }
+};
+
+struct Avx2Int64 {
+	using T = int64_t;
+	using V = __m256i;
+	static constexpr size_t kLanes = 4;
+	static constexpr uint64_t kLanesMask = 0xF;
+	RX_TARGET_AVX2 static V set1(T v) noexcept { return _mm256_set1_epi64x(v); }
+	RX_TARGET_AVX2 static V load(const T *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+	RX_TARGET_AVX2 static uint64_t bits(V v) noexcept { return uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(v))); }
+	RX_TARGET_AVX2 static uint64_t eq(V a, V b) noexcept { return bits(_mm256_cmpeq_epi64(a, b)); }
+	RX_TARGET_AVX2 static uint64_t gt(V a, V b) noexcept { return bits(_mm256_cmpgt_epi64(a, b)); }
+	RX_TARGET_AVX2 static uint64_t lt(V a, V b) noexcept { return bits(_mm256_cmpgt_epi64(b, a)); }
+	RX_TARGET_AVX2 static uint64_t le(V a, V b) noexcept { return ~gt(a, b) & kLanesMask; }
+	RX_TARGET_AVX2 static uint64_t ge(V a, V b) noexcept { return ~lt(a, b) & kLanesMask; }
+};
+
+// Ordered predicates: NaN never matches, the same as scalar comparison does
+struct Avx2Double {
+	using T = double;
+	using V = __m256d;
+	static constexpr size_t kLanes = 4;
+	RX_TARGET_AVX2 static V set1(T v) noexcept { return _mm256_set1_pd(v); }
+	RX_TARGET_AVX2 static V load(const T *p) noexcept { return _mm256_loadu_pd(p); }
+	RX_TARGET_AVX2 static uint64_t eq(V a, V b) noexcept { return uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))); }
+	RX_TARGET_AVX2 static uint64_t gt(V a, V b) noexcept { return uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ))); }
+	RX_TARGET_AVX2 static uint64_t lt(V a, V b) noexcept { return uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ))); }
+	RX_TARGET_AVX2 static uint64_t le(V a, V b) noexcept { return uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ))); }
+	RX_TARGET_AVX2 static uint64_t ge(V a, V b) noexcept { return uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ))); }
+};
+
+struct Avx512Int {
+	using T = int;
+	using V = __m512i;
+	static constexpr size_t kLanes = 16;
+	RX_TARGET_AVX512 static V set1(T v) noexcept { return _mm512_set1_epi32(v); }
+	RX_TARGET_AVX512 static V load(const T *p) noexcept { return _mm512_loadu_si512(p); }
+	RX_TARGET_AVX512 static uint64_t eq(V a, V b) noexcept { return _mm512_cmpeq_epi32_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t gt(V a, V b) noexcept { return _mm512_cmpgt_epi32_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t lt(V a, V b) noexcept { return _mm512_cmplt_epi32_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t le(V a, V b) noexcept { return _mm512_cmple_epi32_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t ge(V a, V b) noexcept { return _mm512_cmpge_epi32_mask(a, b); }
+};
+
+struct Avx512Int64 {
+	using T = int64_t;
+	using V = __m512i;
+	static constexpr size_t kLanes = 8;
+	RX_TARGET_AVX512 static V set1(T v) noexcept { return _mm512_set1_epi64(v); }
+	RX_TARGET_AVX512 static V load(const T *p) noexcept { return _mm512_loadu_si512(p); }
+	RX_TARGET_AVX512 static uint64_t eq(V a, V b) noexcept { return _mm512_cmpeq_epi64_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t gt(V a, V b) noexcept { return _mm512_cmpgt_epi64_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t lt(V a, V b) noexcept { return _mm512_cmplt_epi64_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t le(V a, V b) noexcept { return _mm512_cmple_epi64_mask(a, b); }
+	RX_TARGET_AVX512 static uint64_t ge(V a, V b) noexcept { return _mm512_cmpge_epi64_mask(a, b); }
+};
+
+struct Avx512Double {
+	using T = double;
+	using V = __m512d;
+	static constexpr size_t kLanes = 8;
+	RX_TARGET_AVX512 static V set1(T v) noexcept { return _mm512_set1_pd(v); }
+	RX_TARGET_AVX512 static V load(const T *p) noexcept { return _mm512_loadu_pd(p); }
+	RX_TARGET_AVX512 static uint64_t eq(V a, V b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+	RX_TARGET_AVX512 static uint64_t gt(V a, V b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+	RX_TARGET_AVX512 static uint64_t lt(V a, V b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+	RX_TARGET_AVX512 static uint64_t le(V a, V b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+	RX_TARGET_AVX512 static uint64_t ge(V a, V b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+};
+
+// Intrinsics may be inlined only into the functions with the same target, so the loop is stamped out for each instruction set
+#define RX_DEFINE_SIMD_COMPARE_BLOCK(Name, Target)                                                                                     \
+	template <typename Ops, CondType cond>                                                                                              \
+	Target void Name##Loop(const typename Ops::T *values, size_t count, typename Ops::T rhs1, typename Ops::T rhs2,                    \
+						   uint64_t *mask) noexcept {                                                                                   \
+		const auto r1 = Ops::set1(rhs1);                                                                                                \
+		const auto r2 = Ops::set1(rhs2);                                                                                                \
+		const size_t full = count & ~size_t(63);                                                                                        \
+		for (size_t base = 0; base < full; base += 64) {                                                                                \
+			uint64_t bits = 0;                                                                                                          \
+			for (size_t i = 0; i < 64; i += Ops::kLanes) {                                                                              \
+				const auto v = Ops::load(values + base + i);                                                                            \
+				uint64_t m;                                                                                                             \
+				if constexpr (cond == CondEq) {                                                                                         \
+					m = Ops::eq(v, r1);                                                                                                 \
+				} else if constexpr (cond == CondLt) {                                                                                  \
+					m = Ops::lt(v, r1);                                                                                                 \
+				} else if constexpr (cond == CondLe) {                                                                                  \
+					m = Ops::le(v, r1);                                                                                                 \
+				} else if constexpr (cond == CondGt) {                                                                                  \
+					m = Ops::gt(v, r1);                                                                                                 \
+				} else if constexpr (cond == CondGe) {                                                                                  \
+					m = Ops::ge(v, r1);                                                                                                 \
+				} else {                                                                                                                \
+					m = Ops::ge(v, r1) & Ops::le(v, r2);                                                                                \
+				}                                                                                                                       \
+				bits |= m << i;                                                                                                         \
+			}                                                                                                                           \
+			mask[base >> 6] = bits;                                                                                                     \
+		}                                                                                                                               \
+		compareTail<cond>(values, full, count, rhs1, rhs2, mask);                                                                       \
+	}                                                                                                                                   \
+	template <typename Ops>                                                                                                             \
+	Target void Name(CondType cond, const typename Ops::T *values, size_t count, typename Ops::T rhs1, typename Ops::T rhs2,           \
+					 uint64_t *mask) noexcept {                                                                                         \
+		switch (cond) {                                                                                                                 \
+			case CondEq:                                                                                                                \
+				return Name##Loop<Ops, CondEq>(values, count, rhs1, rhs2, mask);                                                        \
+			case CondLt:                                                                                                                \
+				return Name##Loop<Ops, CondLt>(values, count, rhs1, rhs2, mask);                                                        \
+			case CondLe:                                                                                                                \
+				return Name##Loop<Ops, CondLe>(values, count, rhs1, rhs2, mask);                                                        \
+			case CondGt:                                                                                                                \
+				return Name##Loop<Ops, CondGt>(values, count, rhs1, rhs2, mask);                                                        \
+			case CondGe:                                                                                                                \
+				return Name##Loop<Ops, CondGe>(values, count, rhs1, rhs2, mask);                                                        \
+			case CondRange:                                                                                                             \
+				return Name##Loop<Ops, CondRange>(values, count, rhs1, rhs2, mask);                                                     \
+			default:                                                                                                                    \
+				abort();                                                                                                                \
+		}                                                                                                                               \
+	}
+
+RX_DEFINE_SIMD_COMPARE_BLOCK(compareBlockAvx2, RX_TARGET_AVX2)
+RX_DEFINE_SIMD_COMPARE_BLOCK(compareBlockAvx512, RX_TARGET_AVX512)
+
+#undef RX_DEFINE_SIMD_COMPARE_BLOCK
+
+#endif	// REINDEX_CMP_KERNELS_X86
+
+struct CompareBlockKernels {
+	void (*cmpInt)(CondType, const int *, size_t, int, int, uint64_t *) noexcept;
+	void (*cmpInt64)(CondType, const int64_t *, size_t, int64_t, int64_t, uint64_t *) noexcept;
+	void (*cmpDouble)(CondType, const double *, size_t, double, double, uint64_t *) noexcept;
+	const char *name;
+};
+
+CompareBlockKernels selectKernels() noexcept {
+#ifdef REINDEX_CMP_KERNELS_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return {&compareBlockAvx512<Avx512Int>, &compareBlockAvx512<Avx512Int64>, &compareBlockAvx512<Avx512Double>, "avx512"};
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		return {&compareBlockAvx2<Avx2Int>, &compareBlockAvx2<Avx2Int64>, &compareBlockAvx2<Avx2Double>, "avx2"};
+	}
+#endif
+	// Portable loops are simple enough to be auto-vectorized by compiler for the baseline instruction set (e.g. NEON on aarch64)
+	return {&compareBlockGeneric<int>, &compareBlockGeneric<int64_t>, &compareBlockGeneric<double>, "generic"};
+}
+
+const CompareBlockKernels &kernels() noexcept {
+	static const CompareBlockKernels k = selectKernels();
+	return k;
+}
+
+}  // namespace
+
+void CompareBlock(CondType cond, const int *values, size_t count, int rhs1, int rhs2, uint64_t *mask) noexcept {
+	kernels().cmpInt(cond, values, count, rhs1, rhs2, mask);
+}
+
+void CompareBlock(CondType cond, const int64_t *values, size_t count, int64_t rhs1, int64_t rhs2, uint64_t *mask) noexcept {
+	kernels().cmpInt64(cond, values, count, rhs1, rhs2, mask);
+}
+
+void CompareBlock(CondType cond, const double *values, size_t count, double rhs1, double rhs2, uint64_t *mask) noexcept {
+	kernels().cmpDouble(cond, values, count, rhs1, rhs2, mask);
+}
+
+const char *CompareBlockKernelsName() noexcept { return kernels().name; }
+
+}  // namespace reindexer
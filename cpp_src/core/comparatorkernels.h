@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "core/type_consts.h"
+
+namespace reindexer {
+
+/// Block comparison kernels for the scalar numeric fields.
+/// Each kernel compares 'count' values with condition's arguments and sets bit 'i' of 'mask' if values[i] satisfies condition.
+/// 'mask' must have room for (count + 63) / 64 words. 'rhs2' is used by CondRange only.
+/// Implementation is selected once at runtime by CPU features (AVX-512, AVX2 or portable code), so the same binary may run on any CPU
+void CompareBlock(CondType cond, const int *values, size_t count, int rhs1, int rhs2, uint64_t *mask) noexcept;
+void CompareBlock(CondType cond, const int64_t *values, size_t count, int64_t rhs1, int64_t rhs2, uint64_t *mask) noexcept;
+void CompareBlock(CondType cond, const double *values, size_t count, double rhs1, double rhs2, uint64_t *mask) noexcept;
+
+inline bool IsBlockComparableCond(CondType cond) noexcept {
+	switch (cond) {
+		case CondEq:
+		case CondLt:
+		case CondLe:
+		case CondGt:
+		case CondGe:
+		case CondRange:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/// @return name of the kernels set, selected for the current CPU: "avx512", "avx2" or "generic"
+const char *CompareBlockKernelsName() noexcept;
+
+}  // namespace reindexer
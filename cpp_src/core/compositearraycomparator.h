@@ -13,7 +13,7 @@ public:
 	void BindField(int field, const VariantArray &values, CondType condType);
 	void BindField(const TagsPath &tagsPath, const VariantArray &values, CondType condType);
 	bool Compare(const PayloadValue &pv, const ComparatorVars &vars);
-	bool IsBinded() { return !ctx_.empty(); }
+	bool IsBinded() const noexcept { return !ctx_.empty(); }
 
 private:
 	bool compareField(size_t field, const Variant &v, const ComparatorVars &vars);
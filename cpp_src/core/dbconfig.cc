@@ -31,6 +31,8 @@ Error DBConfigProvider::FromJSON(const gason::JsonNode &root) {
 			profilingData_.perfStats = profilingNode["perfstats"].As<bool>();
 			profilingData_.memStats = profilingNode["memstats"].As<bool>();
 			profilingData_.activityStats = profilingNode["activitystats"].As<bool>();
+			profilingData_.queryTracesSampleRate = profilingNode["query_traces_sample_rate"].As<double>(0.0, 0.0, 1.0);
+			profilingData_.slowQueriesThresholdUS = profilingNode["slow_queries_threshold_us"].As<size_t>(0);
 			auto it = handlers_.find(ProfilingConf);
 			if (it != handlers_.end()) (it->second)();
 		}
@@ -48,6 +50,7 @@ Error DBConfigProvider::FromJSON(const gason::JsonNode &root) {
 				data.startCopyPolicyTxSize = nsNode["start_copy_policy_tx_size"].As<int>(data.startCopyPolicyTxSize);
 				data.copyPolicyMultiplier = nsNode["copy_policy_multiplier"].As<int>(data.copyPolicyMultiplier);
 				data.txSizeToAlwaysCopy = nsNode["tx_size_to_always_copy"].As<int>(data.txSizeToAlwaysCopy);
+				data.txCopySelectIdleThreshold = nsNode["tx_copy_select_idle_threshold"].As<int>(data.txCopySelectIdleThreshold, 0);
 				data.optimizationTimeout = nsNode["optimization_timeout_ms"].As<int>(data.optimizationTimeout);
 				data.optimizationSortWorkers = nsNode["optimization_sort_workers"].As<int>(data.optimizationSortWorkers);
 				int64_t walSize = nsNode["wal_size"].As<int64_t>(0);
@@ -59,12 +62,48 @@ Error DBConfigProvider::FromJSON(const gason::JsonNode &root) {
 				data.maxPreselectPart = nsNode["max_preselect_part"].As<double>(data.maxPreselectPart, 0.0, 1.0);
 				data.idxUpdatesCountingMode = nsNode["index_updates_counting_mode"].As<bool>(data.idxUpdatesCountingMode);
 				data.syncStorageFlushLimit = nsNode["sync_storage_flush_limit"].As<int>(data.syncStorageFlushLimit, 0);
+				data.syncStorageFlushBytesLimit =
+					nsNode["sync_storage_flush_bytes_limit"].As<int64_t>(data.syncStorageFlushBytesLimit, 0);
+				data.storageDurableCommit = nsNode["storage_durable_commit"].As<bool>(data.storageDurableCommit);
+				data.storageGroupCommitDeadline = nsNode["storage_group_commit_deadline_ms"].As<int>(data.storageGroupCommitDeadline, 0);
+				data.storageGroupCommitSize = nsNode["storage_group_commit_size"].As<int>(data.storageGroupCommitSize, 0);
+				data.storageCompression = nsNode["storage_compression"].As<bool>(data.storageCompression);
+				data.tieredTuplesMemoryBudget = nsNode["tiered_tuples_memory_budget"].As<int64_t>(data.tieredTuplesMemoryBudget, 0);
+				data.parallelScanWorkers = nsNode["parallel_scan_workers"].As<int>(data.parallelScanWorkers, 0);
+				data.parallelScanThreshold = nsNode["parallel_scan_threshold"].As<int64_t>(data.parallelScanThreshold, 0);
+				data.parallelUpdateWorkers = nsNode["parallel_update_workers"].As<int>(data.parallelUpdateWorkers, 0);
+				data.subqueriesWorkers = nsNode["subqueries_workers"].As<int>(data.subqueriesWorkers, 0);
+				data.itemsSnapshotPeriod = nsNode["items_snapshot_period_sec"].As<int>(data.itemsSnapshotPeriod, 0);
+				data.walSpillBytesLimit = nsNode["wal_spill_bytes_limit"].As<int64_t>(data.walSpillBytesLimit, 0);
+				data.walSpillTTL = nsNode["wal_spill_ttl_sec"].As<int64_t>(data.walSpillTTL, 0);
+				data.ttlExpirationChunkSize = nsNode["ttl_expiration_chunk_size"].As<int>(data.ttlExpirationChunkSize, 0);
+				data.ttlExpirationRateLimit = nsNode["ttl_expiration_rate_limit"].As<int>(data.ttlExpirationRateLimit, 0);
+				data.deleteChunkSize = nsNode["delete_chunk_size"].As<int>(data.deleteChunkSize, 0);
+				for (auto &indexNode : nsNode["materialized_aggregations"]) {
+					data.materializedAggregations.emplace_back(indexNode.As<string>());
+				}
+				data.pathsIndex = nsNode["paths_index"].As<bool>(data.pathsIndex);
+				data.queryResultsCacheSize = nsNode["query_results_cache_size"].As<int64_t>(data.queryResultsCacheSize, 0);
+				data.itemsCompactionFreePercent = nsNode["items_compaction_free_percent"].As<int>(data.itemsCompactionFreePercent, 0, 100);
+				data.pointReadsCacheSize = nsNode["point_reads_cache_size"].As<int64_t>(data.pointReadsCacheSize, 0);
 				namespacesData_.emplace(nsNode["namespace"].As<string>(), std::move(data));
 			}
 			auto it = handlers_.find(NamespaceDataConf);
 			if (it != handlers_.end()) (it->second)();
 		}
 
+		auto &maintenanceNode = root["maintenance"];
+		if (!maintenanceNode.empty()) {
+			maintenanceData_ = {};
+			maintenanceData_.workers = maintenanceNode["workers"].As<int>(maintenanceData_.workers, 1, 64);
+			maintenanceData_.deferLoadThreshold = maintenanceNode["defer_load_threshold"].As<int>(maintenanceData_.deferLoadThreshold, 0);
+			maintenanceData_.maxDeferralMs = maintenanceNode["max_deferral_ms"].As<int>(maintenanceData_.maxDeferralMs, 0);
+			maintenanceData_.warmupQueries = maintenanceNode["warmup_queries"].As<int>(maintenanceData_.warmupQueries, 0);
+			maintenanceData_.warmStatePeriodSec = maintenanceNode["warm_state_period_sec"].As<int>(maintenanceData_.warmStatePeriodSec, 1);
+			auto it = handlers_.find(MaintenanceConf);
+			if (it != handlers_.end()) (it->second)();
+		}
+
 		auto &replicationNode = root["replication"];
 		if (!replicationNode.empty()) {
 			auto err = replicationData_.FromJSON(replicationNode);
@@ -96,6 +135,11 @@ ReplicationConfigData DBConfigProvider::GetReplicationConfig() {
 	return replicationData_;
 }
 
+MaintenanceConfigData DBConfigProvider::GetMaintenanceConfig() {
+	smart_lock<shared_timed_mutex> lk(mtx_, false);
+	return maintenanceData_;
+}
+
 bool DBConfigProvider::GetNamespaceConfig(const string &nsName, NamespaceConfigData &data) {
 	smart_lock<shared_timed_mutex> lk(mtx_, false);
 	auto it = namespacesData_.find(nsName);
@@ -125,6 +169,8 @@ Error ReplicationConfigData::FromYML(const string &yaml) {
 		forceSyncOnWrongDataHash = root["force_sync_on_wrong_data_hash"].As<bool>(forceSyncOnWrongDataHash);
 		retrySyncIntervalSec = root["retry_sync_interval_sec"].As<int>(retrySyncIntervalSec);
 		onlineReplErrorsThreshold = root["online_repl_errors_threshold"].As<int>(onlineReplErrorsThreshold);
+		onlineUpdatesApplyThreads = std::max(root["online_updates_apply_threads"].As<int>(onlineUpdatesApplyThreads), 0);
+		txDecodeThreads = std::max(root["tx_decode_threads"].As<int>(txDecodeThreads), 0);
 		enableCompression = root["enable_compression"].As<bool>(enableCompression);
 		serverId = root["server_id"].As<int>(serverId);
 		auto &node = root["namespaces"];
@@ -153,6 +199,8 @@ Error ReplicationConfigData::FromJSON(const gason::JsonNode &root) {
 		forceSyncOnWrongDataHash = root["force_sync_on_wrong_data_hash"].As<bool>();
 		retrySyncIntervalSec = root["retry_sync_interval_sec"].As<int>(retrySyncIntervalSec);
 		onlineReplErrorsThreshold = root["online_repl_errors_threshold"].As<int>(onlineReplErrorsThreshold);
+		onlineUpdatesApplyThreads = root["online_updates_apply_threads"].As<int>(onlineUpdatesApplyThreads, 0);
+		txDecodeThreads = root["tx_decode_threads"].As<int>(txDecodeThreads, 0);
 		enableCompression = root["enable_compression"].As<bool>(enableCompression);
 		serverId = root["server_id"].As<int>(serverId);
 		namespaces.clear();
@@ -199,6 +247,8 @@ void ReplicationConfigData::GetJSON(JsonBuilder &jb) const {
 	jb.Put("force_sync_on_wrong_data_hash", forceSyncOnWrongDataHash);
 	jb.Put("retry_sync_interval_sec", retrySyncIntervalSec);
 	jb.Put("online_repl_errors_threshold", onlineReplErrorsThreshold);
+	jb.Put("online_updates_apply_threads", onlineUpdatesApplyThreads);
+	jb.Put("tx_decode_threads", txDecodeThreads);
 	jb.Put("server_id", serverId);
 	{
 		auto arrNode = jb.Array("namespaces");
@@ -255,6 +305,12 @@ void ReplicationConfigData::GetYAML(WrSerializer &ser) const {
 			"# Count of online replication erros, which will be merged in single error message"
 			"online_repl_errors_threshold: " + std::to_string(onlineReplErrorsThreshold) + "\n"
 			"\n"
+			"# Count of threads, which apply online updates of the different namespaces concurrently. 0 - updates are applied serially\n"
+			"online_updates_apply_threads: " + std::to_string(onlineUpdatesApplyThreads) + "\n"
+			"\n"
+			"# Count of threads, which decode items of the large replicated transactions. 0 - items are decoded serially\n"
+			"tx_decode_threads: " + std::to_string(txDecodeThreads) + "\n"
+			"\n"
 			"# List of namespaces for replication. If emply, all namespaces\n"
 			"# All replicated namespaces will become read only for slave\n"
 			"# It should be written as YAML sequence, JSON-style arrays are not supported\n"
@@ -19,7 +19,7 @@ class JsonBuilder;
 class RdxContext;
 class WrSerializer;
 
-enum ConfigType { ProfilingConf, NamespaceDataConf, ReplicationConf };
+enum ConfigType { ProfilingConf, NamespaceDataConf, ReplicationConf, MaintenanceConf };
 
 struct ProfilingConfigData {
 	bool queriesPerfStats = false;
@@ -27,6 +27,22 @@ struct ProfilingConfigData {
 	bool perfStats = false;
 	bool memStats = false;
 	bool activityStats = false;
+	// Part of the selects, which execution stages are traced into #querytraces
+	double queryTracesSampleRate = 0.0;
+	// Selects, which took more than this time, are logged with their plans into #slowqueries. 0 means 'disabled'
+	size_t slowQueriesThresholdUS = 0;
+};
+
+// Background maintenance of the namespaces: indexes optimization, TTL expiration, snapshots, etc
+struct MaintenanceConfigData {
+	int workers = 2;
+	// Count of the running foreground operations, since which the optimization and snapshots are deferred. 0 means 'never defer'
+	int deferLoadThreshold = 0;
+	int maxDeferralMs = 5000;
+	// Count of the most frequent selects of #queriesperfstats, which are stored into the warm state of the database and replayed
+	// after the restart. 0 means 'warm state is disabled'
+	int warmupQueries = 0;
+	int warmStatePeriodSec = 60;
 };
 
 struct NamespaceConfigData {
@@ -38,6 +54,7 @@ struct NamespaceConfigData {
 	int startCopyPolicyTxSize = 10000;
 	int copyPolicyMultiplier = 5;
 	int txSizeToAlwaysCopy = 100000;
+	int txCopySelectIdleThreshold = 0;
 	int optimizationTimeout = 800;
 	int optimizationSortWorkers = 4;
 	int64_t walSize = 4000000;
@@ -46,6 +63,27 @@ struct NamespaceConfigData {
 	double maxPreselectPart = 0.1;
 	bool idxUpdatesCountingMode = false;
 	int syncStorageFlushLimit = 0;
+	int64_t syncStorageFlushBytesLimit = 0;
+	bool storageDurableCommit = false;
+	int storageGroupCommitDeadline = 0;
+	int storageGroupCommitSize = 0;
+	bool storageCompression = false;
+	int64_t tieredTuplesMemoryBudget = 0;
+	int parallelScanWorkers = 0;
+	int64_t parallelScanThreshold = 1000000;
+	int parallelUpdateWorkers = 0;
+	int subqueriesWorkers = 0;
+	int itemsSnapshotPeriod = 0;
+	int64_t walSpillBytesLimit = 0;
+	int64_t walSpillTTL = 0;
+	int ttlExpirationChunkSize = 0;
+	int ttlExpirationRateLimit = 0;
+	int deleteChunkSize = 0;
+	std::vector<std::string> materializedAggregations;
+	bool pathsIndex = false;
+	int64_t queryResultsCacheSize = 0;
+	int itemsCompactionFreePercent = 0;
+	int64_t pointReadsCacheSize = 0;
 };
 
 enum ReplicationRole { ReplicationNone, ReplicationMaster, ReplicationSlave, ReplicationReadOnly };
@@ -65,6 +103,8 @@ struct ReplicationConfigData {
 	int timeoutSec = 60;
 	int retrySyncIntervalSec = 20;
 	int onlineReplErrorsThreshold = 100;
+	int onlineUpdatesApplyThreads = 0;
+	int txDecodeThreads = 0;
 	bool forceSyncOnLogicError = false;
 	bool forceSyncOnWrongDataHash = false;
 	fast_hash_set<string, nocase_hash_str, nocase_equal_str> namespaces;
@@ -76,6 +116,7 @@ struct ReplicationConfigData {
 			   (clusterID == rdata.clusterID) && (forceSyncOnLogicError == rdata.forceSyncOnLogicError) &&
 			   (forceSyncOnWrongDataHash == rdata.forceSyncOnWrongDataHash) && (masterDSN == rdata.masterDSN) &&
 			   (retrySyncIntervalSec == rdata.retrySyncIntervalSec) && (onlineReplErrorsThreshold == rdata.onlineReplErrorsThreshold) &&
+			   (onlineUpdatesApplyThreads == rdata.onlineUpdatesApplyThreads) && (txDecodeThreads == rdata.txDecodeThreads) &&
 			   (timeoutSec == rdata.timeoutSec) && (namespaces == rdata.namespaces) && (enableCompression == rdata.enableCompression) &&
 			   (serverId == rdata.serverId) && (appName == rdata.appName);
 	}
@@ -98,11 +139,13 @@ public:
 
 	ProfilingConfigData GetProfilingConfig();
 	ReplicationConfigData GetReplicationConfig();
+	MaintenanceConfigData GetMaintenanceConfig();
 	bool GetNamespaceConfig(const string &nsName, NamespaceConfigData &data);
 
 private:
 	ProfilingConfigData profilingData_;
 	ReplicationConfigData replicationData_;
+	MaintenanceConfigData maintenanceData_;
 	std::unordered_map<string, NamespaceConfigData> namespacesData_;
 	std::unordered_map<int, std::function<void()>> handlers_;
 	shared_timed_mutex mtx_;
@@ -11,6 +11,10 @@ constexpr char kNamespacesNamespace[] = "#namespaces";
 constexpr char kConfigNamespace[] = "#config";
 constexpr char kActivityStatsNamespace[] = "#activitystats";
 constexpr char kClientsStatsNamespace[] = "#clientsstats";
+constexpr char kReplicationStatsNamespace[] = "#replicationstats";
+constexpr char kQueryTracesNamespace[] = "#querytraces";
+constexpr char kSlowQueriesNamespace[] = "#slowqueries";
+constexpr char kIndexAdvicesNamespace[] = "#indexadvices";
 const std::vector<std::string> kDefDBConfig = {
 	R"json({
 		"type":"profiling",
@@ -19,7 +23,9 @@ const std::vector<std::string> kDefDBConfig = {
 			"queries_threshold_us":10,
 			"perfstats":false,
 			"memstats":true,
-			"activitystats":false
+			"activitystats":false,
+			"query_traces_sample_rate":0.0,
+			"slow_queries_threshold_us":0
 		}
 	})json",
 	R"json({
@@ -34,6 +40,7 @@ const std::vector<std::string> kDefDBConfig = {
 				"start_copy_policy_tx_size":10000,
 				"copy_policy_multiplier":5,
 				"tx_size_to_always_copy":100000,
+				"tx_copy_select_idle_threshold":0,
 				"optimization_timeout_ms":800,
 				"optimization_sort_workers":4,
 				"wal_size":4000000,
@@ -41,10 +48,41 @@ const std::vector<std::string> kDefDBConfig = {
 				"max_preselect_size":1000,
 				"max_preselect_part":0.1,
 				"index_updates_counting_mode":false,
-				"sync_storage_flush_limit":0
+				"sync_storage_flush_limit":0,
+				"sync_storage_flush_bytes_limit":0,
+				"storage_durable_commit":false,
+				"storage_group_commit_deadline_ms":0,
+				"storage_group_commit_size":0,
+				"storage_compression":false,
+				"tiered_tuples_memory_budget":0,
+				"parallel_scan_workers":0,
+				"parallel_scan_threshold":1000000,
+				"parallel_update_workers":0,
+				"subqueries_workers":0,
+				"items_snapshot_period_sec":0,
+				"wal_spill_bytes_limit":0,
+				"wal_spill_ttl_sec":0,
+				"ttl_expiration_chunk_size":0,
+				"ttl_expiration_rate_limit":0,
+				"delete_chunk_size":0,
+				"materialized_aggregations":[],
+				"paths_index":false,
+				"query_results_cache_size":0,
+				"items_compaction_free_percent":0,
+				"point_reads_cache_size":0
 			}
 		]
 	})json",
+	R"json({
+		"type":"maintenance",
+		"maintenance":{
+			"workers":2,
+			"defer_load_threshold":0,
+			"max_deferral_ms":5000,
+			"warmup_queries":0,
+			"warm_state_period_sec":60
+		}
+	})json",
 	R"json({
 		"type":"replication",
 		"replication":{
@@ -98,6 +136,25 @@ const std::vector<NamespaceDef> kSystemNsDefs = {
 		.AddIndex("last_sec_avg_latency_us", "-", "int64", IndexOpts().Dense())
 		.AddIndex("last_sec_avg_lock_time_us", "-", "int64", IndexOpts().Dense())
 		.AddIndex("latency_stddev", "-", "double", IndexOpts().Dense()),
+	NamespaceDef(kQueryTracesNamespace, StorageOpts())
+		.AddIndex("id", "hash", "int64", IndexOpts().PK())
+		.AddIndex("query", "-", "string", IndexOpts().Dense())
+		.AddIndex("start_time_us", "-", "int64", IndexOpts().Dense())
+		.AddIndex("total_us", "-", "int64", IndexOpts().Dense()),
+	NamespaceDef(kSlowQueriesNamespace, StorageOpts())
+		.AddIndex("id", "hash", "int64", IndexOpts().PK())
+		.AddIndex("query", "-", "string", IndexOpts().Dense())
+		.AddIndex("query_fingerprint", "-", "string", IndexOpts().Dense())
+		.AddIndex("plan_fingerprint", "-", "string", IndexOpts().Dense())
+		.AddIndex("start_time_us", "-", "int64", IndexOpts().Dense())
+		.AddIndex("total_us", "-", "int64", IndexOpts().Dense()),
+	NamespaceDef(kIndexAdvicesNamespace, StorageOpts())
+		.AddIndex("id", "hash", "string", IndexOpts().PK())
+		.AddIndex("namespace", "-", "string", IndexOpts().Dense())
+		.AddIndex("kind", "-", "string", IndexOpts().Dense())
+		.AddIndex("queries_count", "-", "int64", IndexOpts().Dense())
+		.AddIndex("queries_time_us", "-", "int64", IndexOpts().Dense())
+		.AddIndex("estimated_memory_bytes", "-", "int64", IndexOpts().Dense()),
 	NamespaceDef(kNamespacesNamespace, StorageOpts()).AddIndex("name", "hash", "string", IndexOpts().PK()),
 	NamespaceDef(kPerfStatsNamespace, StorageOpts()).AddIndex("name", "hash", "string", IndexOpts().PK()),
 	NamespaceDef(kMemStatsNamespace, StorageOpts())
@@ -139,6 +196,19 @@ const std::vector<NamespaceDef> kSystemNsDefs = {
 		.AddIndex("app_name", "-", "string", IndexOpts().Dense())
 		.AddIndex("tx_count", "-", "int64", IndexOpts().Dense())
 		.AddIndex("is_subscribed", "-", "bool", IndexOpts().Dense())
-		.AddIndex("updates_lost", "-", "int64", IndexOpts().Dense())};
+		.AddIndex("updates_lost", "-", "int64", IndexOpts().Dense()),
+	NamespaceDef(kReplicationStatsNamespace, StorageOpts())
+		.AddIndex("name", "hash", "string", IndexOpts().PK())
+		.AddIndex("lsn_lag", "-", "int64", IndexOpts().Dense())
+		.AddIndex("pended_updates", "-", "int64", IndexOpts().Dense())
+		.AddIndex("queued_updates", "-", "int64", IndexOpts().Dense())
+		.AddIndex("applied_records", "-", "int64", IndexOpts().Dense())
+		.AddIndex("applied_records_rate", "-", "int64", IndexOpts().Dense())
+		.AddIndex("recv_records", "-", "int64", IndexOpts().Dense())
+		.AddIndex("recv_bytes", "-", "int64", IndexOpts().Dense())
+		.AddIndex("recv_rate", "-", "int64", IndexOpts().Dense())
+		.AddIndex("tx_count", "-", "int64", IndexOpts().Dense())
+		.AddIndex("tx_apply_time_us", "-", "int64", IndexOpts().Dense())
+		.AddIndex("tx_avg_apply_time_us", "-", "int64", IndexOpts().Dense())};
 
 }  // namespace reindexer
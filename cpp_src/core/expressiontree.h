@@ -733,6 +733,21 @@ protected:
 		result.activeBrackets_ = activeBrackets_;
 		return result;
 	}
+	/// Deep copy, which leaves of the type T are copied by the functor
+	template <typename T, typename F>
+	ExpressionTree makeCopy(F&& copyLeaf) const {
+		ExpressionTree result;
+		result.container_.reserve(container_.size());
+		for (const Node& n : container_) {
+			if (n.template HoldsOrReferTo<T>()) {
+				result.container_.emplace_back(n.operation, copyLeaf(n.template Value<T>()));
+			} else {
+				result.container_.emplace_back(n.MakeDeepCopy());
+			}
+		}
+		result.activeBrackets_ = activeBrackets_;
+		return result;
+	}
 };
 
 }  // namespace reindexer
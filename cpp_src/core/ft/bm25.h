@@ -20,8 +20,21 @@ inline double TF(double termCountInDoc, double mostFreqWordCountInDoc, double wo
 	return termCountInDoc;
 }
 
-inline double bm25score(double termCountInDoc, double mostFreqWordCountInDoc, double wordsInDoc, double avgDocLen) {
+// Document length normalization of bm25score(). It doesn't depend on the term, so it's precomputed for each field of the document
+inline double bm25Norm(double wordsInDoc, double avgDocLen) {
+	return kKeofBm25k1 * (1.0 - kKeofBm25b + kKeofBm25b * wordsInDoc / avgDocLen);
+}
+
+// bm25score() with the precomputed bm25Norm() of the document's field
+inline double bm25scoreByNorm(double termCountInDoc, double mostFreqWordCountInDoc, double wordsInDoc, double norm) {
 	auto termFreq = TF(termCountInDoc, mostFreqWordCountInDoc, wordsInDoc);
-	return termFreq * (kKeofBm25k1 + 1.0) / (termFreq + kKeofBm25k1 * (1.0 - kKeofBm25b + kKeofBm25b * wordsInDoc / avgDocLen));
+	return termFreq * (kKeofBm25k1 + 1.0) / (termFreq + norm);
 }
+
+inline double bm25score(double termCountInDoc, double mostFreqWordCountInDoc, double wordsInDoc, double avgDocLen) {
+	return bm25scoreByNorm(termCountInDoc, mostFreqWordCountInDoc, wordsInDoc, bm25Norm(wordsInDoc, avgDocLen));
+}
+
+// Upper bound of bm25score() for the documents with termCountInDoc or less term entries (score decreases with document length)
+inline double bm25MaxScore(double termCountInDoc) { return bm25score(termCountInDoc, 0.0, 0.0, 1.0); }
 }  // namespace reindexer
@@ -56,9 +56,14 @@ void FtFastConfig::parse(std::string_view json, const fast_hash_map<std::string,
 			maxTypos = maxTyposNode.As<>(maxTypos, 0, 4);
 		}
 		maxTypoLen = root["max_typo_len"].As<>(maxTypoLen, 0, 100);
+		compactTypos = root["compact_typos"].As<>(compactTypos);
 		maxRebuildSteps = root["max_rebuild_steps"].As<>(maxRebuildSteps, 1, 500);
 		maxStepSize = root["max_step_size"].As<>(maxStepSize, 5);
+		incrementalCacheInvalidation = root["incremental_cache_invalidation"].As<>(incrementalCacheInvalidation);
 		summationRanksByFieldsRatio = root["sum_ranks_by_fields_ratio"].As<>(summationRanksByFieldsRatio, 0.0, 1.0);
+		selectWorkers = root["select_workers"].As<>(selectWorkers, 0, 64);
+		parallelVariantsThreshold = root["parallel_variants_threshold"].As<>(parallelVariantsThreshold, 1);
+		parallelMergeThreshold = root["parallel_merge_threshold"].As<>(parallelMergeThreshold, 1);
 
 		FtFastFieldConfig defaultFieldCfg;
 		defaultFieldCfg.bm25Boost = root["bm25_boost"].As<>(defaultFieldCfg.bm25Boost, 0.0, 10.0);
@@ -123,9 +128,14 @@ std::string FtFastConfig::GetJson(const fast_hash_map<std::string, int>& fields)
 	jsonBuilder.Put("min_relevancy", minRelevancy);
 	jsonBuilder.Put("max_typos", maxTypos);
 	jsonBuilder.Put("max_typo_len", maxTypoLen);
+	jsonBuilder.Put("compact_typos", compactTypos);
 	jsonBuilder.Put("max_rebuild_steps", maxRebuildSteps);
 	jsonBuilder.Put("max_step_size", maxStepSize);
+	jsonBuilder.Put("incremental_cache_invalidation", incrementalCacheInvalidation);
 	jsonBuilder.Put("sum_ranks_by_fields_ratio", summationRanksByFieldsRatio);
+	jsonBuilder.Put("select_workers", selectWorkers);
+	jsonBuilder.Put("parallel_variants_threshold", parallelVariantsThreshold);
+	jsonBuilder.Put("parallel_merge_threshold", parallelMergeThreshold);
 	switch (optimization) {
 		case Optimization::Memory:
 			jsonBuilder.Put("optimization", "Memory");
@@ -31,12 +31,24 @@ struct FtFastConfig : public BaseFTConfig {
 
 	int maxTypos = 2;
 	int maxTypoLen = 15;
+	// Store typos as sorted array of their hashes instead of hash map. Takes several times less memory, but lookup is slower
+	bool compactTypos = false;
 
 	int maxRebuildSteps = 50;
 	int maxStepSize = 4000;
+	// Keep cached results on the incremental index update, if the updated documents can not affect them. Ranks of the kept results
+	// are not recalculated, so they may differ from the ranks of the same query on the rebuilt index
+	bool incrementalCacheInvalidation = false;
 
 	double summationRanksByFieldsRatio = 0.0;
 
+	// Count of threads for the select of the single query (0 or 1 - select is executed by the query's thread)
+	int selectWorkers = 0;
+	// Minimal count of the term's variants to process them in several threads
+	int parallelVariantsThreshold = 32;
+	// Minimal count of the term's documents ids to merge them in several threads
+	int parallelMergeThreshold = 100000;
+
 	h_vector<FtFastFieldConfig, 8> fieldsCfg;
 	enum class Optimization { CPU, Memory } optimization = Optimization::Memory;
 	int MaxTyposInWord() const noexcept { return (maxTypos / 2) + (maxTypos % 2); }
@@ -24,6 +24,8 @@ void FtFuzzyConfig::parse(std::string_view json, const fast_hash_map<std::string
 		minOkProc = root["min_ok_proc"].As<>(minOkProc, 0.0, 100.);
 		bufferSize = root["buffer_size"].As<size_t>(bufferSize, 2, 10);
 		spaceSize = root["space_size"].As<size_t>(spaceSize, 0, 9);
+		buildWorkers = root["build_workers"].As<>(buildWorkers, 0, 64);
+		selectWorkers = root["select_workers"].As<>(selectWorkers, 0, 64);
 
 		parseBase(root);
 
@@ -47,6 +49,8 @@ std::string FtFuzzyConfig::GetJson(const fast_hash_map<std::string, int> &) cons
 	jsonBuilder.Put("min_ok_proc", minOkProc);
 	jsonBuilder.Put("buffer_size", bufferSize);
 	jsonBuilder.Put("space_size", spaceSize);
+	jsonBuilder.Put("build_workers", buildWorkers);
+	jsonBuilder.Put("select_workers", selectWorkers);
 	jsonBuilder.End();
 	return wrser.c_str();
 }
@@ -19,6 +19,10 @@ struct FtFuzzyConfig : public BaseFTConfig {
 	double minOkProc = 10;
 	size_t bufferSize = 3;
 	size_t spaceSize = 2;
+	// Count of threads for the index build (0 or 1 - index is built by the committing thread)
+	int buildWorkers = 0;
+	// Count of threads for the merge of the single query's results (0 or 1 - results are merged by the query's thread)
+	int selectWorkers = 0;
 };
 
 const size_t maxFuzzyFTBufferSize = 10;
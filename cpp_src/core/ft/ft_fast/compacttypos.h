@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+#include "indextexttypes.h"
+#include "sort/pdqsort.hpp"
+#include "tools/customhash.h"
+
+namespace reindexer {
+
+/// Compact alternative to the typos hash map: sorted array of (typo hash, word id) pairs, 8 bytes per typo.
+/// Typos strings are not stored, so words, found by typo, may be false positives on hash collision and have to be checked by the caller
+/// (see IsTypoOf). Array has no pointers inside, so it may be copied or mapped as is
+class CompactTyposIndex {
+public:
+	struct Entry {
+		uint32_t hash;
+		WordIdType wordId;
+
+		bool operator<(const Entry &other) const noexcept {
+			return hash < other.hash || (hash == other.hash && wordId.data < other.wordId.data);
+		}
+		bool operator==(const Entry &other) const noexcept { return hash == other.hash && wordId.data == other.wordId.data; }
+	};
+	using const_iterator = std::vector<Entry>::const_iterator;
+
+	void reserve(size_t size) { entries_.reserve(size); }
+	void emplace(std::string_view typo, WordIdType wordId) { entries_.push_back({hash(typo), wordId}); }
+	/// Has to be called after all of the emplaces and before lookups
+	void commit() {
+		boost::sort::pdqsort(entries_.begin(), entries_.end());
+		// The same typo may be produced by the several deletions in the word
+		entries_.erase(std::unique(entries_.begin(), entries_.end()), entries_.end());
+		entries_.shrink_to_fit();
+	}
+	std::pair<const_iterator, const_iterator> equal_range(std::string_view typo) const {
+		const uint32_t h = hash(typo);
+		const auto lower =
+			std::lower_bound(entries_.cbegin(), entries_.cend(), h, [](const Entry &e, uint32_t h) noexcept { return e.hash < h; });
+		auto upper = lower;
+		while (upper != entries_.cend() && upper->hash == h) ++upper;
+		return {lower, upper};
+	}
+	size_t size() const noexcept { return entries_.size(); }
+	size_t heap_size() const noexcept { return entries_.capacity() * sizeof(Entry); }
+	void clear() noexcept {
+		entries_.clear();
+		entries_.shrink_to_fit();
+	}
+
+	/// Checks, if typo may be produced from the word by deletion of up to maxTypos symbols (i.e. typo is subsequence of the word)
+	static bool IsTypoOf(std::string_view typo, std::string_view word, int maxTypos) noexcept {
+		// UTF-8 symbol takes up to 4 bytes
+		if (typo.size() > word.size() || word.size() - typo.size() > size_t(maxTypos) * 4) return false;
+		size_t w = 0;
+		for (char c : typo) {
+			while (w < word.size() && word[w] != c) ++w;
+			if (w == word.size()) return false;
+			++w;
+		}
+		return true;
+	}
+
+private:
+	static uint32_t hash(std::string_view typo) noexcept { return _Hash_bytes(typo.data(), typo.size()); }
+
+	std::vector<Entry> entries_;
+};
+
+}  // namespace reindexer
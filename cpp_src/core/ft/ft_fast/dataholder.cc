@@ -25,7 +25,8 @@ bool IDataHolder::NeedRecomitLast() { return steps.back().suffixes_.word_size()
 size_t IDataHolder::GetMemStat() {
 	size_t res = 0;
 	for (auto& step : steps) {
-		res += step.typosHalf_.heap_size() + step.typosMax_.heap_size() + step.suffixes_.heap_size();
+		res += step.typosHalf_.heap_size() + step.typosMax_.heap_size() + step.typosHalfCompact_.heap_size() +
+			   step.typosMaxCompact_.heap_size() + step.suffixes_.heap_size();
 	}
 	res += vdocs_.capacity() * sizeof(VDocEntry);
 	return res;
@@ -42,6 +43,7 @@ void IDataHolder::Clear() {
 	avgWordsCount_.clear();
 	vdocs_.clear();
 	vdocsTexts.clear();
+	stepWords_.clear();
 	vodcsOffset_ = 0;
 	szCnt = 0;
 }
@@ -170,14 +172,14 @@ void DataHolder<IdCont>::StartCommit(bool complte_updated) {
 }
 
 template <typename IdCont>
-IDataHolder::MergeData DataHolder<IdCont>::Select(FtDSLQuery& dsl, size_t fieldSize, bool needArea, bool inTransaction,
-												  const RdxContext& rdxCtx) {
-	return Selecter<IdCont>{*this, fieldSize, needArea}.Process(dsl, inTransaction, rdxCtx);
+IDataHolder::MergeData DataHolder<IdCont>::Select(FtDSLQuery& dsl, size_t fieldSize, bool needArea, size_t topK, bool inTransaction,
+												  FtCacheDeps* cacheDeps, const RdxContext& rdxCtx) {
+	return Selecter<IdCont>{*this, fieldSize, needArea, topK}.Process(dsl, inTransaction, cacheDeps, rdxCtx);
 }
 
 template <typename IdCont>
-void DataHolder<IdCont>::Process(size_t fieldSize, bool multithread) {
-	DataProcessor<IdCont>{*this, fieldSize}.Process(multithread);
+bool DataHolder<IdCont>::Process(size_t fieldSize, bool multithread, const std::function<bool()>& isCanceled) {
+	return DataProcessor<IdCont>{*this, fieldSize}.Process(multithread, isCanceled);
 }
 
 template class DataHolder<PackedIdRelVec>;
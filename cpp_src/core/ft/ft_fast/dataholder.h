@@ -1,9 +1,12 @@
 #pragma once
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include "compacttypos.h"
 #include "core/ft/areaholder.h"
 #include "core/ft/config/ftfastconfig.h"
 #include "core/ft/filters/itokenfilter.h"
+#include "core/ft/ftvariantscache.h"
 #include "core/ft/idrelset.h"
 #include "core/ft/stemmer.h"
 #include "core/index/indextext/ftkeyentry.h"
@@ -11,12 +14,14 @@
 #include "estl/flat_str_map.h"
 #include "estl/suffix_map.h"
 #include "indextexttypes.h"
+#include "tools/hugepages.h"
 
 namespace reindexer {
 
 // #define REINDEX_FT_EXTRA_DEBUG 1
 
 class RdxContext;
+struct FtCacheDeps;
 
 struct VDocEntry {
 #ifdef REINDEX_FT_EXTRA_DEBUG
@@ -25,6 +30,8 @@ struct VDocEntry {
 	const FtKeyEntryData* keyEntry;
 	h_vector<float, 3> wordsCount;
 	h_vector<float, 3> mostFreqWordCount;
+	// bm25Norm() of each field. Recalculated on each commit, because it depends on the average words count of the field
+	h_vector<double, 3> bm25Norm;
 };
 
 template <typename IdCont>
@@ -32,6 +39,8 @@ class PackedWordEntry {
 public:
 	IdCont vids_;
 	size_t cur_step_pos_ = 0;
+	// Max count of the word entries in single document. Used for rank upper bound estimation, so it's never decreased
+	uint32_t maxTermCount_ = 0;
 };
 class WordEntry {
 public:
@@ -57,12 +66,17 @@ public:
 		flat_str_multimap<char, WordIdType> typosHalf_;
 		// typosMax_ contains words with MaxTyposInWord() typos if MaxTyposInWord() != maxTypos/2
 		flat_str_multimap<char, WordIdType> typosMax_;
+		// Compact typos indexes, which are used instead of the typos maps, if FtFastConfig::compactTypos is set
+		CompactTyposIndex typosHalfCompact_;
+		CompactTyposIndex typosMaxCompact_;
 		uint32_t wordOffset_;
 
 		void clear() {
 			suffixes_.clear();
 			typosHalf_.clear();
 			typosMax_.clear();
+			typosHalfCompact_.clear();
+			typosMaxCompact_.clear();
 		}
 	};
 	// Final information about found document
@@ -79,8 +93,13 @@ public:
 	};
 
 	virtual ~IDataHolder() = default;
-	virtual MergeData Select(FtDSLQuery& dsl, size_t fieldSize, bool needArea, bool inTransaction, const RdxContext&) = 0;
-	virtual void Process(size_t fieldSize, bool multithread) = 0;
+	// @param topK - count of the best ranked documents, required by query (0 - all of the documents are required)
+	// @param cacheDeps - if not null, it's filled by the terms' variants, which the result depends on
+	virtual MergeData Select(FtDSLQuery& dsl, size_t fieldSize, bool needArea, size_t topK, bool inTransaction, FtCacheDeps* cacheDeps,
+							 const RdxContext&) = 0;
+	/// Builds the current commit step
+	/// @return false, if processing was canceled. Holder's data is inconsistent in this case and has to be cleared
+	virtual bool Process(size_t fieldSize, bool multithread, const std::function<bool()>& isCanceled) = 0;
 	virtual size_t GetMemStat() = 0;
 	virtual void Clear() = 0;
 	virtual void StartCommit(bool complte_updated) = 0;
@@ -105,8 +124,10 @@ public:
 	ITokenFilter::Ptr translit_;
 	ITokenFilter::Ptr kbLayout_;
 	ITokenFilter::Ptr synonyms_;
+	// Variants of the query terms. Cleared on the change of the config
+	FtVariantsCache variantsCache_;
 	std::vector<CommitStep> steps;
-	std::vector<VDocEntry> vdocs_;
+	std::vector<VDocEntry, HugePageAllocator<VDocEntry>> vdocs_;
 	size_t cur_vdoc_pos_ = 0;
 	ProcessStatus status_{CreateNew};
 	vector<double> avgWordsCount_;
@@ -114,6 +135,8 @@ public:
 	// Temp data for build
 	vector<h_vector<pair<std::string_view, uint32_t>, 8>> vdocsTexts;
 	vector<std::unique_ptr<string>> bufStrs_;
+	// Words of the documents, processed by the last incremental commit. Collected only for FtFastConfig::incrementalCacheInvalidation
+	vector<string> stepWords_;
 	size_t vodcsOffset_{0};
 	size_t szCnt{0};
 	FtFastConfig* cfg_{nullptr};
@@ -122,15 +145,17 @@ public:
 template <typename IdCont>
 class DataHolder : public IDataHolder {
 public:
-	MergeData Select(FtDSLQuery& dsl, size_t fieldSize, bool needArea, bool inTransaction, const RdxContext&) override;
-	void Process(size_t fieldSize, bool multithread) override;
+	MergeData Select(FtDSLQuery& dsl, size_t fieldSize, bool needArea, size_t topK, bool inTransaction, FtCacheDeps* cacheDeps,
+					 const RdxContext&) override;
+	bool Process(size_t fieldSize, bool multithread, const std::function<bool()>& isCanceled) override;
 	size_t GetMemStat() override;
 	void StartCommit(bool complte_updated) override;
 	void Clear() override;
-	vector<PackedWordEntry<IdCont>>& GetWords() noexcept { return words_; }
+	using WordsVector = std::vector<PackedWordEntry<IdCont>, HugePageAllocator<PackedWordEntry<IdCont>>>;
+	WordsVector& GetWords() noexcept { return words_; }
 	PackedWordEntry<IdCont>& getWordById(WordIdType id);
 
-	vector<PackedWordEntry<IdCont>> words_;
+	WordsVector words_;
 };
 
 extern template class DataHolder<PackedIdRelVec>;
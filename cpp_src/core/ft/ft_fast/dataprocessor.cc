@@ -3,12 +3,14 @@
 #include <chrono>
 #include <functional>
 #include <thread>
+#include "core/ft/bm25.h"
 #include "core/ft/numtotext.h"
 #include "core/ft/typos.h"
 
 #include "tools/logger.h"
 #include "tools/serializer.h"
 #include "tools/stringstools.h"
+#include "tools/threadpool.h"
 
 using std::chrono::high_resolution_clock;
 using std::placeholders::_1;
@@ -20,13 +22,19 @@ namespace reindexer {
 const int kDigitUtfSizeof = 1;
 
 template <typename IdCont>
-void DataProcessor<IdCont>::Process(bool multithread) {
+bool DataProcessor<IdCont>::Process(bool multithread, const std::function<bool()> &isCanceled) {
 	multithread_ = multithread;
 
 	words_map words_um;
 	auto tm0 = high_resolution_clock::now();
 	size_t szCnt = buildWordsMap(words_um);
 	auto tm2 = high_resolution_clock::now();
+	if (isCanceled()) return false;
+	holder_.stepWords_.clear();
+	if (holder_.cfg_->incrementalCacheInvalidation && holder_.status_ != FullRebuild) {
+		holder_.stepWords_.reserve(words_um.size());
+		for (const auto &w : words_um) holder_.stepWords_.emplace_back(w.first);
+	}
 	auto &words = holder_.GetWords();
 
 	holder_.SetWordsOffset(words.size());
@@ -63,6 +71,9 @@ void DataProcessor<IdCont>::Process(bool multithread) {
 				idsetcnt += sizeof(*wIt);
 			}
 
+			for (const auto &relid : keyIt->second.vids_) {
+				word->maxTermCount_ = std::max(word->maxTermCount_, uint32_t(relid.Size()));
+			}
 			word->vids_.insert(word->vids_.end(), keyIt->second.vids_.begin(), keyIt->second.vids_.end());
 			word->vids_.shrink_to_fit();
 
@@ -77,6 +88,7 @@ void DataProcessor<IdCont>::Process(bool multithread) {
 
 	// std::cout << suffixes.dump() << std::endl;
 	idrelsetCommitThread.join();
+	if (isCanceled()) return false;
 
 	// Step 6: Build typos hash map
 	buildTyposMap(wrdOffset, found);
@@ -85,7 +97,7 @@ void DataProcessor<IdCont>::Process(bool multithread) {
 	auto tm5 = high_resolution_clock::now();
 
 	logPrintf(LogInfo, "FastIndexText[%d] built with [%d uniq words, %d typos, %dKB text size, %dKB suffixarray size, %dKB idrelsets size]",
-			  holder_.steps.size(), words_um.size(), holder_.GetTyposHalf().size() + holder_.GetTyposMax().size(), szCnt / 1024,
+			  holder_.steps.size(), words_um.size(), typosCount(), szCnt / 1024,
 			  suffixes.heap_size() / 1024, idsetcnt / 1024);
 
 	logPrintf(LogInfo,
@@ -94,6 +106,7 @@ void DataProcessor<IdCont>::Process(bool multithread) {
 			  duration_cast<milliseconds>(tm5 - tm0).count(), duration_cast<milliseconds>(tm2 - tm0).count(),
 			  duration_cast<milliseconds>(tm5 - tm4).count(), duration_cast<milliseconds>(tm3 - tm2).count(),
 			  duration_cast<milliseconds>(tm4 - tm2).count());
+	return true;
 }
 
 template <typename IdCont>
@@ -139,7 +152,6 @@ size_t DataProcessor<IdCont>::buildWordsMap(words_map &words_um) {
 	size_t szCnt = 0;
 	struct context {
 		words_map words_um;
-		std::thread thread;
 	};
 	std::unique_ptr<context[]> ctxs(new context[maxIndexWorkers]);
 
@@ -196,11 +208,12 @@ size_t DataProcessor<IdCont>::buildWordsMap(words_map &words_um) {
 		worker(0);
 		words_um.swap(ctxs[0].words_um);
 	} else {
-		for (uint32_t t = 0; t < maxIndexWorkers; t++) ctxs[t].thread = std::thread(worker, t);
+		TaskGroup group(maxIndexWorkers);
+		for (uint32_t t = 0; t < maxIndexWorkers; t++) group.Add([&worker, t] { worker(t); });
+		group.Wait();
 		// Merge results into single map
 		for (uint32_t i = 0; i < maxIndexWorkers; i++) {
 			try {
-				ctxs[i].thread.join();
 				for (auto it = ctxs[i].words_um.begin(); it != ctxs[i].words_um.end(); it++) {
 					auto idxIt = words_um.find(it->first);
 
@@ -214,11 +227,11 @@ size_t DataProcessor<IdCont>::buildWordsMap(words_map &words_um) {
 				}
 				words_map().swap(ctxs[i].words_um);
 			} catch (const Error &e) {
-				logPrintf(LogError, "Exeption in loop with thread.join() error= [%s]", e.what());
+				logPrintf(LogError, "Exeption in words maps merge loop error= [%s]", e.what());
 			} catch (const std::exception &e) {
-				logPrintf(LogError, "Exeption in loop with thread.join() error= [%s]", e.what());
+				logPrintf(LogError, "Exeption in words maps merge loop error= [%s]", e.what());
 			} catch (...) {
-				logPrintf(LogError, "Exeption in loop with thread.join()");
+				logPrintf(LogError, "Exeption in words maps merge loop");
 			}
 		}
 	}
@@ -232,6 +245,11 @@ size_t DataProcessor<IdCont>::buildWordsMap(words_map &words_um) {
 			for (int i = 0; i < fieldscount; i++) holder_.avgWordsCount_[i] += vdoc.wordsCount[i];
 		}
 		for (int i = 0; i < fieldscount; i++) holder_.avgWordsCount_[i] /= vdocs.size();
+
+		for (auto &vdoc : vdocs) {
+			vdoc.bm25Norm.resize(fieldscount);
+			for (int i = 0; i < fieldscount; i++) vdoc.bm25Norm[i] = bm25Norm(vdoc.wordsCount[i], holder_.avgWordsCount_[i]);
+		}
 	}
 
 	// Check and print potential stop words
@@ -273,10 +291,22 @@ void DataProcessor<IdCont>::buildTyposMap(uint32_t startPos, const vector<WordId
 	if (!holder_.cfg_->maxTypos) {
 		return;
 	}
+	auto &step = holder_.steps.back();
+	if (holder_.cfg_->compactTypos) {
+		buildTyposMap(startPos, found, step.typosHalfCompact_, step.typosMaxCompact_);
+		step.typosHalfCompact_.commit();
+		step.typosMaxCompact_.commit();
+	} else {
+		buildTyposMap(startPos, found, step.typosHalf_, step.typosMax_);
+		step.typosHalf_.shrink_to_fit();
+		step.typosMax_.shrink_to_fit();
+	}
+}
 
+template <typename IdCont>
+template <typename TyposMap>
+void DataProcessor<IdCont>::buildTyposMap(uint32_t startPos, const vector<WordIdType> &found, TyposMap &typosHalf, TyposMap &typosMax) {
 	typos_context tctx[kMaxTyposInWord];
-	auto &typosHalf = holder_.GetTyposHalf();
-	auto &typosMax = holder_.GetTyposMax();
 	auto &words_ = holder_.GetWords();
 	size_t wordsSize = !found.empty() ? found.size() : words_.size() - startPos;
 
@@ -285,13 +315,13 @@ void DataProcessor<IdCont>::buildTyposMap(uint32_t startPos, const vector<WordId
 	if (maxTyposInWord == halfMaxTypos) {
 		assertrx(maxTyposInWord > 0);
 		const auto multiplicator = wordsSize * (10 << (maxTyposInWord - 1));
-		typosHalf.reserve(multiplicator / 2, multiplicator * 5);
+		reserveTypos(typosHalf, multiplicator);
 	} else {
 		assertrx(maxTyposInWord == halfMaxTypos + 1);
 		auto multiplicator = wordsSize * (10 << (halfMaxTypos > 1 ? (halfMaxTypos - 1) : 0));
-		typosHalf.reserve(multiplicator / 2, multiplicator * 5);
+		reserveTypos(typosHalf, multiplicator);
 		multiplicator = wordsSize * (10 << (maxTyposInWord - 1)) - multiplicator;
-		typosMax.reserve(multiplicator / 2, multiplicator * 5);
+		reserveTypos(typosMax, multiplicator);
 	}
 
 	for (size_t i = 0; i < wordsSize; ++i) {
@@ -313,9 +343,22 @@ void DataProcessor<IdCont>::buildTyposMap(uint32_t startPos, const vector<WordId
 					  }});
 		startPos++;
 	}
+}
+
+template <typename IdCont>
+size_t DataProcessor<IdCont>::typosCount() const noexcept {
+	const auto &step = holder_.steps.back();
+	return step.typosHalf_.size() + step.typosMax_.size() + step.typosHalfCompact_.size() + step.typosMaxCompact_.size();
+}
 
-	typosHalf.shrink_to_fit();
-	typosMax.shrink_to_fit();
+template <typename IdCont>
+void DataProcessor<IdCont>::reserveTypos(flat_str_multimap<char, WordIdType> &typos, size_t multiplicator) {
+	typos.reserve(multiplicator / 2, multiplicator * 5);
+}
+
+template <typename IdCont>
+void DataProcessor<IdCont>::reserveTypos(CompactTyposIndex &typos, size_t multiplicator) {
+	typos.reserve(multiplicator);
 }
 
 template class DataProcessor<PackedIdRelVec>;
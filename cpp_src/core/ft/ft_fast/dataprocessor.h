@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <memory>
 #include <string_view>
 #include "dataholder.h"
@@ -12,7 +13,8 @@ public:
 	using words_map = fast_hash_map<string, WordEntry>;
 	DataProcessor(DataHolder<IdCont>& holder, size_t fieldSize) : holder_(holder), multithread_(false), fieldSize_(fieldSize) {}
 
-	void Process(bool multithread);
+	/// @return false, if processing was canceled
+	bool Process(bool multithread, const std::function<bool()>& isCanceled);
 
 private:
 	size_t buildWordsMap(words_map& m);
@@ -21,6 +23,11 @@ private:
 						  std::vector<string>& output);
 
 	void buildTyposMap(uint32_t startPos, const vector<WordIdType>& found);
+	template <typename TyposMap>
+	void buildTyposMap(uint32_t startPos, const vector<WordIdType>& found, TyposMap& typosHalf, TyposMap& typosMax);
+	static void reserveTypos(flat_str_multimap<char, WordIdType>& typos, size_t multiplicator);
+	static void reserveTypos(CompactTyposIndex& typos, size_t multiplicator);
+	size_t typosCount() const noexcept;
 
 	vector<WordIdType> BuildSuffix(words_map& words_um, DataHolder<IdCont>& holder);
 
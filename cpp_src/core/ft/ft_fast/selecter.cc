@@ -1,11 +1,16 @@
 #include "selecter.h"
 #include "core/ft/bm25.h"
+#include "core/ft/ftsetcashe.h"
 #include "core/ft/typos.h"
 #include "core/rdxcontext.h"
 #include "sort/pdqsort.hpp"
 #include "tools/logger.h"
+#include "tools/workstealingscheduler.h"
 
 namespace {
+// Words with the large count of documents are merged with the deadline checks after each this count of documents
+constexpr int kCancelCheckFrequency = 4096;
+
 static double pos2rank(int pos) {
 	if (pos <= 10) return 1.0 - (pos / 100.0);
 	if (pos <= 100) return 0.9 - (pos / 1000.0);
@@ -35,9 +40,32 @@ void Selecter<IdCont>::prepareVariants(std::vector<FtVariantEntry> &variants, si
 	const FtDSLEntry &term = dsl[termIdx];
 	variants.clear();
 
+	const bool useFilters = synonymsDsl && (!holder_.cfg_->enableNumbersSearch || !term.opts.number);
+	if (useFilters && term.opts.op != OpNot) {
+		holder_.synonyms_->PostProcess(term, dsl, termIdx, *synonymsDsl);
+	}
+	auto addVariants = [&variants, &term](const std::vector<FtVariantsCacheVal::Variant> &expanded) {
+		for (const auto &v : expanded) {
+			variants.push_back({v.pattern, term.opts, v.proc});
+			if (v.pref) variants.back().opts.pref = true;
+			if (v.noSuff) variants.back().opts.suff = false;
+		}
+	};
+
+	// Query stream is usually repetitive, so the expanded variants are cached by the term and the options, which they depend on
+	FtVariantsCacheKey key;
+	utf16_to_utf8(term.pattern, key.term);
+	key.term += '\0';
+	key.term += char('0' + useFilters + 2 * term.opts.exact + 4 * (term.opts.op == OpNot));
+	auto cached = holder_.variantsCache_.Get(key);
+	if (cached.valid && cached.val.variants) {
+		addVariants(*cached.val.variants);
+		return;
+	}
+
 	vector<pair<std::wstring, int>> variantsUtf16{{term.pattern, kFullMatchProc}};
 
-	if (synonymsDsl && (!holder_.cfg_->enableNumbersSearch || !term.opts.number)) {
+	if (useFilters) {
 		// Make translit and kblayout variants
 		if (holder_.cfg_->enableTranslit && !term.opts.exact) {
 			holder_.translit_->GetVariants(term.pattern, variantsUtf16);
@@ -48,16 +76,16 @@ void Selecter<IdCont>::prepareVariants(std::vector<FtVariantEntry> &variants, si
 		// Synonyms
 		if (term.opts.op != OpNot) {
 			holder_.synonyms_->GetVariants(term.pattern, variantsUtf16);
-			holder_.synonyms_->PostProcess(term, dsl, termIdx, *synonymsDsl);
 		}
 	}
 
 	// Apply stemmers
+	auto expanded = std::make_shared<std::vector<FtVariantsCacheVal::Variant>>();
 	string tmpstr, stemstr;
 	for (auto &v : variantsUtf16) {
 		utf16_to_utf8(v.first, tmpstr);
 		if (tmpstr.empty()) continue;
-		variants.push_back({tmpstr, term.opts, v.second});
+		expanded->push_back({tmpstr, v.second, false, false});
 		if (!term.opts.exact) {
 			for (auto &lang : langs) {
 				auto stemIt = holder_.stemmers_.find(lang);
@@ -66,20 +94,24 @@ void Selecter<IdCont>::prepareVariants(std::vector<FtVariantEntry> &variants, si
 				}
 				stemIt->second.stem(tmpstr, stemstr);
 				if (tmpstr != stemstr && !stemstr.empty()) {
-					FtDslOpts opts = term.opts;
-					opts.pref = true;
-
-					if (&v != &variantsUtf16[0]) opts.suff = false;
-
-					variants.push_back({stemstr, opts, v.second - kStemProcDecrease});
+					expanded->push_back({stemstr, v.second - kStemProcDecrease, true, &v != &variantsUtf16[0]});
 				}
 			}
 		}
 	}
+	addVariants(*expanded);
+	if (cached.valid) holder_.variantsCache_.Put(key, {std::move(expanded)});
 }
 
 template <typename IdCont>
-typename IDataHolder::MergeData Selecter<IdCont>::Process(FtDSLQuery &dsl, bool inTransaction, const RdxContext &rdxCtx) {
+typename IDataHolder::MergeData Selecter<IdCont>::Process(FtDSLQuery &dsl, bool inTransaction, FtCacheDeps *cacheDeps,
+														 const RdxContext &rdxCtx) {
+	auto addCacheDeps = [cacheDeps](const std::vector<FtVariantEntry> &variants, const FtDSLEntry &term) {
+		if (!cacheDeps) return;
+		for (const auto &variant : variants) cacheDeps->patterns.emplace_back(variant.pattern);
+		if (term.opts.typos) cacheDeps->typoTerms.emplace_back(term.pattern);
+	};
+	if (cacheDeps) cacheDeps->maxTypos = holder_.cfg_->MaxTyposInWord();
 	FtSelectContext ctx;
 	ctx.rawResults.reserve(dsl.size());
 	// STEP 2: Search dsl terms for each variant
@@ -93,6 +125,7 @@ typename IDataHolder::MergeData Selecter<IdCont>::Process(FtDSLQuery &dsl, bool
 
 		// Prepare term variants (original + translit + stemmed + kblayout + synonym)
 		this->prepareVariants(ctx.variants, i, holder_.cfg_->stemmers, dsl, &synonymsDsl);
+		addCacheDeps(ctx.variants, res.term);
 
 		if (holder_.cfg_->logLevel >= LogInfo) {
 			WrSerializer wrSer;
@@ -132,6 +165,7 @@ typename IDataHolder::MergeData Selecter<IdCont>::Process(FtDSLQuery &dsl, bool
 			synCtx.rawResults.emplace_back();
 			synCtx.rawResults.back().term = synDsl.dsl[i];
 			prepareVariants(synCtx.variants, i, holder_.cfg_->stemmers, synDsl.dsl, nullptr);
+			addCacheDeps(synCtx.variants, synDsl.dsl[i]);
 			if (holder_.cfg_->logLevel >= LogInfo) {
 				WrSerializer wrSer;
 				for (auto &variant : synCtx.variants) {
@@ -158,20 +192,36 @@ typename IDataHolder::MergeData Selecter<IdCont>::Process(FtDSLQuery &dsl, bool
 }
 
 template <typename IdCont>
-void Selecter<IdCont>::processStepVariants(FtSelectContext &ctx, typename DataHolder<IdCont>::CommitStep &step,
-										   const FtVariantEntry &variant, TextSearchResults &res) {
-	if (variant.opts.op == OpAnd) {
-		ctx.foundWords.clear();
-	}
+void Selecter<IdCont>::findStepVariants(typename DataHolder<IdCont>::CommitStep &step, const FtVariantEntry &variant,
+										std::vector<FoundWord> &found) const {
+	found.clear();
 	auto &tmpstr = variant.pattern;
 	auto &suffixes = step.suffixes_;
-	//  Lookup current variant in suffixes array
-	auto keyIt = suffixes.lower_bound(tmpstr);
-
-	int matched = 0, skipped = 0, vids = 0;
 	bool withPrefixes = variant.opts.pref;
 	bool withSuffixes = variant.opts.suff;
 
+	if (!withSuffixes) {
+		// Only the words' beginnings may match, so the sorted words are searched instead of the walk over all of the suffixes
+		const int matchLen = tmpstr.length();
+		const auto range = suffixes.prefix_range(tmpstr);
+		for (auto it = range.first; it != range.second; ++it) {
+			WordIdType glbwordId = suffixes.mapped_at(*it);
+			uint32_t suffixWordId = holder_.GetSuffixWordId(glbwordId, step);
+			const string::value_type *word = suffixes.text_at(*it);
+			int16_t wordLength = suffixes.word_len_at(suffixWordId);
+			// Shorter words go first, so exact match may be only the first one
+			if (!withPrefixes && wordLength != matchLen) break;
+
+			int matchDif = std::abs(long(wordLength - matchLen));
+			int proc = std::max(variant.proc - holder_.cfg_->partialMatchDecrease * matchDif / std::max(matchLen, 3), kPrefixMinProc);
+			found.push_back({glbwordId, word, word, proc, suffixes.virtual_word_len(suffixWordId), false});
+		}
+		return;
+	}
+
+	//  Lookup current variant in suffixes array
+	auto keyIt = suffixes.lower_bound(tmpstr);
+
 	// Walk current variant in suffixes array and fill results
 	do {
 		if (keyIt == suffixes.end()) break;
@@ -186,96 +236,210 @@ void Selecter<IdCont>::processStepVariants(FtSelectContext &ctx, typename DataHo
 		ptrdiff_t suffixLen = keyIt->first - word;
 		const int matchLen = tmpstr.length();
 
-		if (!withSuffixes && suffixLen) continue;
 		if (!withPrefixes && wordLength != matchLen + suffixLen) break;
 
 		int matchDif = std::abs(long(wordLength - matchLen + suffixLen));
 		int proc = std::max(variant.proc - holder_.cfg_->partialMatchDecrease * matchDif / std::max(matchLen, 3),
 							suffixLen ? kSuffixMinProc : kPrefixMinProc);
+		found.push_back({glbwordId, keyIt->first, word, proc, suffixes.virtual_word_len(suffixWordId), suffixLen != 0});
+	} while ((keyIt++).lcp() >= int(tmpstr.length()));
+}
 
-		auto it = ctx.foundWords.find(glbwordId);
+template <typename IdCont>
+void Selecter<IdCont>::addVariantWords(FtSelectContext &ctx, const FtVariantEntry &variant, const std::vector<FoundWord> &found,
+									   TextSearchResults &res) {
+	if (variant.opts.op == OpAnd) {
+		ctx.foundWords.clear();
+	}
+	int matched = 0, skipped = 0, vids = 0;
+	for (const FoundWord &fw : found) {
+		auto it = ctx.foundWords.find(fw.wordId);
 		if (it == ctx.foundWords.end() || it->second.first != ctx.rawResults.size() - 1) {
-			res.push_back({&holder_.getWordById(glbwordId).vids_, keyIt->first, proc, suffixes.virtual_word_len(suffixWordId)});
-			res.idsCnt_ += holder_.getWordById(glbwordId).vids_.size();
-			ctx.foundWords[glbwordId] = std::make_pair(ctx.rawResults.size() - 1, res.size() - 1);
+			const auto &wordEntry = holder_.getWordById(fw.wordId);
+			res.push_back({&wordEntry.vids_, fw.pattern, fw.proc, fw.wordLen, wordEntry.maxTermCount_});
+			res.idsCnt_ += wordEntry.vids_.size();
+			ctx.foundWords[fw.wordId] = std::make_pair(ctx.rawResults.size() - 1, res.size() - 1);
 			if (holder_.cfg_->logLevel >= LogTrace)
-				logPrintf(LogInfo, " matched %s '%s' of word '%s', %d vids, %d%%", suffixLen ? "suffix" : "prefix", keyIt->first, word,
-						  holder_.getWordById(glbwordId).vids_.size(), proc);
+				logPrintf(LogInfo, " matched %s '%s' of word '%s', %d vids, %d%%", fw.suffix ? "suffix" : "prefix", fw.pattern, fw.word,
+						  wordEntry.vids_.size(), fw.proc);
 			matched++;
-			vids += holder_.getWordById(glbwordId).vids_.size();
+			vids += wordEntry.vids_.size();
 		} else {
-			if (ctx.rawResults[it->second.first][it->second.second].proc_ < proc)
-				ctx.rawResults[it->second.first][it->second.second].proc_ = proc;
+			if (ctx.rawResults[it->second.first][it->second.second].proc_ < fw.proc)
+				ctx.rawResults[it->second.first][it->second.second].proc_ = fw.proc;
 			skipped++;
 		}
-	} while ((keyIt++).lcp() >= int(tmpstr.length()));
+	}
 	if (holder_.cfg_->logLevel >= LogInfo)
-		logPrintf(LogInfo, "Lookup variant '%s' (%d%%), matched %d suffixes, with %d vids, skiped %d", tmpstr, variant.proc, matched, vids,
-				  skipped);
+		logPrintf(LogInfo, "Lookup variant '%s' (%d%%), matched %d suffixes, with %d vids, skiped %d", variant.pattern, variant.proc,
+				  matched, vids, skipped);
 }
 
 template <typename IdCont>
 void Selecter<IdCont>::processVariants(FtSelectContext &ctx) {
 	TextSearchResults &res = ctx.rawResults.back();
+	auto &steps = holder_.steps;
+	const size_t lookupsCount = ctx.variants.size() * steps.size();
+	const int workers = holder_.cfg_->selectWorkers;
+
+	if (workers > 1 && lookupsCount > 1 && ctx.variants.size() >= size_t(holder_.cfg_->parallelVariantsThreshold)) {
+		// Suffixes arrays are looked up in parallel, found words are added in the same order as in the single thread
+		std::vector<std::vector<FoundWord>> found(lookupsCount);
+		WorkStealingScheduler scheduler(workers);
+		for (size_t i = 0; i < lookupsCount; ++i) {
+			scheduler.Add(
+				[this, &ctx, &steps, &found, i] { findStepVariants(steps[i % steps.size()], ctx.variants[i / steps.size()], found[i]); });
+		}
+		scheduler.Run(nullptr);
+		for (size_t i = 0; i < lookupsCount; ++i) {
+			addVariantWords(ctx, ctx.variants[i / steps.size()], found[i], res);
+		}
+		return;
+	}
 
+	std::vector<FoundWord> found;
 	for (const FtVariantEntry &variant : ctx.variants) {
-		if (variant.opts.op == OpAnd) {
-			ctx.foundWords.clear();
-		}
-		for (auto &step : holder_.steps) {
-			processStepVariants(ctx, step, variant, res);
+		for (auto &step : steps) {
+			findStepVariants(step, variant, found);
+			addVariantWords(ctx, variant, found, res);
 		}
 	}
 }
 
 template <typename IdCont>
-void Selecter<IdCont>::processTypos(FtSelectContext &ctx, const FtDSLEntry &term) {
-	TextSearchResults &res = ctx.rawResults.back();
+void Selecter<IdCont>::findStepTypos(const typename DataHolder<IdCont>::CommitStep &step, const FtDSLEntry &term,
+									 std::vector<FoundWord> &found) const {
+	found.clear();
+	if (holder_.cfg_->compactTypos) {
+		findStepTypos(step.typosHalfCompact_, step.typosMaxCompact_, term, found);
+	} else {
+		findStepTypos(step.typosHalf_, step.typosMax_, term, found);
+	}
+}
+
+template <typename IdCont>
+template <typename TyposMap>
+void Selecter<IdCont>::findStepTypos(const TyposMap &typosHalf, const TyposMap &typosMax, const FtDSLEntry &term,
+									 std::vector<FoundWord> &found) const {
 	const auto maxTyposInWord = holder_.cfg_->MaxTyposInWord();
 	const bool dontUseMaxTyposForBoth = maxTyposInWord != holder_.cfg_->maxTypos / 2;
 	const size_t patternSize = utf16_to_utf8(term.pattern).size();
-	for (auto &step : holder_.steps) {
-		typos_context tctx[kMaxTyposInWord];
-		const decltype(step.typosHalf_) *typoses[2]{&step.typosHalf_, &step.typosMax_};
-		int matched = 0, skiped = 0, vids = 0;
-		mktypos(tctx, term.pattern, maxTyposInWord, holder_.cfg_->maxTypoLen, [&](std::string_view typo, int level) {
-			const int tcount = maxTyposInWord - level;
-			for (const auto *typos : typoses) {
-				const auto typoRng = typos->equal_range(typo);
-				for (auto typoIt = typoRng.first; typoIt != typoRng.second; typoIt++) {
-					WordIdType wordIdglb = typoIt->second;
-					auto &step = holder_.GetStep(wordIdglb);
-
-					auto wordIdSfx = holder_.GetSuffixWordId(wordIdglb, step);
-
-					// bool virtualWord = suffixes_.is_word_virtual(wordId);
-					uint8_t wordLength = step.suffixes_.word_len_at(wordIdSfx);
-					int proc = kTypoProc - tcount * kTypoStepProc / std::max((wordLength - tcount) / 3, 1);
-					auto it = ctx.foundWords.find(wordIdglb);
-					if (it == ctx.foundWords.end() || it->second.first != ctx.rawResults.size() - 1) {
-						res.push_back(
-							{&holder_.getWordById(wordIdglb).vids_, typoIt->first, proc, step.suffixes_.virtual_word_len(wordIdSfx)});
-						res.idsCnt_ += holder_.getWordById(wordIdglb).vids_.size();
-						ctx.foundWords.emplace(wordIdglb, std::make_pair(ctx.rawResults.size() - 1, res.size() - 1));
-
-						if (holder_.cfg_->logLevel >= LogTrace)
-							logPrintf(LogInfo, " matched typo '%s' of word '%s', %d ids, %d%%", typoIt->first,
-									  step.suffixes_.word_at(wordIdSfx), holder_.getWordById(wordIdglb).vids_.size(), proc);
-						++matched;
-						vids += holder_.getWordById(wordIdglb).vids_.size();
-					} else {
-						++skiped;
-					}
+	typos_context tctx[kMaxTyposInWord];
+	const TyposMap *typoses[2]{&typosHalf, &typosMax};
+	mktypos(tctx, term.pattern, maxTyposInWord, holder_.cfg_->maxTypoLen, [&](std::string_view typo, int level) {
+		const int tcount = maxTyposInWord - level;
+		for (const auto *typos : typoses) {
+			const auto typoRng = typos->equal_range(typo);
+			for (auto typoIt = typoRng.first; typoIt != typoRng.second; typoIt++) {
+				WordIdType wordIdglb;
+				std::string_view pattern;
+				if constexpr (std::is_same_v<TyposMap, CompactTyposIndex>) {
+					wordIdglb = typoIt->wordId;
+				} else {
+					wordIdglb = typoIt->second;
+				}
+				auto &step = holder_.GetStep(wordIdglb);
+
+				auto wordIdSfx = holder_.GetSuffixWordId(wordIdglb, step);
+				const char *word = step.suffixes_.word_at(wordIdSfx);
+
+				// bool virtualWord = suffixes_.is_word_virtual(wordId);
+				uint8_t wordLength = step.suffixes_.word_len_at(wordIdSfx);
+				if constexpr (std::is_same_v<TyposMap, CompactTyposIndex>) {
+					// Compact index contains only typos hashes, so the word has to be checked. Typo itself is not stored, so the word
+					// is used as the matched pattern
+					pattern = std::string_view(word, step.suffixes_.word_len_at(wordIdSfx));
+					if (!CompactTyposIndex::IsTypoOf(typo, pattern, maxTyposInWord)) continue;
+				} else {
+					pattern = typoIt->first;
 				}
-				if (dontUseMaxTyposForBoth && level == 1 && typo.size() != patternSize) return;
+				int proc = kTypoProc - tcount * kTypoStepProc / std::max((wordLength - tcount) / 3, 1);
+				found.push_back({wordIdglb, pattern, word, proc, step.suffixes_.virtual_word_len(wordIdSfx), false});
 			}
-		});
-		if (holder_.cfg_->logLevel >= LogInfo)
-			logPrintf(LogInfo, "Lookup typos, matched %d typos, with %d vids, skiped %d", matched, vids, skiped);
+			if (dontUseMaxTyposForBoth && level == 1 && typo.size() != patternSize) return;
+		}
+	});
+}
+
+template <typename IdCont>
+void Selecter<IdCont>::addTypoWords(FtSelectContext &ctx, const std::vector<FoundWord> &found, TextSearchResults &res) {
+	int matched = 0, skiped = 0, vids = 0;
+	for (const FoundWord &fw : found) {
+		auto it = ctx.foundWords.find(fw.wordId);
+		if (it == ctx.foundWords.end() || it->second.first != ctx.rawResults.size() - 1) {
+			const auto &wordEntry = holder_.getWordById(fw.wordId);
+			res.push_back({&wordEntry.vids_, fw.pattern, fw.proc, fw.wordLen, wordEntry.maxTermCount_});
+			res.idsCnt_ += wordEntry.vids_.size();
+			ctx.foundWords.emplace(fw.wordId, std::make_pair(ctx.rawResults.size() - 1, res.size() - 1));
+
+			if (holder_.cfg_->logLevel >= LogTrace)
+				logPrintf(LogInfo, " matched typo '%s' of word '%s', %d ids, %d%%", fw.pattern, fw.word, wordEntry.vids_.size(), fw.proc);
+			++matched;
+			vids += wordEntry.vids_.size();
+		} else {
+			++skiped;
+		}
+	}
+	if (holder_.cfg_->logLevel >= LogInfo)
+		logPrintf(LogInfo, "Lookup typos, matched %d typos, with %d vids, skiped %d", matched, vids, skiped);
+}
+
+template <typename IdCont>
+void Selecter<IdCont>::processTypos(FtSelectContext &ctx, const FtDSLEntry &term) {
+	TextSearchResults &res = ctx.rawResults.back();
+	auto &steps = holder_.steps;
+	const int workers = holder_.cfg_->selectWorkers;
+	// Count of the typos grows with the pattern's length in power of max typos count
+	size_t typosCount = 1;
+	for (int i = 0; i < holder_.cfg_->MaxTyposInWord(); ++i) typosCount *= term.pattern.size() + 1;
+	if (workers > 1 && steps.size() > 1 && typosCount * steps.size() >= size_t(holder_.cfg_->parallelVariantsThreshold)) {
+		// Typos maps of the commit steps are looked up in parallel, found words are added in the order of steps
+		std::vector<std::vector<FoundWord>> found(steps.size());
+		WorkStealingScheduler scheduler(workers);
+		for (size_t i = 0; i < steps.size(); ++i) {
+			scheduler.Add([this, &steps, &term, &found, i] { findStepTypos(steps[i], term, found[i]); });
+		}
+		scheduler.Run(nullptr);
+		for (const auto &stepFound : found) addTypoWords(ctx, stepFound, res);
+		return;
+	}
+	std::vector<FoundWord> found;
+	for (auto &step : steps) {
+		findStepTypos(step, term, found);
+		addTypoWords(ctx, found, res);
 	}
 }
 
 double bound(double k, double weight, double boost) { return (1.0 - weight) + k * boost * weight; }
+// bound() is linear, so its maximum on the range of k is reached on one of the range ends
+static double maxBound(double kMin, double kMax, double weight, double boost) {
+	return std::max(bound(kMin, weight, boost), bound(kMax, weight, boost));
+}
+
+// Upper bound of the rank, which is calculated by mergeItaration() for any document of the word
+template <typename IdCont>
+double Selecter<IdCont>::wordRankBound(const TextSearchResult &r, const FtDSLEntry &term, double idf) const {
+	const auto &cfg = *holder_.cfg_;
+	const double maxBm25 = idf * bm25MaxScore(r.maxTermCount_);
+	double maxRank = 0.0;
+	size_t fieldsCnt = 0;
+	for (size_t f = 0; f < term.opts.fieldsOpts.size() && f < cfg.fieldsCfg.size(); ++f) {
+		const auto fboost = term.opts.fieldsOpts[f].boost;
+		if (!fboost) continue;
+		const auto &fldCfg = cfg.fieldsCfg[f];
+		const double rank = fboost * r.proc_ * maxBound(0.0, maxBm25, fldCfg.bm25Weight, fldCfg.bm25Boost) * term.opts.boost *
+							bound(term.opts.termLenBoost, fldCfg.termLenWeight, fldCfg.termLenBoost) *
+							maxBound(::pos2rank(INT_MAX), ::pos2rank(0), fldCfg.positionWeight, fldCfg.positionBoost);
+		maxRank = std::max(maxRank, rank);
+		++fieldsCnt;
+	}
+	// Ranks in the other fields are added with decreasing ratio
+	double sumRatio = 1.0;
+	for (double k = cfg.summationRanksByFieldsRatio; fieldsCnt > 1 && k > 0.0; --fieldsCnt, k *= cfg.summationRanksByFieldsRatio) {
+		sumRatio += k;
+	}
+	return maxRank * sumRatio;
+}
 
 template <typename IdCont>
 void Selecter<IdCont>::debugMergeStep(const char *msg, int vid, float normBm25, float normDist, int finalRank, int prevRank) {
@@ -303,6 +467,199 @@ struct Selecter<IdCont>::MergeStatus {
 	int16_t idoffset{0};
 };
 
+template <typename IdCont>
+typename Selecter<IdCont>::TermFieldsRank Selecter<IdCont>::termFieldsRank(const FtDSLEntry &term) const {
+	const auto &cfg = *holder_.cfg_;
+	TermFieldsRank res;
+	res.fields.resize(term.opts.fieldsOpts.size());
+	for (size_t f = 0; f < term.opts.fieldsOpts.size(); ++f) {
+		const auto &fldOpts = term.opts.fieldsOpts[f];
+		if (!fldOpts.boost) continue;
+		assertrx(f < cfg.fieldsCfg.size());
+		auto &fld = res.fields[f];
+		fld.boost = fldOpts.boost;
+		fld.termLenBoost = bound(term.opts.termLenBoost, cfg.fieldsCfg[f].termLenWeight, cfg.fieldsCfg[f].termLenBoost);
+		fld.needSumRank = fldOpts.needSumRank;
+		res.fieldsMask |= uint64_t(1) << f;
+	}
+	return res;
+}
+
+template <typename IdCont>
+double Selecter<IdCont>::calcTermRank(const TextSearchResults &rawRes, const TermFieldsRank &fieldsRank, const TextSearchResult &r,
+									  const IdRelType &relid, double idf, int &field, double &normBm25) const {
+	const auto &vdocs = holder_.vdocs_;
+	const int vid = relid.Id();
+	// Find field with max rank
+	field = 0;
+	normBm25 = 0.0;
+	double termRank = 0.0;
+	bool dontSkipCurTermRank = false;
+	auto termLenBoost = rawRes.term.opts.termLenBoost;
+	h_vector<double, 4> ranksInFields;
+	for (unsigned long long fieldsMask = relid.UsedFieldsMask() & fieldsRank.fieldsMask, f = 0; fieldsMask; ++f, fieldsMask >>= 1) {
+#if defined(__GNUC__) || defined(__clang__)
+		const auto bits = __builtin_ctzll(fieldsMask);
+		f += bits;
+		fieldsMask >>= bits;
+#else
+		while ((fieldsMask & 1) == 0) {
+			++f;
+			fieldsMask >>= 1;
+		}
+#endif
+		assertrx(f < vdocs[vid].bm25Norm.size());
+		const auto &fld = fieldsRank.fields[f];
+		const auto &fldCfg = holder_.cfg_->fieldsCfg[f];
+		// raw bm25
+		const double bm25 =
+			idf * bm25scoreByNorm(relid.WordsInField(f), vdocs[vid].mostFreqWordCount[f], vdocs[vid].wordsCount[f], vdocs[vid].bm25Norm[f]);
+
+		// normalized bm25
+		const double normBm25Tmp = bound(bm25, fldCfg.bm25Weight, fldCfg.bm25Boost);
+
+		const double positionRank = bound(::pos2rank(relid.MinPositionInField(f)), fldCfg.positionWeight, fldCfg.positionBoost);
+
+		termLenBoost = fld.termLenBoost;
+		// final term rank calculation
+		const double termRankTmp = fld.boost * r.proc_ * normBm25Tmp * rawRes.term.opts.boost * termLenBoost * positionRank;
+		const bool needSumRank = fld.needSumRank;
+		if (termRankTmp > termRank) {
+			if (dontSkipCurTermRank) {
+				ranksInFields.push_back(termRank);
+			}
+			field = f;
+			normBm25 = normBm25Tmp;
+			termRank = termRankTmp;
+			dontSkipCurTermRank = needSumRank;
+		} else if (!dontSkipCurTermRank && needSumRank && termRank == termRankTmp) {
+			field = f;
+			normBm25 = normBm25Tmp;
+			dontSkipCurTermRank = true;
+		} else if (termRankTmp && needSumRank) {
+			ranksInFields.push_back(termRankTmp);
+		}
+	}
+	if (!termRank) return termRank;
+	if (holder_.cfg_->summationRanksByFieldsRatio > 0) {
+		std::sort(ranksInFields.begin(), ranksInFields.end());
+		double k = holder_.cfg_->summationRanksByFieldsRatio;
+		for (auto r : ranksInFields) {
+			termRank += (k * r);
+			k *= holder_.cfg_->summationRanksByFieldsRatio;
+		}
+	}
+
+	if (holder_.cfg_->logLevel >= LogTrace) {
+		logPrintf(LogInfo, "Pattern %s, idf %f, termLenBoost %f", r.pattern, idf, termLenBoost);
+	}
+	return termRank;
+}
+
+template <typename IdCont>
+void Selecter<IdCont>::rankWord(const TextSearchResults &rawRes, const TermFieldsRank &fieldsRank, const TextSearchResult &r, double idf,
+								const std::vector<MergeStatus> &statuses, bool hasBeenAnd, std::vector<RankedRelId> &ranked) const {
+	const auto &vdocs = holder_.vdocs_;
+	for (auto &relid : *r.vids_) {
+		const int vid = relid.Id();
+		const MergeStatus &vidStatus = statuses[vid];
+		if ((vidStatus.status == kExcluded) | (hasBeenAnd & (vidStatus.status == 0))) {
+			continue;
+		}
+		if (!vdocs[vid].keyEntry) continue;
+		int field;
+		double normBm25;
+		const double termRank = calcTermRank(rawRes, fieldsRank, r, relid, idf, field, normBm25);
+		if (!termRank) continue;
+		ranked.push_back({IdRelType(std::move(relid)), termRank, normBm25, field});
+	}
+}
+
+template <typename IdCont>
+template <typename RelId>
+void Selecter<IdCont>::mergeTermRank(const TextSearchResults &rawRes, index_t rawResIndex, const TextSearchResult &r, RelId &relid,
+									 double termRank, int field, double normBm25, std::vector<MergeStatus> &statuses,
+									 vector<IDataHolder::MergeInfo> &merged, vector<MergedIdRel> &merged_rd, vector<bool> &curExists,
+									 const bool hasBeenAnd, const bool simple) {
+	const int vid = relid.Id();
+	MergeStatus &vidStatus = statuses[vid];
+
+	// match of 2-rd, and next terms
+	if (!simple && vidStatus.status) {
+		assertrx(relid.Size());
+		auto &curMerged = merged[vidStatus.idoffset];
+		auto &curMrd = merged_rd[vidStatus.idoffset];
+		assertrx(curMrd.cur.Size());
+
+		// Calculate words distance
+		int distance = 0;
+		float normDist = 1;
+
+		if (curMrd.qpos != rawRes.term.opts.qpos) {
+			distance = curMrd.cur.Distance(relid, INT_MAX);
+
+			// Normaized distance
+			normDist = bound(1.0 / double(std::max(distance, 1)), holder_.cfg_->distanceWeight, holder_.cfg_->distanceBoost);
+		}
+		int finalRank = normDist * termRank;
+
+		if (distance <= rawRes.term.opts.distance && (!curExists[vid] || finalRank > curMrd.rank)) {
+			// distance and rank is better, than prev. update rank
+			if (curExists[vid]) {
+				curMerged.proc -= curMrd.rank;
+				debugMergeStep("merged better score ", vid, normBm25, normDist, finalRank, curMrd.rank);
+			} else {
+				debugMergeStep("merged new ", vid, normBm25, normDist, finalRank, curMrd.rank);
+				curMerged.matched++;
+			}
+			curMerged.proc += finalRank;
+			if (needArea_) {
+				for (auto pos : relid.Pos()) {
+					if (!curMerged.holder->AddWord(pos.pos(), r.wordLen_, pos.field())) {
+						break;
+					}
+				}
+			}
+			curMrd.rank = finalRank;
+			curMrd.next = std::move(relid);
+			curExists[vid] = true;
+		} else {
+			debugMergeStep("skiped ", vid, normBm25, normDist, finalRank, curMrd.rank);
+		}
+	}
+	if (int(merged.size()) < holder_.cfg_->mergeLimit && !hasBeenAnd) {
+		const bool currentlyAddedLessRankedMerge =
+			!curExists.empty() && curExists[vid] && merged[vidStatus.idoffset].proc < static_cast<int32_t>(termRank);
+		if (!(simple && currentlyAddedLessRankedMerge) && vidStatus.status) return;
+		// match of 1-st term
+		IDataHolder::MergeInfo info;
+		info.id = vid;
+		info.proc = termRank;
+		info.matched = 1;
+		info.field = field;
+		if (needArea_) {
+			info.holder.reset(new AreaHolder);
+			info.holder->ReserveField(fieldSize_);
+			for (auto pos : relid.Pos()) {
+				info.holder->AddWord(pos.pos(), r.wordLen_, pos.field());
+			}
+		}
+		if (vidStatus.status) {
+			merged[vidStatus.idoffset] = std::move(info);
+		} else {
+			merged.push_back(std::move(info));
+			vidStatus.status = rawResIndex + 1;
+			if (!curExists.empty()) {
+				curExists[vid] = true;
+				vidStatus.idoffset = merged.size() - 1;
+			}
+		}
+		if (simple) return;
+		// prepare for intersect with next terms
+		merged_rd.push_back({IdRelType(std::move(relid)), IdRelType(), int(termRank), rawRes.term.opts.qpos});
+	}
+}
+
 template <typename IdCont>
 void Selecter<IdCont>::mergeItaration(const TextSearchResults &rawRes, index_t rawResIndex, std::vector<MergeStatus> &statuses,
 									  vector<IDataHolder::MergeInfo> &merged, vector<MergedIdRel> &merged_rd, vector<bool> &curExists,
@@ -312,6 +669,7 @@ void Selecter<IdCont>::mergeItaration(const TextSearchResults &rawRes, index_t r
 	const size_t totalDocsCount = vdocs.size();
 	const auto op = rawRes.term.opts.op;
 
+	const TermFieldsRank fieldsRank = termFieldsRank(rawRes.term);
 	curExists.clear();
 	if (!simple || rawRes.size() > 1) {
 		curExists.resize(totalDocsCount, false);
@@ -320,11 +678,78 @@ void Selecter<IdCont>::mergeItaration(const TextSearchResults &rawRes, index_t r
 		if (m_rd.next.Size()) m_rd.cur = std::move(m_rd.next);
 	}
 
-	for (auto &r : rawRes) {
+	// Words of single term query, which are not able to get into the top, are skipped. Full match boost is applied after merge
+	const double fullMatchBoost = holder_.cfg_->fullMatchBoost;
+	const bool skipWords = simple && topK_ && op != OpNot && fullMatchBoost > 0.0;
+	const double fullMatchRatio = skipWords ? std::max(fullMatchBoost, 1.0) / std::min(fullMatchBoost, 1.0) : 1.0;
+	int32_t minTopRank = 0;
+	size_t idsSinceMinTopRank = 0, skippedWords = 0;
+	std::vector<int32_t> topRanks;
+	auto canSkipWord = [&](const TextSearchResult &r, double idf) {
+		return skipWords && wordRankBound(r, rawRes.term, idf) * fullMatchRatio < minTopRank;
+	};
+
+	// Ranks of the large terms' documents are calculated in parallel by the chunks of words, which contain at least
+	// parallelMergeThreshold ids. Ranked documents are merged sequentially in the same order as in the single thread
+	const int workers = holder_.cfg_->selectWorkers;
+	const size_t parallelThreshold = holder_.cfg_->parallelMergeThreshold;
+	const bool parallelRank = workers > 1 && op != OpNot && rawRes.size() > 1 && size_t(rawRes.idsCnt_) >= parallelThreshold;
+	std::vector<std::vector<RankedRelId>> ranked(parallelRank ? rawRes.size() : 0);
+	size_t rankedEnd = 0;
+	int cancelCheckCounter = 0;
+
+	for (size_t wordIdx = 0; wordIdx < rawRes.size(); ++wordIdx) {
+		auto &r = rawRes[wordIdx];
 		if (!inTransaction) ThrowOnCancel(rdxCtx);
 		auto idf = IDF(totalDocsCount, r.vids_->size());
+		if (skipWords) {
+			// Min rank of the top is updated lazily, only if enough ids were merged since the previous update
+			if (merged.size() >= topK_ && idsSinceMinTopRank * 4 >= merged.size()) {
+				topRanks.clear();
+				topRanks.reserve(merged.size());
+				for (const auto &m : merged) topRanks.push_back(m.proc);
+				std::nth_element(topRanks.begin(), topRanks.begin() + topK_ - 1, topRanks.end(), std::greater<int32_t>());
+				minTopRank = topRanks[topK_ - 1];
+				idsSinceMinTopRank = 0;
+			}
+			if (canSkipWord(r, idf)) {
+				++skippedWords;
+				continue;
+			}
+			idsSinceMinTopRank += r.vids_->size();
+		}
+
+		if (parallelRank) {
+			if (wordIdx >= rankedEnd) {
+				// Min rank of the top is not decreased, so the words, skipped at this point, are also skipped by the merge
+				WorkStealingScheduler scheduler(workers);
+				size_t chunkIds = 0;
+				for (rankedEnd = wordIdx; rankedEnd < rawRes.size() && chunkIds < parallelThreshold; ++rankedEnd) {
+					const auto &word = rawRes[rankedEnd];
+					const double wordIdf = IDF(totalDocsCount, word.vids_->size());
+					if (canSkipWord(word, wordIdf)) continue;
+					chunkIds += word.vids_->size();
+					scheduler.Add([this, &rawRes, &fieldsRank, &word, wordIdf, &statuses, hasBeenAnd, &wordRanked = ranked[rankedEnd],
+								   inTransaction, &rdxCtx] {
+						if (!inTransaction) ThrowOnCancel(rdxCtx);
+						rankWord(rawRes, fieldsRank, word, wordIdf, statuses, hasBeenAnd, wordRanked);
+					});
+				}
+				scheduler.Run(nullptr);
+			}
+			for (auto &rr : ranked[wordIdx]) {
+				mergeTermRank(rawRes, rawResIndex, r, rr.relid, rr.rank, rr.field, rr.normBm25, statuses, merged, merged_rd, curExists,
+							  hasBeenAnd, simple);
+			}
+			ranked[wordIdx] = std::vector<RankedRelId>();
+			continue;
+		}
 
 		for (auto &relid : *r.vids_) {
+			if (!inTransaction && ++cancelCheckCounter == kCancelCheckFrequency) {
+				cancelCheckCounter = 0;
+				ThrowOnCancel(rdxCtx);
+			}
 			static_assert((std::is_same_v<IdCont, IdRelVec> && std::is_same_v<decltype(relid), const IdRelType &>) ||
 							  (std::is_same_v<IdCont, PackedIdRelVec> && std::is_same_v<decltype(relid), IdRelType &>),
 						  "Expecting relid is movable for packed vector and not movable for simple vector");
@@ -344,162 +769,64 @@ void Selecter<IdCont>::mergeItaration(const TextSearchResults &rawRes, index_t r
 				continue;
 			}
 			if (!vdocs[vid].keyEntry) continue;
-			// Find field with max rank
-			int field = 0;
-			double normBm25 = 0.0, termRank = 0.0;
-			bool dontSkipCurTermRank = false;
-			auto termLenBoost = rawRes.term.opts.termLenBoost;
-			h_vector<double, 4> ranksInFields;
-			for (unsigned long long fieldsMask = relid.UsedFieldsMask(), f = 0; fieldsMask; ++f, fieldsMask >>= 1) {
-#if defined(__GNUC__) || defined(__clang__)
-				const auto bits = __builtin_ctzll(fieldsMask);
-				f += bits;
-				fieldsMask >>= bits;
-#else
-				while ((fieldsMask & 1) == 0) {
-					++f;
-					fieldsMask >>= 1;
-				}
-#endif
-				assertrx(f < vdocs[vid].wordsCount.size());
-				assertrx(f < rawRes.term.opts.fieldsOpts.size());
-				const auto fboost = rawRes.term.opts.fieldsOpts[f].boost;
-				if (fboost) {
-					assertrx(f < holder_.cfg_->fieldsCfg.size());
-					const auto &fldCfg = holder_.cfg_->fieldsCfg[f];
-					// raw bm25
-					const double bm25 = idf * bm25score(relid.WordsInField(f), vdocs[vid].mostFreqWordCount[f], vdocs[vid].wordsCount[f],
-														holder_.avgWordsCount_[f]);
-
-					// normalized bm25
-					const double normBm25Tmp = bound(bm25, fldCfg.bm25Weight, fldCfg.bm25Boost);
-
-					const double positionRank = bound(::pos2rank(relid.MinPositionInField(f)), fldCfg.positionWeight, fldCfg.positionBoost);
-
-					termLenBoost = bound(rawRes.term.opts.termLenBoost, fldCfg.termLenWeight, fldCfg.termLenBoost);
-					// final term rank calculation
-					const double termRankTmp = fboost * r.proc_ * normBm25Tmp * rawRes.term.opts.boost * termLenBoost * positionRank;
-					const bool needSumRank = rawRes.term.opts.fieldsOpts[f].needSumRank;
-					if (termRankTmp > termRank) {
-						if (dontSkipCurTermRank) {
-							ranksInFields.push_back(termRank);
-						}
-						field = f;
-						normBm25 = normBm25Tmp;
-						termRank = termRankTmp;
-						dontSkipCurTermRank = needSumRank;
-					} else if (!dontSkipCurTermRank && needSumRank && termRank == termRankTmp) {
-						field = f;
-						normBm25 = normBm25Tmp;
-						dontSkipCurTermRank = true;
-					} else if (termRankTmp && needSumRank) {
-						ranksInFields.push_back(termRankTmp);
-					}
-				}
-			}
+			int field;
+			double normBm25;
+			const double termRank = calcTermRank(rawRes, fieldsRank, r, relid, idf, field, normBm25);
 			if (!termRank) continue;
-			if (holder_.cfg_->summationRanksByFieldsRatio > 0) {
-				std::sort(ranksInFields.begin(), ranksInFields.end());
-				double k = holder_.cfg_->summationRanksByFieldsRatio;
-				for (auto r : ranksInFields) {
-					termRank += (k * r);
-					k *= holder_.cfg_->summationRanksByFieldsRatio;
-				}
-			}
-
-			if (holder_.cfg_->logLevel >= LogTrace) {
-				logPrintf(LogInfo, "Pattern %s, idf %f, termLenBoost %f", r.pattern, idf, termLenBoost);
-			}
-
-			// match of 2-rd, and next terms
-			if (!simple && vidStatus.status) {
-				assertrx(relid.Size());
-				auto &curMerged = merged[vidStatus.idoffset];
-				auto &curMrd = merged_rd[vidStatus.idoffset];
-				assertrx(curMrd.cur.Size());
-
-				// Calculate words distance
-				int distance = 0;
-				float normDist = 1;
-
-				if (curMrd.qpos != rawRes.term.opts.qpos) {
-					distance = curMrd.cur.Distance(relid, INT_MAX);
-
-					// Normaized distance
-					normDist = bound(1.0 / double(std::max(distance, 1)), holder_.cfg_->distanceWeight, holder_.cfg_->distanceBoost);
-				}
-				int finalRank = normDist * termRank;
-
-				if (distance <= rawRes.term.opts.distance && (!curExists[vid] || finalRank > curMrd.rank)) {
-					// distance and rank is better, than prev. update rank
-					if (curExists[vid]) {
-						curMerged.proc -= curMrd.rank;
-						debugMergeStep("merged better score ", vid, normBm25, normDist, finalRank, curMrd.rank);
-					} else {
-						debugMergeStep("merged new ", vid, normBm25, normDist, finalRank, curMrd.rank);
-						curMerged.matched++;
-					}
-					curMerged.proc += finalRank;
-					if (needArea_) {
-						for (auto pos : relid.Pos()) {
-							if (!curMerged.holder->AddWord(pos.pos(), r.wordLen_, pos.field())) {
-								break;
-							}
-						}
-					}
-					curMrd.rank = finalRank;
-					curMrd.next = std::move(relid);
-					curExists[vid] = true;
-				} else {
-					debugMergeStep("skiped ", vid, normBm25, normDist, finalRank, curMrd.rank);
-				}
-			}
-			if (int(merged.size()) < holder_.cfg_->mergeLimit && !hasBeenAnd) {
-				const bool currentlyAddedLessRankedMerge =
-					!curExists.empty() && curExists[vid] && merged[vidStatus.idoffset].proc < static_cast<int32_t>(termRank);
-				if (!(simple && currentlyAddedLessRankedMerge) && vidStatus.status) continue;
-				// match of 1-st term
-				IDataHolder::MergeInfo info;
-				info.id = vid;
-				info.proc = termRank;
-				info.matched = 1;
-				info.field = field;
-				if (needArea_) {
-					info.holder.reset(new AreaHolder);
-					info.holder->ReserveField(fieldSize_);
-					for (auto pos : relid.Pos()) {
-						info.holder->AddWord(pos.pos(), r.wordLen_, pos.field());
-					}
-				}
-				if (vidStatus.status) {
-					merged[vidStatus.idoffset] = std::move(info);
-				} else {
-					merged.push_back(std::move(info));
-					vidStatus.status = rawResIndex + 1;
-					if (!curExists.empty()) {
-						curExists[vid] = true;
-						vidStatus.idoffset = merged.size() - 1;
-					}
-				}
-				if (simple) continue;
-				// prepare for intersect with next terms
-				merged_rd.push_back({IdRelType(std::move(relid)), IdRelType(), int(termRank), rawRes.term.opts.qpos});
-			}
+			mergeTermRank(rawRes, rawResIndex, r, relid, termRank, field, normBm25, statuses, merged, merged_rd, curExists, hasBeenAnd,
+						  simple);
 		}
 	}
+	if (skippedWords && holder_.cfg_->logLevel >= LogInfo) {
+		logPrintf(LogInfo, "Top %d merge: skipped %d of %d words with rank less than %d", topK_, skippedWords, rawRes.size(), minTopRank);
+	}
 }
 
 template <typename IdCont>
 typename IDataHolder::MergeData Selecter<IdCont>::mergeResults(vector<TextSearchResults> &rawResults,
 															   const std::vector<size_t> &synonymsBounds, bool inTransaction,
 															   const RdxContext &rdxCtx) {
+	if (!needArea_ || !topK_) {
+		return mergeResults(rawResults, synonymsBounds, std::vector<MergeStatus>(holder_.vdocs_.size()), inTransaction, rdxCtx);
+	}
+
+	// Snippets and highlights are built only for the returned documents, so the areas of the limited query are not collected
+	// for all of the found documents. Top is selected without areas and then the top documents are merged once again with areas
+	needArea_ = false;
+	auto merged = mergeResults(rawResults, synonymsBounds, std::vector<MergeStatus>(holder_.vdocs_.size()), inTransaction, rdxCtx);
+	needArea_ = true;
+	if (merged.empty()) return merged;
+
+	std::vector<MergeStatus> statuses(holder_.vdocs_.size(), MergeStatus{kExcluded, 0});
+	fast_hash_map<IdType, size_t> topPos;
+	topPos.reserve(merged.size());
+	for (size_t i = 0; i < merged.size(); ++i) {
+		statuses[merged[i].id].status = 0;
+		topPos.emplace(merged[i].id, i);
+	}
+	// Merge of the documents is independent of each other, so the top documents get the same ranks and areas as in the full merge
+	const size_t topK = topK_;
+	topK_ = 0;
+	auto withAreas = mergeResults(rawResults, synonymsBounds, std::move(statuses), inTransaction, rdxCtx);
+	topK_ = topK;
+	for (auto &m : withAreas) {
+		auto it = topPos.find(m.id);
+		if (it != topPos.end()) merged[it->second].holder = std::move(m.holder);
+	}
+	return merged;
+}
+
+template <typename IdCont>
+typename IDataHolder::MergeData Selecter<IdCont>::mergeResults(vector<TextSearchResults> &rawResults,
+															   const std::vector<size_t> &synonymsBounds,
+															   std::vector<MergeStatus> &&statuses, bool inTransaction,
+															   const RdxContext &rdxCtx) {
 	const auto &vdocs = holder_.vdocs_;
 	IDataHolder::MergeData merged;
 
 	if (!rawResults.size() || !vdocs.size()) return merged;
 
 	assertrx(kExcluded > rawResults.size());
-	std::vector<MergeStatus> statuses(vdocs.size());
 	std::vector<MergedIdRel> merged_rd;
 
 	int idsMaxCnt = 0;
@@ -567,8 +894,13 @@ typename IDataHolder::MergeData Selecter<IdCont>::mergeResults(vector<TextSearch
 		}
 	}
 
-	boost::sort::pdqsort(merged.begin(), merged.end(),
-						 [](const IDataHolder::MergeInfo &lhs, const IDataHolder::MergeInfo &rhs) { return lhs.proc > rhs.proc; });
+	const auto byRank = [](const IDataHolder::MergeInfo &lhs, const IDataHolder::MergeInfo &rhs) { return lhs.proc > rhs.proc; };
+	// Max rank is already calculated, so documents out of the top may be dropped without changing of the resulting relevancy
+	if (topK_ && merged.size() > topK_) {
+		std::nth_element(merged.begin(), merged.begin() + topK_, merged.end(), byRank);
+		merged.erase(merged.begin() + topK_, merged.end());
+	}
+	boost::sort::pdqsort(merged.begin(), merged.end(), byRank);
 
 	return merged;
 }
@@ -13,13 +13,15 @@ class Selecter {
 	typedef fast_hash_map<WordIdType, pair<size_t, size_t>, WordIdTypeHash, WordIdTypequal> FondWordsType;
 
 public:
-	Selecter(DataHolder<IdCont>& holder, size_t fieldSize, bool needArea) : holder_(holder), fieldSize_(fieldSize), needArea_(needArea) {}
+	Selecter(DataHolder<IdCont>& holder, size_t fieldSize, bool needArea, size_t topK = 0)
+		: holder_(holder), fieldSize_(fieldSize), needArea_(needArea), topK_(topK) {}
 
 	struct TextSearchResult {
 		const IdCont* vids_;
 		std::string_view pattern;
 		int proc_;
 		int16_t wordLen_;
+		uint32_t maxTermCount_;
 	};
 
 	// Intermediate information about found document in current merge step. Used only for queries with 2 or more terms
@@ -42,7 +44,7 @@ public:
 		std::vector<size_t> synonymsGroups;
 	};
 
-	IDataHolder::MergeData Process(FtDSLQuery& dsl, bool inTransaction, const RdxContext&);
+	IDataHolder::MergeData Process(FtDSLQuery& dsl, bool inTransaction, FtCacheDeps* cacheDeps, const RdxContext&);
 	struct FtSelectContext {
 		vector<FtVariantEntry> variants;
 
@@ -52,22 +54,71 @@ public:
 	IDataHolder::MergeData mergeResults(vector<TextSearchResults>& rawResults, const std::vector<size_t>& synonymsBounds,
 										bool inTransaction, const RdxContext&);
 	struct MergeStatus;
+	// @param statuses - initial statuses of the documents. Documents with kExcluded status are not merged
+	IDataHolder::MergeData mergeResults(vector<TextSearchResults>& rawResults, const std::vector<size_t>& synonymsBounds,
+										std::vector<MergeStatus>&& statuses, bool inTransaction, const RdxContext&);
+	// Document's match with the word, which is ranked before the merge
+	struct RankedRelId {
+		IdRelType relid;
+		double rank;
+		double normBm25;
+		int field;
+	};
+	// Factors of the term's rank in the fields, which don't depend on the document. Calculated once per term before its merge
+	struct TermFieldsRank {
+		struct Field {
+			double boost = 0.0;
+			double termLenBoost = 0.0;
+			bool needSumRank = false;
+		};
+		h_vector<Field, 8> fields;
+		// Fields with non-zero boost. Matches in the other fields are not ranked
+		uint64_t fieldsMask = 0;
+	};
+	TermFieldsRank termFieldsRank(const FtDSLEntry& term) const;
+	// @return rank of the document's match with the word or 0, if the match has to be skipped
+	double calcTermRank(const TextSearchResults& rawRes, const TermFieldsRank& fieldsRank, const TextSearchResult& r, const IdRelType& relid,
+						double idf, int& field, double& normBm25) const;
+	void rankWord(const TextSearchResults& rawRes, const TermFieldsRank& fieldsRank, const TextSearchResult& r, double idf,
+				  const std::vector<MergeStatus>& statuses, bool hasBeenAnd, std::vector<RankedRelId>& ranked) const;
+	template <typename RelId>
+	void mergeTermRank(const TextSearchResults& rawRes, index_t rawResIndex, const TextSearchResult& r, RelId& relid, double termRank,
+					   int field, double normBm25, std::vector<MergeStatus>& statuses, vector<IDataHolder::MergeInfo>& merged,
+					   vector<MergedIdRel>& merged_rd, vector<bool>& curExists, bool hasBeenAnd, bool simple);
 	void mergeItaration(const TextSearchResults& rawRes, index_t rawResIndex, std::vector<MergeStatus>& statuses,
 						vector<IDataHolder::MergeInfo>& merged, vector<MergedIdRel>& merged_rd, vector<bool>& curExists, bool hasBeenAnd,
 						bool simple, bool inTransaction, const RdxContext&);
 
+	double wordRankBound(const TextSearchResult&, const FtDSLEntry& term, double idf) const;
 	void debugMergeStep(const char* msg, int vid, float normBm25, float normDist, int finalRank, int prevRank);
+	// Word, which is found by the term's variant or typo
+	struct FoundWord {
+		WordIdType wordId;
+		std::string_view pattern;
+		const char* word;
+		int proc;
+		int16_t wordLen;
+		bool suffix;
+	};
 	void processVariants(FtSelectContext&);
 	void prepareVariants(std::vector<FtVariantEntry>&, size_t termIdx, const std::vector<string>& langs, const FtDSLQuery&,
 						 std::vector<SynonymsDsl>*);
-	void processStepVariants(FtSelectContext& ctx, typename DataHolder<IdCont>::CommitStep& step, const FtVariantEntry& variant,
-							 TextSearchResults& res);
+	// Lookups of the words are read only, so they may be executed in parallel. Found words are added to the results sequentially
+	void findStepVariants(typename DataHolder<IdCont>::CommitStep& step, const FtVariantEntry& variant,
+						  std::vector<FoundWord>& found) const;
+	void addVariantWords(FtSelectContext& ctx, const FtVariantEntry& variant, const std::vector<FoundWord>& found, TextSearchResults& res);
 
 	void processTypos(FtSelectContext&, const FtDSLEntry&);
+	void findStepTypos(const typename DataHolder<IdCont>::CommitStep& step, const FtDSLEntry& term, std::vector<FoundWord>& found) const;
+	template <typename TyposMap>
+	void findStepTypos(const TyposMap& typosHalf, const TyposMap& typosMax, const FtDSLEntry& term, std::vector<FoundWord>& found) const;
+	void addTypoWords(FtSelectContext& ctx, const std::vector<FoundWord>& found, TextSearchResults& res);
 
 	DataHolder<IdCont>& holder_;
 	size_t fieldSize_;
 	bool needArea_;
+	// Count of the best ranked documents, required by query. Documents out of the top are not returned (0 - all documents are returned)
+	size_t topK_;
 };
 
 extern template class Selecter<PackedIdRelVec>;
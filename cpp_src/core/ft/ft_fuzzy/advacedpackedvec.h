@@ -1,9 +1,7 @@
 #pragma once
 #include <limits.h>
-#include "estl/packed_vector.h"
+#include "core/ft/idrelset.h"
 namespace reindexer {
-class IdRelSet;
-class IdRelType;
 
 class AdvacedPackedVec : public packed_vector<IdRelType> {
 public:
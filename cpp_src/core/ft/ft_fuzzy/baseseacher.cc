@@ -151,5 +151,5 @@ void BaseSearcher::AddIndex(BaseHolder::Ptr holder, std::string_view src_data, c
 	holder->SetSize(total_size, id, field);
 }
 
-void BaseSearcher::Commit(BaseHolder::Ptr holder) { holder->Commit(); }
+void BaseSearcher::Commit(BaseHolder::Ptr holder, int workers) { holder->Commit(workers); }
 }  // namespace search_engine
@@ -21,7 +21,7 @@ public:
 	void AddIndex(BaseHolder::Ptr holder, std::string_view src_data, const IdType id, int field, const string &extraWordSymbols);
 	SearchResult Compare(BaseHolder::Ptr holder, const reindexer::FtDSLQuery &dsl, bool inTransaction, const reindexer::RdxContext &);
 
-	void Commit(BaseHolder::Ptr holder);
+	void Commit(BaseHolder::Ptr holder, int workers);
 
 private:
 #ifdef FULL_LOG_FT
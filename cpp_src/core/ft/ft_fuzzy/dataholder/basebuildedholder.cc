@@ -1,4 +1,5 @@
 #include "basebuildedholder.h"
+#include "tools/workstealingscheduler.h"
 
 namespace search_engine {
 using std::move;
@@ -33,11 +34,53 @@ void BaseHolder::AddDada(const wchar_t *key, VDocIdType id, int pos, int field)
 #endif
 }
 
-void BaseHolder::Commit() {
+void BaseHolder::MergeTemp(BaseHolder &other) {
+	for (auto &val : other.tmp_data_) {
+		auto it = tmp_data_.find(val.first);
+		if (it == tmp_data_.end()) {
+			tmp_data_.emplace(val.first, move(val.second));
+			continue;
+		}
+		// Documents' ids of the other holder are greater, so the ids set remains sorted
+		auto &ids = it->second;
+		ids.insert(ids.end(), std::make_move_iterator(val.second.begin()), std::make_move_iterator(val.second.end()));
+		ids.max_id_ = std::max(ids.max_id_, val.second.max_id_);
+		ids.min_id_ = std::min(ids.min_id_, val.second.min_id_);
+	}
+	for (auto &doc : other.words_) {
+		auto &fields = words_[doc.first];
+		for (auto &field : doc.second) fields[field.first] += field.second;
+	}
+	other.Clear();
+	other.words_.clear();
+}
+
+void BaseHolder::Commit(int workers) {
 	data_.reserve(tmp_data_.size());
 	data_.clear();
-	for (auto &val : tmp_data_) {
-		data_.insert(std::make_pair(val.first, AdvacedPackedVec(move(val.second))));
+	if (workers <= 1 || tmp_data_.size() < size_t(workers)) {
+		for (auto &val : tmp_data_) {
+			data_.insert(std::make_pair(val.first, AdvacedPackedVec(move(val.second))));
+		}
+	} else {
+		// Sorting and packing of the ids sets is done in parallel, insertion into the map is sequential
+		vector<data_map<IdRelSet>::iterator> its;
+		its.reserve(tmp_data_.size());
+		for (auto it = tmp_data_.begin(); it != tmp_data_.end(); ++it) its.push_back(it);
+		vector<unique_ptr<AdvacedPackedVec>> packed(its.size());
+		const size_t tasksCount = size_t(workers) * 4;
+		const size_t chunkSize = (its.size() + tasksCount - 1) / tasksCount;
+		WorkStealingScheduler scheduler(workers);
+		for (size_t begin = 0; begin < its.size(); begin += chunkSize) {
+			scheduler.Add([&its, &packed, begin, end = std::min(begin + chunkSize, its.size())] {
+				for (size_t i = begin; i < end; ++i) packed[i].reset(new AdvacedPackedVec(move(its[i]->second)));
+			});
+		}
+		scheduler.Run(nullptr);
+		for (size_t i = 0; i < its.size(); ++i) {
+			data_.insert(std::make_pair(its[i]->first, move(*packed[i])));
+			packed[i].reset();
+		}
 	}
 
 	ClearTemp();
@@ -72,7 +72,10 @@ public:
 	DIt GetData(const wchar_t *key);
 	void SetSize(uint32_t size, VDocIdType id, int filed);
 	void AddDada(const wchar_t *key, VDocIdType id, int pos, int field);
-	void Commit();
+	// Moves temporary data of the holder, which was built from the documents with greater ids
+	void MergeTemp(BaseHolder &other);
+	// @param workers - count of threads for the ids sets packing
+	void Commit(int workers = 0);
 
 public:
 	data_map<IdRelSet> tmp_data_;
@@ -7,6 +7,7 @@
 #include "estl/fast_hash_set.h"
 #include "math.h"
 #include "sort/pdqsort.hpp"
+#include "tools/workstealingscheduler.h"
 
 namespace search_engine {
 
@@ -74,8 +75,70 @@ void MergedData::Add(const IDCtx& ctx) {
 	first_ = false;
 }
 
+// Unpacking of the ids sets is not worth it for the smaller results
+constexpr size_t kMinParallelMergeIds = 100000;
+
 BaseMerger::BaseMerger(int max_id, int min_id) : max_id_(max_id), min_id_(min_id) {}
 
+std::shared_ptr<std::vector<MergedData>> BaseMerger::mergeParallel(MergeCtx& ctx, double& maxProc, bool inTransaction,
+																	const reindexer::RdxContext& rdxCtx) {
+	const int workers = ctx.cfg->selectWorkers;
+	const auto& results = *ctx.results;
+	// Packed ids sets can not be searched, so they are unpacked first
+	std::vector<std::vector<IdRelType>> unpacked(results.size());
+	{
+		WorkStealingScheduler scheduler(workers);
+		for (size_t i = 0; i < results.size(); ++i) {
+			scheduler.Add([&data = *results[i].data, &ids = unpacked[i], inTransaction, &rdxCtx] {
+				if (!inTransaction) ThrowOnCancel(rdxCtx);
+				ids.reserve(data.size());
+				for (auto& relid : data) ids.emplace_back(std::move(relid));
+			});
+		}
+		scheduler.Run(nullptr);
+	}
+
+	const size_t tasksCount = size_t(workers) * 4;
+	const size_t rangeSize = (size_t(max_id_ - min_id_) + tasksCount) / tasksCount;
+	std::vector<std::shared_ptr<std::vector<MergedData>>> parts(tasksCount);
+	std::vector<double> partsMaxProc(tasksCount, 0);
+	WorkStealingScheduler scheduler(workers);
+	for (size_t t = 0; t < tasksCount; ++t) {
+		const int first = min_id_ + t * rangeSize;
+		if (first > max_id_) break;
+		const int last = std::min(max_id_, int(first + rangeSize - 1));
+		scheduler.Add([&, t, first, last] {
+			DataSet<MergedData> dataSet(first, last);
+			for (size_t i = 0; i < results.size(); ++i) {
+				if (!inTransaction) ThrowOnCancel(rdxCtx);
+				const auto& res = results[i];
+				const auto& ids = unpacked[i];
+				auto it = std::lower_bound(ids.cbegin(), ids.cend(), first,
+										   [](const IdRelType& relid, int id) { return int(relid.Id()) < id; });
+				for (; it != ids.cend() && int(it->Id()) <= last; ++it) {
+					IDCtx idCtx{&it->Pos(), res.pos, &partsMaxProc[t], ctx.total_size, res.opts, *ctx.cfg, res.proc, ctx.sizes};
+					dataSet.AddData(it->Id(), idCtx);
+				}
+			}
+			parts[t] = std::move(dataSet.data_);
+		});
+	}
+	scheduler.Run(nullptr);
+
+	size_t totalSize = 0;
+	for (const auto& part : parts) {
+		if (part) totalSize += part->size();
+	}
+	auto merged = std::make_shared<std::vector<MergedData>>();
+	merged->reserve(totalSize);
+	for (size_t t = 0; t < tasksCount; ++t) {
+		if (!parts[t]) continue;
+		merged->insert(merged->end(), std::make_move_iterator(parts[t]->begin()), std::make_move_iterator(parts[t]->end()));
+		maxProc = std::max(maxProc, partsMaxProc[t]);
+	}
+	return merged;
+}
+
 SearchResult BaseMerger::Merge(MergeCtx& ctx, bool inTransaction, const reindexer::RdxContext& rdxCtx) {
 	SearchResult res;
 	res.data_ = std::make_shared<std::vector<MergedData>>();
@@ -83,25 +146,31 @@ SearchResult BaseMerger::Merge(MergeCtx& ctx, bool inTransaction, const reindexe
 	if (min_id_ > max_id_) {
 		return res;
 	}
-	DataSet<MergedData> data_set(min_id_, max_id_);
-	int pos = 0;
 	double max_proc = 0;
-	for (auto& res : *ctx.results) {
-		if (!inTransaction) ThrowOnCancel(rdxCtx);
-		for (auto it = res.data->begin(); it != res.data->end(); ++it) {
-			IDCtx id_ctx{&it->Pos(), res.pos, &max_proc, ctx.total_size, res.opts, *ctx.cfg, res.proc, ctx.sizes};
-
-			data_set.AddData(it->Id(), id_ctx);
-			pos++;
+	size_t idsCount = 0;
+	for (auto& res : *ctx.results) idsCount += res.data->size();
+	std::shared_ptr<std::vector<MergedData>> merged;
+	if (ctx.cfg->selectWorkers > 1 && idsCount >= kMinParallelMergeIds) {
+		merged = mergeParallel(ctx, max_proc, inTransaction, rdxCtx);
+	} else {
+		DataSet<MergedData> data_set(min_id_, max_id_);
+		for (auto& res : *ctx.results) {
+			if (!inTransaction) ThrowOnCancel(rdxCtx);
+			for (auto it = res.data->begin(); it != res.data->end(); ++it) {
+				IDCtx id_ctx{&it->Pos(), res.pos, &max_proc, ctx.total_size, res.opts, *ctx.cfg, res.proc, ctx.sizes};
+
+				data_set.AddData(it->Id(), id_ctx);
+			}
 		}
+		merged = std::move(data_set.data_);
 	}
-	boost::sort::pdqsort(data_set.data_->begin(), data_set.data_->end(), [](const MergedData& lhs, const MergedData& rhs) {
+	boost::sort::pdqsort(merged->begin(), merged->end(), [](const MergedData& lhs, const MergedData& rhs) {
 		if (lhs.proc_ == rhs.proc_) {
 			return lhs.id_ < rhs.id_;
 		}
 		return lhs.proc_ > rhs.proc_;
 	});
 
-	return SearchResult{data_set.data_, max_proc};
+	return SearchResult{merged, max_proc};
 }
 }  // namespace search_engine
@@ -79,6 +79,9 @@ public:
 	SearchResult Merge(MergeCtx &ctx, bool inTransaction, const RdxContext &);
 
 private:
+	// Documents are merged by the ranges of ids, so each of the documents is processed by single thread in the same order
+	std::shared_ptr<std::vector<MergedData>> mergeParallel(MergeCtx &ctx, double &maxProc, bool inTransaction, const RdxContext &);
+
 	int max_id_;
 	int min_id_;
 };
@@ -4,7 +4,7 @@
 #include <vector>
 namespace search_engine {
 
-template <class T, class Base = uint16_t>
+template <class T, class Base = uint32_t>
 class DataSet {
 public:
 	DataSet(int minval, int maxval) : minval_(minval), exists_(maxval - minval + 1, false), offsets_(maxval - minval + 1) {
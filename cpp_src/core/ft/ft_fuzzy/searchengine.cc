@@ -5,6 +5,7 @@
 #include <string_view>
 #include "core/ft/filters/kblayout.h"
 #include "core/ft/filters/translit.h"
+#include "tools/workstealingscheduler.h"
 
 namespace search_engine {
 
@@ -25,9 +26,42 @@ void SearchEngine::AddData(std::string_view src_data, const IdType id, int field
 	}
 	seacher_.AddIndex(holder_, src_data, id, field, extraWordSymbols);
 }
-void SearchEngine::Commit() {
+// Smaller ranges are not worth the merge of the separately built data
+constexpr size_t kMinDocsPerBuildTask = 1000;
+
+void SearchEngine::AddData(const vector<DocFields> &docs, IdType firstId, const string &extraWordSymbols, int workers) {
+	if (commited_) {
+		commited_ = false;
+		holder_->Clear();
+	}
+	const size_t tasksCount = std::min(size_t(std::max(workers, 1)) * 4, docs.size() / kMinDocsPerBuildTask);
+	if (workers <= 1 || tasksCount <= 1) {
+		for (size_t i = 0; i < docs.size(); ++i) {
+			for (auto &field : docs[i]) seacher_.AddIndex(holder_, field.first, firstId + i, field.second, extraWordSymbols);
+		}
+		return;
+	}
+
+	vector<BaseHolder::Ptr> parts(tasksCount);
+	const size_t chunkSize = (docs.size() + tasksCount - 1) / tasksCount;
+	WorkStealingScheduler scheduler(workers);
+	for (size_t t = 0; t < tasksCount; ++t) {
+		parts[t] = std::make_shared<BaseHolder>();
+		parts[t]->cfg_ = holder_->cfg_;
+		scheduler.Add([this, &docs, &part = parts[t], firstId, &extraWordSymbols, begin = t * chunkSize,
+					   end = std::min((t + 1) * chunkSize, docs.size())] {
+			for (size_t i = begin; i < end; ++i) {
+				for (auto &field : docs[i]) seacher_.AddIndex(part, field.first, firstId + i, field.second, extraWordSymbols);
+			}
+		});
+	}
+	scheduler.Run(nullptr);
+	for (auto &part : parts) holder_->MergeTemp(*part);
+}
+
+void SearchEngine::Commit(int workers) {
 	commited_ = true;
-	seacher_.Commit(holder_);
+	seacher_.Commit(holder_, workers);
 }
 
 SearchResult SearchEngine::Search(const FtDSLQuery& dsl, bool inTransaction, const RdxContext& rdxCtx) {
@@ -17,6 +17,8 @@ namespace search_engine {
 class SearchEngine {
 public:
 	typedef shared_ptr<SearchEngine> Ptr;
+	// Texts of the document's fields with the fields' numbers
+	typedef h_vector<pair<std::string_view, uint32_t>, 8> DocFields;
 
 	SearchEngine();
 	void SetConfig(const unique_ptr<FtFuzzyConfig> &cfg);
@@ -27,7 +29,10 @@ public:
 	SearchResult Search(const FtDSLQuery &dsl, bool inTransaction, const reindexer::RdxContext &);
 	void Rebuild();
 	void AddData(std::string_view src_data, const IdType id, int field, const string &extraWordSymbols);
-	void Commit();
+	// Adds the documents with the sequential ids, starting from firstId
+	// @param workers - count of threads. Each thread processes its own ranges of the documents, which are merged in the ids order
+	void AddData(const vector<DocFields> &docs, IdType firstId, const string &extraWordSymbols, int workers);
+	void Commit(int workers = 0);
 
 private:
 	BaseHolder::Ptr holder_;
@@ -205,4 +205,31 @@ void FtDSLQuery::parseFields(wstring &utf16str, wstring::iterator &it, h_vector<
 		if (fo.boost == 0.0) fo = defFieldOpts;
 }
 
+template <typename T>
+static void appendValue(string &res, T v) {
+	res.append(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+string FtDSLQuery::Normalized() const {
+	string res;
+	for (const FtDSLEntry &e : *this) {
+		const string pattern = utf16_to_utf8(e.pattern);
+		appendValue(res, uint32_t(pattern.size()));
+		res += pattern;
+		const auto &o = e.opts;
+		appendValue(res, uint8_t(o.suff | (o.pref << 1) | (o.typos << 2) | (o.exact << 3) | (o.number << 4)));
+		appendValue(res, int8_t(o.op));
+		appendValue(res, o.boost);
+		appendValue(res, o.termLenBoost);
+		appendValue(res, o.distance);
+		appendValue(res, o.qpos);
+		appendValue(res, uint32_t(o.fieldsOpts.size()));
+		for (const auto &fo : o.fieldsOpts) {
+			appendValue(res, fo.boost);
+			appendValue(res, fo.needSumRank);
+		}
+	}
+	return res;
+}
+
 }  // namespace reindexer
@@ -46,6 +46,9 @@ public:
 	void parse(wstring &utf16str);
 	void parse(const string &q);
 	FtDSLQuery CopyCtx() const noexcept { return {fields_, stopWords_, extraWordSymbols_}; }
+	/// @return canonical binary representation of the parsed query. Queries, which differ only in spaces, stop words, terms' case,
+	/// etc, have the same representation, so it may be used as the results cache key
+	string Normalized() const;
 
 protected:
 	void parseFields(wstring &utf16str, wstring::iterator &it, h_vector<FtDslFieldOpts, 8> &fieldsOpts);
@@ -0,0 +1,54 @@
+#include "ftsetcashe.h"
+#include <algorithm>
+
+namespace reindexer {
+
+// Typo of the term and typo of the word are produced by deletion of up to maxTypos symbols in each of them, so they may be
+// matched only if the longest common subsequence is long enough
+static bool mayBeTypo(std::wstring_view term, std::wstring_view word, int maxTypos) {
+	const size_t maxLen = std::max(term.size(), word.size());
+	if (maxLen - std::min(term.size(), word.size()) > size_t(maxTypos)) return false;
+	const size_t minLcs = maxLen > size_t(maxTypos) ? maxLen - maxTypos : 0;
+	if (minLcs == 0) return true;
+	std::vector<uint16_t> lcs(word.size() + 1, 0);
+	for (wchar_t tc : term) {
+		uint16_t diag = 0;
+		for (size_t j = 1; j <= word.size(); ++j) {
+			const uint16_t up = lcs[j];
+			lcs[j] = (tc == word[j - 1]) ? diag + 1 : std::max(lcs[j], lcs[j - 1]);
+			diag = up;
+		}
+	}
+	return lcs[word.size()] >= minLcs;
+}
+
+bool FtCacheDeps::MayMatch(std::string_view word, std::wstring_view wordUtf16) const {
+	// Prefix/suffix options are not checked: the results are kept only if the word definitely can not be found
+	for (const auto &p : patterns) {
+		if (word.find(p) != std::string_view::npos) return true;
+	}
+	for (const auto &t : typoTerms) {
+		if (mayBeTypo(t, wordUtf16, maxTypos)) return true;
+	}
+	return false;
+}
+
+bool FtCacheDeps::HasAnyOf(const std::vector<VDocIdType> &sortedVdocs) const noexcept {
+	auto it = vdocs.cbegin();
+	for (VDocIdType id : sortedVdocs) {
+		it = std::lower_bound(it, vdocs.cend(), id);
+		if (it == vdocs.cend()) return false;
+		if (*it == id) return true;
+	}
+	return false;
+}
+
+size_t FtCacheDeps::heap_size() const noexcept {
+	size_t size = patterns.capacity() * sizeof(std::string) + typoTerms.capacity() * sizeof(std::wstring) +
+				  vdocs.capacity() * sizeof(VDocIdType);
+	for (const auto &p : patterns) size += p.capacity();
+	for (const auto &t : typoTerms) size += t.capacity() * sizeof(wchar_t);
+	return size;
+}
+
+}  // namespace reindexer
@@ -1,18 +1,42 @@
 #pragma once
 
+#include "core/ft/idrelset.h"
 #include "core/idsetcache.h"
 #include "core/selectfunc/ctx/ftctx.h"
 namespace reindexer {
 
+/// Index data, which the cached fulltext result depends on. Allows to keep the result in cache after the index update,
+/// which does not affect it (see FtFastConfig::incrementalCacheInvalidation)
+struct FtCacheDeps {
+	using Ptr = std::shared_ptr<const FtCacheDeps>;
+
+	/// @return true, if the word, added by the index update, may be found by the query
+	bool MayMatch(std::string_view word, std::wstring_view wordUtf16) const;
+	/// @return true, if any of the sorted virtual documents is a part of the result
+	bool HasAnyOf(const std::vector<VDocIdType> &sortedVdocs) const noexcept;
+	size_t heap_size() const noexcept;
+
+	// Terms' variants (original, stemmed, translit, synonyms, etc)
+	std::vector<std::string> patterns;
+	// Terms, which are searched with typos
+	std::vector<std::wstring> typoTerms;
+	int maxTypos = 0;
+	// Sorted virtual documents of the result
+	std::vector<VDocIdType> vdocs;
+};
+
 struct FtIdSetCacheVal {
 	FtIdSetCacheVal() : ids(make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>()) {}
 	FtIdSetCacheVal(const IdSet::Ptr &i) : ids(i) {}
-	FtIdSetCacheVal(const IdSet::Ptr &i, FtCtx::Data::Ptr c) : ids(i), ctx(c) {}
+	FtIdSetCacheVal(const IdSet::Ptr &i, FtCtx::Data::Ptr c, FtCacheDeps::Ptr d = FtCacheDeps::Ptr())
+		: ids(i), ctx(c), deps(std::move(d)) {}
 
-	size_t Size() const { return ids ? sizeof(*ids.get()) + ids->heap_size() : 0; }
+	size_t Size() const { return (ids ? sizeof(*ids.get()) + ids->heap_size() : 0) + (deps ? sizeof(*deps) + deps->heap_size() : 0); }
 
 	IdSet::Ptr ids;
 	FtCtx::Data::Ptr ctx;
+	// Not set, if the result has to be invalidated on every index update
+	FtCacheDeps::Ptr deps;
 };
 
 class FtIdSetCache : public LRUCache<IdSetCacheKey, FtIdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key> {};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/lrucache.h"
+
+namespace reindexer {
+
+/// Cache of the fulltext terms' variants (original + translit + kblayout + synonyms + stemmed), which are expanded by the selecter.
+/// Variants depend on the config of the index, so the cache has to be cleared on its change
+struct FtVariantsCacheKey {
+	size_t Size() const noexcept { return term.size(); }
+
+	// Term's pattern in utf8 with the options, which the variants depend on
+	std::string term;
+};
+
+struct FtVariantsCacheVal {
+	struct Variant {
+		std::string pattern;
+		int proc;
+		// Variant is found by the prefix (stemmed variant)
+		bool pref;
+		// Variant is not found by the suffix (stemmed variant of translit, kblayout or synonym)
+		bool noSuff;
+	};
+
+	size_t Size() const noexcept {
+		if (!variants) return 0;
+		size_t size = variants->capacity() * sizeof(Variant);
+		for (const auto &v : *variants) size += v.pattern.capacity();
+		return size;
+	}
+
+	std::shared_ptr<const std::vector<Variant>> variants;
+};
+
+struct HashFtVariantsCacheKey {
+	size_t operator()(const FtVariantsCacheKey &k) const noexcept { return std::hash<std::string>()(k.term); }
+};
+
+struct EqFtVariantsCacheKey {
+	bool operator()(const FtVariantsCacheKey &lhs, const FtVariantsCacheKey &rhs) const noexcept { return lhs.term == rhs.term; }
+};
+
+class FtVariantsCache : public LRUCache<FtVariantsCacheKey, FtVariantsCacheVal, HashFtVariantsCacheKey, EqFtVariantsCacheKey> {
+public:
+	static constexpr size_t kSizeLimit = 4 * 1024 * 1024;
+
+	FtVariantsCache() : LRUCache(kSizeLimit, 1) {}
+};
+
+}  // namespace reindexer
@@ -7,9 +7,22 @@
 
 namespace reindexer {
 
-size_t IdRelType::pack(uint8_t* buf) const {
+// Single pass varint decoding: most of the packed values (ids deltas, positions count and positions deltas) take one byte
+static inline uint32_t readVarUint32(const uint8_t*& p) noexcept {
+	uint32_t v = *p++;
+	if (v < 0x80) return v;
+	v &= 0x7F;
+	for (unsigned shift = 7; shift < 35; shift += 7) {
+		const uint32_t b = *p++;
+		v |= (b & 0x7F) << shift;
+		if (b < 0x80) break;
+	}
+	return v;
+}
+
+size_t IdRelType::pack(uint8_t* buf, delta_base_type base) const {
 	auto p = buf;
-	p += uint32_pack(id_, p);
+	p += sint32_pack(int32_t(id_ - base), p);
 	p += uint32_pack(pos_.size(), p);
 	uint32_t last = 0;
 	for (auto c : pos_) {
@@ -22,27 +35,19 @@ size_t IdRelType::pack(uint8_t* buf) const {
 size_t IdRelType::unpack(const uint8_t* buf, unsigned len) {
 	auto p = buf;
 	assertrx(len != 0);
-	auto l = scan_varint(len, p);
-	assertrx(l != 0);
-	id_ = parse_uint32(l, p);
-	p += l, len -= l;
-
-	l = scan_varint(len, p);
-	assertrx(l != 0);
-	int sz = parse_uint32(l, p);
-	p += l, len -= l;
+	(void)len;
+	id_ += unzigzag32(readVarUint32(p));
+	const uint32_t sz = readVarUint32(p);
 
 	pos_.resize(sz);
 	usedFieldsMask_ = 0;
 	uint32_t last = 0;
-	for (int i = 0; i < sz; i++) {
-		l = scan_varint(len, p);
-		assertrx(l != 0);
-		pos_[i].fpos = parse_uint32(l, p) + last;
-		last = pos_[i].fpos;
-		addField(pos_[i].field());
-		p += l, len -= l;
+	for (auto& pos : pos_) {
+		pos.fpos = readVarUint32(p) + last;
+		last = pos.fpos;
+		addField(pos.field());
 	}
+	assertrx(size_t(p - buf) <= len);
 
 	return p - buf;
 }
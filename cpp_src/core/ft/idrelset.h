@@ -22,8 +22,11 @@ public:
 
 	int WordsInField(int field) const noexcept;
 	int MinPositionInField(int field) const noexcept;
-	// packed_vector callbacks
-	size_t pack(uint8_t* buf) const;
+	// packed_vector callbacks. Document id is packed as delta from the id of the previous value in the vector, so unpack uses
+	// the id of this object (i.e. previously unpacked value) as delta base
+	using delta_base_type = VDocIdType;
+	delta_base_type DeltaBase() const noexcept { return id_; }
+	size_t pack(uint8_t* buf, delta_base_type base) const;
 	size_t unpack(const uint8_t* buf, unsigned len);
 	size_t maxpackedsize() const { return 2 * (sizeof(VDocIdType) + 1) + (pos_.size() * (sizeof(uint32_t) + 1)); }
 
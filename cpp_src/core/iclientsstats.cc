@@ -31,6 +31,16 @@ void ClientStat::GetJSON(WrSerializer& ser) const {
 		builder.Raw("updates_filter", serFilters.Slice());
 	}
 	builder.Put("updates_lost", updatesLost);
+	builder.Put("compression_ratio", compressionRatio);
+	if (resources) {
+		auto obj = builder.Object("resources");
+		obj.Put("cpu_time_us", resources->cpuUs);
+		obj.Put("rows_examined", resources->rowsExamined);
+		obj.Put("results_bytes", resources->resultsBytes);
+		obj.Put("ops", resources->ops);
+		obj.Put("canceled_ops", resources->canceledOps);
+		obj.Put("rejected_ops", resources->rejectedOps);
+	}
 	builder.End();
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
+#include "core/resourceusage.h"
 #include "net/connection.h"
 #include "replicator/updatesobserver.h"
 
@@ -26,6 +28,7 @@ struct ClientStat {
 	int64_t lastSendTs = 0;
 	int64_t lastRecvTs = 0;
 	int64_t updatesLost = 0;
+	double compressionRatio = 1.0;
 	std::string userRights;
 	std::string clientVersion;
 	std::string appName;
@@ -33,6 +36,8 @@ struct ClientStat {
 	IUpdatesObserver* updatesPusher = nullptr;
 	bool isSubscribed = false;
 	UpdatesFilters updatesFilters;
+	// Resources of the client's account, which is shared by all of its connections. Set, if the accounting is enabled
+	std::optional<ResourceAccount::Snapshot> resources;
 };
 
 struct TxStats {
@@ -49,6 +54,7 @@ struct ClientConnectionStat {
 	std::string clientVersion;
 	std::string appName;
 	IUpdatesObserver* updatesPusher = nullptr;
+	std::shared_ptr<ResourceAccount> resources;
 };
 
 class IClientsStats {
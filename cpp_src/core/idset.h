@@ -3,7 +3,9 @@
 #include <core/type_consts.h>
 #include <algorithm>
 #include <atomic>
+#include <iterator>
 #include <string>
+#include "core/idsetbitmap.h"
 #include "cpp-btree/btree_set.h"
 #include "estl/h_vector.h"
 #include "estl/intrusive_ptr.h"
@@ -63,6 +65,20 @@ public:
 		base_idset::erase(d.first, d.second);
 		return d.second - d.first;
 	}
+	/// Erases the ids, sorted in ascending order, by the single pass over the set
+	/// @return count of the erased ids
+	int Erase(span<IdType> ids) {
+		auto out = begin();
+		auto idIt = ids.begin();
+		for (auto it = begin(); it != end(); ++it) {
+			while (idIt != ids.end() && *idIt < *it) ++idIt;
+			if (idIt != ids.end() && *idIt == *it) continue;
+			*out++ = *it;
+		}
+		const int erased = end() - out;
+		base_idset::erase(out, end());
+		return erased;
+	}
 
 	void Commit() const noexcept {}
 	bool IsCommited() const noexcept { return true; }
@@ -86,12 +102,20 @@ public:
 	using Ptr = intrusive_ptr<intrusive_atomic_rc_wrapper<IdSet>>;
 	IdSet() : usingBtree_(false) {}
 	IdSet(const IdSet &other)
-		: IdSetPlain(other), set_(!other.set_ ? nullptr : new base_idsetset(*other.set_)), usingBtree_(other.usingBtree_.load()) {}
-	IdSet(IdSet &&other) noexcept : IdSetPlain(std::move(other)), set_(std::move(other.set_)), usingBtree_(other.usingBtree_.load()) {}
+		: IdSetPlain(other),
+		  set_(!other.set_ ? nullptr : new base_idsetset(*other.set_)),
+		  bitmap_(!other.bitmap_ ? nullptr : new IdSetBitmap(*other.bitmap_)),
+		  usingBtree_(other.usingBtree_.load()) {}
+	IdSet(IdSet &&other) noexcept
+		: IdSetPlain(std::move(other)),
+		  set_(std::move(other.set_)),
+		  bitmap_(std::move(other.bitmap_)),
+		  usingBtree_(other.usingBtree_.load()) {}
 	IdSet &operator=(IdSet &&other) noexcept {
 		if (&other != this) {
 			IdSetPlain::operator=(std::move(other));
 			set_ = std::move(other.set_);
+			bitmap_ = std::move(other.bitmap_);
 			usingBtree_ = other.usingBtree_.load();
 		}
 		return *this;
@@ -100,10 +124,13 @@ public:
 		if (&other != this) {
 			IdSetPlain::operator=(other);
 			set_.reset(!other.set_ ? nullptr : new base_idsetset(*other.set_));
+			bitmap_.reset(!other.bitmap_ ? nullptr : new IdSetBitmap(*other.bitmap_));
 			usingBtree_ = other.usingBtree_.load();
 		}
 		return *this;
 	}
+	// Creates read-only idset in the compressed bitmap representation
+	explicit IdSet(IdSetBitmap &&bitmap) : bitmap_(new IdSetBitmap(std::move(bitmap))), usingBtree_(false) {}
 	bool Add(IdType id, EditMode editMode, int sortedIdxCount) {
 		// Reserve extra space for sort orders data
 		grow(((set_ ? set_->size() : size()) + 1) * (sortedIdxCount + 1));
@@ -164,12 +191,33 @@ public:
 		}
 		return 0;
 	}
+	int Erase(span<IdType> ids) {
+		if (!set_) return IdSetPlain::Erase(ids);
+		resize(0);
+		usingBtree_ = true;
+		const size_t size = set_->size();
+		if (ids.size() * 4 < size) {
+			for (IdType id : ids) set_->erase(id);
+		} else {
+			// The most of the tree is erased, so the rest is inserted into the new one
+			std::unique_ptr<base_idsetset> rest(new base_idsetset);
+			std::set_difference(set_->begin(), set_->end(), ids.begin(), ids.end(), std::inserter(*rest, rest->end()));
+			set_ = std::move(rest);
+		}
+		return size - set_->size();
+	}
 	void Commit();
 	bool IsCommited() const { return !usingBtree_; }
-	bool IsEmpty() const { return empty() && (!set_ || set_->empty()); }
-	size_t Size() const { return usingBtree_.load(std::memory_order_relaxed) ? set_->size() : size(); }
+	bool IsEmpty() const { return empty() && (!set_ || set_->empty()) && (!bitmap_ || bitmap_->Empty()); }
+	size_t Size() const {
+		if (bitmap_) return bitmap_->Size();
+		return usingBtree_.load(std::memory_order_relaxed) ? set_->size() : size();
+	}
 	size_t BTreeSize() const { return set_ ? sizeof(*set_.get()) + set_->size() * sizeof(int) : 0; }
+	size_t BitmapSize() const { return bitmap_ ? sizeof(*bitmap_.get()) + bitmap_->HeapSize() : 0; }
 	const base_idsetset *BTree() const { return set_.get(); }
+	// Not null only for the read-only idsets, built from merged select results (see SelectKeyResult::mergeIdsets)
+	const IdSetBitmap *Bitmap() const noexcept { return bitmap_.get(); }
 	void ReserveForSorted(int sortedIdxCount) { reserve(((set_ ? set_->size() : size())) * (sortedIdxCount + 1)); }
 
 protected:
@@ -179,6 +227,7 @@ protected:
 	friend class BtreeIndexReverseIteratorImpl;
 
 	std::unique_ptr<base_idsetset> set_;
+	std::unique_ptr<IdSetBitmap> bitmap_;
 	std::atomic<bool> usingBtree_;
 };
 
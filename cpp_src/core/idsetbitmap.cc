@@ -0,0 +1,305 @@
+#include "core/idsetbitmap.h"
+#include <algorithm>
+#include <cstring>
+
+namespace reindexer {
+
+IdSetBitmap::Container::Container(const Container &other) : key(other.key), card(other.card), array(other.array) {
+	if (other.bits) {
+		bits.reset(new uint64_t[kWordsPerChunk]);
+		std::memcpy(bits.get(), other.bits.get(), kWordsPerChunk * sizeof(uint64_t));
+	}
+}
+
+IdSetBitmap::Container &IdSetBitmap::Container::operator=(const Container &other) {
+	if (&other != this) {
+		Container tmp(other);
+		*this = std::move(tmp);
+	}
+	return *this;
+}
+
+bool IdSetBitmap::Container::Add(uint16_t low) {
+	if (bits) {
+		uint64_t &word = bits[low >> 6];
+		const uint64_t mask = uint64_t(1) << (low & 63);
+		if (word & mask) return false;
+		word |= mask;
+		++card;
+		return true;
+	}
+	if (array.empty() || array.back() < low) {
+		array.push_back(low);
+	} else {
+		auto pos = std::lower_bound(array.begin(), array.end(), low);
+		if (*pos == low) return false;
+		array.insert(pos, low);
+	}
+	++card;
+	if (card > kMaxArrayContainerSize) ToBitmap();
+	return true;
+}
+
+bool IdSetBitmap::Container::Contains(uint16_t low) const noexcept {
+	if (bits) return bits[low >> 6] & (uint64_t(1) << (low & 63));
+	return std::binary_search(array.begin(), array.end(), low);
+}
+
+int IdSetBitmap::Container::Next(uint32_t low) const noexcept {
+	if (low >= kChunkSize) return -1;
+	if (bits) {
+		uint32_t w = low >> 6;
+		uint64_t word = bits[w] & (~uint64_t(0) << (low & 63));
+		for (;;) {
+			if (word) return int(w * 64 + __builtin_ctzll(word));
+			if (++w == kWordsPerChunk) return -1;
+			word = bits[w];
+		}
+	}
+	auto pos = std::lower_bound(array.begin(), array.end(), low);
+	return pos == array.end() ? -1 : int(*pos);
+}
+
+int IdSetBitmap::Container::Prev(uint32_t low) const noexcept {
+	if (bits) {
+		int w = low >> 6;
+		const uint32_t shift = 63 - (low & 63);
+		uint64_t word = (bits[w] << shift) >> shift;
+		for (;;) {
+			if (word) return w * 64 + 63 - __builtin_clzll(word);
+			if (--w < 0) return -1;
+			word = bits[w];
+		}
+	}
+	auto pos = std::upper_bound(array.begin(), array.end(), low);
+	return pos == array.begin() ? -1 : int(*(pos - 1));
+}
+
+void IdSetBitmap::Container::ToBitmap() {
+	if (bits) return;
+	bits.reset(new uint64_t[kWordsPerChunk]);
+	std::memset(bits.get(), 0, kWordsPerChunk * sizeof(uint64_t));
+	for (auto low : array) bits[low >> 6] |= uint64_t(1) << (low & 63);
+	array = h_vector<uint16_t, 0>();
+}
+
+void IdSetBitmap::Container::ToArrayIfSparse() {
+	if (!bits || card > kMaxArrayContainerSize) return;
+	array.clear();
+	array.reserve(card);
+	ForEach([this](IdType id) { array.push_back(uint16_t(id)); });
+	bits.reset();
+}
+
+void IdSetBitmap::Container::Or(const Container &other) {
+	if (!other.bits && !bits) {
+		h_vector<uint16_t, 0> merged;
+		merged.reserve(array.size() + other.array.size());
+		auto it1 = array.cbegin();
+		auto it2 = other.array.cbegin();
+		while (it1 != array.end() && it2 != other.array.end()) {
+			if (*it1 < *it2) {
+				merged.push_back(*it1++);
+			} else if (*it2 < *it1) {
+				merged.push_back(*it2++);
+			} else {
+				merged.push_back(*it1++);
+				++it2;
+			}
+		}
+		for (; it1 != array.end(); ++it1) merged.push_back(*it1);
+		for (; it2 != other.array.end(); ++it2) merged.push_back(*it2);
+		array = std::move(merged);
+		card = array.size();
+		if (card > kMaxArrayContainerSize) ToBitmap();
+		return;
+	}
+	if (!other.bits) {
+		for (auto low : other.array) Add(low);
+		return;
+	}
+	ToBitmap();
+	uint32_t c = 0;
+	for (uint32_t w = 0; w < kWordsPerChunk; ++w) {
+		bits[w] |= other.bits[w];
+		c += __builtin_popcountll(bits[w]);
+	}
+	card = c;
+}
+
+void IdSetBitmap::Container::And(const Container &other) {
+	if (bits && other.bits) {
+		uint32_t c = 0;
+		for (uint32_t w = 0; w < kWordsPerChunk; ++w) {
+			bits[w] &= other.bits[w];
+			c += __builtin_popcountll(bits[w]);
+		}
+		card = c;
+		ToArrayIfSparse();
+		return;
+	}
+	if (bits) {
+		// Result can not be bigger than the other's array
+		h_vector<uint16_t, 0> res;
+		res.reserve(other.array.size());
+		for (auto low : other.array) {
+			if (Contains(low)) res.push_back(low);
+		}
+		bits.reset();
+		array = std::move(res);
+	} else {
+		auto out = array.begin();
+		for (auto low : array) {
+			if (other.Contains(low)) *out++ = low;
+		}
+		array.erase(out, array.end());
+	}
+	card = array.size();
+}
+
+bool IdSetBitmap::Container::operator==(const Container &other) const noexcept {
+	if (key != other.key || card != other.card) return false;
+	if (bits && other.bits) return std::memcmp(bits.get(), other.bits.get(), kWordsPerChunk * sizeof(uint64_t)) == 0;
+	const Container &arr = bits ? other : *this;
+	const Container &bm = bits ? *this : other;
+	if (!bm.bits) return std::equal(array.begin(), array.end(), other.array.begin());
+	for (auto low : arr.array) {
+		if (!bm.Contains(low)) return false;
+	}
+	return true;
+}
+
+IdSetBitmap::IdSetBitmap(const IdSetBitmap &other) : containers_(other.containers_), size_(other.size_) {}
+
+IdSetBitmap &IdSetBitmap::operator=(const IdSetBitmap &other) {
+	if (&other != this) {
+		containers_ = other.containers_;
+		size_ = other.size_;
+		lastAdded_ = 0;
+	}
+	return *this;
+}
+
+size_t IdSetBitmap::findContainer(uint16_t key) const noexcept {
+	return std::lower_bound(containers_.begin(), containers_.end(), key, [](const Container &c, uint16_t k) { return c.key < k; }) -
+		   containers_.begin();
+}
+
+IdSetBitmap::Container &IdSetBitmap::getContainer(uint16_t key) {
+	if (lastAdded_ < containers_.size() && containers_[lastAdded_].key == key) return containers_[lastAdded_];
+	if (containers_.empty() || containers_.back().key < key) {
+		containers_.emplace_back(key);
+		lastAdded_ = containers_.size() - 1;
+		return containers_.back();
+	}
+	lastAdded_ = findContainer(key);
+	if (containers_[lastAdded_].key != key) containers_.emplace(containers_.begin() + lastAdded_, key);
+	return containers_[lastAdded_];
+}
+
+bool IdSetBitmap::Add(IdType id) {
+	assertrx(id >= 0);
+	if (getContainer(uint32_t(id) >> 16).Add(uint32_t(id) & 0xFFFF)) {
+		++size_;
+		return true;
+	}
+	return false;
+}
+
+bool IdSetBitmap::Contains(IdType id) const noexcept {
+	if (id < 0) return false;
+	const size_t pos = findContainer(uint32_t(id) >> 16);
+	return pos != containers_.size() && containers_[pos].key == (uint32_t(id) >> 16) && containers_[pos].Contains(uint32_t(id) & 0xFFFF);
+}
+
+void IdSetBitmap::Or(const IdSetBitmap &other) {
+	std::vector<Container> res;
+	res.reserve(containers_.size() + other.containers_.size());
+	auto it1 = containers_.begin();
+	auto it2 = other.containers_.begin();
+	while (it1 != containers_.end() && it2 != other.containers_.end()) {
+		if (it1->key < it2->key) {
+			res.emplace_back(std::move(*it1++));
+		} else if (it2->key < it1->key) {
+			res.emplace_back(*it2++);
+		} else {
+			it1->Or(*it2++);
+			res.emplace_back(std::move(*it1++));
+		}
+	}
+	for (; it1 != containers_.end(); ++it1) res.emplace_back(std::move(*it1));
+	for (; it2 != other.containers_.end(); ++it2) res.emplace_back(*it2);
+	containers_ = std::move(res);
+	size_ = 0;
+	for (auto &c : containers_) size_ += c.card;
+	lastAdded_ = 0;
+}
+
+void IdSetBitmap::And(const IdSetBitmap &other) {
+	auto out = containers_.begin();
+	auto it2 = other.containers_.begin();
+	size_ = 0;
+	for (auto it1 = containers_.begin(); it1 != containers_.end(); ++it1) {
+		while (it2 != other.containers_.end() && it2->key < it1->key) ++it2;
+		if (it2 == other.containers_.end()) break;
+		if (it2->key != it1->key) continue;
+		it1->And(*it2);
+		if (it1->card) {
+			size_ += it1->card;
+			if (out != it1) *out = std::move(*it1);
+			++out;
+		}
+	}
+	containers_.erase(out, containers_.end());
+	lastAdded_ = 0;
+}
+
+IdType IdSetBitmap::Next(IdType from, size_t &cursor) const noexcept {
+	if (from < 0) from = 0;
+	const uint32_t key = uint32_t(from) >> 16;
+	// Iteration is mostly sequential, so check hinted container first
+	if (cursor >= containers_.size() || containers_[cursor].key > key || (cursor + 1 < containers_.size() && containers_[cursor + 1].key <= key)) {
+		cursor = findContainer(key);
+	} else if (containers_[cursor].key < key) {
+		++cursor;
+	}
+	for (uint32_t low = (cursor < containers_.size() && containers_[cursor].key == key) ? uint32_t(from) & 0xFFFF : 0;
+		 cursor < containers_.size(); ++cursor, low = 0) {
+		const int res = containers_[cursor].Next(low);
+		if (res >= 0) return (IdType(containers_[cursor].key) << 16) + res;
+	}
+	return INT_MAX;
+}
+
+IdType IdSetBitmap::Prev(IdType from, size_t &cursor) const noexcept {
+	if (from < 0 || containers_.empty()) return INT_MIN;
+	const uint32_t key = uint32_t(from) >> 16;
+	if (cursor >= containers_.size() || containers_[cursor].key > key || (cursor + 1 < containers_.size() && containers_[cursor + 1].key <= key)) {
+		cursor = findContainer(key);
+		if (cursor == containers_.size() || containers_[cursor].key > key) {
+			if (cursor == 0) return INT_MIN;
+			--cursor;
+		}
+	}
+	uint32_t low = containers_[cursor].key == key ? uint32_t(from) & 0xFFFF : kChunkSize - 1;
+	for (;;) {
+		const int res = containers_[cursor].Prev(low);
+		if (res >= 0) return (IdType(containers_[cursor].key) << 16) + res;
+		if (cursor == 0) return INT_MIN;
+		--cursor;
+		low = kChunkSize - 1;
+	}
+}
+
+size_t IdSetBitmap::HeapSize() const noexcept {
+	size_t res = containers_.capacity() * sizeof(Container);
+	for (auto &c : containers_) res += c.HeapSize();
+	return res;
+}
+
+bool IdSetBitmap::operator==(const IdSetBitmap &other) const noexcept {
+	return size_ == other.size_ && containers_.size() == other.containers_.size() &&
+		   std::equal(containers_.begin(), containers_.end(), other.containers_.begin());
+}
+
+}  // namespace reindexer
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "core/type_consts.h"
+#include "estl/h_vector.h"
+
+namespace reindexer {
+
+// Minimal merged idset size to switch it to the compressed bitmap representation
+constexpr size_t kMinIdsetSizeForBitmap = 4096;
+
+/// Compressed bitmap of row ids (roaring-style).
+/// Id space is split into chunks of 65536 ids by the high 16 bits of id. Each non-empty chunk is stored in a separate container,
+/// which is either a sorted array of low 16 bits (sparse chunk, 2 bytes per id) or a plain 65536-bit bitmap (dense chunk, 8KB).
+/// Container type is picked automatically by chunk cardinality.
+class IdSetBitmap {
+public:
+	using Ptr = std::shared_ptr<const IdSetBitmap>;
+
+	IdSetBitmap() = default;
+	IdSetBitmap(const IdSetBitmap &);
+	IdSetBitmap(IdSetBitmap &&) noexcept = default;
+	IdSetBitmap &operator=(const IdSetBitmap &);
+	IdSetBitmap &operator=(IdSetBitmap &&) noexcept = default;
+
+	/// Adds single id to bitmap
+	/// @return true if id was not present in bitmap
+	bool Add(IdType id);
+	/// Adds sorted sequence of ids. Sequential ids from the same chunk are added without container lookup
+	template <typename It>
+	void Add(It first, It last) {
+		for (; first != last; ++first) Add(*first);
+	}
+	/// Bitwise OR with other bitmap
+	void Or(const IdSetBitmap &other);
+	/// Bitwise AND with other bitmap
+	void And(const IdSetBitmap &other);
+	bool Contains(IdType id) const noexcept;
+
+	/// Returns the least id in bitmap, which is greater or equal to 'from', or INT_MAX if there is no such id
+	/// @param cursor - container position hint. Must be 0 before the first call and is updated by the method
+	IdType Next(IdType from, size_t &cursor) const noexcept;
+	/// Returns the greatest id in bitmap, which is less or equal to 'from', or INT_MIN if there is no such id
+	/// @param cursor - container position hint. Must be 0 before the first call and is updated by the method
+	IdType Prev(IdType from, size_t &cursor) const noexcept;
+
+	size_t Size() const noexcept { return size_; }
+	bool Empty() const noexcept { return size_ == 0; }
+	size_t HeapSize() const noexcept;
+	void Clear() noexcept {
+		containers_.clear();
+		size_ = 0;
+	}
+
+	template <typename F>
+	void ForEach(const F &f) const {
+		for (auto &c : containers_) c.ForEach(f);
+	}
+
+	bool operator==(const IdSetBitmap &other) const noexcept;
+	bool operator!=(const IdSetBitmap &other) const noexcept { return !operator==(other); }
+
+private:
+	static constexpr uint32_t kChunkSize = 1 << 16;
+	static constexpr uint32_t kWordsPerChunk = kChunkSize / 64;
+	// Array container is bigger than bitmap container starting from this cardinality
+	static constexpr uint32_t kMaxArrayContainerSize = 4096;
+
+	struct Container {
+		Container(uint16_t k) noexcept : key(k) {}
+		Container(const Container &);
+		Container(Container &&) noexcept = default;
+		Container &operator=(const Container &);
+		Container &operator=(Container &&) noexcept = default;
+
+		bool IsBitmap() const noexcept { return bool(bits); }
+		bool Add(uint16_t low);
+		bool Contains(uint16_t low) const noexcept;
+		// Returns the least value >= low or -1
+		int Next(uint32_t low) const noexcept;
+		// Returns the greatest value <= low or -1
+		int Prev(uint32_t low) const noexcept;
+		void Or(const Container &other);
+		void And(const Container &other);
+		void ToBitmap();
+		void ToArrayIfSparse();
+		size_t HeapSize() const noexcept { return bits ? kWordsPerChunk * sizeof(uint64_t) : array.heap_size(); }
+		bool operator==(const Container &other) const noexcept;
+
+		template <typename F>
+		void ForEach(const F &f) const {
+			const IdType base = IdType(key) << 16;
+			if (bits) {
+				for (uint32_t w = 0; w < kWordsPerChunk; ++w) {
+					for (uint64_t word = bits[w]; word; word &= word - 1) f(base + IdType(w * 64 + __builtin_ctzll(word)));
+				}
+			} else {
+				for (auto low : array) f(base + IdType(low));
+			}
+		}
+
+		uint16_t key;
+		uint32_t card = 0;
+		h_vector<uint16_t, 0> array;
+		std::unique_ptr<uint64_t[]> bits;
+	};
+
+	size_t findContainer(uint16_t key) const noexcept;
+	Container &getContainer(uint16_t key);
+
+	std::vector<Container> containers_;
+	size_t size_ = 0;
+	size_t lastAdded_ = 0;
+};
+
+}  // namespace reindexer
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <bitset>
+#include <mutex>
 #include "core/idset.h"
 #include "core/keyvalue/variant.h"
 #include "core/lrucache.h"
@@ -10,20 +11,23 @@ namespace reindexer {
 
 struct IdSetCacheKey {
 	IdSetCacheKey(const VariantArray &keys, CondType cond, SortType sort) : keys(&keys), cond(cond), sort(sort) {}
-	IdSetCacheKey(const IdSetCacheKey &other) : keys(&hkeys), cond(other.cond), sort(other.sort), hkeys(*other.keys) {}
-	IdSetCacheKey(IdSetCacheKey &&other) noexcept : keys(&hkeys), cond(other.cond), sort(other.sort), hkeys(std::move(*other.keys)) {}
+	// Keys of the query may refer to the strings of the query without holding them (see Variant::View), so the cached copy holds them
+	IdSetCacheKey(const IdSetCacheKey &other) : keys(&hkeys), cond(other.cond), sort(other.sort), hkeys(*other.keys) { holdKeys(); }
+	IdSetCacheKey(IdSetCacheKey &&other) : keys(&hkeys), cond(other.cond), sort(other.sort), hkeys(std::move(*other.keys)) { holdKeys(); }
 	IdSetCacheKey &operator=(const IdSetCacheKey &other) {
 		if (&other != this) {
 			hkeys = *other.keys;
+			holdKeys();
 			keys = &hkeys;
 			cond = other.cond;
 			sort = other.sort;
 		}
 		return *this;
 	}
-	IdSetCacheKey &operator=(IdSetCacheKey &&other) noexcept {
+	IdSetCacheKey &operator=(IdSetCacheKey &&other) {
 		if (&other != this) {
 			hkeys = std::move(*other.keys);
+			holdKeys();
 			keys = &hkeys;
 			cond = other.cond;
 			sort = other.sort;
@@ -37,6 +41,11 @@ struct IdSetCacheKey {
 	CondType cond;
 	SortType sort;
 	VariantArray hkeys;
+
+private:
+	void holdKeys() {
+		for (Variant &key : hkeys) key.EnsureHold();
+	}
 };
 
 template <typename T>
@@ -49,7 +58,7 @@ T &operator<<(T &os, const IdSetCacheKey &k) {
 struct IdSetCacheVal {
 	IdSetCacheVal() : ids(nullptr) {}
 	IdSetCacheVal(const IdSet::Ptr &i) : ids(i) {}
-	size_t Size() const { return ids ? sizeof(*ids.get()) + ids->heap_size() : 0; }
+	size_t Size() const { return ids ? sizeof(*ids.get()) + ids->heap_size() + ids->BitmapSize() : 0; }
 
 	IdSet::Ptr ids;
 };
@@ -72,13 +81,50 @@ struct hash_idset_cache_key {
 	size_t operator()(const IdSetCacheKey &s) const { return (s.cond << 8) ^ (s.sort << 16) ^ s.keys->Hash(); }
 };
 
+/// Merged idset of the range of the keys of the ordered index [first, last], selected without the sort order
+struct IdSetCacheRange {
+	Variant first, last;
+	IdSet::Ptr ids;
+};
+
 class IdSetCache : public LRUCache<IdSetCacheKey, IdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key> {
 public:
+	// Count of the recently selected ranges, which are kept to compose the idsets of the overlapping ranges from them
+	static constexpr size_t kMaxRanges = 8;
+	using Ranges = h_vector<IdSetCacheRange, kMaxRanges>;
+
 	void ClearSorted(const std::bitset<64> &s) {
 		if (s.any()) {
 			Clear([&s](const IdSetCacheKey &k) { return s.test(k.sort); });
 		}
 	}
+	Ranges GetRanges() const {
+		std::lock_guard lock{rangesLock_};
+		return ranges_;
+	}
+	/// Stores the range instead of the oldest one. Cache is dropped on any update of the index, so the ranges are never outdated
+	void PutRange(IdSetCacheRange &&range) {
+		std::lock_guard lock{rangesLock_};
+		for (auto it = ranges_.begin(); it != ranges_.end(); ++it) {
+			if (it->first == range.first && it->last == range.last) {
+				ranges_.erase(it);
+				break;
+			}
+		}
+		if (ranges_.size() == kMaxRanges) ranges_.erase(ranges_.begin());
+		ranges_.emplace_back(std::move(range));
+	}
+	LRUCacheMemStat GetMemStat() {
+		LRUCacheMemStat ret = LRUCache::GetMemStat();
+		std::lock_guard lock{rangesLock_};
+		for (const auto &range : ranges_) ret.totalSize += IdSetCacheVal(range.ids).Size();
+		ret.itemsCount += ranges_.size();
+		return ret;
+	}
+
+private:
+	Ranges ranges_;
+	mutable std::mutex rangesLock_;
 };
 
 }  // namespace reindexer
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+namespace reindexer {
+
+/// Split block bloom filter: each key sets 8 bits in the single 256 bits block (one bit in each 32 bits word), so the check of the
+/// key reads one cache line. False positive rate is less than 1%, while count of keys is not greater, than capacity.
+/// Keys can not be removed, so the owner rebuilds filter, when there are too many stale keys
+class BloomFilter {
+public:
+	static constexpr size_t kBitsPerKey = 16;
+
+	/// Clears filter and allocates it for the keysCount keys
+	void Reset(size_t keysCount) {
+		blocks_.assign((keysCount * kBitsPerKey + kBlockBits - 1) / kBlockBits, Block{});
+		capacity_ = blocks_.size() * kBlockBits / kBitsPerKey;
+	}
+	/// @param hash - hash of the key. It is mixed again, so the weak hashes of the integers are acceptable
+	void Add(uint64_t hash) noexcept {
+		hash = mix(hash);
+		Block &block = blocks_[blockIdx(hash)];
+		for (unsigned i = 0; i < kWordsPerBlock; ++i) block.words[i] |= bit(hash, i);
+	}
+	/// @return false, if the key was definitely not added. Empty (not allocated) filter may contain any key
+	bool MayContain(uint64_t hash) const noexcept {
+		if (blocks_.empty()) return true;
+		hash = mix(hash);
+		const Block &block = blocks_[blockIdx(hash)];
+		for (unsigned i = 0; i < kWordsPerBlock; ++i) {
+			if (!(block.words[i] & bit(hash, i))) return false;
+		}
+		return true;
+	}
+	/// Count of keys, for which filter was allocated
+	size_t Capacity() const noexcept { return capacity_; }
+	size_t HeapSize() const noexcept { return blocks_.capacity() * sizeof(Block); }
+
+private:
+	static constexpr unsigned kWordsPerBlock = 8;
+	static constexpr size_t kBlockBits = kWordsPerBlock * 32;
+	struct alignas(32) Block {
+		uint32_t words[kWordsPerBlock] = {};
+	};
+
+	static uint64_t mix(uint64_t h) noexcept {
+		// Finalizer of the MurmurHash3
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+	size_t blockIdx(uint64_t hash) const noexcept { return ((hash >> 32) * blocks_.size()) >> 32; }
+	static uint32_t bit(uint64_t hash, unsigned word) noexcept {
+		static constexpr uint32_t kSalt[kWordsPerBlock] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+														   0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+		return uint32_t(1) << ((uint32_t(hash) * kSalt[word]) >> 27);
+	}
+
+	std::vector<Block> blocks_;
+	size_t capacity_ = 0;
+};
+
+}  // namespace reindexer
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <cmath>
+
+namespace reindexer {
+namespace hnsw {
+
+// Count of the independent partial sums. Loops over the blocks of this size are vectorized by the compiler without the reordering of
+// the floating point operations, so the kernels are compiled into SSE/AVX code for the target architecture
+constexpr size_t kDistanceLanes = 16;
+
+inline float L2Sqr(const float *a, const float *b, size_t dimension) noexcept {
+	float sums[kDistanceLanes] = {};
+	size_t i = 0;
+	for (; i + kDistanceLanes <= dimension; i += kDistanceLanes) {
+		for (size_t j = 0; j < kDistanceLanes; ++j) {
+			const float d = a[i + j] - b[i + j];
+			sums[j] += d * d;
+		}
+	}
+	float sum = 0.0f;
+	for (; i < dimension; ++i) {
+		const float d = a[i] - b[i];
+		sum += d * d;
+	}
+	for (float s : sums) sum += s;
+	return sum;
+}
+
+inline float InnerProduct(const float *a, const float *b, size_t dimension) noexcept {
+	float sums[kDistanceLanes] = {};
+	size_t i = 0;
+	for (; i + kDistanceLanes <= dimension; i += kDistanceLanes) {
+		for (size_t j = 0; j < kDistanceLanes; ++j) sums[j] += a[i + j] * b[i + j];
+	}
+	float sum = 0.0f;
+	for (; i < dimension; ++i) sum += a[i] * b[i];
+	for (float s : sums) sum += s;
+	return sum;
+}
+
+// Cosine distance of the normalized vectors is computed as the inner product distance
+inline void Normalize(float *v, size_t dimension) noexcept {
+	const float norm = std::sqrt(InnerProduct(v, v, dimension));
+	if (norm == 0.0f) return;
+	for (size_t i = 0; i < dimension; ++i) v[i] /= norm;
+}
+
+}  // namespace hnsw
+}  // namespace reindexer
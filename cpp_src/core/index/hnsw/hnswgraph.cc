@@ -0,0 +1,263 @@
+#include "hnswgraph.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include "distances.h"
+#include "tools/assertrx.h"
+
+namespace reindexer {
+
+constexpr size_t kMinRemovedNodesForRebuild = 1024;
+constexpr int kMaxLevel = 31;
+
+// Marks of the visited nodes, which are reset by the increment of the epoch. Graph may be searched concurrently, so each thread
+// has its own marks
+class VisitedNodes {
+public:
+	static VisitedNodes &Get(size_t nodesCount) {
+		thread_local VisitedNodes visited;
+		visited.reset(nodesCount);
+		return visited;
+	}
+	bool Visit(uint32_t node) noexcept {
+		if (marks_[node] == epoch_) return false;
+		marks_[node] = epoch_;
+		return true;
+	}
+
+private:
+	void reset(size_t nodesCount) {
+		if (marks_.size() < nodesCount) marks_.resize(nodesCount, 0);
+		if (++epoch_ == 0) {
+			std::fill(marks_.begin(), marks_.end(), 0);
+			epoch_ = 1;
+		}
+	}
+
+	std::vector<uint32_t> marks_;
+	uint32_t epoch_ = 0;
+};
+
+HnswGraph::HnswGraph(const Params &params) : params_(params), levelMult_(1.0 / std::log(double(std::max<size_t>(params.m, 2)))) {
+	assertrx(params_.dimension > 0);
+	assertrx(params_.m >= 2);
+}
+
+void HnswGraph::Add(IdType id, const float *vector) {
+	if (Contains(id)) Remove(id);
+	const NodeId node = ids_.size();
+	vectors_.insert(vectors_.end(), vector, vector + params_.dimension);
+	if (params_.metric == Metric::Cosine) hnsw::Normalize(vectors_.data() + vectors_.size() - params_.dimension, params_.dimension);
+	ids_.push_back(id);
+	nodes_.emplace(id, node);
+	insert(node);
+}
+
+void HnswGraph::Remove(IdType id) {
+	const auto it = nodes_.find(id);
+	if (it == nodes_.end()) return;
+	ids_[it->second] = -1;
+	nodes_.erase(it);
+	if (ids_.size() > 2 * nodes_.size() + kMinRemovedNodesForRebuild) rebuild();
+}
+
+std::vector<HnswGraph::Neighbor> HnswGraph::Search(const float *query, size_t k, size_t ef) const {
+	std::vector<Neighbor> res;
+	if (nodes_.empty() || k == 0) return res;
+	std::vector<float> normalized;
+	if (params_.metric == Metric::Cosine) {
+		normalized.assign(query, query + params_.dimension);
+		hnsw::Normalize(normalized.data(), params_.dimension);
+		query = normalized.data();
+	}
+	const NodeId entry = greedySearch(query, entryPoint_, maxLevel_, 1);
+	const auto found = searchLayer(query, entry, std::max(ef, k), 0, true);
+	res.reserve(std::min(k, found.size()));
+	for (size_t i = 0; i < found.size() && i < k; ++i) res.push_back({found[i].distance, ids_[found[i].node]});
+	return res;
+}
+
+size_t HnswGraph::HeapSize() const noexcept {
+	size_t size = vectors_.capacity() * sizeof(float) + ids_.capacity() * sizeof(IdType) +
+				  bottomLinks_.capacity() * sizeof(uint32_t) + upperLinks_.capacity() * sizeof(std::vector<uint32_t>) +
+				  nodes_.bucket_count() * sizeof(std::pair<IdType, NodeId>);
+	for (const auto &links : upperLinks_) size += links.capacity() * sizeof(uint32_t);
+	return size;
+}
+
+float HnswGraph::distance(const float *lhs, const float *rhs) const noexcept {
+	if (params_.metric == Metric::L2) return hnsw::L2Sqr(lhs, rhs, params_.dimension);
+	return 1.0f - hnsw::InnerProduct(lhs, rhs, params_.dimension);
+}
+
+uint32_t *HnswGraph::linksOf(NodeId node, int level) noexcept {
+	if (level == 0) return bottomLinks_.data() + size_t(node) * (maxLinks(0) + 1);
+	return upperLinks_[node].data() + size_t(level - 1) * (maxLinks(level) + 1);
+}
+
+const uint32_t *HnswGraph::linksOf(NodeId node, int level) const noexcept {
+	return const_cast<HnswGraph *>(this)->linksOf(node, level);
+}
+
+int HnswGraph::randomLevel() {
+	// (0, 1] to avoid the logarithm of zero
+	const double r = 1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+	return std::min(int(-std::log(r) * levelMult_), kMaxLevel);
+}
+
+HnswGraph::NodeId HnswGraph::greedySearch(const float *query, NodeId entry, int fromLevel, int toLevel) const {
+	float entryDistance = distance(query, vectorOf(entry));
+	for (int level = fromLevel; level >= toLevel; --level) {
+		for (bool changed = true; changed;) {
+			changed = false;
+			const uint32_t *links = linksOf(entry, level);
+			for (uint32_t i = 1; i <= links[0]; ++i) {
+				const float d = distance(query, vectorOf(links[i]));
+				if (d < entryDistance) {
+					entryDistance = d;
+					entry = links[i];
+					changed = true;
+				}
+			}
+		}
+	}
+	return entry;
+}
+
+std::vector<HnswGraph::Candidate> HnswGraph::searchLayer(const float *query, NodeId entry, size_t ef, int level, bool liveOnly) const {
+	VisitedNodes &visited = VisitedNodes::Get(ids_.size());
+	// Nearest found nodes are kept in the max heap, so the farthest one is replaced by the nearer one
+	std::priority_queue<Candidate> nearest;
+	// Nodes, which links have to be explored, in the min heap
+	std::vector<Candidate> candidates;
+	const auto candidatesCmp = [](const Candidate &lhs, const Candidate &rhs) noexcept { return rhs < lhs; };
+	float bound = std::numeric_limits<float>::max();
+
+	visited.Visit(entry);
+	const float entryDistance = distance(query, vectorOf(entry));
+	if (!liveOnly || ids_[entry] >= 0) {
+		nearest.push({entryDistance, entry});
+		bound = entryDistance;
+	}
+	candidates.push_back({entryDistance, entry});
+	while (!candidates.empty()) {
+		std::pop_heap(candidates.begin(), candidates.end(), candidatesCmp);
+		const Candidate current = candidates.back();
+		candidates.pop_back();
+		if (current.distance > bound && nearest.size() >= ef) break;
+
+		const uint32_t *links = linksOf(current.node, level);
+		for (uint32_t i = 1; i <= links[0]; ++i) {
+			const NodeId node = links[i];
+			if (!visited.Visit(node)) continue;
+			const float d = distance(query, vectorOf(node));
+			if (nearest.size() >= ef && d >= bound) continue;
+			candidates.push_back({d, node});
+			std::push_heap(candidates.begin(), candidates.end(), candidatesCmp);
+			if (liveOnly && ids_[node] < 0) continue;
+			nearest.push({d, node});
+			if (nearest.size() > ef) nearest.pop();
+			bound = nearest.top().distance;
+		}
+	}
+
+	std::vector<Candidate> res(nearest.size());
+	for (size_t i = res.size(); i > 0; --i) {
+		res[i - 1] = nearest.top();
+		nearest.pop();
+	}
+	return res;
+}
+
+void HnswGraph::selectNeighbors(std::vector<Candidate> &candidates, size_t m) const {
+	if (candidates.size() <= m) return;
+	std::vector<Candidate> selected;
+	selected.reserve(m);
+	for (const Candidate &candidate : candidates) {
+		const float *vector = vectorOf(candidate.node);
+		const bool diverse = std::all_of(selected.begin(), selected.end(), [&](const Candidate &s) {
+			return distance(vector, vectorOf(s.node)) >= candidate.distance;
+		});
+		if (diverse) {
+			selected.push_back(candidate);
+			if (selected.size() == m) break;
+		}
+	}
+	candidates.swap(selected);
+}
+
+void HnswGraph::connect(NodeId node, NodeId neighbor, int level) {
+	uint32_t *links = linksOf(node, level);
+	const size_t capacity = maxLinks(level);
+	if (links[0] < capacity) {
+		links[++links[0]] = neighbor;
+		return;
+	}
+	// Node has no room for the new link, so its links are selected again
+	const float *vector = vectorOf(node);
+	std::vector<Candidate> candidates;
+	candidates.reserve(capacity + 1);
+	candidates.push_back({distance(vector, vectorOf(neighbor)), neighbor});
+	for (uint32_t i = 1; i <= links[0]; ++i) candidates.push_back({distance(vector, vectorOf(links[i])), links[i]});
+	std::sort(candidates.begin(), candidates.end());
+	selectNeighbors(candidates, capacity);
+	links[0] = candidates.size();
+	for (size_t i = 0; i < candidates.size(); ++i) links[i + 1] = candidates[i].node;
+}
+
+void HnswGraph::insert(NodeId node) {
+	const int level = randomLevel();
+	bottomLinks_.resize(bottomLinks_.size() + maxLinks(0) + 1, 0);
+	upperLinks_.emplace_back(size_t(level) * (maxLinks(1) + 1), 0);
+	if (maxLevel_ < 0) {
+		entryPoint_ = node;
+		maxLevel_ = level;
+		return;
+	}
+
+	const float *vector = vectorOf(node);
+	NodeId entry = greedySearch(vector, entryPoint_, maxLevel_, level + 1);
+	for (int l = std::min(level, maxLevel_); l >= 0; --l) {
+		std::vector<Candidate> candidates = searchLayer(vector, entry, params_.efConstruction, l, false);
+		entry = candidates.front().node;
+		selectNeighbors(candidates, params_.m);
+		uint32_t *links = linksOf(node, l);
+		for (const Candidate &candidate : candidates) {
+			links[++links[0]] = candidate.node;
+			connect(candidate.node, node, l);
+		}
+	}
+	if (level > maxLevel_) {
+		entryPoint_ = node;
+		maxLevel_ = level;
+	}
+}
+
+void HnswGraph::rebuild() {
+	std::vector<float> vectors;
+	std::vector<IdType> ids;
+	vectors.reserve(nodes_.size() * params_.dimension);
+	ids.reserve(nodes_.size());
+	for (NodeId node = 0; node < ids_.size(); ++node) {
+		if (ids_[node] < 0) continue;
+		ids.push_back(ids_[node]);
+		vectors.insert(vectors.end(), vectorOf(node), vectorOf(node) + params_.dimension);
+	}
+
+	vectors_ = std::move(vectors);
+	ids_ = std::move(ids);
+	bottomLinks_ = std::vector<uint32_t>();
+	upperLinks_ = std::vector<std::vector<uint32_t>>();
+	nodes_.clear();
+	maxLevel_ = -1;
+	bottomLinks_.reserve(ids_.size() * (maxLinks(0) + 1));
+	upperLinks_.reserve(ids_.size());
+	// Vectors are already normalized
+	for (NodeId node = 0; node < ids_.size(); ++node) {
+		nodes_.emplace(ids_[node], node);
+		insert(node);
+	}
+}
+
+}  // namespace reindexer
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+#include "core/type_consts.h"
+#include "estl/fast_hash_map.h"
+
+namespace reindexer {
+
+/// Hierarchical navigable small world graph of the fixed dimension float vectors, which are identified by the row ids.
+/// Each node is linked with its nearest nodes on the layers from the bottom one up to the random level of the node. Search descends
+/// greedily through the upper (sparse) layers and explores the bottom layer by the best first search with the bounded candidates list.
+/// Removed nodes stay in the graph as the routing ones and are skipped by the search, so the graph is rebuilt, when they are the most
+/// of its nodes
+class HnswGraph {
+public:
+	enum class Metric { L2, Cosine, InnerProduct };
+	struct Params {
+		size_t dimension = 0;
+		Metric metric = Metric::L2;
+		// Max count of the links of the node on the upper layers. Nodes of the bottom layer have twice more links
+		size_t m = 16;
+		// Size of the candidates list, which is used to find the links of the inserted node
+		size_t efConstruction = 200;
+
+		bool operator==(const Params &other) const noexcept {
+			return dimension == other.dimension && metric == other.metric && m == other.m && efConstruction == other.efConstruction;
+		}
+	};
+	struct Neighbor {
+		// Squared euclidean distance for L2 metric and (1 - inner product) for the others
+		float distance;
+		IdType id;
+	};
+
+	explicit HnswGraph(const Params &params);
+
+	const Params &GetParams() const noexcept { return params_; }
+	/// Replaces the vector of the id, if it is already in the graph
+	void Add(IdType id, const float *vector);
+	void Remove(IdType id);
+	bool Contains(IdType id) const { return nodes_.find(id) != nodes_.end(); }
+	/// Approximate search of the nearest vectors. May be called concurrently
+	/// @param ef - size of the candidates list, which controls the accuracy of the search. Not less than k is used
+	/// @return up to k nearest vectors in the increasing order of the distances
+	std::vector<Neighbor> Search(const float *query, size_t k, size_t ef) const;
+	size_t Size() const noexcept { return nodes_.size(); }
+	size_t HeapSize() const noexcept;
+
+private:
+	using NodeId = uint32_t;
+	struct Candidate {
+		float distance;
+		NodeId node;
+		bool operator<(const Candidate &other) const noexcept { return distance < other.distance; }
+	};
+
+	float distance(const float *lhs, const float *rhs) const noexcept;
+	const float *vectorOf(NodeId node) const noexcept { return vectors_.data() + size_t(node) * params_.dimension; }
+	// Links of the node on the level. The first element is the count of the links
+	uint32_t *linksOf(NodeId node, int level) noexcept;
+	const uint32_t *linksOf(NodeId node, int level) const noexcept;
+	size_t maxLinks(int level) const noexcept { return level ? params_.m : 2 * params_.m; }
+	int randomLevel();
+	NodeId greedySearch(const float *query, NodeId entry, int fromLevel, int toLevel) const;
+	// @return up to ef nearest nodes of the level in the increasing order of the distances
+	std::vector<Candidate> searchLayer(const float *query, NodeId entry, size_t ef, int level, bool liveOnly) const;
+	// Keeps up to m candidates, which are nearer to the base node, than to the already selected ones. Candidates have to be sorted
+	void selectNeighbors(std::vector<Candidate> &candidates, size_t m) const;
+	void connect(NodeId node, NodeId neighbor, int level);
+	void insert(NodeId node);
+	void rebuild();
+
+	Params params_;
+	double levelMult_;
+	std::mt19937 rng_;
+	// Vectors of the nodes (normalized for the cosine metric)
+	std::vector<float> vectors_;
+	// Row ids of the nodes. Removed nodes have negative ids
+	std::vector<IdType> ids_;
+	std::vector<uint32_t> bottomLinks_;
+	std::vector<std::vector<uint32_t>> upperLinks_;
+	fast_hash_map<IdType, NodeId> nodes_;
+	NodeId entryPoint_ = 0;
+	int maxLevel_ = -1;
+};
+
+}  // namespace reindexer
@@ -0,0 +1,112 @@
+#include "indexhnsw.h"
+#include <algorithm>
+#include "core/rdxcontext.h"
+#include "gason/gason.h"
+#include "tools/errors.h"
+
+namespace reindexer {
+
+// Size of the candidates list for the KNN condition without the explicit ef
+constexpr size_t kDefaultSearchEf = 64;
+constexpr size_t kMaxDimension = 16384;
+
+HnswGraph::Params IndexHnsw::ParseConfig(std::string_view config) {
+	HnswGraph::Params params;
+	try {
+		gason::JsonParser parser;
+		const auto root = parser.Parse(config.empty() ? std::string_view("{}") : config);
+		params.dimension = root["dimension"].As<size_t>(0, 0, kMaxDimension);
+		if (params.dimension == 0) throw Error(errParams, "Hnsw index config must contain positive 'dimension'");
+		const auto metric = root["metric"].As<std::string>("l2");
+		if (metric == "l2") {
+			params.metric = HnswGraph::Metric::L2;
+		} else if (metric == "cosine") {
+			params.metric = HnswGraph::Metric::Cosine;
+		} else if (metric == "inner_product") {
+			params.metric = HnswGraph::Metric::InnerProduct;
+		} else {
+			throw Error(errParams, "Unknown hnsw index metric '%s'. Expected 'l2', 'cosine' or 'inner_product'", metric);
+		}
+		params.m = root["m"].As<size_t>(params.m, 2, 128);
+		params.efConstruction = root["ef_construction"].As<size_t>(params.efConstruction, 1, 4096);
+	} catch (const gason::Exception &ex) {
+		throw Error(errParseJson, "Hnsw index config: %s", ex.what());
+	}
+	return params;
+}
+
+IndexHnsw::IndexHnsw(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields)
+	: IndexStore<double>(idef, std::move(payloadType), fields), graph_(ParseConfig(idef.opts_.config)) {}
+
+void IndexHnsw::Upsert(VariantArray &result, const VariantArray &keys, IdType id, bool &clearCache) {
+	// Items without the vector are not in the graph
+	if (!keys.empty() && !keys.IsNullValue()) {
+		const size_t dimension = graph_.GetParams().dimension;
+		if (keys.size() != dimension) {
+			throw Error(errParams, "Vector of hnsw index '%s' must have %d components, but %d were provided", name_, dimension, keys.size());
+		}
+		std::vector<float> vector;
+		vector.reserve(dimension);
+		for (const auto &key : keys) vector.push_back(key.As<double>());
+		graph_.Add(id, vector.data());
+	}
+	IndexStore<double>::Upsert(result, keys, id, clearCache);
+}
+
+void IndexHnsw::Delete(const VariantArray &keys, IdType id, StringsHolder &strHolder, bool &clearCache) {
+	graph_.Remove(id);
+	IndexStore<double>::Delete(keys, id, strHolder, clearCache);
+}
+
+SelectKeyResults IndexHnsw::SelectKey(const VariantArray &keys, CondType condition, SortType sortId, Index::SelectOpts opts,
+									  BaseFunctionCtx::Ptr ctx, const RdxContext &rdxCtx) {
+	if (condition != CondKnn) return IndexStore<double>::SelectKey(keys, condition, sortId, opts, ctx, rdxCtx);
+
+	const auto indexWard(rdxCtx.BeforeIndexWork());
+	// Nearest ids are found in the whole namespace, so they can not be checked by the comparator of the single item
+	if (opts.forceComparator) throw Error(errQueryExec, "KNN condition by index '%s' can not be combined with fulltext search", name_);
+	const size_t dimension = graph_.GetParams().dimension;
+	if (keys.size() != dimension + 2) {
+		throw Error(errQueryExec, "KNN condition by index '%s' expects k, ef and vector of %d components, but %d values were provided", name_,
+					dimension, keys.size());
+	}
+	const int64_t k = keys[0].As<int64_t>();
+	const int64_t ef = keys[1].As<int64_t>();
+	if (k <= 0 || ef < 0) throw Error(errQueryExec, "KNN condition expects positive k and not negative ef, but k=%d and ef=%d", k, ef);
+	std::vector<float> query;
+	query.reserve(dimension);
+	for (size_t i = 2; i < keys.size(); ++i) query.push_back(keys[i].As<double>());
+
+	const auto neighbors = graph_.Search(query.data(), k, ef ? ef : kDefaultSearchEf);
+	std::vector<IdType> sortedIds;
+	sortedIds.reserve(neighbors.size());
+	for (const auto &neighbor : neighbors) sortedIds.push_back(neighbor.id);
+	std::sort(sortedIds.begin(), sortedIds.end());
+	IdSet::Ptr ids = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>();
+	ids->Append(sortedIds.begin(), sortedIds.end(), IdSet::Unordered);
+
+	SelectKeyResult res;
+	res.emplace_back(std::move(ids));
+	return SelectKeyResults(std::move(res));
+}
+
+void IndexHnsw::SetOpts(const IndexOpts &opts) {
+	const HnswGraph::Params params = ParseConfig(opts.config);
+	if (!(params == graph_.GetParams())) {
+		throw Error(errParams, "Config of hnsw index '%s' can not be changed. Index has to be recreated", name_);
+	}
+	IndexStore<double>::SetOpts(opts);
+}
+
+IndexMemStat IndexHnsw::GetMemStat() {
+	IndexMemStat ret = IndexStore<double>::GetMemStat();
+	ret.uniqKeysCount = graph_.Size();
+	ret.graphSize = graph_.HeapSize();
+	return ret;
+}
+
+std::unique_ptr<Index> IndexHnsw_New(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields) {
+	return std::unique_ptr<Index>{new IndexHnsw(idef, std::move(payloadType), fields)};
+}
+
+}  // namespace reindexer
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/index/indexstore.h"
+#include "hnswgraph.h"
+
+namespace reindexer {
+
+/// Index of the fixed dimension vectors of the double array field for the approximate nearest neighbors search (KNN condition).
+/// Vectors are stored in the graph as floats. Usual conditions on the field are checked by the comparators
+class IndexHnsw : public IndexStore<double> {
+public:
+	IndexHnsw(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields);
+
+	using IndexStore<double>::Upsert;
+	void Upsert(VariantArray &result, const VariantArray &keys, IdType id, bool &clearCache) override;
+	using IndexStore<double>::Delete;
+	void Delete(const VariantArray &keys, IdType id, StringsHolder &, bool &clearCache) override;
+	SelectKeyResults SelectKey(const VariantArray &keys, CondType condition, SortType stype, Index::SelectOpts opts,
+							   BaseFunctionCtx::Ptr ctx, const RdxContext &) override;
+	void SetOpts(const IndexOpts &opts) override;
+	std::unique_ptr<Index> Clone() override { return std::unique_ptr<Index>{new IndexHnsw(*this)}; }
+	IndexMemStat GetMemStat() override;
+	size_t Size() const override { return graph_.Size(); }
+
+	/// Parses the index config: {"dimension": N, "metric": "l2" | "cosine" | "inner_product", "m": 16, "ef_construction": 200}
+	static HnswGraph::Params ParseConfig(std::string_view config);
+
+private:
+	HnswGraph graph_;
+};
+
+std::unique_ptr<Index> IndexHnsw_New(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields);
+
+}  // namespace reindexer
@@ -1,10 +1,12 @@
 #include "index.h"
 #include "core/namespacedef.h"
+#include "hnsw/indexhnsw.h"
 #include "indexordered.h"
 #include "indextext/fastindextext.h"
 #include "indextext/fuzzyindextext.h"
 #include "rtree/indexrtree.h"
 #include "tools/logger.h"
+#include "tools/workstealingscheduler.h"
 #include "ttlindex.h"
 
 namespace reindexer {
@@ -25,9 +27,55 @@ Index::Index(const Index& obj)
 	  fields_(obj.fields_),
 	  keyType_(obj.keyType_),
 	  selectKeyType_(obj.selectKeyType_),
-	  sortedIdxCount_(obj.sortedIdxCount_) {}
+	  sortedIdxCount_(obj.sortedIdxCount_),
+	  stats_(obj.Stats()) {}
 
 std::unique_ptr<Index> Index::New(const IndexDef& idef, PayloadType payloadType, const FieldsSet& fields) {
+	if (idef.opts_.IsColumnar()) {
+		switch (idef.Type()) {
+			case IndexIntBTree:
+			case IndexDoubleBTree:
+			case IndexInt64BTree:
+			case IndexIntHash:
+			case IndexInt64Hash:
+			case IndexIntStore:
+			case IndexInt64Store:
+			case IndexDoubleStore:
+			case IndexBool:
+			case IndexTtl:
+				if (!idef.opts_.IsArray() && !idef.opts_.IsSparse()) break;
+				[[fallthrough]];
+			default:
+				throw Error(errParams, "Columnar option is supported only by scalar numeric non-sparse indexes, but index '%s' is '%s' %s",
+							idef.name_, idef.indexType_, idef.fieldType_);
+		}
+	}
+	if (idef.opts_.IsFlatHash() && idef.Type() != IndexIntHash && idef.Type() != IndexInt64Hash && idef.Type() != IndexStrHash) {
+		throw Error(errParams, "Flat hash option is supported only by int, int64 and string hash indexes, but index '%s' is '%s' %s",
+					idef.name_, idef.indexType_, idef.fieldType_);
+	}
+	if (idef.opts_.IsLearned() && idef.Type() != IndexIntBTree && idef.Type() != IndexInt64BTree) {
+		throw Error(errParams, "Learned option is supported only by int and int64 tree indexes, but index '%s' is '%s' %s", idef.name_,
+					idef.indexType_, idef.fieldType_);
+	}
+	if (idef.opts_.IsBloomFilter() && idef.Type() != IndexIntHash && idef.Type() != IndexInt64Hash && idef.Type() != IndexStrHash) {
+		throw Error(errParams, "Bloom filter option is supported only by int, int64 and string hash indexes, but index '%s' is '%s' %s",
+					idef.name_, idef.indexType_, idef.fieldType_);
+	}
+	if (idef.opts_.IsTrigram()) {
+		if (idef.Type() != IndexStrHash && idef.Type() != IndexStrBTree) {
+			throw Error(errParams, "Trigram option is supported only by string hash and tree indexes, but index '%s' is '%s' %s", idef.name_,
+						idef.indexType_, idef.fieldType_);
+		}
+		// Keys, which are equal by collation, have to be equal by the case insensitive LIKE
+		const CollateMode collateMode = idef.opts_.GetCollateMode();
+		if (collateMode != CollateNone && collateMode != CollateASCII && collateMode != CollateUTF8) {
+			throw Error(errParams, "Trigram option is not supported by index '%s' with numeric or custom collate mode", idef.name_);
+		}
+	}
+	if (idef.Type() == ::IndexHnsw && (!idef.opts_.IsArray() || idef.opts_.IsSparse() || idef.opts_.IsPK())) {
+		throw Error(errParams, "Hnsw index '%s' has to be not sparse and not primary key array index", idef.name_);
+	}
 	switch (idef.Type()) {
 		case IndexStrBTree:
 		case IndexIntBTree:
@@ -56,6 +104,8 @@ std::unique_ptr<Index> Index::New(const IndexDef& idef, PayloadType payloadType,
 			return TtlIndex_New(idef, std::move(payloadType), fields);
 		case ::IndexRTree:
 			return IndexRTree_New(idef, std::move(payloadType), fields);
+		case ::IndexHnsw:
+			return IndexHnsw_New(idef, std::move(payloadType), fields);
 		default:
 			throw Error(errParams, "Ivalid index type %d for index '%s'", idef.Type(), idef.name_);
 	}
@@ -89,6 +139,21 @@ void Index::dump(S& os, std::string_view step, std::string_view offset) const {
 	   << offset << '}';
 }
 
+void Index::Update(VariantArray& keys, const VariantArray& newKeys, IdType id, StringsHolder& strHolder, bool& clearCache) {
+	Delete(keys, id, strHolder, clearCache);
+	keys.resize(0);
+	Upsert(keys, newKeys, id, clearCache);
+}
+
+void Index::BulkDelete(span<VariantArray> keys, span<IdType> ids, StringsHolder& strHolder, bool& clearCache) {
+	assertrx(keys.size() == ids.size());
+	for (size_t i = 0; i < ids.size(); ++i) Delete(keys[i], ids[i], strHolder, clearCache);
+}
+
+void Index::AddUpdateSortedIdsTasks(const UpdateSortedContext& ctx, WorkStealingScheduler& scheduler) {
+	scheduler.Add([this, &ctx] { UpdateSortedIds(ctx); });
+}
+
 template void Index::dump<std::ostream>(std::ostream&, std::string_view, std::string_view) const;
 
 }  // namespace reindexer
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <bitset>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <vector>
 #include "core/idset.h"
 #include "core/index/keyentry.h"
@@ -18,8 +20,10 @@
 
 namespace reindexer {
 
+class IndexStats;
 class RdxContext;
 class StringsHolder;
+class WorkStealingScheduler;
 
 class Index {
 public:
@@ -32,7 +36,8 @@ public:
 			  forceComparator(0),
 			  unbuiltSortOrders(0),
 			  indexesNotOptimized(0),
-			  inTransaction{0} {}
+			  inTransaction{0},
+			  ftTopK(0) {}
 		unsigned itemsCountInNamespace;
 		int maxIterations;
 		unsigned distinct : 1;
@@ -41,6 +46,8 @@ public:
 		unsigned unbuiltSortOrders : 1;
 		unsigned indexesNotOptimized : 1;
 		unsigned inTransaction : 1;
+		// Count of the best ranked fulltext results, required by query (0 - all of the results are required)
+		unsigned ftTopK;
 	};
 	using KeyEntry = reindexer::KeyEntry<IdSet>;
 	using KeyEntryPlain = reindexer::KeyEntry<IdSetPlain>;
@@ -53,14 +60,32 @@ public:
 	virtual void Upsert(VariantArray& result, const VariantArray& keys, IdType id, bool& clearCache) = 0;
 	virtual void Delete(const Variant& key, IdType id, StringsHolder&, bool& clearCache) = 0;
 	virtual void Delete(const VariantArray& keys, IdType id, StringsHolder&, bool& clearCache) = 0;
+	/// Deletes the keys of the several items. Default implementation deletes them item by item
+	/// @param keys - keys of each item, as for the single item deletion
+	/// @param ids - ids of the items in ascending order
+	virtual void BulkDelete(span<VariantArray> keys, span<IdType> ids, StringsHolder&, bool& clearCache);
+	/// Replaces the keys of the item by the new ones
+	/// @param keys - previous keys of the item on input and the keys, which have to be stored in the payload, on output
+	virtual void Update(VariantArray& keys, const VariantArray& newKeys, IdType id, StringsHolder&, bool& clearCache);
 
 	virtual SelectKeyResults SelectKey(const VariantArray& keys, CondType condition, SortType stype, SelectOpts opts,
 									   BaseFunctionCtx::Ptr ctx, const RdxContext&) = 0;
 	virtual void Commit() = 0;
 	virtual void CommitFulltext() {}
+	/// Commits fulltext index from the namespace's background routine, so the first select after the updates does not have to do it.
+	/// Concurrent selects wait for the commit completion. Full rebuild is interrupted, if isCanceled returns true
+	virtual void CommitFulltextBackground(const std::function<bool()>& isCanceled) { (void)isCanceled; }
 	virtual void MakeSortOrders(UpdateSortedContext&) {}
 
 	virtual void UpdateSortedIds(const UpdateSortedContext& ctx) = 0;
+	/// Adds tasks, which perform UpdateSortedIds, to the scheduler. Large indexes may be splitted into several tasks,
+	/// which are executed concurrently
+	virtual void AddUpdateSortedIdsTasks(const UpdateSortedContext& ctx, WorkStealingScheduler&);
+	/// Same as AddUpdateSortedIdsTasks, but for the sort order, which was not changed since the last build (see MarkBuilt).
+	/// Index may update only the keys, which were modified since that time
+	virtual void AddUpdateSortedIdsDeltaTasks(const UpdateSortedContext& ctx, WorkStealingScheduler& scheduler) {
+		AddUpdateSortedIdsTasks(ctx, scheduler);
+	}
 	virtual size_t Size() const { return 0; }
 	virtual std::unique_ptr<Index> Clone() = 0;
 	virtual bool IsOrdered() const noexcept { return false; }
@@ -69,6 +94,24 @@ public:
 	virtual int64_t GetTTLValue() const { return 0; }
 	virtual IndexIterator::Ptr CreateIterator() const { return nullptr; }
 	virtual bool RequireWarmupOnNsCopy() const noexcept { return false; }
+	/// Dense rowId-indexed array of index keys. 'data' is nullptr, if index does not keep column
+	struct ColumnView {
+		const void* data = nullptr;
+		size_t size = 0;
+	};
+	virtual ColumnView Column() const noexcept { return {}; }
+	/// Calls the function for each key of the scalar index with the count of the rows, which contain this key
+	/// @return false, if the keys of the index can not be enumerated
+	virtual bool ForEachKey(const std::function<void(const Variant& key, size_t count)>&) const { return false; }
+	/// Selects idsets of the keys in the increasing order of their distances from the point, until at least minIds ids are selected.
+	/// Each id, which is not selected, has the distance not less, than the selected ones
+	/// @param exhausted - set to true, if all the ids of the index were selected
+	/// @return false, if the index can not select the nearest keys
+	virtual bool SelectNearest(Point, size_t minIds, SortType, SelectKeyResult&, bool& exhausted) const {
+		(void)minIds;
+		(void)exhausted;
+		return false;
+	}
 
 	const PayloadType& GetPayloadType() const { return payloadType_; }
 	void UpdatePayloadType(PayloadType payloadType) { payloadType_ = std::move(payloadType); }
@@ -103,6 +146,13 @@ public:
 	virtual bool IsBuilt() const noexcept { return isBuilt_; }
 	virtual void MarkBuilt() noexcept { isBuilt_ = true; }
 	virtual void EnableUpdatesCountingMode(bool /*val*/) {}
+	/// Rebuilds the internal structure of the index after the bulk insertion of the items (namespace loading or items update).
+	/// Is called under the exclusive namespace lock only
+	virtual void BulkInsertionDone() {}
+	/// Rebuilds the statistics of the keys distribution. Indexes, which do not support it, keep no statistics
+	virtual void UpdateStats(size_t /*itemsCount*/) {}
+	/// @return statistics, which were built by the last UpdateStats call, or nullptr. May be called concurrently with UpdateStats
+	std::shared_ptr<const IndexStats> Stats() const noexcept { return std::atomic_load(&stats_); }
 
 	virtual void Dump(std::ostream& os, std::string_view step = "  ", std::string_view offset = "") const { dump(os, step, offset); }
 
@@ -129,6 +179,8 @@ protected:
 	// Count of sorted indexes in namespace to resereve additional space in idsets
 	int sortedIdxCount_ = 0;
 	bool isBuilt_{false};
+	// Keys distribution. Replaced atomically, because it is rebuilt under the namespace read lock
+	std::shared_ptr<const IndexStats> stats_;
 
 private:
 	template <typename S>
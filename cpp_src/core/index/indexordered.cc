@@ -11,7 +11,8 @@ template <typename T>
 Variant IndexOrdered<T>::Upsert(const Variant &key, IdType id, bool &clearCache) {
 	if (key.Type() == KeyValueNull) {
 		if (this->empty_ids_.Unsorted().Add(id, IdSet::Auto, this->sortedIdxCount_)) {
-			if (this->cache_) this->cache_.reset();
+			this->emptyIdsSortUpdated_ = true;
+			this->resetCache();
 			clearCache = true;
 			this->isBuilt_ = false;
 		}
@@ -21,18 +22,21 @@ Variant IndexOrdered<T>::Upsert(const Variant &key, IdType id, bool &clearCache)
 
 	auto keyIt = this->idx_map.lower_bound(static_cast<ref_type>(key));
 
-	if (keyIt == this->idx_map.end() || this->idx_map.key_comp()(static_cast<ref_type>(key), keyIt->first))
+	if (keyIt == this->idx_map.end() || this->idx_map.key_comp()(static_cast<ref_type>(key), keyIt->first)) {
 		keyIt = this->idx_map.insert(keyIt, {static_cast<typename T::key_type>(key), typename T::mapped_type()});
-	else
+		resetLearned();
+	} else
 		this->delMemStat(keyIt);
 
 	if (keyIt->second.Unsorted().Add(id, this->opts_.IsPK() ? IdSet::Ordered : IdSet::Auto, this->sortedIdxCount_)) {
 		this->isBuilt_ = false;
-		if (this->cache_) this->cache_.reset();
+		this->sortUpdates_.markUpdated(this->idx_map, keyIt, false);
+		this->resetCache();
 		clearCache = true;
 	}
 	this->tracker_.markUpdated(this->idx_map, keyIt);
 	this->addMemStat(keyIt);
+	if (this->opts_.IsColumnar()) this->upsertColumn(key, id);
 
 	if (this->KeyType() == KeyValueString && this->opts_.GetCollateMode() != CollateNone) {
 		return IndexStore<typename T::key_type>::Upsert(key, id, clearCache);
@@ -41,6 +45,37 @@ Variant IndexOrdered<T>::Upsert(const Variant &key, IdType id, bool &clearCache)
 	return Variant(keyIt->first);
 }
 
+template <typename T>
+void IndexOrdered<T>::Delete(const Variant &key, IdType id, StringsHolder &strHolder, bool &clearCache) {
+	const auto keysCount = this->idx_map.size();
+	IndexUnordered<T>::Delete(key, id, strHolder, clearCache);
+	if (keysCount != this->idx_map.size()) resetLearned();
+}
+
+template <typename T>
+void IndexOrdered<T>::BulkDelete(span<VariantArray> keys, span<IdType> ids, StringsHolder &strHolder, bool &clearCache) {
+	const auto keysCount = this->idx_map.size();
+	IndexUnordered<T>::BulkDelete(keys, ids, strHolder, clearCache);
+	if (keysCount != this->idx_map.size()) resetLearned();
+}
+
+template <typename T>
+void IndexOrdered<T>::Commit() {
+	IndexUnordered<T>::Commit();
+	if constexpr (kLearnable) {
+		if (!this->opts_.IsLearned() || learned_) return;
+		std::vector<typename T::key_type> keys;
+		std::vector<const typename T::mapped_type *> values;
+		keys.reserve(this->idx_map.size());
+		values.reserve(this->idx_map.size());
+		for (const auto &keyIt : this->idx_map) {
+			keys.emplace_back(keyIt.first);
+			values.emplace_back(&keyIt.second);
+		}
+		std::atomic_store(&learned_, std::shared_ptr<const Learned>(std::make_shared<Learned>(std::move(keys), std::move(values))));
+	}
+}
+
 template <typename T>
 SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType condition, SortType sortId, Index::SelectOpts opts,
 											BaseFunctionCtx::Ptr ctx, const RdxContext &rdxCtx) {
@@ -56,6 +91,13 @@ SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType c
 	if (keys.size() < 1) {
 		throw Error(errParams, "For condition required at least 1 argument, but provided 0");
 	}
+	if constexpr (kLearnable) {
+		if (!opts.unbuiltSortOrders && this->opts_.IsLearned()) {
+			if (const auto learned = std::atomic_load(&learned_)) {
+				return selectLearned(*learned, keys, condition, sortId, opts, ctx, rdxCtx);
+			}
+		}
+	}
 
 	auto startIt = this->idx_map.begin();
 	auto endIt = this->idx_map.end();
@@ -115,6 +157,16 @@ SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType c
 		// sort by this index. Just give part of sorted ids;
 		res.push_back(SingleSelectKeyResult(idFirst, idLast + 1));
 	} else {
+		// Ids of the different keys do not intersect only in the non-array index, so the ids of the keys can be removed from the range
+		const bool composable = !sortId && !opts.distinct && !opts.disableIdSetCache && this->cache_ && !this->opts_.IsArray() &&
+								!IsComposite(this->Type());
+		if (composable) {
+			if (auto ids = selectComposedRange(startIt, endIt)) {
+				res.push_back(SingleSelectKeyResult(std::move(ids)));
+				return SelectKeyResults(std::move(res));
+			}
+		}
+
 		int count = 0;
 		auto it = startIt;
 
@@ -137,10 +189,15 @@ SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType c
 				return false;
 			};
 
-			if (count > 1 && !opts.distinct && !opts.disableIdSetCache)
+			if (count > 1 && !opts.distinct && !opts.disableIdSetCache) {
 				this->tryIdsetCache(keys, condition, sortId, selector, res);
-			else
+				// Merged idset is remembered as the range, so the following ranges with the shifted bounds are composed from it
+				if (composable && res.size() == 1 && res[0].tempIds_) {
+					this->cache_->PutRange({Variant(startIt->first), Variant(std::prev(endIt)->first), res[0].tempIds_});
+				}
+			} else {
 				selector(res);
+			}
 		} else {
 			return IndexStore<typename T::key_type>::SelectKey(keys, condition, sortId, opts, ctx, rdxCtx);
 		}
@@ -148,6 +205,136 @@ SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType c
 	return SelectKeyResults(std::move(res));
 }
 
+template <typename F>
+static void forEachId(const IdSet &ids, const F &f) {
+	if (ids.Bitmap()) {
+		ids.Bitmap()->ForEach(f);
+	} else {
+		for (IdType id : ids) f(id);
+	}
+}
+
+template <typename T>
+IdSet::Ptr IndexOrdered<T>::selectComposedRange(typename T::iterator startIt, typename T::iterator endIt) {
+	// Keys, by which the ranges differ, are merged one by one (like the keys of the range itself), so their count is limited the same way
+	constexpr size_t kMaxDeltaKeys = 50;
+	const auto mapEnd = this->idx_map.end();
+	const auto before = [this, mapEnd](typename T::iterator lhs, typename T::iterator rhs) {
+		return lhs != mapEnd && (rhs == mapEnd || this->idx_map.key_comp()(lhs->first, rhs->first));
+	};
+	for (const IdSetCacheRange &range : this->cache_->GetRanges()) {
+		const auto cachedStart = this->idx_map.find(static_cast<ref_type>(range.first));
+		auto cachedEnd = this->idx_map.find(static_cast<ref_type>(range.last));
+		if (cachedStart == mapEnd || cachedEnd == mapEnd) continue;
+		++cachedEnd;
+		if (!before(startIt, cachedEnd) || !before(cachedStart, endIt)) continue;
+
+		SelectKeyResult added, removed;
+		size_t deltaKeys = 0;
+		const auto collect = [&deltaKeys](typename T::iterator from, typename T::iterator to, SelectKeyResult &res) {
+			for (; from != to && deltaKeys <= kMaxDeltaKeys; ++from, ++deltaKeys) res.push_back(SingleSelectKeyResult(from->second, 0));
+		};
+		if (before(startIt, cachedStart)) {
+			collect(startIt, cachedStart, added);
+		} else {
+			collect(cachedStart, startIt, removed);
+		}
+		if (before(endIt, cachedEnd)) {
+			collect(endIt, cachedEnd, removed);
+		} else {
+			collect(cachedEnd, endIt, added);
+		}
+		if (deltaKeys > kMaxDeltaKeys) continue;
+		if (!deltaKeys) return range.ids;
+
+		std::vector<IdType> removedIds, addedIds;
+		if (!removed.empty()) forEachId(*removed.mergeIdsets(), [&removedIds](IdType id) { removedIds.push_back(id); });
+		if (!added.empty()) forEachId(*added.mergeIdsets(), [&addedIds](IdType id) { addedIds.push_back(id); });
+		std::vector<IdType> ids;
+		ids.reserve(range.ids->Size() + addedIds.size());
+		auto removedIt = removedIds.cbegin();
+		auto addedIt = addedIds.cbegin();
+		forEachId(*range.ids, [&](IdType id) {
+			for (; removedIt != removedIds.cend() && *removedIt < id; ++removedIt) {
+			}
+			if (removedIt != removedIds.cend() && *removedIt == id) return;
+			for (; addedIt != addedIds.cend() && *addedIt < id; ++addedIt) ids.push_back(*addedIt);
+			ids.push_back(id);
+		});
+		ids.insert(ids.end(), addedIt, addedIds.cend());
+
+		IdSet::Ptr res;
+		if (ids.size() >= kMinIdsetSizeForBitmap) {
+			IdSetBitmap bitmap;
+			bitmap.Add(ids.cbegin(), ids.cend());
+			res = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>(std::move(bitmap));
+		} else {
+			res = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>();
+			res->reserve(ids.size());
+			for (IdType id : ids) res->Add(id, IdSet::Unordered, 0);
+		}
+		this->cache_->PutRange({Variant(startIt->first), Variant(std::prev(endIt)->first), res});
+		return res;
+	}
+	return IdSet::Ptr();
+}
+
+template <typename T>
+SelectKeyResults IndexOrdered<T>::selectLearned(const Learned &learned, const VariantArray &keys, CondType condition, SortType sortId,
+												Index::SelectOpts opts, BaseFunctionCtx::Ptr ctx, const RdxContext &rdxCtx) {
+	SelectKeyResult res;
+	const auto key1 = static_cast<ref_type>(keys[0]);
+	size_t startPos = 0, endPos = learned.Size();
+	switch (condition) {
+		case CondLt:
+			endPos = learned.LowerBound(key1);
+			break;
+		case CondLe:
+			endPos = learned.UpperBound(key1);
+			break;
+		case CondGt:
+			startPos = learned.UpperBound(key1);
+			break;
+		case CondGe:
+			startPos = learned.LowerBound(key1);
+			break;
+		case CondRange:
+			if (keys.size() != 2) throw Error(errParams, "For ranged query reuqired 2 arguments, but provided %d", keys.size());
+			startPos = learned.LowerBound(key1);
+			endPos = learned.UpperBound(static_cast<ref_type>(keys[1]));
+			break;
+		default:
+			throw Error(errParams, "Unknown query type %d", condition);
+	}
+	if (startPos >= endPos) {
+		// Empty result
+		return SelectKeyResults(std::move(res));
+	}
+
+	const auto &values = learned.Values();
+	if (sortId && this->sortId_ == sortId && !opts.distinct) {
+		assertrx(values[startPos]->Sorted(this->sortId_).size());
+		assertrx(values[endPos - 1]->Sorted(this->sortId_).size());
+		// sort by this index. Just give part of sorted ids;
+		const IdType idFirst = values[startPos]->Sorted(this->sortId_).front();
+		const IdType idLast = values[endPos - 1]->Sorted(this->sortId_).back();
+		res.push_back(SingleSelectKeyResult(idFirst, idLast + 1));
+	} else if (endPos - startPos < 50) {
+		// Count of keys is known without iteration over the btree
+		auto selector = [&values, startPos, endPos, sortId](SelectKeyResult &res) -> bool {
+			for (size_t pos = startPos; pos < endPos; ++pos) res.push_back(SingleSelectKeyResult(*values[pos], sortId));
+			return false;
+		};
+		if (endPos - startPos > 1 && !opts.distinct && !opts.disableIdSetCache)
+			this->tryIdsetCache(keys, condition, sortId, selector, res);
+		else
+			selector(res);
+	} else {
+		return IndexStore<typename T::key_type>::SelectKey(keys, condition, sortId, opts, ctx, rdxCtx);
+	}
+	return SelectKeyResults(std::move(res));
+}
+
 template <typename T>
 void IndexOrdered<T>::MakeSortOrders(UpdateSortedContext &ctx) {
 	logPrintf(LogTrace, "IndexOrdered::MakeSortOrders (%s)", this->name_);
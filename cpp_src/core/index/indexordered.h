@@ -1,6 +1,7 @@
 #pragma once
 
 #include "indexunordered.h"
+#include "learnedkeys.h"
 
 namespace reindexer {
 
@@ -11,14 +12,37 @@ public:
 
 	IndexOrdered(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields)
 		: IndexUnordered<T>(idef, std::move(payloadType), fields) {}
+	// Learned keys point to the entries of the other index map, so they are not copied
+	IndexOrdered(const IndexOrdered &other) : IndexUnordered<T>(other) {}
 
 	SelectKeyResults SelectKey(const VariantArray &keys, CondType condition, SortType stype, Index::SelectOpts opts,
 							   BaseFunctionCtx::Ptr ctx, const RdxContext &) override;
 	Variant Upsert(const Variant &key, IdType id, bool &clearCache) override;
+	void Delete(const Variant &key, IdType id, StringsHolder &, bool &clearCache) override;
+	void BulkDelete(span<VariantArray> keys, span<IdType> ids, StringsHolder &, bool &clearCache) override;
+	void Commit() override;
 	void MakeSortOrders(UpdateSortedContext &ctx) override;
 	IndexIterator::Ptr CreateIterator() const override;
 	std::unique_ptr<Index> Clone() override;
 	bool IsOrdered() const noexcept override { return true; }
+
+private:
+	static constexpr bool kLearnable = std::is_same_v<typename T::key_type, int> || std::is_same_v<typename T::key_type, int64_t>;
+	using Learned = LearnedKeys<typename T::key_type, const typename T::mapped_type *>;
+
+	SelectKeyResults selectLearned(const Learned &, const VariantArray &keys, CondType condition, SortType sortId, Index::SelectOpts opts,
+								   BaseFunctionCtx::Ptr ctx, const RdxContext &);
+	// Composes the idset of the range [startIt, endIt) from the cached overlapping range and the idsets of the keys, by which they differ
+	// @return nullptr, if there is no cached range, which differs by few keys
+	IdSet::Ptr selectComposedRange(typename T::iterator startIt, typename T::iterator endIt);
+	void resetLearned() noexcept {
+		if (learned_) std::atomic_store(&learned_, std::shared_ptr<const Learned>());
+	}
+
+	// Snapshot of the keys, which is built by Commit for the indexes with 'learned' option. It is reset, when the set of keys is
+	// changed, so the keys, which are added after the last indexes optimization, are selected from the btree. Replaced atomically,
+	// because Commit is called under the namespace read lock
+	std::shared_ptr<const Learned> learned_;
 };
 
 std::unique_ptr<Index> IndexOrdered_New(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields);
@@ -0,0 +1,105 @@
+#include "indexstats.h"
+#include <algorithm>
+#include "tools/errors.h"
+
+namespace reindexer {
+
+IndexStats::IndexStats(std::vector<KeyCount> &&keys, size_t rows) : rows_(rows), distinctKeys_(keys.size()) {
+	if (keys.empty()) return;
+	keyType_ = keys.front().first.Type();
+	for (const auto &k : keys) entries_ += k.second;
+
+	const size_t topCount = std::min(kTopKeysCount, keys.size());
+	std::partial_sort(keys.begin(), keys.begin() + topCount, keys.end(),
+					  [](const KeyCount &lhs, const KeyCount &rhs) { return lhs.second > rhs.second; });
+	topKeys_.assign(keys.begin(), keys.begin() + topCount);
+	for (const auto &k : topKeys_) topEntries_ += k.second;
+
+	if (keyType_ != KeyValueInt && keyType_ != KeyValueInt64 && keyType_ != KeyValueDouble) return;
+	std::sort(keys.begin(), keys.end(), [](const KeyCount &lhs, const KeyCount &rhs) { return lhs.first < rhs.first; });
+	// Each bucket holds about the same count of entries, so the frequent keys get more precise bounds
+	const double bucketEntries = double(entries_) / kHistogramBuckets;
+	double nextBound = bucketEntries;
+	size_t cumulative = 0;
+	histogram_.reserve(kHistogramBuckets + 1);
+	for (size_t i = 0; i < keys.size(); ++i) {
+		cumulative += keys[i].second;
+		if (i == 0 || i + 1 == keys.size() || double(cumulative) >= nextBound) {
+			histogram_.emplace_back(keys[i].first.As<double>(), double(cumulative) / entries_);
+			while (nextBound <= double(cumulative)) nextBound += bucketEntries;
+		}
+	}
+}
+
+double IndexStats::Selectivity(CondType cond, const VariantArray &keys) const {
+	if (!rows_ || !entries_) return 0.0;
+	try {
+		VariantArray converted;
+		converted.reserve(keys.size());
+		for (const auto &key : keys) converted.emplace_back(key.convert(keyType_));
+
+		switch (cond) {
+			case CondAny:
+				return rowsPart(1.0);
+			case CondEq:
+			case CondSet: {
+				double part = 0.0;
+				for (const auto &key : converted) part += keyPart(key);
+				return rowsPart(part);
+			}
+			case CondLt:
+			case CondLe:
+			case CondGt:
+			case CondGe:
+			case CondRange: {
+				if (histogram_.empty() || converted.empty()) return -1.0;
+				const double first = converted[0].As<double>();
+				const auto lessOrEqual = [&](size_t i) { return partLessOrEqual(converted[i].As<double>()); };
+				const auto less = [&](size_t i) { return std::max(0.0, lessOrEqual(i) - keyPart(converted[i])); };
+				switch (cond) {
+					case CondLt:
+						return rowsPart(less(0));
+					case CondLe:
+						return rowsPart(lessOrEqual(0));
+					case CondGt:
+						return rowsPart(1.0 - lessOrEqual(0));
+					case CondGe:
+						return rowsPart(1.0 - less(0));
+					default:
+						if (converted.size() < 2 || converted[1].As<double>() < first) return 0.0;
+						return rowsPart(std::max(0.0, lessOrEqual(1) - less(0)));
+				}
+			}
+			default:
+				return -1.0;
+		}
+	} catch (const Error &) {
+		// Keys are not convertible to the index type, so the condition is checked by the generic comparator
+		return -1.0;
+	}
+}
+
+double IndexStats::keyPart(const Variant &key) const {
+	for (const auto &k : topKeys_) {
+		if (k.first == key) return double(k.second) / entries_;
+	}
+	// Rest of the keys are assumed to be uniformly distributed
+	const size_t restKeys = distinctKeys_ - topKeys_.size();
+	return restKeys ? double(entries_ - topEntries_) / restKeys / entries_ : 0.0;
+}
+
+double IndexStats::partLessOrEqual(double key) const {
+	if (key < histogram_.front().first) return 0.0;
+	if (key >= histogram_.back().first) return 1.0;
+	const auto it = std::upper_bound(histogram_.begin(), histogram_.end(), key,
+									 [](double k, const std::pair<double, double> &bound) { return k < bound.first; });
+	const auto &lower = *(it - 1);
+	// Keys are assumed to be uniformly distributed inside the bucket
+	return lower.second + (it->second - lower.second) * (key - lower.first) / (it->first - lower.first);
+}
+
+double IndexStats::rowsPart(double entriesPart) const noexcept {
+	return std::min(1.0, entriesPart * entries_ / rows_);
+}
+
+}  // namespace reindexer
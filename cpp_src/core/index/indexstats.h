@@ -0,0 +1,45 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "core/keyvalue/variant.h"
+#include "core/type_consts.h"
+
+namespace reindexer {
+
+/// Distribution of the index keys, which is collected by the namespace optimization. It is used to estimate, how many rows match
+/// the conditions, which are checked by comparators, so the most selective of them are checked first
+class IndexStats {
+public:
+	using KeyCount = std::pair<Variant, size_t>;
+	/// Count of the most frequent keys, which row counts are kept exactly
+	static constexpr size_t kTopKeysCount = 16;
+	/// Count of the equi-depth histogram buckets. Histogram is built for the numeric keys only
+	static constexpr size_t kHistogramBuckets = 64;
+
+	/// @param keys - keys of the index with count of their rows, in any order
+	/// @param rows - count of the rows in namespace
+	IndexStats(std::vector<KeyCount> &&keys, size_t rows);
+
+	size_t Rows() const noexcept { return rows_; }
+	size_t DistinctKeys() const noexcept { return distinctKeys_; }
+	/// @return estimated part of the namespace rows, which match the condition, or -1, if it can not be estimated
+	double Selectivity(CondType cond, const VariantArray &keys) const;
+
+private:
+	double keyPart(const Variant &key) const;
+	double partLessOrEqual(double key) const;
+	double rowsPart(double entriesPart) const noexcept;
+
+	size_t rows_ = 0;
+	// Count of the pairs of key and row. It is greater than rows_ for the array indexes
+	size_t entries_ = 0;
+	size_t distinctKeys_ = 0;
+	size_t topEntries_ = 0;
+	KeyValueType keyType_ = KeyValueUndefined;
+	std::vector<KeyCount> topKeys_;
+	// Upper bounds of the histogram buckets with the part of the entries, which keys are less or equal to the bound
+	std::vector<std::pair<double, double>> histogram_;
+};
+
+}  // namespace reindexer
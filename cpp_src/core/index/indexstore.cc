@@ -67,10 +67,7 @@ Variant IndexStore<PayloadValue>::Upsert(const Variant &key, IdType /*id*/, bool
 
 template <typename T>
 Variant IndexStore<T>::Upsert(const Variant &key, IdType id, bool & /*clearCache*/) {
-	if (!opts_.IsArray() && !opts_.IsDense() && !opts_.IsSparse() && key.Type() != KeyValueNull) {
-		idx_data.resize(std::max(id + 1, int(idx_data.size())));
-		idx_data[id] = static_cast<T>(key);
-	}
+	if (!opts_.IsArray() && (!opts_.IsDense() || opts_.IsColumnar()) && !opts_.IsSparse()) upsertColumn(key, id);
 	return Variant(key);
 }
 
@@ -24,9 +24,19 @@ public:
 	std::unique_ptr<Index> Clone() override;
 	IndexMemStat GetMemStat() override;
 	bool HoldsStrings() const noexcept override { return std::is_same_v<T, key_string>; }
+	ColumnView Column() const noexcept override { return {idx_data.size() ? idx_data.data() : nullptr, idx_data.size()}; }
 	void Dump(std::ostream &os, std::string_view step = "  ", std::string_view offset = "") const override;
 
 protected:
+	// Puts key to the rowId-indexed column. Column is used by comparators and aggregators instead of the payload access
+	void upsertColumn(const Variant &key, IdType id) {
+		if constexpr (std::is_arithmetic_v<T>) {
+			if (key.Type() == KeyValueNull) return;
+			if (size_t(id) >= idx_data.size()) idx_data.resize(id + 1);
+			idx_data[id] = static_cast<T>(key);
+		}
+	}
+
 	unordered_str_map<int> str_map;
 	h_vector<T> idx_data;
 
@@ -7,11 +7,14 @@
 #include "core/ft/filters/translit.h"
 #include "core/ft/ft_fast/selecter.h"
 #include "core/ft/numtotext.h"
+#include "sort/pdqsort.hpp"
 #include "tools/logger.h"
 
 namespace {
 // Available stemmers for languages
 const char *stemLangs[] = {"en", "ru", "nl", "fin", "de", "da", "fr", "it", "hu", "no", "pt", "ro", "es", "sv", "tr", nullptr};
+// Check of the cached results against the larger commit steps is more expensive, than the results recalculation
+constexpr size_t kMaxIncrementalInvalidationWords = 10000;
 }  // namespace
 
 namespace reindexer {
@@ -66,7 +69,7 @@ Variant FastIndexText<T>::Upsert(const Variant &key, IdType id, bool &clearCache
 	}
 	if (keyIt->second.Unsorted().Add(id, this->opts_.IsPK() ? IdSet::Ordered : IdSet::Auto, 0)) {
 		this->isBuilt_ = false;
-		if (this->cache_ft_) this->cache_ft_->Clear();
+		invalidateCache(keyIt->second.VDocID());
 		clearCache = true;
 	}
 	this->addMemStat(keyIt);
@@ -95,6 +98,7 @@ void FastIndexText<T>::Delete(const Variant &key, IdType id, StringsHolder &strH
 	this->delMemStat(keyIt);
 	delcnt = keyIt->second.Unsorted().Erase(id);
 	(void)delcnt;
+	invalidateCache(keyIt->second.VDocID());
 	// TODO: we have to implement removal of composite indexes (doesn't work right now)
 	assertf(this->opts_.IsArray() || this->Opts().IsSparse() || delcnt, "Delete unexists id from index '%s' id=%d,key=%s", this->name_, id,
 			key.As<string>());
@@ -118,7 +122,6 @@ void FastIndexText<T>::Delete(const Variant &key, IdType id, StringsHolder &strH
 	if (this->KeyType() == KeyValueString && this->opts_.GetCollateMode() != CollateNone) {
 		IndexStore<typename T::key_type>::Delete(key, id, strHolder, clearCache);
 	}
-	if (this->cache_ft_) this->cache_ft_->Clear();
 	clearCache = true;
 }
 
@@ -131,11 +134,12 @@ IndexMemStat FastIndexText<T>::GetMemStat() {
 }
 
 template <typename T>
-IdSet::Ptr FastIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery &dsl, bool inTransaction, const RdxContext &rdxCtx) {
+IdSet::Ptr FastIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery &dsl, bool inTransaction, unsigned topK, FtCacheDeps *cacheDeps,
+									const RdxContext &rdxCtx) {
 	fctx->GetData()->extraWordSymbols_ = this->GetConfig()->extraWordSymbols;
 	fctx->GetData()->isWordPositions_ = true;
 
-	auto mergeInfo = this->holder_->Select(dsl, this->fields_.size(), fctx->NeedArea(), inTransaction, rdxCtx);
+	auto mergeInfo = this->holder_->Select(dsl, this->fields_.size(), fctx->NeedArea(), topK, inTransaction, cacheDeps, rdxCtx);
 	// convert vids(uniq documents id) to ids (real ids)
 	IdSet::Ptr mergedIds = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>();
 	auto &holder = *this->holder_;
@@ -159,6 +163,7 @@ IdSet::Ptr FastIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery &dsl, bool inTra
 
 	mergedIds->reserve(cnt);
 	fctx->Reserve(cnt);
+	if (cacheDeps) cacheDeps->vdocs.reserve(mergeInfo.size());
 	for (auto &vid : mergeInfo) {
 		auto id = vid.id;
 		assertrx(id < IdType(vdocs.size()));
@@ -170,7 +175,9 @@ IdSet::Ptr FastIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery &dsl, bool inTra
 		if (vid.proc <= minRelevancy) break;
 		fctx->Add(vdocs[id].keyEntry->Sorted(0).begin(), vdocs[id].keyEntry->Sorted(0).end(), vid.proc, std::move(vid.holder));
 		mergedIds->Append(vdocs[id].keyEntry->Sorted(0).begin(), vdocs[id].keyEntry->Sorted(0).end(), IdSet::Unordered);
+		if (cacheDeps) cacheDeps->vdocs.push_back(id);
 	}
+	if (cacheDeps) boost::sort::pdqsort(cacheDeps->vdocs.begin(), cacheDeps->vdocs.end());
 	if (GetConfig()->logLevel >= LogInfo) {
 		logPrintf(LogInfo, "Total merge out: %d ids", mergedIds->size());
 
@@ -195,19 +202,31 @@ IdSet::Ptr FastIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery &dsl, bool inTra
 	return mergedIds;
 }
 template <typename T>
-void FastIndexText<T>::commitFulltextImpl() {
+bool FastIndexText<T>::commitFulltextImpl(const std::function<bool()> &isCanceled) {
 	this->holder_->StartCommit(this->tracker_.isCompleteUpdated());
 
 	auto tm0 = high_resolution_clock::now();
 
-	if (this->holder_->status_ == FullRebuild) {
+	// Only full rebuild may be canceled: incremental step modifies the previous steps' data and its size is limited by maxStepSize anyway
+	const auto status = this->holder_->status_;
+	const bool cancelable = status == FullRebuild;
+	if (cancelable) {
 		BuildVdocs(this->idx_map);
 	} else {
 		BuildVdocs(this->tracker_.updated());
 	}
 	auto tm1 = high_resolution_clock::now();
 
-	this->holder_->Process(this->fields_.size(), !this->opts_.IsDense());
+	if (!this->holder_->Process(this->fields_.size(), !this->opts_.IsDense(), cancelable ? isCanceled : [] { return false; })) {
+		// Partially built data is dropped and the index will be completely rebuilt on the next commit
+		this->holder_->Clear();
+		this->holder_->status_ = FullRebuild;
+		for (auto &idx : this->idx_map) idx.second.VDocID() = FtKeyEntryData::ndoc;
+		invalidateCache(FullRebuild, 0);
+		logPrintf(LogInfo, "FastIndexText::Commit of '%s' was canceled", this->name_);
+		return false;
+	}
+	invalidateCache(status, this->holder_->cur_vdoc_pos_);
 	if (this->holder_->NeedClear(this->tracker_.isCompleteUpdated())) {
 		this->tracker_.clear();
 	}
@@ -218,6 +237,46 @@ void FastIndexText<T>::commitFulltextImpl() {
 				  duration_cast<milliseconds>(tm2 - tm0).count(), duration_cast<milliseconds>(tm1 - tm0).count(),
 				  duration_cast<milliseconds>(tm2 - tm1).count());
 	}
+	return true;
+}
+
+template <typename T>
+void FastIndexText<T>::invalidateCache(int vdocId) {
+	if (!GetConfig()->incrementalCacheInvalidation) {
+		if (this->cache_ft_) this->cache_ft_->Clear();
+	} else if (vdocId != FtKeyEntryData::ndoc) {
+		// Documents, which were not committed yet, can not be found by the cached queries
+		updatedVdocs_.push_back(vdocId);
+	}
+}
+
+template <typename T>
+void FastIndexText<T>::invalidateCache(ProcessStatus status, size_t recommittedVdocsPos) {
+	const auto &words = this->holder_->stepWords_;
+	// Virtual documents' ids are reassigned on full rebuild, so the cached dependencies are not valid anymore
+	if (!this->cache_ft_ || !GetConfig()->incrementalCacheInvalidation || status == FullRebuild ||
+		words.size() > kMaxIncrementalInvalidationWords) {
+		this->cache_ft_.reset(new FtIdSetCache);
+	} else {
+		boost::sort::pdqsort(updatedVdocs_.begin(), updatedVdocs_.end());
+		updatedVdocs_.erase(std::unique(updatedVdocs_.begin(), updatedVdocs_.end()), updatedVdocs_.end());
+		std::vector<std::wstring> wordsUtf16;
+		wordsUtf16.reserve(words.size());
+		for (const auto &w : words) wordsUtf16.emplace_back(utf8_to_utf16(w));
+		this->cache_ft_->EraseIf([&](const IdSetCacheKey &, const FtIdSetCacheVal &val) {
+			if (!val.deps) return true;
+			const FtCacheDeps &deps = *val.deps;
+			// Documents of the recommitted step get new ids
+			if (status == RecommitLast && !deps.vdocs.empty() && deps.vdocs.back() >= recommittedVdocsPos) return true;
+			if (deps.HasAnyOf(updatedVdocs_)) return true;
+			for (size_t i = 0; i < words.size(); ++i) {
+				if (deps.MayMatch(words[i], wordsUtf16[i])) return true;
+			}
+			return false;
+		});
+	}
+	updatedVdocs_.clear();
+	this->holder_->stepWords_.clear();
 }
 
 template <typename T>
@@ -259,9 +318,9 @@ void FastIndexText<T>::BuildVdocs(Container &data) {
 
 #ifdef REINDEX_FT_EXTRA_DEBUG
 		string text(vdocsTexts.back()[0].first);
-		vdocs.push_back({(text.length() > 48) ? text.substr(0, 48) + "..." : text, doc->second.get(), {}, {}});
+		vdocs.push_back({(text.length() > 48) ? text.substr(0, 48) + "..." : text, doc->second.get(), {}, {}, {}});
 #else
-		vdocs.push_back({doc->second.get(), {}, {}});
+		vdocs.push_back({doc->second.get(), {}, {}, {}});
 #endif
 
 		if (GetConfig()->logLevel <= LogInfo) {
@@ -302,7 +361,8 @@ void FastIndexText<T>::SetOpts(const IndexOpts &opts) {
 
 	if (!eq_c(oldCfg.stopWords, newCfg.stopWords) || oldCfg.stemmers != newCfg.stemmers || oldCfg.maxTypoLen != newCfg.maxTypoLen ||
 		oldCfg.enableNumbersSearch != newCfg.enableNumbersSearch || oldCfg.extraWordSymbols != newCfg.extraWordSymbols ||
-		oldCfg.synonyms != newCfg.synonyms || oldCfg.maxTypos != newCfg.maxTypos || oldCfg.optimization != newCfg.optimization) {
+		oldCfg.synonyms != newCfg.synonyms || oldCfg.maxTypos != newCfg.maxTypos || oldCfg.optimization != newCfg.optimization ||
+		oldCfg.compactTypos != newCfg.compactTypos) {
 		logPrintf(LogInfo, "FulltextIndex config changed, it will be rebuilt on next search");
 		this->isBuilt_ = false;
 		if (oldCfg.optimization != newCfg.optimization) {
@@ -318,6 +378,7 @@ void FastIndexText<T>::SetOpts(const IndexOpts &opts) {
 		if (this->cache_ft_) this->cache_ft_->Clear();
 	}
 	this->holder_->synonyms_->SetConfig(&newCfg);
+	this->holder_->variantsCache_.Clear();
 }
 
 std::unique_ptr<Index> FastIndexText_New(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields) {
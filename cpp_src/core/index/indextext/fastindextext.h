@@ -23,14 +23,20 @@ public:
 		initConfig();
 	}
 	std::unique_ptr<Index> Clone() override;
-	IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, const RdxContext&) override final;
+	IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, unsigned topK, FtCacheDeps* cacheDeps,
+					  const RdxContext&) override final;
 	IndexMemStat GetMemStat() override;
 	Variant Upsert(const Variant& key, IdType id, bool& clearCache) override final;
 	void Delete(const Variant& key, IdType id, StringsHolder&, bool& clearCache) override final;
 	void SetOpts(const IndexOpts& opts) override final;
 
 protected:
-	void commitFulltextImpl() override final;
+	bool commitFulltextImpl(const std::function<bool()>& isCanceled) override final;
+	bool needCacheDeps() const noexcept override final { return GetConfig()->incrementalCacheInvalidation; }
+	// Drops cached results, if documents with the vdocId are updated
+	void invalidateCache(int vdocId);
+	// Drops cached results, which may be affected by the committed step
+	void invalidateCache(ProcessStatus status, size_t recommittedVdocsPos);
 	FtFastConfig* GetConfig() const;
 	void initConfig(const FtFastConfig* = nullptr);
 	void initHolder(FtFastConfig&);
@@ -38,6 +44,8 @@ protected:
 	template <class Data>
 	void BuildVdocs(Data& data);
 	std::unique_ptr<IDataHolder> holder_;
+	// Updated documents, which were committed before. Collected only for FtFastConfig::incrementalCacheInvalidation
+	std::vector<VDocIdType> updatedVdocs_;
 };
 
 std::unique_ptr<Index> FastIndexText_New(const IndexDef& idef, PayloadType payloadType, const FieldsSet& fields);
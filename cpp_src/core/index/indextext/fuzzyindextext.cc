@@ -15,7 +15,8 @@ std::unique_ptr<Index> FuzzyIndexText<T>::Clone() {
 }
 
 template <typename T>
-IdSet::Ptr FuzzyIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, const RdxContext& rdxCtx) {
+IdSet::Ptr FuzzyIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, unsigned /*topK*/, FtCacheDeps* /*cacheDeps*/,
+									 const RdxContext& rdxCtx) {
 	auto result = engine_.Search(dsl, inTransaction, rdxCtx);
 
 	auto mergedIds = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>();
@@ -41,23 +42,26 @@ IdSet::Ptr FuzzyIndexText<T>::Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTr
 }
 
 template <typename T>
-void FuzzyIndexText<T>::commitFulltextImpl() {
+bool FuzzyIndexText<T>::commitFulltextImpl(const std::function<bool()>& /*isCanceled*/) {
+	this->cache_ft_.reset(new FtIdSetCache);
 	vector<std::unique_ptr<string>> bufStrs;
+	vector<search_engine::SearchEngine::DocFields> docs;
+	docs.reserve(this->idx_map.size());
+	const IdType firstId = this->vdocs_.size();
 	auto gt = this->Getter();
 	for (auto& doc : this->idx_map) {
-		auto res = gt.getDocFields(doc.first, bufStrs);
+		docs.emplace_back(gt.getDocFields(doc.first, bufStrs));
 #ifdef REINDEX_FT_EXTRA_DEBUG
-		string text(res[0].first);
-		this->vdocs_.push_back({(text.length() > 48) ? text.substr(0, 48) + "..." : text, doc.second.get(), {}, {}});
+		string text(docs.back()[0].first);
+		this->vdocs_.push_back({(text.length() > 48) ? text.substr(0, 48) + "..." : text, doc.second.get(), {}, {}, {}});
 #else
-		this->vdocs_.push_back({doc.second.get(), {}, {}});
+		this->vdocs_.push_back({doc.second.get(), {}, {}, {}});
 #endif
-		for (auto& r : res) {
-			engine_.AddData(r.first, this->vdocs_.size() - 1, r.second, this->cfg_->extraWordSymbols);
-		}
 	}
-	engine_.Commit();
+	engine_.AddData(docs, firstId, this->cfg_->extraWordSymbols, GetConfig()->buildWorkers);
+	engine_.Commit(GetConfig()->buildWorkers);
 	this->isBuilt_ = true;
+	return true;
 }
 template <typename T>
 FtFuzzyConfig* FuzzyIndexText<T>::GetConfig() const {
@@ -19,7 +19,8 @@ public:
 	}
 
 	std::unique_ptr<Index> Clone() override;
-	IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, const RdxContext&) override final;
+	IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, unsigned topK, FtCacheDeps* cacheDeps,
+					  const RdxContext&) override final;
 	Variant Upsert(const Variant& key, IdType id, bool& clearCache) override final {
 		this->isBuilt_ = false;
 		return IndexText<T>::Upsert(key, id, clearCache);
@@ -30,7 +31,7 @@ public:
 	}
 
 protected:
-	void commitFulltextImpl() override final;
+	bool commitFulltextImpl(const std::function<bool()>& isCanceled) override final;
 	FtFuzzyConfig* GetConfig() const;
 	void CreateConfig(const FtFuzzyConfig* cfg = nullptr);
 
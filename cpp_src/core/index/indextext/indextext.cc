@@ -73,8 +73,14 @@ SelectKeyResults IndexText<T>::SelectKey(const VariantArray &keys, CondType cond
 		}
 	}
 
+	// STEP 1: Parse search query dsl. Cache key is built from the parsed query, so the equivalent queries share the cached results
+	FtDSLQuery dsl(this->ftFields_, this->cfg_->stopWords, this->cfg_->extraWordSymbols);
+	dsl.parse(keys[0].As<string>());
+	const VariantArray normalizedKeys{Variant(dsl.Normalized())};
+
 	bool need_put = false;
-	IdSetCacheKey ckey{keys, condition, 0};
+	// Sort type is not used by fulltext index, so it's replaced by top size: results with different tops are cached separately
+	IdSetCacheKey ckey{normalizedKeys, condition, opts.ftTopK};
 	SelectKeyResult res;
 	auto cache_ft = cache_ft_->Get(ckey);
 	if (cache_ft.valid) {
@@ -98,11 +104,9 @@ SelectKeyResults IndexText<T>::SelectKey(const VariantArray &keys, CondType cond
 				  need_put ? "(will cache)" : "");
 	}
 
-	// STEP 1: Parse search query dsl
-	FtDSLQuery dsl(this->ftFields_, this->cfg_->stopWords, this->cfg_->extraWordSymbols);
-	dsl.parse(keys[0].As<string>());
-
-	auto mergedIds = Select(ftctx, dsl, opts.inTransaction, rdxCtx);
+	FtCacheDeps cacheDeps;
+	const bool withCacheDeps = need_put && needCacheDeps();
+	auto mergedIds = Select(ftctx, dsl, opts.inTransaction, opts.ftTopK, withCacheDeps ? &cacheDeps : nullptr, rdxCtx);
 	if (mergedIds) {
 		if (need_put && mergedIds->size()) {
 			// This areas will be shared via cache, so lazy commit may race
@@ -112,7 +116,9 @@ SelectKeyResults IndexText<T>::SelectKey(const VariantArray &keys, CondType cond
 					area.second->Commit();
 				}
 			}
-			cache_ft_->Put(ckey, FtIdSetCacheVal{mergedIds, std::move(d)});
+			MemAccountingScope cacheMemScope(MemAccount::Untracked);
+			cache_ft_->Put(ckey, FtIdSetCacheVal{mergedIds, std::move(d),
+												 withCacheDeps ? std::make_shared<const FtCacheDeps>(std::move(cacheDeps)) : nullptr});
 		}
 
 		res.push_back(SingleSelectKeyResult(mergedIds));
@@ -120,6 +126,18 @@ SelectKeyResults IndexText<T>::SelectKey(const VariantArray &keys, CondType cond
 	return SelectKeyResults(std::move(res));
 }
 
+template <typename T>
+void IndexText<T>::CommitFulltextBackground(const std::function<bool()> &isCanceled) {
+	// Background routine holds namespace's read lock, so the keys can not be modified concurrently. Selects, which arrive during
+	// the commit, wait for it on the index lock instead of rebuilding the index by themselves
+	std::lock_guard<Mutex> lck(mtx_);
+	if (this->isBuilt_ || isCanceled()) return;
+	MemAccountingScope ftMemScope(MemAccount::Fulltext);
+	if (commitFulltextImpl(isCanceled)) {
+		this->isBuilt_ = true;
+	}
+}
+
 template <typename T>
 FieldsGetter IndexText<T>::Getter() {
 	return FieldsGetter(this->fields_, this->payloadType_, this->KeyType());
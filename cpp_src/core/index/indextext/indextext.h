@@ -29,21 +29,28 @@ public:
 	SelectKeyResults SelectKey(const VariantArray& keys, CondType condition, SortType stype, Index::SelectOpts opts,
 							   BaseFunctionCtx::Ptr ctx, const RdxContext&) override final;
 	void UpdateSortedIds(const UpdateSortedContext&) override {}
-	virtual IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, const RdxContext&) = 0;
+	void AddUpdateSortedIdsTasks(const UpdateSortedContext&, WorkStealingScheduler&) override {}
+	void AddUpdateSortedIdsDeltaTasks(const UpdateSortedContext&, WorkStealingScheduler&) override {}
+	// @param cacheDeps - if not null, it has to be filled by the data, which the result depends on. Otherwise the result will be dropped
+	// from cache on any index update
+	virtual IdSet::Ptr Select(FtCtx::Ptr fctx, FtDSLQuery& dsl, bool inTransaction, unsigned topK, FtCacheDeps* cacheDeps,
+							  const RdxContext&) = 0;
 	void SetOpts(const IndexOpts& opts) override;
 	void Commit() override final {
 		// Do nothing
 		// Rebuild will be done on first select
 	}
 	void CommitFulltext() override final {
-		cache_ft_.reset(new FtIdSetCache);
-		commitFulltextImpl();
+		MemAccountingScope ftMemScope(MemAccount::Fulltext);
+		commitFulltextImpl([] { return false; });
 		this->isBuilt_ = true;
 	}
+	void CommitFulltextBackground(const std::function<bool()>& isCanceled) override final;
 	void SetSortedIdxCount(int) override final {}
 	bool RequireWarmupOnNsCopy() const noexcept override final { return cfg_ && cfg_->enableWarmupOnNsCopy; }
 	void ClearCache() override {
 		Base::ClearCache();
+		MemAccountingScope cacheMemScope(MemAccount::Untracked);
 		cache_ft_.reset();
 	}
 	void MarkBuilt() noexcept override { assertrx(0); }
@@ -52,7 +59,11 @@ public:
 protected:
 	using Mutex = MarkedMutex<shared_timed_mutex, MutexMark::IndexText>;
 
-	virtual void commitFulltextImpl() = 0;
+	/// Builds the index and invalidates results cache
+	/// @return false, if commit was canceled. In this case index remains unbuilt
+	virtual bool commitFulltextImpl(const std::function<bool()>& isCanceled) = 0;
+	/// @return true, if the results have to be cached with their dependencies for the incremental invalidation
+	virtual bool needCacheDeps() const noexcept { return false; }
 
 	void initSearchers();
 	FieldsGetter Getter();
@@ -1,4 +1,5 @@
 #include "indexunordered.h"
+#include "core/index/indexstats.h"
 #include "core/index/indextext/ftkeyentry.h"
 #include "core/index/payload_map.h"
 #include "core/index/string_map.h"
@@ -11,10 +12,23 @@
 #include "rtree/rtree.h"
 #include "tools/errors.h"
 #include "tools/logger.h"
+#include "tools/string_regexp_functions.h"
+#include "tools/workstealingscheduler.h"
 
 namespace reindexer {
 
 constexpr int kMaxIdsForDistinct = 500;
+// Minimum count of the found keys, whose idsets are merged into the single set before the select. Otherwise select iterator looks for
+// the next id through the all sets of the keys
+constexpr size_t kMinKeysForMergedIdset = 64;
+constexpr size_t kUpdateSortedIdsChunkSize = 32 * 1024;
+constexpr size_t kMinBloomFilterKeys = 1024;
+
+// Bloom filter is supported by the hash maps only
+template <typename T, typename = void>
+constexpr bool kHasHashFunction = false;
+template <typename T>
+constexpr bool kHasHashFunction<T, std::void_t<decltype(std::declval<const T &>().hash_function())>> = true;
 
 template <typename T>
 IndexUnordered<T>::IndexUnordered(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields)
@@ -39,6 +53,16 @@ IndexUnordered<unordered_str_map<Index::KeyEntryPlain>>::IndexUnordered(const In
 																		const FieldsSet &fields)
 	: Base(idef, std::move(payloadType), fields), idx_map(idef.opts_.collateOpts_) {}
 
+template <>
+IndexUnordered<flat_unordered_str_map<Index::KeyEntry>>::IndexUnordered(const IndexDef &idef, PayloadType payloadType,
+																		 const FieldsSet &fields)
+	: Base(idef, std::move(payloadType), fields), idx_map(idef.opts_.collateOpts_) {}
+
+template <>
+IndexUnordered<flat_unordered_str_map<Index::KeyEntryPlain>>::IndexUnordered(const IndexDef &idef, PayloadType payloadType,
+																			  const FieldsSet &fields)
+	: Base(idef, std::move(payloadType), fields), idx_map(idef.opts_.collateOpts_) {}
+
 template <>
 IndexUnordered<unordered_str_map<FtKeyEntry>>::IndexUnordered(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields)
 	: Base(idef, std::move(payloadType), fields), idx_map(idef.opts_.collateOpts_) {}
@@ -77,7 +101,16 @@ bool IndexUnordered<T>::HoldsStrings() const noexcept {
 
 template <typename T>
 IndexUnordered<T>::IndexUnordered(const IndexUnordered &other)
-	: Base(other), idx_map(other.idx_map), cache_(nullptr), empty_ids_(other.empty_ids_), tracker_(other.tracker_) {}
+	: Base(other),
+	  idx_map(other.idx_map),
+	  cache_(nullptr),
+	  empty_ids_(other.empty_ids_),
+	  tracker_(other.tracker_),
+	  sortUpdates_(other.sortUpdates_),
+	  emptyIdsSortUpdated_(other.emptyIdsSortUpdated_),
+	  bloom_(other.bloom_),
+	  bloomKeys_(other.bloomKeys_),
+	  trigrams_(other.trigrams_) {}
 
 template <typename key_type>
 size_t heap_size(const key_type & /*kt*/) {
@@ -89,6 +122,11 @@ size_t heap_size<key_string>(const key_string &kt) {
 	return kt->heap_size() + sizeof(*kt.get());
 }
 
+template <>
+size_t heap_size<collated_key_string>(const collated_key_string &kt) {
+	return heap_size<key_string>(kt) + (kt.SortKey() ? heap_size<key_string>(kt.SortKey()) : 0);
+}
+
 struct DeepClean {
 	template <typename T>
 	void operator()(T &v) const {
@@ -123,7 +161,8 @@ Variant IndexUnordered<T>::Upsert(const Variant &key, IdType id, bool &clearCach
 	// reset cache
 	if (key.Type() == KeyValueNull) {
 		if (this->empty_ids_.Unsorted().Add(id, IdSet::Auto, this->sortedIdxCount_)) {
-			if (cache_) cache_.reset();
+			this->emptyIdsSortUpdated_ = true;
+			resetCache();
 			clearCache = true;
 			this->isBuilt_ = false;
 		}
@@ -134,18 +173,24 @@ Variant IndexUnordered<T>::Upsert(const Variant &key, IdType id, bool &clearCach
 	typename T::iterator keyIt = this->idx_map.find(static_cast<ref_type>(key));
 	if (keyIt == this->idx_map.end()) {
 		keyIt = this->idx_map.insert({static_cast<typename T::key_type>(key), typename T::mapped_type()}).first;
+		if (this->opts_.IsBloomFilter()) addToBloomFilter(keyIt->first);
+		if constexpr (is_str_map_v<T>) {
+			if (this->opts_.IsTrigram()) trigrams_.Add(keyIt->first);
+		}
 	} else {
 		delMemStat(keyIt);
 	}
 
 	if (keyIt->second.Unsorted().Add(id, this->opts_.IsPK() ? IdSet::Ordered : IdSet::Auto, this->sortedIdxCount_)) {
-		if (cache_) cache_.reset();
+		resetCache();
 		clearCache = true;
 		this->isBuilt_ = false;
+		this->sortUpdates_.markUpdated(this->idx_map, keyIt, false);
 	}
 	this->tracker_.markUpdated(this->idx_map, keyIt);
 
 	addMemStat(keyIt);
+	if (this->opts_.IsColumnar()) this->upsertColumn(key, id);
 
 	if (this->KeyType() == KeyValueString && this->opts_.GetCollateMode() != CollateNone) {
 		return Base::Upsert(key, id, clearCache);
@@ -154,14 +199,77 @@ Variant IndexUnordered<T>::Upsert(const Variant &key, IdType id, bool &clearCach
 	return Variant(keyIt->first);
 }
 
+template <typename T>
+void IndexUnordered<T>::Update(VariantArray &keys, const VariantArray &newKeys, IdType id, StringsHolder &strHolder, bool &clearCache) {
+	const KeyValueType keyType = this->KeyType();
+	if (!this->opts_.IsArray() || keys.empty() || newKeys.empty() ||
+		(keyType != KeyValueInt && keyType != KeyValueInt64 && keyType != KeyValueDouble && keyType != KeyValueBool)) {
+		Index::Update(keys, newKeys, id, strHolder, clearCache);
+		return;
+	}
+	// Numeric keys are stored in the payload by value, so array update touches only the keys, which are not in both of the arrays
+	const auto less = [](const Variant *l, const Variant *r) { return l->Compare(*r) < 0; };
+	h_vector<const Variant *, 64> oldSorted, newSorted, changed;
+	for (const auto &k : keys) oldSorted.push_back(&k);
+	for (const auto &k : newKeys) newSorted.push_back(&k);
+	std::sort(oldSorted.begin(), oldSorted.end(), less);
+	std::sort(newSorted.begin(), newSorted.end(), less);
+	std::set_difference(oldSorted.begin(), oldSorted.end(), newSorted.begin(), newSorted.end(), std::back_inserter(changed), less);
+	for (const Variant *k : changed) Delete(*k, id, strHolder, clearCache);
+	changed.clear();
+	std::set_difference(newSorted.begin(), newSorted.end(), oldSorted.begin(), oldSorted.end(), std::back_inserter(changed), less);
+	for (const Variant *k : changed) Upsert(*k, id, clearCache);
+	keys = newKeys;
+}
+
 template <typename T>
 void IndexUnordered<T>::Delete(const Variant &key, IdType id, StringsHolder &strHolder, bool &clearCache) {
+	deleteIds(key, span<IdType>(&id, 1), strHolder, clearCache);
+}
+
+template <typename T>
+void IndexUnordered<T>::BulkDelete(span<VariantArray> keys, span<IdType> ids, StringsHolder &strHolder, bool &clearCache) {
+	assertrx(keys.size() == ids.size());
+	// Fulltext indexes delete their keys by their own overrides
+	if (this->IsFulltext()) {
+		Base::BulkDelete(keys, ids, strHolder, clearCache);
+		return;
+	}
+	// Ids are grouped by the keys, so each key is looked up and its idset is updated once
+	static const Variant kNullKey;
+	std::vector<std::pair<const Variant *, IdType>> entries;
+	entries.reserve(ids.size());
+	for (size_t i = 0; i < ids.size(); ++i) {
+		if (keys[i].empty()) {
+			entries.emplace_back(&kNullKey, ids[i]);
+		} else {
+			for (const Variant &key : keys[i]) entries.emplace_back(&key, ids[i]);
+		}
+	}
+	const auto less = [](const Variant &l, const Variant &r) {
+		if (l.Type() != r.Type()) return l.Type() < r.Type();
+		return l.Type() != KeyValueNull && l.Compare(r) < 0;
+	};
+	// Ids of each key stay in ascending order
+	std::stable_sort(entries.begin(), entries.end(), [&less](const auto &l, const auto &r) { return less(*l.first, *r.first); });
+	std::vector<IdType> keyIds;
+	for (auto it = entries.begin(); it != entries.end();) {
+		const Variant &key = *it->first;
+		keyIds.clear();
+		for (; it != entries.end() && !less(key, *it->first); ++it) keyIds.push_back(it->second);
+		deleteIds(key, keyIds, strHolder, clearCache);
+	}
+}
+
+template <typename T>
+void IndexUnordered<T>::deleteIds(const Variant &key, span<IdType> ids, StringsHolder &strHolder, bool &clearCache) {
 	int delcnt = 0;
 	if (key.Type() == KeyValueNull) {
-		delcnt = this->empty_ids_.Unsorted().Erase(id);
+		delcnt = this->empty_ids_.Unsorted().Erase(ids);
 		assertrx(delcnt);
 		this->isBuilt_ = false;
-		if (cache_) cache_.reset();
+		this->emptyIdsSortUpdated_ = true;
+		resetCache();
 		clearCache = true;
 		return;
 	}
@@ -170,18 +278,21 @@ void IndexUnordered<T>::Delete(const Variant &key, IdType id, StringsHolder &str
 	if (keyIt == idx_map.end()) return;
 
 	delMemStat(keyIt);
-	delcnt = keyIt->second.Unsorted().Erase(id);
+	delcnt = keyIt->second.Unsorted().Erase(ids);
 	(void)delcnt;
 	this->isBuilt_ = false;
-	if (cache_) cache_.reset();
+	resetCache();
 	clearCache = true;
 	// TODO: we have to implement removal of composite indexes (doesn't work right now)
-	assertf(this->opts_.IsArray() || this->Opts().IsSparse() || delcnt, "Delete unexists id from index '%s' id=%d,key=%s (%s)", this->name_,
-			id, key.As<string>(this->payloadType_, this->fields_), Variant(keyIt->first).As<string>(this->payloadType_, this->fields_));
+	assertf(this->opts_.IsArray() || this->Opts().IsSparse() || delcnt == int(ids.size()),
+			"Delete unexists id from index '%s' id=%d,key=%s (%s)", this->name_, ids[0], key.As<string>(this->payloadType_, this->fields_),
+			Variant(keyIt->first).As<string>(this->payloadType_, this->fields_));
 
 	if (keyIt->second.Unsorted().IsEmpty()) {
 		this->tracker_.markDeleted(keyIt);
+		this->sortUpdates_.markDeleted(keyIt);
 		if constexpr (is_str_map_v<T>) {
+			if (this->opts_.IsTrigram()) trigrams_.Remove(std::string_view(*keyIt->first));
 			idx_map.template erase<StringMapEntryCleaner<true>>(
 				keyIt, {strHolder, this->KeyType() == KeyValueString && this->opts_.GetCollateMode() == CollateNone});
 		} else if constexpr (is_payload_map_v<T>) {
@@ -189,13 +300,89 @@ void IndexUnordered<T>::Delete(const Variant &key, IdType id, StringsHolder &str
 		} else {
 			idx_map.template erase<DeepClean>(keyIt);
 		}
+		// Removed keys can not be cleared from filter, so it is rebuilt, when they are the most of the filter keys
+		if (this->opts_.IsBloomFilter() && bloomKeys_ > 2 * idx_map.size() + kMinBloomFilterKeys) rebuildBloomFilter();
 	} else {
 		addMemStat(keyIt);
 		this->tracker_.markUpdated(this->idx_map, keyIt);
+		this->sortUpdates_.markUpdated(this->idx_map, keyIt, false);
 	}
 
 	if (this->KeyType() == KeyValueString && this->opts_.GetCollateMode() != CollateNone) {
-		Base::Delete(key, id, strHolder, clearCache);
+		for (IdType id : ids) Base::Delete(key, id, strHolder, clearCache);
+	}
+}
+
+template <typename T>
+bool IndexUnordered<T>::bloomMayContain(const Variant &key) const {
+	if constexpr (kHasHashFunction<T>) {
+		if (this->opts_.IsBloomFilter()) return bloom_.MayContain(idx_map.hash_function()(static_cast<ref_type>(key)));
+	}
+	(void)key;
+	return true;
+}
+
+template <typename T>
+void IndexUnordered<T>::addToBloomFilter(const typename T::key_type &key) {
+	if constexpr (kHasHashFunction<T>) {
+		if (bloomKeys_ >= bloom_.Capacity()) {
+			// Filter is reallocated with the free space for the new keys
+			rebuildBloomFilter();
+		} else {
+			bloom_.Add(idx_map.hash_function()(key));
+			++bloomKeys_;
+		}
+	}
+	(void)key;
+}
+
+template <typename T>
+void IndexUnordered<T>::rebuildBloomFilter() {
+	if constexpr (kHasHashFunction<T>) {
+		bloom_.Reset(std::max(kMinBloomFilterKeys, 2 * idx_map.size()));
+		for (const auto &keyIt : idx_map) bloom_.Add(idx_map.hash_function()(keyIt.first));
+		bloomKeys_ = idx_map.size();
+	}
+}
+
+template <typename T>
+bool IndexUnordered<T>::selectLikeByTrigrams(const VariantArray &keys, SortType sortId, const Index::SelectOpts &opts,
+											 SelectKeyResult &res) const {
+	if constexpr (is_str_map_v<T>) {
+		if (!this->opts_.IsTrigram() || keys.size() != 1 || keys[0].Type() != KeyValueString) return false;
+		const std::string_view pattern(keys[0]);
+		size_t idsCount = 0;
+		const bool narrowed = trigrams_.ForEachCandidate(pattern, [&](std::string_view key) {
+			if (!matchLikePattern(key, pattern)) return;
+			const auto keyIt = idx_map.find(key);
+			if (keyIt == idx_map.end()) return;
+			res.emplace_back(keyIt->second, sortId);
+			idsCount += keyIt->second.Unsorted().Size();
+		});
+		if (!narrowed) return false;
+		// Merge of the many large idsets is more expensive, than the check of the condition by comparator
+		if (!opts.distinct && opts.itemsCountInNamespace && res.size() > 1u &&
+			((int(idsCount * 2) > opts.maxIterations) ||
+			 (100u * idsCount / opts.itemsCountInNamespace > maxSelectivityPercentForIdset()))) {
+			res.clear();
+			return false;
+		}
+		return true;
+	}
+	(void)keys;
+	(void)sortId;
+	(void)opts;
+	(void)res;
+	return false;
+}
+
+template <typename T>
+void IndexUnordered<T>::SetOpts(const IndexOpts &opts) {
+	Base::SetOpts(opts);
+	// Keys are not added to filter without the option, so it is built from scratch, if the option is enabled again
+	if (!opts.IsBloomFilter()) {
+		bloom_ = BloomFilter();
+		bloomKeys_ = 0;
 	}
 }
 
@@ -213,7 +400,10 @@ bool IndexUnordered<T>::tryIdsetCache(const VariantArray &keys, CondType conditi
 	if (cached.valid) {
 		if (!cached.val.ids) {
 			scanWin = selector(res);
-			if (!scanWin) cache_->Put(ckey, res.mergeIdsets());
+			if (!scanWin) {
+				MemAccountingScope cacheMemScope(MemAccount::Untracked);
+				cache_->Put(ckey, res.mergeIdsets());
+			}
 		} else {
 			res.push_back(SingleSelectKeyResult(cached.val.ids));
 		}
@@ -243,18 +433,22 @@ SelectKeyResults IndexUnordered<T>::SelectKey(const VariantArray &keys, CondType
 			if (condition == CondEq && keys.size() < 1) {
 				throw Error(errParams, "For condition required at least 1 argument, but provided 0");
 			}
+			// Absent key (e.g. the primary key of the new item) is not searched in the map
+			if (keys.size() == 1 && !bloomMayContain(keys[0])) break;
 			{
 				struct {
 					T *i_map;
+					const IndexUnordered<T> *index;
 					const VariantArray &keys;
 					SortType sortId;
 					Index::SelectOpts opts;
-				} ctx = {&this->idx_map, keys, sortId, opts};
+				} ctx = {&this->idx_map, this, keys, sortId, opts};
 				// should return true, if fallback to comparator required
 				auto selector = [&ctx](SelectKeyResult &res) -> bool {
 					size_t idsCount = 0;
 					res.reserve(ctx.keys.size());
 					for (auto key : ctx.keys) {
+						if (!ctx.index->bloomMayContain(key)) continue;
 						auto keyIt = ctx.i_map->find(static_cast<ref_type>(key));
 						if (keyIt != ctx.i_map->end()) {
 							res.emplace_back(keyIt->second, ctx.sortId);
@@ -282,6 +476,8 @@ SelectKeyResults IndexUnordered<T>::SelectKey(const VariantArray &keys, CondType
 					// fallback to comparator, due to expensive idset
 					return Base::SelectKey(keys, condition, sortId, opts, funcCtx, rdxCtx);
 				}
+				// Distinct select excludes the whole idset of the key after the first found item, so the sets are kept separate
+				if (!opts.distinct && res.size() >= kMinKeysForMergedIdset) res.mergeIdsets();
 			}
 			break;
 		case CondAllSet: {
@@ -314,8 +510,10 @@ SelectKeyResults IndexUnordered<T>::SelectKey(const VariantArray &keys, CondType
 		case CondRange:
 		case CondGt:
 		case CondLt:
-		case CondLike:
 			return Base::SelectKey(keys, condition, sortId, opts, funcCtx, rdxCtx);
+		case CondLike:
+			if (!selectLikeByTrigrams(keys, sortId, opts, res)) return Base::SelectKey(keys, condition, sortId, opts, funcCtx, rdxCtx);
+			break;
 		default:
 			throw Error(errQueryExec, "Unknown query on index '%s'", this->name_);
 	}
@@ -357,6 +555,52 @@ void IndexUnordered<T>::UpdateSortedIds(const UpdateSortedContext &ctx) {
 	this->empty_ids_.UpdateSortedIds(ctx);
 }
 
+template <typename T>
+void IndexUnordered<T>::AddUpdateSortedIdsTasks(const UpdateSortedContext &ctx, WorkStealingScheduler &scheduler) {
+	// Keys are splitted into the chunks of approximately kUpdateSortedIdsChunkSize ids (each key is also counted as one id,
+	// because it requires allocation), so huge index is processed by all the workers
+	auto begin = this->idx_map.begin();
+	size_t chunkSize = 0;
+	for (auto it = begin; it != this->idx_map.end();) {
+		chunkSize += it->second.Unsorted().size() + 1;
+		++it;
+		if (chunkSize >= kUpdateSortedIdsChunkSize && it != this->idx_map.end()) {
+			scheduler.Add([&ctx, begin, it] {
+				for (auto keyIt = begin; keyIt != it; ++keyIt) keyIt->second.UpdateSortedIds(ctx);
+			});
+			begin = it;
+			chunkSize = 0;
+		}
+	}
+	scheduler.Add([this, &ctx, begin] {
+		for (auto keyIt = begin; keyIt != this->idx_map.end(); ++keyIt) keyIt->second.UpdateSortedIds(ctx);
+		this->empty_ids_.UpdateSortedIds(ctx);
+	});
+}
+
+template <typename T>
+void IndexUnordered<T>::AddUpdateSortedIdsDeltaTasks(const UpdateSortedContext &ctx, WorkStealingScheduler &scheduler) {
+	if (sortUpdates_.isCompleteUpdated()) return AddUpdateSortedIdsTasks(ctx, scheduler);
+	logPrintf(LogTrace, "IndexUnordered::AddUpdateSortedIdsDeltaTasks (%s) %d updated keys, empty ids %s", this->name_,
+			  sortUpdates_.updated().size(), emptyIdsSortUpdated_ ? "updated" : "not updated");
+	if (sortUpdates_.updated().empty() && !emptyIdsSortUpdated_) return;
+	scheduler.Add([this, &ctx] {
+		for (const auto &key : sortUpdates_.updated()) {
+			auto keyIt = this->idx_map.find(key);
+			assertrx(keyIt != this->idx_map.end());
+			keyIt->second.UpdateSortedIds(ctx);
+		}
+		if (emptyIdsSortUpdated_) this->empty_ids_.UpdateSortedIds(ctx);
+	});
+}
+
+template <typename T>
+void IndexUnordered<T>::MarkBuilt() noexcept {
+	sortUpdates_.clear();
+	emptyIdsSortUpdated_ = false;
+	Base::MarkBuilt();
+}
+
 template <typename T>
 std::unique_ptr<Index> IndexUnordered<T>::Clone() {
 	return std::unique_ptr<Index>{new IndexUnordered<T>(*this)};
@@ -370,6 +614,38 @@ void IndexUnordered<T>::SetSortedIdxCount(int sortedIdxCount) {
 	}
 }
 
+template <typename T>
+void IndexUnordered<T>::UpdateStats(size_t itemsCount) {
+	using KeyT = typename T::key_type;
+	if constexpr (std::is_same_v<KeyT, int> || std::is_same_v<KeyT, int64_t> || std::is_same_v<KeyT, double> ||
+				  std::is_same_v<KeyT, key_string>) {
+		if (IsFullText(this->Type()) || this->opts_.GetCollateMode() != CollateNone) return;
+		std::vector<IndexStats::KeyCount> keys;
+		keys.reserve(idx_map.size());
+		for (auto &keyIt : idx_map) keys.emplace_back(Variant(keyIt.first), keyIt.second.Unsorted().Size());
+		std::atomic_store(&this->stats_, std::shared_ptr<const IndexStats>(std::make_shared<IndexStats>(std::move(keys), itemsCount)));
+	} else {
+		(void)itemsCount;
+	}
+}
+
+template <typename T>
+bool IndexUnordered<T>::ForEachKey(const std::function<void(const Variant &key, size_t count)> &fn) const {
+	using KeyT = typename T::key_type;
+	if constexpr (std::is_same_v<KeyT, int> || std::is_same_v<KeyT, int64_t> || std::is_same_v<KeyT, double> ||
+				  std::is_same_v<KeyT, key_string>) {
+		if (IsFullText(this->Type())) return false;
+		for (auto &keyIt : idx_map) {
+			const size_t count = keyIt.second.Unsorted().Size();
+			if (count) fn(Variant(keyIt.first), count);
+		}
+		return true;
+	} else {
+		(void)fn;
+		return false;
+	}
+}
+
 template <typename T>
 IndexMemStat IndexUnordered<T>::GetMemStat() {
 	IndexMemStat ret = Base::GetMemStat();
@@ -377,6 +653,7 @@ IndexMemStat IndexUnordered<T>::GetMemStat() {
 	if (cache_) ret.idsetCache = cache_->GetMemStat();
 	ret.trackedUpdatesCount = tracker_.updatesSize();
 	ret.trackedUpdatesBuckets = tracker_.updatesBuckets();
+	ret.trigramSize = trigrams_.HeapSize();
 	return ret;
 }
 
@@ -417,6 +694,20 @@ void IndexUnordered<T>::Dump(std::ostream &os, std::string_view step, std::strin
 
 template <typename KeyEntryT>
 static std::unique_ptr<Index> IndexUnordered_New(const IndexDef &idef, PayloadType payloadType, const FieldsSet &fields) {
+	if (idef.opts_.IsFlatHash()) {
+		switch (idef.Type()) {
+			case IndexIntHash:
+				return std::unique_ptr<Index>{
+					new IndexUnordered<flat_unordered_number_map<int, KeyEntryT>>(idef, std::move(payloadType), fields)};
+			case IndexInt64Hash:
+				return std::unique_ptr<Index>{
+					new IndexUnordered<flat_unordered_number_map<int64_t, KeyEntryT>>(idef, std::move(payloadType), fields)};
+			case IndexStrHash:
+				return std::unique_ptr<Index>{new IndexUnordered<flat_unordered_str_map<KeyEntryT>>(idef, std::move(payloadType), fields)};
+			default:
+				break;
+		}
+	}
 	switch (idef.Type()) {
 		case IndexIntHash:
 			return std::unique_ptr<Index>{new IndexUnordered<unordered_number_map<int, KeyEntryT>>(idef, std::move(payloadType), fields)};
@@ -3,8 +3,11 @@
 #include <functional>
 #include <type_traits>
 #include "core/idsetcache.h"
+#include "core/index/bloomfilter.h"
 #include "core/index/indexstore.h"
+#include "core/index/trigramindex.h"
 #include "core/index/updatetracker.h"
+#include "core/memaccounting.h"
 #include "estl/atomic_unique_ptr.h"
 
 namespace reindexer {
@@ -22,27 +25,51 @@ public:
 
 	Variant Upsert(const Variant &key, IdType id, bool &chearCache) override;
 	void Delete(const Variant &key, IdType id, StringsHolder &, bool &chearCache) override;
+	void BulkDelete(span<VariantArray> keys, span<IdType> ids, StringsHolder &, bool &clearCache) override;
+	void Update(VariantArray &keys, const VariantArray &newKeys, IdType id, StringsHolder &, bool &clearCache) override;
 	SelectKeyResults SelectKey(const VariantArray &keys, CondType cond, SortType stype, Index::SelectOpts opts, BaseFunctionCtx::Ptr ctx,
 							   const RdxContext &) override;
 	void Commit() override;
 	void UpdateSortedIds(const UpdateSortedContext &) override;
+	void AddUpdateSortedIdsTasks(const UpdateSortedContext &, WorkStealingScheduler &) override;
+	void AddUpdateSortedIdsDeltaTasks(const UpdateSortedContext &, WorkStealingScheduler &) override;
+	void MarkBuilt() noexcept override;
 	std::unique_ptr<Index> Clone() override;
 	IndexMemStat GetMemStat() override;
 	size_t Size() const override final { return idx_map.size(); }
 	void SetSortedIdxCount(int sortedIdxCount) override;
 	bool HoldsStrings() const noexcept override;
-	void ClearCache() override { cache_.reset(); }
+	void ClearCache() override { resetCache(); }
 	void ClearCache(const std::bitset<64> &s) override {
 		if (cache_) cache_->ClearSorted(s);
 	}
 	void Dump(std::ostream &os, std::string_view step = "  ", std::string_view offset = "") const override;
-	void EnableUpdatesCountingMode(bool val) override { tracker_.enableCountingMode(val); }
+	void EnableUpdatesCountingMode(bool val) override {
+		tracker_.enableCountingMode(val);
+		sortUpdates_.enableCountingMode(val);
+	}
+	void UpdateStats(size_t itemsCount) override;
+	bool ForEachKey(const std::function<void(const Variant &key, size_t count)> &fn) const override;
+	void SetOpts(const IndexOpts &opts) override;
 
 protected:
 	bool tryIdsetCache(const VariantArray &keys, CondType condition, SortType sortId, std::function<bool(SelectKeyResult &)> selector,
 					   SelectKeyResult &res);
+	// Deletes the sorted ids of the single key
+	void deleteIds(const Variant &key, span<IdType> ids, StringsHolder &, bool &clearCache);
 	void addMemStat(typename T::iterator it);
 	void delMemStat(typename T::iterator it);
+	// Returns false, if the key is definitely absent in the index map, i.e. bloom filter is enabled and the key was not added to it
+	bool bloomMayContain(const Variant &key) const;
+	// Selects idsets of the keys, which match the LIKE pattern, by the trigram index. Returns false, if the index can not narrow the keys
+	// or the result is too expensive, so the condition has to be checked by the comparator
+	bool selectLikeByTrigrams(const VariantArray &keys, SortType sortId, const Index::SelectOpts &opts, SelectKeyResult &res) const;
+	// Cached idsets are built by the selects, so their memory is not charged to the namespace's memory account
+	void resetCache() {
+		if (!cache_) return;
+		MemAccountingScope cacheMemScope(MemAccount::Untracked);
+		cache_.reset();
+	}
 
 	// Index map
 	T idx_map;
@@ -52,8 +79,22 @@ protected:
 	Index::KeyEntry empty_ids_;
 	// Tracker of updates
 	UpdateTracker<T> tracker_;
+	// Tracker of the keys, which sorted ids have to be updated on the next sort orders build
+	UpdateTracker<T> sortUpdates_;
+	// True if sorted ids of empty_ids_ have to be updated on the next sort orders build
+	bool emptyIdsSortUpdated_ = false;
 
 private:
+	void addToBloomFilter(const typename T::key_type &key);
+	void rebuildBloomFilter();
+
+	// Filter of the index keys for the indexes with the bloom filter option. Removed keys stay in filter until it is rebuilt
+	BloomFilter bloom_;
+	// Count of keys, which were added to the filter since the last rebuild
+	size_t bloomKeys_ = 0;
+	// Trigrams of the keys of the string indexes with the trigram option
+	TrigramIndex trigrams_;
+
 	template <typename S>
 	void dump(S &os, std::string_view step, std::string_view offset) const;
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace reindexer {
+
+/// Read optimized snapshot of the ordered numeric index keys: sorted array of keys with piecewise linear model of the key positions
+/// (PGM-index). Position of each key is predicted by its segment with error not greater than kEpsilon, so lookup is a search of the
+/// segment in the small array of segments and binary search in 2 * kEpsilon keys instead of the btree nodes traversal.
+/// Snapshot is immutable, it is rebuilt, when the set of the index keys is changed
+template <typename K, typename V>
+class LearnedKeys {
+public:
+	static constexpr size_t kEpsilon = 32;
+
+	/// @param keys - unique keys in ascending order
+	/// @param values - values of the keys
+	LearnedKeys(std::vector<K> &&keys, std::vector<V> &&values) : keys_(std::move(keys)), values_(std::move(values)) { buildSegments(); }
+
+	size_t Size() const noexcept { return keys_.size(); }
+	size_t SegmentsCount() const noexcept { return segments_.size(); }
+	const std::vector<K> &Keys() const noexcept { return keys_; }
+	const std::vector<V> &Values() const noexcept { return values_; }
+	/// @return position of the first key, which is not less than key
+	size_t LowerBound(K key) const noexcept {
+		return find(key, [key](K v) { return v < key; });
+	}
+	/// @return position of the first key, which is greater than key
+	size_t UpperBound(K key) const noexcept {
+		return find(key, [key](K v) { return !(key < v); });
+	}
+	size_t HeapSize() const noexcept {
+		return keys_.capacity() * sizeof(K) + values_.capacity() * sizeof(V) + segments_.capacity() * sizeof(Segment);
+	}
+
+private:
+	struct Segment {
+		K firstKey;
+		size_t firstPos;
+		double slope;
+	};
+
+	// Finds position of the first key, which is not before the searched one
+	template <typename Before>
+	size_t find(K key, Before before) const noexcept {
+		if (keys_.empty() || key < keys_.front()) return 0;
+		const auto segIt =
+			std::upper_bound(segments_.begin(), segments_.end(), key, [](K k, const Segment &s) { return k < s.firstKey; }) - 1;
+		const size_t segBegin = segIt->firstPos;
+		const size_t segEnd = (segIt + 1 == segments_.end()) ? keys_.size() : (segIt + 1)->firstPos;
+		const double predicted = double(segBegin) + segIt->slope * (double(key) - double(segIt->firstKey));
+		const size_t pos = size_t(std::min(std::max(predicted, double(segBegin)), double(segEnd)));
+		const size_t lo = std::max(pos, segBegin + kEpsilon + 1) - kEpsilon - 1;
+		const size_t hi = std::min(pos + kEpsilon + 2, segEnd);
+		const auto begin = keys_.begin();
+		// Prediction is the hint only: the error of floating point arithmetic for the large int64 keys is checked here
+		if ((lo != segBegin && !before(keys_[lo - 1])) || (hi != segEnd && before(keys_[hi]))) {
+			return std::partition_point(begin + segBegin, begin + segEnd, before) - begin;
+		}
+		return std::partition_point(begin + lo, begin + hi, before) - begin;
+	}
+
+	// Splits keys into the segments by the shrinking cone algorithm: segment is extended while there is a line from its first key,
+	// which predicts positions of all of its keys with error not greater than kEpsilon
+	void buildSegments() {
+		size_t first = 0;
+		while (first < keys_.size()) {
+			double minSlope = 0.0, maxSlope = std::numeric_limits<double>::infinity();
+			size_t pos = first + 1;
+			for (; pos < keys_.size(); ++pos) {
+				const double dx = double(keys_[pos]) - double(keys_[first]);
+				if (dx <= 0.0) break;
+				const double dy = double(pos - first);
+				const double lo = (dy - kEpsilon) / dx, hi = (dy + kEpsilon) / dx;
+				if (lo > maxSlope || hi < minSlope) break;
+				minSlope = std::max(minSlope, lo);
+				maxSlope = std::min(maxSlope, hi);
+			}
+			const double slope = (pos == first + 1) ? 0.0 : (minSlope + maxSlope) / 2;
+			segments_.push_back({keys_[first], first, slope});
+			first = pos;
+		}
+		segments_.shrink_to_fit();
+	}
+
+	std::vector<K> keys_;
+	std::vector<V> values_;
+	std::vector<Segment> segments_;
+};
+
+}  // namespace reindexer
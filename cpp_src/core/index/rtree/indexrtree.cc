@@ -59,6 +59,26 @@ SelectKeyResults IndexRTree<KeyEntryT, Splitter, MaxEntries, MinEntries>::Select
 	return SelectKeyResults(std::move(res));
 }
 
+template <typename KeyEntryT, template <typename, typename, typename, typename, size_t, size_t> class Splitter, size_t MaxEntries,
+		  size_t MinEntries>
+bool IndexRTree<KeyEntryT, Splitter, MaxEntries, MinEntries>::SelectNearest(Point point, size_t minIds, SortType sortId,
+																			SelectKeyResult &res, bool &exhausted) const {
+	// Rows without the point are not in the tree
+	if (!this->empty_ids_.Unsorted().IsEmpty()) return false;
+	size_t idsCount = 0;
+	exhausted = true;
+	this->idx_map.Nearest(point, [&](const typename Map::value_type &v) {
+		if (idsCount >= minIds) {
+			exhausted = false;
+			return true;
+		}
+		res.emplace_back(v.second, sortId);
+		idsCount += v.second.Unsorted().Size();
+		return false;
+	});
+	return true;
+}
+
 template <typename KeyEntryT, template <typename, typename, typename, typename, size_t, size_t> class Splitter, size_t MaxEntries,
 		  size_t MinEntries>
 void IndexRTree<KeyEntryT, Splitter, MaxEntries, MinEntries>::Upsert(VariantArray &result, const VariantArray &keys, IdType id,
@@ -77,8 +97,9 @@ void IndexRTree<KeyEntryT, Splitter, MaxEntries, MinEntries>::Upsert(VariantArra
 
 	if (keyIt->second.Unsorted().Add(id, this->opts_.IsPK() ? IdSet::Ordered : IdSet::Auto, this->sortedIdxCount_)) {
 		this->isBuilt_ = false;
+		this->sortUpdates_.markUpdated(this->idx_map, keyIt, false);
 		// reset cache
-		if (this->cache_) this->cache_.reset();
+		this->resetCache();
 		clearCache = true;
 	}
 	this->tracker_.markUpdated(this->idx_map, keyIt);
@@ -99,7 +120,7 @@ void IndexRTree<KeyEntryT, Splitter, MaxEntries, MinEntries>::Delete(const Varia
 	const Point point = static_cast<Point>(keys);
 	typename Map::iterator keyIt = this->idx_map.find(point);
 	if (keyIt == this->idx_map.end()) return;
-	if (this->cache_) this->cache_.reset();
+	this->resetCache();
 	clearCache = true;
 	this->isBuilt_ = false;
 
@@ -113,10 +134,12 @@ void IndexRTree<KeyEntryT, Splitter, MaxEntries, MinEntries>::Delete(const Varia
 
 	if (keyIt->second.Unsorted().IsEmpty()) {
 		this->tracker_.markDeleted(keyIt);
+		this->sortUpdates_.markDeleted(keyIt);
 		this->idx_map.template erase<void>(keyIt);
 	} else {
 		this->addMemStat(keyIt);
 		this->tracker_.markUpdated(this->idx_map, keyIt);
+		this->sortUpdates_.markUpdated(this->idx_map, keyIt, false);
 	}
 }
 
@@ -20,6 +20,8 @@ public:
 	void Upsert(VariantArray &result, const VariantArray &keys, IdType id, bool &clearCache) override;
 	using IndexUnordered<Map>::Delete;
 	void Delete(const VariantArray &keys, IdType id, StringsHolder &, bool &clearCache) override;
+	void BulkInsertionDone() override { this->idx_map.Pack(); }
+	bool SelectNearest(Point, size_t minIds, SortType, SelectKeyResult &, bool &exhausted) const override;
 
 	std::unique_ptr<Index> Clone() override { return std::unique_ptr<Index>{new IndexRTree(*this)}; }
 };
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <queue>
 #include "core/keyvalue/geometry.h"
 #include "estl/h_vector.h"
 
@@ -150,6 +153,7 @@ private:
 	class Leaf : public NodeBase {
 		using SplitterT = Splitter<T, Leaf, Traits, iterator, MaxEntries, MinEntries>;
 		friend Node;
+		friend RectangleTree;
 
 	public:
 		Leaf() noexcept = default;
@@ -566,10 +570,106 @@ public:
 		return cend();
 	}
 	void DWithin(Point p, double distance, RectangleTree::Visitor& visitor) const { root_.DWithin(p, distance, visitor); }
+	/// Visits values in the increasing order of the distances of their points from p (best-first search over the nodes, ordered by
+	/// the distances to their bounding rectangles). Search stops, when visitor returns true
+	template <typename F>
+	void Nearest(Point p, F&& visitor) const {
+		struct Entry {
+			double squaredDist;
+			const NodeBase* node;
+			const T* value;
+			bool operator<(const Entry& other) const noexcept { return squaredDist > other.squaredDist; }
+		};
+		std::priority_queue<Entry> queue;
+		queue.push({0.0, &root_, nullptr});
+		while (!queue.empty()) {
+			const Entry entry = queue.top();
+			queue.pop();
+			if (entry.value) {
+				if (visitor(*entry.value)) return;
+			} else if (entry.node->IsLeaf()) {
+				for (const auto& v : static_cast<const Leaf*>(entry.node)->data_) {
+					queue.push({squaredDistance(Traits::GetPoint(v), p), nullptr, &v});
+				}
+			} else {
+				for (const auto& n : static_cast<const Node*>(entry.node)->data_) {
+					queue.push({squaredDistance(n->BoundRect(), p), n.get(), nullptr});
+				}
+			}
+		}
+	}
+	/// Rebuilds the tree by Sort-Tile-Recursive packing: nodes of each level are sorted by x, cut into sqrt(nodes count) vertical
+	/// slices, and each slice is sorted by y and cut into the full nodes. Packed tree has less nodes and less overlap of their
+	/// rectangles, than the tree built by one by one insertions. Invalidates iterators
+	void Pack() {
+		std::vector<T> values;
+		values.reserve(size());
+		for (auto it = begin(), e = end(); it != e; ++it) values.emplace_back(std::move(*it));
+		root_.data_.clear();
+		root_.SetBoundRect({});
+		if (values.empty()) {
+			root_.insert(std::unique_ptr<NodeBase>{new Leaf});
+			return;
+		}
+
+		using ValuesIt = typename std::vector<T>::iterator;
+		using NodesIt = typename std::vector<std::unique_ptr<NodeBase>>::iterator;
+		const auto valuePoint = [](const T& v) noexcept { return Traits::GetPoint(v); };
+		const auto nodePoint = [](const std::unique_ptr<NodeBase>& n) noexcept { return center(n->BoundRect()); };
+		const auto makeLeaf = [](ValuesIt b, ValuesIt e) {
+			std::unique_ptr<Leaf> leaf{new Leaf};
+			for (; b != e; ++b) leaf->data_.emplace_back(std::move(*b));
+			leaf->adjustBoundRect();
+			return leaf;
+		};
+		const auto makeNode = [](NodesIt b, NodesIt e) {
+			std::unique_ptr<Node> node{new Node};
+			for (; b != e; ++b) {
+				node->data_.emplace_back(std::move(*b));
+				node->data_.back()->SetParent(node.get());
+			}
+			node->adjustBoundRect();
+			return node;
+		};
+
+		std::vector<std::unique_ptr<NodeBase>> level;
+		packLevel(values, valuePoint, level, makeLeaf);
+		while (level.size() > MaxEntries) {
+			std::vector<std::unique_ptr<NodeBase>> upperLevel;
+			packLevel(level, nodePoint, upperLevel, makeNode);
+			level = std::move(upperLevel);
+		}
+		for (auto& n : level) {
+			root_.data_.emplace_back(std::move(n));
+			root_.data_.back()->SetParent(&root_);
+		}
+		root_.adjustBoundRect();
+	}
 
 	bool Check() const noexcept { return root_.Check(nullptr); }
 
 private:
+	static Point center(const Rectangle& r) noexcept { return Point{(r.Left() + r.Right()) / 2, (r.Bottom() + r.Top()) / 2}; }
+
+	template <typename U, typename GetPoint, typename MakeNode>
+	static void packLevel(std::vector<U>& items, GetPoint getPoint, std::vector<std::unique_ptr<NodeBase>>& nodes, MakeNode makeNode) {
+		const size_t nodesCount = (items.size() + MaxEntries - 1) / MaxEntries;
+		const size_t slicesCount = std::ceil(std::sqrt(double(nodesCount)));
+		std::sort(items.begin(), items.end(), [&getPoint](const U& l, const U& r) { return getPoint(l).x < getPoint(r).x; });
+		nodes.reserve(nodesCount + slicesCount);
+		for (size_t slice = 0; slice < slicesCount; ++slice) {
+			// Items are distributed evenly between the slices and the nodes, so each node is at least half full
+			const auto sliceBegin = items.begin() + items.size() * slice / slicesCount;
+			const auto sliceEnd = items.begin() + items.size() * (slice + 1) / slicesCount;
+			std::sort(sliceBegin, sliceEnd, [&getPoint](const U& l, const U& r) { return getPoint(l).y < getPoint(r).y; });
+			const size_t sliceSize = sliceEnd - sliceBegin;
+			const size_t sliceNodes = (sliceSize + MaxEntries - 1) / MaxEntries;
+			for (size_t n = 0; n < sliceNodes; ++n) {
+				nodes.emplace_back(makeNode(sliceBegin + sliceSize * n / sliceNodes, sliceBegin + sliceSize * (n + 1) / sliceNodes));
+			}
+		}
+	}
+
 	Node root_;
 };
 
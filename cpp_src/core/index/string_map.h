@@ -3,12 +3,34 @@
 #include "core/keyvalue/key_string.h"
 #include "core/payload/payloadtype.h"
 #include "cpp-btree/btree_map.h"
+#include "hopscotch/hopscotch_map.h"
 #include "sparse-map/sparse_map.h"
 #include "tools/stringstools.h"
 namespace reindexer {
 
 class FieldsSet;
 
+/// Key of the ordered string map with the binary-comparable sort key of the collation (see collateSortKey), which is built once on the
+/// insertion of the key. Keys of the maps without such collation (CollateNone and CollateNumeric) have no sort key
+class collated_key_string : public key_string {
+public:
+	collated_key_string() = default;
+	collated_key_string(key_string str, const CollateOpts& collateOpts) : key_string(std::move(str)) {
+		std::string sortKey;
+		if (collateSortKey(*get(), collateOpts, sortKey)) sortKey_ = make_key_string(std::move(sortKey));
+	}
+	const key_string& SortKey() const noexcept { return sortKey_; }
+
+private:
+	key_string sortKey_;
+};
+
+/// Looked up string with its sort key (see str_map::find)
+struct collated_key_probe {
+	std::string_view str;
+	std::string_view sortKey;
+};
+
 struct less_key_string {
 	using is_transparent = void;
 
@@ -16,6 +38,16 @@ struct less_key_string {
 	bool operator()(const key_string& lhs, const key_string& rhs) const { return collateCompare(*lhs, *rhs, collateOpts_) < 0; }
 	bool operator()(std::string_view lhs, const key_string& rhs) const { return collateCompare(lhs, *rhs, collateOpts_) < 0; }
 	bool operator()(const key_string& lhs, std::string_view rhs) const { return collateCompare(*lhs, rhs, collateOpts_) < 0; }
+	bool operator()(const collated_key_string& lhs, const collated_key_string& rhs) const {
+		if (lhs.SortKey() && rhs.SortKey()) return lhs.SortKey()->compare(*rhs.SortKey()) < 0;
+		return collateCompare(*lhs, *rhs, collateOpts_) < 0;
+	}
+	bool operator()(const collated_key_probe& lhs, const collated_key_string& rhs) const {
+		return rhs.SortKey() ? std::string_view(*rhs.SortKey()) > lhs.sortKey : collateCompare(lhs.str, *rhs, collateOpts_) < 0;
+	}
+	bool operator()(const collated_key_string& lhs, const collated_key_probe& rhs) const {
+		return lhs.SortKey() ? std::string_view(*lhs.SortKey()) < rhs.sortKey : collateCompare(*lhs, rhs.str, collateOpts_) < 0;
+	}
 	CollateOpts collateOpts_;
 };
 
@@ -65,15 +97,79 @@ public:
 	}
 };
 
+/// Open addressing (hopscotch) variant of unordered_str_map. Key is found in the small neighborhood of its bucket, so lookups are
+/// faster, than in the sparse map, by the cost of the memory for the empty buckets
+template <typename T1>
+class flat_unordered_str_map : public tsl::hopscotch_map<key_string, T1, hash_key_string, equal_key_string> {
+	using base_hash_map = tsl::hopscotch_map<key_string, T1, hash_key_string, equal_key_string>;
+	using base_hash_map::erase;
+
+public:
+	using typename base_hash_map::iterator;
+	flat_unordered_str_map(const CollateOpts& opts)
+		: base_hash_map(1000, hash_key_string(CollateMode(opts.mode)), equal_key_string(opts)) {}
+
+	template <typename deep_cleaner>
+	iterator erase(iterator pos) {
+		static const deep_cleaner deep_clean;
+		return erase(pos, deep_clean);
+	}
+
+	// Hopscotch map hashes the key of the erased entry, so the entry is moved out and cleaned after erase
+	template <typename deep_cleaner>
+	iterator erase(iterator pos, const deep_cleaner& deep_clean) {
+		std::pair<key_string, T1> entry{pos->first, std::move(pos->second)};
+		auto next = base_hash_map::erase(pos);
+		deep_clean(entry);
+		return next;
+	}
+};
+
+/// Ordered string map. Keys are stored with their sort keys, so the comparisons of the collated strings are binary. Key type of the map
+/// is key_string for the indexes, so the map is filled and searched by the key strings and by the string views
 template <typename T1>
-class str_map : public btree::btree_map<key_string, T1, less_key_string> {
-	using base_tree_map = btree::btree_map<key_string, T1, less_key_string>;
+class str_map : public btree::btree_map<collated_key_string, T1, less_key_string> {
+	using base_tree_map = btree::btree_map<collated_key_string, T1, less_key_string>;
 	using base_tree_map::erase;
+	using base_tree_map::insert;
 
 public:
+	using key_type = key_string;
 	using typename base_tree_map::iterator;
+	using typename base_tree_map::const_iterator;
+	using base_tree_map::find;
+	using base_tree_map::lower_bound;
+	using base_tree_map::upper_bound;
 	str_map(const CollateOpts& opts) : base_tree_map(less_key_string(opts)) {}
 
+	std::pair<iterator, bool> insert(std::pair<key_string, T1>&& value) {
+		return base_tree_map::insert({collated_key_string(std::move(value.first), this->key_comp().collateOpts_), std::move(value.second)});
+	}
+	iterator insert(iterator hint, std::pair<key_string, T1>&& value) {
+		return base_tree_map::insert(
+			hint, {collated_key_string(std::move(value.first), this->key_comp().collateOpts_), std::move(value.second)});
+	}
+
+	// Sort key of the looked up string is built once, instead of the collation of each compared key
+	iterator find(std::string_view key) {
+		return lookup(key, [this](const auto& k) { return base_tree_map::find(k); });
+	}
+	const_iterator find(std::string_view key) const {
+		return lookup(key, [this](const auto& k) { return base_tree_map::find(k); });
+	}
+	iterator lower_bound(std::string_view key) {
+		return lookup(key, [this](const auto& k) { return base_tree_map::lower_bound(k); });
+	}
+	const_iterator lower_bound(std::string_view key) const {
+		return lookup(key, [this](const auto& k) { return base_tree_map::lower_bound(k); });
+	}
+	iterator upper_bound(std::string_view key) {
+		return lookup(key, [this](const auto& k) { return base_tree_map::upper_bound(k); });
+	}
+	const_iterator upper_bound(std::string_view key) const {
+		return lookup(key, [this](const auto& k) { return base_tree_map::upper_bound(k); });
+	}
+
 	template <typename deep_cleaner>
 	iterator erase(const iterator& pos) {
 		static const deep_cleaner deep_clean;
@@ -85,6 +181,14 @@ public:
 		deep_clean(*pos);
 		return base_tree_map::erase(pos);
 	}
+
+private:
+	template <typename F>
+	auto lookup(std::string_view key, const F& f) const {
+		std::string sortKey;
+		if (collateSortKey(key, this->key_comp().collateOpts_, sortKey)) return f(collated_key_probe{key, sortKey});
+		return f(key);
+	}
 };
 
 // sparsemap meeds special hash for intergers, due to
@@ -122,6 +226,26 @@ public:
 	}
 };
 
+/// Open addressing (hopscotch) variant of unordered_number_map
+template <typename K, typename T1>
+class flat_unordered_number_map : public tsl::hopscotch_map<K, T1, hash_int<K>> {
+	using base_hash_map = tsl::hopscotch_map<K, T1, hash_int<K>>;
+	using base_hash_map::erase;
+
+public:
+	using typename base_hash_map::iterator;
+	flat_unordered_number_map() = default;
+
+	template <typename deep_cleaner>
+	iterator erase(iterator pos) {
+		static const deep_cleaner deep_clean;
+		std::pair<K, T1> entry{pos->first, std::move(pos->second)};
+		auto next = base_hash_map::erase(pos);
+		deep_clean(entry);
+		return next;
+	}
+};
+
 template <typename K, typename T1>
 class number_map : public btree::btree_map<K, T1> {
 	using base_tree_map = btree::btree_map<K, T1>;
@@ -160,6 +284,7 @@ struct StringMapEntryCleaner {
 	void free_node(const key_string& str) const {
 		if (needSaveExpiredStrings_) strHolder_.Add(str);
 	}
+	void free_node(const collated_key_string& str) const { free_node(static_cast<const key_string&>(str)); }
 
 	void free_node(key_string& str) const {
 		if (needSaveExpiredStrings_) {
@@ -183,4 +308,7 @@ constexpr bool is_str_map_v<str_map<T>> = true;
 template <typename T>
 constexpr bool is_str_map_v<unordered_str_map<T>> = true;
 
+template <typename T>
+constexpr bool is_str_map_v<flat_unordered_str_map<T>> = true;
+
 }  // namespace reindexer
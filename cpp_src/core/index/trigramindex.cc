@@ -0,0 +1,120 @@
+#include "trigramindex.h"
+#include <algorithm>
+#include "tools/customlocal.h"
+#include "utf8cpp/utf8.h"
+
+namespace reindexer {
+
+constexpr size_t kMinRemovedKeysForRebuild = 1024;
+// Posting list, which is much longer than the candidates list, is intersected by the binary search
+constexpr size_t kBinarySearchIntersectionRatio = 16;
+
+// Appends codes of the trigrams of the lowercased code points. Code point takes 21 bits of the trigram's code
+static void appendTrigrams(std::string_view utf8Text, std::vector<uint64_t> &trigrams) {
+	constexpr uint64_t kCodePointMask = (uint64_t(1) << 21) - 1;
+	constexpr uint64_t kBigramMask = (uint64_t(1) << 42) - 1;
+	uint64_t code = 0;
+	size_t codePoints = 0;
+	const char *it = utf8Text.data();
+	const char *const end = utf8Text.data() + utf8Text.size();
+	while (it != end) {
+		const uint64_t ch = static_cast<uint64_t>(ToLower(static_cast<wchar_t>(utf8::unchecked::next(it)))) & kCodePointMask;
+		code = ((code & kBigramMask) << 21) | ch;
+		if (++codePoints >= 3) trigrams.push_back(code);
+	}
+}
+
+static void sortUnique(std::vector<uint64_t> &trigrams) {
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+void TrigramIndex::Add(const key_string &key) {
+	const std::string_view keyView(*key);
+	if (ordinals_.find(keyView) != ordinals_.end()) return;
+	const uint32_t ordinal = keys_.size();
+	keys_.emplace_back(key);
+	ordinals_.emplace(keyView, ordinal);
+	addPostings(ordinal, keyView);
+}
+
+void TrigramIndex::Remove(std::string_view key) {
+	const auto it = ordinals_.find(key);
+	if (it == ordinals_.end()) return;
+	const uint32_t ordinal = it->second;
+	ordinals_.erase(it);
+	keys_[ordinal] = key_string();
+	if (keys_.size() > 2 * ordinals_.size() + kMinRemovedKeysForRebuild) rebuild();
+}
+
+bool TrigramIndex::ForEachCandidate(std::string_view likePattern, const Visitor &visitor) const {
+	std::vector<uint64_t> trigrams;
+	// Wildcards split pattern into the literal parts
+	for (size_t pos = 0; pos <= likePattern.size();) {
+		const size_t next = std::min(likePattern.find_first_of("%_", pos), likePattern.size());
+		appendTrigrams(likePattern.substr(pos, next - pos), trigrams);
+		pos = next + 1;
+	}
+	if (trigrams.empty()) return false;
+	sortUnique(trigrams);
+
+	std::vector<const std::vector<uint32_t> *> lists;
+	lists.reserve(trigrams.size());
+	for (uint64_t trigram : trigrams) {
+		const auto it = postings_.find(trigram);
+		if (it == postings_.end()) return true;
+		lists.push_back(&it->second);
+	}
+	std::sort(lists.begin(), lists.end(), [](const auto *l, const auto *r) { return l->size() < r->size(); });
+
+	std::vector<uint32_t> candidates(*lists[0]), intersection;
+	for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+		const auto &list = *lists[i];
+		intersection.clear();
+		if (list.size() / kBinarySearchIntersectionRatio > candidates.size()) {
+			auto from = list.begin();
+			for (uint32_t ordinal : candidates) {
+				from = std::lower_bound(from, list.end(), ordinal);
+				if (from == list.end()) break;
+				if (*from == ordinal) intersection.push_back(ordinal);
+			}
+		} else {
+			std::set_intersection(candidates.begin(), candidates.end(), list.begin(), list.end(), std::back_inserter(intersection));
+		}
+		candidates.swap(intersection);
+	}
+	for (uint32_t ordinal : candidates) {
+		if (const auto &key = keys_[ordinal]) visitor(std::string_view(*key));
+	}
+	return true;
+}
+
+size_t TrigramIndex::HeapSize() const noexcept {
+	return keys_.capacity() * sizeof(key_string) + ordinals_.bucket_count() * sizeof(std::pair<std::string_view, uint32_t>) +
+		   postings_.bucket_count() * sizeof(std::pair<uint64_t, std::vector<uint32_t>>) + postingsSize_ * sizeof(uint32_t);
+}
+
+void TrigramIndex::addPostings(uint32_t ordinal, std::string_view key) {
+	std::vector<uint64_t> trigrams;
+	appendTrigrams(key, trigrams);
+	sortUnique(trigrams);
+	// Ordinals are increasing, so the posting lists stay sorted
+	for (uint64_t trigram : trigrams) postings_[trigram].push_back(ordinal);
+	postingsSize_ += trigrams.size();
+}
+
+void TrigramIndex::rebuild() {
+	ordinals_.clear();
+	postings_.clear();
+	postingsSize_ = 0;
+	std::vector<key_string> keys;
+	keys.reserve(keys_.size());
+	for (auto &key : keys_) {
+		if (key) keys.emplace_back(std::move(key));
+	}
+	keys_ = std::vector<key_string>();
+	keys_.reserve(keys.size());
+	for (const auto &key : keys) Add(key);
+}
+
+}  // namespace reindexer
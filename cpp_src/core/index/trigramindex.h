@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <string_view>
+#include <vector>
+#include "core/keyvalue/key_string.h"
+#include "estl/fast_hash_map.h"
+
+namespace reindexer {
+
+/// Index of the trigrams of the string index keys for the LIKE conditions. Posting list of each trigram contains ordinals of the keys,
+/// which contain it. Trigrams are made of the lowercased code points, because LIKE patterns are matched case insensitively.
+/// Removed keys leave stale ordinals in the posting lists, so the index is rebuilt, when they are the most of its keys
+class TrigramIndex {
+public:
+	using Visitor = std::function<void(std::string_view key)>;
+
+	void Add(const key_string &key);
+	void Remove(std::string_view key);
+	/// Calls visitor for each key, which contains all the trigrams of the literal parts of the LIKE pattern.
+	/// Keys are only candidates and have to be matched by the pattern.
+	/// @return false, if the pattern has no trigrams, so the index can not narrow the keys
+	bool ForEachCandidate(std::string_view likePattern, const Visitor &visitor) const;
+	size_t HeapSize() const noexcept;
+
+private:
+	void addPostings(uint32_t ordinal, std::string_view key);
+	void rebuild();
+
+	// Live keys are mapped to the ordinals. Views point to the strings, which are held by keys_
+	fast_hash_map<std::string_view, uint32_t> ordinals_;
+	// Keys by ordinals. Removed keys are empty
+	std::vector<key_string> keys_;
+	// Sorted ordinals of the keys by trigrams
+	fast_hash_map<uint64_t, std::vector<uint32_t>> postings_;
+	size_t postingsSize_ = 0;
+};
+
+}  // namespace reindexer
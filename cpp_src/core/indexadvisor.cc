@@ -0,0 +1,221 @@
+#include "indexadvisor.h"
+
+#include <algorithm>
+#include <map>
+#include "core/cjson/jsonbuilder.h"
+#include "core/query/query.h"
+#include "core/querystat.h"
+#include "estl/fast_hash_map.h"
+#include "tools/logger.h"
+#include "tools/stringstools.h"
+
+namespace reindexer {
+
+namespace {
+
+enum class IndexNeed { None, Hash, Tree };
+
+IndexNeed needByCondition(CondType cond) noexcept {
+	switch (cond) {
+		case CondEq:
+		case CondSet:
+		case CondAllSet:
+			return IndexNeed::Hash;
+		case CondLt:
+		case CondLe:
+		case CondGt:
+		case CondGe:
+		case CondRange:
+			return IndexNeed::Tree;
+		default:
+			return IndexNeed::None;
+	}
+}
+
+const char *indexTypeName(IndexNeed need) noexcept { return need == IndexNeed::Tree ? "tree" : "hash"; }
+
+bool isComposite(const IndexDef &idx) noexcept {
+	try {
+		return IsComposite(idx.Type());
+	} catch (const Error &) {
+		return false;
+	}
+}
+
+const IndexDef *findIndex(const NamespaceDef &def, std::string_view field) {
+	for (const auto &idx : def.indexes) {
+		if (isComposite(idx)) continue;
+		if (iequals(idx.name_, field)) return &idx;
+		for (const auto &path : idx.jsonPaths_) {
+			if (path == field) return &idx;
+		}
+	}
+	return nullptr;
+}
+
+bool isFieldName(std::string_view expr) noexcept {
+	return !expr.empty() && std::all_of(expr.begin(), expr.end(),
+										[](char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.'; });
+}
+
+class AdvicesBuilder {
+public:
+	AdvicesBuilder(const IndexAdvisor::GetNsInfo &getNsInfo) : getNsInfo_(getNsInfo) {}
+
+	void Add(const Query &q, const QueryPerfStat &stat) {
+		if (q._namespace.empty() || q._namespace[0] == '#') return;
+		const IndexAdvisor::NsInfo *ns = nsInfo(q._namespace);
+		if (!ns) return;
+
+		q.entries.ExecuteAppropriateForEach(Skip<JoinQueryEntry, QueryEntriesBracket, BetweenFieldsQueryEntry, AlwaysFalse>{},
+											[&](const QueryEntry &qe) { addField(*ns, qe.index, needByCondition(qe.condition), stat); });
+		if (!q.sortingEntries_.empty() && isFieldName(q.sortingEntries_[0].expression)) {
+			addField(*ns, q.sortingEntries_[0].expression, IndexNeed::Tree, stat);
+		}
+		addComposite(*ns, q, stat);
+	}
+
+	std::vector<IndexAdvice> Result() {
+		std::vector<IndexAdvice> ret;
+		ret.reserve(advices_.size());
+		for (auto &entry : advices_) ret.emplace_back(std::move(entry.second.advice));
+		std::sort(ret.begin(), ret.end(),
+				  [](const IndexAdvice &lhs, const IndexAdvice &rhs) { return lhs.queriesTimeUs > rhs.queriesTimeUs; });
+		return ret;
+	}
+
+private:
+	const IndexAdvisor::NsInfo *nsInfo(const std::string &nsName) {
+		auto it = namespaces_.find(nsName);
+		if (it == namespaces_.end()) {
+			IndexAdvisor::NsInfo info;
+			const bool exists = getNsInfo_(nsName, info);
+			it = namespaces_.emplace(nsName, exists ? std::make_unique<IndexAdvisor::NsInfo>(std::move(info)) : nullptr).first;
+		}
+		return it->second.get();
+	}
+
+	void addField(const IndexAdvisor::NsInfo &ns, std::string_view field, IndexNeed need, const QueryPerfStat &stat) {
+		if (need == IndexNeed::None) return;
+		const IndexDef *idx = findIndex(ns.def, field);
+		std::string_view kind = "add_index";
+		if (idx) {
+			if (idx->indexType_ == "-") {
+				kind = "change_index_type";
+			} else if (idx->indexType_ == "hash" && need == IndexNeed::Tree) {
+				kind = "change_index_type";
+			} else {
+				return;
+			}
+		}
+		std::vector<std::string> fields{idx ? idx->name_ : std::string(field)};
+		IndexAdvice &advice = get(ns, kind, std::move(fields), stat);
+		// Tree index serves the equality conditions too, so it wins over the hash one
+		if (advice.indexType.empty() || need == IndexNeed::Tree) advice.indexType = indexTypeName(need);
+		if (idx) advice.currentIndexType = idx->indexType_;
+		advice.estimatedMemoryBytes =
+			ns.itemsCount * (advice.indexType == "tree" ? IndexAdvisor::kTreeBytesPerItem : IndexAdvisor::kHashBytesPerItem);
+	}
+
+	// Equality conditions on the several indexed fields, which are joined by AND, are served by the one composite index lookup instead of
+	// the intersection of the idsets
+	void addComposite(const IndexAdvisor::NsInfo &ns, const Query &q, const QueryPerfStat &stat) {
+		std::vector<std::string> fields;
+		for (size_t i = 0, size = q.entries.Size(); i < size; i = q.entries.Next(i)) {
+			if (q.entries.GetOperation(i) != OpAnd || !q.entries.HoldsOrReferTo<QueryEntry>(i)) continue;
+			const size_t next = q.entries.Next(i);
+			if (next < size && q.entries.GetOperation(next) == OpOr) continue;
+			const QueryEntry &qe = q.entries.Get<QueryEntry>(i);
+			if (qe.condition != CondEq || qe.values.size() != 1) continue;
+			const IndexDef *idx = findIndex(ns.def, qe.index);
+			if (!idx || idx->opts_.IsArray() || (idx->indexType_ != "hash" && idx->indexType_ != "tree")) continue;
+			if (std::find(fields.begin(), fields.end(), idx->name_) == fields.end()) fields.push_back(idx->name_);
+		}
+		if (fields.size() < 2) return;
+		std::sort(fields.begin(), fields.end());
+		if (fields.size() > IndexAdvisor::kMaxCompositeFields) fields.resize(IndexAdvisor::kMaxCompositeFields);
+		for (const auto &idx : ns.def.indexes) {
+			if (!isComposite(idx) || idx.jsonPaths_.size() != fields.size()) continue;
+			std::vector<std::string> paths(idx.jsonPaths_.begin(), idx.jsonPaths_.end());
+			std::sort(paths.begin(), paths.end());
+			if (paths == fields) return;
+		}
+		IndexAdvice &advice = get(ns, "add_composite_index", std::move(fields), stat);
+		advice.indexType = "hash";
+		advice.estimatedMemoryBytes = ns.itemsCount * IndexAdvisor::kCompositeBytesPerItem;
+	}
+
+	IndexAdvice &get(const IndexAdvisor::NsInfo &ns, std::string_view kind, std::vector<std::string> &&fields, const QueryPerfStat &stat) {
+		std::string id = ns.def.name;
+		id.append(":").append(kind).append(":");
+		for (size_t i = 0; i < fields.size(); ++i) {
+			if (i) id += '+';
+			id += fields[i];
+		}
+		auto it = advices_.find(id);
+		if (it == advices_.end()) {
+			Entry entry;
+			entry.advice.id = id;
+			entry.advice.ns = ns.def.name;
+			entry.advice.kind = std::string(kind);
+			entry.advice.fields = std::move(fields);
+			it = advices_.emplace(std::move(id), std::move(entry)).first;
+		}
+		Entry &entry = it->second;
+		if (entry.lastStat != &stat) {
+			entry.lastStat = &stat;
+			if (entry.advice.queries.size() < IndexAdvisor::kMaxQueriesPerAdvice) entry.advice.queries.push_back(stat.query);
+			entry.advice.queriesCount += stat.perf.totalHitCount;
+			entry.advice.queriesTimeUs += stat.perf.totalHitCount * stat.perf.totalTimeUs;
+		}
+		return entry.advice;
+	}
+
+	struct Entry {
+		IndexAdvice advice;
+		// The same query may contain several conditions on the field, but it's counted once
+		const QueryPerfStat *lastStat = nullptr;
+	};
+
+	const IndexAdvisor::GetNsInfo &getNsInfo_;
+	fast_hash_map<std::string, std::unique_ptr<IndexAdvisor::NsInfo>, nocase_hash_str, nocase_equal_str> namespaces_;
+	std::map<std::string, Entry> advices_;
+};
+
+}  // namespace
+
+std::vector<IndexAdvice> IndexAdvisor::Advise(const std::vector<QueryPerfStat> &workload, const GetNsInfo &getNsInfo) {
+	AdvicesBuilder builder(getNsInfo);
+	for (const auto &stat : workload) {
+		if (stat.longestQuery.empty()) continue;
+		Query q;
+		try {
+			q.FromSQL(stat.longestQuery);
+		} catch (const Error &err) {
+			logPrintf(LogTrace, "IndexAdvisor: skipping query '%s': %s", stat.longestQuery, err.what());
+			continue;
+		}
+		q.WalkNested(true, true, [&builder, &stat](const Query &nested) { builder.Add(nested, stat); });
+	}
+	return builder.Result();
+}
+
+void IndexAdvice::GetJSON(WrSerializer &ser) const {
+	JsonBuilder builder(ser);
+	builder.Put("id", id);
+	builder.Put("namespace", ns);
+	builder.Put("kind", kind);
+	{
+		auto arr = builder.Array("fields");
+		for (const auto &field : fields) arr.Put({}, field);
+	}
+	builder.Put("index_type", indexType);
+	if (!currentIndexType.empty()) builder.Put("current_index_type", currentIndexType);
+	builder.Put("queries_count", queriesCount);
+	builder.Put("queries_time_us", queriesTimeUs);
+	builder.Put("estimated_memory_bytes", estimatedMemoryBytes);
+	auto arr = builder.Array("queries");
+	for (const auto &query : queries) arr.Put({}, query);
+}
+
+}  // namespace reindexer
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/namespacedef.h"
+
+namespace reindexer {
+
+class WrSerializer;
+struct QueryPerfStat;
+
+/// Recommendation of #indexadvices: the index, which would replace the scan for the conditions or the sorting of the recorded queries
+struct IndexAdvice {
+	void GetJSON(WrSerializer &ser) const;
+
+	std::string id;
+	std::string ns;
+	// add_index, add_composite_index or change_index_type
+	std::string kind;
+	std::vector<std::string> fields;
+	std::string indexType;
+	// Type of the existing index for change_index_type
+	std::string currentIndexType;
+	// Normalized queries, which would use the index (at most IndexAdvisor::kMaxQueriesPerAdvice)
+	std::vector<std::string> queries;
+	int64_t queriesCount = 0;
+	// Total execution time of the queries. It's the upper bound of the saving, which is reached if the scans were the only cost
+	int64_t queriesTimeUs = 0;
+	int64_t estimatedMemoryBytes = 0;
+};
+
+/// Analyzes the workload recorded by QueriesStatTracer (#queriesperfstats). The longest query of each shape is parsed back and its
+/// conditions and sorting are matched with the indexes of the namespace
+class IndexAdvisor {
+public:
+	static constexpr size_t kMaxQueriesPerAdvice = 10;
+	static constexpr size_t kMaxCompositeFields = 4;
+	// Rough memory cost of the index per item, as if each item had its own key
+	static constexpr int64_t kHashBytesPerItem = 24;
+	static constexpr int64_t kTreeBytesPerItem = 40;
+	static constexpr int64_t kCompositeBytesPerItem = 48;
+
+	struct NsInfo {
+		NamespaceDef def;
+		int64_t itemsCount = 0;
+	};
+	/// Returns false, if the namespace doesn't exist
+	using GetNsInfo = std::function<bool(std::string_view ns, NsInfo &)>;
+
+	/// @return advices sorted by the time of the queries, which would benefit from them
+	static std::vector<IndexAdvice> Advise(const std::vector<QueryPerfStat> &workload, const GetNsInfo &getNsInfo);
+};
+
+}  // namespace reindexer
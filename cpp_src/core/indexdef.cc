@@ -35,6 +35,12 @@ static const std::vector<std::string> &condsGeom() {
 	return data;
 }
 
+static const std::vector<std::string> &condsVector() {
+	using namespace std::string_literals;
+	static const std::vector data{"KNN"s};
+	return data;
+}
+
 enum Caps { CapComposite = 0x1, CapSortable = 0x2, CapFullText = 0x4 };
 
 struct IndexInfo {
@@ -67,6 +73,7 @@ static const std::unordered_map<IndexType, IndexInfo, std::hash<int>, std::equal
 		{IndexFastFT,			{"string"s, "text"s,			condsText(),	CapFullText}},
 		{IndexFuzzyFT,			{"string"s, "fuzzytext"s,		condsText(),	CapFullText}},
 		{IndexRTree,			{"point"s, "rtree"s,			condsGeom(),	0}},
+		{IndexHnsw,				{"double"s, "hnsw"s,			condsVector(),	0}},
 	};
 	// clang-format on
 	return data;
@@ -178,6 +185,11 @@ void IndexDef::FromJSON(const gason::JsonNode &root) {
 	opts_.Array(root["is_array"].As<bool>());
 	opts_.Dense(root["is_dense"].As<bool>());
 	opts_.Sparse(root["is_sparse"].As<bool>());
+	opts_.Columnar(root["is_columnar"].As<bool>());
+	opts_.FlatHash(root["is_flat_hash"].As<bool>());
+	opts_.Learned(root["is_learned"].As<bool>());
+	opts_.BloomFilter(root["is_bloom_filter"].As<bool>());
+	opts_.Trigram(root["is_trigram"].As<bool>());
 	opts_.SetConfig(stringifyJson(root["config"]));
 	const std::string rtreeType = root["rtree_type"].As<std::string>();
 	if (rtreeType.empty()) {
@@ -221,6 +233,11 @@ void IndexDef::GetJSON(WrSerializer &ser, int formatFlags) const {
 		.Put("is_array", opts_.IsArray())
 		.Put("is_dense", opts_.IsDense())
 		.Put("is_sparse", opts_.IsSparse());
+	if (opts_.IsColumnar()) builder.Put("is_columnar", true);
+	if (opts_.IsFlatHash()) builder.Put("is_flat_hash", true);
+	if (opts_.IsLearned()) builder.Put("is_learned", true);
+	if (opts_.IsBloomFilter()) builder.Put("is_bloom_filter", true);
+	if (opts_.IsTrigram()) builder.Put("is_trigram", true);
 	if (indexType_ == "rtree" || fieldType_ == "point") {
 		switch (opts_.RTreeType()) {
 			case IndexOpts::Linear:
@@ -16,10 +16,10 @@ void CollateOpts::Dump(T& os) const {
 }
 template void CollateOpts::Dump<std::ostream>(std::ostream&) const;
 
-IndexOpts::IndexOpts(uint8_t flags, CollateMode mode, RTreeIndexType rtreeType)
+IndexOpts::IndexOpts(uint16_t flags, CollateMode mode, RTreeIndexType rtreeType)
 	: options(flags), collateOpts_(mode), rtreeType_(rtreeType) {}
 
-IndexOpts::IndexOpts(const std::string& sortOrderUTF8, uint8_t flags, RTreeIndexType rtreeType)
+IndexOpts::IndexOpts(const std::string& sortOrderUTF8, uint16_t flags, RTreeIndexType rtreeType)
 	: options(flags), collateOpts_(sortOrderUTF8), rtreeType_(rtreeType) {}
 
 bool IndexOpts::IsEqual(const IndexOpts& other, bool skipConfig) const {
@@ -32,6 +32,11 @@ bool IndexOpts::IsPK() const noexcept { return options & kIndexOptPK; }
 bool IndexOpts::IsArray() const noexcept { return options & kIndexOptArray; }
 bool IndexOpts::IsDense() const noexcept { return options & kIndexOptDense; }
 bool IndexOpts::IsSparse() const noexcept { return options & kIndexOptSparse; }
+bool IndexOpts::IsColumnar() const noexcept { return options & kIndexOptColumnar; }
+bool IndexOpts::IsFlatHash() const noexcept { return options & kIndexOptFlatHash; }
+bool IndexOpts::IsLearned() const noexcept { return options & kIndexOptLearned; }
+bool IndexOpts::IsBloomFilter() const noexcept { return options & kIndexOptBloomFilter; }
+bool IndexOpts::IsTrigram() const noexcept { return options & kIndexOptTrigram; }
 bool IndexOpts::hasConfig() const noexcept { return !config.empty(); }
 CollateMode IndexOpts::GetCollateMode() const noexcept { return static_cast<CollateMode>(collateOpts_.mode); }
 
@@ -55,6 +60,31 @@ IndexOpts& IndexOpts::Sparse(bool value) noexcept {
 	return *this;
 }
 
+IndexOpts& IndexOpts::Columnar(bool value) noexcept {
+	options = value ? options | kIndexOptColumnar : options & ~(kIndexOptColumnar);
+	return *this;
+}
+
+IndexOpts& IndexOpts::FlatHash(bool value) noexcept {
+	options = value ? options | kIndexOptFlatHash : options & ~(kIndexOptFlatHash);
+	return *this;
+}
+
+IndexOpts& IndexOpts::Learned(bool value) noexcept {
+	options = value ? options | kIndexOptLearned : options & ~(kIndexOptLearned);
+	return *this;
+}
+
+IndexOpts& IndexOpts::BloomFilter(bool value) noexcept {
+	options = value ? options | kIndexOptBloomFilter : options & ~(kIndexOptBloomFilter);
+	return *this;
+}
+
+IndexOpts& IndexOpts::Trigram(bool value) noexcept {
+	options = value ? options | kIndexOptTrigram : options & ~(kIndexOptTrigram);
+	return *this;
+}
+
 IndexOpts& IndexOpts::RTreeType(RTreeIndexType value) noexcept {
 	rtreeType_ = value;
 	return *this;
@@ -93,6 +123,31 @@ void IndexOpts::Dump(T& os) const {
 		os << "Sparse";
 		needComma = true;
 	}
+	if (IsColumnar()) {
+		if (needComma) os << ", ";
+		os << "Columnar";
+		needComma = true;
+	}
+	if (IsFlatHash()) {
+		if (needComma) os << ", ";
+		os << "FlatHash";
+		needComma = true;
+	}
+	if (IsLearned()) {
+		if (needComma) os << ", ";
+		os << "Learned";
+		needComma = true;
+	}
+	if (IsBloomFilter()) {
+		if (needComma) os << ", ";
+		os << "BloomFilter";
+		needComma = true;
+	}
+	if (IsTrigram()) {
+		if (needComma) os << ", ";
+		os << "Trigram";
+		needComma = true;
+	}
 	if (needComma) os << ", ";
 	os << RTreeType();
 	if (hasConfig()) {
@@ -18,13 +18,18 @@ struct CollateOpts {
 /// in memory.h and unordered_map.h
 struct IndexOpts {
 	enum RTreeIndexType : uint8_t { Linear = 0, Quadratic = 1, Greene = 2, RStar = 3 };
-	explicit IndexOpts(uint8_t flags = 0, CollateMode mode = CollateNone, RTreeIndexType = RStar);
-	explicit IndexOpts(const std::string& sortOrderUTF8, uint8_t flags = 0, RTreeIndexType = RStar);
+	explicit IndexOpts(uint16_t flags = 0, CollateMode mode = CollateNone, RTreeIndexType = RStar);
+	explicit IndexOpts(const std::string& sortOrderUTF8, uint16_t flags = 0, RTreeIndexType = RStar);
 
 	bool IsPK() const noexcept;
 	bool IsArray() const noexcept;
 	bool IsDense() const noexcept;
 	bool IsSparse() const noexcept;
+	bool IsColumnar() const noexcept;
+	bool IsFlatHash() const noexcept;
+	bool IsLearned() const noexcept;
+	bool IsBloomFilter() const noexcept;
+	bool IsTrigram() const noexcept;
 	RTreeIndexType RTreeType() const noexcept { return rtreeType_; }
 	bool hasConfig() const noexcept;
 
@@ -32,6 +37,11 @@ struct IndexOpts {
 	IndexOpts& Array(bool value = true) noexcept;
 	IndexOpts& Dense(bool value = true) noexcept;
 	IndexOpts& Sparse(bool value = true) noexcept;
+	IndexOpts& Columnar(bool value = true) noexcept;
+	IndexOpts& FlatHash(bool value = true) noexcept;
+	IndexOpts& Learned(bool value = true) noexcept;
+	IndexOpts& BloomFilter(bool value = true) noexcept;
+	IndexOpts& Trigram(bool value = true) noexcept;
 	IndexOpts& RTreeType(RTreeIndexType) noexcept;
 	IndexOpts& SetCollateMode(CollateMode mode) noexcept;
 	IndexOpts& SetConfig(const std::string& config);
@@ -43,7 +53,7 @@ struct IndexOpts {
 	template <typename T>
 	void Dump(T& os) const;
 
-	uint8_t options;
+	uint16_t options;
 	CollateOpts collateOpts_;
 	std::string config;
 	RTreeIndexType rtreeType_ = RStar;
@@ -9,6 +9,7 @@
 #include "core/cjson/protobufbuilder.h"
 #include "core/cjson/protobufdecoder.h"
 #include "core/keyvalue/p_string.h"
+#include "core/namespace/coldtuples.h"
 #include "core/namespace/namespace.h"
 #include "tools/logger.h"
 
@@ -46,7 +47,8 @@ void ItemImpl::ModifyField(const IndexedTagsPath &tagsPath, const VariantArray &
 	ser_.Reset();
 	ser_.PutUInt32(0);
 	WrSerializer generatedCjson;
-	std::string_view cjson(pl.Get(0, 0));
+	key_string coldTuple;
+	std::string_view cjson = ColdTuples::Resolve(pl.Type(), std::string_view(pl.Get(0, 0)), coldTuple);
 	if (cjson.empty()) {
 		buildPayloadTuple(&pl, &tagsMatcher_, generatedCjson);
 		cjson = generatedCjson.Slice();
@@ -69,8 +71,7 @@ void ItemImpl::ModifyField(const IndexedTagsPath &tagsPath, const VariantArray &
 	}
 	if (!err.ok()) throw Error(errLogic, "Error modifying field value: '%s'", err.what());
 
-	tupleData_ = ser_.DetachLStr();
-	pl.Set(0, {Variant(p_string(reinterpret_cast<l_string_hdr *>(tupleData_.get())))});
+	setTuple(pl);
 }
 
 void ItemImpl::SetField(std::string_view jsonPath, const VariantArray &keys, IndexExpressionEvaluator ev) {
@@ -80,6 +81,31 @@ void ItemImpl::DropField(std::string_view jsonPath, IndexExpressionEvaluator ev)
 Variant ItemImpl::GetField(int field) { return GetPayload().Get(field, 0); }
 void ItemImpl::GetField(int field, VariantArray &values) { GetPayload().Get(field, values); }
 
+void ItemImpl::setTuple(Payload &pl) {
+	const size_t len = ser_.Len();
+	if (!tupleData_ || tupleDataCap_ < len) {
+		tupleData_.reset(new uint8_t[len]);
+		tupleDataCap_ = len;
+	}
+	memcpy(tupleData_.get(), ser_.Buf(), len);
+	auto tuple = reinterpret_cast<l_string_hdr *>(tupleData_.get());
+	tuple->length = len - sizeof(uint32_t);
+	pl.Set(0, {Variant(p_string(tuple))});
+}
+
+std::string_view ItemImpl::copySourceData(std::string_view data) {
+	if (!sourceData_ || sourceDataCap_ < data.size()) {
+		// Source data may be the part of the current buffer, so it is replaced after the copying
+		std::unique_ptr<char[]> buf(new char[data.size()]);
+		std::copy(data.begin(), data.end(), buf.get());
+		sourceData_ = std::move(buf);
+		sourceDataCap_ = data.size();
+	} else {
+		memmove(sourceData_.get(), data.data(), data.size());
+	}
+	return std::string_view(sourceData_.get(), data.size());
+}
+
 Error ItemImpl::FromMsgPack(std::string_view buf, size_t &offset) {
 	Payload pl = GetPayload();
 	if (!msgPackDecoder_) {
@@ -90,8 +116,7 @@ Error ItemImpl::FromMsgPack(std::string_view buf, size_t &offset) {
 	ser_.PutUInt32(0);
 	Error err = msgPackDecoder_->Decode(buf, &pl, ser_, offset);
 	if (err.ok()) {
-		tupleData_ = ser_.DetachLStr();
-		pl.Set(0, {Variant(p_string(reinterpret_cast<l_string_hdr *>(tupleData_.get())))});
+		setTuple(pl);
 	}
 	return err;
 }
@@ -105,8 +130,7 @@ Error ItemImpl::FromProtobuf(std::string_view buf) {
 	ser_.PutUInt32(0);
 	Error err = decoder.Decode(buf, &pl, ser_);
 	if (err.ok()) {
-		tupleData_ = ser_.DetachLStr();
-		pl.Set(0, {Variant(p_string(reinterpret_cast<l_string_hdr *>(tupleData_.get())))});
+		setTuple(pl);
 	}
 	return err;
 }
@@ -137,9 +161,7 @@ Error ItemImpl::FromCJSON(std::string_view slice, bool pkOnly) {
 	GetPayload().Reset();
 	std::string_view data = slice;
 	if (!unsafe_) {
-		sourceData_.reset(new char[slice.size()]);
-		std::copy(data.begin(), data.end(), sourceData_.get());
-		data = std::string_view(sourceData_.get(), data.size());
+		data = copySourceData(data);
 	}
 
 	// check tags matcher update
@@ -170,8 +192,7 @@ Error ItemImpl::FromCJSON(std::string_view slice, bool pkOnly) {
 
 	if (err.ok() && !rdser.Eof()) return Error(errParseJson, "Internal error - left unparsed data %d", rdser.Pos());
 
-	tupleData_ = ser_.DetachLStr();
-	pl.Set(0, {Variant(p_string(reinterpret_cast<l_string_hdr *>(tupleData_.get())))});
+	setTuple(pl);
 	return err;
 }
 
@@ -186,16 +207,12 @@ Error ItemImpl::FromJSON(std::string_view slice, char **endp, bool pkOnly) {
 				gason::JsonParser parser;
 				parser.Parse(data, &len);
 				*endp = const_cast<char *>(data.data()) + len;
-				sourceData_.reset(new char[len]);
-				std::copy(data.begin(), data.begin() + len, sourceData_.get());
-				data = std::string_view(sourceData_.get(), len);
+				data = copySourceData(data.substr(0, len));
 			} catch (const gason::Exception &e) {
 				return Error(errParseJson, "Error parsing json: '%s'", e.what());
 			}
 		} else {
-			sourceData_.reset(new char[slice.size()]);
-			std::copy(data.begin(), data.end(), sourceData_.get());
-			data = std::string_view(sourceData_.get(), data.size());
+			data = copySourceData(data);
 		}
 	}
 
@@ -219,8 +236,7 @@ Error ItemImpl::FromJSON(std::string_view slice, char **endp, bool pkOnly) {
 	auto err = decoder.Decode(&pl, ser_, value);
 
 	// Put tuple to field[0]
-	tupleData_ = ser_.DetachLStr();
-	pl.Set(0, {Variant(p_string(reinterpret_cast<l_string_hdr *>(tupleData_.get())))});
+	setTuple(pl);
 	return err;
 }
 
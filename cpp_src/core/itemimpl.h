@@ -25,6 +25,9 @@ struct ItemImplRawData {
 	PayloadValue payloadValue_;
 	std::unique_ptr<uint8_t[]> tupleData_;
 	std::unique_ptr<char[]> sourceData_;
+	// Capacities of the tuple and source data buffers. Buffers are reused by the next decodes of the item
+	size_t tupleDataCap_ = 0;
+	size_t sourceDataCap_ = 0;
 	vector<string> precepts_;
 	std::unique_ptr<std::deque<std::string>> holder_;
 	std::unique_ptr<std::vector<key_string>> keyStringsHolder_;
@@ -35,6 +38,9 @@ class Schema;
 
 class ItemImpl : public ItemImplRawData {
 public:
+	// Max capacity of the buffer, which is kept by the cleared item, returned to the namespace items pool
+	static constexpr size_t kMaxPooledBufferSize = 0x1000;
+
 	ItemImpl() = default;
 
 	// Construct empty item
@@ -110,11 +116,21 @@ public:
 		tagsMatcher_ = TagsMatcher();
 		precepts_.clear();
 		cjson_ = std::string_view();
-		holder_.reset();
-		keyStringsHolder_.reset();
-		sourceData_.reset();
-		tupleData_.reset();
-		ser_ = WrSerializer();
+		if (holder_) holder_->clear();
+		if (keyStringsHolder_) keyStringsHolder_->clear();
+		if (sourceDataCap_ > kMaxPooledBufferSize) {
+			sourceData_.reset();
+			sourceDataCap_ = 0;
+		}
+		if (tupleDataCap_ > kMaxPooledBufferSize) {
+			tupleData_.reset();
+			tupleDataCap_ = 0;
+		}
+		if (ser_.Cap() > kMaxPooledBufferSize) {
+			ser_ = WrSerializer();
+		} else {
+			ser_.Reset();
+		}
 
 		GetPayload().Reset();
 		payloadValue_.SetLSN(-1);
@@ -127,6 +143,11 @@ public:
 	std::shared_ptr<Namespace> GetNamespace() { return ns_; }
 
 protected:
+	// Copies tuple from ser_ to the tuple buffer and sets it to the payload
+	void setTuple(Payload &pl);
+	// Copies source data to the source data buffer
+	std::string_view copySourceData(std::string_view data);
+
 	// Index fields payload data
 	PayloadType payloadType_;
 	PayloadValue realValue_;
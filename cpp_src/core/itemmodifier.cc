@@ -1,12 +1,14 @@
 #include "itemmodifier.h"
+#include <thread>
 #include "core/namespace/namespaceimpl.h"
-#include "core/query/expressionevaluator.h"
-#include "core/selectfunc/functionexecutor.h"
 #include "index/index.h"
 #include "tools/logger.h"
 
 namespace reindexer {
 
+// Minimum count of the items, which are prepared by the single worker
+constexpr size_t kMinPrepareTuplesPartSize = 1024;
+
 ItemModifier::FieldData::FieldData(const UpdateEntry &entry, NamespaceImpl &ns)
 	: entry_(entry), tagsPath_(), fieldIndex_(0), arrayIndex_(IndexValueType::NotSet), isIndex_(false) {
 	if (ns.getIndexByName(entry_.column, fieldIndex_)) {
@@ -46,45 +48,202 @@ void ItemModifier::FieldData::updateTagsPath(TagsMatcher &tm, const IndexExpress
 	}
 }
 
-ItemModifier::ItemModifier(const h_vector<UpdateEntry, 0> &updateEntries, NamespaceImpl &ns) : ns_(ns), updateEntries_(updateEntries) {
+const CompiledExpression &ItemModifier::FieldData::expression(ExpressionEvaluator &ev) {
+	if (expression_.Empty()) {
+		assertrx(entry_.values.size() > 0);
+		expression_ = ev.Compile(static_cast<std::string_view>(entry_.values.front()));
+	}
+	return expression_;
+}
+
+const CompiledExpression &ItemModifier::FieldData::indexExpression(std::string_view expr, ExpressionEvaluator &ev) {
+	for (const auto &compiled : indexExpressions_) {
+		if (compiled.first == expr) return compiled.second;
+	}
+	indexExpressions_.emplace_back(string(expr), ev.Compile(expr));
+	return indexExpressions_.back().second;
+}
+
+bool ItemModifier::FieldData::isConstant() const noexcept {
+	if (isIndex_ || entry_.isExpression || entry_.mode == FieldModeSetJson) return false;
+	// Array indexes of the path have to be the numbers or '*', not the expressions
+	const std::string_view column = entry_.column;
+	for (size_t open = column.find('['); open != std::string_view::npos; open = column.find('[', open + 1)) {
+		const size_t close = column.find(']', open);
+		if (close == std::string_view::npos) return false;
+		const std::string_view index = column.substr(open + 1, close - open - 1);
+		if (index == "*") continue;
+		if (index.empty() || !std::all_of(index.begin(), index.end(), [](char c) { return c >= '0' && c <= '9'; })) return false;
+	}
+	return true;
+}
+
+ItemModifier::ItemModifier(const h_vector<UpdateEntry, 0> &updateEntries, NamespaceImpl &ns)
+	: ns_(ns), updateEntries_(updateEntries), funcExecutor_(ns), ev_(ns.payloadType_, ns.tagsMatcher_, funcExecutor_) {
 	for (const UpdateEntry &updateField : updateEntries_) {
 		fieldsToModify_.emplace_back(updateField, ns_);
 	}
 }
 
+void ItemModifier::PrepareTuples(span<ItemRef> items, int workers) {
+	preparedTuples_.clear();
+	nextPreparedTuple_ = 0;
+	const size_t parts = std::min<size_t>(std::max(workers, 0), items.size() / kMinPrepareTuplesPartSize);
+	if (parts < 2) return;
+	for (const FieldData &field : fieldsToModify_) {
+		if (!field.isConstant()) return;
+	}
+	// Paths are resolved before the workers are started, so the workers do not add the tags into the namespace's tags matcher
+	for (FieldData &field : fieldsToModify_) field.updateTagsPath(ns_.tagsMatcher_, nullptr);
+
+	preparedTuples_.resize(items.size());
+	auto prepare = [this, items](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			auto &prepared = preparedTuples_[i];
+			prepared.first = items[i].Id();
+			// Payload of the namespace is not modified: item gets its private copy
+			PayloadValue pv(ns_.items_[prepared.first]);
+			pv.Clone();
+			ItemImpl item(ns_.payloadType_, pv, ns_.tagsMatcher_);
+			try {
+				for (const FieldData &field : fieldsToModify_) {
+					item.ModifyField(field.tagspath(), field.details().values, field.details().mode);
+				}
+			} catch (const Error &) {
+				// Error is reported by the regular modification of the item
+				continue;
+			}
+			if (item.tagsMatcher().isUpdated()) continue;
+			prepared.second = make_key_string(std::string_view(item.GetField(0)));
+		}
+	};
+
+	const size_t partSize = (items.size() + parts - 1) / parts;
+	std::vector<std::thread> threads;
+	std::vector<std::exception_ptr> errors(parts);
+	threads.reserve(parts - 1);
+	for (size_t i = 1; i < parts; ++i) {
+		threads.emplace_back([&prepare, &error = errors[i], begin = std::min(items.size(), partSize * i), partSize, &items] {
+			try {
+				prepare(begin, std::min(items.size(), begin + partSize));
+			} catch (...) {
+				error = std::current_exception();
+			}
+		});
+	}
+	try {
+		prepare(0, std::min(items.size(), partSize));
+	} catch (...) {
+		errors[0] = std::current_exception();
+	}
+	for (auto &t : threads) t.join();
+	for (auto &error : errors) {
+		if (error) {
+			preparedTuples_.clear();
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+bool ItemModifier::applyPreparedTuple(IdType itemId, Payload &pl, const NsContext &ctx) {
+	if (nextPreparedTuple_ >= preparedTuples_.size() || preparedTuples_[nextPreparedTuple_].first != itemId) return false;
+	const key_string &tuple = preparedTuples_[nextPreparedTuple_++].second;
+	if (!tuple) return false;
+
+	auto strHolder = ns_.StrHolder(ctx);
+	auto indexesCacheCleaner{ns_.GetIndexesCacheCleaner()};
+	h_vector<bool, 32> needUpdateCompIndexes(ns_.indexes_.compositeIndexesSize(), false);
+	for (int i = ns_.indexes_.firstCompositePos(); i < ns_.indexes_.totalSize(); ++i) {
+		for (const FieldData &field : fieldsToModify_) {
+			if (affectsCompositeIndex(field, i)) {
+				needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()] = true;
+				break;
+			}
+		}
+		if (!needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()]) continue;
+		bool needClearCache{false};
+		ns_.indexes_[i]->Delete(Variant(ns_.items_[itemId]), itemId, *strHolder, needClearCache);
+		if (needClearCache && ns_.indexes_[i]->IsOrdered()) indexesCacheCleaner.Add(ns_.indexes_[i]->SortId());
+	}
+
+	Variant oldTupleValue = pl.Get(0, 0);
+	oldTupleValue.EnsureHold();
+	bool needClearCache{false};
+	ns_.indexes_[0]->Delete(oldTupleValue, itemId, *strHolder, needClearCache);
+	Variant tupleValue = ns_.indexes_[0]->Upsert(Variant(tuple), itemId, needClearCache);
+	if (needClearCache && ns_.indexes_[0]->IsOrdered()) indexesCacheCleaner.Add(ns_.indexes_[0]->SortId());
+	pl.Set(0, {tupleValue});
+
+	for (int i = ns_.indexes_.firstCompositePos(); i < ns_.indexes_.totalSize(); ++i) {
+		if (!needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()]) continue;
+		bool needClearCache{false};
+		ns_.indexes_[i]->Upsert(Variant(ns_.items_[itemId]), itemId, needClearCache);
+		if (needClearCache && ns_.indexes_[i]->IsOrdered()) indexesCacheCleaner.Add(ns_.indexes_[i]->SortId());
+	}
+	return true;
+}
+
+bool ItemModifier::affectsCompositeIndex(const FieldData &field, int idx) const {
+	const auto &fields = ns_.indexes_[idx]->Fields();
+	for (const auto f : fields) {
+		if (f == IndexValueType::SetByJsonPath) continue;
+		if (f == field.index()) return true;
+	}
+	for (size_t tp = 0, end = fields.getTagsPathsLength(); tp < end; ++tp) {
+		if (field.tagspath().Compare(fields.getTagsPath(tp))) return true;
+	}
+	return false;
+}
+
 void ItemModifier::Modify(IdType itemId, const NsContext &ctx) {
 	assertrx(ctx.noLock);
-	PayloadValue &pv = ns_.items_[itemId];
+	PayloadValue &pv = ns_.items_.Mutable(itemId);
 	Payload pl(ns_.payloadType_, pv);
+	ns_.pathsIndex_.Remove(itemId, ns_.payloadType_, pv);
 	pv.Clone(pl.RealSize());
 
-	FunctionExecutor funcExecutor(ns_);
-	ExpressionEvaluator ev(ns_.payloadType_, ns_.tagsMatcher_, funcExecutor);
+	try {
+		if (!applyPreparedTuple(itemId, pl, ctx)) {
+			for (FieldData &field : fieldsToModify_) {
+				VariantArray values;
+				if (field.details().isExpression) {
+					values = ev_.Evaluate(field.expression(ev_), pv, field.name());
+				} else {
+					values = field.details().values;
+				}
 
-	for (FieldData &field : fieldsToModify_) {
-		VariantArray values;
-		if (field.details().isExpression) {
-			assertrx(field.details().values.size() > 0);
-			values = ev.Evaluate(static_cast<std::string_view>(field.details().values.front()), pv, field.name());
-		} else {
-			values = field.details().values;
-		}
+				field.updateTagsPath(ns_.tagsMatcher_, [this, &pv, &field](std::string_view expression) {
+					return ev_.Evaluate(field.indexExpression(expression, ev_), pv, field.name());
+				});
 
-		field.updateTagsPath(ns_.tagsMatcher_,
-							 [&ev, &pv, &field](std::string_view expression) { return ev.Evaluate(expression, pv, field.name()); });
+				if (field.details().mode == FieldModeSetJson) {
+					modifyCJSON(pv, itemId, field, values, ctx);
+				} else {
+					modifyField(itemId, field, pl, values, ctx);
+				}
+			}
+		}
+	} catch (...) {
+		// Fields, which are modified before the error, stay modified
+		ns_.pathsIndex_.Add(itemId, ns_.payloadType_, ns_.items_[itemId]);
+		throw;
+	}
+	ns_.pathsIndex_.Add(itemId, ns_.payloadType_, ns_.items_[itemId]);
 
+	ns_.updatedFields_.set(0);
+	for (const FieldData &field : fieldsToModify_) {
 		if (field.details().mode == FieldModeSetJson) {
-			modifyCJSON(pv, itemId, field, values, ctx);
-		} else {
-			modifyField(itemId, field, pl, values, ctx);
+			// Object may contain any indexed fields
+			ns_.updatedFields_.set();
+		} else if (field.isIndex() && field.index() >= 0 && field.index() < ns_.indexes_.firstCompositePos()) {
+			ns_.updatedFields_.set(field.index());
 		}
 	}
-
 	ns_.markUpdated(false);
 }
 
 void ItemModifier::modifyCJSON(PayloadValue &pv, IdType id, FieldData &field, VariantArray &values, const NsContext &ctx) {
-	PayloadValue &plData = ns_.items_[id];
+	PayloadValue &plData = ns_.items_.Mutable(id);
 	Payload pl(ns_.payloadType_, plData);
 	VariantArray cjsonKref;
 	pl.Get(0, cjsonKref);
@@ -114,23 +273,8 @@ void ItemModifier::modifyCJSON(PayloadValue &pv, IdType id, FieldData &field, Va
 	auto indexesCacheCleaner{ns_.GetIndexesCacheCleaner()};
 	h_vector<bool, 32> needUpdateCompIndexes(ns_.indexes_.compositeIndexesSize(), false);
 	for (int i = ns_.indexes_.firstCompositePos(); i < ns_.indexes_.totalSize(); ++i) {
-		const auto &fields = ns_.indexes_[i]->Fields();
-		for (const auto f : fields) {
-			if (f == IndexValueType::SetByJsonPath) continue;
-			if (f == field.index()) {
-				needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()] = true;
-				break;
-			}
-		}
-		if (!needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()]) {
-			for (size_t tp = 0, end = fields.getTagsPathsLength(); tp < end; ++tp) {
-				if (field.tagspath().Compare(fields.getTagsPath(tp))) {
-					needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()] = true;
-					break;
-				}
-			}
-			if (!needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()]) continue;
-		}
+		if (!affectsCompositeIndex(field, i)) continue;
+		needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()] = true;
 		bool needClearCache{false};
 		ns_.indexes_[i]->Delete(Variant(plData), id, *strHolder, needClearCache);
 		if (needClearCache && ns_.indexes_[i]->IsOrdered()) indexesCacheCleaner.Add(ns_.indexes_[i]->SortId());
@@ -175,6 +319,7 @@ void ItemModifier::modifyCJSON(PayloadValue &pv, IdType id, FieldData &field, Va
 				pl.Get(fieldIdx, ns_.krefs, index.Opts().IsArray());
 			}
 			if (ns_.krefs == ns_.skrefs) continue;
+			ns_.materializedAggregations_.Remove(fieldIdx, ns_.krefs);
 			bool needClearCache{false};
 			index.Delete(ns_.krefs, id, *strHolder, needClearCache);
 			if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
@@ -184,6 +329,7 @@ void ItemModifier::modifyCJSON(PayloadValue &pv, IdType id, FieldData &field, Va
 		bool needClearCache{false};
 		index.Upsert(ns_.krefs, ns_.skrefs, id, needClearCache);
 		if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
+		ns_.materializedAggregations_.Add(fieldIdx, ns_.krefs);
 
 		if (!isIndexSparse) {
 			pl.Set(fieldIdx, ns_.krefs);
@@ -221,27 +367,20 @@ void ItemModifier::modifyField(IdType itemId, FieldData &field, Payload &pl, Var
 		for (const Variant &key : values) key.EnsureUTF8();
 	}
 
+	if (field.isIndex() && !index.Opts().IsSparse() && !index.Opts().IsArray() && field.details().mode == FieldModeSet &&
+		values.size() == 1 && !values.IsArrayValue() && ns_.skrefs.size() == 1) {
+		// Scalar index field is not changed (i.e. flag is set again), so neither indexes, nor tuple are touched
+		Variant newValue = values.front();
+		newValue.convert(index.KeyType());
+		if (newValue == ns_.skrefs.front()) return;
+	}
+
 	auto strHolder = ns_.StrHolder(ctx);
 	auto indexesCacheCleaner{ns_.GetIndexesCacheCleaner()};
 	h_vector<bool, 32> needUpdateCompIndexes(ns_.indexes_.compositeIndexesSize(), false);
 	for (int i = ns_.indexes_.firstCompositePos(); i < ns_.indexes_.totalSize(); ++i) {
-		const auto &fields = ns_.indexes_[i]->Fields();
-		for (const auto f : fields) {
-			if (f == IndexValueType::SetByJsonPath) continue;
-			if (f == field.index()) {
-				needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()] = true;
-				break;
-			}
-		}
-		if (!needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()]) {
-			for (size_t tp = 0, end = fields.getTagsPathsLength(); tp < end; ++tp) {
-				if (field.tagspath().Compare(fields.getTagsPath(tp))) {
-					needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()] = true;
-					break;
-				}
-			}
-			if (!needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()]) continue;
-		}
+		if (!affectsCompositeIndex(field, i)) continue;
+		needUpdateCompIndexes[i - ns_.indexes_.firstCompositePos()] = true;
 		bool needClearCache{false};
 		ns_.indexes_[i]->Delete(Variant(ns_.items_[itemId]), itemId, *strHolder, needClearCache);
 		if (needClearCache && ns_.indexes_[i]->IsOrdered()) indexesCacheCleaner.Add(ns_.indexes_[i]->SortId());
@@ -283,6 +422,13 @@ void ItemModifier::modifyIndexValues(IdType itemId, const FieldData &field, Vari
 	}
 	auto strHolder = ns_.StrHolder(ctx);
 	auto indexesCacheCleaner{ns_.GetIndexesCacheCleaner()};
+	// Values of the materialized aggregations are replaced, when the payload is successfully modified
+	VariantArray materializedKeys;
+	const bool materialized = ns_.materializedAggregations_.Has(field.index());
+	if (materialized) {
+		pl.Get(field.index(), materializedKeys, index.Opts().IsArray());
+		for (Variant &key : materializedKeys) key.EnsureHold();
+	}
 	if (index.Opts().IsArray() && !values.IsArrayValue() && !values.IsNullValue()) {
 		if (values.empty()) {
 			throw Error(errParams, "Cannot update array item with an empty value");
@@ -330,23 +476,28 @@ void ItemModifier::modifyIndexValues(IdType itemId, const FieldData &field, Vari
 		if (index.Opts().IsArray() && !index.Opts().IsSparse()) {
 			pl.Get(field.index(), ns_.skrefs, true);
 		}
-		if (!ns_.skrefs.empty()) {
-			bool needClearCache{false};
-			index.Delete(ns_.skrefs, itemId, *strHolder, needClearCache);
-			if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
-		}
-		ns_.krefs.resize(0);
-		ns_.krefs.reserve(values.size());
 		for (Variant &key : values) {
 			key.convert(index.KeyType());
 		}
 		bool needClearCache{false};
-		index.Upsert(ns_.krefs, values, itemId, needClearCache);
+		if (!ns_.skrefs.empty()) {
+			index.Update(ns_.skrefs, values, itemId, *strHolder, needClearCache);
+			std::swap(ns_.krefs, ns_.skrefs);
+		} else {
+			ns_.krefs.resize(0);
+			ns_.krefs.reserve(values.size());
+			index.Upsert(ns_.krefs, values, itemId, needClearCache);
+		}
 		if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
 		if (!index.Opts().IsSparse()) {
 			pl.Set(field.index(), ns_.krefs);
 		}
 	}
+	if (materialized) {
+		ns_.materializedAggregations_.Remove(field.index(), materializedKeys);
+		pl.Get(field.index(), materializedKeys, index.Opts().IsArray());
+		ns_.materializedAggregations_.Add(field.index(), materializedKeys);
+	}
 }
 
 }  // namespace reindexer
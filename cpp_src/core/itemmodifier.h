@@ -2,14 +2,16 @@
 
 #include "core/keyvalue/p_string.h"
 #include "core/payload/payloadiface.h"
+#include "core/queryresults/itemref.h"
+#include "core/query/expressionevaluator.h"
 #include "core/query/query.h"
+#include "core/selectfunc/functionexecutor.h"
 #include "estl/h_vector.h"
 
 namespace reindexer {
 
 struct NsContext;
 class NamespaceImpl;
-class ExpressionEvaluator;
 
 class ItemModifier {
 public:
@@ -19,6 +21,10 @@ public:
 	ItemModifier(ItemModifier &&) = delete;
 	ItemModifier &operator=(ItemModifier &&) = delete;
 
+	/// Builds the modified tuples of the items by the several threads, so Modify only replaces them in the namespace. Tuples are
+	/// prepared only if the query sets the non-indexed fields by the constant values, i.e. they do not depend on the indexes.
+	/// Items have to be modified in the same order after the call
+	void PrepareTuples(span<ItemRef> items, int workers);
 	void Modify(IdType itemId, const NsContext &ctx);
 
 private:
@@ -32,10 +38,17 @@ private:
 		bool isIndex() const noexcept { return isIndex_; }
 		const string &name() const noexcept { return entry_.column; }
 		const string &jsonpath() const noexcept { return jsonPath_; }
+		// Expressions are compiled on the first use, so the errors in them are not reported, if the query does not match any items
+		const CompiledExpression &expression(ExpressionEvaluator &ev);
+		const CompiledExpression &indexExpression(std::string_view expr, ExpressionEvaluator &ev);
+		// Field is modified the same way for all the items
+		bool isConstant() const noexcept;
 
 	private:
 		const UpdateEntry &entry_;
 		IndexedTagsPath tagsPath_;
+		CompiledExpression expression_;
+		std::vector<std::pair<string, CompiledExpression>> indexExpressions_;
 		string jsonPath_;
 		int fieldIndex_;
 		int arrayIndex_;
@@ -60,6 +73,8 @@ private:
 		std::string_view cjson_;
 	};
 
+	bool applyPreparedTuple(IdType itemId, Payload &pl, const NsContext &);
+	bool affectsCompositeIndex(const FieldData &field, int idx) const;
 	void modifyField(IdType itemId, FieldData &field, Payload &pl, VariantArray &values, const NsContext &);
 	void modifyCJSON(PayloadValue &pv, IdType itemId, FieldData &field, VariantArray &values, const NsContext &);
 	void modifyIndexValues(IdType itemId, const FieldData &field, VariantArray &values, Payload &pl, const NsContext &);
@@ -68,6 +83,11 @@ private:
 	const h_vector<UpdateEntry, 0> &updateEntries_;
 	vector<FieldData> fieldsToModify_;
 	CJsonCache cjsonCache_;
+	// Tuples, built by PrepareTuples, in the order of the items. Empty tuple means, that the item has to be modified as usual
+	std::vector<std::pair<IdType, key_string>> preparedTuples_;
+	size_t nextPreparedTuple_ = 0;
+	FunctionExecutor funcExecutor_;
+	ExpressionEvaluator ev_;
 };
 
 }  // namespace reindexer
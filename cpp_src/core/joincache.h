@@ -1,52 +1,45 @@
 #pragma once
 
+#include <bitset>
 #include "core/idset.h"
 #include "core/keyvalue/variant.h"
 #include "core/lrucache.h"
+#include "core/payload/fieldsset.h"
 #include "core/query/query.h"
+#include "core/querycache.h"
 #include "tools/serializer.h"
 #include "vendor/murmurhash/MurmurHash3.h"
 namespace reindexer {
 
+/// Key of the join cache by the joined query or by the pair of the queries. Like QueryCacheKey, it refers to the queries until it's
+/// copied to the cache
 struct JoinCacheKey {
-	JoinCacheKey() {}
-	JoinCacheKey(const JoinCacheKey &other) {
-		if (this != &other) {
-			buf_ = other.buf_;
-		}
-	}
-	void SetData(const Query &q) {
-		WrSerializer ser;
-		q.Serialize(ser, (SkipJoinQueries | SkipMergeQueries));
-		buf_.reserve(buf_.size() + ser.Len());
-		buf_.insert(buf_.end(), ser.Buf(), ser.Buf() + ser.Len());
-	}
+	static constexpr uint8_t kMode = SkipJoinQueries | SkipMergeQueries;
+
+	void SetData(const Query &q) { first_ = QueryCacheKey(q, kMode); }
 	void SetData(const Query &q1, const Query &q2) {
-		WrSerializer ser;
-		q1.Serialize(ser, (SkipJoinQueries | SkipMergeQueries));
-		q2.Serialize(ser, (SkipJoinQueries | SkipMergeQueries));
-		buf_.reserve(buf_.size() + ser.Len());
-		buf_.insert(buf_.end(), ser.Buf(), ser.Buf() + ser.Len());
+		first_ = QueryCacheKey(q1, kMode);
+		second_ = QueryCacheKey(q2, kMode);
 	}
-	size_t Size() const { return sizeof(JoinCacheKey) + (buf_.is_hdata() ? 0 : buf_.size()); }
+	size_t Size() const { return sizeof(JoinCacheKey) + first_.Size() + second_.Size() - 2 * sizeof(QueryCacheKey); }
 
-	h_vector<uint8_t, 256> buf_;
+	QueryCacheKey first_;
+	QueryCacheKey second_;
 };
 struct equal_join_cache_key {
 	bool operator()(const JoinCacheKey &lhs, const JoinCacheKey &rhs) const {
-		return (lhs.buf_.size() == rhs.buf_.size() && memcmp(lhs.buf_.data(), rhs.buf_.data(), lhs.buf_.size()) == 0);
+		return lhs.first_ == rhs.first_ && lhs.second_ == rhs.second_;
 	}
 };
 struct hash_join_cache_key {
-	size_t operator()(const JoinCacheKey &cache) const {
-		uint64_t hash[2];
-		MurmurHash3_x64_128(cache.buf_.data(), cache.buf_.size(), 0, &hash);
-		return hash[0];
-	}
+	size_t operator()(const JoinCacheKey &cache) const noexcept { return cache.first_.Hash() ^ (cache.second_.Hash() * 127); }
 };
 
 struct JoinPreResult;
 
+/// Indexes of the right namespace, which the cached value depends on. 0 stands for the tuple, i.e. for the non-indexed fields
+using JoinCacheFields = std::bitset<maxIndexes>;
+
 struct JoinCacheVal {
 	JoinCacheVal() {}
 	size_t Size() const { return ids_ ? sizeof(*ids_.get()) + ids_->heap_size() : 0; }
@@ -54,6 +47,8 @@ struct JoinCacheVal {
 	bool matchedAtLeastOnce = false;
 	bool inited = false;
 	std::shared_ptr<JoinPreResult> preResult;
+	// Value survives the updates of the existing items, which don't change these indexes
+	JoinCacheFields fields;
 };
 typedef LRUCache<JoinCacheKey, JoinCacheVal, hash_join_cache_key, equal_join_cache_key> MainLruCache;
 
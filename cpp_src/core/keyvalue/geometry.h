@@ -61,6 +61,17 @@ inline bool DWithin(const Rectangle& r, Point p, double distance) noexcept {
 		   DWithin(Point{r.Right(), r.Bottom()}, p, distance) && DWithin(Point{r.Right(), r.Top()}, p, distance);
 }
 
+inline double squaredDistance(Point lhs, Point rhs) noexcept {
+	return (lhs.x - rhs.x) * (lhs.x - rhs.x) + (lhs.y - rhs.y) * (lhs.y - rhs.y);
+}
+
+/// Squared distance from the point to the nearest point of the rectangle. It is 0, if the rectangle contains the point
+inline double squaredDistance(const Rectangle& r, Point p) noexcept {
+	const double dx = std::max({r.Left() - p.x, 0.0, p.x - r.Right()});
+	const double dy = std::max({r.Bottom() - p.y, 0.0, p.y - r.Top()});
+	return dx * dx + dy * dy;
+}
+
 inline Rectangle boundRect(Point p) noexcept { return {p.x, p.x, p.y, p.y}; }
 
 inline Rectangle boundRect(const Rectangle& r1, const Rectangle& r2) noexcept {
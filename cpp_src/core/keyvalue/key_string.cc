@@ -0,0 +1,167 @@
+#include "key_string.h"
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace reindexer {
+
+#ifndef REINDEX_WITH_ASAN
+namespace {
+
+// Key strings are the most numerous small objects of the namespace: distinct values of the string indexes and strings of the items
+// payloads. They have the same size, so they are allocated from the large slabs without the per object overhead of the allocator.
+// Freed slots are linked into the free list of their slab and reused by the next allocations. Slots are taken from the slabs with
+// the lowest addresses, so the other slabs are drained and the completely free ones are returned to the allocator
+class KeyStringSlabs {
+public:
+	static constexpr size_t kSlotSize = sizeof(intrusive_atomic_rc_wrapper<base_key_string>);
+	static constexpr size_t kSlotsPerSlab = 4096;
+	// Count of the slots, which are moved between the thread cache and the shared free list at once
+	static constexpr size_t kTransferBatch = 256;
+	// Count of the completely free slabs, which are kept for the next allocations
+	static constexpr size_t kMaxFreeSlabs = 1;
+
+	static KeyStringSlabs &Instance() {
+		// Never destroyed, because the strings may be released by destructors of the other static objects
+		static KeyStringSlabs *instance = new KeyStringSlabs;
+		return *instance;
+	}
+
+	void Take(std::vector<void *> &dst) {
+		std::lock_guard<std::mutex> lck(mtx_);
+		for (size_t i = 0; i < kTransferBatch; ++i) dst.push_back(take());
+	}
+	void *TakeOne() {
+		std::lock_guard<std::mutex> lck(mtx_);
+		return take();
+	}
+	void Put(void *const *begin, void *const *end) {
+		std::lock_guard<std::mutex> lck(mtx_);
+		for (; begin != end; ++begin) put(*begin);
+	}
+	size_t SlabsCount() {
+		std::lock_guard<std::mutex> lck(mtx_);
+		return slabs_.size();
+	}
+
+private:
+	static_assert(kSlotSize >= sizeof(void *), "Free slot has to hold the pointer to the next one");
+
+	struct Slab {
+		void *freeHead;
+		size_t freeCount;
+	};
+
+	void *take() {
+		if (available_.empty()) allocateSlab();
+		const auto it = available_.begin();
+		Slab &slab = slabs_.find(*it)->second;
+		if (slab.freeCount == kSlotsPerSlab) --freeSlabs_;
+		void *ptr = slab.freeHead;
+		memcpy(&slab.freeHead, ptr, sizeof(void *));
+		if (--slab.freeCount == 0) available_.erase(it);
+		return ptr;
+	}
+	void put(void *ptr) {
+		auto it = std::prev(slabs_.upper_bound(static_cast<char *>(ptr)));
+		Slab &slab = it->second;
+		if (slab.freeCount == 0) available_.insert(it->first);
+		memcpy(ptr, &slab.freeHead, sizeof(void *));
+		slab.freeHead = ptr;
+		if (++slab.freeCount < kSlotsPerSlab) return;
+		if (freeSlabs_ < kMaxFreeSlabs) {
+			++freeSlabs_;
+			return;
+		}
+		available_.erase(it->first);
+		::operator delete(it->first);
+		slabs_.erase(it);
+	}
+	void allocateSlab() {
+		char *data = static_cast<char *>(::operator new(kSlotSize * kSlotsPerSlab));
+		for (size_t i = 0; i + 1 < kSlotsPerSlab; ++i) {
+			void *next = data + (i + 1) * kSlotSize;
+			memcpy(data + i * kSlotSize, &next, sizeof(void *));
+		}
+		slabs_.emplace(data, Slab{data, kSlotsPerSlab});
+		available_.insert(data);
+		++freeSlabs_;
+	}
+
+	std::mutex mtx_;
+	// Slabs by their addresses
+	std::map<char *, Slab> slabs_;
+	// Slabs with the free slots
+	std::set<char *> available_;
+	size_t freeSlabs_ = 0;
+};
+
+// Thread local cache of the free slots, so the shared free list is locked once per kTransferBatch allocations
+class KeyStringsThreadCache {
+public:
+	enum State { NotCreated, Alive, Destroyed };
+
+	KeyStringsThreadCache() {
+		// Capacity is never exceeded by Free, so it does not allocate
+		free_.reserve(2 * KeyStringSlabs::kTransferBatch);
+		state_ = Alive;
+	}
+	~KeyStringsThreadCache() {
+		state_ = Destroyed;
+		KeyStringSlabs::Instance().Put(free_.data(), free_.data() + free_.size());
+	}
+
+	void *Allocate() {
+		if (free_.empty()) KeyStringSlabs::Instance().Take(free_);
+		void *ptr = free_.back();
+		free_.pop_back();
+		return ptr;
+	}
+	void Free(void *ptr) {
+		free_.push_back(ptr);
+		if (free_.size() >= 2 * KeyStringSlabs::kTransferBatch) {
+			const auto from = free_.end() - KeyStringSlabs::kTransferBatch;
+			KeyStringSlabs::Instance().Put(&*from, free_.data() + free_.size());
+			free_.erase(from, free_.end());
+		}
+	}
+	// Strings may be allocated and released by the thread local objects, which are destroyed after the cache
+	static State GetState() noexcept { return state_; }
+
+private:
+	std::vector<void *> free_;
+	static thread_local State state_;
+};
+
+thread_local KeyStringsThreadCache::State KeyStringsThreadCache::state_ = KeyStringsThreadCache::NotCreated;
+thread_local KeyStringsThreadCache tlsKeyStringsCache;
+
+}  // namespace
+
+void *base_key_string::operator new(size_t size) {
+	if (size != KeyStringSlabs::kSlotSize) return ::operator new(size);
+	if (KeyStringsThreadCache::GetState() != KeyStringsThreadCache::Destroyed) return tlsKeyStringsCache.Allocate();
+	return KeyStringSlabs::Instance().TakeOne();
+}
+
+void base_key_string::operator delete(void *ptr, size_t size) noexcept {
+	if (size != KeyStringSlabs::kSlotSize) {
+		::operator delete(ptr);
+	} else if (KeyStringsThreadCache::GetState() == KeyStringsThreadCache::Alive) {
+		tlsKeyStringsCache.Free(ptr);
+	} else {
+		KeyStringSlabs::Instance().Put(&ptr, &ptr + 1);
+	}
+}
+
+size_t key_string_slabs_count() { return KeyStringSlabs::Instance().SlabsCount(); }
+#else	// REINDEX_WITH_ASAN
+// Sanitizer has to see each string allocation
+void *base_key_string::operator new(size_t size) { return ::operator new(size); }
+void base_key_string::operator delete(void *ptr, size_t) noexcept { ::operator delete(ptr); }
+size_t key_string_slabs_count() { return 0; }
+#endif	// REINDEX_WITH_ASAN
+
+}  // namespace reindexer
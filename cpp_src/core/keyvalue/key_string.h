@@ -25,6 +25,10 @@ public:
 		const_string::assign(std::forward<Args>(args)...);
 		bind();
 	}
+	// Key strings are allocated from the shared slabs (see key_string.cc)
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr, size_t size) noexcept;
+
 	static ptrdiff_t export_hdr_offset() {
 		static base_key_string sample;
 		return ptrdiff_t(reinterpret_cast<const char *>(&sample.export_hdr_) - reinterpret_cast<const char *>(&sample));
@@ -84,6 +88,9 @@ key_string make_key_string(Args &&...args) {
 
 inline static bool operator==(const key_string &rhs, const key_string &lhs) { return *rhs == *lhs; }
 
+// Count of the slabs, which the key strings are allocated from. Completely free slabs are returned to the allocator (see key_string.cc)
+size_t key_string_slabs_count();
+
 // Unckecked cast to derived class!
 // It assumes, that all strings in payload are intrusive_ptr and stored with intrusive_atomic_rc_wrapper
 inline void key_string_add_ref(string *str) {
@@ -409,6 +409,50 @@ size_t Variant::Hash() const {
 	}
 }
 
+bool Variant::IsStrictlyEqual(const Variant &other) const {
+	if (type_ != other.type_) return false;
+	switch (type_) {
+		case KeyValueInt:
+		case KeyValueBool:
+		case KeyValueInt64:
+		case KeyValueString:
+			return Compare(other) == 0;
+		case KeyValueDouble:
+			return value_double == other.value_double || (std::isnan(value_double) && std::isnan(other.value_double));
+		case KeyValueTuple: {
+			const VariantArray values = getCompositeValues(), otherValues = other.getCompositeValues();
+			if (values.size() != otherValues.size()) return false;
+			for (size_t i = 0; i < values.size(); ++i) {
+				if (!values[i].IsStrictlyEqual(otherValues[i])) return false;
+			}
+			return true;
+		}
+		case KeyValueComposite:
+			return cast<PayloadValue>()->Ptr() == other.cast<PayloadValue>()->Ptr();
+		default:
+			return true;
+	}
+}
+
+size_t Variant::StrictHash() const {
+	switch (type_) {
+		case KeyValueInt:
+		case KeyValueBool:
+		case KeyValueInt64:
+		case KeyValueString:
+			return Hash();
+		case KeyValueDouble:
+			return std::isnan(value_double) ? size_t(type_) : Hash();
+		case KeyValueTuple: {
+			size_t ret = type_;
+			for (const Variant &v : getCompositeValues()) ret = (ret * 127) ^ v.StrictHash();
+			return ret;
+		}
+		default:
+			return type_;
+	}
+}
+
 void Variant::EnsureUTF8() const {
 	if (type_ == KeyValueString) {
 		if (!utf8::is_valid(operator p_string().data(), operator p_string().data() + operator p_string().size())) {
@@ -532,6 +576,14 @@ const char *Variant::TypeName(KeyValueType t) {
 	return "<invalid type>";
 }
 
+Variant Variant::View() const noexcept {
+	if (!hold_ || type_ != KeyValueString) return *this;
+	Variant view;
+	view.type_ = KeyValueString;
+	*view.cast<p_string>() = p_string(*cast<key_string>());
+	return view;
+}
+
 Variant::operator key_string() const {
 	assertKeyType(type_, KeyValueString);
 	if (hold_) {
@@ -625,6 +677,15 @@ VariantArray::operator Point() const {
 	return {(*this)[0].As<double>(), (*this)[1].As<double>()};
 }
 
+VariantArray VariantArray::View() const {
+	VariantArray result;
+	result.reserve(size());
+	for (const Variant &v : *this) result.emplace_back(v.View());
+	result.isArrayValue = isArrayValue;
+	result.isObjectValue = isObjectValue;
+	return result;
+}
+
 int VariantArray::RelaxCompare(const VariantArray &other, const CollateOpts &collateOpts) const {
 	auto lhsIt{cbegin()}, rhsIt{other.cbegin()};
 	auto const lhsEnd{cend()}, rhsEnd{other.cend()};
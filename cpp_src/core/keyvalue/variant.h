@@ -94,8 +94,16 @@ public:
 	int Compare(const Variant &other, const CollateOpts &collateOpts = CollateOpts()) const;
 	int RelaxCompare(const Variant &other, const CollateOpts &collateOpts = CollateOpts()) const;
 	size_t Hash() const;
+	/// Compares the types and the values without the conversions and the collation. Unlike operator==, it's applicable to the values of
+	/// any types and every value is equal to itself (NaN too)
+	bool IsStrictlyEqual(const Variant &other) const;
+	/// Hash, which is consistent with IsStrictlyEqual and is applicable to the values of any types
+	size_t StrictHash() const;
 	void EnsureUTF8() const;
 	Variant &EnsureHold();
+	/// Copy, which refers to the string of this value without the increment of its reference counter, so the copy must not outlive
+	/// this value. Copies of the read paths don't touch the shared counters of the hot keys this way. Composite values are still held
+	Variant View() const noexcept;
 
 	KeyValueType Type() const noexcept { return type_; }
 	static const char *TypeName(KeyValueType t);
@@ -160,6 +168,8 @@ public:
 	template <typename T>
 	void Dump(T &os) const;
 	int RelaxCompare(const VariantArray &other, const CollateOpts & = CollateOpts{}) const;
+	/// Copy of the values by Variant::View
+	VariantArray View() const;
 
 private:
 	bool isArrayValue = false;
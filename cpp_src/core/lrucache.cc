@@ -1,9 +1,12 @@
-
+#include "client/resultscache.h"
 #include "core/ft/ftsetcashe.h"
+#include "core/ft/ftvariantscache.h"
 #include "core/idset.h"
 #include "core/idsetcache.h"
 #include "core/keyvalue/variant.h"
+#include "core/query/preparedquery.h"
 #include "core/querycache.h"
+#include "core/queryresultscache.h"
 #include "joincache.h"
 #include "tools/logger.h"
 
@@ -11,27 +14,43 @@ namespace reindexer {
 
 const int kMaxHitCountToCache = 1024;
 
+template <typename K, typename V, typename hash, typename equal>
+LRUCache<K, V, hash, equal>::LRUCache(size_t sizeLimit, int hitCount, size_t shardsCount, LRUCacheEvictionMode mode)
+	: cacheSizeLimit_(sizeLimit), mode_(mode) {
+	shardsCount = std::max<size_t>(1, std::min(shardsCount, sizeLimit / kMinCacheShardSizeLimit));
+	std::vector<Shard>(shardsCount).swap(shards_);
+	for (auto &shard : shards_) {
+		shard.cacheSizeLimit_ = sizeLimit / shardsCount;
+		shard.hitCountToCache_ = hitCount;
+	}
+}
+
 template <typename K, typename V, typename hash, typename equal>
 typename LRUCache<K, V, hash, equal>::Iterator LRUCache<K, V, hash, equal>::Get(const K &key) {
 	if (cacheSizeLimit_ == 0) return Iterator();
 
-	std::lock_guard<std::mutex> lk(lock_);
-
-	auto it = items_.find(key);
-	if (it == items_.end()) {
-		it = items_.emplace(key, Entry{}).first;
-		totalCacheSize_ += kElemSizeOverhead + sizeof(Entry) + key.Size();
-		it->second.lruPos = lru_.insert(lru_.end(), &it->first);
-		if (!eraseLRU()) return Iterator();
-	} else if (std::next(it->second.lruPos) != lru_.end()) {
-		lru_.splice(lru_.end(), lru_, it->second.lruPos, std::next(it->second.lruPos));
-		it->second.lruPos = std::prev(lru_.end());
+	Shard &shard = shardFor(key);
+	std::lock_guard<std::mutex> lk(shard.lock_);
+
+	auto it = shard.items_.find(key);
+	if (it == shard.items_.end()) {
+		it = shard.items_.emplace(key, Entry{}).first;
+		shard.totalCacheSize_ += kElemSizeOverhead + sizeof(Entry) + key.Size();
+		it->second.lruPos = shard.lru_.insert(shard.lru_.end(), &it->first);
+		if (!eraseLRU(shard, key)) return Iterator();
+		if (mode_ == LRUCacheEvictionMode::Clock) {
+			// Second-chance reordering may have moved older entries behind the new one, so it could be evicted itself
+			it = shard.items_.find(key);
+			if (it == shard.items_.end()) return Iterator();
+		}
+	} else {
+		shard.touch(it->second, mode_);
 	}
 
-	if (++it->second.hitCount < hitCountToCache_) {
+	if (++it->second.hitCount < shard.hitCountToCache_) {
 		return Iterator();
 	}
-	++getCount_;
+	++shard.getCount_;
 
 	// logPrintf(LogInfo, "Cache::Get (cond=%d,sortId=%d,keys=%d), total in cache items=%d,size=%d", key.cond, key.sort,
 	// 		  (int)key.keys.size(), items_.size(), totalCacheSize_);
@@ -42,50 +61,109 @@ template <typename K, typename V, typename hash, typename equal>
 void LRUCache<K, V, hash, equal>::Put(const K &key, const V &v) {
 	if (cacheSizeLimit_ == 0) return;
 
-	std::lock_guard<std::mutex> lk(lock_);
-	auto it = items_.find(key);
-	if (it == items_.end()) return;
+	Shard &shard = shardFor(key);
+	std::lock_guard<std::mutex> lk(shard.lock_);
+	auto it = shard.items_.find(key);
+	if (it == shard.items_.end()) return;
 
-	totalCacheSize_ += v.Size() - it->second.val.Size();
+	shard.totalCacheSize_ += v.Size() - it->second.val.Size();
 	it->second.val = v;
 
 	// logPrintf(LogInfo, "IdSetCache::Put () add %d,left %d,fwdCnt=%d,sz=%d", endIt - begIt, left, it->second.fwdCount,
 	// 		  it->second.ids->size());
-	++putCount_;
+	++shard.putCount_;
 
-	eraseLRU();
+	eraseLRU(shard, key);
 
-	if (eraseCount_ && putCount_ * 16 > getCount_) {
-		logPrintf(LogWarning, "IdSetCache::eraseLRU () cache invalidates too fast eraseCount=%d,putCount=%d,getCount=%d", eraseCount_,
-				  putCount_, eraseCount_);
-		eraseCount_ = 0;
-		hitCountToCache_ = std::min(hitCountToCache_ * 2, kMaxHitCountToCache);
-		putCount_ = 0;
-		getCount_ = 0;
+	if (shard.eraseCount_ && shard.putCount_ * 16 > shard.getCount_) {
+		logPrintf(LogWarning, "IdSetCache::eraseLRU () cache invalidates too fast eraseCount=%d,putCount=%d,getCount=%d", shard.eraseCount_,
+				  shard.putCount_, shard.eraseCount_);
+		shard.eraseCount_ = 0;
+		shard.hitCountToCache_ = std::min(shard.hitCountToCache_ * 2, kMaxHitCountToCache);
+		shard.putCount_ = 0;
+		shard.getCount_ = 0;
 	}
 }
 
 template <typename K, typename V, typename hash, typename equal>
-bool LRUCache<K, V, hash, equal>::eraseLRU() {
+void LRUCache<K, V, hash, equal>::Shard::touch(Entry &entry, LRUCacheEvictionMode mode) {
+	if (mode == LRUCacheEvictionMode::Clock) {
+		entry.referenced = true;
+	} else if (std::next(entry.lruPos) != lru_.end()) {
+		lru_.splice(lru_.end(), lru_, entry.lruPos, std::next(entry.lruPos));
+		entry.lruPos = std::prev(lru_.end());
+	}
+}
+
+template <typename K, typename V, typename hash, typename equal>
+bool LRUCache<K, V, hash, equal>::eraseLRU(Shard &shard, const K &key) {
+	const K *keep = nullptr;
+	if (shards_.size() > 1) {
+		// Entry may be larger than the shard's share of the limit: it's kept, while it fits the whole cache
+		auto it = shard.items_.find(key);
+		if (it != shard.items_.end() &&
+			sizeof(Entry) + kElemSizeOverhead + it->first.Size() + it->second.val.Size() <= cacheSizeLimit_) {
+			keep = &it->first;
+		}
+	}
+	if (!shard.eraseLRU(mode_, shard.cacheSizeLimit_, keep)) return false;
+	if (!keep) return true;
+
+	// Shard, which exceeds its share, is given the space by the other shards. Busy shards are skipped to avoid the lock order
+	// inversion, so the cache may exceed its limit until their next eviction
+	for (auto &other : shards_) {
+		const size_t total = totalSize();
+		if (total <= cacheSizeLimit_) return true;
+		if (&other == &shard) continue;
+		std::unique_lock<std::mutex> lk(other.lock_, std::try_to_lock);
+		if (!lk.owns_lock()) continue;
+		const size_t size = other.totalCacheSize_.load(std::memory_order_relaxed);
+		other.eraseLRU(mode_, size - std::min(size, total - cacheSizeLimit_), nullptr);
+	}
+	const size_t total = totalSize(), size = shard.totalCacheSize_.load(std::memory_order_relaxed);
+	if (total > cacheSizeLimit_) shard.eraseLRU(mode_, size - std::min(size, total - cacheSizeLimit_), keep);
+	return true;
+}
+
+template <typename K, typename V, typename hash, typename equal>
+bool LRUCache<K, V, hash, equal>::Shard::eraseLRU(LRUCacheEvictionMode mode, size_t limit, const K *keep) {
 	typename LRUList::iterator it = lru_.begin();
 
-	while (totalCacheSize_ > cacheSizeLimit_) {
+	while (totalCacheSize_ > limit) {
 		// just to save us if totalCacheSize_ >0 and lru is empty
 		// someone can make bad key or val with wrong size
 		if (lru_.empty()) {
 			clearAll();
-			logPrintf(LogError, "IdSetCache::eraseLRU () Cache restarted because wrong cache size totalCacheSize_=%d", totalCacheSize_);
+			logPrintf(LogError, "IdSetCache::eraseLRU () Cache restarted because wrong cache size totalCacheSize_=%d",
+					  totalCacheSize_.load());
 			return false;
 		}
+		if (it == lru_.end()) break;
+		if (*it == keep) {
+			++it;
+			continue;
+		}
 		auto mIt = items_.find(**it);
 		assertrx(mIt != items_.end());
 
+		if (mode == LRUCacheEvictionMode::Clock && mIt->second.referenced) {
+			// Give the entry a second chance: move it to the tail and clear the reference bit.
+			// Each entry is moved at most once per pass, so the loop is finite
+			mIt->second.referenced = false;
+			auto next = std::next(it);
+			if (next != lru_.end()) {
+				lru_.splice(lru_.end(), lru_, it, next);
+				it = next;
+			}
+			continue;
+		}
+
 		size_t oldSize = sizeof(Entry) + kElemSizeOverhead + mIt->first.Size() + mIt->second.val.Size();
 
 		if (oldSize > totalCacheSize_) {
 			clearAll();
 			logPrintf(LogError, "IdSetCache::eraseLRU () Cache restarted because wrong cache size totalCacheSize_=%d,oldSize=%d",
-					  totalCacheSize_, oldSize);
+					  totalCacheSize_.load(), oldSize);
 			return false;
 		}
 
@@ -93,18 +171,24 @@ bool LRUCache<K, V, hash, equal>::eraseLRU() {
 		items_.erase(mIt);
 		it = lru_.erase(it);
 		++eraseCount_;
+		++evictionsCount_;
 	}
 
 	return !lru_.empty();
 }
+
 template <typename K, typename V, typename hash, typename equal>
 bool LRUCache<K, V, hash, equal>::Clear() {
-	std::lock_guard<std::mutex> lk(lock_);
-	return clearAll();
+	bool res = false;
+	for (auto &shard : shards_) {
+		std::lock_guard<std::mutex> lk(shard.lock_);
+		res = shard.clearAll() || res;
+	}
+	return res;
 }
 
 template <typename K, typename V, typename hash, typename equal>
-bool LRUCache<K, V, hash, equal>::clearAll() {
+bool LRUCache<K, V, hash, equal>::Shard::clearAll() {
 	bool res = !items_.empty();
 	totalCacheSize_ = 0;
 	std::unordered_map<K, Entry, hash, equal>().swap(items_);
@@ -117,21 +201,34 @@ bool LRUCache<K, V, hash, equal>::clearAll() {
 
 template <typename K, typename V, typename hash, typename equal>
 LRUCacheMemStat LRUCache<K, V, hash, equal>::GetMemStat() {
-	std::lock_guard<std::mutex> lk(lock_);
 	LRUCacheMemStat ret;
-	ret.totalSize = totalCacheSize_;
-	ret.itemsCount = items_.size();
-	// for (auto &item : items_) {
-	// 	if (item.second.val.Empty()) ret.emptyCount++;
-	// }
-
-	ret.hitCountLimit = hitCountToCache_;
+	if (shards_.size() > 1) ret.shards.reserve(shards_.size());
+	for (auto &shard : shards_) {
+		std::lock_guard<std::mutex> lk(shard.lock_);
+		ret.totalSize += shard.totalCacheSize_;
+		ret.itemsCount += shard.items_.size();
+		// for (auto &item : items_) {
+		// 	if (item.second.val.Empty()) ret.emptyCount++;
+		// }
+		ret.hitCountLimit = std::max<size_t>(ret.hitCountLimit, shard.hitCountToCache_);
+		if (shards_.size() > 1) {
+			LRUCacheShardMemStat &s = ret.shards.emplace_back();
+			s.totalSize = shard.totalCacheSize_;
+			s.itemsCount = shard.items_.size();
+			s.hitCountLimit = shard.hitCountToCache_;
+			s.evictionsCount = shard.evictionsCount_;
+		}
+	}
 
 	return ret;
 }
 template class LRUCache<IdSetCacheKey, IdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key>;
 template class LRUCache<IdSetCacheKey, FtIdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key>;
 template class LRUCache<QueryCacheKey, QueryCacheVal, HashQueryCacheKey, EqQueryCacheKey>;
+template class LRUCache<QueryCacheKey, QueryResultsCacheVal, HashQueryCacheKey, EqQueryCacheKey>;
 template class LRUCache<JoinCacheKey, JoinCacheVal, hash_join_cache_key, equal_join_cache_key>;
+template class LRUCache<PreparedQueryCacheKey, PreparedQueryCacheVal, HashPreparedQueryCacheKey, EqPreparedQueryCacheKey>;
+template class LRUCache<FtVariantsCacheKey, FtVariantsCacheVal, HashFtVariantsCacheKey, EqFtVariantsCacheKey>;
+template class LRUCache<client::ResultsCacheKey, client::ResultsCacheVal, client::HashResultsCacheKey, client::EqResultsCacheKey>;
 
 }  // namespace reindexer
@@ -4,6 +4,7 @@
 #include <list>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 #include "namespace/namespacestat.h"
 
 namespace reindexer {
@@ -11,12 +12,19 @@ namespace reindexer {
 constexpr size_t kDefaultCacheSizeLimit = 1024 * 1024 * 128;
 constexpr int kDefaultHitCountToCache = 2;
 constexpr size_t kElemSizeOverhead = 256;
+constexpr size_t kDefaultCacheShardsCount = 1;
+// Shards smaller than this are not worth the split: limit per shard would be too small to hold typical idsets
+constexpr size_t kMinCacheShardSizeLimit = 1024 * 1024;
+
+// LRU - every hit moves entry to the tail of the list
+// Clock - hit only marks entry as referenced, list is reordered on eviction (second-chance)
+enum class LRUCacheEvictionMode { LRU, Clock };
 
 template <typename K, typename V, typename hash, typename equal>
 class LRUCache {
 public:
-	LRUCache(size_t sizeLimit = kDefaultCacheSizeLimit, int hitCount = kDefaultHitCountToCache)
-		: totalCacheSize_(0), cacheSizeLimit_(sizeLimit), hitCountToCache_(hitCount) {}
+	LRUCache(size_t sizeLimit = kDefaultCacheSizeLimit, int hitCount = kDefaultHitCountToCache,
+			 size_t shardsCount = kDefaultCacheShardsCount, LRUCacheEvictionMode mode = LRUCacheEvictionMode::LRU);
 	struct Iterator {
 		Iterator(bool k = false, const V &v = V()) : valid(k), val(v) {}
 		Iterator(const Iterator &other) = delete;
@@ -42,83 +50,133 @@ public:
 
 	bool Clear();
 
+	size_t ShardsCount() const noexcept { return shards_.size(); }
+	LRUCacheEvictionMode EvictionMode() const noexcept { return mode_; }
+
 	template <typename T>
 	void Dump(T &os, std::string_view step, std::string_view offset) const {
 		std::string newOffset{offset};
 		newOffset += step;
-		os << "{\n" << newOffset << "totalCacheSize: ";
-		std::lock_guard lock{lock_};
-		os << totalCacheSize_ << ",\n"
-		   << newOffset << "cacheSizeLimit: " << cacheSizeLimit_ << ",\n"
-		   << newOffset << "hitCountToCache: " << hitCountToCache_ << ",\n"
-		   << newOffset << "getCount: " << getCount_ << ",\n"
-		   << newOffset << "putCount: " << putCount_ << ",\n"
-		   << newOffset << "eraseCount: " << eraseCount_ << ",\n"
-		   << newOffset << "items: [";
-		if (!items_.empty()) {
-			for (auto b = items_.begin(), it = b, e = items_.end(); it != e; ++it) {
-				if (it != b) os << ',';
-				os << '\n' << newOffset << '{' << it->first << ": ";
-				it->second.Dump(os);
-				os << '}';
-			}
+		os << "{\n" << newOffset << "shards: [";
+		for (auto b = shards_.begin(), s = b, e = shards_.end(); s != e; ++s) {
+			if (s != b) os << ',';
 			os << '\n' << newOffset;
-		}
-		os << "],\n" << newOffset << "lruList: [";
-		for (auto b = lru_.begin(), it = b, e = lru_.end(); it != e; ++it) {
-			if (it != b) os << ", ";
-			os << **it;
+			s->Dump(os, step, newOffset);
 		}
 		os << "]\n" << offset << '}';
 	}
 
 	template <typename F>
 	void Clear(const F &cond) {
-		std::lock_guard lock{lock_};
-		for (auto it = lru_.begin(); it != lru_.end();) {
-			if (!cond(**it)) {
-				++it;
-				continue;
-			}
-			auto mIt = items_.find(**it);
-			assertrx(mIt != items_.end());
-			const size_t oldSize = sizeof(Entry) + kElemSizeOverhead + mIt->first.Size() + mIt->second.val.Size();
-			if (oldSize > totalCacheSize_) {
-				clearAll();
-				return;
+		EraseIf([&cond](const K &k, const V &) { return cond(k); });
+	}
+	// Erases entries, for which cond(key, value) returns true
+	template <typename F>
+	void EraseIf(const F &cond) {
+		for (auto &shard : shards_) {
+			std::lock_guard lock{shard.lock_};
+			for (auto it = shard.lru_.begin(); it != shard.lru_.end();) {
+				auto mIt = shard.items_.find(**it);
+				assertrx(mIt != shard.items_.end());
+				if (!cond(mIt->first, mIt->second.val)) {
+					++it;
+					continue;
+				}
+				const size_t oldSize = sizeof(Entry) + kElemSizeOverhead + mIt->first.Size() + mIt->second.val.Size();
+				if (oldSize > shard.totalCacheSize_) {
+					shard.clearAll();
+					break;
+				}
+				shard.totalCacheSize_ -= oldSize;
+				shard.items_.erase(mIt);
+				it = shard.lru_.erase(it);
+				++shard.eraseCount_;
 			}
-			totalCacheSize_ -= oldSize;
-			items_.erase(mIt);
-			it = lru_.erase(it);
-			++eraseCount_;
 		}
 	}
 
 protected:
-	bool eraseLRU();
-
-	bool clearAll();
-
 	typedef std::list<const K *> LRUList;
 
 	struct Entry {
 		V val;
 		typename LRUList::iterator lruPos;
 		int hitCount = 0;
+		// Second-chance bit for the Clock eviction mode
+		bool referenced = false;
 		template <typename T>
 		void Dump(T &os) const {
 			os << "{val: " << val << ", hitCount: " << hitCount << '}';
 		}
 	};
 
-	std::unordered_map<K, Entry, hash, equal> items_;
-	LRUList lru_;
-	mutable std::mutex lock_;
-	size_t totalCacheSize_;
-	size_t cacheSizeLimit_;
-	int hitCountToCache_;
+	// Independently locked part of the cache. Aligned to avoid false sharing of the neighbour shard's mutexes
+	struct alignas(64) Shard {
+		// Evicts entries until the shard's size is within the limit. Entry 'keep' is not evicted
+		bool eraseLRU(LRUCacheEvictionMode mode, size_t limit, const K *keep);
+		bool clearAll();
+		void touch(Entry &entry, LRUCacheEvictionMode mode);
+
+		template <typename T>
+		void Dump(T &os, std::string_view step, std::string_view offset) const {
+			std::string newOffset{offset};
+			newOffset += step;
+			os << "{\n" << newOffset << "totalCacheSize: ";
+			std::lock_guard lock{lock_};
+			os << totalCacheSize_.load() << ",\n"
+			   << newOffset << "cacheSizeLimit: " << cacheSizeLimit_ << ",\n"
+			   << newOffset << "hitCountToCache: " << hitCountToCache_ << ",\n"
+			   << newOffset << "getCount: " << getCount_ << ",\n"
+			   << newOffset << "putCount: " << putCount_ << ",\n"
+			   << newOffset << "eraseCount: " << eraseCount_ << ",\n"
+			   << newOffset << "items: [";
+			if (!items_.empty()) {
+				for (auto b = items_.begin(), it = b, e = items_.end(); it != e; ++it) {
+					if (it != b) os << ',';
+					os << '\n' << newOffset << '{' << it->first << ": ";
+					it->second.Dump(os);
+					os << '}';
+				}
+				os << '\n' << newOffset;
+			}
+			os << "],\n" << newOffset << "lruList: [";
+			for (auto b = lru_.begin(), it = b, e = lru_.end(); it != e; ++it) {
+				if (it != b) os << ", ";
+				os << **it;
+			}
+			os << "]\n" << offset << '}';
+		}
+
+		std::unordered_map<K, Entry, hash, equal> items_;
+		LRUList lru_;
+		mutable std::mutex lock_;
+		// Changed under the lock, but is read by the other shards to get the size of the whole cache
+		std::atomic<size_t> totalCacheSize_ = {0};
+		// Share of the cache's limit
+		size_t cacheSizeLimit_ = 0;
+		int hitCountToCache_ = kDefaultHitCountToCache;
+		int getCount_ = 0, putCount_ = 0, eraseCount_ = 0;
+		size_t evictionsCount_ = 0;
+	};
 
-	int getCount_ = 0, putCount_ = 0, eraseCount_ = 0;
+	// Evicts entries of the locked shard after the insertion or the update of the key
+	bool eraseLRU(Shard &shard, const K &key);
+	size_t totalSize() const noexcept {
+		size_t size = 0;
+		for (const auto &shard : shards_) size += shard.totalCacheSize_.load(std::memory_order_relaxed);
+		return size;
+	}
+
+	Shard &shardFor(const K &k) noexcept {
+		if (shards_.size() == 1) return shards_[0];
+		// Mix hash bits: unordered_map inside of the shard uses the same hash, so low bits must not correlate with the shard id
+		const uint64_t h = uint64_t(hash()(k)) * 0x9E3779B97F4A7C15ULL;
+		return shards_[(h >> 32) % shards_.size()];
+	}
+
+	std::vector<Shard> shards_;
+	size_t cacheSizeLimit_;
+	LRUCacheEvictionMode mode_;
 };
 
 }  // namespace reindexer
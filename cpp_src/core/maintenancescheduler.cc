@@ -0,0 +1,114 @@
+#include "maintenancescheduler.h"
+#include <algorithm>
+#include "debug/sampler.h"
+
+namespace reindexer {
+
+// Deferred tasks are rechecked with this period, because the foreground load is not signaled
+constexpr auto kDeferredRecheckPeriod = std::chrono::milliseconds(50);
+
+void MaintenanceScheduler::SetConfig(const Config &cfg) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	if (stop_) return;
+	cfg_ = cfg;
+	cfg_.workers = std::max(cfg_.workers, 1);
+	while (workers_.size() < size_t(cfg_.workers)) {
+		const size_t idx = workers_.size();
+		workers_.emplace_back([this, idx]() {
+			debug::CPUSampler::RegisterThread(debug::ThreadRole::Background);
+			worker(idx);
+		});
+	}
+	cv_.notify_all();
+}
+
+void MaintenanceScheduler::Schedule(const std::string &owner, Priority priority, std::chrono::milliseconds period,
+									std::function<void()> routine) {
+	auto task = std::make_shared<Task>();
+	task->owner = owner;
+	task->priority = priority;
+	task->period = period;
+	task->routine = std::move(routine);
+	task->due = Clock::now();
+	std::lock_guard<std::mutex> lck(mtx_);
+	tasks_.emplace_back(std::move(task));
+	cv_.notify_one();
+}
+
+void MaintenanceScheduler::Remove(const std::string &owner) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	tasks_.erase(std::remove_if(tasks_.begin(), tasks_.end(), [&owner](const std::shared_ptr<Task> &t) { return t->owner == owner; }),
+				 tasks_.end());
+}
+
+void MaintenanceScheduler::Stop() {
+	std::vector<std::thread> workers;
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		stop_ = true;
+		workers.swap(workers_);
+		cv_.notify_all();
+	}
+	for (auto &w : workers) w.join();
+}
+
+bool MaintenanceScheduler::ownerIsRunning(const std::string &owner) const noexcept {
+	return std::any_of(tasks_.begin(), tasks_.end(), [&owner](const std::shared_ptr<Task> &t) { return t->running && t->owner == owner; });
+}
+
+std::shared_ptr<MaintenanceScheduler::Task> MaintenanceScheduler::pick(Clock::time_point now, Clock::time_point &wakeUp) {
+	const bool highLoad = cfg_.deferLoadThreshold > 0 && foregroundOps_.load(std::memory_order_relaxed) >= cfg_.deferLoadThreshold;
+	std::shared_ptr<Task> best;
+	for (auto &task : tasks_) {
+		if (task->running) continue;
+		if (task->due > now) {
+			wakeUp = std::min(wakeUp, task->due);
+			continue;
+		}
+		if (highLoad && task->priority != Priority::High && now < task->due + cfg_.maxDeferral) {
+			if (!task->deferred) {
+				task->deferred = true;
+				deferred_.fetch_add(1, std::memory_order_relaxed);
+			}
+			wakeUp = std::min(wakeUp, now + kDeferredRecheckPeriod);
+			continue;
+		}
+		if (best && (best->priority < task->priority || (best->priority == task->priority && best->due <= task->due))) continue;
+		if (ownerIsRunning(task->owner)) continue;
+		best = task;
+	}
+	return best;
+}
+
+void MaintenanceScheduler::worker(size_t idx) {
+	std::unique_lock<std::mutex> lck(mtx_);
+	while (!stop_) {
+		if (idx >= size_t(cfg_.workers)) {
+			cv_.wait(lck);
+			continue;
+		}
+		const auto now = Clock::now();
+		auto wakeUp = Clock::time_point::max();
+		auto task = pick(now, wakeUp);
+		if (!task) {
+			if (wakeUp == Clock::time_point::max()) {
+				cv_.wait(lck);
+			} else {
+				cv_.wait_until(lck, wakeUp);
+			}
+			continue;
+		}
+
+		task->running = true;
+		lck.unlock();
+		task->routine();
+		lck.lock();
+		task->running = false;
+		task->deferred = false;
+		task->due = Clock::now() + task->period;
+		// Tasks of the same owner may be waiting for this one
+		cv_.notify_all();
+	}
+}
+
+}  // namespace reindexer
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace reindexer {
+
+/// Pool of the workers, which execute the periodic maintenance tasks of the namespaces.
+/// Due task with the highest priority is executed first, tasks with the same priority are executed in order of their due time, so the
+/// namespaces are served in turn. Tasks of the same owner (namespace) are never executed concurrently, so the long task of one namespace
+/// occupies only one worker. While the foreground load is high, tasks with the lowered priorities are deferred until their deadline.
+class MaintenanceScheduler {
+public:
+	enum class Priority { High, Normal, Low };
+	using Clock = std::chrono::steady_clock;
+
+	struct Config {
+		int workers = 2;
+		// Count of the running foreground operations, since which the normal and low priority tasks are deferred. 0 means 'never defer'
+		int deferLoadThreshold = 0;
+		// Max time, for which the due task may be deferred
+		std::chrono::milliseconds maxDeferral{5000};
+	};
+
+	/// Marks the foreground operation (select, modification, transaction commit), which is running by the current thread
+	class ForegroundOp {
+	public:
+		explicit ForegroundOp(MaintenanceScheduler &scheduler) noexcept : scheduler_(scheduler) {
+			scheduler_.foregroundOps_.fetch_add(1, std::memory_order_relaxed);
+		}
+		~ForegroundOp() { scheduler_.foregroundOps_.fetch_sub(1, std::memory_order_relaxed); }
+		ForegroundOp(const ForegroundOp &) = delete;
+		ForegroundOp &operator=(const ForegroundOp &) = delete;
+
+	private:
+		MaintenanceScheduler &scheduler_;
+	};
+
+	MaintenanceScheduler() = default;
+	~MaintenanceScheduler() { Stop(); }
+	MaintenanceScheduler(const MaintenanceScheduler &) = delete;
+	MaintenanceScheduler &operator=(const MaintenanceScheduler &) = delete;
+
+	/// Applies the config. Extra workers are not stopped on the pool shrinking, but they don't take the new tasks
+	void SetConfig(const Config &cfg);
+	/// Adds the periodic task. Task is executed for the first time right after its adding. Routine must not throw
+	void Schedule(const std::string &owner, Priority priority, std::chrono::milliseconds period, std::function<void()> routine);
+	/// Removes all the tasks of the owner. Running task is not interrupted
+	void Remove(const std::string &owner);
+	/// Stops and joins the workers. Waits for the running tasks
+	void Stop();
+
+	int ForegroundOps() const noexcept { return foregroundOps_.load(std::memory_order_relaxed); }
+	/// Count of the tasks, which were deferred by the foreground load
+	uint64_t DeferredCount() const noexcept { return deferred_.load(std::memory_order_relaxed); }
+
+private:
+	struct Task {
+		std::string owner;
+		Priority priority;
+		std::chrono::milliseconds period;
+		std::function<void()> routine;
+		Clock::time_point due;
+		bool running = false;
+		bool deferred = false;
+	};
+
+	void worker(size_t idx);
+	// Returns the task to execute or the time of the next check
+	std::shared_ptr<Task> pick(Clock::time_point now, Clock::time_point &wakeUp);
+	bool ownerIsRunning(const std::string &owner) const noexcept;
+
+	mutable std::mutex mtx_;
+	std::condition_variable cv_;
+	std::vector<std::shared_ptr<Task>> tasks_;
+	std::vector<std::thread> workers_;
+	Config cfg_;
+	bool stop_ = false;
+	std::atomic<int> foregroundOps_{0};
+	std::atomic<uint64_t> deferred_{0};
+};
+
+}  // namespace reindexer
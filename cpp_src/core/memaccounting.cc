@@ -0,0 +1,39 @@
+#include "memaccounting.h"
+#include <mutex>
+#include "tools/alloc_ext/tc_malloc_extension.h"
+
+namespace reindexer {
+
+thread_local MemAccountingScope::State MemAccountingScope::current_;
+std::atomic<bool> MemAccountingScope::enabled_ = {false};
+
+#if REINDEX_WITH_GPERFTOOLS
+// Size of the allocation is requested from the allocator only for the threads with the active scope
+static void chargeNew(const void *ptr, size_t size) {
+	if (ptr && size && MemAccountingScope::Active()) {
+		MemAccountingScope::Charge(alloc_ext::instance()->GetAllocatedSize(const_cast<void *>(ptr)));
+	}
+}
+
+static void chargeDelete(const void *ptr) {
+	if (ptr && MemAccountingScope::Active()) {
+		MemAccountingScope::Charge(-int64_t(alloc_ext::instance()->GetAllocatedSize(const_cast<void *>(ptr))));
+	}
+}
+#endif
+
+bool MemAccountingScope::Enable() {
+#if REINDEX_WITH_GPERFTOOLS
+	static std::once_flag once;
+	std::call_once(once, [] {
+		if (alloc_ext::TCMallocIsAvailable() && alloc_ext::TCMallocHooksAreAvailable()) {
+			alloc_ext::MallocHook_AddNewHook(chargeNew);
+			alloc_ext::MallocHook_AddDeleteHook(chargeDelete);
+			enabled_.store(true, std::memory_order_relaxed);
+		}
+	});
+#endif
+	return Enabled();
+}
+
+}  // namespace reindexer
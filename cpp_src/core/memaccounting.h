@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace reindexer {
+
+/// Memory of the namespace, which is measured by the allocator: allocations and deallocations of the thread are charged to the account of
+/// the current MemAccountingScope with the sizes reported by the allocator
+class MemAccount {
+public:
+	enum Subsystem : unsigned { Data = 0, Indexes, Fulltext, SubsystemsCount, Untracked = SubsystemsCount };
+
+	void Charge(Subsystem s, int64_t bytes) noexcept { bytes_[s].fetch_add(bytes, std::memory_order_relaxed); }
+	int64_t Get(Subsystem s) const noexcept { return bytes_[s].load(std::memory_order_relaxed); }
+	int64_t Total() const noexcept {
+		int64_t ret = 0;
+		for (auto &b : bytes_) ret += b.load(std::memory_order_relaxed);
+		return ret;
+	}
+
+private:
+	std::atomic<int64_t> bytes_[SubsystemsCount] = {};
+};
+
+/// Charges the allocations and deallocations of the current thread to the account while alive. Scopes may be nested: the scope without
+/// account switches the subsystem of the outer scope's account. Memory of the Untracked subsystem is not charged, i.e. temporary data of
+/// the select, which may be freed outside of the namespace
+class MemAccountingScope {
+public:
+	MemAccountingScope(MemAccount *account, MemAccount::Subsystem s) noexcept : prev_(current_) { current_ = {account, s}; }
+	explicit MemAccountingScope(MemAccount::Subsystem s) noexcept : prev_(current_) { current_.subsystem = s; }
+	~MemAccountingScope() { current_ = prev_; }
+	MemAccountingScope(const MemAccountingScope &) = delete;
+	MemAccountingScope &operator=(const MemAccountingScope &) = delete;
+
+	/// Installs the allocator hooks. Allocations are measured with tcmalloc only. Hooks have to be installed before the namespaces are
+	/// created, otherwise the memory allocated before is not counted
+	/// @return false, if the allocator hooks are not available
+	static bool Enable();
+	static bool Enabled() noexcept { return enabled_.load(std::memory_order_relaxed); }
+	/// Charges the allocated (positive size) or freed (negative size) memory to the current scope. Called by the allocator hooks
+	static void Charge(int64_t bytes) noexcept {
+		if (Active()) current_.account->Charge(current_.subsystem, bytes);
+	}
+	/// @return true, if memory of the current thread is charged to some account now
+	static bool Active() noexcept { return current_.account && current_.subsystem != MemAccount::Untracked; }
+
+private:
+	struct State {
+		MemAccount *account = nullptr;
+		MemAccount::Subsystem subsystem = MemAccount::Untracked;
+	};
+	static thread_local State current_;
+	static std::atomic<bool> enabled_;
+	State prev_;
+};
+
+/// Account of the namespace, which charges the memory of the owner's members construction and destruction. Has to be the first member of
+/// the owner: memory is charged since construction till Leave() and since Enter() till destruction
+class MemAccountGuard {
+public:
+	explicit MemAccountGuard(std::shared_ptr<MemAccount> account) : account_(std::move(account)) { Enter(); }
+	~MemAccountGuard() { Leave(); }
+	MemAccountGuard(const MemAccountGuard &) = delete;
+	MemAccountGuard &operator=(const MemAccountGuard &) = delete;
+
+	void Enter() noexcept {
+		if (!scope_) scope_.emplace(account_.get(), MemAccount::Data);
+	}
+	void Leave() noexcept { scope_.reset(); }
+	const std::shared_ptr<MemAccount> &Account() const noexcept { return account_; }
+
+private:
+	std::shared_ptr<MemAccount> account_;
+	std::optional<MemAccountingScope> scope_;
+};
+
+}  // namespace reindexer
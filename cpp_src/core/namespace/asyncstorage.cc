@@ -1,5 +1,6 @@
 #include "asyncstorage.h"
 #include "core/storage/storagefactory.h"
+#include "namespacestat.h"
 
 namespace reindexer {
 
@@ -11,6 +12,7 @@ void AsyncStorage::Close() {
 	clearUpdates();
 	storage_.reset();
 	path_.clear();
+	readOnly_ = false;
 }
 
 AsyncStorage::AsyncStorage(const AsyncStorage& o, AsyncStorage::FullLockT& storageLock) : isCopiedNsStorage_{true} {
@@ -22,7 +24,14 @@ AsyncStorage::AsyncStorage(const AsyncStorage& o, AsyncStorage::FullLockT& stora
 	}
 	storage_ = o.storage_;
 	path_ = o.path_;
+	readOnly_ = o.readOnly_;
 	curUpdatesChunck_ = createUpdatesCollection();
+	forceFlushLimit_.store(o.forceFlushLimit_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	forceFlushBytesLimit_.store(o.forceFlushBytesLimit_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	durableCommit_.store(o.durableCommit_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	groupCommitDeadlineMs_.store(o.groupCommitDeadlineMs_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	groupCommitSize_.store(o.groupCommitSize_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	flushStats_ = o.flushStats_;
 }
 
 Error AsyncStorage::Open(datastorage::StorageType storageType, const std::string& nsName, const std::string& path,
@@ -36,6 +45,7 @@ Error AsyncStorage::Open(datastorage::StorageType storageType, const std::string
 	auto err = storage_->Open(path, opts);
 	if (err.ok()) {
 		path_ = path;
+		readOnly_ = opts.IsReadOnly();
 		curUpdatesChunck_ = createUpdatesCollection();
 	}
 	return err;
@@ -46,9 +56,10 @@ void AsyncStorage::Destroy() {
 
 	if (storage_) {
 		clearUpdates();
-		storage_->Destroy(path_);
+		if (!readOnly_) storage_->Destroy(path_);
 		storage_.reset();
 		path_.clear();
+		readOnly_ = false;
 	}
 }
 
@@ -60,7 +71,7 @@ std::unique_ptr<datastorage::Cursor> AsyncStorage::GetCursor(StorageOpts& opts)
 void AsyncStorage::WriteSync(const StorageOpts& opts, std::string_view key, std::string_view value) {
 	std::lock_guard lck(updatesMtx_);
 	if (!isCopiedNsStorage_) {
-		if (storage_) {
+		if (storage_ && !readOnly_) {
 			storage_->Write(opts, key, value);
 		}
 		return;
@@ -108,6 +119,14 @@ void AsyncStorage::InheritUpdatesFrom(AsyncStorage& src, AsyncStorage::FullLockT
 		if (src.storage_.get() != storage_.get()) {
 			throw Error(errLogic, "Unable to inherit storage updates from another underlying storage");
 		}
+		if (src.totalUpdatesCount_.load(std::memory_order_acquire)) {
+			const auto srcFirstUpdateMs = src.firstPendingUpdateMs_.load(std::memory_order_relaxed);
+			if (!totalUpdatesCount_.load(std::memory_order_acquire) ||
+				srcFirstUpdateMs < firstPendingUpdateMs_.load(std::memory_order_relaxed)) {
+				firstPendingUpdateMs_.store(srcFirstUpdateMs, std::memory_order_relaxed);
+			}
+		}
+		totalUpdatesBytes_.fetch_add(src.totalUpdatesBytes_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
 		if (src.curUpdatesChunck_) {
 			totalUpdatesCount_.fetch_add(src.curUpdatesChunck_.updatesCount, std::memory_order_release);
 			src.totalUpdatesCount_.fetch_sub(src.curUpdatesChunck_.updatesCount, std::memory_order_release);
@@ -130,6 +149,25 @@ void AsyncStorage::clearUpdates() {
 	curUpdatesChunck_.reset();
 	recycled_.clear();
 	totalUpdatesCount_.store(0, std::memory_order_release);
+	totalUpdatesBytes_.store(0, std::memory_order_relaxed);
+}
+
+StorageFlushPerfStat AsyncStorage::GetFlushPerfStat() const {
+	auto fillStat = [](HistogramStat& stat, HistogramCounterMT::Stats&& counter) {
+		stat.bounds = std::move(counter.bounds);
+		stat.counts = std::move(counter.counts);
+		stat.sum = counter.sum;
+		stat.totalCount = counter.hitsCount;
+	};
+	StorageFlushPerfStat ret;
+	fillStat(ret.sizeBytes, flushStats_->sizeBytes.Get());
+	fillStat(ret.durationUs, flushStats_->durationUs.Get());
+	return ret;
+}
+
+void AsyncStorage::ResetFlushPerfStat() {
+	flushStats_->sizeBytes.Reset();
+	flushStats_->durationUs.Reset();
 }
 
 void AsyncStorage::flush() {
@@ -142,19 +180,25 @@ void AsyncStorage::flush() {
 	UpdatesPtrT uptr;
 	if (totalUpdatesCount_.load(std::memory_order_acquire)) {
 		std::unique_lock lck(updatesMtx_, std::defer_lock_t());
+		const auto opts = StorageOpts().Sync(durableCommit_.load(std::memory_order_relaxed));
+		const auto startTime = std::chrono::steady_clock::now();
+		uint64_t flushedBytes = 0;
 
-		auto flushChunk = [this, &lck](UpdatesPtrT&& uptr) {
+		auto flushChunk = [this, &lck, &opts, &flushedBytes](UpdatesPtrT&& uptr) {
 			assertrx(lck.owns_lock());
 			lck.unlock();
-			const auto status = storage_->Write(StorageOpts(), *uptr);
+			const auto status = storage_->Write(opts, *uptr);
 			if (!status.ok()) {
 				lck.lock();
 				totalUpdatesCount_.fetch_add(uptr.updatesCount, std::memory_order_release);
+				totalUpdatesBytes_.fetch_add(uptr.updatesBytes, std::memory_order_relaxed);
 				finishedUpdateChuncks_.emplace_front(std::move(uptr));
 				throw Error(errLogic, "Error write to storage in '%s': %s", path_, status.what());
 			}
+			flushedBytes += uptr.updatesBytes;
 			uptr->Clear();
 			uptr.updatesCount = 0;
+			uptr.updatesBytes = 0;
 
 			lck.lock();
 			recycleUpdatesCollection(std::move(uptr));
@@ -166,6 +210,7 @@ void AsyncStorage::flush() {
 			uptr = std::move(finishedUpdateChuncks_.front());
 			finishedUpdateChuncks_.pop_front();
 			totalUpdatesCount_.fetch_sub(uptr.updatesCount, std::memory_order_release);
+			totalUpdatesBytes_.fetch_sub(uptr.updatesBytes, std::memory_order_relaxed);
 
 			flushChunk(std::move(uptr));
 		}
@@ -177,10 +222,18 @@ void AsyncStorage::flush() {
 				uptr = std::move(curUpdatesChunck_);
 				curUpdatesChunck_ = createUpdatesCollection();
 				totalUpdatesCount_.store(0, std::memory_order_release);
+				totalUpdatesBytes_.store(0, std::memory_order_relaxed);
 
 				flushChunk(std::move(uptr));
 			}
 		}
+		lck.unlock();
+
+		if (flushedBytes) {
+			flushStats_->sizeBytes.Count(flushedBytes);
+			flushStats_->durationUs.Count(
+				std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+		}
 	}
 }
 
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <chrono>
 #include <deque>
 #include <mutex>
+#include "core/perfstatcounter.h"
 #include "core/storage/idatastorage.h"
 #include "estl/h_vector.h"
 #include "tools/flagguard.h"
 
 namespace reindexer {
 
+struct StorageFlushPerfStat;
+
 class AsyncStorage {
 public:
 	static constexpr uint32_t kLimitToAdviceBatching = 1000;
@@ -39,9 +43,10 @@ public:
 	std::weak_ptr<datastorage::IDataStorage> GetStoragePtr() const;
 	void Remove(std::string_view key) {
 		std::lock_guard lck(updatesMtx_);
-		if (storage_) {
-			totalUpdatesCount_.fetch_add(1, std::memory_order_release);
+		if (storage_ && !readOnly_) {
+			addPendingUpdate(key.size());
 			curUpdatesChunck_->Remove(key);
+			curUpdatesChunck_.updatesBytes += key.size();
 			if (++curUpdatesChunck_.updatesCount == kFlushChunckSize) {
 				beginNewUpdatesChunk();
 			}
@@ -60,26 +65,66 @@ public:
 	}
 	void Close();
 	void Flush();
+	/// Flush for the background routine. With group commit enabled pending updates are accumulated into the larger batches and are
+	/// flushed only when the oldest of them is older than the deadline or when their count reaches the size budget
+	void FlushIfDue() {
+		const auto deadlineMs = groupCommitDeadlineMs_.load(std::memory_order_relaxed);
+		if (deadlineMs) {
+			const auto pending = totalUpdatesCount_.load(std::memory_order_acquire);
+			if (!pending) {
+				return;
+			}
+			const auto sizeBudget = groupCommitSize_.load(std::memory_order_relaxed);
+			if ((!sizeBudget || pending < sizeBudget) && !forceFlushRequired() &&
+				nowMs() - firstPendingUpdateMs_.load(std::memory_order_relaxed) < int64_t(deadlineMs)) {
+				return;
+			}
+		}
+		Flush();
+	}
+	/// Synchronous flush in the writing thread, if count or size of the pending updates exceeds the force flush limits
 	void TryForceFlush() {
-		const auto forceFlushLimit = forceFlushLimit_.load(std::memory_order_relaxed);
-		if (forceFlushLimit && totalUpdatesCount_.load(std::memory_order_acquire) >= forceFlushLimit) {
+		if (forceFlushRequired()) {
 			// Flush must be performed in single thread
 			std::lock_guard flushLck(flushMtx_);
-			if (totalUpdatesCount_.load(std::memory_order_acquire) >= forceFlushLimit) {
+			if (forceFlushRequired()) {
 				flush();
 			}
 		}
 	}
+	/// Must be called after the transaction commit. In durable mode all the pending updates are flushed (and synced) before the commit
+	/// returns, otherwise only the force flush limits are checked
+	void FlushOnCommit() {
+		if (durableCommit_.load(std::memory_order_relaxed)) {
+			Flush();
+		} else {
+			TryForceFlush();
+		}
+	}
 	bool IsValid() const {
 		std::lock_guard lck(updatesMtx_);
 		return storage_.get();
 	}
+	/// Read only storage drops all the updates. Its files are shared with the other processes, so they are never removed
+	bool IsReadOnly() const {
+		std::lock_guard lck(updatesMtx_);
+		return readOnly_;
+	}
 	FullLockT FullLock() { return FullLockT{flushMtx_, updatesMtx_}; }
 	std::string Path() const noexcept;
 	datastorage::StorageType Type() const noexcept;
 	void InheritUpdatesFrom(AsyncStorage& src, AsyncStorage::FullLockT& storageLock);
 	AdviceGuardT AdviceBatching() noexcept { return AdviceGuardT(batchingAdvices_); }
 	void SetForceFlushLimit(uint32_t limit) noexcept { forceFlushLimit_.store(limit, std::memory_order_relaxed); }
+	void SetForceFlushBytesLimit(uint64_t limit) noexcept { forceFlushBytesLimit_.store(limit, std::memory_order_relaxed); }
+	/// In durable mode each flush is synced to disk and transactions commits flush all the pending updates
+	void SetDurableCommit(bool durable) noexcept { durableCommit_.store(durable, std::memory_order_relaxed); }
+	void SetGroupCommitPolicy(uint32_t deadlineMs, uint32_t sizeBudget) noexcept {
+		groupCommitDeadlineMs_.store(deadlineMs, std::memory_order_relaxed);
+		groupCommitSize_.store(sizeBudget, std::memory_order_relaxed);
+	}
+	StorageFlushPerfStat GetFlushPerfStat() const;
+	void ResetFlushPerfStat();
 
 private:
 	constexpr static uint32_t kFlushChunckSize = 11000;
@@ -91,13 +136,18 @@ private:
 		UpdatesPtrT() = default;
 		UpdatesPtrT(UpdatesPtrT&& p, uint32_t cnt) : BaseT(std::move(p)), updatesCount(cnt) {}
 		UpdatesPtrT(const UpdatesPtrT&) = delete;
-		UpdatesPtrT(UpdatesPtrT&& o) noexcept : BaseT(std::move(o)), updatesCount(o.updatesCount) { o.updatesCount = 0; }
+		UpdatesPtrT(UpdatesPtrT&& o) noexcept : BaseT(std::move(o)), updatesCount(o.updatesCount), updatesBytes(o.updatesBytes) {
+			o.updatesCount = 0;
+			o.updatesBytes = 0;
+		}
 		UpdatesPtrT& operator=(const UpdatesPtrT&) = delete;
 		UpdatesPtrT& operator=(UpdatesPtrT&& o) {
 			if (this != &o) {
 				BaseT::operator=(std::move(o));
 				updatesCount = o.updatesCount;
+				updatesBytes = o.updatesBytes;
 				o.updatesCount = 0;
+				o.updatesBytes = 0;
 			}
 			return *this;
 		}
@@ -106,22 +156,48 @@ private:
 		void reset(P* p) noexcept {
 			BaseT::reset(p);
 			updatesCount = 0;
+			updatesBytes = 0;
 		}
 		void reset() noexcept {
 			BaseT::reset();
 			updatesCount = 0;
+			updatesBytes = 0;
 		}
 
 		uint32_t updatesCount = 0;
+		uint64_t updatesBytes = 0;
+	};
+	struct FlushStats {
+		// Bounds of the flush size buckets: 4KB, 16KB, ... 64MB
+		HistogramCounterMT sizeBytes{{4 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20, 64 << 20}};
+		// Bounds of the flush duration buckets: 100us, 400us, ... ~1.6s
+		HistogramCounterMT durationUs{{100, 400, 1600, 6400, 25600, 102400, 409600, 1638400}};
 	};
 
 	void clearUpdates();
 	void flush();
 	void beginNewUpdatesChunk();
+	void addPendingUpdate(size_t bytes) noexcept {
+		totalUpdatesBytes_.fetch_add(bytes, std::memory_order_relaxed);
+		if (totalUpdatesCount_.fetch_add(1, std::memory_order_release) == 0) {
+			firstPendingUpdateMs_.store(nowMs(), std::memory_order_relaxed);
+		}
+	}
+	bool forceFlushRequired() const noexcept {
+		const auto forceFlushLimit = forceFlushLimit_.load(std::memory_order_relaxed);
+		const auto forceFlushBytesLimit = forceFlushBytesLimit_.load(std::memory_order_relaxed);
+		return (forceFlushLimit && totalUpdatesCount_.load(std::memory_order_acquire) >= forceFlushLimit) ||
+			   (forceFlushBytesLimit && totalUpdatesBytes_.load(std::memory_order_relaxed) >= forceFlushBytesLimit);
+	}
+	static int64_t nowMs() noexcept {
+		using namespace std::chrono;
+		return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+	}
 	void write(std::string_view key, std::string_view data) {
-		if (storage_) {
-			totalUpdatesCount_.fetch_add(1, std::memory_order_release);
+		if (storage_ && !readOnly_) {
+			addPendingUpdate(key.size() + data.size());
 			curUpdatesChunck_->Put(key, data);
+			curUpdatesChunck_.updatesBytes += key.size() + data.size();
 			if (++curUpdatesChunck_.updatesCount == kFlushChunckSize) {
 				beginNewUpdatesChunk();
 			}
@@ -134,14 +210,23 @@ private:
 	std::deque<UpdatesPtrT> finishedUpdateChuncks_;
 	UpdatesPtrT curUpdatesChunck_;
 	std::atomic<uint32_t> totalUpdatesCount_ = {0};
+	std::atomic<uint64_t> totalUpdatesBytes_ = {0};
 	shared_ptr<datastorage::IDataStorage> storage_;
 	mutable std::mutex updatesMtx_;
 	mutable std::mutex flushMtx_;
 	std::string path_;
 	bool isCopiedNsStorage_ = false;
+	bool readOnly_ = false;
 	h_vector<UpdatesPtrT, kMaxRecycledChunks> recycled_;
 	std::atomic<int32_t> batchingAdvices_ = {0};
 	std::atomic<uint32_t> forceFlushLimit_ = {0};
+	std::atomic<uint64_t> forceFlushBytesLimit_ = {0};
+	std::atomic<bool> durableCommit_ = {false};
+	std::atomic<uint32_t> groupCommitDeadlineMs_ = {0};
+	std::atomic<uint32_t> groupCommitSize_ = {0};
+	std::atomic<int64_t> firstPendingUpdateMs_ = {0};
+	// Shared with the namespace copies, so the stats survive the transactions with the namespace copying
+	std::shared_ptr<FlushStats> flushStats_ = std::make_shared<FlushStats>();
 };
 
 }  // namespace reindexer
@@ -0,0 +1,55 @@
+#include "coldtuples.h"
+#include "tools/errors.h"
+
+namespace reindexer {
+
+key_string ColdTuples::MakeStub(std::string_view storageKey) {
+	std::string stub;
+	stub.reserve(storageKey.size() + 1);
+	stub.push_back(kStubMarker);
+	stub.append(storageKey);
+	return make_key_string(std::move(stub));
+}
+
+void ColdTuples::SetStorage(std::weak_ptr<datastorage::IDataStorage> storage) {
+	std::lock_guard lck(mtx_);
+	storage_ = std::move(storage);
+}
+
+key_string ColdTuples::Load(std::string_view stub) const {
+	std::shared_ptr<datastorage::IDataStorage> storage;
+	{
+		std::lock_guard lck(mtx_);
+		storage = storage_.lock();
+	}
+	if (!storage) {
+		throw Error(errNotValid, "Storage of the evicted tuples is not available");
+	}
+	std::string tuple;
+	Error err = storage->Read(StorageOpts().FillCache(false), StorageKey(stub), tuple);
+	if (!err.ok()) {
+		throw Error(err.code(), "Unable to load evicted tuple from storage: %s", err.what());
+	}
+	return make_key_string(std::move(tuple));
+}
+
+std::string_view ColdTuples::resolveStub(const PayloadTypeImpl &type, std::string_view stub, key_string &holder) {
+	const ColdTuples *coldTuples = type.GetColdTuples();
+	if (!coldTuples) {
+		throw Error(errLogic, "Evicted tuple in the payload of '%s', which doesn't support tuples eviction", type.Name());
+	}
+	holder = coldTuples->Load(stub);
+	return *holder;
+}
+
+void ItemsAccessBits::Resize(size_t size) {
+	if (size == size_) return;
+	std::unique_ptr<std::atomic<bool>[]> bits(new std::atomic<bool>[size]);
+	const size_t copied = std::min(size, size_);
+	for (size_t i = 0; i < copied; ++i) bits[i].store(bits_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	for (size_t i = copied; i < size; ++i) bits[i].store(true, std::memory_order_relaxed);
+	bits_ = std::move(bits);
+	size_ = size;
+}
+
+}  // namespace reindexer
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "core/keyvalue/key_string.h"
+#include "core/payload/payloadtypeimpl.h"
+#include "core/storage/idatastorage.h"
+#include "core/type_consts.h"
+
+namespace reindexer {
+
+/// Storage of the tuples (CJSON of the non-indexed fields), evicted from the payloads of the rarely accessed items of the tiered
+/// namespace (see 'tiered_tuples_memory_budget'). Evicted tuple is written into the namespace's storage and the payload keeps the stub
+/// with the key of this record instead, so the tuple is read from the storage on demand, when the item is encoded or modified.
+/// Object is shared by all the copies of the namespace's payload type
+class ColdTuples {
+public:
+	/// Valid tuple always starts with TAG_OBJECT ctag, so the stub is distinguished by its first byte
+	static constexpr char kStubMarker = '\0';
+
+	static bool IsStub(std::string_view tuple) noexcept { return !tuple.empty() && tuple[0] == kStubMarker; }
+	static key_string MakeStub(std::string_view storageKey);
+	static std::string_view StorageKey(std::string_view stub) noexcept { return stub.substr(1); }
+	/// Returns the tuple itself or, for the stub, the tuple loaded from the storage. Loaded tuple is owned by the holder
+	static std::string_view Resolve(const PayloadTypeImpl &type, std::string_view tuple, key_string &holder) {
+		return IsStub(tuple) ? resolveStub(type, tuple, holder) : tuple;
+	}
+
+	void SetStorage(std::weak_ptr<datastorage::IDataStorage> storage);
+	key_string Load(std::string_view stub) const;
+
+private:
+	static std::string_view resolveStub(const PayloadTypeImpl &type, std::string_view stub, key_string &holder);
+
+	mutable std::mutex mtx_;
+	std::weak_ptr<datastorage::IDataStorage> storage_;
+};
+
+/// Reference bits of the namespace's items for the CLOCK approximation of LRU. Bit is set by the readers and is cleared by
+/// the eviction pass, so items, which were not read during the whole round of the pass, are considered to be cold
+class ItemsAccessBits {
+public:
+	ItemsAccessBits() = default;
+	ItemsAccessBits(const ItemsAccessBits &other) {
+		Resize(other.size_);
+		for (size_t i = 0; i < size_; ++i) bits_[i].store(other.bits_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	ItemsAccessBits &operator=(const ItemsAccessBits &) = delete;
+
+	void Touch(IdType id) noexcept {
+		if (size_t(id) < size_) bits_[id].store(true, std::memory_order_relaxed);
+	}
+	bool TestAndClear(IdType id) noexcept { return size_t(id) >= size_ || bits_[id].exchange(false, std::memory_order_relaxed); }
+	/// Has to be called under the namespace's write lock. New items are considered to be recently accessed
+	void Resize(size_t size);
+
+private:
+	std::unique_ptr<std::atomic<bool>[]> bits_;
+	size_t size_ = 0;
+};
+
+}  // namespace reindexer
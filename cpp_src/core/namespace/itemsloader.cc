@@ -1,5 +1,7 @@
 #include "itemsloader.h"
+#include <snappy.h>
 #include "core/index/index.h"
+#include "core/storage/prefetchingreader.h"
 #include "tools/logger.h"
 
 namespace reindexer {
@@ -38,104 +40,134 @@ ItemsLoader::LoadData ItemsLoader::Load() {
 }
 
 void ItemsLoader::reading() {
-	StorageOpts opts;
-	opts.FillCache(false);
-	size_t ldcount = 0;
-	unsigned errCount = 0;
-	Error lastErr;
-	int64_t maxLSN = -1;
-	int64_t minLSN = std::numeric_limits<int64_t>::max();
-	const bool nsIsSystem = ns_.isSystem();
-	auto dbIter = ns_.storage_.GetCursor(opts);
+	LoadData ld;
 	unsigned sliceId = 0;
-	for (dbIter->Seek(kRxStorageItemPrefix);
-		 dbIter->Valid() && dbIter->GetComparator().Compare(dbIter->Key(), std::string_view(kRxStorageItemPrefix "\xFF")) < 0;
-		 dbIter->Next()) {
-		std::string_view dataSlice = dbIter->Value();
-		if (dataSlice.size() > 0) {
-			if (!ns_.pkFields().size()) {
-				throw Error(errLogic, "Can't load data storage of '%s' - there are no PK fields in ns", ns_.name_);
-			}
-			if (dataSlice.size() < sizeof(int64_t)) {
-				lastErr = Error(errParseBin, "Not enougth data in data slice");
-				logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_.name_, lastErr.what());
-				++errCount;
-				continue;
-			}
+	if (source_) {
+		// External slices are not stable, so they are copied by placeItem
+		(*source_)([&](std::string_view cjson) { return cjson.empty() || placeItem(cjson, false, false, lsn_t(), sliceId, ld); });
+	} else if (snapshot_) {
+		// Snapshot is mapped until the end of loading, so its slices don't have to be copied
+		snapshot_->ForEach([&](std::string_view dataSlice) { return readItem(dataSlice, true, sliceId, ld); });
+	} else {
+		StorageOpts opts;
+		opts.FillCache(false);
+		// Storage reads are prefetched in the separate thread, so they overlap with the items decoding
+		datastorage::PrefetchingReader reader(ns_.storage_.GetCursor(opts), kRxStorageItemPrefix, kRxStorageItemPrefix "\xFF");
+		reader.ForEach([&](std::string_view, std::string_view dataSlice) { return readItem(dataSlice, false, sliceId, ld); });
+	}
+	std::lock_guard lck(mtx_);
+	if (terminated_) {
+		return;
+	}
+	terminated_ = true;
+	loadingData_.maxLSN = ld.maxLSN;
+	loadingData_.minLSN = ld.minLSN;
+	loadingData_.lastErr = std::move(ld.lastErr);
+	loadingData_.errCount = ld.errCount;
+	loadingData_.ldcount = ld.ldcount;
+	if (items_.HasNoWrittenItems()) {
+		cv_.notify_all();
+	}
+}
 
-			// Read LSN
-			int64_t lsn = *reinterpret_cast<const int64_t *>(dataSlice.data());
-			if (lsn < 0) {
-				lastErr = Error(errParseBin, "Ivalid LSN value: %d", lsn);
-				logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_.name_, lastErr.what());
-				++errCount;
-				continue;
-			}
-			lsn_t l(lsn);
-			if (!nsIsSystem) {
-				if (l.Server() != ns_.serverId_) {
-					l.SetServer(ns_.serverId_);
-				}
-			} else {
-				l.SetServer(0);
-			}
+bool ItemsLoader::readItem(std::string_view dataSlice, bool stableSlice, unsigned &sliceId, LoadData &ld) {
+	if (dataSlice.empty()) {
+		return true;
+	}
+	if (!ns_.pkFields().size()) {
+		throw Error(errLogic, "Can't load data storage of '%s' - there are no PK fields in ns", ns_.name_);
+	}
+	if (dataSlice.size() < sizeof(int64_t)) {
+		ld.lastErr = Error(errParseBin, "Not enougth data in data slice");
+		logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_.name_, ld.lastErr.what());
+		++ld.errCount;
+		return true;
+	}
+
+	// Read LSN
+	int64_t lsn;
+	memcpy(&lsn, dataSlice.data(), sizeof(lsn));
+	const bool compressed = lsn & kStorageItemCompressedFlag;
+	lsn &= ~kStorageItemCompressedFlag;
+	if (lsn < 0) {
+		ld.lastErr = Error(errParseBin, "Ivalid LSN value: %d", lsn);
+		logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_.name_, ld.lastErr.what());
+		++ld.errCount;
+		return true;
+	}
+	lsn_t l(lsn);
+	if (!ns_.isSystem()) {
+		if (l.Server() != ns_.serverId_) {
+			l.SetServer(ns_.serverId_);
+		}
+	} else {
+		l.SetServer(0);
+	}
 
-			maxLSN = std::max(maxLSN, l.Counter());
-			minLSN = std::min(minLSN, l.Counter());
-			dataSlice = dataSlice.substr(sizeof(lsn));
+	ld.maxLSN = std::max(ld.maxLSN, l.Counter());
+	ld.minLSN = std::min(ld.minLSN, l.Counter());
+	return placeItem(dataSlice.substr(sizeof(lsn)), compressed, stableSlice, l, sliceId, ld);
+}
 
-			std::unique_lock lck(mtx_);
-			cv_.wait(lck, [this] { return !items_.IsFull() || terminated_; });
-			if (terminated_) {
-				return;
-			}
-			auto &item = items_.PlaceItem();
-			lck.unlock();
+bool ItemsLoader::placeItem(std::string_view dataSlice, bool compressed, bool stableSlice, lsn_t l, unsigned &sliceId, LoadData &ld) {
+	std::unique_lock lck(mtx_);
+	cv_.wait(lck, [this] { return !items_.IsFull() || terminated_; });
+	if (terminated_) {
+		return false;
+	}
+	auto &item = items_.PlaceItem();
+	lck.unlock();
 
-			auto &sliceStorageP = slices_[sliceId];
-			if (sliceStorageP.len < dataSlice.size()) {
-				sliceStorageP.len = dataSlice.size() * 1.1;
-				sliceStorageP.data.reset(new char[sliceStorageP.len]);
-			}
-			memcpy(sliceStorageP.data.get(), dataSlice.data(), dataSlice.size());
-			dataSlice = std::string_view(sliceStorageP.data.get(), dataSlice.size());
-			sliceId = (sliceId + 1) % slices_.size();
-			item.impl.Unsafe(true);
-			auto err = item.impl.FromCJSON(dataSlice);
-			if (!err.ok()) {
-				logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_.name_, err.what());
-				++errCount;
-				lastErr = err;
-
-				lck.lock();
-				items_.ErasePlaced();
-				lck.unlock();
-				continue;
-			}
-			item.impl.Value().SetLSN(int64_t(l));
-			// Prealloc payload here, because reading|parsing thread is faster then index insertion thread
-			item.preallocPl = PayloadValue(item.impl.GetConstPayload().RealSize());
+	if (compressed || !stableSlice) {
+		size_t len = dataSlice.size();
+		if (compressed && !snappy::GetUncompressedLength(dataSlice.data(), dataSlice.size(), &len)) {
+			len = 0;
+		}
+		auto &sliceStorageP = slices_[sliceId];
+		if (sliceStorageP.len < len) {
+			sliceStorageP.len = len * 1.1;
+			sliceStorageP.data.reset(new char[sliceStorageP.len]);
+		}
+		if (!compressed) {
+			memcpy(sliceStorageP.data.get(), dataSlice.data(), len);
+		} else if (!len || !snappy::RawUncompress(dataSlice.data(), dataSlice.size(), sliceStorageP.data.get())) {
+			ld.lastErr = Error(errParseBin, "Can't decompress item");
+			logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_.name_, ld.lastErr.what());
+			++ld.errCount;
 
 			lck.lock();
-			const bool wasEmpty = items_.HasNoWrittenItems();
-			items_.WritePlaced();
+			items_.ErasePlaced();
 			lck.unlock();
-
-			if (wasEmpty) {
-				cv_.notify_all();
-			}
+			return true;
 		}
+		dataSlice = std::string_view(sliceStorageP.data.get(), len);
+		sliceId = (sliceId + 1) % slices_.size();
 	}
-	std::lock_guard lck(mtx_);
-	terminated_ = true;
-	loadingData_.maxLSN = maxLSN;
-	loadingData_.minLSN = minLSN;
-	loadingData_.lastErr = std::move(lastErr);
-	loadingData_.errCount = errCount;
-	loadingData_.ldcount = ldcount;
-	if (items_.HasNoWrittenItems()) {
+	item.impl.Unsafe(true);
+	auto err = item.impl.FromCJSON(dataSlice);
+	if (!err.ok()) {
+		logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_.name_, err.what());
+		++ld.errCount;
+		ld.lastErr = err;
+
+		lck.lock();
+		items_.ErasePlaced();
+		lck.unlock();
+		return true;
+	}
+	item.impl.Value().SetLSN(int64_t(l));
+	// Prealloc payload here, because reading|parsing thread is faster then index insertion thread
+	item.preallocPl = PayloadValue(item.impl.GetConstPayload().RealSize());
+
+	lck.lock();
+	const bool wasEmpty = items_.HasNoWrittenItems();
+	items_.WritePlaced();
+	lck.unlock();
+
+	if (wasEmpty) {
 		cv_.notify_all();
 	}
+	return true;
 }
 
 void ItemsLoader::insertion() {
@@ -173,40 +205,62 @@ void ItemsLoader::insertion() {
 			}
 
 			if (totalIndexesSize > 1) {
-				indexInserters.BuildSimpleIndexesAsync(startId, items, span<PayloadValue>(ns_.items_.data() + startId, items.size()));
+				// Composite indexes of the previous items are filled together with the simple indexes of the new ones
+				indexInserters.BuildIndexesAsync(startId, items, &ns_.items_);
 				indexInserters.AwaitIndexesBuild();
 			}
 
 			for (unsigned i = 0; i < items.size(); ++i) {
 				const auto id = i + startId;
-				auto &plData = ns_.items_[id];
+				auto &plData = ns_.items_.Mutable(id);
 				Payload pl(ns_.payloadType_, plData);
 				Payload plNew(items[i].impl.GetPayload());
 				// Index [0] must be inserted after all other simple indexes
 				doInsertField(ns_.indexes_, 0, id, pl, plNew, krefs, skrefs, dummyMtx);
 			}
 
-			if (compositeIndexesSize) {
-				indexInserters.BuildCompositeIndexesAsync();
-			}
 			for (unsigned i = 0; i < items.size(); ++i) {
-				auto &plData = ns_.items_[i + startId];
-				Payload pl(ns_.payloadType_, plData);
+				auto &plData = ns_.items_.Mutable(i + startId);
 				plData.SetLSN(items[i].impl.Value().GetLSN());
-				ns_.repl_.dataHash ^= pl.GetHash();
+				ns_.updateDataHash(plData);
 				ns_.itemsDataSize_ += plData.GetCapacity() + sizeof(PayloadValue::dataHeader);
 			}
 			if (compositeIndexesSize) {
-				indexInserters.AwaitIndexesBuild();
+				indexInserters.CompleteItems(startId, ns_.items_, items.size());
+			}
+			if (source_) {
+				writeToStorageAndWAL(items, startId);
 			}
 		} else {
 			terminated = terminated_;
 		}
 	} while (!terminated);
+
+	if (indexInserters.HasCompleteItems()) {
+		indexInserters.BuildIndexesAsync(ns_.items_.size(), {}, nullptr);
+		indexInserters.AwaitIndexesBuild();
+	}
+}
+
+void ItemsLoader::writeToStorageAndWAL(span<ItemData> items, unsigned startId) {
+	WrSerializer pk;
+	for (unsigned i = 0; i < items.size(); ++i) {
+		const IdType id = i + startId;
+		auto &plData = ns_.items_.Mutable(id);
+		const lsn_t lsn(ns_.wal_.Add(WALRecord(WalItemUpdate, id)), ns_.serverId_);
+		plData.SetLSN(int64_t(lsn));
+		if (ns_.storage_.IsValid()) {
+			pk.Reset();
+			pk << kRxStorageItemPrefix;
+			Payload(ns_.payloadType_, plData).SerializeFields(pk, ns_.pkFields());
+			ns_.writeItemToStorage(pk.Slice(), lsn.Counter(), items[i].impl);
+		}
+	}
 }
 
 void ItemsLoader::clearIndexCache() {
 	for (auto &idx : ns_.indexes_) {
+		idx->BulkInsertionDone();
 		idx->ClearCache();
 		idx->Commit();
 	}
@@ -294,39 +348,39 @@ void IndexInserters::AwaitIndexesBuild() {
 	}
 }
 
-void IndexInserters::BuildSimpleIndexesAsync(unsigned startId, span<ItemsLoader::ItemData> newItems, span<PayloadValue> nsItems) {
+void IndexInserters::BuildIndexesAsync(unsigned startId, span<ItemsLoader::ItemData> newItems, NsItems *nsItems) {
 	{
 		std::lock_guard lck(mtx_);
 		shared_.newItems = newItems;
 		shared_.nsItems = nsItems;
 		shared_.startId = startId;
+		shared_.compositeItems.swap(completeItems_);
+		shared_.compositeStartId = completeItemsStartId_;
+		completeItems_.clear();
+		// Tasks are the simple indexes [1, firstCompositePos) and then the composite indexes, if there are complete items for them
+		shared_.tasksCount = newItems.empty() ? 0 : indexes_.firstCompositePos() - 1;
+		if (!shared_.compositeItems.empty()) {
+			shared_.tasksCount += indexes_.compositeIndexesSize();
+		}
 		assertrx(shared_.threadsWithNewData.empty());
 		for (unsigned tid = 0; tid < threads_.size(); ++tid) {
 			shared_.threadsWithNewData.emplace_back(tid + kTIDOffset);
 		}
-		shared_.composite = false;
+		nextTask_.store(0, std::memory_order_relaxed);
 		readyThreads_.store(0, std::memory_order_relaxed);
 	}
 	cv_.notify_all();
 }
 
-void IndexInserters::BuildCompositeIndexesAsync() {
-	{
-		std::lock_guard lck(mtx_);
-		assertrx(shared_.threadsWithNewData.empty());
-		for (unsigned tid = 0; tid < threads_.size(); ++tid) {
-			shared_.threadsWithNewData.emplace_back(tid + kTIDOffset);
-		}
-		shared_.composite = true;
-		readyThreads_.store(0, std::memory_order_relaxed);
-	}
-	cv_.notify_all();
+void IndexInserters::CompleteItems(unsigned startId, const NsItems &nsItems, size_t count) {
+	assertrx(completeItems_.empty());
+	completeItems_.reserve(count);
+	for (size_t id = startId; id < startId + count; ++id) completeItems_.emplace_back(nsItems[id]);
+	completeItemsStartId_ = startId;
 }
 
 void IndexInserters::insertionLoop(unsigned threadId) noexcept {
 	VariantArray krefs, skrefs;
-	const unsigned firstCompositeIndex = indexes_.firstCompositePos();
-	const unsigned totalIndexes = indexes_.totalSize();
 
 	while (true) {
 		try {
@@ -341,43 +395,14 @@ void IndexInserters::insertionLoop(unsigned threadId) noexcept {
 			shared_.threadsWithNewData.erase(std::find(shared_.threadsWithNewData.begin(), shared_.threadsWithNewData.end(), threadId));
 			lck.unlock();
 
-			const unsigned startId = shared_.startId;
-			const unsigned threadsCnt = threads_.size();
-			assertrx(shared_.newItems.size() == shared_.nsItems.size());
-			if (shared_.composite) {
-				for (unsigned i = 0; i < shared_.newItems.size(); ++i) {
-					const auto id = startId + i;
-					auto &plData = shared_.nsItems[i];
-					for (unsigned field = firstCompositeIndex + threadId - kTIDOffset; field < totalIndexes; field += threadsCnt) {
-						bool needClearCache{false};
-						indexes_[field]->Upsert(Variant{plData}, id, needClearCache);
-					}
-				}
-			} else {
-				if (hasArrayIndexes_) {
-					for (unsigned i = 0; i < shared_.newItems.size(); ++i) {
-						const auto id = startId + i;
-						auto &item = shared_.newItems[i].impl;
-						auto &plData = shared_.nsItems[i];
-						Payload pl(pt_, plData);
-						Payload plNew = item.GetPayload();
-						for (unsigned field = threadId; field < firstCompositeIndex; field += threadsCnt) {
-							ItemsLoader::doInsertField(indexes_, field, id, pl, plNew, krefs, skrefs,
-													   plArrayMtxs_[id % plArrayMtxs_.size()]);
-						}
-					}
+			assertrx(shared_.newItems.empty() || shared_.nsItems);
+			const unsigned simpleTasksCount = shared_.newItems.empty() ? 0 : indexes_.firstCompositePos() - 1;
+			for (unsigned task = nextTask_.fetch_add(1, std::memory_order_relaxed); task < shared_.tasksCount;
+				 task = nextTask_.fetch_add(1, std::memory_order_relaxed)) {
+				if (task < simpleTasksCount) {
+					insertSimpleIndex(task + 1, krefs, skrefs);
 				} else {
-					dummy_mutex dummyMtx;
-					for (unsigned i = 0; i < shared_.newItems.size(); ++i) {
-						const auto id = startId + i;
-						auto &item = shared_.newItems[i].impl;
-						auto &plData = shared_.nsItems[i];
-						Payload pl(pt_, plData);
-						Payload plNew = item.GetPayload();
-						for (unsigned field = threadId; field < firstCompositeIndex; field += threadsCnt) {
-							ItemsLoader::doInsertField(indexes_, field, id, pl, plNew, krefs, skrefs, dummyMtx);
-						}
-					}
+					insertCompositeIndex(indexes_.firstCompositePos() + task - simpleTasksCount);
 				}
 			}
 			onItemsHandled();
@@ -389,4 +414,31 @@ void IndexInserters::insertionLoop(unsigned threadId) noexcept {
 	}
 }
 
+void IndexInserters::insertSimpleIndex(unsigned field, VariantArray &krefs, VariantArray &skrefs) {
+	const unsigned startId = shared_.startId;
+	if (hasArrayIndexes_) {
+		for (unsigned i = 0; i < shared_.newItems.size(); ++i) {
+			const auto id = startId + i;
+			Payload pl(pt_, shared_.nsItems->Mutable(id));
+			Payload plNew = shared_.newItems[i].impl.GetPayload();
+			ItemsLoader::doInsertField(indexes_, field, id, pl, plNew, krefs, skrefs, plArrayMtxs_[id % plArrayMtxs_.size()]);
+		}
+	} else {
+		dummy_mutex dummyMtx;
+		for (unsigned i = 0; i < shared_.newItems.size(); ++i) {
+			Payload pl(pt_, shared_.nsItems->Mutable(startId + i));
+			Payload plNew = shared_.newItems[i].impl.GetPayload();
+			ItemsLoader::doInsertField(indexes_, field, startId + i, pl, plNew, krefs, skrefs, dummyMtx);
+		}
+	}
+}
+
+void IndexInserters::insertCompositeIndex(unsigned field) {
+	auto &index = *indexes_[field];
+	for (unsigned i = 0; i < shared_.compositeItems.size(); ++i) {
+		bool needClearCache{false};
+		index.Upsert(Variant{shared_.compositeItems[i]}, shared_.compositeStartId + i, needClearCache);
+	}
+}
+
 }  // namespace reindexer
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <condition_variable>
+#include "itemssnapshot.h"
 #include "namespaceimpl.h"
 
 namespace reindexer {
@@ -19,13 +20,21 @@ public:
 		std::exception_ptr ex;
 	};
 
-	ItemsLoader(unsigned indexInsertionThreads, NamespaceImpl& ns)
+	/// @param snapshot - optional items snapshot, which is used instead of the storage's items records
+	ItemsLoader(unsigned indexInsertionThreads, NamespaceImpl& ns, const ItemsSnapshot* snapshot = nullptr)
 		: ns_(ns),
 		  items_(kBufferSize, ns_.payloadType_, ns_.tagsMatcher_),
 		  slices_(kBufferSize),
+		  snapshot_(snapshot),
 		  indexInsertionThreads_(indexInsertionThreads) {
 		assertrx(indexInsertionThreads_);
 	}
+	/// Loads items from the external source (e.g. from the replication master) instead of the storage. Loaded items get the new LSNs
+	/// and are written into the namespace's WAL and storage
+	ItemsLoader(unsigned indexInsertionThreads, NamespaceImpl& ns, const NamespaceImpl::ItemsSourceT& source)
+		: ItemsLoader(indexInsertionThreads, ns) {
+		source_ = &source;
+	}
 	LoadData Load();
 
 private:
@@ -90,6 +99,9 @@ private:
 	};
 
 	void reading();
+	bool readItem(std::string_view dataSlice, bool stableSlice, unsigned& sliceId, LoadData& ld);
+	bool placeItem(std::string_view dataSlice, bool compressed, bool stableSlice, lsn_t lsn, unsigned& sliceId, LoadData& ld);
+	void writeToStorageAndWAL(span<ItemData> items, unsigned startId);
 	void insertion();
 	void clearIndexCache();
 	template <typename MutexT>
@@ -103,11 +115,16 @@ private:
 	std::condition_variable cv_;
 	InplaceRingBuf<ItemData> items_;
 	std::vector<SliceStorage> slices_;
+	const ItemsSnapshot* snapshot_;
+	const NamespaceImpl::ItemsSourceT* source_ = nullptr;
 	bool terminated_ = false;
 	LoadData loadingData_;
 	const unsigned indexInsertionThreads_;
 };
 
+/// Fills indexes of the loaded items in several threads. Each index is filled by single thread at a time and threads take the indexes
+/// dynamically, so the heavy indexes do not wait for each other. Composite indexes of the previous batch are filled together with the
+/// simple indexes of the current one, because composite indexes require complete payloads
 class IndexInserters {
 public:
 	IndexInserters(NamespaceImpl::IndexesStorage& indexes, PayloadType pt);
@@ -116,20 +133,30 @@ public:
 	void Run(unsigned threadsCnt);
 	void Stop();
 	void AwaitIndexesBuild();
-	void BuildSimpleIndexesAsync(unsigned startId, span<ItemsLoader::ItemData> newItems, span<PayloadValue> nsItems);
-	void BuildCompositeIndexesAsync();
+	/// Starts to fill simple indexes (except of PK) by the new items and composite indexes by the items, passed to CompleteItems
+	/// before this call. Nullptr may be passed with the empty items to fill composite indexes only. Pages of the new items have to be
+	/// owned by the namespace (see NsItems::Mutable), because they are accessed by the several threads
+	void BuildIndexesAsync(unsigned startId, span<ItemsLoader::ItemData> newItems, NsItems *nsItems);
+	/// Marks payloads of the items as complete (all of their fields including PK are set), so they may be put into composite indexes
+	void CompleteItems(unsigned startId, const NsItems &nsItems, size_t count);
+	bool HasCompleteItems() const noexcept { return !completeItems_.empty(); }
 
 private:
 	struct SharedData {
 		span<ItemsLoader::ItemData> newItems;
-		span<PayloadValue> nsItems;
+		NsItems *nsItems = nullptr;
 		unsigned startId = 0;
+		// Copies of the previous items payloads for composite indexes. Namespace's items vector may be reallocated, while they are used
+		std::vector<PayloadValue> compositeItems;
+		unsigned compositeStartId = 0;
+		unsigned tasksCount = 0;
 		h_vector<unsigned, 8> threadsWithNewData;
 		bool terminate = false;
-		bool composite = false;
 	};
 
 	void insertionLoop(unsigned threadId) noexcept;
+	void insertSimpleIndex(unsigned field, VariantArray& krefs, VariantArray& skrefs);
+	void insertCompositeIndex(unsigned field);
 	void onItemsHandled() noexcept {
 		if ((readyThreads_.fetch_add(1, std::memory_order_acq_rel) + 1) == threads_.size()) {
 			std::lock_guard lck(mtx_);
@@ -149,11 +176,14 @@ private:
 	NamespaceImpl::IndexesStorage& indexes_;
 	const PayloadType pt_;
 	SharedData shared_;
+	std::vector<PayloadValue> completeItems_;
+	unsigned completeItemsStartId_ = 0;
 	std::atomic<unsigned> readyThreads_ = {0};
+	std::atomic<unsigned> nextTask_ = {0};
 	std::vector<std::thread> threads_;
 	Error status_;
 	bool hasArrayIndexes_ = false;
-	constexpr static unsigned kTIDOffset = 1;  // Thread ID offset to handle fields [1,n] based on TID
+	constexpr static unsigned kTIDOffset = 1;  // Thread ID offset
 	std::array<shared_timed_mutex, 10> plArrayMtxs_;
 };
 
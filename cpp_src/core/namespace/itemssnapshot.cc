@@ -0,0 +1,191 @@
+#include "itemssnapshot.h"
+#include <cstdio>
+#include "tools/customhash.h"
+#include "tools/fsops.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace reindexer {
+
+constexpr std::string_view kItemsSnapshotFileName = "items.rxsnapshot";
+constexpr size_t kItemsSnapshotWriteBufSize = 1 << 20;
+
+template <typename T>
+static void putValue(std::string &buf, T v) {
+	buf.append(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+template <typename T>
+static T getValue(const char *ptr) noexcept {
+	T v;
+	memcpy(&v, ptr, sizeof(v));
+	return v;
+}
+
+std::string ItemsSnapshot::filePath(const std::string &dir) { return fs::JoinPath(dir, std::string(kItemsSnapshotFileName)); }
+
+Error ItemsSnapshot::Write(const std::string &dir, uint64_t id, datastorage::Cursor &cursor, std::string_view prefix,
+						   const std::function<bool()> &isCanceled) {
+	const std::string path = filePath(dir);
+	const std::string tmpPath = path + ".tmp";
+	FILE *f = fopen(tmpPath.c_str(), "wb");
+	if (!f) {
+		return Error(errLogic, "Unable to create items snapshot '%s': %s", tmpPath, strerror(errno));
+	}
+
+	Error err;
+	std::string buf;
+	buf.reserve(kItemsSnapshotWriteBufSize);
+	auto flushBuf = [&] {
+		if (!buf.empty() && fwrite(buf.data(), 1, buf.size(), f) != buf.size()) {
+			err = Error(errLogic, "Unable to write items snapshot '%s': %s", tmpPath, strerror(errno));
+		}
+		buf.clear();
+		return err.ok();
+	};
+
+	putValue(buf, kMagic);
+	putValue(buf, kVersion);
+	putValue(buf, id);
+	uint64_t count = 0;
+	const std::string prefixEnd = std::string(prefix) + "\xFF";
+	for (cursor.Seek(prefix); cursor.Valid() && cursor.GetComparator().Compare(cursor.Key(), prefixEnd) < 0; cursor.Next()) {
+		const std::string_view value = cursor.Value();
+		if (value.empty()) continue;
+		putValue(buf, uint32_t(value.size()));
+		putValue(buf, _Hash_bytes(value.data(), value.size()));
+		buf.append(value);
+		++count;
+		if (buf.size() >= kItemsSnapshotWriteBufSize) {
+			if (!flushBuf()) break;
+			if (isCanceled()) {
+				err = Error(errCanceled, "Items snapshot writing was canceled");
+				break;
+			}
+		}
+	}
+	if (err.ok()) {
+		putValue(buf, count);
+		putValue(buf, kMagic);
+		putValue(buf, uint32_t(0));
+		flushBuf();
+	}
+	if (err.ok() && fflush(f) != 0) {
+		err = Error(errLogic, "Unable to write items snapshot '%s': %s", tmpPath, strerror(errno));
+	}
+#ifndef _WIN32
+	// Snapshot must be completely written before it's marked as actual in the storage
+	if (err.ok() && fsync(fileno(f)) != 0) {
+		err = Error(errLogic, "Unable to sync items snapshot '%s': %s", tmpPath, strerror(errno));
+	}
+#endif
+	fclose(f);
+	if (err.ok() && fs::Rename(tmpPath, path) != 0) {
+		err = Error(errLogic, "Unable to rename items snapshot '%s': %s", tmpPath, strerror(errno));
+	}
+	if (!err.ok()) {
+		remove(tmpPath.c_str());
+	}
+	return err;
+}
+
+void ItemsSnapshot::Remove(const std::string &dir) noexcept {
+	const std::string path = filePath(dir);
+	remove(path.c_str());
+	remove((path + ".tmp").c_str());
+}
+
+Error ItemsSnapshot::Open(const std::string &dir, uint64_t id) {
+	close();
+	const std::string path = filePath(dir);
+#ifndef _WIN32
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return Error(errNotFound, "Unable to open items snapshot '%s': %s", path, strerror(errno));
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return Error(errNotValid, "Items snapshot '%s' is empty", path);
+	}
+	void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		return Error(errLogic, "Unable to map items snapshot '%s': %s", path, strerror(errno));
+	}
+	// Snapshot is read sequentially twice: on validation and on loading
+	madvise(addr, st.st_size, MADV_SEQUENTIAL);
+	data_ = static_cast<const char *>(addr);
+	size_ = st.st_size;
+#else
+	if (fs::ReadFile(path, content_) < 0) {
+		return Error(errNotFound, "Unable to read items snapshot '%s'", path);
+	}
+	data_ = content_.data();
+	size_ = content_.size();
+#endif
+	Error err = validate(id);
+	if (!err.ok()) {
+		close();
+		return Error(err.code(), "Items snapshot '%s': %s", path, err.what());
+	}
+	return Error();
+}
+
+Error ItemsSnapshot::validate(uint64_t id) noexcept {
+	if (size_ < kHeaderSize + kFooterSize) {
+		return Error(errNotValid, "unexpected file size %d", size_);
+	}
+	if (getValue<uint32_t>(data_) != kMagic || getValue<uint32_t>(data_ + sizeof(uint32_t)) != kVersion) {
+		return Error(errNotValid, "unexpected file format");
+	}
+	if (getValue<uint64_t>(data_ + 2 * sizeof(uint32_t)) != id) {
+		return Error(errNotValid, "snapshot id does not match storage");
+	}
+	const char *footer = data_ + size_ - kFooterSize;
+	if (getValue<uint32_t>(footer + sizeof(uint64_t)) != kMagic) {
+		return Error(errNotValid, "snapshot is incomplete");
+	}
+	const uint64_t count = getValue<uint64_t>(footer);
+	const char *ptr = data_ + kHeaderSize;
+	for (uint64_t i = 0; i < count; ++i) {
+		if (size_t(footer - ptr) < kRecordHeaderSize) {
+			return Error(errNotValid, "unexpected end of records");
+		}
+		const uint32_t size = getValue<uint32_t>(ptr);
+		const uint32_t hash = getValue<uint32_t>(ptr + sizeof(uint32_t));
+		ptr += kRecordHeaderSize;
+		if (size_t(footer - ptr) < size) {
+			return Error(errNotValid, "unexpected end of records");
+		}
+		if (_Hash_bytes(ptr, size) != hash) {
+			return Error(errNotValid, "hash mismatch in record %d", i);
+		}
+		ptr += size;
+	}
+	if (ptr != footer) {
+		return Error(errNotValid, "unexpected data after records");
+	}
+	count_ = count;
+	return Error();
+}
+
+void ItemsSnapshot::close() noexcept {
+#ifndef _WIN32
+	if (data_) {
+		munmap(const_cast<char *>(data_), size_);
+	}
+#else
+	content_.clear();
+#endif
+	data_ = nullptr;
+	size_ = 0;
+	count_ = 0;
+}
+
+}  // namespace reindexer
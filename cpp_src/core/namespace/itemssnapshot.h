@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include "core/storage/idatastorage.h"
+#include "tools/errors.h"
+
+namespace reindexer {
+
+/// Flat binary copy of the namespace's items records from the storage.
+/// Snapshot file is memory mapped on the namespace loading, so items are read sequentially from the single file instead of iterating
+/// over the storage. Snapshot is actual only while the storage contains marker record with the same snapshot id (see NamespaceImpl).
+/// File layout: header (magic, version, id), records (value size, value hash, value) and footer (records count, magic)
+class ItemsSnapshot {
+public:
+	ItemsSnapshot() = default;
+	ItemsSnapshot(const ItemsSnapshot &) = delete;
+	ItemsSnapshot &operator=(const ItemsSnapshot &) = delete;
+	~ItemsSnapshot() { close(); }
+
+	/// Writes storage records with keys, starting with 'prefix', into the snapshot file in the 'dir'.
+	/// Records are written into the temporary file first, which replaces the snapshot file after successful write
+	/// @return errCanceled if isCanceled returned true during write
+	static Error Write(const std::string &dir, uint64_t id, datastorage::Cursor &cursor, std::string_view prefix,
+					   const std::function<bool()> &isCanceled);
+	/// Removes snapshot file from the 'dir'
+	static void Remove(const std::string &dir) noexcept;
+
+	/// Maps snapshot file from the 'dir' and validates its content
+	/// @param id - expected snapshot id
+	Error Open(const std::string &dir, uint64_t id);
+	/// Calls f(std::string_view value) for each record. Values are valid until snapshot is closed. Iteration stops if f returns false
+	template <typename F>
+	void ForEach(F &&f) const {
+		const char *ptr = data_ + kHeaderSize;
+		for (size_t i = 0; i < count_; ++i) {
+			uint32_t size;
+			memcpy(&size, ptr, sizeof(size));
+			ptr += kRecordHeaderSize;
+			if (!f(std::string_view(ptr, size))) return;
+			ptr += size;
+		}
+	}
+	size_t Count() const noexcept { return count_; }
+	size_t FileSize() const noexcept { return size_; }
+
+private:
+	constexpr static uint32_t kMagic = 0x4E535852;	// "RXSN"
+	constexpr static uint32_t kVersion = 1;
+	constexpr static size_t kHeaderSize = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+	constexpr static size_t kRecordHeaderSize = 2 * sizeof(uint32_t);
+	constexpr static size_t kFooterSize = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+	static std::string filePath(const std::string &dir);
+	Error validate(uint64_t id) noexcept;
+	void close() noexcept;
+
+	const char *data_ = nullptr;
+	size_t size_ = 0;
+	size_t count_ = 0;
+#ifdef _WIN32
+	std::string content_;
+#endif
+};
+
+}  // namespace reindexer
@@ -0,0 +1,63 @@
+#include "itemswriter.h"
+
+namespace reindexer {
+
+ItemsWriter::ItemsWriter(size_t maxQueueSize) : maxQueueSize_(maxQueueSize), thread_([this] { run(); }) {}
+
+ItemsWriter::~ItemsWriter() {
+	{
+		std::unique_lock lck(mtx_);
+		cv_.wait(lck, [this] { return tasks_.empty() && !busy_; });
+		terminate_ = true;
+	}
+	cv_.notify_all();
+	thread_.join();
+}
+
+void ItemsWriter::Add(Task &&task) {
+	std::unique_lock lck(mtx_);
+	cv_.wait(lck, [this] { return tasks_.size() < maxQueueSize_ || error_; });
+	rethrowError();
+	tasks_.emplace_back(std::move(task));
+	if (tasks_.size() == 1) cv_.notify_all();
+}
+
+void ItemsWriter::Await() {
+	std::unique_lock lck(mtx_);
+	cv_.wait(lck, [this] { return (tasks_.empty() && !busy_) || error_; });
+	rethrowError();
+}
+
+void ItemsWriter::run() noexcept {
+	std::unique_lock lck(mtx_);
+	for (;;) {
+		cv_.wait(lck, [this] { return !tasks_.empty() || terminate_; });
+		if (tasks_.empty()) return;
+		Task task = std::move(tasks_.front());
+		tasks_.pop_front();
+		busy_ = true;
+		lck.unlock();
+		std::exception_ptr error;
+		try {
+			task();
+		} catch (...) {
+			error = std::current_exception();
+		}
+		lck.lock();
+		busy_ = false;
+		if (error && !error_) {
+			error_ = error;
+			// Tasks, which are queued after the failed one, are not executed
+			tasks_.clear();
+		}
+		cv_.notify_all();
+	}
+}
+
+void ItemsWriter::rethrowError() {
+	if (error_) {
+		std::rethrow_exception(std::exchange(error_, nullptr));
+	}
+}
+
+}  // namespace reindexer
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace reindexer {
+
+/// Serializes the modified items of the large transaction into the storage and the replication records in the separate thread, so
+/// the serialization overlaps with the index updates of the next items. Tasks are executed in the order of their addition and the
+/// queue is bounded, so the committing thread waits, if the writer falls behind
+class ItemsWriter {
+public:
+	using Task = std::function<void()>;
+
+	explicit ItemsWriter(size_t maxQueueSize);
+	ItemsWriter(const ItemsWriter &) = delete;
+	ItemsWriter &operator=(const ItemsWriter &) = delete;
+	/// Completes the queued tasks, so the items, referenced by them, may be destroyed after that
+	~ItemsWriter();
+
+	/// Rethrows the error of the previous task, if there was one
+	void Add(Task &&task);
+	/// Waits for the completion of all the queued tasks, e.g. before the records, which have to follow them, are written by the caller.
+	/// Rethrows the error of the task, if there was one
+	void Await();
+
+private:
+	void run() noexcept;
+	void rethrowError();
+
+	std::mutex mtx_;
+	std::condition_variable cv_;
+	std::deque<Task> tasks_;
+	const size_t maxQueueSize_;
+	bool busy_ = false;
+	bool terminate_ = false;
+	std::exception_ptr error_;
+	std::thread thread_;
+};
+
+}  // namespace reindexer
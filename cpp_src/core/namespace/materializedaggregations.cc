@@ -0,0 +1,55 @@
+#include "materializedaggregations.h"
+#include "core/nsselecter/aggregator.h"
+
+namespace reindexer {
+
+void MaterializedAggregations::Reset(h_vector<int, 4> &&fields) {
+	fields_ = std::move(fields);
+	groups_.clear();
+	groups_.resize(fields_.size());
+}
+
+void MaterializedAggregations::Groups::Add(const VariantArray &keys) {
+	for (const Variant &key : keys) {
+		auto it = counts.find(key);
+		if (it != counts.end()) {
+			++it->second;
+		} else {
+			// Key may reference the string of the item's payload, so the group holds its own copy
+			Variant held(key);
+			counts.emplace(std::move(held.EnsureHold()), 1);
+		}
+	}
+}
+
+void MaterializedAggregations::Groups::Remove(const VariantArray &keys) {
+	for (const Variant &key : keys) {
+		auto it = counts.find(key);
+		assertrx(it != counts.end());
+		if (it == counts.end()) continue;
+		if (--it->second == 0) counts.erase(it);
+	}
+}
+
+bool MaterializedAggregations::CanAggregate(const Aggregator &aggregator) const noexcept {
+	switch (aggregator.Type()) {
+		case AggFacet:
+		case AggSum:
+		case AggAvg:
+		case AggMin:
+		case AggMax:
+			break;
+		default:
+			return false;
+	}
+	const FieldsSet &fields = aggregator.Fields();
+	return fields.size() == 1 && fields[0] != IndexValueType::SetByJsonPath && find(fields[0]);
+}
+
+void MaterializedAggregations::Aggregate(Aggregator &aggregator) const {
+	const Groups *g = find(aggregator.Fields()[0]);
+	assertrx(g);
+	for (const auto &group : g->counts) aggregator.AggregateGroup(group.first, group.second);
+}
+
+}  // namespace reindexer
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include "core/keyvalue/variant.h"
+#include "estl/fast_hash_map.h"
+#include "estl/h_vector.h"
+
+namespace reindexer {
+
+class Aggregator;
+
+/// Counts of the values of the namespace's indexes (see 'materialized_aggregations' of the namespace config), which are maintained
+/// by each modification of the items. Facet, sum, avg, min and max aggregations of the whole namespace are answered by these counts
+/// in O(distinct values) instead of the full scan
+class MaterializedAggregations {
+public:
+	/// Sets the indexes to group by. Counts are cleared, so they should be filled again by the namespace's items
+	void Reset(h_vector<int, 4> &&fields);
+	const h_vector<int, 4> &Fields() const noexcept { return fields_; }
+	bool Empty() const noexcept { return fields_.empty(); }
+	bool Has(int field) const noexcept { return find(field); }
+
+	void Add(int field, const VariantArray &keys) {
+		if (Groups *g = find(field)) g->Add(keys);
+	}
+	void Remove(int field, const VariantArray &keys) {
+		if (Groups *g = find(field)) g->Remove(keys);
+	}
+
+	/// @return true, if result of the aggregator over the whole namespace may be calculated by counts
+	bool CanAggregate(const Aggregator &) const noexcept;
+	void Aggregate(Aggregator &) const;
+
+private:
+	struct Groups {
+		void Add(const VariantArray &keys);
+		void Remove(const VariantArray &keys);
+
+		fast_hash_map<Variant, int> counts;
+	};
+
+	Groups *find(int field) noexcept {
+		for (size_t i = 0; i < fields_.size(); ++i) {
+			if (fields_[i] == field) return &groups_[i];
+		}
+		return nullptr;
+	}
+	const Groups *find(int field) const noexcept { return const_cast<MaterializedAggregations *>(this)->find(field); }
+
+	h_vector<int, 4> fields_;
+	std::vector<Groups> groups_;
+};
+
+}  // namespace reindexer
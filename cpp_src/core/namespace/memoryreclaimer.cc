@@ -0,0 +1,51 @@
+#include "memoryreclaimer.h"
+#include "core/index/index.h"
+#include "core/memaccounting.h"
+
+namespace reindexer {
+
+MemoryReclaimer::MemoryReclaimer() = default;
+MemoryReclaimer::~MemoryReclaimer() = default;
+
+void MemoryReclaimer::Add(NsItems &&items) {
+	if (items.empty()) return;
+	std::lock_guard lck(mtx_);
+	items_.emplace_back(std::move(items));
+}
+
+void MemoryReclaimer::Add(std::unique_ptr<Index> &&index) {
+	if (!index) return;
+	std::lock_guard lck(mtx_);
+	indexes_.emplace_back(std::move(index));
+}
+
+bool MemoryReclaimer::ReleaseStep(MemAccount *account) {
+	std::unique_lock lck(mtx_);
+	if (!items_.empty()) {
+		NsItems items = std::move(items_.front());
+		items_.pop_front();
+		lck.unlock();
+		MemAccountingScope scope(account, MemAccount::Data);
+		if (!items.ReleasePages(kPagesPerStep)) {
+			lck.lock();
+			items_.emplace_front(std::move(items));
+		}
+	} else if (!indexes_.empty()) {
+		std::unique_ptr<Index> index = std::move(indexes_.front());
+		indexes_.pop_front();
+		lck.unlock();
+		MemAccountingScope scope(account, index->IsFulltext() ? MemAccount::Fulltext : MemAccount::Indexes);
+		index.reset();
+	} else {
+		return true;
+	}
+	if (!lck.owns_lock()) lck.lock();
+	return items_.empty() && indexes_.empty();
+}
+
+bool MemoryReclaimer::Empty() const {
+	std::lock_guard lck(mtx_);
+	return items_.empty() && indexes_.empty();
+}
+
+}  // namespace reindexer
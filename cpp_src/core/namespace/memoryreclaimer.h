@@ -0,0 +1,40 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "nsitems.h"
+
+namespace reindexer {
+
+class Index;
+class MemAccount;
+
+/// Data of the truncated and dropped namespaces, which is released in background by the small portions, so the callers are not blocked
+/// by the release of the large namespace and the allocator doesn't spike (see NamespaceImpl::Truncate and ReindexerImpl::closeNamespace)
+class MemoryReclaimer {
+public:
+	// Count of the items pages, which are released by the single step
+	static constexpr size_t kPagesPerStep = 64;
+
+	MemoryReclaimer();
+	MemoryReclaimer(const MemoryReclaimer &) = delete;
+	MemoryReclaimer &operator=(const MemoryReclaimer &) = delete;
+	~MemoryReclaimer();
+
+	void Add(NsItems &&items);
+	void Add(std::unique_ptr<Index> &&index);
+	/// Releases the next portion of the data: up to kPagesPerStep pages of the items or the single index.
+	/// Memory is released without the lock, so the new data may be added concurrently
+	/// @param account - account of the namespace, which is charged by the released memory
+	/// @return true, if there is nothing to release anymore
+	bool ReleaseStep(MemAccount *account);
+	bool Empty() const;
+
+private:
+	mutable std::mutex mtx_;
+	std::deque<NsItems> items_;
+	std::deque<std::unique_ptr<Index>> indexes_;
+};
+
+}  // namespace reindexer
@@ -1,4 +1,5 @@
 #include "namespace.h"
+#include <numeric>
 #include "core/storage/storagefactory.h"
 #include "tools/flagguard.h"
 #include "tools/fsops.h"
@@ -59,13 +60,69 @@ void Namespace::CommitTransaction(Transaction& tx, QueryResults& result, const R
 			}
 			ns = ns_;
 			lck.unlock();
-			ns->storage_.TryForceFlush();
+			ns->storage_.FlushOnCommit();
 			return;
 		}
 	}
 	handleInvalidation(NamespaceImpl::CommitTransaction)(tx, result, NsContext(ctx));
 }
 
+void Namespace::CommitTransactions(span<Ptr> nss, span<Transaction> txs, span<QueryResults> results, const RdxContext& ctx) {
+	assertrx(nss.size() == txs.size() && nss.size() == results.size());
+	if (nss.empty()) return;
+	// Locks are acquired in the same order by all of the batches to avoid the deadlocks
+	std::vector<size_t> order(nss.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&nss](size_t lhs, size_t rhs) { return nss[lhs].get() < nss[rhs].get(); });
+	std::vector<NamespaceImpl::Ptr> impls(nss.size());
+	std::vector<NamespaceImpl::Locker::WLockT> locks(nss.size());
+	while (true) {
+		try {
+			for (size_t i : order) {
+				impls[i] = nss[i]->awaitMainNs(ctx);
+				CounterGuardAIR32 cg(impls[i]->cancelCommitCnt_);
+				locks[i] = impls[i]->wLock(ctx);
+			}
+			break;
+		} catch (const Error& e) {
+			for (auto& lck : locks) {
+				if (lck.owns_lock()) lck.unlock();
+			}
+			if (e.code() != errNamespaceInvalidated) throw;
+			std::this_thread::yield();
+		}
+	}
+
+	for (size_t i = 0; i < nss.size(); ++i) {
+		if (impls[i]->enablePerfCounters_.load(std::memory_order_relaxed)) nss[i]->txStatsCounter_.Count(txs[i]);
+	}
+	std::vector<Error> errors(nss.size());
+	auto commit = [&](size_t i) {
+		try {
+			impls[i]->CommitTransaction(txs[i], results[i], NsContext(ctx).NoLock());
+		} catch (const Error& e) {
+			errors[i] = e;
+		}
+	};
+	std::vector<std::thread> threads;
+	threads.reserve(nss.size() - 1);
+	for (size_t i = 1; i < nss.size(); ++i) {
+		try {
+			threads.emplace_back(commit, i);
+		} catch (const std::system_error&) {
+			commit(i);
+		}
+	}
+	commit(0);
+	for (auto& th : threads) th.join();
+
+	for (auto& lck : locks) lck.unlock();
+	for (auto& ns : impls) ns->storage_.FlushOnCommit();
+	for (auto& err : errors) {
+		if (!err.ok()) throw err;
+	}
+}
+
 NamespacePerfStat Namespace::GetPerfStat(const RdxContext& ctx) {
 	NamespacePerfStat stats = handleInvalidation(NamespaceImpl::GetPerfStat)(ctx);
 	stats.transactions = txStatsCounter_.Get();
@@ -82,13 +139,38 @@ NamespacePerfStat Namespace::GetPerfStat(const RdxContext& ctx) {
 	return stats;
 }
 
+void Namespace::Delete(const Query& query, QueryResults& result, const NsContext& ctx) {
+	const size_t chunkSize = deleteChunkSize_.load(std::memory_order_relaxed);
+	if (!chunkSize || ctx.inTransaction || query.HasLimit() || query.HasOffset()) {
+		nsFuncWrapper<&NamespaceImpl::Delete>(query, result, ctx);
+		return;
+	}
+	// Items are deleted by the chunks, so the write lock is released between them. Each chunk selects the items, which still match the query
+	Query chunkQuery(query);
+	chunkQuery.Limit(chunkSize);
+	for (;;) {
+		const size_t count = result.Count();
+		nsFuncWrapper<&NamespaceImpl::Delete>(chunkQuery, result, ctx);
+		if (result.Count() - count < chunkSize) return;
+	}
+}
+
 bool Namespace::needNamespaceCopy(const NamespaceImpl::Ptr& ns, const Transaction& tx) const noexcept {
 	auto stepsCount = tx.GetSteps().size();
 	auto startCopyPolicyTxSize = static_cast<uint32_t>(startCopyPolicyTxSize_.load(std::memory_order_relaxed));
 	auto copyPolicyMultiplier = static_cast<uint32_t>(copyPolicyMultiplier_.load(std::memory_order_relaxed));
 	auto txSizeToAlwaysCopy = static_cast<uint32_t>(txSizeToAlwaysCopy_.load(std::memory_order_relaxed));
-	return ((stepsCount >= startCopyPolicyTxSize) && (ns->GetItemsCapacity() <= copyPolicyMultiplier * stepsCount)) ||
-		   (stepsCount >= txSizeToAlwaysCopy);
+	const bool needCopy = ((stepsCount >= startCopyPolicyTxSize) && (ns->GetItemsCapacity() <= copyPolicyMultiplier * stepsCount)) ||
+						  (stepsCount >= txSizeToAlwaysCopy);
+	if (!needCopy) return false;
+	// Copy lets the selects run during the commit. If there are no selects, transaction is committed in place without doubling of memory
+	const int selectIdleThreshold = txCopySelectIdleThreshold_.load(std::memory_order_relaxed);
+	if (selectIdleThreshold > 0) {
+		const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		// Select time has seconds precision, so the namespace is idle for sure, if the difference is greater than threshold
+		if (now - ns->getLastSelectTime() > selectIdleThreshold) return false;
+	}
+	return true;
 }
 
 void Namespace::doRename(Namespace::Ptr dst, const std::string& newName, const std::string& storagePath, const RdxContext& ctx) {
@@ -96,6 +178,7 @@ void Namespace::doRename(Namespace::Ptr dst, const std::string& newName, const s
 	awaitMainNs(ctx)->storage_.Flush();
 	auto lck = handleInvalidation(NamespaceImpl::wLock)(ctx);
 	auto& srcNs = *atomicLoadMainNs();	// -V758
+	srcNs.checkReadOnly();
 	NamespaceImpl::Mutex* dstMtx = nullptr;
 	NamespaceImpl::Ptr dstNs;
 	if (dst) {
@@ -112,6 +195,10 @@ void Namespace::doRename(Namespace::Ptr dst, const std::string& newName, const s
 				}
 			}
 		}
+		if (dstNs->storage_.IsReadOnly()) {
+			dstMtx->unlock();
+			throw Error(errLogic, "Can't replace ns '%s' with read only storage", dstNs->name_);
+		}
 		dbpath = dstNs->storage_.Path();
 	} else if (newName == srcNs.name_) {
 		return;
@@ -159,6 +246,7 @@ void Namespace::doRename(Namespace::Ptr dst, const std::string& newName, const s
 			throw status;
 		}
 		srcNs.wal_.SetStorage(srcNs.storage_.GetStoragePtr(), false);
+		srcNs.payloadType_->GetColdTuples()->SetStorage(srcNs.storage_.GetStoragePtr());
 	}
 	if (srcNs.repl_.temporary) {
 		srcNs.repl_.temporary = false;
@@ -17,6 +17,9 @@ public:
 	typedef shared_ptr<Namespace> Ptr;
 
 	void CommitTransaction(Transaction &tx, QueryResults &result, const RdxContext &ctx);
+	/// Commits the transactions of the different namespaces under the write locks of all of them, so the changes of each namespace are
+	/// visible only after all of the transactions are applied. Transactions are applied by the separate threads
+	static void CommitTransactions(span<Ptr> nss, span<Transaction> txs, span<QueryResults> results, const RdxContext &ctx);
 	string GetName(const RdxContext &ctx) const { return handleInvalidation(NamespaceImpl::GetName)(ctx); }
 	bool IsSystem(const RdxContext &ctx) const { return handleInvalidation(NamespaceImpl::IsSystem)(ctx); }
 	bool IsTemporary(const RdxContext &ctx) const { return handleInvalidation(NamespaceImpl::IsTemporary)(ctx); }
@@ -26,8 +29,13 @@ public:
 	void LoadFromStorage(unsigned threadsCount, const RdxContext &ctx) {
 		handleInvalidation(NamespaceImpl::LoadFromStorage)(threadsCount, ctx);
 	}
+	void LoadLazyItems(const RdxContext &ctx) { handleInvalidation(NamespaceImpl::LoadLazyItems)(ctx); }
 	void DeleteStorage(const RdxContext &ctx) { handleInvalidation(NamespaceImpl::DeleteStorage)(ctx); }
+	void BulkLoad(const NamespaceImpl::ItemsSourceT &source, unsigned threadsCount, const RdxContext &ctx) {
+		handleInvalidation(NamespaceImpl::BulkLoad)(source, threadsCount, ctx);
+	}
 	uint32_t GetItemsCount() { return handleInvalidation(NamespaceImpl::GetItemsCount)(); }
+	NamespaceMetrics GetMetrics(bool withPerfStats) { return handleInvalidation(NamespaceImpl::GetMetrics)(withPerfStats); }
 	void AddIndex(const IndexDef &indexDef, const RdxContext &ctx) { handleInvalidation(NamespaceImpl::AddIndex)(indexDef, ctx); }
 	void UpdateIndex(const IndexDef &indexDef, const RdxContext &ctx) { handleInvalidation(NamespaceImpl::UpdateIndex)(indexDef, ctx); }
 	void DropIndex(const IndexDef &indexDef, const RdxContext &ctx) { handleInvalidation(NamespaceImpl::DropIndex)(indexDef, ctx); }
@@ -49,10 +57,14 @@ public:
 		nsFuncWrapper<void (NamespaceImpl::*)(Item &, const NsContext &), &NamespaceImpl::Delete>(item, ctx);
 	}
 	void Delete(Item &item, QueryResults &qr, const NsContext &ctx) { nsFuncWrapper<&NamespaceImpl::Delete>(item, qr, ctx); }
-	void Delete(const Query &query, QueryResults &result, const NsContext &ctx) {
-		nsFuncWrapper<&NamespaceImpl::Delete>(query, result, ctx);
-	}
+	void Delete(const Query &query, QueryResults &result, const NsContext &ctx);
 	void Truncate(const NsContext &ctx) { handleInvalidation(NamespaceImpl::Truncate)(ctx); }
+	void DropData(const RdxContext &ctx) { handleInvalidation(NamespaceImpl::DropData)(ctx); }
+	bool ReleaseGarbage() { return handleInvalidation(NamespaceImpl::ReleaseGarbage)(); }
+	void FillPointReads(const QueryResults &result, const RdxContext &ctx) {
+		handleInvalidation(NamespaceImpl::FillPointReads)(result, ctx);
+	}
+	void ModifyBatch(span<ItemModification> mods, const RdxContext &ctx) { handleInvalidation(NamespaceImpl::ModifyBatch)(mods, ctx); }
 	void Select(QueryResults &result, SelectCtx &params, const RdxContext &ctx) {
 		handleInvalidation(NamespaceImpl::Select)(result, params, ctx);
 	}
@@ -66,12 +78,13 @@ public:
 		handleInvalidation(NamespaceImpl::ResetPerfStat)(ctx);
 	}
 	vector<string> EnumMeta(const RdxContext &ctx) { return handleInvalidation(NamespaceImpl::EnumMeta)(ctx); }
-	void BackgroundRoutine(RdxActivityContext *ctx) {
+	void BackgroundRoutine(RdxActivityContext *ctx, unsigned tasks = BackgroundAll) {
 		if (hasCopy_.load(std::memory_order_acquire)) {
 			return;
 		}
-		handleInvalidation(NamespaceImpl::BackgroundRoutine)(ctx);
+		handleInvalidation(NamespaceImpl::BackgroundRoutine)(ctx, tasks);
 	}
+	bool SortOrdersBuilt() const { return handleInvalidation(NamespaceImpl::SortOrdersBuilt)(); }
 	void StorageFlushingRoutine() {
 		if (hasCopy_.load(std::memory_order_acquire)) {
 			return;
@@ -97,6 +110,12 @@ public:
 	void FillResult(QueryResults &result, IdSet::Ptr ids) const { handleInvalidation(NamespaceImpl::FillResult)(result, ids); }
 	void EnablePerfCounters(bool enable = true) { handleInvalidation(NamespaceImpl::EnablePerfCounters)(enable); }
 	ReplicationState GetReplState(const RdxContext &ctx) const { return handleInvalidation(NamespaceImpl::GetReplState)(ctx); }
+	std::vector<uint64_t> GetDataHashBuckets(const RdxContext &ctx) const {
+		return handleInvalidation(NamespaceImpl::GetDataHashBuckets)(ctx);
+	}
+	void ReplaceDataHashBuckets(const std::vector<unsigned> &buckets, std::vector<Item> &items, const RdxContext &ctx) {
+		handleInvalidation(NamespaceImpl::ReplaceDataHashBuckets)(buckets, items, ctx);
+	}
 	void SetReplLSNs(LSNPair LSNs, const RdxContext &ctx) { handleInvalidation(NamespaceImpl::SetReplLSNs)(LSNs, ctx); }
 	void SetSlaveReplStatus(ReplicationState::Status status, const Error &error, const RdxContext &ctx) {
 		handleInvalidation(NamespaceImpl::SetSlaveReplStatus)(status, error, ctx);
@@ -125,6 +144,8 @@ public:
 		startCopyPolicyTxSize_.store(configData.startCopyPolicyTxSize, std::memory_order_relaxed);
 		copyPolicyMultiplier_.store(configData.copyPolicyMultiplier, std::memory_order_relaxed);
 		txSizeToAlwaysCopy_.store(configData.txSizeToAlwaysCopy, std::memory_order_relaxed);
+		txCopySelectIdleThreshold_.store(configData.txCopySelectIdleThreshold, std::memory_order_relaxed);
+		deleteChunkSize_.store(configData.deleteChunkSize, std::memory_order_relaxed);
 		handleInvalidation(NamespaceImpl::OnConfigUpdated)(configProvider, ctx);
 	}
 	StorageOpts GetStorageOpts(const RdxContext &ctx) { return handleInvalidation(NamespaceImpl::GetStorageOpts)(ctx); }
@@ -224,6 +245,8 @@ private:
 	std::atomic<int> startCopyPolicyTxSize_;
 	std::atomic<int> copyPolicyMultiplier_;
 	std::atomic<int> txSizeToAlwaysCopy_;
+	std::atomic<int> txCopySelectIdleThreshold_ = {0};
+	std::atomic<int> deleteChunkSize_ = {0};
 	TxStatCounter txStatsCounter_;
 	PerfStatCounterMT commitStatsCounter_;
 	PerfStatCounterMT copyStatsCounter_;
@@ -1,7 +1,9 @@
 #include "core/namespace/namespaceimpl.h"
+#include <snappy.h>
 #include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <future>
 #include <memory>
 #include "core/cjson/jsonbuilder.h"
 #include "core/index/index.h"
@@ -13,6 +15,8 @@
 #include "core/rdxcontext.h"
 #include "core/selectfunc/functionexecutor.h"
 #include "itemsloader.h"
+#include "itemswriter.h"
+#include "itemssnapshot.h"
 #include "namespace.h"
 #include "replicator/updatesobserver.h"
 #include "replicator/walselecter.h"
@@ -21,7 +25,9 @@
 #include "tools/fsops.h"
 #include "tools/logger.h"
 #include "tools/stringstools.h"
+#include "tools/threadpool.h"
 #include "tools/timetools.h"
+#include "tools/workstealingscheduler.h"
 
 using std::chrono::duration_cast;
 using std::chrono::high_resolution_clock;
@@ -37,10 +43,20 @@ using std::defer_lock;
 #define kStorageTagsPrefix "tags"
 #define kStorageMetaPrefix "meta"
 #define kStorageCachePrefix "cache"
+#define kStorageItemsSnapshotPrefix "items_snapshot"
+#define kStorageColdTuplePrefix "C"
 #define kTupleName "-tuple"
 
-static const string kPKIndexName = "#pk";
+const string kPKIndexName = "#pk";
 constexpr int kWALStatementItemsThreshold = 5;
+// Count of the items, which keys are collected and deleted from the indexes at once by the delete query
+constexpr size_t kBulkDeleteBatchSize = 4096;
+// Count of the items of the update query or the transaction, which are prepared by the workers at once (see parallel_update_workers)
+constexpr size_t kParallelUpdateBatchSize = 64 * 1024;
+// Minimal count of the steps of the transaction, which storage and replication records are written by the separate thread
+constexpr size_t kMinPipelinedTxSize = 1000;
+// Count of the written items, which the committing thread may outrun the writer by
+constexpr size_t kItemsWriterQueueSize = 1024;
 
 #define kStorageMagic 0x1234FEDC
 #define kStorageVersion 0x8
@@ -51,6 +67,18 @@ constexpr int64_t kStorageSerialInitial = 1;
 constexpr uint8_t kSysRecordsBackupCount = 8;
 constexpr uint8_t kSysRecordsFirstWriteCopies = 3;
 constexpr size_t kMaxMemorySizeOfStringsHolder = 1ull << 24;
+// Marker file in the storage directory of the namespace image, which is shared by the several processes. Such storage is opened read only
+constexpr std::string_view kStorageReadOnlyMarker = "read_only";
+// Compression of the smaller items doesn't save anything
+constexpr size_t kMinCompressedStorageItemSize = 64;
+constexpr int64_t kColdTuplesSweepPeriodSec = 1;
+// Limits duration of the write lock of the single eviction pass
+constexpr size_t kColdTuplesSweepMaxItems = 100000;
+constexpr size_t kColdTuplesSweepMaxChanges = 10000;
+// Eviction of the smaller tuples doesn't save enough memory to pay for the storage reads
+constexpr size_t kMinColdTupleSize = 64;
+// Compaction rebuilds all the indexes, so it's not worth to run it for the few free rows
+constexpr size_t kMinFreeItemsForCompaction = 10000;
 
 NamespaceImpl::IndexesStorage::IndexesStorage(const NamespaceImpl &ns) : ns_(ns) {}
 
@@ -58,7 +86,8 @@ void NamespaceImpl::IndexesStorage::MoveBase(IndexesStorage &&src) { Base::opera
 
 // private implementation and NOT THREADSAFE of copy CTOR
 NamespaceImpl::NamespaceImpl(const NamespaceImpl &src, AsyncStorage::FullLockT &storageLock)
-	: indexes_{*this},
+	: memAccount_{src.memAccount_.Account()},
+	  indexes_{*this},
 	  indexesNames_{src.indexesNames_},
 	  items_{src.items_},
 	  free_{src.free_},
@@ -78,9 +107,10 @@ NamespaceImpl::NamespaceImpl(const NamespaceImpl &src, AsyncStorage::FullLockT &
 	  config_{src.config_},
 	  wal_{src.wal_},
 	  repl_{src.repl_},
+	  dataHashBuckets_{src.dataHashBuckets_},
 	  observers_{src.observers_},
 	  storageOpts_{src.storageOpts_},
-	  lastSelectTime_{0},
+	  lastSelectTime_{src.lastSelectTime_.load()},
 	  cancelCommitCnt_{0},
 	  lastUpdateTime_{src.lastUpdateTime_.load(std::memory_order_acquire)},
 	  itemsCount_{static_cast<uint32_t>(items_.size())},
@@ -89,16 +119,31 @@ NamespaceImpl::NamespaceImpl(const NamespaceImpl &src, AsyncStorage::FullLockT &
 	  serverId_{src.serverId_},
 	  itemsDataSize_{src.itemsDataSize_},
 	  optimizationState_{NotOptimized},
-	  strHolder_{makeStringsHolder()} {
-	for (auto &idxIt : src.indexes_) indexes_.push_back(idxIt->Clone());
+	  strHolder_{makeStringsHolder()},
+	  itemsSnapshotActual_{src.itemsSnapshotActual_},
+	  itemsAccess_{src.itemsAccess_},
+	  coldTuplesStubs_{src.coldTuplesStubs_},
+	  coldTuplesSeq_{src.coldTuplesSeq_},
+	  coldTuplesHand_{src.coldTuplesHand_},
+	  materializedAggregations_{src.materializedAggregations_},
+	  pathsIndex_{src.pathsIndex_} {
+	for (auto &idxIt : src.indexes_) {
+		auto idxMemScope = indexMemScope(*idxIt);
+		indexes_.push_back(idxIt->Clone());
+	}
+	locker_.Stats().Enable(enablePerfCounters_);
+	resetResultsCache();
+	pointReads_.Reset(config_.pointReadsCacheSize);
 
 	markUpdated(true);
 	logPrintf(LogInfo, "Namespace::CopyContentsFrom (%s).Workers: %d, timeout: %d", name_, config_.optimizationSortWorkers,
 			  config_.optimizationTimeout);
+	memAccount_.Leave();
 }
 
 NamespaceImpl::NamespaceImpl(const string &name, UpdatesObservers &observers)
-	: indexes_(*this),
+	: memAccount_(std::make_shared<MemAccount>()),
+	  indexes_(*this),
 	  name_(name),
 	  payloadType_(name),
 	  tagsMatcher_(payloadType_),
@@ -119,13 +164,15 @@ NamespaceImpl::NamespaceImpl(const string &name, UpdatesObservers &observers)
 	itemsCapacity_.store(items_.capacity());
 	optimizationState_.store(NotOptimized);
 
+	payloadType_.SetColdTuples(std::make_shared<ColdTuples>());
 	// Add index and payload field for tuple of non indexed fields
 	IndexDef tupleIndexDef(kTupleName, {}, IndexStrStore, IndexOpts());
 	addIndex(tupleIndexDef);
-	updateSelectTime();
+	// Namespace, which was never selected, is idle for the transactions commit (see tx_copy_select_idle_threshold)
 
 	logPrintf(LogInfo, "Namespace::Construct (%s).Workers: %d, timeout: %d", name_, config_.optimizationSortWorkers,
 			  config_.optimizationTimeout);
+	memAccount_.Leave();
 }
 
 NamespaceImpl::~NamespaceImpl() {
@@ -148,6 +195,20 @@ NamespaceImpl::~NamespaceImpl() {
 #endif
 
 	logPrintf(LogTrace, "Namespace::~Namespace (%s), %d items", name_, items_.size());
+
+	// Indexes are released here to charge them to their subsystems. Caches were not charged at all. Other members are charged by memAccount_
+	{
+		auto cachesMemScope = memScope(MemAccount::Untracked);
+		for (auto &idx : indexes_) idx->ClearCache();
+		queryCache_.reset();
+		joinCache_.reset();
+		resultsCache_.reset();
+	}
+	for (auto &idx : indexes_) {
+		auto idxMemScope = indexMemScope(*idx);
+		idx.reset();
+	}
+	memAccount_.Enter();
 }
 
 void NamespaceImpl::OnConfigUpdated(DBConfigProvider &configProvider, const RdxContext &ctx) {
@@ -156,6 +217,7 @@ void NamespaceImpl::OnConfigUpdated(DBConfigProvider &configProvider, const RdxC
 	ReplicationConfigData replicationConf = configProvider.GetReplicationConfig();
 
 	enablePerfCounters_ = configProvider.GetProfilingConfig().perfStats;
+	locker_.Stats().Enable(enablePerfCounters_);
 
 	auto wlck = wLock(ctx);
 
@@ -166,10 +228,21 @@ void NamespaceImpl::OnConfigUpdated(DBConfigProvider &configProvider, const RdxC
 				  config_.optimizationSortWorkers, configData.optimizationSortWorkers, config_.optimizationTimeout,
 				  configData.optimizationTimeout);
 	}
+	const bool needRebuildMaterializedAggregations = config_.materializedAggregations != configData.materializedAggregations;
+	const bool needRebuildPathsIndex = config_.pathsIndex != configData.pathsIndex;
+	const bool needResetResultsCache = config_.queryResultsCacheSize != configData.queryResultsCacheSize;
+	const bool needResetPointReads = config_.pointReadsCacheSize != configData.pointReadsCacheSize;
 	config_ = configData;
+	if (needRebuildMaterializedAggregations) rebuildMaterializedAggregations();
+	if (needRebuildPathsIndex) rebuildPathsIndex();
+	if (needResetResultsCache) resetResultsCache();
+	if (needResetPointReads) pointReads_.Reset(config_.pointReadsCacheSize);
 	storageOpts_.LazyLoad(configData.lazyLoad);
 	storageOpts_.noQueryIdleThresholdSec = configData.noQueryIdleThreshold;
 	storage_.SetForceFlushLimit(config_.syncStorageFlushLimit);
+	storage_.SetGroupCommitPolicy(config_.storageGroupCommitDeadline, config_.storageGroupCommitSize);
+	storage_.SetForceFlushBytesLimit(config_.syncStorageFlushBytesLimit);
+	storage_.SetDurableCommit(config_.storageDurableCommit);
 
 	for (auto &idx : indexes_) {
 		idx->EnableUpdatesCountingMode(configData.idxUpdatesCountingMode);
@@ -179,6 +252,8 @@ void NamespaceImpl::OnConfigUpdated(DBConfigProvider &configProvider, const RdxC
 		updateSortedIdxCount();
 	}
 
+	// Spill limits are applied before resize, so the records, which are dropped by WAL shrinking, are spilled too
+	wal_.SetSpillLimits(config_.walSpillBytesLimit, config_.walSpillTTL);
 	if (wal_.Resize(config_.walSize)) {
 		logPrintf(LogInfo, "[%s] WAL has been resized lsn #%s, max size %ld", name_, repl_.lastLsn, wal_.Capacity());
 	}
@@ -262,6 +337,7 @@ void NamespaceImpl::recreateCompositeIndexes(int startIdx, int endIdx) {
 
 void NamespaceImpl::updateItems(PayloadType oldPlType, const FieldsSet &changedFields, int deltaFields) {
 	logPrintf(LogTrace, "Namespace::updateItems(%s) delta=%d", name_, deltaFields);
+	auto dataMemScope = memScope(MemAccount::Data);
 
 	assertrx(oldPlType->NumFields() + deltaFields == payloadType_->NumFields());
 
@@ -283,14 +359,14 @@ void NamespaceImpl::updateItems(PayloadType oldPlType, const FieldsSet &changedF
 	newItem.Unsafe(true);
 	int errCount = 0;
 	Error lastErr = errOK;
-	repl_.dataHash = 0;
+	resetDataHash();
 	itemsDataSize_ = 0;
 	auto indexesCacheCleaner{GetIndexesCacheCleaner()};
 	for (size_t rowId = 0; rowId < items_.size(); rowId++) {
 		if (items_[rowId].IsFree()) {
 			continue;
 		}
-		PayloadValue &plCurr = items_[rowId];
+		PayloadValue &plCurr = items_.Mutable(rowId);
 		Payload oldValue(oldPlType, plCurr);
 		ItemImpl oldItem(oldPlType, plCurr, tagsMatcher_);
 		oldItem.Unsafe(true);
@@ -307,6 +383,7 @@ void NamespaceImpl::updateItems(PayloadType oldPlType, const FieldsSet &changedF
 
 		for (auto fieldIdx : changedFields) {
 			auto &index = *indexes_[fieldIdx];
+			auto idxMemScope = indexMemScope(index);
 			if ((fieldIdx == 0) || deltaFields <= 0) {
 				oldValue.Get(fieldIdx, skrefsDel, true);
 				bool needClearCache{false};
@@ -325,15 +402,21 @@ void NamespaceImpl::updateItems(PayloadType oldPlType, const FieldsSet &changedF
 		}
 
 		for (int fieldIdx = compositeStartIdx; fieldIdx < compositeEndIdx; ++fieldIdx) {
+			auto idxMemScope = indexMemScope(*indexes_[fieldIdx]);
 			bool needClearCache{false};
 			indexes_[fieldIdx]->Upsert(Variant(plNew), rowId, needClearCache);
 			if (needClearCache && indexes_[fieldIdx]->IsOrdered()) indexesCacheCleaner.Add(indexes_[fieldIdx]->SortId());
 		}
 
 		plCurr = std::move(plNew);
-		repl_.dataHash ^= Payload(payloadType_, plCurr).GetHash();
+		updateDataHash(plCurr);
 		itemsDataSize_ += plCurr.GetCapacity() + sizeof(PayloadValue::dataHeader);
 	}
+	for (auto fieldIdx : changedFields) {
+		indexes_[fieldIdx]->BulkInsertionDone();
+	}
+	// Indexes are renumbered, so the join cache is cleared entirely
+	updatedFields_.reset();
 	markUpdated(false);
 	if (errCount != 0) {
 		logPrintf(LogError, "Can't update indexes of %d items in namespace %s: %s", errCount, name_, lastErr.what());
@@ -370,9 +453,16 @@ void NamespaceImpl::AddIndex(const IndexDef &indexDef, const RdxContext &ctx) {
 		}
 	}
 
+	PrebuiltIndex prebuilt;
+	if (IsComposite(indexDef.Type())) {
+		prebuilt = prebuildCompositeIndex(indexDef, ctx);
+	}
+
 	auto wlck = wLock(ctx);
 
-	addIndex(indexDef);
+	addIndex(indexDef, &prebuilt);
+	rebuildMaterializedAggregations();
+	rebuildPathsIndex();
 	saveIndexesToStorage();
 	addToWAL(indexDef, WalIndexAdd, ctx);
 }
@@ -385,19 +475,25 @@ void NamespaceImpl::DumpIndex(std::ostream &os, std::string_view index, const Rd
 void NamespaceImpl::UpdateIndex(const IndexDef &indexDef, const RdxContext &ctx) {
 	auto wlck = wLock(ctx);
 	updateIndex(indexDef);
+	rebuildMaterializedAggregations();
+	rebuildPathsIndex();
 	saveIndexesToStorage();
 	addToWAL(indexDef, WalIndexUpdate, ctx);
 }
 
 void NamespaceImpl::DropIndex(const IndexDef &indexDef, const RdxContext &ctx) {
 	auto wlck = wLock(ctx);
+	checkReadOnly();
 	dropIndex(indexDef);
+	rebuildMaterializedAggregations();
+	rebuildPathsIndex();
 	saveIndexesToStorage();
 	addToWAL(indexDef, WalIndexDrop, ctx);
 }
 
 void NamespaceImpl::SetSchema(std::string_view schema, const RdxContext &ctx) {
 	auto wlck = wLock(ctx);
+	checkReadOnly();
 	schema_ = make_shared<Schema>(schema);
 	auto fields = schema_->GetPaths();
 	for (auto &field : fields) {
@@ -405,6 +501,9 @@ void NamespaceImpl::SetSchema(std::string_view schema, const RdxContext &ctx) {
 	}
 
 	schema_->BuildProtobufSchema(tagsMatcher_, payloadType_);
+	// Contexts of the cached results hold the previous schema
+	invalidateResultsCache();
+	pointReads_.Clear();
 
 	saveSchemaToStorage();
 	addToWAL(schema, WalSetSchema, ctx);
@@ -437,6 +536,9 @@ void NamespaceImpl::dumpIndex(std::ostream &os, std::string_view index) const {
 }
 
 void NamespaceImpl::dropIndex(const IndexDef &index) {
+	auto idxMemScope = memScope(IsFullText(index.Type()) ? MemAccount::Fulltext : MemAccount::Indexes);
+	// Cached items are keyed by the primary key, which may be changed with the indexes
+	pointReads_.Clear();
 	auto itIdxName = indexesNames_.find(index.name_);
 	if (itIdxName == indexesNames_.end()) {
 		const char *errMsg = "Cannot remove index %s: doesn't exist";
@@ -563,7 +665,9 @@ void NamespaceImpl::verifyUpdateIndex(const IndexDef &indexDef) const {
 	}
 }
 
-void NamespaceImpl::addIndex(const IndexDef &indexDef) {
+void NamespaceImpl::addIndex(const IndexDef &indexDef, PrebuiltIndex *prebuilt) {
+	auto idxMemScope = memScope(IsFullText(indexDef.Type()) ? MemAccount::Fulltext : MemAccount::Indexes);
+	pointReads_.Clear();
 	string indexName = indexDef.name_;
 
 	auto idxNameIt = indexesNames_.find(indexName);
@@ -581,6 +685,7 @@ void NamespaceImpl::addIndex(const IndexDef &indexDef) {
 		if (newIndexDef == oldIndexDef) {
 			return;
 		} else {
+			checkReadOnly();
 			if (oldIndexDef.Type() == IndexTtl) {
 				oldIndexDef.expireAfter_ = newIndexDef.expireAfter_;
 				if (oldIndexDef == newIndexDef) {
@@ -592,6 +697,7 @@ void NamespaceImpl::addIndex(const IndexDef &indexDef) {
 			throw Error(errConflict, "Index '%s.%s' already exists with different settings", name_, indexName);
 		}
 	}
+	checkReadOnly();
 
 	// New index case. Just add
 	if (currentPKIndex != indexesNames_.end() && opts.IsPK()) {
@@ -600,7 +706,7 @@ void NamespaceImpl::addIndex(const IndexDef &indexDef) {
 	}
 
 	if (IsComposite(indexDef.Type())) {
-		addCompositeIndex(indexDef);
+		addCompositeIndex(indexDef, prebuilt);
 		return;
 	}
 
@@ -638,6 +744,7 @@ void NamespaceImpl::addIndex(const IndexDef &indexDef) {
 
 void NamespaceImpl::updateIndex(const IndexDef &indexDef) {
 	const string &indexName = indexDef.name_;
+	pointReads_.Clear();
 
 	IndexDef foundIndex = getIndexDefinition(indexName);
 
@@ -650,6 +757,7 @@ void NamespaceImpl::updateIndex(const IndexDef &indexDef) {
 		}
 		return;
 	}
+	checkReadOnly();
 
 	verifyUpdateIndex(indexDef);
 	dropIndex(indexDef);
@@ -681,19 +789,15 @@ void NamespaceImpl::verifyUpdateCompositeIndex(const IndexDef &indexDef) const {
 	const auto newIndex = std::unique_ptr<Index>(Index::New(indexDef, payloadType_, {}));
 }
 
-void NamespaceImpl::addCompositeIndex(const IndexDef &indexDef) {
-	string indexName = indexDef.name_;
-	IndexType type = indexDef.Type();
-	IndexOpts opts = indexDef.opts_;
-
-	FieldsSet fields;
-
+bool NamespaceImpl::compositeIndexFields(const IndexDef &indexDef, bool addTags, FieldsSet &fields) {
+	const IndexType type = indexDef.Type();
 	for (auto &jsonPathOrSubIdx : indexDef.jsonPaths_) {
 		auto idxNameIt = indexesNames_.find(jsonPathOrSubIdx);
 		if (idxNameIt == indexesNames_.end()) {
-			TagsPath tagsPath = tagsMatcher_.path2tag(jsonPathOrSubIdx, true);
+			TagsPath tagsPath = tagsMatcher_.path2tag(jsonPathOrSubIdx, addTags);
 			if (tagsPath.empty()) {
-				throw Error(errParams, "Subindex '%s' for composite index '%s' does not exist", jsonPathOrSubIdx, indexName);
+				if (!addTags) return false;
+				throw Error(errParams, "Subindex '%s' for composite index '%s' does not exist", jsonPathOrSubIdx, indexDef.name_);
 			}
 			fields.push_back(tagsPath);
 			fields.push_back(jsonPathOrSubIdx);
@@ -702,16 +806,67 @@ void NamespaceImpl::addCompositeIndex(const IndexDef &indexDef) {
 			fields.push_back(indexes_[idxNameIt->second]->Fields().getTagsPath(0));
 		} else {
 			if (indexes_[idxNameIt->second]->Opts().IsArray() && (type == IndexCompositeBTree || type == IndexCompositeHash)) {
-				throw Error(errParams, "Cannot add array subindex '%s' to composite index '%s'", jsonPathOrSubIdx, indexName);
+				throw Error(errParams, "Cannot add array subindex '%s' to composite index '%s'", jsonPathOrSubIdx, indexDef.name_);
 			}
 			fields.push_back(idxNameIt->second);
 		}
 	}
-
 	assertrx(fields.getJsonPathsLength() == fields.getTagsPathsLength());
+	return true;
+}
+
+NamespaceImpl::PrebuiltIndex NamespaceImpl::prebuildCompositeIndex(const IndexDef &indexDef, const RdxContext &ctx) {
+	auto idxMemScope = memScope(MemAccount::Indexes);
+	PrebuiltIndex res;
+	{
+		auto rlck = rLock(ctx);
+		if (items_.size() < kMinItemsForOnlineIndexBuild || indexesNames_.find(indexDef.name_) != indexesNames_.end()) {
+			return res;
+		}
+		// Tags for the new json paths are added under the write lock only
+		if (!compositeIndexFields(indexDef, false, res.fields)) return res;
+		res.payloadType = payloadType_;
+		res.index = Index::New(indexDef, payloadType_, res.fields);
+		// Pages of the items and the payloads are copy-on-write, so the snapshot is not changed by the concurrent writers
+		res.items = items_;
+	}
+
+	bool needClearCache{false};
+	for (IdType rowId = 0; rowId < IdType(res.items.size()); ++rowId) {
+		if (!res.items[rowId].IsFree()) {
+			res.index->Upsert(Variant(res.items[rowId]), rowId, needClearCache);
+		}
+	}
+	return res;
+}
+
+void NamespaceImpl::addCompositeIndex(const IndexDef &indexDef, PrebuiltIndex *prebuilt) {
+	auto idxMemScope = memScope(MemAccount::Indexes);
+	const string &indexName = indexDef.name_;
+
+	FieldsSet fields;
+	compositeIndexFields(indexDef, true, fields);
 	assertrx(indexesNames_.find(indexName) == indexesNames_.end());
 
 	int idxPos = indexes_.size();
+	if (prebuilt && prebuilt->index && prebuilt->payloadType.get() == payloadType_.get() && prebuilt->fields == fields) {
+		// Catch up on the items, which were changed while the index was built: modified payload is always a new copy
+		auto &index = *prebuilt->index;
+		bool needClearCache{false};
+		const size_t rowsCount = std::max(items_.size(), prebuilt->items.size());
+		for (IdType rowId = 0; rowId < IdType(rowsCount); ++rowId) {
+			const PayloadValue *oldValue = (size_t(rowId) < prebuilt->items.size()) ? &prebuilt->items[rowId] : nullptr;
+			const PayloadValue *newValue = (size_t(rowId) < items_.size()) ? &items_[rowId] : nullptr;
+			if (oldValue && newValue && oldValue->get() == newValue->get()) continue;
+			if (oldValue && !oldValue->IsFree()) index.Delete(Variant(*oldValue), rowId, *strHolder_, needClearCache);
+			if (newValue && !newValue->IsFree()) index.Upsert(Variant(*newValue), rowId, needClearCache);
+		}
+		prebuilt->items.clear();
+		insertIndex(std::move(prebuilt->index), idxPos, indexName);
+		updateSortedIdxCount();
+		return;
+	}
+
 	insertIndex(Index::New(indexDef, payloadType_, fields), idxPos, indexName);
 
 	auto indexesCacheCleaner{GetIndexesCacheCleaner()};
@@ -812,16 +967,27 @@ void NamespaceImpl::Update(const Query &query, QueryResults &result, const NsCon
 		storageAdvice = storage_.AdviceBatching();
 	}
 	ItemModifier itemModifier(query.UpdateFields(), *this);
-	for (ItemRef &item : result.Items()) {
-		assertrx(items_.exists(item.Id()));
-		PayloadValue &pv(items_[item.Id()]);
-		Payload pl(payloadType_, pv);
-		uint64_t oldPlHash = pl.GetHash();
-		size_t oldItemCapacity = pv.GetCapacity();
-		pv.Clone(pl.RealSize());
-		itemModifier.Modify(item.Id(), ctx);
-		replicateItem(item.Id(), ctx, statementReplication, oldPlHash, oldItemCapacity);
-		item.Value() = items_[item.Id()];
+	ItemRefVector &items = result.Items();
+	for (size_t batchBegin = 0; batchBegin < items.size(); batchBegin += kParallelUpdateBatchSize) {
+		// Modified items of the batch are built by the workers, so only their indexes, storage and WAL records are updated here
+		const size_t batchEnd = std::min<size_t>(items.size(), batchBegin + kParallelUpdateBatchSize);
+		itemModifier.PrepareTuples(span<ItemRef>(&items[batchBegin], batchEnd - batchBegin), config_.parallelUpdateWorkers);
+		for (size_t i = batchBegin; i < batchEnd; ++i) {
+			ItemRef &item = items[i];
+			assertrx(items_.exists(item.Id()));
+			const bool cached = erasePointRead(item.Id());
+			PayloadValue &pv(items_.Mutable(item.Id()));
+			Payload pl(payloadType_, pv);
+			uint64_t oldPlHash = pl.GetHash();
+			const unsigned oldDataHashBucket = dataHashBucket(pv);
+			size_t oldItemCapacity = pv.GetCapacity();
+			pv.Clone(pl.RealSize());
+			itemModifier.Modify(item.Id(), ctx);
+			replicateItem(item.Id(), ctx, statementReplication, oldPlHash, oldDataHashBucket, oldItemCapacity);
+			item.Value() = items_[item.Id()];
+			// Modifications of the transaction are not visible until its commit
+			if (cached && !ctx.inTransaction) putPointRead(item.Id());
+		}
 	}
 	result.getTagsMatcher(0) = tagsMatcher_;
 	assertrx(result.IsNamespaceAdded(this));
@@ -849,8 +1015,8 @@ void NamespaceImpl::Update(const Query &query, QueryResults &result, const NsCon
 }
 
 void NamespaceImpl::replicateItem(IdType itemId, const NsContext &ctx, bool statementReplication, uint64_t oldPlHash,
-								  size_t oldItemCapacity) {
-	PayloadValue &pv(items_[itemId]);
+								  unsigned oldDataHashBucket, size_t oldItemCapacity) {
+	PayloadValue &pv(items_.Mutable(itemId));
 	Payload pl(payloadType_, pv);
 
 	if (!statementReplication) {
@@ -867,18 +1033,18 @@ void NamespaceImpl::replicateItem(IdType itemId, const NsContext &ctx, bool stat
 	}
 
 	repl_.dataHash ^= oldPlHash;
-	repl_.dataHash ^= pl.GetHash();
+	dataHashBuckets_[oldDataHashBucket] ^= oldPlHash;
+	updateDataHash(items_[itemId]);
 	itemsDataSize_ -= oldItemCapacity;
 	itemsDataSize_ += pl.Value()->GetCapacity();
 	saveTagsMatcherToStorage(true);
 	if (storage_.IsValid()) {
-		WrSerializer pk, data;
+		invalidateItemsSnapshot();
+		WrSerializer pk;
 		pk << kRxStorageItemPrefix;
 		pl.SerializeFields(pk, pkFields());
-		data.PutUInt64(lsn_t(pv.GetLSN()).Counter());
 		ItemImpl item(payloadType_, pv, tagsMatcher_);
-		item.GetCJSON(data);
-		storage_.Write(pk.Slice(), data.Slice());
+		writeItemToStorage(pk.Slice(), lsn_t(pv.GetLSN()).Counter(), item);
 	}
 }
 
@@ -923,16 +1089,20 @@ void NamespaceImpl::Delete(Item &item, const NsContext &ctx) {
 
 void NamespaceImpl::doDelete(IdType id) {
 	assertrx(items_.exists(id));
+	auto dataMemScope = memScope(MemAccount::Data);
+	erasePointRead(id);
 
-	Payload pl(payloadType_, items_[id]);
+	Payload pl(payloadType_, items_.Mutable(id));
+	pathsIndex_.Remove(id, payloadType_, items_[id]);
 
 	WrSerializer pk;
 	pk << kRxStorageItemPrefix;
 	pl.SerializeFields(pk, pkFields());
 
-	repl_.dataHash ^= pl.GetHash();
+	updateDataHash(items_[id]);
 	wal_.Set(WALRecord(), lsn_t(items_[id].GetLSN()).Counter());
 
+	invalidateItemsSnapshot();
 	storage_.Remove(pk.Slice());
 
 	// erase last item
@@ -942,6 +1112,7 @@ void NamespaceImpl::doDelete(IdType id) {
 	// erase from composite indexes
 	auto indexesCacheCleaner{GetIndexesCacheCleaner()};
 	for (field = indexes_.firstCompositePos(); field < indexes_.totalSize(); ++field) {
+		auto idxMemScope = indexMemScope(*indexes_[field]);
 		bool needClearCache{false};
 		indexes_[field]->Delete(Variant(items_[id]), id, *strHolder_, needClearCache);
 		if (needClearCache && indexes_[field]->IsOrdered()) indexesCacheCleaner.Add(indexes_[field]->SortId());
@@ -967,7 +1138,9 @@ void NamespaceImpl::doDelete(IdType id) {
 		} else {
 			pl.Get(field, skrefs, index.Opts().IsArray());
 		}
+		materializedAggregations_.Remove(field, skrefs);
 		// Delete value from index
+		auto idxMemScope = indexMemScope(index);
 		bool needClearCache{false};
 		index.Delete(skrefs, id, *strHolder_, needClearCache);
 		if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
@@ -975,7 +1148,7 @@ void NamespaceImpl::doDelete(IdType id) {
 
 	// free PayloadValue
 	itemsDataSize_ -= items_[id].GetCapacity() + sizeof(PayloadValue::dataHeader);
-	items_[id].Free();
+	items_.Mutable(id).Free();
 	free_.push_back(id);
 	if (free_.size() == items_.size()) {
 		free_.resize(0);
@@ -984,6 +1157,77 @@ void NamespaceImpl::doDelete(IdType id) {
 	markUpdated(true);
 }
 
+void NamespaceImpl::doDelete(span<IdType> ids) {
+	auto dataMemScope = memScope(MemAccount::Data);
+	invalidateItemsSnapshot();
+	auto indexesCacheCleaner{GetIndexesCacheCleaner()};
+
+	// Holders for tuples. They are required for sparse indexes will be valid
+	VariantArray tupleHolders, skrefs;
+	tupleHolders.reserve(ids.size());
+	WrSerializer pk;
+	for (IdType id : ids) {
+		assertrx(items_.exists(id));
+		erasePointRead(id);
+		Payload pl(payloadType_, items_.Mutable(id));
+		pathsIndex_.Remove(id, payloadType_, items_[id]);
+
+		pk.Reset();
+		pk << kRxStorageItemPrefix;
+		pl.SerializeFields(pk, pkFields());
+
+		updateDataHash(items_[id]);
+		wal_.Set(WALRecord(), lsn_t(items_[id].GetLSN()).Counter());
+		storage_.Remove(pk.Slice());
+
+		// erase from composite indexes
+		for (int field = indexes_.firstCompositePos(); field < indexes_.totalSize(); ++field) {
+			auto idxMemScope = indexMemScope(*indexes_[field]);
+			bool needClearCache{false};
+			indexes_[field]->Delete(Variant(items_[id]), id, *strHolder_, needClearCache);
+			if (needClearCache && indexes_[field]->IsOrdered()) indexesCacheCleaner.Add(indexes_[field]->SortId());
+		}
+		pl.Get(0, skrefs);
+		tupleHolders.insert(tupleHolders.end(), skrefs.begin(), skrefs.end());
+	}
+
+	// Dense and sparse indexes are processed in the same order, as the single item deletion does
+	std::vector<VariantArray> keys(ids.size());
+	assertrx(indexes_.firstCompositePos() != 0);
+	const int borderIdx = indexes_.totalSize() > 1 ? 1 : 0;
+	int field = borderIdx;
+	do {
+		field %= indexes_.firstCompositePos();
+
+		Index &index = *indexes_[field];
+		for (size_t i = 0; i < ids.size(); ++i) {
+			ConstPayload pl(payloadType_, items_[ids[i]]);
+			if (index.Opts().IsSparse()) {
+				assertrx(index.Fields().getTagsPathsLength() > 0);
+				pl.GetByJsonPath(index.Fields().getTagsPath(0), keys[i], index.KeyType());
+			} else {
+				pl.Get(field, keys[i], index.Opts().IsArray());
+			}
+			materializedAggregations_.Remove(field, keys[i]);
+		}
+		auto idxMemScope = indexMemScope(index);
+		bool needClearCache{false};
+		index.BulkDelete(keys, ids, *strHolder_, needClearCache);
+		if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
+	} while (++field != borderIdx);
+
+	for (IdType id : ids) {
+		itemsDataSize_ -= items_[id].GetCapacity() + sizeof(PayloadValue::dataHeader);
+		items_.Mutable(id).Free();
+		free_.push_back(id);
+	}
+	if (free_.size() == items_.size()) {
+		free_.resize(0);
+		items_.resize(0);
+	}
+	markUpdated(true);
+}
+
 void NamespaceImpl::Delete(const Query &q, QueryResults &result, const NsContext &ctx) {
 	PerfStatCalculatorMT calc(updatePerfCounter_, enablePerfCounters_);
 
@@ -1012,8 +1256,12 @@ void NamespaceImpl::Delete(const Query &q, QueryResults &result, const NsContext
 	if (result.Items().size() >= AsyncStorage::kLimitToAdviceBatching) {
 		storageAdvice = storage_.AdviceBatching();
 	}
-	for (auto &r : result.Items()) {
-		doDelete(r.Id());
+	std::vector<IdType> ids;
+	ids.reserve(result.Items().size());
+	for (auto &r : result.Items()) ids.push_back(r.Id());
+	std::sort(ids.begin(), ids.end());
+	for (size_t i = 0; i < ids.size(); i += kBulkDeleteBatchSize) {
+		doDelete(span<IdType>(ids.data() + i, std::min(kBulkDeleteBatchSize, ids.size() - i)));
 	}
 
 	if (!q.HasLimit() && !q.HasOffset() && result.Count() >= kWALStatementItemsThreshold) {
@@ -1057,37 +1305,154 @@ void NamespaceImpl::Truncate(const NsContext &ctx) {
 	checkApplySlaveUpdate(ctx.rdxContext.fromReplication_);	 // throw exception if false
 
 	if (storage_.IsValid()) {
-		for (PayloadValue &pv : items_) {
+		invalidateItemsSnapshot();
+		for (const PayloadValue &pv : items_) {
 			if (pv.IsFree()) continue;
-			Payload pl(payloadType_, pv);
+			ConstPayload pl(payloadType_, pv);
 			WrSerializer pk;
 			pk << kRxStorageItemPrefix;
 			pl.SerializeFields(pk, pkFields());
 			storage_.Remove(pk.Slice());
 		}
 	}
-	items_.clear();
+	clearData();
+
+	WrSerializer ser;
+	WALRecord wrec(WalUpdateQuery, (ser << "TRUNCATE " << name_).Slice());
+
+	lsn_t lsn(wal_.Add(wrec), serverId_);
+	if (!ctx.rdxContext.fromReplication_) repl_.lastSelfLSN = lsn;
+	markUpdated(true);
+	if (!repl_.temporary)
+		observers_->OnWALUpdate(LSNPair(lsn, ctx.rdxContext.fromReplication_ ? ctx.rdxContext.LSNs_.originLSN_ : lsn), name_, wrec);
+	if (!ctx.rdxContext.fromReplication_) setReplLSNs(LSNPair(lsn_t(), lsn));
+	tryForceFlush(std::move(wlck));
+}
+
+void NamespaceImpl::DropData(const RdxContext &ctx) {
+	auto wlck = wLock(ctx);
+	clearData();
+}
+
+void NamespaceImpl::clearData() {
+	auto dataMemScope = memScope(MemAccount::Data);
+	// Large namespace may take seconds to be released, so it's done by the background routine
+	reclaimer_.Add(std::move(items_));
+	pointReads_.Clear();
 	free_.clear();
-	repl_.dataHash = 0;
+	resetDataHash();
 	itemsDataSize_ = 0;
 	for (size_t i = 0; i < indexes_.size(); ++i) {
+		auto idxMemScope = indexMemScope(*indexes_[i]);
 		const IndexOpts opts = indexes_[i]->Opts();
 		std::unique_ptr<Index> newIdx{Index::New(getIndexDefinition(i), indexes_[i]->GetPayloadType(), indexes_[i]->Fields())};
 		newIdx->SetOpts(opts);
 		std::swap(indexes_[i], newIdx);
 		removeIndex(newIdx);
+		reclaimer_.Add(std::move(newIdx));
 	}
+	rebuildMaterializedAggregations();
+	rebuildPathsIndex();
+}
 
-	WrSerializer ser;
-	WALRecord wrec(WalUpdateQuery, (ser << "TRUNCATE " << name_).Slice());
+bool NamespaceImpl::needCompactItems() const noexcept {
+	const size_t freeCount = free_.size();
+	return config_.itemsCompactionFreePercent && freeCount >= kMinFreeItemsForCompaction &&
+		   freeCount * 100 >= items_.size() * size_t(config_.itemsCompactionFreePercent);
+}
 
-	lsn_t lsn(wal_.Add(wrec), serverId_);
-	if (!ctx.rdxContext.fromReplication_) repl_.lastSelfLSN = lsn;
+void NamespaceImpl::compactItems(const RdxContext &ctx) {
+	if (!config_.itemsCompactionFreePercent || lazyItemsPending_.load(std::memory_order_acquire)) return;
+	{
+		auto rlck = rLock(ctx);
+		if (!needCompactItems()) return;
+		const int64_t now =
+			std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		// Namespace is compacted only after the modifications are over, as well as the indexes are optimized
+		if (now - lastUpdateTime_.load(std::memory_order_acquire) < config_.optimizationTimeout) return;
+	}
+
+	auto wlck = wLock(ctx);
+	// Spilled WAL records refer to the items by the ids, which can't be rewritten
+	if (!needCompactItems() || isSystem() || wal_.spilled_size() || cancelCommitCnt_.load(std::memory_order_relaxed) ||
+		lazyItemsPending_.load(std::memory_order_relaxed)) {
+		return;
+	}
+	const size_t oldSize = items_.size();
+	const size_t itemsCount = oldSize - free_.size();
+	auto dataMemScope = memScope(MemAccount::Data);
+
+	// Ids of the items are stored by the type specific structures of each index, so the indexes are built from scratch
+	std::vector<std::unique_ptr<Index>> oldIndexes;
+	oldIndexes.reserve(indexes_.size());
+	for (size_t i = 0; i < indexes_.size(); ++i) {
+		auto idxMemScope = indexMemScope(*indexes_[i]);
+		const IndexOpts opts = indexes_[i]->Opts();
+		std::unique_ptr<Index> newIdx{Index::New(getIndexDefinition(i), indexes_[i]->GetPayloadType(), indexes_[i]->Fields())};
+		newIdx->SetOpts(opts);
+		std::swap(indexes_[i], newIdx);
+		oldIndexes.emplace_back(std::move(newIdx));
+	}
+	const int sortedIdxCount = getSortedIdxCount();
+	for (auto &idx : indexes_) idx->SetSortedIdxCount(sortedIdxCount);
+
+	NsItems oldItems = std::move(items_);
+	pointReads_.Clear();
+	items_.reserve(itemsCount);
+	itemsDataSize_ = 0;
+	assertrx(indexes_.firstCompositePos() != 0);
+	const int borderIdx = indexes_.totalSize() > 1 ? 1 : 0;
+	bool needClearCache{false};
+	for (size_t oldId = 0; oldId < oldSize; ++oldId) {
+		if (oldItems[oldId].IsFree()) continue;
+		const IdType id = items_.size();
+		items_.emplace_back(std::move(oldItems.Mutable(oldId)));
+		PayloadValue &pv = items_.Mutable(id);
+		Payload pl(payloadType_, pv);
+		// Payload may be shared with query results, which have to keep the keys of the old indexes
+		pv.Clone(pl.RealSize());
+
+		// The same order of the indexes as for the insertion of the new item (see doUpsert)
+		int field = borderIdx;
+		do {
+			field %= indexes_.firstCompositePos();
+			Index &index = *indexes_[field];
+			auto idxMemScope = indexMemScope(index);
+			const bool isIndexSparse = index.Opts().IsSparse();
+			if (isIndexSparse) {
+				try {
+					pl.GetByJsonPath(index.Fields().getTagsPath(0), skrefs, index.KeyType());
+				} catch (const Error &) {
+					skrefs.resize(0);
+				}
+			} else {
+				pl.Get(field, skrefs);
+			}
+			krefs.resize(0);
+			index.Upsert(krefs, skrefs, id, needClearCache);
+			if (!isIndexSparse) pl.Set(field, krefs);
+		} while (++field != borderIdx);
+		for (int field = indexes_.firstCompositePos(); field < indexes_.totalSize(); ++field) {
+			auto idxMemScope = indexMemScope(*indexes_[field]);
+			indexes_[field]->Upsert(Variant{pv}, id, needClearCache);
+		}
+		itemsDataSize_ += pv.GetCapacity() + sizeof(PayloadValue::dataHeader);
+		wal_.Set(WALRecord(WalItemUpdate, id), lsn_t(pv.GetLSN()).Counter());
+	}
+	free_.clear();
+	free_.shrink_to_fit();
+	for (auto &idx : oldIndexes) {
+		auto idxMemScope = indexMemScope(*idx);
+		removeIndex(idx);
+		reclaimer_.Add(std::move(idx));
+	}
+	reclaimer_.Add(std::move(oldItems));
+	invalidateItemsSnapshot();
+	coldTuplesHand_ = 0;
+	rebuildMaterializedAggregations();
+	rebuildPathsIndex();
 	markUpdated(true);
-	if (!repl_.temporary)
-		observers_->OnWALUpdate(LSNPair(lsn, ctx.rdxContext.fromReplication_ ? ctx.rdxContext.LSNs_.originLSN_ : lsn), name_, wrec);
-	if (!ctx.rdxContext.fromReplication_) setReplLSNs(LSNPair(lsn_t(), lsn));
-	tryForceFlush(std::move(wlck));
+	logPrintf(LogInfo, "[%s] Items have been compacted from %d to %d rows", name_, oldSize, items_.size());
 }
 
 void NamespaceImpl::Refill(vector<Item> &items, const NsContext &ctx) {
@@ -1106,6 +1471,56 @@ ReplicationState NamespaceImpl::GetReplState(const RdxContext &ctx) const {
 	return getReplState();
 }
 
+std::vector<uint64_t> NamespaceImpl::GetDataHashBuckets(const RdxContext &ctx) const {
+	auto rlck = rLock(ctx);
+	return dataHashBuckets_;
+}
+
+void NamespaceImpl::ReplaceDataHashBuckets(const std::vector<unsigned> &buckets, std::vector<Item> &items, const RdxContext &ctx) {
+	Locker::WLockT wlck;
+	{
+		PerfStatCalculatorMT calc(updatePerfCounter_, enablePerfCounters_);
+		CounterGuardAIR32 cg(cancelCommitCnt_);
+		wlck = wLock(ctx);
+		cg.Reset();
+		calc.LockHit();
+	}
+	checkApplySlaveUpdate(ctx.fromReplication_);
+
+	std::vector<bool> replaced(kDataHashBucketsCount, false);
+	for (auto bucket : buckets) {
+		if (bucket < kDataHashBucketsCount) replaced[bucket] = true;
+	}
+
+	auto storageAdvice = storage_.AdviceBatching();
+	batchHasNewItems_ = false;
+	std::vector<bool> upserted(items_.size(), false);
+	for (auto &item : items) {
+		modifyItem(item, NsContext(ctx).NoLock().InBatch(), ModeUpsert);
+		if (item.GetID() < 0) continue;
+		const size_t id = item.GetID();
+		if (id >= upserted.size()) upserted.resize(id + 1, false);
+		upserted[id] = true;
+	}
+	// Items of the replaced buckets, which were not received from master, are absent on master
+	size_t deleted = 0;
+	for (IdType id = 0; id < IdType(items_.size()); ++id) {
+		if (items_[id].IsFree() || (size_t(id) < upserted.size() && upserted[id]) || !replaced[dataHashBucket(items_[id])]) continue;
+		ItemImpl stale(payloadType_, items_[id], tagsMatcher_);
+		const WALRecord wrec{WalItemModify, stale.GetCJSON(), tagsMatcher_.version(), ModeDelete, false};
+		const lsn_t itemLsn(items_[id].GetLSN());
+		doDelete(id);
+		processWalRecord(wrec, ctx, itemLsn);
+		++deleted;
+	}
+	markUpdated(batchHasNewItems_);
+	logPrintf(LogInfo, "[%s] %d data hash buckets were replaced: %d items upserted, %d items deleted", name_, buckets.size(), items.size(),
+			  deleted);
+
+	storageAdvice.Reset();
+	tryForceFlush(std::move(wlck));
+}
+
 void NamespaceImpl::SetReplLSNs(LSNPair LSNs, const RdxContext &ctx) {
 	auto wlck = wLock(ctx);
 	setReplLSNs(LSNs);
@@ -1169,6 +1584,7 @@ void NamespaceImpl::CommitTransaction(Transaction &tx, QueryResults &result, NsC
 		cg.Reset();
 		calc.LockHit();
 	}
+	checkReadOnly();
 
 	ctx.NoLock().InTransaction();
 
@@ -1183,37 +1599,96 @@ void NamespaceImpl::CommitTransaction(Transaction &tx, QueryResults &result, NsC
 		storageAdvice = storage_.AdviceBatching();
 	}
 
-	for (auto &step : tx.GetSteps()) {
-		if (step.query_) {
-			QueryResults qr;
-			qr.AddNamespace(std::shared_ptr<NamespaceImpl>{this, [](NamespaceImpl *) {}}, ctx);
-			if (step.query_->type_ == QueryDelete) {
-				Delete(*step.query_, qr, ctx);
-			} else {
-				Update(*step.query_, qr, ctx);
-			}
-		} else {
-			Item item = tx.GetItem(std::move(step));
-			if (step.modifyMode_ == ModeDelete) {
-				Delete(item, ctx);
+	auto &steps = tx.GetSteps();
+	std::vector<Item> items;
+	// Declared after the items, so the queued writes of the items are completed before their destruction
+	std::unique_ptr<ItemsWriter> writer;
+	NsContext itemCtx = ctx;
+	if (steps.size() >= kMinPipelinedTxSize) {
+		writer = std::make_unique<ItemsWriter>(kItemsWriterQueueSize);
+		itemCtx.itemsWriter = writer.get();
+	}
+	// Records of the writer have to precede the ones, which are written by the steps below, and the items of the batch are reused
+	auto awaitWriter = [&writer] {
+		if (writer) writer->Await();
+	};
+	for (size_t batchBegin = 0; batchBegin < steps.size(); batchBegin += kParallelUpdateBatchSize) {
+		// Items of the batch are decoded by the workers, so only the modifications of the namespace are applied here
+		const size_t batchEnd = std::min(steps.size(), batchBegin + kParallelUpdateBatchSize);
+		awaitWriter();
+		tx.GetItems(span<TransactionStep>(&steps[batchBegin], batchEnd - batchBegin), items, config_.parallelUpdateWorkers);
+		for (size_t i = batchBegin; i < batchEnd; ++i) {
+			auto &step = steps[i];
+			if (step.query_) {
+				awaitWriter();
+				QueryResults qr;
+				qr.AddNamespace(std::shared_ptr<NamespaceImpl>{this, [](NamespaceImpl *) {}}, ctx);
+				if (step.query_->type_ == QueryDelete) {
+					Delete(*step.query_, qr, ctx);
+				} else {
+					Update(*step.query_, qr, ctx);
+				}
 			} else {
-				modifyItem(item, ctx, step.modifyMode_);
+				Item &item = items[i - batchBegin];
+				if (step.modifyMode_ == ModeDelete) {
+					awaitWriter();
+					Delete(item, ctx);
+				} else {
+					modifyItem(item, itemCtx, step.modifyMode_);
+				}
+				result.AddItem(item);
 			}
-			result.AddItem(item);
 		}
 	}
+	awaitWriter();
 
 	WALRecord commitWrec(WalCommitTransaction, 0, true);
 	processWalRecord(commitWrec, ctx.rdxContext);
 	logPrintf(LogTrace, "[repl:%s]:%d CommitTransaction end", name_, serverId_);
 
+	storageAdvice.Reset();
+	if (wlck.owns_lock()) {
+		wlck.unlock();
+		storage_.FlushOnCommit();
+	}
+}
+
+void NamespaceImpl::ModifyBatch(span<ItemModification> mods, const RdxContext &ctx) {
+	Locker::WLockT wlck;
+	{
+		PerfStatCalculatorMT calc(updatePerfCounter_, enablePerfCounters_);
+		CounterGuardAIR32 cg(cancelCommitCnt_);
+		wlck = wLock(ctx);
+		cg.Reset();
+		calc.LockHit();
+	}
+
+	// Storage records of the whole batch are written together
+	auto storageAdvice = storage_.AdviceBatching();
+	batchHasNewItems_ = false;
+	for (auto &mod : mods) {
+		const RdxContext itemCtx(ctx.fromReplication_, mod.LSNs);
+		try {
+			if (mod.mode == ModeDelete) {
+				Delete(mod.item, NsContext(itemCtx).NoLock().InBatch());
+			} else {
+				modifyItem(mod.item, NsContext(itemCtx).NoLock().InBatch(), mod.mode);
+			}
+		} catch (const Error &err) {
+			mod.err = err;
+		}
+	}
+	markUpdated(batchHasNewItems_);
+
+	storageAdvice.Reset();
 	tryForceFlush(std::move(wlck));
 }
 
 void NamespaceImpl::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 	// Upsert fields to indexes
 	assertrx(items_.exists(id));
-	auto &plData = items_[id];
+	auto dataMemScope = memScope(MemAccount::Data);
+	auto &plData = items_.Mutable(id);
 
 	// Inplace payload
 	Payload pl(payloadType_, plData);
@@ -1221,20 +1696,29 @@ void NamespaceImpl::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 	auto indexesCacheCleaner{GetIndexesCacheCleaner()};
 	Variant oldData;
 	h_vector<bool, 32> needUpdateCompIndexes;
+	// Indexed fields are compared by their payload values, so the unchanged ones are neither converted to the keys, nor touched in the
+	// indexes. Usually only a few of them are changed by the update
+	h_vector<bool, 32> changedFields;
 	if (doUpdate) {
-		repl_.dataHash ^= pl.GetHash();
+		pathsIndex_.Remove(id, payloadType_, plData);
+		updateDataHash(plData);
 		itemsDataSize_ -= plData.GetCapacity() + sizeof(PayloadValue::dataHeader);
 		plData.Clone(pl.RealSize());
+		changedFields = h_vector<bool, 32>(indexes_.firstCompositePos(), true);
+		for (int field = 1; field < indexes_.firstCompositePos(); ++field) {
+			if (!indexes_[field]->Opts().IsSparse()) changedFields[field] = !pl.IsFieldEQ(*plNew.Value(), field);
+		}
 		const size_t compIndexesCount = indexes_.compositeIndexesSize();
+		for (int field = 0; field < indexes_.firstCompositePos(); ++field) {
+			if (changedFields[field]) updatedFields_.set(field);
+		}
 		needUpdateCompIndexes = h_vector<bool, 32>(compIndexesCount, false);
 		bool needUpdateAnyCompIndex = false;
 		for (size_t field = 0; field < compIndexesCount; ++field) {
 			const auto &fields = indexes_[field + indexes_.firstCompositePos()]->Fields();
 			for (const auto f : fields) {
 				if (f == IndexValueType::SetByJsonPath) continue;
-				pl.Get(f, skrefs);
-				plNew.Get(f, krefs);
-				if (skrefs != krefs) {
+				if (changedFields[f]) {
 					needUpdateCompIndexes[field] = true;
 					needUpdateAnyCompIndex = true;
 					break;
@@ -1272,6 +1756,7 @@ void NamespaceImpl::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 		field %= indexes_.firstCompositePos();
 		Index &index = *indexes_[field];
 		bool isIndexSparse = index.Opts().IsSparse();
+		if (doUpdate && !changedFields[field]) continue;
 		if (isIndexSparse) {
 			assertrx(index.Fields().getTagsPathsLength() > 0);
 			try {
@@ -1287,6 +1772,8 @@ void NamespaceImpl::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 			for (auto &key : skrefs) key.EnsureUTF8();
 
 		// Check for update
+		auto idxMemScope = indexMemScope(index);
+		bool needClearCache{false};
 		if (doUpdate) {
 			if (isIndexSparse) {
 				try {
@@ -1298,15 +1785,16 @@ void NamespaceImpl::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 				pl.Get(field, krefs, index.Opts().IsArray());
 			}
 			if (krefs == skrefs) continue;
-			bool needClearCache{false};
-			index.Delete(krefs, id, *strHolder_, needClearCache);
-			if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
+			materializedAggregations_.Remove(field, krefs);
+			// Only the changed keys of the arrays are updated in the index
+			index.Update(krefs, skrefs, id, *strHolder_, needClearCache);
+		} else {
+			// Put value to index
+			krefs.resize(0);
+			index.Upsert(krefs, skrefs, id, needClearCache);
 		}
-		// Put value to index
-		krefs.resize(0);
-		bool needClearCache{false};
-		index.Upsert(krefs, skrefs, id, needClearCache);
 		if (needClearCache && index.IsOrdered()) indexesCacheCleaner.Add(index.SortId());
+		materializedAggregations_.Add(field, krefs);
 
 		if (!isIndexSparse) {
 			// Put value to payload
@@ -1316,6 +1804,7 @@ void NamespaceImpl::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 
 	// Upsert to composite indexes
 	for (int field = indexes_.firstCompositePos(); field < indexes_.totalSize(); ++field) {
+		auto idxMemScope = indexMemScope(*indexes_[field]);
 		bool needClearCache{false};
 		if (doUpdate) {
 			if (!needUpdateCompIndexes[field - indexes_.firstCompositePos()]) continue;
@@ -1325,8 +1814,9 @@ void NamespaceImpl::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 		indexes_[field]->Upsert(Variant{plData}, id, needClearCache);
 		if (needClearCache && indexes_[field]->IsOrdered()) indexesCacheCleaner.Add(indexes_[field]->SortId());
 	}
-	repl_.dataHash ^= pl.GetHash();
+	updateDataHash(plData);
 	itemsDataSize_ += plData.GetCapacity() + sizeof(PayloadValue::dataHeader);
+	pathsIndex_.Add(id, payloadType_, plData);
 	ritem->RealValue() = plData;
 }
 
@@ -1370,7 +1860,84 @@ void NamespaceImpl::updateTagsMatcherFromItem(ItemImpl *ritem) {
 	}
 }
 
+void NamespaceImpl::combinedModifyItem(Item &item, const NsContext &ctx, int mode) {
+	CombinedWrite write{&item, mode, &ctx, Error(), false};
+	std::unique_lock<std::mutex> lck(combinedWritesMtx_);
+	combinedWrites_.emplace_back(&write);
+	while (!write.done) {
+		if (hasWritesCombiner_) {
+			combinedWritesCond_.wait(lck);
+			continue;
+		}
+		hasWritesCombiner_ = true;
+		lck.unlock();
+		applyCombinedWrites(write);
+		lck.lock();
+		hasWritesCombiner_ = false;
+		combinedWritesCond_.notify_all();
+	}
+	if (!write.err.ok()) throw write.err;
+}
+
+void NamespaceImpl::applyCombinedWrites(CombinedWrite &own) {
+	Locker::WLockT wlck;
+	try {
+		PerfStatCalculatorMT calc(updatePerfCounter_, enablePerfCounters_);
+		CounterGuardAIR32 cg(cancelCommitCnt_);
+		wlck = wLock(own.ctx->rdxContext);
+		cg.Reset();
+		calc.LockHit();
+	} catch (const Error &err) {
+		// Invalidated namespace rejects all the writers, while canceled or timed out lock rejects the combiner's write only
+		std::lock_guard<std::mutex> lck(combinedWritesMtx_);
+		for (auto it = combinedWrites_.begin(); it != combinedWrites_.end();) {
+			if (*it == &own || err.code() == errNamespaceInvalidated) {
+				(*it)->err = err;
+				(*it)->done = true;
+				it = combinedWrites_.erase(it);
+			} else {
+				++it;
+			}
+		}
+		return;
+	}
+
+	// Storage records of the combined writes are written together
+	auto storageAdvice = storage_.AdviceBatching();
+	batchHasNewItems_ = false;
+	std::vector<CombinedWrite *> writes;
+	for (size_t applied = 0; applied < kMaxCombinedWrites; applied += writes.size()) {
+		writes.clear();
+		{
+			std::lock_guard<std::mutex> lck(combinedWritesMtx_);
+			if (combinedWrites_.empty()) break;
+			writes.swap(combinedWrites_);
+		}
+		for (auto w : writes) {
+			try {
+				modifyItem(*w->item, NsContext(w->ctx->rdxContext).NoLock().InBatch(), w->mode);
+			} catch (const Error &err) {
+				w->err = err;
+			} catch (const std::exception &e) {
+				// Combiner must not throw before the queued writes are done, otherwise their writers will wait forever
+				w->err = Error(errLogic, e.what());
+			}
+		}
+		std::lock_guard<std::mutex> lck(combinedWritesMtx_);
+		for (auto w : writes) w->done = true;
+		combinedWritesCond_.notify_all();
+	}
+	markUpdated(batchHasNewItems_);
+
+	storageAdvice.Reset();
+	tryForceFlush(std::move(wlck));
+}
+
 void NamespaceImpl::modifyItem(Item &item, const NsContext &ctx, int mode) {
+	if (!ctx.noLock && !ctx.inTransaction) {
+		combinedModifyItem(item, ctx, mode);
+		return;
+	}
 	// Item to doUpsert
 	ItemImpl *itemImpl = item.impl_;
 	Locker::WLockT wlck;
@@ -1404,27 +1971,40 @@ void NamespaceImpl::modifyItem(Item &item, const NsContext &ctx, int mode) {
 
 	item.setLSN(int64_t(lsn));
 	item.setID(id);
+	const bool cached = exists && erasePointRead(id);
 	doUpsert(itemImpl, id, exists);
+	// Modifications of the transaction are not visible until its commit
+	if (cached && !ctx.inTransaction) putPointRead(id);
 
 	saveTagsMatcherToStorage(true);
+	std::string pk;
 	if (storage_.IsValid()) {
-		WrSerializer pk, data;
-		pk << kRxStorageItemPrefix;
-		newPl.SerializeFields(pk, pkFields());
-		data.PutUInt64(lsn.Counter());
-		itemImpl->GetCJSON(data);
-		storage_.Write(pk.Slice(), data.Slice());
-	}
-
-	if (!repl_.temporary) {
-		// not send row with fromReplication=true and originLSN_= empty
-		if (!ctx.rdxContext.fromReplication_ || !ctx.rdxContext.LSNs_.originLSN_.isEmpty())
-			observers_->OnModifyItem(LSNPair(lsn, ctx.rdxContext.fromReplication_ ? ctx.rdxContext.LSNs_.originLSN_ : lsn), name_,
-									 item.impl_, mode, ctx.inTransaction);
+		invalidateItemsSnapshot();
+		WrSerializer pkSer;
+		pkSer << kRxStorageItemPrefix;
+		newPl.SerializeFields(pkSer, pkFields());
+		pk = std::string(pkSer.Slice());
+	}
+	// not send row with fromReplication=true and originLSN_= empty
+	const bool replicate = !repl_.temporary && (!ctx.rdxContext.fromReplication_ || !ctx.rdxContext.LSNs_.originLSN_.isEmpty());
+	const LSNPair lsns(lsn, ctx.rdxContext.fromReplication_ ? ctx.rdxContext.LSNs_.originLSN_ : lsn);
+	auto write = [this, itemImpl, pk = std::move(pk), lsns, replicate, mode, inTransaction = ctx.inTransaction] {
+		if (!pk.empty()) writeItemToStorage(pk, lsns.upstreamLSN_.Counter(), *itemImpl);
+		if (replicate) observers_->OnModifyItem(lsns, name_, itemImpl, mode, inTransaction);
+	};
+	if (ctx.itemsWriter) {
+		// Item is not modified anymore, so it is serialized in parallel with the next modifications
+		ctx.itemsWriter->Add(std::move(write));
+	} else {
+		write();
 	}
 	if (!ctx.rdxContext.fromReplication_) setReplLSNs(LSNPair(lsn_t(), lsn));
 
-	markUpdated(!exists);
+	if (ctx.inBatch) {
+		batchHasNewItems_ = batchHasNewItems_ || !exists;
+	} else {
+		markUpdated(!exists);
+	}
 
 	tryForceFlush(std::move(wlck));
 }
@@ -1485,6 +2065,7 @@ void NamespaceImpl::optimizeIndexes(const NsContext &ctx) {
 	const bool forceBuildAllIndexes = optState == NotOptimized;
 
 	logPrintf(LogTrace, "Namespace::optimizeIndexes(%s) enter", name_);
+	auto idxMemScope = memScope(MemAccount::Indexes);
 	assertrx(indexes_.firstCompositePos() != 0);
 	int field = indexes_.firstCompositePos();
 	do {
@@ -1492,6 +2073,10 @@ void NamespaceImpl::optimizeIndexes(const NsContext &ctx) {
 		PerfStatCalculatorMT calc(indexes_[field]->GetCommitPerfCounter(), enablePerfCounters_);
 		calc.LockHit();
 		indexes_[field]->Commit();
+		// Keys distribution is changed only by the updates, which reset the built flag
+		if (!indexes_[field]->IsBuilt() || !indexes_[field]->Stats()) {
+			indexes_[field]->UpdateStats(items_.size() - free_.size());
+		}
 	} while (++field != indexes_.firstCompositePos() && !cancelCommitCnt_.load(std::memory_order_relaxed));
 
 	// Update sort orders and sort_id for each index
@@ -1501,26 +2086,42 @@ void NamespaceImpl::optimizeIndexes(const NsContext &ctx) {
 									   : config_.optimizationSortWorkers;
 	for (auto &idxIt : indexes_) {
 		if (idxIt->IsOrdered() && maxIndexWorkers != 0) {
-			NSUpdateSortedContext sortCtx(*this, currentSortId++);
-			const bool forceBuildAll = forceBuildAllIndexes || idxIt->IsBuilt() || idxIt->SortId() != currentSortId;
-			idxIt->MakeSortOrders(sortCtx);
-			// Build in multiple threads
-			std::unique_ptr<thread[]> thrs(new thread[maxIndexWorkers]);
-			for (size_t i = 0; i < maxIndexWorkers; i++) {
-				thrs[i] = std::thread([&, i]() {
-					for (size_t j = i; j < this->indexes_.size() && !cancelCommitCnt_.load(std::memory_order_relaxed);
-						 j += maxIndexWorkers) {
-						auto &idx = this->indexes_[j];
-						if (forceBuildAll || !idx->IsBuilt()) {
-							idx->UpdateSortedIds(sortCtx);
-						}
-					}
-				});
+			const SortType sortId = currentSortId++;
+			// Items were not inserted or deleted and keys of the ordered index were not changed since the last build, so its sort order
+			// is still valid. In this case only the keys, which were modified since that time, have to be updated
+			const bool sortOrderChanged = forceBuildAllIndexes || !idxIt->IsBuilt() || idxIt->SortId() != sortId ||
+										  idxIt->SortOrders().size() != items_.size() - free_.size();
+			std::unique_ptr<NSUpdateSortedContext> sortCtx;
+			if (sortOrderChanged) {
+				sortCtx = std::make_unique<NSUpdateSortedContext>(*this, sortId);
+				idxIt->MakeSortOrders(*sortCtx);
+			} else {
+				sortCtx = std::make_unique<NSUpdateSortedContext>(*this, sortId, idxIt->SortOrders());
 			}
-			for (size_t i = 0; i < maxIndexWorkers; i++) thrs[i].join();
+			// Build in multiple threads. Large indexes are splitted into several tasks, which may be stolen by the idle workers.
+			// Optimization is a background job, so the pool's threads are given to it only when foreground operations do not need them
+			WorkStealingScheduler scheduler(maxIndexWorkers, ThreadPool::Priority::Low);
+			for (auto &idx : indexes_) {
+				if (sortOrderChanged) {
+					idx->AddUpdateSortedIdsTasks(*sortCtx, scheduler);
+				} else if (!idx->IsBuilt()) {
+					idx->AddUpdateSortedIdsDeltaTasks(*sortCtx, scheduler);
+				}
+			}
+			scheduler.Run([this] { return cancelCommitCnt_.load(std::memory_order_relaxed) != 0; });
 		}
 		if (cancelCommitCnt_.load(std::memory_order_relaxed)) break;
 	}
+	// Fulltext indexes are committed here too, so the first select after the updates does not have to rebuild them
+	const auto isCanceled = [this] { return cancelCommitCnt_.load(std::memory_order_relaxed) != 0; };
+	for (auto &idxIt : indexes_) {
+		if (isCanceled()) break;
+		if (idxIt->IsFulltext()) {
+			PerfStatCalculatorMT calc(idxIt->GetCommitPerfCounter(), enablePerfCounters_);
+			calc.LockHit();
+			idxIt->CommitFulltextBackground(isCanceled);
+		}
+	}
 	if (maxIndexWorkers && !cancelCommitCnt_.load(std::memory_order_relaxed)) {
 		optimizationState_.store(OptimizationCompleted, std::memory_order_release);
 		for (auto &idxIt : indexes_) {
@@ -1547,8 +2148,12 @@ void NamespaceImpl::markUpdated(bool forceOptimizeAllIndexes) {
 		int expected{OptimizationCompleted};
 		optimizationState_.compare_exchange_strong(expected, OptimizedPartially);
 	}
-	queryCache_->Clear();
-	joinCache_->Clear();
+	{
+		auto cachesMemScope = memScope(MemAccount::Untracked);
+		queryCache_->Clear();
+		invalidateJoinCache(forceOptimizeAllIndexes);
+		invalidateResultsCache();
+	}
 	lastUpdateTime_.store(
 		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count(),
 		std::memory_order_release);
@@ -1564,6 +2169,8 @@ void NamespaceImpl::updateSelectTime() {
 int64_t NamespaceImpl::getLastSelectTime() const { return lastSelectTime_; }
 
 void NamespaceImpl::Select(QueryResults &result, SelectCtx &params, const RdxContext &ctx) {
+	// Results of the select are not charged, but the caches, which are filled by the select, are
+	auto selectMemScope = memScope(MemAccount::Untracked);
 	if (params.query.IsWALQuery()) {
 		WALSelecter selecter(this);
 		selecter(result, params);
@@ -1624,8 +2231,10 @@ NamespaceMemStat NamespaceImpl::GetMemStat(const RdxContext &ctx) {
 	ret.name = name_;
 	ret.joinCache = joinCache_->GetMemStat();
 	ret.queryCache = queryCache_->GetMemStat();
+	if (resultsCache_) ret.queryResultsCache = resultsCache_->GetMemStat();
 
 	ret.itemsCount = ItemsCount();
+	ret.storageLoaded = !lazyItemsPending_.load(std::memory_order_acquire);
 	*(static_cast<ReplicationState *>(&ret.replication)) = getReplState();
 	ret.replication.walCount = size_t(wal_.size());
 	ret.replication.walSize = wal_.heap_size();
@@ -1633,7 +2242,7 @@ NamespaceMemStat NamespaceImpl::GetMemStat(const RdxContext &ctx) {
 	ret.emptyItemsCount = free_.size();
 
 	ret.Total.dataSize = itemsDataSize_ + items_.capacity() * sizeof(PayloadValue);
-	ret.Total.cacheSize = ret.joinCache.totalSize + ret.queryCache.totalSize;
+	ret.Total.cacheSize = ret.joinCache.totalSize + ret.queryCache.totalSize + ret.queryResultsCache.totalSize;
 
 	ret.indexes.reserve(indexes_.size());
 	for (auto &idx : indexes_) {
@@ -1644,6 +2253,16 @@ NamespaceMemStat NamespaceImpl::GetMemStat(const RdxContext &ctx) {
 		ret.Total.dataSize += istat.dataSize;
 		ret.Total.cacheSize += istat.idsetCache.totalSize;
 	}
+	ret.Total.indexesSize += pathsIndex_.HeapSize();
+
+	if (MemAccountingScope::Enabled()) {
+		const MemAccount &account = *memAccount_.Account();
+		ret.Allocator.enabled = true;
+		ret.Allocator.totalSize = account.Total();
+		ret.Allocator.dataSize = account.Get(MemAccount::Data);
+		ret.Allocator.indexesSize = account.Get(MemAccount::Indexes);
+		ret.Allocator.fulltextSize = account.Get(MemAccount::Fulltext);
+	}
 
 	ret.storageOK = storage_.IsValid();
 	ret.storagePath = storage_.Path();
@@ -1678,16 +2297,34 @@ NamespacePerfStat NamespaceImpl::GetPerfStat(const RdxContext &ctx) {
 	ret.name = name_;
 	ret.selects = selectPerfCounter_.Get<PerfStat>();
 	ret.updates = updatePerfCounter_.Get<PerfStat>();
+	ret.storageFlushes = storage_.GetFlushPerfStat();
+	const LockStats &lockStats = locker_.Stats();
+	ret.locks = {lockStats.Get(LockStats::SharedWait), lockStats.Get(LockStats::SharedHold), lockStats.Get(LockStats::ExclusiveWait),
+				 lockStats.Get(LockStats::ExclusiveHold)};
 	for (unsigned i = 1; i < indexes_.size(); i++) {
 		ret.indexes.emplace_back(indexes_[i]->GetIndexPerfStat());
 	}
 	return ret;
 }
 
+NamespaceMetrics NamespaceImpl::GetMetrics(bool withPerfStats) {
+	NamespaceMetrics ret;
+	ret.itemsCount = GetItemsCount();
+	if (withPerfStats) {
+		ret.perfStats = true;
+		ret.selects = selectPerfCounter_.Get<PerfStat>();
+		ret.updates = updatePerfCounter_.Get<PerfStat>();
+		ret.storageFlushes = storage_.GetFlushPerfStat();
+	}
+	return ret;
+}
+
 void NamespaceImpl::ResetPerfStat(const RdxContext &ctx) {
 	auto rlck = rLock(ctx);
 	selectPerfCounter_.Reset();
 	updatePerfCounter_.Reset();
+	storage_.ResetFlushPerfStat();
+	locker_.Stats().Reset();
 	for (auto &i : indexes_) i->ResetIndexPerfStat();
 }
 
@@ -1815,6 +2452,24 @@ bool NamespaceImpl::loadIndexesFromStorage() {
 	return true;
 }
 
+void NamespaceImpl::writeItemToStorage(std::string_view pk, uint64_t lsnCounter, ItemImpl &item) {
+	WrSerializer data;
+	data.PutUInt64(lsnCounter);
+	item.GetCJSON(data);
+	const size_t cjsonLen = data.Len() - sizeof(uint64_t);
+	if (config_.storageCompression && cjsonLen >= kMinCompressedStorageItemSize) {
+		std::string compressed;
+		snappy::Compress(reinterpret_cast<const char *>(data.Buf()) + sizeof(uint64_t), cjsonLen, &compressed);
+		// Incompressible items are stored as is
+		if (compressed.size() < cjsonLen) {
+			data.Reset();
+			data.PutUInt64(lsnCounter | kStorageItemCompressedFlag);
+			data.Write(compressed);
+		}
+	}
+	storage_.Write(pk, data.Slice());
+}
+
 void NamespaceImpl::loadReplStateFromStorage() {
 	string json;
 	Error status = loadLatestSysRecord(kStorageReplStatePrefix, sysRecordsVersions_.replVersion, json);
@@ -1884,7 +2539,8 @@ void NamespaceImpl::saveSchemaToStorage() {
 }
 
 void NamespaceImpl::saveReplStateToStorage(bool direct) {
-	if (!storage_.IsValid()) return;
+	// Replication state of the namespace without loaded items is not complete, while its stored version is still actual
+	if (!storage_.IsValid() || lazyItemsPending_.load(std::memory_order_acquire)) return;
 
 	if (direct) {
 		replStateUpdates_.store(0, std::memory_order_release);
@@ -1903,6 +2559,7 @@ void NamespaceImpl::saveReplStateToStorage(bool direct) {
 
 void NamespaceImpl::saveTagsMatcherToStorage(bool clearUpdate) {
 	if (storage_.IsValid() && tagsMatcher_.isUpdated()) {
+		invalidateItemsSnapshot();
 		WrSerializer ser;
 		ser.PutUInt64(sysRecordsVersions_.tagsVersion);
 		tagsMatcher_.serialize(ser);
@@ -1922,6 +2579,13 @@ void NamespaceImpl::EnableStorage(const string &path, StorageOpts opts, StorageT
 
 	bool success = false;
 	const bool storageDirExists = (fs::Stat(dbpath) == fs::StatDir);
+	if (storageDirExists && fs::Stat(fs::JoinPath(dbpath, std::string(kStorageReadOnlyMarker))) == fs::StatFile) {
+		opts.ReadOnly();
+	}
+	if (opts.IsReadOnly()) {
+		logPrintf(LogInfo, "[%s] Storage is opened read only", name_);
+		opts.DropOnFileFormatError(false);
+	}
 	try {
 		while (!success) {
 			if (!opts.IsCreateIfMissing() && !storageDirExists) {
@@ -1946,6 +2610,7 @@ void NamespaceImpl::EnableStorage(const string &path, StorageOpts opts, StorageT
 			if (!success && opts.IsDropOnFileFormatError()) {
 				logPrintf(LogWarning, "Dropping storage for namespace '%s' on path '%s' due to format error", name_, dbpath);
 				opts.DropOnFileFormatError(false);
+				ItemsSnapshot::Remove(dbpath);
 				storage_.Destroy();
 			}
 		}
@@ -1964,6 +2629,7 @@ void NamespaceImpl::EnableStorage(const string &path, StorageOpts opts, StorageT
 	}
 
 	storageOpts_ = opts;
+	payloadType_->GetColdTuples()->SetStorage(storage_.GetStoragePtr());
 }
 
 StorageOpts NamespaceImpl::GetStorageOpts(const RdxContext &ctx) {
@@ -1978,15 +2644,144 @@ std::shared_ptr<const Schema> NamespaceImpl::GetSchemaPtr(const RdxContext &ctx)
 
 void NamespaceImpl::LoadFromStorage(unsigned threadsCount, const RdxContext &ctx) {
 	auto wlck = wLock(ctx);
+	// System namespaces are required on startup, so they are never loaded lazily
+	if (storageOpts_.IsLazyLoad() && !isSystem()) {
+		lazyLoadThreads_ = threadsCount;
+		const int pkField = pointReadsPkField();
+		if (pkField >= 0) {
+			auto readCtx = std::make_shared<const LazyReadContext>(LazyReadContext{payloadType_, tagsMatcher_, schema_, strHolder_,
+																				   storage_.GetStoragePtr(), serverId_,
+																				   payloadType_.Field(pkField).Type()});
+			std::lock_guard lck(lazyReadCtxMtx_);
+			lazyReadCtx_ = std::move(readCtx);
+		}
+		lazyItemsPending_.store(true, std::memory_order_release);
+		logPrintf(LogInfo, "[%s] Items loading is postponed until the first access to namespace", name_);
+		return;
+	}
+	loadItemsFromStorage(threadsCount);
+}
+
+void NamespaceImpl::LoadLazyItems(const RdxContext &ctx) {
+	if (!lazyItemsPending_.load(std::memory_order_acquire)) {
+		return;
+	}
+	auto wlck = wLock(ctx);
+	if (lazyItemsPending_.load(std::memory_order_acquire)) {
+		loadItemsFromStorage(lazyLoadThreads_);
+		lazyItemsPending_.store(false, std::memory_order_release);
+		std::lock_guard lck(lazyReadCtxMtx_);
+		lazyReadCtx_.reset();
+	}
+}
+
+bool NamespaceImpl::GetLazyByPK(const VariantArray &keys, const std::shared_ptr<NamespaceImpl> &self, QueryResults &result) {
+	if (!lazyItemsPending_.load(std::memory_order_acquire) || keys.empty()) return false;
+	std::shared_ptr<const LazyReadContext> readCtx;
+	{
+		std::lock_guard lck(lazyReadCtxMtx_);
+		readCtx = lazyReadCtx_;
+	}
+	if (!readCtx) return false;
+	auto storage = readCtx->storage.lock();
+	if (!storage) return false;
+	lazyLoadRequested_.store(true, std::memory_order_release);
+
+	WrSerializer key;
+	std::string data, uncompressed;
+	h_vector<std::string, 1> readKeys;
+	std::vector<std::unique_ptr<ItemImpl>> items;
+	items.reserve(keys.size());
+	for (const Variant &k : keys) {
+		key.Reset();
+		key << kRxStorageItemPrefix;
+		try {
+			PointReadsCache::MakeKey(key, Variant(k).convert(readCtx->pkType));
+		} catch (const Error &) {
+			return false;
+		}
+		if (std::find(readKeys.begin(), readKeys.end(), key.Slice()) != readKeys.end()) continue;
+		readKeys.emplace_back(key.Slice());
+		// Items are not modified, while they are pending, so the storage contains all of them
+		Error err = storage->Read(StorageOpts().FillCache(false), key.Slice(), data);
+		if (err.code() == errNotFound) continue;
+		if (!err.ok() || data.size() < sizeof(int64_t)) return false;
+
+		int64_t lsn;
+		memcpy(&lsn, data.data(), sizeof(lsn));
+		std::string_view cjson = std::string_view(data).substr(sizeof(lsn));
+		if (lsn & kStorageItemCompressedFlag) {
+			lsn &= ~kStorageItemCompressedFlag;
+			if (!snappy::Uncompress(cjson.data(), cjson.size(), &uncompressed)) return false;
+			cjson = uncompressed;
+		}
+		lsn_t l(lsn);
+		l.SetServer(readCtx->serverId);
+
+		auto item = std::make_unique<ItemImpl>(readCtx->payloadType, readCtx->tagsMatcher, FieldsSet(), readCtx->schema);
+		if (!item->FromCJSON(cjson).ok()) return false;
+		item->Value().SetLSN(int64_t(l));
+		items.emplace_back(std::move(item));
+	}
+
+	// Items, which are loaded concurrently, may be modified right after the loading
+	if (!lazyItemsPending_.load(std::memory_order_acquire)) return false;
+
+	result.addNSContext(readCtx->payloadType, readCtx->tagsMatcher, FieldsSet(), readCtx->schema);
+	result.AddNamespace(self, readCtx->strHolder);
+	// Items don't have ids yet
+	for (auto &item : items) result.AddDetached(readCtx->payloadType, ItemRef(-1, item->Value()));
+	return true;
+}
+
+void NamespaceImpl::BulkLoad(const ItemsSourceT &source, unsigned threadsCount, const RdxContext &ctx) {
+	auto wlck = wLock(ctx);
+	checkApplySlaveUpdate(ctx.fromReplication_);
+	if (items_.size() != free_.size()) {
+		throw Error(errLogic, "Unable to bulk load items into the non-empty namespace '%s'", name_);
+	}
+	if (!pkFields().size()) {
+		throw Error(errLogic, "Unable to bulk load items into '%s' - there are no PK fields in ns", name_);
+	}
+	if (storage_.IsValid()) {
+		invalidateItemsSnapshot();
+	}
+
+	ItemsLoader loader(threadsCount, *this, source);
+	auto ldata = loader.Load();
+	saveTagsMatcherToStorage(true);
+	// Loader fills the indexes directly, so the counts are collected by the loaded items
+	rebuildMaterializedAggregations();
+	rebuildPathsIndex();
+
+	logPrintf(LogInfo, "[%s] Done bulk loading. %d items loaded (%d errors %s), lsn #%s", name_, ItemsCount(),
+			  ldata.errCount, ldata.lastErr.what(), lsn_t(wal_.LSNCounter() - 1, serverId_));
+	if (ldata.errCount) {
+		throw ldata.lastErr;
+	}
+	markUpdated(true);
+}
+
+void NamespaceImpl::loadItemsFromStorage(unsigned threadsCount) {
 	FlagGuardT nsLoadingGuard(nsIsLoading_);
 
 	uint64_t dataHash = repl_.dataHash;
-	repl_.dataHash = 0;
-
-	ItemsLoader loader(threadsCount, *this);
+	resetDataHash();
+
+	// WAL records don't depend on the items, so they are read from the storage during the items decoding
+	auto walRecords = std::async(std::launch::async, [storage = storage_.GetStoragePtr().lock(), threadsCount] {
+		return WALTracker::ReadFromStorage(storage, threadsCount);
+	});
+	ItemsSnapshot snapshot;
+	const bool useSnapshot = openItemsSnapshot(snapshot);
+	ItemsLoader loader(threadsCount, *this, useSnapshot ? &snapshot : nullptr);
 	auto ldata = loader.Load();
+	// All the tuples are loaded into memory, so records of the tuples, evicted before restart, are stale
+	removeColdTuplesFromStorage();
+	rebuildMaterializedAggregations();
+	rebuildPathsIndex();
 
-	initWAL(ldata.minLSN, ldata.maxLSN);
+	initWAL(ldata.minLSN, ldata.maxLSN, walRecords.get());
 	if (!isSystem()) {
 		repl_.lastLsn.SetServer(serverId_);
 		repl_.lastSelfLSN.SetServer(serverId_);
@@ -2003,8 +2798,190 @@ void NamespaceImpl::LoadFromStorage(unsigned threadsCount, const RdxContext &ctx
 	markUpdated(true);
 }
 
-void NamespaceImpl::initWAL(int64_t minLSN, int64_t maxLSN) {
-	wal_.Init(config_.walSize, minLSN, maxLSN, storage_.GetStoragePtr());
+bool NamespaceImpl::openItemsSnapshot(ItemsSnapshot &snapshot) {
+	std::string content;
+	Error err = storage_.Read(StorageOpts().FillCache(false), kStorageItemsSnapshotPrefix, content);
+	itemsSnapshotActual_ = err.ok();
+	if (!itemsSnapshotActual_) {
+		// Snapshot file without marker is outdated
+		if (!storage_.IsReadOnly()) ItemsSnapshot::Remove(storage_.Path());
+		return false;
+	}
+	if (content.size() != sizeof(uint64_t)) {
+		logPrintf(LogWarning, "[%s] Unexpected items snapshot marker size: %d", name_, content.size());
+		return false;
+	}
+	Serializer ser(content);
+	err = snapshot.Open(storage_.Path(), ser.GetUInt64());
+	if (!err.ok()) {
+		logPrintf(LogWarning, "[%s] Unable to load items from snapshot: %s", name_, err.what());
+		return false;
+	}
+	logPrintf(LogInfo, "[%s] Loading items from snapshot (%d records, %dM)", name_, snapshot.Count(), snapshot.FileSize() / (1024 * 1024));
+	return true;
+}
+
+void NamespaceImpl::writeItemsSnapshot(const RdxContext &ctx) {
+	if (!config_.itemsSnapshotPeriod || itemsSnapshotActual_ || lazyItemsPending_.load(std::memory_order_acquire) ||
+		optimizationState_.load(std::memory_order_relaxed) != OptimizationCompleted || storage_.IsReadOnly()) {
+		return;
+	}
+	const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	if (lastItemsSnapshotTime_ && now - lastItemsSnapshotTime_ < config_.itemsSnapshotPeriod) {
+		return;
+	}
+
+	// Read lock guarantees, that there are no concurent storage updates. Concurent writers cancel snapshot the same way as indexes
+	// optimization
+	auto rlck = rLock(ctx);
+	if (!storage_.IsValid() || isSystem() || repl_.temporary || itemsSnapshotActual_ ||
+		optimizationState_.load(std::memory_order_relaxed) != OptimizationCompleted) {
+		return;
+	}
+	lastItemsSnapshotTime_ = now;
+	storage_.Flush();
+	StorageOpts opts;
+	opts.FillCache(false);
+	auto cursor = storage_.GetCursor(opts);
+	const uint64_t id = std::chrono::system_clock::now().time_since_epoch().count();
+	Error err = ItemsSnapshot::Write(storage_.Path(), id, *cursor, kRxStorageItemPrefix,
+									 [this] { return cancelCommitCnt_.load(std::memory_order_relaxed) != 0; });
+	if (!err.ok()) {
+		logPrintf(err.code() == errCanceled ? LogTrace : LogWarning, "[%s] Items snapshot was not written: %s", name_, err.what());
+		return;
+	}
+	WrSerializer ser;
+	ser.PutUInt64(id);
+	storage_.WriteSync(StorageOpts().FillCache().Sync(), kStorageItemsSnapshotPrefix, ser.Slice());
+	itemsSnapshotActual_ = true;
+	logPrintf(LogInfo, "[%s] Items snapshot has been written", name_);
+}
+
+void NamespaceImpl::invalidateItemsSnapshot() {
+	if (itemsSnapshotActual_) {
+		// Marker removal is flushed together with (or before) the following items updates
+		storage_.Remove(kStorageItemsSnapshotPrefix);
+		itemsSnapshotActual_ = false;
+	}
+}
+
+void NamespaceImpl::evictColdTuples(const RdxContext &ctx) {
+	const int64_t budget = config_.tieredTuplesMemoryBudget;
+	if ((!budget && coldTuplesStubs_.empty()) || lazyItemsPending_.load(std::memory_order_acquire)) {
+		return;
+	}
+	const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	if (now - lastColdTuplesSweepTime_ < kColdTuplesSweepPeriodSec) {
+		return;
+	}
+	lastColdTuplesSweepTime_ = now;
+
+	auto wlck = wLock(ctx);
+	if (!storage_.IsValid() || storage_.IsReadOnly() || isSystem() || repl_.temporary || lazyItemsPending_.load(std::memory_order_relaxed)) {
+		return;
+	}
+	removeStaleColdTuples();
+	int64_t resident = indexes_[0]->GetMemStat().dataSize;
+	if (budget && resident <= budget && coldTuplesStubs_.empty()) {
+		return;
+	}
+	itemsAccess_.Resize(items_.capacity());
+
+	// Evicted tuples are written first and replaced by the stubs only after the storage flush, so readers always find their records
+	std::vector<std::pair<IdType, key_string>> evicted;
+	WrSerializer key;
+	size_t changes = 0, restored = 0;
+	const size_t count = items_.size();
+	for (size_t visited = 0; visited < std::min(count, kColdTuplesSweepMaxItems) && changes < kColdTuplesSweepMaxChanges; ++visited) {
+		if (size_t(coldTuplesHand_) >= count) coldTuplesHand_ = 0;
+		const IdType id = coldTuplesHand_++;
+		if (items_[id].IsFree()) continue;
+		const bool accessed = itemsAccess_.TestAndClear(id);
+		const std::string_view tuple(ConstPayload(payloadType_, items_[id]).Get(0, 0));
+		if (ColdTuples::IsStub(tuple)) {
+			if ((accessed && resident < budget) || !budget) {
+				try {
+					key_string loaded = payloadType_->GetColdTuples()->Load(tuple);
+					resident += loaded->size();
+					replaceTuple(id, Variant(loaded));
+					++restored;
+					++changes;
+				} catch (const Error &err) {
+					logPrintf(LogWarning, "[%s] Unable to restore evicted tuple: %s", name_, err.what());
+				}
+			}
+		} else if (budget && !accessed && resident > budget && tuple.size() >= kMinColdTupleSize) {
+			key.Reset();
+			key << kStorageColdTuplePrefix;
+			key.PutUInt64(++coldTuplesSeq_);
+			storage_.Write(key.Slice(), tuple);
+			evicted.emplace_back(id, ColdTuples::MakeStub(key.Slice()));
+			resident -= tuple.size();
+			++changes;
+		}
+	}
+	if (!evicted.empty()) {
+		storage_.Flush();
+		for (auto &e : evicted) {
+			replaceTuple(e.first, Variant(e.second));
+			coldTuplesStubs_.emplace_back(std::move(e.second));
+		}
+	}
+	if (!budget && coldTuplesStubs_.empty()) {
+		itemsAccess_.Resize(0);
+	}
+	if (changes) {
+		logPrintf(LogTrace, "[%s] Evicted %d and restored %d tuples, tuples memory: %d", name_, evicted.size(), restored, resident);
+	}
+}
+
+void NamespaceImpl::replaceTuple(IdType id, const Variant &tuple) {
+	const bool cached = erasePointRead(id);
+	PayloadValue &pv = items_.Mutable(id);
+	const Variant oldTuple = ConstPayload(payloadType_, pv).Get(0, 0);
+	// Payload may be shared with query results, which have to keep the previous tuple
+	const int64_t lsn = pv.GetLSN();
+	pv.Clone();
+	pv.SetLSN(lsn);
+	bool needClearCache{false};
+	Variant newTuple = indexes_[0]->Upsert(tuple, id, needClearCache);
+	indexes_[0]->Delete(oldTuple, id, *strHolder_, needClearCache);
+	Payload(payloadType_, pv).Set(0, {newTuple});
+	if (cached) putPointRead(id);
+	// Cached results hold the previous payload, but don't hold the strings holder, which the previous tuple was moved to
+	invalidateResultsCache();
+}
+
+void NamespaceImpl::removeStaleColdTuples() {
+	for (size_t i = 0; i < coldTuplesStubs_.size();) {
+		if (coldTuplesStubs_[i].unique()) {
+			storage_.Remove(ColdTuples::StorageKey(*coldTuplesStubs_[i]));
+			coldTuplesStubs_[i] = std::move(coldTuplesStubs_.back());
+			coldTuplesStubs_.pop_back();
+		} else {
+			++i;
+		}
+	}
+}
+
+void NamespaceImpl::removeColdTuplesFromStorage() {
+	StorageOpts opts;
+	opts.FillCache(false);
+	auto dbIter = storage_.GetCursor(opts);
+	size_t removed = 0;
+	for (dbIter->Seek(kStorageColdTuplePrefix);
+		 dbIter->Valid() && dbIter->GetComparator().Compare(dbIter->Key(), std::string_view(kStorageColdTuplePrefix "\xFF")) < 0;
+		 dbIter->Next()) {
+		storage_.Remove(dbIter->Key());
+		++removed;
+	}
+	if (removed) {
+		logPrintf(LogTrace, "[%s] %d stale evicted tuples were removed from storage", name_, removed);
+	}
+}
+
+void NamespaceImpl::initWAL(int64_t minLSN, int64_t maxLSN, WALTracker::StoredRecords &&walRecords) {
+	wal_.Init(config_.walSize, minLSN, maxLSN, storage_.GetStoragePtr(), std::move(walRecords));
 	// Fill existing records
 	for (IdType rowId = 0; rowId < IdType(items_.size()); rowId++) {
 		if (!items_[rowId].IsFree()) {
@@ -2017,26 +2994,46 @@ void NamespaceImpl::initWAL(int64_t minLSN, int64_t maxLSN) {
 
 void NamespaceImpl::removeExpiredItems(RdxActivityContext *ctx) {
 	const RdxContext rdxCtx{ctx};
-	auto wlck = wLock(rdxCtx);
-	if (repl_.slaveMode) {
-		return;
-	}
-	const auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
-	if (now == lastExpirationCheckTs_) {
-		return;
-	}
-	lastExpirationCheckTs_ = now;
-	const NsContext nsCtx{rdxCtx, true};
-	for (const std::unique_ptr<Index> &index : indexes_) {
-		if ((index->Type() != IndexTtl) || (index->Size() == 0)) continue;
-		const int64_t expirationthreshold =
-			std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() -
-			index->GetTTLValue();
-		QueryResults qr;
-		qr.AddNamespace(std::shared_ptr<NamespaceImpl>{this, [](NamespaceImpl *) {}}, nsCtx);
-		Delete(Query(name_).Where(index->Name(), CondLt, expirationthreshold), qr, NsContext(rdxCtx).NoLock());
+	size_t expiredCount = 0;
+	for (bool firstChunk = true;; firstChunk = false) {
+		// Deleted items are released after the lock
+		std::vector<QueryResults> deleted;
+		auto wlck = wLock(rdxCtx);
+		if (repl_.slaveMode) {
+			return;
+		}
+		if (firstChunk) {
+			const auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+			if (now == lastExpirationCheckTs_) {
+				return;
+			}
+			lastExpirationCheckTs_ = now;
+		}
+		// Expired items are deleted by chunks, so the write lock is released between them
+		const size_t rateLimit = config_.ttlExpirationRateLimit;
+		size_t chunkLimit = config_.ttlExpirationChunkSize ? size_t(config_.ttlExpirationChunkSize) : std::numeric_limits<size_t>::max();
+		if (rateLimit) chunkLimit = std::min(chunkLimit, rateLimit - expiredCount);
+		size_t chunkCount = 0;
+		const NsContext nsCtx{rdxCtx, true};
+		for (const std::unique_ptr<Index> &index : indexes_) {
+			if ((index->Type() != IndexTtl) || (index->Size() == 0)) continue;
+			if (chunkCount == chunkLimit) break;
+			const int64_t expirationthreshold =
+				std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() -
+				index->GetTTLValue();
+			Query q = Query(name_).Where(index->Name(), CondLt, expirationthreshold);
+			if (chunkLimit != std::numeric_limits<size_t>::max()) q.Limit(chunkLimit - chunkCount);
+			QueryResults &qr = deleted.emplace_back();
+			qr.AddNamespace(std::shared_ptr<NamespaceImpl>{this, [](NamespaceImpl *) {}}, nsCtx);
+			Delete(q, qr, NsContext(rdxCtx).NoLock());
+			chunkCount += qr.Count();
+		}
+		expiredCount += chunkCount;
+		tryForceFlush(std::move(wlck));
+		if (chunkCount < chunkLimit || (rateLimit && expiredCount >= rateLimit)) {
+			return;
+		}
 	}
-	tryForceFlush(std::move(wlck));
 }
 
 void NamespaceImpl::removeExpiredStrings(RdxActivityContext *ctx) {
@@ -2054,6 +3051,9 @@ void NamespaceImpl::removeExpiredStrings(RdxActivityContext *ctx) {
 	} else if (strHolder_->HoldsIndexes() || strHolder_->MemStat() > kMaxMemorySizeOfStringsHolder) {
 		strHoldersWaitingToBeDeleted_.push_back(std::move(strHolder_));
 		strHolder_ = makeStringsHolder();
+		// Point reads cache has to release the previous holder
+		const int pkField = pointReadsPkField();
+		if (pointReads_.Enabled() && pkField >= 0) pointReads_.UpdateContext(payloadType_, tagsMatcher_, schema_, strHolder_, pkField);
 	}
 }
 
@@ -2067,26 +3067,45 @@ StringsHolderPtr NamespaceImpl::StrHolder(const NsContext &ctx) {
 	return ret;
 }
 
-void NamespaceImpl::BackgroundRoutine(RdxActivityContext *ctx) {
+void NamespaceImpl::BackgroundRoutine(RdxActivityContext *ctx, unsigned tasks) {
 	const RdxContext rdxCtx(ctx);
 	const NsContext nsCtx(rdxCtx);
-	auto replStateUpdates = replStateUpdates_.load(std::memory_order_acquire);
-	if (replStateUpdates) {
-		auto wlck = wLock(nsCtx.rdxContext);
-		if (replStateUpdates_.load(std::memory_order_relaxed)) {
-			saveReplStateToStorage(false);
-			replStateUpdates_.store(0, std::memory_order_relaxed);
+	if ((tasks & BackgroundOptimization) && lazyLoadRequested_.load(std::memory_order_acquire)) {
+		LoadLazyItems(rdxCtx);
+	}
+	if (tasks & BackgroundExpiration) {
+		auto replStateUpdates = replStateUpdates_.load(std::memory_order_acquire);
+		if (replStateUpdates) {
+			auto wlck = wLock(nsCtx.rdxContext);
+			if (replStateUpdates_.load(std::memory_order_relaxed)) {
+				saveReplStateToStorage(false);
+				replStateUpdates_.store(0, std::memory_order_relaxed);
+			}
 		}
 	}
-	optimizeIndexes(nsCtx);
-	removeExpiredItems(ctx);
-	removeExpiredStrings(ctx);
+	if (tasks & BackgroundOptimization) {
+		compactItems(rdxCtx);
+		optimizeIndexes(nsCtx);
+	}
+	if (tasks & BackgroundExpiration) {
+		removeExpiredItems(ctx);
+		removeExpiredStrings(ctx);
+		ReleaseGarbage();
+	}
+	if (tasks & BackgroundSnapshots) {
+		writeItemsSnapshot(rdxCtx);
+		evictColdTuples(rdxCtx);
+	}
 }
 
-void NamespaceImpl::StorageFlushingRoutine() { storage_.Flush(); }
+void NamespaceImpl::StorageFlushingRoutine() { storage_.FlushIfDue(); }
 
 void NamespaceImpl::DeleteStorage(const RdxContext &ctx) {
 	auto wlck = wLock(ctx);
+	// Files of the read only storage are kept, only the storage is closed
+	if (storage_.IsValid() && !storage_.IsReadOnly()) {
+		ItemsSnapshot::Remove(storage_.Path());
+	}
 	storage_.Destroy();
 }
 
@@ -2207,7 +3226,6 @@ vector<string> NamespaceImpl::enumMeta() const {
 }
 
 void NamespaceImpl::warmupFtIndexes() {
-	h_vector<std::thread, 8> warmupThreads;
 	h_vector<Index *, 8> warmupIndexes;
 	for (auto &idx : indexes_) {
 		if (idx->RequireWarmupOnNsCopy()) {
@@ -2216,20 +3234,14 @@ void NamespaceImpl::warmupFtIndexes() {
 	}
 	auto threadsCnt = config_.optimizationSortWorkers > 0 ? std::min(unsigned(config_.optimizationSortWorkers), warmupIndexes.size())
 														  : std::min(4u, warmupIndexes.size());
-	warmupThreads.resize(threadsCnt);
-	std::atomic<unsigned> next = {0};
-	for (unsigned i = 0; i < warmupThreads.size(); ++i) {
-		warmupThreads[i] = std::thread([&warmupIndexes, &next] {
-			unsigned num = next.fetch_add(1);
-			while (num < warmupIndexes.size()) {
-				warmupIndexes[num]->CommitFulltext();
-				num = next.fetch_add(1);
-			}
+	TaskGroup group(threadsCnt);
+	for (auto idx : warmupIndexes) {
+		group.Add([this, idx] {
+			auto ftMemScope = memScope(MemAccount::Fulltext);
+			idx->CommitFulltext();
 		});
 	}
-	for (auto &th : warmupThreads) {
-		th.join();
-	}
+	group.Wait();
 }
 
 int NamespaceImpl::getSortedIdxCount() const {
@@ -2247,13 +3259,14 @@ void NamespaceImpl::updateSortedIdxCount() {
 }
 
 IdType NamespaceImpl::createItem(size_t realSize) {
+	auto dataMemScope = memScope(MemAccount::Data);
 	IdType id = 0;
 	if (free_.size()) {
 		id = free_.back();
 		free_.pop_back();
 		assertrx(id < IdType(items_.size()));
 		assertrx(items_[id].IsFree());
-		items_[id] = PayloadValue(realSize);
+		items_.Mutable(id) = PayloadValue(realSize);
 	} else {
 		id = items_.size();
 		items_.emplace_back(PayloadValue(realSize));
@@ -2261,7 +3274,91 @@ IdType NamespaceImpl::createItem(size_t realSize) {
 	return id;
 }
 
+void NamespaceImpl::rebuildMaterializedAggregations() {
+	h_vector<int, 4> fields;
+	for (const auto &indexName : config_.materializedAggregations) {
+		int field = IndexValueType::NotSet;
+		// Index may be added later, counts are rebuilt then
+		if (!getIndexByName(indexName, field)) continue;
+		if (field == 0 || field >= indexes_.firstCompositePos() || indexes_[field]->Opts().IsSparse()) {
+			logPrintf(LogWarning, "[%s] Unable to materialize aggregations of '%s': it should be dense or array index", name_, indexName);
+			continue;
+		}
+		fields.push_back(field);
+	}
+	materializedAggregations_.Reset(std::move(fields));
+	for (IdType id = 0; !materializedAggregations_.Empty() && id < IdType(items_.size()); ++id) {
+		if (items_[id].IsFree()) continue;
+		ConstPayload pl(payloadType_, items_[id]);
+		for (int field : materializedAggregations_.Fields()) {
+			pl.Get(field, krefs, indexes_[field]->Opts().IsArray());
+			materializedAggregations_.Add(field, krefs);
+		}
+	}
+}
+
+void NamespaceImpl::invalidateResultsCache() {
+	dataVersion_ = nextDataVersion();
+	if (resultsCache_) resultsCache_->Clear();
+}
+
+void NamespaceImpl::resetResultsCache() {
+	auto cachesMemScope = memScope(MemAccount::Untracked);
+	resultsCache_.reset();
+	if (config_.queryResultsCacheSize) resultsCache_ = std::make_unique<QueryResultsCache>(config_.queryResultsCacheSize);
+}
+
+int NamespaceImpl::pointReadsPkField() const {
+	const auto it = indexesNames_.find(kPKIndexName);
+	if (it == indexesNames_.end() || it->second >= indexes_.firstCompositePos() || indexes_[it->second]->Opts().IsSparse()) return -1;
+	return it->second;
+}
+
+bool NamespaceImpl::erasePointRead(IdType id) {
+	if (pointReads_.Empty()) return false;
+	const int pkField = pointReadsPkField();
+	if (pkField < 0) return false;
+	WrSerializer key;
+	PointReadsCache::MakeKey(key, ConstPayload(payloadType_, items_[id]).Get(pkField, 0));
+	return pointReads_.Erase(key.Slice());
+}
+
+void NamespaceImpl::putPointRead(IdType id) {
+	const int pkField = pointReadsPkField();
+	if (pkField < 0) return;
+	pointReads_.UpdateContext(payloadType_, tagsMatcher_, schema_, strHolder_, pkField);
+	WrSerializer key;
+	PointReadsCache::MakeKey(key, ConstPayload(payloadType_, items_[id]).Get(pkField, 0));
+	pointReads_.Put(key.Slice(), id, items_[id]);
+}
+
+void NamespaceImpl::FillPointReads(const QueryResults &result, const RdxContext &ctx) {
+	if (!pointReads_.Enabled() || result.Items().empty()) return;
+	auto rlck = rLock(ctx);
+	for (const ItemRef &item : result.Items()) {
+		// Payload of the modified item is cloned, while it's shared with the results
+		if (item.Nsid() != 0 || !item.ValueInitialized() || !items_.exists(item.Id()) || items_[item.Id()].Ptr() != item.Value().Ptr()) {
+			continue;
+		}
+		putPointRead(item.Id());
+	}
+}
+
+void NamespaceImpl::rebuildPathsIndex() {
+	pathsIndex_.Reset(config_.pathsIndex);
+	for (IdType id = 0; pathsIndex_.Enabled() && id < IdType(items_.size()); ++id) {
+		if (!items_[id].IsFree()) pathsIndex_.Add(id, payloadType_, items_[id]);
+	}
+}
+
+void NamespaceImpl::checkReadOnly() const {
+	if (storage_.IsReadOnly()) {
+		throw Error(errLogic, "Can't modify ns '%s' with read only storage", name_);
+	}
+}
+
 void NamespaceImpl::checkApplySlaveUpdate(bool fromReplication) {
+	checkReadOnly();
 	if (repl_.slaveMode && !repl_.replicatorEnabled)  // readOnly
 	{
 		throw Error(errLogic, "Can't modify read only ns '%s'", name_);
@@ -2325,48 +3422,104 @@ void NamespaceImpl::FillResult(QueryResults &result, IdSet::Ptr ids) const {
 }
 
 void NamespaceImpl::getFromJoinCache(JoinCacheRes &ctx) const {
-	if (config_.cacheMode == CacheModeOff || optimizationState_ != OptimizationCompleted) return;
-	auto it = joinCache_->Get(ctx.key);
-	ctx.needPut = false;
-	ctx.haveData = false;
-	if (it.valid) {
-		if (!it.val.inited) {
-			ctx.needPut = true;
-		} else {
-			ctx.haveData = true;
-			ctx.it = std::move(it);
-		}
-	}
+	if (config_.cacheMode == CacheModeOff) return;
+	getJoinCacheVal(ctx);
 }
 
 void NamespaceImpl::getIndsideFromJoinCache(JoinCacheRes &ctx) const {
-	if (config_.cacheMode != CacheModeAggressive || optimizationState_ != OptimizationCompleted) return;
-	auto it = joinCache_->Get(ctx.key);
+	if (config_.cacheMode != CacheModeAggressive) return;
+	getJoinCacheVal(ctx);
+}
+
+void NamespaceImpl::getJoinCacheVal(JoinCacheRes &ctx) const {
 	ctx.needPut = false;
 	ctx.haveData = false;
-	if (it.valid) {
-		if (!it.val.inited) {
-			ctx.needPut = true;
-		} else {
-			ctx.haveData = true;
-			ctx.it = std::move(it);
-		}
+	// Values are built only with the optimized indexes. Until the indexes are optimized again after the update, only the values,
+	// which don't refer to the sort orders, are used
+	const bool optimized = optimizationState_ == OptimizationCompleted;
+	auto it = joinCache_->Get(ctx.key);
+	if (!it.valid) return;
+	if (!it.val.inited) {
+		ctx.needPut = optimized;
+	} else if (optimized || !it.val.preResult || !it.val.preResult->enableSortOrders) {
+		ctx.haveData = true;
+		ctx.it = std::move(it);
 	}
 }
 
-void NamespaceImpl::putToJoinCache(JoinCacheRes &res, JoinPreResult::Ptr preResult) const {
+void NamespaceImpl::putToJoinCache(JoinCacheRes &res, JoinPreResult::Ptr preResult, const Query &q) const {
 	JoinCacheVal joinCacheVal;
 	res.needPut = false;
 	joinCacheVal.inited = true;
+	// Iterators refer to the indexes and values are the copies of the items, so only the ids are valid after the update of the item
+	if (preResult->dataMode == JoinPreResult::ModeIdSet && preResult->executionMode == JoinPreResult::ModeExecute) {
+		addJoinCacheFields(q, joinCacheVal.fields);
+	} else {
+		joinCacheVal.fields.set();
+	}
 	joinCacheVal.preResult = preResult;
+	auto cachesMemScope = memScope(MemAccount::Untracked);
 	joinCache_->Put(res.key, joinCacheVal);
 }
-void NamespaceImpl::putToJoinCache(JoinCacheRes &res, JoinCacheVal &val) const {
+void NamespaceImpl::putToJoinCache(JoinCacheRes &res, JoinCacheVal &val, const Query &q1, const Query &q2) const {
 	val.inited = true;
+	addJoinCacheFields(q1, val.fields);
+	addJoinCacheFields(q2, val.fields);
+	auto cachesMemScope = memScope(MemAccount::Untracked);
 	joinCache_->Put(res.key, val);
 }
 
-const FieldsSet &NamespaceImpl::pkFields() {
+void NamespaceImpl::addJoinCacheFields(const Query &q, JoinCacheFields &fields) const {
+	auto add = [this, &fields](const std::string &name) {
+		int idx = IndexValueType::NotSet;
+		if (!getIndexByName(name, idx)) {
+			fields.set(0);
+		} else if (idx < indexes_.firstCompositePos()) {
+			fields.set(idx);
+		} else {
+			const FieldsSet &subfields = indexes_[idx]->Fields();
+			for (const auto f : subfields) {
+				fields.set(f == IndexValueType::SetByJsonPath ? 0 : f);
+			}
+			if (subfields.getTagsPathsLength()) fields.set(0);
+		}
+	};
+	q.entries.ExecuteAppropriateForEach(Skip<JoinQueryEntry, QueryEntriesBracket, AlwaysFalse>{},
+										[&add](const QueryEntry &qe) { add(qe.index); },
+										[&add](const BetweenFieldsQueryEntry &qe) {
+											add(qe.firstIndex);
+											add(qe.secondIndex);
+										});
+	for (const auto &se : q.sortingEntries_) {
+		int idx = IndexValueType::NotSet;
+		if (getIndexByName(se.expression, idx)) {
+			add(se.expression);
+		} else {
+			// Sort expression may refer to any field
+			fields.set();
+		}
+	}
+	for (const auto &agg : q.aggregations_) {
+		for (const auto &field : agg.fields_) add(field);
+	}
+}
+
+void NamespaceImpl::invalidateJoinCache(bool itemsSetChanged) {
+	// Inserted or deleted item may match any conditions. And the changes, which are not tracked by updatedFields_ (e.g. of the indexes
+	// definitions), invalidate everything too
+	if (itemsSetChanged || updatedFields_.none()) {
+		joinCache_->Clear();
+	} else {
+		joinCache_->EraseIf([this](const JoinCacheKey &, const JoinCacheVal &val) { return (val.fields & updatedFields_).any(); });
+	}
+	updatedFields_.reset();
+}
+
+MemAccountingScope NamespaceImpl::indexMemScope(const Index &index) const noexcept {
+	return memScope(index.IsFulltext() ? MemAccount::Fulltext : MemAccount::Indexes);
+}
+
+const FieldsSet &NamespaceImpl::pkFields() const {
 	auto it = indexesNames_.find(kPKIndexName);
 	if (it != indexesNames_.end()) {
 		return indexes_[it->second]->Fields();
@@ -2385,6 +3538,7 @@ void NamespaceImpl::processWalRecord(const WALRecord &wrec, const RdxContext &ct
 }
 
 NamespaceImpl::IndexesCacheCleaner::~IndexesCacheCleaner() {
+	auto cachesMemScope = ns_.memScope(MemAccount::Untracked);
 	for (auto &idx : ns_.indexes_) idx->ClearCache(sorts_);
 }
 
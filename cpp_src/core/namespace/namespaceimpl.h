@@ -1,30 +1,40 @@
 ﻿#pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <memory>
 #include <set>
 #include <thread>
 #include <vector>
 #include "asyncstorage.h"
+#include "coldtuples.h"
 #include "core/cjson/tagsmatcher.h"
 #include "core/dbconfig.h"
 #include "core/index/keyentry.h"
 #include "core/item.h"
 #include "core/joincache.h"
+#include "core/memaccounting.h"
 #include "core/namespacedef.h"
 #include "core/payload/payloadiface.h"
 #include "core/perfstatcounter.h"
 #include "core/querycache.h"
+#include "core/queryresultscache.h"
 #include "core/schema.h"
 #include "core/storage/idatastorage.h"
 #include "core/storage/storagetype.h"
 #include "core/transactionimpl.h"
 #include "estl/contexted_locks.h"
 #include "estl/fast_hash_map.h"
+#include "estl/mutex.h"
 #include "estl/shared_mutex.h"
 #include "estl/smart_lock.h"
 #include "estl/syncpool.h"
+#include "materializedaggregations.h"
+#include "memoryreclaimer.h"
+#include "nsitems.h"
+#include "pathsindex.h"
+#include "pointreadscache.h"
 #include "replicator/updatesobserver.h"
 #include "replicator/waltracker.h"
 #include "stringsholder.h"
@@ -38,6 +48,11 @@ namespace reindexer {
 
 using reindexer::datastorage::StorageType;
 
+// Flag in the LSN of the item storage record, which marks snappy compressed CJSON
+constexpr uint64_t kStorageItemCompressedFlag = 1ull << 62;
+// Alias of the primary key index, which may be used in the queries instead of the index name
+extern const std::string kPKIndexName;
+
 class Index;
 struct SelectCtx;
 struct JoinPreResult;
@@ -52,10 +67,13 @@ class ItemComparator;
 class SortExpression;
 class ProtobufSchema;
 class QueryResults;
+class ItemsSnapshot;
 namespace SortExprFuncs {
 struct DistanceBetweenJoinedIndexesSameNs;
 }  // namespace SortExprFuncs
 
+class ItemsWriter;
+
 struct NsContext {
 	NsContext(const RdxContext &rdxCtx, bool noLock_ = false) noexcept : rdxContext{rdxCtx}, noLock{noLock_} {}
 	NsContext &NoLock() noexcept {
@@ -67,9 +85,37 @@ struct NsContext {
 		return *this;
 	}
 
+	NsContext &InBatch() noexcept {
+		inBatch = true;
+		return *this;
+	}
+
 	const RdxContext &rdxContext;
 	bool noLock = false;
 	bool inTransaction = false;
+	// Namespace is marked as updated once for the whole batch of the modifications
+	bool inBatch = false;
+	// Storage and replication records of the modified items are written by this writer (see CommitTransaction)
+	ItemsWriter *itemsWriter = nullptr;
+};
+
+/// Modification of the single item, which is applied as a part of the batch
+struct ItemModification {
+	Item item;
+	ItemModifyMode mode;
+	LSNPair LSNs;
+	Error err;
+};
+
+/// Parts of the namespace's background routine, which may be scheduled separately
+enum BackgroundTask : unsigned {
+	// Replication state flush, TTL expiration and removal of the unused strings
+	BackgroundExpiration = 1 << 0,
+	// Indexes optimization: sort orders and fulltext indexes building
+	BackgroundOptimization = 1 << 1,
+	// Items snapshot writing and eviction of the cold tuples
+	BackgroundSnapshots = 1 << 2,
+	BackgroundAll = BackgroundExpiration | BackgroundOptimization | BackgroundSnapshots,
 };
 
 class NamespaceImpl {
@@ -117,6 +163,14 @@ protected:
 			for (IdType i = 0; i < IdType(ns_.items_.size()); i++)
 				ids2Sorts_.push_back(ns_.items_[i].IsFree() ? SortIdUnexists : SortIdUnfilled);
 		}
+		// Context of the already built sort order: items positions are restored from the sort order of the ordered index
+		NSUpdateSortedContext(const NamespaceImpl &ns, SortType curSortId, const vector<IdType> &sortOrders)
+			: ns_(ns), sorted_indexes_(ns_.getSortedIdxCount()), curSortId_(curSortId), ids2Sorts_(ns.items_.size(), SortIdUnexists) {
+			for (size_t i = 0; i < sortOrders.size(); ++i) {
+				assertrx(size_t(sortOrders[i]) < ids2Sorts_.size());
+				ids2Sorts_[sortOrders[i]] = i;
+			}
+		}
 		int getSortedIdxCount() const noexcept override { return sorted_indexes_; }
 		SortType getCurSortId() const noexcept override { return curSortId_; }
 		const vector<SortType> &ids2Sorts() const noexcept override { return ids2Sorts_; }
@@ -155,16 +209,13 @@ protected:
 		const NamespaceImpl &ns_;
 	};
 
-	class Items : public vector<PayloadValue> {
-	public:
-		bool exists(IdType id) const { return id < IdType(size()) && !at(id).IsFree(); }
-	};
+	using Items = NsItems;
 
 public:
 	enum OptimizationState : int { NotOptimized, OptimizedPartially, OptimizationCompleted };
 
 	typedef shared_ptr<NamespaceImpl> Ptr;
-	using Mutex = MarkedMutex<shared_timed_mutex, MutexMark::Namespace>;
+	using Mutex = ProfiledMarkedMutex<shared_timed_mutex, MutexMark::Namespace>;
 
 	NamespaceImpl(const string &_name, UpdatesObservers &observers);
 	NamespaceImpl &operator=(const NamespaceImpl &) = delete;
@@ -182,9 +233,21 @@ public:
 
 	void EnableStorage(const string &path, StorageOpts opts, StorageType storageType, const RdxContext &ctx);
 	void LoadFromStorage(unsigned threadsCount, const RdxContext &ctx);
+	/// Loads items of the lazily loaded namespace, if they were not loaded yet. Has to be called before any access to namespace's data
+	void LoadLazyItems(const RdxContext &ctx);
+	/// Reads the items by the primary key directly from the storage, while the items of the lazily loaded namespace are not loaded yet,
+	/// and requests the loading of the items in the background
+	/// @return false, if the items are loaded already or the namespace's primary key can't be read this way. Results are not changed
+	bool GetLazyByPK(const VariantArray &keys, const std::shared_ptr<NamespaceImpl> &self, QueryResults &result);
 	void DeleteStorage(const RdxContext &);
+	/// Source of the items for BulkLoad. Calls the passed function for the CJSON of each item, until it returns false
+	using ItemsSourceT = std::function<void(const std::function<bool(std::string_view cjson)> &)>;
+	/// Loads items into the empty namespace, filling its indexes in several threads. Items must have unique PKs
+	void BulkLoad(const ItemsSourceT &source, unsigned threadsCount, const RdxContext &ctx);
 
 	uint32_t GetItemsCount() const { return itemsCount_.load(std::memory_order_relaxed); }
+	/// Counters of the metrics are synchronized by themselves, so the namespace is not locked
+	NamespaceMetrics GetMetrics(bool withPerfStats);
 	uint32_t GetItemsCapacity() const { return itemsCapacity_.load(std::memory_order_relaxed); }
 	void AddIndex(const IndexDef &indexDef, const RdxContext &ctx);
 	void UpdateIndex(const IndexDef &indexDef, const RdxContext &ctx);
@@ -200,7 +263,16 @@ public:
 	void Delete(Item &item, const NsContext &);
 	void Delete(const Query &query, QueryResults &result, const NsContext &);
 	void Truncate(const NsContext &);
+	/// Clears the data of the dropped namespace. Memory is released by the ReleaseGarbage calls
+	void DropData(const RdxContext &);
+	/// Releases the next portion of the memory of the truncated or dropped data
+	/// @return true, if there is nothing to release anymore
+	bool ReleaseGarbage() { return reclaimer_.ReleaseStep(memAccount_.Account().get()); }
+	/// Puts the items of the select by the primary key to the point reads cache, if they were not modified after the select
+	void FillPointReads(const QueryResults &result, const RdxContext &ctx);
 	void Refill(vector<Item> &, const NsContext &);
+	/// Applies modifications under the single namespace lock. Errors of the single modifications are stored into their err fields
+	void ModifyBatch(span<ItemModification> mods, const RdxContext &);
 
 	void Select(QueryResults &result, SelectCtx &params, const RdxContext &);
 	NamespaceDef GetDefinition(const RdxContext &ctx);
@@ -209,7 +281,7 @@ public:
 	void ResetPerfStat(const RdxContext &);
 	vector<string> EnumMeta(const RdxContext &ctx);
 
-	void BackgroundRoutine(RdxActivityContext *);
+	void BackgroundRoutine(RdxActivityContext *, unsigned tasks = BackgroundAll);
 	void StorageFlushingRoutine();
 	void CloseStorage(const RdxContext &);
 
@@ -229,10 +301,20 @@ public:
 
 	void FillResult(QueryResults &result, IdSet::Ptr ids) const;
 
-	void EnablePerfCounters(bool enable = true) { enablePerfCounters_ = enable; }
+	void EnablePerfCounters(bool enable = true) {
+		enablePerfCounters_ = enable;
+		locker_.Stats().Enable(enable);
+	}
 
 	// Replication slave mode functions
 	ReplicationState GetReplState(const RdxContext &) const;
+	/// Count of the data hash buckets. Items are distributed between the buckets by the hash of their PK, so the same item belongs
+	/// to the same bucket on master and slave
+	static constexpr unsigned kDataHashBucketsCount = 1024;
+	/// Get data hashes of the items of each bucket. Data hash of the namespace is XOR of all the buckets
+	std::vector<uint64_t> GetDataHashBuckets(const RdxContext &) const;
+	/// Replaces items of the data hash buckets with the master's items: items are upserted and the other items of the buckets are deleted
+	void ReplaceDataHashBuckets(const std::vector<unsigned> &buckets, std::vector<Item> &items, const RdxContext &);
 	void SetReplLSNs(LSNPair LSNs, const RdxContext &ctx);
 
 	void SetSlaveReplStatus(ReplicationState::Status, const Error &, const RdxContext &);
@@ -245,6 +327,9 @@ public:
 	std::shared_ptr<const Schema> GetSchemaPtr(const RdxContext &ctx) const;
 	int getNsNumber() const { return schema_ ? schema_->GetProtobufNsNumber() : 0; }
 	IndexesCacheCleaner GetIndexesCacheCleaner() { return IndexesCacheCleaner{*this}; }
+	/// Charges the memory of the current thread to the namespace's subsystem while the result is alive
+	MemAccountingScope memScope(MemAccount::Subsystem s) const noexcept { return {memAccount_.Account().get(), s}; }
+	MemAccountingScope indexMemScope(const Index &index) const noexcept;
 
 protected:
 	struct SysRecordsVersions {
@@ -269,6 +354,7 @@ protected:
 			return lck;
 		}
 		void MarkReadOnly() { readonly_.store(true, std::memory_order_release); }
+		LockStats &Stats() const noexcept { return mtx_.Stats(); }
 		std::atomic_bool &IsReadOnly() { return readonly_; }
 
 	private:
@@ -286,29 +372,71 @@ protected:
 	bool loadIndexesFromStorage();
 	void saveReplStateToStorage(bool direct = true);
 	void saveTagsMatcherToStorage(bool clearUpdate);
+	void writeItemToStorage(std::string_view pk, uint64_t lsnCounter, ItemImpl &item);
 	void loadReplStateFromStorage();
-
-	void initWAL(int64_t minLSN, int64_t maxLSN);
+	void loadItemsFromStorage(unsigned threadsCount);
+	bool openItemsSnapshot(ItemsSnapshot &snapshot);
+	void writeItemsSnapshot(const RdxContext &ctx);
+	void invalidateItemsSnapshot();
+	void evictColdTuples(const RdxContext &ctx);
+	bool needCompactItems() const noexcept;
+	// Renumbers the items into the dense range of ids, if the namespace has too many free rows (see items_compaction_free_percent)
+	void compactItems(const RdxContext &ctx);
+	void replaceTuple(IdType id, const Variant &tuple);
+	void removeStaleColdTuples();
+	void removeColdTuplesFromStorage();
+
+	void initWAL(int64_t minLSN, int64_t maxLSN, WALTracker::StoredRecords &&walRecords);
 
 	void markUpdated(bool forceOptimizeAllIndexes);
+	// Assigns the new data version to the namespace and drops the cached results of the queries
+	void invalidateResultsCache();
+	void resetResultsCache();
+	// Field of the primary key, which is used by the point reads cache, or -1, if the key is composite
+	int pointReadsPkField() const;
+	// Drops the cached item before its modification
+	// @return true, if the item was cached
+	bool erasePointRead(IdType id);
+	// Puts the actual value of the item to the point reads cache. Has to be called under the lock
+	void putPointRead(IdType id);
+	static uint64_t nextDataVersion() noexcept {
+		static std::atomic<uint64_t> counter{0};
+		return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
 	void doUpsert(ItemImpl *ritem, IdType id, bool doUpdate);
 	void modifyItem(Item &item, const NsContext &, int mode = ModeUpsert);
+	void combinedModifyItem(Item &item, const NsContext &, int mode);
 	void updateTagsMatcherFromItem(ItemImpl *ritem);
 	void updateItems(PayloadType oldPlType, const FieldsSet &changedFields, int deltaFields);
 	void doDelete(IdType id);
+	// Deletes the items, sorted by their ids. Keys of all the items are deleted from each index at once
+	void doDelete(span<IdType> ids);
 	void optimizeIndexes(const NsContext &);
 	void insertIndex(std::unique_ptr<Index> newIndex, int idxNo, const string &realName);
-	void addIndex(const IndexDef &indexDef);
-	void addCompositeIndex(const IndexDef &indexDef);
+	// Composite index, which is built without namespace lock from the snapshot of the items
+	struct PrebuiltIndex {
+		std::unique_ptr<Index> index;
+		PayloadType payloadType;
+		FieldsSet fields;
+		Items items;
+	};
+	static constexpr size_t kMinItemsForOnlineIndexBuild = 10000;
+	PrebuiltIndex prebuildCompositeIndex(const IndexDef &indexDef, const RdxContext &ctx);
+	bool compositeIndexFields(const IndexDef &indexDef, bool addTags, FieldsSet &fields);
+	void addIndex(const IndexDef &indexDef, PrebuiltIndex *prebuilt = nullptr);
+	void addCompositeIndex(const IndexDef &indexDef, PrebuiltIndex *prebuilt);
 	void verifyUpdateIndex(const IndexDef &indexDef) const;
 	void verifyUpdateCompositeIndex(const IndexDef &indexDef) const;
 	void updateIndex(const IndexDef &indexDef);
 	void dropIndex(const IndexDef &index);
 	void addToWAL(const IndexDef &indexDef, WALRecType type, const RdxContext &ctx);
 	void addToWAL(std::string_view json, WALRecType type, const RdxContext &ctx);
-	void replicateItem(IdType itemId, const NsContext &ctx, bool statementReplication, uint64_t oldPlHash, size_t oldItemCapacity);
+	void replicateItem(IdType itemId, const NsContext &ctx, bool statementReplication, uint64_t oldPlHash, unsigned oldDataHashBucket,
+					   size_t oldItemCapacity);
 	void removeExpiredItems(RdxActivityContext *);
 	void removeExpiredStrings(RdxActivityContext *);
+	// Replaces the items and the indexes by the empty ones. Previous data is passed to the reclaimer
+	void clearData();
 
 	void recreateCompositeIndexes(int startIdx, int endIdx);
 	NamespaceDef getDefinition() const;
@@ -321,14 +449,19 @@ protected:
 	pair<IdType, bool> findByPK(ItemImpl *ritem, bool inTransaction, const RdxContext &);
 	int getSortedIdxCount() const;
 	void updateSortedIdxCount();
+	void rebuildMaterializedAggregations();
+	void rebuildPathsIndex();
 	void setFieldsBasedOnPrecepts(ItemImpl *ritem);
 
-	void putToJoinCache(JoinCacheRes &res, std::shared_ptr<JoinPreResult> preResult) const;
-	void putToJoinCache(JoinCacheRes &res, JoinCacheVal &val) const;
+	void putToJoinCache(JoinCacheRes &res, std::shared_ptr<JoinPreResult> preResult, const Query &q) const;
+	void putToJoinCache(JoinCacheRes &res, JoinCacheVal &val, const Query &q1, const Query &q2) const;
 	void getFromJoinCache(JoinCacheRes &ctx) const;
 	void getIndsideFromJoinCache(JoinCacheRes &ctx) const;
+	void getJoinCacheVal(JoinCacheRes &ctx) const;
+	void addJoinCacheFields(const Query &q, JoinCacheFields &fields) const;
+	void invalidateJoinCache(bool itemsSetChanged);
 
-	const FieldsSet &pkFields();
+	const FieldsSet &pkFields() const;
 
 	vector<string> enumMeta() const;
 
@@ -341,6 +474,8 @@ protected:
 
 	bool SortOrdersBuilt() const noexcept { return optimizationState_.load(std::memory_order_acquire) == OptimizationCompleted; }
 
+	// Allocator-level memory accounting. Has to be the first member to charge the construction and destruction of the other members
+	MemAccountGuard memAccount_;
 	IndexesStorage indexes_;
 	fast_hash_map<string, int, nocase_hash_str, nocase_equal_str> indexesNames_;
 	// All items with data
@@ -381,6 +516,8 @@ private:
 	bool isSystem() const { return !name_.empty() && name_[0] == '#'; }
 	IdType createItem(size_t realSize);
 	void checkApplySlaveUpdate(bool v);
+	// Namespace, which storage is opened read only, rejects all the modifications
+	void checkReadOnly() const;
 
 	void processWalRecord(const WALRecord &wrec, const RdxContext &ctx, lsn_t itemLsn = lsn_t(), Item *item = nullptr);
 
@@ -390,6 +527,17 @@ private:
 
 	void removeIndex(std::unique_ptr<Index> &);
 	void dumpIndex(std::ostream &os, std::string_view index) const;
+	unsigned dataHashBucket(const PayloadValue &pv) const { return ConstPayload(payloadType_, pv).GetHash(pkFields()) % kDataHashBucketsCount; }
+	/// Adds the item into the data hash or removes it from the data hash
+	void updateDataHash(const PayloadValue &pv) {
+		const uint64_t hash = ConstPayload(payloadType_, pv).GetHash();
+		repl_.dataHash ^= hash;
+		dataHashBuckets_[dataHashBucket(pv)] ^= hash;
+	}
+	void resetDataHash() {
+		repl_.dataHash = 0;
+		std::fill(dataHashBuckets_.begin(), dataHashBuckets_.end(), 0);
+	}
 	void tryForceFlush(Locker::WLockT &&wlck) {
 		if (wlck.owns_lock()) {
 			wlck.unlock();
@@ -398,14 +546,33 @@ private:
 	}
 
 	JoinCache::Ptr joinCache_;
+	// Indexes changed by the updates of the existing items since the last markUpdated()
+	JoinCacheFields updatedFields_;
 
 	PerfStatCounterMT updatePerfCounter_, selectPerfCounter_;
 	std::atomic<bool> enablePerfCounters_;
 
 	NamespaceConfigData config_;
+	bool batchHasNewItems_ = false;
+	// Concurrent single item modifications are combined: the first writer takes the write lock and applies the queued
+	// modifications of the other writers as the one batch, while they are waiting for the result
+	struct CombinedWrite {
+		Item *item;
+		int mode;
+		const NsContext *ctx;
+		Error err;
+		bool done = false;
+	};
+	static constexpr size_t kMaxCombinedWrites = 1024;
+	void applyCombinedWrites(CombinedWrite &own);
+	std::mutex combinedWritesMtx_;
+	std::condition_variable combinedWritesCond_;
+	std::vector<CombinedWrite *> combinedWrites_;
+	bool hasWritesCombiner_ = false;
 	// Replication variables
 	WALTracker wal_;
 	ReplicationState repl_;
+	std::vector<uint64_t> dataHashBuckets_ = std::vector<uint64_t>(kDataHashBucketsCount, 0);
 	UpdatesObservers *observers_;
 
 	StorageOpts storageOpts_;
@@ -426,7 +593,46 @@ private:
 	std::atomic<int> optimizationState_{OptimizationState::NotOptimized};
 	StringsHolderPtr strHolder_;
 	std::deque<StringsHolderPtr> strHoldersWaitingToBeDeleted_;
+	// Truncated data, which is released by the background routine
+	MemoryReclaimer reclaimer_;
 	std::chrono::seconds lastExpirationCheckTs_;
+	// Storage contains marker of the actual items snapshot. Marker is removed before the first items modification in the storage
+	bool itemsSnapshotActual_ = false;
+	// Time (steady clock seconds) of the last attempt to write items snapshot
+	int64_t lastItemsSnapshotTime_ = 0;
+	// Items of the lazily loaded namespace are not loaded from storage yet. Replication state and indexes definitions are loaded
+	std::atomic<bool> lazyItemsPending_ = {false};
+	unsigned lazyLoadThreads_ = 1;
+	// Primary key lookups of the lazily loaded namespace, which are served from the storage, request the background loading
+	std::atomic<bool> lazyLoadRequested_ = {false};
+	// Context of the primary key lookups of the lazily loaded namespace. Is set until the items are loaded
+	struct LazyReadContext {
+		PayloadType payloadType;
+		TagsMatcher tagsMatcher;
+		std::shared_ptr<const Schema> schema;
+		StringsHolderPtr strHolder;
+		std::weak_ptr<datastorage::IDataStorage> storage;
+		int serverId;
+		KeyValueType pkType;
+	};
+	std::shared_ptr<const LazyReadContext> lazyReadCtx_;
+	mutable spinlock lazyReadCtxMtx_;
+	// Tiered mode: reference bits of the items, stubs of all the evicted tuples (record of the stub is removed from the storage, when
+	// nobody else holds it), sequence for the keys of the evicted tuples records and position of the eviction pass
+	ItemsAccessBits itemsAccess_;
+	std::vector<key_string> coldTuplesStubs_;
+	uint64_t coldTuplesSeq_ = 0;
+	IdType coldTuplesHand_ = 0;
+	// Time (steady clock seconds) of the last eviction pass
+	int64_t lastColdTuplesSweepTime_ = 0;
+	MaterializedAggregations materializedAggregations_;
+	PathsIndex pathsIndex_;
+	// Version of the data of the namespace (see NsDataVersions). Changed under the write lock
+	uint64_t dataVersion_ = nextDataVersion();
+	// Cache of the full results of the queries. Null, if disabled by the namespace config
+	std::unique_ptr<QueryResultsCache> resultsCache_;
+	// Items of the lookups by the primary key, which are read without the lock (see 'point_reads_cache_size' of the namespace config)
+	PointReadsCache pointReads_;
 };
 
 }  // namespace reindexer
@@ -25,6 +25,13 @@ void NamespaceMemStat::GetJSON(WrSerializer &ser) {
 	builder.Put("optimization_completed", optimizationCompleted);
 
 	builder.Object("total").Put("data_size", Total.dataSize).Put("indexes_size", Total.indexesSize).Put("cache_size", Total.cacheSize);
+	if (Allocator.enabled) {
+		builder.Object("allocator")
+			.Put("total_size", Allocator.totalSize)
+			.Put("data_size", Allocator.dataSize)
+			.Put("indexes_size", Allocator.indexesSize)
+			.Put("fulltext_size", Allocator.fulltextSize);
+	}
 
 	{
 		auto obj = builder.Object("replication");
@@ -39,6 +46,10 @@ void NamespaceMemStat::GetJSON(WrSerializer &ser) {
 		auto obj = builder.Object("query_cache");
 		queryCache.GetJSON(obj);
 	}
+	{
+		auto obj = builder.Object("query_results_cache");
+		queryResultsCache.GetJSON(obj);
+	}
 
 	auto arr = builder.Array("indexes");
 	for (auto &index : indexes) {
@@ -52,6 +63,24 @@ void LRUCacheMemStat::GetJSON(JsonBuilder &builder) {
 	builder.Put("items_count", itemsCount);
 	builder.Put("empty_count", emptyCount);
 	builder.Put("hit_count_limit", hitCountLimit);
+	if (hitsCount || missesCount) {
+		builder.Put("hits_count", hitsCount);
+		builder.Put("misses_count", missesCount);
+	}
+	if (!shards.empty()) {
+		auto arr = builder.Array("shards");
+		for (auto &shard : shards) {
+			auto obj = arr.Object();
+			shard.GetJSON(obj);
+		}
+	}
+}
+
+void LRUCacheShardMemStat::GetJSON(JsonBuilder &builder) {
+	builder.Put("total_size", totalSize);
+	builder.Put("items_count", itemsCount);
+	builder.Put("hit_count_limit", hitCountLimit);
+	builder.Put("evictions_count", evictionsCount);
 }
 
 void IndexMemStat::GetJSON(JsonBuilder &builder) {
@@ -64,6 +93,8 @@ void IndexMemStat::GetJSON(JsonBuilder &builder) {
 	if (sortOrdersSize) builder.Put("sort_orders_size", sortOrdersSize);
 	if (fulltextSize) builder.Put("fulltext_size", fulltextSize);
 	if (columnSize) builder.Put("column_size", columnSize);
+	if (trigramSize) builder.Put("trigram_size", trigramSize);
+	if (graphSize) builder.Put("graph_size", graphSize);
 
 	if (idsetCache.totalSize || idsetCache.itemsCount || idsetCache.emptyCount || idsetCache.hitCountLimit) {
 		auto obj = builder.Object("idset_cache");
@@ -83,6 +114,10 @@ void PerfStat::GetJSON(JsonBuilder &builder) {
 	builder.Put("latency_stddev", stddev);
 	builder.Put("min_latency_us", minTimeUs);
 	builder.Put("max_latency_us", maxTimeUs);
+	builder.Put("latency_p50_us", p50TimeUs);
+	builder.Put("latency_p90_us", p90TimeUs);
+	builder.Put("latency_p99_us", p99TimeUs);
+	builder.Put("latency_p999_us", p999TimeUs);
 }
 
 void NamespacePerfStat::GetJSON(WrSerializer &ser) {
@@ -101,6 +136,14 @@ void NamespacePerfStat::GetJSON(WrSerializer &ser) {
 		auto obj = builder.Object("transactions");
 		transactions.GetJSON(obj);
 	}
+	{
+		auto obj = builder.Object("storage_flushes");
+		storageFlushes.GetJSON(obj);
+	}
+	{
+		auto obj = builder.Object("locks");
+		locks.GetJSON(obj);
+	}
 
 	auto arr = builder.Array("indexes");
 
@@ -110,6 +153,43 @@ void NamespacePerfStat::GetJSON(WrSerializer &ser) {
 	}
 }
 
+void LockPerfStat::GetJSON(JsonBuilder &builder) {
+	const auto put = [&builder](std::string_view name, const LockStats::Snapshot &stat) {
+		auto obj = builder.Object(name);
+		obj.Put("count", stat.count);
+		obj.Put("total_us", stat.totalUs);
+		obj.Put("max_us", stat.maxUs);
+		obj.Put("p50_us", stat.p50Us);
+		obj.Put("p99_us", stat.p99Us);
+	};
+	put("read_wait", readWait);
+	put("read_hold", readHold);
+	put("write_wait", writeWait);
+	put("write_hold", writeHold);
+}
+
+void HistogramStat::GetJSON(JsonBuilder &builder) {
+	builder.Put("total_count", totalCount);
+	builder.Put("sum", sum);
+	auto arr = builder.Array("buckets");
+	for (size_t i = 0; i < counts.size(); ++i) {
+		auto obj = arr.Object();
+		if (i < bounds.size()) obj.Put("le", bounds[i]);
+		obj.Put("count", counts[i]);
+	}
+}
+
+void StorageFlushPerfStat::GetJSON(JsonBuilder &builder) {
+	{
+		auto obj = builder.Object("size_bytes");
+		sizeBytes.GetJSON(obj);
+	}
+	{
+		auto obj = builder.Object("duration_us");
+		durationUs.GetJSON(obj);
+	}
+}
+
 void IndexPerfStat::GetJSON(JsonBuilder &builder) {
 	builder.Put("name", name);
 	{
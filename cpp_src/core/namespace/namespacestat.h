@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include "core/lsn.h"
+#include "estl/lockstats.h"
 #include "estl/span.h"
 #include "gason/gason.h"
 #include "tools/errors.h"
@@ -15,6 +16,15 @@ namespace reindexer {
 class WrSerializer;
 class JsonBuilder;
 
+struct LRUCacheShardMemStat {
+	void GetJSON(JsonBuilder &builder);
+
+	size_t totalSize = 0;
+	size_t itemsCount = 0;
+	size_t hitCountLimit = 0;
+	size_t evictionsCount = 0;
+};
+
 struct LRUCacheMemStat {
 	void GetJSON(JsonBuilder &builder);
 
@@ -22,6 +32,11 @@ struct LRUCacheMemStat {
 	size_t itemsCount = 0;
 	size_t emptyCount = 0;
 	size_t hitCountLimit = 0;
+	// Filled only for the caches, which count the lookups of the cached values
+	size_t hitsCount = 0;
+	size_t missesCount = 0;
+	// Filled only for the caches with more than one shard
+	std::vector<LRUCacheShardMemStat> shards;
 };
 
 struct IndexMemStat {
@@ -34,10 +49,14 @@ struct IndexMemStat {
 	size_t sortOrdersSize = 0;
 	size_t fulltextSize = 0;
 	size_t columnSize = 0;
+	size_t trigramSize = 0;
+	size_t graphSize = 0;
 	size_t trackedUpdatesCount = 0;
 	size_t trackedUpdatesBuckets = 0;
 	LRUCacheMemStat idsetCache;
-	size_t GetIndexStructSize() const noexcept { return idsetPlainSize + idsetBTreeSize + sortOrdersSize + fulltextSize + columnSize; }
+	size_t GetIndexStructSize() const noexcept {
+		return idsetPlainSize + idsetBTreeSize + sortOrdersSize + fulltextSize + columnSize + trigramSize + graphSize;
+	}
 };
 
 struct MasterState {
@@ -112,9 +131,18 @@ struct NamespaceMemStat {
 		size_t indexesSize = 0;
 		size_t cacheSize = 0;
 	} Total;
+	// Memory measured by the allocator. Set only if the memory accounting is enabled
+	struct {
+		bool enabled = false;
+		int64_t totalSize = 0;
+		int64_t dataSize = 0;
+		int64_t indexesSize = 0;
+		int64_t fulltextSize = 0;
+	} Allocator;
 	ReplicationStat replication;
 	LRUCacheMemStat joinCache;
 	LRUCacheMemStat queryCache;
+	LRUCacheMemStat queryResultsCache;
 	std::vector<IndexMemStat> indexes;
 };
 
@@ -130,6 +158,10 @@ struct PerfStat {
 	double stddev;
 	size_t minTimeUs;
 	size_t maxTimeUs;
+	size_t p50TimeUs;
+	size_t p90TimeUs;
+	size_t p99TimeUs;
+	size_t p999TimeUs;
 };
 
 struct TxPerfStat {
@@ -162,6 +194,32 @@ struct IndexPerfStat {
 	PerfStat commits;
 };
 
+struct HistogramStat {
+	void GetJSON(JsonBuilder &builder);
+
+	// Upper bounds of the buckets (inclusive). The last bucket has no upper bound
+	std::vector<uint64_t> bounds;
+	std::vector<uint64_t> counts;
+	uint64_t sum = 0;
+	size_t totalCount = 0;
+};
+
+struct StorageFlushPerfStat {
+	void GetJSON(JsonBuilder &builder);
+
+	HistogramStat sizeBytes;
+	HistogramStat durationUs;
+};
+
+struct LockPerfStat {
+	void GetJSON(JsonBuilder &builder);
+
+	LockStats::Snapshot readWait;
+	LockStats::Snapshot readHold;
+	LockStats::Snapshot writeWait;
+	LockStats::Snapshot writeHold;
+};
+
 struct NamespacePerfStat {
 	void GetJSON(WrSerializer &ser);
 
@@ -169,7 +227,20 @@ struct NamespacePerfStat {
 	PerfStat updates;
 	PerfStat selects;
 	TxPerfStat transactions;
+	StorageFlushPerfStat storageFlushes;
+	LockPerfStat locks;
 	std::vector<IndexPerfStat> indexes;
 };
 
+/// Cheap metrics of the namespace, which are read without the lock of the namespace and without the walk over its indexes
+struct NamespaceMetrics {
+	std::string name;
+	uint32_t itemsCount = 0;
+	/// Selects, updates and storage flushes are filled, if the performance statistics are enabled (see 'perfstats' of the profiling config)
+	bool perfStats = false;
+	PerfStat selects{};
+	PerfStat updates{};
+	StorageFlushPerfStat storageFlushes;
+};
+
 }  // namespace reindexer
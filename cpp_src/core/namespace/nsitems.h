@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+#include "core/payload/payloadvalue.h"
+#include "core/type_consts.h"
+#include "estl/intrusive_ptr.h"
+#include "tools/assertrx.h"
+
+namespace reindexer {
+
+/// Items of the namespace, which are stored by the pages of the fixed size. Copies of the container share the pages, and the page is
+/// cloned on the first modification through the copy, so the copy of the namespace (see the copy policy of the transactions) takes
+/// O(pages) instead of O(items), and only the pages, which are touched by the transaction, are duplicated
+class NsItems {
+public:
+	static constexpr size_t kPageSize = 4096;
+
+	class const_iterator {
+	public:
+		const_iterator(const NsItems &items, size_t pos) noexcept : items_(&items), pos_(pos) {}
+		const PayloadValue &operator*() const noexcept { return (*items_)[pos_]; }
+		const PayloadValue *operator->() const noexcept { return &(*items_)[pos_]; }
+		const_iterator &operator++() noexcept {
+			++pos_;
+			return *this;
+		}
+		bool operator==(const const_iterator &other) const noexcept { return pos_ == other.pos_; }
+		bool operator!=(const const_iterator &other) const noexcept { return pos_ != other.pos_; }
+
+	private:
+		const NsItems *items_;
+		size_t pos_;
+	};
+
+	NsItems() = default;
+	NsItems(const NsItems &) = default;
+	NsItems &operator=(const NsItems &) = default;
+	NsItems(NsItems &&other) noexcept : pages_(std::move(other.pages_)), size_(std::exchange(other.size_, 0)) {}
+	NsItems &operator=(NsItems &&other) noexcept {
+		pages_ = std::move(other.pages_);
+		size_ = std::exchange(other.size_, 0);
+		return *this;
+	}
+
+	size_t size() const noexcept { return size_; }
+	bool empty() const noexcept { return size_ == 0; }
+	size_t capacity() const noexcept { return pages_.size() * kPageSize; }
+	bool exists(IdType id) const noexcept { return id < IdType(size_) && !(*this)[id].IsFree(); }
+	const_iterator begin() const noexcept { return const_iterator(*this, 0); }
+	const_iterator end() const noexcept { return const_iterator(*this, size_); }
+
+	const PayloadValue &operator[](size_t id) const noexcept { return pages_[id / kPageSize]->values[id % kPageSize]; }
+	/// Returns the item for the modification. Page of the item is cloned before, if it's shared with the other copy of the namespace
+	PayloadValue &Mutable(size_t id) {
+		auto &page = pages_[id / kPageSize];
+		if (!page.unique()) page = make_intrusive<Page>(*page);
+		return page->values[id % kPageSize];
+	}
+
+	void emplace_back(PayloadValue &&value) {
+		if (size_ == capacity()) pages_.emplace_back(make_intrusive<Page>());
+		Mutable(size_++) = std::move(value);
+	}
+	/// Shrinks the container. Items behind the new size are released
+	void resize(size_t size) {
+		assertrx(size <= size_);
+		for (size_t id = size; id < size_ && id % kPageSize; ++id) Mutable(id) = PayloadValue();
+		pages_.resize((size + kPageSize - 1) / kPageSize);
+		size_ = size;
+	}
+	void clear() noexcept {
+		pages_.clear();
+		size_ = 0;
+	}
+	void reserve(size_t size) { pages_.reserve((size + kPageSize - 1) / kPageSize); }
+	/// Releases up to 'count' last pages
+	/// @return true, if the container is empty after that
+	bool ReleasePages(size_t count) noexcept {
+		const size_t pages = pages_.size() > count ? pages_.size() - count : 0;
+		while (pages_.size() > pages) pages_.pop_back();
+		size_ = std::min(size_, pages * kPageSize);
+		return pages_.empty();
+	}
+
+private:
+	struct PageData {
+		std::array<PayloadValue, kPageSize> values;
+	};
+	using Page = intrusive_atomic_rc_wrapper<PageData>;
+
+	std::vector<intrusive_ptr<Page>> pages_;
+	size_t size_ = 0;
+};
+
+}  // namespace reindexer
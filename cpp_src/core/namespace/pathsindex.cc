@@ -0,0 +1,281 @@
+#include "pathsindex.h"
+#include <algorithm>
+#include <cmath>
+#include "coldtuples.h"
+#include "core/cjson/ctag.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+// Conditions, which match more keys, are checked by the comparator, like the range conditions of the tree indexes
+constexpr size_t kMaxSelectedKeys = 50;
+
+struct PathsIndex::ItemPath {
+	bool Supported() const noexcept { return !unsupported && !(strings && others); }
+
+	VariantArray values;
+	bool strings = false;
+	bool others = false;
+	bool unsupported = false;
+};
+
+template <typename T>
+static T toKey(Variant value) {
+	// Values are converted to the type of the stored ones the same way, as the comparator does
+	if constexpr (std::is_same_v<T, std::string>) {
+		return value.As<std::string>();
+	} else {
+		value.convert(std::is_same_v<T, bool> ? KeyValueBool : (std::is_same_v<T, double> ? KeyValueDouble : KeyValueInt64));
+		return static_cast<T>(value);
+	}
+}
+
+template <typename T>
+static bool isNaN(const T &key) noexcept {
+	if constexpr (std::is_same_v<T, double>) {
+		return std::isnan(key);
+	} else {
+		(void)key;
+		return false;
+	}
+}
+
+void PathsIndex::collect(ctag tag, Serializer &rdser, TagsPath &path, ItemPaths &item) {
+	const int tagType = tag.Type();
+	const int tagName = tag.Name();
+	if (tagName) path.push_back(tagName);
+	if (tag.Field() >= 0) {
+		// Values of the indexed fields are stored in the payload
+		if (tagType == TAG_ARRAY) rdser.GetVarUint();
+		item[path].unsupported = true;
+	} else {
+		switch (tagType) {
+			case TAG_ARRAY: {
+				const carraytag atag = rdser.GetUInt32();
+				for (int i = 0; i < atag.Count(); ++i) {
+					if (atag.Tag() == TAG_OBJECT) {
+						collect(rdser.GetVarUint(), rdser, path, item);
+					} else {
+						ItemPath &p = item[path];
+						p.values.push_back(rdser.GetRawVariant(KeyValueType(atag.Tag())));
+						(atag.Tag() == TAG_STRING ? p.strings : p.others) = true;
+					}
+				}
+				break;
+			}
+			case TAG_OBJECT:
+				// Comparator matches the object by the values of all its nested fields
+				item[path].unsupported = true;
+				for (ctag otag = rdser.GetVarUint(); otag.Type() != TAG_END; otag = rdser.GetVarUint()) collect(otag, rdser, path, item);
+				break;
+			case TAG_NULL:
+				// Nulls are skipped by the comparator
+				break;
+			default: {
+				ItemPath &p = item[path];
+				p.values.push_back(rdser.GetRawVariant(KeyValueType(tagType)));
+				(tagType == TAG_STRING ? p.strings : p.others) = true;
+			}
+		}
+	}
+	if (tagName) path.pop_back();
+}
+
+void PathsIndex::collect(const ConstPayload &pl, ItemPaths &item, key_string &holder) {
+	const std::string_view tuple = ColdTuples::Resolve(pl.Type(), std::string_view(pl.Get(0, 0)), holder);
+	if (tuple.empty()) return;
+	Serializer rdser(tuple);
+	const ctag begTag = rdser.GetVarUint();
+	if (begTag.Type() != TAG_OBJECT) return;
+	TagsPath path;
+	for (ctag tag = rdser.GetVarUint(); tag.Type() != TAG_END; tag = rdser.GetVarUint()) collect(tag, rdser, path, item);
+}
+
+void PathsIndex::Add(IdType id, const PayloadType &type, const PayloadValue &pv) {
+	if (!enabled_) return;
+	ItemPaths item;
+	key_string holder;
+	collect(ConstPayload(type, pv), item, holder);
+	for (auto &p : item) {
+		PathEntry &entry = paths_[p.first];
+		if (!p.second.Supported()) {
+			++entry.unsupported;
+			continue;
+		}
+		for (const Variant &value : p.second.values) {
+			switch (value.Type()) {
+				case KeyValueString:
+					entry.strings[value.As<std::string>()].Add(id, IdSetPlain::Ordered, 0);
+					break;
+				case KeyValueDouble:
+					if (!std::isnan(double(value))) entry.doubles[double(value)].Add(id, IdSetPlain::Ordered, 0);
+					break;
+				case KeyValueBool:
+					entry.bools[bool(value)].Add(id, IdSetPlain::Ordered, 0);
+					break;
+				default:
+					entry.ints[toKey<int64_t>(value)].Add(id, IdSetPlain::Ordered, 0);
+			}
+		}
+	}
+}
+
+template <typename KeysMap, typename T>
+static void removeKey(KeysMap &keys, const T &key, IdType id) {
+	const auto it = keys.find(key);
+	if (it == keys.end()) return;
+	it->second.Erase(id);
+	if (it->second.empty()) keys.erase(it);
+}
+
+void PathsIndex::Remove(IdType id, const PayloadType &type, const PayloadValue &pv) {
+	if (!enabled_) return;
+	ItemPaths item;
+	key_string holder;
+	collect(ConstPayload(type, pv), item, holder);
+	for (auto &p : item) {
+		const auto it = paths_.find(p.first);
+		if (it == paths_.end()) continue;
+		PathEntry &entry = it->second;
+		if (!p.second.Supported()) {
+			--entry.unsupported;
+		} else {
+			for (const Variant &value : p.second.values) {
+				switch (value.Type()) {
+					case KeyValueString:
+						removeKey(entry.strings, value.As<std::string>(), id);
+						break;
+					case KeyValueDouble:
+						removeKey(entry.doubles, double(value), id);
+						break;
+					case KeyValueBool:
+						removeKey(entry.bools, bool(value), id);
+						break;
+					default:
+						removeKey(entry.ints, toKey<int64_t>(value), id);
+				}
+			}
+		}
+		if (!entry.unsupported && entry.strings.empty() && entry.doubles.empty() && entry.bools.empty() && entry.ints.empty()) {
+			paths_.erase(it);
+		}
+	}
+}
+
+template <typename T>
+void PathsIndex::select(const KeysMap<T> &keys, CondType cond, const VariantArray &values, h_vector<const IdSetPlain *, 4> &found) {
+	if (keys.empty()) return;
+	auto begin = keys.begin(), end = keys.end();
+	switch (cond) {
+		case CondEq:
+		case CondSet:
+			for (const Variant &value : values) {
+				const T key = toKey<T>(value);
+				if (isNaN(key)) continue;
+				const auto it = keys.find(key);
+				if (it != keys.end()) found.push_back(&it->second);
+			}
+			return;
+		case CondLt:
+		case CondLe: {
+			const T key = toKey<T>(values[0]);
+			if (isNaN(key)) return;
+			end = (cond == CondLt) ? keys.lower_bound(key) : keys.upper_bound(key);
+			break;
+		}
+		case CondGt:
+		case CondGe: {
+			const T key = toKey<T>(values[0]);
+			if (isNaN(key)) return;
+			begin = (cond == CondGt) ? keys.upper_bound(key) : keys.lower_bound(key);
+			break;
+		}
+		case CondRange: {
+			const T from = toKey<T>(values[0]), to = toKey<T>(values[1]);
+			if (isNaN(from) || isNaN(to) || to < from) return;
+			begin = keys.lower_bound(from);
+			end = keys.upper_bound(to);
+			break;
+		}
+		default:
+			return;
+	}
+	for (auto it = begin; it != end && found.size() <= kMaxSelectedKeys; ++it) found.push_back(&it->second);
+}
+
+bool PathsIndex::Select(const TagsPath &path, CondType cond, const VariantArray &values, SelectKeyResult &res) const {
+	if (!enabled_) return false;
+	switch (cond) {
+		case CondEq:
+		case CondSet:
+			if (values.empty()) return false;
+			break;
+		case CondLt:
+		case CondLe:
+		case CondGt:
+		case CondGe:
+			if (values.size() != 1) return false;
+			break;
+		case CondRange:
+			if (values.size() != 2) return false;
+			break;
+		default:
+			return false;
+	}
+	// Strings are not compared with numbers by the comparator, so the values of the condition have to be of the single kind
+	bool strings = false, others = false;
+	for (const Variant &value : values) {
+		switch (value.Type()) {
+			case KeyValueString:
+				strings = true;
+				break;
+			case KeyValueInt:
+			case KeyValueInt64:
+			case KeyValueDouble:
+			case KeyValueBool:
+				others = true;
+				break;
+			default:
+				return false;
+		}
+	}
+	if (strings && others) return false;
+
+	h_vector<const IdSetPlain *, 4> found;
+	const auto it = paths_.find(path);
+	if (it != paths_.end()) {
+		const PathEntry &entry = it->second;
+		if (entry.unsupported) return false;
+		if (strings) {
+			select(entry.strings, cond, values, found);
+		} else {
+			select(entry.ints, cond, values, found);
+			select(entry.doubles, cond, values, found);
+			select(entry.bools, cond, values, found);
+		}
+	}
+	if (found.size() > kMaxSelectedKeys) return false;
+
+	std::sort(found.begin(), found.end());
+	found.erase(std::unique(found.begin(), found.end()), found.end());
+	for (const IdSetPlain *ids : found) res.emplace_back(IdSetRef(ids->data(), ids->size()));
+	if (res.empty()) res.emplace_back(IdType(0), IdType(0));
+	return true;
+}
+
+size_t PathsIndex::HeapSize() const noexcept {
+	size_t size = paths_.bucket_count() * sizeof(std::pair<TagsPath, PathEntry>);
+	const auto keysSize = [](const auto &keys) noexcept {
+		size_t s = 0;
+		for (const auto &key : keys) s += sizeof(key) + key.second.heap_size();
+		return s;
+	};
+	for (const auto &path : paths_) {
+		const PathEntry &entry = path.second;
+		size += keysSize(entry.ints) + keysSize(entry.doubles) + keysSize(entry.bools) + keysSize(entry.strings);
+		for (const auto &key : entry.strings) size += key.first.capacity();
+	}
+	return size;
+}
+
+}  // namespace reindexer
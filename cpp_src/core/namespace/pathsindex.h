@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include "core/cjson/tagspath.h"
+#include "core/idset.h"
+#include "core/payload/payloadiface.h"
+#include "core/selectkeyresult.h"
+#include "cpp-btree/btree_map.h"
+#include "estl/fast_hash_map.h"
+
+namespace reindexer {
+
+/// Inverted index of the values of the non-indexed fields of the namespace's items (see 'paths_index' of the namespace config).
+/// Maps the tags path and the scalar value of the field to the ids of the items, so the conditions on the fields, which are unknown
+/// beforehand, are selected without the extraction of the values from the tuple of each item.
+/// Paths, which hold the objects, the references to the indexed fields or both strings and non-strings in some item, are left to
+/// the comparator, since its matching rules for them differ from the plain lookup of the values
+class PathsIndex {
+public:
+	bool Enabled() const noexcept { return enabled_; }
+	/// Drops all the values. Enabled index should be filled again by the namespace's items
+	void Reset(bool enabled) noexcept {
+		enabled_ = enabled;
+		paths_.clear();
+	}
+	void Add(IdType id, const PayloadType &type, const PayloadValue &pv);
+	void Remove(IdType id, const PayloadType &type, const PayloadValue &pv);
+	/// Selects ids of the items, which have value of the path, matching the condition
+	/// @return false, if the condition can not be selected by the index and has to be checked by the comparator
+	bool Select(const TagsPath &path, CondType cond, const VariantArray &values, SelectKeyResult &res) const;
+	size_t HeapSize() const noexcept;
+
+private:
+	// Transparent comparator does not use the vendored adapter of std::less<std::string>
+	template <typename T>
+	using KeysMap = btree::btree_map<T, IdSetPlain, std::less<>>;
+	struct PathEntry {
+		KeysMap<int64_t> ints;
+		KeysMap<double> doubles;
+		KeysMap<bool> bools;
+		KeysMap<std::string> strings;
+		// Count of the items, in which the path can not be selected by the index
+		int unsupported = 0;
+	};
+	struct ItemPath;
+	using ItemPaths = fast_hash_map<TagsPath, ItemPath>;
+
+	static void collect(ctag tag, Serializer &rdser, TagsPath &path, ItemPaths &item);
+	// Values of the strings reference the tuple, which may be loaded into the holder
+	static void collect(const ConstPayload &pl, ItemPaths &item, key_string &holder);
+	template <typename T>
+	static void select(const KeysMap<T> &keys, CondType cond, const VariantArray &values, h_vector<const IdSetPlain *, 4> &found);
+
+	fast_hash_map<TagsPath, PathEntry> paths_;
+	bool enabled_ = false;
+};
+
+}  // namespace reindexer
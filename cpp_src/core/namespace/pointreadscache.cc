@@ -0,0 +1,100 @@
+#include "pointreadscache.h"
+#include "core/queryresults/queryresults.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+void PointReadsCache::Reset(size_t maxItems) {
+	maxItems_.store(maxItems, std::memory_order_relaxed);
+	Clear();
+}
+
+void PointReadsCache::Clear() {
+	for (auto &s : stripes_) {
+		std::lock_guard lck(s.mtx);
+		size_.fetch_sub(s.entries.size(), std::memory_order_relaxed);
+		s.entries.clear();
+	}
+	std::lock_guard lck(ctxMtx_);
+	ctx_.reset();
+}
+
+void PointReadsCache::UpdateContext(const PayloadType &payloadType, const TagsMatcher &tagsMatcher,
+									const std::shared_ptr<const Schema> &schema, const StringsHolderPtr &strHolder, int pkField) {
+	std::lock_guard lck(ctxMtx_);
+	if (ctx_ && ctx_->payloadType.get() == payloadType.get() && ctx_->tagsMatcher.version() == tagsMatcher.version() &&
+		ctx_->tagsMatcher.stateToken() == tagsMatcher.stateToken() && ctx_->schema == schema && ctx_->strHolder == strHolder &&
+		ctx_->pkField == pkField) {
+		return;
+	}
+	const KeyValueType pkType = pkField >= 0 ? payloadType.Field(pkField).Type() : KeyValueUndefined;
+	ctx_ = std::make_shared<const Context>(Context{payloadType, tagsMatcher, schema, strHolder, pkField, pkType});
+}
+
+void PointReadsCache::Put(std::string_view key, IdType id, const PayloadValue &value) {
+	const size_t maxItems = maxItems_.load(std::memory_order_relaxed);
+	if (!maxItems) return;
+	Stripe &s = stripe(key);
+	std::lock_guard lck(s.mtx);
+	auto it = s.entries.find(std::string(key));
+	if (it != s.entries.end()) {
+		it.value() = Entry{id, value};
+		return;
+	}
+	if (s.entries.size() * kStripesCount >= maxItems && !s.entries.empty()) {
+		// Evicted key is returned back by the next locked lookup, if it's still hot
+		s.entries.erase(s.entries.begin());
+		size_.fetch_sub(1, std::memory_order_relaxed);
+	}
+	s.entries.emplace(std::string(key), Entry{id, value});
+	size_.fetch_add(1, std::memory_order_release);
+}
+
+bool PointReadsCache::Erase(std::string_view key) {
+	Stripe &s = stripe(key);
+	std::lock_guard lck(s.mtx);
+	if (!s.entries.erase(std::string(key))) return false;
+	size_.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool PointReadsCache::Get(const VariantArray &keys, const std::shared_ptr<NamespaceImpl> &ns, QueryResults &result) const {
+	if (!Enabled() || Empty() || keys.empty()) return false;
+	WrSerializer ser;
+	ItemRefVector items;
+	items.reserve(keys.size());
+	for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+		const auto ctx = context();
+		if (!ctx || ctx->pkField < 0) return false;
+		items.clear();
+		for (const Variant &key : keys) {
+			ser.Reset();
+			try {
+				MakeKey(ser, Variant(key).convert(ctx->pkType));
+			} catch (const Error &) {
+				return false;
+			}
+			const Stripe &s = stripe(ser.Slice());
+			std::lock_guard lck(s.mtx);
+			const auto it = s.entries.find(std::string(ser.Slice()));
+			if (it == s.entries.end()) return false;
+			items.emplace_back(it->second.id, it->second.value);
+		}
+		// Entries, which were put after the replacement of the context, may be unreadable with the previous one
+		if (context() != ctx) continue;
+
+		// Same order of the items as the one of the select by the primary key
+		std::sort(items.begin(), items.end(), [](const ItemRef &lhs, const ItemRef &rhs) { return lhs.Id() < rhs.Id(); });
+		items.erase(std::unique(items.begin(), items.end(), [](const ItemRef &lhs, const ItemRef &rhs) { return lhs.Id() == rhs.Id(); }),
+					items.end());
+		result.addNSContext(ctx->payloadType, ctx->tagsMatcher, FieldsSet(), ctx->schema);
+		result.AddNamespace(ns, ctx->strHolder);
+		for (auto &item : items) result.Add(item);
+		return true;
+	}
+	return false;
+}
+
+void PointReadsCache::MakeKey(WrSerializer &ser, const Variant &pkValue) { ser.PutVariant(pkValue); }
+
+}  // namespace reindexer
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "core/cjson/tagsmatcher.h"
+#include "core/keyvalue/variant.h"
+#include "core/payload/payloadtype.h"
+#include "core/payload/payloadvalue.h"
+#include "estl/fast_hash_map.h"
+#include "estl/mutex.h"
+#include "stringsholder.h"
+
+namespace reindexer {
+
+class NamespaceImpl;
+class QueryResults;
+class Schema;
+class WrSerializer;
+
+/// Cache of the items, which were selected by the primary key (see 'point_reads_cache_size' of the namespace config).
+/// Cache is read without the lock of the namespace, so the point reads of the hot keys don't wait for the writers. Writers update or
+/// drop the entries of the modified items under the write lock, and the reader retries the lookup, if the context of the namespace
+/// (payload type, tags matcher, schema or strings holder) was replaced concurrently
+class PointReadsCache {
+public:
+	// Count of the independently locked parts of the cache
+	static constexpr size_t kStripesCount = 16;
+	static constexpr int kMaxReadAttempts = 4;
+
+	struct Context {
+		PayloadType payloadType;
+		TagsMatcher tagsMatcher;
+		std::shared_ptr<const Schema> schema;
+		// Strings, which are removed from the indexes after the lookup, are held by this holder or by the following ones
+		StringsHolderPtr strHolder;
+		int pkField;
+		KeyValueType pkType;
+	};
+
+	/// Clears the cache and sets its capacity. 0 disables the cache
+	void Reset(size_t maxItems);
+	bool Enabled() const noexcept { return maxItems_.load(std::memory_order_relaxed); }
+	bool Empty() const noexcept { return !size_.load(std::memory_order_acquire); }
+	size_t Size() const noexcept { return size_.load(std::memory_order_relaxed); }
+	void Clear();
+	/// Replaces the context, if any of its parts was changed. Has to be called under the lock of the namespace before the entries
+	/// are put, so the entries are always readable with the actual context
+	void UpdateContext(const PayloadType &payloadType, const TagsMatcher &tagsMatcher, const std::shared_ptr<const Schema> &schema,
+					   const StringsHolderPtr &strHolder, int pkField);
+	/// Puts the item by its primary key (see MakeKey)
+	void Put(std::string_view key, IdType id, const PayloadValue &value);
+	/// @return true, if the key was cached
+	bool Erase(std::string_view key);
+	/// Appends the items of the primary keys to the results. Keys, which are absent in the namespace, are never cached, so such lookups
+	/// always fail
+	/// @return false, if any of the keys is not cached. Results are not changed in this case
+	bool Get(const VariantArray &keys, const std::shared_ptr<NamespaceImpl> &ns, QueryResults &result) const;
+
+	static void MakeKey(WrSerializer &ser, const Variant &pkValue);
+
+private:
+	struct Entry {
+		IdType id;
+		PayloadValue value;
+	};
+	struct Stripe {
+		mutable spinlock mtx;
+		fast_hash_map<std::string, Entry> entries;
+	};
+
+	Stripe &stripe(std::string_view key) noexcept { return stripes_[std::hash<std::string_view>()(key) % kStripesCount]; }
+	const Stripe &stripe(std::string_view key) const noexcept {
+		return stripes_[std::hash<std::string_view>()(key) % kStripesCount];
+	}
+	std::shared_ptr<const Context> context() const {
+		std::lock_guard lck(ctxMtx_);
+		return ctx_;
+	}
+
+	Stripe stripes_[kStripesCount];
+	mutable spinlock ctxMtx_;
+	std::shared_ptr<const Context> ctx_;
+	std::atomic<size_t> maxItems_ = {0};
+	std::atomic<size_t> size_ = {0};
+};
+
+}  // namespace reindexer
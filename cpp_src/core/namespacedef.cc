@@ -23,6 +23,7 @@ void NamespaceDef::FromJSON(const gason::JsonNode &root) {
 	storage.Enabled(root["storage"]["enabled"].As<bool>(true));
 	storage.DropOnFileFormatError(root["storage"]["drop_on_file_format_error"].As<bool>());
 	storage.CreateIfMissing(root["storage"]["create_if_missing"].As<bool>(true));
+	storage.ReadOnly(root["storage"]["read_only"].As<bool>());
 
 	for (auto &arrelem : root["indexes"]) {
 		IndexDef idx;
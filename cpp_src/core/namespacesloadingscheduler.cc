@@ -0,0 +1,49 @@
+#include "namespacesloadingscheduler.h"
+
+namespace reindexer {
+
+NamespacesLoadingScheduler &NamespacesLoadingScheduler::Instance() {
+	static NamespacesLoadingScheduler scheduler;
+	return scheduler;
+}
+
+void NamespacesLoadingScheduler::SetLimit(size_t limit) {
+	{
+		std::lock_guard lck(mtx_);
+		limit_ = limit;
+	}
+	cv_.notify_all();
+}
+
+size_t NamespacesLoadingScheduler::Limit() const {
+	std::lock_guard lck(mtx_);
+	return limit_;
+}
+
+size_t NamespacesLoadingScheduler::Waiting() const {
+	std::lock_guard lck(mtx_);
+	return waiters_.size();
+}
+
+NamespacesLoadingScheduler::Slot NamespacesLoadingScheduler::Acquire(int64_t size) {
+	std::unique_lock lck(mtx_);
+	const Waiter waiter{size, nextTicket_++};
+	waiters_.insert(waiter);
+	cv_.wait(lck, [this, &waiter] { return (!limit_ || active_ < limit_) && waiters_.begin()->ticket == waiter.ticket; });
+	waiters_.erase(waiters_.begin());
+	++active_;
+	lck.unlock();
+	// Next waiter may be admitted too, if there are free slots
+	cv_.notify_all();
+	return Slot(this);
+}
+
+void NamespacesLoadingScheduler::release() {
+	{
+		std::lock_guard lck(mtx_);
+		--active_;
+	}
+	cv_.notify_all();
+}
+
+}  // namespace reindexer
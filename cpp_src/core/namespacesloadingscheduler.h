@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace reindexer {
+
+/// Process-wide limit of the namespaces, which are loaded from the storages concurrently. Databases may be opened in parallel (see
+/// DBManager::Init), so the waiting namespaces of all the databases are admitted by their size: the biggest namespace is loaded first,
+/// which minimizes the total loading time. Limit is shared by the I/O and CPU parts of the loading
+class NamespacesLoadingScheduler {
+public:
+	/// Loading slot. Next waiting namespace is admitted, when the slot is destroyed
+	class Slot {
+	public:
+		Slot(Slot &&other) noexcept : scheduler_(std::exchange(other.scheduler_, nullptr)) {}
+		Slot(const Slot &) = delete;
+		Slot &operator=(const Slot &) = delete;
+		Slot &operator=(Slot &&) = delete;
+		~Slot() {
+			if (scheduler_) scheduler_->release();
+		}
+
+	private:
+		friend class NamespacesLoadingScheduler;
+		explicit Slot(NamespacesLoadingScheduler *scheduler) noexcept : scheduler_(scheduler) {}
+
+		NamespacesLoadingScheduler *scheduler_;
+	};
+
+	static NamespacesLoadingScheduler &Instance();
+
+	/// Sets the count of the concurrently loaded namespaces. 0 means 'no limit'
+	void SetLimit(size_t limit);
+	size_t Limit() const;
+	/// Count of the namespaces, which are waiting for the slot
+	size_t Waiting() const;
+	/// Waits for the free slot. Namespaces with the greater size are admitted first
+	Slot Acquire(int64_t size);
+
+private:
+	struct Waiter {
+		// Waiters are ordered by the descending size and by the arrival order
+		bool operator<(const Waiter &other) const noexcept { return size != other.size ? size > other.size : ticket < other.ticket; }
+
+		int64_t size;
+		uint64_t ticket;
+	};
+
+	void release();
+
+	mutable std::mutex mtx_;
+	std::condition_variable cv_;
+	size_t limit_ = 0;
+	size_t active_ = 0;
+	uint64_t nextTicket_ = 0;
+	std::set<Waiter> waiters_;
+};
+
+}  // namespace reindexer
@@ -1,6 +1,8 @@
 #include "aggregator.h"
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include "core/namespace/nsitems.h"
 #include "core/queryresults/queryresults.h"
 #include "estl/overloaded.h"
 
@@ -159,8 +161,9 @@ void Aggregator::MultifieldComparator::insertField(size_t toIdx, const FieldsSet
 	}
 }
 
-struct Aggregator::MultifieldOrderedMap : public btree::btree_map<PayloadValue, int, Aggregator::MultifieldComparator> {
-	using Base = btree::btree_map<PayloadValue, int, MultifieldComparator>;
+struct Aggregator::MultifieldOrderedMap
+	: public btree::btree_map<PayloadValue, int, Aggregator::MultifieldComparator, ArenaAllocator<std::pair<const PayloadValue, int>>> {
+	using Base = btree::btree_map<PayloadValue, int, MultifieldComparator, ArenaAllocator<std::pair<const PayloadValue, int>>>;
 	using Base::Base;
 	MultifieldOrderedMap() = delete;
 };
@@ -203,7 +206,8 @@ Aggregator::Aggregator(Aggregator &&) = default;
 Aggregator::~Aggregator() = default;
 
 Aggregator::Aggregator(const PayloadType &payloadType, const FieldsSet &fields, AggType aggType, const h_vector<string, 1> &names,
-					   const h_vector<SortingEntry, 1> &sort, size_t limit, size_t offset, bool compositeIndexFields)
+					   const h_vector<SortingEntry, 1> &sort, size_t limit, size_t offset, bool compositeIndexFields,
+					   MonotonicArena *arena)
 	: payloadType_(payloadType),
 	  fields_(fields),
 	  aggType_(aggType),
@@ -217,18 +221,19 @@ Aggregator::Aggregator(const PayloadType &payloadType, const FieldsSet &fields,
 				if (sort.empty()) {
 					facets_ = std::make_unique<Facets>(SinglefieldUnorderedMap{});
 				} else {
-					facets_ = std::make_unique<Facets>(SinglefieldOrderedMap{SinglefieldComparator{sort}});
+					facets_ = std::make_unique<Facets>(SinglefieldOrderedMap{SinglefieldComparator{sort}, arena});
 				}
 			} else {
 				if (sort.empty()) {
 					facets_ = std::make_unique<Facets>(MultifieldUnorderedMap{payloadType_, fields_});
 				} else {
-					facets_ = std::make_unique<Facets>(MultifieldOrderedMap{MultifieldComparator{sort, fields_, payloadType_}});
+					facets_ = std::make_unique<Facets>(MultifieldOrderedMap{MultifieldComparator{sort, fields_, payloadType_}, arena});
 				}
 			}
 			break;
 		case AggDistinct:
-			distincts_.reset(new HashSetVariantRelax(16, DistinctHasher(payloadType, fields), RelaxVariantCompare(payloadType, fields)));
+			distincts_.reset(
+				new HashSetVariantRelax(16, DistinctHasher(payloadType, fields), RelaxVariantCompare(payloadType, fields), arena));
 			break;
 		case AggMin:
 			result_ = std::numeric_limits<double>::max();
@@ -239,6 +244,12 @@ Aggregator::Aggregator(const PayloadType &payloadType, const FieldsSet &fields,
 		case AggAvg:
 		case AggSum:
 			break;
+		case AggApproxCountDistinct:
+			hll_ = std::make_unique<HyperLogLog>();
+			break;
+		case AggQuantile:
+			tdigest_ = std::make_unique<TDigest>();
+			break;
 		default:
 			throw Error(errParams, "Unknown aggregation type %d", aggType_);
 	}
@@ -311,6 +322,14 @@ AggregationResult Aggregator::GetResult() const {
 				ret.distincts.push_back(value);
 			}
 			break;
+		case AggApproxCountDistinct:
+			assertrx(hll_);
+			ret.value = std::round(hll_->Estimate());
+			break;
+		case AggQuantile:
+			assertrx(tdigest_);
+			ret.value = tdigest_->Quantile(quantile_);
+			break;
 		default:
 			abort();
 	}
@@ -350,17 +369,221 @@ void Aggregator::Aggregate(const PayloadValue &data) {
 		return;
 	}
 
+	// Numeric aggregations take the values of the field without their conversion to the Variants
+	const bool numeric = aggType_ == AggSum || aggType_ == AggAvg || aggType_ == AggMin || aggType_ == AggMax;
+	ConstPayload(payloadType_, data).VisitField(fields_[0], [this, numeric](auto values) {
+		for (const auto &v : values) {
+			if constexpr (std::is_same_v<std::decay_t<decltype(v)>, p_string>) {
+				aggregate(Variant(v, false));
+			} else if (numeric) {
+				aggregate(double(v));
+			} else {
+				aggregate(Variant(v));
+			}
+		}
+	});
+}
+
+void Aggregator::SetColumn(const void *data, size_t size) {
+	switch (aggType_) {
+		case AggSum:
+		case AggAvg:
+		case AggMin:
+		case AggMax:
+			break;
+		default:
+			return;
+	}
+	if (!data || fields_.size() != 1 || fields_[0] == IndexValueType::SetByJsonPath) return;
 	const auto &fieldType = payloadType_.Field(fields_[0]);
-	if (!fieldType.IsArray()) {
-		aggregate(PayloadFieldValue(fieldType, data.Ptr() + fieldType.Offset()).Get());
+	if (fieldType.IsArray()) return;
+	switch (fieldType.Type()) {
+		case KeyValueInt:
+		case KeyValueInt64:
+		case KeyValueDouble:
+		case KeyValueBool:
+			column_ = data;
+			columnSize_ = size;
+			columnType_ = fieldType.Type();
+			break;
+		default:
+			break;
+	}
+}
+
+double Aggregator::columnValue(IdType rowId) const noexcept {
+	switch (columnType_) {
+		case KeyValueInt:
+			return static_cast<const int *>(column_)[rowId];
+		case KeyValueInt64:
+			return static_cast<const int64_t *>(column_)[rowId];
+		case KeyValueDouble:
+			return static_cast<const double *>(column_)[rowId];
+		case KeyValueBool:
+			return static_cast<const bool *>(column_)[rowId];
+		default:
+			abort();
+	}
+}
+
+void Aggregator::Aggregate(const PayloadValue &data, IdType rowId) {
+	if (!column_ || size_t(rowId) >= columnSize_) return Aggregate(data);
+	const double v = columnValue(rowId);
+	switch (aggType_) {
+		case AggSum:
+		case AggAvg:
+			result_ += v;
+			hitCount_++;
+			break;
+		case AggMin:
+			result_ = std::min(v, result_);
+			break;
+		case AggMax:
+			result_ = std::max(v, result_);
+			break;
+		default:
+			abort();
+	}
+}
+
+void Aggregator::Aggregate(const NsItems &items, const IdType *ids, size_t count) {
+	if (!count) return;
+	// Ids are ascending, so the last one is enough to check, that the whole block is covered by column
+	if (!column_ || size_t(ids[count - 1]) >= columnSize_) {
+		for (size_t i = 0; i < count; ++i) Aggregate(items[ids[i]], ids[i]);
 		return;
 	}
+	switch (columnType_) {
+		case KeyValueInt:
+			return reduceColumn(static_cast<const int *>(column_), ids, count);
+		case KeyValueInt64:
+			return reduceColumn(static_cast<const int64_t *>(column_), ids, count);
+		case KeyValueDouble:
+			return reduceColumn(static_cast<const double *>(column_), ids, count);
+		case KeyValueBool:
+			return reduceColumn(static_cast<const bool *>(column_), ids, count);
+		default:
+			abort();
+	}
+}
+
+void Aggregator::AggregateGroup(const Variant &value, int count) {
+	switch (aggType_) {
+		case AggFacet:
+			std::visit(overloaded{[&](SinglefieldUnorderedMap &fm) { fm[value] += count; },
+								  [&](SinglefieldOrderedMap &fm) { fm[value] += count; }, [](MultifieldUnorderedMap &) { assertrx(0); },
+								  [](MultifieldOrderedMap &) { assertrx(0); }},
+					   *facets_);
+			break;
+		case AggDistinct:
+			assertrx(distincts_);
+			distincts_->insert(value);
+			break;
+		case AggSum:
+		case AggAvg:
+			result_ += value.As<double>() * count;
+			hitCount_ += count;
+			break;
+		case AggMin:
+		case AggMax:
+			aggregate(value);
+			break;
+		default:
+			abort();
+	}
+}
 
-	PayloadFieldValue::Array *arr = reinterpret_cast<PayloadFieldValue::Array *>(data.Ptr() + fieldType.Offset());
+template <typename T>
+void Aggregator::reduceColumn(const T *column, const IdType *ids, size_t count) noexcept {
+	// Several independent accumulators break the dependency chain, so the loop may be vectorized
+	constexpr size_t kLanes = 4;
+	double acc[kLanes];
+	std::fill(std::begin(acc), std::end(acc), (aggType_ == AggSum || aggType_ == AggAvg) ? 0.0 : result_);
+	size_t i = 0;
+	switch (aggType_) {
+		case AggSum:
+		case AggAvg:
+			for (; i + kLanes <= count; i += kLanes) {
+				for (size_t l = 0; l < kLanes; ++l) acc[l] += double(column[ids[i + l]]);
+			}
+			for (; i < count; ++i) acc[0] += double(column[ids[i]]);
+			result_ += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+			hitCount_ += count;
+			break;
+		case AggMin:
+			for (; i + kLanes <= count; i += kLanes) {
+				for (size_t l = 0; l < kLanes; ++l) acc[l] = std::min(acc[l], double(column[ids[i + l]]));
+			}
+			for (; i < count; ++i) acc[0] = std::min(acc[0], double(column[ids[i]]));
+			result_ = std::min(std::min(acc[0], acc[1]), std::min(acc[2], acc[3]));
+			break;
+		case AggMax:
+			for (; i + kLanes <= count; i += kLanes) {
+				for (size_t l = 0; l < kLanes; ++l) acc[l] = std::max(acc[l], double(column[ids[i + l]]));
+			}
+			for (; i < count; ++i) acc[0] = std::max(acc[0], double(column[ids[i]]));
+			result_ = std::max(std::max(acc[0], acc[1]), std::max(acc[2], acc[3]));
+			break;
+		default:
+			abort();
+	}
+}
 
-	uint8_t *ptr = data.Ptr() + arr->offset;
-	for (int i = 0; i < arr->len; i++, ptr += fieldType.ElemSizeof()) {
-		aggregate(PayloadFieldValue(fieldType, ptr).Get());
+void Aggregator::Merge(const Aggregator &other) {
+	assertrx(aggType_ == other.aggType_);
+	switch (aggType_) {
+		case AggSum:
+		case AggAvg:
+			result_ += other.result_;
+			hitCount_ += other.hitCount_;
+			break;
+		case AggMin:
+			result_ = std::min(other.result_, result_);
+			break;
+		case AggMax:
+			result_ = std::max(other.result_, result_);
+			break;
+		case AggFacet:
+			assertrx(facets_ && other.facets_);
+			// Both of the aggregators were created with the same settings, so they hold the same kind of map
+			std::visit(
+				[&other](auto &fm) {
+					for (const auto &facet : std::get<std::decay_t<decltype(fm)>>(*other.facets_)) fm[facet.first] += facet.second;
+				},
+				*facets_);
+			break;
+		case AggDistinct:
+			assertrx(distincts_ && other.distincts_);
+			distincts_->insert(other.distincts_->begin(), other.distincts_->end());
+			break;
+		case AggApproxCountDistinct:
+			assertrx(hll_ && other.hll_);
+			hll_->Merge(*other.hll_);
+			break;
+		case AggQuantile:
+			assertrx(tdigest_ && other.tdigest_);
+			tdigest_->Merge(*other.tdigest_);
+			break;
+		default:
+			abort();
+	}
+}
+
+void Aggregator::aggregate(double v) {
+	switch (aggType_) {
+		case AggSum:
+		case AggAvg:
+			result_ += v;
+			hitCount_++;
+			break;
+		case AggMin:
+			result_ = std::min(v, result_);
+			break;
+		case AggMax:
+			result_ = std::max(v, result_);
+			break;
+		default:
+			aggregate(Variant(v));
 	}
 }
 
@@ -386,6 +609,14 @@ void Aggregator::aggregate(const Variant &v) {
 			assertrx(distincts_);
 			distincts_->insert(v);
 			break;
+		case AggApproxCountDistinct:
+			assertrx(hll_);
+			hll_->Add(v.Hash());
+			break;
+		case AggQuantile:
+			assertrx(tdigest_);
+			tdigest_->Add(v.As<double>());
+			break;
 		case AggUnknown:
 		case AggCount:
 		case AggCountCached:
@@ -2,11 +2,15 @@
 
 #include <unordered_set>
 #include "core/index/payload_map.h"
+#include "estl/monotonic_arena.h"
+#include "estl/span.h"
+#include "sketches.h"
 #include "vendor/cpp-btree/btree_map.h"
 
 namespace reindexer {
 
 struct AggregationResult;
+class NsItems;
 
 class Aggregator {
 public:
@@ -17,12 +21,47 @@ public:
 	};
 
 	Aggregator(const PayloadType &, const FieldsSet &, AggType aggType, const h_vector<string, 1> &names,
-			   const h_vector<SortingEntry, 1> &sort = {}, size_t limit = UINT_MAX, size_t offset = 0, bool compositeIndexFields = false);
+			   const h_vector<SortingEntry, 1> &sort = {}, size_t limit = UINT_MAX, size_t offset = 0, bool compositeIndexFields = false,
+			   MonotonicArena *arena = nullptr);
 	Aggregator();
 	Aggregator(Aggregator &&);
 	~Aggregator();
 
 	void Aggregate(const PayloadValue &lhs);
+	/// Aggregates row by id. Reads value from the index column, if it was set by SetColumn
+	void Aggregate(const PayloadValue &lhs, IdType rowId);
+	/// Aggregates block of rows. Sum/Avg/Min/Max over the index column are reduced by the tight typed loop
+	/// @param items - namespace's rows
+	/// @param ids - ascending row ids of the block
+	/// @param count - size of the block
+	void Aggregate(const NsItems &items, const IdType *ids, size_t count);
+	/// Aggregates the value of the single field, which is met count times. Available for Facet/Distinct/Sum/Avg/Min/Max
+	void AggregateGroup(const Variant &value, int count);
+	/// Makes Sum/Avg/Min/Max aggregator read the single scalar index field from the dense rowId-indexed column instead of payload
+	/// @param data - column of the field type values
+	/// @param size - count of values in the column
+	void SetColumn(const void *data, size_t size);
+	/// Sets quantile, which is calculated by AggQuantile aggregator
+	/// @param q - quantile in [0, 1]
+	void SetQuantile(double q) noexcept { quantile_ = q; }
+	/// Merges state of the aggregator, which was aggregating other part of rows with the same settings
+	void Merge(const Aggregator &other);
+	/// @return true, if state of this aggregator may be merged with the other one
+	bool IsMergeable() const noexcept {
+		switch (aggType_) {
+			case AggSum:
+			case AggAvg:
+			case AggMin:
+			case AggMax:
+			case AggFacet:
+			case AggDistinct:
+			case AggApproxCountDistinct:
+			case AggQuantile:
+				return true;
+			default:
+				return false;
+		}
+	}
 	AggregationResult GetResult() const;
 
 	Aggregator(const Aggregator &) = delete;
@@ -31,6 +70,7 @@ public:
 
 	AggType Type() const noexcept { return aggType_; }
 	const h_vector<string, 1> &Names() const noexcept { return names_; }
+	const FieldsSet &Fields() const noexcept { return fields_; }
 
 protected:
 	enum Direction { Desc = -1, Asc = 1 };
@@ -38,11 +78,16 @@ protected:
 	class SinglefieldComparator;
 	struct MultifieldOrderedMap;
 	using MultifieldUnorderedMap = unordered_payload_map<int, false>;
-	using SinglefieldOrderedMap = btree::btree_map<Variant, int, SinglefieldComparator>;
+	using SinglefieldOrderedMap =
+		btree::btree_map<Variant, int, SinglefieldComparator, ArenaAllocator<std::pair<const Variant, int>>>;
 	using SinglefieldUnorderedMap = fast_hash_map<Variant, int>;
 	using Facets = std::variant<MultifieldOrderedMap, MultifieldUnorderedMap, SinglefieldOrderedMap, SinglefieldUnorderedMap>;
 
 	void aggregate(const Variant &variant);
+	void aggregate(double value);
+	double columnValue(IdType rowId) const noexcept;
+	template <typename T>
+	void reduceColumn(const T *column, const IdType *ids, size_t count) noexcept;
 
 	PayloadType payloadType_;
 	FieldsSet fields_;
@@ -102,9 +147,18 @@ protected:
 		FieldsSet fields_;
 	};
 
-	typedef std::unordered_set<Variant, DistinctHasher, RelaxVariantCompare> HashSetVariantRelax;
+	// Node based containers are allocated from the query's arena (if any)
+	typedef std::unordered_set<Variant, DistinctHasher, RelaxVariantCompare, ArenaAllocator<Variant>> HashSetVariantRelax;
 	std::unique_ptr<HashSetVariantRelax> distincts_;
 	bool compositeIndexFields_;
+
+	std::unique_ptr<HyperLogLog> hll_;
+	std::unique_ptr<TDigest> tdigest_;
+	double quantile_ = 0.5;
+
+	const void *column_ = nullptr;
+	size_t columnSize_ = 0;
+	KeyValueType columnType_ = KeyValueUndefined;
 };
 
 }  // namespace reindexer
@@ -4,6 +4,8 @@
 #include "core/cjson/jsonbuilder.h"
 #include "core/namespace/namespaceimpl.h"
 #include "core/query/sql/sqlencoder.h"
+#include "core/querytrace.h"
+#include "core/slowquerylog.h"
 #include "nsselecter.h"
 #include "tools/logger.h"
 
@@ -92,7 +94,7 @@ static std::string addToJSON(JsonBuilder &builder, const JoinedSelector &js, OpT
 					jsonSel.Put("keys", js.PreResult()->values.size());
 					break;
 				case JoinPreResult::ModeIdSet:
-					jsonSel.Put("method", "preselected_rows");
+					jsonSel.Put("method", js.HashJoinUsed() ? "preselected_rows_hash" : "preselected_rows");
 					jsonSel.Put("keys", js.PreResult()->ids.size());
 					break;
 				case JoinPreResult::ModeIterators:
@@ -175,6 +177,10 @@ std::string SelectIteratorContainer::explainJSON(const_iterator begin, const_ite
 				}
 				jsonSel.Put("field", opName(it->operation) + siter.name);
 				jsonSel.Put("matched", siter.GetMatchedCount());
+				if (!isScanIterator) {
+					const int estimated = siter.EstimatedMatched();
+					if (estimated >= 0) jsonSel.Put("estimated", estimated);
+				}
 				jsonSel.Put("method", isScanIterator || siter.comparators_.size() ? "scan" : "index");
 				jsonSel.Put("type", siter.TypeName());
 				name << opName(it->operation, it == begin) << siter.name;
@@ -207,8 +213,50 @@ std::string SelectIteratorContainer::explainJSON(const_iterator begin, const_ite
 	return name.str();
 }
 
-ExplainCalc::Duration ExplainCalc::lap() {
+static uint64_t fingerprint(std::string_view str) noexcept { return std::hash<std::string_view>()(str); }
+
+static uint64_t joinFingerprint(const JoinedSelector &js) {
+	uint64_t ret = CombineFingerprint(uint64_t(js.Type()), fingerprint(js.RightNsName()));
+	if (js.PreResult()) ret = CombineFingerprint(ret, js.PreResult()->dataMode);
+	return CombineFingerprint(ret, js.HashJoinUsed());
+}
+
+uint64_t ExplainCalc::PlanFingerprint() const {
+	uint64_t ret = CombineFingerprint(fingerprint(sortIndex_), sortOptimization_);
+	if (selectors_) ret = CombineFingerprint(ret, selectors_->PlanFingerprint(jselectors_));
+	if (jselectors_) {
+		for (const JoinedSelector &js : *jselectors_) {
+			if (js.Type() == JoinType::InnerJoin || js.Type() == JoinType::OrInnerJoin) continue;
+			ret = CombineFingerprint(ret, joinFingerprint(js));
+		}
+	}
+	return ret;
+}
+
+uint64_t SelectIteratorContainer::planFingerprint(const_iterator begin, const_iterator end, const JoinedSelectors *jselectors) {
+	uint64_t ret = 0;
+	for (const_iterator it = begin; it != end; ++it) {
+		ret = CombineFingerprint(ret, it->operation);
+		it->InvokeAppropriate<void>(
+			[&](const SelectIteratorsBracket &) { ret = CombineFingerprint(ret, planFingerprint(it.cbegin(), it.cend(), jselectors)); },
+			[&](const SelectIterator &siter) {
+				ret = CombineFingerprint(ret, fingerprint(siter.name));
+				ret = CombineFingerprint(ret, fingerprint(siter.TypeName()));
+				ret = CombineFingerprint(ret, siter.comparators_.size() != 0);
+			},
+			[&](const JoinSelectIterator &jiter) {
+				assertrx(jiter.joinIndex < jselectors->size());
+				ret = CombineFingerprint(ret, joinFingerprint((*jselectors)[jiter.joinIndex]));
+			},
+			[&](const FieldsComparator &c) { ret = CombineFingerprint(ret, fingerprint(c.Name())); },
+			[&](const AlwaysFalse &) { ret = CombineFingerprint(ret, fingerprint("AlwaysFalse")); });
+	}
+	return ret;
+}
+
+ExplainCalc::Duration ExplainCalc::lap(std::string_view stage) {
 	auto now = Clock::now();
+	if (trace_ && !stage.empty()) trace_->AddSpan(stage, traceNs_, last_point_, now);
 	Duration d = now - last_point_;
 	last_point_ = now;
 	return d;
@@ -217,7 +265,7 @@ ExplainCalc::Duration ExplainCalc::lap() {
 int ExplainCalc::To_us(const ExplainCalc::Duration &d) { return duration_cast<microseconds>(d).count(); }
 
 void reindexer::ExplainCalc::StartTiming() {
-	if (enabled_) lap();
+	if (enabled_) lap({});
 }
 
 void reindexer::ExplainCalc::StopTiming() {
@@ -225,19 +273,19 @@ void reindexer::ExplainCalc::StopTiming() {
 }
 
 void reindexer::ExplainCalc::AddPrepareTime() {
-	if (enabled_) prepare_ += lap();
+	if (enabled_) prepare_ += lap("prepare");
 }
 
 void reindexer::ExplainCalc::AddSelectTime() {
-	if (enabled_) select_ += lap();
+	if (enabled_) select_ += lap("indexes");
 }
 
 void reindexer::ExplainCalc::AddPostprocessTime() {
-	if (enabled_) postprocess_ += lap();
+	if (enabled_) postprocess_ += lap("postprocess");
 }
 
 void reindexer::ExplainCalc::AddLoopTime() {
-	if (enabled_) loop_ += lap();
+	if (enabled_) loop_ += lap("loop");
 }
 
 void reindexer::ExplainCalc::StartSort() {
@@ -245,7 +293,11 @@ void reindexer::ExplainCalc::StartSort() {
 }
 
 void reindexer::ExplainCalc::StopSort() {
-	if (enabled_) sort_ = Clock::now() - sort_start_point_;
+	if (enabled_) {
+		const auto now = Clock::now();
+		sort_ = now - sort_start_point_;
+		if (trace_) trace_->AddSpan("sort", traceNs_, sort_start_point_, now);
+	}
 }
 
 void reindexer::ExplainCalc::AddIterations(int iters) { iters_ += iters; }
@@ -11,6 +11,7 @@ namespace reindexer {
 
 class SelectIteratorContainer;
 class JoinedSelector;
+class QueryTrace;
 typedef std::vector<JoinedSelector> JoinedSelectors;
 
 class ExplainCalc {
@@ -22,7 +23,9 @@ private:
 	typedef Clock::time_point time_point;
 
 public:
-	ExplainCalc(bool enable) : enabled_(enable) {}
+	/// @param trace - trace of the sampled query. Timings are measured and added to it as spans even without explain
+	ExplainCalc(bool enable, QueryTrace *trace = nullptr, std::string_view traceNs = {})
+		: trace_(trace), traceNs_(traceNs), enabled_(enable || trace) {}
 
 	void StartTiming();
 	void StopTiming();
@@ -43,12 +46,15 @@ public:
 
 	void LogDump(int logLevel);
 	std::string GetJSON();
+	/// Fingerprint of the plan: selectors, their order and execution methods, sort index and joins. Costs, counters and timings are not
+	/// included
+	uint64_t PlanFingerprint() const;
 	Duration Total() const noexcept { return total_; }
 	size_t Iterations() const noexcept { return iters_; }
 	static int To_us(const Duration &d);
 
 protected:
-	Duration lap();
+	Duration lap(std::string_view stage);
 	static const char *JoinTypeName(JoinType jtype);
 
 protected:
@@ -65,6 +71,8 @@ protected:
 	bool sortOptimization_ = false;
 	int iters_ = 0;
 	int count_ = 0;
+	QueryTrace *trace_;
+	std::string_view traceNs_;
 	bool enabled_;
 };
 
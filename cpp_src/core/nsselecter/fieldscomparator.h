@@ -16,6 +16,7 @@ public:
 	const std::string& Name() const noexcept { return name_; }
 	std::string Dump() const { return Name(); }
 	int GetMatchedCount() const noexcept { return matchedCount_; }
+	void AddMatchedCount(int count) noexcept { matchedCount_ += count; }
 	void SetLeftField(const TagsPath& tpath) {
 		setField(tpath, ctx_[0].lCtx_);
 		leftFieldSet = true;
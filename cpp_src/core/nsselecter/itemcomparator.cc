@@ -52,6 +52,40 @@ bool ItemComparator::operator()(const ItemRef &lhs, const ItemRef &rhs) const {
 	}
 }
 
+bool ItemComparator::HasNumericFirstKey(bool &desc) const noexcept {
+	if (!byExpr_.empty() && byExpr_[0].first == 0) {
+		desc = byExpr_[0].second;
+		return true;
+	}
+	if (byIndex_.empty() || byIndex_[0].first != 0 || fields_[0] == IndexValueType::SetByJsonPath) return false;
+	const PayloadFieldType &field = ns_.payloadType_.Field(fields_[0]);
+	switch (field.Type()) {
+		case KeyValueInt:
+		case KeyValueInt64:
+		case KeyValueDouble:
+		case KeyValueBool:
+			desc = byIndex_[0].second;
+			return !field.IsArray();
+		default:
+			return false;
+	}
+}
+
+double ItemComparator::FirstKey(const ItemRef &item) const {
+	if (!byExpr_.empty() && byExpr_[0].first == 0) {
+		return ctx_.sortingContext.exprResults[0][item.SortExprResultsIdx()];
+	}
+	return ConstPayload(ns_.payloadType_, ns_.items_[item.Id()]).VisitField(fields_[0], [](auto values) {
+		if constexpr (std::is_arithmetic_v<typename decltype(values)::value_type>) {
+			return double(values[0]);
+		} else {
+			// First key is numeric (see HasNumericFirstKey)
+			abort();
+			return 0.0;
+		}
+	});
+}
+
 class ItemComparator::BackInserter {
 public:
 	explicit BackInserter(ItemComparator &comparator) : comparator_(comparator) {}
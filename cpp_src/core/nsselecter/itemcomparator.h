@@ -24,6 +24,12 @@ public:
 	void BindForForcedSort();
 	void BindForGeneralSort();
 
+	/// Checks, if the first sort criterion is a sort expression or a scalar numeric field, so its value may be precomputed once per item
+	/// as the numeric sort key. Must be called after BindForGeneralSort
+	bool HasNumericFirstKey(bool &desc) const noexcept;
+	/// Key of the first sort criterion. Items with different keys are ordered by the keys only
+	double FirstKey(const ItemRef &) const;
+
 private:
 	template <typename Inserter>
 	void bindOne(size_t index, const SortingContext::Entry &sortingCtx, Inserter insert, bool multiSort);
@@ -4,9 +4,23 @@
 #include "nsselecter.h"
 
 constexpr size_t kMaxIterationsScaleForInnerJoinOptimization = 100;
+// Sub-select for the single left row costs about as much as hashing of this count of the right rows
+constexpr size_t kHashJoinBuildCostRatio = 32;
+// Sub-selects check the deadline by themselves, but the hash table and preresult values lookups do not
+constexpr int kJoinCancelCheckFrequency = 1000;
 
 namespace reindexer {
 
+// Strings are not held the same way, as by the extraction of the field values to VariantArray
+template <typename T>
+static Variant toVariant(const T &value) {
+	if constexpr (std::is_same_v<T, p_string>) {
+		return Variant(value, false);
+	} else {
+		return Variant(value);
+	}
+}
+
 void JoinedSelector::selectFromRightNs(QueryResults &joinItemR, const Query &query, bool &found, bool &matchedAtLeastOnce) {
 	assertrx(rightNs_);
 
@@ -16,7 +30,7 @@ void JoinedSelector::selectFromRightNs(QueryResults &joinItemR, const Query &que
 
 	rightNs_->getIndsideFromJoinCache(joinRes_);
 	if (joinRes_.needPut) {
-		rightNs_->putToJoinCache(joinRes_, preResult_);
+		rightNs_->putToJoinCache(joinRes_, preResult_, joinQuery_);
 	}
 	if (joinResLong.haveData) {
 		found = joinResLong.it.val.ids_->size();
@@ -29,7 +43,13 @@ void JoinedSelector::selectFromRightNs(QueryResults &joinItemR, const Query &que
 		ctx.reqMatchedOnceFlag = true;
 		ctx.skipIndexesLookup = true;
 		ctx.functions = &selectFunctions_;
+		ctx.bestEffort = bestEffort_;
 		rightNs_->Select(joinItemR, ctx, rdxCtx_);
+		if (joinItemR.incomplete) {
+			// Partial joined rows are neither cached nor returned
+			deadlineExceeded_ = true;
+			return;
+		}
 		if (query.explain_) {
 			preResult_->explainOneSelect = joinItemR.explainResults;
 		}
@@ -44,7 +64,7 @@ void JoinedSelector::selectFromRightNs(QueryResults &joinItemR, const Query &que
 		for (auto &r : joinItemR.Items()) {
 			val.ids_->Add(r.Id(), IdSet::Unordered, 0);
 		}
-		rightNs_->putToJoinCache(joinResLong, val);
+		rightNs_->putToJoinCache(joinResLong, val, joinQuery_, query);
 	}
 }
 
@@ -61,8 +81,135 @@ void JoinedSelector::selectFromPreResultValues(QueryResults &joinItemR, const Qu
 	matchedAtLeastOnce = matched;
 }
 
+bool JoinedSelector::hashJoinAvailable() const {
+	// Hash lookup gives the same rows as the sub-select only for the exact equality of the indexed values
+	if (preResult_->executionMode != JoinPreResult::ModeExecute || preResult_->dataMode != JoinPreResult::ModeIdSet || !rightNs_ ||
+		!itemQuery_.sortingEntries_.empty() || itemQuery_.entries.Size() != joinQuery_.joinEntries_.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < joinQuery_.joinEntries_.size(); ++i) {
+		const QueryJoinEntry &joinEntry = joinQuery_.joinEntries_[i];
+		if (joinEntry.op_ != OpAnd || joinEntry.condition_ != CondEq || !itemQuery_.entries.HoldsOrReferTo<QueryEntry>(i)) return false;
+		const int rightIdxNo = itemQuery_.entries.Get<QueryEntry>(i).idxNo;
+		if (rightIdxNo <= 0 || rightIdxNo >= rightNs_->indexes_.firstSparsePos()) return false;
+		const Index &rightIndex = *rightNs_->indexes_[rightIdxNo];
+		if (IsFullText(rightIndex.Type())) return false;
+		switch (rightIndex.KeyType()) {
+			case KeyValueInt:
+			case KeyValueInt64:
+			case KeyValueDouble:
+				break;
+			case KeyValueString:
+				if (rightIndex.Opts().GetCollateMode() != CollateNone) return false;
+				break;
+			default:
+				return false;
+		}
+	}
+	return true;
+}
+
+bool JoinedSelector::useHashJoin() {
+	switch (hashJoinState_) {
+		case HashJoinState::Built:
+			return true;
+		case HashJoinState::NotAvailable:
+			return false;
+		case HashJoinState::NotChecked:
+			hashJoinState_ = hashJoinAvailable() ? HashJoinState::Available : HashJoinState::NotAvailable;
+			return false;
+		case HashJoinState::Available:
+			// Table is built, when the sub-selects of the previous left rows have already cost about as much as its building
+			if (size_t(called_) * kHashJoinBuildCostRatio < preResult_->ids.size()) return false;
+			buildHashJoinTable();
+			hashJoinState_ = HashJoinState::Built;
+			return true;
+	}
+	return false;
+}
+
+void JoinedSelector::buildHashJoinTable() {
+	rightNs_->getIndsideFromJoinCache(joinRes_);
+	if (joinRes_.needPut) {
+		rightNs_->putToJoinCache(joinRes_, preResult_, joinQuery_);
+	}
+
+	const int rightIdxNo = itemQuery_.entries.Get<QueryEntry>(0).idxNo;
+	hashJoinTable_ = std::make_unique<HashJoinTable>();
+	hashJoinTable_->reserve(preResult_->ids.size());
+	for (IdType rowId : preResult_->ids) {
+		if (rightNs_->items_[rowId].IsFree()) continue;
+		ConstPayload{rightNs_->payloadType_, rightNs_->items_[rowId]}.VisitField(rightIdxNo, [this, rowId](auto values) {
+			for (const auto &v : values) {
+				auto &ids = (*hashJoinTable_)[toVariant(v)];
+				// Array field may contain the same value several times
+				if (ids.empty() || ids.back() != rowId) ids.push_back(rowId);
+			}
+		});
+	}
+}
+
+// Values of the left row, which are converted to the type of the right index. Values, which can not be converted, never match
+static void convertJoinValues(const VariantArray &src, KeyValueType type, VariantArray &dst) {
+	dst.clear();
+	for (const Variant &v : src) {
+		try {
+			dst.emplace_back(v.convert(type));
+		} catch (const Error &) {
+		}
+	}
+}
+
+void JoinedSelector::selectFromHashJoinTable(QueryResults &joinItemR, const Query &query, bool &found, bool &matchedAtLeastOnce) const {
+	assertrx(hashJoinTable_);
+	h_vector<VariantArray, 2> leftValues(query.entries.Size());
+	for (size_t i = 0; i < query.entries.Size(); ++i) {
+		// Join entry without values is replaced by AlwaysFalse
+		if (!query.entries.HoldsOrReferTo<QueryEntry>(i)) return;
+		const QueryEntry &qe = query.entries.Get<QueryEntry>(i);
+		convertJoinValues(qe.values, rightNs_->indexes_[qe.idxNo]->KeyType(), leftValues[i]);
+		if (leftValues[i].empty()) return;
+	}
+
+	h_vector<IdType, 16> rowIds;
+	for (const Variant &v : leftValues[0]) {
+		const auto it = hashJoinTable_->find(v);
+		if (it != hashJoinTable_->end()) rowIds.insert(rowIds.end(), it->second.begin(), it->second.end());
+	}
+	if (leftValues[0].size() > 1) {
+		// Rows are returned in the same order as by the sub-select
+		std::sort(rowIds.begin(), rowIds.end());
+		rowIds.erase(std::unique(rowIds.begin(), rowIds.end()), rowIds.end());
+	}
+
+	size_t matched = 0;
+	VariantArray rightValues;
+	for (IdType rowId : rowIds) {
+		const ConstPayload pl{rightNs_->payloadType_, rightNs_->items_[rowId]};
+		bool match = true;
+		for (size_t i = 1; i < leftValues.size() && match; ++i) {
+			pl.Get(query.entries.Get<QueryEntry>(i).idxNo, rightValues);
+			match = std::any_of(rightValues.begin(), rightValues.end(), [&leftValues, i](const Variant &rv) {
+				return std::find(leftValues[i].begin(), leftValues[i].end(), rv) != leftValues[i].end();
+			});
+		}
+		if (!match) continue;
+		if (++matched > query.count) break;
+		found = true;
+		joinItemR.Add({rowId, rightNs_->items_[rowId], 0, 0});
+	}
+	matchedAtLeastOnce = matched;
+}
+
 bool JoinedSelector::Process(IdType rowId, int nsId, ConstPayload payload, bool match) {
 	++called_;
+	if (!deadlineExceeded_ && !inTransaction_ && called_ % kJoinCancelCheckFrequency == 0) {
+		deadlineExceeded_ = CheckDeadline(rdxCtx_, bestEffort_);
+	}
+	if (deadlineExceeded_) {
+		result_.incomplete = true;
+		return false;
+	}
 	if (optimized_ && !match) {
 		matched_++;
 		return true;
@@ -105,8 +252,14 @@ bool JoinedSelector::Process(IdType rowId, int nsId, ConstPayload payload, bool
 	QueryResults joinItemR;
 	if (preResult_->dataMode == JoinPreResult::ModeValues) {
 		selectFromPreResultValues(joinItemR, *itemQueryPtr, found, matchedAtLeastOnce);
+	} else if (useHashJoin()) {
+		selectFromHashJoinTable(joinItemR, *itemQueryPtr, found, matchedAtLeastOnce);
 	} else {
 		selectFromRightNs(joinItemR, *itemQueryPtr, found, matchedAtLeastOnce);
+		if (deadlineExceeded_) {
+			result_.incomplete = true;
+			return false;
+		}
 	}
 	if (match && found) {
 		if (nsId >= static_cast<int>(result_.joined_.size())) {
@@ -128,13 +281,15 @@ void JoinedSelector::readValuesFromRightNs(VariantArray &values, const Index &le
 	for (IdType rowId : preResult_->ids) {
 		if (rightNs_->items_[rowId].IsFree()) continue;
 		const ConstPayload pl{rightNs_->payloadType_, rightNs_->items_[rowId]};
-		VariantArray buffer;
 		if constexpr (byJsonPath) {
+			VariantArray buffer;
 			pl.GetByJsonPath(rightIndex, rightNs_->tagsMatcher_, buffer, leftIndexType);
+			for (Variant &v : buffer) values.push_back(v.convert(leftIndexType));
 		} else {
-			pl.Get(rightIdxNo, buffer);
+			pl.VisitField(rightIdxNo, [&values, leftIndexType](auto fieldValues) {
+				for (const auto &v : fieldValues) values.push_back(toVariant(v).convert(leftIndexType));
+			});
 		}
-		for (Variant &v : buffer) values.push_back(v.convert(leftIndexType));
 	}
 }
 
@@ -145,13 +300,15 @@ void JoinedSelector::readValuesFromPreResult(VariantArray &values, const Index &
 	for (const ItemRef &item : preResult_->values) {
 		assertrx(!item.Value().IsFree());
 		const ConstPayload pl{preResult_->values.payloadType, item.Value()};
-		VariantArray buffer;
 		if constexpr (byJsonPath) {
+			VariantArray buffer;
 			pl.GetByJsonPath(rightIndex, preResult_->values.tagsMatcher, buffer, leftIndexType);
+			for (Variant &v : buffer) values.push_back(v.convert(leftIndexType));
 		} else {
-			pl.Get(rightIdxNo, buffer);
+			pl.VisitField(rightIdxNo, [&values, leftIndexType](auto fieldValues) {
+				for (const auto &v : fieldValues) values.push_back(toVariant(v).convert(leftIndexType));
+			});
 		}
-		for (Variant &v : buffer) values.push_back(v.convert(leftIndexType));
 	}
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "core/joincache.h"
+#include "estl/fast_hash_map.h"
 #include "explaincalc.h"
 #include "selectiteratorcontainer.h"
 
@@ -68,7 +69,7 @@ public:
 	JoinedSelector(JoinType joinType, std::shared_ptr<NamespaceImpl> leftNs, std::shared_ptr<NamespaceImpl> rightNs, JoinCacheRes &&joinRes,
 				   Query &&itemQuery, QueryResults &result, const JoinedQuery &joinQuery, JoinPreResult::Ptr preResult,
 				   size_t joinedFieldIdx, SelectFunctionsHolder &selectFunctions, int joinedSelectorsCount, bool inTransaction,
-				   const RdxContext &rdxCtx)
+				   bool bestEffort, const RdxContext &rdxCtx)
 		: joinType_(joinType),
 		  called_(0),
 		  matched_(0),
@@ -84,7 +85,8 @@ public:
 		  joinedSelectorsCount_(joinedSelectorsCount),
 		  rdxCtx_(rdxCtx),
 		  optimized_(false),
-		  inTransaction_{inTransaction} {}
+		  inTransaction_{inTransaction},
+		  bestEffort_{bestEffort} {}
 
 	JoinedSelector(JoinedSelector &&) = default;
 	JoinedSelector &operator=(JoinedSelector &&) = delete;
@@ -102,7 +104,11 @@ public:
 											 const RdxContext &);
 	static constexpr int MaxIterationsForPreResultStoreValuesOptimization() noexcept { return 200; }
 	JoinPreResult::CPtr PreResult() const noexcept { return preResult_; }
+	/// Right rows are matched by the hash table, instead of the sub-select per left row
+	bool HashJoinUsed() const noexcept { return hashJoinState_ == HashJoinState::Built; }
 	const std::shared_ptr<NamespaceImpl> &RightNs() const noexcept { return rightNs_; }
+	/// Deadline of the best-effort query is exceeded. Left rows are not joined anymore and the results are marked as incomplete
+	bool DeadlineExceeded() const noexcept { return deadlineExceeded_; }
 
 private:
 	template <bool byJsonPath>
@@ -111,6 +117,14 @@ private:
 	void readValuesFromPreResult(VariantArray &values, const Index &leftIndex, int rightIdxNo, const std::string &rightIndex) const;
 	void selectFromRightNs(QueryResults &joinItemR, const Query &, bool &found, bool &matchedAtLeastOnce);
 	void selectFromPreResultValues(QueryResults &joinItemR, const Query &, bool &found, bool &matchedAtLeastOnce) const;
+	bool useHashJoin();
+	bool hashJoinAvailable() const;
+	void buildHashJoinTable();
+	void selectFromHashJoinTable(QueryResults &joinItemR, const Query &, bool &found, bool &matchedAtLeastOnce) const;
+
+	enum class HashJoinState { NotChecked, NotAvailable, Available, Built };
+	// Right rows of the preresult by the values of the first join field
+	using HashJoinTable = fast_hash_map<Variant, h_vector<IdType, 4>>;
 
 	JoinType joinType_;
 	int called_, matched_;
@@ -127,6 +141,10 @@ private:
 	const RdxContext &rdxCtx_;
 	bool optimized_{false};
 	bool inTransaction_{false};
+	bool bestEffort_{false};
+	bool deadlineExceeded_{false};
+	HashJoinState hashJoinState_{HashJoinState::NotChecked};
+	std::unique_ptr<HashJoinTable> hashJoinTable_;
 };
 using JoinedSelectors = vector<JoinedSelector>;
 
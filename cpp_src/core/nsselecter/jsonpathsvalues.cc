@@ -0,0 +1,35 @@
+#include "jsonpathsvalues.h"
+#include <algorithm>
+
+namespace reindexer {
+
+void JsonPathsValues::Register(const TagsPath &path) {
+	if (std::find(paths_.begin(), paths_.end(), path) != paths_.end()) return;
+	paths_.push_back(path);
+	values_.emplace_back();
+	// Filter of encoder is rebuilt with the new path
+	encoder_.reset();
+	filter_.reset();
+	row_ = nullptr;
+}
+
+const VariantArray *JsonPathsValues::Get(const TagsPath &path, const PayloadType &type, const PayloadValue &pv) {
+	const auto it = std::find(paths_.begin(), paths_.end(), path);
+	if (it == paths_.end()) return nullptr;
+	if (row_ != pv.Ptr() || !encoder_) {
+		if (!encoder_) {
+			filter_ = std::make_unique<FieldsSet>();
+			for (const TagsPath &p : paths_) filter_->push_back(p);
+			encoder_ = std::make_unique<BaseEncoder<PathsExtractor>>(nullptr, filter_.get());
+		}
+		for (VariantArray &values : values_) values.resize(0);
+		row_ = nullptr;
+		PathsExtractor extractor(&paths_, &values_);
+		ConstPayload pl(type, pv);
+		encoder_->Encode(&pl, extractor);
+		row_ = pv.Ptr();
+	}
+	return &values_[it - paths_.begin()];
+}
+
+}  // namespace reindexer
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include "core/cjson/baseencoder.h"
+#include "core/cjson/pathsextractor.h"
+
+namespace reindexer {
+
+/// Values of the non-indexed fields of the current row, which are compared by the conditions of the query.
+/// Paths of all the conditions are extracted by the single pass over the tuple, when the values of any of them are requested
+/// for the next row, so the conditions on the several fields of the same row do not decode its tuple again.
+/// Copy (e.g. the one made for the parallel scan) holds the same paths, but extracts the values of its rows itself
+class JsonPathsValues {
+public:
+	JsonPathsValues() = default;
+	JsonPathsValues(const JsonPathsValues &other) : paths_(other.paths_), values_(other.paths_.size()) {}
+	JsonPathsValues(JsonPathsValues &&) = default;
+	JsonPathsValues &operator=(const JsonPathsValues &other) {
+		if (this != &other) *this = JsonPathsValues(other);
+		return *this;
+	}
+	JsonPathsValues &operator=(JsonPathsValues &&) = default;
+
+	void Register(const TagsPath &path);
+	/// @return values of the path in the row, as they are returned by ConstPayload::GetByJsonPath without the type conversion,
+	/// or nullptr, if the path was not registered. Values are valid until the values of the other row are requested
+	const VariantArray *Get(const TagsPath &path, const PayloadType &type, const PayloadValue &pv);
+	size_t Size() const noexcept { return paths_.size(); }
+	void Clear() noexcept {
+		paths_.clear();
+		values_.clear();
+		encoder_.reset();
+		filter_.reset();
+		row_ = nullptr;
+	}
+
+private:
+	std::vector<TagsPath> paths_;
+	std::vector<VariantArray> values_;
+	// Encoder holds the filter of paths and the tuple of the row, if it is not stored in the payload
+	std::unique_ptr<FieldsSet> filter_;
+	std::unique_ptr<BaseEncoder<PathsExtractor>> encoder_;
+	const uint8_t *row_ = nullptr;
+};
+
+}  // namespace reindexer
@@ -1,18 +1,30 @@
 #include "nsselecter.h"
 #include "core/namespace/namespaceimpl.h"
 #include "core/queryresults/joinresults.h"
+#include "core/resourceusage.h"
+#include "core/slowquerylog.h"
 #include "crashqueryreporter.h"
 #include "explaincalc.h"
 #include "itemcomparator.h"
 #include "querypreprocessor.h"
 #include "sortexpression.h"
 #include "tools/logger.h"
+#include "tools/threadpool.h"
 
 using namespace std::string_view_literals;
 
 constexpr int kMinIterationsForInnerJoinOptimization = 100;
 constexpr int kMaxIterationsForIdsetPreresult = 10000;
 constexpr int kCancelCheckFrequency = 1000;
+constexpr size_t kSelectBatchSize = 1024;
+// Minimal count of rows for each thread of the parallel scan
+constexpr int64_t kMinParallelScanPartSize = 4 * kSelectBatchSize;
+// Minimal count of the extra items, which are collected before the results of ORDER BY with LIMIT are trimmed (see trimToTopN)
+constexpr size_t kMinTopNTrimBuffer = 1024;
+// Minimal count of the items, sorted by the precomputed keys of the first sort criterion
+constexpr size_t kMinItemsForSortKeys = 256;
+// Growth of the count of the nearest rows, which are selected by the R-tree index, when the previous count was not enough for the limit
+constexpr size_t kNearestIdsGrowFactor = 4;
 
 namespace reindexer {
 
@@ -24,8 +36,9 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 	if (ns_->config_.logLevel > ctx.query.debugLevel) {
 		const_cast<Query *>(&ctx.query)->debugLevel = ns_->config_.logLevel;
 	}
+	if (selectByPK(result, ctx, rdxCtx)) return;
 
-	ExplainCalc explain(ctx.query.explain_ || ctx.query.debugLevel >= LogInfo);
+	ExplainCalc explain(ctx.query.explain_ || ctx.query.debugLevel >= LogInfo || ctx.slowQuery, ctx.trace, ns_->name_);
 	ActiveQueryScope queryScope(ctx, ns_->optimizationState_, explain, ns_->locker_.IsReadOnly(), ns_->strHolder_.get());
 
 	explain.StartTiming();
@@ -48,19 +61,29 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 		}
 	}
 
+	// Query outlives the select, so its values are not held by the conditions. Except the ones of the join preresult, which may be cached
 	QueryPreprocessor qPreproc((ctx.preResult && ctx.preResult->executionMode == JoinPreResult::ModeExecute)
 								   ? const_cast<QueryEntries *>(&ctx.query.entries)->MakeLazyCopy()
-								   : QueryEntries{ctx.query.entries},
+							   : ctx.preResult ? QueryEntries{ctx.query.entries}
+											   : ctx.query.entries.MakeViewCopy(),
 							   ctx.query, ns_, ctx.reqMatchedOnceFlag, ctx.inTransaction);
 	if (ctx.joinedSelectors) {
 		qPreproc.InjectConditionsFromJoins(*ctx.joinedSelectors, rdxCtx);
 	}
-	auto aggregators = getAggregators(ctx.query);
+	auto aggregators = getAggregators(ctx.query, &ctx.arena);
 	qPreproc.AddDistinctEntries(aggregators);
 	const bool aggregationsOnly = aggregators.size() > 1 || (aggregators.size() == 1 && aggregators[0].Type() != AggDistinct);
+	const bool materializedAggregations = canUseMaterializedAggregations(ctx, aggregators);
+	if (materializedAggregations) {
+		for (auto &aggregator : aggregators) ns_->materializedAggregations_.Aggregate(aggregator);
+	}
+	size_t indexKeysMatched = 0;
+	const bool indexKeysAggregations = !materializedAggregations && aggregateByIndexKeys(ctx, aggregators, indexKeysMatched);
 	if (!ctx.skipIndexesLookup) qPreproc.LookupQueryIndexes();
 
 	const bool isFt = qPreproc.ContainsFullTextIndexes();
+	// Ids, selected by KNN condition, are not ordered by the sort indexes
+	const bool isKnn = qPreproc.ContainsKnnConditions();
 	if (!ctx.skipIndexesLookup && !isFt) qPreproc.SubstituteCompositeIndexes();
 	qPreproc.ConvertWhereValues();
 
@@ -83,7 +106,21 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 		ctx.isForceAll = true;
 	}
 	const bool isForceAll = ctx.isForceAll;
+	// Query, which is sorted by the distance from the point with limit, selects the rows of the nearest keys of the R-tree index.
+	// Count of the nearest rows is increased, while the rows, which match the other conditions, are not enough for the limit
+	size_t nearestMinIds = 0;
+	bool nearestRetry = false;
 	do {
+		nearestRetry = false;
+		if (materializedAggregations) {
+			// Rows are not scanned at all
+			result.totalCount = ns_->items_.size() - ns_->free_.size();
+			break;
+		}
+		if (indexKeysAggregations) {
+			result.totalCount = indexKeysMatched;
+			break;
+		}
 		qres.Clear();
 		lctx.start = 0;
 		lctx.count = UINT_MAX;
@@ -91,8 +128,8 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 
 		// DO NOT use deducted sort order in the following cases:
 		// - query contains explicity specified sort order
-		// - query contains FullText query.
-		const bool disableOptimizeSortOrder = isFt || !ctx.query.sortingEntries_.empty() || ctx.preResult;
+		// - query contains FullText or KNN query.
+		const bool disableOptimizeSortOrder = isFt || isKnn || !ctx.query.sortingEntries_.empty() || ctx.preResult;
 		SortingEntries sortBy = disableOptimizeSortOrder ? ctx.query.sortingEntries_ : qPreproc.DetectOptimalSortOrder();
 
 		if (ctx.preResult) {
@@ -111,7 +148,7 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 
 		// Prepare sorting context
 		ctx.sortingContext.forcedMode = qPreproc.ContainsForcedSortOrder();
-		prepareSortingContext(sortBy, ctx, isFt, qPreproc.AvailableSelectBySortIndex());
+		prepareSortingContext(sortBy, ctx, isFt, !isKnn && qPreproc.AvailableSelectBySortIndex());
 
 		if (ctx.sortingContext.isOptimizationEnabled()) {
 			// Unbuilt btree index optimization is available for query with
@@ -149,6 +186,19 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 			}
 		}
 
+		Point nearestPoint;
+		const int nearestIndex = isFt ? IndexValueType::NotSet : nearestSortIndex(ctx, qPreproc, !aggregators.empty(), nearestPoint);
+		bool nearestExhausted = true;
+		if (nearestIndex >= 0) {
+			if (!nearestMinIds) nearestMinIds = size_t(qPreproc.Start()) + qPreproc.Count();
+			SelectKeyResult res;
+			if (ns_->indexes_[nearestIndex]->SelectNearest(nearestPoint, nearestMinIds, ctx.sortingContext.sortId(), res,
+															 nearestExhausted)) {
+				static const string nearestName = "-nearest";
+				qres.Append(OpAnd, SelectIterator(res, false, nearestName));
+			}
+		}
+
 		// Prepare data for select functions
 		if (ctx.functions) {
 			fnc_ = ctx.functions->AddNamespace(ctx.query, *ns_, isFt);
@@ -253,9 +303,21 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 
 		explain.AddPostprocessTime();
 
-		// do not calc total by loop, if we have only 1 condition with 1 idset
-		lctx.calcTotal = needCalcTotal &&
+		// do not calc total by loop, if we have only 1 condition with 1 idset or with the disjoint idsets of the same index
+		size_t idsetsTotal = 0;
+		const bool totalByIdsets = needCalcTotal && !hasComparators && !qPreproc.MoreThanOneEvaluation() && qres.Size() == 1 &&
+								   qres.IsSelectIterator(0) && qres.GetOperation(0) == OpAnd &&
+								   qres.Get<SelectIterator>(0).CountByIdsets(idsetsTotal);
+		lctx.calcTotal = needCalcTotal && !totalByIdsets &&
 						 (hasComparators || qPreproc.MoreThanOneEvaluation() || qres.Size() > 1 || qres.Get<SelectIterator>(0).size() > 1);
+		// Non-indexed filters without sorting, joins and fulltext may be evaluated by blocks
+		lctx.batchFiltering = !reverse && hasComparators && !isFt && !ft_ctx_ && ctx.sortingContext.entries.empty() &&
+							  ctx.sortingContext.expressions.empty() && !ctx.sortingContext.isOptimizationEnabled() &&
+							  !qres.Get<SelectIterator>(0).distinct && qres.IsBatchFilterable();
+		lctx.parallelScanParts = lctx.batchFiltering ? getParallelScanParts(ctx, qres) : 0;
+		// Candidates of the loop are charged to the client's account, so the operation may be canceled by its rows quota before the loop
+		ResourceUsageScope::AddRowsExamined(uint64_t(std::max(maxIterations, 0)));
+		if (deadlineExceeded(ctx, result, rdxCtx)) break;
 
 		if (reverse && hasComparators && aggregationsOnly) selectLoop<true, true, true>(lctx, result, rdxCtx);
 		if (!reverse && hasComparators && aggregationsOnly) selectLoop<false, true, true>(lctx, result, rdxCtx);
@@ -268,7 +330,9 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 
 		// Get total count for simple query with 1 condition and 1 idset
 		if (needCalcTotal && !lctx.calcTotal) {
-			if (!ctx.query.entries.Empty()) {
+			if (totalByIdsets) {
+				result.totalCount = idsetsTotal;
+			} else if (!ctx.query.entries.Empty()) {
 				result.totalCount = qres.Get<SelectIterator>(0).GetMaxIterations();
 			} else {
 				result.totalCount = ns_->items_.size() - ns_->free_.size();
@@ -276,10 +340,14 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 		}
 		explain.AddLoopTime();
 		explain.AddIterations(maxIterations);
-		if (!ctx.inTransaction) {
-			ThrowOnCancel(rdxCtx);
+		if (deadlineExceeded(ctx, result, rdxCtx)) break;
+		if (nearestIndex >= 0 && !nearestExhausted && result.Count() - resultInitSize < qPreproc.Count()) {
+			// Too many of the nearest rows do not match the other conditions
+			result.Items().erase(result.Items().begin() + resultInitSize, result.Items().end());
+			nearestMinIds *= kNearestIdsGrowFactor;
+			nearestRetry = true;
 		}
-	} while (qPreproc.NeedNextEvaluation(lctx.start, lctx.count, ctx.matchedAtLeastOnce));
+	} while (nearestRetry || qPreproc.NeedNextEvaluation(lctx.start, lctx.count, ctx.matchedAtLeastOnce));
 
 	processLeftJoins(result, ctx, resultInitSize, rdxCtx);
 	if (!ctx.sortingContext.expressions.empty()) {
@@ -317,6 +385,10 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 						 : result.Count());
 	explain.PutSelectors(&qres);
 	explain.PutJoinedSelectors(ctx.joinedSelectors);
+	if (ctx.slowQuery) {
+		const bool slow = explain.Total() >= ctx.slowQuery->Threshold();
+		ctx.slowQuery->AddPlan(ns_->name_, explain.PlanFingerprint(), slow ? explain.GetJSON() : std::string());
+	}
 
 	if (ctx.query.debugLevel >= LogInfo) {
 		logPrintf(LogInfo, "%s", ctx.query.GetSQL());
@@ -333,8 +405,10 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 		logPrintf(LogInfo, "Query returned: [%s]; total=%d", result.Dump(), result.totalCount);
 	}
 
-	if (needPutCachedTotal) {
+	// Total of the incomplete results is not accurate
+	if (needPutCachedTotal && !result.incomplete) {
 		logPrintf(LogTrace, "[%s] put totalCount value into query cache: %d ", ns_->name_, result.totalCount);
+		MemAccountingScope cacheMemScope(MemAccount::Untracked);
 		ns_->queryCache_->Put(ckey, {static_cast<size_t>(result.totalCount)});
 	}
 	if (ctx.preResult && ctx.preResult->executionMode == JoinPreResult::ModeBuild) {
@@ -359,15 +433,15 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx, const RdxConte
 }
 
 template <typename It>
-const PayloadValue &getValue(const ItemRef &itemRef, const vector<PayloadValue> &items);
+const PayloadValue &getValue(const ItemRef &itemRef, const NsItems &items);
 
 template <>
-const PayloadValue &getValue<ItemRefVector::iterator>(const ItemRef &itemRef, const vector<PayloadValue> &items) {
+const PayloadValue &getValue<ItemRefVector::iterator>(const ItemRef &itemRef, const NsItems &items) {
 	return items[itemRef.Id()];
 }
 
 template <>
-const PayloadValue &getValue<JoinPreResult::Values::iterator>(const ItemRef &itemRef, const vector<PayloadValue> &) {
+const PayloadValue &getValue<JoinPreResult::Values::iterator>(const ItemRef &itemRef, const NsItems &) {
 	return itemRef.Value();
 }
 
@@ -509,7 +583,49 @@ void NsSelecter::applyGeneralSort(It itFirst, It itLast, It itEnd, const ItemCom
 		throw Error(errLogic, "Sorting cannot be applied to merged queries.");
 	}
 
-	std::partial_sort(itFirst, itLast, itEnd, comparator);
+	bool desc = false;
+	const size_t count = itEnd - itFirst;
+	if (count < kMinItemsForSortKeys || !comparator.HasNumericFirstKey(desc)) {
+		std::partial_sort(itFirst, itLast, itEnd, comparator);
+		return;
+	}
+	// Key of the first sort criterion is computed once per item instead of once per comparison. Full comparator is used only for
+	// the items with equal keys
+	std::vector<std::pair<double, unsigned>> keys;
+	keys.reserve(count);
+	for (size_t i = 0; i < count; ++i) keys.emplace_back(comparator.FirstKey(itFirst[i]), i);
+	std::partial_sort(keys.begin(), keys.begin() + (itLast - itFirst), keys.end(),
+					  [&comparator, itFirst, desc](const std::pair<double, unsigned> &lhs, const std::pair<double, unsigned> &rhs) {
+						  if (lhs.first != rhs.first) return desc ? (lhs.first > rhs.first) : (lhs.first < rhs.first);
+						  return comparator(itFirst[lhs.second], itFirst[rhs.second]);
+					  });
+	std::vector<typename std::iterator_traits<It>::value_type> sorted;
+	sorted.reserve(count);
+	for (const auto &key : keys) sorted.emplace_back(std::move(itFirst[key.second]));
+	std::move(sorted.begin(), sorted.end(), itFirst);
+}
+
+void NsSelecter::trimToTopN(SelectCtx &ctx, ItemRefVector &items, size_t initCount, size_t topN) {
+	ItemComparatorState comparatorState;
+	ItemComparator comparator{*ns_, ctx, comparatorState};
+	comparator.BindForGeneralSort();
+	const auto begin = items.begin() + initCount;
+	assertrx(topN && size_t(items.end() - begin) > topN);
+	// Comparator breaks the ties by row id, so the kept items are the same, as the first items of the full sort
+	std::nth_element(begin, begin + topN - 1, items.end(), comparator);
+	items.erase(begin + topN, items.end());
+
+	auto &exprResults = ctx.sortingContext.exprResults;
+	if (exprResults.empty()) return;
+	// Results of the sort expressions are kept only for the remaining items
+	for (auto &eR : exprResults) {
+		h_vector<double, 32> kept;
+		kept.reserve(topN);
+		for (auto it = begin; it != items.end(); ++it) kept.push_back(eR[it->SortExprResultsIdx()]);
+		eR = std::move(kept);
+	}
+	unsigned idx = 0;
+	for (auto it = begin; it != items.end(); ++it) *it = ItemRef(it->Id(), idx++, it->Proc(), it->Nsid(), it->Raw());
 }
 
 void NsSelecter::setLimitAndOffset(ItemRefVector &queryResult, size_t offset, size_t limit) {
@@ -528,13 +644,28 @@ void NsSelecter::processLeftJoins(QueryResults &qr, SelectCtx &sctx, size_t star
 	for (size_t i = startPos; i < qr.Count(); ++i) {
 		IdType rowid = qr[i].GetItemRef().Id();
 		ConstPayload pl(ns_->payloadType_, ns_->items_[rowid]);
+		bool exceeded = false;
 		for (auto &joinedSelector : *sctx.joinedSelectors) {
-			if (joinedSelector.Type() == JoinType::LeftJoin) joinedSelector.Process(rowid, sctx.nsid, pl, true);
+			if (joinedSelector.Type() == JoinType::LeftJoin) {
+				joinedSelector.Process(rowid, sctx.nsid, pl, true);
+				exceeded = exceeded || joinedSelector.DeadlineExceeded();
+			}
+		}
+		if (exceeded || ((i - startPos + 1) % kCancelCheckFrequency == 0 && deadlineExceeded(sctx, qr, rdxCtx))) {
+			// Rows are returned with the complete joined data only
+			qr.Erase(qr.Items().begin() + (exceeded ? i : i + 1), qr.Items().end());
+			qr.incomplete = true;
+			break;
 		}
-		if (!sctx.inTransaction && (i % kCancelCheckFrequency == 0)) ThrowOnCancel(rdxCtx);
 	}
 }
 
+bool NsSelecter::deadlineExceeded(const SelectCtx &sctx, QueryResults &result, const RdxContext &rdxCtx) {
+	if (sctx.inTransaction || !CheckDeadline(rdxCtx, sctx.bestEffort)) return false;
+	result.incomplete = true;
+	return true;
+}
+
 bool NsSelecter::checkIfThereAreLeftJoins(SelectCtx &sctx) const {
 	if (!sctx.joinedSelectors) return false;
 	for (auto &joinedSelector : *sctx.joinedSelectors) {
@@ -620,75 +751,100 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result, const RdxContext
 	VariantArray prevValues;
 	size_t multisortLimitLeft = 0;
 
+	// Items, which are sorted by the general algorithm after the loop, are trimmed to the best offset + limit of them during the loop,
+	// so ORDER BY with small LIMIT does not hold all of the matched items
+	const size_t topN =
+		(sctx.isForceAll && sortingOptions.usingGeneralAlgorithm && !sortingOptions.forcedMode && !sctx.preResult && !aggregationsOnly &&
+		 sctx.query.mergeQueries_.size() <= 1 && ctx.qPreproc.Count() != UINT_MAX)
+			? size_t(ctx.qPreproc.Start()) + ctx.qPreproc.Count()
+			: 0;
+	const size_t topNTrimSize = topN + std::max(topN, kMinTopNTrimBuffer);
+
 	// TODO: nested conditions support. Like (A  OR B OR C) AND (X OR Z)
 	assertrx(!qres.Empty());
 	assertrx(qres.IsSelectIterator(0));
 	SelectIterator &firstIterator = qres.begin()->Value<SelectIterator>();
-	IdType rowId = firstIterator.Val();
-	while (firstIterator.Next(rowId) && !finish) {
-		if (!sctx.inTransaction && (rowId % kCancelCheckFrequency == 0)) ThrowOnCancel(rdxCtx);
-		rowId = firstIterator.Val();
-		IdType properRowId = rowId;
-
-		if (firstSortIndex) {
-			assertf(firstSortIndex->SortOrders().size() > static_cast<size_t>(rowId),
-					"FirstIterator: %s, firstSortIndex: %s, firstSortIndex size: %d, rowId: %d", firstIterator.name.c_str(),
-					firstSortIndex->Name().c_str(), static_cast<int>(firstSortIndex->SortOrders().size()), rowId);
-			properRowId = firstSortIndex->SortOrders()[rowId];
+	if constexpr (!reverse && hasComparators) {
+		if (ctx.batchFiltering) {
+			selectBatchLoop<aggregationsOnly>(ctx, firstIterator, result, rdxCtx);
+			finish = true;
 		}
+	}
+	if (!finish) {
+		IdType rowId = firstIterator.Val();
+		// Deadline is checked by the count of the candidates, because the sparse row ids may skip any fixed remainder
+		int cancelCheckCounter = 0;
+		while (firstIterator.Next(rowId) && !finish) {
+			if (++cancelCheckCounter == kCancelCheckFrequency) {
+				cancelCheckCounter = 0;
+				if (deadlineExceeded(sctx, result, rdxCtx)) break;
+			}
+			rowId = firstIterator.Val();
+			IdType properRowId = rowId;
+
+			if (firstSortIndex) {
+				assertf(firstSortIndex->SortOrders().size() > static_cast<size_t>(rowId),
+						"FirstIterator: %s, firstSortIndex: %s, firstSortIndex size: %d, rowId: %d", firstIterator.name.c_str(),
+						firstSortIndex->Name().c_str(), static_cast<int>(firstSortIndex->SortOrders().size()), rowId);
+				properRowId = firstSortIndex->SortOrders()[rowId];
+			}
 
-		assertrx(static_cast<size_t>(properRowId) < ns_->items_.size());
-		PayloadValue &pv = ns_->items_[properRowId];
-		if (pv.IsFree()) continue;
-		assertrx(pv.Ptr());
-		if (qres.Process<reverse, hasComparators>(pv, &finish, &rowId, properRowId, !ctx.start && ctx.count)) {
-			sctx.matchedAtLeastOnce = true;
-			uint8_t proc = ft_ctx_ ? ft_ctx_->Proc(firstIterator.Pos()) : 0;
-			// Check distinct condition:
-			// Exclude last sets of id from each query result, so duplicated keys will
-			// be removed
-			for (auto &it : qres) {
-				if (it.HoldsOrReferTo<SelectIterator>() && it.Value<SelectIterator>().distinct) {
-					it.Value<SelectIterator>().ExcludeLastSet(pv, rowId, properRowId);
+			assertrx(static_cast<size_t>(properRowId) < ns_->items_.size());
+			const PayloadValue &pv = ns_->items_[properRowId];
+			if (pv.IsFree()) continue;
+			assertrx(pv.Ptr());
+			if (qres.Process<reverse, hasComparators>(pv, &finish, &rowId, properRowId, !ctx.start && ctx.count)) {
+				sctx.matchedAtLeastOnce = true;
+				uint8_t proc = ft_ctx_ ? ft_ctx_->Proc(firstIterator.Pos()) : 0;
+				// Check distinct condition:
+				// Exclude last sets of id from each query result, so duplicated keys will
+				// be removed
+				for (auto &it : qres) {
+					if (it.HoldsOrReferTo<SelectIterator>() && it.Value<SelectIterator>().distinct) {
+						it.Value<SelectIterator>().ExcludeLastSet(pv, rowId, properRowId);
+					}
 				}
-			}
-			if ((ctx.start || (ctx.count == 0)) && sortingOptions.multiColumnByBtreeIndex) {
-				VariantArray recentValues;
-				size_t lastResSize = result.Count();
-				getSortIndexValue(sctx.sortingContext, properRowId, recentValues, proc, result.joined_[sctx.nsid], joinedSelectors);
-				if (prevValues.empty() && result.Items().empty()) {
-					prevValues = recentValues;
-				} else {
-					if (recentValues != prevValues) {
+				if ((ctx.start || (ctx.count == 0)) && sortingOptions.multiColumnByBtreeIndex) {
+					VariantArray recentValues;
+					size_t lastResSize = result.Count();
+					getSortIndexValue(sctx.sortingContext, properRowId, recentValues, proc, result.joined_[sctx.nsid], joinedSelectors);
+					if (prevValues.empty() && result.Items().empty()) {
+						prevValues = recentValues;
+					} else {
+						if (recentValues != prevValues) {
+							if (ctx.start) {
+								result.Items().clear();
+								multisortLimitLeft = 0;
+								lastResSize = 0;
+								prevValues = recentValues;
+							} else if (!ctx.count) {
+								multiSortFinished = true;
+							}
+						}
+					}
+					if (!multiSortFinished) {
+						addSelectResult<aggregationsOnly>(proc, rowId, properRowId, sctx, ctx.aggregators, result);
+					}
+					if (lastResSize < result.Count()) {
 						if (ctx.start) {
-							result.Items().clear();
-							multisortLimitLeft = 0;
-							lastResSize = 0;
-							prevValues = recentValues;
-						} else if (!ctx.count) {
-							multiSortFinished = true;
+							++multisortLimitLeft;
 						}
 					}
 				}
-				if (!multiSortFinished) {
+				if (ctx.start) {
+					--ctx.start;
+				} else if (ctx.count) {
 					addSelectResult<aggregationsOnly>(proc, rowId, properRowId, sctx, ctx.aggregators, result);
-				}
-				if (lastResSize < result.Count()) {
-					if (ctx.start) {
-						++multisortLimitLeft;
+					--ctx.count;
+					if (!ctx.count && sortingOptions.multiColumn && !multiSortFinished)
+						getSortIndexValue(sctx.sortingContext, properRowId, prevValues, proc, result.joined_[sctx.nsid], joinedSelectors);
+					if (topN && result.Items().size() - initCount >= topNTrimSize) {
+						trimToTopN(sctx, result.Items(), initCount, topN);
 					}
 				}
+				if (!ctx.count && !ctx.calcTotal && multiSortFinished) break;
+				if (ctx.calcTotal) result.totalCount++;
 			}
-			if (ctx.start) {
-				--ctx.start;
-			} else if (ctx.count) {
-				addSelectResult<aggregationsOnly>(proc, rowId, properRowId, sctx, ctx.aggregators, result);
-				--ctx.count;
-				if (!ctx.count && sortingOptions.multiColumn && !multiSortFinished)
-					getSortIndexValue(sctx.sortingContext, properRowId, prevValues, proc, result.joined_[sctx.nsid], joinedSelectors);
-			}
-			if (!ctx.count && !ctx.calcTotal && multiSortFinished) break;
-			if (ctx.calcTotal) result.totalCount++;
 		}
 	}
 
@@ -730,6 +886,179 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result, const RdxContext
 	}
 }
 
+template <bool aggregationsOnly>
+void NsSelecter::selectBatchLoop(LoopCtx &ctx, SelectIterator &firstIterator, QueryResults &result, const RdxContext &rdxCtx) {
+	SelectCtx &sctx = ctx.sctx;
+	IdType ids[kSelectBatchSize];
+	bool finish = (ctx.count == 0) && !sctx.reqMatchedOnceFlag && !ctx.calcTotal && !sctx.matchedAtLeastOnce;
+	if (!finish && ctx.parallelScanParts > 1) {
+		selectParallelBatchLoop<aggregationsOnly>(ctx, firstIterator, result, rdxCtx);
+		return;
+	}
+	bool iteratorEnd = false;
+	IdType rowId = firstIterator.Val();
+	while (!finish && !iteratorEnd) {
+		size_t count = 0;
+		while (count < kSelectBatchSize) {
+			if (!firstIterator.Next(rowId)) {
+				iteratorEnd = true;
+				break;
+			}
+			rowId = firstIterator.Val();
+			assertrx(static_cast<size_t>(rowId) < ns_->items_.size());
+			if (!ns_->items_[rowId].IsFree()) ids[count++] = rowId;
+		}
+		if (deadlineExceeded(sctx, result, rdxCtx)) break;
+		count = ctx.qres.FilterBatch(ids, count, ns_->items_);
+		if constexpr (aggregationsOnly) {
+			// Each of the matched rows is aggregated, so the whole block goes to the aggregators at once
+			if (!ctx.start && ctx.count == UINT_MAX) {
+				for (size_t i = 0; i < count; ++i) ns_->itemsAccess_.Touch(ids[i]);
+				for (auto &aggregator : ctx.aggregators) aggregator.Aggregate(ns_->items_, ids, count);
+				if (count) sctx.matchedAtLeastOnce = true;
+				if (ctx.calcTotal) result.totalCount += count;
+				continue;
+			}
+		}
+		for (size_t i = 0; i < count; ++i) {
+			sctx.matchedAtLeastOnce = true;
+			if (ctx.start) {
+				--ctx.start;
+			} else if (ctx.count) {
+				addSelectResult<aggregationsOnly>(0, ids[i], ids[i], sctx, ctx.aggregators, result);
+				--ctx.count;
+			}
+			if (!ctx.count && !ctx.calcTotal) {
+				finish = true;
+				break;
+			}
+			if (ctx.calcTotal) result.totalCount++;
+		}
+	}
+}
+
+template <bool aggregationsOnly>
+void NsSelecter::selectParallelBatchLoop(LoopCtx &ctx, SelectIterator &firstIterator, QueryResults &result, const RdxContext &rdxCtx) {
+	struct ScanPart {
+		ScanPart(const SelectIteratorContainer &it) : qres(it) {}
+		SelectIteratorContainer qres;
+		h_vector<Aggregator, 4> aggregators;
+		std::vector<IdType> matched;
+		std::exception_ptr error;
+	};
+
+	SelectCtx &sctx = ctx.sctx;
+	IdType begin = 0, end = 0;
+	const bool isRange = firstIterator.IsSingleRange(begin, end);
+	assertrx(isRange);
+	(void)isRange;
+	const size_t partsCount = ctx.parallelScanParts;
+	const IdType partSize = (end - begin + partsCount - 1) / partsCount;
+	// Aggregators without limit and offset may be calculated by each thread and merged after that.
+	// Otherwise only rows, which are actually added to the result, are aggregated
+	bool parallelAggregation = ctx.start == 0 && ctx.count == UINT_MAX;
+	for (const auto &agg : ctx.aggregators) parallelAggregation = parallelAggregation && agg.IsMergeable();
+
+	std::vector<ScanPart> parts;
+	parts.reserve(partsCount - 1);
+	for (size_t i = 1; i < partsCount; ++i) {
+		parts.emplace_back(ctx.qres);
+		if (parallelAggregation && !ctx.aggregators.empty()) parts.back().aggregators = getAggregators(sctx.query);
+	}
+	h_vector<Aggregator, 4> noAggregators;
+	std::vector<IdType> matched;
+	std::atomic<bool> stop{false};
+	std::exception_ptr error;
+	// Parts are scanned by the shared pool, so the concurrent queries don't multiply the count of the threads
+	TaskGroup group(partsCount, ThreadPool::Priority::High);
+	try {
+		for (size_t i = 0; i < parts.size(); ++i) {
+			const IdType from = std::min(end, IdType(begin + partSize * (i + 1)));
+			const IdType to = std::min(end, IdType(from + partSize));
+			group.Add([this, &part = parts[i], from, to, &stop]() {
+				try {
+					scanPart(part.qres, from, to, part.aggregators, part.matched, stop, nullptr, false);
+				} catch (...) {
+					part.error = std::current_exception();
+					stop = true;
+				}
+			});
+		}
+		const bool exceeded = scanPart(ctx.qres, begin, std::min(end, IdType(begin + partSize)),
+									   parallelAggregation ? ctx.aggregators : noAggregators, matched, stop,
+									   sctx.inTransaction ? nullptr : &rdxCtx, sctx.bestEffort);
+		if (exceeded) {
+			// Other parts are stopped at their next batch, rows matched by them so far are returned
+			result.incomplete = true;
+			stop = true;
+		}
+	} catch (...) {
+		error = std::current_exception();
+		stop = true;
+		group.Cancel();
+	}
+	group.Wait();
+	if (error) std::rethrow_exception(error);
+	for (auto &part : parts) {
+		if (part.error) std::rethrow_exception(part.error);
+	}
+
+	firstIterator.AddMatchedCount(end - begin);
+	for (auto &part : parts) {
+		ctx.qres.MergeMatchedCounts(part.qres);
+		for (size_t i = 0; i < part.aggregators.size(); ++i) ctx.aggregators[i].Merge(part.aggregators[i]);
+	}
+	// Merge matched rows in the order of row ids, so result is the same as in sequential scan
+	h_vector<Aggregator, 4> &aggregators = parallelAggregation ? noAggregators : ctx.aggregators;
+	for (size_t p = 0; p <= parts.size(); ++p) {
+		for (IdType id : (p == 0) ? matched : parts[p - 1].matched) {
+			sctx.matchedAtLeastOnce = true;
+			if (ctx.start) {
+				--ctx.start;
+			} else if (ctx.count) {
+				addSelectResult<aggregationsOnly>(0, id, id, sctx, aggregators, result);
+				--ctx.count;
+			}
+			if (!ctx.count && !ctx.calcTotal) return;
+			if (ctx.calcTotal) result.totalCount++;
+		}
+	}
+}
+
+bool NsSelecter::scanPart(SelectIteratorContainer &qres, IdType begin, IdType end, h_vector<Aggregator, 4> &aggregators,
+						  std::vector<IdType> &matched, const std::atomic<bool> &stop, const RdxContext *rdxCtx, bool bestEffort) {
+	IdType ids[kSelectBatchSize];
+	for (IdType rowId = begin; rowId < end && !stop.load(std::memory_order_relaxed);) {
+		size_t count = 0;
+		for (; count < kSelectBatchSize && rowId < end; ++rowId) {
+			if (!ns_->items_[rowId].IsFree()) ids[count++] = rowId;
+		}
+		if (rdxCtx && CheckDeadline(*rdxCtx, bestEffort)) return true;
+		count = qres.FilterBatch(ids, count, ns_->items_);
+		for (auto &aggregator : aggregators) aggregator.Aggregate(ns_->items_, ids, count);
+		matched.insert(matched.end(), ids, ids + count);
+	}
+	return false;
+}
+
+size_t NsSelecter::getParallelScanParts(const SelectCtx &ctx, const SelectIteratorContainer &qres) const {
+	const int workers = ns_->config_.parallelScanWorkers;
+	if (workers < 2 || ctx.query.parallelScan == ParallelScanOff || ctx.inTransaction) return 0;
+	IdType begin = 0, end = 0;
+	if (!qres.Get<SelectIterator>(0).IsSingleRange(begin, end)) return 0;
+	const int64_t rows = end - begin;
+	if (ctx.query.parallelScan != ParallelScanOn && rows < ns_->config_.parallelScanThreshold) return 0;
+	// Values set of the CondAllSet comparator is shared between the copies of comparator, so it can not be used concurrently
+	bool concurrentSafe = true;
+	qres.ExecuteAppropriateForEach(
+		Skip<JoinSelectIterator, SelectIteratorsBracket, FieldsComparator, AlwaysFalse>{}, [&concurrentSafe](const SelectIterator &it) {
+			for (const auto &cmp : it.comparators_) concurrentSafe = concurrentSafe && cmp.cond_ != CondAllSet;
+		});
+	if (!concurrentSafe) return 0;
+	const int64_t parts = std::min<int64_t>(workers, rows / kMinParallelScanPartSize);
+	return parts > 1 ? parts : 0;
+}
+
 void NsSelecter::getSortIndexValue(const SortingContext &sortCtx, IdType rowId, VariantArray &value, uint8_t proc,
 								   const joins::NamespaceResults &joinResults, const JoinedSelectors &js) {
 	const SortingContext::Entry *firstEntry = sortCtx.getFirstColumnEntry();
@@ -760,7 +1089,8 @@ void NsSelecter::calculateSortExpressions(uint8_t proc, IdType rowId, IdType pro
 template <bool aggregationsOnly>
 void NsSelecter::addSelectResult(uint8_t proc, IdType rowId, IdType properRowId, SelectCtx &sctx, h_vector<Aggregator, 4> &aggregators,
 								 QueryResults &result) {
-	for (auto &aggregator : aggregators) aggregator.Aggregate(ns_->items_[properRowId]);
+	ns_->itemsAccess_.Touch(properRowId);
+	for (auto &aggregator : aggregators) aggregator.Aggregate(ns_->items_[properRowId], properRowId);
 	if constexpr (aggregationsOnly) return;
 	if (sctx.preResult && sctx.preResult->executionMode == JoinPreResult::ModeBuild) {
 		switch (sctx.preResult->dataMode) {
@@ -795,7 +1125,7 @@ void NsSelecter::addSelectResult(uint8_t proc, IdType rowId, IdType properRowId,
 	}
 }
 
-h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q) const {
+h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q, MonotonicArena *arena) const {
 	static constexpr int NotFilled = -2;
 	h_vector<Aggregator, 4> ret;
 	h_vector<size_t, 4> distinctIndexes;
@@ -805,8 +1135,26 @@ h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q) const {
 		if (ag.fields_.empty()) {
 			throw Error(errQueryExec, "Empty set of fields for aggregation %s", AggregationResult::aggTypeToStr(ag.type_));
 		}
+		double quantile = 0.0;
+		if (ag.type_ == AggQuantile) {
+			// Quantile is passed as the second argument of aggregation, e.g. quantile(price, 0.95)
+			if (ag.fields_.size() != 2) {
+				throw Error(errQueryExec, "Aggregation %s expects field and quantile", AggregationResult::aggTypeToStr(ag.type_));
+			}
+			try {
+				size_t pos = 0;
+				quantile = std::stod(ag.fields_[1], &pos);
+				if (pos != ag.fields_[1].size()) quantile = -1.0;
+			} catch (const std::exception &) {
+				quantile = -1.0;
+			}
+			if (!(quantile >= 0.0 && quantile <= 1.0)) {
+				throw Error(errQueryExec, "Quantile should be a number in [0, 1], but got '%s'", ag.fields_[1]);
+			}
+		}
+		const size_t fieldsCount = (ag.type_ == AggQuantile) ? 1 : ag.fields_.size();
 		if (ag.type_ != AggFacet) {
-			if (ag.fields_.size() != 1) {
+			if (ag.type_ != AggQuantile && ag.fields_.size() != 1) {
 				throw Error(errQueryExec, "For aggregation %s is available exactly one field", AggregationResult::aggTypeToStr(ag.type_));
 			}
 			if (!ag.sortingEntries_.empty()) {
@@ -824,7 +1172,7 @@ h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q) const {
 								 ag.sortingEntries_[i].desc};
 		}
 		int idx = -1;
-		for (size_t i = 0; i < ag.fields_.size(); ++i) {
+		for (size_t i = 0; i < fieldsCount; ++i) {
 			for (size_t j = 0; j < sortingEntries.size(); ++j) {
 				if (iequals(ag.fields_[i], ag.sortingEntries_[j].expression)) {
 					sortingEntries[j].field = i;
@@ -854,7 +1202,12 @@ h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q) const {
 			}
 		}
 		if (ag.type_ == AggDistinct) distinctIndexes.push_back(ret.size());
-		ret.emplace_back(ns_->payloadType_, fields, ag.type_, ag.fields_, sortingEntries, ag.limit_, ag.offset_, compositeIndexFields);
+		ret.emplace_back(ns_->payloadType_, fields, ag.type_, ag.fields_, sortingEntries, ag.limit_, ag.offset_, compositeIndexFields, arena);
+		if (ag.type_ == AggQuantile) ret.back().SetQuantile(quantile);
+		if (fields.size() == 1 && fields[0] != IndexValueType::SetByJsonPath) {
+			const auto column = ns_->indexes_[fields[0]]->Column();
+			ret.back().SetColumn(column.data, column.size);
+		}
 	}
 
 	if (distinctIndexes.size() <= 1) return ret;
@@ -871,6 +1224,156 @@ h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q) const {
 	return ret;
 }
 
+bool NsSelecter::canUseMaterializedAggregations(const SelectCtx &ctx, const h_vector<Aggregator, 4> &aggregators) const noexcept {
+	const Query &q = ctx.query;
+	if (aggregators.empty() || ns_->materializedAggregations_.Empty() || q.count != 0 || !q.entries.Empty() || ctx.preResult ||
+		!q.joinQueries_.empty() || !q.mergeQueries_.empty()) {
+		return false;
+	}
+	return std::all_of(aggregators.begin(), aggregators.end(),
+					   [this](const Aggregator &agg) { return ns_->materializedAggregations_.CanAggregate(agg); });
+}
+
+// Checks the key of the scalar index by the condition, which values are converted to the type of the key
+static bool indexKeyMatches(const Variant &key, CondType cond, const VariantArray &values) {
+	switch (cond) {
+		case CondEq:
+		case CondSet:
+			return std::any_of(values.begin(), values.end(), [&key](const Variant &v) { return key.Compare(v) == 0; });
+		case CondLt:
+			return key.Compare(values[0]) < 0;
+		case CondLe:
+			return key.Compare(values[0]) <= 0;
+		case CondGt:
+			return key.Compare(values[0]) > 0;
+		case CondGe:
+			return key.Compare(values[0]) >= 0;
+		case CondRange:
+			return key.Compare(values[0]) >= 0 && key.Compare(values[1]) <= 0;
+		default:
+			return false;
+	}
+}
+
+bool NsSelecter::aggregateByIndexKeys(const SelectCtx &ctx, h_vector<Aggregator, 4> &aggregators, size_t &matched) const {
+	const Query &q = ctx.query;
+	if (aggregators.empty() || q.count != 0 || ctx.preResult || !q.joinQueries_.empty() || !q.mergeQueries_.empty()) return false;
+	const int field = aggregators[0].Fields().size() == 1 ? aggregators[0].Fields()[0] : int(IndexValueType::SetByJsonPath);
+	if (field <= 0 || field >= ns_->payloadType_.NumFields()) return false;
+	for (const Aggregator &agg : aggregators) {
+		if ((agg.Type() != AggDistinct && agg.Type() != AggFacet) || agg.Fields().size() != 1 || agg.Fields()[0] != field) return false;
+	}
+	const auto &index = ns_->indexes_[field];
+	const IndexOpts &opts = index->Opts();
+	// Each row has the single key of the scalar index, and the keys, which are equal by the collation, are not merged by the aggregators
+	if (IsFullText(index->Type()) || opts.IsArray() || opts.IsSparse() || opts.GetCollateMode() != CollateNone) return false;
+
+	// Conditions on the same index are checked by the keys
+	struct KeyCondition {
+		CondType cond;
+		VariantArray values;
+	};
+	h_vector<KeyCondition, 2> conditions;
+	const KeyValueType keyType = ns_->payloadType_.Field(field).Type();
+	for (auto it = q.entries.cbegin(); it != q.entries.cend(); ++it) {
+		if (it->IsSubTree() || it->operation != OpAnd || !it->HoldsOrReferTo<QueryEntry>()) return false;
+		const QueryEntry &qe = it->Value<QueryEntry>();
+		int idx = IndexValueType::NotSet;
+		if (qe.distinct || !ns_->getIndexByName(qe.index, idx) || idx != field) return false;
+		switch (qe.condition) {
+			case CondEq:
+			case CondSet:
+				break;
+			case CondLt:
+			case CondLe:
+			case CondGt:
+			case CondGe:
+				if (qe.values.size() != 1) return false;
+				break;
+			case CondRange:
+				if (qe.values.size() != 2) return false;
+				break;
+			default:
+				return false;
+		}
+		KeyCondition kc{qe.condition, qe.values};
+		try {
+			for (Variant &v : kc.values) v.convert(keyType);
+		} catch (const Error &) {
+			// Error of the conversion is reported by the generic select
+			return false;
+		}
+		conditions.emplace_back(std::move(kc));
+	}
+
+	matched = 0;
+	return index->ForEachKey([&](const Variant &key, size_t count) {
+		for (const KeyCondition &kc : conditions) {
+			if (!indexKeyMatches(key, kc.cond, kc.values)) return;
+		}
+		for (Aggregator &agg : aggregators) agg.AggregateGroup(key, int(count));
+		matched += count;
+	});
+}
+
+int NsSelecter::nearestSortIndex(const SelectCtx &ctx, const QueryPreprocessor &qPreproc, bool haveAggregators, Point &point) const {
+	const SortingContext &sortCtx = ctx.sortingContext;
+	if (haveAggregators || ctx.preResult || (ctx.joinedSelectors && !ctx.joinedSelectors->empty()) || !ctx.query.mergeQueries_.empty() ||
+		ctx.query.calcTotal != ModeNoTotal || !ctx.query.forcedSortOrder_.empty() || qPreproc.MoreThanOneEvaluation() ||
+		qPreproc.Count() == 0 || qPreproc.Count() == UINT_MAX || sortCtx.entries.size() != 1 || sortCtx.entries[0].data->desc ||
+		sortCtx.entries[0].expression == SortingContext::Entry::NoExpression) {
+		return IndexValueType::NotSet;
+	}
+	const SortExpression &expr = sortCtx.expressions[sortCtx.entries[0].expression];
+	if (expr.Size() != 1 || !expr.HoldsOrReferTo<SortExprFuncs::DistanceFromPoint>(0) || expr.GetOperation(0).negative) {
+		return IndexValueType::NotSet;
+	}
+	const auto &distance = expr.Get<SortExprFuncs::DistanceFromPoint>(0);
+	if (distance.index < 0 || ns_->indexes_[distance.index]->Type() != IndexRTree) return IndexValueType::NotSet;
+	point = distance.point;
+	return distance.index;
+}
+
+bool NsSelecter::selectByPK(QueryResults &result, SelectCtx &ctx, const RdxContext &rdxCtx) {
+	const Query &q = ctx.query;
+	if (q.entries.Size() != 1 || !q.entries.HoldsOrReferTo<QueryEntry>(0) || q.entries.GetOperation(0) != OpAnd || q.HasOffset() ||
+		q.calcTotal != ModeNoTotal || q.explain_ || q.debugLevel >= LogInfo || q.IsWithRank() || !q.aggregations_.empty() ||
+		!q.sortingEntries_.empty() || !q.forcedSortOrder_.empty() || !q.joinQueries_.empty() || !q.mergeQueries_.empty() ||
+		!q.selectFunctions_.empty() || ctx.preResult || ctx.contextCollectingMode || (ctx.joinedSelectors && !ctx.joinedSelectors->empty())) {
+		return false;
+	}
+	const QueryEntry &entry = q.entries.Get<QueryEntry>(0);
+	if ((entry.condition != CondEq && entry.condition != CondSet) || entry.distinct || entry.values.empty()) return false;
+	int idxNo;
+	if (!ns_->getIndexByName(entry.index, idxNo)) return false;
+	Index &index = *ns_->indexes_[idxNo];
+	if (!index.Opts().IsPK() || index.Opts().IsSparse() || IsComposite(index.Type())) return false;
+
+	h_vector<IdType, 4> ids;
+	Index::SelectOpts opts;
+	opts.inTransaction = ctx.inTransaction;
+	VariantArray key{Variant()};
+	for (const Variant &value : entry.values) {
+		try {
+			key[0] = value.convert(index.KeyType());
+		} catch (const Error &) {
+			// Conversion error is reported by the generic path
+			return false;
+		}
+		SelectKeyResults res = index.SelectKey(key, CondEq, 0, opts, nullptr, rdxCtx);
+		if (res.size() && res[0].size() && res[0][0].ids_.size()) ids.push_back(res[0][0].ids_[0]);
+	}
+	// Rows are returned in the order of ids and without duplicates, the same way as by the idset of the generic path
+	std::sort(ids.begin(), ids.end());
+	ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+	const size_t count = std::min<size_t>(ids.size(), q.count);
+	for (size_t i = 0; i < count; ++i) {
+		ns_->itemsAccess_.Touch(ids[i]);
+		result.Add({ids[i], ns_->items_[ids[i]], 0, ctx.nsid});
+	}
+	return true;
+}
+
 void NsSelecter::prepareSortIndex(std::string_view column, int &index, bool &skipSortingEntry, StrictMode strictMode) {
 	assertrx(!column.empty());
 	index = IndexValueType::SetByJsonPath;
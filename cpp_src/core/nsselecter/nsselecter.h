@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include "aggregator.h"
 #include "core/index/index.h"
 #include "joinedselector.h"
@@ -6,6 +7,9 @@
 
 namespace reindexer {
 
+class QueryTrace;
+class SlowQuery;
+
 struct SelectCtx {
 	explicit SelectCtx(const Query &query_, const Query *parentQuery_) : query(query_), parentQuery(parentQuery_) {}
 	const Query &query;
@@ -21,9 +25,17 @@ struct SelectCtx {
 	bool reqMatchedOnceFlag = false;
 	bool contextCollectingMode = false;
 	bool inTransaction = false;
+	// Scan is stopped on the exceeded deadline and the collected rows are returned as incomplete results (see Query::BestEffort)
+	bool bestEffort = false;
 
 	const Query *parentQuery = nullptr;
+	// Trace of the sampled query. Stages of the selection are added to it as spans
+	QueryTrace *trace = nullptr;
+	// Query, which is checked by the slow queries log. Plan of the selection is added to it
+	SlowQuery *slowQuery = nullptr;
 	bool requiresCrashTracking = false;
+	// Memory for the query's temporaries, which are not used after selection (aggregators' containers). Released with context
+	MonotonicArena arena;
 };
 
 class ItemComparator;
@@ -48,10 +60,22 @@ private:
 		ExplainCalc &explain;
 		unsigned start = 0;
 		unsigned count = UINT_MAX;
+		// Filter candidates by blocks of kSelectBatchSize ids (see SelectIteratorContainer::FilterBatch)
+		bool batchFiltering = false;
+		// Count of the row id ranges, which are filtered in parallel (see selectParallelBatchLoop). 0 - sequential scan
+		size_t parallelScanParts = 0;
 	};
 
 	template <bool reverse, bool haveComparators, bool aggregationsOnly>
 	void selectLoop(LoopCtx &ctx, QueryResults &result, const RdxContext &);
+	template <bool aggregationsOnly>
+	void selectBatchLoop(LoopCtx &ctx, SelectIterator &firstIterator, QueryResults &result, const RdxContext &);
+	template <bool aggregationsOnly>
+	void selectParallelBatchLoop(LoopCtx &ctx, SelectIterator &firstIterator, QueryResults &result, const RdxContext &);
+	/// @return true, if the scan was stopped by the exceeded deadline in best-effort mode
+	bool scanPart(SelectIteratorContainer &qres, IdType begin, IdType end, h_vector<Aggregator, 4> &aggregators, std::vector<IdType> &matched,
+				  const std::atomic<bool> &stop, const RdxContext *rdxCtx, bool bestEffort);
+	size_t getParallelScanParts(const SelectCtx &ctx, const SelectIteratorContainer &qres) const;
 	template <bool desc, bool multiColumnSort, typename It>
 	It applyForcedSort(It begin, It end, const ItemComparator &, const SelectCtx &ctx);
 	template <typename It>
@@ -62,7 +86,24 @@ private:
 	void addSelectResult(uint8_t proc, IdType rowId, IdType properRowId, SelectCtx &sctx, h_vector<Aggregator, 4> &aggregators,
 						 QueryResults &result);
 
-	h_vector<Aggregator, 4> getAggregators(const Query &) const;
+	h_vector<Aggregator, 4> getAggregators(const Query &, MonotonicArena *arena = nullptr) const;
+	/// @return true, if all of the aggregations are calculated over the whole namespace by the materialized counts and items are not
+	/// requested
+	bool canUseMaterializedAggregations(const SelectCtx &ctx, const h_vector<Aggregator, 4> &aggregators) const noexcept;
+	/// Calculates Distinct and Facet aggregations of the single scalar index by the keys of the index and the sizes of their idsets,
+	/// if items are not requested and the query has no conditions except the ones on the same index
+	/// @param matched - count of the rows, which match the conditions
+	/// @return false, if the aggregations have to be calculated by the rows
+	bool aggregateByIndexKeys(const SelectCtx &ctx, h_vector<Aggregator, 4> &aggregators, size_t &matched) const;
+	/// Selects the items of the plain 'WHERE pk = ?' or 'WHERE pk IN (...)' query directly from the PK index, without the query
+	/// preprocessing, selectors and explain
+	/// @return false, if the query is not a primary key lookup and has to be selected by the generic path
+	// Returns number of the R-tree index, if the query is sorted only by the distance of its points from the point and has limit,
+	// so the nearest rows of the index may be selected instead of the sort of all the matched rows
+	int nearestSortIndex(const SelectCtx &, const QueryPreprocessor &, bool haveAggregators, Point &point) const;
+	bool selectByPK(QueryResults &result, SelectCtx &ctx, const RdxContext &);
+	/// Keeps the best topN of the items after initCount (in the order of the general sort) and drops the rest of them
+	void trimToTopN(SelectCtx &ctx, ItemRefVector &items, size_t initCount, size_t topN);
 	void setLimitAndOffset(ItemRefVector &result, size_t offset, size_t limit);
 	void prepareSortingContext(SortingEntries &sortBy, SelectCtx &ctx, bool isFt, bool availableSelectBySortIndex);
 	void prepareSortIndex(std::string_view column, int &index, bool &skipSortingEntry, StrictMode);
@@ -71,6 +112,9 @@ private:
 	void getSortIndexValue(const SortingContext &sortCtx, IdType rowId, VariantArray &value, uint8_t proc, const joins::NamespaceResults &,
 						   const JoinedSelectors &);
 	void processLeftJoins(QueryResults &qr, SelectCtx &sctx, size_t startPos, const RdxContext &);
+	/// Checks the query's deadline. Throws on the cancellation, unless the query may return the partial results
+	/// @return true, if the selection has to be stopped and its results are marked as incomplete
+	bool deadlineExceeded(const SelectCtx &sctx, QueryResults &result, const RdxContext &);
 	bool checkIfThereAreLeftJoins(SelectCtx &sctx) const;
 	template <typename It>
 	void sortResults(LoopCtx &sctx, It begin, It end, const SortingOptions &sortingOptions);
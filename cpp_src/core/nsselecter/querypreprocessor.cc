@@ -140,6 +140,13 @@ bool QueryPreprocessor::ContainsFullTextIndexes() const {
 	return false;
 }
 
+bool QueryPreprocessor::ContainsKnnConditions() const {
+	for (auto it = cbegin().PlainIterator(), end = cend().PlainIterator(); it != end; ++it) {
+		if (it->HoldsOrReferTo<QueryEntry>() && it->Value<QueryEntry>().condition == CondKnn) return true;
+	}
+	return false;
+}
+
 int QueryPreprocessor::getCompositeIndex(const FieldsSet &fields) const {
 	if (fields.getTagsPathsLength() == 0) {
 		for (int i = ns_.indexes_.firstCompositePos(); i < ns_.indexes_.totalSize(); i++) {
@@ -226,7 +233,7 @@ void QueryPreprocessor::convertWhereValues(QueryEntry *qe) const {
 		fields = &ns_.indexes_[qe->idxNo]->Fields();
 	}
 	if (keyType != KeyValueUndefined) {
-		if (qe->condition != CondDWithin) {
+		if (qe->condition != CondDWithin && qe->condition != CondKnn) {
 			for (auto &key : qe->values) {
 				key.convert(keyType, &ns_.payloadType_, fields);
 			}
@@ -332,7 +339,7 @@ KeyValueType QueryPreprocessor::detectQueryEntryFieldType(const QueryEntry &qent
 	KeyValueType keyType = KeyValueUndefined;
 	for (auto &item : ns_.items_) {
 		if (!item.IsFree()) {
-			Payload pl(ns_.payloadType_, item);
+			ConstPayload pl(ns_.payloadType_, item);
 			VariantArray values;
 			pl.GetByJsonPath(qentry.index, ns_.tagsMatcher_, values, KeyValueUndefined);
 			if (values.size() > 0) keyType = values[0].Type();
@@ -356,6 +363,66 @@ void QueryPreprocessor::AddDistinctEntries(const h_vector<Aggregator, 4> &aggreg
 	}
 }
 
+static void moveDistincts(AggregationResult &aggRes, VariantArray &values) {
+	values.reserve(values.size() + aggRes.distincts.size());
+	assertrx(aggRes.distinctsFields.size() == 1);
+	const auto field = aggRes.distinctsFields[0];
+	for (Variant &distValue : aggRes.distincts) {
+		if (distValue.Type() == KeyValueComposite) {
+			ConstPayload pl(aggRes.payloadType, distValue.operator const PayloadValue &());
+			VariantArray v;
+			if (field == IndexValueType::SetByJsonPath) {
+				assertrx(aggRes.distinctsFields.getTagsPathsLength() == 1);
+				pl.GetByJsonPath(aggRes.distinctsFields.getTagsPath(0), v, KeyValueUndefined);
+			} else {
+				pl.Get(field, v);
+			}
+			assertrx(v.size() == 1);
+			values.emplace_back(std::move(v[0]));
+		} else {
+			values.emplace_back(std::move(distValue));
+		}
+	}
+}
+
+// Inner join, which does not return the joined items and is matched by the single equality, is the semi-join:
+// 'WHERE left_field IN (SELECT DISTINCT right_field FROM right_ns WHERE ...)'
+static bool isSemiJoin(const JoinedSelector &joinedSelector) noexcept {
+	if (joinedSelector.Type() != InnerJoin) return false;
+	const auto &joinQuery = joinedSelector.JoinQuery();
+	if (joinQuery.count != 0 || joinQuery.joinEntries_.size() != 1) return false;
+	const auto &joinEntry = joinQuery.joinEntries_[0];
+	return joinEntry.op_ == OpAnd && (joinEntry.condition_ == CondEq || joinEntry.condition_ == CondSet);
+}
+
+void QueryPreprocessor::injectSemiJoin(size_t cur, const JoinedSelector &joinedSelector, const RdxContext &rdxCtx) {
+	const auto &joinEntry = joinedSelector.JoinQuery().joinEntries_[0];
+	Query query{joinedSelector.JoinQuery()};
+	query.count = UINT_MAX;
+	query.start = 0;
+	query.sortingEntries_.clear();
+	query.forcedSortOrder_.clear();
+	query.aggregations_.clear();
+	query.Distinct(joinEntry.joinIndex_);
+	SelectCtx ctx{query, nullptr};
+	QueryResults qr;
+	joinedSelector.RightNs()->Select(qr, ctx, rdxCtx);
+	assertrx(qr.aggregationResults.size() == 1 && qr.aggregationResults[0].type == AggDistinct);
+
+	QueryEntry newEntry;
+	newEntry.index = joinEntry.index_;
+	if (!ns_.getIndexByName(newEntry.index, newEntry.idxNo)) {
+		newEntry.idxNo = IndexValueType::SetByJsonPath;
+	}
+	newEntry.condition = CondSet;
+	moveDistincts(qr.aggregationResults[0], newEntry.values);
+	if (newEntry.values.empty()) {
+		SetValue(cur, AlwaysFalse{});
+	} else {
+		SetValue(cur, std::move(newEntry));
+	}
+}
+
 void QueryPreprocessor::injectConditionsFromJoins(size_t from, size_t to, JoinedSelectors &js, const RdxContext &rdxCtx) {
 	for (size_t cur = from; cur < to; cur = Next(cur)) {
 		container_[cur].InvokeAppropriate<void>(
@@ -364,6 +431,11 @@ void QueryPreprocessor::injectConditionsFromJoins(size_t from, size_t to, Joined
 			[&](const JoinQueryEntry &jqe) {
 				assertrx(js.size() > jqe.joinIndex);
 				JoinedSelector &joinedSelector = js[jqe.joinIndex];
+				// Left rows are filtered by the values of the right query, so the joined selector is not called for them at all
+				if (isSemiJoin(joinedSelector)) {
+					injectSemiJoin(cur, joinedSelector, rdxCtx);
+					return;
+				}
 				if (joinedSelector.PreResult()->dataMode == JoinPreResult::ModeValues) return;
 				const auto &rNsCfg = joinedSelector.RightNs()->Config();
 				if (rNsCfg.maxPreselectSize == 0 && rNsCfg.maxPreselectPart == 0.0) return;
@@ -437,25 +509,7 @@ void QueryPreprocessor::injectConditionsFromJoins(size_t from, size_t to, Joined
 						case CondSet: {
 							assertrx(qr.aggregationResults[0].type == AggDistinct);
 							newEntry.condition = CondSet;
-							newEntry.values.reserve(qr.aggregationResults[0].distincts.size());
-							assertrx(qr.aggregationResults[0].distinctsFields.size() == 1);
-							const auto field = qr.aggregationResults[0].distinctsFields[0];
-							for (Variant &distValue : qr.aggregationResults[0].distincts) {
-								if (distValue.Type() == KeyValueComposite) {
-									ConstPayload pl(qr.aggregationResults[0].payloadType, distValue.operator const PayloadValue &());
-									VariantArray v;
-									if (field == IndexValueType::SetByJsonPath) {
-										assertrx(qr.aggregationResults[0].distinctsFields.getTagsPathsLength() == 1);
-										pl.GetByJsonPath(qr.aggregationResults[0].distinctsFields.getTagsPath(0), v, KeyValueUndefined);
-									} else {
-										pl.Get(field, v);
-									}
-									assertrx(v.size() == 1);
-									newEntry.values.emplace_back(std::move(v[0]));
-								} else {
-									newEntry.values.emplace_back(std::move(distValue));
-								}
-							}
+							moveDistincts(qr.aggregationResults[0], newEntry.values);
 							break;
 						}
 						case CondLt:
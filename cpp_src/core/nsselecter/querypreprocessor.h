@@ -23,6 +23,7 @@ public:
 		container_.resize(container_.size() - merged);
 	}
 	bool ContainsFullTextIndexes() const;
+	bool ContainsKnnConditions() const;
 	bool ContainsForcedSortOrder() const noexcept {
 		if (queryEntryAddedByForcedSortOptimization_) {
 			return forcedStage();
@@ -63,6 +64,8 @@ private:
 	void convertWhereValues(QueryEntry *) const;
 	const Index *findMaxIndex(QueryEntries::const_iterator begin, QueryEntries::const_iterator end) const;
 	void injectConditionsFromJoins(size_t from, size_t to, JoinedSelectors &, const RdxContext &);
+	/// Replaces the join entry by the condition on the values of the right query
+	void injectSemiJoin(size_t cur, const JoinedSelector &, const RdxContext &);
 	void checkStrictMode(const std::string &index, int idxNo) const;
 
 	NamespaceImpl &ns_;
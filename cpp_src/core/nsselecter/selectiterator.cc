@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cmath>
 #include "core/index/indexiterator.h"
+#include "core/namespace/nsitems.h"
 
 namespace reindexer {
 
@@ -17,6 +18,25 @@ void SelectIterator::Bind(PayloadType type, int field) {
 	for (Comparator &cmp : comparators_) cmp.Bind(type, field);
 }
 
+void SelectIterator::TryCompareBlock(const NsItems &items, const IdType *ids, size_t count, uint64_t *mask,
+									 JsonPathsValues &jsonValues) {
+	const size_t words = (count + 63) / 64;
+	if (comparators_.size() == 1 && comparators_[0].IsBlockComparable()) {
+		comparators_[0].CompareBlock(items, ids, count, mask);
+		for (size_t w = 0; w < words; ++w) matchedCount_ += __builtin_popcountll(mask[w]);
+		return;
+	}
+	std::fill(mask, mask + words, 0);
+	for (size_t i = 0; i < count; ++i) mask[i >> 6] |= uint64_t(TryCompare(items[ids[i]], ids[i], jsonValues)) << (i & 63);
+}
+
+bool SelectIterator::IsSingleRange(IdType &rBegin, IdType &rEnd) const noexcept {
+	if (size() != 1 || !begin()->isRange_ || !comparators_.empty()) return false;
+	rBegin = begin()->rBegin_;
+	rEnd = begin()->rEnd_;
+	return true;
+}
+
 void SelectIterator::Start(bool reverse) {
 	isReverse_ = reverse;
 	lastIt_ = begin();
@@ -31,6 +51,10 @@ void SelectIterator::Start(bool reverse) {
 			} else {
 				it->rIt_ = it->rBegin_;
 			}
+		} else if (it->useBitmap_) {
+			assertrx(it->bitmap_);
+			it->bmCursor_ = 0;
+			it->bmVal_ = isReverse_ ? INT_MAX : INT_MIN;
 		} else {
 			if (it->useBtree_) {
 				assertrx(it->set_);
@@ -90,6 +114,14 @@ bool SelectIterator::nextFwd(IdType minHint) {
 					lastIt_ = it;
 				}
 			}
+		} else if (it->useBitmap_) {
+			if (it->bmVal_ != INT_MAX) {
+				if (it->bmVal_ <= lastVal_) it->bmVal_ = it->bitmap_->Next(lastVal_ + 1, it->bmCursor_);
+				if (it->bmVal_ < minVal) {
+					minVal = it->bmVal_;
+					lastIt_ = it;
+				}
+			}
 		} else {
 			if (it->isRange_ && it->rIt_ != it->rEnd_) {
 				it->rIt_ = min(it->rEnd_, max(it->rIt_, lastVal_ + 1));
@@ -125,6 +157,14 @@ bool SelectIterator::nextRev(IdType maxHint) {
 				maxVal = *it->ritset_;
 				lastIt_ = it;
 			}
+		} else if (it->useBitmap_) {
+			if (it->bmVal_ != INT_MIN) {
+				if (it->bmVal_ >= lastVal_) it->bmVal_ = it->bitmap_->Prev(lastVal_ - 1, it->bmCursor_);
+				if (it->bmVal_ > maxVal) {
+					maxVal = it->bmVal_;
+					lastIt_ = it;
+				}
+			}
 		} else if (it->isRange_ && it->rrIt_ != it->rrEnd_) {
 			it->rrIt_ = max(it->rrEnd_, min(it->rrIt_, lastVal_ - 1));
 
@@ -132,7 +172,7 @@ bool SelectIterator::nextRev(IdType maxHint) {
 				maxVal = it->rrIt_;
 				lastIt_ = it;
 			}
-		} else if (!it->isRange_ && !it->useBtree_ && it->rit_ != it->rend_) {
+		} else if (!it->isRange_ && !it->useBtree_ && !it->useBitmap_ && it->rit_ != it->rend_) {
 			for (; it->rit_ != it->rend_ && *it->rit_ >= lastVal_; it->rit_++) {
 			}
 			if (it->rit_ != it->rend_ && *it->rit_ > maxVal) {
@@ -154,6 +194,9 @@ bool SelectIterator::nextFwdSingleIdset(IdType minHint) {
 			it->itset_ = it->set_->upper_bound(lastVal_);
 		}
 		lastVal_ = (it->itset_ != it->set_->end()) ? *it->itset_ : INT_MAX;
+	} else if (it->useBitmap_) {
+		if (it->bmVal_ != INT_MAX && it->bmVal_ <= lastVal_) it->bmVal_ = it->bitmap_->Next(lastVal_ + 1, it->bmCursor_);
+		lastVal_ = it->bmVal_;
 	} else {
 		if (it->bsearch_) {
 			if (it->it_ != it->end_ && *it->it_ <= lastVal_) {
@@ -177,6 +220,9 @@ bool SelectIterator::nextRevSingleIdset(IdType maxHint) {
 		for (; it->ritset_ != it->setrend_ && *it->ritset_ >= lastVal_; it->ritset_++) {
 		}
 		lastVal_ = (it->ritset_ != it->setrend_) ? *it->ritset_ : INT_MIN;
+	} else if (it->useBitmap_) {
+		if (it->bmVal_ != INT_MIN && it->bmVal_ >= lastVal_) it->bmVal_ = it->bitmap_->Prev(lastVal_ - 1, it->bmCursor_);
+		lastVal_ = it->bmVal_;
 	} else {
 		for (; it->rit_ != it->rend_ && *it->rit_ >= lastVal_; it->rit_++) {
 		}
@@ -209,25 +255,21 @@ bool SelectIterator::nextRevSingleRange(IdType maxHint) {
 
 // Unsorted next implementation
 bool SelectIterator::nextUnsorted() {
-	if (lastIt_ == end()) {
-		return false;
-	} else if (lastIt_->it_ == lastIt_->end_) {
-		++lastIt_;
-
-		while (lastIt_ != end()) {
-			if (lastIt_->it_ != lastIt_->end_) {
-				lastVal_ = *lastIt_->it_;
-				lastIt_->it_++;
-				return true;
+	for (; lastIt_ != end(); ++lastIt_) {
+		if (lastIt_->useBitmap_) {
+			if (lastIt_->bmVal_ != INT_MAX) {
+				lastIt_->bmVal_ = lastIt_->bitmap_->Next(lastIt_->bmVal_ == INT_MIN ? 0 : lastIt_->bmVal_ + 1, lastIt_->bmCursor_);
+				if (lastIt_->bmVal_ != INT_MAX) {
+					lastVal_ = lastIt_->bmVal_;
+					return true;
+				}
 			}
-			++lastIt_;
+		} else if (lastIt_->it_ != lastIt_->end_) {
+			lastVal_ = *lastIt_->it_;
+			lastIt_->it_++;
+			return true;
 		}
-	} else {
-		lastVal_ = *lastIt_->it_;
-		lastIt_->it_++;
-		return true;
 	}
-
 	return false;
 }
 
@@ -244,6 +286,8 @@ void SelectIterator::ExcludeLastSet(const PayloadValue &value, IdType rowId, IdT
 		if (lastIt_->useBtree_) {
 			lastIt_->itset_ = lastIt_->setend_;
 			lastIt_->ritset_ = lastIt_->setrend_;
+		} else if (lastIt_->useBitmap_) {
+			lastIt_->bmVal_ = isReverse_ ? INT_MIN : INT_MAX;
 		} else {
 			lastIt_->it_ = lastIt_->end_;
 			lastIt_->rit_ = lastIt_->rend_;
@@ -276,12 +320,37 @@ double SelectIterator::Cost(int expectedIterations) const {
 	double result{0.0};
 	if (!comparators_.empty()) {
 		result = expectedIterations + 1;
+		// Comparators with known selectivity are checked first, the most selective of them rejects the most rows
+		if (comparatorsSelectivity_ >= 0.0) result -= 1.0 - comparatorsSelectivity_;
 	} else if (empty()) {
 		result = GetMaxIterations();
 	}
 	return result + static_cast<double>(distinct ? 1 : GetMaxIterations()) * size();
 }
 
+bool SelectIterator::CountByIdsets(size_t &count) const {
+	if (!disjointIdsets || distinct || !comparators_.empty()) return false;
+	// Duplicated keys of the condition select the same idset several times, so the idsets are counted once
+	h_vector<std::pair<const void *, size_t>, 8> sets;
+	sets.reserve(size());
+	for (const SingleSelectKeyResult &r : *this) {
+		if (r.indexForwardIter_ || r.isRange_) return false;
+		if (r.useBtree_) {
+			sets.emplace_back(r.set_, r.set_->size());
+		} else if (r.useBitmap_) {
+			sets.emplace_back(r.bitmap_, r.bitmap_->Size());
+		} else if (r.ids_.size()) {
+			sets.emplace_back(r.ids_.data(), r.ids_.size());
+		}
+	}
+	std::sort(sets.begin(), sets.end());
+	count = 0;
+	for (auto it = sets.begin(); it != sets.end(); ++it) {
+		if (it == sets.begin() || it->first != std::prev(it)->first) count += it->second;
+	}
+	return true;
+}
+
 int SelectIterator::Val() const {
 	if (type_ == UnbuiltSortOrdersIndex) {
 		return begin()->indexForwardIter_->Value();
@@ -292,7 +361,7 @@ int SelectIterator::Val() const {
 
 void SelectIterator::SetExpectMaxIterations(int expectedIterations) {
 	for (SingleSelectKeyResult &r : *this) {
-		if (!r.isRange_ && r.ids_.size() > 1) {
+		if (!r.isRange_ && !r.useBitmap_ && r.ids_.size() > 1) {
 			int itersloop = r.ids_.size();
 			int itersbsearch = int((std::log2(r.ids_.size()) - 1) * expectedIterations);
 			r.bsearch_ = itersbsearch < itersloop;
@@ -330,6 +399,7 @@ string SelectIterator::Dump() const {
 
 	for (auto &it : *this) {
 		if (it.useBtree_) ret += "btree;";
+		if (it.useBitmap_) ret += "bitmap;";
 		if (it.isRange_) ret += "range;";
 		if (it.bsearch_) ret += "bsearch;";
 		ret += ",";
@@ -4,6 +4,8 @@
 
 namespace reindexer {
 
+class NsItems;
+
 /// Allows to iterate over a result of selecting
 /// data for one certain key.
 class SelectIterator : public SelectKeyResult {
@@ -76,7 +78,7 @@ public:
 	/// Current rowId index since the beginning
 	/// of current SingleKeyValue object.
 	int Pos() const {
-		assertrx(!lastIt_->useBtree_ && (type_ != UnbuiltSortOrdersIndex));
+		assertrx(!lastIt_->useBtree_ && !lastIt_->useBitmap_ && (type_ != UnbuiltSortOrdersIndex));
 		return lastIt_->it_ - lastIt_->begin_ - 1;
 	}
 
@@ -87,16 +89,26 @@ public:
 	/// Uses each comparator to compare with pl.
 	/// @param pl - PayloadValue to be compared.
 	/// @param rowId - rowId.
-	inline bool TryCompare(const PayloadValue &pl, int rowId) {
+	/// @param jsonValues - values of the non-indexed fields of the row, which are shared by the conditions of the query.
+	inline bool TryCompare(const PayloadValue &pl, int rowId, JsonPathsValues &jsonValues) {
 		for (auto &cmp : comparators_)
-			if (cmp.Compare(pl, rowId)) {
+			if (cmp.Compare(pl, rowId, jsonValues)) {
 				matchedCount_++;
 				return true;
 			}
 		return false;
 	}
+	/// Block version of TryCompare: sets bit 'i' of 'mask' if items[ids[i]] matches any of comparators.
+	/// @param mask - output bitmask, must have room for (count + 63) / 64 words
+	void TryCompareBlock(const NsItems &items, const IdType *ids, size_t count, uint64_t *mask, JsonPathsValues &jsonValues);
 	/// @return amonut of matched items
 	int GetMatchedCount() const noexcept { return matchedCount_; }
+	/// Adds matches, which were counted by the copy of this iterator
+	void AddMatchedCount(int count) noexcept { matchedCount_ += count; }
+	/// Checks, if iterator is the single range of row ids without comparators (i.e. the full scan)
+	/// @param begin - first row id of the range
+	/// @param end - row id after the last one
+	bool IsSingleRange(IdType &begin, IdType &end) const noexcept;
 
 	/// Excludes last set of ids from each result
 	/// to remove duplicated keys
@@ -115,6 +127,18 @@ public:
 	/// cost goes before others.
 	double Cost(int expectedIterations) const;
 
+	/// Sets the estimation of the rows, which match the comparators, made by the index statistics
+	/// @param rows - estimated count of the matched rows
+	/// @param selectivity - estimated part of the namespace rows, which match the comparators
+	void SetComparatorsEstimation(int rows, double selectivity) noexcept {
+		estimatedMatched_ = rows;
+		comparatorsSelectivity_ = selectivity;
+	}
+	/// @return expected count of the matched rows or -1, if it is unknown
+	int EstimatedMatched() const noexcept { return comparators_.empty() ? int(GetMaxIterations()) : estimatedMatched_; }
+	/// @return estimated part of the namespace rows, which match the comparators, or -1, if it is unknown
+	double ComparatorsSelectivity() const noexcept { return comparatorsSelectivity_; }
+
 	/// Switches SingleSelectKeyResult to btree search
 	/// mode if it's more efficient than just comparing
 	/// each object in sequence.
@@ -122,10 +146,16 @@ public:
 
 	int Type() { return type_; }
 
+	/// Counts the rows of the iterator by the sizes of its idsets, without the iteration
+	/// @return false, if the rows can not be counted this way (i.e. the idsets may intersect or there are comparators)
+	bool CountByIdsets(size_t &count) const;
+
 	const char *TypeName() const;
 	string Dump() const;
 
 	bool distinct = false;
+	// Each row is contained by one of the idsets at most, i.e. the idsets are selected by the keys of the same non-array index
+	bool disjointIdsets = false;
 	string name;
 
 protected:
@@ -149,6 +179,8 @@ protected:
 	iterator lastIt_ = nullptr;
 	IdType end_ = 0;
 	int matchedCount_ = 0;
+	int estimatedMatched_ = -1;
+	double comparatorsSelectivity_ = -1.0;
 };
 
 }  // namespace reindexer
@@ -1,6 +1,7 @@
 #include "selectiteratorcontainer.h"
 #include <sstream>
 #include "core/index/index.h"
+#include "core/index/indexstats.h"
 #include "core/namespace/namespaceimpl.h"
 #include "core/nsselecter/nsselecter.h"
 #include "core/rdxcontext.h"
@@ -185,12 +186,19 @@ void SelectIteratorContainer::SetExpectMaxIterations(int expectedIterations) {
 	}
 }
 
-SelectKeyResults SelectIteratorContainer::processQueryEntry(const QueryEntry &qe, const NamespaceImpl &ns, StrictMode strictMode) {
+SelectKeyResults SelectIteratorContainer::processQueryEntry(const QueryEntry &qe, bool isQueryFt, const NamespaceImpl &ns,
+															StrictMode strictMode) {
 	SelectKeyResults selectResults;
 
 	FieldsSet fields;
 	TagsPath tagsPath = ns.tagsMatcher_.path2tag(qe.index);
-	if (!tagsPath.empty()) {
+	// Ids of the paths index are not ordered by the sort index, so it is used only when the indexes would not be forced to comparators
+	const bool usePathsIndex =
+		!tagsPath.empty() && !qe.distinct && !isQueryFt && !(ctx_ && ctx_->sortingContext.isOptimizationEnabled());
+	SelectKeyResult pathsIndexResult;
+	if (usePathsIndex && ns.pathsIndex_.Select(tagsPath, qe.condition, qe.values, pathsIndexResult)) {
+		selectResults.emplace_back(std::move(pathsIndexResult));
+	} else if (!tagsPath.empty()) {
 		SelectKeyResult comparisonResult;
 		fields.push_back(tagsPath);
 		comparisonResult.comparators_.emplace_back(qe.condition, KeyValueUndefined, qe.values, false, qe.distinct, ns.payloadType_, fields,
@@ -240,10 +248,20 @@ void SelectIteratorContainer::processField(FieldsComparator &fc, std::string_vie
 	}
 }
 
+unsigned SelectIteratorContainer::fulltextTopK() const noexcept {
+	if (!ctx_ || ctx_->parentQuery || ctx_->preResult || ctx_->inTransaction || ctx_->reqMatchedOnceFlag) return 0;
+	const Query &q = ctx_->query;
+	if (q.count == UINT_MAX || q.start >= UINT_MAX - q.count || q.calcTotal != ModeNoTotal || !q.sortingEntries_.empty() ||
+		!q.aggregations_.empty() || !q.joinQueries_.empty() || !q.mergeQueries_.empty()) {
+		return 0;
+	}
+	return q.start + q.count;
+}
+
 SelectKeyResults SelectIteratorContainer::processQueryEntry(const QueryEntry &qe, bool enableSortIndexOptimize, const NamespaceImpl &ns,
-															unsigned sortId, bool isQueryFt, SelectFunction::Ptr &selectFnc,
-															bool &isIndexFt, bool &isIndexSparse, FtCtx::Ptr &ftCtx,
-															const RdxContext &rdxCtx) {
+															unsigned sortId, bool isQueryFt, unsigned ftTopK,
+															SelectFunction::Ptr &selectFnc, bool &isIndexFt, bool &isIndexSparse,
+															FtCtx::Ptr &ftCtx, const RdxContext &rdxCtx) {
 	auto &index = ns.indexes_[qe.idxNo];
 	isIndexFt = IsFullText(index->Type());
 	isIndexSparse = index->Opts().IsSparse();
@@ -267,6 +285,7 @@ SelectKeyResults SelectIteratorContainer::processQueryEntry(const QueryEntry &qe
 	opts.maxIterations = GetMaxIterations();
 	opts.indexesNotOptimized = !ctx_->sortingContext.enableSortOrders;
 	opts.inTransaction = ctx_->inTransaction;
+	if (isIndexFt) opts.ftTopK = ftTopK;
 
 	auto ctx = selectFnc ? selectFnc->CreateCtx(qe.idxNo) : BaseFunctionCtx::Ptr{};
 	if (ctx && ctx->type == BaseFunctionCtx::kFtCtx) ftCtx = reindexer::reinterpret_pointer_cast<FtCtx>(ctx);
@@ -310,6 +329,9 @@ void SelectIteratorContainer::processQueryEntryResults(SelectKeyResults &selectR
 						it.AppendAndBind(res, ns.payloadType_, qe.idxNo);
 					}
 					it.name += " or " + qe.index;
+					it.disjointIdsets = false;
+					// Estimation of the single condition is not valid for the merged one
+					it.SetComparatorsEstimation(-1, -1.0);
 					break;
 				}
 			}
@@ -317,6 +339,9 @@ void SelectIteratorContainer::processQueryEntryResults(SelectKeyResults &selectR
 			case OpNot:
 			case OpAnd:
 				Append(op, SelectIterator(res, qe.distinct, qe.index, isIndexFt));
+				if (!nonIndexField && !isIndexFt && !ns.indexes_[qe.idxNo]->Opts().IsArray()) {
+					lastAppendedOrClosed()->Value<SelectIterator>().disjointIdsets = true;
+				}
 				if (!nonIndexField && !isIndexSparse) {
 					// last appended is always a SelectIterator
 					const auto lastAppendedIt = lastAppendedOrClosed();
@@ -329,6 +354,8 @@ void SelectIteratorContainer::processQueryEntryResults(SelectKeyResults &selectR
 					if (lastAppended.comparators_.empty()) {
 						if (cur && cur < maxIterations_) maxIterations_ = cur;
 						if (!cur) wasZeroIterations_ = true;
+					} else {
+						estimateComparators(lastAppended, ns, qe);
 					}
 				}
 				break;
@@ -342,6 +369,15 @@ void SelectIteratorContainer::processQueryEntryResults(SelectKeyResults &selectR
 	}
 }
 
+void SelectIteratorContainer::estimateComparators(SelectIterator &it, const NamespaceImpl &ns, const QueryEntry &qe) {
+	const auto stats = ns.indexes_[qe.idxNo]->Stats();
+	if (!stats) return;
+	const double selectivity = stats->Selectivity(qe.condition, qe.values);
+	if (selectivity < 0.0) return;
+	const size_t itemsCount = ns.items_.size() - ns.free_.size();
+	it.SetComparatorsEstimation(int(selectivity * itemsCount), selectivity);
+}
+
 void SelectIteratorContainer::processEqualPositions(const std::vector<EqualPositions> &equalPositions, const NamespaceImpl &ns,
 													const QueryEntries &queries) {
 	for (const auto &eqPos : equalPositions) {
@@ -475,12 +511,15 @@ void SelectIteratorContainer::prepareIteratorsForSelectLoop(const QueryEntries &
 							strictMode = ctx_->query.strictMode;
 						}
 					}
-					selectResults = processQueryEntry(qe, ns, strictMode);
+					selectResults = processQueryEntry(qe, isQueryFt, ns, strictMode);
 				} else {
 					const bool enableSortIndexOptimize = !sortIndexCreated && (op == OpAnd) && !qe.distinct && (begin == 0) &&
 														 (ctx_->sortingContext.uncommitedIndex == qe.idxNo) &&
 														 (next == end || queries.GetOperation(next) != OpOr);
-					selectResults = processQueryEntry(qe, enableSortIndexOptimize, ns, sortId, isQueryFt, selectFnc, isIndexFt,
+					// Fulltext results are limited only if the fulltext condition is the single condition of the query
+					const unsigned ftTopK =
+						(begin == 0 && end == queries.Size() && next == end && op == OpAnd && !qe.distinct) ? fulltextTopK() : 0;
+					selectResults = processQueryEntry(qe, enableSortIndexOptimize, ns, sortId, isQueryFt, ftTopK, selectFnc, isIndexFt,
 													  isIndexSparse, ftCtx, rdxCtx);
 					if (enableSortIndexOptimize) sortIndexCreated = true;
 				}
@@ -511,9 +550,9 @@ void SelectIteratorContainer::prepareIteratorsForSelectLoop(const QueryEntries &
 }
 
 template <bool reverse, bool hasComparators>
-bool SelectIteratorContainer::checkIfSatisfyCondition(SelectIterator &it, PayloadValue &pv, bool *finish, IdType rowId,
+bool SelectIteratorContainer::checkIfSatisfyCondition(SelectIterator &it, const PayloadValue &pv, bool *finish, IdType rowId,
 													  IdType properRowId) {
-	if (!hasComparators || !it.TryCompare(pv, properRowId)) {
+	if (!hasComparators || !it.TryCompare(pv, properRowId, jsonValues_)) {
 		while (((reverse && it.Val() > rowId) || (!reverse && it.Val() < rowId)) && it.Next(rowId)) {
 		}
 		if (it.End()) {
@@ -526,7 +565,7 @@ bool SelectIteratorContainer::checkIfSatisfyCondition(SelectIterator &it, Payloa
 	return true;
 }
 
-bool SelectIteratorContainer::checkIfSatisfyCondition(JoinSelectIterator &it, PayloadValue &pv, IdType properRowId, bool match) {
+bool SelectIteratorContainer::checkIfSatisfyCondition(JoinSelectIterator &it, const PayloadValue &pv, IdType properRowId, bool match) {
 	assertrx(ctx_->joinedSelectors);
 	ConstPayload pl(*pt_, pv);
 	auto &joinedSelector = (*ctx_->joinedSelectors)[it.joinIndex];
@@ -534,7 +573,7 @@ bool SelectIteratorContainer::checkIfSatisfyCondition(JoinSelectIterator &it, Pa
 }
 
 template <bool reverse, bool hasComparators>
-bool SelectIteratorContainer::checkIfSatisfyAllConditions(iterator begin, iterator end, PayloadValue &pv, bool *finish, IdType rowId,
+bool SelectIteratorContainer::checkIfSatisfyAllConditions(iterator begin, iterator end, const PayloadValue &pv, bool *finish, IdType rowId,
 														  IdType properRowId, bool match) {
 	bool result = true;
 	bool currentFinish = false;
@@ -615,7 +654,7 @@ IdType SelectIteratorContainer::getNextItemId(const_iterator begin, const_iterat
 }
 
 template <bool reverse, bool hasComparators>
-bool SelectIteratorContainer::Process(PayloadValue &pv, bool *finish, IdType *rowId, IdType properRowId, bool match) {
+bool SelectIteratorContainer::Process(const PayloadValue &pv, bool *finish, IdType *rowId, IdType properRowId, bool match) {
 	auto it = begin();
 	if (checkIfSatisfyAllConditions<reverse, hasComparators>(++it, end(), pv, finish, *rowId, properRowId, match)) {
 		return true;
@@ -625,10 +664,137 @@ bool SelectIteratorContainer::Process(PayloadValue &pv, bool *finish, IdType *ro
 	}
 }
 
-template bool SelectIteratorContainer::Process<false, false>(PayloadValue &, bool *, IdType *, IdType, bool);
-template bool SelectIteratorContainer::Process<false, true>(PayloadValue &, bool *, IdType *, IdType, bool);
-template bool SelectIteratorContainer::Process<true, false>(PayloadValue &, bool *, IdType *, IdType, bool);
-template bool SelectIteratorContainer::Process<true, true>(PayloadValue &, bool *, IdType *, IdType, bool);
+bool SelectIteratorContainer::IsBatchFilterable() const {
+	if (Size() < 2) return false;
+	auto it = cbegin();
+	for (++it; it != cend(); ++it) {
+		if (it->operation == OpOr) return false;
+		const bool filterable = it->InvokeAppropriate<bool>(
+			[](const SelectIteratorsBracket &) { return false; },
+			[](const SelectIterator &sit) { return sit.empty() && !sit.comparators_.empty() && !sit.distinct; },
+			[](const JoinSelectIterator &) { return false; }, [](const FieldsComparator &) { return true; },
+			[](const AlwaysFalse &) { return false; });
+		if (!filterable) return false;
+	}
+	return true;
+}
+
+size_t SelectIteratorContainer::FilterBatch(IdType *ids, size_t count, const NsItems &items) {
+	if (filterOrder_.size() + 1 != container_.size()) {
+		filterOrder_.clear();
+		for (unsigned i = 1; i < container_.size(); ++i) filterOrder_.push_back(i);
+		filterStats_.clear();
+		filterStats_.resize(container_.size());
+		filterCandidates_ = 0;
+	}
+	filterCandidates_ += count;
+	if (jsonPathsConditions_ > 1) {
+		count = filterBatchByRows(ids, count, items);
+		if (filterCandidates_ >= kFilterReorderPeriod) reorderFilters();
+		return count;
+	}
+	h_vector<uint64_t, 16> mask((count + 63) / 64);
+	for (auto pos = filterOrder_.begin(); pos != filterOrder_.end() && count; ++pos) {
+		auto &node = container_[*pos];
+		const bool isNot = (node.operation == OpNot);
+		size_t passed = 0;
+		// One tight loop per condition: the same comparator is applied to the whole block
+		node.InvokeAppropriate<void>(
+			[&](SelectIterator &sit) {
+				sit.TryCompareBlock(items, ids, count, mask.data(), jsonValues_);
+				for (size_t i = 0; i < count; ++i) {
+					ids[passed] = ids[i];
+					passed += (bool((mask[i >> 6] >> (i & 63)) & 1) != isNot);
+				}
+			},
+			[&](FieldsComparator &fc) {
+				for (size_t i = 0; i < count; ++i) {
+					const IdType rowId = ids[i];
+					ids[passed] = rowId;
+					passed += (fc.Compare(items[rowId]) != isNot);
+				}
+			},
+			[](SelectIteratorsBracket &) { assertrx(0); }, [](JoinSelectIterator &) { assertrx(0); }, [](AlwaysFalse &) { assertrx(0); });
+		filterStats_[*pos].checked += count;
+		filterStats_[*pos].passed += passed;
+		count = passed;
+	}
+	if (filterCandidates_ >= kFilterReorderPeriod) reorderFilters();
+	return count;
+}
+
+size_t SelectIteratorContainer::filterBatchByRows(IdType *ids, size_t count, const NsItems &items) {
+	// Conditions on the several non-indexed fields are checked row by row, so the tuple of row is decoded once for all of them
+	size_t passed = 0;
+	for (size_t i = 0; i < count; ++i) {
+		const IdType rowId = ids[i];
+		const PayloadValue &pv = items[rowId];
+		bool match = true;
+		for (unsigned pos : filterOrder_) {
+			auto &node = container_[pos];
+			const bool res = node.InvokeAppropriate<bool>(
+				[&](SelectIterator &sit) { return sit.TryCompare(pv, rowId, jsonValues_); },
+				[&pv](FieldsComparator &fc) { return fc.Compare(pv); }, [](SelectIteratorsBracket &) -> bool { abort(); }, [](JoinSelectIterator &) -> bool { abort(); },
+				[](AlwaysFalse &) -> bool { abort(); });
+			++filterStats_[pos].checked;
+			if (res == (node.operation == OpNot)) {
+				match = false;
+				break;
+			}
+			++filterStats_[pos].passed;
+		}
+		ids[passed] = rowId;
+		passed += match;
+	}
+	return passed;
+}
+
+void SelectIteratorContainer::registerJsonPaths() {
+	jsonValues_.Clear();
+	jsonPathsConditions_ = 0;
+	ExecuteAppropriateForEach(Skip<SelectIteratorsBracket, JoinSelectIterator, FieldsComparator, AlwaysFalse>{},
+							  [this](const SelectIterator &sit) {
+								  bool hasJsonPaths = false;
+								  for (const Comparator &cmp : sit.comparators_) {
+									  if (const TagsPath *path = cmp.JsonPath()) {
+										  jsonValues_.Register(*path);
+										  hasJsonPaths = true;
+									  }
+								  }
+								  jsonPathsConditions_ += hasJsonPaths;
+							  });
+}
+
+void SelectIteratorContainer::reorderFilters() {
+	const auto passRate = [this](unsigned pos) {
+		const FilterStat &stat = filterStats_[pos];
+		// Conditions, which were not reached, keep their place after the ones, which rejected all of the candidates
+		return stat.checked ? double(stat.passed) / stat.checked : 1.0;
+	};
+	std::stable_sort(filterOrder_.begin(), filterOrder_.end(), [&](unsigned lhs, unsigned rhs) { return passRate(lhs) < passRate(rhs); });
+	// Older observations lose their weight, so the order follows the changes of data along the scan
+	for (auto &stat : filterStats_) {
+		stat.checked /= 2;
+		stat.passed /= 2;
+	}
+	filterCandidates_ = 0;
+}
+
+void SelectIteratorContainer::MergeMatchedCounts(const SelectIteratorContainer &other) {
+	assertrx(Size() == other.Size());
+	auto oit = other.cbegin();
+	for (auto it = begin(); it != end(); ++it, ++oit) {
+		it->InvokeAppropriate<void>(
+			[&oit](SelectIterator &sit) { sit.AddMatchedCount(oit->Value<SelectIterator>().GetMatchedCount()); },
+			[&oit](FieldsComparator &fc) { fc.AddMatchedCount(oit->Value<FieldsComparator>().GetMatchedCount()); },
+			[](SelectIteratorsBracket &) { assertrx(0); }, [](JoinSelectIterator &) { assertrx(0); }, [](AlwaysFalse &) {});
+	}
+}
+
+template bool SelectIteratorContainer::Process<false, false>(const PayloadValue &, bool *, IdType *, IdType, bool);
+template bool SelectIteratorContainer::Process<false, true>(const PayloadValue &, bool *, IdType *, IdType, bool);
+template bool SelectIteratorContainer::Process<true, false>(const PayloadValue &, bool *, IdType *, IdType, bool);
+template bool SelectIteratorContainer::Process<true, true>(const PayloadValue &, bool *, IdType *, IdType, bool);
 
 std::string SelectIteratorContainer::Dump() const {
 	WrSerializer ser;
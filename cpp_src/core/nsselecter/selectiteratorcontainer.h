@@ -43,9 +43,24 @@ public:
 	void PrepareIteratorsForSelectLoop(const QueryEntries &queries, unsigned sortId, bool isFt, const NamespaceImpl &ns,
 									   SelectFunction::Ptr &selectFnc, FtCtx::Ptr &ftCtx, const RdxContext &rdxCtx) {
 		prepareIteratorsForSelectLoop(queries, 0, queries.Size(), sortId, isFt, ns, selectFnc, ftCtx, rdxCtx);
+		registerJsonPaths();
 	}
 	template <bool reverse, bool hasComparators>
-	bool Process(PayloadValue &, bool *finish, IdType *rowId, IdType, bool match);
+	bool Process(const PayloadValue &, bool *finish, IdType *rowId, IdType, bool match);
+	/// Checks, if all the conditions after the first one are plain row filters (comparators joined by AND/NOT),
+	/// so candidates, produced by the first iterator, may be filtered by blocks
+	bool IsBatchFilterable() const;
+	/// Filters block of candidates by each condition in turn.
+	/// Survived row ids are compacted to the beginning of the block in the initial order.
+	/// Conditions are reordered periodically by the observed pass rates, so the most selective of them are checked first
+	/// even if the initial order was chosen badly
+	/// @param ids - block of candidate row ids
+	/// @param count - size of block
+	/// @param items - namespace's rows
+	/// @return count of survived row ids
+	size_t FilterBatch(IdType *ids, size_t count, const NsItems &items);
+	/// Adds matched counters of the conditions from the copy of this container, which was used for filtering of the part of rows
+	void MergeMatchedCounts(const SelectIteratorContainer &other);
 
 	bool IsSelectIterator(size_t i) const noexcept {
 		assertrx(i < Size());
@@ -58,9 +73,15 @@ public:
 	void ExplainJSON(int iters, JsonBuilder &builder, const vector<JoinedSelector> *js) const {
 		explainJSON(cbegin(), cend(), iters, builder, js);
 	}
+	uint64_t PlanFingerprint(const vector<JoinedSelector> *js) const { return planFingerprint(cbegin(), cend(), js); }
 
 	void Clear() {
 		clear();
+		jsonValues_.Clear();
+		jsonPathsConditions_ = 0;
+		filterOrder_.clear();
+		filterStats_.clear();
+		filterCandidates_ = 0;
 		maxIterations_ = std::numeric_limits<int>::max();
 		wasZeroIterations_ = false;
 	}
@@ -78,12 +99,13 @@ private:
 	// Check idset must be 1st
 	static void checkFirstQuery(Container &);
 	template <bool reverse, bool hasComparators>
-	bool checkIfSatisfyCondition(SelectIterator &, PayloadValue &, bool *finish, IdType rowId, IdType properRowId);
-	bool checkIfSatisfyCondition(JoinSelectIterator &, PayloadValue &, IdType properRowId, bool match);
+	bool checkIfSatisfyCondition(SelectIterator &, const PayloadValue &, bool *finish, IdType rowId, IdType properRowId);
+	bool checkIfSatisfyCondition(JoinSelectIterator &, const PayloadValue &, IdType properRowId, bool match);
 	template <bool reverse, bool hasComparators>
-	bool checkIfSatisfyAllConditions(iterator begin, iterator end, PayloadValue &, bool *finish, IdType rowId, IdType properRowId,
+	bool checkIfSatisfyAllConditions(iterator begin, iterator end, const PayloadValue &, bool *finish, IdType rowId, IdType properRowId,
 									 bool match);
 	static std::string explainJSON(const_iterator it, const_iterator to, int iters, JsonBuilder &builder, const vector<JoinedSelector> *);
+	static uint64_t planFingerprint(const_iterator it, const_iterator to, const vector<JoinedSelector> *);
 	template <bool reverse>
 	static IdType next(const_iterator, IdType from);
 	template <bool reverse>
@@ -91,16 +113,23 @@ private:
 	static bool isIdset(const_iterator it, const_iterator end);
 	static bool markBracketsHavingJoins(iterator begin, iterator end) noexcept;
 	bool haveJoins(size_t i) const noexcept;
+	void reorderFilters();
+	void registerJsonPaths();
+	size_t filterBatchByRows(IdType *ids, size_t count, const NsItems &items);
 
-	SelectKeyResults processQueryEntry(const QueryEntry &qe, const NamespaceImpl &ns, StrictMode strictMode);
+	SelectKeyResults processQueryEntry(const QueryEntry &qe, bool isQueryFt, const NamespaceImpl &ns, StrictMode strictMode);
 	SelectKeyResults processQueryEntry(const QueryEntry &qe, bool enableSortIndexOptimize, const NamespaceImpl &ns, unsigned sortId,
-									   bool isQueryFt, SelectFunction::Ptr &selectFnc, bool &isIndexFt, bool &isIndexSparse, FtCtx::Ptr &,
-									   const RdxContext &);
+									   bool isQueryFt, unsigned ftTopK, SelectFunction::Ptr &selectFnc, bool &isIndexFt,
+									   bool &isIndexSparse, FtCtx::Ptr &, const RdxContext &);
+	/// @return count of the best ranked fulltext results, which are enough for the query with single fulltext condition
+	/// (0 - if the results are filtered or reordered after the fulltext index)
+	unsigned fulltextTopK() const noexcept;
 	template <bool left>
 	void processField(FieldsComparator &, std::string_view field, int idxNo, const NamespaceImpl &ns) const;
 	void processJoinEntry(const JoinQueryEntry &, OpType);
 	void processQueryEntryResults(SelectKeyResults &selectResults, OpType, const NamespaceImpl &ns, const QueryEntry &qe, bool isIndexFt,
 								  bool isIndexSparse, bool nonIndexField);
+	static void estimateComparators(SelectIterator &, const NamespaceImpl &, const QueryEntry &);
 	struct EqualPositions {
 		h_vector<size_t, 4> queryEntriesPositions;
 		size_t positionToInsertIterator = 0;
@@ -124,6 +153,22 @@ private:
 	SelectCtx *ctx_;
 	int maxIterations_;
 	bool wasZeroIterations_;
+
+	struct FilterStat {
+		uint64_t checked = 0;
+		uint64_t passed = 0;
+	};
+	// Count of the filtered candidates, after which the order of the batch filters is revised
+	static constexpr size_t kFilterReorderPeriod = 8 * 1024;
+	// Order, in which FilterBatch checks the conditions
+	h_vector<unsigned, 8> filterOrder_;
+	// Observed pass rates of the conditions since the last revision of order (indexed by the position of condition)
+	h_vector<FilterStat, 8> filterStats_;
+	size_t filterCandidates_ = 0;
+	// Values of the non-indexed fields, which are compared by the conditions, are extracted once per row for all of them
+	JsonPathsValues jsonValues_;
+	// Count of the conditions, which compare the values of the non-indexed fields
+	unsigned jsonPathsConditions_ = 0;
 };
 
 }  // namespace reindexer
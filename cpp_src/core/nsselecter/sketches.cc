@@ -0,0 +1,123 @@
+#include "sketches.h"
+#include <algorithm>
+#include <cmath>
+
+namespace reindexer {
+
+// Count of values, which are buffered before they are merged into centroids
+constexpr size_t kTDigestBufferSize = 5 * size_t(TDigest::kCompression);
+
+static uint64_t mixHash(uint64_t h) noexcept {
+	// Finalizer of MurmurHash3: every bit of input affects every bit of output
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+void HyperLogLog::Add(uint64_t hash) noexcept {
+	const uint64_t h = mixHash(hash);
+	const size_t idx = h >> (64 - kPrecision);
+	// Guard bit limits the rank, if all of the remaining bits are zeroes
+	const uint64_t rest = (h << kPrecision) | (uint64_t(1) << (kPrecision - 1));
+	const uint8_t rank = __builtin_clzll(rest) + 1;
+	if (registers_[idx] < rank) registers_[idx] = rank;
+}
+
+void HyperLogLog::Merge(const HyperLogLog &other) noexcept {
+	for (size_t i = 0; i < registers_.size(); ++i) registers_[i] = std::max(registers_[i], other.registers_[i]);
+}
+
+double HyperLogLog::Estimate() const noexcept {
+	const double m = registers_.size();
+	double sum = 0.0;
+	size_t zeroes = 0;
+	for (uint8_t r : registers_) {
+		sum += std::ldexp(1.0, -int(r));
+		zeroes += (r == 0);
+	}
+	const double alpha = 0.7213 / (1.0 + 1.079 / m);
+	const double estimate = alpha * m * m / sum;
+	// Linear counting is more precise for the small cardinalities
+	if (estimate <= 2.5 * m && zeroes) return m * std::log(m / zeroes);
+	return estimate;
+}
+
+void TDigest::Add(double value) {
+	if (Empty()) {
+		min_ = max_ = value;
+	} else {
+		min_ = std::min(min_, value);
+		max_ = std::max(max_, value);
+	}
+	buffered_.push_back({value, 1.0});
+	if (buffered_.size() >= kTDigestBufferSize) compress();
+}
+
+void TDigest::Merge(const TDigest &other) {
+	if (other.Empty()) return;
+	if (Empty()) {
+		min_ = other.min_;
+		max_ = other.max_;
+	} else {
+		min_ = std::min(min_, other.min_);
+		max_ = std::max(max_, other.max_);
+	}
+	buffered_.insert(buffered_.end(), other.centroids_.begin(), other.centroids_.end());
+	buffered_.insert(buffered_.end(), other.buffered_.begin(), other.buffered_.end());
+	compress();
+}
+
+void TDigest::compress() const {
+	if (buffered_.empty()) return;
+	buffered_.insert(buffered_.end(), centroids_.begin(), centroids_.end());
+	std::sort(buffered_.begin(), buffered_.end(), [](const Centroid &lhs, const Centroid &rhs) { return lhs.mean < rhs.mean; });
+	total_ = 0;
+	for (const auto &c : buffered_) total_ += c.weight;
+
+	centroids_.clear();
+	Centroid cur = buffered_.front();
+	double weightBefore = 0;
+	for (auto it = buffered_.begin() + 1; it != buffered_.end(); ++it) {
+		const double merged = cur.weight + it->weight;
+		const double q = (weightBefore + merged / 2) / total_;
+		// Centroids near the tails are kept small, so the extreme quantiles are precise
+		const double maxWeight = 4.0 * total_ * q * (1.0 - q) / kCompression;
+		if (merged <= std::max(1.0, maxWeight)) {
+			cur.mean += (it->mean - cur.mean) * it->weight / merged;
+			cur.weight = merged;
+		} else {
+			weightBefore += cur.weight;
+			centroids_.push_back(cur);
+			cur = *it;
+		}
+	}
+	centroids_.push_back(cur);
+	buffered_.clear();
+}
+
+double TDigest::Quantile(double q) const {
+	compress();
+	if (centroids_.empty()) return 0.0;
+	if (centroids_.size() == 1) return centroids_.front().mean;
+	const double target = std::clamp(q, 0.0, 1.0) * total_;
+	// Each centroid is considered to be centered at the middle of its weight
+	double center = centroids_.front().weight / 2;
+	if (target <= center) {
+		return min_ + (centroids_.front().mean - min_) * (center > 0 ? target / center : 0.0);
+	}
+	for (size_t i = 1; i < centroids_.size(); ++i) {
+		const double nextCenter = center + (centroids_[i - 1].weight + centroids_[i].weight) / 2;
+		if (target <= nextCenter) {
+			const double part = (target - center) / (nextCenter - center);
+			return centroids_[i - 1].mean + (centroids_[i].mean - centroids_[i - 1].mean) * part;
+		}
+		center = nextCenter;
+	}
+	const double tail = total_ - center;
+	return centroids_.back().mean + (max_ - centroids_.back().mean) * (tail > 0 ? (target - center) / tail : 1.0);
+}
+
+}  // namespace reindexer
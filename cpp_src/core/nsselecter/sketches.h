@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace reindexer {
+
+/// Approximate count of distinct values in fixed memory (2^kPrecision one byte registers).
+/// Relative standard error is about 1.04 / sqrt(2^kPrecision), i.e. 0.8%
+class HyperLogLog {
+public:
+	static constexpr unsigned kPrecision = 14;
+
+	HyperLogLog() : registers_(size_t(1) << kPrecision, 0) {}
+
+	/// @param hash - hash of the value. It is mixed again, so the weak hashes of the integers are acceptable
+	void Add(uint64_t hash) noexcept;
+	/// Merges the sketch of the other part of values
+	void Merge(const HyperLogLog &other) noexcept;
+	double Estimate() const noexcept;
+
+private:
+	std::vector<uint8_t> registers_;
+};
+
+/// Approximate quantiles of the stream of values (merging t-digest). Memory is bounded by the compression parameter,
+/// precision is the best near the tails of distribution (p95, p99)
+class TDigest {
+public:
+	static constexpr double kCompression = 100.0;
+
+	void Add(double value);
+	/// Merges the digest of the other part of values
+	void Merge(const TDigest &other);
+	/// @param q - quantile in [0, 1]
+	/// @return approximate value of quantile or 0 if digest is empty
+	double Quantile(double q) const;
+	bool Empty() const noexcept { return centroids_.empty() && buffered_.empty(); }
+
+private:
+	struct Centroid {
+		double mean;
+		double weight;
+	};
+	// Merges buffered values into centroids. Called lazily, so the digest is logically const
+	void compress() const;
+
+	mutable std::vector<Centroid> centroids_;
+	mutable std::vector<Centroid> buffered_;
+	mutable double total_ = 0;
+	double min_ = 0;
+	double max_ = 0;
+};
+
+}  // namespace reindexer
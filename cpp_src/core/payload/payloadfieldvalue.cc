@@ -83,4 +83,26 @@ bool PayloadFieldValue::IsEQ(const PayloadFieldValue &o) const {
 			abort();
 	}
 }
+
+int PayloadFieldValue::Compare(const PayloadFieldValue &o, const CollateOpts &collateOpts) const {
+	auto cmp = [this, &o](auto tag) {
+		using T = decltype(tag);
+		const T lhs = *reinterpret_cast<const T *>(p_), rhs = *reinterpret_cast<const T *>(o.p_);
+		return (lhs == rhs) ? 0 : (lhs > rhs) ? 1 : -1;
+	};
+	switch (t_.Type()) {
+		case KeyValueBool:
+			return cmp(bool());
+		case KeyValueInt:
+			return cmp(int());
+		case KeyValueInt64:
+			return cmp(int64_t());
+		case KeyValueDouble:
+			return cmp(double());
+		case KeyValueString:
+			return collateCompare(*reinterpret_cast<const p_string *>(p_), *reinterpret_cast<const p_string *>(o.p_), collateOpts);
+		default:
+			abort();
+	}
+}
 }  // namespace reindexer
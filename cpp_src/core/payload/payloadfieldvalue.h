@@ -19,6 +19,8 @@ public:
 	Variant Get(bool enableHold = false) const;
 	size_t Hash() const;
 	bool IsEQ(const PayloadFieldValue &o) const;
+	// Compares the values of the same type the same way, as their Variants are compared
+	int Compare(const PayloadFieldValue &o, const CollateOpts &collateOpts) const;
 
 	// Type of value, not owning
 	const PayloadFieldType &t_;
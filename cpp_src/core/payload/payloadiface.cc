@@ -4,6 +4,7 @@
 #include "core/cjson/cjsondecoder.h"
 #include "core/keyvalue/p_string.h"
 #include "core/keyvalue/variant.h"
+#include "core/namespace/coldtuples.h"
 #include "core/namespace/stringsholder.h"
 #include "itoa/itoa.h"
 #include "payloadiface.h"
@@ -342,6 +343,11 @@ uint64_t PayloadIface<T>::GetHash() const {
 			for (int i = 0; i < arr->len; i++, p += f.ElemSizeof()) {
 				ret ^= PayloadFieldValue(f, p).Hash();
 			}
+		} else if (field == 0 && t_.GetColdTuples()) {
+			// Hash of the item must not depend on the eviction of its tuple
+			key_string coldTuple;
+			const std::string_view tuple = ColdTuples::Resolve(t_, std::string_view(Field(0).Get()), coldTuple);
+			ret ^= std::hash<p_string>()(p_string(&tuple));
 		} else
 			ret ^= Field(field).Hash();
 	}
@@ -355,21 +361,7 @@ bool PayloadIface<T>::IsEQ(const T &other, const FieldsSet &fields) const {
 	VariantArray keys1, keys2;
 	for (auto field : fields) {
 		if (field != IndexValueType::SetByJsonPath) {
-			auto &f = t_.Field(field);
-			if (f.IsArray()) {
-				auto *arr1 = reinterpret_cast<PayloadFieldValue::Array *>(Field(field).p_);
-				auto *arr2 = reinterpret_cast<PayloadFieldValue::Array *>(o.Field(field).p_);
-				if (arr1->len != arr2->len) return false;
-
-				uint8_t *p1 = v_->Ptr() + arr1->offset;
-				uint8_t *p2 = o.v_->Ptr() + arr2->offset;
-
-				for (int i = 0; i < arr1->len; i++, p1 += f.ElemSizeof(), p2 += f.ElemSizeof()) {
-					if (!PayloadFieldValue(f, p1).IsEQ(PayloadFieldValue(f, p2))) return false;
-				}
-			} else {
-				if (!Field(field).IsEQ(o.Field(field))) return false;
-			}
+			if (!IsFieldEQ(other, field)) return false;
 		} else {
 			const TagsPath &tagsPath = fields.getTagsPath(tagPathIdx++);
 			if (GetByJsonPath(tagsPath, keys1, KeyValueUndefined) != o.GetByJsonPath(tagsPath, keys2, KeyValueUndefined)) return false;
@@ -378,6 +370,25 @@ bool PayloadIface<T>::IsEQ(const T &other, const FieldsSet &fields) const {
 	return true;
 }
 
+template <typename T>
+bool PayloadIface<T>::IsFieldEQ(const T &other, int field) const {
+	PayloadIface<const T> o(t_, other);
+	auto &f = t_.Field(field);
+	if (!f.IsArray()) return Field(field).IsEQ(o.Field(field));
+
+	auto *arr1 = reinterpret_cast<PayloadFieldValue::Array *>(Field(field).p_);
+	auto *arr2 = reinterpret_cast<PayloadFieldValue::Array *>(o.Field(field).p_);
+	if (arr1->len != arr2->len) return false;
+
+	uint8_t *p1 = v_->Ptr() + arr1->offset;
+	uint8_t *p2 = o.v_->Ptr() + arr2->offset;
+
+	for (int i = 0; i < arr1->len; i++, p1 += f.ElemSizeof(), p2 += f.ElemSizeof()) {
+		if (!PayloadFieldValue(f, p1).IsEQ(PayloadFieldValue(f, p2))) return false;
+	}
+	return true;
+}
+
 template <typename T>
 int PayloadIface<T>::Compare(const T &other, const FieldsSet &fields, size_t &firstDifferentFieldIdx,
 							 const h_vector<const CollateOpts *, 1> &collateOpts) const {
@@ -392,7 +403,7 @@ int PayloadIface<T>::Compare(const T &other, const FieldsSet &fields, size_t &fi
 		const auto field(fields[i]);
 		const CollateOpts *opts(commonOpts ? collateOpts[0] : collateOpts[i]);
 		if (field != IndexValueType::SetByJsonPath) {
-			cmpRes = Field(field).Get().Compare(o.Field(field).Get(), opts ? *opts : CollateOpts());
+			cmpRes = Field(field).Compare(o.Field(field), opts ? *opts : CollateOpts());
 		} else {
 			assertrx(tagPathIdx < fields.getTagsPathsLength());
 			const TagsPath &tagsPath = fields.getTagsPath(tagPathIdx++);
@@ -3,6 +3,7 @@
 #include <type_traits>
 #include "core/cjson/tagsmatcher.h"
 #include "core/indexopts.h"
+#include "core/keyvalue/p_string.h"
 #include "core/keyvalue/variant.h"
 #include "estl/span.h"
 #include "fieldsset.h"
@@ -39,6 +40,35 @@ public:
 		auto *arr = reinterpret_cast<PayloadFieldValue::Array *>(Field(field).p_);
 		return span<Elem>(reinterpret_cast<Elem *>(v_->Ptr() + arr->offset), arr->len);
 	}
+	// Get element(s) of the field as span of typed values without the conversion to the Variants. Value of the non-array field is
+	// returned as the span of single element. Elem has to match the type of the field (bool, int, int64_t, double or p_string).
+	// Values must not be modified through the span
+	template <typename Elem>
+	span<Elem> GetTyped(int field) const {
+		assertrx(field < Type().NumFields());
+		const PayloadFieldValue value = Field(field);
+		if (!value.t_.IsArray()) return span<Elem>(reinterpret_cast<const Elem *>(value.p_), 1);
+		auto *arr = reinterpret_cast<const PayloadFieldValue::Array *>(value.p_);
+		return span<Elem>(reinterpret_cast<const Elem *>(v_->Ptr() + arr->offset), arr->len);
+	}
+	// Call visitor with the span of typed values of the field (see GetTyped)
+	template <typename Visitor>
+	auto VisitField(int field, Visitor &&visitor) const {
+		switch (t_.Field(field).Type()) {
+			case KeyValueBool:
+				return visitor(GetTyped<bool>(field));
+			case KeyValueInt:
+				return visitor(GetTyped<int>(field));
+			case KeyValueInt64:
+				return visitor(GetTyped<int64_t>(field));
+			case KeyValueDouble:
+				return visitor(GetTyped<double>(field));
+			case KeyValueString:
+				return visitor(GetTyped<p_string>(field));
+			default:
+				abort();
+		}
+	}
 	// Get array len
 	int GetArrayLen(int field) const {
 		assertrx(field < Type().NumFields());
@@ -99,6 +129,8 @@ public:
 	size_t GetHash(const FieldsSet &fields) const;
 	// Compare is EQ by field mask
 	bool IsEQ(const T &other, const FieldsSet &fields) const;
+	// Compare is EQ by the value of the indexed field. Values are compared without the conversion to the Variants
+	bool IsFieldEQ(const T &other, int field) const;
 	// Get hash of all document
 	uint64_t GetHash() const;
 
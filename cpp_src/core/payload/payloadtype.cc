@@ -186,6 +186,7 @@ const string &PayloadType::Name() const { return get()->Name(); }
 void PayloadType::SetName(const string &name) { clone()->SetName(name); }
 int PayloadType::NumFields() const { return get()->NumFields(); }
 void PayloadType::Add(PayloadFieldType f) { clone()->Add(f); }
+void PayloadType::SetColdTuples(std::shared_ptr<ColdTuples> coldTuples) { clone()->SetColdTuples(std::move(coldTuples)); }
 bool PayloadType::Drop(std::string_view field) { return clone()->Drop(field); }
 int PayloadType::FieldByName(std::string_view field) const { return get()->FieldByName(field); }
 bool PayloadType::FieldByName(std::string_view name, int &field) const { return get()->FieldByName(name, field); }
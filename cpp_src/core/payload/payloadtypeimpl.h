@@ -1,6 +1,7 @@
 #pragma once
 
 #include <initializer_list>
+#include <memory>
 #include <string>
 #include <vector>
 #include "estl/fast_hash_map.h"
@@ -11,6 +12,7 @@ namespace reindexer {
 
 class Serializer;
 class WrSerializer;
+class ColdTuples;
 
 // Type of all payload object
 class PayloadTypeImpl {
@@ -35,6 +37,8 @@ public:
 	bool Contains(std::string_view field) const;
 	int FieldByJsonPath(std::string_view jsonPath) const;
 	const vector<int> &StrFields() const { return strFields_; }
+	ColdTuples *GetColdTuples() const noexcept { return coldTuples_.get(); }
+	void SetColdTuples(std::shared_ptr<ColdTuples> coldTuples) noexcept { coldTuples_ = std::move(coldTuples); }
 
 	void serialize(WrSerializer &ser) const;
 	void deserialize(Serializer &ser);
@@ -49,6 +53,8 @@ protected:
 	JsonPathMap fieldsByJsonPath_;
 	string name_;
 	vector<int> strFields_;
+	// Storage of the tuples, evicted from the namespace's payloads. It is shared between the copies of the payload type
+	std::shared_ptr<ColdTuples> coldTuples_;
 };
 
 }  // namespace reindexer
@@ -21,6 +21,7 @@ void PerfStatCounter<Mutex>::Hit(std::chrono::microseconds time) {
 	calcTime += time;
 	calcHitCount++;
 	totalHitCount++;
+	latencies_.Add(time.count());
 	if (lastValuesUs.size() < kMaxValuesCountForStddev) {
 		lastValuesUs.push_back(std::chrono::duration_cast<std::chrono::microseconds>(calcTime).count());
 		posInValuesUs = kMaxValuesCountForStddev - 1;
@@ -57,6 +58,7 @@ void PerfStatCounter<Mutex>::Reset() {
 	stddev = defaultCounter.stddev;
 	minTime = defaultCounter.minTime;
 	maxTime = defaultCounter.maxTime;
+	latencies_.Reset();
 }
 
 template <typename Mutex>
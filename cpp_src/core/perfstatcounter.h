@@ -1,6 +1,9 @@
 #pragma once
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <cmath>
 #include <chrono>
 #include <mutex>
 #include <vector>
@@ -8,6 +11,73 @@
 
 namespace reindexer {
 
+/// Log-linear histogram of latencies (like HDR histogram): each power of two range of values is split into kSubBuckets equal buckets,
+/// so the relative error of quantiles is not greater than 1 / kSubBuckets at the fixed memory. Histograms are mergeable
+class LatencyHistogram {
+public:
+	static constexpr unsigned kSubBucketsBits = 3;
+	static constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBucketsBits;
+	/// Values greater than 2^kMaxValueBits (about 19 hours in microseconds) are counted in the last bucket
+	static constexpr unsigned kMaxValueBits = 36;
+
+	void Add(uint64_t value) {
+		if (counts_.empty()) counts_.resize(kBucketsCount, 0);
+		++counts_[bucketIdx(value)];
+		++count_;
+		maxValue_ = std::max(maxValue_, value);
+	}
+	void Merge(const LatencyHistogram &other) {
+		if (!other.count_) return;
+		if (counts_.empty()) counts_.resize(kBucketsCount, 0);
+		for (size_t i = 0; i < kBucketsCount; ++i) counts_[i] += other.counts_[i];
+		count_ += other.count_;
+		maxValue_ = std::max(maxValue_, other.maxValue_);
+	}
+	/// @param q - quantile in [0, 1]
+	/// @return upper bound of the bucket, which contains quantile, but not greater than max value, or 0 if histogram is empty
+	uint64_t Quantile(double q) const noexcept {
+		if (!count_) return 0;
+		const uint64_t rank = std::max(uint64_t(1), uint64_t(std::ceil(std::min(std::max(q, 0.0), 1.0) * double(count_))));
+		uint64_t seen = 0;
+		size_t i = 0;
+		for (; i + 1 < kBucketsCount; ++i) {
+			seen += counts_[i];
+			if (seen >= rank) break;
+		}
+		// The last bucket has no upper bound
+		return (i + 1 == kBucketsCount) ? maxValue_ : std::min(bucketUpperBound(i), maxValue_);
+	}
+	/// Clears counters, but keeps allocated memory
+	void Reset() noexcept {
+		std::fill(counts_.begin(), counts_.end(), 0);
+		count_ = 0;
+		maxValue_ = 0;
+	}
+	uint64_t Count() const noexcept { return count_; }
+
+private:
+	static constexpr size_t kBucketsCount = (kMaxValueBits - kSubBucketsBits + 1) * kSubBuckets;
+
+	static size_t bucketIdx(uint64_t value) noexcept {
+		if (value < kSubBuckets) return value;
+		unsigned msb = 63 - __builtin_clzll(value);
+		if (msb >= kMaxValueBits) return kBucketsCount - 1;
+		const unsigned shift = msb - kSubBucketsBits;
+		// Mantissa is in [kSubBuckets, 2 * kSubBuckets), so the buckets of the neighbour ranges are adjacent
+		return shift * kSubBuckets + (value >> shift);
+	}
+	static uint64_t bucketUpperBound(size_t idx) noexcept {
+		if (idx < kSubBuckets) return idx;
+		const unsigned shift = idx / kSubBuckets - 1;
+		const uint64_t mantissa = idx % kSubBuckets + kSubBuckets;
+		return ((mantissa + 1) << shift) - 1;
+	}
+
+	std::vector<uint64_t> counts_;
+	uint64_t count_ = 0;
+	uint64_t maxValue_ = 0;
+};
+
 template <typename Mutex>
 class PerfStatCounter {
 public:
@@ -28,7 +98,11 @@ public:
 				 size_t(avgLockTime.count() / (avgHitCount ? avgHitCount : 1)),
 				 stddev,
 				 size_t(minTime == defaultMinTime() ? 0 : minTime.count()),
-				 size_t(maxTime.count())};
+				 size_t(maxTime.count()),
+				 size_t(latencies_.Quantile(0.5)),
+				 size_t(latencies_.Quantile(0.9)),
+				 size_t(latencies_.Quantile(0.99)),
+				 size_t(latencies_.Quantile(0.999))};
 	}
 
 protected:
@@ -55,6 +129,7 @@ protected:
 	std::chrono::microseconds maxTime = std::chrono::microseconds(std::numeric_limits<size_t>::min());
 	std::vector<size_t> lastValuesUs;
 	size_t posInValuesUs = 0;
+	LatencyHistogram latencies_;
 	Mutex mtx_;
 };
 
@@ -131,4 +206,44 @@ using QuantityCounterMT = QuantityCounter<IntT, std::mutex>;
 template <typename IntT>
 using QuantityCounterST = QuantityCounter<IntT, dummy_mutex>;
 
+/// Counts distribution of the values by the fixed buckets. Bucket i contains values in (bounds[i - 1], bounds[i]], the last bucket
+/// has no upper bound
+template <typename Mutex>
+class HistogramCounter {
+public:
+	struct Stats {
+		std::vector<uint64_t> bounds;
+		std::vector<uint64_t> counts;
+		uint64_t sum = 0;
+		size_t hitsCount = 0;
+	};
+
+	explicit HistogramCounter(std::vector<uint64_t> bounds) {
+		stats_.bounds = std::move(bounds);
+		stats_.counts.resize(stats_.bounds.size() + 1, 0);
+	}
+	void Count(uint64_t value) {
+		std::unique_lock<Mutex> lck(mtx_);
+		const auto bucket = std::lower_bound(stats_.bounds.begin(), stats_.bounds.end(), value) - stats_.bounds.begin();
+		++stats_.counts[bucket];
+		stats_.sum += value;
+		++stats_.hitsCount;
+	}
+	Stats Get() const {
+		std::unique_lock<Mutex> lck(mtx_);
+		return stats_;
+	}
+	void Reset() {
+		std::unique_lock<Mutex> lck(mtx_);
+		std::fill(stats_.counts.begin(), stats_.counts.end(), 0);
+		stats_.sum = 0;
+		stats_.hitsCount = 0;
+	}
+
+private:
+	mutable Mutex mtx_;
+	Stats stats_;
+};
+using HistogramCounterMT = HistogramCounter<std::mutex>;
+
 }  // namespace reindexer
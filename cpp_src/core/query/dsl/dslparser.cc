@@ -101,7 +101,7 @@ static const fast_str_map<Filter> filter_map = {{"cond", Filter::Cond},
 static const fast_str_map<CondType> cond_map = {
 	{"any", CondAny},  {"eq", CondEq},		 {"lt", CondLt},		   {"le", CondLe},		   {"gt", CondGt},
 	{"ge", CondGe},	   {"range", CondRange}, {"set", CondSet},		   {"allset", CondAllSet}, {"empty", CondEmpty},
-	{"match", CondEq}, {"like", CondLike},	 {"dwithin", CondDWithin},
+	{"match", CondEq}, {"like", CondLike},	 {"dwithin", CondDWithin}, {"knn", CondKnn},
 };
 
 static const fast_str_map<OpType> op_map = {{"or", OpOr}, {"and", OpAnd}, {"not", OpNot}};
@@ -119,7 +119,9 @@ static const fast_str_map<Aggregation> aggregation_map = {{"fields", Aggregation
 														  {"limit", Aggregation::Limit},
 														  {"offset", Aggregation::Offset}};
 static const fast_str_map<AggType> aggregation_types = {{"sum", AggSum}, {"avg", AggAvg},	  {"max", AggMax},
-														{"min", AggMin}, {"facet", AggFacet}, {"distinct", AggDistinct}};
+														{"min", AggMin}, {"facet", AggFacet}, {"distinct", AggDistinct},
+														{"approx_count_distinct", AggApproxCountDistinct},
+														{"quantile", AggQuantile}};
 
 // additionalfor parse field 'equation_positions'
 static const fast_str_map<EqualPosition> equationPosition_map = {{"positions", EqualPosition::Positions}};
@@ -372,6 +374,11 @@ void parseFilter(JsonValue& filter, Query& q, std::vector<std::pair<size_t, Equa
 						throw Error(errLogic, "Condition ANY must have 0 values, but %d values was provided", values.size());
 					}
 					break;
+				case CondKnn:
+					if (values.size() < 3) {
+						throw Error(errLogic, "Condition KNN must have k, ef and vector values, but %d values was provided", values.size());
+					}
+					break;
 				default:
 					break;
 			}
@@ -11,146 +11,224 @@ using namespace std::string_view_literals;
 
 const char* kWrongFieldTypeError = "Only integral type non-array fields are supported in arithmetical expressions: %s";
 
+static bool isNumericType(KeyValueType type) noexcept {
+	return (type == KeyValueInt) || (type == KeyValueInt64) || (type == KeyValueDouble);
+}
+
 ExpressionEvaluator::ExpressionEvaluator(const PayloadType& type, TagsMatcher& tagsMatcher, FunctionExecutor& func)
 	: type_(type), tagsMatcher_(tagsMatcher), functionExecutor_(func) {}
 
-void ExpressionEvaluator::captureArrayContent(tokenizer& parser) {
+void ExpressionEvaluator::captureArrayContent(tokenizer& parser, VariantArray& values) {
 	token tok = parser.next_token(false);
 	for (;;) {
 		tok = parser.next_token(false);
 		if (tok.text() == "]"sv) {
-			if (arrayValues_.empty()) break;
+			if (values.empty()) break;
 			throw Error(errParseSQL, "Expected field value, but found ']' in query, %s", parser.where());
 		}
-		arrayValues_.emplace_back(token2kv(tok, parser, false));
+		values.emplace_back(token2kv(tok, parser, false));
 		tok = parser.next_token();
 		if (tok.text() == "]"sv) break;
 		if (tok.text() != ","sv) throw Error(errParseSQL, "Expected ']' or ',', but found '%s' in query, %s", tok.text(), parser.where());
 	};
 }
 
-double ExpressionEvaluator::getPrimaryToken(tokenizer& parser, const PayloadValue& v) {
+int ExpressionEvaluator::addNode(CompiledExpression& expr, Node&& node) {
+	expr.nodes_.emplace_back(std::move(node));
+	return int(expr.nodes_.size()) - 1;
+}
+
+int ExpressionEvaluator::addOperation(CompiledExpression& expr, NodeType type, int left, int right) {
+	Node node;
+	node.type = type;
+	node.left = left;
+	node.right = right;
+	return addNode(expr, std::move(node));
+}
+
+int ExpressionEvaluator::compilePrimaryToken(tokenizer& parser, CompiledExpression& expr) {
 	token tok = parser.peek_token(true, true);
+	Node node;
 	if (tok.text() == "("sv) {
 		parser.next_token();
-		double val = performSumAndSubtracting(parser, v);
+		int res = compileSumAndSubtracting(parser, expr);
 		if (parser.next_token().text() != ")"sv) throw Error(errLogic, "')' expected in arithmetical expression");
-		return val;
+		return res;
 	} else if (tok.text() == "["sv) {
-		captureArrayContent(parser);
+		node.type = NodeType::Array;
+		captureArrayContent(parser, node.values);
 	} else if (tok.type == TokenNumber) {
 		char* p = nullptr;
 		parser.next_token();
-		return strtod(tok.text().data(), &p);
+		node.type = NodeType::Number;
+		node.number = strtod(tok.text().data(), &p);
 	} else if (tok.type == TokenName) {
-		int field = 0;
-		VariantArray fieldValues;
-		ConstPayload pv(type_, v);
-		if (type_.FieldByName(tok.text(), field)) {
-			KeyValueType type = type_.Field(field).Type();
-			if (type_.Field(field).IsArray()) {
-				pv.Get(field, fieldValues);
-				for (const Variant& v : fieldValues) {
-					arrayValues_.emplace_back(v);
-				}
-				parser.next_token();
-				return 0.0;
-			} else if (state_ == StateArrayConcat) {
-				VariantArray vals;
-				pv.GetByJsonPath(tok.text(), tagsMatcher_, vals, KeyValueUndefined);
-				for (const Variant& v : vals) {
-					arrayValues_.emplace_back(v);
-				}
-				parser.next_token();
-				return 0.0;
-			} else if ((type == KeyValueInt) || (type == KeyValueInt64) || (type == KeyValueDouble)) {
-				pv.Get(field, fieldValues);
-				if (fieldValues.empty()) throw Error(errLogic, "Calculating value of an empty field is impossible: %s", tok.text());
-				parser.next_token();
-				return fieldValues.front().As<double>();
-			} else {
-				throw Error(errLogic, kWrongFieldTypeError, tok.text());
-			}
+		node.name = string(tok.text());
+		node.concat = (state_ == StateArrayConcat);
+		parser.next_token();
+		if (type_.FieldByName(tok.text(), node.field)) {
+			node.type = NodeType::Field;
+		} else if (parser.peek_token(false).text() == "("sv) {
+			node.type = NodeType::Function;
+			node.func = std::make_shared<SelectFuncStruct>(SelectFuncParser().ParseFunction(parser, true, std::move(tok)));
+			return addNode(expr, std::move(node));
 		} else {
-			pv.GetByJsonPath(tok.text(), tagsMatcher_, fieldValues, KeyValueUndefined);
-			if (fieldValues.size() > 0) {
-				KeyValueType type = fieldValues.front().Type();
-				if ((fieldValues.size() > 1) || (state_ == StateArrayConcat)) {
-					for (const Variant& v : fieldValues) {
-						arrayValues_.emplace_back(v);
-					}
-					parser.next_token();
-					return 0.0;
-				} else if ((type == KeyValueInt) || (type == KeyValueInt64) || (type == KeyValueDouble)) {
-					parser.next_token();
-					return fieldValues.front().As<double>();
-				} else {
-					throw Error(errLogic, kWrongFieldTypeError, tok.text());
-				}
-			} else {
-				SelectFuncStruct funcData = SelectFuncParser().ParseFunction(parser, true);
-				funcData.field = forField_;
-				return functionExecutor_.Execute(funcData).As<double>();
-			}
+			node.type = NodeType::JsonPath;
+			node.nextToken = string(parser.peek_token(false).text());
 		}
+		// Path may be unknown yet, if the tag will be added by the update itself. It is resolved for each item in this case
+		node.tagsPath = tagsMatcher_.path2indexedtag(node.name, nullptr, false);
 	} else {
 		throw Error(errLogic, "Only integral type non-array fields are supported in arithmetical expressions");
 	}
-	return 0.0;
+	return addNode(expr, std::move(node));
 }
 
-double ExpressionEvaluator::performArrayConcatenation(tokenizer& parser, const PayloadValue& v, token& tok) {
-	double left = getPrimaryToken(parser, v);
+int ExpressionEvaluator::compileArrayConcatenation(tokenizer& parser, CompiledExpression& expr, token& tok) {
+	int left = compilePrimaryToken(parser, expr);
 	tok = parser.peek_token();
 	while (tok.text() == "|"sv) {
 		parser.next_token();
 		tok = parser.next_token();
 		if (tok.text() != "|") throw Error(errLogic, "Expected '|', not %s", tok.text());
 		state_ = StateArrayConcat;
-		getPrimaryToken(parser, v);
+		int right = compilePrimaryToken(parser, expr);
+		left = addOperation(expr, NodeType::ArrayConcatenation, left, right);
 		tok = parser.peek_token();
 	}
 	return left;
 }
 
-double ExpressionEvaluator::performMultiplicationAndDivision(tokenizer& parser, const PayloadValue& v, token& tok) {
-	double left = performArrayConcatenation(parser, v, tok);
+int ExpressionEvaluator::compileMultiplicationAndDivision(tokenizer& parser, CompiledExpression& expr, token& tok) {
+	int left = compileArrayConcatenation(parser, expr, tok);
 	tok = parser.peek_token(true, true);
 	while (tok.text() == "*"sv || tok.text() == "/"sv) {
 		state_ = StateMultiplyAndDivide;
-		if (tok.text() == "*"sv) {
-			parser.next_token();
-			left *= performMultiplicationAndDivision(parser, v, tok);
-		} else if (tok.text() == "/"sv) {
-			parser.next_token();
-			double val = performMultiplicationAndDivision(parser, v, tok);
-			if (val == 0) throw Error(errLogic, "Division by zero!");
-			left /= val;
-		}
+		const NodeType type = (tok.text() == "*"sv) ? NodeType::Multiplication : NodeType::Division;
+		parser.next_token();
+		int right = compileMultiplicationAndDivision(parser, expr, tok);
+		left = addOperation(expr, type, left, right);
 	}
 	return left;
 }
 
-double ExpressionEvaluator::performSumAndSubtracting(tokenizer& parser, const PayloadValue& v) {
+int ExpressionEvaluator::compileSumAndSubtracting(tokenizer& parser, CompiledExpression& expr) {
 	token tok;
-	double left = performMultiplicationAndDivision(parser, v, tok);
+	int left = compileMultiplicationAndDivision(parser, expr, tok);
 	tok = parser.peek_token(true, true);
 	while (tok.text() == "+"sv || tok.text() == "-"sv) {
 		state_ = StateSumAndSubtract;
-		if (tok.text() == "+"sv) {
-			parser.next_token(true, true);
-			left += performMultiplicationAndDivision(parser, v, tok);
-		} else if (tok.text() == "-"sv) {
-			parser.next_token(true, true);
-			left -= performMultiplicationAndDivision(parser, v, tok);
-		}
+		const NodeType type = (tok.text() == "+"sv) ? NodeType::Sum : NodeType::Subtraction;
+		parser.next_token(true, true);
+		int right = compileMultiplicationAndDivision(parser, expr, tok);
+		left = addOperation(expr, type, left, right);
 	}
 	return left;
 }
 
-VariantArray ExpressionEvaluator::Evaluate(tokenizer& parser, const PayloadValue& v, std::string_view forField) {
+CompiledExpression ExpressionEvaluator::Compile(std::string_view expr) {
+	CompiledExpression compiled;
+	state_ = None;
+	tokenizer parser(expr);
+	compiled.root_ = compileSumAndSubtracting(parser, compiled);
+	return compiled;
+}
+
+void ExpressionEvaluator::getByJsonPath(const Node& node, const PayloadValue& v, VariantArray& values) {
+	ConstPayload pv(type_, v);
+	if (node.tagsPath.empty()) {
+		pv.GetByJsonPath(node.name, tagsMatcher_, values, KeyValueUndefined);
+	} else {
+		pv.GetByJsonPath(node.tagsPath, values, KeyValueUndefined);
+	}
+}
+
+void ExpressionEvaluator::appendArrayValues(const VariantArray& values) {
+	for (const Variant& v : values) {
+		arrayValues_.emplace_back(v);
+	}
+}
+
+double ExpressionEvaluator::evaluateOperand(const Node& node, const PayloadValue& v) {
+	VariantArray fieldValues;
+	switch (node.type) {
+		case NodeType::Number:
+			return node.number;
+		case NodeType::Array:
+			appendArrayValues(node.values);
+			return 0.0;
+		case NodeType::Field: {
+			const PayloadFieldType& field = type_.Field(node.field);
+			if (field.IsArray()) {
+				ConstPayload(type_, v).Get(node.field, fieldValues);
+				appendArrayValues(fieldValues);
+				return 0.0;
+			} else if (node.concat) {
+				getByJsonPath(node, v, fieldValues);
+				appendArrayValues(fieldValues);
+				return 0.0;
+			} else if (isNumericType(field.Type())) {
+				ConstPayload(type_, v).Get(node.field, fieldValues);
+				if (fieldValues.empty()) throw Error(errLogic, "Calculating value of an empty field is impossible: %s", node.name);
+				return fieldValues.front().As<double>();
+			}
+			throw Error(errLogic, kWrongFieldTypeError, node.name);
+		}
+		case NodeType::JsonPath:
+			getByJsonPath(node, v, fieldValues);
+			if (fieldValues.empty()) {
+				throw Error(errParseDSL, "An open parenthesis is required, but found `%s`", node.nextToken);
+			} else if ((fieldValues.size() > 1) || node.concat) {
+				appendArrayValues(fieldValues);
+				return 0.0;
+			} else if (isNumericType(fieldValues.front().Type())) {
+				return fieldValues.front().As<double>();
+			}
+			throw Error(errLogic, kWrongFieldTypeError, node.name);
+		case NodeType::Function:
+			node.func->field = forField_;
+			return functionExecutor_.Execute(*node.func).As<double>();
+		default:
+			throw Error(errLogic, "Unexpected node of arithmetical expression");
+	}
+}
+
+double ExpressionEvaluator::evaluate(const CompiledExpression& expr, int idx, const PayloadValue& v) {
+	const Node& node = expr.nodes_[idx];
+	// Operands are evaluated from left to right, because arrays concatenation and functions depend on the order
+	switch (node.type) {
+		case NodeType::Sum: {
+			const double left = evaluate(expr, node.left, v);
+			return left + evaluate(expr, node.right, v);
+		}
+		case NodeType::Subtraction: {
+			const double left = evaluate(expr, node.left, v);
+			return left - evaluate(expr, node.right, v);
+		}
+		case NodeType::Multiplication: {
+			const double left = evaluate(expr, node.left, v);
+			return left * evaluate(expr, node.right, v);
+		}
+		case NodeType::Division: {
+			const double left = evaluate(expr, node.left, v);
+			const double right = evaluate(expr, node.right, v);
+			if (right == 0) throw Error(errLogic, "Division by zero!");
+			return left / right;
+		}
+		case NodeType::ArrayConcatenation: {
+			const double left = evaluate(expr, node.left, v);
+			evaluate(expr, node.right, v);
+			return left;
+		}
+		default:
+			return evaluateOperand(node, v);
+	}
+}
+
+VariantArray ExpressionEvaluator::Evaluate(const CompiledExpression& expr, const PayloadValue& v, std::string_view forField) {
 	forField_ = string(forField);
-	double expressionValue = performSumAndSubtracting(parser, v);
+	arrayValues_.clear();
+	double expressionValue = evaluate(expr, expr.root_, v);
 	if (arrayValues_.empty()) {
 		return {Variant(expressionValue)};
 	} else {
@@ -159,10 +237,4 @@ VariantArray ExpressionEvaluator::Evaluate(tokenizer& parser, const PayloadValue
 	}
 }
 
-VariantArray ExpressionEvaluator::Evaluate(std::string_view expr, const PayloadValue& v, std::string_view forField) {
-	arrayValues_.clear();
-	tokenizer parser(expr);
-	return Evaluate(parser, v, forField);
-}
-
 }  // namespace reindexer
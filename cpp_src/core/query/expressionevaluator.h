@@ -1,6 +1,8 @@
 #pragma once
 
+#include "core/cjson/tagspath.h"
 #include "core/keyvalue/variant.h"
+#include "core/selectfunc/selectfuncparser.h"
 
 namespace reindexer {
 
@@ -8,21 +10,64 @@ class token;
 class tokenizer;
 class FunctionExecutor;
 class TagsMatcher;
+class ExpressionEvaluator;
+
+/// Arithmetical expression (of the UPDATE query's field or of the array index in the field's path), parsed once for all the updated
+/// items. Names of the fields are resolved to the payload fields and tags paths during the compilation
+class CompiledExpression {
+public:
+	bool Empty() const noexcept { return nodes_.empty(); }
+
+private:
+	friend class ExpressionEvaluator;
+
+	enum class NodeType { Number, Array, Field, JsonPath, Function, Sum, Subtraction, Multiplication, Division, ArrayConcatenation };
+	struct Node {
+		NodeType type;
+		// Operand follows array concatenation operator '||' - its values are appended to the resulting array
+		bool concat = false;
+		double number = 0.0;
+		int field = 0;
+		int left = -1, right = -1;
+		std::string name;
+		// Token, found after the name of the missing field - it was expected to be the function's open parenthesis
+		std::string nextToken;
+		IndexedTagsPath tagsPath;
+		VariantArray values;
+		std::shared_ptr<SelectFuncStruct> func;
+	};
+
+	std::vector<Node> nodes_;
+	int root_ = -1;
+};
 
 class ExpressionEvaluator {
 public:
 	ExpressionEvaluator(const PayloadType& type, TagsMatcher& tagsMatcher, FunctionExecutor& func);
 
-	VariantArray Evaluate(tokenizer& parser, const PayloadValue& v, std::string_view forField);
-	VariantArray Evaluate(std::string_view expr, const PayloadValue& v, std::string_view forField);
+	CompiledExpression Compile(std::string_view expr);
+	VariantArray Evaluate(const CompiledExpression& expr, const PayloadValue& v, std::string_view forField);
+	VariantArray Evaluate(std::string_view expr, const PayloadValue& v, std::string_view forField) {
+		return Evaluate(Compile(expr), v, forField);
+	}
 
 private:
-	double getPrimaryToken(tokenizer& parser, const PayloadValue& v);
-	double performSumAndSubtracting(tokenizer& parser, const PayloadValue& v);
-	double performMultiplicationAndDivision(tokenizer& parser, const PayloadValue& v, token& lastTok);
-	double performArrayConcatenation(tokenizer& parser, const PayloadValue& v, token& lastTok);
+	using Node = CompiledExpression::Node;
+	using NodeType = CompiledExpression::NodeType;
+
+	int compilePrimaryToken(tokenizer& parser, CompiledExpression& expr);
+	int compileSumAndSubtracting(tokenizer& parser, CompiledExpression& expr);
+	int compileMultiplicationAndDivision(tokenizer& parser, CompiledExpression& expr, token& lastTok);
+	int compileArrayConcatenation(tokenizer& parser, CompiledExpression& expr, token& lastTok);
+	int addNode(CompiledExpression& expr, Node&& node);
+	int addOperation(CompiledExpression& expr, NodeType type, int left, int right);
+
+	double evaluate(const CompiledExpression& expr, int node, const PayloadValue& v);
+	double evaluateOperand(const Node& node, const PayloadValue& v);
+	void getByJsonPath(const Node& node, const PayloadValue& v, VariantArray& values);
+	void appendArrayValues(const VariantArray& values);
 
-	void captureArrayContent(tokenizer& parser);
+	void captureArrayContent(tokenizer& parser, VariantArray& values);
 
 	enum State { None = 0, StateArrayConcat, StateMultiplyAndDivide, StateSumAndSubtract };
 
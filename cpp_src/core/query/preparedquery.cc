@@ -0,0 +1,23 @@
+#include "preparedquery.h"
+
+namespace reindexer {
+
+PreparedQuery::PreparedQuery(std::string_view sql) {
+	SQLParser(query_, &placeholders_).Parse(sql);
+	// Parsed query holds about the same data as its text, but in the several allocations
+	size_ = sizeof(PreparedQuery) + 4 * sql.size();
+}
+
+Query PreparedQuery::Bind(const VariantArray &params) const {
+	if (params.size() != placeholders_.size()) {
+		throw Error(errParams, "Prepared query expects %d params, but %d were passed", placeholders_.size(), params.size());
+	}
+	Query q(query_);
+	for (size_t i = 0; i < params.size(); ++i) {
+		const auto &placeholder = placeholders_[i];
+		q.entries.Get<QueryEntry>(placeholder.entry).values[placeholder.value] = params[i];
+	}
+	return q;
+}
+
+}  // namespace reindexer
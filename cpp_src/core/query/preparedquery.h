@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include "core/query/query.h"
+#include "core/query/sql/sqlparser.h"
+
+namespace reindexer {
+
+/// SQL query, which is parsed once and is executed many times with the different values of the '?' placeholders in WHERE clause,
+/// e.g. "SELECT * FROM items WHERE id = ? AND category IN (?, ?)"
+class PreparedQuery {
+public:
+	/// Parses SQL query. Throws Error on the invalid query
+	explicit PreparedQuery(std::string_view sql);
+
+	size_t ParamsCount() const noexcept { return placeholders_.size(); }
+	/// @return query with the placeholders replaced by the params in the order of placeholders
+	Query Bind(const VariantArray &params) const;
+	/// @return approximate size of the memory, used by the query (for the cache limits)
+	size_t Size() const noexcept { return size_; }
+
+private:
+	Query query_;
+	std::vector<SQLPlaceholder> placeholders_;
+	size_t size_ = 0;
+};
+
+/// Cache of the prepared queries by SQL text
+struct PreparedQueryCacheKey {
+	size_t Size() const noexcept { return sql.size(); }
+
+	std::string sql;
+};
+
+struct PreparedQueryCacheVal {
+	size_t Size() const noexcept { return query ? query->Size() : 0; }
+
+	std::shared_ptr<const PreparedQuery> query;
+};
+
+struct HashPreparedQueryCacheKey {
+	size_t operator()(const PreparedQueryCacheKey &k) const noexcept { return std::hash<std::string>()(k.sql); }
+};
+
+struct EqPreparedQueryCacheKey {
+	bool operator()(const PreparedQueryCacheKey &lhs, const PreparedQueryCacheKey &rhs) const noexcept { return lhs.sql == rhs.sql; }
+};
+
+}  // namespace reindexer
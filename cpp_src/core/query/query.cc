@@ -12,6 +12,7 @@ using namespace std::string_view_literals;
 
 const std::string_view kLsnIndexName = "#lsn"sv;
 const std::string_view kSlaveVersionIndexName = "#slave_version"sv;
+const std::string_view kDataHashBucketsIndexName = "#data_hash_buckets"sv;
 
 Query::Query(const string &__namespace, unsigned _start, unsigned _count, CalcTotalMode _calcTotal)
 	: _namespace(__namespace), start(_start), count(_count), calcTotal(_calcTotal) {}
@@ -27,6 +28,9 @@ bool Query::operator==(const Query &obj) const {
 	if (count != obj.count) return false;
 	if (debugLevel != obj.debugLevel) return false;
 	if (strictMode != obj.strictMode) return false;
+	if (parallelScan != obj.parallelScan) return false;
+	if (waitLSN != obj.waitLSN || waitLSNTimeoutMs != obj.waitLSNTimeoutMs) return false;
+	if (bestEffort != obj.bestEffort) return false;
 	if (forcedSortOrder_.size() != obj.forcedSortOrder_.size()) return false;
 	for (size_t i = 0, s = forcedSortOrder_.size(); i < s; ++i) {
 		if (forcedSortOrder_[i].RelaxCompare(obj.forcedSortOrder_[i]) != 0) return false;
@@ -192,6 +196,16 @@ void Query::deserialize(Serializer &ser, bool &hasJoinConditions) {
 			case QueryStrictMode:
 				strictMode = StrictMode(ser.GetVarUint());
 				break;
+			case QueryParallelScan:
+				parallelScan = ParallelScanMode(ser.GetVarUint());
+				break;
+			case QueryWaitLSN:
+				waitLSN = ser.GetVarint();
+				waitLSNTimeoutMs = ser.GetVarUint();
+				break;
+			case QueryBestEffort:
+				bestEffort = ser.GetVarUint();
+				break;
 			case QueryLimit:
 				count = ser.GetVarUint();
 				break;
@@ -361,6 +375,22 @@ void Query::Serialize(WrSerializer &ser, uint8_t mode) const {
 		ser.PutVarUint(int(strictMode));
 	}
 
+	if (parallelScan != ParallelScanNotSet) {
+		ser.PutVarUint(QueryParallelScan);
+		ser.PutVarUint(int(parallelScan));
+	}
+
+	if (HasWaitLSN()) {
+		ser.PutVarUint(QueryWaitLSN);
+		ser.PutVarint(waitLSN);
+		ser.PutVarUint(waitLSNTimeoutMs);
+	}
+
+	if (bestEffort) {
+		ser.PutVarUint(QueryBestEffort);
+		ser.PutVarUint(1);
+	}
+
 	if (!(mode & SkipLimitOffset)) {
 		if (HasLimit()) {
 			ser.PutVarUint(QueryLimit);
@@ -425,6 +455,98 @@ void Query::Serialize(WrSerializer &ser, uint8_t mode) const {
 	}
 }
 
+size_t Query::Hash(uint8_t mode) const {
+	size_t ret = std::hash<std::string>()(_namespace) ^ (entries.Hash() * 31);
+	for (const auto &se : sortingEntries_) ret = (ret * 127) ^ std::hash<std::string>()(se.expression) ^ size_t(se.desc);
+	for (const auto &v : forcedSortOrder_) ret = (ret * 127) ^ v.StrictHash();
+	for (const auto &agg : aggregations_) ret = (ret * 127) ^ agg.type_ ^ (agg.fields_.size() << 4);
+	for (const auto &sf : selectFilter_) ret = (ret * 127) ^ std::hash<std::string>()(sf);
+	ret = (ret * 127) ^ calcTotal ^ (size_t(debugLevel) << 4);
+	if (!(mode & SkipLimitOffset)) ret = (ret * 127) ^ start ^ (size_t(count) << 32);
+	if (!(mode & SkipJoinQueries)) {
+		for (const auto &jq : joinQueries_) ret = (ret * 127) ^ jq.joinType ^ jq.Hash(WithJoinEntries);
+	}
+	if (!(mode & SkipMergeQueries)) {
+		for (const auto &mq : mergeQueries_) ret = (ret * 127) ^ mq.joinType ^ mq.Hash(mode | WithJoinEntries);
+	}
+	return ret;
+}
+
+bool Query::IsEqual(const Query &other, uint8_t mode) const {
+	if (_namespace != other._namespace || !entries.IsEqual(other.entries)) return false;
+	if (aggregations_ != other.aggregations_ || sortingEntries_ != other.sortingEntries_) return false;
+	if (forcedSortOrder_.size() != other.forcedSortOrder_.size()) return false;
+	for (size_t i = 0, s = forcedSortOrder_.size(); i < s; ++i) {
+		if (!forcedSortOrder_[i].IsStrictlyEqual(other.forcedSortOrder_[i])) return false;
+	}
+	if (calcTotal != other.calcTotal || debugLevel != other.debugLevel || strictMode != other.strictMode ||
+		parallelScan != other.parallelScan || waitLSN != other.waitLSN || waitLSNTimeoutMs != other.waitLSNTimeoutMs ||
+		bestEffort != other.bestEffort || explain_ != other.explain_ || withRank_ != other.withRank_) {
+		return false;
+	}
+	if (selectFilter_ != other.selectFilter_ || selectFunctions_ != other.selectFunctions_) return false;
+	if (updateFields_.size() != other.updateFields_.size()) return false;
+	for (size_t i = 0; i < updateFields_.size(); ++i) {
+		const auto &field = updateFields_[i], &ofield = other.updateFields_[i];
+		if (field.column != ofield.column || field.mode != ofield.mode || field.isExpression != ofield.isExpression ||
+			field.values.size() != ofield.values.size()) {
+			return false;
+		}
+		for (size_t j = 0; j < field.values.size(); ++j) {
+			if (!field.values[j].IsStrictlyEqual(ofield.values[j])) return false;
+		}
+	}
+	if (!(mode & SkipLimitOffset) && (start != other.start || count != other.count)) return false;
+	if (mode & WithJoinEntries) {
+		const auto &joinEntries = reinterpret_cast<const JoinedQuery *>(this)->joinEntries_;
+		const auto &otherJoinEntries = reinterpret_cast<const JoinedQuery *>(&other)->joinEntries_;
+		if (joinEntries.size() != otherJoinEntries.size()) return false;
+		for (size_t i = 0; i < joinEntries.size(); ++i) {
+			// Numbers of the indexes are set during the select
+			const auto &qje = joinEntries[i], &oqje = otherJoinEntries[i];
+			if (qje.op_ != oqje.op_ || qje.condition_ != oqje.condition_ || qje.index_ != oqje.index_ ||
+				qje.joinIndex_ != oqje.joinIndex_) {
+				return false;
+			}
+		}
+	}
+	if (!(mode & SkipJoinQueries)) {
+		if (joinQueries_.size() != other.joinQueries_.size()) return false;
+		for (size_t i = 0; i < joinQueries_.size(); ++i) {
+			const auto &jq = joinQueries_[i], &ojq = other.joinQueries_[i];
+			if (jq.joinType != ojq.joinType || !jq.IsEqual(ojq, WithJoinEntries)) return false;
+		}
+	}
+	if (!(mode & SkipMergeQueries)) {
+		if (mergeQueries_.size() != other.mergeQueries_.size()) return false;
+		for (size_t i = 0; i < mergeQueries_.size(); ++i) {
+			const auto &mq = mergeQueries_[i], &omq = other.mergeQueries_[i];
+			if (mq.joinType != omq.joinType || !mq.IsEqual(omq, mode | WithJoinEntries)) return false;
+		}
+	}
+	return true;
+}
+
+Query Query::MakeHoldingCopy(uint8_t mode) const {
+	Query copy(*this);
+	if (mode & SkipJoinQueries) copy.joinQueries_.clear();
+	if (mode & SkipMergeQueries) copy.mergeQueries_.clear();
+	const auto hold = [](Query &q) {
+		q.entries.HoldValues();
+		for (auto &v : q.forcedSortOrder_) v.EnsureHold();
+		for (auto &field : q.updateFields_) {
+			for (auto &v : field.values) v.EnsureHold();
+		}
+	};
+	hold(copy);
+	for (auto &jq : copy.joinQueries_) hold(jq);
+	for (auto &mq : copy.mergeQueries_) {
+		hold(mq);
+		for (auto &jq : mq.joinQueries_) hold(jq);
+	}
+	return copy;
+}
+
 void Query::Deserialize(Serializer &ser) {
 	_namespace = string(ser.GetVString());
 	bool hasJoinConditions = false;
@@ -522,8 +644,9 @@ void Query::WalkNested(bool withSelf, bool withMerged, std::function<void(const
 }
 
 bool Query::IsWALQuery() const noexcept {
-	if (entries.Size() == 1 && entries.HoldsOrReferTo<QueryEntry>(0) && kLsnIndexName == entries.Get<QueryEntry>(0).index) {
-		return true;
+	if (entries.Size() == 1 && entries.HoldsOrReferTo<QueryEntry>(0)) {
+		const auto &index = entries.Get<QueryEntry>(0).index;
+		return kLsnIndexName == index || kDataHashBucketsIndexName == index;
 	} else if (entries.Size() == 2 && entries.HoldsOrReferTo<QueryEntry>(0) && entries.HoldsOrReferTo<QueryEntry>(1)) {
 		const auto &index0 = entries.Get<QueryEntry>(0).index;
 		const auto &index1 = entries.Get<QueryEntry>(1).index;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <initializer_list>
 #include "core/keyvalue/geometry.h"
@@ -245,6 +246,28 @@ public:
 	}
 	Query &&DWithin(const string &idx, Point p, double distance) && { return std::move(DWithin(idx, p, distance)); }
 
+	/// Adds condition, which selects k items with the nearest vectors of the hnsw index (approximately).
+	/// Values of the condition are k, ef and components of the vector.
+	/// @param idx - name of the hnsw index.
+	/// @param vector - vector, which dimension is equal to the dimension of the index.
+	/// @param k - count of the nearest items. Other conditions are applied to these items.
+	/// @param ef - size of the candidates list of the search (accuracy). 0 means the default size.
+	Query &Knn(const string &idx, const std::vector<double> &vector, size_t k, size_t ef = 0) & {
+		QueryEntry qe;
+		qe.condition = CondKnn;
+		qe.index = idx;
+		qe.values.reserve(vector.size() + 2);
+		qe.values.emplace_back(int64_t(k));
+		qe.values.emplace_back(int64_t(ef));
+		for (double v : vector) qe.values.emplace_back(v);
+		entries.Append(nextOp_, std::move(qe));
+		nextOp_ = OpAnd;
+		return *this;
+	}
+	Query &&Knn(const string &idx, const std::vector<double> &vector, size_t k, size_t ef = 0) && {
+		return std::move(Knn(idx, vector, k, ef));
+	}
+
 	/// Sets a new value for a field.
 	/// @param field - field name.
 	/// @param value - new value.
@@ -484,6 +507,39 @@ public:
 	}
 	Query &&Strict(StrictMode mode) && { return std::move(Strict(mode)); }
 
+	/// Overrides namespace's parallel scan settings for this query.
+	/// ParallelScanOn allows parallel execution of the full scan regardless of parallel_scan_threshold, ParallelScanOff disables it.
+	/// @param mode - parallel scan mode.
+	/// @return Query object.
+	Query &ParallelScan(ParallelScanMode mode) & {
+		parallelScan = mode;
+		return *this;
+	}
+	Query &&ParallelScan(ParallelScanMode mode) && { return std::move(ParallelScan(mode)); }
+
+	/// Makes slave wait until the namespace's master LSN is applied, before the query execution.
+	/// Query fails with errTimeout, if LSN was not applied during the timeout. Ignored by the non-slave namespaces.
+	/// @param lsn - master's LSN of the item modification (e.g. Item::GetLSN() on master).
+	/// @param timeout - maximum time to wait.
+	/// @return Query object.
+	Query &WaitLSN(int64_t lsn, std::chrono::milliseconds timeout) & {
+		waitLSN = lsn;
+		waitLSNTimeoutMs = timeout.count();
+		return *this;
+	}
+	Query &&WaitLSN(int64_t lsn, std::chrono::milliseconds timeout) && { return std::move(WaitLSN(lsn, timeout)); }
+	bool HasWaitLSN() const noexcept { return waitLSN >= 0; }
+
+	/// Allows query to return the partial results instead of the timeout error, if its deadline is exceeded during the namespace scan.
+	/// Such results are marked as incomplete (QueryResults::incomplete). Explicit cancellation still fails the query.
+	/// @param on - enables or disables best-effort mode.
+	/// @return Query object.
+	Query &BestEffort(bool on = true) & {
+		bestEffort = on;
+		return *this;
+	}
+	Query &&BestEffort(bool on = true) && { return std::move(BestEffort(on)); }
+
 	/// Performs sorting by certain column. Analog to sql ORDER BY.
 	/// @param sort - sorting column name.
 	/// @param desc - is sorting direction descending or ascending.
@@ -675,6 +731,21 @@ public:
 	/// @param ser - serializer object.
 	void Deserialize(Serializer &ser);
 
+	/// Hash of the parts of the query, which are serialized in the mode (see Serialize). It's consistent with IsEqual
+	/// @param mode - serialization mode.
+	size_t Hash(uint8_t mode = Normal) const;
+
+	/// Compares the parts of the queries, which are serialized in the mode, without the serialization. Unlike operator==, the values
+	/// of the conditions are compared strictly with their types. Used by the keys of the query caches
+	/// @param other - query to compare with.
+	/// @param mode - serialization mode.
+	bool IsEqual(const Query &other, uint8_t mode = Normal) const;
+
+	/// Makes the copy of the parts of the query, which are serialized in the mode, so its values hold their strings and the copy
+	/// may outlive the source query (see Variant::View)
+	/// @param mode - serialization mode.
+	Query MakeHoldingCopy(uint8_t mode = Normal) const;
+
 	void WalkNested(bool withSelf, bool withMerged, std::function<void(const Query &q)> visitor) const;
 
 	bool HasLimit() const noexcept { return count != UINT_MAX; }
@@ -693,6 +764,10 @@ public:
 	unsigned count = UINT_MAX;				   /// Number of rows from result set.
 	int debugLevel = 0;						   /// Debug level.
 	StrictMode strictMode = StrictModeNotSet;  /// Strict mode.
+	ParallelScanMode parallelScan = ParallelScanNotSet;	 /// Parallel full scan mode.
+	int64_t waitLSN = -1;					   /// Master's LSN, which has to be applied by slave before the query execution.
+	unsigned waitLSNTimeoutMs = 0;			   /// Maximum time to wait for waitLSN.
+	bool bestEffort = false;				   /// Return partial results on the exceeded deadline.
 	bool explain_ = false;					   /// Explain query if true
 	CalcTotalMode calcTotal = ModeNoTotal;	   /// Calculation mode.
 	QueryType type_ = QuerySelect;			   /// Query type
@@ -33,7 +33,7 @@ std::string QueryEntry::Dump() const {
 
 BetweenFieldsQueryEntry::BetweenFieldsQueryEntry(std::string fstIdx, CondType cond, std::string sndIdx)
 	: firstIndex{std::move(fstIdx)}, secondIndex{std::move(sndIdx)}, condition_{cond} {
-	if (condition_ == CondAny || condition_ == CondEmpty || condition_ == CondDWithin) {
+	if (condition_ == CondAny || condition_ == CondEmpty || condition_ == CondDWithin || condition_ == CondKnn) {
 		throw Error{errLogic, "Condition '%s' is inapplicable between two fields", std::string{CondTypeToStr(condition_)}};
 	}
 }
@@ -49,6 +49,77 @@ std::string BetweenFieldsQueryEntry::Dump() const {
 	return std::string{ser.Slice()};
 }
 
+QueryEntries QueryEntries::MakeViewCopy() const {
+	QueryEntries result{makeCopy<QueryEntry>([](const QueryEntry &qe) {
+		QueryEntry copy(qe.condition, qe.index, qe.idxNo, qe.distinct);
+		copy.values = qe.values.View();
+		return copy;
+	})};
+	result.equalPositions = equalPositions;
+	return result;
+}
+
+void QueryEntries::HoldValues() {
+	ExecuteAppropriateForEach(Skip<JoinQueryEntry, QueryEntriesBracket, BetweenFieldsQueryEntry, AlwaysFalse>{}, [](QueryEntry &qe) {
+		for (Variant &v : qe.values) v.EnsureHold();
+	});
+}
+
+size_t QueryEntries::Hash() const {
+	size_t ret = equalPositions.size();
+	for (size_t i = 0; i < Size(); ++i) {
+		ret = (ret * 127) ^ (Size(i) << 2) ^ GetOperation(i);
+		InvokeAppropriate<void>(
+			i, [&ret](const QueryEntriesBracket &b) { ret = (ret * 127) ^ b.equalPositions.size(); },
+			[&ret](const QueryEntry &qe) {
+				ret = (ret * 127) ^ std::hash<std::string>()(qe.index) ^ (size_t(qe.condition) << 1) ^ size_t(qe.distinct);
+				for (const Variant &v : qe.values) ret = (ret * 127) ^ v.StrictHash();
+			},
+			[&ret](const JoinQueryEntry &jqe) { ret = (ret * 127) ^ jqe.joinIndex; },
+			[&ret](const BetweenFieldsQueryEntry &qe) {
+				ret = (ret * 127) ^ std::hash<std::string>()(qe.firstIndex) ^ (std::hash<std::string>()(qe.secondIndex) * 31) ^
+					  qe.Condition();
+			},
+			[&ret](const AlwaysFalse &) { ret = (ret * 127) ^ 1; });
+	}
+	return ret;
+}
+
+bool QueryEntries::IsEqual(const QueryEntries &other) const {
+	if (Size() != other.Size() || equalPositions != other.equalPositions) return false;
+	for (size_t i = 0; i < Size(); ++i) {
+		if (GetOperation(i) != other.GetOperation(i) || Size(i) != other.Size(i)) return false;
+		const bool equal = InvokeAppropriate<bool>(
+			i,
+			[&other, i](const QueryEntriesBracket &b) {
+				return other.IsSubTree(i) && b.equalPositions == other.Get<QueryEntriesBracket>(i).equalPositions;
+			},
+			[&other, i](const QueryEntry &qe) {
+				if (!other.HoldsOrReferTo<QueryEntry>(i)) return false;
+				const QueryEntry &oqe = other.Get<QueryEntry>(i);
+				if (qe.condition != oqe.condition || qe.distinct != oqe.distinct || qe.index != oqe.index ||
+					qe.values.size() != oqe.values.size()) {
+					return false;
+				}
+				for (size_t j = 0; j < qe.values.size(); ++j) {
+					if (!qe.values[j].IsStrictlyEqual(oqe.values[j])) return false;
+				}
+				return true;
+			},
+			[&other, i](const JoinQueryEntry &jqe) {
+				return other.HoldsOrReferTo<JoinQueryEntry>(i) && other.Get<JoinQueryEntry>(i).joinIndex == jqe.joinIndex;
+			},
+			[&other, i](const BetweenFieldsQueryEntry &qe) {
+				if (!other.HoldsOrReferTo<BetweenFieldsQueryEntry>(i)) return false;
+				const BetweenFieldsQueryEntry &oqe = other.Get<BetweenFieldsQueryEntry>(i);
+				return qe.Condition() == oqe.Condition() && qe.firstIndex == oqe.firstIndex && qe.secondIndex == oqe.secondIndex;
+			},
+			[&other, i](const AlwaysFalse &) { return other.HoldsOrReferTo<AlwaysFalse>(i); });
+		if (!equal) return false;
+	}
+	return true;
+}
+
 void QueryEntries::serialize(const_iterator it, const_iterator to, WrSerializer &ser) {
 	for (; it != to; ++it) {
 		const OpType op = it->operation;
@@ -263,6 +334,8 @@ bool QueryEntries::checkIfSatisfyCondition(const VariantArray &lValues, CondType
 				distance = rValues[0].As<double>();
 			}
 			return DWithin(static_cast<Point>(lValues), point, distance);
+		case CondType::CondKnn:
+			throw Error(errLogic, "Condition KNN can not be checked for the single item");
 		default:
 			assertrx(0);
 	}
@@ -107,6 +107,16 @@ public:
 	QueryEntries(const QueryEntries &) = default;
 	QueryEntries &operator=(QueryEntries &&) = default;
 	QueryEntries MakeLazyCopy() & { return {makeLazyCopy()}; }
+	/// Copy, which values of the conditions don't own their strings (see Variant::View), so it must not outlive the source
+	QueryEntries MakeViewCopy() const;
+	/// Makes the values of the conditions to hold their strings, so they don't depend on the source of the query values
+	void HoldValues();
+
+	/// Hash of the conditions, which is consistent with IsEqual
+	size_t Hash() const;
+	/// Compares the conditions and the equal positions. Unlike operator==, the values are compared strictly with their types
+	/// (see Variant::IsStrictlyEqual) and the numbers of the indexes are not compared
+	bool IsEqual(const QueryEntries &) const;
 
 	void ToDsl(const Query &parentQuery, JsonBuilder &builder) const { return toDsl(cbegin(), cend(), parentQuery, builder); }
 	void WriteSQLWhere(const Query &parentQuery, WrSerializer &, bool stripArgs) const;
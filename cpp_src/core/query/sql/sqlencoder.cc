@@ -306,6 +306,20 @@ void SQLEncoder::dumpWhereEntries(QueryEntries::const_iterator from, QueryEntrie
 						}
 						ser << ", ST_GeomFromText('POINT(" << point.x << ' ' << point.y << ")'), " << distance << ')';
 					}
+				} else if (entry.condition == CondKnn) {
+					ser << "KNN(";
+					indexToSql(entry.index, ser);
+					if (stripArgs) {
+						ser << ", ?, ?, ?)";
+					} else {
+						assertrx(entry.values.size() > 2);
+						ser << ", [";
+						for (size_t i = 2; i < entry.values.size(); ++i) {
+							if (i != 2) ser << ',';
+							ser << entry.values[i].As<string>();
+						}
+						ser << "], " << entry.values[0].As<string>() << ", " << entry.values[1].As<string>() << ')';
+					}
 				} else {
 					indexToSql(entry.index, ser);
 					ser << ' ' << entry.condition << ' ';
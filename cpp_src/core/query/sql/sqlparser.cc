@@ -12,7 +12,7 @@ namespace reindexer {
 
 using namespace std::string_view_literals;
 
-SQLParser::SQLParser(Query &query) : query_(query) {}
+SQLParser::SQLParser(Query &query, std::vector<SQLPlaceholder> *placeholders) : query_(query), placeholders_(placeholders) {}
 
 int SQLParser::Parse(std::string_view q) {
 	tokenizer parser(q);
@@ -627,6 +627,9 @@ int SQLParser::parseWhere(tokenizer &parser) {
 			} else if (iequals(tok.text(), "st_dwithin"sv)) {
 				parseDWithin(parser, nextOp);
 				nextOp = OpAnd;
+			} else if (iequals(tok.text(), "knn"sv) && parser.peek_token().text() == "("sv) {
+				parseKnn(parser, nextOp);
+				nextOp = OpAnd;
 			} else {
 				// Index name
 				const std::string index{tok.text()};
@@ -665,13 +668,19 @@ int SQLParser::parseWhere(tokenizer &parser) {
 					for (;;) {
 						tok = parser.next_token();
 						if (tok.text() == ")"sv && tok.type == TokenSymbol) break;
-						values.push_back(token2kv(tok, parser, true));
+						if (parsePlaceholder(tok, parser, values.size())) {
+							values.emplace_back();
+						} else {
+							values.push_back(token2kv(tok, parser, true));
+						}
 						tok = parser.next_token();
 						if (tok.text() == ")"sv) break;
 						if (tok.text() != ","sv)
 							throw Error(errParseSQL, "Expected ')' or ',', but found '%s' in query, %s", tok.text(), parser.where());
 					}
 					query_.entries.Append(nextOp, QueryEntry{index, condition, std::move(values)});
+				} else if (parsePlaceholder(tok, parser, 0)) {
+					query_.entries.Append(nextOp, QueryEntry{index, condition, {Variant()}});
 				} else if (tok.type != TokenName || toLower(tok.text()) == "true" || toLower(tok.text()) == "false") {
 					query_.entries.Append(nextOp, QueryEntry{index, condition, {token2kv(tok, parser, true)}});
 					// Second field
@@ -888,6 +897,126 @@ void SQLParser::parseDWithin(tokenizer &parser, OpType nextOp) {
 	query_.DWithin(field, point, distance.As<double>());
 }
 
+void SQLParser::parseKnn(tokenizer &parser, OpType nextOp) {
+	const auto expectSymbol = [&parser](std::string_view symbol) {
+		const auto tok = parser.next_token();
+		if (tok.text() != symbol) {
+			throw Error(errParseSQL, "Expected '%s', but found %s, %s", symbol, tok.text(), parser.where());
+		}
+	};
+	const auto parseNumber = [&parser](KeyValueType expectedType) {
+		const auto tok = parser.next_token();
+		const auto value = token2kv(tok, parser, false);
+		if (value.Type() != expectedType && (expectedType != KeyValueDouble || value.Type() != KeyValueInt64)) {
+			throw Error(errParseSQL, "Expected %s, but found %s, %s", expectedType == KeyValueDouble ? "number" : "integer", tok.text(),
+						parser.where());
+		}
+		return value;
+	};
+
+	expectSymbol("("sv);
+	auto tok = parser.next_token();
+	if (tok.type != TokenName) {
+		throw Error(errParseSQL, "Expected field name, but found %s, %s", tok.text(), parser.where());
+	}
+	const std::string field(tok.text());
+	expectSymbol(","sv);
+	expectSymbol("["sv);
+	std::vector<double> vector;
+	for (;;) {
+		vector.push_back(parseNumber(KeyValueDouble).As<double>());
+		tok = parser.next_token();
+		if (tok.text() == "]"sv) break;
+		if (tok.text() != ","sv) {
+			throw Error(errParseSQL, "Expected ']' or ',', but found %s, %s", tok.text(), parser.where());
+		}
+	}
+	expectSymbol(","sv);
+	const int64_t k = parseNumber(KeyValueInt64).As<int64_t>();
+	int64_t ef = 0;
+	tok = parser.next_token();
+	if (tok.text() == ","sv) {
+		ef = parseNumber(KeyValueInt64).As<int64_t>();
+		tok = parser.next_token();
+	}
+	if (tok.text() != ")"sv) {
+		throw Error(errParseSQL, "Expected ')', but found %s, %s", tok.text(), parser.where());
+	}
+	if (k <= 0 || ef < 0) {
+		throw Error(errParseSQL, "KNN expects positive k and not negative ef, %s", parser.where());
+	}
+
+	if (nextOp == OpOr) {
+		query_.Or();
+	} else if (nextOp == OpNot) {
+		query_.Not();
+	}
+	query_.Knn(field, vector, k, ef);
+}
+
+bool SQLParser::Parameterize(std::string_view sql, std::string &normalized, VariantArray &values) {
+	enum { Other, AfterCondition, InValuesList } state = Other;
+	normalized.clear();
+	values.clear();
+	try {
+		tokenizer parser(sql);
+		if (parser.next_token().text() != "select"sv) return false;
+		bool inWhere = false;
+		size_t copiedPos = 0;
+		for (;;) {
+			const size_t startPos = parser.getPos();
+			const auto tok = parser.next_token();
+			if (tok.type == TokenEnd) break;
+			const std::string_view text = tok.text();
+			if (tok.type == TokenName) {
+				if (text == "select"sv || text == "join"sv || text == "inner"sv || text == "left"sv || text == "merge"sv ||
+					text == "st_dwithin"sv || text == "knn"sv || text == "equal_position"sv) {
+					return false;
+				}
+				if (text == "where"sv) {
+					inWhere = true;
+				} else if (text == "order"sv || text == "limit"sv || text == "offset"sv) {
+					inWhere = false;
+				}
+			} else if (tok.type == TokenSymbol && (text == "?"sv || text == "{"sv)) {
+				return false;
+			}
+			if (!inWhere) continue;
+
+			if ((tok.type == TokenNumber || tok.type == TokenString) && state != Other) {
+				values.emplace_back(token2kv(tok, parser, false));
+				const size_t endPos = parser.getPos();
+				normalized.append(sql.substr(copiedPos, startPos - copiedPos)).append("?"sv);
+				if (endPos > startPos && isspace(sql[endPos - 1])) normalized.append(" "sv);
+				copiedPos = endPos;
+				if (state == AfterCondition) state = Other;
+			} else if (tok.type == TokenOp || (tok.type == TokenName && (text == "in"sv || text == "range"sv || text == "like"sv ||
+																		 text == "allset"sv))) {
+				state = AfterCondition;
+			} else if (tok.type == TokenSymbol && text == "("sv) {
+				// Brackets of the conditions and the functions are not supported
+				if (state != AfterCondition) return false;
+				state = InValuesList;
+			} else if (state == AfterCondition || (state == InValuesList && tok.type == TokenSymbol && text == ")"sv)) {
+				state = Other;
+			}
+		}
+		normalized.append(sql.substr(copiedPos));
+	} catch (const Error &) {
+		return false;
+	}
+	return true;
+}
+
+bool SQLParser::parsePlaceholder(const token &tok, tokenizer &parser, size_t valueIdx) {
+	if (tok.type != TokenSymbol || tok.text() != "?"sv) return false;
+	if (!placeholders_) {
+		throw Error(errParseSQL, "Placeholders are allowed only in WHERE clause of the prepared query, %s", parser.where());
+	}
+	placeholders_->push_back({query_.entries.Size(), valueIdx});
+	return true;
+}
+
 void SQLParser::parseJoin(JoinType type, tokenizer &parser) {
 	JoinedQuery jquery;
 	SQLParser jparser(jquery);
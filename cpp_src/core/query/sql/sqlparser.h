@@ -13,15 +13,34 @@ class JoinedQuery;
 struct SortingEntries;
 struct UpdateEntry;
 using EqualPosition_t = h_vector<std::string, 2>;
+
+/// Position of the '?' placeholder in the WHERE clause of the parsed query
+struct SQLPlaceholder {
+	/// Position of the QueryEntry in query.entries
+	size_t entry;
+	/// Index of the value in the QueryEntry
+	size_t value;
+};
+
 class SQLParser {
 public:
-	explicit SQLParser(Query &q);
+	/// @param q - query to fill
+	/// @param placeholders - positions of the '?' placeholders of values. If nullptr, placeholders are not allowed
+	explicit SQLParser(Query &q, std::vector<SQLPlaceholder> *placeholders = nullptr);
 
 	/// Parses pure sql select query and initializes Query object data members as a result.
 	/// @param q - sql query.
 	/// @return always returns 0.
 	int Parse(std::string_view q);
 
+	/// Replaces the literal values of the WHERE conditions of the plain select query by the '?' placeholders, so the queries, which
+	/// differ only by these values, are parsed once as the same prepared query.
+	/// @param sql - sql query.
+	/// @param normalized - query text with the placeholders.
+	/// @param values - replaced values in the order of the placeholders.
+	/// @return false, if the query is not supported (not a select, contains joins, merges, brackets, placeholders and so on).
+	static bool Parameterize(std::string_view sql, std::string &normalized, VariantArray &values);
+
 protected:
 	/// Sql parser context
 	struct SqlParsingCtx {
@@ -104,6 +123,7 @@ protected:
 
 	Point parseGeomFromText(tokenizer &parser) const;
 	void parseDWithin(tokenizer &parser, OpType nextOp);
+	void parseKnn(tokenizer &parser, OpType nextOp);
 
 	/// Parse update field entries
 	UpdateEntry parseUpdateField(tokenizer &parser);
@@ -114,9 +134,14 @@ protected:
 	/// Parse merge entries
 	void parseMerge(tokenizer &parser);
 
+	/// Registers the placeholder of the value, which is going to be appended to query entries
+	/// @return true, if token is the placeholder
+	bool parsePlaceholder(const token &tok, tokenizer &parser, size_t valueIdx);
+
 	static CondType getCondType(std::string_view cond);
 	SqlParsingCtx ctx_;
 	Query &query_;
+	std::vector<SQLPlaceholder> *placeholders_;
 };
 
 }  // namespace reindexer
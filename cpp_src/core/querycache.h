@@ -20,43 +20,87 @@ struct QueryCacheVal {
 	int total_count = -1;
 };
 
-struct QueryCacheKey {
-	QueryCacheKey() {}
-	QueryCacheKey(const QueryCacheKey& other) : buf(other.buf) {}
+/// Key of the caches of the queries. Key is hashed and compared by the structure of the query (see Query::Hash and Query::IsEqual)
+/// instead of its serialization. Key, which is made for the lookup, refers to the query, so it must not outlive it. Copy of the key,
+/// which is stored by the cache, holds the copy of the query
+class QueryCacheKey {
+public:
+	static constexpr uint8_t kDefaultMode = SkipJoinQueries | SkipMergeQueries | SkipLimitOffset;
+
+	QueryCacheKey() = default;
+	/// @param q - query of the key
+	/// @param mode - parts of the query, which are the part of the key (see QuerySerializeMode). WithJoinEntries is not supported
+	QueryCacheKey(const Query& q, uint8_t mode = kDefaultMode) : query_(&q), hash_(q.Hash(mode)), mode_(mode) {
+		assertrx(!(mode & WithJoinEntries));
+	}
+	/// Key of the temporary query holds its copy
+	QueryCacheKey(Query&& q, uint8_t mode = kDefaultMode) : QueryCacheKey(static_cast<const Query&>(q), mode) { hold(); }
+	QueryCacheKey(const QueryCacheKey& other)
+		: query_(other.query_), heldQuery_(other.heldQuery_), hash_(other.hash_), size_(other.size_), mode_(other.mode_) {
+		hold();
+	}
+	QueryCacheKey(QueryCacheKey&&) noexcept = default;
 	QueryCacheKey& operator=(const QueryCacheKey& other) {
 		if (this != &other) {
-			buf = other.buf;
+			query_ = other.query_;
+			heldQuery_ = other.heldQuery_;
+			hash_ = other.hash_;
+			size_ = other.size_;
+			mode_ = other.mode_;
+			hold();
 		}
 		return *this;
 	}
-	QueryCacheKey(const Query& q) {
-		WrSerializer ser;
-		q.Serialize(ser, (SkipJoinQueries | SkipMergeQueries | SkipLimitOffset));
-		buf.reserve(ser.Len());
-		buf.assign(ser.Buf(), ser.Buf() + ser.Len());
+	QueryCacheKey& operator=(QueryCacheKey&&) noexcept = default;
+
+	bool operator==(const QueryCacheKey& other) const {
+		if (hash_ != other.hash_ || mode_ != other.mode_) return false;
+		if (query_ == other.query_) return true;
+		return query_ && other.query_ && query_->IsEqual(*other.query_, mode_);
 	}
-	size_t Size() const { return sizeof(QueryCacheKey) + (buf.is_hdata() ? 0 : buf.size()); }
+	size_t Hash() const noexcept { return hash_; }
+	size_t Size() const noexcept { return sizeof(QueryCacheKey) + size_; }
 
-	QueryCacheKey(WrSerializer& ser) : buf(ser.Buf(), ser.Buf() + ser.Len()) {}
-	h_vector<uint8_t, 256> buf;
+private:
+	void hold() {
+		if (heldQuery_ || !query_) return;
+		heldQuery_ = std::make_shared<const Query>(query_->MakeHoldingCopy(mode_));
+		query_ = heldQuery_.get();
+		size_ = approxSize(*query_);
+	}
+	static size_t approxSize(const Query& q) {
+		size_t size = sizeof(Query) + q._namespace.size() + q.entries.Size() * sizeof(QueryEntry);
+		q.entries.ExecuteAppropriateForEach(Skip<JoinQueryEntry, QueryEntriesBracket, BetweenFieldsQueryEntry, AlwaysFalse>{},
+											[&size](const QueryEntry& qe) {
+												size += qe.index.size() + qe.values.size() * sizeof(Variant);
+												for (const Variant& v : qe.values) {
+													if (v.Type() == KeyValueString) size += std::string_view(v).size();
+												}
+											});
+		for (const auto& jq : q.joinQueries_) size += approxSize(jq);
+		for (const auto& mq : q.mergeQueries_) size += approxSize(mq);
+		return size;
+	}
+
+	const Query* query_ = nullptr;
+	std::shared_ptr<const Query> heldQuery_;
+	size_t hash_ = 0;
+	size_t size_ = 0;
+	uint8_t mode_ = kDefaultMode;
 };
 
 struct EqQueryCacheKey {
-	bool operator()(const QueryCacheKey& lhs, const QueryCacheKey& rhs) const {
-		return (lhs.buf.size() == rhs.buf.size()) && (memcmp(lhs.buf.data(), rhs.buf.data(), lhs.buf.size()) == 0);
-	}
+	bool operator()(const QueryCacheKey& lhs, const QueryCacheKey& rhs) const { return lhs == rhs; }
 };
 
 struct HashQueryCacheKey {
-	size_t operator()(const QueryCacheKey& q) const {
-		uint64_t hash[2];
-		MurmurHash3_x64_128(q.buf.data(), q.buf.size(), 0, &hash);
-		return hash[0];
-	}
+	size_t operator()(const QueryCacheKey& q) const noexcept { return q.Hash(); }
 };
 
 struct QueryCache : LRUCache<QueryCacheKey, QueryCacheVal, HashQueryCacheKey, EqQueryCacheKey> {
-	QueryCache(size_t sizeLimit = kDefaultCacheSizeLimit, int hitCount = kDefaultHitCountToCache) : LRUCache(sizeLimit, hitCount) {}
+	QueryCache(size_t sizeLimit = kDefaultCacheSizeLimit, int hitCount = kDefaultHitCountToCache,
+			   size_t shardsCount = kDefaultCacheShardsCount, LRUCacheEvictionMode mode = LRUCacheEvictionMode::LRU)
+		: LRUCache(sizeLimit, hitCount, shardsCount, mode) {}
 };
 
 }  // namespace reindexer
@@ -51,6 +51,10 @@ std::string_view AggregationResult::aggTypeToStr(AggType type) {
 			return "count"sv;
 		case AggCountCached:
 			return "count_cached"sv;
+		case AggApproxCountDistinct:
+			return "approx_count_distinct"sv;
+		case AggQuantile:
+			return "quantile"sv;
 		default:
 			return "?"sv;
 	}
@@ -73,6 +77,10 @@ AggType AggregationResult::strToAggType(std::string_view type) {
 		return AggCount;
 	} else if (type == "count_cached"sv) {
 		return AggCountCached;
+	} else if (type == "approx_count_distinct"sv) {
+		return AggApproxCountDistinct;
+	} else if (type == "quantile"sv) {
+		return AggQuantile;
 	}
 	return AggUnknown;
 }
@@ -0,0 +1,111 @@
+#include "columnarencoder.h"
+#include "core/cjson/jsonbuilder.h"
+#include "core/cjson/msgpackbuilder.h"
+#include "core/payload/payloadiface.h"
+#include "core/type_consts_helpers.h"
+#include "estl/fast_hash_map.h"
+#include "queryresults.h"
+
+namespace reindexer {
+
+ColumnarEncoder::ColumnarEncoder(const QueryResults &qr, size_t offset, size_t limit)
+	: qr_(qr), begin_(std::min(offset, qr.Count())), end_(begin_ + std::min(limit, qr.Count() - begin_)) {
+	if (begin_ == end_) return;
+	const auto &items = qr.Items();
+	for (size_t i = begin_; i < end_; ++i) {
+		if (items[i].Raw()) throw Error(errParams, "Columnar output is not supported for WAL query results");
+		if (items[i].Nsid() != 0) throw Error(errParams, "Columnar output is not supported for merged query results");
+	}
+	const PayloadType &type = qr.getPayloadType(0);
+	const FieldsSet &filter = qr.getFieldsFilter(0);
+	// Field 0 is tuple with non indexed fields
+	for (int field = 1; field < type.NumFields(); ++field) {
+		if (filter.empty() || filter.contains(field)) fields_.push_back(field);
+	}
+}
+
+template <typename Builder>
+void ColumnarEncoder::Encode(Builder &builder, std::string_view name) const {
+	auto root = builder.Object(name, 2);
+	root.Put("rows", int64_t(Rows()));
+	auto fieldsArray = root.Array("fields", fields_.size());
+	for (int field : fields_) {
+		const PayloadFieldType &fieldType = qr_.getPayloadType(0).Field(field);
+		const bool isString = fieldType.Type() == KeyValueString;
+		auto column = fieldsArray.Object(std::string_view(), isString ? 4 : 3);
+		column.Put("name", fieldType.Name());
+		column.Put("type", KeyValueTypeToStr(fieldType.Type()));
+		if (isString) {
+			encodeDictionary(column, field);
+		} else {
+			encodeValues(column, field);
+		}
+	}
+}
+
+template <typename Builder>
+void ColumnarEncoder::encodeValues(Builder &column, int field) const {
+	const auto &items = qr_.Items();
+	const PayloadType &type = qr_.getPayloadType(0);
+	const bool isArray = type.Field(field).IsArray();
+	VariantArray values;
+	auto valuesArray = column.Array("values", Rows());
+	for (size_t i = begin_; i < end_; ++i) {
+		ConstPayload pl(type, items[i].Value());
+		if (isArray) {
+			pl.Get(field, values);
+			auto rowArray = valuesArray.Array(std::string_view(), values.size());
+			for (const Variant &v : values) rowArray.Put(std::string_view(), v);
+		} else {
+			valuesArray.Put(std::string_view(), pl.Field(field).Get());
+		}
+	}
+}
+
+template <typename Builder>
+void ColumnarEncoder::encodeDictionary(Builder &column, int field) const {
+	const auto &items = qr_.Items();
+	const PayloadType &type = qr_.getPayloadType(0);
+	const bool isArray = type.Field(field).IsArray();
+	// Strings are held by the payloads of the query results, so the dictionary does not copy them
+	fast_hash_map<std::string_view, int> dictionary;
+	std::vector<std::string_view> strings;
+	std::vector<int> indices;
+	std::vector<size_t> rowSizes;
+	VariantArray values;
+	auto addString = [&](const Variant &v) {
+		const auto res = dictionary.emplace(std::string_view(v), int(strings.size()));
+		if (res.second) strings.emplace_back(res.first->first);
+		indices.push_back(res.first->second);
+	};
+	for (size_t i = begin_; i < end_; ++i) {
+		ConstPayload pl(type, items[i].Value());
+		if (isArray) {
+			pl.Get(field, values);
+			rowSizes.push_back(values.size());
+			for (const Variant &v : values) addString(v);
+		} else {
+			addString(pl.Field(field).Get());
+		}
+	}
+
+	auto dictionaryArray = column.Array("dictionary", strings.size());
+	for (std::string_view s : strings) dictionaryArray.Put(std::string_view(), s);
+	dictionaryArray.End();
+
+	auto indicesArray = column.Array("indices", Rows());
+	if (isArray) {
+		auto it = indices.cbegin();
+		for (size_t rowSize : rowSizes) {
+			auto rowArray = indicesArray.Array(std::string_view(), rowSize);
+			for (size_t j = 0; j < rowSize; ++j) rowArray.Put(std::string_view(), *it++);
+		}
+	} else {
+		for (int idx : indices) indicesArray.Put(std::string_view(), idx);
+	}
+}
+
+template void ColumnarEncoder::Encode<JsonBuilder>(JsonBuilder &, std::string_view) const;
+template void ColumnarEncoder::Encode<MsgPackBuilder>(MsgPackBuilder &, std::string_view) const;
+
+}  // namespace reindexer
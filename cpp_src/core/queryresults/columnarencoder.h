@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace reindexer {
+
+class QueryResults;
+
+/// Encodes indexed fields of the query results by columns: each field is written once with the array of its values for all of the
+/// rows. Values are read directly from the payloads, so the tuples are not decoded. Strings are dictionary encoded: column contains
+/// unique strings and indexes of the strings for each row.
+/// Output object: {"rows": N, "fields": [{"name": "id", "type": "int", "values": [...]},
+///                                       {"name": "name", "type": "string", "dictionary": [...], "indices": [...]}]}
+/// Values of array fields are arrays of values for each row
+class ColumnarEncoder {
+public:
+	/// @param qr - query results of the single namespace. Merged and WAL results are not supported (Error is thrown)
+	/// @param offset - first row to encode
+	/// @param limit - max count of rows to encode
+	ColumnarEncoder(const QueryResults &qr, size_t offset, size_t limit);
+
+	/// Writes columns object into builder
+	/// @param builder - parent JsonBuilder or MsgPackBuilder
+	/// @param name - name of the columns object
+	template <typename Builder>
+	void Encode(Builder &builder, std::string_view name) const;
+
+	size_t Rows() const noexcept { return end_ - begin_; }
+
+private:
+	template <typename Builder>
+	void encodeValues(Builder &column, int field) const;
+	template <typename Builder>
+	void encodeDictionary(Builder &column, int field) const;
+
+	const QueryResults &qr_;
+	size_t begin_, end_;
+	std::vector<int> fields_;
+};
+
+}  // namespace reindexer
@@ -12,14 +12,17 @@ namespace reindexer {
 
 void QueryResults::AddNamespace(std::shared_ptr<NamespaceImpl> ns, const NsContext &ctx) {
 	assertrx(ctx.noLock);
-	const NamespaceImpl *nsPtr = ns.get();
 	auto strHolder = ns->StrHolder(ctx);
-	const auto it =
-		std::find_if(nsData_.cbegin(), nsData_.cend(), [nsPtr](const NsDataHolder &nsData) { return nsData.ns.get() == nsPtr; });
-	if (it != nsData_.cend()) {
-		assertrx(it->strHolder.get() == strHolder.get());
-		return;
-	}
+	AddNamespace(std::move(ns), std::move(strHolder));
+}
+
+void QueryResults::AddNamespace(std::shared_ptr<NamespaceImpl> ns, StringsHolderPtr strHolder) {
+	const NamespaceImpl *nsPtr = ns.get();
+	// Namespace may replace its strings holder between the chunks of the chunked deletion, so the results hold all of them
+	const auto it = std::find_if(nsData_.cbegin(), nsData_.cend(), [nsPtr, &strHolder](const NsDataHolder &nsData) {
+		return nsData.ns.get() == nsPtr && nsData.strHolder.get() == strHolder.get();
+	});
+	if (it != nsData_.cend()) return;
 	nsData_.emplace_back(std::move(ns), std::move(strHolder));
 }
 
@@ -52,6 +55,7 @@ QueryResults::QueryResults(QueryResults &&obj)
 	  haveRank(obj.haveRank),
 	  nonCacheableData(obj.nonCacheableData),
 	  needOutputRank(obj.needOutputRank),
+	  incomplete(obj.incomplete),
 	  ctxs(std::move(obj.ctxs)),
 	  explainResults(std::move(obj.explainResults)),
 	  items_(std::move(obj.items_)),
@@ -70,6 +74,7 @@ QueryResults &QueryResults::operator=(QueryResults &&obj) noexcept {
 		totalCount = obj.totalCount;
 		haveRank = obj.haveRank;
 		needOutputRank = obj.needOutputRank;
+		incomplete = obj.incomplete;
 		ctxs = std::move(obj.ctxs);
 		nonCacheableData = std::move(obj.nonCacheableData);
 		explainResults = std::move(obj.explainResults);
@@ -88,8 +93,30 @@ QueryResults::~QueryResults() = default;
 
 void QueryResults::Clear() { *this = QueryResults(); }
 
+void QueryResults::CopyResultsFrom(const QueryResults &other) {
+	items_ = other.items_;
+	joined_ = other.joined_;
+	aggregationResults = other.aggregationResults;
+	totalCount = other.totalCount;
+	haveRank = other.haveRank;
+	needOutputRank = other.needOutputRank;
+	incomplete = other.incomplete;
+	ctxs = other.ctxs;
+	nonCacheableData = other.nonCacheableData;
+	explainResults = other.explainResults;
+	stringsHolder_ = other.stringsHolder_;
+}
+
 void QueryResults::Erase(ItemRefVector::iterator start, ItemRefVector::iterator finish) { items_.erase(start, finish); }
 
+void QueryResults::ReleaseItemsData(size_t begin, size_t end) {
+	end = std::min(end, size_t(items_.size()));
+	for (size_t i = begin; i < end; ++i) {
+		auto &itemRef = items_[i];
+		if (itemRef.ValueInitialized()) itemRef.Value() = PayloadValue();
+	}
+}
+
 void QueryResults::Add(const ItemRef &i) { items_.push_back(i); }
 
 std::string QueryResults::Dump() const {
@@ -367,6 +394,22 @@ void QueryResults::AddItem(Item &item, bool withData, bool enableHold) {
 	}
 }
 
+void QueryResults::AddDetached(const PayloadType &type, const ItemRef &item) {
+	PayloadValue value(item.Value());
+	value.Clone();
+	Payload pl(type, value);
+	VariantArray krs;
+	for (int field : type.StrFields()) {
+		pl.Get(field, krs);
+		for (Variant &kr : krs) {
+			stringsHolder_.emplace_back(make_key_string(std::string_view(kr)));
+			kr = Variant(stringsHolder_.back());
+		}
+		pl.Set(field, krs, false);
+	}
+	Add(ItemRef(item.Id(), value));
+}
+
 const TagsMatcher &QueryResults::getTagsMatcher(int nsid) const {
 	assertrx(nsid < int(ctxs.size()));
 	return ctxs[nsid].tagsMatcher_;
@@ -44,13 +44,21 @@ public:
 	// or if data from the item are contained in namespace added to the queryResults
 	// enableHold is ignored when withData = false
 	void AddItem(Item &item, bool withData = false, bool enableHold = true);
+	// Adds the item, which is not held by any namespace (e.g. read directly from the storage). Strings of the item are copied and held by
+	// the results
+	void AddDetached(const PayloadType &type, const ItemRef &item);
 	std::string Dump() const;
 	void Erase(ItemRefVector::iterator begin, ItemRefVector::iterator end);
+	// Releases payloads, held by the items in [begin, end). Items' ids are kept, but their data must not be accessed anymore
+	void ReleaseItemsData(size_t begin, size_t end);
 	size_t Count() const { return items_.size(); }
 	size_t TotalCount() const { return totalCount; }
 	const std::string &GetExplainResults() const { return explainResults; }
 	const std::vector<AggregationResult> &GetAggregationResults() const { return aggregationResults; }
 	void Clear();
+	// Copies the items, joined items, aggregations and contexts of the other results. Holders of the namespaces' data and the activity
+	// context are not copied, so the namespaces of the copy have to be added separately
+	void CopyResultsFrom(const QueryResults &other);
 	h_vector<std::string_view, 1> GetNamespaces() const;
 	bool IsCacheEnabled() const { return !nonCacheableData; }
 
@@ -89,6 +97,8 @@ public:
 	bool haveRank = false;
 	bool nonCacheableData = false;
 	bool needOutputRank = false;
+	// Deadline of the best-effort query was exceeded, so only the part of the matched items is returned and the total may be inaccurate
+	bool incomplete = false;
 
 	struct Context;
 	// precalc context size
@@ -115,6 +125,8 @@ public:
 	const ItemRefVector &Items() const { return items_; }
 	int GetJoinedNsCtxIndex(int nsid) const;
 	void AddNamespace(std::shared_ptr<NamespaceImpl>, const NsContext &);
+	// Namespace is not locked by the caller, so its strings holder is passed explicitly (see PointReadsCache)
+	void AddNamespace(std::shared_ptr<NamespaceImpl>, StringsHolderPtr);
 	void RemoveNamespace(const NamespaceImpl *ns);
 	bool IsNamespaceAdded(const NamespaceImpl *ns) const noexcept {
 		return std::find_if(nsData_.cbegin(), nsData_.cend(), [ns](const NsDataHolder &nsData) { return nsData.ns.get() == ns; }) !=
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include "core/querycache.h"
+#include "core/queryresults/joinresults.h"
+#include "core/queryresults/queryresults.h"
+
+namespace reindexer {
+
+/// Data versions of the namespaces, which are used by the query (main, merged and joined ones), in ascending order.
+/// Each modification of the namespace assigns it the new version, unique among all the namespaces
+using NsDataVersions = h_vector<uint64_t, 4>;
+
+struct QueryResultsCacheVal {
+	struct Snapshot {
+		QueryResults results;
+		NsDataVersions versions;
+		size_t size = 0;
+	};
+
+	size_t Size() const noexcept { return snapshot ? snapshot->size : 0; }
+
+	std::shared_ptr<const Snapshot> snapshot;
+};
+
+/// Cache of the full results of the selects (see 'query_results_cache_size' of the namespace config).
+/// Key is the whole query including its joins, merges, limit and offset. Cached results are returned only if none of the namespaces
+/// of the query were modified since the results were stored
+class QueryResultsCache : public LRUCache<QueryCacheKey, QueryResultsCacheVal, HashQueryCacheKey, EqQueryCacheKey> {
+public:
+	QueryResultsCache(size_t sizeLimit) : LRUCache(sizeLimit) {}
+
+	/// Copies the cached results of the query to the results
+	/// @return false, if the query has no actual results in the cache. Entry for its results is created after the several misses
+	bool GetResults(const QueryCacheKey &key, const NsDataVersions &versions, QueryResults &result) {
+		const auto it = Get(key);
+		if (!it.valid || !it.val.snapshot || it.val.snapshot->versions != versions) {
+			misses_.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		hits_.fetch_add(1, std::memory_order_relaxed);
+		result.CopyResultsFrom(it.val.snapshot->results);
+		return true;
+	}
+	void PutResults(const QueryCacheKey &key, const NsDataVersions &versions, const QueryResults &result) {
+		auto snapshot = std::make_shared<QueryResultsCacheVal::Snapshot>();
+		snapshot->results.CopyResultsFrom(result);
+		snapshot->versions = versions;
+		// Payloads of the items are shared with the namespaces, so only the references to them are counted
+		snapshot->size = sizeof(QueryResultsCacheVal::Snapshot) + result.Count() * sizeof(ItemRef) + result.GetExplainResults().size();
+		for (const auto &joined : result.joined_) snapshot->size += joined.TotalItems() * sizeof(ItemRef);
+		Put(key, QueryResultsCacheVal{std::move(snapshot)});
+	}
+	LRUCacheMemStat GetMemStat() {
+		LRUCacheMemStat ret = LRUCache::GetMemStat();
+		ret.hitsCount = hits_.load(std::memory_order_relaxed);
+		ret.missesCount = misses_.load(std::memory_order_relaxed);
+		return ret;
+	}
+
+private:
+	std::atomic<size_t> hits_ = {0}, misses_ = {0};
+};
+
+}  // namespace reindexer
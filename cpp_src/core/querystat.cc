@@ -45,6 +45,10 @@ void QueryPerfStat::GetJSON(WrSerializer &ser) const {
 	builder.Put("latency_stddev", perf.stddev);
 	builder.Put("min_latency_us", perf.minTimeUs);
 	builder.Put("max_latency_us", perf.maxTimeUs);
+	builder.Put("latency_p50_us", perf.p50TimeUs);
+	builder.Put("latency_p90_us", perf.p90TimeUs);
+	builder.Put("latency_p99_us", perf.p99TimeUs);
+	builder.Put("latency_p999_us", perf.p999TimeUs);
 	builder.Put("longest_query", longestQuery);
 }
 
@@ -0,0 +1,65 @@
+#include "querytrace.h"
+
+#include <thread>
+#include "core/cjson/jsonbuilder.h"
+
+namespace reindexer {
+
+void QueryTrace::AddSpan(std::string_view stage, std::string_view ns, Clock::time_point begin, Clock::time_point end) {
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	spans_.push_back(
+		{stage, std::string(ns), duration_cast<microseconds>(begin - start_).count(), duration_cast<microseconds>(end - begin).count()});
+}
+
+void QueryTrace::Finish(std::string_view error) {
+	totalUs_ = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_).count();
+	error_ = std::string(error);
+}
+
+void QueryTrace::GetJSON(WrSerializer &ser) const {
+	JsonBuilder builder(ser);
+	builder.Put("id", int64_t(id));
+	builder.Put("query", query_);
+	builder.Put("start_time_us", std::chrono::duration_cast<std::chrono::microseconds>(startTime_.time_since_epoch()).count());
+	builder.Put("total_us", totalUs_);
+	if (!error_.empty()) builder.Put("error", error_);
+	auto arr = builder.Array("spans");
+	for (const auto &span : spans_) {
+		auto obj = arr.Object();
+		obj.Put("stage", span.stage);
+		if (!span.ns.empty()) obj.Put("namespace", span.ns);
+		obj.Put("start_us", span.startUs);
+		obj.Put("duration_us", span.durationUs);
+	}
+}
+
+bool QueryTracer::NeedTrace(double sampleRate) noexcept {
+	if (sampleRate <= 0.0) return false;
+	if (sampleRate >= 1.0) return true;
+	// Xorshift generator per thread: sampling decision must not contend on the shared state
+	thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return double(state >> 11) * (1.0 / double(uint64_t(1) << 53)) < sampleRate;
+}
+
+void QueryTracer::Add(QueryTrace &&trace) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	trace.id = nextId_++;
+	if (traces_.size() >= kMaxTraces) traces_.pop_front();
+	traces_.emplace_back(std::move(trace));
+}
+
+std::vector<QueryTrace> QueryTracer::Data() const {
+	std::lock_guard<std::mutex> lck(mtx_);
+	return {traces_.begin(), traces_.end()};
+}
+
+void QueryTracer::Reset() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	traces_.clear();
+}
+
+}  // namespace reindexer
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace reindexer {
+
+class WrSerializer;
+
+/// Timings of the stages of one query execution. Each span has the start offset from the beginning of the query and duration, so the
+/// trace may be converted into the spans of the external tracing system
+class QueryTrace {
+public:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	struct Span {
+		std::string_view stage;
+		std::string ns;
+		int64_t startUs;
+		int64_t durationUs;
+	};
+
+	explicit QueryTrace(std::string query) : query_(std::move(query)), startTime_(std::chrono::system_clock::now()), start_(Clock::now()) {}
+
+	/// @param stage - name of the stage. Must be a string literal
+	void AddSpan(std::string_view stage, std::string_view ns, Clock::time_point begin, Clock::time_point end);
+	void Finish(std::string_view error = {});
+	void GetJSON(WrSerializer &ser) const;
+
+	uint64_t id = 0;
+
+private:
+	std::string query_;
+	std::string error_;
+	std::chrono::system_clock::time_point startTime_;
+	Clock::time_point start_;
+	int64_t totalUs_ = 0;
+	std::vector<Span> spans_;
+};
+
+/// Measures the time of the scope as a span of the trace. Does nothing, if the query is not traced
+class QueryTraceSpan {
+public:
+	QueryTraceSpan(QueryTrace *trace, std::string_view stage, std::string_view ns = {}) : trace_(trace), stage_(stage), ns_(ns) {
+		if (trace_) begin_ = QueryTrace::Clock::now();
+	}
+	~QueryTraceSpan() {
+		if (trace_) trace_->AddSpan(stage_, ns_, begin_, QueryTrace::Clock::now());
+	}
+	QueryTraceSpan(const QueryTraceSpan &) = delete;
+	QueryTraceSpan &operator=(const QueryTraceSpan &) = delete;
+
+private:
+	QueryTrace *trace_;
+	std::string_view stage_;
+	std::string_view ns_;
+	QueryTrace::Clock::time_point begin_;
+};
+
+/// Keeps the last kMaxTraces traces of the sampled queries for #querytraces
+class QueryTracer {
+public:
+	static constexpr size_t kMaxTraces = 1000;
+
+	/// @param sampleRate - part of the queries to trace in [0, 1]
+	/// @return true, if the next query has to be traced
+	static bool NeedTrace(double sampleRate) noexcept;
+	void Add(QueryTrace &&trace);
+	std::vector<QueryTrace> Data() const;
+	void Reset();
+
+private:
+	mutable std::mutex mtx_;
+	std::deque<QueryTrace> traces_;
+	uint64_t nextId_ = 1;
+};
+
+}  // namespace reindexer
@@ -36,6 +36,16 @@ void ThrowOnCancel(const Context& ctx, std::string_view errMsg = std::string_vie
 	}
 }
 
+/// Same as ThrowOnCancel, but the exceeded deadline of the operation, which may be completed with the partial results, is not an error.
+/// Returns true in this case
+template <typename Context>
+bool CheckDeadline(const Context& ctx, bool bestEffort) {
+	if (!ctx.isCancelable()) return false;
+	if (bestEffort && ctx.checkCancel() == CancelType::Timeout) return true;
+	ThrowOnCancel(ctx);
+	return false;
+}
+
 class RdxDeadlineContext : public IRdxCancelContext {
 public:
 	using ClockT = std::chrono::steady_clock;
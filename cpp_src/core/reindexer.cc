@@ -36,9 +36,15 @@ Error Reindexer::Insert(std::string_view nsName, Item& item, QueryResults& qr) {
 Error Reindexer::Update(std::string_view nsName, Item& item, QueryResults& qr) { return impl_->Update(nsName, item, qr, ctx_); }
 Error Reindexer::Upsert(std::string_view nsName, Item& item, QueryResults& qr) { return impl_->Upsert(nsName, item, qr, ctx_); }
 Error Reindexer::Delete(std::string_view nsName, Item& item, QueryResults& qr) { return impl_->Delete(nsName, item, qr, ctx_); }
+Error Reindexer::ModifyItems(std::string_view nsName, span<Item> items, ItemModifyMode mode, span<Error> itemsErrors) {
+	return impl_->ModifyItems(nsName, items, mode, itemsErrors, ctx_);
+}
 Item Reindexer::NewItem(std::string_view nsName) { return impl_->NewItem(nsName, ctx_); }
 Transaction Reindexer::NewTransaction(std::string_view nsName) { return impl_->NewTransaction(nsName, ctx_); }
 Error Reindexer::CommitTransaction(Transaction& tr, QueryResults& result) { return impl_->CommitTransaction(tr, result, ctx_); }
+Error Reindexer::CommitTransactions(span<Transaction> txs, span<QueryResults> results) {
+	return impl_->CommitTransactions(txs, results, ctx_);
+}
 Error Reindexer::RollBackTransaction(Transaction& tr) { return impl_->RollBackTransaction(tr); }
 Error Reindexer::GetMeta(std::string_view nsName, const string& key, string& data) { return impl_->GetMeta(nsName, key, data, ctx_); }
 Error Reindexer::PutMeta(std::string_view nsName, const string& key, std::string_view data) {
@@ -47,7 +53,13 @@ Error Reindexer::PutMeta(std::string_view nsName, const string& key, std::string
 Error Reindexer::EnumMeta(std::string_view nsName, vector<string>& keys) { return impl_->EnumMeta(nsName, keys, ctx_); }
 Error Reindexer::Delete(const Query& q, QueryResults& result) { return impl_->Delete(q, result, ctx_); }
 Error Reindexer::Select(std::string_view query, QueryResults& result) { return impl_->Select(query, result, ctx_); }
+Error Reindexer::Select(std::string_view query, const VariantArray& params, QueryResults& result) {
+	return impl_->Select(query, params, result, ctx_);
+}
 Error Reindexer::Select(const Query& q, QueryResults& result) { return impl_->Select(q, result, ctx_); }
+Error Reindexer::GetByPK(std::string_view nsName, const VariantArray& keys, QueryResults& result) {
+	return impl_->GetByPK(nsName, keys, result, ctx_);
+}
 Error Reindexer::Update(const Query& query, QueryResults& result) { return impl_->Update(query, result, ctx_); }
 Error Reindexer::Commit(std::string_view nsName) { return impl_->Commit(nsName); }
 Error Reindexer::AddIndex(std::string_view nsName, const IndexDef& idx) { return impl_->AddIndex(nsName, idx, ctx_); }
@@ -63,11 +75,13 @@ Error Reindexer::SubscribeUpdates(IUpdatesObserver* observer, const UpdatesFilte
 	return impl_->SubscribeUpdates(observer, filters, opts);
 }
 Error Reindexer::GetProtobufSchema(WrSerializer& ser, vector<string>& namespaces) { return impl_->GetProtobufSchema(ser, namespaces); }
+Error Reindexer::GetNamespacesMetrics(std::vector<NamespaceMetrics>& metrics) { return impl_->GetNamespacesMetrics(metrics, ctx_); }
 Error Reindexer::UnsubscribeUpdates(IUpdatesObserver* observer) { return impl_->UnsubscribeUpdates(observer); }
 Error Reindexer::GetSqlSuggestions(const std::string_view sqlQuery, int pos, vector<string>& suggestions) {
 	return impl_->GetSqlSuggestions(sqlQuery, pos, suggestions, ctx_);
 }
 Error Reindexer::Status() { return impl_->Status(); }
+bool Reindexer::IsWarmedUp() const { return impl_->IsWarmedUp(); }
 
 Error Reindexer::DumpIndex(std::ostream& os, std::string_view nsName, std::string_view index) {
 	return impl_->DumpIndex(os, nsName, index, ctx_);
@@ -18,6 +18,7 @@ class IUpdatesObserver;
 class IClientsStats;
 class ProtobufSchema;
 class UpdatesFilters;
+struct NamespaceMetrics;
 
 /// The main Reindexer interface. Holds database object<br>
 /// *Thread safety*: All methods of Reindexer are thread safe. <br>
@@ -157,6 +158,15 @@ public:
 	/// @param item - Item, obtained by call to NewItem of the same namespace
 	/// @param result - QueryResults with deleted item.
 	Error Delete(std::string_view nsName, Item &item, QueryResults &result);
+	/// Insert, update, upsert or delete the batch of items under the single namespace lock.
+	/// Each modified item gets its internal ID as after the single item call. Batch is applied completely, even if some of the items
+	/// can not be modified. Items of the system namespaces are modified one by one
+	/// @param nsName - Name of namespace
+	/// @param items - Items, obtained by call to NewItem of the same namespace
+	/// @param mode - Modification mode for all of the items
+	/// @param itemsErrors - Optional statuses of the items. If not empty, must have the same size as items
+	/// @return error of the first failed item
+	Error ModifyItems(std::string_view nsName, span<Item> items, ItemModifyMode mode, span<Error> itemsErrors = {});
 	/// Delete all items froms namespace, which matches provided Query
 	/// @param query - Query with conditions
 	/// @param result - QueryResults with IDs of deleted items
@@ -166,11 +176,24 @@ public:
 	/// @param query - SQL query. Only "SELECT" semantic is supported
 	/// @param result - QueryResults with found items
 	Error Select(std::string_view query, QueryResults &result);
+	/// Execute SQL Query with the '?' placeholders in WHERE clause. Parsed query is cached by its text, so the repeated queries are
+	/// not parsed again
+	/// May be used with completion
+	/// @param query - SQL query, e.g. "SELECT * FROM items WHERE id = ?"
+	/// @param params - values of the placeholders in the order of their appearance in query
+	/// @param result - QueryResults with found items
+	Error Select(std::string_view query, const VariantArray &params, QueryResults &result);
 	/// Execute Query and return results
 	/// May be used with completion
 	/// @param query - Query object with query attributes
 	/// @param result - QueryResults with found items
 	Error Select(const Query &query, QueryResults &result);
+	/// Get items by the values of primary key. It is the faster alternative of "SELECT * FROM ns WHERE pk IN (...)"
+	/// May be used with completion
+	/// @param nsName - Name of namespace
+	/// @param keys - values of primary key. Each value of the composite primary key is the tuple of its fields values
+	/// @param result - QueryResults with found items in the order of their internal ids
+	Error GetByPK(std::string_view nsName, const VariantArray &keys, QueryResults &result);
 	/// Flush changes to storage
 	/// Cancelation context doesn't affect this call
 	/// @param nsName - Name of namespace
@@ -187,6 +210,12 @@ public:
 	/// @param tr - transaction to commit
 	/// @param result - QueryResults with IDs of changed by tx items.
 	Error CommitTransaction(Transaction &tr, QueryResults &result);
+	/// Commit transactions of the different namespaces together. Transactions are applied in parallel, and the changes of each
+	/// namespace become visible only after all of the transactions are applied
+	/// @param txs - transactions to commit. Each namespace may be modified by one transaction of the batch only
+	/// @param results - QueryResults with IDs of changed by tx items. Must have the same size as txs
+	/// @return error of the first failed transaction
+	Error CommitTransactions(span<Transaction> txs, span<QueryResults> results);
 	/// RollBack transaction - transaction will be deleted after rollback
 	/// Cancelation context doesn't affect this call
 	/// @param tr - transaction to rollback
@@ -213,6 +242,9 @@ public:
 	Error GetSqlSuggestions(std::string_view sqlQuery, int pos, vector<string> &suggestions);
 	/// Get curret connection status
 	Error Status();
+	/// Check if the warm state of the previous run is replayed (see 'warmup_queries' of the maintenance config)
+	/// @return true, if there is no warm state or its replay is done
+	bool IsWarmedUp() const;
 
 	/// Init system namepaces, and load config from config namespace
 	/// Cancelation context doesn't affect this call
@@ -233,6 +265,10 @@ public:
 	/// @param ser - schema output buffer
 	/// @param namespaces - list of namespaces to be embedded in .proto
 	Error GetProtobufSchema(WrSerializer &ser, vector<string> &namespaces);
+	/// Get cheap metrics of the user namespaces (items count and performance counters). Unlike the select from #perfstats or #memstats,
+	/// namespaces are not locked and the system namespaces are not refilled
+	/// @param metrics - output vector of the metrics
+	Error GetNamespacesMetrics(std::vector<NamespaceMetrics> &metrics);
 
 	/// Add cancelable context
 	/// @param ctx - context pointer
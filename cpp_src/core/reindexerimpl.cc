@@ -1,18 +1,23 @@
 #include "core/reindexerimpl.h"
 #include <stdio.h>
 #include <chrono>
+#include <numeric>
 #include <thread>
+#include <unordered_set>
 #include "cjson/jsonbuilder.h"
 #include "core/cjson/jsondecoder.h"
 #include "core/cjson/protobufschemabuilder.h"
 #include "core/iclientsstats.h"
 #include "core/index/index.h"
+#include "core/indexadvisor.h"
 #include "core/itemimpl.h"
+#include "core/namespacesloadingscheduler.h"
 #include "core/nsselecter/crashqueryreporter.h"
 #include "core/query/sql/sqlsuggester.h"
 #include "core/selectfunc/selectfunc.h"
 #include "core/type_consts_helpers.h"
 #include "defnsconfigs.h"
+#include "warmstate.h"
 #include "estl/contexted_locks.h"
 #include "queryresults/joinresults.h"
 #include "replicator/replicator.h"
@@ -20,8 +25,10 @@
 #include "tools/errors.h"
 #include "tools/fsops.h"
 #include "tools/logger.h"
+#include "tools/workstealingscheduler.h"
 
 #include "debug/backtrace.h"
+#include "debug/sampler.h"
 #include "debug/terminate_handler.h"
 
 std::once_flag initTerminateHandlerFlag;
@@ -36,6 +43,9 @@ namespace reindexer {
 
 constexpr char kStoragePlaceholderFilename[] = ".reindexer.storage";
 constexpr char kReplicationConfFilename[] = "replication.conf";
+constexpr char kWarmStateFilename[] = "warmstate.json";
+// Sort orders may be never built, if the namespace's optimization is disabled, so the warmup does not wait for them infinitely
+constexpr auto kMaxSortOrdersWaiting = std::chrono::seconds(60);
 constexpr unsigned kStorageLoadingThreads = 6;
 
 static unsigned ConcurrentNamespaceLoaders() noexcept {
@@ -64,8 +74,16 @@ ReindexerImpl::ReindexerImpl(IClientsStats* clientsStats)
 	  clientsStats_(clientsStats) {
 	stopBackgroundThreads_ = false;
 	configProvider_.setHandler(ProfilingConf, std::bind(&ReindexerImpl::onProfiligConfigLoad, this));
-	backgroundThread_ = std::thread([this]() { this->backgroundRoutine(); });
-	storageFlushingThread_ = std::thread([this]() { this->storageFlushingRoutine(); });
+	configProvider_.setHandler(MaintenanceConf, std::bind(&ReindexerImpl::onMaintenanceConfigLoad, this));
+	onMaintenanceConfigLoad();
+	backgroundThread_ = std::thread([this]() {
+		debug::CPUSampler::RegisterThread(debug::ThreadRole::Background);
+		this->backgroundRoutine();
+	});
+	storageFlushingThread_ = std::thread([this]() {
+		debug::CPUSampler::RegisterThread(debug::ThreadRole::StorageFlush);
+		this->storageFlushingRoutine();
+	});
 	std::call_once(initTerminateHandlerFlag, []() {
 		debug::terminate_handler_init();
 		debug::backtrace_set_crash_query_reporter(&reindexer::PrintCrashedQuery);
@@ -74,6 +92,7 @@ ReindexerImpl::ReindexerImpl(IClientsStats* clientsStats)
 
 ReindexerImpl::~ReindexerImpl() {
 	stopBackgroundThreads_ = true;
+	if (warmupThread_.joinable()) warmupThread_.join();
 	backgroundThread_.join();
 	storageFlushingThread_.join();
 	replicator_->Stop();
@@ -201,41 +220,52 @@ Error ReindexerImpl::Connect(const string& dsn, ConnectOpts opts) {
 	if (!err.ok()) return err;
 
 	if (enableStorage && opts.IsOpenNamespaces()) {
-		const size_t maxLoadWorkers = ConcurrentNamespaceLoaders();
+		// The biggest namespaces are loaded first, so the loading of the last one doesn't prolong the total time
+		std::vector<std::pair<int64_t, const fs::DirEntry*>> nsQueue;
+		nsQueue.reserve(foundNs.size());
+		for (auto& de : foundNs) {
+			if (de.isDir && validateObjectName(de.name, true)) {
+				nsQueue.emplace_back(de.name[0] == '@' ? 0 : fs::DirSize(fs::JoinPath(storagePath_, de.name)), &de);
+			}
+		}
+		std::stable_sort(nsQueue.begin(), nsQueue.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+		const size_t maxLoadWorkers = std::min(size_t(ConcurrentNamespaceLoaders()), std::max(nsQueue.size(), size_t(1)));
 		std::unique_ptr<std::thread[]> thrs(new std::thread[maxLoadWorkers]);
 		std::atomic_flag hasNsErrors{false};
+		std::atomic<size_t> next{0};
 		for (size_t i = 0; i < maxLoadWorkers; i++) {
 			thrs[i] = std::thread(
-				[&](size_t begin) {
-					for (size_t j = begin; j < foundNs.size(); j += maxLoadWorkers) {
-						auto& de = foundNs[j];
-						if (de.isDir && validateObjectName(de.name, true)) {
-							if (de.name[0] == '@') {
-								const std::string tmpPath = fs::JoinPath(storagePath_, de.name);
-								logPrintf(LogWarning, "Dropping tmp namespace '%s'", de.name);
-								if (fs::RmDirAll(tmpPath) < 0) {
-									logPrintf(LogWarning, "Failed to remove '%s' temporary namespace from filesystem, path: %s", de.name,
-											  tmpPath);
-									hasNsErrors.test_and_set(std::memory_order_relaxed);
-								}
-								continue;
-							}
-							auto status = OpenNamespace(de.name, StorageOpts().Enabled());
-							if (status.ok()) {
-								const RdxContext dummyCtx;
-								if (getNamespace(de.name, dummyCtx)->IsTemporary(dummyCtx)) {
-									logPrintf(LogWarning, "Dropping tmp namespace '%s'", de.name);
-									status = closeNamespace(de.name, dummyCtx, true, true);
-								}
-							}
-							if (!status.ok()) {
-								logPrintf(LogError, "Failed to open namespace '%s' - %s", de.name, status.what());
+				[&] {
+					for (size_t j = next.fetch_add(1, std::memory_order_relaxed); j < nsQueue.size();
+						 j = next.fetch_add(1, std::memory_order_relaxed)) {
+						auto& de = *nsQueue[j].second;
+						if (de.name[0] == '@') {
+							const std::string tmpPath = fs::JoinPath(storagePath_, de.name);
+							logPrintf(LogWarning, "Dropping tmp namespace '%s'", de.name);
+							if (fs::RmDirAll(tmpPath) < 0) {
+								logPrintf(LogWarning, "Failed to remove '%s' temporary namespace from filesystem, path: %s", de.name,
+										  tmpPath);
 								hasNsErrors.test_and_set(std::memory_order_relaxed);
 							}
+							continue;
+						}
+						// Slots are shared by the namespaces of all the databases, which are opened concurrently
+						const auto slot = NamespacesLoadingScheduler::Instance().Acquire(nsQueue[j].first);
+						auto status = OpenNamespace(de.name, StorageOpts().Enabled());
+						if (status.ok()) {
+							const RdxContext dummyCtx;
+							if (getNamespaceNoLoad(de.name, dummyCtx)->IsTemporary(dummyCtx)) {
+								logPrintf(LogWarning, "Dropping tmp namespace '%s'", de.name);
+								status = closeNamespace(de.name, dummyCtx, true, true);
+							}
+						}
+						if (!status.ok()) {
+							logPrintf(LogError, "Failed to open namespace '%s' - %s", de.name, status.what());
+							hasNsErrors.test_and_set(std::memory_order_relaxed);
 						}
 					}
-				},
-				i);
+				});
 		}
 		for (size_t i = 0; i < maxLoadWorkers; i++) thrs[i].join();
 
@@ -261,6 +291,7 @@ Error ReindexerImpl::Connect(const string& dsn, ConnectOpts opts) {
 
 	if (err.ok()) {
 		connected_.store(true, std::memory_order_release);
+		startWarmup();
 	}
 	return err;
 }
@@ -381,9 +412,13 @@ Error ReindexerImpl::closeNamespace(std::string_view nsName, const RdxContext& c
 			ns->CloseStorage(ctx);
 		}
 		if (dropStorage) {
-			if (!nsIt->second->GetDefinition(ctx).isTemporary) {
+			if (!ns->GetDefinition(ctx).isTemporary) {
 				observers_.OnWALUpdate(LSNPair(), nsName, WALRecord(WalNamespaceDrop));
 			}
+			// Data of the large namespace may take seconds to be released, so it's released by the background thread
+			ns->DropData(ctx);
+			std::lock_guard lck(droppedNamespacesMtx_);
+			droppedNamespaces_.emplace_back(std::move(ns));
 		}
 
 	} catch (const Error& err) {
@@ -471,6 +506,8 @@ Error ReindexerImpl::renameNamespace(std::string_view srcNsName, const std::stri
 		const auto rdxCtx = ctx.CreateRdxContext(
 			ctx.NeedTraceActivity() ? (ser << "RENAME " << srcNsName << " to " << dstNsName).Slice() : ""sv, activities_);
 
+		// Items of the lazily loaded namespace have to be loaded before its storage is moved
+		getNamespaceNoThrow(srcNsName, rdxCtx);
 		ULock lock(mtx_, &rdxCtx);
 		auto srcIt = namespaces_.find(srcNsName);
 		if (srcIt == namespaces_.end()) {
@@ -509,6 +546,7 @@ Error ReindexerImpl::renameNamespace(std::string_view srcNsName, const std::stri
 template <bool needUpdateSystemNs, typename MakeCtxStrFn, typename MemFnType, MemFnType Namespace::*MemFn, typename Arg, typename... Args>
 Error ReindexerImpl::applyNsFunction(std::string_view nsName, const InternalRdxContext& ctx, const MakeCtxStrFn& makeCtxStr, Arg arg,
 									 Args... args) {
+	MaintenanceScheduler::ForegroundOp fgOp(maintenance_);
 	Error err;
 	try {
 		WrSerializer ser;
@@ -537,6 +575,7 @@ struct IsVoidReturn<void (Namespace::*)(Args...)> : public std::true_type {};
 template <auto MemFn, typename MakeCtxStrFn, typename Arg, typename... Args>
 Error ReindexerImpl::applyNsFunction(std::string_view nsName, const InternalRdxContext& ctx, const MakeCtxStrFn& makeCtxStr, Arg& arg,
 									 Args... args) {
+	MaintenanceScheduler::ForegroundOp fgOp(maintenance_);
 	Error err;
 	try {
 		WrSerializer ser;
@@ -610,6 +649,7 @@ Error ReindexerImpl::Update(std::string_view nsName, Item& item, QueryResults& q
 }
 
 Error ReindexerImpl::Update(const Query& q, QueryResults& result, const InternalRdxContext& ctx) {
+	MaintenanceScheduler::ForegroundOp fgOp(maintenance_);
 	try {
 		WrSerializer ser;
 		const auto rdxCtx = ctx.CreateRdxContext(ctx.NeedTraceActivity() ? q.GetSQL(ser).Slice() : ""sv, activities_, result);
@@ -644,6 +684,61 @@ Error ReindexerImpl::Upsert(std::string_view nsName, Item& item, QueryResults& q
 	APPLY_NS_FUNCTION2(true, Upsert, item, qr);
 }
 
+Error ReindexerImpl::ModifyItems(std::string_view nsName, span<Item> items, ItemModifyMode mode, span<Error> itemsErrors,
+								 const InternalRdxContext& ctx) {
+	assertrx(itemsErrors.empty() || itemsErrors.size() == items.size());
+	MaintenanceScheduler::ForegroundOp fgOp(maintenance_);
+	Error err;
+	std::vector<ItemModification> mods;
+	bool isSystem = false;
+	try {
+		WrSerializer ser;
+		if (ctx.NeedTraceActivity()) ser << "MODIFY " << items.size() << " ITEMS OF " << nsName;
+		const auto rdxCtx = ctx.CreateRdxContext(ser.Slice(), activities_);
+		auto ns = getNamespace(nsName, rdxCtx);
+		isSystem = ns->IsSystem(rdxCtx);
+		if (!isSystem) {
+			mods.reserve(items.size());
+			for (auto& item : items) mods.push_back({std::move(item), mode, LSNPair(), Error()});
+			ns->ModifyBatch(mods, rdxCtx);
+		}
+	} catch (const Error& e) {
+		err = e;
+		for (auto& itemErr : itemsErrors) itemErr = e;
+	}
+	for (size_t i = 0; i < mods.size(); ++i) {
+		items[i] = std::move(mods[i].item);
+		if (err.ok() && !mods[i].err.ok()) err = mods[i].err;
+		if (!itemsErrors.empty()) itemsErrors[i] = std::move(mods[i].err);
+	}
+	if (isSystem) {
+		// Database state is synchronized with the system namespace after each item, so its items are modified one by one
+		const auto itemCtx = ctx.WithCompletion(nullptr);
+		for (size_t i = 0; i < items.size(); ++i) {
+			auto& item = items[i];
+			Error status;
+			switch (mode) {
+				case ModeUpsert:
+					status = Upsert(nsName, item, itemCtx);
+					break;
+				case ModeDelete:
+					status = Delete(nsName, item, itemCtx);
+					break;
+				case ModeInsert:
+					status = Insert(nsName, item, itemCtx);
+					break;
+				case ModeUpdate:
+					status = Update(nsName, item, itemCtx);
+					break;
+			}
+			if (err.ok()) err = status;
+			if (!itemsErrors.empty()) itemsErrors[i] = std::move(status);
+		}
+	}
+	if (ctx.Compl()) ctx.Compl()(err);
+	return err;
+}
+
 Item ReindexerImpl::NewItem(std::string_view nsName, const InternalRdxContext& ctx) {
 	try {
 		WrSerializer ser;
@@ -667,6 +762,7 @@ Transaction ReindexerImpl::NewTransaction(std::string_view _namespace, const Int
 }
 
 Error ReindexerImpl::CommitTransaction(Transaction& tr, QueryResults& result, const InternalRdxContext& ctx) {
+	MaintenanceScheduler::ForegroundOp fgOp(maintenance_);
 	Error err = errOK;
 	try {
 		WrSerializer ser;
@@ -680,6 +776,33 @@ Error ReindexerImpl::CommitTransaction(Transaction& tr, QueryResults& result, co
 
 	return err;
 }
+Error ReindexerImpl::CommitTransactions(span<Transaction> txs, span<QueryResults> results, const InternalRdxContext& ctx) {
+	if (txs.size() != results.size()) return Error(errParams, "Count of the results has to be equal to the count of the transactions");
+	MaintenanceScheduler::ForegroundOp fgOp(maintenance_);
+	Error err = errOK;
+	try {
+		WrSerializer ser;
+		if (ctx.NeedTraceActivity()) {
+			ser << "COMMIT TRANSACTIONS"sv;
+			for (auto& tx : txs) ser << ' ' << tx.GetName();
+		}
+		const RdxContext rdxCtx = ctx.CreateRdxContext(ser.Slice(), activities_);
+		std::vector<Namespace::Ptr> nss;
+		nss.reserve(txs.size());
+		for (auto& tx : txs) {
+			auto ns = getNamespace(tx.GetName(), rdxCtx);
+			if (std::find(nss.begin(), nss.end(), ns) != nss.end()) {
+				throw Error(errParams, "Namespace '%s' is modified by several transactions of the batch", tx.GetName());
+			}
+			nss.emplace_back(std::move(ns));
+		}
+		Namespace::CommitTransactions(nss, txs, results, rdxCtx);
+	} catch (const Error& e) {
+		err = e;
+	}
+
+	return err;
+}
 Error ReindexerImpl::RollBackTransaction(Transaction& tr) {
 	tr.GetSteps().clear();
 
@@ -731,7 +854,22 @@ Error ReindexerImpl::Select(std::string_view query, QueryResults& result, const
 	Error err = errOK;
 	try {
 		Query q;
-		q.FromSQL(query);
+		// Select queries, which differ only by the values of the conditions, are parsed once
+		std::string normalized;
+		VariantArray values;
+		bool parsed = false;
+		if (SQLParser::Parameterize(query, normalized, values)) {
+			try {
+				const auto prepared = getPreparedQuery(normalized);
+				if (prepared->ParamsCount() == values.size()) {
+					q = prepared->Bind(values);
+					parsed = true;
+				}
+			} catch (const Error&) {
+				// Error is reported by the parser of the original query
+			}
+		}
+		if (!parsed) q.FromSQL(query);
 		switch (q.type_) {
 			case QuerySelect:
 				err = Select(q, result, ctx);
@@ -756,6 +894,42 @@ Error ReindexerImpl::Select(std::string_view query, QueryResults& result, const
 	return err;
 }
 
+Error ReindexerImpl::Select(std::string_view query, const VariantArray& params, QueryResults& result, const InternalRdxContext& ctx) {
+	Error err = errOK;
+	try {
+		const Query q = getPreparedQuery(query)->Bind(params);
+		switch (q.type_) {
+			case QuerySelect:
+				err = Select(q, result, ctx);
+				break;
+			case QueryDelete:
+				err = Delete(q, result, ctx);
+				break;
+			case QueryUpdate:
+				err = Update(q, result, ctx);
+				break;
+			default:
+				throw Error(errParams, "Error unsupported prepared query type %d", q.type_);
+		}
+	} catch (const Error& e) {
+		err = e;
+	}
+
+	if (ctx.Compl()) ctx.Compl()(err);
+	return err;
+}
+
+std::shared_ptr<const PreparedQuery> ReindexerImpl::getPreparedQuery(std::string_view sql) {
+	const PreparedQueryCacheKey key{std::string(sql)};
+	auto cached = preparedQueries_.Get(key);
+	std::shared_ptr<const PreparedQuery> prepared = cached.val.query;
+	if (!prepared) {
+		prepared = std::make_shared<const PreparedQuery>(sql);
+		if (cached.valid) preparedQueries_.Put(key, {prepared});
+	}
+	return prepared;
+}
+
 struct ItemRefLess {
 	bool operator()(const ItemRef& lhs, const ItemRef& rhs) const {
 		if (lhs.Proc() == rhs.Proc()) {
@@ -768,7 +942,99 @@ struct ItemRefLess {
 	}
 };
 
+// Query of the main or merged namespace for the sorted merge: it is sorted by the main query entries and returns the best offset + limit
+// of its items, so the namespaces, which are parts of the same dataset, do not return all of the matched items
+static Query sortedMergePart(const Query& q, const Query& mainQ) {
+	Query part(q);
+	part.mergeQueries_.clear();
+	part.sortingEntries_ = mainQ.sortingEntries_;
+	part.start = 0;
+	part.count = (mainQ.count > UINT_MAX - mainQ.start) ? UINT_MAX : mainQ.start + mainQ.count;
+	part.calcTotal = mainQ.calcTotal;
+	return part;
+}
+
+// Merges results of the main and merged queries, which were sorted by the same entries. Values are compared without the index collation
+static void mergeSortedResults(const Query& q, QueryResults& result, const h_vector<size_t, 8>& partsEnds) {
+	ItemRefVector& items = result.Items();
+	std::vector<VariantArray> keys;
+	keys.reserve(items.size());
+	for (const auto& item : items) {
+		ConstPayload pl(result.getPayloadType(item.Nsid()), item.Value());
+		VariantArray itemKeys;
+		itemKeys.reserve(q.sortingEntries_.size());
+		for (const auto& se : q.sortingEntries_) {
+			VariantArray values;
+			int field = 0;
+			if (pl.Type().FieldByName(se.expression, field)) {
+				pl.Get(field, values);
+			} else {
+				pl.GetByJsonPath(se.expression, result.getTagsMatcher(item.Nsid()), values, KeyValueUndefined);
+			}
+			itemKeys.emplace_back(values.empty() ? Variant() : values[0]);
+		}
+		keys.emplace_back(std::move(itemKeys));
+	}
+	const auto less = [&q, &keys](size_t lhs, size_t rhs) {
+		for (size_t i = 0; i < q.sortingEntries_.size(); ++i) {
+			const Variant &l = keys[lhs][i], &r = keys[rhs][i];
+			int cmp = 0;
+			if (l.Type() == KeyValueNull || r.Type() == KeyValueNull) {
+				// Items without value go first
+				cmp = int(r.Type() == KeyValueNull) - int(l.Type() == KeyValueNull);
+			} else {
+				cmp = l.RelaxCompare(r);
+			}
+			if (cmp) return q.sortingEntries_[i].desc ? cmp > 0 : cmp < 0;
+		}
+		return false;
+	};
+	std::vector<size_t> order(items.size());
+	std::iota(order.begin(), order.end(), 0);
+	for (size_t i = 1; i < partsEnds.size(); ++i) {
+		std::inplace_merge(order.begin(), order.begin() + partsEnds[i - 1], order.begin() + partsEnds[i], less);
+	}
+	ItemRefVector merged;
+	merged.reserve(items.size());
+	for (size_t idx : order) merged.emplace_back(std::move(items[idx]));
+	items = std::move(merged);
+}
+
+// Results of these queries are not determined by the data of the namespaces alone, or are changed by the select functions
+static bool isResultsCacheable(const Query& q) {
+	if (q.IsWALQuery() || q.explain_ || (!q._namespace.empty() && q._namespace[0] == '#')) return false;
+	bool withFunctions = false;
+	q.WalkNested(true, true, [&withFunctions](const Query& nq) { withFunctions = withFunctions || !nq.selectFunctions_.empty(); });
+	return !withFunctions;
+}
+
+// Items of the cached results are read by the query too, so they are marked as accessed for the eviction of the cold tuples
+template <typename T>
+void ReindexerImpl::touchResultsItems(const Query& q, const QueryResults& result, NsLocker<T>& locks) {
+	h_vector<NamespaceImpl::Ptr, 2> nss;
+	nss.emplace_back(locks.Get(q._namespace));
+	for (const auto& mq : q.mergeQueries_) nss.emplace_back(locks.Get(mq._namespace));
+	for (const auto& itemRef : result.Items()) {
+		if (itemRef.Nsid() >= nss.size()) continue;
+		const Query& nq = itemRef.Nsid() ? q.mergeQueries_[itemRef.Nsid() - 1] : q;
+		if (nss[itemRef.Nsid()]) nss[itemRef.Nsid()]->itemsAccess_.Touch(itemRef.Id());
+		if (itemRef.Nsid() >= result.joined_.size()) continue;
+		const joins::ItemIterator joinedIt(&result.joined_[itemRef.Nsid()], itemRef.Id());
+		if (!joinedIt.getJoinedItemsCount()) continue;
+		const int fieldsCount = std::min(joinedIt.getJoinedFieldsCount(), int(nq.joinQueries_.size()));
+		for (int f = 0; f < fieldsCount; ++f) {
+			const auto joinedNs = locks.Get(nq.joinQueries_[f]._namespace);
+			if (!joinedNs) continue;
+			const auto fieldIt = joinedIt.at(f);
+			for (int i = 0, cnt = fieldIt.ItemsCount(); i < cnt; ++i) joinedNs->itemsAccess_.Touch(fieldIt[i].Id());
+		}
+	}
+}
+
 Error ReindexerImpl::Select(const Query& q, QueryResults& result, const InternalRdxContext& ctx) {
+	MaintenanceScheduler::ForegroundOp fgOp(maintenance_);
+	std::unique_ptr<QueryTrace> trace;
+	std::optional<SlowQuery> slowQuery;
 	try {
 		WrSerializer normalizedSQL, nonNormalizedSQL;
 		if (ctx.NeedTraceActivity()) q.GetSQL(nonNormalizedSQL, false);
@@ -776,9 +1042,15 @@ Error ReindexerImpl::Select(const Query& q, QueryResults& result, const Internal
 		NsLocker<const RdxContext> locks(rdxCtx);
 
 		auto mainNsWrp = getNamespace(q._namespace, rdxCtx);
+		if (q.HasWaitLSN()) {
+			// Read-your-writes: slave's namespace has to apply client's modification before the select
+			replicator_->WaitUpstreamLSN(mainNsWrp, lsn_t(q.waitLSN), std::chrono::milliseconds(q.waitLSNTimeoutMs), rdxCtx);
+		}
 		auto mainNs = q.IsWALQuery() ? mainNsWrp->awaitMainNs(rdxCtx) : mainNsWrp->getMainNs();
 
 		ProfilingConfigData profilingCfg = configProvider_.GetProfilingConfig();
+		if (QueryTracer::NeedTrace(profilingCfg.queryTracesSampleRate)) trace = std::make_unique<QueryTrace>(q.GetSQL(false));
+		if (profilingCfg.slowQueriesThresholdUS) slowQuery.emplace(std::chrono::microseconds(profilingCfg.slowQueriesThresholdUS));
 		PerfStatCalculatorMT calc(mainNs->selectPerfCounter_, mainNs->enablePerfCounters_);	 // todo more accurate detect joined queries
 		auto& tracker = queriesStatTracker_;
 		if (profilingCfg.queriesPerfStats) {
@@ -814,22 +1086,80 @@ Error ReindexerImpl::Select(const Query& q, QueryResults& result, const Internal
 			locks.Add(ns);
 		});
 
-		locks.Lock();
+		{
+			QueryTraceSpan span(trace.get(), "lock_wait");
+			const auto lockBegin = slowQuery ? SlowQuery::Clock::now() : SlowQuery::Clock::time_point();
+			locks.Lock();
+			if (slowQuery) slowQuery->AddLockWait(SlowQuery::Clock::now() - lockBegin);
+		}
 
 		calc.LockHit();
 		statCalculator.LockHit();
 
-		SelectFunctionsHolder func;
-		doSelect(q, result, locks, func, rdxCtx);
-		func.Process(result);
+		QueryResultsCache* resultsCache = isResultsCacheable(q) ? mainNs->resultsCache_.get() : nullptr;
+		std::optional<QueryCacheKey> resultsCacheKey;
+		NsDataVersions versions;
+		if (resultsCache) {
+			resultsCacheKey.emplace(q, Normal);
+			versions = locks.DataVersions();
+		}
+		if (resultsCache && resultsCache->GetResults(*resultsCacheKey, versions, result)) {
+			locks.AddNamespacesTo(result);
+			touchResultsItems(q, result, locks);
+		} else {
+			SelectFunctionsHolder func;
+			doSelect(q, result, locks, func, rdxCtx, trace.get(), slowQuery ? &slowQuery.value() : nullptr);
+			{
+				QueryTraceSpan span(trace.get(), "select_functions");
+				func.Process(result);
+			}
+			if (resultsCache && result.IsCacheEnabled() && !result.incomplete) resultsCache->PutResults(*resultsCacheKey, versions, result);
+		}
 	} catch (const Error& err) {
+		if (trace) {
+			trace->Finish(err.what());
+			queryTracer_.Add(std::move(*trace));
+		}
+		if (slowQuery && slowQuery->Finish(err.what())) addSlowQuery(q, std::move(*slowQuery));
 		if (ctx.Compl()) ctx.Compl()(err);
 		return err;
 	}
+	if (trace) {
+		trace->Finish();
+		queryTracer_.Add(std::move(*trace));
+	}
+	if (slowQuery && slowQuery->Finish()) addSlowQuery(q, std::move(*slowQuery));
 	if (ctx.Compl()) ctx.Compl()(errOK);
 	return errOK;
 }
 
+void ReindexerImpl::addSlowQuery(const Query& q, SlowQuery&& slowQuery) {
+	slowQuery.SetQuery(q.GetSQL(true), q.GetSQL(false));
+	slowQueryLog_.Add(std::move(slowQuery));
+}
+
+Error ReindexerImpl::GetByPK(std::string_view nsName, const VariantArray& keys, QueryResults& result, const InternalRdxContext& ctx) {
+	Error err;
+	try {
+		const auto rdxCtx = ctx.CreateRdxContext("", activities_);
+		auto nsWrp = getNamespaceNoLoad(nsName, rdxCtx);
+		auto ns = nsWrp->getMainNs();
+		// Items of the lazily loaded namespace are read from the storage, while they are loaded in the background
+		if (!ns->GetLazyByPK(keys, ns, result)) {
+			// Hot keys are returned by the point reads cache without the lock of the namespace, so they don't wait for the writers
+			if (!ns->pointReads_.Get(keys, ns, result)) {
+				// Query on the PK index alias is selected by the NsSelecter's primary key lookup, without the generic query planning
+				err = Select(Query(string(nsName)).Where(kPKIndexName, CondSet, keys), result, ctx.WithCompletion(nullptr));
+				if (err.ok()) nsWrp->FillPointReads(result, rdxCtx);
+			}
+		}
+	} catch (const Error& e) {
+		err = e;
+	}
+	if (ctx.Compl()) ctx.Compl()(err);
+	return err;
+}
+
 struct ReindexerImpl::QueryResultsContext {
 	QueryResultsContext() {}
 	QueryResultsContext(PayloadType type, TagsMatcher tagsMatcher, const FieldsSet& fieldsFilter, std::shared_ptr<const Schema> schema)
@@ -882,12 +1212,24 @@ void ReindexerImpl::prepareJoinResults(const Query& q, QueryResults& result) {
 }
 template <typename T>
 JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResults& result, NsLocker<T>& locks, SelectFunctionsHolder& func,
-													  vector<QueryResultsContext>& queryResultsContexts, const RdxContext& rdxCtx) {
+													  vector<QueryResultsContext>& queryResultsContexts, const RdxContext& rdxCtx,
+													  QueryTrace* trace, SlowQuery* slowQuery, bool bestEffort) {
 	JoinedSelectors joinedSelectors;
 	if (q.joinQueries_.empty()) return joinedSelectors;
 	auto ns = locks.Get(q._namespace);
 	assertrx(ns);
 
+	struct JoinPrep {
+		std::shared_ptr<NamespaceImpl> jns;
+		Query jItemQ;
+		Query jjq;
+		JoinPreResult::Ptr preResult;
+		JoinCacheRes joinRes;
+		bool needPreselect;
+	};
+	std::vector<JoinPrep> preps;
+	preps.reserve(q.joinQueries_.size());
+
 	// For each joined queries
 	int joinedSelectorsCount = q.joinQueries_.size();
 	for (auto& jq : q.joinQueries_) {
@@ -920,29 +1262,66 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 		}
 
 		Query jjq(jq);
-		JoinPreResult::Ptr preResult = std::make_shared<JoinPreResult>();
-		size_t joinedFieldIdx = joinedSelectors.size();
 		JoinCacheRes joinRes;
 		joinRes.key.SetData(jq);
 		jns->getFromJoinCache(joinRes);
 		jjq.explain_ = q.explain_;
 		jjq.Strict(q.strictMode);
-		if (!jjq.entries.Empty() && !joinRes.haveData) {
-			QueryResults jr;
-			jjq.Limit(UINT_MAX);
-			SelectCtx ctx(jjq, &q);
-			ctx.preResult = preResult;
-			ctx.preResult->executionMode = JoinPreResult::ModeBuild;
-			ctx.preResult->enableStoredValues = isPreResultValuesModeOptimizationAvailable(jItemQ, jns);
-			ctx.functions = &func;
-			ctx.requiresCrashTracking = true;
-			jns->Select(jr, ctx, rdxCtx);
-			assertrx(ctx.preResult->executionMode == JoinPreResult::ModeExecute);
+		const bool needPreselect = !jjq.entries.Empty() && !joinRes.haveData;
+		preps.push_back({std::move(jns), std::move(jItemQ), std::move(jjq), std::make_shared<JoinPreResult>(), std::move(joinRes),
+						 needPreselect});
+	}
+
+	auto preselect = [&](JoinPrep& prep, SelectFunctionsHolder& f, QueryTrace* tr, SlowQuery* sq) {
+		QueryResults jr;
+		prep.jjq.Limit(UINT_MAX);
+		SelectCtx ctx(prep.jjq, &q);
+		ctx.preResult = prep.preResult;
+		ctx.preResult->executionMode = JoinPreResult::ModeBuild;
+		ctx.preResult->enableStoredValues = isPreResultValuesModeOptimizationAvailable(prep.jItemQ, prep.jns);
+		ctx.functions = &f;
+		ctx.requiresCrashTracking = true;
+		ctx.trace = tr;
+		ctx.slowQuery = sq;
+		QueryTraceSpan span(tr, "join_preselect", prep.jjq._namespace);
+		prep.jns->Select(jr, ctx, rdxCtx);
+		assertrx(ctx.preResult->executionMode == JoinPreResult::ModeExecute);
+	};
+	const size_t preselectsCount = std::count_if(preps.begin(), preps.end(), [](const JoinPrep& prep) { return prep.needPreselect; });
+	const int workers = ns->config_.subqueriesWorkers;
+	if (workers > 1 && preselectsCount > 1 && !trace) {
+		// Preselects of the different joins are independent. Each one collects its select functions and plans separately, and they are
+		// merged in the order of the joins after that
+		std::vector<SelectFunctionsHolder> funcs(preps.size());
+		std::vector<std::optional<SlowQuery>> slowQueries(preps.size());
+		WorkStealingScheduler scheduler(std::min(size_t(workers), preselectsCount));
+		for (size_t i = 0; i < preps.size(); ++i) {
+			if (!preps[i].needPreselect) continue;
+			if (slowQuery) slowQueries[i].emplace(slowQuery->Threshold());
+			scheduler.Add([&, i] { preselect(preps[i], funcs[i], nullptr, slowQueries[i] ? &slowQueries[i].value() : nullptr); });
+		}
+		scheduler.Run([] { return false; });
+		for (size_t i = 0; i < preps.size(); ++i) {
+			func.Merge(std::move(funcs[i]));
+			if (slowQueries[i]) slowQuery->AppendPlans(std::move(*slowQueries[i]));
 		}
+	} else {
+		for (auto& prep : preps) {
+			if (prep.needPreselect) preselect(prep, func, trace, slowQuery);
+		}
+	}
+
+	for (size_t i = 0; i < preps.size(); ++i) {
+		auto& jq = q.joinQueries_[i];
+		auto& jns = preps[i].jns;
+		auto& jItemQ = preps[i].jItemQ;
+		auto& joinRes = preps[i].joinRes;
+		JoinPreResult::Ptr preResult = preps[i].preResult;
+		size_t joinedFieldIdx = joinedSelectors.size();
 		if (joinRes.haveData) {
 			preResult = joinRes.it.val.preResult;
 		} else if (joinRes.needPut) {
-			jns->putToJoinCache(joinRes, preResult);
+			jns->putToJoinCache(joinRes, preResult, jq);
 		}
 
 		queryResultsContexts.emplace_back(jns->payloadType_, jns->tagsMatcher_, FieldsSet(jns->tagsMatcher_, jq.selectFilter_),
@@ -973,14 +1352,15 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 			jns.reset();
 		}
 		joinedSelectors.emplace_back(jq.joinType, ns, std::move(jns), std::move(joinRes), std::move(jItemQ), result, jq, preResult,
-									 joinedFieldIdx, func, joinedSelectorsCount, false, rdxCtx);
+									 joinedFieldIdx, func, joinedSelectorsCount, false, bestEffort, rdxCtx);
 		ThrowOnCancel(rdxCtx);
 	}
 	return joinedSelectors;
 }
 
 template <typename T>
-void ReindexerImpl::doSelect(const Query& q, QueryResults& result, NsLocker<T>& locks, SelectFunctionsHolder& func, const RdxContext& ctx) {
+void ReindexerImpl::doSelect(const Query& q, QueryResults& result, NsLocker<T>& locks, SelectFunctionsHolder& func, const RdxContext& ctx,
+							 QueryTrace* trace, SlowQuery* slowQuery) {
 	auto ns = locks.Get(q._namespace);
 	assertrx(ns);
 	if (!ns) {
@@ -988,43 +1368,135 @@ void ReindexerImpl::doSelect(const Query& q, QueryResults& result, NsLocker<T>&
 	}
 	vector<QueryResultsContext> joinQueryResultsContexts;
 	// should be destroyed after results.lockResults()
-	JoinedSelectors mainJoinedSelectors = prepareJoinedSelectors(q, result, locks, func, joinQueryResultsContexts, ctx);
+	JoinedSelectors mainJoinedSelectors =
+		prepareJoinedSelectors(q, result, locks, func, joinQueryResultsContexts, ctx, trace, slowQuery, q.bestEffort);
 	prepareJoinResults(q, result);
-	{
-		SelectCtx selCtx(q, nullptr);
+	// Merged namespaces with the same structure (e.g. parts of the large dataset) are sorted by the main query entries and their results
+	// are merged after that
+	const bool sortedMerge = !q.mergeQueries_.empty() && !q.sortingEntries_.empty();
+	h_vector<size_t, 8> partsEnds;
+	size_t partsTotal = 0;
+	const Query mainPart = sortedMerge ? sortedMergePart(q, q) : Query();
+	auto selectMain = [&] {
+		SelectCtx selCtx(sortedMerge ? mainPart : q, nullptr);
 		selCtx.joinedSelectors = mainJoinedSelectors.size() ? &mainJoinedSelectors : nullptr;
 		selCtx.contextCollectingMode = true;
 		selCtx.functions = &func;
 		selCtx.nsid = 0;
-		selCtx.isForceAll = !q.mergeQueries_.empty();
+		selCtx.isForceAll = !q.mergeQueries_.empty() && !sortedMerge;
 		selCtx.requiresCrashTracking = true;
+		selCtx.trace = trace;
+		selCtx.slowQuery = slowQuery;
+		selCtx.bestEffort = q.bestEffort;
 		ns->Select(result, selCtx, ctx);
+	};
+
+	if (q.mergeQueries_.empty()) {
+		selectMain();
 		result.AddNamespace(ns, {ctx, true});
 	}
 
 	// should be destroyed after results.lockResults()
 	vector<JoinedSelectors> mergeJoinedSelectors;
 	if (!q.mergeQueries_.empty()) {
-		mergeJoinedSelectors.reserve(q.mergeQueries_.size());
-		uint8_t counter = 0;
-
+		std::vector<std::shared_ptr<NamespaceImpl>> mergedNamespaces;
+		mergedNamespaces.reserve(q.mergeQueries_.size());
 		for (auto& mq : q.mergeQueries_) {
-			auto mns = locks.Get(mq._namespace);
-			assertrx(mns);
-			SelectCtx mctx(mq, &q);
-			mctx.nsid = ++counter;
-			mctx.isForceAll = true;
-			mctx.functions = &func;
+			mergedNamespaces.emplace_back(locks.Get(mq._namespace));
+			assertrx(mergedNamespaces.back());
+		}
+		auto selectMerged = [&](size_t i, QueryResults& res, SelectFunctionsHolder& f, QueryTrace* tr, SlowQuery* sq,
+								JoinedSelectors* joinedSelectors) {
+			const Query& mq = q.mergeQueries_[i];
+			const Query mergedPart = sortedMerge ? sortedMergePart(mq, q) : Query();
+			SelectCtx mctx(sortedMerge ? mergedPart : mq, &q);
+			mctx.nsid = i + 1;
+			mctx.isForceAll = !sortedMerge;
+			mctx.functions = &f;
 			mctx.contextCollectingMode = true;
-			mergeJoinedSelectors.emplace_back(prepareJoinedSelectors(mq, result, locks, func, joinQueryResultsContexts, ctx));
-			mctx.joinedSelectors = mergeJoinedSelectors.back().size() ? &mergeJoinedSelectors.back() : nullptr;
+			mctx.joinedSelectors = joinedSelectors;
 			mctx.requiresCrashTracking = true;
-
-			mns->Select(result, mctx, ctx);
-			result.AddNamespace(mns, {ctx, true});
+			mctx.trace = tr;
+			mctx.slowQuery = sq;
+			// Merged queries are the parts of the main one, so they share its mode
+			mctx.bestEffort = q.bestEffort;
+			mergedNamespaces[i]->Select(res, mctx, ctx);
+		};
+
+		const int workers = ns->config_.subqueriesWorkers;
+		// Joined items of the merged queries are collected into the shared results, so such queries are selected one after another
+		const bool parallelMerge = workers > 1 && !trace && std::all_of(q.mergeQueries_.begin(), q.mergeQueries_.end(), [](const Query& mq) {
+			return mq.joinQueries_.empty();
+		});
+		if (parallelMerge) {
+			// Main and merged queries are selected concurrently into the separate results, which are appended in the order of nsid
+			struct MergedPart {
+				QueryResults result;
+				SelectFunctionsHolder func;
+				std::optional<SlowQuery> slowQuery;
+			};
+			std::vector<MergedPart> parts(q.mergeQueries_.size());
+			WorkStealingScheduler scheduler(std::min(size_t(workers), parts.size() + 1));
+			scheduler.Add(selectMain);
+			for (size_t i = 0; i < parts.size(); ++i) {
+				if (slowQuery) parts[i].slowQuery.emplace(slowQuery->Threshold());
+				scheduler.Add([&, i] {
+					auto& part = parts[i];
+					selectMerged(i, part.result, part.func, nullptr, part.slowQuery ? &part.slowQuery.value() : nullptr, nullptr);
+				});
+			}
+			scheduler.Run([] { return false; });
+
+			result.AddNamespace(ns, {ctx, true});
+			partsEnds.emplace_back(result.Items().size());
+			partsTotal += result.totalCount;
+			for (size_t i = 0; i < parts.size(); ++i) {
+				QueryResults& res = parts[i].result;
+				result.addNSContext(res.getPayloadType(0), res.getTagsMatcher(0), res.getFieldsFilter(0), res.getSchema(0));
+				for (const auto& item : res.Items()) result.Add(item);
+				for (auto& aggRes : res.aggregationResults) result.aggregationResults.emplace_back(std::move(aggRes));
+				if (!res.explainResults.empty()) result.explainResults = std::move(res.explainResults);
+				result.haveRank = result.haveRank || res.haveRank;
+				result.needOutputRank = result.needOutputRank || res.needOutputRank;
+				result.incomplete = result.incomplete || res.incomplete;
+				result.totalCount = res.totalCount;
+				func.Merge(std::move(parts[i].func));
+				if (parts[i].slowQuery) slowQuery->AppendPlans(std::move(*parts[i].slowQuery));
+				result.AddNamespace(mergedNamespaces[i], {ctx, true});
+				partsEnds.emplace_back(result.Items().size());
+				partsTotal += res.totalCount;
+			}
+		} else {
+			selectMain();
+			result.AddNamespace(ns, {ctx, true});
+			partsEnds.emplace_back(result.Items().size());
+			partsTotal += result.totalCount;
+
+			mergeJoinedSelectors.reserve(q.mergeQueries_.size());
+			for (size_t i = 0; i < q.mergeQueries_.size(); ++i) {
+				mergeJoinedSelectors.emplace_back(prepareJoinedSelectors(q.mergeQueries_[i], result, locks, func, joinQueryResultsContexts,
+																		 ctx, trace, slowQuery, q.bestEffort));
+				result.totalCount = 0;
+				selectMerged(i, result, func, trace, slowQuery, mergeJoinedSelectors.back().size() ? &mergeJoinedSelectors.back() : nullptr);
+				result.AddNamespace(mergedNamespaces[i], {ctx, true});
+				partsEnds.emplace_back(result.Items().size());
+				partsTotal += result.totalCount;
+			}
 		}
 
 		ItemRefVector& itemRefVec = result.Items();
+		if (sortedMerge) {
+			QueryTraceSpan span(trace, "merge_sort");
+			mergeSortedResults(q, result, partsEnds);
+			result.totalCount = q.calcTotal ? partsTotal : 0;
+			result.Erase(itemRefVec.begin(), itemRefVec.begin() + std::min<size_t>(q.start, itemRefVec.size()));
+			if (itemRefVec.size() > q.count) result.Erase(itemRefVec.begin() + q.count, itemRefVec.end());
+			// Adding context to QueryResults
+			for (const auto& jctx : joinQueryResultsContexts) {
+				result.addNSContext(jctx.type_, jctx.tagsMatcher_, jctx.fieldsFilter_, jctx.schema_);
+			}
+			return;
+		}
 		if (static_cast<size_t>(q.start) >= itemRefVec.size()) {
 			result.Erase(itemRefVec.begin(), itemRefVec.end());
 			return;
@@ -1055,7 +1527,8 @@ void ReindexerImpl::doSelect(const Query& q, QueryResults& result, NsLocker<T>&
 	for (const auto& jctx : joinQueryResultsContexts) result.addNSContext(jctx.type_, jctx.tagsMatcher_, jctx.fieldsFilter_, jctx.schema_);
 }
 
-template void ReindexerImpl::doSelect(const Query&, QueryResults&, NsLocker<RdxContext>&, SelectFunctionsHolder&, const RdxContext&);
+template void ReindexerImpl::doSelect(const Query&, QueryResults&, NsLocker<RdxContext>&, SelectFunctionsHolder&, const RdxContext&,
+									  QueryTrace*, SlowQuery*);
 
 Error ReindexerImpl::Commit(std::string_view /*_namespace*/) {
 	try {
@@ -1069,6 +1542,26 @@ Error ReindexerImpl::Commit(std::string_view /*_namespace*/) {
 }
 
 Namespace::Ptr ReindexerImpl::getNamespace(std::string_view nsName, const RdxContext& ctx) {
+	auto ns = getNamespaceNoLoad(nsName, ctx);
+	ns->LoadLazyItems(ctx);
+	return ns;
+}
+
+Namespace::Ptr ReindexerImpl::getNamespaceNoThrow(std::string_view nsName, const RdxContext& ctx) {
+	Namespace::Ptr ns;
+	{
+		SLock lock(mtx_, &ctx);
+		auto nsIt = namespaces_.find(nsName);
+		if (nsIt == namespaces_.end()) {
+			return nullptr;
+		}
+		ns = nsIt->second;
+	}
+	ns->LoadLazyItems(ctx);
+	return ns;
+}
+
+Namespace::Ptr ReindexerImpl::getNamespaceNoLoad(std::string_view nsName, const RdxContext& ctx) {
 	SLock lock(mtx_, &ctx);
 	auto nsIt = namespaces_.find(nsName);
 
@@ -1080,12 +1573,6 @@ Namespace::Ptr ReindexerImpl::getNamespace(std::string_view nsName, const RdxCon
 	return nsIt->second;
 }
 
-Namespace::Ptr ReindexerImpl::getNamespaceNoThrow(std::string_view nsName, const RdxContext& ctx) {
-	SLock lock(mtx_, &ctx);
-	auto nsIt = namespaces_.find(nsName);
-	return (nsIt == namespaces_.end()) ? nullptr : nsIt->second;
-}
-
 Error ReindexerImpl::AddIndex(std::string_view nsName, const IndexDef& indexDef, const InternalRdxContext& ctx) {
 	const auto makeCtxStr = [nsName, &indexDef](WrSerializer& ser) -> WrSerializer& {
 		return ser << "CREATE INDEX " << indexDef.name_ << " ON " << nsName;
@@ -1183,20 +1670,59 @@ Error ReindexerImpl::EnumNamespaces(vector<NamespaceDef>& defs, EnumNamespacesOp
 	return errOK;
 }
 
+Error ReindexerImpl::GetNamespacesMetrics(std::vector<NamespaceMetrics>& metrics, const InternalRdxContext& ctx) {
+	try {
+		const auto rdxCtx = ctx.CreateRdxContext(""sv, activities_);
+		const bool perfStats = configProvider_.GetProfilingConfig().perfStats;
+		auto nsarray = getNamespaces(rdxCtx);
+		metrics.reserve(metrics.size() + nsarray.size());
+		for (auto& nspair : nsarray) {
+			if (!nspair.first.empty() && nspair.first[0] == '#') continue;
+			metrics.emplace_back(nspair.second->GetMetrics(perfStats));
+			metrics.back().name = nspair.first;
+		}
+	} catch (const Error& err) {
+		return err;
+	}
+	return errOK;
+}
+
 void ReindexerImpl::backgroundRoutine() {
 	static const RdxContext dummyCtx;
-	auto nsBackground = [&]() {
+	static constexpr auto kTasksPeriod = std::chrono::milliseconds(100);
+	auto nsBackground = [this](const string& name, unsigned tasks) noexcept {
+		try {
+			auto ns = getNamespaceNoLoad(name, dummyCtx);
+			ns->BackgroundRoutine(nullptr, tasks);
+		} catch (Error err) {
+			logPrintf(LogWarning, "backgroundRoutine() failed: %s", err.what());
+		} catch (...) {
+			logPrintf(LogWarning, "backgroundRoutine() failed with ns: %s", name);
+		}
+	};
+	std::unordered_set<string> scheduled;
+	auto lastWarmStateSave = std::chrono::steady_clock::now();
+	auto syncScheduledNamespaces = [&]() {
 		auto nsarray = getNamespacesNames(dummyCtx);
-		for (auto name : nsarray) {
-			try {
-				auto ns = getNamespace(name, dummyCtx);
-				ns->BackgroundRoutine(nullptr);
-			} catch (Error err) {
-				logPrintf(LogWarning, "backgroundRoutine() failed: %s", err.what());
-			} catch (...) {
-				logPrintf(LogWarning, "backgroundRoutine() failed with ns: %s", name);
+		const std::unordered_set<string> actual(nsarray.begin(), nsarray.end());
+		for (auto it = scheduled.begin(); it != scheduled.end();) {
+			if (actual.find(*it) == actual.end()) {
+				maintenance_.Remove(*it);
+				it = scheduled.erase(it);
+			} else {
+				++it;
 			}
 		}
+		for (auto& name : nsarray) {
+			if (!scheduled.emplace(name).second) continue;
+			using Priority = MaintenanceScheduler::Priority;
+			maintenance_.Schedule(name, Priority::High, kTasksPeriod, [nsBackground, name] { nsBackground(name, BackgroundExpiration); });
+			maintenance_.Schedule(name, Priority::Normal, kTasksPeriod,
+								  [nsBackground, name] { nsBackground(name, BackgroundOptimization); });
+			maintenance_.Schedule(name, Priority::Low, kTasksPeriod, [nsBackground, name] { nsBackground(name, BackgroundSnapshots); });
+		}
+	};
+	auto checkReplConfig = [&]() {
 		std::string yamlReplConf;
 		bool replConfigWasModified = replConfigFileChecker_.ReadIfFileWasModified(yamlReplConf);
 		if (replConfigWasModified) {
@@ -1210,11 +1736,129 @@ void ReindexerImpl::backgroundRoutine() {
 	};
 
 	while (!stopBackgroundThreads_) {
-		nsBackground();
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		syncScheduledNamespaces();
+		checkReplConfig();
+		releaseDroppedNamespaces();
+		const auto now = std::chrono::steady_clock::now();
+		if (now - lastWarmStateSave >= std::chrono::seconds(configProvider_.GetMaintenanceConfig().warmStatePeriodSec)) {
+			saveWarmState();
+			lastWarmStateSave = now;
+		}
+		std::this_thread::sleep_for(kTasksPeriod);
 	}
 
-	nsBackground();
+	maintenance_.Stop();
+	for (auto& name : getNamespacesNames(dummyCtx)) nsBackground(name, BackgroundAll);
+	checkReplConfig();
+	saveWarmState();
+}
+
+void ReindexerImpl::releaseDroppedNamespaces() {
+	// Memory is released without the lock, so the drop of the next namespace is not blocked
+	std::vector<Namespace::Ptr> dropped;
+	{
+		std::lock_guard lck(droppedNamespacesMtx_);
+		dropped.swap(droppedNamespaces_);
+	}
+	dropped.erase(std::remove_if(dropped.begin(), dropped.end(), [](const Namespace::Ptr &ns) { return ns->ReleaseGarbage(); }),
+				  dropped.end());
+	if (!dropped.empty()) {
+		std::lock_guard lck(droppedNamespacesMtx_);
+		droppedNamespaces_.insert(droppedNamespaces_.end(), std::make_move_iterator(dropped.begin()),
+								  std::make_move_iterator(dropped.end()));
+	}
+}
+
+void ReindexerImpl::startWarmup() {
+	if (storagePath_.empty() || !configProvider_.GetMaintenanceConfig().warmupQueries) return;
+	WarmState state;
+	Error err;
+	if (!state.Load(fs::JoinPath(storagePath_, kWarmStateFilename), err)) return;
+	if (!err.ok()) {
+		logPrintf(LogWarning, "Can't load warm state of '%s': %s", storagePath_, err.what());
+		return;
+	}
+	warmedUp_.store(false, std::memory_order_release);
+	warmupThread_ = std::thread([this, state = std::move(state)] {
+		debug::CPUSampler::RegisterThread(debug::ThreadRole::Background);
+		warmupRoutine(state);
+	});
+}
+
+void ReindexerImpl::warmupRoutine(const WarmState& state) {
+	static const RdxContext dummyCtx;
+	static constexpr auto kPollPeriod = std::chrono::milliseconds(100);
+	// Idsets and joins are cached only after the sort orders are built, so the queries are replayed after them
+	const auto deadline = std::chrono::steady_clock::now() + kMaxSortOrdersWaiting;
+	for (auto& name : state.sortedNamespaces) {
+		try {
+			// Lazily loaded namespace is loaded here, since the traffic used it before the restart
+			auto ns = getNamespaceNoThrow(name, dummyCtx);
+			while (ns && !stopBackgroundThreads_ && !ns->SortOrdersBuilt() && std::chrono::steady_clock::now() < deadline) {
+				std::this_thread::sleep_for(kPollPeriod);
+			}
+		} catch (const Error& err) {
+			logPrintf(LogWarning, "Warmup of namespace '%s' failed: %s", name, err.what());
+		}
+	}
+	size_t replayed = 0;
+	for (auto& entry : state.queries) {
+		if (stopBackgroundThreads_) break;
+		Query q;
+		try {
+			q.FromSQL(entry.sql);
+		} catch (const Error& err) {
+			logPrintf(LogWarning, "Warmup query '%s' is not valid: %s", entry.sql, err.what());
+			continue;
+		}
+		if (q.type_ != QuerySelect) continue;
+		// Entries of the caches are created after the several hits of the same key
+		for (int i = 0; i <= kDefaultHitCountToCache && !stopBackgroundThreads_; ++i) {
+			QueryResults qr;
+			if (Error err = Select(q, qr, InternalRdxContext()); !err.ok()) {
+				logPrintf(LogWarning, "Warmup query '%s' failed: %s", entry.sql, err.what());
+				break;
+			}
+		}
+		++replayed;
+	}
+	logPrintf(LogInfo, "Warmup of '%s' is done: %d queries are replayed", storagePath_, replayed);
+	warmedUp_.store(true, std::memory_order_release);
+}
+
+void ReindexerImpl::saveWarmState() {
+	static const RdxContext dummyCtx;
+	const size_t maxQueries = configProvider_.GetMaintenanceConfig().warmupQueries;
+	// State of the previous run is not replaced, until it is replayed
+	if (storagePath_.empty() || !maxQueries || !connected_.load(std::memory_order_acquire) || !IsWarmedUp()) return;
+	WarmState state;
+	auto stats = queriesStatTracker_.Data();
+	std::sort(stats.begin(), stats.end(), [](const QueryPerfStat& l, const QueryPerfStat& r) {
+		return l.perf.totalHitCount > r.perf.totalHitCount;
+	});
+	for (auto& stat : stats) {
+		if (state.queries.size() >= maxQueries) break;
+		// Selects from the system namespaces do not warm anything up
+		Query q;
+		try {
+			q.FromSQL(stat.longestQuery);
+		} catch (const Error&) {
+			continue;
+		}
+		if (q.type_ != QuerySelect || (!q._namespace.empty() && q._namespace[0] == '#')) continue;
+		state.queries.push_back({std::move(stat.longestQuery), stat.perf.totalHitCount});
+	}
+	try {
+		for (auto& ns : getNamespaces(dummyCtx)) {
+			if (ns.second->SortOrdersBuilt()) state.sortedNamespaces.push_back(ns.first);
+		}
+	} catch (const Error& err) {
+		logPrintf(LogWarning, "Can't collect warm state of '%s': %s", storagePath_, err.what());
+		return;
+	}
+	if (Error err = state.Save(fs::JoinPath(storagePath_, kWarmStateFilename)); !err.ok()) {
+		logPrintf(LogWarning, "%s", err.what());
+	}
 }
 
 void ReindexerImpl::storageFlushingRoutine() {
@@ -1223,7 +1867,7 @@ void ReindexerImpl::storageFlushingRoutine() {
 		auto nsarray = getNamespacesNames(dummyCtx);
 		for (auto name : nsarray) {
 			try {
-				auto ns = getNamespace(name, dummyCtx);
+				auto ns = getNamespaceNoLoad(name, dummyCtx);
 				ns->StorageFlushingRoutine();
 			} catch (Error err) {
 				logPrintf(LogWarning, "storageFlushingRoutine() failed: %s", err.what());
@@ -1369,6 +2013,10 @@ void ReindexerImpl::updateToSystemNamespace(std::string_view nsName, Item& item,
 		}
 	} else if (nsName == kQueriesPerfStatsNamespace) {
 		queriesStatTracker_.Reset();
+	} else if (nsName == kQueryTracesNamespace) {
+		queryTracer_.Reset();
+	} else if (nsName == kSlowQueriesNamespace) {
+		slowQueryLog_.Reset();
 	} else if (nsName == kPerfStatsNamespace) {
 		for (auto& ns : getNamespaces(ctx)) ns.second->ResetPerfStat(ctx);
 	}
@@ -1469,6 +2117,57 @@ void ReindexerImpl::syncSystemNamespaces(std::string_view sysNsName, std::string
 		queriesperfstatsNs->Refill(items, NsContext(ctx));
 	}
 
+	if (profilingCfg.queriesPerfStats && sysNsName == kIndexAdvicesNamespace) {
+		const auto advices = IndexAdvisor::Advise(queriesStatTracker_.Data(), [&](std::string_view nsName, IndexAdvisor::NsInfo& info) {
+			auto ns = getNamespaceNoThrow(nsName, ctx);
+			if (!ns) return false;
+			info.def = ns->GetDefinition(ctx);
+			info.itemsCount = ns->GetItemsCount();
+			return true;
+		});
+		std::vector<Item> items;
+		items.reserve(advices.size());
+		auto indexAdvicesNs = getNamespace(kIndexAdvicesNamespace, ctx);
+		for (const auto& advice : advices) {
+			ser.Reset();
+			advice.GetJSON(ser);
+			items.push_back(indexAdvicesNs->NewItem(ctx));
+			auto err = items.back().FromJSON(ser.Slice());
+			if (!err.ok()) throw err;
+		}
+		indexAdvicesNs->Refill(items, NsContext(ctx));
+	}
+
+	if (sysNsName == kQueryTracesNamespace) {
+		const auto data = queryTracer_.Data();
+		std::vector<Item> items;
+		items.reserve(data.size());
+		auto queryTracesNs = getNamespace(kQueryTracesNamespace, ctx);
+		for (const auto& trace : data) {
+			ser.Reset();
+			trace.GetJSON(ser);
+			items.push_back(queryTracesNs->NewItem(ctx));
+			auto err = items.back().FromJSON(ser.Slice());
+			if (!err.ok()) throw err;
+		}
+		queryTracesNs->Refill(items, NsContext(ctx));
+	}
+
+	if (sysNsName == kSlowQueriesNamespace) {
+		const auto data = slowQueryLog_.Data();
+		std::vector<Item> items;
+		items.reserve(data.size());
+		auto slowQueriesNs = getNamespace(kSlowQueriesNamespace, ctx);
+		for (const auto& query : data) {
+			ser.Reset();
+			query.GetJSON(ser);
+			items.push_back(slowQueriesNs->NewItem(ctx));
+			auto err = items.back().FromJSON(ser.Slice());
+			if (!err.ok()) throw err;
+		}
+		slowQueriesNs->Refill(items, NsContext(ctx));
+	}
+
 	if (sysNsName == kActivityStatsNamespace) {
 		const auto data = activities_.List();
 		std::vector<Item> items;
@@ -1512,6 +2211,21 @@ void ReindexerImpl::syncSystemNamespaces(std::string_view sysNsName, std::string
 			clientsNs->Refill(items, NsContext(ctx));
 		}
 	}
+	if (sysNsName == kReplicationStatsNamespace) {
+		const auto stats = replicator_->GetReplicationStats();
+		auto replStatsNs = getNamespace(kReplicationStatsNamespace, ctx);
+		std::vector<Item> items;
+		items.reserve(stats.size());
+		for (const auto& stat : stats) {
+			if (!filterNsName.empty() && !iequals(filterNsName, stat.name)) continue;
+			ser.Reset();
+			stat.GetJSON(ser);
+			items.emplace_back(replStatsNs->NewItem(ctx));
+			auto err = items.back().FromJSON(ser.Slice());
+			if (!err.ok()) throw err;
+		}
+		replStatsNs->Refill(items, NsContext(ctx));
+	}
 }
 
 void ReindexerImpl::onProfiligConfigLoad() {
@@ -1521,6 +2235,15 @@ void ReindexerImpl::onProfiligConfigLoad() {
 	Delete(Query(kPerfStatsNamespace), qr1);
 }
 
+void ReindexerImpl::onMaintenanceConfigLoad() {
+	const auto data = configProvider_.GetMaintenanceConfig();
+	MaintenanceScheduler::Config cfg;
+	cfg.workers = data.workers;
+	cfg.deferLoadThreshold = data.deferLoadThreshold;
+	cfg.maxDeferral = std::chrono::milliseconds(data.maxDeferralMs);
+	maintenance_.SetConfig(cfg);
+}
+
 Error ReindexerImpl::SubscribeUpdates(IUpdatesObserver* observer, const UpdatesFilters& filters, SubscriptionOpts opts) {
 	return observers_.Add(observer, filters, opts);
 }
@@ -6,13 +6,18 @@
 #include <thread>
 
 #include "core/namespace/namespace.h"
+#include "core/lrucache.h"
 #include "core/nsselecter/nsselecter.h"
+#include "core/query/preparedquery.h"
 #include "core/rdxcontext.h"
 #include "dbconfig.h"
+#include "maintenancescheduler.h"
 #include "estl/fast_hash_map.h"
 #include "estl/h_vector.h"
 #include "estl/smart_lock.h"
 #include "querystat.h"
+#include "querytrace.h"
+#include "slowquerylog.h"
 #include "replicator/updatesobserver.h"
 #include "tools/errors.h"
 #include "tools/filecontentwatcher.h"
@@ -23,8 +28,11 @@ namespace reindexer {
 class Replicator;
 class IClientsStats;
 class ProtobufSchema;
+struct WarmState;
 
 class ReindexerImpl {
+	static constexpr size_t kPreparedQueriesCacheSize = 16 * 1024 * 1024;
+
 	using Mutex = MarkedMutex<shared_timed_mutex, MutexMark::Reindexer>;
 	using StorageMutex = MarkedMutex<shared_timed_mutex, MutexMark::ReindexerStorage>;
 	struct NsLockerItem {
@@ -69,15 +77,22 @@ public:
 	Error Upsert(std::string_view nsName, Item &item, const InternalRdxContext &ctx = InternalRdxContext());
 	Error Upsert(std::string_view nsName, Item &item, QueryResults &, const InternalRdxContext &ctx = InternalRdxContext());
 	Error Delete(std::string_view nsName, Item &item, const InternalRdxContext &ctx = InternalRdxContext());
+	Error ModifyItems(std::string_view nsName, span<Item> items, ItemModifyMode mode, span<Error> itemsErrors = {},
+					  const InternalRdxContext &ctx = InternalRdxContext());
 	Error Delete(std::string_view nsName, Item &item, QueryResults &, const InternalRdxContext &ctx = InternalRdxContext());
 	Error Delete(const Query &query, QueryResults &result, const InternalRdxContext &ctx = InternalRdxContext());
 	Error Select(std::string_view query, QueryResults &result, const InternalRdxContext &ctx = InternalRdxContext());
+	Error Select(std::string_view query, const VariantArray &params, QueryResults &result,
+				 const InternalRdxContext &ctx = InternalRdxContext());
 	Error Select(const Query &query, QueryResults &result, const InternalRdxContext &ctx = InternalRdxContext());
+	Error GetByPK(std::string_view nsName, const VariantArray &keys, QueryResults &result,
+				  const InternalRdxContext &ctx = InternalRdxContext());
 	Error Commit(std::string_view nsName);
 	Item NewItem(std::string_view nsName, const InternalRdxContext &ctx = InternalRdxContext());
 
 	Transaction NewTransaction(std::string_view nsName, const InternalRdxContext &ctx = InternalRdxContext());
 	Error CommitTransaction(Transaction &tr, QueryResults &result, const InternalRdxContext &ctx = InternalRdxContext());
+	Error CommitTransactions(span<Transaction> txs, span<QueryResults> results, const InternalRdxContext &ctx = InternalRdxContext());
 	Error RollBackTransaction(Transaction &tr);
 
 	Error GetMeta(std::string_view nsName, const string &key, string &data, const InternalRdxContext &ctx = InternalRdxContext());
@@ -89,7 +104,10 @@ public:
 	Error GetSqlSuggestions(std::string_view sqlQuery, int pos, vector<string> &suggestions,
 							const InternalRdxContext &ctx = InternalRdxContext());
 	Error GetProtobufSchema(WrSerializer &ser, vector<string> &namespaces);
+	Error GetNamespacesMetrics(std::vector<NamespaceMetrics> &metrics, const InternalRdxContext &ctx = InternalRdxContext());
 	Error Status();
+	/// @return false, while the warm state of the previous run is replayed (see 'warmup_queries' of the maintenance config)
+	bool IsWarmedUp() const noexcept { return warmedUp_.load(std::memory_order_acquire); }
 
 	bool NeedTraceActivity() { return configProvider_.GetProfilingConfig().activityStats; }
 
@@ -154,19 +172,36 @@ protected:
 			}
 			return nullptr;
 		}
+		NsDataVersions DataVersions() const {
+			NsDataVersions versions;
+			for (auto it = begin(); it != end(); ++it) versions.push_back(it->ns->dataVersion_);
+			std::sort(versions.begin(), versions.end());
+			return versions;
+		}
+		// Holds the data of all the locked namespaces by the results, which are not selected from them (e.g. the cached ones)
+		void AddNamespacesTo(QueryResults &result) {
+			for (auto it = begin(); it != end(); ++it) result.AddNamespace(it->ns, {context_, true});
+		}
 
 	protected:
 		bool locked_ = false;
 		const Context &context_;
 	};
 	template <typename T>
-	void doSelect(const Query &q, QueryResults &result, NsLocker<T> &locks, SelectFunctionsHolder &func, const RdxContext &ctx);
+	void doSelect(const Query &q, QueryResults &result, NsLocker<T> &locks, SelectFunctionsHolder &func, const RdxContext &ctx,
+				  QueryTrace *trace, SlowQuery *slowQuery);
+	template <typename T>
+	static void touchResultsItems(const Query &q, const QueryResults &result, NsLocker<T> &locks);
+	void addSlowQuery(const Query &q, SlowQuery &&slowQuery);
 	struct QueryResultsContext;
 	template <typename T>
 	JoinedSelectors prepareJoinedSelectors(const Query &q, QueryResults &result, NsLocker<T> &locks, SelectFunctionsHolder &func,
-										   vector<QueryResultsContext> &, const RdxContext &ctx);
+										   vector<QueryResultsContext> &, const RdxContext &ctx, QueryTrace *trace, SlowQuery *slowQuery,
+										   bool bestEffort);
 	void prepareJoinResults(const Query &q, QueryResults &result);
 	static bool isPreResultValuesModeOptimizationAvailable(const Query &jItemQ, const NamespaceImpl::Ptr &jns);
+	// Parses the query with placeholders or takes it from the cache of the prepared queries
+	std::shared_ptr<const PreparedQuery> getPreparedQuery(std::string_view sql);
 
 	void syncSystemNamespaces(std::string_view sysNsName, std::string_view filterNsName, const RdxContext &ctx);
 	void createSystemNamespaces();
@@ -174,17 +209,26 @@ protected:
 	void updateConfigProvider(const gason::JsonNode &config);
 	void updateReplicationConfFile();
 	void onProfiligConfigLoad();
+	void onMaintenanceConfigLoad();
 	Error tryLoadReplicatorConfFromFile();
 	Error tryLoadReplicatorConfFromYAML(const std::string &yamlReplConf);
 
 	void backgroundRoutine();
 	void storageFlushingRoutine();
+	void startWarmup();
+	void warmupRoutine(const WarmState &state);
+	void saveWarmState();
+	// Releases the next portion of the data of each dropped namespace. Namespace is destroyed, when its data is released completely
+	void releaseDroppedNamespaces();
 	Error closeNamespace(std::string_view nsName, const RdxContext &ctx, bool dropStorage, bool enableDropSlave = false);
 
 	Error syncDownstream(std::string_view nsName, bool force, const InternalRdxContext &ctx = InternalRdxContext());
 
+	// Items of the lazily loaded namespace are loaded on the first getNamespace/getNamespaceNoThrow call
 	Namespace::Ptr getNamespace(std::string_view nsName, const RdxContext &ctx);
 	Namespace::Ptr getNamespaceNoThrow(std::string_view nsName, const RdxContext &ctx);
+	// Does not load lazily loaded namespace. May be used only for the calls, which do not access namespace's data
+	Namespace::Ptr getNamespaceNoLoad(std::string_view nsName, const RdxContext &ctx);
 
 	std::vector<std::pair<string, Namespace::Ptr>> getNamespaces(const RdxContext &ctx);
 	std::vector<string> getNamespacesNames(const RdxContext &ctx);
@@ -198,9 +242,18 @@ protected:
 
 	std::thread backgroundThread_;
 	std::thread storageFlushingThread_;
+	std::thread warmupThread_;
 	std::atomic<bool> stopBackgroundThreads_;
+	std::atomic<bool> warmedUp_ = {true};
+	// Executes the background tasks of the namespaces. Set of the scheduled namespaces is synchronized by the background thread
+	MaintenanceScheduler maintenance_;
+	// Dropped namespaces, which data is released by the background thread (see NamespaceImpl::DropData)
+	std::mutex droppedNamespacesMtx_;
+	std::vector<Namespace::Ptr> droppedNamespaces_;
 
 	QueriesStatTracer queriesStatTracker_;
+	QueryTracer queryTracer_;
+	SlowQueryLog slowQueryLog_;
 	UpdatesObservers observers_;
 	std::unique_ptr<Replicator> replicator_;
 	DBConfigProvider configProvider_;
@@ -217,6 +270,11 @@ protected:
 
 	IClientsStats *clientsStats_ = nullptr;
 
+	// Parsed SQL queries with placeholders by their text. Parsed query does not depend on the namespaces' schemas, so the cache is
+	// not invalidated by the indexes changes
+	using PreparedQueriesCache = LRUCache<PreparedQueryCacheKey, PreparedQueryCacheVal, HashPreparedQueryCacheKey, EqPreparedQueryCacheKey>;
+	PreparedQueriesCache preparedQueries_{kPreparedQueriesCacheSize, 1};
+
 	friend class Replicator;
 	friend class TransactionImpl;
 };
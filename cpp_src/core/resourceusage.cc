@@ -0,0 +1,100 @@
+#include "resourceusage.h"
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+
+namespace reindexer {
+
+constexpr unsigned kWindowCpuBits = 40;
+constexpr uint64_t kWindowCpuMask = (uint64_t(1) << kWindowCpuBits) - 1;
+constexpr uint64_t kWindowSecMask = (uint64_t(1) << (64 - kWindowCpuBits)) - 1;
+
+thread_local ResourceUsageScope *ResourceUsageScope::current_ = nullptr;
+
+uint64_t ResourceAccount::nowSec() noexcept {
+	using namespace std::chrono;
+	return uint64_t(duration_cast<seconds>(steady_clock::now().time_since_epoch()).count()) & kWindowSecMask;
+}
+
+Error ResourceAccount::Admit(bool withResults) {
+	if (quotas_.cpuUsPerSec) {
+		const uint64_t window = window_.load(std::memory_order_relaxed);
+		if ((window >> kWindowCpuBits) == nowSec() && (window & kWindowCpuMask) >= quotas_.cpuUsPerSec) {
+			rejectedOps_.fetch_add(1, std::memory_order_relaxed);
+			return Error(errQuotaExceeded, "CPU time quota (%d us per second) is exceeded, retry later", quotas_.cpuUsPerSec);
+		}
+	}
+	if (withResults && quotas_.resultsBytes && resultsBytes_.load(std::memory_order_relaxed) >= int64_t(quotas_.resultsBytes)) {
+		rejectedOps_.fetch_add(1, std::memory_order_relaxed);
+		return Error(errQuotaExceeded, "Query results memory quota (%d bytes) is exceeded, close the unused results", quotas_.resultsBytes);
+	}
+	return Error();
+}
+
+void ResourceAccount::AddOp(uint64_t cpuUs, uint64_t rows, bool canceled) noexcept {
+	cpuUs_.fetch_add(cpuUs, std::memory_order_relaxed);
+	rowsExamined_.fetch_add(rows, std::memory_order_relaxed);
+	ops_.fetch_add(1, std::memory_order_relaxed);
+	if (canceled) canceledOps_.fetch_add(1, std::memory_order_relaxed);
+	if (!quotas_.cpuUsPerSec) return;
+
+	const uint64_t sec = nowSec();
+	uint64_t window = window_.load(std::memory_order_relaxed), newWindow;
+	do {
+		const uint64_t spent = (window >> kWindowCpuBits) == sec ? (window & kWindowCpuMask) : 0;
+		newWindow = (sec << kWindowCpuBits) | std::min(spent + cpuUs, kWindowCpuMask);
+	} while (!window_.compare_exchange_weak(window, newWindow, std::memory_order_relaxed));
+}
+
+ResourceAccount::Snapshot ResourceAccount::Get() const noexcept {
+	Snapshot ret;
+	ret.cpuUs = cpuUs_.load(std::memory_order_relaxed);
+	ret.rowsExamined = rowsExamined_.load(std::memory_order_relaxed);
+	ret.resultsBytes = resultsBytes_.load(std::memory_order_relaxed);
+	ret.ops = ops_.load(std::memory_order_relaxed);
+	ret.canceledOps = canceledOps_.load(std::memory_order_relaxed);
+	ret.rejectedOps = rejectedOps_.load(std::memory_order_relaxed);
+	return ret;
+}
+
+uint64_t ResourceUsageScope::threadCpuUs() noexcept {
+#ifndef _WIN32
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+	return uint64_t(ts.tv_sec) * 1000000 + uint64_t(ts.tv_nsec) / 1000;
+#else
+	return 0;
+#endif
+}
+
+ResourceUsageScope::ResourceUsageScope(ResourceAccount &account) noexcept
+	: account_(account), prev_(current_), thread_(std::this_thread::get_id()), startCpuUs_(threadCpuUs()) {
+	current_ = this;
+}
+
+ResourceUsageScope::~ResourceUsageScope() {
+	current_ = prev_;
+	account_.AddOp(threadCpuUs() - startCpuUs_, rows_.load(std::memory_order_relaxed), exceeded_.load(std::memory_order_relaxed));
+}
+
+CancelType ResourceUsageScope::GetCancelType() const noexcept {
+	if (exceeded_.load(std::memory_order_relaxed)) return CancelType::Explicit;
+	const auto &quotas = account_.Quotas();
+	bool exceeded = quotas.rowsPerOp && rows_.load(std::memory_order_relaxed) > quotas.rowsPerOp;
+	// CPU time is measured for the thread, which has started the operation. Checks from the other threads (i.e. parallel scan) are skipped
+	if (!exceeded && quotas.cpuUsPerOp && thread_ == std::this_thread::get_id()) {
+		exceeded = threadCpuUs() - startCpuUs_ > quotas.cpuUsPerOp;
+	}
+	if (!exceeded) return CancelType::None;
+	exceeded_.store(true, std::memory_order_relaxed);
+	return CancelType::Explicit;
+}
+
+Error ResourceUsageScope::Result(Error &&err) const {
+	if (err.code() != errCanceled || !exceeded_.load(std::memory_order_relaxed)) return std::move(err);
+	const auto &quotas = account_.Quotas();
+	return Error(errQuotaExceeded, "Operation is canceled: quota of the single operation (%d us of CPU time, %d rows) is exceeded",
+				 quotas.cpuUsPerOp, quotas.rowsPerOp);
+}
+
+}  // namespace reindexer
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include "rdxcontext.h"
+
+namespace reindexer {
+
+/// Limits of the resources of one client. Zero value means no limit
+struct ResourceQuotas {
+	// CPU time of the single operation. Operation is canceled, when it's exceeded
+	uint64_t cpuUsPerOp = 0;
+	// Rows, examined by the single operation. Operation is canceled, when it's exceeded
+	uint64_t rowsPerOp = 0;
+	// CPU time of all the operations of the client per second. New operations are rejected, while the budget of the current second is spent
+	uint64_t cpuUsPerSec = 0;
+	// Memory, held by the query results of the client. New selects are rejected, while it's exceeded
+	uint64_t resultsBytes = 0;
+
+	bool HasOpLimits() const noexcept { return cpuUsPerOp || rowsPerOp; }
+};
+
+/// Resources, consumed by the operations of one client (user or application)
+class ResourceAccount {
+public:
+	struct Snapshot {
+		uint64_t cpuUs = 0;
+		uint64_t rowsExamined = 0;
+		int64_t resultsBytes = 0;
+		uint64_t ops = 0;
+		uint64_t canceledOps = 0;
+		uint64_t rejectedOps = 0;
+	};
+
+	explicit ResourceAccount(const ResourceQuotas &quotas) noexcept : quotas_(quotas) {}
+
+	const ResourceQuotas &Quotas() const noexcept { return quotas_; }
+	/// Checks the quotas, which are applied before the start of the operation
+	/// @param withResults - operation keeps its query results until they are fetched by the client
+	/// @return errQuotaExceeded, if the operation has to be rejected
+	Error Admit(bool withResults);
+	void AddOp(uint64_t cpuUs, uint64_t rows, bool canceled) noexcept;
+	void AddResultsBytes(int64_t bytes) noexcept { resultsBytes_.fetch_add(bytes, std::memory_order_relaxed); }
+	Snapshot Get() const noexcept;
+
+private:
+	static uint64_t nowSec() noexcept;
+
+	const ResourceQuotas quotas_;
+	std::atomic<uint64_t> cpuUs_{0};
+	std::atomic<uint64_t> rowsExamined_{0};
+	std::atomic<int64_t> resultsBytes_{0};
+	std::atomic<uint64_t> ops_{0};
+	std::atomic<uint64_t> canceledOps_{0};
+	std::atomic<uint64_t> rejectedOps_{0};
+	// CPU time, spent during the current second. The second is packed into the high 24 bits
+	std::atomic<uint64_t> window_{0};
+};
+
+/// Accounting of the single operation, which is executed by the current thread. CPU time of the thread and rows, examined by the selects,
+/// are charged to the account at the end of the scope. Scope is also the cancel context of the operation: it's canceled, when the quotas of
+/// the single operation are exceeded
+class ResourceUsageScope : public IRdxCancelContext {
+public:
+	explicit ResourceUsageScope(ResourceAccount &account) noexcept;
+	~ResourceUsageScope() override;
+	ResourceUsageScope(const ResourceUsageScope &) = delete;
+	ResourceUsageScope &operator=(const ResourceUsageScope &) = delete;
+
+	/// Charges the rows, which are going to be examined by the select loop, to the scope of the current thread
+	static void AddRowsExamined(uint64_t rows) noexcept {
+		if (current_) current_->rows_.fetch_add(rows, std::memory_order_relaxed);
+	}
+
+	CancelType GetCancelType() const noexcept override final;
+	bool IsCancelable() const noexcept override final { return account_.Quotas().HasOpLimits(); }
+	/// Replaces the cancelation error of the operation, which was canceled by the quota, with errQuotaExceeded
+	Error Result(Error &&err) const;
+
+private:
+	static uint64_t threadCpuUs() noexcept;
+
+	static thread_local ResourceUsageScope *current_;
+	ResourceAccount &account_;
+	ResourceUsageScope *prev_;
+	const std::thread::id thread_;
+	const uint64_t startCpuUs_;
+	std::atomic<uint64_t> rows_{0};
+	mutable std::atomic<bool> exceeded_{false};
+};
+
+}  // namespace reindexer
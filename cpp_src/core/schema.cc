@@ -30,8 +30,20 @@ std::string_view kvTypeToJsonSchemaType(KeyValueType type) {
 	}
 }
 
+SchemaFieldTypesNode& SchemaFieldTypesNode::AddPath(const TagsPath& path, size_t depth) {
+	if (depth == path.size()) return *this;
+	const auto it = std::lower_bound(childrenTags.begin(), childrenTags.end(), path[depth]);
+	const size_t pos = it - childrenTags.begin();
+	if (it == childrenTags.end() || *it != path[depth]) {
+		childrenTags.insert(it, path[depth]);
+		children.emplace(children.begin() + pos);
+	}
+	return children[pos].AddPath(path, depth + 1);
+}
+
 void SchemaFieldsTypes::AddObject(std::string_view objectType) {
 	types_[tagsPath_] = {KeyValueComposite, false};
+	typesTree_.AddPath(tagsPath_).type = {KeyValueComposite, false};
 	auto it = objectTypes_.find(string(objectType));
 	if (it == objectTypes_.end()) {
 		objectTypes_.emplace(std::string(objectType), tagsPath_.size());
@@ -43,7 +55,10 @@ void SchemaFieldsTypes::AddObject(std::string_view objectType) {
 	}
 }
 
-void SchemaFieldsTypes::AddField(KeyValueType type, bool isArray) { types_[tagsPath_] = {type, isArray}; }
+void SchemaFieldsTypes::AddField(KeyValueType type, bool isArray) {
+	types_[tagsPath_] = {type, isArray};
+	typesTree_.AddPath(tagsPath_).type = {type, isArray};
+}
 
 bool SchemaFieldsTypes::NeedToEmbedType(string objectType) const {
 	auto it = objectTypes_.find(objectType);
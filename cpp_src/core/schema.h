@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 #include "core/cjson/tagsmatcher.h"
@@ -60,11 +61,26 @@ struct SchemaFieldType {
 	bool isArray_;
 };
 
+/// Types of the schema fields by the tags of the nested objects. Encoders keep the node of the current object,
+/// so the type of each field is resolved by its tag only, without the lookup of the whole tags path
+struct SchemaFieldTypesNode {
+	const SchemaFieldTypesNode* Child(int tag) const noexcept {
+		const auto it = std::lower_bound(childrenTags.begin(), childrenTags.end(), tag);
+		return (it == childrenTags.end() || *it != tag) ? nullptr : &children[it - childrenTags.begin()];
+	}
+	SchemaFieldTypesNode& AddPath(const TagsPath& path, size_t depth = 0);
+
+	SchemaFieldType type{KeyValueUndefined, false};
+	std::vector<int> childrenTags;
+	std::vector<SchemaFieldTypesNode> children;
+};
+
 class SchemaFieldsTypes {
 public:
 	void AddObject(std::string_view objectType);
 	void AddField(KeyValueType type, bool isArray);
 	KeyValueType GetField(const TagsPath& fieldPath, bool& isArray) const;
+	const SchemaFieldTypesNode& GetTypesTree() const noexcept { return typesTree_; }
 	string GenerateObjectName();
 
 	bool NeedToEmbedType(string objectType) const;
@@ -74,6 +90,7 @@ private:
 
 	TagsPath tagsPath_;
 	std::unordered_map<TagsPath, SchemaFieldType> types_;
+	SchemaFieldTypesNode typesTree_;
 	std::unordered_map<string, int> objectTypes_;
 	int generatedObjectsNames = {0};
 };
@@ -120,6 +137,7 @@ public:
 	std::vector<string> GetSuggestions(std::string_view path) const { return paths_.GetSuggestions(path); }
 	std::vector<std::string> GetPaths() const noexcept { return paths_.GetPaths(); }
 	KeyValueType GetFieldType(const TagsPath& fieldPath, bool& isArray) const;
+	const SchemaFieldTypesNode& GetFieldTypesTree() const noexcept { return paths_.fieldsTypes_.GetTypesTree(); }
 
 	bool HasPath(std::string_view path, bool allowAdditionalFields = false) const noexcept {
 		return paths_.HasPath(path, allowAdditionalFields);
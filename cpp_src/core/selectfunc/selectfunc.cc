@@ -149,6 +149,17 @@ BaseFunctionCtx::Ptr SelectFunction::CreateCtx(int indexNo) {
 	}
 	return ctx;
 }
+void SelectFunctionsHolder::Merge(SelectFunctionsHolder &&other) {
+	force_only_ = force_only_ && other.force_only_;
+	if (!other.querys_) return;
+	if (!querys_) {
+		querys_ = std::move(other.querys_);
+		return;
+	}
+	for (auto &q : *other.querys_) querys_->emplace(q.first, std::move(q.second));
+	other.querys_.reset();
+}
+
 void SelectFunctionsHolder::Process(QueryResults &res) {
 	if (!querys_ || querys_->empty() || force_only_) return;
 	bool changed = false;
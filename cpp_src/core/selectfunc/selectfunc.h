@@ -54,6 +54,9 @@ public:
 	/// Processing of results of an executed query.
 	/// @param res - results of query execution.
 	void Process(QueryResults& res);
+	/// Moves the functions of the other holder, which was used by the concurrently executed sub-query.
+	/// Functions of the namespaces, which are already added, are kept
+	void Merge(SelectFunctionsHolder&& other);
 
 private:
 	/// Indicates if object is empty and was created wuth flag force = true.
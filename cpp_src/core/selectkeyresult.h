@@ -35,17 +35,21 @@ public:
 			useBtree_ = true;
 		}
 	}
-	explicit SingleSelectKeyResult(IdSet::Ptr ids) : tempIds_(ids), ids_(*ids) {}
+	explicit SingleSelectKeyResult(IdSet::Ptr ids) : tempIds_(ids), ids_(*ids), bitmap_(ids->Bitmap()), useBitmap_(bitmap_) {}
 	explicit SingleSelectKeyResult(const IdSetRef &ids) : ids_(ids) {}
 	explicit SingleSelectKeyResult(IdType rBegin, IdType rEnd) : rBegin_(rBegin), rEnd_(rEnd), isRange_(true) {}
 	SingleSelectKeyResult(const SingleSelectKeyResult &other)
 		: tempIds_(other.tempIds_),
 		  ids_(other.ids_),
 		  set_(other.set_),
+		  bitmap_(other.bitmap_),
 		  indexForwardIter_(other.indexForwardIter_),
+		  bmVal_(other.bmVal_),
+		  bmCursor_(other.bmCursor_),
 		  bsearch_(other.bsearch_),
 		  isRange_(other.isRange_),
-		  useBtree_(other.useBtree_) {
+		  useBtree_(other.useBtree_),
+		  useBitmap_(other.useBitmap_) {
 		if (isRange_) {
 			rBegin_ = other.rBegin_;
 			rEnd_ = other.rEnd_;
@@ -70,10 +74,14 @@ public:
 			tempIds_ = other.tempIds_;
 			ids_ = other.ids_;
 			set_ = other.set_;
+			bitmap_ = other.bitmap_;
 			indexForwardIter_ = other.indexForwardIter_;
+			bmVal_ = other.bmVal_;
+			bmCursor_ = other.bmCursor_;
 			bsearch_ = other.bsearch_;
 			isRange_ = other.isRange_;
 			useBtree_ = other.useBtree_;
+			useBitmap_ = other.useBitmap_;
 			if (isRange_) {
 				rBegin_ = other.rBegin_;
 				rEnd_ = other.rEnd_;
@@ -101,6 +109,7 @@ public:
 
 protected:
 	const base_idsetset *set_ = nullptr;
+	const IdSetBitmap *bitmap_ = nullptr;
 
 	union {
 		IdSetRef::const_iterator begin_;
@@ -131,10 +140,15 @@ protected:
 
 	IndexIterator::Ptr indexForwardIter_;
 
+	// Current candidate and container hint of the bitmap iteration
+	IdType bmVal_ = 0;
+	size_t bmCursor_ = 0;
+
 	// if isRange is true then bsearch is always false
 	bool bsearch_ = false;
 	bool isRange_ = false;
 	bool useBtree_ = false;
+	bool useBitmap_ = false;
 };
 
 /// Stores results of selecting data for 1 certain key,
@@ -143,6 +157,9 @@ protected:
 /// following keys: 10, 11, 12, 13, ... 19).
 class SelectKeyResult : public h_vector<SingleSelectKeyResult, 1> {
 public:
+	// Maximum count of the sets, which are merged by the scan of their heads
+	static constexpr size_t kMaxIdsetsForScanMerge = 16;
+
 	std::vector<Comparator> comparators_;
 
 	void ClearDistinct() {
@@ -161,6 +178,8 @@ public:
 				cnt += std::abs(r.rEnd_ - r.rBegin_);
 			} else if (r.useBtree_) {
 				cnt += r.set_->size();
+			} else if (r.useBitmap_) {
+				cnt += r.bitmap_->Size();
 			} else {
 				cnt += r.ids_.size();
 			}
@@ -174,45 +193,94 @@ public:
 	/// SingleSelectKeyResult objects. Such
 	/// representation makes further work with
 	/// the object much easier.
+	/// Large merged sets are stored as compressed
+	/// bitmap (see IdSetBitmap).
 	/// @return Pointer to a sorted IdSet object made
 	/// from all the SingleSelectKeyResult inner objects.
 	IdSet::Ptr mergeIdsets() {
-		auto mergedIds = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>();
-
 		size_t expectSize = 0;
 		for (auto it = begin(); it != end(); it++) {
 			if (it->useBtree_) {
 				it->itset_ = it->set_->begin();
 				expectSize += it->set_->size();
+			} else if (it->useBitmap_) {
+				it->bmCursor_ = 0;
+				expectSize += it->bitmap_->Size();
 			} else {
 				it->it_ = it->ids_.begin();
 				expectSize += it->ids_.size();
 			}
 		}
-		mergedIds->reserve(expectSize);
 
-		for (;;) {
-			const int min = mergedIds->size() ? mergedIds->back() : INT_MIN;
-			int curMin = INT_MAX;
+		IdSet::Ptr mergedIds;
+		if (expectSize >= kMinIdsetSizeForBitmap && size() > 1) {
+			mergedIds = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>(mergeBitmaps());
+		} else if (size() > kMaxIdsetsForScanMerge) {
+			// Ids of the many small sets (e.g. of the large IN-condition by the unique field) are sorted once instead of the scan of
+			// all the sets for each merged id
+			mergedIds = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>();
+			mergedIds->reserve(expectSize);
+			auto add = [&mergedIds](IdType id) { mergedIds->Add(id, IdSet::Unordered, 0); };
 			for (auto it = begin(); it != end(); it++) {
 				if (it->useBtree_) {
-					for (; it->itset_ != it->set_->end() && *it->itset_ <= min; it->itset_++) {
-					};
-					if (it->itset_ != it->set_->end() && *it->itset_ < curMin) curMin = *it->itset_;
+					for (IdType id : *it->set_) add(id);
+				} else if (it->useBitmap_) {
+					it->bitmap_->ForEach(add);
 				} else {
-					for (; it->it_ != it->ids_.end() && *it->it_ <= min; it->it_++) {
-					};
-					if (it->it_ != it->ids_.end() && *it->it_ < curMin) curMin = *it->it_;
+					for (IdType id : it->ids_) add(id);
 				}
 			}
-			if (curMin == INT_MAX) break;
-			mergedIds->Add(curMin, IdSet::Unordered, 0);
-		};
-		mergedIds->shrink_to_fit();
+			std::sort(mergedIds->begin(), mergedIds->end());
+			mergedIds->erase(std::unique(mergedIds->begin(), mergedIds->end()), mergedIds->end());
+			mergedIds->shrink_to_fit();
+		} else {
+			mergedIds = make_intrusive<intrusive_atomic_rc_wrapper<IdSet>>();
+			mergedIds->reserve(expectSize);
+			for (;;) {
+				const int min = mergedIds->size() ? mergedIds->back() : INT_MIN;
+				int curMin = INT_MAX;
+				for (auto it = begin(); it != end(); it++) {
+					if (it->useBtree_) {
+						for (; it->itset_ != it->set_->end() && *it->itset_ <= min; it->itset_++) {
+						};
+						if (it->itset_ != it->set_->end() && *it->itset_ < curMin) curMin = *it->itset_;
+					} else if (it->useBitmap_) {
+						const IdType v = it->bitmap_->Next(min == INT_MIN ? 0 : min + 1, it->bmCursor_);
+						if (v < curMin) curMin = v;
+					} else {
+						for (; it->it_ != it->ids_.end() && *it->it_ <= min; it->it_++) {
+						};
+						if (it->it_ != it->ids_.end() && *it->it_ < curMin) curMin = *it->it_;
+					}
+				}
+				if (curMin == INT_MAX) break;
+				mergedIds->Add(curMin, IdSet::Unordered, 0);
+			};
+			mergedIds->shrink_to_fit();
+		}
 		clear();
 		push_back(SingleSelectKeyResult(mergedIds));
 		return mergedIds;
 	}
+
+protected:
+	IdSetBitmap mergeBitmaps() const {
+		IdSetBitmap res;
+		for (auto it = begin(); it != end(); it++) {
+			if (it->useBtree_) {
+				IdSetBitmap bm;
+				bm.Add(it->set_->begin(), it->set_->end());
+				res.Or(bm);
+			} else if (it->useBitmap_) {
+				res.Or(*it->bitmap_);
+			} else {
+				IdSetBitmap bm;
+				bm.Add(it->ids_.begin(), it->ids_.end());
+				res.Or(bm);
+			}
+		}
+		return res;
+	}
 };
 
 /// Result of selecting data for
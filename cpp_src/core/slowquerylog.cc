@@ -0,0 +1,88 @@
+#include "slowquerylog.h"
+
+#include <algorithm>
+#include "core/cjson/jsonbuilder.h"
+
+namespace reindexer {
+
+static std::string fingerprintToString(uint64_t fingerprint) {
+	static const char kDigits[] = "0123456789abcdef";
+	std::string ret(16, '0');
+	for (int i = 15; i >= 0; --i, fingerprint >>= 4) ret[i] = kDigits[fingerprint & 0xF];
+	return ret;
+}
+
+void SlowQuery::AddPlan(std::string_view ns, uint64_t fingerprint, std::string explain) {
+	plans_.push_back({std::string(ns), fingerprint, std::move(explain)});
+}
+
+void SlowQuery::AppendPlans(SlowQuery &&other) {
+	for (auto &plan : other.plans_) plans_.emplace_back(std::move(plan));
+	other.plans_.clear();
+}
+
+bool SlowQuery::Finish(std::string_view error) {
+	const auto total = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_);
+	totalUs_ = total.count();
+	error_ = std::string(error);
+	return total >= threshold_;
+}
+
+void SlowQuery::SetQuery(std::string normalizedSQL, std::string sql) {
+	normalizedSQL_ = std::move(normalizedSQL);
+	sql_ = std::move(sql);
+	queryFingerprint_ = std::hash<std::string_view>()(normalizedSQL_);
+}
+
+uint64_t SlowQuery::PlanFingerprint() const noexcept {
+	uint64_t ret = 0;
+	for (const auto &plan : plans_) {
+		ret = CombineFingerprint(ret, std::hash<std::string_view>()(plan.ns));
+		ret = CombineFingerprint(ret, plan.fingerprint);
+	}
+	return ret;
+}
+
+void SlowQuery::GetJSON(WrSerializer &ser) const {
+	JsonBuilder builder(ser);
+	builder.Put("id", int64_t(id));
+	builder.Put("query", normalizedSQL_);
+	builder.Put("sql", sql_);
+	builder.Put("query_fingerprint", fingerprintToString(queryFingerprint_));
+	builder.Put("plan_fingerprint", fingerprintToString(PlanFingerprint()));
+	builder.Put("plan_changed", planChanged);
+	builder.Put("start_time_us", std::chrono::duration_cast<std::chrono::microseconds>(startTime_.time_since_epoch()).count());
+	builder.Put("total_us", totalUs_);
+	builder.Put("lock_wait_us", std::chrono::duration_cast<std::chrono::microseconds>(lockWait_).count());
+	if (!error_.empty()) builder.Put("error", error_);
+	auto arr = builder.Array("plans");
+	for (const auto &plan : plans_) {
+		auto obj = arr.Object();
+		obj.Put("namespace", plan.ns);
+		obj.Put("fingerprint", fingerprintToString(plan.fingerprint));
+		if (!plan.explain.empty()) obj.Raw("explain", plan.explain);
+	}
+}
+
+void SlowQueryLog::Add(SlowQuery &&query) {
+	const uint64_t planFingerprint = query.PlanFingerprint();
+	std::lock_guard<std::mutex> lck(mtx_);
+	query.id = nextId_++;
+	auto prev = std::find_if(queries_.rbegin(), queries_.rend(),
+							 [&query](const SlowQuery &q) { return q.QueryFingerprint() == query.QueryFingerprint(); });
+	query.planChanged = (prev != queries_.rend() && prev->PlanFingerprint() != planFingerprint);
+	if (queries_.size() >= kMaxQueries) queries_.pop_front();
+	queries_.emplace_back(std::move(query));
+}
+
+std::vector<SlowQuery> SlowQueryLog::Data() const {
+	std::lock_guard<std::mutex> lck(mtx_);
+	return {queries_.begin(), queries_.end()};
+}
+
+void SlowQueryLog::Reset() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	queries_.clear();
+}
+
+}  // namespace reindexer
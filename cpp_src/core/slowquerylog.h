@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace reindexer {
+
+class WrSerializer;
+
+inline uint64_t CombineFingerprint(uint64_t seed, uint64_t value) noexcept {
+	return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+/// Execution of one query for #slowqueries. Fingerprints of the plans are calculated for each namespace's select of the query, but the
+/// explain is serialized only for the selects, which took more than the threshold by themselves
+class SlowQuery {
+public:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	struct Plan {
+		std::string ns;
+		uint64_t fingerprint;
+		std::string explain;
+	};
+
+	explicit SlowQuery(std::chrono::microseconds threshold)
+		: threshold_(threshold), startTime_(std::chrono::system_clock::now()), start_(Clock::now()) {}
+
+	std::chrono::microseconds Threshold() const noexcept { return threshold_; }
+	/// @param explain - explain of the select in JSON. Empty, if the select was faster than the threshold
+	void AddPlan(std::string_view ns, uint64_t fingerprint, std::string explain);
+	void AddLockWait(Clock::duration wait) noexcept { lockWait_ += wait; }
+	/// Appends the plans of the sub-query, which was executed concurrently with its own SlowQuery
+	void AppendPlans(SlowQuery &&other);
+	/// @return true, if the query took more than the threshold
+	bool Finish(std::string_view error = {});
+	/// @param normalizedSQL - SQL without the values, which defines the shape of the query
+	/// @param sql - SQL with the values
+	void SetQuery(std::string normalizedSQL, std::string sql);
+	void GetJSON(WrSerializer &ser) const;
+
+	uint64_t QueryFingerprint() const noexcept { return queryFingerprint_; }
+	/// Fingerprint of the plans of all the selects of the query. Costs, counters and timings are not included, so it changes only if the
+	/// selectors, their order or the execution methods were changed
+	uint64_t PlanFingerprint() const noexcept;
+
+	uint64_t id = 0;
+	// True, if the previous slow query of the same shape had another plan
+	bool planChanged = false;
+
+private:
+	std::chrono::microseconds threshold_;
+	std::string normalizedSQL_;
+	std::string sql_;
+	std::string error_;
+	uint64_t queryFingerprint_ = 0;
+	std::chrono::system_clock::time_point startTime_;
+	Clock::time_point start_;
+	Clock::duration lockWait_ = Clock::duration::zero();
+	int64_t totalUs_ = 0;
+	std::vector<Plan> plans_;
+};
+
+/// Keeps the last kMaxQueries queries, which took more than the threshold, for #slowqueries
+class SlowQueryLog {
+public:
+	static constexpr size_t kMaxQueries = 256;
+
+	void Add(SlowQuery &&query);
+	std::vector<SlowQuery> Data() const;
+	void Reset();
+
+private:
+	mutable std::mutex mtx_;
+	std::deque<SlowQuery> queries_;
+	uint64_t nextId_ = 1;
+};
+
+}  // namespace reindexer
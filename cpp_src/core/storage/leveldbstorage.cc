@@ -113,6 +113,10 @@ Error LevelDbStorage::doOpen(const string& path, const StorageOpts& opts) {
 		throw Error(errParams, "Cannot enable storage: the path is empty '%s'", path);
 	}
 
+	if (opts.IsReadOnly()) {
+		return Error(errParams, "Read only mode is not supported by the LevelDB storage");
+	}
+
 	leveldb::Options options;
 	options.create_if_missing = opts.IsCreateIfMissing();
 	options.max_open_files = 50;
@@ -0,0 +1,83 @@
+#include "prefetchingreader.h"
+
+namespace reindexer {
+namespace datastorage {
+
+PrefetchingReader::PrefetchingReader(std::unique_ptr<Cursor> cursor, std::string from, std::string to, size_t batchSize,
+									 size_t queueSize)
+	: cursor_(std::move(cursor)), from_(std::move(from)), to_(std::move(to)), batchSize_(batchSize), queueSize_(queueSize) {
+	thread_ = std::thread([this] { prefetch(); });
+}
+
+PrefetchingReader::~PrefetchingReader() {
+	{
+		std::lock_guard lck(mtx_);
+		stopped_ = true;
+	}
+	cv_.notify_all();
+	thread_.join();
+}
+
+void PrefetchingReader::prefetch() {
+	try {
+		Comparator &cmp = cursor_->GetComparator();
+		Batch batch;
+		auto push = [&]() -> bool {
+			std::unique_lock lck(mtx_);
+			cv_.wait(lck, [this] { return queue_.size() < queueSize_ || stopped_; });
+			if (stopped_) {
+				return false;
+			}
+			queue_.emplace_back(std::move(batch));
+			cv_.notify_all();
+			if (recycled_.empty()) {
+				batch = Batch();
+			} else {
+				batch = std::move(recycled_.back());
+				recycled_.pop_back();
+			}
+			return true;
+		};
+		for (cursor_->Seek(from_); cursor_->Valid() && cmp.Compare(cursor_->Key(), to_) < 0; cursor_->Next()) {
+			const auto key = cursor_->Key();
+			const auto value = cursor_->Value();
+			batch.records.push_back({batch.data.size(), key.size(), value.size()});
+			batch.data.append(key).append(value);
+			if (batch.data.size() >= batchSize_ && !push()) {
+				return;
+			}
+		}
+		if (!batch.records.empty() && !push()) {
+			return;
+		}
+	} catch (...) {
+		std::lock_guard lck(mtx_);
+		ex_ = std::current_exception();
+	}
+	std::lock_guard lck(mtx_);
+	finished_ = true;
+	cv_.notify_all();
+}
+
+bool PrefetchingReader::nextBatch(Batch &batch) {
+	std::unique_lock lck(mtx_);
+	if (!batch.records.empty()) {
+		batch.records.clear();
+		batch.data.clear();
+		recycled_.emplace_back(std::move(batch));
+	}
+	cv_.wait(lck, [this] { return !queue_.empty() || finished_; });
+	if (queue_.empty()) {
+		if (ex_) {
+			std::rethrow_exception(ex_);
+		}
+		return false;
+	}
+	batch = std::move(queue_.front());
+	queue_.pop_front();
+	cv_.notify_all();
+	return true;
+}
+
+}  // namespace datastorage
+}  // namespace reindexer
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "idatastorage.h"
+
+namespace reindexer {
+namespace datastorage {
+
+/// Forward-only reader of the storage records range. Cursor is iterated in the separate thread, which keeps the read-ahead queue of
+/// the records batches, so the storage I/O overlaps with the processing of the records by the caller
+class PrefetchingReader {
+public:
+	static constexpr size_t kDefaultBatchSize = 1 << 20;
+	static constexpr size_t kDefaultQueueSize = 4;
+
+	/// @param cursor - cursor of the storage. Reader takes the ownership
+	/// @param from - first key of the range (inclusive)
+	/// @param to - last key of the range (exclusive)
+	/// @param batchSize - approximate size of the keys and values of the single batch in bytes
+	/// @param queueSize - maximum count of the prefetched batches
+	PrefetchingReader(std::unique_ptr<Cursor> cursor, std::string from, std::string to, size_t batchSize = kDefaultBatchSize,
+					  size_t queueSize = kDefaultQueueSize);
+	PrefetchingReader(const PrefetchingReader &) = delete;
+	PrefetchingReader &operator=(const PrefetchingReader &) = delete;
+	~PrefetchingReader();
+
+	/// Calls f(std::string_view key, std::string_view value) for each record of the range. Key and value are valid only during the
+	/// call. Iteration stops, if f returns false. Exceptions of the cursor are rethrown
+	template <typename F>
+	void ForEach(F &&f) {
+		Batch batch;
+		while (nextBatch(batch)) {
+			for (const auto &rec : batch.records) {
+				const std::string_view key(batch.data.data() + rec.offset, rec.keyLen);
+				const std::string_view value(batch.data.data() + rec.offset + rec.keyLen, rec.valueLen);
+				if (!f(key, value)) {
+					return;
+				}
+			}
+		}
+	}
+
+private:
+	struct Batch {
+		struct Record {
+			size_t offset;
+			size_t keyLen;
+			size_t valueLen;
+		};
+		std::string data;
+		std::vector<Record> records;
+	};
+
+	void prefetch();
+	bool nextBatch(Batch &batch);
+
+	std::unique_ptr<Cursor> cursor_;
+	const std::string from_, to_;
+	const size_t batchSize_, queueSize_;
+	std::deque<Batch> queue_;
+	std::vector<Batch> recycled_;
+	bool finished_ = false;
+	bool stopped_ = false;
+	std::exception_ptr ex_;
+	std::mutex mtx_;
+	std::condition_variable cv_;
+	std::thread thread_;
+};
+
+}  // namespace datastorage
+}  // namespace reindexer
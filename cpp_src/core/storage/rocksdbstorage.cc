@@ -2,10 +2,13 @@
 
 #include "rocksdbstorage.h"
 
+#include <rocksdb/cache.h>
 #include <rocksdb/comparator.h>
 #include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
 #include <rocksdb/iterator.h>
 #include <rocksdb/slice.h>
+#include <rocksdb/table.h>
 
 void toWriteOptions(const StorageOpts& opts, rocksdb::WriteOptions& wopts) { wopts.sync = opts.IsSync(); }
 
@@ -20,6 +23,11 @@ namespace datastorage {
 using namespace std::string_view_literals;
 
 constexpr auto kStorageNotInitialized = "Storage is not initialized"sv;
+constexpr size_t kCursorReadaheadSize = 2 << 20;
+
+std::mutex RocksDbStorage::tuningMtx_;
+RocksDbTuning RocksDbStorage::tuning_;
+std::shared_ptr<rocksdb::Cache> RocksDbStorage::sharedBlockCache_;
 
 RocksDbStorage::RocksDbStorage() {}
 
@@ -103,6 +111,8 @@ Cursor* RocksDbStorage::GetCursor(StorageOpts& opts) {
 	rocksdb::ReadOptions options;
 	toReadOptions(opts, options);
 	options.fill_cache = false;
+	// Cursors are used for the sequential scans, so the larger reads decrease count of the I/O requests on the cold cache
+	options.readahead_size = kCursorReadaheadSize;
 	return new RocksDbIterator(db_->NewIterator(options));
 }
 
@@ -116,9 +126,12 @@ Error RocksDbStorage::doOpen(const string& path, const StorageOpts& opts) {
 	rocksdb::Options options;
 	options.create_if_missing = opts.IsCreateIfMissing();
 	options.max_open_files = 50;
+	applyTuning(options);
 
 	rocksdb::DB* db;
-	rocksdb::Status status = rocksdb::DB::Open(options, path, &db);
+	// Read only storage may be opened by the several processes at the same time
+	rocksdb::Status status =
+		opts.IsReadOnly() ? rocksdb::DB::OpenForReadOnly(options, path, &db) : rocksdb::DB::Open(options, path, &db);
 	if (status.ok()) {
 		db_.reset(db);
 		opts_ = opts;
@@ -139,6 +152,53 @@ void RocksDbStorage::doDestroy(const string& path) {
 	}
 }
 
+void RocksDbStorage::SetTuning(const RocksDbTuning& tuning) {
+	std::lock_guard lck(tuningMtx_);
+	if (tuning.sharedBlockCacheSize != tuning_.sharedBlockCacheSize || !sharedBlockCache_) {
+		sharedBlockCache_ = tuning.sharedBlockCacheSize ? rocksdb::NewLRUCache(tuning.sharedBlockCacheSize) : nullptr;
+	}
+	tuning_ = tuning;
+}
+
+void RocksDbStorage::applyTuning(rocksdb::Options& options) {
+	std::lock_guard lck(tuningMtx_);
+	switch (tuning_.compaction) {
+		case RocksDbTuning::Compaction::Level:
+			options.compaction_style = rocksdb::kCompactionStyleLevel;
+			break;
+		case RocksDbTuning::Compaction::Universal:
+			options.compaction_style = rocksdb::kCompactionStyleUniversal;
+			break;
+	}
+	switch (tuning_.compression) {
+		case RocksDbTuning::Compression::None:
+			options.compression = rocksdb::kNoCompression;
+			break;
+		case RocksDbTuning::Compression::Snappy:
+			options.compression = rocksdb::kSnappyCompression;
+			break;
+		case RocksDbTuning::Compression::LZ4:
+			options.compression = rocksdb::kLZ4Compression;
+			break;
+		case RocksDbTuning::Compression::ZSTD:
+			options.compression = rocksdb::kZSTD;
+			break;
+	}
+	if (tuning_.writeBufferSize) {
+		options.write_buffer_size = tuning_.writeBufferSize;
+	}
+	if (tuning_.bloomFilterBits > 0 || sharedBlockCache_) {
+		rocksdb::BlockBasedTableOptions tableOptions;
+		if (tuning_.bloomFilterBits > 0) {
+			tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(tuning_.bloomFilterBits));
+		}
+		if (sharedBlockCache_) {
+			tableOptions.block_cache = sharedBlockCache_;
+		}
+		options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(tableOptions));
+	}
+}
+
 RocksDbBatchBuffer::RocksDbBatchBuffer() {}
 
 RocksDbBatchBuffer::~RocksDbBatchBuffer() {}
@@ -4,7 +4,9 @@
 
 #include <rocksdb/db.h>
 #include <rocksdb/write_batch.h>
+#include <mutex>
 #include "basestorage.h"
+#include "rocksdbtuning.h"
 
 using std::unique_ptr;
 
@@ -31,6 +33,8 @@ public:
 	Cursor* GetCursor(StorageOpts& opts) override final;
 	UpdatesCollection* GetUpdatesCollection() override final;
 
+	static void SetTuning(const RocksDbTuning& tuning);
+
 protected:
 	Error doOpen(const string& path, const StorageOpts& opts) override final;
 	void doDestroy(const string& path) override final;
@@ -39,6 +43,12 @@ private:
 	string dbpath_;
 	StorageOpts opts_;
 	unique_ptr<rocksdb::DB> db_;
+
+	static void applyTuning(rocksdb::Options& options);
+
+	static std::mutex tuningMtx_;
+	static RocksDbTuning tuning_;
+	static std::shared_ptr<rocksdb::Cache> sharedBlockCache_;
 };
 
 class RocksDbBatchBuffer : public UpdatesCollection {
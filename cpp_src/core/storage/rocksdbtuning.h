@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string_view>
+#include "tools/errors.h"
+
+namespace reindexer {
+namespace datastorage {
+
+/// Tuning profile of the RocksDB storages. It's common for all of the RocksDB storages of the process
+struct RocksDbTuning {
+	enum class Compaction { Level, Universal };
+	enum class Compression { None, Snappy, LZ4, ZSTD };
+
+	static Compaction CompactionFromString(std::string_view str) {
+		if (str.empty() || str == "level") return Compaction::Level;
+		if (str == "universal") return Compaction::Universal;
+		// FIFO compaction drops the oldest files on the size limit, i.e. loses the data of the primary storage
+		throw Error(errParams, "Invalid RocksDB compaction style: '%s'. Expected 'level' or 'universal'", str);
+	}
+	static Compression CompressionFromString(std::string_view str) {
+		if (str.empty() || str == "snappy") return Compression::Snappy;
+		if (str == "none") return Compression::None;
+		if (str == "lz4") return Compression::LZ4;
+		if (str == "zstd") return Compression::ZSTD;
+		throw Error(errParams, "Invalid RocksDB compression: '%s'. Expected 'none', 'snappy', 'lz4' or 'zstd'", str);
+	}
+
+	Compaction compaction = Compaction::Level;
+	Compression compression = Compression::Snappy;
+	/// Bits per key of the bloom filter. 0 - bloom filter is disabled
+	int bloomFilterBits = 0;
+	/// Size of the block cache, which is shared by all of the RocksDB storages. 0 - each storage has its own default cache
+	size_t sharedBlockCacheSize = 0;
+	/// Size of the memtable of each storage. 0 - RocksDB default
+	size_t writeBufferSize = 0;
+};
+
+}  // namespace datastorage
+}  // namespace reindexer
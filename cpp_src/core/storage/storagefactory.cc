@@ -37,5 +37,13 @@ std::vector<StorageType> StorageFactory::getAvailableTypes() {
 	return types;
 }
 
+void StorageFactory::setRocksDbTuning(const RocksDbTuning& tuning) {
+#ifdef REINDEX_WITH_ROCKSDB
+	RocksDbStorage::SetTuning(tuning);
+#else	// REINDEX_WITH_ROCKSDB
+	(void)tuning;
+#endif	// REINDEX_WITH_ROCKSDB
+}
+
 }  // namespace datastorage
 }  // namespace reindexer
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "idatastorage.h"
+#include "rocksdbtuning.h"
 #include "storagetype.h"
 
 namespace reindexer {
@@ -12,6 +13,8 @@ public:
 	static IDataStorage* create(StorageType);
 	static IDataStorage* create(std::string_view type);
 	static std::vector<StorageType> getAvailableTypes();
+	/// Sets tuning of the RocksDB storages. It's applied to the storages, which are opened after this call
+	static void setRocksDbTuning(const RocksDbTuning& tuning);
 };
 }  // namespace datastorage
 }  // namespace reindexer
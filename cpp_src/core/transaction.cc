@@ -52,9 +52,9 @@ const vector<TransactionStep> &Transaction::GetSteps() const {
 	return impl_->steps_;
 }
 
-Item Transaction::GetItem(TransactionStep &&st) {
+void Transaction::GetItems(span<TransactionStep> steps, std::vector<Item> &items, int workers) {
 	assertrx(impl_);
-	return impl_->GetItem(std::move(st));
+	impl_->GetItems(steps, items, workers);
 }
 
 bool Transaction::IsTagsUpdated() const {
@@ -2,6 +2,7 @@
 #include "core/namespacedef.h"
 #include "core/query/query.h"
 #include "core/queryresults/queryresults.h"
+#include "estl/span.h"
 
 namespace reindexer {
 
@@ -31,7 +32,7 @@ public:
 	void Modify(Query &&query);
 	bool IsFree() { return impl_ == nullptr; }
 	Item NewItem();
-	Item GetItem(TransactionStep &&st);
+	void GetItems(span<TransactionStep> steps, std::vector<Item> &items, int workers);
 	Error Status() { return status_; }
 
 	const std::string &GetName();
@@ -1,4 +1,5 @@
 #include "transactionimpl.h"
+#include <thread>
 #include "item.h"
 #include "itemimpl.h"
 
@@ -6,6 +7,29 @@ namespace reindexer {
 
 using std::string;
 
+// Minimum count of the items, which are decoded by the single worker
+constexpr size_t kMinDecodeItemsPartSize = 1024;
+
+std::string_view TransactionItemsBuffer::Append(std::string_view data) {
+	if (data.size() > kChunkSize / 4) {
+		// Large item gets its own chunk, which is placed before the current one, so the current chunk is filled further
+		std::unique_ptr<char[]> chunk(new char[data.size()]);
+		memcpy(chunk.get(), data.data(), data.size());
+		const std::string_view ret(chunk.get(), data.size());
+		chunks_.emplace(chunks_.empty() ? chunks_.end() : chunks_.end() - 1, std::move(chunk));
+		return ret;
+	}
+	if (chunkCap_ - chunkUsed_ < data.size()) {
+		chunks_.emplace_back(new char[kChunkSize]);
+		chunkUsed_ = 0;
+		chunkCap_ = kChunkSize;
+	}
+	char *dst = chunks_.back().get() + chunkUsed_;
+	memcpy(dst, data.data(), data.size());
+	chunkUsed_ += data.size();
+	return std::string_view(dst, data.size());
+}
+
 void TransactionImpl::checkTagsMatcher(Item &item) {
 	if (item.IsTagsUpdated()) {
 		ItemImpl *ritem = item.impl_;
@@ -18,9 +42,60 @@ Item TransactionImpl::NewItem() {
 	std::unique_lock<std::mutex> lock(mtx_);
 	return Item(new ItemImpl(payloadType_, tagsMatcher_, pkFields_));
 }
-Item TransactionImpl::GetItem(TransactionStep &&st) {
-	std::unique_lock<std::mutex> lock(mtx_);
-	return Item(new ItemImpl(payloadType_, tagsMatcher_, pkFields_, schema_, std::move(st.itemData_)));
+
+void TransactionImpl::GetItems(span<TransactionStep> steps, std::vector<Item> &items, int workers) {
+	TagsMatcher tm;
+	{
+		std::unique_lock<std::mutex> lock(mtx_);
+		tm = tagsMatcher_;
+	}
+	items.clear();
+	items.resize(steps.size());
+	auto decode = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			if (!steps[i].query_) items[i] = decodeItem(steps[i], tm);
+		}
+	};
+	const size_t parts = std::min<size_t>(std::max(workers, 0), steps.size() / kMinDecodeItemsPartSize);
+	if (parts < 2) {
+		decode(0, steps.size());
+		return;
+	}
+
+	const size_t partSize = (steps.size() + parts - 1) / parts;
+	std::vector<std::thread> threads;
+	std::vector<std::exception_ptr> errors(parts);
+	threads.reserve(parts - 1);
+	for (size_t i = 1; i < parts; ++i) {
+		threads.emplace_back([&decode, &error = errors[i], begin = std::min(steps.size(), partSize * i), partSize, &steps] {
+			try {
+				decode(begin, std::min(steps.size(), begin + partSize));
+			} catch (...) {
+				error = std::current_exception();
+			}
+		});
+	}
+	try {
+		decode(0, std::min(steps.size(), partSize));
+	} catch (...) {
+		errors[0] = std::current_exception();
+	}
+	for (auto &t : threads) t.join();
+	for (auto &error : errors) {
+		if (error) std::rethrow_exception(error);
+	}
+}
+
+Item TransactionImpl::decodeItem(const TransactionStep &st, const TagsMatcher &tm) {
+	Item item(new ItemImpl(payloadType_, tm, pkFields_, schema_));
+	ItemImpl *ritem = item.impl_;
+	Error err = ritem->FromCJSON(st.itemCJSON_);
+	if (!err.ok()) throw err;
+	ritem->Value().SetLSN(st.lsn_);
+	if (!st.precepts_.empty()) ritem->SetPrecepts(st.precepts_);
+	// New tags of the transaction are merged into the namespace's tags matcher by the items, which added them
+	if (st.tagsUpdated_) ritem->tagsMatcher().setUpdated();
+	return item;
 }
 
 TransactionImpl::TransactionImpl(const string &nsName, const PayloadType &pt, const TagsMatcher &tm, const FieldsSet &pf,
@@ -55,30 +130,33 @@ void TransactionImpl::UpdateTagsMatcherFromItem(ItemImpl *ritem) {
 	}
 }
 
+void TransactionImpl::addItemStep(Item &&item, ItemModifyMode mode) {
+	checkTagsMatcher(item);
+	ItemImpl *ritem = item.impl_;
+	const bool tagsUpdated = ritem->tagsMatcher().isUpdated();
+	const int64_t lsn = ritem->Value().GetLSN();
+	steps_.emplace_back(itemsBuffer_.Append(ritem->GetCJSON()), mode, lsn, std::move(ritem->precepts_), tagsUpdated);
+}
+
 void TransactionImpl::Insert(Item &&item) {
 	std::unique_lock<std::mutex> lock(mtx_);
-	checkTagsMatcher(item);
-	steps_.emplace_back(TransactionStep{move(item), ModeInsert});
+	addItemStep(std::move(item), ModeInsert);
 }
 void TransactionImpl::Update(Item &&item) {
 	std::unique_lock<std::mutex> lock(mtx_);
-	checkTagsMatcher(item);
-	steps_.emplace_back(TransactionStep{move(item), ModeUpdate});
+	addItemStep(std::move(item), ModeUpdate);
 }
 void TransactionImpl::Upsert(Item &&item) {
 	std::unique_lock<std::mutex> lock(mtx_);
-	checkTagsMatcher(item);
-	steps_.emplace_back(TransactionStep{move(item), ModeUpsert});
+	addItemStep(std::move(item), ModeUpsert);
 }
 void TransactionImpl::Delete(Item &&item) {
 	std::unique_lock<std::mutex> lock(mtx_);
-	checkTagsMatcher(item);
-	steps_.emplace_back(TransactionStep{move(item), ModeDelete});
+	addItemStep(std::move(item), ModeDelete);
 }
 void TransactionImpl::Modify(Item &&item, ItemModifyMode mode) {
 	std::unique_lock<std::mutex> lock(mtx_);
-	checkTagsMatcher(item);
-	steps_.emplace_back(TransactionStep{move(item), mode});
+	addItemStep(std::move(item), mode);
 }
 
 void TransactionImpl::Modify(Query &&query) {
@@ -1,5 +1,6 @@
 #pragma once
 #include "core/itemimpl.h"
+#include "estl/span.h"
 #include "payload/fieldsset.h"
 #include "transaction.h"
 
@@ -7,10 +8,8 @@ namespace reindexer {
 
 class TransactionStep {
 public:
-	TransactionStep(Item &&item, ItemModifyMode modifyMode) : itemData_(move(*item.impl_)), modifyMode_(modifyMode), query_(nullptr) {
-		delete item.impl_;
-		item.impl_ = nullptr;
-	}
+	TransactionStep(std::string_view itemCJSON, ItemModifyMode modifyMode, int64_t lsn, vector<string> &&precepts, bool tagsUpdated)
+		: itemCJSON_(itemCJSON), precepts_(std::move(precepts)), lsn_(lsn), modifyMode_(modifyMode), tagsUpdated_(tagsUpdated) {}
 	TransactionStep(Query &&query) : modifyMode_(ModeUpdate), query_(new Query(std::move(query))) {}
 
 	TransactionStep(const TransactionStep &) = delete;
@@ -18,11 +17,31 @@ public:
 	TransactionStep(TransactionStep && /*rhs*/) noexcept = default;
 	TransactionStep &operator=(TransactionStep && /*rhs*/) = default;
 
-	ItemImplRawData itemData_;
+	// CJSON of the item, stored in the items buffer of the transaction. Item is decoded on commit
+	std::string_view itemCJSON_;
+	vector<string> precepts_;
+	int64_t lsn_ = -1;
 	ItemModifyMode modifyMode_;
+	bool tagsUpdated_ = false;
 	std::unique_ptr<Query> query_;
 };
 
+/// Serialized items of the transaction. Items are appended to the large chunks, so the big transaction does not hold the payload
+/// and the buffers of each item until the commit
+class TransactionItemsBuffer {
+public:
+	/// @return view of the copy of the data, which is valid until the buffer is destroyed
+	std::string_view Append(std::string_view data);
+
+private:
+	static constexpr size_t kChunkSize = 0x100000;
+
+	// The last chunk is the one, which is being filled
+	std::vector<std::unique_ptr<char[]>> chunks_;
+	size_t chunkUsed_ = 0;
+	size_t chunkCap_ = 0;
+};
+
 class TransactionImpl {
 public:
 	TransactionImpl(const std::string &nsName, const PayloadType &pt, const TagsMatcher &tm, const FieldsSet &pf,
@@ -37,11 +56,15 @@ public:
 
 	void UpdateTagsMatcherFromItem(ItemImpl *ritem);
 	Item NewItem();
-	Item GetItem(TransactionStep &&st);
+	/// Decodes the items of the steps (steps with the queries get the empty items). Items are decoded by the several threads,
+	/// if there are many of them
+	void GetItems(span<TransactionStep> steps, std::vector<Item> &items, int workers);
 
 	const std::string &GetName() { return nsName_; }
 
 	void checkTagsMatcher(Item &item);
+	void addItemStep(Item &&item, ItemModifyMode mode);
+	Item decodeItem(const TransactionStep &st, const TagsMatcher &tm);
 
 	PayloadType payloadType_;
 	TagsMatcher tagsMatcher_;
@@ -49,6 +72,7 @@ public:
 	std::shared_ptr<const Schema> schema_;
 
 	std::vector<TransactionStep> steps_;
+	TransactionItemsBuffer itemsBuffer_;
 	std::string nsName_;
 	bool tagsUpdated_;
 	std::mutex mtx_;
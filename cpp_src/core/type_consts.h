@@ -37,6 +37,7 @@ typedef enum IndexType {
 	IndexCompositeFuzzyFT = 17,
 	IndexTtl = 18,
 	IndexRTree = 19,
+	IndexHnsw = 20,
 } IndexType;
 
 typedef enum QueryItemType {
@@ -68,6 +69,9 @@ typedef enum QueryItemType {
 	QueryUpdateFieldV2 = 25,
 	QueryBetweenFieldsCondition = 26,
 	QueryAlwaysFalseCondition = 27,
+	QueryParallelScan = 28,
+	QueryWaitLSN = 29,
+	QueryBestEffort = 30,
 } QueryItemType;
 
 typedef enum QuerySerializeMode {
@@ -91,6 +95,7 @@ typedef enum CondType {
 	CondEmpty = 9,
 	CondLike = 10,
 	CondDWithin = 11,
+	CondKnn = 12,
 } CondType;
 
 enum ErrorCode {
@@ -121,6 +126,7 @@ enum ErrorCode {
 	errParseMsgPack = 24,
 	errParseProtobuf = 25,
 	errUpdatesLost = 26,
+	errQuotaExceeded = 27,
 };
 
 enum SchemaType { JsonSchemaType, ProtobufSchemaType };
@@ -131,7 +137,7 @@ enum OpType { OpOr = 1, OpAnd = 2, OpNot = 3 };
 
 enum ArithmeticOpType { OpPlus = 0, OpMinus = 1, OpMult = 2, OpDiv = 3 };
 
-enum AggType { AggSum, AggAvg, AggFacet, AggMin, AggMax, AggDistinct, AggCount, AggCountCached, AggUnknown = -1 };
+enum AggType { AggSum, AggAvg, AggFacet, AggMin, AggMax, AggDistinct, AggCount, AggCountCached, AggApproxCountDistinct, AggQuantile, AggUnknown = -1 };
 
 enum JoinType { LeftJoin, InnerJoin, OrInnerJoin, Merge };
 
@@ -139,12 +145,14 @@ enum CalcTotalMode { ModeNoTotal, ModeCachedTotal, ModeAccurateTotal };
 
 enum DataFormat { FormatJson, FormatCJson, FormatMsgPack };
 
-enum QueryResultItemType { QueryResultEnd, QueryResultAggregation, QueryResultExplain };
+enum QueryResultItemType { QueryResultEnd, QueryResultAggregation, QueryResultExplain, QueryResultIncomplete };
 
 enum CacheMode { CacheModeOn = 0, CacheModeAggressive = 1, CacheModeOff = 2 };
 
 enum StrictMode { StrictModeNotSet = 0, StrictModeNone, StrictModeNames, StrictModeIndexes };
 
+enum ParallelScanMode { ParallelScanNotSet = 0, ParallelScanOff, ParallelScanOn };
+
 typedef int IdType;
 typedef unsigned SortType;
 
@@ -160,6 +168,8 @@ enum {
 	kResultsCJson = 0x2,
 	kResultsJson = 0x3,
 	kResultsMsgPack = 0x4,
+	// Array of reindexer_item_view after the query params (builtin binding only, see reindexer_ctypes.h)
+	kResultsItemViews = 0x5,
 
 	kResultsWithPayloadTypes = 0x10,
 	kResultsWithItemID = 0x20,
@@ -170,14 +180,21 @@ enum {
 	kResultsNeedOutputRank = 0x400,
 	// kResultsWithShardId = 0x800, // v4.x.x
 	// kResultsNeedOutputShardId = 0x1000, // v4.x.x
-	kResultsSupportIdleTimeout = 0x2000	 // FIXME: Change this to version check after test
+	kResultsSupportIdleTimeout = 0x2000,  // FIXME: Change this to version check after test
+	// Joined item, which was already put into the same page of the results, is put as the reference to it
+	kResultsJoinedRefs = 0x4000
 };
 
 typedef enum IndexOpt {
+	kIndexOptTrigram = 1 << 9,
+	kIndexOptBloomFilter = 1 << 8,
 	kIndexOptPK = 1 << 7,
 	kIndexOptArray = 1 << 6,
 	kIndexOptDense = 1 << 5,
 	kIndexOptSparse = 1 << 3,
+	kIndexOptColumnar = 1 << 2,
+	kIndexOptFlatHash = 1 << 1,
+	kIndexOptLearned = 1 << 0,
 } IndexOpt;
 
 typedef enum StotageOpt {
@@ -190,6 +207,7 @@ typedef enum StotageOpt {
 	kStorageOptLazyLoad = 1 << 6,
 	kStorageOptSlaveMode = 1 << 7,
 	kStorageOptAutorepair = 1 << 9,
+	kStorageOptReadOnly = 1 << 10,
 } StorageOpt;
 
 enum CollateMode { CollateNone = 0, CollateASCII, CollateUTF8, CollateNumeric, CollateCustom };
@@ -217,6 +235,7 @@ typedef struct StorageOpts {
 	bool IsLazyLoad() const { return options & kStorageOptLazyLoad; }
 	bool IsSlaveMode() const { return options & kStorageOptSlaveMode; }
 	bool IsAutorepair() const { return options & kStorageOptAutorepair; }
+	bool IsReadOnly() const { return options & kStorageOptReadOnly; }
 
 	StorageOpts& Enabled(bool value = true) {
 		options = value ? options | kStorageOptEnabled : options & ~(kStorageOptEnabled);
@@ -262,6 +281,11 @@ typedef struct StorageOpts {
 		options = value ? options | kStorageOptAutorepair : options & ~(kStorageOptAutorepair);
 		return *this;
 	}
+
+	StorageOpts& ReadOnly(bool value = true) {
+		options = value ? options | kStorageOptReadOnly : options & ~(kStorageOptReadOnly);
+		return *this;
+	}
 #endif
 	uint16_t options;
 	uint16_t noQueryIdleThresholdSec;
@@ -338,6 +362,7 @@ enum IndexValueType { NotSet = -1, SetByJsonPath = -2 };
 
 enum SubscriptionOpt {
 	kSubscriptionOptIncrementSubscription = 1 << 0,
+	kSubscriptionOptBatchedUpdates = 1 << 1,
 };
 
 typedef struct SubscriptionOpts {
@@ -349,6 +374,12 @@ typedef struct SubscriptionOpts {
 		options = value ? options | kSubscriptionOptIncrementSubscription : options & ~(kSubscriptionOptIncrementSubscription);
 		return *this;
 	}
+	// Subscriber is able to receive the updates, coalesced into the compressed batches (kCmdUpdatesBatch)
+	bool IsBatchedUpdates() const { return options & kSubscriptionOptBatchedUpdates; }
+	SubscriptionOpts& BatchedUpdates(bool value = true) {
+		options = value ? options | kSubscriptionOptBatchedUpdates : options & ~(kSubscriptionOptBatchedUpdates);
+		return *this;
+	}
 #endif
 	uint16_t options;
 } SubscriptionOpts;
@@ -49,6 +49,8 @@ std::string_view CondTypeToStr(CondType t) {
 			return "CondLike"sv;
 		case CondDWithin:
 			return "CondDWithin"sv;
+		case CondKnn:
+			return "CondKnn"sv;
 		default:
 			return "Unknown"sv;
 	}
@@ -37,6 +37,8 @@ auto& operator<<(T& os, CondType cond) {
 			return os << "LIKE";
 		case CondDWithin:
 			return os << "DWITHIN";
+		case CondKnn:
+			return os << "KNN";
 		default:
 			abort();
 	}
@@ -115,6 +117,8 @@ T& operator<<(T& os, IndexType it) {
 			return os << "Ttl";
 		case ::IndexRTree:
 			return os << "RTree";
+		case ::IndexHnsw:
+			return os << "Hnsw";
 		default:
 			abort();
 	}
@@ -0,0 +1,60 @@
+#include "warmstate.h"
+#include "cjson/jsonbuilder.h"
+#include "gason/gason.h"
+#include "tools/fsops.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+Error WarmState::FromJSON(span<char> json) {
+	try {
+		FromJSON(gason::JsonParser().Parse(json));
+	} catch (const gason::Exception &ex) {
+		return Error(errParseJson, "WarmState: %s", ex.what());
+	} catch (const Error &err) {
+		return err;
+	}
+	return errOK;
+}
+
+void WarmState::FromJSON(const gason::JsonNode &root) {
+	queries.clear();
+	for (auto &elem : root["queries"]) {
+		queries.push_back({elem["sql"].As<std::string>(), elem["hits"].As<uint64_t>()});
+	}
+	sortedNamespaces.clear();
+	for (auto &elem : root["sorted_namespaces"]) sortedNamespaces.push_back(elem.As<std::string>());
+}
+
+void WarmState::GetJSON(WrSerializer &ser) const {
+	JsonBuilder json(ser);
+	{
+		auto arr = json.Array("queries");
+		for (auto &q : queries) {
+			auto obj = arr.Object(nullptr);
+			obj.Put("sql", q.sql);
+			obj.Put("hits", q.hits);
+		}
+	}
+	auto arr = json.Array("sorted_namespaces");
+	for (auto &ns : sortedNamespaces) arr.Put(nullptr, ns);
+}
+
+bool WarmState::Load(const std::string &path, Error &err) {
+	std::string content;
+	if (fs::ReadFile(path, content) <= 0) return false;
+	err = FromJSON(giftStr(content));
+	return true;
+}
+
+Error WarmState::Save(const std::string &path) const {
+	WrSerializer ser;
+	GetJSON(ser);
+	const std::string tmpPath = path + ".tmp";
+	if (fs::WriteFile(tmpPath, ser.Slice()) != int64_t(ser.Len()) || fs::Rename(tmpPath, path) < 0) {
+		return Error(errParams, "Can't write warm state file '%s' - reason %s", path, strerror(errno));
+	}
+	return errOK;
+}
+
+}  // namespace reindexer
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "estl/span.h"
+#include "tools/errors.h"
+
+namespace gason {
+struct JsonNode;
+}
+
+namespace reindexer {
+
+class WrSerializer;
+
+/// Warm state of the database, which is stored into its storage directory periodically and on shutdown
+/// (see 'warmup_queries' of the maintenance config). After the restart the state is replayed in background, so the indexes and the
+/// caches, which were used by the traffic before the restart, are prepared before the database reports, that it is warmed up
+struct WarmState {
+	struct QueryEntry {
+		std::string sql;
+		uint64_t hits = 0;
+	};
+
+	Error FromJSON(span<char> json);
+	void FromJSON(const gason::JsonNode &root);
+	void GetJSON(WrSerializer &ser) const;
+	/// Reads the state from the file
+	/// @return false, if there is no state file
+	bool Load(const std::string &path, Error &err);
+	/// Replaces the state file. File is written under the temporary name first, so the restart never sees the partial one
+	Error Save(const std::string &path) const;
+
+	// Most frequent selects in the descending order of their hits
+	std::vector<QueryEntry> queries;
+	// Namespaces, which had built sort orders
+	std::vector<std::string> sortedNamespaces;
+};
+
+}  // namespace reindexer
@@ -1,4 +1,5 @@
 #include "coroutine.h"
+#include <atomic>
 #include <cstdio>
 #include <iterator>
 #include <thread>
@@ -8,6 +9,19 @@ namespace coroutine {
 
 static void static_entry() { ordinator::instance().entry(); }
 
+static std::atomic<size_t> live_routines{0};
+static std::atomic<size_t> live_routines_peak{0};
+static std::atomic<size_t> stacks_count{0};
+static std::atomic<size_t> pooled_stacks{0};
+static std::atomic<size_t> stacks_size{0};
+static std::atomic<size_t> stacks_size_peak{0};
+
+static void update_peak(std::atomic<size_t> &peak, size_t value) noexcept {
+	size_t cur = peak.load(std::memory_order_relaxed);
+	while (cur < value && !peak.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+	}
+}
+
 ordinator &ordinator::instance() noexcept {
 	static thread_local ordinator ord;
 	return ord;
@@ -34,18 +48,22 @@ void ordinator::entry() {
 	current_ = pop_from_call_stack();
 	current_routine.finalize();
 	finalized_indexes_.emplace_back(index);
+	live_routines.fetch_sub(1, std::memory_order_relaxed);
 }
 
 routine_t ordinator::create(std::function<void()> function, size_t stack_size) {
+	routine_t id;
 	if (finalized_indexes_.empty()) {
-		routines_.emplace_back(std::move(function), koishi_create(), stack_size);
-		return routines_.size();
+		routines_.emplace_back(std::move(function), stack_size);
+		id = routines_.size();
+	} else {
+		const routine_t index = finalized_indexes_.back();
+		finalized_indexes_.pop_back();
+		routines_[index].reuse(std::move(function), stack_size);
+		id = index + 1;
 	}
-
-	const routine_t index = finalized_indexes_.back();
-	finalized_indexes_.pop_back();
-	routines_[index].reuse(std::move(function), stack_size);
-	return index + 1;
+	update_peak(live_routines_peak, live_routines.fetch_add(1, std::memory_order_relaxed) + 1);
+	return id;
 }
 
 void ordinator::routine::reuse(std::function<void()> function, size_t new_stack_size) noexcept {
@@ -70,7 +88,7 @@ int ordinator::resume(routine_t id) {
 		routine &routine = routines_[id - 1];
 		if (routine.is_finalized()) return -2;
 
-		if (routine.is_empty()) routine.create_fiber();
+		if (routine.is_empty()) routine.create_fiber(stack_pool_);
 		push_to_call_stack(current_);
 
 		current_ = id;
@@ -183,24 +201,97 @@ size_t ordinator::shrink_storage() noexcept {
 		}
 	}
 	std::swap(finalized_indexes_, new_idx);
+	stack_pool_.clear();
 	return routines_.size();
 }
 
-void ordinator::routine::create_fiber() {
-	koishi_init(fiber_, stack_size_, reinterpret_cast<koishi_entrypoint_t>(static_entry));
-	is_empty_ = false;
+stats ordinator::get_stats() noexcept {
+	stats res;
+	res.live_routines = live_routines.load(std::memory_order_relaxed);
+	res.live_routines_peak = live_routines_peak.load(std::memory_order_relaxed);
+	res.stacks = stacks_count.load(std::memory_order_relaxed);
+	res.pooled_stacks = pooled_stacks.load(std::memory_order_relaxed);
+	res.stacks_size = stacks_size.load(std::memory_order_relaxed);
+	res.stacks_size_peak = stacks_size_peak.load(std::memory_order_relaxed);
+	return res;
+}
+
+size_t ordinator::stack_pool::size_class(size_t stack_size) noexcept {
+	const size_t real_size = koishi_util_real_stack_size(stack_size);
+	size_t cls = 0;
+	while (cls < k_stack_size_classes && (k_min_pooled_stack_size << cls) < real_size) ++cls;
+	return cls;
+}
+
+koishi_coroutine_t *ordinator::stack_pool::get(size_t stack_size) {
+	const size_t cls = size_class(stack_size);
+	if (cls < k_stack_size_classes) {
+		auto &stacks = stacks_[cls];
+		if (!stacks.empty()) {
+			koishi_coroutine_t *fiber = stacks.back();
+			stacks.pop_back();
+			pooled_stacks.fetch_sub(1, std::memory_order_relaxed);
+			koishi_recycle(fiber, reinterpret_cast<koishi_entrypoint_t>(static_entry));
+			return fiber;
+		}
+		stack_size = k_min_pooled_stack_size << cls;
+	}
+
+	koishi_coroutine_t *fiber = koishi_create();
+	koishi_init(fiber, stack_size, reinterpret_cast<koishi_entrypoint_t>(static_entry));
+	size_t real_size = 0;
+	koishi_get_stack(fiber, &real_size);
+	stacks_count.fetch_add(1, std::memory_order_relaxed);
+	update_peak(stacks_size_peak, stacks_size.fetch_add(real_size, std::memory_order_relaxed) + real_size);
+	return fiber;
+}
+
+void ordinator::stack_pool::put(koishi_coroutine_t *fiber) {
+	assertrx(fiber);
+	size_t real_size = 0;
+	koishi_get_stack(fiber, &real_size);
+	const size_t cls = size_class(real_size);
+	// Stack is pooled only if its size is exactly the size of the class (i.e. page size is not larger, than the class size)
+	if (cls < k_stack_size_classes && real_size == (k_min_pooled_stack_size << cls) && stacks_[cls].size() < k_max_pooled_stacks) {
+		stacks_[cls].emplace_back(fiber);
+		pooled_stacks.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	destroy(fiber);
+}
+
+void ordinator::stack_pool::clear() noexcept {
+	for (auto &stacks : stacks_) {
+		pooled_stacks.fetch_sub(stacks.size(), std::memory_order_relaxed);
+		for (auto fiber : stacks) destroy(fiber);
+		stacks.clear();
+		stacks.shrink_to_fit();
+	}
+}
+
+void ordinator::stack_pool::destroy(koishi_coroutine_t *fiber) noexcept {
+	size_t real_size = 0;
+	koishi_get_stack(fiber, &real_size);
+	koishi_deinit(fiber);
+	koishi_destroy(fiber);
+	stacks_count.fetch_sub(1, std::memory_order_relaxed);
+	stacks_size.fetch_sub(real_size, std::memory_order_relaxed);
+}
+
+void ordinator::routine::create_fiber(stack_pool &pool) {
+	assertrx(is_empty());
+	fiber_ = pool.get(stack_size_);
 }
 
 ordinator::routine::~routine() {
 	if (fiber_) {
-		clear();
-		koishi_destroy(fiber_);
+		stack_pool::destroy(fiber_);
 		fiber_ = nullptr;
 	}
 }
 
 ordinator::routine::routine(ordinator::routine &&o) noexcept
-	: func(std::move(o.func)), fiber_(o.fiber_), stack_size_(o.stack_size_), is_empty_(o.is_empty_), finalized_(o.finalized_) {
+	: func(std::move(o.func)), fiber_(o.fiber_), stack_size_(o.stack_size_), finalized_(o.finalized_) {
 	o.fiber_ = nullptr;
 }
 
@@ -209,18 +300,13 @@ void ordinator::routine::finalize() noexcept {
 	finalized_ = true;
 }
 
-void ordinator::routine::clear() noexcept {
-	koishi_deinit(fiber_);
-	is_empty_ = true;
-}
-
 void ordinator::clear_finalized() {
 	assertrx(!finalized_indexes_.empty());
 	auto index = finalized_indexes_.back();
 
 	auto &routine = routines_[index];
 	assertrx(routine.is_finalized());
-	routine.clear();
+	stack_pool_.put(routine.release_fiber());
 	if (loop_completion_callback_) {
 		loop_completion_callback_(index + 1);
 	}
@@ -239,6 +325,9 @@ ordinator::ordinator() : current_(0), loop_completion_callback_{nullptr} {
 }
 
 ordinator::~ordinator() {
+	for (auto &routine : routines_) {
+		if (!routine.is_finalized()) live_routines.fetch_sub(1, std::memory_order_relaxed);
+	}
 	routines_.clear();
 	finalized_indexes_.clear();
 	completion_callbacks_.clear();
@@ -14,6 +14,25 @@ namespace coroutine {
 using routine_t = uint32_t;
 
 constexpr size_t k_default_stack_limit = 128 * 1024;
+/// Stacks of the finished coroutines are pooled by the size classes: 16KB, 32KB, ..., 2MB. Requested stack size is rounded up to the
+/// closest class. Memory of the stacks is committed lazily, so the rounding doesn't increase RSS
+constexpr size_t k_min_pooled_stack_size = 16 * 1024;
+constexpr size_t k_stack_size_classes = 8;
+/// Max count of the pooled stacks of each size class per thread
+constexpr size_t k_max_pooled_stacks = 64;
+
+/// @struct Coroutines and stacks statistics of the whole process
+struct stats {
+	/// Count of the coroutines, which were created, but not finished yet
+	size_t live_routines = 0;
+	size_t live_routines_peak = 0;
+	/// Count of the allocated stacks including the pooled ones
+	size_t stacks = 0;
+	size_t pooled_stacks = 0;
+	/// Reserved size of the allocated stacks (without guard pages)
+	size_t stacks_size = 0;
+	size_t stacks_size_peak = 0;
+};
 
 /// @class Some kind of a coroutines scheduler. Exists as a singletone with thread_local storage duration.
 class ordinator {
@@ -58,13 +77,42 @@ public:
 	/// @param id - callback's ID
 	/// @return 0 if callback was successfully removed
 	int remove_completion_callback(int64_t id) noexcept;
-	/// Shrink coroutines storage and free some occupied memory (remove unused coroutine objects)
+	/// Shrink coroutines storage and free some occupied memory (remove unused coroutine objects and release pooled stacks)
 	/// @return New storage size
 	size_t shrink_storage() noexcept;
+	/// Get coroutines and stacks statistics of all the threads
+	static stats get_stats() noexcept;
 	/// Entry point for each new coroutine
 	void entry();
 
 private:
+	/// @class Pool of the stacks of the finished coroutines. Stack is reused by the coroutine of the same size class
+	/// without mmap/munmap calls
+	class stack_pool {
+	public:
+		stack_pool() noexcept = default;
+		~stack_pool() { clear(); }
+		stack_pool(const stack_pool &) = delete;
+		stack_pool &operator=(const stack_pool &) = delete;
+
+		/// Get initialized execution context with the stack of the required size class. Pooled stack is reused, if there is any
+		/// @param stack_size - Required stack size
+		koishi_coroutine_t *get(size_t stack_size);
+		/// Return execution context of the finished coroutine to the pool. Its stack is released, if the pool is full
+		/// @param fiber - Execution context to return
+		void put(koishi_coroutine_t *fiber);
+		/// Release all the pooled stacks
+		void clear() noexcept;
+		/// Release execution context with its stack
+		static void destroy(koishi_coroutine_t *fiber) noexcept;
+
+	private:
+		/// @returns Index of the size class or k_stack_size_classes, if the stacks of this size are not pooled
+		static size_t size_class(size_t stack_size) noexcept;
+
+		std::vector<koishi_coroutine_t *> stacks_[k_stack_size_classes];
+	};
+
 	/// @class Holds coroutine's data such as stack and state
 	class routine {
 	public:
@@ -72,10 +120,8 @@ private:
 		~routine();
 		routine(const routine &) = delete;
 		routine(routine &&other) noexcept;
-		routine(std::function<void()> _func, koishi_coroutine_t *fiber, size_t stack_size) noexcept
-			: func(std::move(_func)), fiber_(fiber), stack_size_(stack_size), is_empty_(true) {
+		routine(std::function<void()> _func, size_t stack_size) noexcept : func(std::move(_func)), stack_size_(stack_size) {
 			assertrx(stack_size_);
-			assertrx(fiber_);
 		}
 		routine &operator=(const routine &) = delete;
 		routine &operator=(routine &&) = delete;
@@ -85,14 +131,16 @@ private:
 		bool is_finalized() const noexcept { return finalized_; }
 		/// Mark routine as finilized
 		void finalize() noexcept;
-		/// Deallocate coroutines stack
-		void clear() noexcept;
+		/// Detach execution context with the stack from the finished coroutine
+		/// @returns Detached execution context
+		koishi_coroutine_t *release_fiber() noexcept { return std::exchange(fiber_, nullptr); }
 		/// Check if coroutine has allocated stack
 		/// @returns true - if stack is empty; false - if stack is allocated
-		bool is_empty() const noexcept { return is_empty_; }
-		/// Allocate coroutine's stack and create execution context on it
+		bool is_empty() const noexcept { return !fiber_; }
+		/// Get coroutine's stack from the pool and create execution context on it
 		/// Couroutine has to be empty to call this method
-		void create_fiber();
+		/// @param pool - Pool of the stacks of the current thread
+		void create_fiber(stack_pool &pool);
 		/// Reuse finalized coroutine with new func
 		/// @param _func - New coroutine's func
 		/// @param new_stack_size - New coroutines stack size
@@ -107,7 +155,6 @@ private:
 	private:
 		koishi_coroutine_t *fiber_ = nullptr;
 		size_t stack_size_ = k_default_stack_limit;
-		bool is_empty_ = true;
 		bool finalized_ = false;
 	};
 
@@ -135,6 +182,8 @@ private:
 	void clear_finalized();
 
 	routine_t current_;
+	/// Has to be destroyed after the routines
+	stack_pool stack_pool_;
 	std::vector<routine> routines_;
 	/// Stack, which contains sequence of coroutines switches. Ordiantor pushes new id in this stack on each resume()-call
 	/// and pops top id on each suspend()-call.
@@ -168,6 +217,8 @@ inline bool remove_loop_completion_callback() noexcept { return ordinator::insta
 inline int remove_completion_callback(int64_t id) noexcept { return ordinator::instance().remove_completion_callback(id); }
 /// Wrapper for corresponding ordinator's method
 inline size_t shrink_storage() noexcept { return ordinator::instance().shrink_storage(); }
+/// Wrapper for corresponding ordinator's method
+inline stats get_stats() noexcept { return ordinator::get_stats(); }
 
 }  // namespace coroutine
 }  // namespace reindexer
@@ -0,0 +1,323 @@
+#include "sampler.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include "debug/backtrace.h"
+#include "debug/resolver.h"
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/ucontext.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#define REINDEX_WITH_CPU_SAMPLER 1
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace reindexer {
+namespace debug {
+
+using namespace std::string_view_literals;
+
+static constexpr std::string_view kThreadRoleNames[] = {"other"sv, "rpc"sv, "http"sv, "background"sv, "storage_flush"sv};
+static_assert(sizeof(kThreadRoleNames) / sizeof(kThreadRoleNames[0]) == unsigned(ThreadRole::Count), "Name is required for each role");
+
+std::string_view ThreadRoleName(ThreadRole role) noexcept { return kThreadRoleNames[unsigned(role)]; }
+
+std::optional<ThreadRole> ParseThreadRole(std::string_view name) noexcept {
+	for (unsigned i = 0; i < unsigned(ThreadRole::Count); ++i) {
+		if (kThreadRoleNames[i] == name) return ThreadRole(i);
+	}
+	return std::nullopt;
+}
+
+struct CPUSampler::Stack {
+	ThreadRole role;
+	unsigned depth;
+	void *pcs[kMaxDepth];
+};
+
+CPUSampler &CPUSampler::Instance() {
+	// Never destroyed: signals may be delivered during the static destruction
+	static CPUSampler *instance = new CPUSampler;
+	return *instance;
+}
+
+#if REINDEX_WITH_CPU_SAMPLER
+
+namespace {
+
+// Slot of the ring is written by the signal handler under the seqlock: odd sequence means, that the slot is being written now
+struct Sample {
+	std::atomic<uint32_t> seq = {0};
+	unsigned depth = 0;
+	int64_t timeMs = 0;
+	// pcs[0] is not used by backtrace_internal
+	void *pcs[CPUSampler::kMaxDepth + 1];
+};
+
+struct Ring {
+	std::atomic<uint64_t> head = {0};
+	Sample samples[CPUSampler::kSamplesPerRole];
+};
+
+// Rings are allocated on the first start and are never freed, so the handler does not need any synchronization with the readers
+std::atomic<Ring *> g_rings = {nullptr};
+thread_local std::atomic<int> t_role = {-1};
+
+int64_t monotonicMs() noexcept {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return int64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+uintptr_t interruptedPC(void *ctx) noexcept {
+#if defined(__x86_64__)
+	return uintptr_t(reinterpret_cast<ucontext_t *>(ctx)->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+	return uintptr_t(reinterpret_cast<ucontext_t *>(ctx)->uc_mcontext.pc);
+#else
+	(void)ctx;
+	return 0;
+#endif
+}
+
+// Unwinders without the context support start from the handler itself: its frames and the frames past the end of the stack are dropped
+unsigned trimStack(void **pcs, unsigned depth, void *ctx) noexcept {
+	const uintptr_t pc = interruptedPC(ctx);
+	unsigned first = 0;
+	for (unsigned i = 0; pc && i < depth; ++i) {
+		if (uintptr_t(pcs[i]) == pc) {
+			first = i;
+			break;
+		}
+	}
+	unsigned last = depth;
+	while (last > first && (!pcs[last - 1] || uintptr_t(pcs[last - 1]) == ~uintptr_t(0))) --last;
+	std::copy(pcs + first, pcs + last, pcs);
+	return last - first;
+}
+
+void sampleHandler(int, siginfo_t *info, void *ctx) {
+	const int role = t_role.load(std::memory_order_relaxed);
+	Ring *rings = g_rings.load(std::memory_order_acquire);
+	if (role < 0 || !rings || info->si_code != SI_TIMER) return;
+
+	const int savedErrno = errno;
+	Ring &ring = rings[role];
+	Sample &sample = ring.samples[ring.head.fetch_add(1, std::memory_order_relaxed) % CPUSampler::kSamplesPerRole];
+	const uint32_t seq = sample.seq.load(std::memory_order_relaxed);
+	sample.seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	std::string_view method;
+	const int depth = backtrace_internal(sample.pcs, CPUSampler::kMaxDepth + 1, ctx, method);
+	sample.depth = depth > 1 ? trimStack(sample.pcs + 1, depth - 1, ctx) : 0;
+	sample.timeMs = monotonicMs();
+	sample.seq.store(seq + 2, std::memory_order_release);
+	errno = savedErrno;
+}
+
+}  // namespace
+
+struct CPUSampler::ThreadState {
+	timer_t timer;
+};
+
+struct CPUSampler::ThreadGuard {
+	~ThreadGuard() {
+		if (state) CPUSampler::Instance().unregister(state);
+	}
+	ThreadState *state = nullptr;
+};
+
+bool CPUSampler::IsSupported() noexcept { return true; }
+
+void CPUSampler::RegisterThread(ThreadRole role) {
+	thread_local ThreadGuard guard;
+	t_role.store(int(role), std::memory_order_relaxed);
+	if (guard.state) return;
+
+	auto state = std::make_unique<ThreadState>();
+	sigevent sev;
+	memset(&sev, 0, sizeof(sev));
+	sev.sigev_notify = SIGEV_THREAD_ID;
+	sev.sigev_signo = SIGPROF;
+	sev.sigev_notify_thread_id = syscall(SYS_gettid);
+	if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &state->timer) != 0) return;
+
+	auto &sampler = Instance();
+	std::lock_guard<std::mutex> lck(sampler.mtx_);
+	arm(*state, sampler.Frequency());
+	guard.state = state.release();
+	sampler.threads_.emplace_back(guard.state);
+}
+
+void CPUSampler::unregister(ThreadState *state) {
+	t_role.store(-1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		threads_.erase(std::find(threads_.begin(), threads_.end(), state));
+	}
+	timer_delete(state->timer);
+	delete state;
+}
+
+void CPUSampler::arm(ThreadState &state, int hz) noexcept {
+	itimerspec its;
+	memset(&its, 0, sizeof(its));
+	if (hz > 0) {
+		its.it_interval.tv_nsec = 1000000000 / hz;
+		its.it_value = its.it_interval;
+	}
+	timer_settime(state.timer, 0, &its, nullptr);
+}
+
+Error CPUSampler::Start(int hz) {
+	if (hz <= 0 || hz > 1000) return Error(errParams, "Sampling frequency must be in [1, 1000] Hz, got %d", hz);
+
+	std::lock_guard<std::mutex> lck(mtx_);
+	if (!g_rings.load(std::memory_order_relaxed)) {
+		// Unwinder may allocate on the first call, so it must not happen in the signal handler
+		void *pcs[kMaxDepth];
+		std::string_view method;
+		backtrace_internal(pcs, kMaxDepth, nullptr, method);
+		g_rings.store(new Ring[unsigned(ThreadRole::Count)], std::memory_order_release);
+
+		struct sigaction sa;
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_sigaction = sampleHandler;
+		sa.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&sa.sa_mask);
+		if (sigaction(SIGPROF, &sa, nullptr) != 0) return Error(errLogic, "Unable to set SIGPROF handler: %s", strerror(errno));
+	}
+	hz_.store(hz, std::memory_order_relaxed);
+	lastHz_.store(hz, std::memory_order_relaxed);
+	for (auto state : threads_) arm(*state, hz);
+	return Error();
+}
+
+void CPUSampler::Stop() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	hz_.store(0, std::memory_order_relaxed);
+	for (auto state : threads_) arm(*state, 0);
+}
+
+std::vector<CPUSampler::Stack> CPUSampler::stacks(std::chrono::seconds window, std::optional<ThreadRole> role) const {
+	std::vector<Stack> ret;
+	const Ring *rings = g_rings.load(std::memory_order_acquire);
+	if (!rings) return ret;
+
+	const int64_t minTimeMs = monotonicMs() - std::chrono::duration_cast<std::chrono::milliseconds>(window).count();
+	for (unsigned r = 0; r < unsigned(ThreadRole::Count); ++r) {
+		if (role && *role != ThreadRole(r)) continue;
+		for (const Sample &sample : rings[r].samples) {
+			const uint32_t seq = sample.seq.load(std::memory_order_acquire);
+			if (!seq || (seq & 1)) continue;
+			Stack stack;
+			stack.role = ThreadRole(r);
+			stack.depth = std::min(sample.depth, kMaxDepth);
+			const int64_t timeMs = sample.timeMs;
+			std::copy(sample.pcs + 1, sample.pcs + 1 + stack.depth, stack.pcs);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sample.seq.load(std::memory_order_relaxed) != seq || timeMs < minTimeMs || !stack.depth) continue;
+			ret.emplace_back(stack);
+		}
+	}
+	return ret;
+}
+
+std::string CPUSampler::Collapsed(std::chrono::seconds window, std::optional<ThreadRole> role) const {
+	std::unordered_map<uintptr_t, std::string> names;
+	auto frameName = [&names](uintptr_t addr) -> const std::string & {
+		auto it = names.find(addr);
+		if (it == names.end()) {
+			TraceEntry te(addr);
+			std::string name(te.FuncName());
+			if (name.empty() || name[0] == '<') {
+				char buf[32];
+				snprintf(buf, sizeof(buf), "0x%lx", static_cast<unsigned long>(addr));
+				name = buf;
+			}
+			// ';' separates the frames and ' ' separates the count
+			std::replace(name.begin(), name.end(), ';', ',');
+			it = names.emplace(addr, std::move(name)).first;
+		}
+		return it->second;
+	};
+
+	std::map<std::string, uint64_t> counts;
+	std::string line;
+	for (const Stack &stack : stacks(window, role)) {
+		line = ThreadRoleName(stack.role);
+		for (unsigned i = stack.depth; i > 0; --i) {
+			line += ';';
+			// Callers' addresses are the return addresses, which may point to the next function already
+			const uintptr_t addr = uintptr_t(stack.pcs[i - 1]) - (i > 1 ? 1 : 0);
+			line += frameName(addr);
+		}
+		++counts[line];
+	}
+
+	std::string ret;
+	for (const auto &c : counts) {
+		ret += c.first;
+		ret += ' ';
+		ret += std::to_string(c.second);
+		ret += '\n';
+	}
+	return ret;
+}
+
+std::string CPUSampler::Profile(std::chrono::seconds window, std::optional<ThreadRole> role) const {
+	std::map<std::vector<uintptr_t>, uintptr_t> counts;
+	for (const Stack &stack : stacks(window, role)) {
+		++counts[std::vector<uintptr_t>(reinterpret_cast<const uintptr_t *>(stack.pcs),
+										reinterpret_cast<const uintptr_t *>(stack.pcs) + stack.depth)];
+	}
+
+	const int hz = lastHz_.load(std::memory_order_relaxed);
+	// Header: header words count, version, sampling period in microseconds and padding
+	std::vector<uintptr_t> words = {0, 3, 0, uintptr_t(1000000 / hz), 0};
+	for (const auto &c : counts) {
+		words.emplace_back(c.second);
+		words.emplace_back(c.first.size());
+		words.insert(words.end(), c.first.begin(), c.first.end());
+	}
+	// Trailer
+	words.insert(words.end(), {0, 1, 0});
+
+	std::string ret(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(uintptr_t));
+	// Mapped objects are required to symbolize the profile
+	std::ifstream maps("/proc/self/maps");
+	std::stringstream mapsContent;
+	mapsContent << maps.rdbuf();
+	ret += mapsContent.str();
+	return ret;
+}
+
+#else  // REINDEX_WITH_CPU_SAMPLER
+
+struct CPUSampler::ThreadState {};
+
+bool CPUSampler::IsSupported() noexcept { return false; }
+void CPUSampler::RegisterThread(ThreadRole) {}
+void CPUSampler::unregister(ThreadState *) {}
+void CPUSampler::arm(ThreadState &, int) noexcept {}
+Error CPUSampler::Start(int) { return Error(errForbidden, "Sampling CPU profiler is supported on Linux only"); }
+void CPUSampler::Stop() {}
+std::vector<CPUSampler::Stack> CPUSampler::stacks(std::chrono::seconds, std::optional<ThreadRole>) const { return {}; }
+std::string CPUSampler::Collapsed(std::chrono::seconds, std::optional<ThreadRole>) const { return {}; }
+std::string CPUSampler::Profile(std::chrono::seconds, std::optional<ThreadRole>) const { return {}; }
+
+#endif	// REINDEX_WITH_CPU_SAMPLER
+
+}  // namespace debug
+}  // namespace reindexer
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "tools/errors.h"
+
+namespace reindexer {
+namespace debug {
+
+/// Role of the thread. Samples of the threads are aggregated by their roles
+enum class ThreadRole : unsigned { Other = 0, RPC, HTTP, Background, StorageFlush, Count };
+
+std::string_view ThreadRoleName(ThreadRole role) noexcept;
+std::optional<ThreadRole> ParseThreadRole(std::string_view name) noexcept;
+
+/// Always-on sampling CPU profiler. Each registered thread has its own CPU-time timer, which sends SIGPROF to this thread. Signal handler
+/// unwinds the stack of the interrupted thread into the preallocated ring of the samples of the thread's role, so the last kSamplesPerRole
+/// samples of each role are available for the rolling window profiles
+class CPUSampler {
+public:
+	static constexpr unsigned kMaxDepth = 32;
+	static constexpr size_t kSamplesPerRole = 16384;
+
+	static CPUSampler &Instance();
+	static bool IsSupported() noexcept;
+	/// Registers current thread for the sampling. Thread is unregistered on exit
+	static void RegisterThread(ThreadRole role);
+
+	/// @param hz - samples per second of the CPU time of each thread
+	Error Start(int hz);
+	void Stop();
+	int Frequency() const noexcept { return hz_.load(std::memory_order_relaxed); }
+
+	/// Stacks of the samples of the last `window` in the collapsed format: "role;caller;...;callee count" per line
+	/// @param role - role of the threads. Samples of all roles, if not set
+	std::string Collapsed(std::chrono::seconds window, std::optional<ThreadRole> role = std::nullopt) const;
+	/// Samples of the last `window` in the legacy gperftools CPU profile format, which is readable by pprof
+	std::string Profile(std::chrono::seconds window, std::optional<ThreadRole> role = std::nullopt) const;
+
+private:
+	struct ThreadState;
+	struct ThreadGuard;
+	struct Stack;
+
+	CPUSampler() = default;
+	std::vector<Stack> stacks(std::chrono::seconds window, std::optional<ThreadRole> role) const;
+	static void arm(ThreadState &state, int hz) noexcept;
+	void unregister(ThreadState *state);
+
+	std::mutex mtx_;
+	std::vector<ThreadState *> threads_;
+	std::atomic<int> hz_ = {0};
+	std::atomic<int> lastHz_ = {1};
+};
+
+}  // namespace debug
+}  // namespace reindexer
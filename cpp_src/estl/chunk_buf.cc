@@ -0,0 +1,67 @@
+#include "chunk_buf.h"
+
+namespace reindexer {
+
+chunk_pool &chunk_pool::instance() noexcept {
+	// Pool is never destroyed, so the chunks of the static objects may be released after the exit from main()
+	static chunk_pool *pool = new chunk_pool();
+	return *pool;
+}
+
+chunk_pool::chunk_pool() {
+	for (size_t i = 0; i < kClassesCount; ++i) {
+		// Buffers are returned into the pool without allocations
+		classes_[i].buffers.reserve(kMaxPooledBytesPerClass / (kMinSize << i));
+	}
+}
+
+size_t chunk_pool::class_index(size_t size) noexcept {
+	size_t idx = 0;
+	while (idx < kClassesCount && (kMinSize << idx) < size) ++idx;
+	return idx;
+}
+
+uint8_t *chunk_pool::get(size_t &size) {
+	const size_t idx = class_index(size);
+	if (idx == kClassesCount) {
+		return new uint8_t[size];
+	}
+	size = kMinSize << idx;
+	auto &cls = classes_[idx];
+	{
+		std::lock_guard lck(cls.mtx);
+		if (!cls.buffers.empty()) {
+			uint8_t *data = cls.buffers.back();
+			cls.buffers.pop_back();
+			pooled_bytes_.fetch_sub(size, std::memory_order_relaxed);
+			return data;
+		}
+	}
+	return new uint8_t[size];
+}
+
+void chunk_pool::put(uint8_t *data, size_t size) noexcept {
+	const size_t idx = class_index(size);
+	if (idx < kClassesCount && size == (kMinSize << idx)) {
+		auto &cls = classes_[idx];
+		std::lock_guard lck(cls.mtx);
+		if (cls.buffers.size() < cls.buffers.capacity()) {
+			cls.buffers.push_back(data);
+			pooled_bytes_.fetch_add(size, std::memory_order_relaxed);
+			return;
+		}
+	}
+	delete[] data;
+}
+
+void chunk_pool::clear() noexcept {
+	for (size_t i = 0; i < kClassesCount; ++i) {
+		auto &cls = classes_[i];
+		std::lock_guard lck(cls.mtx);
+		for (uint8_t *data : cls.buffers) delete[] data;
+		pooled_bytes_.fetch_sub(cls.buffers.size() * (kMinSize << i), std::memory_order_relaxed);
+		cls.buffers.clear();
+	}
+}
+
+}  // namespace reindexer
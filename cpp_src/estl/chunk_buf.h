@@ -1,19 +1,57 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <mutex>
 #include <stdlib.h>
 #include <string_view>
 #include <vector>
+#include "mutex.h"
 #include "span.h"
 
 namespace reindexer {
 
+/// Process-wide pool of the chunks' buffers by the size classes: 4KB, 8KB, ..., 256KB. Buffers are allocated by new[], so the buffer
+/// may still be taken by WrSerializer (and vice versa)
+class chunk_pool {
+public:
+	static constexpr size_t kMinSize = 0x1000;
+	static constexpr size_t kClassesCount = 7;
+	static constexpr size_t kMaxSize = kMinSize << (kClassesCount - 1);
+	/// Max size of the pooled buffers of each size class
+	static constexpr size_t kMaxPooledBytesPerClass = 0x800000;
+
+	static chunk_pool &instance() noexcept;
+
+	/// Get buffer of the size class, which fits 'size' bytes. Larger buffers are allocated without pooling
+	/// @param size - Required size. Size of the returned buffer is written here
+	uint8_t *get(size_t &size);
+	/// Return buffer to the pool. Buffer is released, if its size is not the size of any class or the pool of its class is full
+	void put(uint8_t *data, size_t size) noexcept;
+	size_t pooled_bytes() const noexcept { return pooled_bytes_.load(std::memory_order_relaxed); }
+	/// Release all the pooled buffers
+	void clear() noexcept;
+
+private:
+	struct size_class {
+		spinlock mtx;
+		std::vector<uint8_t *> buffers;
+	};
+
+	chunk_pool();
+	~chunk_pool() = delete;
+
+	static size_t class_index(size_t size) noexcept;
+
+	size_class classes_[kClassesCount];
+	std::atomic<size_t> pooled_bytes_{0};
+};
+
 class chunk {
 public:
 	chunk() : data_(nullptr), len_(0), offset_(0), cap_(0) {}
-	~chunk() { delete[] data_; }
+	~chunk() { release(); }
 	chunk(const chunk &) = delete;
 	chunk &operator=(const chunk &) = delete;
 	chunk(chunk &&other) noexcept {
@@ -28,7 +66,7 @@ public:
 	}
 	chunk &operator=(chunk &&other) noexcept {
 		if (this != &other) {
-			delete[] data_;
+			release();
 			data_ = other.data_;
 			len_ = other.len_;
 			offset_ = other.offset_;
@@ -42,17 +80,23 @@ public:
 	}
 	void append(std::string_view data) {
 		if (!data_ || len_ + data.size() > cap_) {
-			cap_ = std::max(size_t(0x1000), size_t(len_ + data.size()));
-			uint8_t *newdata = new uint8_t[cap_];
-			if (data_) {
-				memcpy(newdata, data_, len_);
-			}
-			delete data_;
-			data_ = newdata;
+			reserve(len_ + data.size());
 		}
 		memcpy(data_ + len_, data.data(), data.size());
 		len_ += data.size();
 	}
+	/// Grow buffer to fit at least 'cap' bytes
+	void reserve(size_t cap) {
+		if (data_ && cap <= cap_) return;
+		size_t newcap = std::max(chunk_pool::kMinSize, cap);
+		uint8_t *newdata = chunk_pool::instance().get(newcap);
+		if (data_) {
+			memcpy(newdata, data_, len_);
+			chunk_pool::instance().put(data_, cap_);
+		}
+		data_ = newdata;
+		cap_ = newcap;
+	}
 	size_t size() { return len_ - offset_; }
 	uint8_t *data() { return data_ + offset_; }
 
@@ -60,6 +104,11 @@ public:
 	size_t len_;
 	size_t offset_;
 	size_t cap_;
+
+private:
+	void release() noexcept {
+		if (data_) chunk_pool::instance().put(data_, cap_);
+	}
 };
 
 template <typename Mutex>
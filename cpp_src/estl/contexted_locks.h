@@ -4,6 +4,7 @@
 #include <functional>
 #include <mutex>
 
+#include "estl/lockstats.h"
 #include "tools/errors.h"
 
 using std::chrono::milliseconds;
@@ -39,13 +40,20 @@ public:
 		assertrx(_M_context);
 	}
 	contexted_unique_lock(contexted_unique_lock&& lck)
-		: _M_mtx(lck._M_mtx), _M_owns(lck._M_owns), _M_context(lck._M_context), _M_chkTimeout(lck._M_chkTimeout) {
+		: _M_mtx(lck._M_mtx),
+		  _M_owns(lck._M_owns),
+		  _M_context(lck._M_context),
+		  _M_chkTimeout(lck._M_chkTimeout),
+		  _M_lockedAt(lck._M_lockedAt) {
 		lck._M_owns = false;
 		lck._M_mtx = nullptr;
 		lck._M_context = nullptr;
 	}
 	~contexted_unique_lock() {
-		if (_M_owns) _M_mtx->unlock();
+		if (_M_owns) {
+			_M_countHold();
+			_M_mtx->unlock();
+		}
 	}
 
 	contexted_unique_lock(const contexted_unique_lock&) = delete;
@@ -57,6 +65,7 @@ public:
 			_M_owns = lck._M_owns;
 			_M_context = lck._M_context;
 			_M_chkTimeout = lck._M_chkTimeout;
+			_M_lockedAt = lck._M_lockedAt;
 			lck._M_owns = false;
 			lck._M_mtx = nullptr;
 			lck._M_context = nullptr;
@@ -69,6 +78,8 @@ public:
 		_M_lockable();
 		assertrx(_M_context);
 		const auto lockWard = _M_context->BeforeLock(_Mutex::mark);
+		LockStats* stats = _M_stats();
+		const auto waitStart = stats ? LockStats::Clock::now() : LockStats::Clock::time_point();
 		if (_M_chkTimeout.count() > 0 && _M_context->isCancelable()) {
 			do {
 				ThrowOnCancel(*_M_context, "Write lock (contexted_unique_lock) was canceled on condition"sv);
@@ -77,6 +88,10 @@ public:
 			_M_mtx->lock();
 		}
 		_M_owns = true;
+		if (stats) {
+			_M_lockedAt = LockStats::Clock::now();
+			stats->Add(LockStats::ExclusiveWait, _M_lockedAt - waitStart);
+		}
 	}
 
 	bool try_lock() {
@@ -86,12 +101,14 @@ public:
 
 	void unlock() {
 		if (!_M_owns) assertrx(0);
+		_M_countHold();
 		_M_mtx->unlock();
 		_M_owns = false;
 	}
 
 	MutexType* release() noexcept {
 		_M_owns = false;
+		_M_lockedAt = LockStats::Clock::time_point();
 		auto ret = _M_mtx;
 		_M_mtx = nullptr;
 		return ret;
@@ -106,11 +123,29 @@ private:
 		if (_M_mtx == nullptr) assertrx(0);
 		if (_M_owns) assertrx(0);
 	}
+	LockStats* _M_stats() const noexcept {
+		if constexpr (HasLockStats<MutexType>::value) {
+			LockStats& stats = _M_mtx->Stats();
+			return stats.Enabled() ? &stats : nullptr;
+		} else {
+			return nullptr;
+		}
+	}
+	void _M_countHold() noexcept {
+		if constexpr (HasLockStats<MutexType>::value) {
+			if (_M_lockedAt != LockStats::Clock::time_point()) {
+				_M_mtx->Stats().Add(LockStats::ExclusiveHold, LockStats::Clock::now() - _M_lockedAt);
+				_M_lockedAt = LockStats::Clock::time_point();
+			}
+		}
+	}
 
 	MutexType* _M_mtx;
 	bool _M_owns;
 	Context* _M_context;
 	milliseconds _M_chkTimeout;
+	// Time of the lock acquisition, if the lock stats are collected
+	LockStats::Clock::time_point _M_lockedAt;
 };
 
 template <typename _Mutex, typename Context>
@@ -133,13 +168,20 @@ public:
 		assertrx(_M_context);
 	}
 	contexted_shared_lock(contexted_shared_lock&& lck)
-		: _M_mtx(lck._M_mtx), _M_owns(lck._M_owns), _M_context(lck._M_context), _M_chkTimeout(lck._M_chkTimeout) {
+		: _M_mtx(lck._M_mtx),
+		  _M_owns(lck._M_owns),
+		  _M_context(lck._M_context),
+		  _M_chkTimeout(lck._M_chkTimeout),
+		  _M_lockedAt(lck._M_lockedAt) {
 		lck._M_owns = false;
 		lck._M_mtx = nullptr;
 		lck._M_context = nullptr;
 	}
 	~contexted_shared_lock() {
-		if (_M_owns) _M_mtx->unlock_shared();
+		if (_M_owns) {
+			_M_countHold();
+			_M_mtx->unlock_shared();
+		}
 	}
 
 	contexted_shared_lock(const contexted_shared_lock&) = delete;
@@ -151,6 +193,7 @@ public:
 			_M_owns = lck._M_owns;
 			_M_context = lck._M_context;
 			_M_chkTimeout = lck._M_chkTimeout;
+			_M_lockedAt = lck._M_lockedAt;
 			lck._M_owns = false;
 			lck._M_mtx = nullptr;
 			lck._M_context = nullptr;
@@ -163,6 +206,8 @@ public:
 		_M_lockable();
 		assertrx(_M_context);
 		const auto lockWard = _M_context->BeforeLock(_Mutex::mark);
+		LockStats* stats = _M_stats();
+		const auto waitStart = stats ? LockStats::Clock::now() : LockStats::Clock::time_point();
 		if (_M_chkTimeout.count() > 0 && _M_context->isCancelable()) {
 			do {
 				ThrowOnCancel(*_M_context, "Read lock (contexted_shared_lock) was canceled on condition"sv);
@@ -171,6 +216,10 @@ public:
 			_M_mtx->lock_shared();
 		}
 		_M_owns = true;
+		if (stats) {
+			_M_lockedAt = LockStats::Clock::now();
+			stats->Add(LockStats::SharedWait, _M_lockedAt - waitStart);
+		}
 	}
 
 	bool try_lock() {
@@ -180,12 +229,14 @@ public:
 
 	void unlock() {
 		if (!_M_owns) assertrx(0);
+		_M_countHold();
 		_M_mtx->unlock_shared();
 		_M_owns = false;
 	}
 
 	MutexType* release() noexcept {
 		_M_owns = false;
+		_M_lockedAt = LockStats::Clock::time_point();
 		auto ret = _M_mtx;
 		_M_mtx = nullptr;
 		return ret;
@@ -200,11 +251,29 @@ private:
 		if (_M_mtx == nullptr) assertrx(0);
 		if (_M_owns) assertrx(0);
 	}
+	LockStats* _M_stats() const noexcept {
+		if constexpr (HasLockStats<MutexType>::value) {
+			LockStats& stats = _M_mtx->Stats();
+			return stats.Enabled() ? &stats : nullptr;
+		} else {
+			return nullptr;
+		}
+	}
+	void _M_countHold() noexcept {
+		if constexpr (HasLockStats<MutexType>::value) {
+			if (_M_lockedAt != LockStats::Clock::time_point()) {
+				_M_mtx->Stats().Add(LockStats::SharedHold, LockStats::Clock::now() - _M_lockedAt);
+				_M_lockedAt = LockStats::Clock::time_point();
+			}
+		}
+	}
 
 	MutexType* _M_mtx;
 	bool _M_owns;
 	Context* _M_context;
 	milliseconds _M_chkTimeout;
+	// Time of the lock acquisition, if the lock stats are collected
+	LockStats::Clock::time_point _M_lockedAt;
 };
 
 }  // namespace reindexer
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+#include "estl/mutex.h"
+
+namespace reindexer {
+
+/// Wait and hold times of the mutex locks. Times are counted by the power of two buckets of microseconds with the atomic counters, so
+/// the stats are updated without any additional lock. Stats are collected only while enabled
+class LockStats {
+public:
+	enum Kind : unsigned { SharedWait = 0, SharedHold, ExclusiveWait, ExclusiveHold, KindsCount };
+	using Clock = std::chrono::steady_clock;
+	static constexpr unsigned kBucketsCount = 40;
+
+	struct Snapshot {
+		uint64_t count = 0;
+		uint64_t totalUs = 0;
+		uint64_t maxUs = 0;
+		uint64_t p50Us = 0;
+		uint64_t p99Us = 0;
+	};
+
+	bool Enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+	void Enable(bool enable) noexcept { enabled_.store(enable, std::memory_order_relaxed); }
+	void Add(Kind kind, Clock::duration time) noexcept {
+		const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+		Counters &c = counters_[kind];
+		c.buckets[bucketIdx(us)].fetch_add(1, std::memory_order_relaxed);
+		c.totalUs.fetch_add(us, std::memory_order_relaxed);
+		uint64_t maxUs = c.maxUs.load(std::memory_order_relaxed);
+		while (us > maxUs && !c.maxUs.compare_exchange_weak(maxUs, us, std::memory_order_relaxed)) {
+		}
+	}
+	/// Counters are read without snapshot isolation, so the concurrent locks may be partially counted
+	Snapshot Get(Kind kind) const noexcept {
+		const Counters &c = counters_[kind];
+		Snapshot ret;
+		uint64_t buckets[kBucketsCount], total = 0;
+		for (unsigned i = 0; i < kBucketsCount; ++i) {
+			buckets[i] = c.buckets[i].load(std::memory_order_relaxed);
+			total += buckets[i];
+		}
+		ret.count = total;
+		ret.totalUs = c.totalUs.load(std::memory_order_relaxed);
+		ret.maxUs = c.maxUs.load(std::memory_order_relaxed);
+		ret.p50Us = quantile(buckets, total, 0.5, ret.maxUs);
+		ret.p99Us = quantile(buckets, total, 0.99, ret.maxUs);
+		return ret;
+	}
+	void Reset() noexcept {
+		for (auto &c : counters_) {
+			for (auto &b : c.buckets) b.store(0, std::memory_order_relaxed);
+			c.totalUs.store(0, std::memory_order_relaxed);
+			c.maxUs.store(0, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	struct Counters {
+		std::atomic<uint64_t> buckets[kBucketsCount] = {};
+		std::atomic<uint64_t> totalUs = {0};
+		std::atomic<uint64_t> maxUs = {0};
+	};
+
+	// Bucket i contains times in [2^(i - 1), 2^i) microseconds, bucket 0 - times less than 1 microsecond
+	static unsigned bucketIdx(uint64_t us) noexcept {
+		return us ? std::min<unsigned>(64 - __builtin_clzll(us), kBucketsCount - 1) : 0;
+	}
+	static uint64_t quantile(const uint64_t *buckets, uint64_t total, double q, uint64_t maxUs) noexcept {
+		if (!total) return 0;
+		const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * double(total))));
+		uint64_t seen = 0;
+		for (unsigned i = 0; i + 1 < kBucketsCount; ++i) {
+			seen += buckets[i];
+			if (seen >= rank) return std::min(i ? (uint64_t(1) << i) - 1 : 0, maxUs);
+		}
+		return maxUs;
+	}
+
+	Counters counters_[KindsCount];
+	std::atomic<bool> enabled_ = {false};
+};
+
+/// Marked mutex, which has stats of its contexted locks
+template <typename Mutex, MutexMark m>
+class ProfiledMarkedMutex : public MarkedMutex<Mutex, m> {
+public:
+	LockStats &Stats() const noexcept { return stats_; }
+
+private:
+	mutable LockStats stats_;
+};
+
+template <typename Mutex, typename = void>
+struct HasLockStats : std::false_type {};
+template <typename Mutex>
+struct HasLockStats<Mutex, std::void_t<decltype(std::declval<const Mutex &>().Stats())>> : std::true_type {};
+
+}  // namespace reindexer
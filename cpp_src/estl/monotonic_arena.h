@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace reindexer {
+
+/// Monotonic memory arena for short-lived temporaries.
+/// Memory is allocated from the chained blocks and is never reused: deallocation is no-op and all of the blocks are released at once
+/// on Release() or in destructor. Blocks are allocated lazily, so empty arena does not use heap. Not thread safe
+class MonotonicArena {
+public:
+	static constexpr size_t kDefaultBlockSize = 4096;
+	static constexpr size_t kMaxBlockSize = 1 << 20;
+	static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+	explicit MonotonicArena(size_t initialBlockSize = kDefaultBlockSize) noexcept : nextBlockSize_(initialBlockSize) {}
+	MonotonicArena(const MonotonicArena &) = delete;
+	MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+	/// Allocates size bytes, aligned by kAlignment
+	void *Allocate(size_t size) {
+		size = (size + kAlignment - 1) & ~(kAlignment - 1);
+		if (size > size_t(end_ - cur_)) {
+			// Huge allocations get separate block to keep the rest of current block usable
+			if (size > nextBlockSize_ / 2) {
+				return allocateBlock(size);
+			}
+			cur_ = allocateBlock(nextBlockSize_);
+			end_ = cur_ + nextBlockSize_;
+			nextBlockSize_ = std::min(nextBlockSize_ * 2, kMaxBlockSize);
+		}
+		void *res = cur_;
+		cur_ += size;
+		return res;
+	}
+	/// Releases all of the allocated memory
+	void Release() noexcept {
+		blocks_.clear();
+		cur_ = end_ = nullptr;
+		allocated_ = 0;
+	}
+	/// @return total size of the allocated blocks
+	size_t Allocated() const noexcept { return allocated_; }
+
+private:
+	char *allocateBlock(size_t size) {
+		// operator new[] for char returns memory, aligned by alignof(std::max_align_t)
+		blocks_.emplace_back(new char[size]);
+		allocated_ += size;
+		return blocks_.back().get();
+	}
+
+	std::vector<std::unique_ptr<char[]>> blocks_;
+	char *cur_ = nullptr;
+	char *end_ = nullptr;
+	size_t nextBlockSize_;
+	size_t allocated_ = 0;
+};
+
+/// STL allocator over MonotonicArena. Allocator without arena uses global heap, so the same container type may be used in both cases
+template <typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+	template <typename U>
+	struct rebind {
+		using other = ArenaAllocator<U>;
+	};
+
+	ArenaAllocator(MonotonicArena *arena = nullptr) noexcept : arena_(arena) {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.arena_) {}
+
+	T *allocate(size_t n) {
+		static_assert(alignof(T) <= MonotonicArena::kAlignment, "Overaligned types are not supported");
+		return arena_ ? static_cast<T *>(arena_->Allocate(n * sizeof(T))) : std::allocator<T>().allocate(n);
+	}
+	void deallocate(T *p, size_t n) noexcept {
+		if (!arena_) std::allocator<T>().deallocate(p, n);
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U> &other) const noexcept {
+		return arena_ == other.arena_;
+	}
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U> &other) const noexcept {
+		return arena_ != other.arena_;
+	}
+
+private:
+	template <typename U>
+	friend class ArenaAllocator;
+
+	MonotonicArena *arena_;
+};
+
+}  // namespace reindexer
@@ -1,11 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 #include "tools/assertrx.h"
 
 namespace reindexer {
+
+/// Vector of the variable-length packed values. Values are delta-packed: T::pack receives the delta base of the previous value
+/// (T::DeltaBase()) and T::unpack is called on the previous unpacked value, so each value may be decoded only sequentially from
+/// the beginning of the vector. Default constructed T has to have the same delta base as the empty vector
 template <typename T>
 class packed_vector {
 public:
@@ -17,7 +22,7 @@ public:
 	typedef const T& const_reference;
 
 	using store_container = std::vector<uint8_t>;
-	packed_vector() noexcept : size_(0) {}
+	packed_vector() noexcept : size_(0), lastBase_(T().DeltaBase()) {}
 	class iterator {
 	public:
 		iterator(const packed_vector* pv, store_container::const_iterator it) : pv_(pv), it_(it), unpacked_(0) { unpack(); }
@@ -53,15 +58,20 @@ public:
 
 	template <typename TT>
 	void push_back(const TT& v) {
-		data_.reserve(data_.size() + v.maxpackedsize());
-		auto p = v.pack(data_.end());
-		data_.resize(p + data_.size());
+		restoreLastBase();
+		const size_type p = data_.size();
+		data_.resize(p + v.maxpackedsize());
+		data_.resize(p + v.pack(data_.data() + p, lastBase_));
+		lastBase_ = v.DeltaBase();
 		size_++;
 	}
 
 	void erase_back(size_type pos) {
+		// Values are unpacked with the wrong delta base here, but only their count is required
 		for (auto it = iterator(this, data_.begin() + pos); it != end(); ++it) size_--;
 		data_.resize(pos);
+		// Delta base for the next value is restored on demand: it requires unpacking of the whole vector
+		lastBase_ = pos ? kUnknownBase : T().DeltaBase();
 	}
 
 	size_type size() const noexcept { return size_; }
@@ -70,6 +80,7 @@ public:
 	void insert(iterator pos, InputIterator from, InputIterator to) {
 		assertrx(pos == end());
 		(void)pos;
+		restoreLastBase();
 		data_.reserve((to - from) / 2);
 		int i = 0;
 		size_type p = data_.size();
@@ -79,7 +90,8 @@ public:
 				for (auto iit = it; j < 100 && iit != to; iit++, j++) sz += iit->maxpackedsize();
 				data_.resize(p + sz);
 			}
-			p += it->pack(&*(data_.begin() + p));
+			p += it->pack(&*(data_.begin() + p), lastBase_);
+			lastBase_ = it->DeltaBase();
 			assertrx(p <= data_.size());
 		}
 		data_.resize(p);
@@ -90,12 +102,24 @@ public:
 	void clear() noexcept {
 		data_.clear();
 		size_ = 0;
+		lastBase_ = T().DeltaBase();
 	}
 	bool empty() const noexcept { return size_ == 0; }
 	size_type pos(iterator it) noexcept { return it.pos(); }
 
 protected:
+	using delta_base_type = typename T::delta_base_type;
+	// Packed values never have this delta base (e.g. it's not valid document id)
+	static constexpr delta_base_type kUnknownBase = std::numeric_limits<delta_base_type>::max();
+
+	void restoreLastBase() {
+		if (lastBase_ != kUnknownBase) return;
+		lastBase_ = T().DeltaBase();
+		for (auto it = begin(); it != end(); ++it) lastBase_ = it->DeltaBase();
+	}
+
 	store_container data_;
 	size_type size_;
+	delta_base_type lastBase_;
 };
 }  // namespace reindexer
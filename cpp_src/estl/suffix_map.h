@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <string_view>
 #include <vector>
 #include "libdivsufsort/divsufsort.h"
@@ -68,6 +70,8 @@ class suffix_map {
 	};
 
 public:
+	typedef vector<int>::const_iterator prefix_iterator;
+
 	suffix_map() {}
 	suffix_map(const suffix_map & /*other*/) = delete;
 	suffix_map &operator=(const suffix_map & /*other*/) = default;
@@ -84,6 +88,24 @@ public:
 		return {start, iterator(idx_, this)};
 	}
 
+	// Range of the words, which start with str. Iterators point to the words' positions in text.
+	// Only the words' beginnings are searched, so short prefixes don't require walk over all of the suffixes inside the words
+	std::pair<prefix_iterator, prefix_iterator> prefix_range(std::string_view str) const {
+		if (!built_) {
+			throw std::logic_error("Should call suffix_map::build before search");
+		}
+		// Words are zero terminated, so strncmp does not read beyond the word and shorter words are less than their continuations
+		auto start = std::lower_bound(sorted_words_.cbegin(), sorted_words_.cend(), str, [this](int pos, std::string_view s) {
+			return strncmp(&text_[pos], s.data(), s.length()) < 0;
+		});
+		auto finish = std::upper_bound(start, sorted_words_.cend(), str, [this](std::string_view s, int pos) {
+			return strncmp(&text_[pos], s.data(), s.length()) > 0;
+		});
+		return {start, finish};
+	}
+	const CharT *text_at(int pos) const { return &text_[pos]; }
+	const V &mapped_at(int pos) const { return mapped_[pos]; }
+
 	iterator lower_bound(std::string_view str) const {
 		if (!built_) {
 			throw std::logic_error("Should call suffix_map::build before search");
@@ -151,6 +173,7 @@ public:
 		sa_.resize(text_.size());
 		if (!sa_.empty()) ::divsufsort(reinterpret_cast<const char_type *>(text_.data()), &sa_[0], text_.size());
 		build_lcp();
+		build_sorted_words();
 		built_ = true;
 	}
 
@@ -166,6 +189,7 @@ public:
 		mapped_.clear();
 		words_.clear();
 		words_len_.clear();
+		sorted_words_.clear();
 		text_.clear();
 		built_ = false;
 	}
@@ -174,8 +198,8 @@ public:
 
 	const vector<CharT> &text() const { return text_; }
 	size_t heap_size() {
-		return (sa_.capacity() + words_.capacity()) * sizeof(int) +			  //
-			   (lcp_.capacity() + words_len_.capacity()) * sizeof(int16_t) +  //
+		return (sa_.capacity() + words_.capacity() + sorted_words_.capacity()) * sizeof(int) +	//
+			   (lcp_.capacity() + words_len_.capacity()) * sizeof(int16_t) +					//
 			   mapped_.capacity() * sizeof(V) + text_.capacity();
 	}
 
@@ -198,7 +222,16 @@ protected:
 		}
 	}
 
-	std::vector<int> sa_, words_;
+	// Suffixes, which are the words' beginnings, are the words in lexicographical order
+	void build_sorted_words() {
+		sorted_words_.clear();
+		sorted_words_.reserve(words_.size());
+		for (int pos : sa_) {
+			if (pos == 0 || text_[pos - 1] == '\0') sorted_words_.push_back(pos);
+		}
+	}
+
+	std::vector<int> sa_, words_, sorted_words_;
 	std::vector<int16_t> lcp_;
 	std::vector<std::pair<uint8_t, uint8_t>> words_len_;
 	vector<V> mapped_;
@@ -27,6 +27,15 @@ void tokenizer::skip_space() {
 }
 
 token tokenizer::next_token(bool to_lower, bool treatSignAsToken, bool inOrderBy) {
+	if (peeked_.matches(pos_, to_lower, treatSignAsToken, inOrderBy)) {
+		peeked_.valid = false;
+		setPos(peeked_.endPos);
+		return std::move(peeked_.tok);
+	}
+	return read_token(to_lower, treatSignAsToken, inOrderBy);
+}
+
+token tokenizer::read_token(bool to_lower, bool treatSignAsToken, bool inOrderBy) {
 	skip_space();
 
 	if (cur_ == q_.end()) return token(TokenEnd);
@@ -148,9 +157,17 @@ string tokenizer::where() const {
 }
 
 token tokenizer::peek_token(bool to_lower, bool treatSignAsToken, bool inOrderBy) {
+	if (peeked_.matches(pos_, to_lower, treatSignAsToken, inOrderBy)) return peeked_.tok.clone();
 	auto save_cur = cur_;
 	auto save_pos = pos_;
-	auto res = next_token(to_lower, treatSignAsToken, inOrderBy);
+	auto res = read_token(to_lower, treatSignAsToken, inOrderBy);
+	peeked_.tok = res.clone();
+	peeked_.pos = save_pos;
+	peeked_.endPos = pos_;
+	peeked_.to_lower = to_lower;
+	peeked_.treatSignAsToken = treatSignAsToken;
+	peeked_.inOrderBy = inOrderBy;
+	peeked_.valid = true;
 	cur_ = save_cur;
 	pos_ = save_pos;
 	return res;
@@ -33,6 +33,13 @@ public:
 	}
 
 	std::string_view text() const { return std::string_view(text_.data(), text_.size()); }
+	token clone() const {
+		token res(type);
+		res.text_ = text_;
+		res.text_.reserve(text_.size() + 1);
+		*(res.text_.begin() + res.text_.size()) = 0;
+		return res;
+	}
 
 	token_type type;
 	h_vector<char, 20> text_;
@@ -52,9 +59,24 @@ public:
 	const char *begin() const;
 
 protected:
+	token read_token(bool to_lower, bool treatSignAsToken, bool inOrderBy);
+
 	std::string_view q_;
 	std::string_view::const_iterator cur_;
 	size_t pos_ = 0;
+
+private:
+	// Parser peeks the most of the tokens before it takes them, so the last peeked token is not read twice
+	struct peeked {
+		token tok;
+		size_t pos = 0, endPos = 0;
+		bool to_lower = false, treatSignAsToken = false, inOrderBy = false;
+		bool valid = false;
+		bool matches(size_t p, bool l, bool s, bool o) const noexcept {
+			return valid && pos == p && to_lower == l && treatSignAsToken == s && inOrderBy == o;
+		}
+	};
+	peeked peeked_;
 };
 
 Variant token2kv(const token &currTok, tokenizer &parser, bool allowComposite);
@@ -0,0 +1,45 @@
+#include <iostream>
+#include "args/args.hpp"
+#include "item_codecs.h"
+
+int main(int argc, char **argv) {
+	unsigned docsCount = 1000;
+
+	// Own flags are parsed after the benchmark library has removed its flags from the arguments
+	::benchmark::Initialize(&argc, argv);
+	args::ArgumentParser parser("Reindexer item codecs benchmark. Measures JSON, CJSON, MsgPack and Protobuf encoders and decoders",
+								"Benchmark library flags (--benchmark_filter, --benchmark_out, --benchmark_out_format=json, etc) are also "
+								"accepted");
+	args::HelpFlag help(parser, "help", "show this message", {'h', "help"});
+	args::Group options("options");
+	args::ValueFlag<unsigned> docsF(options, "N", "Number of the distinct documents of each shape", {"docs"}, docsCount,
+									args::Options::Single);
+	args::GlobalOptions globals(parser, options);
+
+	try {
+		parser.ParseCLI(argc, argv);
+	} catch (const args::Help &) {
+		std::cout << parser;
+		return 0;
+	} catch (const args::Error &e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		std::cout << parser.Help() << std::endl;
+		return 2;
+	}
+	docsCount = std::max(1u, args::get(docsF));
+
+	// Namespaces are in memory only
+	reindexer::Reindexer db;
+	std::vector<std::unique_ptr<ItemCodecs>> fixtures;
+	for (auto shape : {ItemCodecs::Shape::Flat, ItemCodecs::Shape::Nested, ItemCodecs::Shape::Wide, ItemCodecs::Shape::Arrays}) {
+		fixtures.emplace_back(std::make_unique<ItemCodecs>(&db, shape, docsCount));
+		auto err = fixtures.back()->Initialize();
+		if (!err.ok()) {
+			std::cerr << "ERROR: Unable to initialize '" << ItemCodecs::ShapeName(shape) << "' documents: " << err.what() << std::endl;
+			return 1;
+		}
+		fixtures.back()->RegisterAllCases();
+	}
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
@@ -0,0 +1,362 @@
+#include "item_codecs.h"
+
+#include <functional>
+#include "allocs_tracker.h"
+#include "core/cjson/baseencoder.h"
+#include "core/cjson/cjsonbuilder.h"
+#include "core/cjson/cjsondecoder.h"
+#include "core/cjson/jsondecoder.h"
+#include "core/cjson/msgpackbuilder.h"
+#include "core/cjson/msgpackdecoder.h"
+#include "core/cjson/protobufbuilder.h"
+#include "core/cjson/protobufdecoder.h"
+#include "gason/gason.h"
+
+using reindexer::Error;
+using reindexer::JsonBuilder;
+using reindexer::WrSerializer;
+
+static constexpr int kFlatInts = 8;
+static constexpr int kFlatDoubles = 4;
+static constexpr int kFlatStrings = 6;
+static constexpr int kFlatBools = 2;
+static constexpr int kNestedDepth = 8;
+static constexpr int kWideFields = 200;
+
+static std::vector<CodecField> shapeFields(ItemCodecs::Shape shape) {
+	using Type = CodecField::Type;
+	std::vector<CodecField> fields;
+	switch (shape) {
+		case ItemCodecs::Shape::Flat:
+			for (int i = 0; i < kFlatInts; ++i) fields.push_back({"int_" + std::to_string(i), Type::Int});
+			for (int i = 0; i < kFlatDoubles; ++i) fields.push_back({"double_" + std::to_string(i), Type::Double});
+			for (int i = 0; i < kFlatStrings; ++i) fields.push_back({"string_" + std::to_string(i), Type::String});
+			for (int i = 0; i < kFlatBools; ++i) fields.push_back({"bool_" + std::to_string(i), Type::Bool});
+			break;
+		case ItemCodecs::Shape::Nested: {
+			// Chain of the objects with a few scalar fields on each level
+			std::vector<CodecField> level;
+			for (int depth = 0; depth < kNestedDepth; ++depth) {
+				std::vector<CodecField> obj{{"n", Type::Int}, {"s", Type::String}, {"d", Type::Double}};
+				if (!level.empty()) obj.push_back({"child", Type::Object, 0, std::move(level)});
+				level = std::move(obj);
+			}
+			fields.push_back({"name", Type::String});
+			fields.push_back({"root", Type::Object, 0, std::move(level)});
+			break;
+		}
+		case ItemCodecs::Shape::Wide: {
+			static const Type types[] = {Type::Int, Type::String, Type::Double, Type::Bool};
+			for (int i = 0; i < kWideFields; ++i) fields.push_back({"field_" + std::to_string(i), types[i % 4]});
+			break;
+		}
+		case ItemCodecs::Shape::Arrays:
+			fields.push_back({"ints", Type::IntArray, 100});
+			fields.push_back({"scores", Type::IntArray, 50});
+			fields.push_back({"tags", Type::StringArray, 30});
+			fields.push_back({"points", Type::ObjectArray, 20, {{"x", Type::Int}, {"y", Type::Double}, {"label", Type::String}}});
+			break;
+	}
+	return fields;
+}
+
+ItemCodecs::ItemCodecs(reindexer::Reindexer *db, Shape shape, unsigned docsCount)
+	: db_(db), shape_(shape), docsCount_(docsCount), nsName_("codecs_" + std::string(ShapeName(shape))), fields_(shapeFields(shape)) {}
+
+std::string_view ItemCodecs::ShapeName(Shape shape) noexcept {
+	switch (shape) {
+		case Shape::Flat:
+			return "flat";
+		case Shape::Nested:
+			return "nested";
+		case Shape::Wide:
+			return "wide";
+		case Shape::Arrays:
+			return "arrays";
+	}
+	return "";
+}
+
+std::string_view ItemCodecs::FormatName(Format format) noexcept {
+	switch (format) {
+		case Format::JSON:
+			return "JSON";
+		case Format::CJSON:
+			return "CJSON";
+		case Format::MsgPack:
+			return "MsgPack";
+		case Format::Protobuf:
+			return "Protobuf";
+	}
+	return "";
+}
+
+Error ItemCodecs::Initialize() {
+	reindexer::NamespaceDef nsdef(nsName_);
+	nsdef.AddIndex("id", "hash", "int", IndexOpts().PK());
+	auto err = db_->AddNamespace(nsdef);
+	if (!err.ok()) return err;
+
+	// Protobuf codecs require the schema
+	WrSerializer ser;
+	{
+		JsonBuilder schema(ser);
+		schema.Put("type", "object");
+		schema.Array("required", {"id"});
+		auto props = schema.Object("properties");
+		props.Object("id").Put("type", "integer");
+		putSchema(props, fields_);
+	}
+	err = db_->SetSchema(nsName_, ser.Slice());
+	if (!err.ok()) return err;
+
+	for (unsigned i = 0; i < docsCount_; ++i) {
+		ser.Reset();
+		putDocument(ser, int(i));
+		auto item = db_->NewItem(nsName_);
+		if (!item.Status().ok()) return item.Status();
+		err = item.FromJSON(ser.Slice());
+		if (!err.ok()) return err;
+		err = db_->Upsert(nsName_, item);
+		if (!err.ok()) return err;
+	}
+	err = db_->Commit(nsName_);
+	if (!err.ok()) return err;
+
+	reindexer::QueryResults qr;
+	err = db_->Select(reindexer::Query(nsName_), qr);
+	if (!err.ok()) return err;
+	if (qr.Count() != docsCount_) return Error(errLogic, "Unexpected count of the items in '%s': %d", nsName_, qr.Count());
+	payloadType_ = qr.getPayloadType(0);
+	tagsMatcher_ = qr.getTagsMatcher(0);
+	schema_ = qr.getSchema(0);
+	values_.clear();
+	for (auto &itemRef : qr.Items()) values_.emplace_back(itemRef.Value());
+	msgPackDecoder_ = std::make_unique<reindexer::MsgPackDecoder>(&tagsMatcher_);
+
+	encoded_.assign(kFormatsCount, {});
+	for (int f = 0; f < kFormatsCount; ++f) {
+		encoded_[f].reserve(values_.size());
+		for (auto &pv : values_) {
+			ser.Reset();
+			err = encode(Format(f), pv, ser);
+			if (!err.ok()) return err;
+			encoded_[f].emplace_back(ser.Slice());
+		}
+	}
+	return Error();
+}
+
+void ItemCodecs::RegisterAllCases() {
+	using std::placeholders::_1;
+	for (int f = 0; f < kFormatsCount; ++f) {
+		const std::string suffix = "/" + std::string(FormatName(Format(f))) + "/" + std::string(ShapeName(shape_));
+		benchmark::RegisterBenchmark(("Decode" + suffix).c_str(), std::bind(&ItemCodecs::Decode, this, _1, Format(f)));
+		benchmark::RegisterBenchmark(("Encode" + suffix).c_str(), std::bind(&ItemCodecs::Encode, this, _1, Format(f)));
+	}
+}
+
+void ItemCodecs::Decode(State &state, Format format) {
+	const auto &docs = encoded_[int(format)];
+	reindexer::PayloadValue pv(payloadType_.TotalSize());
+	reindexer::Payload pl(payloadType_, pv);
+	WrSerializer ser;
+	size_t bytes = 0, i = 0;
+	benchmark::AllocsTracker allocsTracker(state);
+	for (auto _ : state) {
+		const std::string &doc = docs[i++ % docs.size()];
+		auto err = decode(format, doc, pl, ser);
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			return;
+		}
+		bytes += doc.size();
+	}
+	state.SetItemsProcessed(int64_t(state.iterations()));
+	state.SetBytesProcessed(int64_t(bytes));
+}
+
+void ItemCodecs::Encode(State &state, Format format) {
+	WrSerializer ser;
+	size_t bytes = 0, i = 0;
+	benchmark::AllocsTracker allocsTracker(state);
+	for (auto _ : state) {
+		ser.Reset();
+		auto err = encode(format, values_[i++ % values_.size()], ser);
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			return;
+		}
+		bytes += ser.Len();
+	}
+	state.SetItemsProcessed(int64_t(state.iterations()));
+	state.SetBytesProcessed(int64_t(bytes));
+}
+
+// Same calls as in ItemImpl::GetJSON, GetCJSON, GetMsgPack and GetProtobuf
+Error ItemCodecs::encode(Format format, const reindexer::PayloadValue &pv, WrSerializer &ser) {
+	reindexer::ConstPayload pl(payloadType_, pv);
+	try {
+		switch (format) {
+			case Format::JSON: {
+				reindexer::JsonEncoder encoder(&tagsMatcher_);
+				JsonBuilder builder(ser, ObjType::TypePlain);
+				encoder.Encode(&pl, builder);
+				break;
+			}
+			case Format::CJSON: {
+				reindexer::CJsonEncoder encoder(&tagsMatcher_);
+				reindexer::CJsonBuilder builder(ser, ObjType::TypePlain);
+				encoder.Encode(&pl, builder);
+				break;
+			}
+			case Format::MsgPack: {
+				int startTag = 0;
+				reindexer::MsgPackEncoder encoder(&tagsMatcher_);
+				const reindexer::TagsLengths &tagsLengths = encoder.GetTagsMeasures(&pl);
+				reindexer::MsgPackBuilder builder(ser, &tagsLengths, &startTag, ObjType::TypePlain, &tagsMatcher_);
+				encoder.Encode(&pl, builder);
+				break;
+			}
+			case Format::Protobuf: {
+				reindexer::ProtobufBuilder builder(&ser, ObjType::TypePlain, schema_.get(), &tagsMatcher_);
+				reindexer::ProtobufEncoder encoder(&tagsMatcher_);
+				encoder.Encode(&pl, builder);
+				break;
+			}
+		}
+	} catch (const Error &err) {
+		return err;
+	}
+	return Error();
+}
+
+// Same calls as in ItemImpl::FromJSON, FromCJSON, FromMsgPack and FromProtobuf
+Error ItemCodecs::decode(Format format, std::string_view data, reindexer::Payload &pl, WrSerializer &ser) {
+	ser.Reset();
+	ser.PutUInt32(0);
+	try {
+		switch (format) {
+			case Format::JSON: {
+				jsonBuf_.assign(data.data(), data.size());
+				gason::JsonValue value;
+				gason::JsonAllocator allocator;
+				char *endptr = nullptr;
+				int status = jsonParse(reindexer::span<char>(&jsonBuf_[0], jsonBuf_.size()), &endptr, &value, allocator);
+				if (status != gason::JSON_OK) return Error(errParseJson, "Error parsing json: '%s'", gason::jsonStrError(status));
+				reindexer::JsonDecoder decoder(tagsMatcher_);
+				return decoder.Decode(&pl, ser, value);
+			}
+			case Format::CJSON: {
+				reindexer::Serializer rdser(data);
+				reindexer::CJsonDecoder decoder(tagsMatcher_);
+				return decoder.Decode(&pl, rdser, ser);
+			}
+			case Format::MsgPack: {
+				size_t offset = 0;
+				return msgPackDecoder_->Decode(data, &pl, ser, offset);
+			}
+			case Format::Protobuf: {
+				reindexer::ProtobufDecoder decoder(tagsMatcher_, schema_);
+				return decoder.Decode(data, &pl, ser);
+			}
+		}
+	} catch (const Error &err) {
+		return err;
+	}
+	return Error();
+}
+
+void ItemCodecs::putDocument(WrSerializer &ser, int id) {
+	JsonBuilder builder(ser);
+	builder.Put("id", id);
+	putFields(builder, fields_);
+}
+
+void ItemCodecs::putFields(JsonBuilder &builder, const std::vector<CodecField> &fields) {
+	auto randString = [this] {
+		std::string s(8 + rnd_() % 17, ' ');
+		for (auto &c : s) c = char('a' + rnd_() % 26);
+		return s;
+	};
+	for (const auto &f : fields) {
+		switch (f.type) {
+			case CodecField::Type::Int:
+				builder.Put(f.name, int(rnd_() % 100000));
+				break;
+			case CodecField::Type::Double:
+				builder.Put(f.name, double(rnd_() % 1000000) / 100);
+				break;
+			case CodecField::Type::String:
+				builder.Put(f.name, std::string_view(randString()));
+				break;
+			case CodecField::Type::Bool:
+				builder.Put(f.name, bool(rnd_() & 1));
+				break;
+			case CodecField::Type::Object: {
+				auto obj = builder.Object(f.name);
+				putFields(obj, f.fields);
+				break;
+			}
+			case CodecField::Type::IntArray: {
+				auto arr = builder.Array(f.name);
+				for (unsigned i = 0; i < f.count; ++i) arr.Put({}, int(rnd_() % 100000));
+				break;
+			}
+			case CodecField::Type::StringArray: {
+				auto arr = builder.Array(f.name);
+				for (unsigned i = 0; i < f.count; ++i) arr.Put({}, std::string_view(randString()));
+				break;
+			}
+			case CodecField::Type::ObjectArray: {
+				auto arr = builder.Array(f.name);
+				for (unsigned i = 0; i < f.count; ++i) {
+					auto obj = arr.Object(nullptr);
+					putFields(obj, f.fields);
+				}
+				break;
+			}
+		}
+	}
+}
+
+void ItemCodecs::putSchema(JsonBuilder &builder, const std::vector<CodecField> &fields) {
+	auto putObject = [](JsonBuilder &obj, const std::vector<CodecField> &objFields) {
+		obj.Put("type", "object");
+		obj.Put("additionalProperties", false);
+		auto props = obj.Object("properties");
+		putSchema(props, objFields);
+	};
+	for (const auto &f : fields) {
+		auto node = builder.Object(f.name);
+		switch (f.type) {
+			case CodecField::Type::Int:
+				node.Put("type", "integer");
+				break;
+			case CodecField::Type::Double:
+				node.Put("type", "number");
+				break;
+			case CodecField::Type::String:
+				node.Put("type", "string");
+				break;
+			case CodecField::Type::Bool:
+				node.Put("type", "boolean");
+				break;
+			case CodecField::Type::Object:
+				putObject(node, f.fields);
+				break;
+			case CodecField::Type::IntArray:
+			case CodecField::Type::StringArray: {
+				node.Put("type", "array");
+				node.Object("items").Put("type", f.type == CodecField::Type::IntArray ? "integer" : "string");
+				break;
+			}
+			case CodecField::Type::ObjectArray: {
+				node.Put("type", "array");
+				auto items = node.Object("items");
+				putObject(items, f.fields);
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "core/cjson/jsonbuilder.h"
+#include "core/cjson/msgpackdecoder.h"
+#include "core/payload/payloadiface.h"
+#include "core/reindexer.h"
+
+/// Field of the generated documents
+struct CodecField {
+	enum class Type { Int, Double, String, Bool, Object, IntArray, StringArray, ObjectArray };
+
+	CodecField(std::string _name, Type _type, unsigned _count = 0, std::vector<CodecField> _fields = {})
+		: name(std::move(_name)), type(_type), count(_count), fields(std::move(_fields)) {}
+
+	std::string name;
+	Type type;
+	// Count of the array's elements
+	unsigned count;
+	// Fields of the object or of the array's objects
+	std::vector<CodecField> fields;
+};
+
+/// Encoders and decoders of the items (JSON, CJSON, MsgPack, Protobuf) on the documents of one shape. Codecs are called directly on the
+/// payloads of the namespace, so the measured time and allocations don't include the item's and the namespace's overhead
+class ItemCodecs {
+public:
+	enum class Shape { Flat, Nested, Wide, Arrays };
+	enum class Format { JSON, CJSON, MsgPack, Protobuf };
+	static constexpr int kFormatsCount = 4;
+
+	ItemCodecs(reindexer::Reindexer *db, Shape shape, unsigned docsCount);
+
+	reindexer::Error Initialize();
+	void RegisterAllCases();
+
+	static std::string_view ShapeName(Shape shape) noexcept;
+	static std::string_view FormatName(Format format) noexcept;
+
+private:
+	using State = benchmark::State;
+
+	void Decode(State &state, Format format);
+	void Encode(State &state, Format format);
+
+	reindexer::Error encode(Format format, const reindexer::PayloadValue &pv, reindexer::WrSerializer &ser);
+	reindexer::Error decode(Format format, std::string_view data, reindexer::Payload &pl, reindexer::WrSerializer &ser);
+	void putDocument(reindexer::WrSerializer &ser, int id);
+	void putFields(reindexer::JsonBuilder &builder, const std::vector<CodecField> &fields);
+	static void putSchema(reindexer::JsonBuilder &builder, const std::vector<CodecField> &fields);
+
+	reindexer::Reindexer *db_;
+	Shape shape_;
+	unsigned docsCount_;
+	std::string nsName_;
+	std::vector<CodecField> fields_;
+	std::mt19937 rnd_;
+
+	// Namespace's state, which is captured after the filling
+	reindexer::PayloadType payloadType_;
+	reindexer::TagsMatcher tagsMatcher_;
+	std::shared_ptr<const reindexer::Schema> schema_;
+	std::vector<reindexer::PayloadValue> values_;
+	// Decoder is reused by the item too
+	std::unique_ptr<reindexer::MsgPackDecoder> msgPackDecoder_;
+	// Documents encoded in each format
+	std::vector<std::vector<std::string>> encoded_;
+	// JSON is parsed in place, so it's decoded from the copy
+	std::string jsonBuf_;
+};
@@ -24,6 +24,8 @@ void Aggregation::RegisterAllCases() {
 	Register("Facet", &Aggregation::Facet, this);
 	Register("MultiFacet", &Aggregation::MultiFacet, this);
 	Register("ArrayFacet", &Aggregation::ArrayFacet, this);
+	Register("Distinct", &Aggregation::Distinct, this);
+	Register("SortedMultiFacet", &Aggregation::SortedMultiFacet, this);
 }
 
 Error Aggregation::Initialize() {
@@ -85,3 +87,25 @@ void Aggregation::ArrayFacet(benchmark::State& state) {
 		if (!err.ok()) state.SkipWithError(err.what().c_str());
 	}
 }
+
+void Aggregation::Distinct(benchmark::State& state) {
+	benchmark::AllocsTracker allocsTracker(state);
+	for (auto _ : state) {
+		reindexer::Query q(nsdef_.name);
+		q.Aggregate(AggDistinct, {"str_data"});
+		reindexer::QueryResults qres;
+		auto err = db_->Select(q, qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+}
+
+void Aggregation::SortedMultiFacet(benchmark::State& state) {
+	benchmark::AllocsTracker allocsTracker(state);
+	for (auto _ : state) {
+		reindexer::Query q(nsdef_.name);
+		q.Aggregate(AggFacet, {"int_data", "str_data"}, {{"count", true}}, 100);
+		reindexer::QueryResults qres;
+		auto err = db_->Select(q, qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+}
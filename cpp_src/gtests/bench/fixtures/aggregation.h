@@ -26,6 +26,8 @@ protected:
 	void Facet(State&);
 	void ArrayFacet(State&);
 	void MultiFacet(State&);
+	void Distinct(State&);
+	void SortedMultiFacet(State&);
 
 private:
 	reindexer::WrSerializer wrSer_;
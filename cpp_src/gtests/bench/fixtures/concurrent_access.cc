@@ -0,0 +1,129 @@
+#include "concurrent_access.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "core/cjson/jsonbuilder.h"
+
+static constexpr int kGenresCount = 50;
+static constexpr int kYearsFrom = 1900;
+static constexpr int kYearsCount = 120;
+static constexpr int kTxSize = 10;
+
+Error ConcurrentAccess::Initialize() {
+	assert(db_);
+	return db_->AddNamespace(nsdef_);
+}
+
+Benchmark* ConcurrentAccess::registerScaling(const string& name, void (ConcurrentAccess::*fn)(State&)) {
+	const int maxThreads = std::clamp(int(std::thread::hardware_concurrency()), 1, 32);
+	return Register(name, fn, this)->ThreadRange(1, maxThreads)->UseRealTime();
+}
+
+void ConcurrentAccess::RegisterAllCases() {
+	Register("Insert" + std::to_string(id_seq_->Count()), &ConcurrentAccess::Insert, this)->Iterations(1);
+	registerScaling("Select", &ConcurrentAccess::Select);
+	registerScaling("SelectWithWriter", &ConcurrentAccess::SelectWithWriter);
+	registerScaling("CachedSelect", &ConcurrentAccess::CachedSelect);
+	registerScaling("Transactions", &ConcurrentAccess::Transactions);
+}
+
+Error ConcurrentAccess::fillItem(Item& item, int id, std::mt19937& rnd, reindexer::WrSerializer& ser) {
+	if (!item.Status().ok()) return item.Status();
+	ser.Reset();
+	{
+		reindexer::JsonBuilder bld(ser);
+		bld.Put("id", id);
+		bld.Put("year", kYearsFrom + int(rnd() % kYearsCount));
+		bld.Put("genre", int(rnd() % kGenresCount));
+		bld.Put("name", "name" + std::to_string(rnd() % 10000));
+	}
+	return item.FromJSON(ser.Slice());
+}
+
+Item ConcurrentAccess::MakeItem() {
+	Item item = db_->NewItem(nsdef_.name);
+	fillItem(item, id_seq_->Next(), rnd_, wrSer_);
+	return item;
+}
+
+void ConcurrentAccess::Insert(State& state) {
+	for (auto _ : state) {
+		for (int i = 0; i < id_seq_->Count(); ++i) {
+			Item item = MakeItem();
+			if (!item.Status().ok()) state.SkipWithError(item.Status().what().c_str());
+
+			auto err = db_->Upsert(nsdef_.name, item);
+			if (!err.ok()) state.SkipWithError(err.what().c_str());
+		}
+	}
+
+	auto err = db_->Commit(nsdef_.name);
+	if (!err.ok()) state.SkipWithError(err.what().c_str());
+	WaitForOptimization();
+}
+
+void ConcurrentAccess::Select(State& state) {
+	std::mt19937 rnd(state.thread_index());
+	for (auto _ : state) {
+		const int year = kYearsFrom + int(rnd() % kYearsCount);
+		reindexer::QueryResults qres;
+		auto err = db_->Select(reindexer::Query(nsdef_.name).Where("year", CondRange, {year, year + 10}).Limit(20), qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void ConcurrentAccess::SelectWithWriter(State& state) {
+	// Writer is the additional thread, which is started by the first reader, so the readers count is the same as for the Select case
+	std::atomic<bool> stop{false};
+	std::atomic<int64_t> writes{0};
+	std::thread writer;
+	if (state.thread_index() == 0) {
+		writer = std::thread([this, &stop, &writes] {
+			std::mt19937 rnd(kYearsCount);
+			reindexer::WrSerializer ser;
+			while (!stop.load(std::memory_order_relaxed)) {
+				Item item = db_->NewItem(nsdef_.name);
+				if (!fillItem(item, int(rnd() % id_seq_->Count()) + 1, rnd, ser).ok() || !db_->Upsert(nsdef_.name, item).ok()) break;
+				writes.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+	Select(state);
+	if (state.thread_index() == 0) {
+		stop = true;
+		writer.join();
+		state.counters["writes_per_second"] = benchmark::Counter(double(writes.load()), benchmark::Counter::kIsRate);
+	}
+}
+
+void ConcurrentAccess::CachedSelect(State& state) {
+	// All the threads run the same query, so its idset and total count are taken from the caches after the first hits
+	const reindexer::Query q = reindexer::Query(nsdef_.name).Where("genre", CondSet, {1, 3, 5, 7, 9, 11}).ReqTotal().Limit(20);
+	for (auto _ : state) {
+		reindexer::QueryResults qres;
+		auto err = db_->Select(q, qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void ConcurrentAccess::Transactions(State& state) {
+	std::mt19937 rnd(state.thread_index());
+	reindexer::WrSerializer ser;
+	for (auto _ : state) {
+		auto tx = db_->NewTransaction(nsdef_.name);
+		if (!tx.Status().ok()) state.SkipWithError(tx.Status().what().c_str());
+		for (int i = 0; i < kTxSize; ++i) {
+			Item item = tx.NewItem();
+			auto err = fillItem(item, int(rnd() % id_seq_->Count()) + 1, rnd, ser);
+			if (!err.ok()) state.SkipWithError(err.what().c_str());
+			tx.Upsert(std::move(item));
+		}
+		reindexer::QueryResults qres;
+		auto err = db_->CommitTransaction(tx, qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
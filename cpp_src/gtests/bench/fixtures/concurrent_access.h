@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+
+#include "base_fixture.h"
+
+/// Cases, which are executed by the growing number of threads to show the scaling of the namespace locks and caches. Throughput of each
+/// case is reported as items_per_second for each threads count
+class ConcurrentAccess : protected BaseFixture {
+public:
+	~ConcurrentAccess() override = default;
+	ConcurrentAccess(Reindexer* db, const string& name, size_t maxItems) : BaseFixture(db, name, maxItems) {
+		nsdef_.AddIndex("id", "hash", "int", IndexOpts().PK());
+		nsdef_.AddIndex("year", "tree", "int", IndexOpts());
+		nsdef_.AddIndex("genre", "hash", "int", IndexOpts());
+		nsdef_.AddIndex("name", "hash", "string", IndexOpts());
+	}
+
+	void RegisterAllCases() override;
+	Error Initialize() override;
+
+protected:
+	Item MakeItem() override;
+
+	void Insert(State& state);
+	void Select(State& state);
+	void SelectWithWriter(State& state);
+	void CachedSelect(State& state);
+	void Transactions(State& state);
+
+private:
+	Error fillItem(Item& item, int id, std::mt19937& rnd, reindexer::WrSerializer& ser);
+	Benchmark* registerScaling(const string& name, void (ConcurrentAccess::*fn)(State&));
+
+	reindexer::WrSerializer wrSer_;
+	std::mt19937 rnd_;
+};
@@ -0,0 +1,256 @@
+#include "ft_scale.h"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+#include "core/ft/config/ftfastconfig.h"
+#include "tools/stringstools.h"
+
+using benchmark::State;
+using benchmark::AllocsTracker;
+
+using reindexer::Query;
+using reindexer::QueryResults;
+
+constexpr size_t kSampleDocsPeriod = 1000;
+constexpr size_t kMaxSampleDocs = 1000;
+constexpr size_t kSynonymsCount = 100;
+constexpr unsigned kQueryLimit = 20;
+#if defined(REINDEX_WITH_ASAN) || defined(REINDEX_WITH_TSAN)
+constexpr int kQueriesIterations = 20;
+constexpr int kCommitIterations = 5;
+#else
+constexpr int kQueriesIterations = 500;
+constexpr int kCommitIterations = 20;
+#endif
+
+FullTextScale::FullTextScale(Reindexer* db, const string& name, size_t maxItems)
+	: BaseFixture(db, name, maxItems), descriptionLen_(3.4, 0.6), rng_(maxItems) {}
+
+reindexer::Error FullTextScale::Initialize() {
+	std::ifstream file(RX_BENCH_DICT_PATH);
+	if (!file) return Error(errNotValid, "%s", strerror(errno));
+	words_.reserve(140000);
+	std::copy(std::istream_iterator<string>(file), std::istream_iterator<string>(), std::back_inserter(words_));
+	if (words_.size() < 2 * kSynonymsCount) return Error(errNotValid, "Dictionary is too small: %d words", words_.size());
+
+	// Dictionary is sorted, so the words are shuffled to make frequency independent of the alphabetical order
+	std::shuffle(words_.begin(), words_.end(), rng_);
+	std::vector<double> weights(words_.size());
+	for (size_t i = 0; i < weights.size(); ++i) weights[i] = 1.0 / double(i + 1);
+	zipf_ = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+
+	reindexer::FtFastConfig ftCfg(2);
+	ftCfg.maxStepSize = 10000;
+	// Multi field ranking prefers the matches in the title
+	ftCfg.fieldsCfg[0].positionWeight = 0.3;
+	for (size_t i = 0; i < kSynonymsCount; ++i) {
+		synonyms_.emplace_back(words_[words_.size() - 1 - i]);
+		ftCfg.synonyms.push_back({{synonyms_.back()}, {words_[i]}});
+	}
+	IndexOpts ftIndexOpts;
+	ftIndexOpts.config = ftCfg.GetJson({{"title", 0}, {"description", 1}});
+	nsdef_.AddIndex("id", "hash", "int", IndexOpts().PK())
+		.AddIndex("title", "-", "string", IndexOpts())
+		.AddIndex("description", "-", "string", IndexOpts())
+		.AddIndex("search", {"title", "description"}, "text", "composite", ftIndexOpts);
+	return BaseFixture::Initialize();
+}
+
+void FullTextScale::RegisterAllCases() {
+	Register("Insert", &FullTextScale::Insert, this)->Iterations(1)->Unit(benchmark::kMillisecond);
+	Register("Build", &FullTextScale::Build, this)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+	Register("SingleWordMatch", &FullTextScale::SingleWordMatch, this)->Iterations(kQueriesIterations)->Unit(benchmark::kMicrosecond);
+	Register("PhraseMatch", &FullTextScale::PhraseMatch, this)->Iterations(kQueriesIterations)->Unit(benchmark::kMicrosecond);
+	Register("PrefixMatch", &FullTextScale::PrefixMatch, this)->Iterations(kQueriesIterations)->Unit(benchmark::kMicrosecond);
+	Register("TypoMatch", &FullTextScale::TypoMatch, this)->Iterations(kQueriesIterations)->Unit(benchmark::kMicrosecond);
+	Register("SynonymMatch", &FullTextScale::SynonymMatch, this)->Iterations(kQueriesIterations)->Unit(benchmark::kMicrosecond);
+	Register("MultiFieldRankedMatch", &FullTextScale::MultiFieldRankedMatch, this)
+		->Iterations(kQueriesIterations)
+		->Unit(benchmark::kMicrosecond);
+
+	// Argument is the count of the documents, inserted before each commit
+	Register("IncrementalCommit", &FullTextScale::IncrementalCommit, this)
+		->Arg(100)
+		->Arg(5000)
+		->Iterations(kCommitIterations)
+		->Unit(benchmark::kMillisecond);
+	Register("DropNamespace", &FullTextScale::DropNamespace, this)->Iterations(1)->Unit(benchmark::kMillisecond);
+}
+
+reindexer::Item FullTextScale::MakeItem() {
+	auto item = db_->NewItem(nsdef_.name);
+	item.Unsafe(false);
+
+	const int id = nextId_++;
+	const auto title = makeWords(std::uniform_int_distribution<size_t>(2, 8)(rng_));
+	const auto description = makeWords(std::clamp<size_t>(size_t(descriptionLen_(rng_)), 5, 300));
+	if (size_t(id) % kSampleDocsPeriod == 0 && phrases_.size() < kMaxSampleDocs) {
+		// Phrase of the sample document is the few consequent words of its description
+		const size_t pos = std::uniform_int_distribution<size_t>(0, description.size() - 3)(rng_);
+		phrases_.emplace_back(*description[pos] + ' ' + *description[pos + 1] + ' ' + *description[pos + 2]);
+		titleWords_.emplace_back(*title[0]);
+	}
+
+	item["id"] = id;
+	item["title"] = join(title);
+	item["description"] = join(description);
+	return item;
+}
+
+void FullTextScale::Insert(State& state) {
+	for (auto _ : state) {
+		for (int i = 0; i < id_seq_->Count(); ++i) {
+			auto item = MakeItem();
+			if (!item.Status().ok()) state.SkipWithError(item.Status().what().c_str());
+
+			auto err = db_->Insert(nsdef_.name, item);
+			if (!err.ok()) state.SkipWithError(err.what().c_str());
+		}
+	}
+	state.SetItemsProcessed(id_seq_->Count());
+	setMemoryCounters(state);
+}
+
+void FullTextScale::Build(State& state) {
+	for (auto _ : state) {
+		// Index is built by the first select
+		QueryResults qres;
+		auto err = db_->Select(Query(nsdef_.name).Where("search", CondEq, zipfWord()).Limit(kQueryLimit), qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+	setMemoryCounters(state);
+}
+
+void FullTextScale::IncrementalCommit(State& state) {
+	using std::chrono::duration;
+	using std::chrono::steady_clock;
+	const size_t batchSize = state.range(0);
+	std::vector<double> latencies;
+	latencies.reserve(state.max_iterations);
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (size_t i = 0; i < batchSize; ++i) {
+			auto item = MakeItem();
+			if (!item.Status().ok()) state.SkipWithError(item.Status().what().c_str());
+			auto err = db_->Insert(nsdef_.name, item);
+			if (!err.ok()) state.SkipWithError(err.what().c_str());
+		}
+		state.ResumeTiming();
+
+		// Updated documents are committed to the index by the select
+		const auto start = steady_clock::now();
+		QueryResults qres;
+		auto err = db_->Select(Query(nsdef_.name).Where("search", CondEq, zipfWord()).Limit(kQueryLimit), qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+		latencies.push_back(duration<double, std::micro>(steady_clock::now() - start).count());
+	}
+	setLatencyCounters(state, latencies);
+	setMemoryCounters(state);
+}
+
+void FullTextScale::DropNamespace(State& state) {
+	for (auto _ : state) {
+		// Corpus is released before the benchmarks of the next scale. Empty namespace is left to be closed by the fixture
+		auto err = db_->DropNamespace(nsdef_.name);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+		err = BaseFixture::Initialize();
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+}
+
+void FullTextScale::SingleWordMatch(State& state) {
+	selectLatency(state, [this] { return zipfWord(); });
+}
+
+void FullTextScale::PhraseMatch(State& state) {
+	selectLatency(state, [this] { return '"' + phrases_[std::uniform_int_distribution<size_t>(0, phrases_.size() - 1)(rng_)] + '"'; });
+}
+
+void FullTextScale::PrefixMatch(State& state) {
+	selectLatency(state, [this] {
+		auto word = reindexer::utf8_to_utf16(zipfWord());
+		word.resize(std::min<size_t>(word.size(), std::uniform_int_distribution<size_t>(3, 5)(rng_)));
+		return reindexer::utf16_to_utf8(word) + '*';
+	});
+}
+
+void FullTextScale::TypoMatch(State& state) {
+	selectLatency(state, [this] {
+		auto word = reindexer::utf8_to_utf16(zipfWord());
+		// Typo is made by the replacement of the symbol by the next one
+		++word[std::uniform_int_distribution<size_t>(0, word.size() - 1)(rng_)];
+		return reindexer::utf16_to_utf8(word) + '~';
+	});
+}
+
+void FullTextScale::SynonymMatch(State& state) {
+	selectLatency(state, [this] { return synonyms_[std::uniform_int_distribution<size_t>(0, synonyms_.size() - 1)(rng_)]; });
+}
+
+void FullTextScale::MultiFieldRankedMatch(State& state) {
+	selectLatency(state, [this] {
+		const size_t doc = std::uniform_int_distribution<size_t>(0, titleWords_.size() - 1)(rng_);
+		return "@title^3,description " + titleWords_[doc] + ' ' + zipfWord();
+	});
+}
+
+const string& FullTextScale::zipfWord() { return words_[zipf_(rng_)]; }
+
+vector<const string*> FullTextScale::makeWords(size_t wordsCount) {
+	vector<const string*> res;
+	res.reserve(wordsCount);
+	for (size_t i = 0; i < wordsCount; ++i) res.push_back(&zipfWord());
+	return res;
+}
+
+string FullTextScale::join(const vector<const string*>& words) {
+	string res;
+	for (const string* w : words) {
+		if (!res.empty()) res += ' ';
+		res += *w;
+	}
+	return res;
+}
+
+void FullTextScale::selectLatency(State& state, const std::function<string()>& makeDsl) {
+	using std::chrono::duration;
+	using std::chrono::steady_clock;
+	if (phrases_.empty()) {
+		state.SkipWithError("Namespace is empty");
+		return;
+	}
+	AllocsTracker allocsTracker(state);
+	std::vector<double> latencies;
+	latencies.reserve(state.max_iterations);
+	size_t cnt = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		Query q = Query(nsdef_.name).Where("search", CondEq, makeDsl()).Limit(kQueryLimit);
+		state.ResumeTiming();
+
+		const auto start = steady_clock::now();
+		QueryResults qres;
+		auto err = db_->Select(q, qres);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+		latencies.push_back(duration<double, std::micro>(steady_clock::now() - start).count());
+		cnt += qres.Count();
+	}
+	setLatencyCounters(state, latencies);
+	setMemoryCounters(state);
+	state.SetLabel(FormatString("RPR: %.1f", cnt / double(state.iterations())));
+}
+
+void FullTextScale::setLatencyCounters(State& state, std::vector<double>& latencies) {
+	if (latencies.empty()) return;
+	std::sort(latencies.begin(), latencies.end());
+	const auto percentile = [&latencies](double p) { return latencies[std::min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+	state.counters["p50,us"] = percentile(0.5);
+	state.counters["p99,us"] = percentile(0.99);
+}
+
+void FullTextScale::setMemoryCounters(State& state) { state.counters["PeakRSS"] = GetPeakRSS(); }
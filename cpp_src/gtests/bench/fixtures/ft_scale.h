@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base_fixture.h"
+
+/// Fulltext benchmarks on the generated corpus of the configurable size.
+/// Words frequencies of the corpus follow Zipf's law and documents lengths are log-normally distributed, like in the real texts.
+/// Queries latencies are reported as percentiles, so the tails are visible
+class FullTextScale : protected BaseFixture {
+public:
+	virtual ~FullTextScale() {}
+	FullTextScale(Reindexer* db, const string& name, size_t maxItems);
+
+	virtual Error Initialize();
+	virtual void RegisterAllCases();
+
+protected:
+	virtual Item MakeItem();
+
+protected:
+	void Insert(State& state);
+	void Build(State& state);
+	void IncrementalCommit(State& state);
+	void DropNamespace(State& state);
+
+	void SingleWordMatch(State& state);
+	void PhraseMatch(State& state);
+	void PrefixMatch(State& state);
+	void TypoMatch(State& state);
+	void SynonymMatch(State& state);
+	void MultiFieldRankedMatch(State& state);
+
+protected:
+	const string& zipfWord();
+	vector<const string*> makeWords(size_t wordsCount);
+	static string join(const vector<const string*>& words);
+	void selectLatency(State& state, const std::function<string()>& makeDsl);
+	static void setLatencyCounters(State& state, std::vector<double>& latencies);
+	static void setMemoryCounters(State& state);
+
+protected:
+	vector<string> words_;
+	std::discrete_distribution<size_t> zipf_;
+	std::lognormal_distribution<double> descriptionLen_;
+	std::mt19937 rng_;
+	// Synonyms tokens are the rare words, which are replaced by the frequent ones
+	vector<string> synonyms_;
+	// Phrases and first title words of the sample of the inserted documents
+	vector<string> phrases_;
+	vector<string> titleWords_;
+	int nextId_ = 1;
+};
@@ -1,11 +1,15 @@
+#include <algorithm>
 #include <iostream>
+#include <memory>
 
 #include "benchmark/benchmark.h"
 #include "core/reindexer.h"
 #include "tools/fsops.h"
 #include "tools/reporter.h"
+#include "tools/stringstools.h"
 
 #include "ft_fixture.h"
+#include "ft_scale.h"
 
 const std::string kStoragePath = "/tmp/reindex/ft_bench_test";
 
@@ -14,10 +18,24 @@ using reindexer::Reindexer;
 
 #if defined(REINDEX_WITH_ASAN) || defined(REINDEX_WITH_TSAN)
 const int kItemsInBenchDataset = 1000;
+const char* const kDefaultScales = "1000";
 #else
 const int kItemsInBenchDataset = 100000;
+const char* const kDefaultScales = "100000";
 #endif
 
+// Comma separated counts of the documents for the scale benchmarks, for example RX_FT_BENCH_SCALES=1000000,10000000
+static std::vector<size_t> getScales() {
+	const char* env = getenv("RX_FT_BENCH_SCALES");
+	std::vector<std::string> tokens;
+	reindexer::split(std::string(env && *env ? env : kDefaultScales), ",", true, tokens);
+	std::vector<size_t> scales;
+	for (auto& t : tokens) scales.push_back(std::stoull(t));
+	// Peak RSS is not decreased, so the smaller corpora are benchmarked first
+	std::sort(scales.begin(), scales.end());
+	return scales;
+}
+
 int main(int argc, char** argv) {
 	if (reindexer::fs::RmDirAll(kStoragePath) < 0 && errno != ENOENT) {
 		std::cerr << "Could not clean working dir '" << kStoragePath << "'.";
@@ -34,11 +52,20 @@ int main(int argc, char** argv) {
 	auto err = ft.Initialize();
 	if (!err.ok()) return err.code();
 
+	std::vector<std::unique_ptr<FullTextScale>> scaleFixtures;
+	for (size_t scale : getScales()) {
+		scaleFixtures.emplace_back(new FullTextScale(DB.get(), "FtScale" + std::to_string(scale), scale));
+		err = scaleFixtures.back()->Initialize();
+		if (!err.ok()) return err.code();
+	}
+
 	::benchmark::Initialize(&argc, argv);
 	if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
 
 	ft.RegisterAllCases();
+	for (auto& f : scaleFixtures) f->RegisterAllCases();
 
+	benchmark::AddReindexerContext();
 	benchmark::Reporter reporter;
 	::benchmark::RunSpecifiedBenchmarks(&reporter);
 
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/// Histogram of the latencies in microseconds with the log-linear buckets: each power of two range is split into kSubBuckets buckets, so
+/// the relative error of the quantiles is less than 1/kSubBuckets
+class LatencyHistogram {
+public:
+	static constexpr unsigned kSubBucketsBits = 6;
+	static constexpr unsigned kSubBuckets = 1u << kSubBucketsBits;
+	static constexpr unsigned kRanges = 64 - kSubBucketsBits;
+
+	void Record(uint64_t us) noexcept {
+		++buckets_[bucketIdx(us)];
+		++count_;
+		sum_ += us;
+		max_ = std::max(max_, us);
+	}
+	void Merge(const LatencyHistogram &other) noexcept {
+		for (size_t i = 0; i < buckets_.size(); ++i) buckets_[i] += other.buckets_[i];
+		count_ += other.count_;
+		sum_ += other.sum_;
+		max_ = std::max(max_, other.max_);
+	}
+	/// @return upper bound of the bucket, which contains the q-quantile
+	uint64_t Quantile(double q) const noexcept {
+		if (!count_) return 0;
+		const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * double(count_))));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < buckets_.size(); ++i) {
+			seen += buckets_[i];
+			if (seen >= rank) return std::min(bucketUpperBound(i), max_);
+		}
+		return max_;
+	}
+	uint64_t Count() const noexcept { return count_; }
+	uint64_t Max() const noexcept { return max_; }
+	double Mean() const noexcept { return count_ ? double(sum_) / double(count_) : 0.0; }
+
+private:
+	// Values less than kSubBuckets are stored exactly in the first range. Range r > 0 contains [2^(r + bits - 1), 2^(r + bits))
+	static size_t bucketIdx(uint64_t us) noexcept {
+		if (us < kSubBuckets) return us;
+		const unsigned msb = 63 - __builtin_clzll(us);
+		const unsigned range = msb - kSubBucketsBits + 1;
+		const unsigned sub = (us >> (msb - kSubBucketsBits + 1)) & (kSubBuckets / 2 - 1);
+		return size_t(range) * kSubBuckets / 2 + kSubBuckets / 2 + sub;
+	}
+	static uint64_t bucketUpperBound(size_t idx) noexcept {
+		if (idx < kSubBuckets) return idx;
+		const size_t range = (idx - kSubBuckets / 2) / (kSubBuckets / 2);
+		const uint64_t sub = (idx - kSubBuckets / 2) % (kSubBuckets / 2);
+		return ((kSubBuckets / 2 + sub + 1) << range) - 1;
+	}
+
+	std::array<uint64_t, kRanges * kSubBuckets / 2 + kSubBuckets / 2> buckets_ = {};
+	uint64_t count_ = 0;
+	uint64_t sum_ = 0;
+	uint64_t max_ = 0;
+};
@@ -0,0 +1,63 @@
+#include <iostream>
+#include "args/args.hpp"
+#include "workload.h"
+
+int main(int argc, char **argv) {
+	WorkloadConfig cfg;
+
+	args::ArgumentParser parser("Reindexer macro benchmark. Drives the running reindexer_server with the open-loop mixed workload");
+	args::HelpFlag help(parser, "help", "show this message", {'h', "help"});
+	args::Group options("options");
+	args::ValueFlag<std::string> dsnF(options, "DSN", "DSN of the database: 'cproto://<ip>:<port>/<dbname>'", {'d', "dsn"},
+									  "cproto://127.0.0.1:6534/macro_bench", args::Options::Single);
+	args::ValueFlag<unsigned> rateF(options, "OPS", "Target arrival rate (operations per second)", {'r', "rate"}, cfg.rate,
+									args::Options::Single);
+	args::ValueFlag<unsigned> durationF(options, "SEC", "Measured duration of the run (seconds)", {"duration"}, cfg.duration.count(),
+										args::Options::Single);
+	args::ValueFlag<unsigned> warmupF(options, "SEC", "Warmup before the measurement (seconds)", {"warmup"}, cfg.warmup.count(),
+									  args::Options::Single);
+	args::ValueFlag<unsigned> workersF(options, "N", "Number of the concurrent workers. Has to be enough to sustain the target rate",
+									   {'w', "workers"}, cfg.workers, args::Options::Single);
+	args::ValueFlag<unsigned> itemsF(options, "N", "Number of the items in the dataset", {"items"}, cfg.items, args::Options::Single);
+	args::ValueFlag<unsigned> txSizeF(options, "N", "Number of the upserts in each transaction", {"tx-size"}, cfg.txSize,
+									  args::Options::Single);
+	args::ValueFlag<std::string> mixF(options, "MIX", "Relative weights of the operations: get, range, ft, join, upsert and tx",
+									  {'m', "mix"}, "get=50,range=20,ft=5,join=5,upsert=15,tx=5", args::Options::Single);
+	args::Flag noFillF(options, "", "Use the dataset of the previous run instead of the recreation", {"no-fill"});
+	args::GlobalOptions globals(parser, options);
+
+	try {
+		parser.ParseCLI(argc, argv);
+	} catch (const args::Help &) {
+		std::cout << parser;
+		return 0;
+	} catch (const args::Error &e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		std::cout << parser.Help() << std::endl;
+		return 2;
+	}
+
+	cfg.dsn = args::get(dsnF);
+	cfg.rate = std::max(1u, args::get(rateF));
+	cfg.duration = std::chrono::seconds(args::get(durationF));
+	cfg.warmup = std::chrono::seconds(args::get(warmupF));
+	cfg.workers = std::max(1u, args::get(workersF));
+	cfg.items = std::max(1u, args::get(itemsF));
+	cfg.txSize = std::max(1u, args::get(txSizeF));
+	cfg.fill = !noFillF;
+	auto err = ParseWorkloadMix(args::get(mixF), cfg.mix);
+	if (!err.ok()) {
+		std::cerr << "ERROR: " << err.what() << std::endl;
+		return 2;
+	}
+
+	Workload workload(cfg);
+	err = workload.Connect();
+	if (err.ok()) err = workload.Prepare();
+	if (!err.ok()) {
+		std::cerr << "ERROR: " << err.what() << std::endl;
+		return 1;
+	}
+	workload.Run().Print(std::cout, cfg.rate);
+	return 0;
+}
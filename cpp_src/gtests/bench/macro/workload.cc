@@ -0,0 +1,264 @@
+#include "workload.h"
+
+#include <iomanip>
+#include <thread>
+#include "core/cjson/jsonbuilder.h"
+#include "tools/stringstools.h"
+
+using reindexer::Error;
+using reindexer::Query;
+using reindexer::client::Item;
+using reindexer::client::QueryResults;
+
+static const char kItemsNs[] = "macro_items";
+static const char kGenresNs[] = "macro_genres";
+static constexpr int kGenresCount = 100;
+static constexpr int kYearsFrom = 1900;
+static constexpr int kYearsCount = 120;
+// Time to execute the operations, which were scheduled before the end of the run, but were not started because of the overload
+static constexpr std::chrono::seconds kDrainTimeout{10};
+
+std::string_view WorkloadOpName(WorkloadOp type) noexcept {
+	switch (type) {
+		case WorkloadOp::Get:
+			return "get";
+		case WorkloadOp::Range:
+			return "range";
+		case WorkloadOp::Fulltext:
+			return "ft";
+		case WorkloadOp::Join:
+			return "join";
+		case WorkloadOp::Upsert:
+			return "upsert";
+		case WorkloadOp::Tx:
+			return "tx";
+		case WorkloadOp::Count:
+			break;
+	}
+	return "<unknown>";
+}
+
+Error ParseWorkloadMix(std::string_view str, WorkloadMix &mix) {
+	WorkloadMix ret = {};
+	std::vector<std::string> parts;
+	for (const auto &part : reindexer::split(std::string(str), ",", true, parts)) {
+		const auto pos = part.find('=');
+		if (pos == std::string::npos) return Error(errParams, "Invalid mix entry '%s', expected 'op=weight'", part);
+		const std::string_view name = std::string_view(part).substr(0, pos);
+		unsigned op = 0;
+		while (op < unsigned(WorkloadOp::Count) && WorkloadOpName(WorkloadOp(op)) != name) ++op;
+		if (op == unsigned(WorkloadOp::Count)) return Error(errParams, "Unknown operation '%s' in mix", name);
+		ret[op] = reindexer::stoi(std::string_view(part).substr(pos + 1));
+	}
+	unsigned total = 0;
+	for (auto w : ret) total += w;
+	if (!total) return Error(errParams, "Mix '%s' has no operations", str);
+	mix = ret;
+	return Error();
+}
+
+void WorkloadReport::Merge(const WorkloadReport &other) {
+	for (size_t i = 0; i < latencies.size(); ++i) {
+		latencies[i].Merge(other.latencies[i]);
+		errors[i] += other.errors[i];
+	}
+	dropped += other.dropped;
+}
+
+void WorkloadReport::Print(std::ostream &os, unsigned targetRate) const {
+	const double seconds = double(elapsed.count()) / 1e6;
+	LatencyHistogram total;
+	uint64_t totalErrors = 0;
+	os << std::left << std::setw(8) << "op" << std::right << std::setw(10) << "count" << std::setw(10) << "errors" << std::setw(12)
+	   << "ops/s" << std::setw(10) << "mean,us" << std::setw(10) << "p50,us" << std::setw(10) << "p99,us" << std::setw(10) << "p999,us"
+	   << std::setw(12) << "max,us" << '\n';
+	auto printRow = [&os, seconds](std::string_view name, const LatencyHistogram &h, uint64_t errors) {
+		os << std::left << std::setw(8) << name << std::right << std::setw(10) << h.Count() << std::setw(10) << errors << std::setw(12)
+		   << std::fixed << std::setprecision(1) << (seconds > 0 ? double(h.Count()) / seconds : 0.0) << std::setw(10) << h.Mean()
+		   << std::setw(10) << h.Quantile(0.5) << std::setw(10) << h.Quantile(0.99) << std::setw(10) << h.Quantile(0.999) << std::setw(12)
+		   << h.Max() << '\n';
+	};
+	for (unsigned op = 0; op < unsigned(WorkloadOp::Count); ++op) {
+		if (!latencies[op].Count() && !errors[op]) continue;
+		printRow(WorkloadOpName(WorkloadOp(op)), latencies[op], errors[op]);
+		total.Merge(latencies[op]);
+		totalErrors += errors[op];
+	}
+	printRow("total", total, totalErrors);
+	os << "target rate: " << targetRate << " ops/s, measured time: " << std::setprecision(1) << seconds << " s";
+	if (dropped) os << ", dropped (not started in " << kDrainTimeout.count() << "s after the end): " << dropped;
+	os << std::endl;
+}
+
+Workload::Workload(const WorkloadConfig &cfg)
+	: cfg_(cfg), db_(reindexer::client::ReindexerConfig(int(std::max(1u, cfg.workers / 4)), 1)) {
+	for (auto w : cfg_.mix) mixTotal_ += w;
+	std::mt19937 rnd(1);
+	static const char kLetters[] = "abcdefghijklmnopqrstuvwxyz";
+	words_.reserve(10000);
+	for (int i = 0; i < 10000; ++i) {
+		std::string word(3 + rnd() % 8, 'a');
+		for (auto &c : word) c = kLetters[rnd() % 26];
+		words_.emplace_back(std::move(word));
+	}
+}
+
+Error Workload::Connect() { return db_.Connect(cfg_.dsn, reindexer::client::ConnectOpts().CreateDBIfMissing()); }
+
+Error Workload::Prepare() {
+	using reindexer::NamespaceDef;
+	// Data of the previous run is used as is
+	if (!cfg_.fill) return Error();
+	for (const char *ns : {kItemsNs, kGenresNs}) {
+		auto err = db_.DropNamespace(ns);
+		if (!err.ok() && err.code() != errNotFound) return err;
+	}
+	NamespaceDef genres(kGenresNs);
+	genres.AddIndex("id", "hash", "int", IndexOpts().PK()).AddIndex("title", "hash", "string", IndexOpts());
+	auto err = db_.AddNamespace(genres);
+	if (!err.ok()) return err;
+	NamespaceDef items(kItemsNs);
+	items.AddIndex("id", "hash", "int", IndexOpts().PK())
+		.AddIndex("name", "hash", "string", IndexOpts())
+		.AddIndex("year", "tree", "int", IndexOpts())
+		.AddIndex("genre", "hash", "int", IndexOpts())
+		.AddIndex("description", "text", "string", IndexOpts());
+	err = db_.AddNamespace(items);
+	if (!err.ok()) return err;
+
+	std::mt19937 rnd(2);
+	for (int i = 0; i < kGenresCount; ++i) {
+		Item item = db_.NewItem(kGenresNs);
+		if (!item.Status().ok()) return item.Status();
+		err = item.FromJSON(R"({"id":)" + std::to_string(i) + R"(,"title":")" + words_[i] + "\"}");
+		if (!err.ok()) return err;
+		err = db_.Upsert(kGenresNs, item);
+		if (!err.ok()) return err;
+	}
+	for (unsigned i = 0; i < cfg_.items; ++i) {
+		err = upsertItem(int(i), rnd);
+		if (!err.ok()) return err;
+	}
+	return db_.Commit(kItemsNs);
+}
+
+WorkloadReport Workload::Run() {
+	// Arrivals are scheduled since the beginning of the warmup, but are measured since its end
+	const auto start = Clock::now();
+	const auto measureStart = start + cfg_.warmup;
+	const auto end = measureStart + cfg_.duration;
+	nextArrival_ = 0;
+	std::vector<WorkloadReport> reports(cfg_.workers);
+	std::vector<std::thread> threads;
+	threads.reserve(cfg_.workers);
+	for (unsigned i = 0; i < cfg_.workers; ++i) {
+		threads.emplace_back([this, start, measureStart, end, &reports, i] { worker(start, measureStart, end, reports[i]); });
+	}
+	for (auto &th : threads) th.join();
+
+	WorkloadReport ret;
+	for (const auto &r : reports) ret.Merge(r);
+	ret.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - measureStart);
+	return ret;
+}
+
+void Workload::worker(Clock::time_point start, Clock::time_point measureStart, Clock::time_point end, WorkloadReport &report) {
+	const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / double(cfg_.rate)));
+	std::mt19937 rnd(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	for (;;) {
+		const auto arrival = start + interval * nextArrival_.fetch_add(1, std::memory_order_relaxed);
+		if (arrival >= end) break;
+		auto now = Clock::now();
+		if (now < arrival) {
+			std::this_thread::sleep_until(arrival);
+		} else if (now > end + kDrainTimeout) {
+			++report.dropped;
+			continue;
+		}
+		const WorkloadOp op = pickOp(rnd);
+		const Error err = execute(op, rnd);
+		if (arrival < measureStart) continue;
+		if (!err.ok()) {
+			++report.errors[size_t(op)];
+			continue;
+		}
+		now = Clock::now();
+		report.latencies[size_t(op)].Record(std::chrono::duration_cast<std::chrono::microseconds>(now - arrival).count());
+	}
+}
+
+WorkloadOp Workload::pickOp(std::mt19937 &rnd) const {
+	unsigned v = rnd() % mixTotal_;
+	unsigned op = 0;
+	while (v >= cfg_.mix[op]) v -= cfg_.mix[op++];
+	return WorkloadOp(op);
+}
+
+std::string Workload::randomText(std::mt19937 &rnd, unsigned words) const {
+	std::string ret;
+	for (unsigned i = 0; i < words; ++i) {
+		if (i) ret += ' ';
+		ret += words_[rnd() % words_.size()];
+	}
+	return ret;
+}
+
+Error Workload::fillItem(Item &item, int id, std::mt19937 &rnd) const {
+	reindexer::WrSerializer ser;
+	{
+		reindexer::JsonBuilder json(ser);
+		json.Put("id", id);
+		json.Put("name", words_[rnd() % words_.size()]);
+		json.Put("year", kYearsFrom + int(rnd() % kYearsCount));
+		json.Put("genre", int(rnd() % kGenresCount));
+		json.Put("description", randomText(rnd, 20));
+	}
+	return item.FromJSON(ser.Slice());
+}
+
+Error Workload::upsertItem(int id, std::mt19937 &rnd) {
+	Item item = db_.NewItem(kItemsNs);
+	if (!item.Status().ok()) return item.Status();
+	auto err = fillItem(item, id, rnd);
+	if (!err.ok()) return err;
+	return db_.Upsert(kItemsNs, item);
+}
+
+Error Workload::execute(WorkloadOp type, std::mt19937 &rnd) {
+	const int id = int(rnd() % std::max(1u, cfg_.items));
+	const int year = kYearsFrom + int(rnd() % kYearsCount);
+	QueryResults qr;
+	switch (type) {
+		case WorkloadOp::Get:
+			return db_.Select(Query(kItemsNs).Where("id", CondEq, id), qr);
+		case WorkloadOp::Range:
+			return db_.Select(Query(kItemsNs).Where("year", CondRange, {year, year + 5}).Limit(20), qr);
+		case WorkloadOp::Fulltext:
+			return db_.Select(Query(kItemsNs).Where("description", CondEq, words_[rnd() % words_.size()]).Limit(20), qr);
+		case WorkloadOp::Join:
+			return db_.Select(Query(kItemsNs)
+								  .Where("year", CondRange, {year, year + 5})
+								  .Limit(20)
+								  .InnerJoin("genre", "id", CondEq, Query(kGenresNs)),
+							  qr);
+		case WorkloadOp::Upsert:
+			return upsertItem(id, rnd);
+		case WorkloadOp::Tx: {
+			auto tx = db_.NewTransaction(kItemsNs);
+			if (!tx.Status().ok()) return tx.Status();
+			for (unsigned i = 0; i < cfg_.txSize; ++i) {
+				Item item = tx.NewItem();
+				auto err = item.Status().ok() ? fillItem(item, int(rnd() % std::max(1u, cfg_.items)), rnd) : item.Status();
+				if (!err.ok()) {
+					db_.RollBackTransaction(tx);
+					return err;
+				}
+				tx.Upsert(std::move(item));
+			}
+			return db_.CommitTransaction(tx);
+		}
+		case WorkloadOp::Count:
+			break;
+	}
+	return Error(errParams, "Unknown operation");
+}
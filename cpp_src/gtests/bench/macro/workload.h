@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "client/reindexer.h"
+#include "latencyhistogram.h"
+
+enum class WorkloadOp : unsigned { Get = 0, Range, Fulltext, Join, Upsert, Tx, Count };
+
+std::string_view WorkloadOpName(WorkloadOp type) noexcept;
+
+using WorkloadMix = std::array<unsigned, size_t(WorkloadOp::Count)>;
+
+/// Parses the mix of the operations in format "get=50,range=20,ft=5,join=5,upsert=15,tx=5". Weights are relative
+reindexer::Error ParseWorkloadMix(std::string_view str, WorkloadMix &mix);
+
+struct WorkloadConfig {
+	std::string dsn;
+	// Target arrival rate of the operations per second
+	unsigned rate = 1000;
+	std::chrono::seconds duration{60};
+	std::chrono::seconds warmup{5};
+	unsigned workers = 16;
+	unsigned items = 100000;
+	unsigned txSize = 20;
+	bool fill = true;
+	WorkloadMix mix = {50, 20, 5, 5, 15, 5};
+};
+
+struct WorkloadReport {
+	std::array<LatencyHistogram, size_t(WorkloadOp::Count)> latencies;
+	std::array<uint64_t, size_t(WorkloadOp::Count)> errors = {};
+	std::chrono::microseconds elapsed{0};
+	// Operations, which were not started until the end of the run, because all the workers were busy
+	uint64_t dropped = 0;
+
+	void Merge(const WorkloadReport &other);
+	void Print(std::ostream &os, unsigned targetRate) const;
+};
+
+/// Open-loop workload: the operations arrive with the fixed rate regardless of the completion of the previous ones. Latency of each
+/// operation is measured from its scheduled arrival time, so the time spent in the queue while all the workers are busy is included and
+/// the results are not affected by the coordinated omission
+class Workload {
+public:
+	explicit Workload(const WorkloadConfig &cfg);
+
+	reindexer::Error Connect();
+	/// Creates namespaces and fills them, if it is enabled by the config
+	reindexer::Error Prepare();
+	WorkloadReport Run();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void worker(Clock::time_point start, Clock::time_point measureStart, Clock::time_point end, WorkloadReport &report);
+	reindexer::Error execute(WorkloadOp type, std::mt19937 &rnd);
+	reindexer::Error upsertItem(int id, std::mt19937 &rnd);
+	reindexer::Error fillItem(reindexer::client::Item &item, int id, std::mt19937 &rnd) const;
+	WorkloadOp pickOp(std::mt19937 &rnd) const;
+	std::string randomText(std::mt19937 &rnd, unsigned words) const;
+
+	WorkloadConfig cfg_;
+	reindexer::client::Reindexer db_;
+	std::vector<std::string> words_;
+	std::atomic<uint64_t> nextArrival_{0};
+	unsigned mixTotal_ = 0;
+};
@@ -5,6 +5,7 @@
 #include "aggregation.h"
 #include "api_tv_composite.h"
 #include "api_tv_simple.h"
+#include "concurrent_access.h"
 #include "geometry.h"
 #include "join_items.h"
 #include "tools/reporter.h"
@@ -40,6 +41,7 @@ int main(int argc, char** argv) {
 	ApiTvComposite apiTvComposite(DB.get(), "ApiTvComposite", kItemsInBenchDataset);
 	Geometry geometry(DB.get(), "Geometry", kItemsInBenchDataset);
 	Aggregation aggregation(DB.get(), "Aggregation", kItemsInBenchDataset);
+	ConcurrentAccess concurrentAccess(DB.get(), "ConcurrentAccess", kItemsInBenchDataset / 5);
 
 	auto err = apiTvSimple.Initialize();
 	if (!err.ok()) return err.code();
@@ -56,6 +58,9 @@ int main(int argc, char** argv) {
 	err = aggregation.Initialize();
 	if (!err.ok()) return err.code();
 
+	err = concurrentAccess.Initialize();
+	if (!err.ok()) return err.code();
+
 	::benchmark::Initialize(&argc, argv);
 	if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
 
@@ -64,6 +69,7 @@ int main(int argc, char** argv) {
 	apiTvComposite.RegisterAllCases();
 	geometry.RegisterAllCases();
 	aggregation.RegisterAllCases();
+	concurrentAccess.RegisterAllCases();
 
 	::benchmark::RunSpecifiedBenchmarks();
 }
@@ -0,0 +1,91 @@
+#include <iostream>
+#include "args/args.hpp"
+#include "core/storage/storagefactory.h"
+#include "storage_load.h"
+#include "tools/fsops.h"
+#include "tools/stringstools.h"
+
+int main(int argc, char **argv) {
+	using reindexer::datastorage::StorageType;
+	StorageBenchConfig cfg;
+
+	// Own flags are parsed after the benchmark library has removed its flags from the arguments
+	::benchmark::Initialize(&argc, argv);
+	args::ArgumentParser parser("Reindexer storage benchmark. Measures fill, load on startup and updates of the namespace with storage",
+								"Benchmark library flags (--benchmark_filter, --benchmark_out, --benchmark_out_format=json, etc) are also "
+								"accepted");
+	args::HelpFlag help(parser, "help", "show this message", {'h', "help"});
+	args::Group options("options");
+	args::ValueFlag<std::string> pathF(options, "PATH", "Root directory of the databases. It is cleaned before the run", {"path"}, cfg.path,
+									   args::Options::Single);
+	args::ValueFlag<unsigned> itemsF(options, "N", "Number of the items in the namespace", {"items"}, cfg.items, args::Options::Single);
+	args::ValueFlag<unsigned> payloadF(options, "BYTES", "Size of the non-indexed payload of each item", {"payload"}, cfg.payloadSize,
+									   args::Options::Single);
+	args::ValueFlag<std::string> storagesF(options, "TYPES", "Comma-separated storage types: leveldb, rocksdb. All available by default",
+										   {"storages"}, "", args::Options::Single);
+	args::ValueFlag<std::string> indexesF(options, "SETS", "Comma-separated indexes sets: pk_only, indexed, fulltext", {"indexes"},
+										  "pk_only,indexed,fulltext", args::Options::Single);
+	args::ValueFlag<unsigned> loadIterationsF(options, "N", "Number of the loads in the cold and warm load cases", {"load-iterations"},
+											  cfg.loadIterations, args::Options::Single);
+	args::ValueFlag<double> upsertSecondsF(options, "SEC", "Minimal duration of the upsert case", {"upsert-time"}, cfg.upsertSeconds,
+										   args::Options::Single);
+	args::GlobalOptions globals(parser, options);
+
+	try {
+		parser.ParseCLI(argc, argv);
+	} catch (const args::Help &) {
+		std::cout << parser;
+		return 0;
+	} catch (const args::Error &e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		std::cout << parser.Help() << std::endl;
+		return 2;
+	}
+
+	cfg.path = args::get(pathF);
+	cfg.items = std::max(1u, args::get(itemsF));
+	cfg.payloadSize = args::get(payloadF);
+	cfg.loadIterations = std::max(1u, args::get(loadIterationsF));
+	cfg.upsertSeconds = args::get(upsertSecondsF);
+
+	std::vector<StorageType> types;
+	if (args::get(storagesF).empty()) {
+		types = reindexer::datastorage::StorageFactory::getAvailableTypes();
+	} else {
+		std::vector<std::string> names;
+		for (const auto &name : reindexer::split(args::get(storagesF), ",", true, names)) {
+			try {
+				types.emplace_back(reindexer::datastorage::StorageTypeFromString(name));
+			} catch (const reindexer::Error &err) {
+				std::cerr << "ERROR: " << err.what() << std::endl;
+				return 2;
+			}
+		}
+	}
+	std::vector<StorageLoad::Indexes> indexes;
+	std::vector<std::string> names;
+	for (const auto &name : reindexer::split(args::get(indexesF), ",", true, names)) {
+		unsigned i = 0;
+		while (i <= unsigned(StorageLoad::Indexes::Fulltext) && StorageLoad::IndexesName(StorageLoad::Indexes(i)) != name) ++i;
+		if (i > unsigned(StorageLoad::Indexes::Fulltext)) {
+			std::cerr << "ERROR: Unknown indexes set '" << name << "'" << std::endl;
+			return 2;
+		}
+		indexes.emplace_back(StorageLoad::Indexes(i));
+	}
+
+	if (reindexer::fs::RmDirAll(cfg.path) < 0 && errno != ENOENT) {
+		std::cerr << "Could not clean working dir '" << cfg.path << "'. Reason: " << strerror(errno) << std::endl;
+		return 1;
+	}
+
+	std::vector<std::unique_ptr<StorageLoad>> fixtures;
+	for (auto type : types) {
+		for (auto idx : indexes) {
+			fixtures.emplace_back(std::make_unique<StorageLoad>(cfg, type, idx));
+			fixtures.back()->RegisterAllCases();
+		}
+	}
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
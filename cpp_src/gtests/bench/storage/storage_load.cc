@@ -0,0 +1,356 @@
+#include "storage_load.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <functional>
+#include <iostream>
+#include "core/cjson/jsonbuilder.h"
+#include "gason/gason.h"
+#include "tools/fsops.h"
+
+using reindexer::Error;
+using reindexer::Query;
+using reindexer::QueryResults;
+
+static constexpr int kGenresCount = 50;
+static constexpr int kYearsFrom = 1900;
+static constexpr int kYearsCount = 120;
+static constexpr int kTagsCount = 5;
+static constexpr int kDescriptionWords = 20;
+static constexpr int kWordsCount = 10000;
+
+static void forEachFile(const std::string &dir, const std::function<void(const std::string &)> &fn) {
+	std::vector<reindexer::fs::DirEntry> entries;
+	if (reindexer::fs::ReadDir(dir, entries) < 0) return;
+	for (const auto &e : entries) {
+		const std::string path = reindexer::fs::JoinPath(dir, e.name);
+		if (e.isDir) {
+			forEachFile(path, fn);
+		} else {
+			fn(path);
+		}
+	}
+}
+
+static uint64_t directorySize(const std::string &dir) {
+	uint64_t ret = 0;
+	forEachFile(dir, [&ret](const std::string &path) {
+		struct stat st;
+		if (::stat(path.c_str(), &st) == 0) ret += uint64_t(st.st_size);
+	});
+	return ret;
+}
+
+// Evicts the storage files from the OS page cache, so the next load reads them from the disk. Only the clean pages may be evicted, so the
+// files are synced first
+static void dropPageCache(const std::string &dir) {
+#if defined(__linux__)
+	forEachFile(dir, [](const std::string &path) {
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return;
+		::fdatasync(fd);
+		::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+	});
+#else
+	static bool warned = false;
+	if (!warned) {
+		std::cerr << "Page cache eviction is not supported on this platform, cold load is measured with the warm cache" << std::endl;
+		warned = true;
+	}
+	(void)dir;
+#endif
+}
+
+static void warmPageCache(const std::string &dir) {
+	forEachFile(dir, [](const std::string &path) {
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return;
+		char buf[1 << 16];
+		while (::read(fd, buf, sizeof(buf)) > 0) {
+		}
+		::close(fd);
+	});
+}
+
+// Upper bound of the bucket, which contains the quantile. Values of the last bucket have no upper bound, so its lower bound is returned
+static double histogramQuantile(const gason::JsonNode &hist, double q) {
+	const auto total = hist["total_count"].As<uint64_t>();
+	if (!total) return 0.0;
+	uint64_t cumulative = 0, bound = 0;
+	for (const auto &bucket : hist["buckets"]) {
+		if (!bucket["le"].empty()) bound = bucket["le"].As<uint64_t>();
+		cumulative += bucket["count"].As<uint64_t>();
+		if (double(cumulative) >= q * double(total)) break;
+	}
+	return double(bound);
+}
+
+StorageLoad::StorageLoad(const StorageBenchConfig &cfg, reindexer::datastorage::StorageType type, Indexes indexes)
+	: cfg_(cfg), type_(type), indexes_(indexes), nsdef_("items") {
+	dbPath_ =
+		reindexer::fs::JoinPath(cfg_.path, reindexer::datastorage::StorageTypeToString(type_) + "_" + std::string(IndexesName(indexes_)));
+	nsdef_.AddIndex("id", "hash", "int", IndexOpts().PK());
+	if (indexes_ != Indexes::PkOnly) {
+		nsdef_.AddIndex("year", "tree", "int", IndexOpts())
+			.AddIndex("genre", "hash", "int", IndexOpts())
+			.AddIndex("name", "hash", "string", IndexOpts())
+			.AddIndex("tags", "hash", "string", IndexOpts().Array());
+	}
+	if (indexes_ == Indexes::Fulltext) {
+		nsdef_.AddIndex("description", "text", "string", IndexOpts());
+	}
+
+	std::mt19937 rnd(1);
+	static const char kLetters[] = "abcdefghijklmnopqrstuvwxyz";
+	words_.reserve(kWordsCount);
+	for (int i = 0; i < kWordsCount; ++i) {
+		std::string word(3 + rnd() % 8, 'a');
+		for (auto &c : word) c = kLetters[rnd() % 26];
+		words_.emplace_back(std::move(word));
+	}
+}
+
+StorageLoad *StorageLoad::active_ = nullptr;
+
+StorageLoad::~StorageLoad() {
+	if (active_ == this) active_ = nullptr;
+}
+
+void StorageLoad::activate() {
+	if (active_ && active_ != this) active_->db_.reset();
+	active_ = this;
+}
+
+std::string_view StorageLoad::IndexesName(Indexes indexes) noexcept {
+	switch (indexes) {
+		case Indexes::PkOnly:
+			return "pk_only";
+		case Indexes::Indexed:
+			return "indexed";
+		case Indexes::Fulltext:
+			return "fulltext";
+	}
+	return "<unknown>";
+}
+
+std::string StorageLoad::caseName(std::string_view name) const {
+	return std::string(name) + "/" + reindexer::datastorage::StorageTypeToString(type_) + "/" + std::string(IndexesName(indexes_));
+}
+
+void StorageLoad::RegisterAllCases() {
+	using std::placeholders::_1;
+	benchmark::RegisterBenchmark(caseName("Fill").c_str(), std::bind(&StorageLoad::Fill, this, _1))
+		->Iterations(1)
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+	benchmark::RegisterBenchmark(caseName("ColdLoad").c_str(), std::bind(&StorageLoad::ColdLoad, this, _1))
+		->Iterations(cfg_.loadIterations)
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+	benchmark::RegisterBenchmark(caseName("WarmLoad").c_str(), std::bind(&StorageLoad::WarmLoad, this, _1))
+		->Iterations(cfg_.loadIterations)
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+	benchmark::RegisterBenchmark(caseName("Upsert").c_str(), std::bind(&StorageLoad::Upsert, this, _1))
+		->MinTime(cfg_.upsertSeconds)
+		->UseRealTime();
+}
+
+Error StorageLoad::connect() {
+	db_ = std::make_unique<reindexer::Reindexer>();
+	const auto storageType = type_ == reindexer::datastorage::StorageType::RocksDB ? kStorageTypeOptRocksDB : kStorageTypeOptLevelDB;
+	auto err = db_->Connect("builtin://" + dbPath_, ConnectOpts().OpenNamespaces(false).WithStorageType(storageType));
+	if (!err.ok()) return err;
+	// Flushes statistics are reported by the upsert case
+	auto item = db_->NewItem("#config");
+	if (!item.Status().ok()) return item.Status();
+	err = item.FromJSON(R"json({"type":"profiling","profiling":{"perfstats":true}})json");
+	if (!err.ok()) return err;
+	return db_->Upsert("#config", item);
+}
+
+Error StorageLoad::openNamespace() { return db_->OpenNamespace(nsdef_.name, nsdef_.storage); }
+
+Error StorageLoad::upsertItem(int id, size_t &bytes) {
+	reindexer::WrSerializer ser;
+	{
+		reindexer::JsonBuilder json(ser);
+		json.Put("id", id);
+		json.Put("year", kYearsFrom + int(rnd_() % kYearsCount));
+		json.Put("genre", int(rnd_() % kGenresCount));
+		json.Put("name", words_[rnd_() % words_.size()]);
+		{
+			auto tags = json.Array("tags");
+			for (int i = 0; i < kTagsCount; ++i) tags.Put(nullptr, words_[rnd_() % words_.size()]);
+		}
+		std::string description;
+		for (int i = 0; i < kDescriptionWords; ++i) {
+			if (i) description += ' ';
+			description += words_[rnd_() % words_.size()];
+		}
+		json.Put("description", description);
+		std::string payload(cfg_.payloadSize, 'a');
+		for (auto &c : payload) c = char('a' + rnd_() % 26);
+		json.Put("payload", payload);
+	}
+	auto item = db_->NewItem(nsdef_.name);
+	if (!item.Status().ok()) return item.Status();
+	auto err = item.FromJSON(ser.Slice());
+	if (!err.ok()) return err;
+	bytes += ser.Len();
+	return db_->Upsert(nsdef_.name, item);
+}
+
+void StorageLoad::Fill(State &state) {
+	activate();
+	size_t bytes = 0;
+	filled_ = false;
+	for (auto _ : state) {
+		state.PauseTiming();
+		db_.reset();
+		if (reindexer::fs::RmDirAll(dbPath_) < 0 && errno != ENOENT) {
+			state.SkipWithError(("Unable to remove '" + dbPath_ + "': " + strerror(errno)).c_str());
+			return;
+		}
+		auto err = connect();
+		if (err.ok()) err = db_->AddNamespace(nsdef_);
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			return;
+		}
+		state.ResumeTiming();
+
+		for (unsigned i = 0; i < cfg_.items && err.ok(); ++i) err = upsertItem(int(i), bytes);
+		if (err.ok()) err = db_->Commit(nsdef_.name);
+		// Closing flushes all the pending updates of the storage, so it's the part of the fill
+		if (err.ok()) err = db_->CloseNamespace(nsdef_.name);
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			return;
+		}
+
+		state.PauseTiming();
+		db_.reset();
+		state.ResumeTiming();
+	}
+	filled_ = true;
+	state.SetItemsProcessed(int64_t(state.iterations()) * cfg_.items);
+	state.SetBytesProcessed(int64_t(bytes));
+	state.counters["storage_mb"] = double(directorySize(dbPath_)) / double(1 << 20);
+}
+
+bool StorageLoad::ensureFilled(State &state) {
+	activate();
+	if (filled_) return true;
+	db_.reset();
+	if (reindexer::fs::RmDirAll(dbPath_) < 0 && errno != ENOENT) {
+		state.SkipWithError(("Unable to remove '" + dbPath_ + "': " + strerror(errno)).c_str());
+		return false;
+	}
+	auto err = connect();
+	if (err.ok()) err = db_->AddNamespace(nsdef_);
+	size_t bytes = 0;
+	for (unsigned i = 0; i < cfg_.items && err.ok(); ++i) err = upsertItem(int(i), bytes);
+	if (err.ok()) err = db_->Commit(nsdef_.name);
+	if (!err.ok()) {
+		state.SkipWithError(err.what().c_str());
+		return false;
+	}
+	db_.reset();
+	filled_ = true;
+	return true;
+}
+
+void StorageLoad::load(State &state, bool cold) {
+	if (!ensureFilled(state)) return;
+	for (auto _ : state) {
+		state.PauseTiming();
+		db_.reset();
+		if (cold) {
+			dropPageCache(dbPath_);
+		} else {
+			warmPageCache(dbPath_);
+		}
+		auto err = connect();
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			return;
+		}
+		state.ResumeTiming();
+
+		err = openNamespace();
+
+		state.PauseTiming();
+		QueryResults qr;
+		if (err.ok()) err = db_->Select(Query(nsdef_.name).Limit(0).ReqTotal(), qr);
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			return;
+		}
+		if (qr.TotalCount() != cfg_.items) {
+			state.SkipWithError(("Expected " + std::to_string(cfg_.items) + " items, got " + std::to_string(qr.TotalCount())).c_str());
+			return;
+		}
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(int64_t(state.iterations()) * cfg_.items);
+	state.counters["storage_mb"] = double(directorySize(dbPath_)) / double(1 << 20);
+}
+
+void StorageLoad::Upsert(State &state) {
+	if (!ensureFilled(state)) return;
+	// Database is kept open between the runs of the case, so the namespace is loaded only once
+	if (!db_) {
+		auto err = connect();
+		if (err.ok()) err = openNamespace();
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			return;
+		}
+	}
+	QueryResults resetQr;
+	auto err = db_->Delete(Query("#perfstats"), resetQr);
+	if (!err.ok()) {
+		state.SkipWithError(err.what().c_str());
+		return;
+	}
+
+	size_t bytes = 0;
+	for (auto _ : state) {
+		// Updates of the existing items, so the size of the namespace remains the same
+		err = upsertItem(int(rnd_() % cfg_.items), bytes);
+		if (!err.ok()) {
+			state.SkipWithError(err.what().c_str());
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(int64_t(bytes));
+	reportFlushes(state);
+}
+
+void StorageLoad::reportFlushes(State &state) {
+	QueryResults qr;
+	auto err = db_->Select(Query("#perfstats").Where("name", CondEq, nsdef_.name), qr);
+	if (!err.ok() || qr.Count() != 1) return;
+	reindexer::WrSerializer ser;
+	err = qr.begin().GetJSON(ser, false);
+	if (!err.ok()) return;
+	try {
+		gason::JsonParser parser;
+		const auto root = parser.Parse(ser.Slice());
+		const auto &duration = root["storage_flushes"]["duration_us"];
+		const auto &size = root["storage_flushes"]["size_bytes"];
+		const auto flushes = duration["total_count"].As<uint64_t>();
+		state.counters["flushes"] = double(flushes);
+		if (flushes) {
+			state.counters["flush_mean_us"] = double(duration["sum"].As<uint64_t>()) / double(flushes);
+			state.counters["flush_p99_us"] = histogramQuantile(duration, 0.99);
+			state.counters["flush_mean_kb"] = double(size["sum"].As<uint64_t>()) / double(flushes) / 1024.0;
+		}
+	} catch (const gason::Exception &e) {
+		std::cerr << "Unable to parse perfstats: " << e.what() << std::endl;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "core/reindexer.h"
+#include "core/storage/storagetype.h"
+
+struct StorageBenchConfig {
+	// Root directory of the databases. Each storage type and indexes set uses its own database in the subdirectory
+	std::string path = "/tmp/reindex/storage_bench";
+	unsigned items = 200000;
+	// Size of the non-indexed string field of each item, which is the main part of the namespace size
+	unsigned payloadSize = 1024;
+	unsigned loadIterations = 3;
+	double upsertSeconds = 10.0;
+};
+
+/// Storage and startup benchmark of the single namespace: its filling, loading on the database start with cold and warm page cache and
+/// the sustained updates with the enabled storage. Each set of indexes is benchmarked for each storage type
+class StorageLoad {
+public:
+	enum class Indexes { PkOnly, Indexed, Fulltext };
+
+	StorageLoad(const StorageBenchConfig &cfg, reindexer::datastorage::StorageType type, Indexes indexes);
+	~StorageLoad();
+
+	void RegisterAllCases();
+
+	static std::string_view IndexesName(Indexes indexes) noexcept;
+
+private:
+	using State = benchmark::State;
+
+	void Fill(State &state);
+	void ColdLoad(State &state) { load(state, true); }
+	void WarmLoad(State &state) { load(state, false); }
+	void Upsert(State &state);
+
+	void load(State &state, bool cold);
+	// Closes the database of the previously benchmarked fixture, so only one dataset is kept in memory
+	void activate();
+	reindexer::Error connect();
+	reindexer::Error openNamespace();
+	reindexer::Error upsertItem(int id, size_t &bytes);
+	// Fills the namespace, if it was not filled by the Fill case before. Required by the load and upsert cases
+	bool ensureFilled(State &state);
+	void reportFlushes(State &state);
+	std::string caseName(std::string_view name) const;
+
+	StorageBenchConfig cfg_;
+	reindexer::datastorage::StorageType type_;
+	Indexes indexes_;
+	reindexer::NamespaceDef nsdef_;
+	std::string dbPath_;
+	std::unique_ptr<reindexer::Reindexer> db_;
+	std::vector<std::string> words_;
+	std::mt19937 rnd_;
+	bool filled_ = false;
+
+	static StorageLoad *active_;
+};
@@ -2,6 +2,10 @@
 
 #include <cmath>
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 string HumanReadableNumber(size_t number, bool si, const string& unitLabel) {
 	const string siPrefix = "kMGTPE";
 	const string prefix = "KMGTPE";
@@ -58,3 +62,17 @@ string FormatString(const char* msg, ...) {
 	va_end(args);
 	return tmp;
 }
+
+size_t GetPeakRSS() {
+#ifndef _WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss;
+#else
+	return size_t(usage.ru_maxrss) * 1024;
+#endif
+#else
+	return 0;
+#endif
+}
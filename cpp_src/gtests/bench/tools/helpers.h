@@ -68,3 +68,5 @@ vector<T> randomNumArray(int count, int start, int region) {
 string FormatString(const char* msg, va_list args);
 string FormatString(const char* msg, ...);
 string HumanReadableNumber(size_t number, bool si, const string& unitLabel = "");
+// @return peak resident set size of the process in bytes (0, if it's not supported on this platform)
+size_t GetPeakRSS();
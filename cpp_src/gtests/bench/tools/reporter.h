@@ -3,6 +3,7 @@
 #include <benchmark/benchmark.h>
 
 #include "helpers.h"
+#include "reindexer_version.h"
 #include "vendor/spdlog/spdlog.h"
 
 using benchmark::ConsoleReporter;
@@ -120,4 +121,8 @@ private:
 	}
 };
 
+/// Adds reindexer's version to the context of the reports. JSON report (--benchmark_out=<file> --benchmark_out_format=json) contains
+/// all of the counters, so the reports of the different versions may be compared
+inline void AddReindexerContext() { AddCustomContext("reindexer_version", REINDEX_VERSION); }
+
 }  // namespace benchmark
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <fstream>
 #include <vector>
 #include "reindexer_api.h"
@@ -717,6 +718,62 @@ TEST_F(ReindexerApi, WithTimeoutInterface) {
 	ASSERT_TRUE(err.ok()) << err.what();
 }
 
+TEST_F(ReindexerApi, BestEffortQueryTimeout) {
+	// Deadline, which is exceeded after the given count of the checks. Count of the checks is deterministic, unlike the time
+	class ChecksDeadlineContext : public reindexer::IRdxCancelContext {
+	public:
+		explicit ChecksDeadlineContext(int checksLimit) noexcept : checksLimit_(checksLimit) {}
+		reindexer::CancelType GetCancelType() const noexcept override {
+			return (++checks_ > checksLimit_) ? reindexer::CancelType::Timeout : reindexer::CancelType::None;
+		}
+		bool IsCancelable() const noexcept override { return true; }
+		int Checks() const noexcept { return checks_.load(); }
+
+	private:
+		const int checksLimit_;
+		mutable std::atomic<int> checks_{0};
+	};
+
+	Error err = rt.reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled(false));
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	constexpr int kItemsCount = 20000;
+	for (int i = 0; i < kItemsCount; ++i) {
+		Item item(rt.reindexer->NewItem(default_namespace));
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON("{\"id\":" + std::to_string(i) + ",\"value\":" + std::to_string(i) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	// Non-indexed condition is checked for each row by the select loop
+	const Query q = Query(default_namespace).Where("value", CondGe, 0).BestEffort();
+	ChecksDeadlineContext noDeadline(std::numeric_limits<int>::max());
+	QueryResults qr;
+	err = rt.reindexer->WithContext(&noDeadline).Select(q, qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), kItemsCount);
+	ASSERT_FALSE(qr.incomplete);
+	ASSERT_GT(noDeadline.Checks(), 4);
+
+	// Deadline is exceeded in the middle of the loop
+	ChecksDeadlineContext deadline(noDeadline.Checks() / 2);
+	qr.Clear();
+	err = rt.reindexer->WithContext(&deadline).Select(q, qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_TRUE(qr.incomplete);
+	ASSERT_GT(qr.Count(), 0);
+	ASSERT_LT(qr.Count(), kItemsCount);
+
+	// Query without best-effort mode fails
+	ChecksDeadlineContext strictDeadline(noDeadline.Checks() / 2);
+	qr.Clear();
+	err = rt.reindexer->WithContext(&strictDeadline).Select(Query(q).BestEffort(false), qr);
+	ASSERT_EQ(err.code(), errTimeout);
+}
+
 template <CollateMode collateMode>
 struct CollateComparer {
 	bool operator()(const string& lhs, const string& rhs) const {
@@ -1677,3 +1734,43 @@ TEST_F(ReindexerApi, EmptyJSONParsing) {
 	err = item.FromJSON(" ");
 	EXPECT_EQ(err.code(), errParseJson);
 }
+
+TEST_F(ReindexerApi, FuzzyIndexParallelBuildAndMerge) {
+	// Fuzzy index, which is built and searched by several threads, has to return the same results as the single threaded one
+	const std::vector<std::string> kWords{"terminator", "termination", "terminal", "determine", "term", "matrix", "animal"};
+	const std::vector<std::pair<std::string, std::string>> kNamespaces{{"fuzzy_single", R"({"build_workers":0,"select_workers":0})"},
+																		{"fuzzy_parallel", R"({"build_workers":4,"select_workers":4})"}};
+	constexpr int kItemsCount = 20000;
+	for (const auto& ns : kNamespaces) {
+		auto err = rt.reindexer->OpenNamespace(ns.first, StorageOpts().Enabled(false));
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->AddIndex(ns.first, {"id", "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->AddIndex(ns.first, {"text", "fuzzytext", "string", IndexOpts().SetConfig(ns.second)});
+		ASSERT_TRUE(err.ok()) << err.what();
+		for (int i = 0; i < kItemsCount; ++i) {
+			Item item = NewItem(ns.first);
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			item["id"] = i;
+			item["text"] = kWords[i % kWords.size()] + " " + kWords[(i / kWords.size()) % kWords.size()] + " " + std::to_string(i % 100);
+			Upsert(ns.first, item);
+		}
+		err = Commit(ns.first);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	const auto select = [&](const std::string& ns, const std::string& text) {
+		QueryResults qr;
+		auto err = rt.reindexer->Select(Query(ns).Where("text", CondEq, text), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::vector<std::pair<int, int>> res;
+		for (auto it : qr) res.emplace_back(it.GetItemRef().Proc(), it.GetItem(false)["id"].As<int>());
+		std::sort(res.begin(), res.end());
+		return res;
+	};
+	for (const std::string text : {"terminator", "term matrix", "animl", "determinal 42"}) {
+		const auto expected = select(kNamespaces[0].first, text);
+		EXPECT_FALSE(expected.empty()) << text;
+		EXPECT_EQ(select(kNamespaces[1].first, text), expected) << text;
+	}
+}
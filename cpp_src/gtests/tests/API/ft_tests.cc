@@ -1,7 +1,9 @@
 #include <gtest/gtest-param-test.h>
+#include <algorithm>
 #include <condition_variable>
 #include <iostream>
 #include <limits>
+#include <random>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -855,6 +857,27 @@ TEST_P(FTApi, SelectTranslitWithComma) {
 	EXPECT_EQ(item["ft1"].As<string>(), "!матэ!");
 }
 
+TEST_P(FTApi, VariantsCacheInvalidation) {
+	// Expanded variants of the terms are cached, but they always have to match the actual config
+	auto ftCfg = GetDefaultConfig();
+	Init(ftCfg);
+	Add("nm1"sv, "хлебопечка"sv, ""sv);
+
+	const auto check = [&](size_t expected) {
+		for (int i = 0; i < 3; ++i) {
+			auto qr = SimpleSelect("@ft1 [kt,jgtxrf");
+			EXPECT_EQ(qr.Count(), expected);
+		}
+	};
+	check(1);
+	ftCfg.enableKbLayout = false;
+	SetFTConfig(ftCfg);
+	check(0);
+	ftCfg.enableKbLayout = true;
+	SetFTConfig(ftCfg);
+	check(1);
+}
+
 TEST_P(FTApi, SelectMultiwordSynonyms) {
 	auto ftCfg = GetDefaultConfig();
 	ftCfg.synonyms = {{{"whole world", "UN", "United Nations"},
@@ -1237,6 +1260,264 @@ TEST_P(FTApi, SelectFullMatch) {
 	CheckAllPermutations("", {"love"}, "", {{"test", "!love!"}, {"test", "!love! second"}}, true);
 }
 
+TEST_P(FTApi, TopLimitedSelect) {
+	auto ftCfg = GetDefaultConfig();
+	Init(ftCfg);
+
+	// Words with common prefix get different ranks by the match length, words count and position in the field
+	const std::vector<std::string_view> words{"word"sv, "words"sv, "wordy"sv, "wordplay"sv, "wordsmith"sv, "other"sv, "text"sv};
+	std::mt19937 rng(17);
+	for (int i = 0; i < 500; ++i) {
+		std::string ft1, ft2;
+		for (int j = 0, cnt = 1 + rng() % 8; j < cnt; ++j) ft1.append(words[rng() % words.size()]).append(" ");
+		for (int j = 0, cnt = rng() % 4; j < cnt; ++j) ft2.append(words[rng() % words.size()]).append(" ");
+		Add("nm1"sv, ft1, ft2);
+	}
+
+	const auto select = [this](const std::string& dsl, unsigned offset, unsigned limit) {
+		reindexer::QueryResults qr;
+		const auto err = rt.reindexer->Select(reindexer::Query("nm1").Where("ft3", CondEq, dsl).Offset(offset).Limit(limit), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::vector<std::pair<int, int>> res;
+		for (auto it : qr) res.emplace_back(it.GetItemRef().Proc(), it.GetItem(false)["id"].As<int>());
+		return res;
+	};
+	for (const std::string dsl : {"word*", "wordy", "word* other", "word* +text", "*ord* -other", "wordsmit~"}) {
+		const auto all = select(dsl, 0, UINT_MAX);
+		ASSERT_FALSE(all.empty()) << dsl;
+		for (unsigned offset : {0u, 3u}) {
+			for (unsigned limit : {1u, 5u, 20u, 1000u}) {
+				const auto top = select(dsl, offset, limit);
+				const size_t expectedSize = std::min<size_t>(limit, all.size() > offset ? all.size() - offset : 0);
+				ASSERT_EQ(top.size(), expectedSize) << dsl << "; offset: " << offset << "; limit: " << limit;
+				for (size_t i = 0; i < top.size(); ++i) {
+					// The same ranked documents may be returned in different order
+					ASSERT_EQ(top[i].first, all[offset + i].first) << dsl << "; offset: " << offset << "; limit: " << limit << "; i: " << i;
+				}
+			}
+		}
+	}
+}
+
+TEST_P(FTApi, TopLimitedHighlight) {
+	auto ftCfg = GetDefaultConfig();
+	Init(ftCfg);
+
+	const std::vector<std::string_view> words{"word"sv, "words"sv, "wordy"sv, "other"sv, "text"sv};
+	std::mt19937 rng(19);
+	for (int i = 0; i < 300; ++i) {
+		std::string ft1, ft2;
+		for (int j = 0, cnt = 1 + rng() % 6; j < cnt; ++j) ft1.append(words[rng() % words.size()]).append(" ");
+		for (int j = 0, cnt = rng() % 4; j < cnt; ++j) ft2.append(words[rng() % words.size()]).append(" ");
+		Add("nm1"sv, ft1, ft2);
+	}
+
+	// Areas of the limited query are collected only for the returned documents, but highlight has to be the same as without limit
+	const auto select = [this](const std::string& dsl, unsigned offset, unsigned limit) {
+		reindexer::QueryResults qr;
+		auto q = reindexer::Query("nm1").Where("ft3", CondEq, dsl).Offset(offset).Limit(limit);
+		q.AddFunction("ft3 = highlight(!,!)");
+		const auto err = rt.reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::vector<std::pair<int, std::string>> res;
+		for (auto it : qr) {
+			auto item = it.GetItem(false);
+			res.emplace_back(item["id"].As<int>(), item["ft1"].As<std::string>() + "|" + item["ft2"].As<std::string>());
+		}
+		return res;
+	};
+	for (const std::string dsl : {"word*", "wordy", "word* other", "word* +text", "\"word other\"~3"}) {
+		const auto all = select(dsl, 0, UINT_MAX);
+		ASSERT_FALSE(all.empty()) << dsl;
+		std::unordered_map<int, std::string> expected(all.begin(), all.end());
+		for (unsigned offset : {0u, 4u}) {
+			const auto top = select(dsl, offset, 10);
+			ASSERT_EQ(top.size(), std::min<size_t>(10, all.size() > offset ? all.size() - offset : 0)) << dsl << "; offset: " << offset;
+			for (const auto& r : top) {
+				ASSERT_EQ(r.second, expected[r.first]) << dsl << "; offset: " << offset << "; id: " << r.first;
+			}
+		}
+	}
+}
+
+TEST_P(FTApi, ParallelSelect) {
+	auto ftCfg = GetDefaultConfig();
+	ftCfg.maxTypos = 4;
+	Init(ftCfg);
+
+	const std::vector<std::string_view> words{"word"sv, "words"sv, "wordy"sv, "world"sv, "sword"sv, "other"sv, "otter"sv, "text"sv};
+	std::mt19937 rng(23);
+	// Several commits create several steps of the index
+	for (int i = 0; i < 600; ++i) {
+		std::string ft1, ft2;
+		for (int j = 0, cnt = 1 + rng() % 6; j < cnt; ++j) ft1.append(words[rng() % words.size()]).append(" ");
+		for (int j = 0, cnt = rng() % 3; j < cnt; ++j) ft2.append(words[rng() % words.size()]).append(" ");
+		Add("nm1"sv, ft1, ft2);
+		if (i % 200 == 0) SimpleSelect("word");
+	}
+
+	const std::vector<std::string> queries{"word*", "*ord~", "word~ other~", "wor* +text", "word* -otter", "\"word text\"~3", "slovo"};
+	const auto selectAll = [&] {
+		std::vector<std::vector<std::pair<int, int>>> results;
+		for (const auto& q : queries) {
+			reindexer::QueryResults qr;
+			const auto err = rt.reindexer->Select(reindexer::Query("nm1").Where("ft3", CondEq, q), qr);
+			EXPECT_TRUE(err.ok()) << err.what();
+			results.emplace_back();
+			for (auto it : qr) results.back().emplace_back(it.GetItemRef().Proc(), it.GetItem(false)["id"].As<int>());
+			// Index is rebuilt on config update, so the same ranked documents may be returned in different order
+			std::sort(results.back().begin(), results.back().end(), std::greater<std::pair<int, int>>());
+		}
+		return results;
+	};
+	const auto expected = selectAll();
+
+	ftCfg.selectWorkers = 4;
+	ftCfg.parallelVariantsThreshold = 1;
+	ftCfg.parallelMergeThreshold = 1;
+	SetFTConfig(ftCfg);
+	const auto results = selectAll();
+	ASSERT_EQ(results.size(), expected.size());
+	for (size_t i = 0; i < results.size(); ++i) {
+		EXPECT_EQ(results[i], expected[i]) << queries[i];
+	}
+}
+
+TEST_P(FTApi, CompactTypos) {
+	// Compact typos index has to find the same words as typos maps
+	auto ftCfg = GetDefaultConfig();
+	ftCfg.maxTypos = 4;
+	Init(ftCfg);
+
+	const std::vector<std::string_view> words{"карандаш"sv, "каранадаш"sv, "кранадаш"sv, "pencil"sv, "pensil"sv, "pecnil"sv,
+											  "parcel"sv,   "paper"sv,     "pepper"sv,   "pen"sv,    "открытка"sv};
+	std::mt19937 rng(41);
+	for (int i = 0; i < 400; ++i) {
+		std::string ft1, ft2;
+		for (int j = 0, cnt = 1 + rng() % 4; j < cnt; ++j) ft1.append(words[rng() % words.size()]).append(" ");
+		for (int j = 0, cnt = rng() % 3; j < cnt; ++j) ft2.append(words[rng() % words.size()]).append(" ");
+		Add("nm1"sv, ft1, ft2);
+	}
+
+	const std::vector<std::string> queries{"pencil~", "penci~", "папер~", "карандш~", "pappr~ +pen", "открыт~ -pencil", "zzzzz~"};
+	const auto selectAll = [&] {
+		std::vector<std::vector<std::pair<int, int>>> results;
+		for (const auto& q : queries) {
+			reindexer::QueryResults qr;
+			const auto err = rt.reindexer->Select(reindexer::Query("nm1").Where("ft3", CondEq, q), qr);
+			EXPECT_TRUE(err.ok()) << err.what();
+			results.emplace_back();
+			for (auto it : qr) results.back().emplace_back(it.GetItemRef().Proc(), it.GetItem(false)["id"].As<int>());
+			std::sort(results.back().begin(), results.back().end(), std::greater<std::pair<int, int>>());
+		}
+		return results;
+	};
+	const auto expected = selectAll();
+
+	ftCfg.compactTypos = true;
+	SetFTConfig(ftCfg);
+	const auto results = selectAll();
+	ASSERT_EQ(results.size(), expected.size());
+	for (size_t i = 0; i < results.size(); ++i) {
+		EXPECT_EQ(results[i], expected[i]) << queries[i];
+	}
+	EXPECT_FALSE(results[0].empty());
+}
+
+TEST_P(FTApi, BackgroundCommit) {
+	// Fulltext index has to be built by the namespace's background optimization without any selects
+	auto ftCfg = GetDefaultConfig();
+	ftCfg.maxTypos = 0;
+	Init(ftCfg);
+	auto err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	reindexer::Item config = rt.reindexer->NewItem("#config");
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	err = config.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "optimization_timeout_ms":10}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->Upsert("#config", config);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	const auto awaitOptimization = [&] {
+		for (int i = 0;; ++i) {
+			ASSERT_LT(i, 200) << "Fulltext index was not built in background";
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			reindexer::QueryResults qr;
+			err = rt.reindexer->Select(reindexer::Query("#memstats").Where("name", CondEq, "nm1"), qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			ASSERT_EQ(qr.Count(), 1);
+			if (qr[0].GetItem(false)["optimization_completed"].Get<bool>()) break;
+		}
+	};
+	for (int i = 0; i < 300; ++i) {
+		Add("nm1"sv, "word" + std::to_string(i % 10), "text");
+	}
+	awaitOptimization();
+	auto res = SimpleSelect("word3");
+	EXPECT_EQ(res.Count(), 30);
+
+	// Several incremental steps and deletion
+	for (int i = 0; i < 200; ++i) {
+		Add("nm1"sv, "other" + std::to_string(i % 10), "text");
+	}
+	reindexer::QueryResults qr;
+	err = rt.reindexer->Delete(reindexer::Query("nm1").Where("ft1", CondEq, "word3"), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	awaitOptimization();
+	res = SimpleSelect("word3");
+	EXPECT_EQ(res.Count(), 0);
+	res = SimpleSelect("other5");
+	EXPECT_EQ(res.Count(), 20);
+}
+
+TEST_P(FTApi, IncrementalCacheInvalidation) {
+	// Cached results may be kept on index update, but they always have to be actual
+	auto ftCfg = GetDefaultConfig();
+	ftCfg.incrementalCacheInvalidation = true;
+	Init(ftCfg);
+	for (int i = 0; i < 100; ++i) {
+		Add("nm1"sv, "word" + std::to_string(i % 10), "text");
+	}
+	const auto check = [&](const std::string& query, size_t expected) {
+		// Second select puts the results into cache and the third one gets them from cache
+		for (int i = 0; i < 3; ++i) {
+			auto res = SimpleSelect(query);
+			EXPECT_EQ(res.Count(), expected) << query;
+		}
+	};
+	check("word3", 10);
+	check("wrd3~", 10);
+	// Equivalent query shares the cached results
+	check("  WORD3 ", 10);
+
+	// Documents, which can not be found by the queries
+	for (int i = 0; i < 10; ++i) {
+		Add("nm1"sv, "other", "text");
+	}
+	check("word3", 10);
+	check("wrd3~", 10);
+
+	// Documents, which are found by the term or by the typo
+	Add("nm1"sv, "word3", "text");
+	Add("nm1"sv, "wird3", "text");
+	check("word3", 11);
+	check("wrd3~", 12);
+
+	reindexer::QueryResults qr;
+	auto err = rt.reindexer->Delete(reindexer::Query("nm1").Where("ft1", CondEq, "wird3"), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	check("wrd3~", 11);
+	qr.Clear();
+	err = rt.reindexer->Delete(reindexer::Query("nm1").Where("ft1", CondEq, "word3"), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	check("word3", 0);
+	check("wrd3~", 0);
+	check("other", 10);
+}
+
 TEST_P(FTApi, SetFtFieldsCfgErrors) {
 	auto cfg = GetDefaultConfig(2);
 	Init(cfg);
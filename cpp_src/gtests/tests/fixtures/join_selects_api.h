@@ -328,6 +328,30 @@ protected:
 		ASSERT_TRUE(err.ok()) << err.what();
 	}
 
+	void SetQueryResultsCacheSize(const string& nsName, int64_t size) {
+		reindexer::WrSerializer ser;
+		reindexer::JsonBuilder jb(ser);
+
+		jb.Put("type", "namespaces");
+		auto nsArray = jb.Array("namespaces");
+		auto ns = nsArray.Object();
+		ns.Put("namespace", nsName.c_str());
+		ns.Put("query_results_cache_size", size);
+		ns.End();
+		nsArray.End();
+		jb.End();
+
+		auto item = rt.NewItem(config_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+
+		auto err = item.FromJSON(ser.Slice());
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		rt.Upsert(config_namespace, item);
+		err = rt.Commit(config_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
 	void CheckJoinsInComplexWhereCondition(const QueryResults& qr) {
 		for (auto it : qr) {
 			Item item = it.GetItem(false);
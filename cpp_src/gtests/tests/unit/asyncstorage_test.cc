@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "core/namespace/asyncstorage.h"
+#include "core/namespace/namespacestat.h"
+#include "tools/fsops.h"
+
+using reindexer::AsyncStorage;
+using reindexer::Error;
+
+TEST(AsyncStorage, GroupCommit) {
+	const std::string kDir = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "AsyncStorageGroupCommitTest");
+	constexpr uint32_t kDeadlineMs = 1000;
+	constexpr uint32_t kSizeBudget = 100;
+	reindexer::fs::RmDirAll(kDir);
+
+	AsyncStorage storage;
+	Error err = storage.Open(reindexer::datastorage::StorageType::LevelDB, "ns", kDir, StorageOpts().Enabled().CreateIfMissing());
+	ASSERT_TRUE(err.ok()) << err.what();
+	storage.SetGroupCommitPolicy(kDeadlineMs, kSizeBudget);
+	auto isFlushed = [&storage](int key) {
+		std::string value;
+		return storage.Read(StorageOpts(), std::to_string(key), value).ok();
+	};
+
+	// Updates are accumulated until the deadline
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < 10; ++i) storage.Write(std::to_string(i), "value");
+	storage.FlushIfDue();
+	if (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(kDeadlineMs)) {
+		ASSERT_FALSE(isFlushed(0));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(kDeadlineMs + 100));
+	storage.FlushIfDue();
+	ASSERT_TRUE(isFlushed(0));
+	ASSERT_TRUE(isFlushed(9));
+
+	// Size budget triggers flush before the deadline
+	for (uint32_t i = 0; i < kSizeBudget; ++i) storage.Write(std::to_string(1000 + i), "value");
+	storage.FlushIfDue();
+	ASSERT_TRUE(isFlushed(1000 + kSizeBudget - 1));
+
+	// Close flushes all of the pending updates
+	storage.Write("closed", "value");
+	storage.Close();
+	err = storage.Open(reindexer::datastorage::StorageType::LevelDB, "ns", kDir, StorageOpts().Enabled());
+	ASSERT_TRUE(err.ok()) << err.what();
+	std::string value;
+	err = storage.Read(StorageOpts(), "closed", value);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(value, "value");
+
+	storage.Close();
+	reindexer::fs::RmDirAll(kDir);
+}
+
+TEST(AsyncStorage, FlushPolicyAndStats) {
+	const std::string kDir = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "AsyncStorageFlushPolicyTest");
+	constexpr uint64_t kBytesLimit = 10000;
+	const std::string kValue(1000, 'x');
+	reindexer::fs::RmDirAll(kDir);
+
+	AsyncStorage storage;
+	Error err = storage.Open(reindexer::datastorage::StorageType::LevelDB, "ns", kDir, StorageOpts().Enabled().CreateIfMissing());
+	ASSERT_TRUE(err.ok()) << err.what();
+	storage.SetForceFlushBytesLimit(kBytesLimit);
+	auto isFlushed = [&storage](const std::string& key) {
+		std::string value;
+		return storage.Read(StorageOpts(), key, value).ok();
+	};
+
+	// Updates are not flushed in the writing thread until their size reaches the limit
+	storage.Write("k0", kValue);
+	storage.TryForceFlush();
+	ASSERT_FALSE(isFlushed("k0"));
+	for (int i = 1; i < 10; ++i) storage.Write("k" + std::to_string(i), kValue);
+	storage.TryForceFlush();
+	ASSERT_TRUE(isFlushed("k9"));
+
+	// Without durable mode commit flushes by limits only
+	storage.Write("tx1", "value");
+	storage.FlushOnCommit();
+	ASSERT_FALSE(isFlushed("tx1"));
+
+	// Durable commit flushes all of the pending updates
+	storage.SetDurableCommit(true);
+	storage.Write("tx2", "value");
+	storage.FlushOnCommit();
+	ASSERT_TRUE(isFlushed("tx1"));
+	ASSERT_TRUE(isFlushed("tx2"));
+
+	auto stats = storage.GetFlushPerfStat();
+	ASSERT_EQ(stats.sizeBytes.totalCount, 2);
+	ASSERT_EQ(stats.durationUs.totalCount, 2);
+	ASSERT_EQ(stats.sizeBytes.counts.size(), stats.sizeBytes.bounds.size() + 1);
+	ASSERT_EQ(stats.sizeBytes.sum, 10 * (kValue.size() + 2) + 2 * (3 + 5));
+	// 10KB flush goes to the (4KB, 16KB] bucket, 16 bytes flush goes to the first one
+	ASSERT_EQ(stats.sizeBytes.counts[0], 1);
+	ASSERT_EQ(stats.sizeBytes.counts[1], 1);
+
+	storage.ResetFlushPerfStat();
+	stats = storage.GetFlushPerfStat();
+	ASSERT_EQ(stats.sizeBytes.totalCount, 0);
+	ASSERT_EQ(stats.sizeBytes.sum, 0);
+
+	storage.Close();
+	reindexer::fs::RmDirAll(kDir);
+}
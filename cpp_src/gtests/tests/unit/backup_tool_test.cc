@@ -0,0 +1,104 @@
+#include "cmd/reindexer_tool/backup_tool.h"
+#include "core/reindexer.h"
+#include "gtest/gtest.h"
+#include "tools/fsops.h"
+
+using reindexer::Error;
+using reindexer::Item;
+using reindexer::Query;
+using reindexer::QueryResults;
+using reindexer::Reindexer;
+using reindexer::WrSerializer;
+using reindexer_tool::BackupTool;
+
+class BackupToolTest : public ::testing::TestWithParam<bool> {
+protected:
+	void SetUp() override {
+		reindexer::fs::RmDirAll(kBasePath);
+		dbPath_ = reindexer::fs::JoinPath(kBasePath, "db");
+		restoredDbPath_ = reindexer::fs::JoinPath(kBasePath, "restored");
+		backupPath_ = reindexer::fs::JoinPath(kBasePath, "backup");
+	}
+	void TearDown() override { reindexer::fs::RmDirAll(kBasePath); }
+
+	// JSON of the namespace's items, ordered by the primary key
+	static std::vector<std::string> getItems(Reindexer& rx) {
+		QueryResults qr;
+		Error err = rx.Select(Query(kNs).Sort("id", false), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::vector<std::string> items;
+		for (auto& it : qr) {
+			WrSerializer ser;
+			err = it.GetJSON(ser, false);
+			EXPECT_TRUE(err.ok()) << err.what();
+			items.emplace_back(ser.Slice());
+		}
+		return items;
+	}
+
+	const std::string kBasePath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "BackupToolTest");
+	inline static const std::string kNs = "backup_ns";
+	std::string dbPath_, restoredDbPath_, backupPath_;
+};
+
+TEST_P(BackupToolTest, BackupAndRestore) {
+	constexpr int kItemsCount = 5000;
+	const bool compress = GetParam();
+	std::vector<std::string> sourceItems;
+	{
+		Reindexer rx;
+		Error err = rx.Connect("builtin://" + dbPath_);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.OpenNamespace(kNs);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(kNs, {"id", "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(kNs, {"name", "tree", "string", IndexOpts()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		for (int i = 0; i < kItemsCount; ++i) {
+			Item item = rx.NewItem(kNs);
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			err = item.FromJSON("{\"id\":" + std::to_string(i) + ",\"name\":\"name_" + std::to_string(i % 100) + "\",\"nested\":{\"value\":" +
+								std::to_string(i * 2) + "}}");
+			ASSERT_TRUE(err.ok()) << err.what();
+			err = rx.Upsert(kNs, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+		// Deleted items must not be restored
+		QueryResults delQr;
+		err = rx.Delete(Query(kNs).Where("id", CondLt, 100), delQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.PutMeta(kNs, "meta_key", "meta_value");
+		ASSERT_TRUE(err.ok()) << err.what();
+		sourceItems = getItems(rx);
+		ASSERT_EQ(sourceItems.size(), kItemsCount - 100);
+	}
+
+	Error err = BackupTool::Backup("builtin://" + dbPath_, backupPath_, 2, compress);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = BackupTool::Restore("builtin://" + restoredDbPath_, backupPath_, 2);
+	ASSERT_TRUE(err.ok()) << err.what();
+	// Existing namespaces are not overwritten
+	err = BackupTool::Restore("builtin://" + restoredDbPath_, backupPath_, 2);
+	EXPECT_EQ(err.code(), errConflict) << err.what();
+
+	Reindexer rx;
+	err = rx.Connect("builtin://" + restoredDbPath_);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rx.OpenNamespace(kNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(getItems(rx), sourceItems);
+	std::string meta;
+	err = rx.GetMeta(kNs, "meta_key", meta);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(meta, "meta_value");
+
+	// Indexes are restored too
+	QueryResults qr;
+	err = rx.Select(Query(kNs).Where("name", CondEq, "name_42"), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), kItemsCount / 100 - 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(, BackupToolTest, ::testing::Values(false, true),
+						 [](const ::testing::TestParamInfo<bool>& info) { return info.param ? "Compressed" : "Uncompressed"; });
@@ -0,0 +1,24 @@
+#include "core/index/bloomfilter.h"
+#include "gtest/gtest.h"
+
+using reindexer::BloomFilter;
+
+TEST(BloomFilterTest, HasNoFalseNegatives) {
+	BloomFilter filter;
+	// Filter without allocated blocks may contain any key
+	EXPECT_TRUE(filter.MayContain(1));
+
+	constexpr uint64_t kKeys = 100000;
+	filter.Reset(kKeys);
+	EXPECT_GE(filter.Capacity(), kKeys);
+	// Weak hashes of the sequential integers are mixed by filter
+	for (uint64_t k = 0; k < kKeys; ++k) filter.Add(k);
+	for (uint64_t k = 0; k < kKeys; ++k) ASSERT_TRUE(filter.MayContain(k)) << k;
+
+	size_t falsePositives = 0;
+	for (uint64_t k = kKeys; k < 11 * kKeys; ++k) falsePositives += filter.MayContain(k);
+	EXPECT_LT(double(falsePositives) / (10 * kKeys), 0.01);
+
+	filter.Reset(kKeys);
+	EXPECT_FALSE(filter.MayContain(1));
+}
@@ -0,0 +1,57 @@
+#include "estl/chunk_buf.h"
+#include "gtest/gtest.h"
+#include "tools/serializer.h"
+
+using reindexer::chunk;
+using reindexer::chunk_pool;
+
+TEST(ChunkPoolTest, BuffersAreReusedBySizeClasses) {
+	auto &pool = chunk_pool::instance();
+	pool.clear();
+	ASSERT_EQ(pool.pooled_bytes(), 0u);
+
+	const uint8_t *buf = nullptr;
+	{
+		chunk ch;
+		ch.append(std::string(5000, 'x'));
+		// Size is rounded up to the size class
+		EXPECT_EQ(ch.cap_, 2 * chunk_pool::kMinSize);
+		buf = ch.data_;
+	}
+	EXPECT_EQ(pool.pooled_bytes(), 2 * chunk_pool::kMinSize);
+	{
+		chunk ch;
+		ch.reserve(6000);
+		// Buffer of the same size class is reused
+		EXPECT_EQ(ch.data_, buf);
+		EXPECT_EQ(pool.pooled_bytes(), 0u);
+
+		// Grown buffer is returned into the pool
+		ch.append(std::string(3 * chunk_pool::kMinSize, 'y'));
+		EXPECT_EQ(ch.cap_, 4 * chunk_pool::kMinSize);
+		EXPECT_EQ(pool.pooled_bytes(), 2 * chunk_pool::kMinSize);
+		EXPECT_EQ(std::string_view(reinterpret_cast<const char *>(ch.data()), ch.size()), std::string(3 * chunk_pool::kMinSize, 'y'));
+	}
+	EXPECT_EQ(pool.pooled_bytes(), 6 * chunk_pool::kMinSize);
+
+	// Buffers larger, than the largest size class, and the buffers of the other sizes are not pooled
+	{
+		chunk ch;
+		ch.reserve(chunk_pool::kMaxSize + 1);
+		EXPECT_EQ(ch.cap_, chunk_pool::kMaxSize + 1);
+		reindexer::WrSerializer ser;
+		ser.Write(std::string(100, 'z'));
+		// Data of the serializer's inline buffer is copied into the pooled buffer
+		chunk fromSer = ser.DetachChunk();
+		EXPECT_EQ(fromSer.cap_, chunk_pool::kMinSize);
+		reindexer::WrSerializer largeSer;
+		largeSer.Write(std::string(5000, 'z'));
+		// Buffer of the serializer is taken as is
+		chunk fromLargeSer = largeSer.DetachChunk();
+		EXPECT_EQ(fromLargeSer.size(), 5000u);
+	}
+	EXPECT_EQ(pool.pooled_bytes(), 7 * chunk_pool::kMinSize);
+
+	pool.clear();
+	EXPECT_EQ(pool.pooled_bytes(), 0u);
+}
@@ -0,0 +1,21 @@
+#include "client/latencytracker.h"
+#include "gtest/gtest.h"
+
+using reindexer::client::LatencyTracker;
+using std::chrono::microseconds;
+
+TEST(ClientLatencyTrackerTest, PercentileOfRecentRequests) {
+	LatencyTracker tracker;
+	// Percentile is not estimated by the few samples
+	for (size_t i = 1; i < LatencyTracker::kMinSamples; ++i) tracker.Add(microseconds(i));
+	EXPECT_EQ(tracker.Percentile(0.95).count(), 0);
+
+	tracker.Add(microseconds(LatencyTracker::kMinSamples));
+	EXPECT_EQ(tracker.Percentile(0.5).count(), int64_t(LatencyTracker::kMinSamples / 2 + 1));
+	EXPECT_EQ(tracker.Percentile(0.99).count(), int64_t(LatencyTracker::kMinSamples));
+
+	// Only the last requests of the window are taken into account
+	for (size_t i = 0; i < LatencyTracker::kWindowSize; ++i) tracker.Add(microseconds(i < LatencyTracker::kWindowSize / 10 ? 1000 : 10));
+	EXPECT_EQ(tracker.Percentile(0.5).count(), 10);
+	EXPECT_EQ(tracker.Percentile(0.95).count(), 1000);
+}
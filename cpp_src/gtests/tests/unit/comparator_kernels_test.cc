@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "core/comparatorkernels.h"
+
+using reindexer::CompareBlock;
+
+template <typename T>
+static bool compareRef(CondType cond, T v, T rhs1, T rhs2) {
+	switch (cond) {
+		case CondEq:
+			return v == rhs1;
+		case CondLt:
+			return v < rhs1;
+		case CondLe:
+			return v <= rhs1;
+		case CondGt:
+			return v > rhs1;
+		case CondGe:
+			return v >= rhs1;
+		case CondRange:
+			return v >= rhs1 && v <= rhs2;
+		default:
+			abort();
+	}
+}
+
+template <typename T>
+static void checkKernels(const std::vector<T>& values, T rhs1, T rhs2) {
+	// Sizes include empty block, partial vectors and partial mask words
+	for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(63), size_t(64), size_t(65), size_t(200), values.size()}) {
+		for (CondType cond : {CondEq, CondLt, CondLe, CondGt, CondGe, CondRange}) {
+			ASSERT_TRUE(reindexer::IsBlockComparableCond(cond));
+			std::vector<uint64_t> mask((count + 63) / 64, ~uint64_t(0));
+			CompareBlock(cond, values.data(), count, rhs1, rhs2, mask.data());
+			for (size_t i = 0; i < count; ++i) {
+				const bool bit = (mask[i / 64] >> (i % 64)) & 1;
+				ASSERT_EQ(bit, compareRef(cond, values[i], rhs1, rhs2))
+					<< "cond: " << cond << "; i: " << i << "; count: " << count << "; kernels: " << reindexer::CompareBlockKernelsName();
+			}
+			// Bits after the last value must be cleared
+			if (count % 64) {
+				ASSERT_EQ(mask.back() >> (count % 64), 0u);
+			}
+		}
+	}
+}
+
+TEST(ComparatorKernels, IntegerValues) {
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> dist(-50, 50);
+	std::vector<int> ints(1000);
+	std::vector<int64_t> ints64(1000);
+	for (size_t i = 0; i < ints.size(); ++i) {
+		ints[i] = dist(rng);
+		// Values out of int32 range check 64-bit lanes comparison
+		ints64[i] = int64_t(dist(rng)) * (int64_t(1) << 33);
+	}
+	ints[3] = std::numeric_limits<int>::min();
+	ints[4] = std::numeric_limits<int>::max();
+	checkKernels<int>(ints, -10, 10);
+	checkKernels<int>(ints, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+	checkKernels<int64_t>(ints64, -(int64_t(10) << 33), int64_t(10) << 33);
+}
+
+TEST(ComparatorKernels, DoubleValues) {
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<double> dist(-100.0, 100.0);
+	std::vector<double> doubles(1000);
+	for (auto& v : doubles) v = std::round(dist(rng));
+	// NaN never satisfies condition
+	doubles[5] = std::numeric_limits<double>::quiet_NaN();
+	doubles[70] = std::numeric_limits<double>::infinity();
+	doubles[71] = -std::numeric_limits<double>::infinity();
+	checkKernels<double>(doubles, -12.0, 12.0);
+	checkKernels<double>(doubles, 0.0, 0.0);
+}
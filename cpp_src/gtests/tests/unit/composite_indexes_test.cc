@@ -1,4 +1,5 @@
 #include "composite_indexes_api.h"
+#include "tools/fsops.h"
 
 TEST_F(CompositeIndexesApi, CompositeIndexesAddTest) {
 	addCompositeIndex({kFieldNameBookid, kFieldNameBookid2}, CompositeIndexHash, IndexOpts().PK());
@@ -186,3 +187,61 @@ TEST_F(CompositeIndexesApi, CompositeIndexesSelectTest) {
 
 	execAndCompareQuery(Query(default_namespace));
 }
+
+TEST_F(CompositeIndexesApi, CompositeIndexesLoadFromStorage) {
+	const std::string kDir = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "CompositeIndexesLoadTest");
+	const std::string kDsn = "builtin://" + kDir;
+	// Items are inserted into the indexes by the several batches during the loading
+	constexpr int kItemsCount = 5000;
+	reindexer::fs::RmDirAll(kDir);
+
+	auto connect = [&] {
+		rt.reindexer.reset(new Reindexer);
+		Error err = rt.reindexer->Connect(kDsn);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled());
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	auto checkCount = [&](const string& indexName, int v1, int v2, size_t expected) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query(default_namespace).WhereComposite(indexName, CondEq, {{Variant(v1), Variant(v2)}}), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), expected) << indexName << ": " << v1 << ", " << v2;
+	};
+
+	connect();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{kFieldNameBookid, "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{kFieldNameBookid2, "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{kFieldNameTitle, "text", "string", IndexOpts(), 0},
+											   IndexDeclaration{kFieldNamePages, "hash", "int", IndexOpts(), 0},
+											   IndexDeclaration{kFieldNamePrice, "hash", "int", IndexOpts(), 0},
+											   IndexDeclaration{kFieldNameName, "hash", "string", IndexOpts(), 0}});
+	const string hashIndexName = getCompositeIndexName({kFieldNamePrice, kFieldNamePages});
+	const string treeIndexName = getCompositeIndexName({kFieldNameBookid2, kFieldNamePrice});
+	addCompositeIndex({kFieldNamePrice, kFieldNamePages}, CompositeIndexHash, IndexOpts());
+	addCompositeIndex({kFieldNameBookid2, kFieldNamePrice}, CompositeIndexBTree, IndexOpts());
+	for (int i = 0; i < kItemsCount; ++i) {
+		addOneRow(i, i % 100, kFieldNameTitle + std::to_string(i), i % 7, i % 13, kFieldNameName);
+	}
+
+	connect();
+	QueryResults qr;
+	Error err = rt.reindexer->Select(Query(default_namespace), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), size_t(kItemsCount));
+	for (int price = 0; price < 13; price += 4) {
+		for (int pages = 0; pages < 7; pages += 3) {
+			size_t expected = 0;
+			for (int i = 0; i < kItemsCount; ++i) expected += (i % 13 == price && i % 7 == pages);
+			checkCount(hashIndexName, price, pages, expected);
+		}
+		for (int bookid2 = 0; bookid2 < 100; bookid2 += 33) {
+			size_t expected = 0;
+			for (int i = 0; i < kItemsCount; ++i) expected += (i % 100 == bookid2 && i % 13 == price);
+			checkCount(treeIndexName, bookid2, price, expected);
+		}
+	}
+
+	rt.reindexer.reset();
+	reindexer::fs::RmDirAll(kDir);
+}
@@ -353,3 +353,44 @@ TEST(Coroutines, SchedulingOrder) {
 		ASSERT_TRUE(false);
 	}
 }
+
+TEST(Coroutines, StacksPooling) {
+	// Stacks of the finished coroutines should be reused by the new coroutines of the same size class
+	using reindexer::coroutine::get_stats;
+	constexpr size_t kCoroCount = 10;
+	constexpr size_t kStackSize = 100 * 1024;
+	constexpr size_t kLargeStackSize = 8 * 1024 * 1024;
+	auto runCoroutines = [](size_t stackSize) {
+		dynamic_loop loop;
+		for (size_t i = 0; i < kCoroCount; ++i) {
+			loop.spawn([&loop] { loop.sleep(milliseconds(1)); }, stackSize);
+		}
+		loop.run();
+	};
+
+	const auto initial = get_stats();
+	runCoroutines(kStackSize);
+	const auto afterFirstRun = get_stats();
+	ASSERT_EQ(afterFirstRun.live_routines, initial.live_routines);
+	ASSERT_GE(afterFirstRun.live_routines_peak, initial.live_routines + kCoroCount);
+	ASSERT_GE(afterFirstRun.pooled_stacks, kCoroCount);
+	ASSERT_GE(afterFirstRun.stacks_size_peak, kCoroCount * kStackSize);
+
+	runCoroutines(kStackSize);
+	const auto afterSecondRun = get_stats();
+	ASSERT_EQ(afterSecondRun.stacks, afterFirstRun.stacks);
+	ASSERT_EQ(afterSecondRun.pooled_stacks, afterFirstRun.pooled_stacks);
+	ASSERT_EQ(afterSecondRun.stacks_size, afterFirstRun.stacks_size);
+
+	// Stacks larger, than the largest size class, are not pooled
+	runCoroutines(kLargeStackSize);
+	const auto afterLargeRun = get_stats();
+	ASSERT_EQ(afterLargeRun.stacks, afterSecondRun.stacks);
+	ASSERT_EQ(afterLargeRun.stacks_size, afterSecondRun.stacks_size);
+	ASSERT_GE(afterLargeRun.stacks_size_peak, afterSecondRun.stacks_size + kCoroCount * kLargeStackSize);
+
+	reindexer::coroutine::shrink_storage();
+	const auto afterShrink = get_stats();
+	ASSERT_LE(afterShrink.pooled_stacks + kCoroCount, afterLargeRun.pooled_stacks);
+	ASSERT_LE(afterShrink.stacks_size + kCoroCount * kStackSize, afterLargeRun.stacks_size);
+}
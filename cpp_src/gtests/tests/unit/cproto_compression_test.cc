@@ -0,0 +1,60 @@
+#include <random>
+#include <string>
+#include "gtest/gtest.h"
+#include "net/cproto/compressor.h"
+
+using reindexer::net::cproto::AdaptiveCompressor;
+
+namespace {
+
+std::string randomData(size_t len) {
+	std::mt19937 gen(len);
+	std::string data(len, ' ');
+	for (auto &c : data) c = char(gen());
+	return data;
+}
+
+}  // namespace
+
+TEST(CprotoCompressionTest, CompressesOnlyLargeCompressibleMessages) {
+	AdaptiveCompressor compressor;
+	std::string out;
+
+	// Small messages are sent as is
+	const std::string small(AdaptiveCompressor::kMinCompressSize - 1, 'a');
+	EXPECT_FALSE(compressor.Compress(small, out));
+	// Forced compression ignores the threshold
+	EXPECT_TRUE(compressor.Compress(small, out, true));
+
+	const std::string large(AdaptiveCompressor::kMinCompressSize * 8, 'a');
+	ASSERT_TRUE(compressor.Compress(large, out));
+	EXPECT_LT(out.size(), large.size());
+
+	auto stats = compressor.TakeStats();
+	EXPECT_EQ(stats.rawBytes, int64_t(2 * small.size() + large.size()));
+	EXPECT_LT(stats.sentBytes, stats.rawBytes);
+	stats = compressor.TakeStats();
+	EXPECT_EQ(stats.rawBytes, 0);
+	EXPECT_EQ(stats.sentBytes, 0);
+}
+
+TEST(CprotoCompressionTest, SuspendsCompressionOnPoorRatio) {
+	AdaptiveCompressor compressor;
+	std::string out;
+	const std::string incompressible = randomData(AdaptiveCompressor::kMinCompressSize * 8);
+	const std::string compressible(incompressible.size(), 'a');
+
+	EXPECT_FALSE(compressor.Compress(incompressible, out));
+	// Compression is not even tried for the next messages, so the compressible ones are sent as is too
+	for (unsigned i = 0; i < AdaptiveCompressor::kSkipAfterPoorRatio; ++i) {
+		out.clear();
+		EXPECT_FALSE(compressor.Compress(compressible, out)) << i;
+		EXPECT_TRUE(out.empty());
+	}
+	// Ratio is sampled again after the pause
+	EXPECT_TRUE(compressor.Compress(compressible, out));
+
+	const auto stats = compressor.TakeStats();
+	EXPECT_EQ(stats.rawBytes, int64_t(incompressible.size() * (AdaptiveCompressor::kSkipAfterPoorRatio + 2)));
+	EXPECT_EQ(stats.sentBytes, int64_t(incompressible.size() * (AdaptiveCompressor::kSkipAfterPoorRatio + 1) + out.size()));
+}
@@ -0,0 +1,139 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "net/cproto/serverconnection.h"
+
+using namespace reindexer::net;
+using reindexer::Error;
+
+namespace {
+
+class Handlers {
+public:
+	Error Slow(cproto::Context &ctx) {
+		EXPECT_EQ(std::this_thread::get_id(), loopThread);
+		// Query is executed by the executor, while the connection's thread handles the next calls
+		ctx.Await([this] {
+			EXPECT_NE(std::this_thread::get_id(), loopThread);
+			EXPECT_EQ(fastReceived.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+		});
+		EXPECT_EQ(std::this_thread::get_id(), loopThread);
+		slowCompleted = true;
+		static std::string_view data = "slow";
+		ctx.Return({cproto::Arg(reindexer::p_string(&data))});
+		return errOK;
+	}
+	Error Fast(cproto::Context &) {
+		EXPECT_EQ(std::this_thread::get_id(), loopThread);
+		return errOK;
+	}
+	Error Failed(cproto::Context &ctx) {
+		// Exception of the awaited task is rethrown in the call's coroutine
+		try {
+			ctx.Await([] { throw Error(errLogic, "failed"); });
+		} catch (const Error &err) {
+			return err;
+		}
+		return errOK;
+	}
+	Error Sequential(cproto::Context &) {
+		EXPECT_TRUE(slowCompleted);
+		return errOK;
+	}
+
+	const std::thread::id loopThread = std::this_thread::get_id();
+	std::promise<void> fastReceived;
+	bool slowCompleted = false;
+};
+
+void putRequest(reindexer::WrSerializer &ser, cproto::CmdCode cmd, uint32_t seq) {
+	reindexer::WrSerializer args;
+	cproto::Args().Pack(args);
+	cproto::CProtoHeader hdr;
+	hdr.magic = cproto::kCprotoMagic;
+	hdr.version = cproto::kCprotoVersion;
+	hdr.compressed = 0;
+	hdr._reserved = 0;
+	hdr.cmd = cmd;
+	hdr.len = args.Len();
+	hdr.seq = seq;
+	ser.Write(std::string_view(reinterpret_cast<char *>(&hdr), sizeof(hdr)));
+	ser.Write(args.Slice());
+}
+
+}  // namespace
+
+TEST(CprotoCoroutineCallsTest, SuspendedCallDoesNotBlockConnection) {
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	for (int fd : fds) ASSERT_EQ(fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK), 0);
+
+	Handlers handlers;
+	cproto::CallsExecutor executor(1);
+	cproto::Dispatcher dispatcher;
+	dispatcher.Register(cproto::kCmdSelect, &handlers, &Handlers::Slow);
+	dispatcher.Register(cproto::kCmdPing, &handlers, &Handlers::Fast);
+	dispatcher.Register(cproto::kCmdGetMeta, &handlers, &Handlers::Failed);
+	dispatcher.Register(cproto::kCmdCommit, &handlers, &Handlers::Sequential);
+	dispatcher.AllowParallel(cproto::kCmdSelect);
+	dispatcher.AllowParallel(cproto::kCmdPing);
+	dispatcher.AllowParallel(cproto::kCmdGetMeta);
+	dispatcher.SetExecutor(&executor);
+	dispatcher.EnableCoroutines(true);
+
+	ev::dynamic_loop loop;
+	{
+		cproto::ServerConnection conn(fds[0], loop, dispatcher, false, 0);
+
+		reindexer::WrSerializer requests;
+		putRequest(requests, cproto::kCmdSelect, 1);
+		putRequest(requests, cproto::kCmdPing, 2);
+		putRequest(requests, cproto::kCmdCommit, 3);
+		putRequest(requests, cproto::kCmdGetMeta, 4);
+		ASSERT_EQ(write(fds[1], requests.Buf(), requests.Len()), ssize_t(requests.Len()));
+
+		std::vector<uint32_t> seqs;
+		std::string received;
+		ev::io client;
+		client.set(loop);
+		client.set([&](ev::io &w, int) {
+			char buf[1024];
+			ssize_t n;
+			while ((n = read(w.fd, buf, sizeof(buf))) > 0) received.append(buf, n);
+			while (received.size() >= sizeof(cproto::CProtoHeader)) {
+				const auto hdr = *reinterpret_cast<const cproto::CProtoHeader *>(received.data());
+				if (received.size() < sizeof(hdr) + hdr.len) break;
+				reindexer::Serializer ser(received.data() + sizeof(hdr), hdr.len);
+				EXPECT_EQ(ser.GetVarUint(), uint64_t(hdr.seq == 4 ? errLogic : errOK)) << hdr.seq;
+				ser.GetVString();
+				cproto::Args args;
+				args.Unpack(ser);
+				if (hdr.seq == 1) {
+					EXPECT_EQ(args.size(), 1u);
+				} else if (hdr.seq == 2) {
+					handlers.fastReceived.set_value();
+				}
+				seqs.emplace_back(hdr.seq);
+				received.erase(0, sizeof(hdr) + hdr.len);
+			}
+			if (seqs.size() == 4) loop.break_loop();
+		});
+		client.start(fds[1], ev::READ);
+		ev::timer deadline;
+		deadline.set(loop);
+		deadline.set([&](ev::timer &, int) { loop.break_loop(); });
+		deadline.start(10.0);
+
+		loop.run();
+		// Fast call is answered while the slow one is suspended. Sequential call waits for both of them
+		EXPECT_EQ(seqs, (std::vector<uint32_t>{2, 1, 3, 4}));
+		client.stop();
+		deadline.stop();
+	}
+	close(fds[1]);
+}
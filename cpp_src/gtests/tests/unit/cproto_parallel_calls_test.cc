@@ -0,0 +1,116 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <future>
+#include <vector>
+#include "gtest/gtest.h"
+#include "net/cproto/serverconnection.h"
+
+using namespace reindexer::net;
+using reindexer::Error;
+
+namespace {
+
+class Handlers {
+public:
+	Error Slow(cproto::Context &ctx) {
+		// Slow call is not completed until the response of the next call is received by the client
+		EXPECT_EQ(fastReceived.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+		slowCompleted = true;
+		static std::string_view data = "slow";
+		ctx.Return({cproto::Arg(reindexer::p_string(&data))});
+		return errOK;
+	}
+	Error Fast(cproto::Context &) { return errOK; }
+	Error Sequential(cproto::Context &) {
+		EXPECT_TRUE(slowCompleted);
+		return errOK;
+	}
+
+	std::promise<void> fastReceived;
+	std::atomic<bool> slowCompleted{false};
+};
+
+void putRequest(reindexer::WrSerializer &ser, cproto::CmdCode cmd, uint32_t seq) {
+	reindexer::WrSerializer args;
+	cproto::Args().Pack(args);
+	cproto::CProtoHeader hdr;
+	hdr.magic = cproto::kCprotoMagic;
+	hdr.version = cproto::kCprotoVersion;
+	hdr.compressed = 0;
+	hdr._reserved = 0;
+	hdr.cmd = cmd;
+	hdr.len = args.Len();
+	hdr.seq = seq;
+	ser.Write(std::string_view(reinterpret_cast<char *>(&hdr), sizeof(hdr)));
+	ser.Write(args.Slice());
+}
+
+}  // namespace
+
+TEST(CprotoParallelCallsTest, ResponsesAreSentOutOfOrder) {
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	for (int fd : fds) ASSERT_EQ(fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK), 0);
+
+	Handlers handlers;
+	cproto::CallsExecutor executor(2);
+	cproto::Dispatcher dispatcher;
+	dispatcher.Register(cproto::kCmdSelect, &handlers, &Handlers::Slow);
+	dispatcher.Register(cproto::kCmdPing, &handlers, &Handlers::Fast);
+	dispatcher.Register(cproto::kCmdCommit, &handlers, &Handlers::Sequential);
+	dispatcher.AllowParallel(cproto::kCmdSelect);
+	dispatcher.AllowParallel(cproto::kCmdPing);
+	dispatcher.SetExecutor(&executor);
+
+	ev::dynamic_loop loop;
+	{
+		cproto::ServerConnection conn(fds[0], loop, dispatcher, false, 0);
+
+		reindexer::WrSerializer requests;
+		putRequest(requests, cproto::kCmdSelect, 1);
+		putRequest(requests, cproto::kCmdPing, 2);
+		putRequest(requests, cproto::kCmdCommit, 3);
+		ASSERT_EQ(write(fds[1], requests.Buf(), requests.Len()), ssize_t(requests.Len()));
+
+		std::vector<uint32_t> seqs;
+		std::string received;
+		ev::io client;
+		client.set(loop);
+		client.set([&](ev::io &w, int) {
+			char buf[1024];
+			ssize_t n;
+			while ((n = read(w.fd, buf, sizeof(buf))) > 0) received.append(buf, n);
+			while (received.size() >= sizeof(cproto::CProtoHeader)) {
+				const auto hdr = *reinterpret_cast<const cproto::CProtoHeader *>(received.data());
+				if (received.size() < sizeof(hdr) + hdr.len) break;
+				reindexer::Serializer ser(received.data() + sizeof(hdr), hdr.len);
+				EXPECT_EQ(ser.GetVarUint(), uint64_t(errOK)) << hdr.seq;
+				ser.GetVString();
+				cproto::Args args;
+				args.Unpack(ser);
+				if (hdr.seq == 1) {
+					EXPECT_EQ(args.size(), 1u);
+				} else if (hdr.seq == 2) {
+					handlers.fastReceived.set_value();
+				}
+				seqs.emplace_back(hdr.seq);
+				received.erase(0, sizeof(hdr) + hdr.len);
+			}
+			if (seqs.size() == 3) loop.break_loop();
+		});
+		client.start(fds[1], ev::READ);
+		ev::timer deadline;
+		deadline.set(loop);
+		deadline.set([&](ev::timer &, int) { loop.break_loop(); });
+		deadline.start(10.0);
+
+		loop.run();
+		// Fast call is answered before the slow one, which was received first. Sequential call waits for both of them
+		EXPECT_EQ(seqs, (std::vector<uint32_t>{2, 1, 3}));
+		client.stop();
+		deadline.stop();
+	}
+	close(fds[1]);
+}
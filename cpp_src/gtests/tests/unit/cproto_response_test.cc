@@ -0,0 +1,129 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include "gtest/gtest.h"
+#include "net/cproto/serverconnection.h"
+
+using namespace reindexer::net;
+using reindexer::chunk;
+using reindexer::p_string;
+
+namespace {
+
+class ServerConnectionWrapper : public cproto::ServerConnection {
+public:
+	using cproto::ServerConnection::ServerConnection;
+
+	// Returns chunks from the send buffer, which are not sent yet
+	reindexer::span<chunk> Pending() { return wrBuf_.tail(); }
+	void Drop() { wrBuf_.erase(wrBuf_.data_size()); }
+	void Push(std::string_view data) { wrBuf_.write(data); }
+	// Sends pending data, as if the socket became writable
+	void Flush() { callback(io_, ev::WRITE); }
+	void SetSendBufWatermarks(size_t low, size_t high) noexcept {
+		sendBufLowWatermark_ = low;
+		sendBufHighWatermark_ = high;
+	}
+	bool ReadingPaused() const noexcept { return sendBufOverflow_; }
+	size_t PendingBytes() { return wrBuf_.data_size(); }
+};
+
+}  // namespace
+
+TEST(CprotoResponseTest, DataChunkIsSentWithoutCopying) {
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	// Connection reads the socket on creation, so it has to be non-blocking like the accepted ones
+	ASSERT_EQ(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+	ev::dynamic_loop loop;
+	cproto::Dispatcher dispatcher;
+	{
+		ServerConnectionWrapper conn(fds[0], loop, dispatcher, false, 0);
+		cproto::RPCCall call{cproto::kCmdFetchResults, 42, {}, std::chrono::milliseconds(0)};
+
+		const std::string payload(3000, 'x');
+		for (bool zeroCopy : {true, false}) {
+			cproto::Context ctx{"", &call, &conn, {}, false};
+			std::string_view data(payload);
+			if (zeroCopy) {
+				chunk ch = conn.GetDataChunk();
+				reindexer::WrSerializer ser(std::move(ch));
+				ser.Write(payload);
+				ch = ser.DetachChunk();
+				const uint8_t *dataPtr = ch.data_;
+				ctx.Return(std::move(ch), {cproto::Arg(int(5)), cproto::Arg(int64_t(100500))});
+				auto pending = conn.Pending();
+				ASSERT_EQ(pending.size(), 1u);
+				// Response is built in place of the data buffer
+				EXPECT_EQ(pending[0].data_, dataPtr);
+			} else {
+				ctx.Return({cproto::Arg(p_string(&data)), cproto::Arg(int(5)), cproto::Arg(int64_t(100500))});
+			}
+			EXPECT_TRUE(ctx.respSent);
+
+			auto pending = conn.Pending();
+			ASSERT_EQ(pending.size(), 1u);
+			reindexer::Serializer ser(pending[0].data(), pending[0].size());
+			const auto hdr = *reinterpret_cast<const cproto::CProtoHeader *>(ser.Buf());
+			ser.SetPos(sizeof(hdr));
+			EXPECT_EQ(hdr.magic, cproto::kCprotoMagic);
+			EXPECT_EQ(hdr.cmd, cproto::kCmdFetchResults);
+			EXPECT_EQ(hdr.seq, 42u);
+			EXPECT_FALSE(hdr.compressed);
+			EXPECT_EQ(size_t(hdr.len), pending[0].size() - sizeof(hdr));
+			EXPECT_EQ(ser.GetVarUint(), uint64_t(errOK));
+			EXPECT_EQ(ser.GetVString(), "");
+			cproto::Args args;
+			args.Unpack(ser);
+			EXPECT_TRUE(ser.Eof());
+			ASSERT_EQ(args.size(), 3u);
+			EXPECT_EQ(std::string_view(args[0]), payload);
+			EXPECT_EQ(int(args[1]), 5);
+			EXPECT_EQ(int64_t(args[2]), 100500);
+			conn.Drop();
+		}
+	}
+	close(fds[1]);
+}
+
+TEST(CprotoResponseTest, SocketIsNotReadWhileSendBufIsOverflowed) {
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	ASSERT_EQ(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+	ASSERT_EQ(fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK), 0);
+	constexpr size_t kLowWatermark = 0x10000;
+	constexpr size_t kHighWatermark = 0x100000;
+	constexpr size_t kChunkSize = 0x8000;
+	constexpr size_t kTotalSize = 2 * kHighWatermark;
+	ev::dynamic_loop loop;
+	cproto::Dispatcher dispatcher;
+	{
+		ServerConnectionWrapper conn(fds[0], loop, dispatcher, false, 0);
+		conn.SetSendBufWatermarks(kLowWatermark, kHighWatermark);
+		const std::string data(kChunkSize, 'x');
+		// Client doesn't read the responses
+		for (size_t i = 0; i < kTotalSize / kChunkSize; ++i) conn.Push(data);
+		conn.Flush();
+		ASSERT_GE(conn.PendingBytes(), kHighWatermark);
+		EXPECT_TRUE(conn.ReadingPaused());
+
+		size_t received = 0;
+		std::string buf(kChunkSize, '\0');
+		while (received < kTotalSize) {
+			const ssize_t n = read(fds[1], buf.data(), buf.size());
+			ASSERT_GT(n, 0);
+			received += n;
+			conn.Flush();
+			// Reading is resumed only after the send buffer is drained to the low watermark
+			if (conn.PendingBytes() > kLowWatermark) {
+				ASSERT_TRUE(conn.ReadingPaused()) << conn.PendingBytes();
+			} else {
+				ASSERT_FALSE(conn.ReadingPaused()) << conn.PendingBytes();
+			}
+		}
+		EXPECT_EQ(received, kTotalSize);
+		EXPECT_EQ(conn.PendingBytes(), 0u);
+	}
+	close(fds[1]);
+}
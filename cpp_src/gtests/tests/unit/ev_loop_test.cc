@@ -0,0 +1,164 @@
+#ifdef __linux__
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "net/ev/ev.h"
+
+using namespace reindexer::net;
+
+namespace {
+
+class LoopWrapper : public ev::dynamic_loop {
+public:
+#ifdef HAVE_URING_LOOP
+	bool UringEnabled() const noexcept { return backend_.uring_enabled(); }
+#else
+	bool UringEnabled() const noexcept { return false; }
+#endif
+};
+
+}  // namespace
+
+TEST(EvLoopTest, UringBackendDeliversReadinessEvents) {
+	setenv("REINDEXER_IO_URING", "1", 1);
+	LoopWrapper loop;
+	unsetenv("REINDEXER_IO_URING");
+#ifdef HAVE_URING_LOOP
+	EXPECT_EQ(loop.UringEnabled(), ev::loop_uring_backend::supported());
+#endif
+
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+	std::string received;
+	int writeEvents = 0;
+	bool done = false;
+	ev::io reader, writer;
+	reader.set(loop);
+	reader.set([&](ev::io &w, int events) {
+		ASSERT_TRUE(events & ev::READ);
+		char buf[4];
+		// Reads less data than available, so the next event is expected for the rest of the data
+		ssize_t n = read(w.fd, buf, sizeof(buf));
+		ASSERT_GT(n, 0);
+		received.append(buf, n);
+		if (received.size() == 10) {
+			done = true;
+			loop.break_loop();
+		}
+	});
+	writer.set(loop);
+	writer.set([&](ev::io &w, int events) {
+		ASSERT_TRUE(events & ev::WRITE);
+		++writeEvents;
+		ASSERT_EQ(write(w.fd, "0123456789", 10), 10);
+		w.stop();
+	});
+	reader.start(fds[0], ev::READ);
+	writer.start(fds[1], ev::WRITE);
+
+	ev::timer deadline;
+	deadline.set(loop);
+	deadline.set([&](ev::timer &, int) { loop.break_loop(); });
+	deadline.start(10.0);
+
+	// Asyncs from the other threads wake up the loop too
+	ev::async async;
+	bool asyncCalled = false;
+	async.set(loop);
+	async.set([&](ev::async &) { asyncCalled = true; });
+	async.start();
+	async.send();
+
+	loop.run();
+	EXPECT_TRUE(done);
+	EXPECT_TRUE(asyncCalled);
+	EXPECT_EQ(received, "0123456789");
+	EXPECT_EQ(writeEvents, 1);
+
+	// Timers are handled without io events
+	bool timerCalled = false;
+	ev::timer tm;
+	tm.set(loop);
+	tm.set([&](ev::timer &, int) {
+		timerCalled = true;
+		loop.break_loop();
+	});
+	tm.start(0.01);
+	loop.run();
+	EXPECT_TRUE(timerCalled);
+
+	reader.stop();
+	deadline.stop();
+	async.stop();
+	close(fds[0]);
+	close(fds[1]);
+}
+
+TEST(EvLoopTest, CoarseTimersFireAfterDeadlines) {
+	using std::chrono::steady_clock;
+	constexpr size_t kTimersCount = 1000;
+	ev::dynamic_loop loop;
+	std::vector<ev::timer> timers(kTimersCount);
+	std::vector<steady_clock::time_point> deadlines(kTimersCount);
+	size_t fired = 0, early = 0;
+	const auto start = steady_clock::now();
+	for (size_t i = 0; i < kTimersCount; ++i) {
+		const double t = 0.05 * double(i % 10 + 1);
+		deadlines[i] = start + std::chrono::milliseconds(int64_t(t * 1000));
+		timers[i].set(loop);
+		timers[i].set_coarse(true);
+		timers[i].set([&, i](ev::timer &, int) {
+			if (steady_clock::now() < deadlines[i]) ++early;
+			if (++fired == kTimersCount / 2) loop.break_loop();
+		});
+		timers[i].start(t);
+		ASSERT_TRUE(timers[i].is_active());
+	}
+	// Stopped timers are not fired
+	for (size_t i = 1; i < kTimersCount; i += 2) {
+		timers[i].stop();
+		ASSERT_FALSE(timers[i].is_active());
+	}
+
+	// Periodic coarse timer is restarted after each call
+	size_t periodicCalls = 0;
+	ev::periodic periodic;
+	periodic.set(loop);
+	periodic.set_coarse(true);
+	periodic.set([&](ev::timer &, int) { ++periodicCalls; });
+	periodic.start(0.1, 0.1);
+
+	// Timer, which doesn't fit into the near slots of the wheel
+	bool longTimerCalled = false;
+	ev::timer longTimer;
+	longTimer.set(loop);
+	longTimer.set_coarse(true);
+	longTimer.set([&](ev::timer &, int) { longTimerCalled = true; });
+	longTimer.start(3600.0);
+
+	ev::timer deadline;
+	deadline.set(loop);
+	deadline.set([&](ev::timer &, int) { loop.break_loop(); });
+	deadline.start(10.0);
+
+	loop.run();
+	EXPECT_EQ(fired, kTimersCount / 2);
+	EXPECT_EQ(early, 0);
+	EXPECT_GE(periodicCalls, 2);
+	EXPECT_TRUE(periodic.is_active());
+	EXPECT_FALSE(longTimerCalled);
+	EXPECT_TRUE(longTimer.is_active());
+	for (auto &tm : timers) EXPECT_FALSE(tm.is_active());
+
+	periodic.stop();
+	longTimer.stop();
+	deadline.stop();
+	EXPECT_FALSE(longTimer.is_active());
+}
+
+#endif	// __linux__
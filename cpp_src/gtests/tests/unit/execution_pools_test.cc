@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <future>
+#include <thread>
+#include "gtest/gtest.h"
+#include "net/cproto/callsexecutor.h"
+#include "server/executionpools.h"
+#include "tools/numa.h"
+
+using reindexer::Error;
+using reindexer::net::cproto::CallsExecutor;
+using reindexer_server::ExecutionPool;
+using reindexer_server::ExecutionPoolConfig;
+using reindexer_server::ExecutionPools;
+using reindexer_server::ServerConfig;
+
+TEST(ExecutionPoolsTest, ExecuteAndWait) {
+	CallsExecutor executor(1);
+	std::thread::id taskThread;
+	executor.ExecuteAndWait([&taskThread] { taskThread = std::this_thread::get_id(); });
+	EXPECT_NE(taskThread, std::thread::id());
+	EXPECT_NE(taskThread, std::this_thread::get_id());
+
+	// Exception of the task is rethrown in the calling thread
+	EXPECT_THROW(executor.ExecuteAndWait([] { throw Error(errLogic, "failed"); }), Error);
+}
+
+TEST(ExecutionPoolsTest, AdmissionControl) {
+	ExecutionPoolConfig cfg;
+	cfg.threads = 1;
+	cfg.maxQueue = 2;
+	cfg.maxQueueWait = std::chrono::milliseconds(50);
+	ExecutionPool pool("olap", cfg);
+	EXPECT_TRUE(pool.Admit().ok());
+
+	// The only thread is busy, so the next task is queued
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	pool.Executor().Execute([released] { released.wait(); });
+	pool.Executor().Execute([] {});
+	for (int i = 0; i < 1000 && pool.Executor().QueueSize() != 1; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	ASSERT_EQ(pool.Executor().QueueSize(), 1u);
+	EXPECT_TRUE(pool.Admit().ok());
+
+	// Queue wait exceeds the limit
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	EXPECT_GE(pool.Executor().QueueWait(), std::chrono::milliseconds(100));
+	EXPECT_EQ(pool.Admit().code(), errQuotaExceeded);
+
+	release.set_value();
+	for (int i = 0; i < 1000 && pool.Executor().QueueSize(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	EXPECT_EQ(pool.Executor().QueueWait(), std::chrono::microseconds(0));
+	EXPECT_TRUE(pool.Admit().ok());
+}
+
+TEST(ExecutionPoolsTest, Routing) {
+	ServerConfig cfg;
+	auto err = cfg.ParseYaml(R"yaml(
+execution_pools:
+  pools:
+    olap:
+      threads: 2
+    ft:
+      threads: 1
+      numa_node: 100000
+  users:
+    analytics: olap
+  apps:
+    search: ft
+  namespaces:
+    Items: ft
+)yaml");
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_TRUE(ExecutionPools::Required(cfg));
+	ExecutionPools pools(cfg);
+
+	auto pool = pools.Get("analytics", "");
+	ASSERT_TRUE(pool);
+	EXPECT_EQ(pool->Name(), "olap");
+	EXPECT_EQ(pool->Executor().Threads(), 2u);
+	// Application's pool is preferred
+	pool = pools.Get("analytics", "search");
+	ASSERT_TRUE(pool);
+	EXPECT_EQ(pool->Name(), "ft");
+	EXPECT_FALSE(pools.Get("reindexer", "app"));
+	// Namespaces names are case insensitive. Pool with unavailable NUMA node is still created
+	EXPECT_EQ(cfg.ExecutionPools["ft"].numaNode, 100000);
+	pool = pools.GetByNamespace("items");
+	ASSERT_TRUE(pool);
+	EXPECT_EQ(pool->Name(), "ft");
+	EXPECT_FALSE(pools.GetByNamespace("other"));
+
+	err = ServerConfig().ParseYaml(R"yaml(
+execution_pools:
+  users:
+    analytics: olap
+)yaml");
+	EXPECT_EQ(err.code(), errParams);
+}
+
+TEST(ExecutionPoolsTest, NumaNodeCPUs) {
+	EXPECT_TRUE(reindexer::numa::NodeCPUs(-1).empty());
+	EXPECT_TRUE(reindexer::numa::NodeCPUs(100000).empty());
+	// Node 0 exists on any Linux system with NUMA support in the kernel
+	auto cpus = reindexer::numa::NodeCPUs(0);
+	if (!cpus.empty()) {
+		EXPECT_TRUE(std::is_sorted(cpus.begin(), cpus.end()));
+		CallsExecutor executor(1, [cpus] { EXPECT_TRUE(reindexer::numa::PinCurrentThread(cpus)); });
+		executor.ExecuteAndWait([] {});
+	}
+}
@@ -0,0 +1,21 @@
+#include <string>
+#include "gtest/gtest.h"
+#include "vendor/gason/gason.h"
+
+TEST(GasonTest, ParsesLongStringsWithEscapes) {
+	// Strings are longer than the vector block, and escapes/quotes are placed at each position of the block
+	for (size_t prefix = 0; prefix < 40; ++prefix) {
+		const std::string plain(prefix, 'a');
+		const std::string json = R"({"k":")" + plain + R"(\"x\\y\nЖ)" + plain + R"(","long_key_name_with_more_than_16_chars":")" + plain +
+								 R"("})";
+		gason::JsonParser parser;
+		gason::JsonNode root = parser.Parse(std::string_view(json));
+		EXPECT_EQ(root["k"].As<std::string>(), plain + "\"x\\y\n\xD0\x96" + plain) << prefix;
+		EXPECT_EQ(root["long_key_name_with_more_than_16_chars"].As<std::string>(), plain) << prefix;
+	}
+}
+
+TEST(GasonTest, ReportsUnterminatedLongString) {
+	gason::JsonParser parser;
+	EXPECT_THROW(parser.Parse(std::string_view(R"({"k":"unterminated string longer than 16 chars)")), gason::Exception);
+}
@@ -130,4 +130,47 @@ TEST_F(GrpcClientApi, SelectJSON) {
 	}
 }
 
+// Perform Select with GRPC-service, which streams results by the batches
+TEST_F(GrpcClientApi, SelectJSONStream) {
+	constexpr size_t kBatchSize = 30;
+	reindexer::grpc::SelectSqlRequest request;
+	request.set_dbname(kDbName);
+	request.set_sql(reindexer::Query(default_namespace).GetSQL());
+
+	reindexer::grpc::OutputFlags* flags = request.flags().New();
+	flags->set_encodingtype(reindexer::grpc::EncodingType::JSON);
+	flags->set_streambatchsize(kBatchSize);
+	request.set_allocated_flags(flags);
+
+	grpc::ClientContext context;
+	std::unique_ptr<grpc::ClientReader<reindexer::grpc::QueryResultsResponse>> reader = rx_->SelectSql(&context, request);
+
+	reindexer::grpc::QueryResultsResponse response;
+	std::vector<size_t> batches;
+	int64_t totalItems = -1;
+	while (reader->Read(&response)) {
+		ASSERT_TRUE(response.errorresponse().code() == reindexer::grpc::ErrorResponse_ErrorCode_errCodeOK) << response.errorresponse().what();
+		// Options are sent with the first response only
+		if (batches.empty()) {
+			ASSERT_TRUE(response.has_options());
+			totalItems = response.options().totalitems();
+		} else {
+			ASSERT_FALSE(response.has_options());
+		}
+
+		gason::JsonParser parser;
+		gason::JsonNode root;
+		ASSERT_NO_THROW(root = parser.Parse(std::string_view(response.data())));
+		size_t items = 0;
+		for (auto elem : root["items"]) {
+			(void)elem;
+			++items;
+		}
+		batches.emplace_back(items);
+	}
+	ASSERT_TRUE(reader->Finish().ok());
+	EXPECT_EQ(totalItems, 100);
+	EXPECT_EQ(batches, std::vector<size_t>({kBatchSize, kBatchSize, kBatchSize, 100 - 3 * kBatchSize}));
+}
+
 #endif
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include "core/cjson/jsonbuilder.h"
+#include "core/index/hnsw/distances.h"
+#include "core/index/hnsw/hnswgraph.h"
+#include "gtest/gtest.h"
+#include "reindexer_api.h"
+
+using reindexer::HnswGraph;
+
+static std::vector<float> randomVectors(size_t count, size_t dimension, std::mt19937 &rng) {
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::vector<float> vectors(count * dimension);
+	for (auto &v : vectors) v = dist(rng);
+	return vectors;
+}
+
+static std::set<IdType> exactNearest(const std::vector<float> &vectors, const std::set<IdType> &ids, const float *query, size_t dimension,
+									 size_t k) {
+	std::vector<std::pair<float, IdType>> distances;
+	for (IdType id : ids) distances.emplace_back(reindexer::hnsw::L2Sqr(query, vectors.data() + id * dimension, dimension), id);
+	std::sort(distances.begin(), distances.end());
+	std::set<IdType> res;
+	for (size_t i = 0; i < k && i < distances.size(); ++i) res.insert(distances[i].second);
+	return res;
+}
+
+TEST(HnswGraphTest, Kernels) {
+	// Dimension is not multiple of the kernels' block size
+	std::vector<float> a(37), b(37);
+	float l2 = 0.0f, ip = 0.0f;
+	for (size_t i = 0; i < a.size(); ++i) {
+		a[i] = 0.5f * i;
+		b[i] = 1.0f - 0.25f * i;
+		l2 += (a[i] - b[i]) * (a[i] - b[i]);
+		ip += a[i] * b[i];
+	}
+	EXPECT_FLOAT_EQ(reindexer::hnsw::L2Sqr(a.data(), b.data(), a.size()), l2);
+	EXPECT_FLOAT_EQ(reindexer::hnsw::InnerProduct(a.data(), b.data(), a.size()), ip);
+}
+
+TEST(HnswGraphTest, Recall) {
+	constexpr size_t kDimension = 24, kCount = 3000, kK = 10, kQueries = 50;
+	std::mt19937 rng(42);
+	const auto vectors = randomVectors(kCount, kDimension, rng);
+	HnswGraph graph({kDimension, HnswGraph::Metric::L2, 12, 100});
+	std::set<IdType> ids;
+	for (size_t i = 0; i < kCount; ++i) {
+		graph.Add(i, vectors.data() + i * kDimension);
+		ids.insert(i);
+	}
+	ASSERT_EQ(graph.Size(), kCount);
+
+	const auto checkRecall = [&] {
+		const auto queries = randomVectors(kQueries, kDimension, rng);
+		size_t matched = 0;
+		for (size_t q = 0; q < kQueries; ++q) {
+			const float *query = queries.data() + q * kDimension;
+			const auto found = graph.Search(query, kK, 64);
+			ASSERT_EQ(found.size(), kK);
+			ASSERT_TRUE(std::is_sorted(found.begin(), found.end(), [](const auto &l, const auto &r) { return l.distance < r.distance; }));
+			const auto expected = exactNearest(vectors, ids, query, kDimension, kK);
+			for (const auto &n : found) {
+				ASSERT_TRUE(ids.count(n.id)) << n.id;
+				matched += expected.count(n.id);
+			}
+		}
+		EXPECT_GE(matched, kQueries * kK * 9 / 10);
+	};
+	checkRecall();
+
+	// Removed vectors are not found, but stay the routing nodes until the graph is rebuilt
+	for (size_t i = 0; i < kCount; i += 2) {
+		graph.Remove(i);
+		ids.erase(i);
+	}
+	ASSERT_EQ(graph.Size(), ids.size());
+	checkRecall();
+	for (size_t i = 1; i < kCount; i += 4) {
+		graph.Remove(i);
+		ids.erase(i);
+	}
+	checkRecall();
+}
+
+TEST(HnswGraphTest, CosineAndReplace) {
+	HnswGraph graph({2, HnswGraph::Metric::Cosine, 4, 16});
+	const float vectors[][2] = {{1.0f, 0.0f}, {0.0f, 3.0f}, {-2.0f, 0.1f}, {5.0f, 5.0f}};
+	for (IdType id = 0; id < 4; ++id) graph.Add(id, vectors[id]);
+
+	// Length of the vectors does not matter
+	const float query[] = {10.0f, 9.0f};
+	auto found = graph.Search(query, 2, 10);
+	ASSERT_EQ(found.size(), 2);
+	EXPECT_EQ(found[0].id, 3);
+	EXPECT_NEAR(found[0].distance, 1.0f - (10.0f + 9.0f) / (std::sqrt(2.0f) * std::sqrt(181.0f)), 1e-5);
+	EXPECT_EQ(found[1].id, 0);
+
+	const float replaced[] = {-1.0f, -1.0f};
+	graph.Add(3, replaced);
+	EXPECT_EQ(graph.Size(), 4);
+	found = graph.Search(query, 1, 10);
+	ASSERT_EQ(found.size(), 1);
+	EXPECT_EQ(found[0].id, 0);
+	EXPECT_TRUE(graph.Search(query, 0, 10).empty());
+}
+
+TEST_F(ReindexerApi, KnnHnswRows) {
+	constexpr size_t kDimension = 8, kCount = 2000, kK = 10, kQueries = 20;
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace,
+								 {"vec", "hnsw", "double", IndexOpts().Array().SetConfig(R"({"dimension":8,"ef_construction":100})")});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, {"value", "tree", "int", IndexOpts()});
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	std::mt19937 rng(7);
+	const auto vectors = randomVectors(kCount, kDimension, rng);
+	const auto upsert = [&](int id, size_t dimension) {
+		reindexer::WrSerializer ser;
+		{
+			reindexer::JsonBuilder json(ser);
+			json.Put("id", id);
+			json.Put("value", id % 2);
+			auto arr = json.Array("vec");
+			for (size_t i = 0; i < dimension; ++i) arr.Put({}, double(vectors[id * kDimension + i]));
+		}
+		Item item = rt.reindexer->NewItem(default_namespace);
+		EXPECT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON(ser.Slice());
+		EXPECT_TRUE(err.ok()) << err.what();
+		return rt.reindexer->Upsert(default_namespace, item);
+	};
+	for (size_t id = 0; id < kCount; ++id) {
+		err = upsert(id, kDimension);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	// Vectors of the wrong dimension are not accepted
+	err = upsert(0, kDimension - 1);
+	EXPECT_FALSE(err.ok());
+
+	std::set<IdType> ids;
+	for (size_t id = 0; id < kCount; ++id) ids.insert(id);
+	const auto queries = randomVectors(kQueries, kDimension, rng);
+	size_t matched = 0;
+	for (size_t q = 0; q < kQueries; ++q) {
+		const std::vector<double> query(queries.begin() + q * kDimension, queries.begin() + (q + 1) * kDimension);
+		const auto expected = exactNearest(vectors, ids, queries.data() + q * kDimension, kDimension, kK);
+
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Knn("vec", query, kK, 64), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), kK);
+		for (size_t j = 0; j < qr.Count(); ++j) matched += expected.count(qr[j].GetItem(false)["id"].As<int>());
+
+		// Other conditions filter the nearest rows
+		QueryResults filtered;
+		const std::string sql = Query(default_namespace).Knn("vec", query, kK, 64).Where("value", CondEq, 1).GetSQL();
+		err = rt.reindexer->Select(sql, filtered);
+		ASSERT_TRUE(err.ok()) << err.what() << "; " << sql;
+		ASSERT_LE(filtered.Count(), kK);
+		for (size_t j = 0; j < filtered.Count(); ++j) EXPECT_EQ(filtered[j].GetItem(false)["value"].As<int>(), 1);
+	}
+	EXPECT_GE(matched, kQueries * kK * 9 / 10);
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Where("vec", CondKnn, {1, 0}), qr);
+	EXPECT_FALSE(err.ok());
+}
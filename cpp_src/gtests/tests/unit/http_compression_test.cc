@@ -0,0 +1,143 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include "gtest/gtest.h"
+#include "net/http/serverconnection.h"
+#include "tools/serializer.h"
+
+#if REINDEX_WITH_ZLIB
+#include <zlib.h>
+#endif	// REINDEX_WITH_ZLIB
+
+using namespace reindexer::net;
+using namespace std::string_view_literals;
+
+TEST(HttpCompressionTest, AcceptEncodingNegotiation) {
+	EXPECT_TRUE(http::AcceptsGzip("gzip"sv));
+	EXPECT_TRUE(http::AcceptsGzip("deflate, GZIP;q=0.5, br"sv));
+	EXPECT_TRUE(http::AcceptsGzip("x-gzip"sv));
+	EXPECT_TRUE(http::AcceptsGzip(" gzip ; q=1.0"sv));
+	EXPECT_FALSE(http::AcceptsGzip(""sv));
+	EXPECT_FALSE(http::AcceptsGzip("deflate, br"sv));
+	EXPECT_FALSE(http::AcceptsGzip("gzip;q=0"sv));
+	EXPECT_FALSE(http::AcceptsGzip("gzip; q=0.000, identity"sv));
+	EXPECT_FALSE(http::AcceptsGzip("gzipped"sv));
+}
+
+#if REINDEX_WITH_ZLIB
+
+namespace {
+
+class BodyHandler {
+public:
+	int Handle(http::Context &ctx) {
+		if (ctx.request->path == "/stream"sv) {
+			// Response of the unknown length is sent by parts
+			ctx.writer->SetRespCode(http::StatusOK);
+			for (size_t pos = 0; pos < body.size(); pos += 1000) ctx.writer->Write(std::string_view(body).substr(pos, 1000));
+			return 0;
+		}
+		return ctx.String(http::StatusOK, ctx.request->path == "/small"sv ? std::string_view(body).substr(0, 100) : body);
+	}
+
+	std::string body;
+};
+
+std::string gunzip(std::string_view data) {
+	z_stream zs{};
+	EXPECT_EQ(inflateInit2(&zs, 15 + 16), Z_OK);
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+	zs.avail_in = data.size();
+	std::string res;
+	char buf[0x1000];
+	int ret;
+	do {
+		zs.next_out = reinterpret_cast<Bytef *>(buf);
+		zs.avail_out = sizeof(buf);
+		ret = inflate(&zs, Z_NO_FLUSH);
+		res.append(buf, sizeof(buf) - zs.avail_out);
+	} while (ret == Z_OK);
+	EXPECT_EQ(ret, Z_STREAM_END);
+	inflateEnd(&zs);
+	return res;
+}
+
+// Returns the headers and the decoded chunked body of the response
+std::pair<std::string, std::string> request(http::Router &router, std::string_view path, std::string_view acceptEncoding) {
+	int fds[2];
+	EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	EXPECT_EQ(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+	std::string req = "GET " + std::string(path) + " HTTP/1.1\r\nConnection: close\r\n";
+	if (!acceptEncoding.empty()) req += "Accept-Encoding: " + std::string(acceptEncoding) + "\r\n";
+	req += "\r\n";
+	EXPECT_EQ(::write(fds[1], req.data(), req.size()), ssize_t(req.size()));
+
+	ev::dynamic_loop loop;
+	http::CompressionOpts opts;
+	opts.level = 6;
+	opts.minSize = 1000;
+	std::unique_ptr<http::ServerConnection> conn(new http::ServerConnection(fds[0], loop, router, 1 << 20, opts));
+	::shutdown(fds[1], SHUT_WR);
+	std::string resp;
+	char buf[0x1000];
+	ssize_t n;
+	while ((n = ::read(fds[1], buf, sizeof(buf))) > 0) resp.append(buf, n);
+	::close(fds[1]);
+
+	const auto headersEnd = resp.find("\r\n\r\n");
+	EXPECT_NE(headersEnd, std::string::npos);
+	std::string headers = resp.substr(0, headersEnd + 2);
+	std::string_view rest = std::string_view(resp).substr(headersEnd + 4);
+	if (headers.find("Transfer-Encoding: chunked\r\n") == std::string::npos) return {std::move(headers), std::string(rest)};
+	std::string body;
+	while (!rest.empty()) {
+		size_t len = std::stoul(std::string(rest.substr(0, rest.find("\r\n"))), nullptr, 16);
+		rest.remove_prefix(rest.find("\r\n") + 2);
+		body.append(rest.substr(0, len));
+		rest.remove_prefix(std::min(rest.size(), len + 2));
+		if (!len) break;
+	}
+	return {std::move(headers), std::move(body)};
+}
+
+}  // namespace
+
+TEST(HttpCompressionTest, ResponsesAreCompressedByParts) {
+	BodyHandler handler;
+	for (int i = 0; i < 5000; ++i) handler.body += "{\"id\":" + std::to_string(i) + ",\"name\":\"item\"},";
+	http::Router router;
+	router.GET<BodyHandler, &BodyHandler::Handle>("/*", &handler);
+
+	for (std::string_view path : {"/full"sv, "/stream"sv}) {
+		auto [headers, body] = request(router, path, "deflate, gzip"sv);
+		EXPECT_NE(headers.find("Content-Encoding: gzip\r\n"), std::string::npos) << path;
+		EXPECT_NE(headers.find("Transfer-Encoding: chunked\r\n"), std::string::npos) << path;
+		EXPECT_LT(body.size(), handler.body.size() / 4) << path;
+		EXPECT_EQ(gunzip(body), handler.body) << path;
+
+		std::tie(headers, body) = request(router, path, "gzip;q=0"sv);
+		EXPECT_EQ(headers.find("Content-Encoding"), std::string::npos) << path;
+		EXPECT_EQ(body, handler.body) << path;
+	}
+
+	// Small responses are not compressed
+	auto [headers, body] = request(router, "/small"sv, "gzip"sv);
+	EXPECT_EQ(headers.find("Content-Encoding"), std::string::npos);
+	EXPECT_EQ(body, handler.body.substr(0, 100));
+}
+
+TEST(HttpCompressionTest, GzipEncoderStream) {
+	http::GzipEncoder encoder(1);
+	reindexer::WrSerializer ser;
+	std::string data;
+	for (int i = 0; i < 100000; ++i) {
+		std::string part = std::to_string(i * 7919 % 100003) + ';';
+		data += part;
+		encoder.Encode(part, ser, false);
+	}
+	encoder.Encode({}, ser, true);
+	EXPECT_EQ(gunzip(ser.Slice()), data);
+}
+
+#endif	// REINDEX_WITH_ZLIB
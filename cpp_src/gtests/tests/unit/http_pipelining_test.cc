@@ -0,0 +1,75 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "net/http/serverconnection.h"
+
+using namespace reindexer::net;
+using namespace std::string_view_literals;
+
+namespace {
+
+class PathHandler {
+public:
+	int Handle(http::Context &ctx) {
+		paths.emplace_back(ctx.request->path);
+		return ctx.String(http::StatusOK, ctx.request->path);
+	}
+
+	std::vector<std::string> paths;
+};
+
+std::string readAll(int fd) {
+	std::string res;
+	char buf[0x1000];
+	ssize_t n;
+	while ((n = ::read(fd, buf, sizeof(buf))) > 0) res.append(buf, n);
+	return res;
+}
+
+size_t count(std::string_view str, std::string_view substr) {
+	size_t cnt = 0;
+	for (auto pos = str.find(substr); pos != std::string_view::npos; pos = str.find(substr, pos + 1)) ++cnt;
+	return cnt;
+}
+
+}  // namespace
+
+TEST(HttpPipeliningTest, PipelinedRequestsAreAnsweredInOrder) {
+	PathHandler handler;
+	http::Router router;
+	router.GET<PathHandler, &PathHandler::Handle>("/*", &handler);
+
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	ASSERT_EQ(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+
+	// All of the requests are received by the single read. The last one must not be handled after 'Connection: close'
+	const std::string requests =
+		"GET /first HTTP/1.1\r\nHost: localhost\r\n\r\n"
+		"GET /second HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"
+		"GET /third HTTP/1.1\r\nConnection: close\r\n\r\n"
+		"GET /fourth HTTP/1.1\r\n\r\n";
+	ASSERT_EQ(::write(fds[1], requests.data(), requests.size()), ssize_t(requests.size()));
+
+	ev::dynamic_loop loop;
+	std::unique_ptr<http::ServerConnection> conn(new http::ServerConnection(fds[0], loop, router, 1 << 20));
+	EXPECT_TRUE(conn->IsFinished());
+	::shutdown(fds[1], SHUT_WR);
+
+	const std::string responses = readAll(fds[1]);
+	EXPECT_EQ(handler.paths, std::vector<std::string>({"/first", "/second", "/third"}));
+	const auto first = responses.find("/first"), second = responses.find("/second"), third = responses.find("/third");
+	ASSERT_NE(first, std::string::npos);
+	ASSERT_NE(second, std::string::npos);
+	ASSERT_NE(third, std::string::npos);
+	EXPECT_LT(first, second);
+	EXPECT_LT(second, third);
+	EXPECT_EQ(count(responses, "HTTP/1.1 200 OK\r\n"sv), 3u);
+	EXPECT_EQ(count(responses, "Connection: keep-alive\r\n"sv), 2u);
+	EXPECT_EQ(count(responses, "Connection: close\r\n"sv), 1u);
+	EXPECT_EQ(responses.find("/fourth"), std::string::npos);
+	::close(fds[1]);
+}
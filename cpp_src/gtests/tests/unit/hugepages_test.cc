@@ -0,0 +1,33 @@
+#include <vector>
+#include "gtest/gtest.h"
+#include "tools/hugepages.h"
+
+using reindexer::HugePageAllocator;
+namespace hugepages = reindexer::hugepages;
+
+TEST(HugePagesTest, LargeAllocationsAreMapped) {
+	const size_t mapped = hugepages::MappedBytes();
+	hugepages::SetMode(hugepages::Mode::Madvise);
+	std::vector<int64_t, HugePageAllocator<int64_t>> large(hugepages::kMinAllocationSize / sizeof(int64_t));
+	std::vector<int64_t, HugePageAllocator<int64_t>> small(16);
+	for (size_t i = 0; i < large.size(); ++i) large[i] = i;
+#ifdef __linux__
+	EXPECT_EQ(hugepages::MappedBytes(), mapped + hugepages::kMinAllocationSize);
+#endif
+	// Memory mapped in the previous mode is released correctly
+	hugepages::SetMode(hugepages::Mode::Off);
+	large.clear();
+	large.shrink_to_fit();
+	EXPECT_EQ(hugepages::MappedBytes(), mapped);
+	large.resize(hugepages::kMinAllocationSize / sizeof(int64_t));
+	EXPECT_EQ(hugepages::MappedBytes(), mapped);
+
+	// Explicit huge pages fall back to the transparent ones, if there is no preallocated pool
+	hugepages::SetMode(hugepages::Mode::Explicit);
+	std::vector<int64_t, HugePageAllocator<int64_t>> explicitLarge(large.size(), 1);
+#ifdef __linux__
+	EXPECT_EQ(hugepages::MappedBytes(), mapped + hugepages::kMinAllocationSize);
+#endif
+	EXPECT_EQ(explicitLarge.back(), 1);
+	hugepages::SetMode(hugepages::Mode::Off);
+}
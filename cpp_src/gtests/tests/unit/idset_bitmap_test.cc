@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <set>
+#include "core/idsetbitmap.h"
+#include "core/selectkeyresult.h"
+
+using reindexer::IdSet;
+using reindexer::IdSetBitmap;
+
+static std::vector<IdType> bitmapToVector(const IdSetBitmap& bm) {
+	std::vector<IdType> res;
+	bm.ForEach([&res](IdType id) { res.push_back(id); });
+	return res;
+}
+
+TEST(IdSetBitmap, AddAndIterate) {
+	std::mt19937 rng(42);
+	// Sparse (array containers) and dense (bitmap containers) id ranges
+	for (int range : {70000, 300000, 5000000}) {
+		std::set<IdType> expected;
+		IdSetBitmap bm;
+		for (int i = 0; i < 20000; ++i) {
+			const IdType id = rng() % range;
+			ASSERT_EQ(bm.Add(id), expected.insert(id).second);
+		}
+		ASSERT_EQ(bm.Size(), expected.size());
+		ASSERT_EQ(bitmapToVector(bm), std::vector<IdType>(expected.begin(), expected.end()));
+
+		std::vector<IdType> fwd, rev;
+		size_t cursor = 0;
+		for (IdType id = bm.Next(0, cursor); id != INT_MAX; id = bm.Next(id + 1, cursor)) fwd.push_back(id);
+		ASSERT_EQ(fwd, std::vector<IdType>(expected.begin(), expected.end()));
+		cursor = 0;
+		for (IdType id = bm.Prev(INT_MAX - 1, cursor); id != INT_MIN; id = bm.Prev(id - 1, cursor)) rev.push_back(id);
+		ASSERT_EQ(rev, std::vector<IdType>(expected.rbegin(), expected.rend()));
+
+		for (int i = 0; i < 1000; ++i) {
+			const IdType from = rng() % range;
+			size_t hint = rng() % 8;
+			auto it = expected.lower_bound(from);
+			ASSERT_EQ(bm.Next(from, hint), it == expected.end() ? INT_MAX : *it);
+			hint = rng() % 8;
+			auto rit = expected.upper_bound(from);
+			ASSERT_EQ(bm.Prev(from, hint), rit == expected.begin() ? INT_MIN : *std::prev(rit));
+			ASSERT_EQ(bm.Contains(from), expected.count(from) != 0);
+		}
+	}
+}
+
+TEST(IdSetBitmap, OrAnd) {
+	std::mt19937 rng(7);
+	std::set<IdType> s1, s2;
+	IdSetBitmap bm1, bm2;
+	for (int i = 0; i < 30000; ++i) {
+		const IdType id1 = rng() % 200000, id2 = rng() % 200000;
+		s1.insert(id1);
+		bm1.Add(id1);
+		s2.insert(id2);
+		bm2.Add(id2);
+	}
+
+	IdSetBitmap orBm = bm1;
+	orBm.Or(bm2);
+	std::vector<IdType> expectedOr;
+	std::set_union(s1.begin(), s1.end(), s2.begin(), s2.end(), std::back_inserter(expectedOr));
+	EXPECT_EQ(bitmapToVector(orBm), expectedOr);
+	EXPECT_EQ(orBm.Size(), expectedOr.size());
+
+	IdSetBitmap andBm = bm1;
+	andBm.And(bm2);
+	std::vector<IdType> expectedAnd;
+	std::set_intersection(s1.begin(), s1.end(), s2.begin(), s2.end(), std::back_inserter(expectedAnd));
+	EXPECT_EQ(bitmapToVector(andBm), expectedAnd);
+	EXPECT_EQ(andBm.Size(), expectedAnd.size());
+
+	EXPECT_TRUE(IdSetBitmap(orBm) == orBm);
+	EXPECT_TRUE(andBm != orBm);
+}
+
+TEST(IdSetBitmap, MergeSelectKeyResults) {
+	using reindexer::SelectKeyResult;
+	using reindexer::SingleSelectKeyResult;
+	const int keysCount = 4;
+	const int idsPerKey = int(reindexer::kMinIdsetSizeForBitmap);
+
+	// Low-cardinality index: each key owns every keysCount-th row
+	std::vector<IdSet::Ptr> idsets;
+	SelectKeyResult res;
+	for (int k = 0; k < keysCount; ++k) {
+		auto ids = reindexer::make_intrusive<reindexer::intrusive_atomic_rc_wrapper<IdSet>>();
+		for (int i = 0; i < idsPerKey; ++i) ids->Add(i * keysCount + k, IdSet::Unordered, 0);
+		idsets.push_back(ids);
+		res.push_back(SingleSelectKeyResult(ids));
+	}
+	IdSet::Ptr merged = res.mergeIdsets();
+	ASSERT_TRUE(merged->Bitmap());
+	ASSERT_EQ(merged->Size(), size_t(keysCount * idsPerKey));
+	ASSERT_EQ(res.size(), 1u);
+	ASSERT_EQ(res.GetMaxIterations(), size_t(keysCount * idsPerKey));
+
+	std::vector<IdType> ids = bitmapToVector(*merged->Bitmap());
+	for (size_t i = 0; i < ids.size(); ++i) ASSERT_EQ(ids[i], IdType(i));
+}
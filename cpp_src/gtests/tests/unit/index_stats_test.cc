@@ -0,0 +1,60 @@
+#include "core/index/indexstats.h"
+#include "gtest/gtest.h"
+
+using reindexer::IndexStats;
+using reindexer::Variant;
+using reindexer::VariantArray;
+
+namespace {
+
+VariantArray keys(std::initializer_list<int> values) {
+	VariantArray res;
+	for (int v : values) res.emplace_back(Variant(v));
+	return res;
+}
+
+}  // namespace
+
+TEST(IndexStatsTest, EstimatesEqualityByTopKeys) {
+	constexpr size_t kRows = 10000;
+	// Key 0 is in the half of the rows, the rest of the rows are uniformly distributed over 1000 keys
+	std::vector<IndexStats::KeyCount> counts;
+	counts.emplace_back(Variant(0), kRows / 2);
+	for (int i = 1; i <= 1000; ++i) counts.emplace_back(Variant(i), kRows / 2 / 1000);
+	const IndexStats stats(std::move(counts), kRows);
+
+	EXPECT_EQ(stats.Rows(), kRows);
+	EXPECT_EQ(stats.DistinctKeys(), 1001u);
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondEq, keys({0})), 0.5);
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondEq, keys({500})), 0.0005);
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondSet, keys({0, 500})), 0.5005);
+	// Keys are converted to the index type
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondEq, VariantArray{Variant(std::string("0"))}), 0.5);
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondAny, VariantArray{}), 1.0);
+	EXPECT_LT(stats.Selectivity(CondLike, keys({0})), 0.0);
+}
+
+TEST(IndexStatsTest, EstimatesRangesByHistogram) {
+	constexpr size_t kRows = 100000;
+	std::vector<IndexStats::KeyCount> counts;
+	for (int i = 0; i < int(kRows); ++i) counts.emplace_back(Variant(i), 1);
+	const IndexStats stats(std::move(counts), kRows);
+
+	constexpr double kPrecision = 0.02;
+	EXPECT_NEAR(stats.Selectivity(CondLt, keys({10000})), 0.1, kPrecision);
+	EXPECT_NEAR(stats.Selectivity(CondGe, keys({10000})), 0.9, kPrecision);
+	EXPECT_NEAR(stats.Selectivity(CondRange, keys({25000, 75000})), 0.5, kPrecision);
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondRange, keys({75000, 25000})), 0.0);
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondLt, keys({-1})), 0.0);
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondGt, keys({int(kRows)})), 0.0);
+}
+
+TEST(IndexStatsTest, RangesAreNotEstimatedForStrings) {
+	std::vector<IndexStats::KeyCount> counts;
+	counts.emplace_back(Variant(std::string("a")), 3);
+	counts.emplace_back(Variant(std::string("b")), 1);
+	const IndexStats stats(std::move(counts), 4);
+
+	EXPECT_DOUBLE_EQ(stats.Selectivity(CondEq, VariantArray{Variant(std::string("a"))}), 0.75);
+	EXPECT_LT(stats.Selectivity(CondGt, VariantArray{Variant(std::string("a"))}), 0.0);
+}
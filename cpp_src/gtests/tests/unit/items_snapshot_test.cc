@@ -0,0 +1,74 @@
+#include <chrono>
+#include <thread>
+#include "reindexer_api.h"
+#include "tools/fsops.h"
+
+TEST_F(ReindexerApi, ItemsSnapshotLoading) {
+	using reindexer::fs::JoinPath;
+	const std::string kDir = JoinPath(reindexer::fs::GetTempDir(), "ItemsSnapshotTest");
+	const std::string kSnapshotPath = JoinPath(JoinPath(kDir, default_namespace), "items.rxsnapshot");
+	const std::string kDsn = "builtin://" + kDir;
+	const char* const kConfigNs = "#config";
+	constexpr int kItemsCount = 2000;
+	reindexer::fs::RmDirAll(kDir);
+
+	auto connect = [&] {
+		rt.reindexer.reset(new Reindexer);
+		Error err = rt.reindexer->Connect(kDsn);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled());
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	auto upsertItem = [&](int id, const std::string& value) {
+		Item item = NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		Error err = item.FromJSON("{\"id\":" + std::to_string(id) + ",\"value\":\"" + value + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	};
+	auto checkItems = [&](int expectedCount, int modifiedId) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query(default_namespace).Sort("id", false), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), size_t(expectedCount));
+		for (auto it : qr) {
+			Item item = it.GetItem(false);
+			const int id = item["id"].As<int>();
+			ASSERT_EQ(item["value"].As<std::string>(), id == modifiedId ? "modified" : "value_" + std::to_string(id));
+		}
+	};
+
+	connect();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{"id", "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "tree", "string", IndexOpts(), 0}});
+	Item config = NewItem(kConfigNs);
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	Error err = config.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "optimization_timeout_ms":10, "items_snapshot_period_sec":1}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(kConfigNs, config);
+	for (int i = 0; i < kItemsCount; ++i) {
+		upsertItem(i, "value_" + std::to_string(i));
+	}
+
+	// Snapshot is written by background routine after indexes optimization
+	for (int i = 0; reindexer::fs::Stat(kSnapshotPath) != reindexer::fs::StatFile; ++i) {
+		ASSERT_LT(i, 200) << "Items snapshot was not written";
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	connect();
+	checkItems(kItemsCount, -1);
+
+	// Items updates make snapshot outdated, so namespace has to be loaded from storage records
+	upsertItem(10, "modified");
+	QueryResults qr;
+	err = rt.reindexer->Delete(Query(default_namespace).Where("id", CondGe, kItemsCount - 100), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	connect();
+	checkItems(kItemsCount - 100, 10);
+
+	rt.reindexer.reset();
+	reindexer::fs::RmDirAll(kDir);
+}
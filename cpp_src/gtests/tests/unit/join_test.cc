@@ -497,6 +497,117 @@ TEST_F(JoinSelectsApi, JoinPreResultStoreValuesOptimizationStressTest) {
 	for (auto& th : threads) th.join();
 }
 
+TEST_F(JoinSelectsApi, HashJoinTest) {
+	static const string leftNs = "hashJoinLeftNs";
+	static const string rightNs = "hashJoinRightNs";
+	static constexpr char const* data = "data";
+	static constexpr int kDataValues = 100;
+	static constexpr int kRightRows = 3000;
+	static constexpr int kRightPreselected = 2000;
+	static constexpr int kLeftRows = 1000;
+	static constexpr int kLeftDataValues = 150;
+
+	const auto createNs = [this](const string& ns, int rows, int dataValues) {
+		Error err = rt.reindexer->OpenNamespace(ns);
+		ASSERT_TRUE(err.ok()) << err.what();
+		DefineNamespaceDataset(
+			ns, {IndexDeclaration{id, "hash", "int", IndexOpts().PK(), 0}, IndexDeclaration{data, "hash", "int", IndexOpts(), 0}});
+		for (int i = 0; i < rows; ++i) {
+			Item item = NewItem(ns);
+			item[id] = i;
+			item[data] = i % dataValues;
+			Upsert(ns, item);
+		}
+		Commit(ns);
+	};
+	createNs(rightNs, kRightRows, kDataValues);
+	createNs(leftNs, kLeftRows, kLeftDataValues);
+
+	// Left rows are joined with many preselected right rows, so they are matched by the hash table instead of the sub-selects
+	Query q{Query(leftNs).Explain().InnerJoin(data, data, CondEq, Query(rightNs).Where(id, CondLt, kRightPreselected))};
+	QueryResults qr;
+	Error err = rt.reindexer->Select(q, qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	int expectedCount = 0;
+	for (int i = 0; i < kLeftRows; ++i) {
+		if (i % kLeftDataValues < kDataValues) ++expectedCount;
+	}
+	ASSERT_EQ(qr.Count(), size_t(expectedCount));
+	for (auto it : qr) {
+		int joinedCount = 0;
+		auto joined = it.GetJoined();
+		for (auto fieldIt = joined.begin(); fieldIt != joined.end(); ++fieldIt) {
+			joinedCount += fieldIt.ItemsCount();
+			QueryResults jqr = fieldIt.ToQueryResults();
+			jqr.addNSContext(qr.getPayloadType(1), qr.getTagsMatcher(1), qr.getFieldsFilter(1), qr.getSchema(1));
+			const VariantArray leftData = it.GetItem(false)[data];
+			ASSERT_EQ(leftData.size(), 1u);
+			for (auto jit : jqr) {
+				const VariantArray rightId = jit.GetItem(false)[id];
+				const VariantArray rightData = jit.GetItem(false)[data];
+				ASSERT_EQ(rightId.size(), 1u);
+				ASSERT_EQ(rightData.size(), 1u);
+				EXPECT_LT(rightId[0].As<int>(), kRightPreselected);
+				EXPECT_EQ(rightData[0].As<int>(), leftData[0].As<int>());
+			}
+		}
+		EXPECT_EQ(joinedCount, kRightPreselected / kDataValues);
+	}
+	const string& explain = qr.GetExplainResults();
+	if (explain.find("\"preselected_rows") != string::npos) {
+		EXPECT_NE(explain.find("\"preselected_rows_hash\""), string::npos) << explain;
+	}
+}
+
+TEST_F(JoinSelectsApi, SemiJoinTest) {
+	static const string leftNs = "semiJoinLeftNs";
+	static const string rightNs = "semiJoinRightNs";
+	static constexpr char const* data = "data";
+	static constexpr int kRightRows = 3000;
+	static constexpr int kRightSelected = 500;
+	static constexpr int kRightDataValues = 1000;
+	static constexpr int kLeftRows = 2000;
+
+	const auto createNs = [this](const string& ns, int rows, int dataValues) {
+		Error err = rt.reindexer->OpenNamespace(ns);
+		ASSERT_TRUE(err.ok()) << err.what();
+		DefineNamespaceDataset(
+			ns, {IndexDeclaration{id, "hash", "int", IndexOpts().PK(), 0}, IndexDeclaration{data, "hash", "int", IndexOpts(), 0}});
+		for (int i = 0; i < rows; ++i) {
+			Item item = NewItem(ns);
+			item[id] = i;
+			item[data] = i % dataValues;
+			Upsert(ns, item);
+		}
+		Commit(ns);
+	};
+	createNs(rightNs, kRightRows, kRightDataValues);
+	createNs(leftNs, kLeftRows, kLeftRows);
+
+	// Joined items are not requested, so the join is replaced by the condition on the distinct values of the right query
+	for (bool negative : {false, true}) {
+		Query q(leftNs);
+		if (negative) q.Not();
+		q.InnerJoin(data, data, CondEq, Query(rightNs).Where(id, CondLt, kRightSelected).Limit(0));
+		QueryResults qr;
+		Error err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), size_t(negative ? kLeftRows - kRightSelected : kRightSelected)) << negative;
+		for (auto it : qr) {
+			const int leftData = it.GetItem(false)[data].As<int>();
+			EXPECT_EQ(leftData < kRightSelected, !negative) << leftData;
+			EXPECT_EQ(it.GetJoined().getJoinedItemsCount(), 0) << leftData;
+		}
+	}
+
+	// Nothing is matched by the empty right query
+	QueryResults qr;
+	Error err = rt.reindexer->Select(Query(leftNs).InnerJoin(data, data, CondEq, Query(rightNs).Where(id, CondLt, 0).Limit(0)), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), 0u);
+}
+
 bool checkForAllowedJsonTags(const vector<string>& tags, gason::JsonValue jsonValue) {
 	size_t count = 0;
 	for (auto elem : jsonValue) {
@@ -597,6 +708,76 @@ TEST_F(JoinSelectsApi, TestMergeWithJoins) {
 	}
 }
 
+TEST_F(JoinSelectsApi, QueryResultsCache) {
+	SetQueryResultsCacheSize(authors_namespace, 1 << 24);
+	const Query query{Query(authors_namespace)
+						  .Where(age, CondGe, 30)
+						  .LeftJoin(authorid, authorid_fk, CondEq, Query(books_namespace).Sort(price, true))
+						  .Sort(age, true)
+						  .Limit(20)
+						  .ReqTotal()
+						  .Aggregate(AggMax, {age})};
+	const auto select = [&] {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(query, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		// Joined items and the contexts of the joined namespace are the part of the results as well as the main items
+		std::string res = qr.Dump() + "; total: " + std::to_string(qr.TotalCount());
+		for (const auto& agg : qr.GetAggregationResults()) res += "; max: " + std::to_string(agg.value);
+		for (auto it : qr) {
+			reindexer::WrSerializer ser;
+			err = it.GetJSON(ser, false);
+			EXPECT_TRUE(err.ok()) << err.what();
+			res += "; ";
+			res += ser.Slice();
+		}
+		return res;
+	};
+	const auto cacheStats = [&] {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, authors_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1);
+		reindexer::WrSerializer ser;
+		err = qr.begin().GetJSON(ser, false);
+		EXPECT_TRUE(err.ok()) << err.what();
+		gason::JsonParser parser;
+		const auto stats = parser.Parse(ser.Slice())["query_results_cache"];
+		return std::make_pair(stats["hits_count"].As<int>(), stats["misses_count"].As<int>());
+	};
+
+	// Results are stored on the second select
+	const std::string expected = select();
+	EXPECT_EQ(select(), expected);
+	EXPECT_EQ(cacheStats(), std::make_pair(0, 2));
+	EXPECT_EQ(select(), expected);
+	EXPECT_EQ(select(), expected);
+	EXPECT_EQ(cacheStats(), std::make_pair(2, 2));
+
+	// Modification of the joined namespace makes the cached results outdated
+	QueryResults deleted;
+	Error err = rt.reindexer->Delete(Query(books_namespace), deleted);
+	ASSERT_TRUE(err.ok()) << err.what();
+	const std::string withoutBooks = select();
+	EXPECT_NE(withoutBooks, expected);
+	EXPECT_EQ(cacheStats(), std::make_pair(2, 3));
+	EXPECT_EQ(select(), withoutBooks);
+	EXPECT_EQ(cacheStats(), std::make_pair(3, 3));
+
+	// Modification of the main namespace drops its cache, so the results are stored again on the second select
+	Item item = NewItem(authors_namespace);
+	item[authorid] = DostoevskyAuthorId + 1;
+	item[name] = "Leo Tolstoy";
+	item[age] = 150;
+	Upsert(authors_namespace, item);
+	const std::string withNewAuthor = select();
+	EXPECT_NE(withNewAuthor, withoutBooks);
+	EXPECT_NE(withNewAuthor.find("Leo Tolstoy"), std::string::npos);
+	EXPECT_EQ(select(), withNewAuthor);
+	EXPECT_EQ(select(), withNewAuthor);
+	EXPECT_EQ(cacheStats(), std::make_pair(4, 5));
+}
+
 TEST_F(JoinOnConditionsApi, TestGeneralConditions) {
 	const string sqlTemplate =
 		R"(select * from books_namespace inner join books_namespace on (books_namespace.authorid_fk = books_namespace.authorid_fk and books_namespace.pages %s books_namespace.pages);)";
@@ -757,3 +938,68 @@ TEST_F(JoinOnConditionsApi, TestInvalidConditions) {
 	err = rt.reindexer->Select(Query(books_namespace).InnerJoin(authorid_fk, authorid, CondLike, Query(authors_namespace)), qr);
 	EXPECT_TRUE(!err.ok());
 }
+
+TEST_F(JoinSelectsApi, JoinCacheFieldsInvalidation) {
+	TurnOnJoinCache(books_namespace);
+	const auto upsertBook = [&](int id, int bookPages, int bookPrice) {
+		Item item = NewItem(books_namespace);
+		item[bookid] = id;
+		item[title] = "The Idiot";
+		item[pages] = bookPages;
+		item[price] = bookPrice;
+		item[genreId_fk] = genresIds[0];
+		item[authorid_fk] = DostoevskyAuthorId;
+		Upsert(books_namespace, item);
+	};
+	const int firstBookId = 20000;
+	upsertBook(firstBookId, 10, 6000);
+	upsertBook(firstBookId + 1, 10, 7000);
+	upsertBook(firstBookId + 2, 10, 100);
+
+	const Query query{Query(authors_namespace)
+						  .Where(authorid, CondEq, DostoevskyAuthorId)
+						  .InnerJoin(authorid, authorid_fk, CondEq,
+									 Query(books_namespace).Where(price, CondGe, 5000).Where(bookid, CondGe, firstBookId))};
+	// Pages of the joined books by their ids
+	const auto select = [&] {
+		std::map<int, int> res;
+		for (int i = 0; i < 3; ++i) {
+			QueryResults qr;
+			Error err = rt.reindexer->Select(query, qr);
+			EXPECT_TRUE(err.ok()) << err.what();
+			EXPECT_EQ(qr.Count(), 1);
+			if (qr.Count() != 1) return res;
+			std::map<int, int> joined;
+			QueryResults jqr = qr.begin().GetJoined().begin().ToQueryResults();
+			jqr.addNSContext(qr.getPayloadType(1), qr.getTagsMatcher(1), qr.getFieldsFilter(1), qr.getSchema(1));
+			for (auto it : jqr) {
+				Item item = it.GetItem(false);
+				joined[item[bookid].As<int>()] = item[pages].As<int>();
+			}
+			// Cached and built results are the same
+			if (i) {
+				EXPECT_EQ(joined, res);
+			}
+			res = std::move(joined);
+		}
+		return res;
+	};
+
+	EXPECT_EQ(select(), (std::map<int, int>{{firstBookId, 10}, {firstBookId + 1, 10}}));
+
+	// Field, which is not in the conditions
+	upsertBook(firstBookId, 20, 6000);
+	EXPECT_EQ(select(), (std::map<int, int>{{firstBookId, 20}, {firstBookId + 1, 10}}));
+
+	// Fields of the conditions
+	upsertBook(firstBookId + 2, 10, 8000);
+	EXPECT_EQ(select(), (std::map<int, int>{{firstBookId, 20}, {firstBookId + 1, 10}, {firstBookId + 2, 10}}));
+	upsertBook(firstBookId + 1, 10, 100);
+	EXPECT_EQ(select(), (std::map<int, int>{{firstBookId, 20}, {firstBookId + 2, 10}}));
+
+	// Update query
+	QueryResults updated;
+	Error err = rt.reindexer->Update(Query(books_namespace).Where(bookid, CondEq, firstBookId).Set(price, {Variant(1)}), updated);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(select(), (std::map<int, int>{{firstBookId + 2, 10}}));
+}
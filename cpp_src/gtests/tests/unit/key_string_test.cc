@@ -0,0 +1,92 @@
+#include <thread>
+#include "core/keyvalue/key_string.h"
+#include "core/keyvalue/variant.h"
+#include "gtest/gtest.h"
+
+using reindexer::key_string;
+using reindexer::make_key_string;
+
+TEST(KeyStringTest, StringsAreReusedAfterRelease) {
+	std::vector<key_string> strings;
+	for (int i = 0; i < 10000; ++i) strings.emplace_back(make_key_string(std::to_string(i) + std::string(i % 40, 'x')));
+	for (int i = 0; i < 10000; ++i) {
+		ASSERT_EQ(std::string_view(*strings[i]), std::to_string(i) + std::string(i % 40, 'x'));
+	}
+
+	const void *released = strings.back().get();
+	strings.pop_back();
+	// Last released slot is the first one to be reused by the same thread
+	const key_string reused = make_key_string("reused");
+	EXPECT_EQ(reused.get(), released);
+	EXPECT_EQ(std::string_view(*reused), "reused");
+}
+
+TEST(KeyStringTest, StringsAreReleasedByOtherThreads) {
+	constexpr int kThreads = 4;
+	constexpr int kStringsPerThread = 20000;
+	std::vector<std::vector<key_string>> strings(kThreads);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < kThreads; ++t) {
+		threads.emplace_back([&strings, t] {
+			for (int i = 0; i < kStringsPerThread; ++i) strings[t].emplace_back(make_key_string(std::to_string(t * kStringsPerThread + i)));
+		});
+	}
+	for (auto &th : threads) th.join();
+	threads.clear();
+
+	// Strings are released by the other threads, than they were created by, and the threads allocate the new ones concurrently
+	for (int t = 0; t < kThreads; ++t) {
+		threads.emplace_back([&strings, t] {
+			auto &own = strings[(t + 1) % kThreads];
+			for (int i = 0; i < kStringsPerThread; ++i) {
+				ASSERT_EQ(std::string_view(*own[i]), std::to_string(((t + 1) % kThreads) * kStringsPerThread + i));
+				own[i] = make_key_string(std::to_string(-i));
+			}
+			for (int i = 0; i < kStringsPerThread; ++i) ASSERT_EQ(std::string_view(*own[i]), std::to_string(-i));
+			own.clear();
+		});
+	}
+	for (auto &th : threads) th.join();
+}
+
+#ifndef REINDEX_WITH_ASAN
+TEST(KeyStringTest, FreeSlabsAreReleased) {
+	const size_t slabsBefore = reindexer::key_string_slabs_count();
+	size_t slabsAllocated = 0;
+	// Thread cache of the free slots is flushed, when the thread exits
+	std::thread th([&slabsAllocated] {
+		std::vector<key_string> strings;
+		for (int i = 0; i < 100000; ++i) strings.emplace_back(make_key_string(std::to_string(i)));
+		slabsAllocated = reindexer::key_string_slabs_count();
+	});
+	th.join();
+	EXPECT_GT(slabsAllocated, slabsBefore);
+	// Single completely free slab is kept for the next allocations
+	EXPECT_LE(reindexer::key_string_slabs_count(), slabsBefore + 1);
+}
+#endif	// REINDEX_WITH_ASAN
+
+TEST(KeyStringTest, VariantViewsDontHoldStrings) {
+	using reindexer::Variant;
+	using reindexer::VariantArray;
+	const key_string str = make_key_string("hot_key");
+	Variant held(str);
+	EXPECT_FALSE(str.unique());
+
+	VariantArray views;
+	for (int i = 0; i < 10; ++i) views.emplace_back(held.View());
+	VariantArray copies = views.View();
+	copies.emplace_back(copies.back());
+	held = Variant();
+	// Views refer to the string, while it's held by the others
+	EXPECT_TRUE(str.unique());
+	for (const Variant &v : copies) {
+		ASSERT_EQ(v, Variant(str));
+		ASSERT_EQ(v.As<std::string>(), "hot_key");
+	}
+
+	Variant holder = copies.front();
+	holder.EnsureHold();
+	EXPECT_FALSE(str.unique());
+	EXPECT_EQ(Variant(42).View(), Variant(42));
+}
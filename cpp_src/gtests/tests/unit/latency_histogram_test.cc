@@ -0,0 +1,51 @@
+#include "core/perfstatcounter.h"
+#include "gtest/gtest.h"
+
+using reindexer::LatencyHistogram;
+
+TEST(LatencyHistogramTest, QuantilesAreWithinRelativeError) {
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.Quantile(0.99), 0u);
+
+	for (uint64_t v = 1; v <= 100000; ++v) histogram.Add(v);
+	ASSERT_EQ(histogram.Count(), 100000u);
+	const double maxError = 1.0 / LatencyHistogram::kSubBuckets;
+	for (double q : {0.5, 0.9, 0.99, 0.999}) {
+		const double expected = q * 100000;
+		const double actual = histogram.Quantile(q);
+		EXPECT_GE(actual, expected) << q;
+		EXPECT_LE(actual, expected * (1 + maxError)) << q;
+	}
+	EXPECT_EQ(histogram.Quantile(1.0), 100000u);
+	EXPECT_EQ(histogram.Quantile(0.0), 1u);
+
+	// Small values are counted exactly, huge values are limited by the max value
+	LatencyHistogram small;
+	for (uint64_t v : {0, 3, 5, 7}) small.Add(v);
+	EXPECT_EQ(small.Quantile(0.5), 3u);
+	small.Add(uint64_t(1) << 50);
+	EXPECT_EQ(small.Quantile(1.0), uint64_t(1) << 50);
+}
+
+TEST(LatencyHistogramTest, MergesAndResets) {
+	LatencyHistogram fast, slow, empty;
+	for (int i = 0; i < 990; ++i) fast.Add(10);
+	for (int i = 0; i < 10; ++i) slow.Add(5000);
+
+	fast.Merge(empty);
+	EXPECT_EQ(fast.Count(), 990u);
+	empty.Merge(slow);
+	EXPECT_EQ(empty.Quantile(0.5), 5000u);
+
+	fast.Merge(slow);
+	EXPECT_EQ(fast.Count(), 1000u);
+	EXPECT_EQ(fast.Quantile(0.5), 10u);
+	EXPECT_EQ(fast.Quantile(0.99), 10u);
+	EXPECT_EQ(fast.Quantile(0.995), 5000u);
+
+	fast.Reset();
+	EXPECT_EQ(fast.Count(), 0u);
+	EXPECT_EQ(fast.Quantile(0.99), 0u);
+	fast.Add(20);
+	EXPECT_EQ(fast.Quantile(0.99), 20u);
+}
@@ -0,0 +1,57 @@
+#include <random>
+#include "core/index/learnedkeys.h"
+#include "gtest/gtest.h"
+
+using reindexer::LearnedKeys;
+
+namespace {
+
+template <typename K>
+void checkLookups(std::vector<K> keys, const std::vector<K> &lookups) {
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	std::vector<size_t> values(keys.size());
+	for (size_t i = 0; i < values.size(); ++i) values[i] = i;
+	const std::vector<K> expected = keys;
+	const LearnedKeys<K, size_t> learned(std::move(keys), std::move(values));
+	ASSERT_EQ(learned.Size(), expected.size());
+	for (K key : lookups) {
+		ASSERT_EQ(learned.LowerBound(key), size_t(std::lower_bound(expected.begin(), expected.end(), key) - expected.begin())) << key;
+		ASSERT_EQ(learned.UpperBound(key), size_t(std::upper_bound(expected.begin(), expected.end(), key) - expected.begin())) << key;
+	}
+}
+
+}  // namespace
+
+TEST(LearnedKeysTest, SequentialKeysAreCoveredByFewSegments) {
+	std::vector<int64_t> keys, lookups;
+	// Timestamps with the small irregular gaps
+	for (int64_t i = 0; i < 100000; ++i) keys.push_back(1600000000000 + i * 10 + i % 7);
+	for (int64_t k = keys.front() - 5; k < keys.back() + 5; k += 3) lookups.push_back(k);
+
+	std::vector<size_t> values(keys.size());
+	const LearnedKeys<int64_t, size_t> learned(std::vector<int64_t>(keys), std::move(values));
+	EXPECT_LT(learned.SegmentsCount(), 10u);
+	checkLookups(keys, lookups);
+}
+
+TEST(LearnedKeysTest, RandomKeys) {
+	std::mt19937 rnd(17);
+	std::vector<int> keys, lookups;
+	for (int i = 0; i < 50000; ++i) keys.push_back(int(rnd() % 1000000) - 500000);
+	for (int i = 0; i < 50000; ++i) lookups.push_back(int(rnd() % 1100000) - 550000);
+	for (int k : {std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), keys.front(), keys.back()}) lookups.push_back(k);
+	checkLookups(keys, lookups);
+}
+
+TEST(LearnedKeysTest, LargeKeysAndEmptyKeys) {
+	// Distinct int64 keys, which are not distinct after conversion to double
+	std::vector<int64_t> keys, lookups;
+	const int64_t kLarge = std::numeric_limits<int64_t>::max() - 5000;
+	for (int64_t i = 0; i < 5000; ++i) keys.push_back(kLarge + i);
+	for (int64_t i = 0; i < 1000; ++i) keys.push_back(std::numeric_limits<int64_t>::min() + i * 1000000);
+	for (int64_t i = -10; i < 5010; ++i) lookups.push_back(kLarge + std::min<int64_t>(i, 5004));
+	for (int64_t i = 0; i < 1000; ++i) lookups.push_back(std::numeric_limits<int64_t>::min() + i * 999999);
+	checkLookups(keys, lookups);
+	checkLookups(std::vector<int64_t>{}, lookups);
+}
@@ -0,0 +1,61 @@
+#include <thread>
+#include "core/rdxcontext.h"
+#include "estl/contexted_locks.h"
+#include "estl/shared_mutex.h"
+#include "gtest/gtest.h"
+
+using reindexer::LockStats;
+using Mutex = reindexer::ProfiledMarkedMutex<reindexer::shared_timed_mutex, reindexer::MutexMark::Namespace>;
+using WLock = reindexer::contexted_unique_lock<Mutex, const reindexer::RdxContext>;
+using RLock = reindexer::contexted_shared_lock<Mutex, const reindexer::RdxContext>;
+
+TEST(LockStatsTest, CountsWaitAndHoldTimes) {
+	Mutex mtx;
+	const reindexer::RdxContext ctx;
+	{
+		// Stats are disabled by default
+		WLock lck(mtx, &ctx);
+	}
+	EXPECT_EQ(mtx.Stats().Get(LockStats::ExclusiveHold).count, 0u);
+
+	mtx.Stats().Enable(true);
+	{
+		WLock lck(mtx, &ctx);
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	{
+		RLock lck1(mtx, &ctx);
+		RLock lck2(mtx, &ctx);
+		lck2.unlock();
+	}
+
+	const auto writeHold = mtx.Stats().Get(LockStats::ExclusiveHold);
+	EXPECT_EQ(writeHold.count, 1u);
+	EXPECT_GE(writeHold.maxUs, 5000u);
+	EXPECT_GE(writeHold.totalUs, 5000u);
+	EXPECT_GE(writeHold.p99Us, 4096u);
+	EXPECT_LE(writeHold.p99Us, writeHold.maxUs);
+	EXPECT_EQ(mtx.Stats().Get(LockStats::ExclusiveWait).count, 1u);
+	EXPECT_EQ(mtx.Stats().Get(LockStats::SharedWait).count, 2u);
+	EXPECT_EQ(mtx.Stats().Get(LockStats::SharedHold).count, 2u);
+
+	mtx.Stats().Reset();
+	EXPECT_EQ(mtx.Stats().Get(LockStats::ExclusiveHold).count, 0u);
+	EXPECT_EQ(mtx.Stats().Get(LockStats::ExclusiveHold).maxUs, 0u);
+}
+
+TEST(LockStatsTest, CountsWaitOfTheBlockedWriter) {
+	Mutex mtx;
+	mtx.Stats().Enable(true);
+	const reindexer::RdxContext ctx;
+
+	RLock reader(mtx, &ctx);
+	std::thread writer([&mtx, &ctx] { WLock lck(mtx, &ctx); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	reader.unlock();
+	writer.join();
+
+	const auto writeWait = mtx.Stats().Get(LockStats::ExclusiveWait);
+	EXPECT_EQ(writeWait.count, 1u);
+	EXPECT_GE(writeWait.maxUs, 10000u);
+}
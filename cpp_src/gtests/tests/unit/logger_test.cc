@@ -0,0 +1,51 @@
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/type_consts.h"
+#include "gtest/gtest.h"
+#include "tools/logger.h"
+
+using std::chrono::milliseconds;
+
+TEST(LoggerTest, MaxLevel) {
+	std::atomic<int> written{0};
+	reindexer::logInstallWriter([&](int, char *) { ++written; });
+	reindexer::logSetMaxLevel(LogWarning);
+	EXPECT_FALSE(reindexer::logLevelEnabled(LogInfo));
+	reindexer::logPrintf(LogInfo, "skipped %d", 1);
+	reindexer::logPrintf(LogError, "written %d", 2);
+	EXPECT_EQ(written.load(), 1);
+	reindexer::logSetMaxLevel(LogTrace);
+	reindexer::logInstallWriter(nullptr);
+}
+
+TEST(LoggerTest, AsyncDoesNotBlock) {
+	std::mutex mtx;
+	std::vector<std::string> records;
+	std::atomic<bool> blockWriter{true};
+	const auto callerThread = std::this_thread::get_id();
+	std::atomic<bool> writtenByCaller{false};
+	reindexer::logInstallWriter([&](int, char *buf) {
+		if (std::this_thread::get_id() == callerThread) writtenByCaller = true;
+		while (blockWriter) std::this_thread::sleep_for(milliseconds(1));
+		std::lock_guard<std::mutex> lck(mtx);
+		records.emplace_back(buf);
+	});
+	reindexer::logEnableAsync(16);
+	const size_t droppedBefore = reindexer::logDroppedRecords();
+	constexpr int kRecords = 1000;
+	// Writer is blocked, so the records beyond the ring's size are dropped instead of blocking the caller
+	for (int i = 0; i < kRecords; ++i) reindexer::logPrintf(LogError, "record %d", i);
+	const size_t dropped = reindexer::logDroppedRecords() - droppedBefore;
+	EXPECT_GE(dropped, size_t(kRecords - 16 - 1));
+	blockWriter = false;
+	reindexer::logDisableAsync();
+	reindexer::logInstallWriter(nullptr);
+
+	EXPECT_FALSE(writtenByCaller.load());
+	EXPECT_EQ(records.size() + dropped, size_t(kRecords));
+	ASSERT_FALSE(records.empty());
+	EXPECT_EQ(records.front(), "record 0");
+}
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/maintenancescheduler.h"
+#include "gtest/gtest.h"
+
+using reindexer::MaintenanceScheduler;
+using Priority = MaintenanceScheduler::Priority;
+using std::chrono::milliseconds;
+
+static MaintenanceScheduler::Config schedulerConfig(int workers, int deferLoadThreshold = 0,
+													 milliseconds maxDeferral = milliseconds(5000)) {
+	MaintenanceScheduler::Config cfg;
+	cfg.workers = workers;
+	cfg.deferLoadThreshold = deferLoadThreshold;
+	cfg.maxDeferral = maxDeferral;
+	return cfg;
+}
+
+TEST(MaintenanceSchedulerTest, ExecutesByPriority) {
+	MaintenanceScheduler scheduler;
+	std::mutex mtx;
+	std::vector<std::string> order;
+	auto record = [&](std::string name) {
+		return [&, name] {
+			std::lock_guard<std::mutex> lck(mtx);
+			order.emplace_back(name);
+		};
+	};
+	// Tasks are scheduled before the workers start, so all of them are due at once
+	scheduler.Schedule("ns1", Priority::Low, milliseconds(10000), record("low"));
+	scheduler.Schedule("ns2", Priority::Normal, milliseconds(10000), record("normal"));
+	scheduler.Schedule("ns3", Priority::High, milliseconds(10000), record("high"));
+	scheduler.SetConfig(schedulerConfig(1));
+	for (int i = 0; i < 200; ++i) {
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			if (order.size() == 3) break;
+		}
+		std::this_thread::sleep_for(milliseconds(10));
+	}
+	scheduler.Stop();
+	ASSERT_EQ(order, (std::vector<std::string>{"high", "normal", "low"}));
+}
+
+TEST(MaintenanceSchedulerTest, LongTaskDoesNotBlockOtherOwners) {
+	MaintenanceScheduler scheduler;
+	scheduler.SetConfig(schedulerConfig(2));
+	std::atomic<int> running{0}, maxRunning{0}, otherCalls{0};
+	auto slow = [&] {
+		const int cur = ++running;
+		int prev = maxRunning.load();
+		while (prev < cur && !maxRunning.compare_exchange_weak(prev, cur)) {
+		}
+		std::this_thread::sleep_for(milliseconds(300));
+		--running;
+	};
+	scheduler.Schedule("slow", Priority::Normal, milliseconds(1), slow);
+	scheduler.Schedule("slow", Priority::High, milliseconds(1), slow);
+	scheduler.Schedule("other", Priority::High, milliseconds(1), [&] { ++otherCalls; });
+	std::this_thread::sleep_for(milliseconds(500));
+	scheduler.Stop();
+	// Tasks of the same owner are never executed concurrently
+	EXPECT_EQ(maxRunning.load(), 1);
+	EXPECT_GT(otherCalls.load(), 10);
+}
+
+TEST(MaintenanceSchedulerTest, DefersOnForegroundLoad) {
+	MaintenanceScheduler scheduler;
+	std::atomic<int> normalCalls{0}, highCalls{0};
+	{
+		MaintenanceScheduler::ForegroundOp op(scheduler);
+		EXPECT_EQ(scheduler.ForegroundOps(), 1);
+		scheduler.SetConfig(schedulerConfig(1, 1, milliseconds(10000)));
+		scheduler.Schedule("ns1", Priority::Normal, milliseconds(1), [&] { ++normalCalls; });
+		scheduler.Schedule("ns2", Priority::High, milliseconds(1), [&] { ++highCalls; });
+		std::this_thread::sleep_for(milliseconds(200));
+		EXPECT_EQ(normalCalls.load(), 0);
+		EXPECT_GT(highCalls.load(), 0);
+		EXPECT_EQ(scheduler.DeferredCount(), 1u);
+	}
+	EXPECT_EQ(scheduler.ForegroundOps(), 0);
+	for (int i = 0; i < 200 && !normalCalls.load(); ++i) std::this_thread::sleep_for(milliseconds(10));
+	EXPECT_GT(normalCalls.load(), 0);
+
+	// Deferred task is executed after its deadline despite the load
+	scheduler.SetConfig(schedulerConfig(1, 1, milliseconds(50)));
+	MaintenanceScheduler::ForegroundOp op(scheduler);
+	const int calls = normalCalls.load();
+	for (int i = 0; i < 200 && normalCalls.load() == calls; ++i) std::this_thread::sleep_for(milliseconds(10));
+	EXPECT_GT(normalCalls.load(), calls);
+	scheduler.Stop();
+}
+
+TEST(MaintenanceSchedulerTest, RemovesOwnerTasks) {
+	MaintenanceScheduler scheduler;
+	scheduler.SetConfig(schedulerConfig(2));
+	std::atomic<int> calls{0};
+	scheduler.Schedule("ns1", Priority::Normal, milliseconds(1), [&] { ++calls; });
+	for (int i = 0; i < 200 && !calls.load(); ++i) std::this_thread::sleep_for(milliseconds(10));
+	scheduler.Remove("ns1");
+	// Wait for the task, which may be running during the removal
+	std::this_thread::sleep_for(milliseconds(50));
+	const int removedCalls = calls.load();
+	std::this_thread::sleep_for(milliseconds(100));
+	EXPECT_EQ(calls.load(), removedCalls);
+	scheduler.Stop();
+}
@@ -0,0 +1,68 @@
+#include <memory>
+#include "core/memaccounting.h"
+#include "gtest/gtest.h"
+
+using reindexer::MemAccount;
+using reindexer::MemAccountingScope;
+
+TEST(MemAccountingTest, ChargesCurrentScope) {
+	MemAccount account;
+	MemAccountingScope::Charge(100);
+	EXPECT_FALSE(MemAccountingScope::Active());
+	{
+		MemAccountingScope scope(&account, MemAccount::Data);
+		EXPECT_TRUE(MemAccountingScope::Active());
+		MemAccountingScope::Charge(100);
+		{
+			MemAccountingScope idxScope(MemAccount::Indexes);
+			MemAccountingScope::Charge(30);
+			{
+				MemAccountingScope ftScope(MemAccount::Fulltext);
+				MemAccountingScope::Charge(20);
+				MemAccountingScope::Charge(-5);
+			}
+			MemAccountingScope::Charge(-10);
+		}
+		{
+			MemAccountingScope selectScope(MemAccount::Untracked);
+			EXPECT_FALSE(MemAccountingScope::Active());
+			MemAccountingScope::Charge(1000);
+		}
+		MemAccountingScope::Charge(-40);
+	}
+	EXPECT_FALSE(MemAccountingScope::Active());
+	MemAccountingScope::Charge(-100);
+
+	EXPECT_EQ(account.Get(MemAccount::Data), 60);
+	EXPECT_EQ(account.Get(MemAccount::Indexes), 20);
+	EXPECT_EQ(account.Get(MemAccount::Fulltext), 15);
+	EXPECT_EQ(account.Total(), 95);
+}
+
+TEST(MemAccountingTest, NestedAccounts) {
+	MemAccount outer, inner;
+	MemAccountingScope outerScope(&outer, MemAccount::Indexes);
+	{
+		MemAccountingScope innerScope(&inner, MemAccount::Data);
+		MemAccountingScope::Charge(10);
+	}
+	MemAccountingScope::Charge(20);
+	EXPECT_EQ(inner.Total(), 10);
+	EXPECT_EQ(inner.Get(MemAccount::Data), 10);
+	EXPECT_EQ(outer.Total(), 20);
+	EXPECT_EQ(outer.Get(MemAccount::Indexes), 20);
+}
+
+TEST(MemAccountingTest, AccountGuard) {
+	reindexer::MemAccountGuard guard(std::make_shared<MemAccount>());
+	const auto &account = *guard.Account();
+	MemAccountingScope::Charge(10);
+	guard.Leave();
+	MemAccountingScope::Charge(100);
+	guard.Enter();
+	guard.Enter();
+	MemAccountingScope::Charge(-3);
+	guard.Leave();
+	EXPECT_FALSE(MemAccountingScope::Active());
+	EXPECT_EQ(account.Get(MemAccount::Data), 7);
+}
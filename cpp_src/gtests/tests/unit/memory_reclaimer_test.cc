@@ -0,0 +1,30 @@
+#include "core/namespace/memoryreclaimer.h"
+#include "gtest/gtest.h"
+
+using reindexer::MemoryReclaimer;
+using reindexer::NsItems;
+
+TEST(MemoryReclaimerTest, ItemsAreReleasedByPortions) {
+	auto makeItems = [](size_t pages) {
+		NsItems items;
+		for (size_t i = 0; i < pages * NsItems::kPageSize; ++i) items.emplace_back(reindexer::PayloadValue(8));
+		return items;
+	};
+	MemoryReclaimer reclaimer;
+	EXPECT_TRUE(reclaimer.Empty());
+	reclaimer.Add(NsItems());
+	EXPECT_TRUE(reclaimer.Empty());
+
+	NsItems items = makeItems(MemoryReclaimer::kPagesPerStep + 1);
+	reclaimer.Add(std::move(items));
+	EXPECT_TRUE(items.empty());
+	reclaimer.Add(makeItems(1));
+	EXPECT_FALSE(reclaimer.Empty());
+
+	// The first items take two steps, and the second ones take the single step
+	EXPECT_FALSE(reclaimer.ReleaseStep(nullptr));
+	EXPECT_FALSE(reclaimer.ReleaseStep(nullptr));
+	EXPECT_TRUE(reclaimer.ReleaseStep(nullptr));
+	EXPECT_TRUE(reclaimer.Empty());
+	EXPECT_TRUE(reclaimer.ReleaseStep(nullptr));
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include "estl/monotonic_arena.h"
+#include "vendor/cpp-btree/btree_map.h"
+
+using reindexer::ArenaAllocator;
+using reindexer::MonotonicArena;
+
+TEST(MonotonicArena, Allocations) {
+	MonotonicArena arena(256);
+	ASSERT_EQ(arena.Allocated(), 0u);
+	for (size_t size : {1, 7, 16, 100, 200, 1000, 3, 5000}) {
+		void *p = arena.Allocate(size);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % MonotonicArena::kAlignment, 0u);
+		memset(p, 0xAB, size);
+	}
+	EXPECT_GE(arena.Allocated(), 6000u);
+	arena.Release();
+	EXPECT_EQ(arena.Allocated(), 0u);
+	EXPECT_NE(arena.Allocate(10), nullptr);
+}
+
+TEST(MonotonicArena, Containers) {
+	MonotonicArena arena;
+	{
+		std::unordered_set<std::string, std::hash<std::string>, std::equal_to<std::string>, ArenaAllocator<std::string>> set(
+			16, std::hash<std::string>(), std::equal_to<std::string>(), &arena);
+		btree::btree_map<int, int, std::less<int>, ArenaAllocator<std::pair<const int, int>>> map(std::less<int>(), &arena);
+		for (int i = 0; i < 10000; ++i) {
+			set.insert(std::to_string(i % 5000));
+			++map[i % 3000];
+		}
+		ASSERT_EQ(set.size(), 5000u);
+		ASSERT_EQ(map.size(), 3000u);
+		for (const auto &v : map) ASSERT_EQ(v.second, v.first < 1000 ? 4 : 3);
+		EXPECT_GT(arena.Allocated(), 0u);
+	}
+	// Allocator without arena works as std::allocator
+	std::unordered_set<int, std::hash<int>, std::equal_to<int>, ArenaAllocator<int>> heapSet(16);
+	for (int i = 0; i < 1000; ++i) heapSet.insert(i);
+	EXPECT_EQ(heapSet.size(), 1000u);
+}
@@ -1,10 +1,18 @@
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <numeric>
+#include <set>
+#include <thread>
+#include "core/cbinding/reindexer_ctypes.h"
 #include "core/cbinding/resultserializer.h"
 #include "core/cjson/ctag.h"
 #include "core/cjson/jsonbuilder.h"
 #include "core/cjson/msgpackbuilder.h"
 #include "core/cjson/msgpackdecoder.h"
 #include "core/itemimpl.h"
+#include "core/namespace/namespacestat.h"
+#include "core/queryresults/columnarencoder.h"
 #include "estl/span.h"
 #include "ns_api.h"
 #include "tools/jsontools.h"
@@ -1542,6 +1550,30 @@ TEST_F(NsApi, TestUpdateFieldWithExpressions) {
 	}
 }
 
+TEST_F(NsApi, TestUpdateFieldWithFieldsExpressions) {
+	// Expression is compiled once per query, but the fields values are taken from each updated item
+	DefineDefaultNamespace();
+	AddUnindexedData();
+
+	QueryResults qr;
+	Error err = rt.reindexer->Select("update test_namespace set int_field = nested.bonus / 2 + id * 2 where id >= 1000", qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1000) << qr.Count();
+	for (auto &it : qr) {
+		Item item = it.GetItem(false);
+		ASSERT_EQ(item[intField].As<int>(), item[idIdxName].As<int>() * 3) << item.GetJSON();
+	}
+
+	// Missing field is not an error, if the query does not match any items
+	QueryResults qrEmpty;
+	err = rt.reindexer->Select("update test_namespace set int_field = missing_field + 1 where id < 0", qrEmpty);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qrEmpty.Count(), 0);
+	QueryResults qrMissing;
+	err = rt.reindexer->Select("update test_namespace set int_field = missing_field + 1 where id = 1000", qrMissing);
+	ASSERT_FALSE(err.ok());
+}
+
 void checkQueryDsl(const Query &src) {
 	Query dst;
 	const string dsl = src.GetJSON();
@@ -1820,3 +1852,2321 @@ TEST_F(NsApi, DeleteLastItems) {
 	ASSERT_TRUE(err.ok()) << err.what();
 	ASSERT_EQ(qr.Count(), 2);
 }
+
+TEST_F(NsApi, ColumnarIndexes) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace,
+						   {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+							IndexDeclaration{"hash_value", "hash", "int64", IndexOpts().Columnar(), 0},
+							IndexDeclaration{"tree_value", "tree", "double", IndexOpts().Columnar(), 0},
+							IndexDeclaration{"store_value", "-", "int", IndexOpts().Dense().Columnar(), 0}});
+
+	// Columnar option is not allowed for strings, arrays and sparse indexes
+	err = rt.reindexer->AddIndex(default_namespace, reindexer::IndexDef{"str_value", {"str_value"}, "hash", "string", IndexOpts().Columnar()});
+	EXPECT_EQ(err.code(), errParams) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace,
+								 reindexer::IndexDef{"arr_value", {"arr_value"}, "tree", "int", IndexOpts().Array().Columnar()});
+	EXPECT_EQ(err.code(), errParams) << err.what();
+
+	constexpr int kItemsCount = 1000;
+	std::vector<int> values(kItemsCount);
+	auto upsertItem = [&](int id, int value) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["hash_value"] = int64_t(value);
+		item["tree_value"] = double(value) / 2;
+		item["store_value"] = value;
+		Upsert(default_namespace, item);
+		values[id] = value;
+	};
+	for (int i = 0; i < kItemsCount; ++i) upsertItem(i, i % 100 - 50);
+	// Rewrite some values to check that columns are updated
+	for (int i = 50; i < kItemsCount; i += 100) upsertItem(i, -50);
+
+	double sum = 0, minVal = std::numeric_limits<double>::max(), maxVal = std::numeric_limits<double>::lowest();
+	size_t filteredCount = 0, minValuesCount = 0;
+	for (int value : values) {
+		if (value >= -10 && value <= 10) {
+			++filteredCount;
+			sum += value;
+			minVal = std::min(minVal, double(value));
+			maxVal = std::max(maxVal, double(value));
+		}
+		if (value == -50) ++minValuesCount;
+	}
+
+	for (const char* field : {"hash_value", "store_value"}) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace)
+									   .Where(field, CondRange, {-10, 10})
+									   .Aggregate(AggSum, {field})
+									   .Aggregate(AggMin, {field})
+									   .Aggregate(AggMax, {field}),
+								   qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), filteredCount) << field;
+		ASSERT_EQ(qr.GetAggregationResults().size(), 3u);
+		EXPECT_EQ(qr.GetAggregationResults()[0].value, sum) << field;
+		EXPECT_EQ(qr.GetAggregationResults()[1].value, minVal) << field;
+		EXPECT_EQ(qr.GetAggregationResults()[2].value, maxVal) << field;
+	}
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Where("tree_value", CondLt, {-24.5}).Aggregate(AggSum, {"tree_value"}), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), minValuesCount);
+	ASSERT_EQ(qr.GetAggregationResults().size(), 1u);
+	EXPECT_EQ(qr.GetAggregationResults()[0].value, -25.0 * minValuesCount);
+}
+
+TEST_F(NsApi, ParallelFullScan) {
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"store_value", "-", "int", IndexOpts(), 0}});
+
+	const char* const configNs = "#config";
+	Item item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "parallel_scan_workers":4, "parallel_scan_threshold":10000}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	err = Commit(configNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	constexpr int kItemsCount = 40000;
+	for (int i = 0; i < kItemsCount; ++i) {
+		Item it = NewItem(default_namespace);
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(i) + ",\"store_value\":" + std::to_string(i % 1000) +
+						  ",\"value\":" + std::to_string(i % 7) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+	// Free some rows in the middle of the namespace
+	QueryResults delQr;
+	err = rt.reindexer->Delete(Query(default_namespace).Where(idIdxName, CondRange, {15000, 17000}), delQr);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto makeQuery = [&](ParallelScanMode mode) {
+		return Query(default_namespace).Where("store_value", CondLt, {500}).Where("value", CondGt, {2}).ParallelScan(mode);
+	};
+	const std::vector<std::function<Query(ParallelScanMode)>> queries = {
+		[&](ParallelScanMode mode) { return makeQuery(mode).ReqTotal(); },
+		[&](ParallelScanMode mode) { return makeQuery(mode).Limit(100).Offset(12000).ReqTotal(); },
+		[&](ParallelScanMode mode) {
+			return makeQuery(mode).Aggregate(AggSum, {"store_value"}).Aggregate(AggMin, {"value"}).Aggregate(AggMax, {"value"}).Limit(0);
+		},
+		[&](ParallelScanMode mode) { return makeQuery(mode).Aggregate(AggAvg, {"store_value"}).Limit(1000); },
+		[&](ParallelScanMode mode) { return makeQuery(mode).Aggregate(AggDistinct, {"value"}).Aggregate(AggSum, {"store_value"}); },
+		[&](ParallelScanMode mode) {
+			return makeQuery(mode).Aggregate(AggFacet, {"value"}, {{"count", true}}).Aggregate(AggFacet, {"value", "store_value"});
+		},
+	};
+	for (const auto& makeQ : queries) {
+		for (ParallelScanMode mode : {ParallelScanNotSet, ParallelScanOn}) {
+			QueryResults sequentialQr, parallelQr;
+			err = rt.reindexer->Select(makeQ(ParallelScanOff), sequentialQr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			const Query q = makeQ(mode);
+			err = rt.reindexer->Select(q, parallelQr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			ASSERT_EQ(parallelQr.Count(), sequentialQr.Count()) << q.GetSQL();
+			EXPECT_EQ(parallelQr.TotalCount(), sequentialQr.TotalCount()) << q.GetSQL();
+			for (auto pit = parallelQr.begin(), sit = sequentialQr.begin(); pit != parallelQr.end(); ++pit, ++sit) {
+				ASSERT_EQ(pit.GetItemRef().Id(), sit.GetItemRef().Id()) << q.GetSQL();
+			}
+			const auto& parallelAggs = parallelQr.GetAggregationResults();
+			const auto& sequentialAggs = sequentialQr.GetAggregationResults();
+			ASSERT_EQ(parallelAggs.size(), sequentialAggs.size()) << q.GetSQL();
+			for (size_t i = 0; i < parallelAggs.size(); ++i) {
+				EXPECT_EQ(parallelAggs[i].value, sequentialAggs[i].value) << q.GetSQL();
+				// Partial results of the parallel scan are merged, so unordered distincts and facets may be listed in other order
+				auto parallelDistincts = parallelAggs[i].distincts, sequentialDistincts = sequentialAggs[i].distincts;
+				std::sort(parallelDistincts.begin(), parallelDistincts.end());
+				std::sort(sequentialDistincts.begin(), sequentialDistincts.end());
+				EXPECT_EQ(parallelDistincts, sequentialDistincts) << q.GetSQL();
+				const auto facetsList = [](const reindexer::AggregationResult& agg) {
+					std::vector<std::pair<std::vector<std::string>, int>> res;
+					for (const auto& f : agg.facets) res.emplace_back(std::vector<std::string>(f.values.begin(), f.values.end()), f.count);
+					std::sort(res.begin(), res.end());
+					return res;
+				};
+				EXPECT_EQ(facetsList(parallelAggs[i]), facetsList(sequentialAggs[i])) << q.GetSQL();
+			}
+		}
+	}
+}
+
+TEST_F(NsApi, BatchFiltersReorderedBySelectivity) {
+	// Unselective condition goes first in the query, but it has to be checked after the selective one during the most part of the scan
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"wide", "-", "int", IndexOpts(), 0},
+											   IndexDeclaration{"narrow", "-", "int", IndexOpts(), 0}});
+	constexpr int kItemsCount = 40000;
+	for (int i = 0; i < kItemsCount; ++i) {
+		Item it = NewItem(default_namespace);
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(i) + ",\"wide\":" + std::to_string(i % 100) +
+						  ",\"narrow\":" + std::to_string(i % 100 == 1 ? 1 : 0) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+
+	QueryResults qr;
+	err = rt.reindexer->Select(
+		Query(default_namespace).Where("wide", CondLt, {90}).Where("narrow", CondEq, {1}).ParallelScan(ParallelScanOff).Explain(), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), kItemsCount / 100);
+	for (auto it : qr) ASSERT_EQ(it.GetItem(false)["narrow"].As<int>(), 1);
+
+	gason::JsonParser parser;
+	const auto explain = parser.Parse(std::string_view(qr.GetExplainResults()));
+	int wideMatched = -1;
+	for (const auto& sel : explain["selectors"]) {
+		if (sel["field"].As<std::string>() == "wide") wideMatched = sel["matched"].As<int>();
+	}
+	ASSERT_GE(wideMatched, 0) << qr.GetExplainResults();
+	EXPECT_LT(wideMatched, kItemsCount / 2) << qr.GetExplainResults();
+}
+
+TEST_F(NsApi, GeneralSortWithSmallLimit) {
+	// Matched items are trimmed to offset + limit during the select loop. Result must be the same as after the full sort
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"score", "-", "int", IndexOpts(), 0}});
+	constexpr int kItemsCount = 5000;
+	std::vector<std::pair<int, int>> expected, expectedByExpr;
+	for (int i = 0; i < kItemsCount; ++i) {
+		const int score = (i * 7919) % 1000;
+		Item it = NewItem(default_namespace);
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(i) + ",\"score\":" + std::to_string(score) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+		// Ties are ordered by row id in the direction of the sort
+		expected.emplace_back(-score, -i);
+		expectedByExpr.emplace_back(score + i, i);
+	}
+	std::sort(expected.begin(), expected.end());
+	std::sort(expectedByExpr.begin(), expectedByExpr.end());
+
+	constexpr int kOffset = 5, kLimit = 10;
+	const auto check = [&](const Query& q, const std::vector<std::pair<int, int>>& exp) {
+		QueryResults qr;
+		err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), size_t(kLimit)) << q.GetSQL();
+		EXPECT_EQ(qr.TotalCount(), kItemsCount) << q.GetSQL();
+		int i = kOffset;
+		for (auto it : qr) {
+			EXPECT_EQ(it.GetItem(false)[idIdxName].As<int>(), std::abs(exp[i++].second)) << q.GetSQL();
+		}
+	};
+	check(Query(default_namespace).Sort("score", true).Offset(kOffset).Limit(kLimit).ReqTotal(), expected);
+	check(Query(default_namespace).Sort("score + " + idIdxName, false).Offset(kOffset).Limit(kLimit).ReqTotal(), expectedByExpr);
+}
+
+TEST_F(NsApi, GeneralSortByPrecomputedKeys) {
+	// Items are ordered by the precomputed keys of the first criterion. Equal keys are ordered by the next criteria
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"price", "-", "double", IndexOpts(), 0},
+											   IndexDeclaration{"name", "hash", "string", IndexOpts(), 0}});
+	constexpr int kItemsCount = 2000;
+	std::vector<std::tuple<double, std::string, int>> expected;
+	for (int i = 0; i < kItemsCount; ++i) {
+		const double price = (i % 50) * 1.5;
+		const std::string name = "n" + std::to_string((i * 31) % 97);
+		Item it = NewItem(default_namespace);
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(i) + ",\"price\":" + std::to_string(price) + ",\"name\":\"" +
+						  name + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+		expected.emplace_back(-price, name, -i);
+	}
+	std::sort(expected.begin(), expected.end());
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Sort("price", true).Sort("name", false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), size_t(kItemsCount));
+	size_t i = 0;
+	for (auto it : qr) {
+		Item item = it.GetItem(false);
+		ASSERT_EQ(item["price"].As<double>(), -std::get<0>(expected[i])) << i;
+		ASSERT_EQ(item["name"].As<std::string>(), std::get<1>(expected[i])) << i;
+		++i;
+	}
+}
+
+TEST_F(NsApi, SortOrdersAfterUpdates) {
+	// Check, that sort orders stay consistent, when optimization updates only modified keys of the unchanged sort orders
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"sort_value", "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{"hash_value", "hash", "int", IndexOpts(), 0}});
+
+	const char* const configNs = "#config";
+	Item item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "optimization_timeout_ms":10}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	err = Commit(configNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto awaitOptimization = [&] {
+		bool optimizationCompleted = false;
+		for (int i = 0; !optimizationCompleted; ++i) {
+			ASSERT_LT(i, 200) << "Too long index optimization";
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			QueryResults qr;
+			Error err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			ASSERT_EQ(qr.Count(), 1);
+			optimizationCompleted = qr[0].GetItem(false)["optimization_completed"].Get<bool>();
+		}
+	};
+
+	constexpr int kItemsCount = 5000;
+	std::vector<int> hashValues(kItemsCount);
+	auto upsertItem = [&](int id) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(id) + ",\"sort_value\":" + std::to_string(kItemsCount - id) +
+						  ",\"hash_value\":" + std::to_string(hashValues[id]) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	};
+	for (int i = 0; i < kItemsCount; ++i) {
+		hashValues[i] = i % 10;
+		upsertItem(i);
+	}
+	awaitOptimization();
+
+	auto checkSortedSelect = [&](int hashValue, bool desc) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Where("hash_value", CondEq, hashValue).Sort("sort_value", desc), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		std::vector<int> expectedIds;
+		for (int i = 0; i < kItemsCount; ++i) {
+			if (hashValues[i] == hashValue) expectedIds.push_back(i);
+		}
+		// sort_value decreases with id
+		if (!desc) std::reverse(expectedIds.begin(), expectedIds.end());
+		ASSERT_EQ(qr.Count(), expectedIds.size());
+		size_t i = 0;
+		for (auto it : qr) {
+			ASSERT_EQ(it.GetItem(false)[idIdxName].As<int>(), expectedIds[i++]);
+		}
+	};
+
+	// Sort order by 'sort_value' is not changed by these updates, so only the modified hash keys have to be resorted
+	for (int round = 0; round < 3; ++round) {
+		for (int i = round; i < kItemsCount; i += 7) {
+			hashValues[i] = (hashValues[i] + 3) % 11;
+			upsertItem(i);
+		}
+		awaitOptimization();
+		for (int v = 0; v < 11; ++v) {
+			checkSortedSelect(v, false);
+			checkSortedSelect(v, true);
+		}
+	}
+}
+
+TEST_F(NsApi, ApproximateAggregations) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"price", "tree", "int", IndexOpts(), 0}});
+	constexpr int kItemsCount = 10000;
+	for (int i = 0; i < kItemsCount; ++i) {
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON("{\"" + idIdxName + "\":" + std::to_string(i) + ",\"price\":" + std::to_string(i % 1000) +
+							",\"name\":\"name" + std::to_string(i % 300) + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+	err = Commit(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	const auto check = [&](const Query& q) {
+		QueryResults qr;
+		err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.GetAggregationResults().size(), 4u) << q.GetSQL();
+		EXPECT_NEAR(qr.GetAggregationResults()[0].value, 1000, 20) << q.GetSQL();
+		EXPECT_NEAR(qr.GetAggregationResults()[1].value, 300, 6) << q.GetSQL();
+		EXPECT_NEAR(qr.GetAggregationResults()[2].value, 500, 10) << q.GetSQL();
+		EXPECT_NEAR(qr.GetAggregationResults()[3].value, 990, 3) << q.GetSQL();
+	};
+	check(Query(default_namespace)
+			  .Aggregate(AggApproxCountDistinct, {"price"})
+			  .Aggregate(AggApproxCountDistinct, {"name"})
+			  .Aggregate(AggQuantile, {"price", "0.5"})
+			  .Aggregate(AggQuantile, {"price", "0.99"}));
+	Query sqlQuery;
+	sqlQuery.FromSQL("SELECT approx_count_distinct(price), approx_count_distinct(name), quantile(price, 0.5), quantile(price, 0.99) FROM " +
+					 default_namespace);
+	check(sqlQuery);
+
+	for (const char* quantile : {"1.5", "-0.1", "abc"}) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Aggregate(AggQuantile, {"price", quantile}), qr);
+		EXPECT_EQ(err.code(), errQueryExec) << quantile;
+	}
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Aggregate(AggQuantile, {"price"}), qr);
+	EXPECT_EQ(err.code(), errQueryExec);
+}
+
+TEST_F(NsApi, MaterializedAggregations) {
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"brand", "hash", "string", IndexOpts(), 0},
+											   IndexDeclaration{"price", "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{"tags", "hash", "int", IndexOpts().Array(), 0}});
+
+	const char* const configNs = "#config";
+	Item item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "materialized_aggregations":["brand", "price", "tags"]}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	err = Commit(configNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto upsert = [&](int id) {
+		Item it = NewItem(default_namespace);
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(id) + ",\"brand\":\"brand" + std::to_string(id % 13) +
+						  "\",\"price\":" + std::to_string(id % 101) + ",\"tags\":[" + std::to_string(id % 5) + "," +
+						  std::to_string(id % 7) + "]}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	};
+	for (int i = 0; i < 1000; ++i) upsert(i);
+	// Updates, deletes and update queries change the counts
+	for (int i = 0; i < 1000; i += 3) upsert(i * 7);
+	QueryResults qr;
+	err = rt.reindexer->Delete(Query(default_namespace).Where(idIdxName, CondLt, {100}), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	qr.Clear();
+	err = rt.reindexer->Update(Query(default_namespace).Where(idIdxName, CondRange, {200, 300}).Set("brand", {"updated"}).Set("price", {-1}),
+							   qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto makeQuery = [&] {
+		return Query(default_namespace)
+			.Aggregate(AggFacet, {"brand"})
+			.Aggregate(AggFacet, {"tags"}, {{"count", true}}, 3)
+			.Aggregate(AggSum, {"price"})
+			.Aggregate(AggAvg, {"tags"})
+			.Aggregate(AggMin, {"price"})
+			.Aggregate(AggMax, {"price"})
+			.ReqTotal();
+	};
+	auto sortedFacets = [](const reindexer::AggregationResult& agg) {
+		std::vector<std::pair<std::string, int>> facets;
+		for (const auto& f : agg.facets) facets.emplace_back(f.values.front(), f.count);
+		std::sort(facets.begin(), facets.end());
+		return facets;
+	};
+	QueryResults materializedQr, scanQr;
+	err = rt.reindexer->Select(makeQuery().Limit(0), materializedQr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	// Filter by PK disables materialized aggregations
+	err = rt.reindexer->Select(makeQuery().Where(idIdxName, CondGe, {0}).Limit(0), scanQr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(materializedQr.TotalCount(), scanQr.TotalCount());
+	const auto& materialized = materializedQr.GetAggregationResults();
+	const auto& scan = scanQr.GetAggregationResults();
+	ASSERT_EQ(materialized.size(), scan.size());
+	for (size_t i = 0; i < scan.size(); ++i) {
+		EXPECT_EQ(materialized[i].type, scan[i].type) << i;
+		EXPECT_DOUBLE_EQ(materialized[i].value, scan[i].value) << i;
+		EXPECT_EQ(sortedFacets(materialized[i]), sortedFacets(scan[i])) << i;
+	}
+	EXPECT_EQ(materialized[0].facets.size(), 14u);
+	EXPECT_EQ(materialized[1].facets.size(), 3u);
+	EXPECT_DOUBLE_EQ(materialized[4].value, -1.0);
+}
+
+TEST_F(NsApi, IndexKeysAggregations) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"brand", "hash", "string", IndexOpts(), 0},
+											   IndexDeclaration{"price", "tree", "int", IndexOpts(), 0}});
+	for (int i = 0; i < 1000; ++i) {
+		Item it = NewItem(default_namespace);
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(i) + ",\"brand\":\"brand" + std::to_string(i % 13) +
+						  "\",\"price\":" + std::to_string(i % 101) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+	QueryResults qr;
+	err = rt.reindexer->Delete(Query(default_namespace).Where("price", CondLt, {10}), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto sortedFacets = [](const reindexer::AggregationResult& agg) {
+		std::vector<std::pair<std::string, int>> facets;
+		for (const auto& f : agg.facets) facets.emplace_back(f.values.front(), f.count);
+		std::sort(facets.begin(), facets.end());
+		return facets;
+	};
+	auto sortedDistincts = [](const reindexer::AggregationResult& agg) {
+		std::vector<std::string> distincts;
+		for (const auto& d : agg.distincts) distincts.emplace_back(d.As<std::string>());
+		std::sort(distincts.begin(), distincts.end());
+		return distincts;
+	};
+	auto check = [&](const Query& q) {
+		QueryResults keysQr, scanQr;
+		err = rt.reindexer->Select(Query(q).ReqTotal().Limit(0), keysQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		// Condition on the other index disables the aggregation by the index keys
+		err = rt.reindexer->Select(Query(q).Where(idIdxName, CondGe, {0}).ReqTotal().Limit(0), scanQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(keysQr.TotalCount(), scanQr.TotalCount()) << q.GetSQL();
+		const auto& keys = keysQr.GetAggregationResults();
+		const auto& scan = scanQr.GetAggregationResults();
+		ASSERT_EQ(keys.size(), scan.size());
+		for (size_t i = 0; i < scan.size(); ++i) {
+			EXPECT_EQ(keys[i].type, scan[i].type) << q.GetSQL();
+			EXPECT_EQ(sortedFacets(keys[i]), sortedFacets(scan[i])) << q.GetSQL();
+			EXPECT_EQ(sortedDistincts(keys[i]), sortedDistincts(scan[i])) << q.GetSQL();
+		}
+	};
+	check(Query(default_namespace).Aggregate(AggFacet, {"brand"}));
+	check(Query(default_namespace).Aggregate(AggFacet, {"price"}, {{"price", true}}, 5));
+	check(Query(default_namespace).Distinct("price"));
+	check(Query(default_namespace).Aggregate(AggFacet, {"price"}).Where("price", CondRange, {20, 50}).Where("price", CondGt, {25}));
+	check(Query(default_namespace).Distinct("brand").Where("brand", CondSet, {"brand1", "brand5", "absent"}));
+	check(Query(default_namespace).Aggregate(AggFacet, {"brand"}).Where("brand", CondLe, {"brand3"}));
+}
+
+TEST_F(NsApi, TotalCountByIdsets) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"status", "hash", "string", IndexOpts(), 0},
+											   IndexDeclaration{"price", "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{"tags", "hash", "int", IndexOpts().Array(), 0}});
+	for (int i = 0; i < 500; ++i) {
+		Item it = NewItem(default_namespace);
+		err = it.FromJSON("{\"" + idIdxName + "\":" + std::to_string(i) + ",\"status\":\"s" + std::to_string(i % 7) +
+						  "\",\"price\":" + std::to_string(i % 50) + ",\"tags\":[" + std::to_string(i % 3) + "," +
+						  std::to_string(i % 5) + "]}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+
+	auto check = [&](const Query& q) {
+		QueryResults allQr, pageQr, countQr;
+		err = rt.reindexer->Select(q, allQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->Select(Query(q).ReqTotal().Limit(3), pageQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->Select(Query(q).ReqTotal().Limit(0), countQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(pageQr.TotalCount(), allQr.Count()) << q.GetSQL();
+		EXPECT_EQ(countQr.TotalCount(), allQr.Count()) << q.GetSQL();
+	};
+	check(Query(default_namespace).Where("status", CondSet, {"s1", "s3", "absent"}));
+	// Duplicated keys select the same idsets
+	check(Query(default_namespace).Where("status", CondSet, {"s1", "s1", "s2"}));
+	check(Query(default_namespace).Where("price", CondRange, {10, 20}));
+	check(Query(default_namespace).Where("price", CondGe, {45}));
+	// Rows of the array index are contained by several idsets
+	check(Query(default_namespace).Where("tags", CondSet, {0, 1, 2}));
+	check(Query(default_namespace).Where("status", CondEq, {"s1"}).Or().Where("price", CondEq, {1}));
+}
+
+TEST_F(NsApi, PathsIndex) {
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0}});
+
+	auto setPathsIndex = [&](bool enabled) {
+		Item item = NewItem("#config");
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON(std::string(R"json({"type":"namespaces","namespaces":[{"namespace":"*", "paths_index":)json") +
+							(enabled ? "true" : "false") + "}]}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert("#config", item);
+		err = Commit("#config");
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	auto upsert = [&](int id) {
+		Item item = NewItem(default_namespace);
+		// Scores of the part of items are doubles
+		const std::string score = std::to_string(id % 50) + (id % 3 ? "" : ".5");
+		err = item.FromJSON("{\"" + idIdxName + "\":" + std::to_string(id) + ",\"city\":\"city" + std::to_string(id % 7) +
+							"\",\"score\":" + score + ",\"nested\":{\"level\":" + std::to_string(id % 3) + "},\"tags\":[" +
+							std::to_string(id % 4) + "," + std::to_string(id % 5) + "],\"flag\":" + (id % 2 ? "true" : "false") +
+							",\"mixed\":" + (id % 5 ? "[1,\"1\"]" : "1") + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	};
+	for (int i = 0; i < 500; ++i) upsert(i);
+
+	const std::vector<Query> queries = {
+		Query(default_namespace).Where("city", CondEq, "city3"),
+		Query(default_namespace).Where("city", CondSet, {"city1", "city5", "unknown"}),
+		Query(default_namespace).Where("city", CondGe, "city4"),
+		Query(default_namespace).Where("score", CondLt, 10),
+		Query(default_namespace).Where("score", CondRange, VariantArray{Variant(20), Variant(30.5)}),
+		Query(default_namespace).Where("score", CondEq, 7.5),
+		Query(default_namespace).Where("nested.level", CondEq, 2),
+		Query(default_namespace).Where("tags", CondSet, {1, 3}),
+		Query(default_namespace).Where("tags", CondGt, 3),
+		Query(default_namespace).Where("flag", CondEq, true),
+		Query(default_namespace).Where("nested", CondEq, 1),
+		Query(default_namespace).Where("mixed", CondEq, "1"),
+		Query(default_namespace).Where("city", CondEq, "city3").Where("score", CondGe, 25),
+		Query(default_namespace).Where("city", CondEq, "city3").Or().Where("tags", CondEq, 0).Not().Where("flag", CondEq, false),
+		Query(default_namespace).Where("score", CondGe, 40).Sort(idIdxName, true),
+	};
+	auto selectIds = [&] {
+		std::vector<std::vector<int>> results;
+		for (const Query& q : queries) {
+			QueryResults qr;
+			err = rt.reindexer->Select(q, qr);
+			EXPECT_TRUE(err.ok()) << err.what();
+			std::vector<int> ids;
+			for (auto& it : qr) ids.push_back(it.GetItem(false)[idIdxName].As<int>());
+			std::sort(ids.begin(), ids.end());
+			results.emplace_back(std::move(ids));
+		}
+		return results;
+	};
+
+	// Paths index returns the same items as the comparators
+	const auto expected = selectIds();
+	EXPECT_FALSE(expected[0].empty());
+	setPathsIndex(true);
+	EXPECT_EQ(selectIds(), expected);
+
+	// Modifications are applied to the index
+	for (int i = 0; i < 500; i += 3) upsert(i * 7);
+	QueryResults qr;
+	err = rt.reindexer->Delete(Query(default_namespace).Where(idIdxName, CondLt, 100), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	qr.Clear();
+	err = rt.reindexer->Update(Query(default_namespace).Where(idIdxName, CondRange, {200, 300}).Set("city", {"city3"}), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	const auto indexed = selectIds();
+	setPathsIndex(false);
+	EXPECT_EQ(selectIds(), indexed);
+}
+
+TEST_F(NsApi, NonIndexedFieldsConditions) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0}});
+
+	constexpr int kCount = 2000;
+	for (int id = 0; id < kCount; ++id) {
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON("{\"" + idIdxName + "\":" + std::to_string(id) + ",\"city\":\"city" + std::to_string(id % 7) +
+							"\",\"score\":" + std::to_string(id % 50) + ",\"nested\":{\"level\":" + std::to_string(id % 3) +
+							",\"tags\":[" + std::to_string(id % 4) + "," + std::to_string(id % 5) + "]}}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+
+	struct {
+		Query query;
+		std::function<bool(int)> match;
+	} cases[] = {
+		{Query(default_namespace).Where("city", CondEq, "city3").Where("score", CondGe, 25).Where("nested.level", CondEq, 1),
+		 [](int id) { return id % 7 == 3 && id % 50 >= 25 && id % 3 == 1; }},
+		{Query(default_namespace).Where("score", CondGe, 10).Where("score", CondLt, 20).Not().Where("nested.tags", CondEq, 3),
+		 [](int id) { return id % 50 >= 10 && id % 50 < 20 && id % 4 != 3 && id % 5 != 3; }},
+		{Query(default_namespace).Where(idIdxName, CondLt, 1500).Where("nested.level", CondEq, 2).Where("city", CondSet, {"city1", "city2"}),
+		 [](int id) { return id < 1500 && id % 3 == 2 && (id % 7 == 1 || id % 7 == 2); }},
+		{Query(default_namespace).Where("city", CondEq, "city0").Or().Where("nested.tags", CondEq, 4).Where("score", CondLt, 5),
+		 [](int id) { return (id % 7 == 0 || id % 5 == 4) && id % 50 < 5; }},
+		{Query(default_namespace).Where("nested", CondEq, 2).Where("score", CondRange, {5, 7}),
+		 [](int id) { return (id % 3 == 2 || id % 4 == 2 || id % 5 == 2) && id % 50 >= 5 && id % 50 <= 7; }},
+	};
+	for (auto& c : cases) {
+		QueryResults qr;
+		err = rt.reindexer->Select(c.query, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		std::vector<int> ids, expected;
+		for (auto& it : qr) ids.push_back(it.GetItem(false)[idIdxName].As<int>());
+		for (int id = 0; id < kCount; ++id) {
+			if (c.match(id)) expected.push_back(id);
+		}
+		std::sort(ids.begin(), ids.end());
+		EXPECT_EQ(ids, expected) << c.query.GetSQL();
+	}
+}
+
+TEST_F(NsApi, SlidingRanges) {
+	// Idsets of the ranges with the shifted bounds are composed from the cached ones
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"ts", "tree", "int", IndexOpts(), 0}});
+
+	const char* const configNs = "#config";
+	Item item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "optimization_timeout_ms":10}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	err = Commit(configNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto awaitOptimization = [&] {
+		bool optimizationCompleted = false;
+		for (int i = 0; !optimizationCompleted; ++i) {
+			ASSERT_LT(i, 200) << "Too long index optimization";
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			QueryResults qr;
+			Error err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			ASSERT_EQ(qr.Count(), 1);
+			optimizationCompleted = qr[0].GetItem(false)["optimization_completed"].Get<bool>();
+		}
+	};
+
+	constexpr int kItemsCount = 6000, kKeysCount = 200;
+	std::vector<int> ts(kItemsCount);
+	auto upsertItem = [&](int id) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		it[idIdxName] = id;
+		it["ts"] = ts[id];
+		Upsert(default_namespace, it);
+	};
+	for (int id = 0; id < kItemsCount; ++id) {
+		ts[id] = (id * 7) % kKeysCount;
+		upsertItem(id);
+	}
+	awaitOptimization();
+
+	auto checkRange = [&](const Query& q, int from, int to) {
+		QueryResults qr;
+		err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		std::vector<int> ids, expected;
+		for (auto it : qr) ids.push_back(it.GetItem(false)[idIdxName].As<int>());
+		for (int id = 0; id < kItemsCount; ++id) {
+			if (ts[id] >= from && ts[id] <= to) expected.push_back(id);
+		}
+		std::sort(ids.begin(), ids.end());
+		ASSERT_EQ(ids, expected) << q.GetSQL();
+	};
+	auto checkWindows = [&](int width) {
+		// Window is cached by the repeated select. The next windows are composed of the previous ones
+		for (int repeat = 0; repeat < 2; ++repeat) {
+			checkRange(Query(default_namespace).Where("ts", CondRange, {10, 10 + width}), 10, 10 + width);
+		}
+		for (int from = 11; from < 60; from += (from % 3) + 1) {
+			checkRange(Query(default_namespace).Where("ts", CondRange, {from, from + width}), from, from + width);
+			checkRange(Query(default_namespace).Where("ts", CondGe, from).Where("ts", CondLt, from + width), from, from + width - 1);
+		}
+		checkRange(Query(default_namespace).Where("ts", CondRange, {5, 100}), 5, 100);
+		checkRange(Query(default_namespace).Where("ts", CondLe, 30), 0, 30);
+		checkRange(Query(default_namespace).Where("ts", CondGt, kKeysCount - 30), kKeysCount - 29, kKeysCount);
+	};
+	checkWindows(20);
+	checkWindows(40);
+
+	// Cached ranges are dropped on the update of the index
+	for (int id = 0; id < kItemsCount; id += 5) {
+		ts[id] = (ts[id] + 13) % kKeysCount;
+		upsertItem(id);
+	}
+	awaitOptimization();
+	checkWindows(20);
+}
+
+TEST_F(NsApi, DeleteByQueryInBulk) {
+	// Items of the query are removed from the indexes in bulk. With 'delete_chunk_size' they are deleted by the several chunks
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{"name", "hash", "string", IndexOpts(), 0},
+											   IndexDeclaration{"tags", "hash", "int", IndexOpts().Array(), 0}});
+
+	const char* const configNs = "#config";
+	Item item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "delete_chunk_size":70}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	err = Commit(configNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	constexpr int kItemsCount = 1000;
+	std::set<int> alive;
+	for (int id = 0; id < kItemsCount; ++id) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		err = it.FromJSON(fmt::sprintf(R"json({"%s":%d,"value":%d,"name":"name_%d","tags":[%d,%d]})json", idIdxName, id, id % 10,
+									   id % 5, id % 7, 10 + id % 3));
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+		alive.insert(id);
+	}
+
+	auto checkIndexes = [&]() {
+		auto check = [&](const Query& q, const std::function<bool(int)>& pred) {
+			QueryResults qr;
+			err = rt.reindexer->Select(q, qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			std::vector<int> ids, expected;
+			for (auto it : qr) ids.push_back(it.GetItem(false)[idIdxName].As<int>());
+			for (int id : alive) {
+				if (pred(id)) expected.push_back(id);
+			}
+			std::sort(ids.begin(), ids.end());
+			ASSERT_EQ(ids, expected) << q.GetSQL();
+		};
+		check(Query(default_namespace), [](int) { return true; });
+		check(Query(default_namespace).Where(idIdxName, CondLt, 300), [](int id) { return id < 300; });
+		for (int v = 0; v < 10; ++v) check(Query(default_namespace).Where("value", CondEq, v), [v](int id) { return id % 10 == v; });
+		for (int n = 0; n < 5; ++n) {
+			check(Query(default_namespace).Where("name", CondEq, "name_" + std::to_string(n)), [n](int id) { return id % 5 == n; });
+		}
+		for (int t = 0; t < 7; ++t) check(Query(default_namespace).Where("tags", CondEq, t), [t](int id) { return id % 7 == t; });
+		for (int t = 10; t < 13; ++t) {
+			check(Query(default_namespace).Where("tags", CondEq, t), [t](int id) { return 10 + id % 3 == t; });
+		}
+	};
+
+	auto deleteItems = [&](const Query& q, const std::function<bool(int)>& pred) {
+		QueryResults qr;
+		err = rt.reindexer->Delete(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		size_t expected = 0;
+		for (auto it = alive.begin(); it != alive.end();) {
+			if (pred(*it)) {
+				it = alive.erase(it);
+				++expected;
+			} else {
+				++it;
+			}
+		}
+		ASSERT_EQ(qr.Count(), expected) << q.GetSQL();
+	};
+
+	deleteItems(Query(default_namespace).Where("value", CondLt, 5), [](int id) { return id % 10 < 5; });
+	checkIndexes();
+
+	item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({"type":"namespaces","namespaces":[{"namespace":"*", "delete_chunk_size":0}]})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	deleteItems(Query(default_namespace).Where("tags", CondEq, 11), [](int id) { return id % 3 == 1; });
+	checkIndexes();
+}
+
+TEST_F(NsApi, ParallelUpdateNonindexedFields) {
+	// Modified items of the large update query are built by the several workers
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts(), 0}});
+
+	const char* const configNs = "#config";
+	Item item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "parallel_update_workers":4}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	err = Commit(configNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	constexpr int kItemsCount = 10000;
+	for (int id = 0; id < kItemsCount; ++id) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		err = it.FromJSON(fmt::sprintf(R"json({"%s":%d,"value":%d,"nested":{"bonus":%d,"name":"name_%d"},"arr":[1,2,3]})json", idIdxName,
+									   id, id % 10, id, id));
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+
+	QueryResults qrUpdate;
+	err = rt.reindexer->Update(
+		Query(default_namespace).Where("value", CondLt, 8).Set("nested.bonus", 100500).Set("arr[1]", 7).Drop("nested.name"), qrUpdate);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qrUpdate.Count(), size_t(kItemsCount / 10 * 8));
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), size_t(kItemsCount));
+	for (auto it : qr) {
+		Item it2 = it.GetItem(false);
+		const int id = it2[idIdxName].As<int>();
+		const std::string expected =
+			(id % 10 < 8)
+				? fmt::sprintf(R"json({"%s":%d,"value":%d,"nested":{"bonus":100500},"arr":[1,7,3]})json", idIdxName, id, id % 10)
+				: fmt::sprintf(R"json({"%s":%d,"value":%d,"nested":{"bonus":%d,"name":"name_%d"},"arr":[1,2,3]})json", idIdxName, id,
+							   id % 10, id, id);
+		ASSERT_EQ(it2.GetJSON(), expected);
+	}
+
+	// Updated values are found by the queries
+	qr.Clear();
+	err = rt.reindexer->Select(Query(default_namespace).Where("nested.bonus", CondEq, 100500), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), size_t(kItemsCount / 10 * 8));
+}
+
+TEST_F(NsApi, PreparedSelect) {
+	DefineDefaultNamespace();
+	FillDefaultNamespace(100);
+
+	const std::string sql = "SELECT * FROM " + default_namespace + " WHERE " + intField + " IN (?, ?) AND " + stringField + " = ?";
+	for (int i = 0; i < 10; ++i) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(sql, VariantArray{Variant(i), Variant(i + 50), Variant(std::to_string(i + 50))}, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1u);
+		EXPECT_EQ(qr[0].GetItem(false)[intField].As<int>(), i + 50);
+	}
+
+	const std::string deleteSql = "DELETE FROM " + default_namespace + " WHERE " + intField + " < ?";
+	QueryResults qr;
+	Error err = rt.reindexer->Select(deleteSql, VariantArray{Variant(10)}, qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), 10u);
+
+	qr.Clear();
+	err = rt.reindexer->Select(sql, VariantArray{Variant(1)}, qr);
+	EXPECT_EQ(err.code(), errParams);
+}
+
+TEST_F(NsApi, SelectByPK) {
+	DefineDefaultNamespace();
+	FillDefaultNamespace(100);
+
+	auto checkIds = [this](QueryResults& qr, const std::vector<int>& expected) {
+		ASSERT_EQ(qr.Count(), expected.size());
+		for (size_t i = 0; i < expected.size(); ++i) {
+			EXPECT_EQ(qr[i].GetItem(false)[idIdxName].As<int>(), expected[i]) << i;
+		}
+	};
+
+	// Duplicated and missing keys are skipped, keys are converted to the index type
+	QueryResults qr;
+	Error err = rt.reindexer->GetByPK(default_namespace,
+									  VariantArray{Variant(7), Variant(5), Variant(7), Variant(1000), Variant(std::string("9"))}, qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	checkIds(qr, {5, 7, 9});
+
+	// Results of the primary key lookup are the same as the results of the generic path, which is used for the queries with offset
+	qr.Clear();
+	err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondSet, {3, 1, 2}).Limit(2), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	checkIds(qr, {1, 2});
+	qr.Clear();
+	err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondSet, {3, 1, 2}).Offset(1), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	checkIds(qr, {2, 3});
+
+	qr.Clear();
+	err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondEq, 42).Select({intField.c_str()}), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1u);
+	EXPECT_EQ(qr[0].GetItem(false)[intField].As<int>(), 42);
+}
+
+TEST_F(NsApi, PointReadsCache) {
+	// Items of the lookups by the primary key are cached and read without the lock. Writers keep the cached items actual
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	Item config = NewItem("#config");
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	err = config.FromJSON(R"json({"type":"namespaces","namespaces":[{"namespace":"*","point_reads_cache_size":1000}]})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", config);
+	DefineDefaultNamespace();
+	FillDefaultNamespace(100);
+
+	auto upsert = [this](int id, int value) {
+		Item item = NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		item[idIdxName] = id;
+		item[intField] = value;
+		item[stringField] = std::to_string(value);
+		Upsert(default_namespace, item);
+	};
+	auto getByPK = [this](const VariantArray& keys) {
+		std::vector<std::pair<int, int>> values;
+		QueryResults qr;
+		Error err = rt.reindexer->GetByPK(default_namespace, keys, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		for (auto it : qr) {
+			Item item = it.GetItem(false);
+			values.emplace_back(item[idIdxName].As<int>(), item[intField].As<int>());
+			EXPECT_EQ(item[stringField].As<std::string>(), std::to_string(values.back().second));
+		}
+		return values;
+	};
+	using Values = std::vector<std::pair<int, int>>;
+
+	// Second lookup is answered by the cache
+	const VariantArray keys{Variant(7), Variant(3), Variant(std::string("5"))};
+	EXPECT_EQ(getByPK(keys), (Values{{3, 3}, {5, 5}, {7, 7}}));
+	EXPECT_EQ(getByPK(keys), (Values{{3, 3}, {5, 5}, {7, 7}}));
+
+	// Modified and deleted items are not returned by the cache anymore
+	Item item = NewItem(default_namespace);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	item[idIdxName] = 5;
+	err = rt.reindexer->Delete(default_namespace, item);
+	ASSERT_TRUE(err.ok()) << err.what();
+	QueryResults qr;
+	err = rt.reindexer->Update(Query(default_namespace).Where(idIdxName, CondEq, 7).Set(intField, 70).Set(stringField, "70"), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(getByPK(keys), (Values{{3, 3}, {7, 70}}));
+	qr.Clear();
+	err = rt.reindexer->Update(Query(default_namespace).Where(idIdxName, CondEq, 3).Set(intField, 30).Set(stringField, "30"), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(getByPK(keys), (Values{{3, 30}, {7, 70}}));
+
+	// Modifications of the transaction are returned only after its commit
+	auto tx = rt.reindexer->NewTransaction(default_namespace);
+	ASSERT_TRUE(tx.Status().ok()) << tx.Status().what();
+	Item txItem = tx.NewItem();
+	ASSERT_TRUE(txItem.Status().ok()) << txItem.Status().what();
+	txItem[idIdxName] = 3;
+	txItem[intField] = 300;
+	txItem[stringField] = "300";
+	tx.Upsert(std::move(txItem));
+	EXPECT_EQ(getByPK(keys), (Values{{3, 30}, {7, 70}}));
+	qr.Clear();
+	err = rt.reindexer->CommitTransaction(tx, qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(getByPK(keys), (Values{{3, 300}, {7, 70}}));
+
+	// Cache is dropped with the change of the indexes
+	err = rt.reindexer->AddIndex(default_namespace, reindexer::IndexDef{"new_field", {"new_field"}, "hash", "int", IndexOpts()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(getByPK(keys), (Values{{3, 300}, {7, 70}}));
+	EXPECT_EQ(getByPK(keys), (Values{{3, 300}, {7, 70}}));
+
+	// Lookups of the hot keys are concurrent with the modifications of the same keys
+	constexpr int kUpdatesCount = 2000;
+	std::atomic<bool> done{false};
+	std::thread reader([&] {
+		int lastValue = 0;
+		while (!done.load()) {
+			for (auto v : getByPK({Variant(11)})) {
+				EXPECT_GE(v.second, lastValue);
+				lastValue = v.second;
+			}
+		}
+	});
+	for (int i = 1; i <= kUpdatesCount; ++i) {
+		upsert(11, i);
+		upsert(12, i);
+	}
+	done = true;
+	reader.join();
+	EXPECT_EQ(getByPK({Variant(11), Variant(12)}), (Values{{11, kUpdatesCount}, {12, kUpdatesCount}}));
+}
+
+TEST_F(NsApi, FlatHashIndexes) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK().FlatHash(), 0},
+											   IndexDeclaration{"str_value", "hash", "string", IndexOpts().FlatHash(), 0},
+											   IndexDeclaration{"int64_value", "hash", "int64", IndexOpts().FlatHash(), 0},
+											   IndexDeclaration{"plain_value", "hash", "int64", IndexOpts(), 0}});
+
+	// Flat hash option is not allowed for the other index types
+	err = rt.reindexer->AddIndex(default_namespace,
+								 reindexer::IndexDef{"tree_value", {"tree_value"}, "tree", "int", IndexOpts().FlatHash()});
+	EXPECT_EQ(err.code(), errParams) << err.what();
+
+	constexpr int kItemsCount = 2000;
+	auto upsertItem = [&](int id, int value) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["str_value"] = "value_" + std::to_string(value);
+		item["int64_value"] = int64_t(value);
+		item["plain_value"] = int64_t(value);
+		Upsert(default_namespace, item);
+	};
+	for (int i = 0; i < kItemsCount; ++i) upsertItem(i, i % 300);
+	// Keys are removed from the map, when their last item is rewritten or deleted
+	for (int i = 0; i < kItemsCount; ++i) {
+		if (i % 300 >= 250) upsertItem(i, i % 250);
+	}
+	for (int i = 0; i < kItemsCount; i += 3) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		err = rt.reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	// Flat hash indexes return the same results as the sparse ones
+	for (int value : {0, 7, 100, 249, 250, 299}) {
+		QueryResults expected;
+		err = rt.reindexer->Select(Query(default_namespace).Where("plain_value", CondEq, int64_t(value)), expected);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(expected.Count() == 0, value >= 250) << value;
+		for (const auto& q : {Query(default_namespace).Where("int64_value", CondEq, int64_t(value)),
+							  Query(default_namespace).Where("str_value", CondEq, "value_" + std::to_string(value))}) {
+			QueryResults qr;
+			err = rt.reindexer->Select(q, qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			EXPECT_EQ(qr.Count(), expected.Count()) << q.GetSQL();
+		}
+	}
+	for (int id : {1, 2, 3, 1999}) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondEq, id), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), id % 3 ? 1u : 0u) << id;
+	}
+}
+
+TEST_F(NsApi, LearnedTreeIndexes) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"ts", "tree", "int64", IndexOpts().Learned(), 0},
+											   IndexDeclaration{"plain_ts", "tree", "int64", IndexOpts(), 0}});
+
+	// Learned option is not allowed for the other index types
+	err = rt.reindexer->AddIndex(default_namespace,
+								 reindexer::IndexDef{"str_value", {"str_value"}, "tree", "string", IndexOpts().Learned()});
+	EXPECT_EQ(err.code(), errParams) << err.what();
+
+	const char* const configNs = "#config";
+	Item item = NewItem(configNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "optimization_timeout_ms":10}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(configNs, item);
+	err = Commit(configNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto awaitOptimization = [&] {
+		bool optimizationCompleted = false;
+		for (int i = 0; !optimizationCompleted; ++i) {
+			ASSERT_LT(i, 200) << "Too long index optimization";
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			QueryResults qr;
+			Error err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			ASSERT_EQ(qr.Count(), 1);
+			optimizationCompleted = qr[0].GetItem(false)["optimization_completed"].Get<bool>();
+		}
+	};
+	auto upsertItem = [&](int id, int64_t ts) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["ts"] = ts;
+		item["plain_ts"] = ts;
+		Upsert(default_namespace, item);
+	};
+	// Learned index returns the same results as the plain btree
+	auto checkRanges = [&] {
+		const int64_t kBase = 1600000000000;
+		for (int64_t v : {kBase - 1, kBase, kBase + 1, kBase + 4999, kBase + 30000, kBase + 59997, kBase + 100000}) {
+			for (CondType cond : {CondLt, CondLe, CondGt, CondGe, CondRange}) {
+				for (bool sorted : {false, true}) {
+					auto makeQuery = [&](const char* field) {
+						Query q(default_namespace);
+						if (cond == CondRange) {
+							q.Where(field, cond, {v, v + 120});
+						} else {
+							q.Where(field, cond, v);
+						}
+						if (sorted) q.Sort(field, false);
+						return q;
+					};
+					QueryResults expected, qr;
+					err = rt.reindexer->Select(makeQuery("plain_ts"), expected);
+					ASSERT_TRUE(err.ok()) << err.what();
+					err = rt.reindexer->Select(makeQuery("ts"), qr);
+					ASSERT_TRUE(err.ok()) << err.what();
+					ASSERT_EQ(qr.Count(), expected.Count()) << makeQuery("ts").GetSQL();
+					for (size_t i = 0; sorted && i < qr.Count(); ++i) {
+						EXPECT_EQ(qr[i].GetItem(false)["ts"].As<int64_t>(), expected[i].GetItem(false)["plain_ts"].As<int64_t>());
+					}
+				}
+			}
+		}
+	};
+
+	// Timestamps are mostly increasing with the irregular steps and several items per timestamp
+	constexpr int kItemsCount = 20000;
+	for (int i = 0; i < kItemsCount; ++i) upsertItem(i, 1600000000000 + i * 3 - i % 2);
+	awaitOptimization();
+	checkRanges();
+
+	// Keys, which were added or removed after the optimization, are selected from the btree
+	for (int i = kItemsCount; i < kItemsCount + 100; ++i) upsertItem(i, 1600000000000 + 30000 + i % 7);
+	for (int i = 0; i < kItemsCount; i += 5) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		err = rt.reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	checkRanges();
+	awaitOptimization();
+	checkRanges();
+}
+
+TEST_F(NsApi, BloomFilterIndexes) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK().BloomFilter(), 0},
+											   IndexDeclaration{"str_value", "hash", "string", IndexOpts().BloomFilter(), 0},
+											   IndexDeclaration{"sparse_value", "hash", "int64", IndexOpts().Sparse().BloomFilter(), 0}});
+
+	// Bloom filter option is not allowed for the other index types
+	err = rt.reindexer->AddIndex(default_namespace,
+								 reindexer::IndexDef{"tree_value", {"tree_value"}, "tree", "int", IndexOpts().BloomFilter()});
+	EXPECT_EQ(err.code(), errParams) << err.what();
+
+	auto upsertItem = [&](int id, int value) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["str_value"] = "value_" + std::to_string(value);
+		if (value % 2) item["sparse_value"] = int64_t(value);
+		Upsert(default_namespace, item);
+	};
+	// Filter is reallocated several times while the keys are inserted and rebuilt, when the most of the keys are removed
+	constexpr int kItemsCount = 10000;
+	for (int i = 0; i < kItemsCount; ++i) upsertItem(i, i);
+	for (int i = 0; i < kItemsCount; ++i) {
+		if (i % 10) {
+			Item item = NewItem(default_namespace);
+			item[idIdxName] = i;
+			err = rt.reindexer->Delete(default_namespace, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+	}
+	for (int i = kItemsCount; i < kItemsCount + 100; ++i) upsertItem(i, i);
+
+	auto count = [&](const Query& q) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+	for (int v = 0; v < kItemsCount + 200; ++v) {
+		const size_t expected = (v < kItemsCount) ? (v % 10 == 0) : (v < kItemsCount + 100);
+		ASSERT_EQ(count(Query(default_namespace).Where(idIdxName, CondEq, v)), expected) << v;
+		ASSERT_EQ(count(Query(default_namespace).Where("str_value", CondEq, "value_" + std::to_string(v))), expected) << v;
+		ASSERT_EQ(count(Query(default_namespace).Where("sparse_value", CondEq, int64_t(v))), (v % 2) ? expected : 0) << v;
+	}
+	EXPECT_EQ(count(Query(default_namespace).Where(idIdxName, CondSet, {0, 1, 10, 11, kItemsCount + 1, kItemsCount + 101})), 3);
+
+	// Existing item is found by the primary key on insert
+	Item item = NewItem(default_namespace);
+	item[idIdxName] = 10;
+	item["str_value"] = "other";
+	err = rt.reindexer->Insert(default_namespace, item);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(item.GetID(), -1);
+	EXPECT_EQ(count(Query(default_namespace).Where("str_value", CondEq, "other")), 0);
+}
+
+TEST_F(NsApi, SortedMergeOfPartitions) {
+	// Dataset is splitted by id into the namespaces with the same structure, so their writes and optimizations are independent
+	constexpr int kParts = 3;
+	constexpr int kItemsCount = 1000;
+	std::vector<std::string> parts;
+	for (int p = 0; p < kParts; ++p) {
+		parts.emplace_back(default_namespace + "_part_" + std::to_string(p));
+		Error err = rt.reindexer->OpenNamespace(parts.back());
+		ASSERT_TRUE(err.ok()) << err.what();
+		DefineNamespaceDataset(parts.back(), {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											  IndexDeclaration{"value", "tree", "int", IndexOpts(), 0}});
+	}
+	std::vector<std::pair<int, int>> expected;
+	for (int id = 0; id < kItemsCount; ++id) {
+		const int value = (id * 7919) % 500;
+		Item item = NewItem(parts[id % kParts]);
+		item[idIdxName] = id;
+		item["value"] = value;
+		Upsert(parts[id % kParts], item);
+		if (value >= 100) expected.emplace_back(value, id);
+	}
+	std::sort(expected.begin(), expected.end(),
+			  [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) { return lhs.first > rhs.first; });
+
+	for (unsigned offset : {0u, 5u, 700u}) {
+		Query q = Query(parts[0]).Where("value", CondGe, 100).Sort("value", true).Offset(offset).Limit(20).ReqTotal();
+		for (int p = 1; p < kParts; ++p) q.mergeQueries_.emplace_back(JoinType::Merge, Query(parts[p]).Where("value", CondGe, 100));
+		QueryResults qr;
+		Error err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.TotalCount(), expected.size());
+		const size_t expectedCount = std::min<size_t>(20, expected.size() > offset ? expected.size() - offset : 0);
+		ASSERT_EQ(qr.Count(), expectedCount) << offset;
+		// Items with the equal values may be returned in any order
+		for (size_t i = 0; i < qr.Count(); ++i) {
+			Item item = qr[i].GetItem(false);
+			EXPECT_EQ(item["value"].As<int>(), expected[offset + i].first) << i;
+			EXPECT_EQ(qr.Items()[i].Nsid(), item[idIdxName].As<int>() % kParts) << i;
+		}
+	}
+}
+
+TEST_F(NsApi, ConcurrentUpserts) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts(), 0}});
+
+	// Concurrent writes are combined into batches, but each writer gets the result of its own item
+	constexpr int kThreads = 8;
+	constexpr int kItemsPerThread = 500;
+	std::vector<std::thread> threads;
+	std::atomic<int> errors{0}, wrongIds{0};
+	for (int t = 0; t < kThreads; ++t) {
+		threads.emplace_back([&, t] {
+			for (int i = 0; i < kItemsPerThread; ++i) {
+				const int id = t * kItemsPerThread + i;
+				Item item = rt.reindexer->NewItem(default_namespace);
+				item[idIdxName] = id;
+				item["value"] = id * 2;
+				Error err = rt.reindexer->Upsert(default_namespace, item);
+				if (!err.ok()) ++errors;
+				if (item.GetID() < 0) ++wrongIds;
+				// Item with the same primary key is rejected on insert
+				Item dup = rt.reindexer->NewItem(default_namespace);
+				dup[idIdxName] = id;
+				err = rt.reindexer->Insert(default_namespace, dup);
+				if (!err.ok()) ++errors;
+				if (dup.GetID() != -1) ++wrongIds;
+			}
+		});
+	}
+	for (auto& th : threads) th.join();
+	EXPECT_EQ(errors.load(), 0);
+	EXPECT_EQ(wrongIds.load(), 0);
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Sort("value", false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), size_t(kThreads * kItemsPerThread));
+	int expected = 0;
+	for (auto& it : qr) {
+		Item item = it.GetItem(false);
+		ASSERT_EQ(item[idIdxName].As<int>(), expected);
+		ASSERT_EQ(item["value"].As<int>(), expected * 2);
+		++expected;
+	}
+}
+
+TEST_F(NsApi, OnlineCompositeIndexBuild) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"a", "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{"b", "hash", "string", IndexOpts(), 0}});
+	auto upsertItem = [&](int id, int a) {
+		Item item = rt.reindexer->NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["a"] = a;
+		item["b"] = std::to_string(id % 7);
+		return rt.reindexer->Upsert(default_namespace, item);
+	};
+	// Namespace is large enough to build indexes from the snapshot of the items
+	constexpr int kItemsCount = 20000;
+	for (int i = 0; i < kItemsCount; ++i) {
+		err = upsertItem(i, i % 100);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	// Items are updated, deleted and inserted, while the indexes are built
+	std::atomic<bool> done{false};
+	std::thread writer([&] {
+		for (int i = 0; !done.load() || i < 1000; ++i) {
+			const int id = i % kItemsCount;
+			Error err = upsertItem(id, 100 + i % 100);
+			ASSERT_TRUE(err.ok()) << err.what();
+			if (i % 3 == 0) {
+				Item item = rt.reindexer->NewItem(default_namespace);
+				item[idIdxName] = (id + kItemsCount / 2) % kItemsCount;
+				err = rt.reindexer->Delete(default_namespace, item);
+				ASSERT_TRUE(err.ok()) << err.what();
+			}
+			err = upsertItem(kItemsCount + i, i % 200);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+	});
+	err = rt.reindexer->AddIndex(default_namespace, reindexer::IndexDef{"a+b", {"a", "b"}, "hash", "composite", IndexOpts()});
+	EXPECT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, reindexer::IndexDef{"b+a", {"b", "a"}, "tree", "composite", IndexOpts()});
+	EXPECT_TRUE(err.ok()) << err.what();
+	done = true;
+	writer.join();
+
+	auto count = [&](const Query& q) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+	// Expected counts are calculated from the items, because the conditions on both fields are substituted by composite index
+	std::map<std::pair<int, std::string>, size_t> expectedCounts;
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (auto& it : qr) {
+		Item item = it.GetItem(false);
+		++expectedCounts[{item["a"].As<int>(), item["b"].As<std::string>()}];
+	}
+	for (int a = 0; a < 200; ++a) {
+		for (int b = 0; b < 7; ++b) {
+			const std::string bStr = std::to_string(b);
+			const size_t expected = expectedCounts[{a, bStr}];
+			ASSERT_EQ(count(Query(default_namespace).WhereComposite("a+b", CondEq, {{Variant(a), Variant(bStr)}})), expected) << a << b;
+			ASSERT_EQ(count(Query(default_namespace).WhereComposite("b+a", CondEq, {{Variant(bStr), Variant(a)}})), expected) << a << b;
+		}
+	}
+}
+
+TEST_F(NsApi, ArrayIndexPartialUpdate) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"hash_tags", "hash", "int", IndexOpts().Array(), 0},
+											   IndexDeclaration{"tree_tags", "tree", "int64", IndexOpts().Array(), 0}});
+	auto upsertItem = [&](int id, const std::vector<int>& tags) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["hash_tags"] = tags;
+		item["tree_tags"] = std::vector<int64_t>(tags.begin(), tags.end());
+		Upsert(default_namespace, item);
+	};
+	auto ids = [&](const char* index, int tag) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query(default_namespace).Where(index, CondEq, tag).Sort(idIdxName, false), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::vector<int> res;
+		for (auto& it : qr) res.emplace_back(it.GetItem(false)[idIdxName].As<int>());
+		return res;
+	};
+	auto checkTags = [&](int tag, const std::vector<int>& expectedIds) {
+		EXPECT_EQ(ids("hash_tags", tag), expectedIds) << tag;
+		EXPECT_EQ(ids("tree_tags", tag), expectedIds) << tag;
+	};
+
+	std::vector<int> tags(200);
+	std::iota(tags.begin(), tags.end(), 0);
+	upsertItem(1, tags);
+	upsertItem(2, {0, 1, 1});
+
+	// Single tag is replaced, the rest of tags are kept, and the order of the tags is changed
+	tags[100] = 1000;
+	std::reverse(tags.begin(), tags.end());
+	upsertItem(1, tags);
+	checkTags(100, {});
+	checkTags(1000, {1});
+	checkTags(99, {1});
+	checkTags(0, {1, 2});
+
+	// Duplicated tag is kept, while one of its copies is removed
+	upsertItem(2, {0, 1, 2});
+	checkTags(1, {1, 2});
+	checkTags(2, {1, 2});
+	upsertItem(2, {2});
+	checkTags(0, {1});
+	checkTags(1, {1});
+
+	// Array is updated by query
+	QueryResults qr;
+	err = rt.reindexer->Update(Query(default_namespace).Where(idIdxName, CondEq, 2).Set("hash_tags", {Variant(2), Variant(3)}), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(ids("hash_tags", 2), std::vector<int>({1, 2}));
+	EXPECT_EQ(ids("hash_tags", 3), std::vector<int>({1, 2}));
+	EXPECT_EQ(ids("hash_tags", 1), std::vector<int>({1}));
+
+	// Array becomes empty and filled again
+	upsertItem(2, {});
+	checkTags(2, {1});
+	upsertItem(2, {5000});
+	checkTags(5000, {2});
+}
+
+TEST_F(NsApi, ModifyItemsBatch) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{intField.c_str(), "tree", "int", IndexOpts(), 0}});
+	auto makeBatch = [&](int from, int to) {
+		std::vector<Item> items;
+		for (int id = from; id < to; ++id) {
+			Item item = NewItem(default_namespace);
+			item[idIdxName] = id;
+			item[intField] = id * 10;
+			items.emplace_back(std::move(item));
+		}
+		return items;
+	};
+	auto count = [&](const Query& q) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+
+	auto items = makeBatch(0, 100);
+	err = rt.reindexer->ModifyItems(default_namespace, items, ModeInsert);
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (auto& item : items) EXPECT_NE(item.GetID(), -1);
+	EXPECT_EQ(count(Query(default_namespace)), 100u);
+
+	// Existing items are not inserted again, the new ones are
+	items = makeBatch(50, 150);
+	err = rt.reindexer->ModifyItems(default_namespace, items, ModeInsert);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(items[0].GetID(), -1);
+	EXPECT_NE(items[99].GetID(), -1);
+	EXPECT_EQ(count(Query(default_namespace)), 150u);
+
+	items = makeBatch(0, 50);
+	err = rt.reindexer->ModifyItems(default_namespace, items, ModeDelete);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(count(Query(default_namespace)), 100u);
+	EXPECT_EQ(count(Query(default_namespace).Where(intField, CondLt, 500)), 0u);
+
+	// Items of the system namespace are modified too
+	Item nsItem = NewItem("#config");
+	ASSERT_TRUE(nsItem.Status().ok()) << nsItem.Status().what();
+	err = nsItem.FromJSON(R"({"type":"profiling","profiling":{"queriesperfstats":true}})");
+	ASSERT_TRUE(err.ok()) << err.what();
+	std::vector<Item> configItems;
+	configItems.emplace_back(std::move(nsItem));
+	err = rt.reindexer->ModifyItems("#config", configItems, ModeUpsert);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_NE(configItems[0].GetID(), -1);
+
+	// Statuses of the single items
+	items = makeBatch(200, 210);
+	std::vector<Error> itemsErrors(items.size(), Error(errLogic));
+	err = rt.reindexer->ModifyItems(default_namespace, items, ModeUpsert, itemsErrors);
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (auto& itemErr : itemsErrors) EXPECT_TRUE(itemErr.ok()) << itemErr.what();
+	err = rt.reindexer->ModifyItems("not_existing_ns", items, ModeUpsert, itemsErrors);
+	EXPECT_EQ(err.code(), errParams);
+	for (auto& itemErr : itemsErrors) EXPECT_EQ(itemErr.code(), errParams);
+}
+
+TEST_F(NsApi, SelectFilterOnWideDocument) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"objs.price", "tree", "int", IndexOpts().Array(), 0}});
+	std::string json = R"({"id":1,)";
+	for (int i = 0; i < 300; ++i) json += "\"f" + std::to_string(i) + "\":" + std::to_string(i) + ",";
+	json += R"("nested":{"a":1,"b":{"c":2}},"objs":[{"price":1,"name":"x"},{"price":2}],"tail":"t"})";
+	Item item = NewItem(default_namespace);
+	err = item.FromJSON(json);
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(default_namespace, item);
+
+	auto selectJSON = [&](const std::vector<std::string>& filter) {
+		QueryResults qr;
+		Query q(default_namespace);
+		for (auto& f : filter) q.selectFilter_.emplace_back(f);
+		Error err = rt.reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1u);
+		reindexer::WrSerializer ser;
+		err = qr[0].GetJSON(ser, false);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return std::string(ser.Slice());
+	};
+	EXPECT_EQ(selectJSON({"f5"}), R"({"f5":5})");
+	EXPECT_EQ(selectJSON({"f250", "f5", "nested.b"}), R"({"f5":5,"f250":250,"nested":{"b":{"c":2}}})");
+	// Indexed array values after the skipped subtrees are taken from the right positions of the payload array
+	EXPECT_EQ(selectJSON({"objs.price", "tail"}), R"({"objs":[{"price":1},{"price":2}],"tail":"t"})");
+	EXPECT_EQ(selectJSON({"tail", "unknown_field"}), selectJSON({}));
+
+	// Values by json path are extracted by the same encoder
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1u);
+	Item selected = qr[0].GetItem(false);
+	EXPECT_EQ(selected["f7"].As<int>(), 7);
+	EXPECT_EQ(selected["nested.b.c"].As<int>(), 2);
+}
+
+TEST_F(NsApi, UpdateScalarFieldsInTuple) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"flag", "tree", "bool", IndexOpts(), 0}});
+	Item item = NewItem(default_namespace);
+	err = item.FromJSON(
+		R"({"id":1,"flag":true,"counter":1,"nested":{"a":"str","b":{"c":1.5},"d":[1,2]},"objs":[{"v":1},{"v":2}]})");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(default_namespace, item);
+
+	auto update = [&](Query&& q) {
+		QueryResults qr;
+		Error err = rt.reindexer->Update(q.Where(idIdxName, CondEq, 1), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1u);
+	};
+	auto selectJSON = [&]() {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query(default_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1u);
+		reindexer::WrSerializer ser;
+		err = qr[0].GetJSON(ser, false);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return std::string(ser.Slice());
+	};
+
+	// Values of the existing fields are replaced with the change of the encoded length and type
+	update(Query(default_namespace).Set("counter", 100500));
+	update(Query(default_namespace).Set("nested.b.c", "value"));
+	update(Query(default_namespace).Set("nested.d", 3));
+	// New fields are inserted by the full rebuild of tuple
+	update(Query(default_namespace).Set("nested.e", 7));
+	EXPECT_EQ(selectJSON(),
+			  R"({"id":1,"flag":true,"counter":100500,"nested":{"a":"str","b":{"c":"value"},"d":3,"e":7},"objs":[{"v":1},{"v":2}]})");
+
+	// Flag is set to the same value: item is still matched by the index
+	update(Query(default_namespace).Set("flag", true));
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Where("flag", CondEq, true), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), 1u);
+	update(Query(default_namespace).Set("flag", false));
+	qr.Clear();
+	err = rt.reindexer->Select(Query(default_namespace).Where("flag", CondEq, true), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), 0u);
+}
+
+TEST_F(NsApi, ColumnarQueryResults) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"name", "hash", "string", IndexOpts(), 0},
+											   IndexDeclaration{"tags", "hash", "string", IndexOpts().Array(), 0}});
+	const char* jsons[] = {R"({"id":1,"name":"a","tags":["x"],"extra":1})", R"({"id":2,"name":"b","tags":["y","x"]})",
+						   R"({"id":3,"name":"a","tags":[]})", R"({"id":4,"name":"b","tags":["y"]})"};
+	for (const char* json : jsons) {
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON(json);
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Sort(idIdxName, false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 4u);
+
+	reindexer::WrSerializer ser;
+	reindexer::JsonBuilder builder(ser);
+	reindexer::ColumnarEncoder encoder(qr, 1, 10);
+	EXPECT_EQ(encoder.Rows(), 3u);
+	encoder.Encode(builder, "columnar");
+	builder.End();
+	EXPECT_EQ(ser.Slice(),
+			  R"({"columnar":{"rows":3,"fields":[{"name":"id","type":"int","values":[2,3,4]},)"
+			  R"({"name":"name","type":"string","dictionary":["b","a"],"indices":[0,1,0]},)"
+			  R"({"name":"tags","type":"string","dictionary":["y","x"],"indices":[[0,1],[],[0]]}]}})");
+}
+
+TEST_F(NsApi, ItemViewsResults) {
+	DefineDefaultNamespace();
+	FillDefaultNamespace(100);
+
+	QueryResults qr;
+	Error err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondLt, 50), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 50u);
+
+	reindexer::WrResultSerializer wrser({kResultsItemViews | kResultsWithItemID, {}, 0, UINT_MAX});
+	wrser.PutResults(&qr);
+	reindexer::Serializer ser(wrser.Buf(), wrser.Len());
+	const int flags = ser.GetVarUint();
+	ASSERT_EQ(flags & kResultsFormatMask, kResultsItemViews);
+	ser.GetVarUint();
+	ser.GetVarUint();
+	ASSERT_EQ(ser.GetVarUint(), qr.Count());
+	while (ser.GetVarUint() != QueryResultEnd) ser.GetSlice();
+
+	// Views follow the query params in place, aligned by their address
+	const uintptr_t viewsAddr = (uintptr_t(ser.Buf() + ser.Pos()) + 7) & ~uintptr_t(7);
+	ASSERT_EQ(uintptr_t(ser.Buf()) + ser.Len(), viewsAddr + qr.Count() * sizeof(reindexer_item_view));
+	const auto* views = reinterpret_cast<const reindexer_item_view*>(viewsAddr);
+	for (size_t i = 0; i < qr.Count(); ++i) {
+		const auto& itemRef = qr.Items()[i];
+		EXPECT_EQ(views[i].cptr, uintptr_t(itemRef.Value().Ptr()));
+		EXPECT_EQ(views[i].lsn, itemRef.Value().GetLSN());
+		EXPECT_EQ(views[i].id, itemRef.Id());
+		EXPECT_EQ(views[i].nsid, itemRef.Nsid());
+	}
+
+	// Results with the joined items are passed as the pointers
+	QueryResults jqr;
+	err = rt.reindexer->Select(
+		Query(default_namespace).Where(idIdxName, CondLt, 10).InnerJoin(idIdxName, idIdxName, CondEq, Query(default_namespace)), jqr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(jqr.Count(), 10u);
+	reindexer::WrResultSerializer jwrser({kResultsItemViews | kResultsWithItemID, {}, 0, UINT_MAX});
+	jwrser.PutResults(&jqr);
+	reindexer::Serializer jser(jwrser.Buf(), jwrser.Len());
+	EXPECT_EQ(int(jser.GetVarUint()) & kResultsFormatMask, kResultsPtrs);
+}
+
+TEST_F(NsApi, SpilledResultsAreFetchedAsRegular) {
+	DefineDefaultNamespace();
+	FillDefaultNamespace(100);
+
+	QueryResults qr;
+	Error err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondLt, 50).ReqTotal(), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 50u);
+
+	const int flags = kResultsCJson | kResultsWithItemID;
+	const reindexer::SpilledQueryResults spilled(qr, flags, 20);
+	EXPECT_EQ(spilled.Offset(), 20u);
+	EXPECT_EQ(spilled.Count(), qr.Count());
+	for (unsigned offset : {20u, 35u, 45u, 50u}) {
+		const reindexer::ResultFetchOpts opts{flags, {}, offset, 10};
+		reindexer::WrResultSerializer expected(opts);
+		const bool expectedLast = expected.PutResults(&qr);
+		reindexer::WrSerializer ser;
+		EXPECT_EQ(spilled.PutResults(ser, opts), expectedLast) << offset;
+		EXPECT_EQ(ser.Slice(), expected.Slice()) << offset;
+	}
+
+	// Items before the spilled ones and the other formats are not available
+	reindexer::WrSerializer ser;
+	EXPECT_THROW(spilled.PutResults(ser, {flags, {}, 10, 10}), Error);
+	EXPECT_THROW(spilled.PutResults(ser, {kResultsJson, {}, 20, 10}), Error);
+	EXPECT_FALSE(reindexer::SpilledQueryResults::CanSpill(kResultsPtrs));
+}
+
+TEST_F(NsApi, JoinedItemsRefs) {
+	DefineDefaultNamespace();
+	FillDefaultNamespace(100);
+
+	// Each of the right items is joined with the several left ones
+	QueryResults qr;
+	Error err = rt.reindexer->Select(Query(default_namespace)
+										 .Where(idIdxName, CondLt, 20)
+										 .InnerJoin(intField, intField, CondGe, Query(default_namespace).Where(idIdxName, CondLt, 3)),
+									 qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_GT(qr.Count(), 0u);
+
+	// Ids and pointers of the main and the joined items in the order of the results
+	const auto parse = [](const reindexer::WrResultSerializer& wrser, int& flags) {
+		std::vector<std::pair<int, uint64_t>> items, refs;
+		reindexer::Serializer ser(wrser.Buf(), wrser.Len());
+		flags = ser.GetVarUint();
+		ser.GetVarUint();
+		ser.GetVarUint();
+		const unsigned count = ser.GetVarUint();
+		while (ser.GetVarUint() != QueryResultEnd) ser.GetSlice();
+		const auto getItem = [&ser] {
+			const int id = ser.GetVarUint();
+			ser.GetVarUint();
+			return std::make_pair(id, ser.GetUInt64());
+		};
+		for (unsigned i = 0; i < count; ++i) {
+			items.emplace_back(getItem());
+			const unsigned fieldsCount = ser.GetVarUint();
+			for (unsigned field = 0; field < fieldsCount; ++field) {
+				const unsigned joinedCount = ser.GetVarUint();
+				for (unsigned j = 0; j < joinedCount; ++j) {
+					const unsigned ref = (flags & kResultsJoinedRefs) ? ser.GetVarUint() : 0;
+					if (ref) {
+						items.emplace_back(refs.at(ref - 1));
+					} else {
+						items.emplace_back(getItem());
+						refs.emplace_back(items.back());
+					}
+				}
+			}
+		}
+		EXPECT_TRUE(ser.Eof());
+		return std::make_pair(items, refs.size());
+	};
+
+	int flags = 0;
+	reindexer::WrResultSerializer plainSer({kResultsPtrs | kResultsWithItemID, {}, 0, UINT_MAX});
+	plainSer.PutResults(&qr);
+	const auto plain = parse(plainSer, flags);
+	EXPECT_FALSE(flags & kResultsJoinedRefs);
+
+	reindexer::WrResultSerializer refsSer({kResultsPtrs | kResultsWithItemID | kResultsJoinedRefs, {}, 0, UINT_MAX});
+	refsSer.PutResults(&qr);
+	const auto withRefs = parse(refsSer, flags);
+	EXPECT_TRUE(flags & kResultsJoinedRefs);
+	EXPECT_EQ(withRefs.first, plain.first);
+	// Only 3 right items are put
+	EXPECT_EQ(withRefs.second, 3u);
+	EXPECT_LT(refsSer.Len(), plainSer.Len());
+
+	// Spilled items are self-contained
+	const reindexer::SpilledQueryResults spilled(qr, kResultsCJson | kResultsWithItemID | kResultsJoinedRefs, 0);
+	reindexer::WrSerializer spilledSer;
+	spilled.PutResults(spilledSer, {kResultsCJson | kResultsWithItemID | kResultsJoinedRefs, {}, 0, UINT_MAX});
+	reindexer::Serializer ser(spilledSer.Buf(), spilledSer.Len());
+	EXPECT_FALSE(ser.GetVarUint() & kResultsJoinedRefs);
+}
+
+TEST_F(NsApi, PooledItemsReuseBuffers) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0}});
+
+	// Items are returned to the pool of namespace and decoded again, so the long and the short documents use the same buffers
+	std::vector<std::string> jsons;
+	for (int i = 0; i < 20; ++i) {
+		const size_t len = (i % 3 == 0) ? 2 * reindexer::ItemImpl::kMaxPooledBufferSize : size_t(i);
+		jsons.emplace_back(R"({"id":)" + std::to_string(i) + R"(,"data":")" + std::string(len, 'a' + i) + R"("})");
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON(jsons.back());
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Sort(idIdxName, false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), jsons.size());
+	for (size_t i = 0; i < jsons.size(); ++i) {
+		reindexer::WrSerializer ser;
+		err = qr[i].GetJSON(ser, false);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(ser.Slice(), jsons[i]);
+	}
+}
+
+TEST_F(NsApi, QueryTracesNs) {
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0}});
+	for (int i = 0; i < 10; ++i) {
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON(R"({"id":)" + std::to_string(i) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+
+	Item config = NewItem("#config");
+	err = config.FromJSON(R"json({"type":"profiling","profiling":{"memstats":true,"query_traces_sample_rate":1.0}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", config);
+
+	const Query query = Query(default_namespace).Where(idIdxName, CondGe, 5).Sort(idIdxName, true);
+	{
+		QueryResults qr;
+		err = rt.reindexer->Select(query, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 5u);
+	}
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query("#querytraces").Where("query", CondEq, query.GetSQL()), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1u);
+	const std::string json(qr[0].GetItem(false).GetJSON());
+	for (const char *stage : {"lock_wait", "prepare", "indexes", "loop", "postprocess", "select_functions"}) {
+		EXPECT_NE(json.find(std::string(R"("stage":")") + stage + '"'), std::string::npos) << stage << ": " << json;
+	}
+	EXPECT_NE(json.find(R"("namespace":")" + default_namespace + '"'), std::string::npos) << json;
+
+	// Traces are not recorded, when sample rate is 0
+	config = NewItem("#config");
+	err = config.FromJSON(R"json({"type":"profiling","profiling":{"memstats":true,"query_traces_sample_rate":0.0}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", config);
+	{
+		QueryResults qrSelect;
+		err = rt.reindexer->Select(query, qrSelect);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	qr.Clear();
+	err = rt.reindexer->Select(Query("#querytraces").Where("query", CondEq, query.GetSQL()), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), 1u);
+}
+
+TEST_F(NsApi, SlowQueriesNs) {
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0}});
+	for (int i = 0; i < 10; ++i) {
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON(R"({"id":)" + std::to_string(i) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+
+	Item config = NewItem("#config");
+	err = config.FromJSON(R"json({"type":"profiling","profiling":{"memstats":true,"slow_queries_threshold_us":1}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", config);
+
+	for (int i = 0; i < 2; ++i) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondGe, 5 + i).Sort(idIdxName, true), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	const std::string normalizedSQL = Query(default_namespace).Where(idIdxName, CondGe, 5).Sort(idIdxName, true).GetSQL(true);
+	QueryResults qr;
+	err = rt.reindexer->Select(Query("#slowqueries").Where("query", CondEq, normalizedSQL).Sort("id", false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 2u);
+	std::string planFingerprint;
+	for (auto &it : qr) {
+		Item item = it.GetItem(false);
+		const std::string json(item.GetJSON());
+		EXPECT_NE(json.find(R"("namespace":")" + default_namespace + '"'), std::string::npos) << json;
+		EXPECT_NE(json.find(R"("selectors":[)"), std::string::npos) << json;
+		EXPECT_NE(json.find(R"("plan_changed":false)"), std::string::npos) << json;
+		// Both queries have the same shape and plan
+		if (planFingerprint.empty()) planFingerprint = item["plan_fingerprint"].As<std::string>();
+		EXPECT_EQ(item["plan_fingerprint"].As<std::string>(), planFingerprint);
+	}
+
+	// Writing to the namespace resets the log
+	Item reset = NewItem("#slowqueries");
+	err = reset.FromJSON(R"({"id":0})");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#slowqueries", reset);
+	qr.Clear();
+	err = rt.reindexer->Select(Query("#slowqueries").Where("query", CondEq, normalizedSQL), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), 0u);
+}
+
+TEST_F(NsApi, IndexAdvicesNs) {
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0}});
+	for (int i = 0; i < 10; ++i) {
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON(R"({"id":)" + std::to_string(i) + R"(,"value":)" + std::to_string(i % 3) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+
+	Item config = NewItem("#config");
+	err = config.FromJSON(R"json({"type":"profiling","profiling":{"queriesperfstats":true,"queries_threshold_us":0}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", config);
+
+	for (int i = 0; i < 3; ++i) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Where("value", CondEq, i), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		qr.Clear();
+		err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondGe, i), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	auto checkAdvice = [&](const std::string &id, std::string_view indexType) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query("#indexadvices").Where("id", CondEq, id), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1u) << id;
+		Item item = qr.begin().GetItem(false);
+		EXPECT_EQ(item["index_type"].As<std::string>(), indexType) << item.GetJSON();
+		EXPECT_EQ(item["queries_count"].As<int64_t>(), 3) << item.GetJSON();
+		EXPECT_GT(item["estimated_memory_bytes"].As<int64_t>(), 0) << item.GetJSON();
+	};
+	// Condition on the non-indexed field is checked by the comparator
+	checkAdvice(default_namespace + ":add_index:value", "hash");
+	// Range condition on the hash index iterates all its keys
+	checkAdvice(default_namespace + ":change_index_type:" + idIdxName, "tree");
+}
+
+TEST_F(NsApi, TrigramIndexes) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace,
+						   {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+							IndexDeclaration{"hash_value", "hash", "string", IndexOpts().Trigram(), 0},
+							IndexDeclaration{"tree_value", "tree", "string", IndexOpts().Trigram().SetCollateMode(CollateUTF8), 0},
+							IndexDeclaration{"plain_value", "hash", "string", IndexOpts(), 0}});
+
+	// Trigram option is not allowed for the other index types and the collations, which are not compatible with LIKE
+	err = rt.reindexer->AddIndex(default_namespace, reindexer::IndexDef{"int_value", {"int_value"}, "hash", "int", IndexOpts().Trigram()});
+	EXPECT_EQ(err.code(), errParams) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, reindexer::IndexDef{"numeric_value", {"numeric_value"}, "tree", "string",
+																		IndexOpts().Trigram().SetCollateMode(CollateNumeric)});
+	EXPECT_EQ(err.code(), errParams) << err.what();
+
+	const std::vector<std::string> words{"Apple", "pineapple", "ЯБЛОКО", "application", "grape", "Grapefruit", "ap"};
+	constexpr int kItemsCount = 5000;
+	for (int i = 0; i < kItemsCount; ++i) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		const std::string value = words[i % words.size()] + "_" + std::to_string(i % 100);
+		item["hash_value"] = value;
+		item["tree_value"] = value;
+		item["plain_value"] = value;
+		Upsert(default_namespace, item);
+	}
+
+	auto count = [&](const std::string& field, const std::string& pattern) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query(default_namespace).Where(field, CondLike, pattern), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+	// Results of the trigram indexes are the same as the results of the full scan
+	auto check = [&] {
+		for (const std::string pattern : {"%appl%", "%APPLE%", "%apple_1%", "gr_pe%", "%лок%", "%ap%", "%xyz%", "grape%fruit%", "%_99"}) {
+			const size_t expected = count("plain_value", pattern);
+			ASSERT_EQ(count("hash_value", pattern), expected) << pattern;
+			ASSERT_EQ(count("tree_value", pattern), expected) << pattern;
+		}
+	};
+	check();
+	ASSERT_GT(count("plain_value", "%appl%"), 0);
+	// Keys are removed from the trigram indexes with their last items
+	for (int i = 0; i < kItemsCount; ++i) {
+		if (i % 100 >= 50) continue;
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		err = rt.reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	check();
+}
+
+TEST_F(NsApi, ItemsCompaction) {
+	// Free rows of the namespace are compacted in background, when their part exceeds 'items_compaction_free_percent'
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{"name", "hash", "string", IndexOpts(), 0},
+											   IndexDeclaration{"tags", "hash", "int", IndexOpts().Array(), 0},
+											   IndexDeclaration{"sparse", "hash", "string", IndexOpts().Sparse(), 0}});
+
+	constexpr int kItemsCount = 12000;
+	for (int id = 0; id < kItemsCount; ++id) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		err = it.FromJSON(fmt::sprintf(R"json({"%s":%d,"value":%d,"name":"name_%d","tags":[%d,%d],"sparse":"s%d","extra":%d})json",
+									   idIdxName, id, id % 10, id % 5, id % 7, 10 + id % 3, id % 4, id));
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+	QueryResults delQr;
+	err = rt.reindexer->Delete(Query(default_namespace).Where("value", CondGt, 0), delQr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(delQr.Count(), size_t(kItemsCount * 9 / 10));
+
+	Item config = NewItem("#config");
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	err = config.FromJSON(
+		R"json({"type":"namespaces","namespaces":[{"namespace":"*","optimization_timeout_ms":10,"items_compaction_free_percent":50}]})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", config);
+
+	for (int i = 0;; ++i) {
+		ASSERT_LT(i, 200) << "Items were not compacted";
+		QueryResults qr;
+		err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1u);
+		if (qr.begin().GetItem(false).GetJSON().find("empty_items_count") == std::string_view::npos) break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	auto check = [&](const Query& q, const std::function<bool(int)>& pred) {
+		QueryResults qr;
+		err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		std::vector<int> ids, expected;
+		for (auto it : qr) ids.push_back(it.GetItem(false)[idIdxName].As<int>());
+		for (int id = 0; id < kItemsCount; id += 10) {
+			if (pred(id)) expected.push_back(id);
+		}
+		std::sort(ids.begin(), ids.end());
+		ASSERT_EQ(ids, expected) << q.GetSQL();
+	};
+	check(Query(default_namespace), [](int) { return true; });
+	check(Query(default_namespace).Where(idIdxName, CondLt, 3000), [](int id) { return id < 3000; });
+	check(Query(default_namespace).Where("value", CondEq, 0), [](int) { return true; });
+	check(Query(default_namespace).Where("name", CondEq, "name_0"), [](int) { return true; });
+	for (int t = 0; t < 7; ++t) check(Query(default_namespace).Where("tags", CondEq, t), [t](int id) { return id % 7 == t; });
+	check(Query(default_namespace).Where("sparse", CondEq, "s2"), [](int id) { return id % 4 == 2; });
+	check(Query(default_namespace).Where("extra", CondGe, 6000), [](int id) { return id >= 6000; });
+
+	// New items take the ids after the compacted ones
+	Item it = NewItem(default_namespace);
+	ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+	err = it.FromJSON(fmt::sprintf(R"json({"%s":%d,"value":0,"name":"name_0","tags":[1]})json", idIdxName, kItemsCount));
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(default_namespace, it);
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Where("tags", CondEq, 1).Sort(idIdxName, true).Limit(1), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1u);
+	EXPECT_EQ(qr.begin().GetItem(false)[idIdxName].As<int>(), kItemsCount);
+}
+
+TEST_F(NsApi, UpdateOfChangedIndexedFields) {
+	// Only the changed indexed fields of the updated item are modified in the indexes
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts(), 0},
+											   IndexDeclaration{"name", "hash", "string", IndexOpts(), 0},
+											   IndexDeclaration{"tags", "hash", "int", IndexOpts().Array(), 0},
+											   IndexDeclaration{"value+name", "hash", "composite", IndexOpts(), 0}});
+
+	constexpr int kItemsCount = 100;
+	auto upsert = [&](int id, int value, int name, int tag) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		err = it.FromJSON(fmt::sprintf(R"json({"%s":%d,"value":%d,"name":"name_%d","tags":[%d,%d],"extra":%d})json", idIdxName, id,
+									   value, name, tag, tag + 1, id));
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	};
+	auto count = [&](const Query& q) {
+		QueryResults qr;
+		err = rt.reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+	for (int id = 0; id < kItemsCount; ++id) upsert(id, id, id, id);
+	// Each update changes the single indexed field
+	for (int id = 0; id < kItemsCount; id += 2) upsert(id, -id, id, id);
+	for (int id = 0; id < kItemsCount; id += 3) upsert(id, id % 2 ? id : -id, id + kItemsCount, id);
+	for (int id = 0; id < kItemsCount; id += 5) upsert(id, id % 2 ? id : -id, id % 3 ? id : id + kItemsCount, 2 * kItemsCount);
+
+	for (int id = 0; id < kItemsCount; ++id) {
+		const int value = id % 2 ? id : -id;
+		const int name = id % 3 ? id : id + kItemsCount;
+		const int tag = id % 5 ? id : 2 * kItemsCount;
+		EXPECT_EQ(count(Query(default_namespace).Where("value", CondEq, value)), 1u) << id;
+		EXPECT_EQ(count(Query(default_namespace).Where("name", CondEq, fmt::sprintf("name_%d", name))), 1u) << id;
+		EXPECT_EQ(
+			count(Query(default_namespace).WhereComposite("value+name", CondEq, {{Variant(value), Variant(fmt::sprintf("name_%d", name))}})),
+			1u)
+			<< id;
+		EXPECT_EQ(count(Query(default_namespace).Where("tags", CondEq, tag + 1).Where(idIdxName, CondEq, id)), 1u) << id;
+	}
+	EXPECT_EQ(count(Query(default_namespace).Where("tags", CondEq, 2 * kItemsCount)), size_t(kItemsCount / 5));
+	EXPECT_EQ(count(Query(default_namespace).Where("value", CondLt, 0)), size_t(kItemsCount / 2 - 1));
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Sort("value", false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	int prev = std::numeric_limits<int>::min();
+	for (auto it : qr) {
+		const int value = it.GetItem(false)["value"].As<int>();
+		ASSERT_GE(value, prev);
+		prev = value;
+	}
+}
+
+TEST_F(NsApi, ParallelMergedQueries) {
+	// Merged queries are executed by the several workers, and their results are appended in the order of the merged namespaces
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	constexpr int kNamespacesCount = 4;
+	constexpr int kItemsCount = 500;
+	auto nsName = [](int n) { return fmt::sprintf("merged_ns_%d", n); };
+	for (int n = 0; n < kNamespacesCount; ++n) {
+		err = rt.reindexer->OpenNamespace(nsName(n));
+		ASSERT_TRUE(err.ok()) << err.what();
+		DefineNamespaceDataset(nsName(n), {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+										   IndexDeclaration{"value", "tree", "int", IndexOpts(), 0}});
+		for (int id = 0; id < kItemsCount; ++id) {
+			Item it = NewItem(nsName(n));
+			ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+			err = it.FromJSON(fmt::sprintf(R"json({"%s":%d,"value":%d,"ns":%d})json", idIdxName, id, id % 10, n));
+			ASSERT_TRUE(err.ok()) << err.what();
+			Upsert(nsName(n), it);
+		}
+	}
+
+	auto select = [&](int workers) {
+		Item item = NewItem("#config");
+		EXPECT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON(
+			fmt::sprintf(R"json({"type":"namespaces","namespaces":[{"namespace":"*", "subqueries_workers":%d}]})json", workers));
+		EXPECT_TRUE(err.ok()) << err.what();
+		Upsert("#config", item);
+		Query q = Query(nsName(0)).Where("value", CondLt, 3);
+		for (int n = 1; n < kNamespacesCount; ++n) {
+			q.mergeQueries_.emplace_back(Merge, Query(nsName(n)).Where("value", CondGe, n));
+		}
+		QueryResults qr;
+		err = rt.reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::vector<std::string> items;
+		for (auto it : qr) items.emplace_back(it.GetItem(false).GetJSON());
+		return items;
+	};
+
+	const auto sequential = select(0);
+	size_t expected = kItemsCount / 10 * 3;
+	for (int n = 1; n < kNamespacesCount; ++n) expected += kItemsCount / 10 * (10 - n);
+	ASSERT_EQ(sequential.size(), expected);
+	for (int i = 0; i < 5; ++i) {
+		ASSERT_EQ(select(4), sequential);
+	}
+}
+
+TEST_F(NsApi, LargeSetConditions) {
+	// Idsets of the large IN-condition are merged before the select
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "hash", "int", IndexOpts(), 0},
+											   IndexDeclaration{"tags", "tree", "int", IndexOpts().Array(), 0}});
+	constexpr int kItemsCount = 5000;
+	for (int id = 0; id < kItemsCount; ++id) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		err = it.FromJSON(fmt::sprintf(R"json({"%s":%d,"value":%d,"tags":[%d,%d],"extra":%d})json", idIdxName, id, id % 500, id % 300,
+									   id % 300 + 1, id));
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+
+	auto check = [&](const Query& q, size_t expectedCount, bool sortedById) {
+		QueryResults qr;
+		err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), expectedCount) << q.GetSQL();
+		int prev = -1;
+		for (auto it : qr) {
+			const int id = it.GetItem(false)[idIdxName].As<int>();
+			if (sortedById) {
+				ASSERT_GT(id, prev) << q.GetSQL();
+			}
+			prev = id;
+		}
+	};
+	VariantArray keys;
+	for (int id = kItemsCount * 2; id >= 0; id -= 3) keys.emplace_back(id);
+	const size_t inRange = (kItemsCount + 2) / 3;
+	check(Query(default_namespace).Where(idIdxName, CondSet, keys), inRange, false);
+	check(Query(default_namespace).Where(idIdxName, CondSet, keys).Sort(idIdxName, false), inRange, true);
+	check(Query(default_namespace).Where(idIdxName, CondSet, keys).Where("value", CondLt, 250), inRange / 2, false);
+	check(Query(default_namespace).Where("extra", CondSet, keys), inRange, false);
+
+	keys.clear();
+	for (int v = 0; v < 200; ++v) keys.emplace_back(v);
+	check(Query(default_namespace).Where("value", CondSet, keys), size_t(kItemsCount / 500 * 200), false);
+	check(Query(default_namespace).Where("tags", CondSet, keys), size_t(kItemsCount / 300 * 200 + kItemsCount % 300), false);
+	check(Query(default_namespace).Where("value", CondSet, keys).Distinct("value"), 200u, false);
+}
+
+TEST_F(NsApi, NamespacesMetrics) {
+	// Cheap metrics of the namespaces are consistent with the namespaces content and skip the system namespaces
+	Error err = rt.reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK(), 0}});
+	constexpr int kItemsCount = 100;
+	for (int id = 0; id < kItemsCount; ++id) {
+		Item it = NewItem(default_namespace);
+		ASSERT_TRUE(it.Status().ok()) << it.Status().what();
+		err = it.FromJSON(fmt::sprintf(R"json({"%s":%d})json", idIdxName, id));
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, it);
+	}
+
+	auto getMetrics = [&]() {
+		std::vector<reindexer::NamespaceMetrics> metrics;
+		err = rt.reindexer->GetNamespacesMetrics(metrics);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(metrics.size(), 1u);
+		return metrics.empty() ? reindexer::NamespaceMetrics() : metrics.front();
+	};
+	reindexer::NamespaceMetrics metrics = getMetrics();
+	EXPECT_EQ(metrics.name, default_namespace);
+	EXPECT_EQ(metrics.itemsCount, uint32_t(kItemsCount));
+	EXPECT_FALSE(metrics.perfStats);
+
+	Item item = NewItem("#config");
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({"type":"profiling","profiling":{"perfstats":true}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", item);
+	for (int i = 0; i < 10; ++i) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Where(idIdxName, CondEq, i), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	metrics = getMetrics();
+	EXPECT_EQ(metrics.itemsCount, uint32_t(kItemsCount));
+	EXPECT_TRUE(metrics.perfStats);
+	EXPECT_GE(metrics.selects.totalHitCount, 10u);
+}
@@ -0,0 +1,36 @@
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/namespacesloadingscheduler.h"
+#include "gtest/gtest.h"
+
+using reindexer::NamespacesLoadingScheduler;
+
+TEST(NamespacesLoadingSchedulerTest, BiggestNamespacesAreAdmittedFirst) {
+	NamespacesLoadingScheduler scheduler;
+	scheduler.SetLimit(1);
+	std::mutex mtx;
+	std::vector<int64_t> order;
+	std::vector<std::thread> threads;
+	{
+		const auto slot = scheduler.Acquire(0);
+		for (int64_t size : {10, 30, 20, 30}) {
+			threads.emplace_back([&, size] {
+				const auto s = scheduler.Acquire(size);
+				std::lock_guard lck(mtx);
+				order.emplace_back(size);
+			});
+			// Waiters with the same size are admitted in order of their arrival
+			while (scheduler.Waiting() < threads.size()) std::this_thread::yield();
+		}
+	}
+	for (auto& th : threads) th.join();
+	EXPECT_EQ(order, std::vector<int64_t>({30, 30, 20, 10}));
+	EXPECT_EQ(scheduler.Waiting(), 0u);
+
+	// Without the limit slots are granted at once
+	scheduler.SetLimit(0);
+	const auto s1 = scheduler.Acquire(1);
+	const auto s2 = scheduler.Acquire(2);
+	EXPECT_EQ(scheduler.Waiting(), 0u);
+}
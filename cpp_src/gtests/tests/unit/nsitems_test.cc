@@ -0,0 +1,47 @@
+#include "core/namespace/nsitems.h"
+#include "gtest/gtest.h"
+
+using reindexer::NsItems;
+using reindexer::PayloadValue;
+
+TEST(NsItemsTest, CopiesSharePagesUntilModification) {
+	constexpr size_t kItemsCount = 3 * NsItems::kPageSize + 10;
+	NsItems items;
+	for (size_t i = 0; i < kItemsCount; ++i) {
+		PayloadValue pv(8);
+		pv.SetLSN(int64_t(i));
+		items.emplace_back(std::move(pv));
+	}
+	ASSERT_EQ(items.size(), kItemsCount);
+	ASSERT_EQ(items.capacity(), 4 * NsItems::kPageSize);
+
+	NsItems copy = items;
+	EXPECT_EQ(&copy[0], &items[0]);
+	EXPECT_EQ(&copy[kItemsCount - 1], &items[kItemsCount - 1]);
+
+	// Only the page of the modified item is cloned
+	const size_t modifiedId = NsItems::kPageSize + 5;
+	copy.Mutable(modifiedId) = PayloadValue();
+	EXPECT_TRUE(copy[modifiedId].IsFree());
+	EXPECT_FALSE(items[modifiedId].IsFree());
+	EXPECT_NE(&copy[NsItems::kPageSize], &items[NsItems::kPageSize]);
+	EXPECT_EQ(&copy[0], &items[0]);
+	EXPECT_EQ(&copy[2 * NsItems::kPageSize], &items[2 * NsItems::kPageSize]);
+	for (size_t i = 0; i < kItemsCount; ++i) {
+		ASSERT_EQ(items[i].GetLSN(), int64_t(i));
+		if (i != modifiedId) {
+			ASSERT_EQ(copy[i].GetLSN(), int64_t(i));
+		}
+	}
+
+	// Shrinking of the copy doesn't affect the source
+	copy.resize(NsItems::kPageSize + 1);
+	EXPECT_EQ(copy.size(), NsItems::kPageSize + 1);
+	EXPECT_EQ(copy.capacity(), 2 * NsItems::kPageSize);
+	EXPECT_EQ(items.size(), kItemsCount);
+	EXPECT_FALSE(items[NsItems::kPageSize + 1].IsFree());
+	copy.emplace_back(PayloadValue(8));
+	EXPECT_FALSE(copy.exists(modifiedId));
+	EXPECT_TRUE(copy.exists(NsItems::kPageSize + 1));
+	EXPECT_FALSE(copy.exists(kItemsCount));
+}
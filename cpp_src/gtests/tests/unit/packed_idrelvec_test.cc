@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "core/ft/idrelset.h"
+
+using reindexer::IdRelType;
+using reindexer::PackedIdRelVec;
+
+static std::vector<IdRelType> makeRelIds(std::mt19937& rng, size_t count, uint32_t firstId) {
+	std::vector<IdRelType> res;
+	uint32_t id = firstId;
+	for (size_t i = 0; i < count; ++i) {
+		// Large gaps check multibyte deltas. Ids are not decreasing in the index, but packing has to support any order
+		id += (i % 50 == 0) ? rng() % 100000 : rng() % 10;
+		res.emplace_back(i % 97 == 0 ? id / 3 : id);
+		for (int j = 0, cnt = rng() % 5; j < cnt; ++j) res.back().Add(rng() % (1 << 20), j % 3);
+	}
+	return res;
+}
+
+static void checkEqual(const PackedIdRelVec& packed, const std::vector<IdRelType>& expected) {
+	ASSERT_EQ(packed.size(), expected.size());
+	size_t i = 0;
+	for (auto& relid : packed) {
+		ASSERT_LT(i, expected.size());
+		ASSERT_EQ(relid.Id(), expected[i].Id()) << i;
+		ASSERT_EQ(relid.Size(), expected[i].Size()) << i;
+		ASSERT_EQ(relid.UsedFieldsMask(), expected[i].UsedFieldsMask()) << i;
+		for (size_t j = 0; j < relid.Size(); ++j) {
+			ASSERT_EQ(relid.Pos()[j].fpos, expected[i].Pos()[j].fpos) << i << ":" << j;
+		}
+		++i;
+	}
+	ASSERT_EQ(i, expected.size());
+}
+
+TEST(PackedIdRelVec, InsertAndEraseBack) {
+	std::mt19937 rng(11);
+	PackedIdRelVec packed;
+	auto expected = makeRelIds(rng, 1000, 0);
+	packed.insert(packed.end(), expected.begin(), expected.end());
+	checkEqual(packed, expected);
+
+	// Second step is appended after the first one. It's erased and packed again on recommit
+	const auto stepPos = packed.pos(packed.end());
+	auto step = makeRelIds(rng, 500, expected.back().Id());
+	packed.insert(packed.end(), step.begin(), step.end());
+	packed.erase_back(stepPos);
+	checkEqual(packed, expected);
+	step = makeRelIds(rng, 300, expected.back().Id());
+	packed.insert(packed.end(), step.begin(), step.end());
+	for (auto& relid : step) packed.push_back(relid);
+	expected.insert(expected.end(), step.begin(), step.end());
+	expected.insert(expected.end(), step.begin(), step.end());
+	checkEqual(packed, expected);
+
+	packed.erase_back(0);
+	EXPECT_TRUE(packed.empty());
+	step = makeRelIds(rng, 10, 5);
+	packed.insert(packed.end(), step.begin(), step.end());
+	checkEqual(packed, step);
+}
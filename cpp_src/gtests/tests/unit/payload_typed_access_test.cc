@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "core/keyvalue/key_string.h"
+#include "core/payload/payloadiface.h"
+
+using reindexer::ConstPayload;
+using reindexer::Payload;
+using reindexer::PayloadFieldType;
+using reindexer::PayloadType;
+using reindexer::PayloadValue;
+using reindexer::Variant;
+using reindexer::VariantArray;
+
+TEST(PayloadTypedAccess, FieldsMatchVariants) {
+	PayloadType type("ns");
+	type.Add(PayloadFieldType(KeyValueString, "-", {}, false));
+	type.Add(PayloadFieldType(KeyValueInt, "int", {"int"}, false));
+	type.Add(PayloadFieldType(KeyValueInt64, "ints64", {"ints64"}, true));
+	type.Add(PayloadFieldType(KeyValueDouble, "double", {"double"}, false));
+	type.Add(PayloadFieldType(KeyValueString, "strings", {"strings"}, true));
+	PayloadValue value(type.TotalSize());
+	Payload pl(type, value);
+	const reindexer::key_string str1 = reindexer::make_key_string("abc"), str2 = reindexer::make_key_string("def");
+	pl.Set(1, VariantArray{Variant(42)});
+	pl.Set(2, VariantArray{Variant(int64_t(1) << 40), Variant(int64_t(-5)), Variant(int64_t(7))});
+	pl.Set(3, VariantArray{Variant(0.5)});
+	pl.Set(4, VariantArray{Variant(str1), Variant(str2)});
+
+	const ConstPayload cpl(type, value);
+	for (int field = 1; field < type.NumFields(); ++field) {
+		VariantArray expected;
+		cpl.Get(field, expected);
+		VariantArray actual;
+		cpl.VisitField(field, [&actual](auto values) {
+			for (const auto &v : values) {
+				if constexpr (std::is_same_v<std::decay_t<decltype(v)>, reindexer::p_string>) {
+					actual.emplace_back(Variant(v, false));
+				} else {
+					actual.emplace_back(Variant(v));
+				}
+			}
+		});
+		EXPECT_EQ(actual, expected) << field;
+	}
+	EXPECT_EQ(cpl.GetTyped<int64_t>(2).size(), 3u);
+	EXPECT_EQ(cpl.GetTyped<int64_t>(2)[1], -5);
+	EXPECT_EQ(std::string_view(cpl.GetTyped<reindexer::p_string>(4)[1]), "def");
+
+	// Typed comparison of the fields gives the same result, as the comparison of their Variants
+	PayloadValue other(value);
+	other.Clone();
+	Payload(type, other).Set(1, VariantArray{Variant(41)});
+	Payload(type, other).Set(3, VariantArray{Variant(0.5)});
+	EXPECT_EQ(cpl.Field(1).Compare(ConstPayload(type, other).Field(1), CollateOpts()), 1);
+	EXPECT_EQ(cpl.Field(3).Compare(ConstPayload(type, other).Field(3), CollateOpts()), 0);
+	EXPECT_TRUE(cpl.IsFieldEQ(other, 2));
+	EXPECT_FALSE(cpl.IsFieldEQ(other, 1));
+}
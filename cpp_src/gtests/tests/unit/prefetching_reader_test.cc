@@ -0,0 +1,68 @@
+#include <map>
+#include "core/storage/prefetchingreader.h"
+#include "gtest/gtest.h"
+
+using namespace reindexer::datastorage;
+
+namespace {
+
+class MapComparator : public Comparator {
+public:
+	int Compare(std::string_view a, std::string_view b) const override { return a.compare(b); }
+};
+
+class MapCursor : public Cursor {
+public:
+	explicit MapCursor(const std::map<std::string, std::string>& data) : data_(data), it_(data_.end()) {}
+	bool Valid() const override { return it_ != data_.end(); }
+	void SeekToFirst() override { it_ = data_.begin(); }
+	void SeekToLast() override { it_ = std::prev(data_.end()); }
+	void Seek(std::string_view target) override { it_ = data_.lower_bound(std::string(target)); }
+	void Next() override { ++it_; }
+	void Prev() override { --it_; }
+	std::string_view Key() const override { return it_->first; }
+	std::string_view Value() const override { return it_->second; }
+	Comparator& GetComparator() override { return comparator_; }
+
+private:
+	const std::map<std::string, std::string>& data_;
+	std::map<std::string, std::string>::const_iterator it_;
+	MapComparator comparator_;
+};
+
+}  // namespace
+
+TEST(PrefetchingReaderTest, ReadsRangeInOrder) {
+	std::map<std::string, std::string> data;
+	constexpr int kCount = 10000;
+	for (int i = 0; i < kCount; ++i) {
+		data.emplace("I" + std::to_string(i), "value_" + std::to_string(i));
+		data.emplace("W" + std::to_string(i), "wal");
+	}
+	data.emplace("A", "before");
+
+	// Small batches and queue make the reader thread wait for the consumer
+	PrefetchingReader reader(std::make_unique<MapCursor>(data), "I", "I\xFF", 100, 2);
+	auto expected = data.lower_bound("I");
+	int count = 0;
+	reader.ForEach([&](std::string_view key, std::string_view value) {
+		EXPECT_EQ(key, expected->first);
+		EXPECT_EQ(value, expected->second);
+		++expected;
+		++count;
+		return true;
+	});
+	EXPECT_EQ(count, kCount);
+}
+
+TEST(PrefetchingReaderTest, StopsIteration) {
+	std::map<std::string, std::string> data;
+	for (int i = 0; i < 1000; ++i) {
+		data.emplace("I" + std::to_string(i), std::string(100, 'x'));
+	}
+	// Destructor has to stop the reader thread, which waits for the free place in the queue
+	PrefetchingReader reader(std::make_unique<MapCursor>(data), "I", "I\xFF", 100, 1);
+	int count = 0;
+	reader.ForEach([&](std::string_view, std::string_view) { return ++count < 10; });
+	EXPECT_EQ(count, 10);
+}
@@ -0,0 +1,73 @@
+#include "core/query/preparedquery.h"
+#include "gtest/gtest.h"
+
+using reindexer::Error;
+using reindexer::PreparedQuery;
+using reindexer::Query;
+using reindexer::Variant;
+using reindexer::VariantArray;
+
+TEST(PreparedQueryTest, BindsParamsInOrderOfPlaceholders) {
+	const PreparedQuery prepared("SELECT * FROM items WHERE id = ? AND category IN (?, 'books', ?) AND price > 10");
+	ASSERT_EQ(prepared.ParamsCount(), 3u);
+
+	Query q = prepared.Bind(VariantArray{Variant(5), Variant(std::string("food")), Variant(std::string("toys"))});
+	EXPECT_EQ(q.GetSQL(), "SELECT * FROM items WHERE id = 5 AND category IN ('food','books','toys') AND price > 10");
+
+	// Prepared query is not changed by bind, so it may be executed again with the other params
+	q = prepared.Bind(VariantArray{Variant(7), Variant(std::string("a")), Variant(std::string("b"))});
+	EXPECT_EQ(q.GetSQL(), "SELECT * FROM items WHERE id = 7 AND category IN ('a','books','b') AND price > 10");
+}
+
+TEST(PreparedQueryTest, ChecksParamsCount) {
+	const PreparedQuery prepared("SELECT * FROM items WHERE id = ?");
+	try {
+		prepared.Bind(VariantArray{Variant(1), Variant(2)});
+		FAIL() << "Params count mismatch is expected";
+	} catch (const Error &err) {
+		EXPECT_EQ(err.code(), errParams);
+	}
+
+	const PreparedQuery withoutParams("SELECT * FROM items WHERE id = 1");
+	EXPECT_EQ(withoutParams.ParamsCount(), 0u);
+	EXPECT_EQ(withoutParams.Bind({}).GetSQL(), "SELECT * FROM items WHERE id = 1");
+}
+
+TEST(PreparedQueryTest, PlaceholdersAreNotAllowedInNestedQueries) {
+	try {
+		PreparedQuery prepared("SELECT * FROM items INNER JOIN (SELECT * FROM other WHERE id = ?) ON items.id = other.id");
+		FAIL() << "Placeholders in joined query are not supported";
+	} catch (const Error &err) {
+		EXPECT_EQ(err.code(), errParseSQL);
+	}
+}
+
+TEST(PreparedQueryTest, ParameterizesValuesOfConditions) {
+	const std::string_view sql =
+		"SELECT id, name FROM items WHERE id = 5 AND category IN ('books', 'food') AND price > 10.5 AND name = other LIMIT 10";
+	std::string normalized;
+	VariantArray values;
+	ASSERT_TRUE(reindexer::SQLParser::Parameterize(sql, normalized, values));
+	EXPECT_EQ(normalized, "SELECT id, name FROM items WHERE id = ? AND category IN (?, ?) AND price > ? AND name = other LIMIT 10");
+	ASSERT_EQ(values.size(), 4u);
+
+	// Query, which is bound with the extracted values, is the same as the parsed one
+	const PreparedQuery prepared(normalized);
+	Query expected;
+	expected.FromSQL(sql);
+	EXPECT_EQ(prepared.Bind(values), expected);
+	EXPECT_EQ(prepared.Bind(values).GetSQL(), expected.GetSQL());
+
+	// Queries, which differ only by the values, have the same normalized text
+	std::string otherNormalized;
+	ASSERT_TRUE(reindexer::SQLParser::Parameterize(
+		"SELECT id, name FROM items WHERE id = 7 AND category IN ('toys', 'a') AND price > 1 AND name = other LIMIT 10", otherNormalized,
+		values));
+	EXPECT_EQ(otherNormalized, normalized);
+
+	for (std::string_view unsupported : {"UPDATE items SET price = 5 WHERE id = 1", "SELECT * FROM items WHERE id = ?",
+										 "SELECT * FROM items WHERE (id = 1 OR id = 2)",
+										 "SELECT * FROM items WHERE id = 1 INNER JOIN other ON items.id = other.id"}) {
+		EXPECT_FALSE(reindexer::SQLParser::Parameterize(unsupported, normalized, values)) << unsupported;
+	}
+}
@@ -0,0 +1,26 @@
+#include "core/queryresults/queryresults.h"
+#include "gtest/gtest.h"
+
+using reindexer::ItemRef;
+using reindexer::PayloadValue;
+using reindexer::QueryResults;
+
+TEST(QueryResultsTest, ReleaseItemsDataKeepsIds) {
+	constexpr int kItems = 5;
+	QueryResults qr;
+	for (int i = 0; i < kItems; ++i) qr.Add(ItemRef(i, PayloadValue(16)));
+	// Items without payloads are not changed
+	qr.Add(ItemRef(kItems, 0u));
+
+	// Items of the streamed chunks release their payloads, while the rest of the items are still accessible
+	qr.ReleaseItemsData(0, 2);
+	qr.ReleaseItemsData(4, 100);
+	ASSERT_EQ(qr.Count(), size_t(kItems + 1));
+	for (int i = 0; i < kItems; ++i) {
+		const auto &itemRef = qr.Items()[i];
+		EXPECT_EQ(itemRef.Id(), i);
+		EXPECT_EQ(itemRef.Value().IsFree(), i < 2 || i == 4) << i;
+	}
+	EXPECT_FALSE(qr.Items()[kItems].ValueInitialized());
+	EXPECT_EQ(qr.Items()[kItems].Id(), kItems);
+}
@@ -0,0 +1,89 @@
+#if defined(REINDEX_WITH_ROCKSDB) && !defined(_WIN32)
+
+#include <unistd.h>
+#include "core/reindexer.h"
+#include "gtest/gtest.h"
+#include "tools/fsops.h"
+
+using reindexer::Error;
+using reindexer::Item;
+using reindexer::Query;
+using reindexer::QueryResults;
+using reindexer::Reindexer;
+
+TEST(ReadOnlyStorageTest, SharedNamespaceImage) {
+	const std::string kBasePath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "ReadOnlyStorageTest");
+	const std::string kImageDbPath = reindexer::fs::JoinPath(kBasePath, "image");
+	const std::string kReaderDbPath = reindexer::fs::JoinPath(kBasePath, "reader");
+	const std::string kNs = "ro_ns";
+	constexpr int kItemsCount = 100;
+	const auto kConnectOpts = ConnectOpts().WithStorageType(kStorageTypeOptRocksDB);
+	reindexer::fs::RmDirAll(kBasePath);
+
+	// Build the image of the namespace
+	{
+		Reindexer rx;
+		Error err = rx.Connect("builtin://" + kImageDbPath, kConnectOpts);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.OpenNamespace(kNs);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(kNs, {"id", "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		for (int i = 0; i < kItemsCount; ++i) {
+			Item item = rx.NewItem(kNs);
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			err = item.FromJSON("{\"id\":" + std::to_string(i) + "}");
+			ASSERT_TRUE(err.ok()) << err.what();
+			err = rx.Upsert(kNs, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+		err = rx.CloseNamespace(kNs);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	const std::string imagePath = reindexer::fs::JoinPath(kImageDbPath, kNs);
+	ASSERT_EQ(reindexer::fs::WriteFile(reindexer::fs::JoinPath(imagePath, "read_only"), ""), 0);
+	ASSERT_EQ(reindexer::fs::MkDirAll(kReaderDbPath), 0);
+	ASSERT_EQ(symlink(imagePath.c_str(), reindexer::fs::JoinPath(kReaderDbPath, kNs).c_str()), 0);
+
+	// Both databases open the same storage at the same time
+	Reindexer rx1, rx2;
+	Error err = rx1.Connect("builtin://" + kImageDbPath, kConnectOpts);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rx2.Connect("builtin://" + kReaderDbPath, kConnectOpts);
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (auto rx : {&rx1, &rx2}) {
+		err = rx->OpenNamespace(kNs);
+		ASSERT_TRUE(err.ok()) << err.what();
+		QueryResults qr;
+		err = rx->Select(Query(kNs), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), kItemsCount);
+	}
+
+	// Modifications are rejected
+	Item item = rx1.NewItem(kNs);
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	err = item.FromJSON(R"json({"id":1000})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rx1.Upsert(kNs, item);
+	EXPECT_EQ(err.code(), errLogic) << err.what();
+	err = rx1.TruncateNamespace(kNs);
+	EXPECT_EQ(err.code(), errLogic) << err.what();
+	err = rx1.AddIndex(kNs, {"value", "hash", "string", IndexOpts()});
+	EXPECT_EQ(err.code(), errLogic) << err.what();
+	err = rx1.RenameNamespace(kNs, "ro_ns_renamed");
+	EXPECT_EQ(err.code(), errLogic) << err.what();
+
+	// Dropping of the namespace keeps the shared files
+	err = rx2.DropNamespace(kNs);
+	ASSERT_TRUE(err.ok()) << err.what();
+	QueryResults qr;
+	err = rx1.Select(Query(kNs), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), kItemsCount);
+	EXPECT_EQ(reindexer::fs::Stat(imagePath), reindexer::fs::StatDir);
+
+	reindexer::fs::RmDirAll(kBasePath);
+}
+
+#endif	// defined(REINDEX_WITH_ROCKSDB) && !defined(_WIN32)
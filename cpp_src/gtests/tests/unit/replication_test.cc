@@ -1,5 +1,7 @@
 #include <unordered_map>
 #include <unordered_set>
+#include "core/namespace/namespaceimpl.h"
+#include "gason/gason.h"
 #include "replication_load_api.h"
 #include "replicator/walrecord.h"
 
@@ -269,6 +271,219 @@ TEST_F(ReplicationLoadApi, SingleSlaveTest) {
 	WaitSync("some1");
 }
 
+TEST_F(ReplicationLoadApi, ForceSyncBulkLoad) {
+	InitNs();
+	FillData(5000);
+	ForceSync();
+	WaitSync("some");
+	WaitSync("some1");
+
+	// Indexes of the bulk loaded items have to be filled the same way, as on master
+	const Query q = Query("some").Where("int", CondGt, RAND_MAX / 2).Sort("int", false).Sort("id", false);
+	auto selectItems = [&q](ServerControl::Interface::Ptr srv) {
+		BaseApi::QueryResultsType res(srv->api.reindexer.get());
+		auto err = srv->api.reindexer->Select(q, res);
+		EXPECT_TRUE(err.ok()) << err.what();
+		std::vector<std::string> items;
+		WrSerializer ser;
+		for (auto it : res) {
+			ser.Reset();
+			err = it.GetJSON(ser, false);
+			EXPECT_TRUE(err.ok()) << err.what();
+			items.emplace_back(ser.Slice());
+		}
+		return items;
+	};
+	const auto masterItems = selectItems(GetSrv(masterId_));
+	ASSERT_FALSE(masterItems.empty());
+	for (size_t i = 0; i < GetServersCount(); ++i) {
+		if (i == masterId_) continue;
+		EXPECT_EQ(selectItems(GetSrv(i)), masterItems) << i;
+	}
+
+	// Bulk loaded items have to be written into the slave's storage
+	const size_t slaveId = (masterId_ + 1) % GetServersCount();
+	RestartServer(slaveId);
+	WaitSync("some");
+	WaitSync("some1");
+	EXPECT_EQ(selectItems(GetSrv(slaveId)), masterItems);
+}
+
+TEST_F(ReplicationLoadApi, DataHashBucketsQuery) {
+	InitNs();
+	FillData(1000);
+	WaitSync("some");
+
+	auto master = GetSrv(masterId_)->api.reindexer;
+	size_t itemsCount = 0;
+	{
+		BaseApi::QueryResultsType qr(master.get());
+		Error err = master->Select(Query("some"), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		itemsCount = qr.Count();
+		ASSERT_GT(itemsCount, 0u);
+	}
+
+	// Slave with the empty buckets receives list of all the master's non-empty buckets and all the master's items
+	VariantArray emptyBuckets;
+	for (unsigned i = 0; i < reindexer::NamespaceImpl::kDataHashBucketsCount; ++i) emptyBuckets.emplace_back(int64_t(0));
+	BaseApi::QueryResultsType qr(master.get(), kResultsWithPayloadTypes | kResultsCJson | kResultsWithItemID | kResultsWithRaw);
+	Error err = master->Select(Query("some").Where("#data_hash_buckets", CondSet, emptyBuckets), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	size_t items = 0;
+	std::vector<WALRecType> rawRecords;
+	std::string bucketsJSON;
+	for (auto it : qr) {
+		if (it.IsRaw()) {
+			reindexer::WALRecord wrec(it.GetRaw());
+			rawRecords.emplace_back(wrec.type);
+			if (wrec.type == reindexer::WalDataHashBuckets) bucketsJSON = std::string(wrec.data);
+		} else {
+			++items;
+		}
+	}
+	EXPECT_EQ(items, itemsCount);
+	ASSERT_EQ(rawRecords.size(), 2u);
+	EXPECT_EQ(rawRecords.front(), reindexer::WalDataHashBuckets);
+	EXPECT_EQ(rawRecords.back(), reindexer::WalReplState);
+	gason::JsonParser parser;
+	size_t bucketsCount = 0;
+	for (auto &bucket : parser.Parse(reindexer::giftStr(bucketsJSON))["buckets"]) {
+		EXPECT_LT(bucket.As<unsigned>(), reindexer::NamespaceImpl::kDataHashBucketsCount);
+		++bucketsCount;
+	}
+	EXPECT_GT(bucketsCount, 1u);
+	EXPECT_LE(bucketsCount, itemsCount);
+
+	// Query has to contain the hashes of all the buckets
+	BaseApi::QueryResultsType qrInvalid(master.get(), kResultsWithPayloadTypes | kResultsCJson | kResultsWithItemID | kResultsWithRaw);
+	err = master->Select(Query("some").Where("#data_hash_buckets", CondSet, {int64_t(0)}), qrInvalid);
+	EXPECT_FALSE(err.ok());
+}
+
+TEST_F(ReplicationLoadApi, ReplicationStats) {
+	InitNs();
+	FillData(1000);
+	WaitSync("some");
+
+	// Slave reports the applied master's records in '#replicationstats'
+	auto slave = GetSrv(1)->api.reindexer;
+	BaseApi::QueryResultsType qr(slave.get());
+	Error err = slave->Select(Query("#replicationstats").Where("name", CondEq, "some"), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1u);
+	reindexer::WrSerializer ser;
+	err = qr.begin().GetJSON(ser, false);
+	ASSERT_TRUE(err.ok()) << err.what();
+	gason::JsonParser parser;
+	auto stat = parser.Parse(reindexer::giftStr(ser.Slice()));
+	EXPECT_EQ(stat["name"].As<std::string>(), "some");
+	EXPECT_EQ(stat["lsn_lag"].As<int64_t>(), 0);
+	EXPECT_GT(stat["applied_records"].As<int64_t>(), 0);
+	EXPECT_GT(stat["recv_records"].As<int64_t>(), 0);
+	EXPECT_GT(stat["recv_bytes"].As<int64_t>(), 0);
+	EXPECT_EQ(stat["queued_updates"].As<int64_t>(), 0);
+	EXPECT_EQ(stat["applied_lsn"]["counter"].As<int64_t>(), stat["master_lsn"]["counter"].As<int64_t>());
+
+	// Master does not replicate anything
+	auto master = GetSrv(masterId_)->api.reindexer;
+	BaseApi::QueryResultsType qrMaster(master.get());
+	err = master->Select(Query("#replicationstats"), qrMaster);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qrMaster.Count(), 0u);
+}
+
+TEST_F(ReplicationLoadApi, WaitLSNOnSlave) {
+	InitNs();
+	FillData(100);
+	WaitSync("some");
+
+	auto master = GetSrv(masterId_)->api.reindexer;
+	auto slave = GetSrv(1)->api.reindexer;
+	constexpr int kItemsCount = 100;
+	for (int i = 0; i < kItemsCount; ++i) {
+		auto item = master->NewItem("some");
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		Error err = item.FromJSON("{\"id\":" + std::to_string(1000000 + i) + ",\"int\":" + std::to_string(i) + ",\"string\":\"wait\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = master->Upsert("some", item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	int64_t lastLSN = -1;
+	{
+		BaseApi::QueryResultsType qr(master.get(), kResultsWithPayloadTypes | kResultsCJson | kResultsWithItemID);
+		Error err = master->Select(Query("some").Where("id", CondEq, 1000000 + kItemsCount - 1), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1u);
+		lastLSN = qr.begin().GetLSN();
+		ASSERT_GE(lastLSN, 0);
+	}
+
+	// Slave's select sees all the master's modifications up to the waited LSN
+	BaseApi::QueryResultsType qr(slave.get());
+	Error err = slave->Select(Query("some").Where("string", CondEq, "wait").WaitLSN(lastLSN, std::chrono::seconds(10)), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), size_t(kItemsCount));
+
+	// LSN, which was not produced by master yet, is not awaited longer than the timeout
+	const auto start = std::chrono::steady_clock::now();
+	BaseApi::QueryResultsType qrTimeout(slave.get());
+	err = slave->Select(Query("some").WaitLSN(lastLSN + 1000000, std::chrono::milliseconds(200)), qrTimeout);
+	EXPECT_EQ(err.code(), errTimeout) << err.what();
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+	// Master does not wait for LSN
+	BaseApi::QueryResultsType qrMaster(master.get());
+	err = master->Select(Query("some").WaitLSN(lastLSN + 1000000, std::chrono::milliseconds(200)), qrMaster);
+	EXPECT_TRUE(err.ok()) << err.what();
+}
+
+TEST_F(ReplicationLoadApi, LargeTransactionParallelDecode) {
+	// Slave decodes items of the large replicated transactions by several threads
+	const size_t kSlaveId = 1;
+	RestartWithConfigFile(kSlaveId, "role: slave\n"
+									"master_dsn: cproto://127.0.0.1:" +
+										std::to_string(kDefaultRpcPort) +
+										"/node0\n"
+										"server_id: 1\n"
+										"force_sync_on_wrong_data_hash: true\n"
+										"tx_decode_threads: 4\n"
+										"namespaces: []");
+	InitNs();
+	WaitSync("some");
+
+	constexpr int kTxItems = 50000;
+	auto master = GetSrv(masterId_)->api.reindexer;
+	auto tx = master->NewTransaction("some");
+	ASSERT_TRUE(tx.Status().ok()) << tx.Status().what();
+	auto addItems = [&tx](int from, int to) {
+		for (int i = from; i < to; ++i) {
+			auto item = tx.NewItem();
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			Error err = item.FromJSON("{\"id\":" + std::to_string(i) + ",\"int\":" + std::to_string(i) + ",\"string\":\"initial\"}");
+			ASSERT_TRUE(err.ok()) << err.what();
+			err = tx.Upsert(std::move(item));
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+	};
+	addItems(0, kTxItems / 2);
+	// Update query has to be applied after the previous items and before the next ones
+	Error err = tx.Modify(Query("some").Where("int", CondLt, kTxItems).Set("string", "updated"));
+	ASSERT_TRUE(err.ok()) << err.what();
+	addItems(kTxItems / 2, kTxItems);
+	err = master->CommitTransaction(tx);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	WaitSync("some");
+	auto slave = GetSrv(kSlaveId)->api.reindexer;
+	for (auto &value : {"initial", "updated"}) {
+		BaseApi::QueryResultsType qr(slave.get());
+		err = slave->Select(Query("some").Where("string", CondEq, value), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), size_t(kTxItems / 2)) << value;
+	}
+}
+
 TEST_F(ReplicationLoadApi, ConfigSync) {
 	ReplicationConfigTest config("slave", true, false, 0, "cproto://127.0.0.1:6534/0", "slave_1");
 	const size_t kTestSlaveID = 2;
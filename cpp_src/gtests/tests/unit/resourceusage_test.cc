@@ -0,0 +1,90 @@
+#include "core/resourceusage.h"
+#include "gtest/gtest.h"
+
+using reindexer::CancelType;
+using reindexer::Error;
+using reindexer::ResourceAccount;
+using reindexer::ResourceQuotas;
+using reindexer::ResourceUsageScope;
+
+TEST(ResourceUsageTest, ChargesCurrentScope) {
+	ResourceAccount account(ResourceQuotas{});
+	ResourceUsageScope::AddRowsExamined(100);
+	{
+		ResourceUsageScope scope(account);
+		EXPECT_FALSE(scope.IsCancelable());
+		ResourceUsageScope::AddRowsExamined(10);
+		{
+			ResourceAccount nested(ResourceQuotas{});
+			ResourceUsageScope nestedScope(nested);
+			ResourceUsageScope::AddRowsExamined(1000);
+		}
+		ResourceUsageScope::AddRowsExamined(5);
+		EXPECT_EQ(scope.GetCancelType(), CancelType::None);
+	}
+	ResourceUsageScope::AddRowsExamined(100);
+
+	const auto stat = account.Get();
+	EXPECT_EQ(stat.rowsExamined, 15u);
+	EXPECT_EQ(stat.ops, 1u);
+	EXPECT_EQ(stat.canceledOps, 0u);
+	EXPECT_EQ(stat.rejectedOps, 0u);
+}
+
+TEST(ResourceUsageTest, CancelsByRowsQuota) {
+	ResourceQuotas quotas;
+	quotas.rowsPerOp = 50;
+	ResourceAccount account(quotas);
+	{
+		ResourceUsageScope scope(account);
+		EXPECT_TRUE(scope.IsCancelable());
+		ResourceUsageScope::AddRowsExamined(50);
+		EXPECT_EQ(scope.GetCancelType(), CancelType::None);
+		ResourceUsageScope::AddRowsExamined(1);
+		EXPECT_EQ(scope.GetCancelType(), CancelType::Explicit);
+
+		EXPECT_EQ(scope.Result(Error(errCanceled, "Canceled")).code(), errQuotaExceeded);
+		EXPECT_EQ(scope.Result(Error(errParams, "Params")).code(), errParams);
+		EXPECT_TRUE(scope.Result(Error()).ok());
+	}
+	{
+		ResourceUsageScope scope(account);
+		EXPECT_EQ(scope.Result(Error(errCanceled, "Canceled")).code(), errCanceled);
+	}
+	const auto stat = account.Get();
+	EXPECT_EQ(stat.ops, 2u);
+	EXPECT_EQ(stat.canceledOps, 1u);
+}
+
+TEST(ResourceUsageTest, RejectsByResultsQuota) {
+	ResourceQuotas quotas;
+	quotas.resultsBytes = 1000;
+	ResourceAccount account(quotas);
+	EXPECT_TRUE(account.Admit(true).ok());
+	account.AddResultsBytes(1000);
+	EXPECT_EQ(account.Admit(true).code(), errQuotaExceeded);
+	EXPECT_TRUE(account.Admit(false).ok());
+	account.AddResultsBytes(-1);
+	EXPECT_TRUE(account.Admit(true).ok());
+
+	const auto stat = account.Get();
+	EXPECT_EQ(stat.resultsBytes, 999);
+	EXPECT_EQ(stat.rejectedOps, 1u);
+}
+
+TEST(ResourceUsageTest, RejectsByCpuQuota) {
+	ResourceQuotas quotas;
+	quotas.cpuUsPerSec = 1000;
+	ResourceAccount account(quotas);
+	EXPECT_TRUE(account.Admit(false).ok());
+	account.AddOp(600, 0, false);
+	EXPECT_TRUE(account.Admit(false).ok());
+	account.AddOp(600, 0, false);
+	// Window is reset in the next second, so the check is retried, if the second is changed between the calls
+	Error err = account.Admit(false);
+	if (err.ok()) {
+		account.AddOp(1000, 0, false);
+		err = account.Admit(false);
+	}
+	EXPECT_EQ(err.code(), errQuotaExceeded);
+}
@@ -0,0 +1,85 @@
+#include <unistd.h>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "gtest/gtest.h"
+#include "net/listener.h"
+
+using namespace reindexer::net;
+
+namespace {
+
+class FakeConnection : public IServerConnection {
+public:
+	explicit FakeConnection(int fd) : fd_(fd) {}
+	~FakeConnection() override { ::close(fd_); }
+	bool IsFinished() override { return false; }
+	bool Restart(int fd) override {
+		::close(fd_);
+		fd_ = fd;
+		return true;
+	}
+	void Attach(ev::dynamic_loop &) override {}
+	void Detach() override {}
+
+private:
+	int fd_;
+};
+
+}  // namespace
+
+TEST(ReusePortListenerTest, AcceptsConnectionsInWorkerThreads) {
+	if (!ReusePortListener::IsSupported()) {
+		GTEST_SKIP() << "SO_REUSEPORT balancing is not supported";
+	}
+	constexpr int kWorkers = 4;
+	constexpr int kConnections = 200;
+	const std::string addr = "127.0.0.1:34567";
+	std::mutex mtx;
+	std::set<std::thread::id> threads;
+	std::atomic<int> accepted{0};
+	ReusePortListener listener(
+		[&](ev::dynamic_loop &, int fd) {
+			{
+				std::lock_guard<std::mutex> lck(mtx);
+				threads.emplace(std::this_thread::get_id());
+			}
+			++accepted;
+			return new FakeConnection(fd);
+		},
+		kWorkers);
+	ASSERT_TRUE(listener.Bind(addr));
+	// Repeated bind is not allowed
+	EXPECT_FALSE(listener.Bind(addr));
+
+	std::vector<reindexer::net::socket> clients;
+	for (int i = 0; i < kConnections; ++i) {
+		reindexer::net::socket client;
+		client.connect(addr);
+		ASSERT_TRUE(client.valid());
+		clients.emplace_back(client);
+	}
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	// Listening sockets use TCP_DEFER_ACCEPT, so connections are accepted after the first data
+	char data[] = "x";
+	for (auto &client : clients) {
+		while (client.send(reindexer::span<char>(data, 1)) != 1 && std::chrono::steady_clock::now() < deadline) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	while (accepted.load() < kConnections && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_EQ(accepted.load(), kConnections);
+	{
+		// Connections are balanced by the kernel, so they are accepted by the different workers
+		std::lock_guard<std::mutex> lck(mtx);
+		EXPECT_GT(threads.size(), 1u);
+		EXPECT_LE(threads.size(), size_t(kWorkers));
+		EXPECT_EQ(threads.count(std::this_thread::get_id()), 0u);
+	}
+
+	listener.Stop();
+	for (auto &client : clients) client.close();
+}
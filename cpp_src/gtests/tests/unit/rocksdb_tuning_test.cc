@@ -0,0 +1,57 @@
+#include "core/storage/rocksdbtuning.h"
+#include "gtest/gtest.h"
+#include "server/config.h"
+
+using reindexer::Error;
+using reindexer::datastorage::RocksDbTuning;
+using reindexer_server::ServerConfig;
+
+TEST(RocksDbTuningTest, ParseCompactionStyle) {
+	EXPECT_EQ(RocksDbTuning::CompactionFromString(""), RocksDbTuning::Compaction::Level);
+	EXPECT_EQ(RocksDbTuning::CompactionFromString("level"), RocksDbTuning::Compaction::Level);
+	EXPECT_EQ(RocksDbTuning::CompactionFromString("universal"), RocksDbTuning::Compaction::Universal);
+	// FIFO compaction deletes the oldest data, so it's not allowed for the primary storage
+	EXPECT_THROW(RocksDbTuning::CompactionFromString("fifo"), Error);
+	EXPECT_THROW(RocksDbTuning::CompactionFromString("Level"), Error);
+}
+
+TEST(RocksDbTuningTest, ParseCompression) {
+	EXPECT_EQ(RocksDbTuning::CompressionFromString(""), RocksDbTuning::Compression::Snappy);
+	EXPECT_EQ(RocksDbTuning::CompressionFromString("snappy"), RocksDbTuning::Compression::Snappy);
+	EXPECT_EQ(RocksDbTuning::CompressionFromString("none"), RocksDbTuning::Compression::None);
+	EXPECT_EQ(RocksDbTuning::CompressionFromString("lz4"), RocksDbTuning::Compression::LZ4);
+	EXPECT_EQ(RocksDbTuning::CompressionFromString("zstd"), RocksDbTuning::Compression::ZSTD);
+	EXPECT_THROW(RocksDbTuning::CompressionFromString("gzip"), Error);
+}
+
+TEST(RocksDbTuningTest, ServerConfig) {
+	ServerConfig cfg;
+	auto err = cfg.ParseYaml(R"yaml(
+storage:
+  engine: rocksdb
+  rocksdb:
+    compaction_style: universal
+    compression: zstd
+    bloom_filter_bits: 10
+    block_cache_size: 268435456
+    write_buffer_size: 8388608
+)yaml");
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(cfg.RocksDB.compaction, RocksDbTuning::Compaction::Universal);
+	EXPECT_EQ(cfg.RocksDB.compression, RocksDbTuning::Compression::ZSTD);
+	EXPECT_EQ(cfg.RocksDB.bloomFilterBits, 10);
+	EXPECT_EQ(cfg.RocksDB.sharedBlockCacheSize, 268435456u);
+	EXPECT_EQ(cfg.RocksDB.writeBufferSize, 8388608u);
+
+	// Section is optional
+	ServerConfig defaultCfg;
+	err = defaultCfg.ParseYaml("storage:\n  engine: rocksdb\n");
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(defaultCfg.RocksDB.compaction, RocksDbTuning::Compaction::Level);
+	EXPECT_EQ(defaultCfg.RocksDB.compression, RocksDbTuning::Compression::Snappy);
+	EXPECT_EQ(defaultCfg.RocksDB.bloomFilterBits, 0);
+	EXPECT_EQ(defaultCfg.RocksDB.sharedBlockCacheSize, 0u);
+
+	err = ServerConfig().ParseYaml("storage:\n  rocksdb:\n    compaction_style: fifo\n");
+	EXPECT_EQ(err.code(), errParams);
+}
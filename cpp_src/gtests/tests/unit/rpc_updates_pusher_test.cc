@@ -0,0 +1,80 @@
+#include <vector>
+#include "gtest/gtest.h"
+#include "server/rpcupdatespusher.h"
+
+using reindexer::LSNPair;
+using reindexer::SharedWALRecord;
+using reindexer::WALRecord;
+using reindexer::WalItemModify;
+using reindexer::WalInitTransaction;
+using namespace reindexer::net::cproto;
+
+namespace {
+
+class WriterMock : public Writer {
+public:
+	void WriteRPCReturn(Context &, const Args &, const reindexer::Error &) override {}
+	reindexer::chunk GetDataChunk() override { return reindexer::chunk(); }
+	void WriteRPCReturn(Context &, reindexer::chunk &&, const Args &, const reindexer::Error &) override {}
+	void CallRPC(const IRPCCall &call) override { calls.emplace_back(call.data_); }
+	void SetUpdatesBatching(bool) override {}
+	void SetClientData(std::unique_ptr<ClientData>) override {}
+	ClientData *GetClientData() override { return nullptr; }
+	std::shared_ptr<reindexer::net::connection_stat> GetConnectionStat() override { return nullptr; }
+
+	std::vector<SharedWALRecord> calls;
+};
+
+// Same filter as the one, which is used by RPCServer for the clients without transactions support
+bool legacyFilter(WALRecord &rec) {
+	if (rec.type == WalInitTransaction) return true;
+	rec.inTransaction = false;
+	return false;
+}
+
+}  // namespace
+
+TEST(RPCUpdatesPusherTest, SharesPackedRecordBetweenSubscribers) {
+	constexpr int kSubscribers = 5;
+	std::vector<WriterMock> writers(kSubscribers + 1);
+	std::vector<RPCUpdatesPusher> pushers(kSubscribers + 1);
+	for (size_t i = 0; i < pushers.size(); ++i) pushers[i].SetWriter(&writers[i]);
+	// The last subscriber does not support transactions
+	pushers.back().SetFilter(legacyFilter);
+
+	const LSNPair LSNs(reindexer::lsn_t(10, 1), reindexer::lsn_t(5, 0));
+	WALRecord txRec(WalItemModify, "cjson", 1, ModeUpsert, true);
+	for (auto &pusher : pushers) pusher.OnWALUpdate(LSNs, "ns", txRec);
+
+	// Record is packed once for all of the subscribers
+	for (int i = 0; i < kSubscribers; ++i) {
+		ASSERT_EQ(writers[i].calls.size(), 1u);
+		EXPECT_EQ(writers[i].calls[0].packed_.get(), writers[0].calls[0].packed_.get());
+	}
+	auto unpacked = writers[0].calls[0].Unpack();
+	EXPECT_EQ(unpacked.upstreamLSN, int64_t(LSNs.upstreamLSN_));
+	EXPECT_EQ(unpacked.originLSN, int64_t(LSNs.originLSN_));
+	EXPECT_EQ(std::string_view(unpacked.nsName), "ns");
+	EXPECT_TRUE(WALRecord(std::string_view(unpacked.pwalRec)).inTransaction);
+
+	// Filtered record does not reuse packed record of the original one
+	ASSERT_EQ(writers.back().calls.size(), 1u);
+	EXPECT_NE(writers.back().calls[0].packed_.get(), writers[0].calls[0].packed_.get());
+	WALRecord filtered(std::string_view(writers.back().calls[0].Unpack().pwalRec));
+	EXPECT_FALSE(filtered.inTransaction);
+	EXPECT_EQ(filtered.itemModify.itemCJson, "cjson");
+
+	// Records, which are not changed by filter, are shared with the legacy subscribers too
+	WALRecord rec(WalItemModify, "cjson", 1, ModeUpsert, false);
+	for (auto &pusher : pushers) pusher.OnWALUpdate(LSNs, "ns", rec);
+	for (auto &writer : writers) {
+		ASSERT_EQ(writer.calls.size(), 2u);
+		EXPECT_EQ(writer.calls[1].packed_.get(), writers[0].calls[1].packed_.get());
+	}
+
+	// Skipped records are not pushed
+	WALRecord initTxRec(WalInitTransaction, 0, true);
+	for (auto &pusher : pushers) pusher.OnWALUpdate(LSNs, "ns", initTxRec);
+	EXPECT_EQ(writers[0].calls.size(), 3u);
+	EXPECT_EQ(writers.back().calls.size(), 2u);
+}
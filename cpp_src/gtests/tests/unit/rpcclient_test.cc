@@ -1,5 +1,6 @@
 #include <chrono>
 #include <condition_variable>
+#include "client/replicarouter.h"
 #include "rpcclient_api.h"
 #include "rpcserver_fake.h"
 #include "tools/fsops.h"
@@ -281,6 +282,96 @@ TEST_F(RPCClientTestApi, RenameNamespace) {
 	StopServer();
 }
 
+TEST_F(RPCClientTestApi, ResultsCache) {
+	// Cached results should be invalidated by the own modifications and by the updates of the other clients
+	StartDefaultRealServer();
+	const string dsn = "cproto://" + kDefaultRPCServerAddr + "/db1";
+	const string kNsName = "cached_ns";
+	reindexer::client::ConnectOpts opts;
+	opts.CreateDBIfMissing();
+	reindexer::client::ReindexerConfig config;
+	config.ResultsCacheSize = 1024 * 1024;
+	config.ResultsCacheNamespaces = {kNsName};
+	reindexer::client::Reindexer rx(config);
+	auto err = rx.Connect(dsn, opts);
+	ASSERT_TRUE(err.ok()) << err.what();
+	reindexer::client::Reindexer writer;
+	err = writer.Connect(dsn, opts);
+	ASSERT_TRUE(err.ok()) << err.what();
+	CreateNamespace(rx, kNsName);
+	FillData(rx, kNsName, 0, 10);
+
+	auto selectCount = [&rx, &kNsName](int id) {
+		client::QueryResults qr;
+		auto err = rx.Select(Query(kNsName).Where("id", CondEq, id), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+	ASSERT_EQ(selectCount(5), 1);
+	ASSERT_EQ(selectCount(5), 1);
+	ASSERT_EQ(rx.GetResultsCacheStat().hitsCount, 1);
+
+	// Own modification is visible immediately
+	client::QueryResults delQr;
+	err = rx.Delete(Query(kNsName).Where("id", CondEq, 5), delQr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(selectCount(5), 0);
+
+	// Modification of the other client is visible after its update is delivered
+	FillData(writer, kNsName, 5, 1);
+	size_t count = 0;
+	for (int i = 0; i < 50 && !count; ++i) {
+		count = selectCount(5);
+		if (!count) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	ASSERT_EQ(count, 1);
+	StopServer();
+}
+
+TEST_F(RPCClientTestApi, ReplicaRouting) {
+	// Reads should go to the fastest replica, which has applied the own writes and is within the lag bound
+	using reindexer::client::ReplicaRouter;
+	ReplicaRouter router(2, 10);
+	const h_vector<std::string_view, 2> nsNames{"ns"};
+	ASSERT_EQ(router.Choose(nsNames), ReplicaRouter::kMaster);
+
+	auto seq = router.BeginPoll();
+	router.SetLSNs(ReplicaRouter::kMaster, seq, {{"ns", 100}});
+	router.SetLSNs(0, seq, {{"ns", 95}});
+	router.SetLSNs(1, seq, {{"ns", 80}});
+	ASSERT_EQ(router.Choose(nsNames), 0);
+	ASSERT_EQ(router.Choose({"ns", "other_ns"}), ReplicaRouter::kMaster);
+
+	// Own write with the known LSN
+	router.OnWrite("ns", 98);
+	ASSERT_EQ(router.Choose(nsNames), ReplicaRouter::kMaster);
+	router.SetLSNs(1, router.BeginPoll(), {{"ns", 99}});
+	ASSERT_EQ(router.Choose(nsNames), 1);
+
+	// Own write with the unknown LSN is resolved by the poll of the master, which was started after it
+	router.OnWrite("ns", -1);
+	ASSERT_EQ(router.Choose(nsNames), ReplicaRouter::kMaster);
+	seq = router.BeginPoll();
+	router.SetLSNs(ReplicaRouter::kMaster, seq, {{"ns", 105}});
+	router.SetLSNs(0, seq, {{"ns", 105}});
+	router.SetLSNs(1, seq, {{"ns", 104}});
+	ASSERT_EQ(router.Choose(nsNames), 0);
+
+	router.AddLatency(0, std::chrono::microseconds(1000));
+	router.AddLatency(1, std::chrono::microseconds(100));
+	router.SetLSNs(1, router.BeginPoll(), {{"ns", 105}});
+	ASSERT_EQ(router.Choose(nsNames), 1);
+	router.SetFailed(1);
+	ASSERT_EQ(router.Choose(nsNames), 0);
+
+	auto stat = router.GetStat();
+	ASSERT_EQ(stat.masterReadsCount, 4);
+	ASSERT_EQ(stat.replicas.size(), 2);
+	ASSERT_EQ(stat.replicas[0].readsCount, 3);
+	ASSERT_EQ(stat.replicas[1].readsCount, 2);
+	ASSERT_FALSE(stat.replicas[1].available);
+}
+
 TEST_F(RPCClientTestApi, CoroRequestTimeout) {
 	// Should return error on request timeout
 	RPCServerConfig conf;
@@ -774,3 +865,41 @@ TEST_F(RPCClientTestApi, CoroUpdatesFilteringByNs) {
 	loop.run();
 	ASSERT_TRUE(finished);
 }
+
+TEST_F(RPCClientTestApi, CoroUpdatesBatches) {
+	// Should receive all of the updates, when they are coalesced into several batches
+	StartDefaultRealServer();
+	ev::dynamic_loop loop;
+	bool finished = false;
+
+	auto mainRoutine = [this, &loop, &finished] {
+		using namespace std::string_view_literals;
+		reindexer::client::CoroReindexer rx;
+		const string dsn = "cproto://" + kDefaultRPCServerAddr + "/db1";
+		auto err = rx.Connect(dsn, loop, reindexer::client::ConnectOpts().CreateDBIfMissing());
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		constexpr auto kNsName = "ns_batches"sv;
+		CreateNamespace(rx, kNsName);
+
+		UpdatesReciever reciever(loop);
+		err = rx.SubscribeUpdates(&reciever, UpdatesFilters());
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		// Updates of this size don't fit into the single batch
+		constexpr size_t kCount = 5000;
+		FillData(rx, kNsName, 0, kCount);
+		ASSERT_TRUE(reciever.AwaitItems(kNsName, kCount));
+
+		err = rx.UnsubscribeUpdates(&reciever);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.Stop();
+		ASSERT_TRUE(err.ok()) << err.what();
+		finished = true;
+	};
+
+	loop.spawn(mainRoutine);
+
+	loop.run();
+	ASSERT_TRUE(finished);
+}
@@ -269,6 +269,93 @@ TEST(RTree, LinearMap) { TestMap<reindexer::LinearSplitter>(); }
 TEST(RTree, GreeneMap) { TestMap<reindexer::GreeneSplitter>(); }
 TEST(RTree, RStarMap) { TestMap<reindexer::RStarSplitter>(); }
 
+// Checks of Sort-Tile-Recursive packing of RectangleTree and of its modifications after the packing
+template <template <typename, typename, typename, typename, size_t, size_t> class Splitter>
+static void TestPack() {
+	using Map = reindexer::RTreeMap<size_t, Splitter, 16, 8>;
+	constexpr size_t kCount = 10000;
+
+	Map map;
+	map.Pack();
+	ASSERT_TRUE(map.Check());
+	ASSERT_TRUE(map.empty());
+
+	std::vector<typename Map::value_type> data;
+	for (size_t i = 0; data.size() < kCount; ++i) {
+		const auto res = map.insert({randPoint(kRange), i});
+		if (res.second) data.emplace_back(res.first->first, i);
+	}
+	map.Pack();
+	ASSERT_TRUE(map.Check());
+	ASSERT_EQ(map.size(), kCount);
+
+	for (size_t i = 0; i < 1000; ++i) {
+		SearchVisitor<Map> visitor;
+		const reindexer::Point point{randPoint(kRange)};
+		const double distance = randBinDouble(0, 100);
+		for (const auto& r : data) {
+			if (reindexer::DWithin(point, r.first, distance)) visitor.Add(r);
+		}
+		map.DWithin(point, distance, visitor);
+		ASSERT_EQ(visitor.Size(), 0);
+		ASSERT_EQ(visitor.Wrong(), 0);
+	}
+
+	size_t size = kCount;
+	for (size_t i = 0; i < 1000; ++i) {
+		size += map.insert({randPoint(kRange), kCount + i}).second;
+		DeleteVisitor<Map> visitor{{randPoint(kRange), randPoint(kRange)}};
+		size -= map.DeleteOneIf(visitor);
+		ASSERT_TRUE(map.Check());
+		ASSERT_EQ(map.size(), size);
+	}
+}
+
+TEST(RTree, QuadraticPack) { TestPack<reindexer::QuadraticSplitter>(); }
+TEST(RTree, LinearPack) { TestPack<reindexer::LinearSplitter>(); }
+TEST(RTree, GreenePack) { TestPack<reindexer::GreeneSplitter>(); }
+TEST(RTree, RStarPack) { TestPack<reindexer::RStarSplitter>(); }
+
+// Checks of the order of the values, visited by the nearest neighbors search
+template <template <typename, typename, typename, typename, size_t, size_t> class Splitter>
+static void TestNearest() {
+	reindexer::RectangleTree<reindexer::Point, Splitter, 16, 4> tree;
+	std::vector<reindexer::Point> points;
+	for (size_t i = 0; i < 5000; ++i) {
+		const auto p = randPoint(kRange);
+		if (tree.insert(reindexer::Point{p}).second) points.push_back(p);
+	}
+	for (size_t i = 0; i < 10; ++i) {
+		const auto center = randPoint(kRange);
+		const auto distanceLess = [center](reindexer::Point lhs, reindexer::Point rhs) {
+			return reindexer::squaredDistance(lhs, center) < reindexer::squaredDistance(rhs, center);
+		};
+		std::sort(points.begin(), points.end(), distanceLess);
+
+		std::vector<reindexer::Point> nearest;
+		tree.Nearest(center, [&nearest](reindexer::Point p) {
+			nearest.push_back(p);
+			return nearest.size() == 100;
+		});
+		ASSERT_EQ(nearest.size(), 100);
+		for (size_t j = 0; j < nearest.size(); ++j) {
+			ASSERT_EQ(reindexer::squaredDistance(nearest[j], center), reindexer::squaredDistance(points[j], center)) << j;
+		}
+
+		size_t visited = 0;
+		tree.Nearest(center, [&visited](reindexer::Point) {
+			++visited;
+			return false;
+		});
+		ASSERT_EQ(visited, points.size());
+	}
+}
+
+TEST(RTree, QuadraticNearest) { TestNearest<reindexer::QuadraticSplitter>(); }
+TEST(RTree, LinearNearest) { TestNearest<reindexer::LinearSplitter>(); }
+TEST(RTree, GreeneNearest) { TestNearest<reindexer::GreeneSplitter>(); }
+TEST(RTree, RStarNearest) { TestNearest<reindexer::RStarSplitter>(); }
+
 // Make sure RTree indexes work with null values correctly
 TEST_F(ReindexerApi, EmptyRTreeSparseValues) {
 	// Create namespace and add 2 RTree indexes (of type Sparse)
@@ -327,3 +414,57 @@ TEST_F(ReindexerApi, EmptyRTreeSparseValues) {
 		ASSERT_TRUE(qr.Count() == 1);
 	}
 }
+
+// Query sorted by the distance from the point with limit selects the nearest rows of the RTree index
+TEST_F(ReindexerApi, NearestRTreeRows) {
+	Error err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, {"point", "rtree", "point", IndexOpts().RTreeType(IndexOpts::RStar)});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->AddIndex(default_namespace, {"value", "tree", "int", IndexOpts()});
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	constexpr int kItemsCount = 5000;
+	std::vector<reindexer::Point> points;
+	for (int i = 0; i < kItemsCount; ++i) {
+		Item item = rt.reindexer->NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		// Some rows share the same point
+		points.push_back(i % 10 ? randPoint(kRange) : points.back());
+		item["id"] = i;
+		item["point"] = points.back();
+		item["value"] = i % 100;
+		err = rt.reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	for (size_t i = 0; i < 20; ++i) {
+		const auto center = randPoint(kRange);
+		std::ostringstream sort;
+		sort.precision(std::numeric_limits<double>::digits10 + 1);
+		sort << "ST_Distance(point, ST_GeomFromText('point(" << center.x << ' ' << center.y << ")'))";
+		// Rows with the small values are rare, so the nearest rows are selected several times
+		const int maxValue = (i % 2) ? 100 : 3;
+		std::vector<double> expected;
+		for (int id = 0; id < kItemsCount; ++id) {
+			if (id % 100 < maxValue) expected.push_back(reindexer::squaredDistance(points[id], center));
+		}
+		std::sort(expected.begin(), expected.end());
+
+		const unsigned offset = i % 3, limit = 10;
+		QueryResults qr;
+		err = rt.reindexer->Select(
+			Query(default_namespace).Where("value", CondLt, maxValue).Sort(sort.str(), false).Offset(offset).Limit(limit).Explain(), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), limit);
+		EXPECT_NE(qr.GetExplainResults().find("-nearest"), std::string::npos);
+		for (size_t j = 0; j < qr.Count(); ++j) {
+			Item item = qr[j].GetItem(false);
+			const int id = item["id"].As<int>();
+			EXPECT_LT(id % 100, maxValue);
+			ASSERT_EQ(reindexer::squaredDistance(points[id], center), expected[offset + j]) << j;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#include <thread>
+#include "debug/sampler.h"
+#include "gtest/gtest.h"
+
+using reindexer::debug::CPUSampler;
+using reindexer::debug::ThreadRole;
+
+static void burnCPU(std::chrono::milliseconds time) {
+	volatile uint64_t v = 0;
+	const auto end = std::chrono::steady_clock::now() + time;
+	while (std::chrono::steady_clock::now() < end) {
+		for (int i = 0; i < 10000; ++i) v = v + i;
+	}
+}
+
+TEST(CPUSamplerTest, SamplesRegisteredThreadsByRole) {
+	if (!CPUSampler::IsSupported()) GTEST_SKIP();
+	auto &sampler = CPUSampler::Instance();
+	EXPECT_FALSE(sampler.Start(0).ok());
+	const auto err = sampler.Start(100);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	std::thread background([] {
+		CPUSampler::RegisterThread(ThreadRole::Background);
+		burnCPU(std::chrono::milliseconds(300));
+	});
+	// Not registered thread is not sampled
+	std::thread other([] { burnCPU(std::chrono::milliseconds(300)); });
+	background.join();
+	other.join();
+	sampler.Stop();
+
+	const std::string collapsed = sampler.Collapsed(std::chrono::seconds(60));
+	ASSERT_FALSE(collapsed.empty());
+	size_t samples = 0;
+	for (size_t pos = 0, end; pos < collapsed.size(); pos = end + 1) {
+		end = collapsed.find('\n', pos);
+		ASSERT_NE(end, std::string::npos);
+		const std::string_view line(collapsed.data() + pos, end - pos);
+		EXPECT_EQ(line.substr(0, 11), "background;") << line;
+		const auto countPos = line.rfind(' ');
+		ASSERT_NE(countPos, std::string_view::npos) << line;
+		samples += std::stoul(std::string(line.substr(countPos + 1)));
+	}
+	// 300ms of the CPU time give up to 30 samples. Precision of the CPU timers depends on the kernel ticks
+	EXPECT_GE(samples, 5u);
+	EXPECT_LE(samples, 40u);
+	EXPECT_TRUE(sampler.Collapsed(std::chrono::seconds(60), ThreadRole::RPC).empty());
+
+	const std::string profile = sampler.Profile(std::chrono::seconds(60), ThreadRole::Background);
+	ASSERT_GE(profile.size(), 8 * sizeof(uintptr_t));
+	const uintptr_t *words = reinterpret_cast<const uintptr_t *>(profile.data());
+	EXPECT_EQ(words[0], 0u);
+	EXPECT_EQ(words[1], 3u);
+	EXPECT_EQ(words[3], 10000u);
+	EXPECT_NE(profile.find("r-xp"), std::string::npos);
+}
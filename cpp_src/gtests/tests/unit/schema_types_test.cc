@@ -0,0 +1,32 @@
+#include "core/schema.h"
+#include "gtest/gtest.h"
+
+using reindexer::SchemaFieldTypesNode;
+using reindexer::TagsPath;
+
+TEST(SchemaTypesTest, ResolvesTypesByTagsOfNestedObjects) {
+	SchemaFieldTypesNode root;
+	root.AddPath(TagsPath{5}).type = {KeyValueInt, false};
+	root.AddPath(TagsPath{2}).type = {KeyValueComposite, false};
+	root.AddPath(TagsPath{2, 7}).type = {KeyValueString, true};
+	root.AddPath(TagsPath{2, 1}).type = {KeyValueDouble, false};
+	// Path is added before the type of its parent object
+	root.AddPath(TagsPath{9, 3}).type = {KeyValueBool, false};
+
+	ASSERT_NE(root.Child(5), nullptr);
+	EXPECT_EQ(root.Child(5)->type.type_, KeyValueInt);
+	const SchemaFieldTypesNode *obj = root.Child(2);
+	ASSERT_NE(obj, nullptr);
+	EXPECT_EQ(obj->type.type_, KeyValueComposite);
+	ASSERT_NE(obj->Child(7), nullptr);
+	EXPECT_EQ(obj->Child(7)->type.type_, KeyValueString);
+	EXPECT_TRUE(obj->Child(7)->type.isArray_);
+	ASSERT_NE(obj->Child(1), nullptr);
+	EXPECT_EQ(obj->Child(1)->type.type_, KeyValueDouble);
+	EXPECT_EQ(obj->Child(5), nullptr);
+	ASSERT_NE(root.Child(9), nullptr);
+	EXPECT_EQ(root.Child(9)->type.type_, KeyValueUndefined);
+	ASSERT_NE(root.Child(9)->Child(3), nullptr);
+	EXPECT_EQ(root.Child(9)->Child(3)->type.type_, KeyValueBool);
+	EXPECT_EQ(root.Child(4), nullptr);
+}
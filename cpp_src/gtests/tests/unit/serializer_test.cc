@@ -0,0 +1,50 @@
+#include <limits>
+#include "gtest/gtest.h"
+#include "tools/serializer.h"
+
+using reindexer::Error;
+using reindexer::Serializer;
+using reindexer::WrSerializer;
+
+TEST(SerializerTest, BatchedVarintsAreSameAsSingleOnes) {
+	std::vector<int64_t> values;
+	// Runs of the single byte values are mixed with the long ones
+	for (int64_t i = 0; i < 100; ++i) values.push_back(i % 30);
+	for (int64_t v : {int64_t(-1), int64_t(64), int64_t(-65), int64_t(1) << 40, std::numeric_limits<int64_t>::min(),
+					  std::numeric_limits<int64_t>::max()}) {
+		values.push_back(v);
+		for (int64_t i = 0; i < 9; ++i) values.push_back(-i);
+	}
+
+	WrSerializer wrser;
+	for (int64_t v : values) wrser.PutVarint(v);
+	wrser.PutVarUint(777);
+
+	Serializer single(wrser.Slice());
+	for (int64_t v : values) ASSERT_EQ(single.GetVarint(), v);
+
+	std::vector<int64_t> batch(values.size());
+	Serializer rdser(wrser.Slice());
+	rdser.GetVarints(reindexer::span<int64_t>(batch.data(), 7));
+	rdser.GetVarints(reindexer::span<int64_t>(batch.data() + 7, batch.size() - 7));
+	EXPECT_EQ(batch, values);
+	EXPECT_EQ(rdser.Pos(), single.Pos());
+	EXPECT_EQ(rdser.GetVarUint(), 777u);
+	EXPECT_TRUE(rdser.Eof());
+}
+
+TEST(SerializerTest, BatchedVarintsCheckBufferBounds) {
+	WrSerializer wrser;
+	for (int i = 0; i < 10; ++i) wrser.PutVarUint(i);
+	wrser.PutVarUint(uint64_t(1) << 50);
+
+	// Last value is truncated
+	Serializer rdser(wrser.Slice().substr(0, wrser.Len() - 1));
+	std::vector<uint64_t> values(11);
+	try {
+		rdser.GetVarUints(reindexer::span<uint64_t>(values.data(), values.size()));
+		FAIL() << "Broken buffer is expected";
+	} catch (const Error &err) {
+		EXPECT_EQ(err.code(), errParseBin);
+	}
+}
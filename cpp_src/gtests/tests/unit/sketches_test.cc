@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <random>
+#include "core/nsselecter/sketches.h"
+#include "gtest/gtest.h"
+
+using reindexer::HyperLogLog;
+using reindexer::TDigest;
+
+TEST(SketchesTest, HyperLogLogEstimatesDistinctCount) {
+	for (uint64_t distinct : {0, 10, 1000, 100000, 1000000}) {
+		HyperLogLog hll;
+		// Each value is added several times, duplicates should not affect the estimate
+		for (int repeat = 0; repeat < 3; ++repeat) {
+			for (uint64_t v = 0; v < distinct; ++v) hll.Add(v);
+		}
+		EXPECT_NEAR(hll.Estimate(), double(distinct), std::max(1.0, double(distinct) * 0.03)) << distinct;
+	}
+}
+
+TEST(SketchesTest, HyperLogLogMergesParts) {
+	HyperLogLog whole, first, second;
+	for (uint64_t v = 0; v < 200000; ++v) {
+		whole.Add(v);
+		// Parts overlap by a half
+		if (v < 150000) first.Add(v);
+		if (v >= 50000) second.Add(v);
+	}
+	first.Merge(second);
+	EXPECT_DOUBLE_EQ(first.Estimate(), whole.Estimate());
+}
+
+TEST(SketchesTest, TDigestEstimatesQuantiles) {
+	constexpr int kCount = 100000;
+	std::vector<double> values(kCount);
+	for (int i = 0; i < kCount; ++i) values[i] = i;
+	std::shuffle(values.begin(), values.end(), std::mt19937(42));
+
+	TDigest whole, first, second;
+	EXPECT_TRUE(whole.Empty());
+	EXPECT_DOUBLE_EQ(whole.Quantile(0.5), 0.0);
+	for (int i = 0; i < kCount; ++i) {
+		whole.Add(values[i]);
+		(i % 3 ? first : second).Add(values[i]);
+	}
+	first.Merge(second);
+
+	for (const TDigest *digest : {&whole, &first}) {
+		EXPECT_DOUBLE_EQ(digest->Quantile(0.0), 0.0);
+		EXPECT_DOUBLE_EQ(digest->Quantile(1.0), kCount - 1);
+		EXPECT_NEAR(digest->Quantile(0.5), kCount * 0.5, kCount * 0.01);
+		// Tails are more precise than the median
+		EXPECT_NEAR(digest->Quantile(0.95), kCount * 0.95, kCount * 0.005);
+		EXPECT_NEAR(digest->Quantile(0.99), kCount * 0.99, kCount * 0.002);
+	}
+}
+
+TEST(SketchesTest, TDigestSingleValue) {
+	TDigest digest;
+	digest.Add(42.0);
+	EXPECT_FALSE(digest.Empty());
+	EXPECT_DOUBLE_EQ(digest.Quantile(0.1), 42.0);
+	EXPECT_DOUBLE_EQ(digest.Quantile(0.99), 42.0);
+}
@@ -176,3 +176,74 @@ TEST_F(DISABLED_StorageLazyLoadApi, TestForTSAN) {
 		insertThreads[i].join();
 	}
 }
+
+TEST_F(ReindexerApi, LazyLoadOnFirstAccess) {
+	const std::string kStoragePath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "LazyLoadOnFirstAccess");
+	constexpr int kItemsCount = 100;
+	reindexer::fs::RmDirAll(kStoragePath);
+	rt.reindexer.reset(new Reindexer);
+	Error err = rt.reindexer->Connect("builtin://" + kStoragePath);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	Item config = NewItem("#config");
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	err = config.FromJSON(R"json({"type":"namespaces","namespaces":[{"namespace":"*","lazyload":true}]})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert("#config", config);
+
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{"id", "hash", "int", IndexOpts().PK(), 0}});
+	for (int i = 0; i < kItemsCount; ++i) {
+		Item item = NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON(R"json({"id":)json" + std::to_string(i) + R"json(,"name":"item_)json" + std::to_string(i) + R"json("})json");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+	err = rt.reindexer->CloseNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto getStat = [this](bool& storageLoaded) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1);
+		Item item = qr[0].GetItem(false);
+		storageLoaded = item["storage_loaded"].As<bool>();
+		return item["items_count"].As<int64_t>();
+	};
+
+	// Items are not loaded until the first access to namespace
+	bool storageLoaded = true;
+	EXPECT_EQ(getStat(storageLoaded), 0);
+	EXPECT_FALSE(storageLoaded);
+
+	// Primary key lookups are served from the storage, while the items are loaded in the background
+	{
+		QueryResults qr;
+		err = rt.reindexer->GetByPK(default_namespace, {Variant(3), Variant(kItemsCount), Variant(7)}, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 2);
+		reindexer::WrSerializer wrser;
+		err = qr[0].GetJSON(wrser, false);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(wrser.Slice(), R"json({"id":3,"name":"item_3"})json");
+		wrser.Reset();
+		err = qr[1].GetJSON(wrser, false);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(wrser.Slice(), R"json({"id":7,"name":"item_7"})json");
+	}
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_EQ(qr.Count(), kItemsCount);
+	EXPECT_EQ(getStat(storageLoaded), kItemsCount);
+	EXPECT_TRUE(storageLoaded);
+
+	rt.reindexer.reset();
+	reindexer::fs::RmDirAll(kStoragePath);
+}
@@ -106,6 +106,31 @@ TEST(StringFunctions, IsLikeSqlPattern) {
 }
 
 // Make sure 'Like' operator does not work with FT indexes
+TEST(StringFunctions, CollateSortKeys) {
+	// Sort keys are compared the same way, as the strings themselves. Strings of the few characters have the common prefixes
+	static const std::vector<std::string> chars = {"a", "A", "b", "\xD0\xB1", "\xD0\x91", "\xD1\x91", " ", "-", "\xE2\x84\xAA"};
+	auto shortString = []() {
+		std::string result;
+		for (int len = rand() % 6; len > 0; --len) result += chars[rand() % chars.size()];
+		return result;
+	};
+	auto sign = [](int v) { return (v > 0) - (v < 0); };
+	const CollateOpts modes[] = {CollateOpts(CollateASCII), CollateOpts(CollateUTF8),
+											CollateOpts("a-b\xD0\xB1")};
+	std::string lhsKey, rhsKey;
+	for (const auto& opts : modes) {
+		for (int i = 0; i < 20000; ++i) {
+			const std::string lhs = shortString(), rhs = shortString();
+			ASSERT_TRUE(reindexer::collateSortKey(lhs, opts, lhsKey));
+			ASSERT_TRUE(reindexer::collateSortKey(rhs, opts, rhsKey));
+			ASSERT_EQ(sign(lhsKey.compare(rhsKey)), sign(reindexer::collateCompare(lhs, rhs, opts)))
+				<< "mode " << opts.mode << ": '" << lhs << "' vs '" << rhs << "'";
+		}
+	}
+	EXPECT_FALSE(reindexer::collateSortKey("abc", CollateOpts(CollateNone), lhsKey));
+	EXPECT_FALSE(reindexer::collateSortKey("abc", CollateOpts(CollateNumeric), lhsKey));
+}
+
 TEST_F(ReindexerApi, LikeWithFullTextIndex) {
 	// Define structure of the Namespace, where one of
 	// the indexes is of type 'text' (Full text)
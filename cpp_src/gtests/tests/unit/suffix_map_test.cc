@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "estl/suffix_map.h"
+
+TEST(SuffixMap, PrefixRange) {
+	const std::vector<std::string> words{"bar", "abc", "ab", "barbell", "cab", "a", "abcd", "ba"};
+	reindexer::suffix_map<char, int> map;
+	for (size_t i = 0; i < words.size(); ++i) map.insert(words[i], int(i));
+	map.build();
+
+	for (const std::string prefix : {"", "a", "ab", "abc", "b", "bar", "c", "ca", "cab", "d", "abcde"}) {
+		std::vector<std::string> expected;
+		for (const auto& w : words) {
+			if (w.compare(0, prefix.size(), prefix) == 0) expected.push_back(w);
+		}
+		std::sort(expected.begin(), expected.end());
+
+		std::vector<std::string> found;
+		const auto range = map.prefix_range(prefix);
+		for (auto it = range.first; it != range.second; ++it) {
+			found.emplace_back(map.text_at(*it));
+			EXPECT_EQ(words[map.mapped_at(*it)], found.back());
+		}
+		// Suffixes inside the words ("ab" in "cab", "bar" in "barbell") are not found
+		EXPECT_EQ(found, expected) << "prefix: '" << prefix << "'";
+	}
+}
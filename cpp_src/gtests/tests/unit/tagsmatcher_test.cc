@@ -0,0 +1,52 @@
+#include "core/cjson/tagsmatcher.h"
+#include "gtest/gtest.h"
+
+using reindexer::Serializer;
+using reindexer::TagsMatcher;
+using reindexer::TagsMatcherImpl;
+using reindexer::WrSerializer;
+
+TEST(TagsMatcherTest, KeepsTagsNumberingAfterCompaction) {
+	constexpr int kTags = 3 * TagsMatcherImpl::kMaxOwnTags + 10;
+	TagsMatcher tm;
+	for (int i = 0; i < kTags; ++i) {
+		EXPECT_EQ(tm.name2tag("field" + std::to_string(i), true), i + 1);
+	}
+	EXPECT_EQ(tm.size(), size_t(kTags));
+	for (int i = 0; i < kTags; ++i) {
+		const std::string name = "field" + std::to_string(i);
+		EXPECT_EQ(tm.name2tag(name), i + 1);
+		EXPECT_EQ(tm.tag2name(i + 1), name);
+	}
+	EXPECT_EQ(tm.name2tag("unknown"), 0);
+	EXPECT_THROW(tm.tag2name(kTags + 1), reindexer::Error);
+
+	WrSerializer wrser;
+	tm.serialize(wrser);
+	TagsMatcher restored;
+	Serializer ser(wrser.Slice());
+	restored.deserialize(ser);
+	ASSERT_EQ(restored.size(), tm.size());
+	for (int i = 1; i <= kTags; ++i) EXPECT_EQ(restored.tag2name(i), tm.tag2name(i));
+}
+
+TEST(TagsMatcherTest, MergesCopiesWithSharedTags) {
+	TagsMatcher tm;
+	for (size_t i = 0; i < TagsMatcherImpl::kMaxOwnTags + 5; ++i) tm.name2tag("field" + std::to_string(i), true);
+
+	// Copy adds new tags to its own part and does not change the original matcher
+	TagsMatcher copy = tm;
+	const int newTag = copy.name2tag("new_field", true);
+	EXPECT_EQ(newTag, int(tm.size()) + 1);
+	EXPECT_EQ(tm.name2tag("new_field"), 0);
+
+	ASSERT_TRUE(tm.try_merge(copy));
+	EXPECT_EQ(tm.name2tag("new_field"), newTag);
+	EXPECT_EQ(tm.size(), copy.size());
+
+	// Same name with the other tag is conflict
+	TagsMatcher conflicting;
+	conflicting.name2tag("new_field", true);
+	EXPECT_FALSE(tm.try_merge(conflicting));
+	EXPECT_EQ(tm.name2tag("new_field"), newTag);
+}
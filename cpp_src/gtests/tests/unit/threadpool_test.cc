@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include "tools/errors.h"
+#include "tools/threadpool.h"
+
+using reindexer::TaskGroup;
+using reindexer::ThreadPool;
+
+TEST(ThreadPool, ConcurrencyLimit) {
+	std::atomic<int> running{0}, maxRunning{0}, executed{0};
+	TaskGroup group(2);
+	for (int i = 0; i < 50; ++i) {
+		group.Add([&] {
+			const int cur = ++running;
+			int prev = maxRunning.load();
+			while (prev < cur && !maxRunning.compare_exchange_weak(prev, cur)) {
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			--running;
+			++executed;
+		});
+	}
+	group.Wait();
+	EXPECT_EQ(executed.load(), 50);
+	EXPECT_LE(maxRunning.load(), 2);
+
+	// Group may be reused
+	group.Add([&executed] { ++executed; });
+	group.Wait();
+	EXPECT_EQ(executed.load(), 51);
+}
+
+TEST(ThreadPool, NestedGroups) {
+	// Waiting thread executes tasks of its own group, so the nested groups can not deadlock even if all the pool's threads are busy
+	const size_t outerTasks = ThreadPool::Instance().Threads() * 2;
+	std::atomic<size_t> executed{0};
+	TaskGroup outer;
+	for (size_t i = 0; i < outerTasks; ++i) {
+		outer.Add([&executed] {
+			TaskGroup inner;
+			for (int j = 0; j < 10; ++j) inner.Add([&executed] { ++executed; });
+			inner.Wait();
+		});
+	}
+	outer.Wait();
+	EXPECT_EQ(executed.load(), outerTasks * 10);
+}
+
+TEST(ThreadPool, CancelAndErrors) {
+	std::atomic<int> executed{0};
+	TaskGroup canceled(2, ThreadPool::Priority::Normal, [&executed] { return executed.load() >= 10; });
+	for (int i = 0; i < 1000; ++i) canceled.Add([&executed] { ++executed; });
+	canceled.Wait();
+	EXPECT_GE(executed.load(), 10);
+	EXPECT_LT(executed.load(), 1000);
+
+	TaskGroup failed(3, ThreadPool::Priority::High);
+	for (int i = 0; i < 10; ++i) {
+		failed.Add([i] {
+			if (i == 5) throw reindexer::Error(errLogic, "Task error");
+		});
+	}
+	try {
+		failed.Wait();
+		FAIL() << "Exception was expected";
+	} catch (const reindexer::Error &err) {
+		EXPECT_EQ(err.code(), errLogic);
+	}
+	// Error is not rethrown twice
+	failed.Add([] {});
+	EXPECT_NO_THROW(failed.Wait());
+}
+
+TEST(ThreadPool, DestructorSkipsPendingTasks) {
+	std::atomic<int> executed{0};
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	std::thread releaser([&release] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		release.set_value();
+	});
+	{
+		TaskGroup group(2);
+		group.Add([released] { released.wait(); });
+		for (int i = 0; i < 100; ++i) group.Add([&executed] { ++executed; });
+	}
+	releaser.join();
+	EXPECT_LT(executed.load(), 100);
+}
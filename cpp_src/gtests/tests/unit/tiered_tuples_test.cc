@@ -0,0 +1,86 @@
+#include <chrono>
+#include <thread>
+#include "reindexer_api.h"
+#include "tools/fsops.h"
+
+TEST_F(ReindexerApi, TieredTuplesEviction) {
+	using reindexer::fs::JoinPath;
+	const std::string kDir = JoinPath(reindexer::fs::GetTempDir(), "TieredTuplesTest");
+	const char* const kConfigNs = "#config";
+	constexpr int kItemsCount = 500;
+	reindexer::fs::RmDirAll(kDir);
+
+	rt.reindexer.reset(new Reindexer);
+	Error err = rt.reindexer->Connect("builtin://" + kDir);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled());
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{"id", "hash", "int", IndexOpts().PK(), 0}});
+
+	auto valueOf = [](int id) { return "value_" + std::to_string(id) + std::string(1000, 'x'); };
+	auto upsertItem = [&](int id, const std::string& value) {
+		Item item = NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON("{\"id\":" + std::to_string(id) + ",\"value\":\"" + value + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	};
+	auto setBudget = [&](int64_t budget) {
+		Item config = NewItem(kConfigNs);
+		ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+		err = config.FromJSON(R"json({"type":"namespaces","namespaces":[{"namespace":"*","tiered_tuples_memory_budget":)json" +
+							  std::to_string(budget) + "}]}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(kConfigNs, config);
+	};
+	auto dataSize = [&] {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1);
+		return qr[0].GetItem(false)["total.data_size"].As<int64_t>();
+	};
+	auto checkItems = [&](int modifiedId) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(default_namespace).Sort("id", false), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), size_t(kItemsCount));
+		for (auto it : qr) {
+			Item item = it.GetItem(false);
+			const int id = item["id"].As<int>();
+			ASSERT_EQ(item["value"].As<std::string>(), id == modifiedId ? "modified" : valueOf(id));
+		}
+	};
+
+	for (int i = 0; i < kItemsCount; ++i) {
+		upsertItem(i, valueOf(i));
+	}
+	const int64_t initialSize = dataSize();
+
+	// Tuples, which were not read since the previous eviction pass, are evicted from memory
+	setBudget(1);
+	for (int i = 0; dataSize() > initialSize - kItemsCount * 500; ++i) {
+		ASSERT_LT(i, 100) << "Tuples were not evicted";
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	checkItems(-1);
+
+	// Evicted tuples are loaded on demand for the filtering and modification by non-indexed fields
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Where("value", CondEq, valueOf(10)), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1);
+	upsertItem(20, "modified");
+	checkItems(20);
+
+	// Disabled tiered mode restores all the tuples
+	setBudget(0);
+	for (int i = 0; dataSize() < initialSize - kItemsCount * 100; ++i) {
+		ASSERT_LT(i, 100) << "Tuples were not restored";
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	checkItems(20);
+
+	rt.reindexer.reset();
+	reindexer::fs::RmDirAll(kDir);
+}
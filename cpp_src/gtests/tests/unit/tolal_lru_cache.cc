@@ -109,3 +109,125 @@ TEST(LruCache, StressTest) {
 		EXPECT_TRUE(memoryConsumed <= cacheSize);
 	}
 }
+
+TEST(LruCache, ShardedStatsTest) {
+	const size_t cacheSize = 1024 * 1024 * 16;
+	const size_t shardsCount = 8;
+	const int queriesCount = 1000;
+
+	for (auto mode : {reindexer::LRUCacheEvictionMode::LRU, reindexer::LRUCacheEvictionMode::Clock}) {
+		QueryCache cache(cacheSize, 1, shardsCount, mode);
+		ASSERT_EQ(cache.ShardsCount(), shardsCount);
+
+		for (int i = 0; i < queriesCount; ++i) {
+			QueryCacheKey ckey{Query("namespace" + std::to_string(i))};
+			auto cached = cache.Get(ckey);
+			ASSERT_TRUE(cached.valid);
+			cache.Put(ckey, QueryCacheVal{size_t(i)});
+		}
+		for (int i = 0; i < queriesCount; ++i) {
+			QueryCacheKey ckey{Query("namespace" + std::to_string(i))};
+			auto cached = cache.Get(ckey);
+			ASSERT_TRUE(cached.valid);
+			ASSERT_EQ(cached.val.total_count, i);
+		}
+
+		auto stat = cache.GetMemStat();
+		ASSERT_EQ(stat.itemsCount, size_t(queriesCount));
+		ASSERT_EQ(stat.shards.size(), shardsCount);
+		size_t itemsInShards = 0, sizeInShards = 0;
+		for (auto& shard : stat.shards) {
+			itemsInShards += shard.itemsCount;
+			sizeInShards += shard.totalSize;
+			EXPECT_EQ(shard.evictionsCount, 0u);
+		}
+		EXPECT_EQ(itemsInShards, stat.itemsCount);
+		EXPECT_EQ(sizeInShards, stat.totalSize);
+
+		cache.Clear();
+		stat = cache.GetMemStat();
+		EXPECT_EQ(stat.itemsCount, 0u);
+		EXPECT_EQ(stat.totalSize, 0u);
+	}
+}
+
+TEST(LruCache, ClockEvictionTest) {
+	// Single shard to make eviction order predictable
+	const size_t cacheSize = 1024 * 64;
+	QueryCache cache(cacheSize, 1, 1, reindexer::LRUCacheEvictionMode::Clock);
+	ASSERT_EQ(cache.ShardsCount(), 1u);
+
+	QueryCacheKey hotKey{Query("hot_namespace")};
+	cache.Get(hotKey);
+	cache.Put(hotKey, QueryCacheVal{size_t(42)});
+	for (int i = 0; i < 10000; ++i) {
+		QueryCacheKey ckey{Query("namespace" + std::to_string(i))};
+		cache.Get(ckey);
+		cache.Put(ckey, QueryCacheVal{size_t(i)});
+		// Frequently touched key must survive eviction due to the second-chance bit
+		auto hot = cache.Get(hotKey);
+		ASSERT_TRUE(hot.valid) << i;
+		ASSERT_EQ(hot.val.total_count, 42);
+	}
+	auto stat = cache.GetMemStat();
+	EXPECT_LE(stat.totalSize, cacheSize);
+}
+
+TEST(LruCache, ShardedCacheHoldsEntriesLargerThanShard) {
+	const size_t cacheSize = 1024 * 1024 * 16;
+	const size_t shardsCount = 8;
+	QueryCache cache(cacheSize, 1, shardsCount);
+	ASSERT_EQ(cache.ShardsCount(), shardsCount);
+
+	for (int i = 0; i < 1000; ++i) {
+		QueryCacheKey ckey{Query("namespace" + std::to_string(i))};
+		cache.Get(ckey);
+		cache.Put(ckey, QueryCacheVal{size_t(i)});
+	}
+	// Key is 3 times larger than the share of the single shard
+	const Query bigQuery(std::string(3 * cacheSize / shardsCount, 'n'));
+	QueryCacheKey bigKey{bigQuery};
+	ASSERT_TRUE(cache.Get(bigKey).valid);
+	cache.Put(bigKey, QueryCacheVal{size_t(42)});
+	auto cached = cache.Get(bigKey);
+	ASSERT_TRUE(cached.valid);
+	EXPECT_EQ(cached.val.total_count, 42);
+	EXPECT_LE(cache.GetMemStat().totalSize, cacheSize);
+
+	// Entries larger than the whole cache are not cached
+	const Query hugeQuery(std::string(cacheSize + 1, 'h'));
+	QueryCacheKey hugeKey{hugeQuery};
+	EXPECT_FALSE(cache.Get(hugeKey).valid);
+	EXPECT_LE(cache.GetMemStat().totalSize, cacheSize);
+}
+
+TEST(LruCache, QueryCacheKeyComparesQueriesStructure) {
+	QueryCacheKey heldKey;
+	{
+		const Query q = Query("namespace").Where("id", CondEq, 5).Where("name", CondSet, {"a", "b"}).Sort("id", true).Limit(10);
+		const QueryCacheKey key{q};
+		// Stored copy of the key doesn't depend on the lifetime of the query
+		heldKey = key;
+		ASSERT_TRUE(EqQueryCacheKey()(heldKey, key));
+
+		// Limit and offset are not the part of the default key
+		const Query otherLimit = Query(q).Limit(20).Offset(5);
+		EXPECT_TRUE(EqQueryCacheKey()(QueryCacheKey{otherLimit}, key));
+		EXPECT_FALSE(EqQueryCacheKey()(QueryCacheKey(otherLimit, Normal), QueryCacheKey(q, Normal)));
+	}
+	EXPECT_TRUE(EqQueryCacheKey()(
+		heldKey, QueryCacheKey{Query("namespace").Where("id", CondEq, 5).Where("name", CondSet, {"a", "b"}).Sort("id", true)}));
+	EXPECT_EQ(reindexer::HashQueryCacheKey()(heldKey),
+			  reindexer::HashQueryCacheKey()(
+				  QueryCacheKey{Query("namespace").Where("id", CondEq, 5).Where("name", CondSet, {"a", "b"}).Sort("id", true)}));
+
+	// Values are compared with their types
+	EXPECT_FALSE(EqQueryCacheKey()(
+		heldKey, QueryCacheKey{Query("namespace").Where("id", CondEq, "5").Where("name", CondSet, {"a", "b"}).Sort("id", true)}));
+	EXPECT_FALSE(EqQueryCacheKey()(
+		heldKey, QueryCacheKey{Query("namespace").Where("id", CondEq, 5).Where("name", CondSet, {"a", "c"}).Sort("id", true)}));
+	EXPECT_FALSE(EqQueryCacheKey()(
+		heldKey, QueryCacheKey{Query("namespace").Where("id", CondEq, 5).Where("name", CondSet, {"a", "b"}).Sort("id", false)}));
+	EXPECT_FALSE(
+		EqQueryCacheKey()(heldKey, QueryCacheKey{Query("namespace").Where("id", CondEq, 5).Where("name", CondSet, {"a", "b"})}));
+}
@@ -164,3 +164,181 @@ TEST_F(TransactionApi, IndexesOptimizeTest) {
 	bool optimization_completed = qr[0].GetItem(false)["optimization_completed"].Get<bool>();
 	ASSERT_EQ(true, optimization_completed);
 }
+
+TEST_F(TransactionApi, CopyFreeCommitOfIdleNamespace) {
+	const char* const kConfigNs = "#config";
+	Item config = NewItem(kConfigNs);
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	Error err = config.FromJSON(R"json({"type":"profiling", "profiling":{"perfstats":true}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(kConfigNs, config);
+	config = NewItem(kConfigNs);
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	err = config.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "start_copy_policy_tx_size":10000, "tx_copy_select_idle_threshold":3600}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(kConfigNs, config);
+
+	auto copiesCount = [&] {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(Query("#perfstats").Where("name", CondEq, default_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1u);
+		return qr.Count() ? qr[0].GetItem(false)["transactions.total_copy_count"].As<int64_t>() : -1;
+	};
+
+	// Namespace is not copied, if there were no selects from it during the threshold. This namespace was never selected
+	AddDataToNsTx(*rt.reindexer, 0, 15000, "data");
+	EXPECT_EQ(copiesCount(), 0);
+	EXPECT_EQ(GetItemsCount(*rt.reindexer), 15000);
+
+	// Selected namespace is copied to let the selects run during the commit
+	AddDataToNsTx(*rt.reindexer, 15000, 15000, "data");
+	EXPECT_EQ(copiesCount(), 1);
+	EXPECT_EQ(GetItemsCount(*rt.reindexer), 30000);
+}
+
+TEST_F(TransactionApi, ParallelItemsDecode) {
+	// Items of the large transaction are stored serialized and are decoded on commit by the several workers
+	const char* const kConfigNs = "#config";
+	Item config = NewItem(kConfigNs);
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	Error err = config.FromJSON(R"json({"type":"namespaces", "namespaces":[{"namespace":"*", "parallel_update_workers":4}]})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	Upsert(kConfigNs, config);
+
+	constexpr int kItemsCount = 5000;
+	auto itemJSON = [](int id, int value) {
+		return fmt::sprintf(R"json({"id":%d,"data":"data_%d","extra":{"value":%d,"tags":["tag_%d"]}})json", id, id, value, id % 3);
+	};
+	auto tx = rt.reindexer->NewTransaction(default_namespace);
+	ASSERT_TRUE(tx.Status().ok()) << tx.Status().what();
+	for (int id = 0; id < kItemsCount; ++id) {
+		Item item = tx.NewItem();
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON(itemJSON(id, id));
+		ASSERT_TRUE(err.ok()) << err.what();
+		tx.Upsert(std::move(item));
+		if (id == kItemsCount / 2) {
+			// Query is applied after the previous items and before the next ones
+			tx.Modify(Query(default_namespace).Where(kFieldId, CondLt, kItemsCount).Set("extra.value", -1));
+		}
+	}
+	Item item = tx.NewItem();
+	ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+	item[kFieldId] = 0;
+	tx.Delete(std::move(item));
+	QueryResults result;
+	err = rt.reindexer->CommitTransaction(tx, result);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	QueryResults qr;
+	err = rt.reindexer->Select(Query(default_namespace).Sort(kFieldId, false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), size_t(kItemsCount - 1));
+	int id = 1;
+	for (auto it : qr) {
+		ASSERT_EQ(it.GetItem(false).GetJSON(), itemJSON(id, id <= kItemsCount / 2 ? -1 : id));
+		++id;
+	}
+}
+
+TEST_F(TransactionApi, PipelinedCommitWithStorage) {
+	// Storage records of the large transaction are written by the separate thread and have to match the final state of the items
+	using reindexer::fs::JoinPath;
+	const std::string kDir = JoinPath(reindexer::fs::GetTempDir(), "PipelinedTxTest");
+	const char* const kNs = "pipelined_tx_ns";
+	constexpr int kItemsCount = 3000;
+	reindexer::fs::RmDirAll(kDir);
+
+	auto connect = [&] {
+		auto rx = std::make_unique<Reindexer>();
+		Error err = rx->Connect("builtin://" + kDir);
+		EXPECT_TRUE(err.ok()) << err.what();
+		err = rx->OpenNamespace(kNs, StorageOpts().Enabled().CreateIfMissing());
+		EXPECT_TRUE(err.ok()) << err.what();
+		return rx;
+	};
+	auto rx = connect();
+	Error err = rx->AddIndex(kNs, {kFieldId, "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto tx = rx->NewTransaction(kNs);
+	ASSERT_TRUE(tx.Status().ok()) << tx.Status().what();
+	for (int i = 0; i < 2 * kItemsCount; ++i) {
+		// The second half of the steps updates the items of the first one
+		Item item = tx.NewItem();
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON(fmt::sprintf(R"json({"id":%d,"value":%d})json", i % kItemsCount, i));
+		ASSERT_TRUE(err.ok()) << err.what();
+		tx.Upsert(std::move(item));
+	}
+	QueryResults result;
+	err = rx->CommitTransaction(tx, result);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	// Items are loaded from the storage after the reopening
+	rx.reset();
+	rx = connect();
+	QueryResults qr;
+	err = rx->Select(Query(kNs).Sort(kFieldId, false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), size_t(kItemsCount));
+	int id = 0;
+	for (auto it : qr) {
+		ASSERT_EQ(it.GetItem(false).GetJSON(), fmt::sprintf(R"json({"id":%d,"value":%d})json", id, id + kItemsCount));
+		++id;
+	}
+	rx.reset();
+	reindexer::fs::RmDirAll(kDir);
+}
+
+TEST_F(TransactionApi, MultiNamespaceCommit) {
+	// Transactions of the several namespaces are committed together and each namespace may be modified by one transaction only
+	const std::vector<std::string> kNamespaces = {"multi_tx_ns_1", "multi_tx_ns_2", "multi_tx_ns_3"};
+	constexpr int kItemsCount = 500;
+	for (auto& ns : kNamespaces) {
+		Error err = rt.reindexer->OpenNamespace(ns);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rt.reindexer->AddIndex(ns, {kFieldId, "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	auto newTransactions = [&](const std::vector<std::string>& namespaces) {
+		std::vector<reindexer::Transaction> txs;
+		for (auto& ns : namespaces) {
+			txs.emplace_back(rt.reindexer->NewTransaction(ns));
+			EXPECT_TRUE(txs.back().Status().ok()) << txs.back().Status().what();
+			for (int id = 0; id < kItemsCount; ++id) {
+				Item item = txs.back().NewItem();
+				EXPECT_TRUE(item.Status().ok()) << item.Status().what();
+				Error err = item.FromJSON(fmt::sprintf(R"json({"id":%d,"ns":"%s"})json", id, ns));
+				EXPECT_TRUE(err.ok()) << err.what();
+				txs.back().Upsert(std::move(item));
+			}
+		}
+		return txs;
+	};
+
+	auto txs = newTransactions(kNamespaces);
+	std::vector<QueryResults> results(txs.size());
+	Error err = rt.reindexer->CommitTransactions(txs, results);
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (size_t i = 0; i < kNamespaces.size(); ++i) {
+		EXPECT_EQ(results[i].Count(), size_t(kItemsCount));
+		QueryResults qr;
+		err = rt.reindexer->Select(Query(kNamespaces[i]).Sort(kFieldId, false), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), size_t(kItemsCount));
+		int id = 0;
+		for (auto it : qr) {
+			ASSERT_EQ(it.GetItem(false).GetJSON(), fmt::sprintf(R"json({"id":%d,"ns":"%s"})json", id++, kNamespaces[i]));
+		}
+	}
+
+	txs = newTransactions({kNamespaces[0], kNamespaces[0]});
+	results = std::vector<QueryResults>(txs.size());
+	err = rt.reindexer->CommitTransactions(txs, results);
+	EXPECT_EQ(err.code(), errParams) << err.what();
+}
@@ -0,0 +1,57 @@
+#include <set>
+#include <string>
+#include "core/index/trigramindex.h"
+#include "gtest/gtest.h"
+
+using reindexer::TrigramIndex;
+using reindexer::make_key_string;
+
+static std::set<std::string> candidates(const TrigramIndex &index, std::string_view pattern, bool *narrowed = nullptr) {
+	std::set<std::string> keys;
+	const bool res = index.ForEachCandidate(pattern, [&keys](std::string_view key) { keys.emplace(key); });
+	if (narrowed) *narrowed = res;
+	return keys;
+}
+
+TEST(TrigramIndexTest, Candidates) {
+	TrigramIndex index;
+	for (const char *key : {"apple pie", "Pineapple", "APPLICATION", "grape", "ap", "яблоко", "Яблоня"}) index.Add(make_key_string(key));
+
+	using Keys = std::set<std::string>;
+	// Trigrams are case insensitive
+	EXPECT_EQ(candidates(index, "%appl%"), (Keys{"apple pie", "Pineapple", "APPLICATION"}));
+	EXPECT_EQ(candidates(index, "%apple%pie"), (Keys{"apple pie"}));
+	EXPECT_EQ(candidates(index, "%ЯБЛ%"), (Keys{"яблоко", "Яблоня"}));
+	// Trigrams are not crossing wildcards
+	EXPECT_EQ(candidates(index, "gr_pe"), Keys{});
+	EXPECT_EQ(candidates(index, "%rap_"), (Keys{"grape"}));
+	EXPECT_EQ(candidates(index, "%xyz%"), Keys{});
+
+	// Pattern without trigrams can not narrow the keys
+	bool narrowed = true;
+	EXPECT_TRUE(candidates(index, "%ap%", &narrowed).empty());
+	EXPECT_FALSE(narrowed);
+
+	index.Remove("Pineapple");
+	index.Remove("absent");
+	EXPECT_EQ(candidates(index, "%appl%"), (Keys{"apple pie", "APPLICATION"}));
+}
+
+TEST(TrigramIndexTest, RebuildAfterRemoval) {
+	TrigramIndex index;
+	constexpr int kKeys = 10000;
+	for (int i = 0; i < kKeys; ++i) index.Add(make_key_string("key_" + std::to_string(i)));
+	const size_t fullSize = index.HeapSize();
+	// Index is rebuilt, when the removed keys are the most of it
+	for (int i = 0; i < kKeys; ++i) {
+		if (i % 10) index.Remove("key_" + std::to_string(i));
+	}
+	EXPECT_LT(index.HeapSize(), fullSize);
+	for (int i = kKeys; i < kKeys + 10; ++i) index.Add(make_key_string("key_" + std::to_string(i)));
+
+	// '_' is the wildcard too
+	EXPECT_EQ(candidates(index, "key_999%"), (std::set<std::string>{"key_9990"}));
+	std::set<std::string> expected{"key_1000"};
+	for (int i = kKeys; i < kKeys + 10; ++i) expected.emplace("key_" + std::to_string(i));
+	EXPECT_EQ(candidates(index, "%1000%"), expected);
+}
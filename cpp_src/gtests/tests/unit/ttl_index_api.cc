@@ -33,3 +33,26 @@ TEST_F(TtlIndexApi, ItemsVanishingAfterInsertRemove) {
 	count = WaitForVanishing();
 	ASSERT_TRUE(count == 0);
 }
+
+TEST_F(TtlIndexApi, ItemsVanishingByChunksWithRateLimit) {
+	Item config = rt.reindexer->NewItem("#config");
+	ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+	Error err = config.FromJSON(R"json({
+		"type":"namespaces",
+		"namespaces":[{"namespace":"*", "ttl_expiration_chunk_size":100, "ttl_expiration_rate_limit":1000}]
+	})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rt.reindexer->Upsert("#config", config);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	// 3000 items are expired at once, but not more than 1000 of them are deleted per second
+	std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+	ASSERT_GE(GetItemsCount(), 1000u);
+
+	size_t count = GetItemsCount();
+	for (size_t i = 0; i < 100 && count; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		count = GetItemsCount();
+	}
+	ASSERT_EQ(count, 0u);
+}
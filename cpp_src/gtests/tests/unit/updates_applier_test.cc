@@ -0,0 +1,103 @@
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "gtest/gtest.h"
+#include "replicator/updatesapplier.h"
+
+using reindexer::LSNPair;
+using reindexer::UpdatesApplier;
+using reindexer::WALRecord;
+using reindexer::WalPutMeta;
+using reindexer::span;
+using Update = reindexer::UpdatesApplier::Update;
+
+TEST(UpdatesApplierTest, KeepsOrderWithinNamespace) {
+	constexpr int kNamespaces = 8;
+	constexpr int kUpdatesPerNs = 2000;
+	std::mutex mtx;
+	std::map<std::string, std::vector<int>> applied;
+	UpdatesApplier applier([&](std::string_view nsName, span<Update> updates) {
+		std::lock_guard<std::mutex> lck(mtx);
+		for (auto &upd : updates) {
+			applied[std::string(nsName)].emplace_back(std::stoi(std::string(upd.rec.putMeta.value)));
+		}
+	});
+	applier.Start(4);
+	for (int i = 0; i < kUpdatesPerNs; ++i) {
+		for (int ns = 0; ns < kNamespaces; ++ns) {
+			const std::string value = std::to_string(i);
+			applier.Push(LSNPair(), "ns" + std::to_string(ns), WALRecord(WalPutMeta, "key", value));
+		}
+	}
+	applier.WaitIdle();
+
+	ASSERT_EQ(applied.size(), size_t(kNamespaces));
+	for (auto &ns : applied) {
+		ASSERT_EQ(ns.second.size(), size_t(kUpdatesPerNs)) << ns.first;
+		for (int i = 0; i < kUpdatesPerNs; ++i) {
+			ASSERT_EQ(ns.second[i], i) << ns.first;
+		}
+	}
+	applier.Stop();
+}
+
+TEST(UpdatesApplierTest, AppliesNamespacesConcurrently) {
+	std::atomic<bool> secondApplied{false};
+	std::atomic<bool> firstWaited{false};
+	UpdatesApplier applier([&](std::string_view nsName, span<Update>) {
+		if (nsName == "first") {
+			// Slow update of the first namespace does not block the updates of the second one
+			const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (!secondApplied.load() && std::chrono::steady_clock::now() < deadline) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			firstWaited = secondApplied.load();
+		} else {
+			secondApplied = true;
+		}
+	});
+	applier.Start(2);
+	applier.Push(LSNPair(), "first", WALRecord(WalPutMeta, "key", "value"));
+	applier.Push(LSNPair(), "second", WALRecord(WalPutMeta, "key", "value"));
+	applier.WaitIdle();
+	EXPECT_TRUE(firstWaited.load());
+}
+
+TEST(UpdatesApplierTest, AppliesQueuedUpdatesAsBatches) {
+	constexpr size_t kUpdatesCount = 5000;
+	std::atomic<bool> firstBatchApplied{false};
+	std::atomic<bool> released{false};
+	std::mutex mtx;
+	std::vector<size_t> batches;
+	UpdatesApplier applier([&](std::string_view, span<Update> updates) {
+		if (!firstBatchApplied.exchange(true)) {
+			// Updates are queued, while the first one is applied
+			while (!released.load()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+		std::lock_guard<std::mutex> lck(mtx);
+		batches.emplace_back(updates.size());
+	});
+	applier.Start(1);
+	applier.Push(LSNPair(), "ns", WALRecord(WalPutMeta, "key", "0"));
+	while (!firstBatchApplied.load()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	for (size_t i = 1; i < kUpdatesCount; ++i) {
+		applier.Push(LSNPair(), "ns", WALRecord(WalPutMeta, "key", std::to_string(i)));
+	}
+	released = true;
+	applier.WaitIdle();
+
+	size_t total = 0;
+	for (auto size : batches) {
+		EXPECT_LE(size, UpdatesApplier::kMaxBatchSize);
+		total += size;
+	}
+	EXPECT_EQ(total, kUpdatesCount);
+	// All of the updates, queued during the first batch, are applied by the full size batches
+	EXPECT_EQ(batches.size(), 1 + (kUpdatesCount - 1 + UpdatesApplier::kMaxBatchSize - 1) / UpdatesApplier::kMaxBatchSize);
+}
@@ -0,0 +1,188 @@
+#include <map>
+#include <string>
+#include "core/storage/idatastorage.h"
+#include "gtest/gtest.h"
+#include "replicator/waltracker.h"
+
+using reindexer::WALRecord;
+using reindexer::WALTracker;
+using reindexer::WalPutMeta;
+using namespace reindexer::datastorage;
+
+namespace {
+
+class MapComparator : public Comparator {
+public:
+	int Compare(std::string_view a, std::string_view b) const override { return a.compare(b); }
+};
+
+class MapCursor : public Cursor {
+public:
+	explicit MapCursor(const std::map<std::string, std::string>& data) : data_(data), it_(data_.end()) {}
+	bool Valid() const override { return it_ != data_.end(); }
+	void SeekToFirst() override { it_ = data_.begin(); }
+	void SeekToLast() override { it_ = std::prev(data_.end()); }
+	void Seek(std::string_view target) override { it_ = data_.lower_bound(std::string(target)); }
+	void Next() override { ++it_; }
+	void Prev() override { --it_; }
+	std::string_view Key() const override { return it_->first; }
+	std::string_view Value() const override { return it_->second; }
+	Comparator& GetComparator() override { return comparator_; }
+
+private:
+	const std::map<std::string, std::string>& data_;
+	std::map<std::string, std::string>::const_iterator it_;
+	MapComparator comparator_;
+};
+
+class MapStorage : public IDataStorage {
+public:
+	reindexer::Error Open(const std::string&, const StorageOpts&) override { return {}; }
+	reindexer::Error Read(const StorageOpts&, std::string_view key, std::string& value) override {
+		auto it = data.find(std::string(key));
+		if (it == data.end()) return reindexer::Error(errNotFound);
+		value = it->second;
+		return {};
+	}
+	reindexer::Error Write(const StorageOpts&, std::string_view key, std::string_view value) override {
+		data[std::string(key)] = std::string(value);
+		return {};
+	}
+	reindexer::Error Write(const StorageOpts&, UpdatesCollection&) override { return reindexer::Error(errLogic); }
+	reindexer::Error Delete(const StorageOpts&, std::string_view key) override {
+		data.erase(std::string(key));
+		return {};
+	}
+	Snapshot::Ptr MakeSnapshot() override { return nullptr; }
+	void ReleaseSnapshot(Snapshot::Ptr) override {}
+	void Flush() override {}
+	Cursor* GetCursor(StorageOpts&) override { return new MapCursor(data); }
+	UpdatesCollection* GetUpdatesCollection() override { return nullptr; }
+	void Destroy(const std::string&) override { data.clear(); }
+	reindexer::Error Repair(const std::string&) override { return {}; }
+	StorageType Type() const noexcept override { return StorageType::LevelDB; }
+
+	size_t Count(std::string_view prefix) const {
+		size_t count = 0;
+		for (auto& kv : data) count += (std::string_view(kv.first).substr(0, prefix.size()) == prefix);
+		return count;
+	}
+
+	std::map<std::string, std::string> data;
+};
+
+std::vector<std::pair<int64_t, std::string>> readSpilled(const WALTracker& wal, int64_t from) {
+	std::vector<std::pair<int64_t, std::string>> res;
+	wal.ForEachSpilled(from, [&res](int64_t lsn, reindexer::span<uint8_t> rec) {
+		res.emplace_back(lsn, std::string(WALRecord(rec).putMeta.value));
+		return true;
+	});
+	return res;
+}
+
+}  // namespace
+
+TEST(WALSpillTest, ServesAgedOutRecords) {
+	constexpr int64_t kWALSize = 10;
+	constexpr int64_t kRecords = 100;
+	auto storage = std::make_shared<MapStorage>();
+	WALTracker wal(kWALSize);
+	wal.SetSpillLimits(1 << 20, 0);
+	wal.Init(kWALSize, std::numeric_limits<int64_t>::max(), -1, storage);
+	// Records of the same size
+	for (int64_t i = 0; i < kRecords; ++i) {
+		wal.Add(WALRecord(WalPutMeta, "key", std::to_string(1000 + i)));
+	}
+
+	// Records, which are aged out of the ring buffer, are not outdated
+	EXPECT_FALSE(wal.is_outdated(0));
+	EXPECT_TRUE(wal.is_spilled(0));
+	EXPECT_TRUE(wal.is_spilled(kRecords - kWALSize - 1));
+	EXPECT_FALSE(wal.is_spilled(kRecords - kWALSize));
+	EXPECT_EQ(wal.begin().GetLSN(), kRecords - kWALSize);
+	auto spilled = readSpilled(wal, 5);
+	ASSERT_EQ(spilled.size(), size_t(kRecords - kWALSize - 5));
+	for (size_t i = 0; i < spilled.size(); ++i) {
+		EXPECT_EQ(spilled[i].first, int64_t(i + 5));
+		EXPECT_EQ(spilled[i].second, std::to_string(1000 + i + 5));
+	}
+
+	// Spilled records are restored from storage
+	WALTracker restored(kWALSize);
+	restored.SetSpillLimits(1 << 20, 0);
+	restored.Init(kWALSize, std::numeric_limits<int64_t>::max(), -1, storage);
+	EXPECT_EQ(restored.LSNCounter(), kRecords);
+	EXPECT_EQ(readSpilled(restored, 0), readSpilled(wal, 0));
+	EXPECT_EQ(restored.spilled_size(), wal.spilled_size());
+
+	// The oldest records are removed, when budget is exceeded
+	const int64_t recordSize = wal.spilled_size() / (kRecords - kWALSize);
+	wal.SetSpillLimits(recordSize * 10, 0);
+	EXPECT_TRUE(wal.is_outdated(0));
+	EXPECT_FALSE(wal.is_outdated(kRecords - kWALSize - 10));
+	spilled = readSpilled(wal, 0);
+	ASSERT_EQ(spilled.size(), 10u);
+	EXPECT_EQ(spilled.front().first, kRecords - kWALSize - 10);
+	EXPECT_EQ(storage->Count("V"), 10u);
+
+	// Spilled records are removed from storage, when spill mode is disabled
+	wal.SetSpillLimits(0, 0);
+	EXPECT_TRUE(wal.is_outdated(kRecords - kWALSize - 1));
+	EXPECT_EQ(wal.spilled_size(), 0);
+	EXPECT_EQ(storage->Count("V"), 0u);
+}
+
+TEST(WALSpillTest, SpillsRecordsDroppedByResize) {
+	auto storage = std::make_shared<MapStorage>();
+	WALTracker wal(100);
+	wal.SetSpillLimits(1 << 20, 0);
+	wal.Init(100, std::numeric_limits<int64_t>::max(), -1, storage);
+	for (int i = 0; i < 50; ++i) {
+		wal.Add(WALRecord(WalPutMeta, "key", std::to_string(i)));
+	}
+	EXPECT_FALSE(wal.is_spilled(0));
+	ASSERT_TRUE(wal.Resize(20));
+	EXPECT_FALSE(wal.is_outdated(0));
+	auto spilled = readSpilled(wal, 0);
+	ASSERT_EQ(spilled.size(), 30u);
+	EXPECT_EQ(spilled.back().first, 29);
+	EXPECT_EQ(wal.begin().GetLSN(), 30);
+}
+
+TEST(WALSpillTest, CompressedRingBuffer) {
+	// Ring buffer spans several blocks, so most of them are sealed
+	constexpr int64_t kWALSize = reindexer::WALRing::kBlockSize * (reindexer::WALRing::kMaxOpenBlocks + 4);
+	constexpr int64_t kRecords = kWALSize + reindexer::WALRing::kBlockSize / 2;
+	WALTracker wal(kWALSize);
+	wal.Init(kWALSize, std::numeric_limits<int64_t>::max(), -1, std::weak_ptr<IDataStorage>());
+	for (int64_t i = 0; i < kRecords; ++i) {
+		wal.Add(WALRecord(WalPutMeta, "key", std::to_string(i)));
+	}
+	// Records of the sealed blocks are emptied without the decompression
+	auto isEmptied = [](int64_t lsn) { return lsn % 7 == 0; };
+	for (int64_t lsn = kRecords - kWALSize; lsn < kRecords; ++lsn) {
+		if (isEmptied(lsn)) {
+			ASSERT_TRUE(wal.Set(WALRecord(), lsn));
+		}
+	}
+
+	auto check = [&](const WALTracker& tracker, int64_t from) {
+		int64_t lsn = from;
+		for (auto it = tracker.begin(); it != tracker.end(); ++it, ++lsn) {
+			ASSERT_EQ(it.GetLSN(), lsn);
+			const WALRecord rec = *it;
+			if (isEmptied(lsn)) {
+				EXPECT_EQ(rec.type, reindexer::WalEmpty) << lsn;
+			} else {
+				ASSERT_EQ(rec.type, WalPutMeta) << lsn;
+				EXPECT_EQ(rec.putMeta.value, std::to_string(lsn));
+			}
+		}
+		EXPECT_EQ(lsn, kRecords);
+	};
+	check(wal, kRecords - kWALSize);
+	EXPECT_EQ(wal.size(), kWALSize);
+
+	ASSERT_TRUE(wal.Resize(kWALSize / 2));
+	check(wal, kRecords - kWALSize / 2);
+}
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <thread>
+#include "core/warmstate.h"
+#include "reindexer_api.h"
+#include "tools/fsops.h"
+
+TEST_F(ReindexerApi, WarmStateReplay) {
+	using reindexer::fs::JoinPath;
+	const std::string kDir = JoinPath(reindexer::fs::GetTempDir(), "WarmStateTest");
+	const std::string kDsn = "builtin://" + kDir;
+	const char* const kConfigNs = "#config";
+	const Query kFrequentQuery = Query(default_namespace).Where("value", CondGe, "value_50");
+	const Query kRareQuery = Query(default_namespace).Where("id", CondEq, 5);
+	reindexer::fs::RmDirAll(kDir);
+
+	auto connect = [&] {
+		rt.reindexer.reset(new Reindexer);
+		Error err = rt.reindexer->Connect(kDsn);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	auto upsertConfig = [&](const char* json) {
+		Item config = NewItem(kConfigNs);
+		ASSERT_TRUE(config.Status().ok()) << config.Status().what();
+		Error err = config.FromJSON(json);
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(kConfigNs, config);
+	};
+	auto select = [&](const Query& q) {
+		QueryResults qr;
+		Error err = rt.reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+
+	connect();
+	Error err = rt.reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled());
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{"id", "hash", "int", IndexOpts().PK(), 0},
+											   IndexDeclaration{"value", "tree", "string", IndexOpts(), 0}});
+	upsertConfig(R"json({"type":"namespaces","namespaces":[{"namespace":"*","optimization_timeout_ms":10}]})json");
+	upsertConfig(R"json({"type":"profiling","profiling":{"queriesperfstats":true}})json");
+	upsertConfig(R"json({"type":"maintenance","maintenance":{"workers":2,"warmup_queries":5}})json");
+	for (int i = 0; i < 100; ++i) {
+		Item item = NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON("{\"id\":" + std::to_string(i) + ",\"value\":\"value_" + std::to_string(i) + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		Upsert(default_namespace, item);
+	}
+	for (int i = 0;; ++i) {
+		ASSERT_LT(i, 200) << "Indexes optimization was not completed";
+		QueryResults qr;
+		err = rt.reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1u);
+		if (qr.begin().GetItem(false)["optimization_completed"].As<bool>()) break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	for (int i = 0; i < 3; ++i) select(kFrequentQuery);
+	select(kRareQuery);
+
+	// Warm state is saved on shutdown
+	rt.reindexer.reset();
+	reindexer::WarmState state;
+	ASSERT_TRUE(state.Load(JoinPath(kDir, "warmstate.json"), err));
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(state.sortedNamespaces, std::vector<std::string>{default_namespace});
+	ASSERT_GE(state.queries.size(), 2u);
+	EXPECT_EQ(state.queries[0].sql, kFrequentQuery.GetSQL());
+	EXPECT_EQ(state.queries[0].hits, 3u);
+
+	// Each query of the state is replayed, until the caches create its entries
+	connect();
+	for (int i = 0; !rt.reindexer->IsWarmedUp(); ++i) {
+		ASSERT_LT(i, 200) << "Warmup was not completed";
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	for (const Query& q : {kFrequentQuery, kRareQuery}) {
+		QueryResults qr;
+		err = rt.reindexer->Select(Query("#queriesperfstats").Where("total_queries_count", CondEq, 3), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		bool found = false;
+		for (auto it : qr) found = found || it.GetItem(false)["query"].As<std::string>() == q.GetSQL(true);
+		EXPECT_TRUE(found) << q.GetSQL();
+	}
+
+	rt.reindexer.reset();
+	reindexer::fs::RmDirAll(kDir);
+}
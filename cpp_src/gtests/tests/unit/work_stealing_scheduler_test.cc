@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "tools/errors.h"
+#include "tools/workstealingscheduler.h"
+
+using reindexer::WorkStealingScheduler;
+
+TEST(WorkStealingScheduler, ExecutesEachTaskOnce) {
+	constexpr size_t kTasksCount = 1000;
+	std::vector<std::atomic<int>> counters(kTasksCount);
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::set<std::thread::id> threads;
+	WorkStealingScheduler scheduler(4);
+	for (size_t i = 0; i < kTasksCount; ++i) {
+		scheduler.Add([&, i] {
+			counters[i]++;
+			std::unique_lock<std::mutex> lck(mtx);
+			threads.insert(std::this_thread::get_id());
+			cv.notify_all();
+			// The first task blocks its thread until the other thread executes some task, so the tasks can not be executed by
+			// the single thread
+			if (i == 0) cv.wait_for(lck, std::chrono::seconds(30), [&threads] { return threads.size() > 1; });
+		});
+	}
+	ASSERT_EQ(scheduler.TasksCount(), kTasksCount);
+	scheduler.Run(nullptr);
+	for (size_t i = 0; i < kTasksCount; ++i) ASSERT_EQ(counters[i].load(), 1) << i;
+	EXPECT_GT(threads.size(), 1u);
+	ASSERT_EQ(scheduler.TasksCount(), 0u);
+
+	// Scheduler may be reused
+	std::atomic<int> executed{0};
+	for (size_t i = 0; i < 3; ++i) scheduler.Add([&executed] { executed++; });
+	scheduler.Run(nullptr);
+	EXPECT_EQ(executed.load(), 3);
+}
+
+TEST(WorkStealingScheduler, Cancel) {
+	std::atomic<int> executed{0};
+	WorkStealingScheduler scheduler(2);
+	for (size_t i = 0; i < 100; ++i) scheduler.Add([&executed] { executed++; });
+	scheduler.Run([&executed] { return executed.load() >= 10; });
+	EXPECT_GE(executed.load(), 10);
+	EXPECT_LT(executed.load(), 100);
+}
+
+TEST(WorkStealingScheduler, ReusedAfterCancelAndError) {
+	std::atomic<int> executed{0};
+	WorkStealingScheduler scheduler(2);
+	for (size_t i = 0; i < 10; ++i) scheduler.Add([&executed] { executed++; });
+	scheduler.Run([] { return true; });
+	EXPECT_EQ(executed.load(), 0);
+
+	for (size_t i = 0; i < 10; ++i) scheduler.Add([&executed] { executed++; });
+	scheduler.Run(nullptr);
+	EXPECT_EQ(executed.load(), 10);
+
+	scheduler.Add([] { throw reindexer::Error(errLogic, "Task error"); });
+	EXPECT_THROW(scheduler.Run(nullptr), reindexer::Error);
+
+	executed = 0;
+	for (size_t i = 0; i < 10; ++i) scheduler.Add([&executed] { executed++; });
+	scheduler.Run(nullptr);
+	EXPECT_EQ(executed.load(), 10);
+}
+
+TEST(WorkStealingScheduler, RethrowsError) {
+	std::atomic<int> executed{0};
+	WorkStealingScheduler scheduler(3);
+	for (size_t i = 0; i < 100; ++i) {
+		scheduler.Add([&executed, i] {
+			if (i == 50) throw reindexer::Error(errLogic, "Task error");
+			executed++;
+		});
+	}
+	try {
+		scheduler.Run(nullptr);
+		FAIL() << "Exception was expected";
+	} catch (const reindexer::Error &err) {
+		EXPECT_EQ(err.code(), errLogic);
+		EXPECT_EQ(err.what(), std::string("Task error"));
+	}
+	EXPECT_LT(executed.load(), 100);
+}
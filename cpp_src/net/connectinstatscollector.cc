@@ -10,6 +10,7 @@ connection_stats_collector::connection_stats_collector() { stat_ = std::make_sha
 
 void connection_stats_collector::attach(ev::dynamic_loop& loop) noexcept {
 	stats_update_timer_.set<connection_stats_collector, &connection_stats_collector::stats_check_cb>(this);
+	stats_update_timer_.set_coarse(true);
 	stats_update_timer_.set(loop);
 	stats_update_timer_.start(k_stats_update_period, k_stats_update_period);
 }
@@ -49,6 +50,12 @@ void connection_stats_collector::update_send_buf_size(size_t size) noexcept {
 	stat_->send_buf_bytes.store(size, std::memory_order_relaxed);
 }
 
+void connection_stats_collector::update_compression_stats(const cproto::CompressionStats &stats) noexcept {
+	if (!stats.rawBytes) return;
+	stat_->compression_raw_bytes.fetch_add(stats.rawBytes, std::memory_order_relaxed);
+	stat_->compression_sent_bytes.fetch_add(stats.sentBytes, std::memory_order_relaxed);
+}
+
 void connection_stats_collector::stats_check_cb(ev::periodic&, int) noexcept {
 	assertrx(stat_);
 	const uint64_t kAvgPeriod = 10;
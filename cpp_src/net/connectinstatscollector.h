@@ -3,6 +3,7 @@
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include "net/cproto/compressor.h"
 #include "net/ev/ev.h"
 #include "tools/ssize_t.h"
 
@@ -23,6 +24,9 @@ struct connection_stat {
 	std::atomic<uint32_t> recv_rate{0};
 	int64_t start_time{0};
 	std::atomic_int_fast64_t updates_lost{0};
+	// Size of the messages before and after compression. Counted only for the connections with enabled compression
+	std::atomic_int_fast64_t compression_raw_bytes{0};
+	std::atomic_int_fast64_t compression_sent_bytes{0};
 };
 
 class connection_stats_collector {
@@ -39,6 +43,7 @@ public:
 	void update_write_stats(ssize_t written, size_t send_buf_size) noexcept;
 	void update_pended_updates(size_t) noexcept;
 	void update_send_buf_size(size_t) noexcept;
+	void update_compression_stats(const cproto::CompressionStats &) noexcept;
 
 protected:
 	void stats_check_cb(ev::periodic &watcher, int) noexcept;
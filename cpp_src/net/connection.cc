@@ -26,6 +26,8 @@ void Connection<Mutex>::restart(int fd) {
 	rdBuf_.clear();
 	curEvents_ = 0;
 	closeConn_ = false;
+	readPaused_ = false;
+	sendBufOverflow_ = false;
 	if (stats_) stats_->restart();
 }
 
@@ -39,6 +41,7 @@ void Connection<Mutex>::attach(ev::dynamic_loop &loop) {
 		clientAddr_ = sock_.addr();
 	}
 	timeout_.set<Connection, &Connection::timeout_cb>(this);
+	timeout_.set_coarse(true);
 	timeout_.set(loop);
 	async_.set<Connection, &Connection::async_cb>(this);
 	async_.set(loop);
@@ -87,10 +90,21 @@ void Connection<Mutex>::callback(ev::io & /*watcher*/, int revents) {
 		write_cb();
 	}
 
-	int nevents = ev::READ | (wrBuf_.size() ? ev::WRITE : 0);
+	const size_t pending = wrBuf_.data_size();
+	if (sendBufOverflow_) {
+		sendBufOverflow_ = pending > sendBufLowWatermark_;
+	} else {
+		sendBufOverflow_ = pending >= sendBufHighWatermark_;
+	}
+
+	int nevents = ((readPaused_ || sendBufOverflow_) ? 0 : ev::READ) | (wrBuf_.size() ? ev::WRITE : 0);
 
 	if (curEvents_ != nevents && sock_.valid()) {
-		(curEvents_) ? io_.set(nevents) : io_.start(sock_.fd(), nevents);
+		if (!nevents) {
+			io_.stop();
+		} else {
+			(curEvents_) ? io_.set(nevents) : io_.start(sock_.fd(), nevents);
+		}
 		curEvents_ = nevents;
 	}
 }
@@ -133,7 +147,7 @@ void Connection<Mutex>::write_cb() {
 // Receive message from client socket
 template <typename Mutex>
 void Connection<Mutex>::read_cb() {
-	while (!closeConn_) {
+	while (!closeConn_ && !readPaused_ && !sendBufOverflow_) {
 		auto it = rdBuf_.head();
 		ssize_t nread = sock_.recv(it);
 		int err = sock_.last_error();
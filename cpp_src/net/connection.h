@@ -14,6 +14,9 @@ namespace net {
 
 constexpr ssize_t kConnReadbufSize = 0x8000;
 constexpr ssize_t kConnWriteBufSize = 0x800;
+// Socket is not read, while the size of the unsent data is above the high watermark, until it's drained to the low watermark
+constexpr size_t kConnSendBufHighWatermark = 0x2000000;
+constexpr size_t kConnSendBufLowWatermark = 0x800000;
 
 struct ConnectionStat {
 	ConnectionStat() {
@@ -67,6 +70,12 @@ protected:
 	bool closeConn_ = false;
 	bool attached_ = false;
 	bool canWrite_ = true;
+	// Socket is not read, while it's set. Data, which is already in the read buffer, is not affected
+	bool readPaused_ = false;
+	// Socket is not read, while the client doesn't read the responses (see kConnSendBufHighWatermark)
+	bool sendBufOverflow_ = false;
+	size_t sendBufHighWatermark_ = kConnSendBufHighWatermark;
+	size_t sendBufLowWatermark_ = kConnSendBufLowWatermark;
 
 	chain_buf<Mutex> wrBuf_;
 	cbuf<char> rdBuf_;
@@ -2,6 +2,7 @@
 
 #include "core/keyvalue/p_string.h"
 #include "core/keyvalue/variant.h"
+#include "estl/span.h"
 #include "tools/serializer.h"
 namespace reindexer {
 namespace net {
@@ -16,6 +17,20 @@ public:
 	void Pack(WrSerializer &ser) const;
 	void Dump(WrSerializer &wrser) const;
 };
+
+/// Calls f with the packed args of each update from the args of kCmdUpdatesBatch message
+template <typename F>
+void ForEachBatchedUpdate(const Args &batchArgs, F &&f) {
+	if (batchArgs.empty()) {
+		throw Error(errParseBin, "Empty updates batch");
+	}
+	const std::string_view batch(batchArgs[0]);
+	Serializer ser(batch);
+	while (!ser.Eof()) {
+		const auto packed = ser.GetVString();
+		f(span<uint8_t>(reinterpret_cast<const uint8_t *>(packed.data()), packed.size()));
+	}
+}
 }  // namespace cproto
 }  // namespace net
 }  // namespace reindexer
@@ -0,0 +1,82 @@
+#include "callsexecutor.h"
+#include <exception>
+#include "debug/sampler.h"
+#include "tools/assertrx.h"
+
+namespace reindexer {
+namespace net {
+namespace cproto {
+
+CallsExecutor::CallsExecutor(size_t threads, std::function<void()> threadInit) {
+	assertrx(threads);
+	threads_.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) threads_.emplace_back([this, threadInit] { work(threadInit); });
+}
+
+CallsExecutor::~CallsExecutor() {
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		terminate_ = true;
+	}
+	cond_.notify_all();
+	for (auto &th : threads_) th.join();
+}
+
+void CallsExecutor::Execute(Task &&task) {
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		tasks_.emplace_back(QueuedTask{std::move(task), std::chrono::steady_clock::now()});
+	}
+	cond_.notify_one();
+}
+
+void CallsExecutor::ExecuteAndWait(Task &&task) {
+	std::mutex mtx;
+	std::condition_variable cond;
+	bool done = false;
+	std::exception_ptr ex;
+	Execute([&] {
+		try {
+			task();
+		} catch (...) {
+			ex = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lck(mtx);
+		done = true;
+		cond.notify_one();
+	});
+	std::unique_lock<std::mutex> lck(mtx);
+	cond.wait(lck, [&done] { return done; });
+	if (ex) std::rethrow_exception(ex);
+}
+
+size_t CallsExecutor::QueueSize() const {
+	std::lock_guard<std::mutex> lck(mtx_);
+	return tasks_.size();
+}
+
+std::chrono::microseconds CallsExecutor::QueueWait() const {
+	std::lock_guard<std::mutex> lck(mtx_);
+	if (tasks_.empty()) return std::chrono::microseconds(0);
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tasks_.front().queuedAt);
+}
+
+void CallsExecutor::work(const std::function<void()> &threadInit) {
+	debug::CPUSampler::RegisterThread(debug::ThreadRole::RPC);
+	if (threadInit) threadInit();
+	for (;;) {
+		Task task;
+		{
+			std::unique_lock<std::mutex> lck(mtx_);
+			cond_.wait(lck, [this] { return terminate_ || !tasks_.empty(); });
+			if (tasks_.empty()) return;
+			task = std::move(tasks_.front().task);
+			tasks_.pop_front();
+		}
+		task();
+	}
+}
+
+}  // namespace cproto
+}  // namespace net
+}  // namespace reindexer
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reindexer {
+namespace net {
+namespace cproto {
+
+/// Fixed pool of threads, which execute parallel RPC calls of the server connections
+class CallsExecutor {
+public:
+	using Task = std::function<void()>;
+
+	/// @param threadInit - Optional routine, which is called by each thread of the pool before the execution of the tasks
+	explicit CallsExecutor(size_t threads, std::function<void()> threadInit = nullptr);
+	/// Waits for completion of all of the queued tasks
+	~CallsExecutor();
+	CallsExecutor(const CallsExecutor &) = delete;
+	CallsExecutor &operator=(const CallsExecutor &) = delete;
+
+	void Execute(Task &&task);
+	/// Executes the task by the pool and blocks the calling thread until its completion. Task's exception is rethrown
+	void ExecuteAndWait(Task &&task);
+
+	size_t QueueSize() const;
+	/// Time, for which the oldest queued task is waiting for the free thread
+	std::chrono::microseconds QueueWait() const;
+	size_t Threads() const noexcept { return threads_.size(); }
+
+private:
+	struct QueuedTask {
+		Task task;
+		std::chrono::steady_clock::time_point queuedAt;
+	};
+
+	void work(const std::function<void()> &threadInit);
+
+	mutable std::mutex mtx_;
+	std::condition_variable cond_;
+	std::deque<QueuedTask> tasks_;
+	std::vector<std::thread> threads_;
+	bool terminate_ = false;
+};
+
+}  // namespace cproto
+}  // namespace net
+}  // namespace reindexer
@@ -170,6 +170,7 @@ void ClientConnection::deadline_check_cb(ev::timer &, int) {
 				if (state_ == ConnFailed || state_ == ConnClosing) {
 					return;
 				}
+				--inFlight_;
 				if (bufWait_) {
 					std::unique_lock<std::mutex> lck(mtx_);
 					cc->used = false;
@@ -222,6 +223,7 @@ void ClientConnection::onClose() {
 		State prevState = state_;
 		state_ = ConnClosing;
 		completions_.swap(tmpCompletions);
+		inFlight_ = 0;
 		mtx_.unlock();
 
 		keep_alive_.stop();
@@ -314,10 +316,26 @@ void ClientConnection::onRead() {
 			return;
 		}
 		rdBuf_.erase(hdr.len);
-		if (hdr.cmd == kCmdUpdates) {
+		if (hdr.cmd == kCmdUpdates || hdr.cmd == kCmdUpdatesBatch) {
 			auto handler = updatesHandler_.release(std::memory_order_acq_rel);
 			if (handler) {
-				(*handler)(std::move(ans), this);
+				if (hdr.cmd == kCmdUpdates) {
+					(*handler)(std::move(ans), this);
+				} else {
+					// Batch is split into the separate updates, so the handler doesn't have to know about batching
+					try {
+						if (!ans.Status().ok()) {
+							throw ans.Status();
+						}
+						ForEachBatchedUpdate(ans.GetArgs(1), [&](span<uint8_t> data) {
+							RPCAnswer update(errOK);
+							update.data_ = data;
+							(*handler)(std::move(update), this);
+						});
+					} catch (const Error &err) {
+						(*handler)(RPCAnswer(err), this);
+					}
+				}
 				Completion *expected = nullptr;
 				if (!updatesHandler_.compare_exchange_strong(expected, handler, std::memory_order_acq_rel)) {
 					delete handler;
@@ -340,6 +358,7 @@ void ClientConnection::onRead() {
 					rdBuf_.clear();
 					return;
 				}
+				--inFlight_;
 				if (bufWait_) {
 					std::unique_lock<std::mutex> lck(mtx_);
 					completion->used = false;
@@ -505,6 +524,7 @@ void ClientConnection::call(Completion cmpl, const CommandParams &opts, const Ar
 	completion->deadline = deadline;
 	completion->cancelCtx = opts.cancelCtx;
 	completion->used = true;
+	++inFlight_;
 
 	wrBuf_.write(std::move(data));
 	lck.unlock();
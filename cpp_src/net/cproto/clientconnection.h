@@ -154,6 +154,8 @@ public:
 	}
 
 	int PendingCompletions();
+	/// Count of the calls, which are waiting for the answer
+	int InFlight() const noexcept { return inFlight_.load(std::memory_order_relaxed); }
 	void SetTerminateFlag() noexcept { terminate_.store(true, std::memory_order_release); }
 	void SetUpdatesHandler(Completion handler) {
 		auto cur = updatesHandler_.get(std::memory_order_acquire);
@@ -217,6 +219,7 @@ protected:
 	std::condition_variable connectCond_, bufCond_, closingCond_;
 	std::atomic<uint32_t> seq_;
 	std::atomic<int32_t> bufWait_;
+	std::atomic<int32_t> inFlight_ = {0};
 	std::mutex mtx_;
 	std::thread::id loopThreadID_;
 	Error lastError_;
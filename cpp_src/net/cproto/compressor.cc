@@ -0,0 +1,38 @@
+#include "compressor.h"
+#include <snappy.h>
+
+namespace reindexer {
+namespace net {
+namespace cproto {
+
+bool AdaptiveCompressor::Compress(std::string_view data, std::string &out, bool force) {
+	if (!force) {
+		if (!MayCompress(data.size()) || skip_) {
+			if (skip_ && MayCompress(data.size())) --skip_;
+			AddUncompressed(data.size());
+			return false;
+		}
+	}
+
+	out.clear();
+	snappy::Compress(data.data(), data.size(), &out);
+	const double ratio = data.size() ? double(out.size()) / double(data.size()) : 1.0;
+	// Recent messages have more weight, so the ratio follows the changes of the traffic
+	ratio_ = (ratio_ > 0.0) ? (ratio_ + ratio) / 2 : ratio;
+	if (ratio_ > kPoorRatio) {
+		skip_ = kSkipAfterPoorRatio;
+		// Next sample is not affected by the poor history
+		ratio_ = 0.0;
+	}
+	if (!force && out.size() >= data.size()) {
+		AddUncompressed(data.size());
+		return false;
+	}
+	stats_.rawBytes += data.size();
+	stats_.sentBytes += out.size();
+	return true;
+}
+
+}  // namespace cproto
+}  // namespace net
+}  // namespace reindexer
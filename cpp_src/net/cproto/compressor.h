@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+namespace reindexer {
+namespace net {
+namespace cproto {
+
+struct CompressionStats {
+	int64_t rawBytes = 0;
+	int64_t sentBytes = 0;
+};
+
+/// Chooses, which messages of the connection with enabled compression are worth compressing.
+/// Small messages are always sent as is. Compression of the larger messages is suspended for a while,
+/// if the recent messages were not compressible enough, and then the ratio is sampled again
+class AdaptiveCompressor {
+public:
+	/// Messages shorter than this gain nothing from compression, but pay its CPU cost
+	static constexpr size_t kMinCompressSize = 512;
+	/// Compression is suspended, when compressed size is more than this part of the raw size
+	static constexpr double kPoorRatio = 0.9;
+	/// Count of the large messages, which are sent uncompressed after the poor ratio was detected
+	static constexpr unsigned kSkipAfterPoorRatio = 32;
+
+	/// Returns true and compressed data in out, if the message has to be sent compressed
+	bool Compress(std::string_view data, std::string &out, bool force = false);
+	/// Message of len bytes, which is sent as is
+	void AddUncompressed(size_t len) noexcept {
+		stats_.rawBytes += len;
+		stats_.sentBytes += len;
+	}
+	bool MayCompress(size_t len) const noexcept { return len >= kMinCompressSize; }
+	double Ratio() const noexcept { return ratio_; }
+	CompressionStats TakeStats() noexcept {
+		auto stats = stats_;
+		stats_ = CompressionStats();
+		return stats;
+	}
+	void Reset() noexcept { *this = AdaptiveCompressor(); }
+
+private:
+	double ratio_ = 0.0;
+	unsigned skip_ = 0;
+	CompressionStats stats_;
+};
+
+}  // namespace cproto
+}  // namespace net
+}  // namespace reindexer
@@ -398,6 +398,23 @@ void CoroClientConnection::readerRoutine() {
 				ans.EnsureHold(getChunk());
 				updatesCh_.push(std::move(ans));
 			}
+		} else if (hdr.cmd == kCmdUpdatesBatch) {
+			if (updatesHandler_) {
+				// Batch is split into the separate updates, so the handler doesn't have to know about batching
+				try {
+					if (!ans.Status().ok()) {
+						throw ans.Status();
+					}
+					ForEachBatchedUpdate(ans.GetArgs(1), [&](span<uint8_t> data) {
+						CoroRPCAnswer update;
+						update.data_ = data;
+						update.EnsureHold(getChunk());
+						updatesCh_.push(std::move(update));
+					});
+				} catch (const Error &err) {
+					updatesCh_.push(CoroRPCAnswer(err));
+				}
+			}
 		} else if (hdr.cmd == kCmdLogin) {
 			if (ans.Status().ok()) {
 				loggedIn_ = true;
@@ -67,6 +67,12 @@ std::string_view CmdName(uint16_t cmd) {
 			return "FetchResults"sv;
 		case kCmdCloseResults:
 			return "CloseResults"sv;
+		case kCmdStreamResults:
+			return "StreamResults"sv;
+		case kCmdResultsChunk:
+			return "ResultsChunk"sv;
+		case kCmdStreamCredit:
+			return "StreamCredit"sv;
 		case kCmdGetMeta:
 			return "GetMeta"sv;
 		case kCmdPutMeta:
@@ -79,6 +85,8 @@ std::string_view CmdName(uint16_t cmd) {
 			return "Updates"sv;
 		case kCmdGetSQLSuggestions:
 			return "GetSQLSuggestions"sv;
+		case kCmdUpdatesBatch:
+			return "UpdatesBatch"sv;
 		default:
 			return "Unknown"sv;
 	}
@@ -39,6 +39,9 @@ enum CmdCode : uint16_t {
 	kCmdSelectSQL = 49,
 	kCmdFetchResults = 50,
 	kCmdCloseResults = 51,
+	kCmdStreamResults = 52,
+	kCmdResultsChunk = 53,
+	kCmdStreamCredit = 54,
 
 	kCmdGetMeta = 64,
 	kCmdPutMeta = 65,
@@ -51,6 +54,8 @@ enum CmdCode : uint16_t {
 
 	kCmdGetSQLSuggestions = 92,
 
+	kCmdUpdatesBatch = 93,
+
 	kCmdCodeMax = 128
 };
 
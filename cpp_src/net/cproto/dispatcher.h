@@ -7,6 +7,7 @@
 #include <string_view>
 #include <vector>
 #include "args.h"
+#include "callsexecutor.h"
 #include "core/keyvalue/p_string.h"
 #include "cproto.h"
 #include "net/connection.h"
@@ -41,16 +42,34 @@ class Writer {
 public:
 	virtual ~Writer() = default;
 	virtual void WriteRPCReturn(Context &ctx, const Args &args, const Error &status) = 0;
+	/// Returns pooled buffer of the connection for the response data. Data must be appended to the returned chunk
+	virtual chunk GetDataChunk() = 0;
+	/// Sends response with the first string argument, which is taken from the chunk, returned by GetDataChunk. Data is not copied
+	virtual void WriteRPCReturn(Context &ctx, chunk &&data, const Args &args, const Error &status) = 0;
 	virtual void CallRPC(const IRPCCall &call) = 0;
+	/// Enables coalescing of the pushed updates into the compressed kCmdUpdatesBatch messages
+	virtual void SetUpdatesBatching(bool enable) = 0;
 	virtual void SetClientData(std::unique_ptr<ClientData> data) = 0;
 	virtual ClientData *GetClientData() = 0;
 	virtual std::shared_ptr<reindexer::net::connection_stat> GetConnectionStat() = 0;
+	/// Executes the heavy part of the call. Connection, which handles the calls as coroutines, passes the task to the calls executor
+	/// and suspends the call's coroutine until the task's completion, so the connection's thread is not blocked meanwhile
+	/// @param executor - executor of the task instead of the dispatcher's one. Calling thread is blocked, if the call is not a coroutine
+	virtual void Await(std::function<void()> task, CallsExecutor *executor) {
+		if (executor) {
+			executor->ExecuteAndWait(std::move(task));
+		} else {
+			task();
+		}
+	}
 };
 
 struct Context {
 	void Return(const Args &args, const Error &status = errOK) { writer->WriteRPCReturn(*this, args, status); }
+	void Return(chunk &&data, const Args &args, const Error &status = errOK) { writer->WriteRPCReturn(*this, std::move(data), args, status); }
 	void SetClientData(std::unique_ptr<ClientData> data) { writer->SetClientData(std::move(data)); }
 	ClientData *GetClientData() { return writer->GetClientData(); }
+	void Await(std::function<void()> task, CallsExecutor *executor = nullptr) { writer->Await(std::move(task), executor); }
 
 	std::string_view clientAddr;
 	RPCCall *call;
@@ -83,7 +102,7 @@ class Dispatcher {
 	friend class ServerConnection;
 
 public:
-	Dispatcher() : handlers_(kCmdCodeMax, {nullptr, nullptr}) {}
+	Dispatcher() : handlers_(kCmdCodeMax, {nullptr, nullptr}), parallel_(kCmdCodeMax, false) {}
 
 	/// Add handler for command.
 	/// @param cmd - Command code
@@ -107,6 +126,21 @@ public:
 		}
 	}
 
+	/// Allow to execute command by the calls executor in parallel with the other parallel commands of the same connection.
+	/// Responses for such commands may be sent out of order. Handler must not change per-connection state without synchronization
+	/// @param cmd - Command code
+	void AllowParallel(CmdCode cmd) { parallel_[cmd] = true; }
+	bool IsParallel(CmdCode cmd) const noexcept { return executor_ && uint32_t(cmd) < uint32_t(parallel_.size()) && parallel_[cmd]; }
+
+	/// Set executor for the parallel commands. All of the commands are executed in the connection's thread, if executor is not set
+	/// @param executor - executor, which must outlive all of the connections
+	void SetExecutor(CallsExecutor *executor) noexcept { executor_ = executor; }
+	/// Handle each call as a coroutine in the connection's thread. Parts of the handlers, passed to Context::Await, are executed by the
+	/// executor, while the thread handles the other calls and connections. Requires executor
+	/// @param enable - enable coroutines mode
+	void EnableCoroutines(bool enable) noexcept { coroutines_ = enable; }
+	bool CoroutinesEnabled() const noexcept { return executor_ && coroutines_; }
+
 	/// Add middleware for commands
 	/// @param object - handler class object
 	/// @param func - handler
@@ -210,6 +244,9 @@ protected:
 
 	std::vector<Handler> handlers_;
 	std::vector<Handler> middlewares_;
+	std::vector<bool> parallel_;
+	CallsExecutor *executor_ = nullptr;
+	bool coroutines_ = false;
 
 	std::function<void(Context &ctx, const Error &err, const Args &args)> logger_;
 	std::function<void(Context &ctx, const Error &err)> onClose_;
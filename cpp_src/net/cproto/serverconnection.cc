@@ -13,6 +13,14 @@ namespace cproto {
 const auto kCProtoTimeoutSec = 300.;
 const auto kUpdatesResendTimeout = 0.1;
 const auto kMaxUpdatesBufSize = 1024 * 1024 * 8;
+// Size of the single updates batch. Pending updates are flushed before the resend timeout, when this size is reached
+const size_t kUpdatesBatchSize = 64 * 1024;
+// Space, which is reserved at the beginning of the data chunk for the RPC header, status and the first argument's type and length
+const size_t kRPCDataReservedSize = sizeof(CProtoHeader) + 32;
+// Max count of the parallel calls of the single connection, which are executed at the same time
+const size_t kMaxParallelCalls = 64;
+// Stack size of the call's coroutine. Handlers with the deep recursion have to pass it to Context::Await
+const size_t kCallCoroStackSize = 256 * 1024;
 
 ServerConnection::ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &dispatcher, bool enableStat, size_t maxUpdatesSize)
 	: net::ConnectionST(fd, loop, enableStat),
@@ -23,11 +31,15 @@ ServerConnection::ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &d
 	timeout_.start(kCProtoTimeoutSec);
 	updates_async_.set<ServerConnection, &ServerConnection::async_cb>(this);
 	updates_timeout_.set<ServerConnection, &ServerConnection::timeout_cb>(this);
+	updates_timeout_.set_coarse(true);
 	updates_async_.set(loop);
 	updates_timeout_.set(loop);
 
 	updates_timeout_.start(kUpdatesResendTimeout, kUpdatesResendTimeout);
 	updates_async_.start();
+	parallel_async_.set<ServerConnection, &ServerConnection::parallel_cb>(this);
+	parallel_async_.set(loop);
+	parallel_async_.start();
 
 	callback(io_, ev::READ);
 }
@@ -36,6 +48,7 @@ ServerConnection::~ServerConnection() { closeConn(); }
 
 bool ServerConnection::Restart(int fd) {
 	restart(fd);
+	compressor_.Reset();
 	timeout_.start(kCProtoTimeoutSec);
 	updates_async_.start();
 	callback(io_, ev::READ);
@@ -51,20 +64,39 @@ void ServerConnection::Attach(ev::dynamic_loop &loop) {
 		updates_async_.start();
 		updates_timeout_.set(loop);
 		updates_timeout_.start(kUpdatesResendTimeout, kUpdatesResendTimeout);
+		parallel_async_.set(loop);
+		parallel_async_.start();
+		// Responses of the calls, which were completed while connection was detached
+		std::lock_guard<std::mutex> lck(parallelMtx_);
+		if (!parallelDone_.empty()) parallel_async_.send();
 	}
 }
 
 void ServerConnection::Detach() {
 	if (attached_) {
+		// Coroutines are bound to the current thread, so they have to be completed before the connection is moved to another one
+		drainCoroCalls();
+		// Executed calls are bound to the current loop via async watcher. Their responses will be sent after the next Attach()
+		waitParallelCalls();
 		detach();
 		updates_async_.stop();
 		updates_async_.reset();
 		updates_timeout_.stop();
 		updates_timeout_.reset();
+		parallel_async_.stop();
+		parallel_async_.reset();
 	}
 }
 
 void ServerConnection::onClose() {
+	// Calls may use client data, so they have to be completed first
+	drainCoroCalls();
+	waitParallelCalls();
+	{
+		std::lock_guard<std::mutex> lck(parallelMtx_);
+		parallelDone_.clear();
+		parallelInFlight_ = 0;
+	}
 	if (dispatcher_.onClose_) {
 		Context ctx{"", nullptr, this, {{}, {}}, false};
 		dispatcher_.onClose_(ctx, errOK);
@@ -84,10 +116,178 @@ void ServerConnection::handleRPC(Context &ctx) {
 	}
 }
 
+void ServerConnection::handleParallelRPC(Context &ctx) {
+	auto call = std::make_unique<ParallelCall>(*this, enableSnappy_);
+	call->call.cmd = ctx.call->cmd;
+	call->call.seq = ctx.call->seq;
+	call->call.execTimeout_ = ctx.call->execTimeout_;
+	// Arguments reference the read buffer, which will be reused before the call's completion
+	call->call.args = ctx.call->args;
+	for (auto &arg : call->call.args) arg.EnsureHold();
+	call->ctx = Context{ctx.clientAddr, &call->call, &call->writer, ctx.stat, false};
+
+	if (!parallelInFlight_++) {
+		// Connection is not idle, while its calls are executed
+		timeout_.stop();
+	}
+	dispatcher_.executor_->Execute([this, call = call.release()] { executeParallelRPC(std::unique_ptr<ParallelCall>(call)); });
+}
+
+void ServerConnection::executeParallelRPC(std::unique_ptr<ParallelCall> &&call) {
+	Context &ctx = call->ctx;
+	try {
+		Error err = dispatcher_.handle(ctx);
+		if (!ctx.respSent) {
+			ctx.writer->WriteRPCReturn(ctx, Args(), err);
+		}
+	} catch (const Error &err) {
+		// Exception occurs on unrecoverable error. Send responce, and drop connection
+		fprintf(stderr, "drop connect, reason: %s\n", err.what().c_str());
+		try {
+			if (!ctx.respSent) ctx.writer->WriteRPCReturn(ctx, Args(), err);
+		} catch (const Error &err) {
+			fprintf(stderr, "responceRPC unexpected error: %s", err.what().c_str());
+		}
+		call->dropConnection = true;
+	}
+
+	// Connection may be destroyed right after the unlock
+	std::lock_guard<std::mutex> lck(parallelMtx_);
+	parallelDone_.emplace_back(std::move(call));
+	parallel_async_.send();
+	parallelCond_.notify_all();
+}
+
+void ServerConnection::handleCoroRPC(Context &ctx, bool exclusive) {
+	auto call = std::make_unique<CoroCall>();
+	call->call.cmd = ctx.call->cmd;
+	call->call.seq = ctx.call->seq;
+	call->call.execTimeout_ = ctx.call->execTimeout_;
+	// Arguments reference the read buffer, which will be reused, while the coroutine is suspended
+	call->call.args = ctx.call->args;
+	for (auto &arg : call->call.args) arg.EnsureHold();
+	call->ctx = Context{ctx.clientAddr, &call->call, this, ctx.stat, false};
+
+	if (!parallelInFlight_ && !coroInFlight_) timeout_.stop();
+	++coroInFlight_;
+	exclusiveInFlight_ = exclusive;
+	auto id = coroutine::create([this, call = call.release()] { executeCoroRPC(std::unique_ptr<CoroCall>(call)); }, kCallCoroStackSize);
+	// Call is executed right away until its first Await()
+	coroutine::resume(id);
+}
+
+void ServerConnection::executeCoroRPC(std::unique_ptr<CoroCall> &&call) {
+	Context &ctx = call->ctx;
+	try {
+		handleRPC(ctx);
+	} catch (const Error &err) {
+		// Exception occurs on unrecoverable error. Send responce, and drop connection
+		fprintf(stderr, "drop connect, reason: %s\n", err.what().c_str());
+		try {
+			if (!ctx.respSent) responceRPC(ctx, err, Args());
+		} catch (const Error &err) {
+			fprintf(stderr, "responceRPC unexpected error: %s", err.what().c_str());
+		}
+		closeConn_ = true;
+	}
+	assertrx(coroInFlight_);
+	--coroInFlight_;
+	exclusiveInFlight_ = false;
+}
+
+void ServerConnection::Await(std::function<void()> task, CallsExecutor *executor) {
+	const auto id = coroutine::current();
+	if (!coroInFlight_ || !id || !dispatcher_.executor_) {
+		Writer::Await(std::move(task), executor);
+		return;
+	}
+
+	bool done = false;
+	std::exception_ptr ex;
+	(executor ? executor : dispatcher_.executor_)->Execute([this, id, &task, &done, &ex] {
+		try {
+			task();
+		} catch (...) {
+			ex = std::current_exception();
+		}
+		// Coroutine may be completed right after the unlock
+		std::lock_guard<std::mutex> lck(parallelMtx_);
+		done = true;
+		readyCoros_.emplace_back(id);
+		parallel_async_.send();
+		parallelCond_.notify_all();
+	});
+	for (;;) {
+		{
+			std::lock_guard<std::mutex> lck(parallelMtx_);
+			if (done) break;
+		}
+		coroutine::suspend();
+	}
+	if (ex) std::rethrow_exception(ex);
+}
+
+void ServerConnection::drainCoroCalls() {
+	// Suspended calls are resumed by the loop, so their tasks completion is awaited here
+	while (coroInFlight_) {
+		std::vector<coroutine::routine_t> ready;
+		{
+			std::unique_lock<std::mutex> lck(parallelMtx_);
+			parallelCond_.wait(lck, [this] { return !readyCoros_.empty(); });
+			ready.swap(readyCoros_);
+		}
+		for (auto id : ready) coroutine::resume(id);
+	}
+}
+
+void ServerConnection::parallel_cb(ev::async &) {
+	std::vector<std::unique_ptr<ParallelCall>> done;
+	std::vector<coroutine::routine_t> ready;
+	{
+		std::lock_guard<std::mutex> lck(parallelMtx_);
+		done.swap(parallelDone_);
+		ready.swap(readyCoros_);
+	}
+	if (done.empty() && ready.empty()) return;
+
+	for (auto id : ready) coroutine::resume(id);
+
+	for (auto &call : done) {
+		const size_t len = call->writer.response.size();
+		wrBuf_.write(std::move(call->writer.response));
+		if (ConnectionST::stats_) {
+			ConnectionST::stats_->update_send_buf_size(wrBuf_.data_size());
+			ConnectionST::stats_->update_compression_stats(call->writer.compressor.TakeStats());
+		}
+		if (dispatcher_.onResponse_) {
+			// Must be called from the connection's thread
+			call->ctx.writer = this;
+			call->ctx.stat.sizeStat.respSizeBytes = len;
+			dispatcher_.onResponse_(call->ctx);
+		}
+		if (call->dropConnection) closeConn_ = true;
+	}
+	assertrx(parallelInFlight_ >= done.size());
+	parallelInFlight_ -= done.size();
+	if (!parallelInFlight_ && !coroInFlight_) timeout_.start(kCProtoTimeoutSec);
+
+	if (readPaused_) {
+		// Handle calls, which are waiting for the completion of the parallel calls
+		readPaused_ = false;
+		onRead();
+	}
+	callback(io_, ev::WRITE);
+}
+
+void ServerConnection::waitParallelCalls() {
+	std::unique_lock<std::mutex> lck(parallelMtx_);
+	parallelCond_.wait(lck, [this] { return parallelDone_.size() >= parallelInFlight_; });
+}
+
 void ServerConnection::onRead() {
 	CProtoHeader hdr;
 
-	while (!closeConn_) {
+	while (!closeConn_ && !readPaused_) {
 		Context ctx{clientAddr_, nullptr, this, {{}, {}}, false};
 		std::string uncompressed;
 
@@ -128,6 +328,15 @@ void ServerConnection::onRead() {
 			return;
 		}
 
+		const bool parallel = dispatcher_.IsParallel(CmdCode(hdr.cmd));
+		const size_t inFlight = parallelInFlight_ + coroInFlight_;
+		if (inFlight && (!parallel || exclusiveInFlight_ || inFlight >= kMaxParallelCalls)) {
+			// Sequential call is handled after completion of the previous parallel calls, so the order of the modifications and
+			// the selects is preserved. Socket is not read until then
+			readPaused_ = true;
+			return;
+		}
+
 		rdBuf_.erase(sizeof(hdr));
 
 		auto it = rdBuf_.tail();
@@ -162,7 +371,11 @@ void ServerConnection::onRead() {
 				}
 			}
 
-			handleRPC(ctx);
+			if (dispatcher_.CoroutinesEnabled()) {
+				handleCoroRPC(ctx, !parallel);
+			} else {
+				parallel ? handleParallelRPC(ctx) : handleRPC(ctx);
+			}
 		} catch (const Error &err) {
 			// Exception occurs on unrecoverable error. Send responce, and drop connection
 			fprintf(stderr, "drop connect, reason: %s\n", err.what().c_str());
@@ -175,15 +388,17 @@ void ServerConnection::onRead() {
 		}
 
 		rdBuf_.erase(hdr.len);
-		timeout_.start(kCProtoTimeoutSec);
+		if (!parallelInFlight_ && !coroInFlight_) timeout_.start(kCProtoTimeoutSec);
 	}
 }
-static void packRPC(WrSerializer &ser, Context &ctx, const Error &status, const Args &args, bool enableSnappy) {
+// Message is compressed, if compressor is passed and it considers the message worth compressing
+static void packRPC(WrSerializer &ser, Context &ctx, const Error &status, const Args &args, AdaptiveCompressor *compressor,
+					bool forceCompression = false) {
 	CProtoHeader hdr;
 	hdr.len = 0;
 	hdr.magic = kCprotoMagic;
 	hdr.version = kCprotoVersion;
-	hdr.compressed = enableSnappy;
+	hdr.compressed = false;
 
 	if (ctx.call != nullptr) {
 		hdr.cmd = ctx.call->cmd;
@@ -200,12 +415,14 @@ static void packRPC(WrSerializer &ser, Context &ctx, const Error &status, const
 	ser.PutVString(status.what());
 	args.Pack(ser);
 
-	if (hdr.compressed) {
+	if (compressor) {
 		auto data = ser.Slice().substr(sizeof(hdr) + savePos);
 		std::string compressed;
-		snappy::Compress(data.data(), data.length(), &compressed);
-		ser.Reset(sizeof(hdr) + savePos);
-		ser.Write(compressed);
+		if (compressor->Compress(data, compressed, forceCompression)) {
+			ser.Reset(sizeof(hdr) + savePos);
+			ser.Write(compressed);
+			reinterpret_cast<CProtoHeader *>(ser.Buf() + savePos)->compressed = true;
+		}
 	}
 	if (ser.Len() - savePos >= size_t(std::numeric_limits<int32_t>::max())) {
 		throw Error(errNetwork, "Too large RPC message(%d), size: %d bytes", hdr.cmd, ser.Len());
@@ -213,9 +430,9 @@ static void packRPC(WrSerializer &ser, Context &ctx, const Error &status, const
 	reinterpret_cast<CProtoHeader *>(ser.Buf() + savePos)->len = ser.Len() - savePos - sizeof(hdr);
 }
 
-static chunk packRPC(chunk chunk, Context &ctx, const Error &status, const Args &args, bool enableSnappy) {
+static chunk packRPC(chunk chunk, Context &ctx, const Error &status, const Args &args, AdaptiveCompressor *compressor) {
 	WrSerializer ser(std::move(chunk));
-	packRPC(ser, ctx, status, args, enableSnappy);
+	packRPC(ser, ctx, status, args, compressor);
 	return ser.DetachChunk();
 }
 
@@ -225,10 +442,126 @@ void ServerConnection::responceRPC(Context &ctx, const Error &status, const Args
 		return;
 	}
 
-	auto &&chunk = packRPC(wrBuf_.get_chunk(), ctx, status, args, enableSnappy_);
+	auto &&chunk = packRPC(wrBuf_.get_chunk(), ctx, status, args, enableSnappy_ ? &compressor_ : nullptr);
 	auto len = chunk.len_;
 	wrBuf_.write(std::move(chunk));
-	if (ConnectionST::stats_) ConnectionST::stats_->update_send_buf_size(wrBuf_.data_size());
+	onResponceSent(ctx, status, args, len);
+}
+
+static chunk reserveDataChunk(chunk &&ch) {
+	if (!ch.data_ || ch.cap_ < kRPCDataReservedSize) {
+		ch = chunk();
+		ch.reserve(kRPCDataReservedSize);
+	}
+	ch.len_ = kRPCDataReservedSize;
+	ch.offset_ = 0;
+	return std::move(ch);
+}
+
+static std::string_view dataPayload(const chunk &data, size_t len) noexcept {
+	return std::string_view(reinterpret_cast<const char *>(data.data_) + kRPCDataReservedSize, len);
+}
+
+static Args argsWithData(const std::string_view &payload, const Args &args) {
+	Args fullArgs;
+	fullArgs.reserve(args.size() + 1);
+	fullArgs.emplace_back(p_string(&payload));
+	for (auto &arg : args) fullArgs.emplace_back(arg);
+	return fullArgs;
+}
+
+// Packs uncompressed RPC message in place of the data chunk: header and the first argument's prefix are placed right before the data,
+// the rest of the arguments are appended after it. Returns false, if the reserved space is not enough
+static bool packRPCInPlace(chunk &data, Context &ctx, const Error &status, const Args &args) {
+	assertrx(data.data_ && data.len_ >= kRPCDataReservedSize && data.offset_ == 0);
+	CProtoHeader hdr;
+	hdr.len = 0;
+	hdr.magic = kCprotoMagic;
+	hdr.version = kCprotoVersion;
+	hdr.compressed = false;
+	hdr.cmd = ctx.call ? ctx.call->cmd : 0;
+	hdr.seq = ctx.call ? ctx.call->seq : 0;
+
+	WrSerializer prefix;
+	prefix.Write(std::string_view(reinterpret_cast<char *>(&hdr), sizeof(hdr)));
+	prefix.PutVarUint(status.code());
+	prefix.PutVString(status.what());
+	prefix.PutVarUint(args.size() + 1);
+	prefix.PutVarUint(KeyValueString);
+	prefix.PutVarUint(data.len_ - kRPCDataReservedSize);
+	if (prefix.Len() > kRPCDataReservedSize) return false;
+
+	WrSerializer ser(std::move(data));
+	for (auto &arg : args) ser.PutVariant(arg);
+	data = ser.DetachChunk();
+	data.offset_ = kRPCDataReservedSize - prefix.Len();
+	memcpy(data.data_ + data.offset_, prefix.Buf(), prefix.Len());
+	if (data.size() >= size_t(std::numeric_limits<int32_t>::max())) {
+		throw Error(errNetwork, "Too large RPC message(%d), size: %d bytes", hdr.cmd, data.size());
+	}
+	reinterpret_cast<CProtoHeader *>(data.data())->len = data.size() - sizeof(hdr);
+	return true;
+}
+
+chunk ServerConnection::GetDataChunk() { return reserveDataChunk(wrBuf_.get_chunk()); }
+
+void ServerConnection::responceRPC(Context &ctx, const Error &status, chunk &&data, const Args &args) {
+	if (ctx.respSent) {
+		fprintf(stderr, "Warning - RPC responce already sent\n");
+		return;
+	}
+
+	const size_t payloadLen = data.len_ - kRPCDataReservedSize;
+	if ((enableSnappy_ && compressor_.MayCompress(payloadLen)) || !packRPCInPlace(data, ctx, status, args)) {
+		// Compressed response or response with the long error message can not be built in place
+		responceRPC(ctx, status, argsWithData(dataPayload(data, payloadLen), args));
+		return;
+	}
+	const size_t len = data.size();
+	if (enableSnappy_) compressor_.AddUncompressed(len - sizeof(CProtoHeader));
+	if (dispatcher_.logger_) {
+		const auto fullArgs = argsWithData(dataPayload(data, payloadLen), args);
+		wrBuf_.write(std::move(data));
+		onResponceSent(ctx, status, fullArgs, len);
+	} else {
+		wrBuf_.write(std::move(data));
+		onResponceSent(ctx, status, args, len);
+	}
+}
+
+void ServerConnection::ParallelCallWriter::WriteRPCReturn(Context &ctx, const Args &args, const Error &status) {
+	if (ctx.respSent) {
+		fprintf(stderr, "Warning - RPC responce already sent\n");
+		return;
+	}
+	response = packRPC(chunk(), ctx, status, args, enableSnappy_ ? &compressor : nullptr);
+	ctx.respSent = true;
+	if (owner_.dispatcher_.logger_) owner_.dispatcher_.logger_(ctx, status, args);
+}
+
+chunk ServerConnection::ParallelCallWriter::GetDataChunk() { return reserveDataChunk(chunk()); }
+
+void ServerConnection::ParallelCallWriter::WriteRPCReturn(Context &ctx, chunk &&data, const Args &args, const Error &status) {
+	if (ctx.respSent) {
+		fprintf(stderr, "Warning - RPC responce already sent\n");
+		return;
+	}
+	const size_t payloadLen = data.len_ - kRPCDataReservedSize;
+	if ((enableSnappy_ && compressor.MayCompress(payloadLen)) || !packRPCInPlace(data, ctx, status, args)) {
+		WriteRPCReturn(ctx, argsWithData(dataPayload(data, payloadLen), args), status);
+		return;
+	}
+	if (enableSnappy_) compressor.AddUncompressed(data.size() - sizeof(CProtoHeader));
+	response = std::move(data);
+	ctx.respSent = true;
+	if (owner_.dispatcher_.logger_) owner_.dispatcher_.logger_(ctx, status, argsWithData(dataPayload(response, payloadLen), args));
+}
+
+void ServerConnection::onResponceSent(Context &ctx, const Error &status, const Args &args, size_t len) {
+	if (ConnectionST::stats_) {
+		ConnectionST::stats_->update_send_buf_size(wrBuf_.data_size());
+		if (enableSnappy_) ConnectionST::stats_->update_compression_stats(compressor_.TakeStats());
+	}
 
 	if (dispatcher_.onResponse_) {
 		ctx.stat.sizeStat.respSizeBytes = len;
@@ -284,6 +617,9 @@ void ServerConnection::CallRPC(const IRPCCall &call) {
 	}
 	updates_.emplace_back(call);
 	updatesSize_ += call.data_->size();
+	if (batchUpdates_.load(std::memory_order_relaxed) && updatesSize_ >= kUpdatesBatchSize) {
+		updates_async_.send();
+	}
 
 	if (ConnectionST::stats_) {
 		auto stat = ConnectionST::stats_->get_stat();
@@ -303,21 +639,42 @@ void ServerConnection::sendUpdates() {
 	updates.swap(updates_);
 	updateLostFlag_ = false;
 	updates_mtx_.unlock();
-	RPCCall callUpdate{kCmdUpdates, 0, {}, milliseconds(0)};
+	const bool batchUpdates = batchUpdates_.load(std::memory_order_relaxed);
+	RPCCall callUpdate{batchUpdates ? kCmdUpdatesBatch : kCmdUpdates, 0, {}, milliseconds(0)};
 	cproto::Context ctx{"", &callUpdate, this, {{}, {}}, false};
 	size_t len = 0;
 	Args args;
 	CmdCode cmd;
 	WrSerializer ser(wrBuf_.get_chunk());
+	// Batch is the sequence of the packed args of the single updates. It's always compressed, because the subscriber, which
+	// requested batching, is able to decompress it, and the similar neighbour records give much better compression ratio
+	WrSerializer batch, packedArgs;
+	auto flushBatch = [&] {
+		const std::string_view batchData = batch.Slice();
+		packRPC(ser, ctx, Error(), {Arg(p_string(&batchData))}, &compressor_, true);
+		batch.Reset();
+	};
 	size_t cnt = 0;
-	for (cnt = 0; cnt < updates.size() && ser.Len() < kMaxUpdatesBufSize; ++cnt) {
+	for (cnt = 0; cnt < updates.size() && ser.Len() + batch.Len() < kMaxUpdatesBufSize; ++cnt) {
 		if (updates[cnt].data_) {
 			if (!updateLostFlag_) {
 				updatesSize_ -= updates[cnt].data_->size();
 			}
 		}
 		updates[cnt].Get(&updates[cnt], cmd, args);
-		packRPC(ser, ctx, Error(), args, enableSnappy_);
+		if (batchUpdates) {
+			packedArgs.Reset();
+			args.Pack(packedArgs);
+			batch.PutVString(packedArgs.Slice());
+			if (batch.Len() >= kUpdatesBatchSize) {
+				flushBatch();
+			}
+		} else {
+			packRPC(ser, ctx, Error(), args, enableSnappy_ ? &compressor_ : nullptr);
+		}
+	}
+	if (batch.Len()) {
+		flushBatch();
 	}
 
 	if (cnt != updates.size()) {
@@ -337,7 +694,10 @@ void ServerConnection::sendUpdates() {
 
 	len = ser.Len();
 	wrBuf_.write(ser.DetachChunk());
-	if (ConnectionST::stats_) ConnectionST::stats_->update_send_buf_size(wrBuf_.data_size());
+	if (ConnectionST::stats_) {
+		ConnectionST::stats_->update_send_buf_size(wrBuf_.data_size());
+		ConnectionST::stats_->update_compression_stats(compressor_.TakeStats());
+	}
 
 	if (dispatcher_.onResponse_) {
 		ctx.stat.sizeStat.respSizeBytes = len;
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string.h>
+#include <condition_variable>
+#include "compressor.h"
+#include "coroutine/coroutine.h"
 #include "dispatcher.h"
 #include "estl/atomic_unique_ptr.h"
 #include "net/connection.h"
@@ -32,18 +35,68 @@ public:
 
 	// Writer iterface implementation
 	void WriteRPCReturn(Context &ctx, const Args &args, const Error &status) override final { responceRPC(ctx, status, args); }
+	chunk GetDataChunk() override final;
+	void WriteRPCReturn(Context &ctx, chunk &&data, const Args &args, const Error &status) override final {
+		responceRPC(ctx, status, std::move(data), args);
+	}
 	void CallRPC(const IRPCCall &call) override final;
+	void SetUpdatesBatching(bool enable) override final { batchUpdates_.store(enable, std::memory_order_relaxed); }
 	void SetClientData(std::unique_ptr<ClientData> data) override final { clientData_ = std::move(data); }
 	ClientData *GetClientData() override final { return clientData_.get(); }
 	std::shared_ptr<connection_stat> GetConnectionStat() override final {
 		return ConnectionST::stats_ ? ConnectionST::stats_->get_stat() : std::shared_ptr<connection_stat>();
 	}
+	void Await(std::function<void()> task, CallsExecutor *executor) override final;
 
 protected:
+	// Writer of the call, which is executed by the dispatcher's executor. Packed response is passed to the connection's thread
+	class ParallelCallWriter : public Writer {
+	public:
+		ParallelCallWriter(ServerConnection &owner, bool enableSnappy) noexcept : owner_(owner), enableSnappy_(enableSnappy) {}
+
+		void WriteRPCReturn(Context &ctx, const Args &args, const Error &status) override final;
+		chunk GetDataChunk() override final;
+		void WriteRPCReturn(Context &ctx, chunk &&data, const Args &args, const Error &status) override final;
+		void CallRPC(const IRPCCall &call) override final { owner_.CallRPC(call); }
+		void SetUpdatesBatching(bool enable) override final { owner_.SetUpdatesBatching(enable); }
+		void SetClientData(std::unique_ptr<ClientData> data) override final { owner_.SetClientData(std::move(data)); }
+		ClientData *GetClientData() override final { return owner_.GetClientData(); }
+		std::shared_ptr<connection_stat> GetConnectionStat() override final { return owner_.GetConnectionStat(); }
+
+		chunk response;
+		AdaptiveCompressor compressor;
+
+	private:
+		ServerConnection &owner_;
+		const bool enableSnappy_;
+	};
+	struct ParallelCall {
+		ParallelCall(ServerConnection &owner, bool enableSnappy) : writer(owner, enableSnappy) {}
+
+		RPCCall call;
+		Context ctx;
+		ParallelCallWriter writer;
+		bool dropConnection = false;
+	};
+	// Call, which is handled as a coroutine in the connection's thread
+	struct CoroCall {
+		RPCCall call;
+		Context ctx;
+	};
+
 	void onRead() override;
 	void onClose() override;
 	void handleRPC(Context &ctx);
+	void handleParallelRPC(Context &ctx);
+	void executeParallelRPC(std::unique_ptr<ParallelCall> &&call);
+	void parallel_cb(ev::async &);
+	void waitParallelCalls();
+	void handleCoroRPC(Context &ctx, bool exclusive);
+	void executeCoroRPC(std::unique_ptr<CoroCall> &&call);
+	void drainCoroCalls();
 	void responceRPC(Context &ctx, const Error &error, const Args &args);
+	void responceRPC(Context &ctx, const Error &error, chunk &&data, const Args &args);
+	void onResponceSent(Context &ctx, const Error &status, const Args &args, size_t len);
 	void async_cb(ev::async &) { sendUpdates(); }
 	void timeout_cb(ev::periodic &, int) { sendUpdates(); }
 	void sendUpdates();
@@ -56,12 +109,26 @@ protected:
 	std::vector<IRPCCall> updates_;
 	std::atomic<size_t> updatesSize_;
 	std::atomic<bool> updateLostFlag_;
+	std::atomic<bool> batchUpdates_ = {false};
 	const size_t maxUpdatesSize_;
 	std::mutex updates_mtx_;
 
 	ev::periodic updates_timeout_;
 	ev::async updates_async_;
-	bool enableSnappy_;
+	bool enableSnappy_ = false;
+	AdaptiveCompressor compressor_;
+
+	// Completed parallel calls, which responses are not sent yet
+	std::vector<std::unique_ptr<ParallelCall>> parallelDone_;
+	size_t parallelInFlight_ = 0;
+	std::mutex parallelMtx_;
+	std::condition_variable parallelCond_;
+	ev::async parallel_async_;
+	// Coroutines of the calls, which tasks were completed by the executor, and which have to be resumed
+	std::vector<coroutine::routine_t> readyCoros_;
+	size_t coroInFlight_ = 0;
+	// Sequential call is handled as a coroutine. The other calls are not read until its completion
+	bool exclusiveInFlight_ = false;
 };
 }  // namespace cproto
 }  // namespace net
@@ -17,6 +17,18 @@
 #ifdef HAVE_EPOLL_LOOP
 #include <sys/epoll.h>
 #endif
+#ifdef HAVE_URING_LOOP
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdlib>
+// Waiting with timeout without the dedicated timeout requests requires IORING_ENTER_EXT_ARG (linux 5.11+)
+#if defined(IORING_FEAT_EXT_ARG) && defined(IORING_FEAT_NODROP) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define HAVE_URING_EXT_ARG 1
+#endif
+#endif
 
 namespace reindexer {
 namespace net {
@@ -291,6 +303,303 @@ int loop_epoll_backend::runonce(int64_t t) {
 
 #endif
 
+#ifdef HAVE_URING_LOOP
+#ifdef HAVE_URING_EXT_ARG
+class loop_uring_backend_private {
+public:
+	struct fd_state {
+		uint32_t gen = 0;
+		int events = 0;
+		// There is the poll request in the ring for this fd
+		bool armed = false;
+	};
+
+	static constexpr unsigned kEntries = 1024;
+	static constexpr uint64_t kRemoveUserData = ~uint64_t(0);
+
+	~loop_uring_backend_private() { close(); }
+
+	bool open(unsigned entries) {
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+		ringfd_ = syscall(__NR_io_uring_setup, entries, &params);
+		if (ringfd_ < 0) return false;
+		if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP)) {
+			close();
+			return false;
+		}
+
+		sqSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cqSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (singleMmap) sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+		sqPtr_ = mmap(nullptr, sqSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQ_RING);
+		if (sqPtr_ == MAP_FAILED) {
+			sqPtr_ = nullptr;
+			close();
+			return false;
+		}
+		if (singleMmap) {
+			cqPtr_ = sqPtr_;
+		} else {
+			cqPtr_ = mmap(nullptr, cqSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_CQ_RING);
+			if (cqPtr_ == MAP_FAILED) {
+				cqPtr_ = nullptr;
+				close();
+				return false;
+			}
+		}
+		sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+		void *sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd_, IORING_OFF_SQES);
+		if (sqes == MAP_FAILED) {
+			close();
+			return false;
+		}
+		sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+		auto sq = static_cast<char *>(sqPtr_);
+		sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+		sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+		sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+		sqEntries_ = params.sq_entries;
+		auto sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+		// Submission queue entries are always placed in the same slots of the array
+		for (unsigned i = 0; i < sqEntries_; ++i) sqArray[i] = i;
+		sqTailLocal_ = *sqTail_;
+
+		auto cq = static_cast<char *>(cqPtr_);
+		cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+		cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+		cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+		cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+		completions_.reserve(params.cq_entries);
+		return true;
+	}
+
+	void close() {
+		if (sqes_) munmap(sqes_, sqesSize_);
+		if (cqPtr_ && cqPtr_ != sqPtr_) munmap(cqPtr_, cqSize_);
+		if (sqPtr_) munmap(sqPtr_, sqSize_);
+		sqes_ = nullptr;
+		cqPtr_ = sqPtr_ = nullptr;
+		if (ringfd_ >= 0) ::close(ringfd_);
+		ringfd_ = -1;
+	}
+
+	bool opened() const noexcept { return ringfd_ >= 0; }
+
+	int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, const void *arg, size_t argSize) {
+		return syscall(__NR_io_uring_enter, ringfd_, toSubmit, minComplete, flags, arg, argSize);
+	}
+
+	unsigned pending() const noexcept { return sqTailLocal_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE); }
+
+	io_uring_sqe *get_sqe() {
+		if (pending() >= sqEntries_) {
+			// Submission queue is full, so the requests are submitted without waiting for the completions
+			__atomic_store_n(sqTail_, sqTailLocal_, __ATOMIC_RELEASE);
+			if (enter(pending(), 0, 0, nullptr, 0) < 0) {
+				perror("io_uring_enter");
+			}
+		}
+		io_uring_sqe *sqe = &sqes_[sqTailLocal_ & sqMask_];
+		++sqTailLocal_;
+		memset(sqe, 0, sizeof(*sqe));
+		return sqe;
+	}
+
+	void queue_poll_add(int fd, int events, uint64_t userData) {
+		io_uring_sqe *sqe = get_sqe();
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->fd = fd;
+		sqe->poll32_events = ((events & READ) ? POLLIN : 0) | ((events & WRITE) ? POLLOUT : 0);
+		sqe->user_data = userData;
+	}
+
+	void queue_poll_remove(uint64_t targetUserData) {
+		io_uring_sqe *sqe = get_sqe();
+		sqe->opcode = IORING_OP_POLL_REMOVE;
+		sqe->fd = -1;
+		sqe->addr = targetUserData;
+		sqe->user_data = kRemoveUserData;
+	}
+
+	void arm(int fd) {
+		fd_state &st = fds_[fd];
+		queue_poll_add(fd, st.events, user_data(fd, st.gen));
+		st.armed = true;
+	}
+
+	void disarm(int fd) {
+		fd_state &st = fds_[fd];
+		if (st.armed) {
+			queue_poll_remove(user_data(fd, st.gen));
+			st.armed = false;
+		}
+		// Completions of the previous requests are ignored
+		++st.gen;
+	}
+
+	int wait(int64_t t) {
+		__atomic_store_n(sqTail_, sqTailLocal_, __ATOMIC_RELEASE);
+		io_uring_getevents_arg arg;
+		memset(&arg, 0, sizeof(arg));
+		__kernel_timespec ts;
+		if (t != -1) {
+			ts.tv_sec = t / 1000000;
+			ts.tv_nsec = (t % 1000000) * 1000;
+			arg.ts = reinterpret_cast<uint64_t>(&ts);
+		}
+		int ret = enter(pending(), 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+		if (ret < 0 && errno != ETIME && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+			return ret;
+		}
+
+		completions_.clear();
+		unsigned head = *cqHead_;
+		const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+		for (; head != tail; ++head) {
+			completions_.emplace_back(cqes_[head & cqMask_]);
+		}
+		__atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+		return completions_.size();
+	}
+
+	static uint64_t user_data(int fd, uint32_t gen) noexcept { return (uint64_t(unsigned(fd)) << 32) | gen; }
+
+	int ringfd_ = -1;
+	void *sqPtr_ = nullptr, *cqPtr_ = nullptr;
+	size_t sqSize_ = 0, cqSize_ = 0, sqesSize_ = 0;
+	io_uring_sqe *sqes_ = nullptr;
+	unsigned *sqHead_ = nullptr, *sqTail_ = nullptr;
+	unsigned sqMask_ = 0, sqEntries_ = 0, sqTailLocal_ = 0;
+	unsigned *cqHead_ = nullptr, *cqTail_ = nullptr;
+	unsigned cqMask_ = 0;
+	io_uring_cqe *cqes_ = nullptr;
+	std::vector<fd_state> fds_;
+	std::vector<io_uring_cqe> completions_;
+};
+#else	// HAVE_URING_EXT_ARG
+class loop_uring_backend_private {
+public:
+	struct fd_state {
+		uint32_t gen = 0;
+		int events = 0;
+		bool armed = false;
+	};
+
+	static constexpr unsigned kEntries = 0;
+	static constexpr uint64_t kRemoveUserData = ~uint64_t(0);
+
+	bool open(unsigned) { return false; }
+	bool opened() const noexcept { return false; }
+	void arm(int) {}
+	void disarm(int) {}
+	int wait(int64_t) { return -1; }
+
+	std::vector<fd_state> fds_;
+	std::vector<io_uring_cqe> completions_;
+};
+#endif	// HAVE_URING_EXT_ARG
+
+loop_uring_backend::loop_uring_backend() : private_(new loop_uring_backend_private) {}
+loop_uring_backend::~loop_uring_backend() {}
+
+void loop_uring_backend::init(dynamic_loop *owner) {
+	owner_ = owner;
+	const char *env = std::getenv("REINDEXER_IO_URING");
+	const bool enable = env && strcmp(env, "0") != 0;
+	if (enable && supported() && private_->open(loop_uring_backend_private::kEntries)) {
+		private_->fds_.reserve(2048);
+		return;
+	}
+	epoll_.init(owner);
+}
+
+void loop_uring_backend::set(int fd, int events, int oldevents) {
+	if (!private_->opened()) {
+		epoll_.set(fd, events, oldevents);
+		return;
+	}
+	auto &fds = private_->fds_;
+	if (fd >= int(fds.size())) fds.resize(fd + 1);
+	if (fds[fd].armed && fds[fd].events == events) return;
+	private_->disarm(fd);
+	fds[fd].events = events;
+	if (events) private_->arm(fd);
+}
+
+void loop_uring_backend::stop(int fd) {
+	if (!private_->opened()) {
+		epoll_.stop(fd);
+		return;
+	}
+	if (fd >= int(private_->fds_.size())) return;
+	private_->disarm(fd);
+	private_->fds_[fd].events = 0;
+}
+
+int loop_uring_backend::runonce(int64_t t) {
+	if (!private_->opened()) return epoll_.runonce(t);
+
+	int ret = private_->wait(t);
+	if (ret <= 0) return ret;
+
+	for (auto &cqe : private_->completions_) {
+		if (cqe.user_data == loop_uring_backend_private::kRemoveUserData) continue;
+		const int fd = int(cqe.user_data >> 32);
+		const uint32_t gen = uint32_t(cqe.user_data);
+		auto &fds = private_->fds_;
+		if (fd >= int(fds.size()) || fds[fd].gen != gen) continue;
+		// Poll requests are one-shot, so the level-triggered semantics of the other backends is kept
+		fds[fd].armed = false;
+		int events = 0;
+		if (cqe.res < 0) {
+			if (cqe.res == -ECANCELED) continue;
+			// Error will be reported by the following read
+			events = READ;
+		} else {
+			events = ((cqe.res & (POLLIN | POLLHUP | POLLERR)) ? READ : 0) | ((cqe.res & POLLOUT) ? WRITE : 0);
+		}
+		if (events && !check_async(fd)) owner_->io_callback(fd, events);
+		// Watcher may be updated or stopped by the callback
+		if (fd < int(fds.size()) && fds[fd].gen == gen && !fds[fd].armed && fds[fd].events) {
+			private_->arm(fd);
+		}
+	}
+	return ret;
+}
+
+void loop_uring_backend::enable_asyncs() {
+	if (private_->opened()) {
+		loop_posix_base::enable_asyncs();
+	} else {
+		epoll_.enable_asyncs();
+	}
+}
+
+void loop_uring_backend::send_async() {
+	if (private_->opened()) {
+		loop_posix_base::send_async();
+	} else {
+		epoll_.send_async();
+	}
+}
+
+bool loop_uring_backend::uring_enabled() const noexcept { return private_->opened(); }
+
+int loop_uring_backend::capacity() { return 500000; }
+
+bool loop_uring_backend::supported() {
+	static const bool supported = [] {
+		loop_uring_backend_private ring;
+		return ring.open(2);
+	}();
+	return supported;
+}
+
+#endif	// HAVE_URING_LOOP
+
 #ifdef HAVE_WSA_LOOP
 struct win_fd {
 	HANDLE hEvent = INVALID_HANDLE_VALUE;
@@ -461,8 +770,10 @@ void dynamic_loop::run() {
 
 		int tv = gEnableBusyLoop ? 0 : -1;
 
-		if (!gEnableBusyLoop && timers_.size()) {
-			tv = std::chrono::duration_cast<std::chrono::microseconds>(timers_.front()->deadline_ - now).count();
+		if (!gEnableBusyLoop && (timers_.size() || !coarse_timers_.empty())) {
+			auto deadline = coarse_timers_.empty() ? timers_.front()->deadline_ : coarse_timers_.next_expiration();
+			if (timers_.size()) deadline = std::min(deadline, timers_.front()->deadline_);
+			tv = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
 			if (tv < 0) tv = 0;
 		}
 		int ret = backend_.runonce(tv);
@@ -481,7 +792,7 @@ void dynamic_loop::run() {
 				fprintf(stderr, "Unexpected signals %08X", pendingSignalsMask);
 			}
 		}
-		if (ret >= 0 && timers_.size()) {
+		if (ret >= 0 && (timers_.size() || !coarse_timers_.empty())) {
 			if (!gEnableBusyLoop || !(++count % 100)) {
 				now = std::chrono::steady_clock::now();
 			}
@@ -490,6 +801,9 @@ void dynamic_loop::run() {
 				timers_.erase(timers_.begin());
 				tim->callback(1);
 			}
+			if (!coarse_timers_.empty()) {
+				coarse_timers_.expire(now);
+			}
 		}
 	}
 	remove_coro_cb();
@@ -519,19 +833,24 @@ void dynamic_loop::stop(int fd) {
 }
 
 void dynamic_loop::set(timer *watcher, double t) {
-	auto it = std::find(timers_.begin(), timers_.end(), watcher);
-	if (it != timers_.end()) {
-		timers_.erase(it);
-	}
+	stop(watcher);
 
 	watcher->deadline_ = std::chrono::steady_clock::now();
 	watcher->deadline_ += std::chrono::duration<int64_t, std::ratio<1, 1000000>>(int64_t(t * 1000000));
-	it = std::lower_bound(timers_.begin(), timers_.end(), watcher,
-						  [](const timer *lhs, const timer *rhs) { return lhs->deadline_ < rhs->deadline_; });
+	if (watcher->coarse_) {
+		coarse_timers_.add(watcher);
+		return;
+	}
+	auto it = std::lower_bound(timers_.begin(), timers_.end(), watcher,
+							   [](const timer *lhs, const timer *rhs) { return lhs->deadline_ < rhs->deadline_; });
 	timers_.insert(it, watcher);
 }
 
 void dynamic_loop::stop(timer *watcher) {
+	if (watcher->coarse_) {
+		coarse_timers_.remove(watcher);
+		return;
+	}
 	auto it = std::find(timers_.begin(), timers_.end(), watcher);
 	if (it != timers_.end()) {
 		timers_.erase(it);
@@ -606,9 +925,100 @@ void dynamic_loop::send(async *watcher) {
 }
 
 bool dynamic_loop::is_active(const timer *watcher) const noexcept {
+	if (watcher->coarse_) {
+		return watcher->wheel_slot_ >= 0;
+	}
 	return std::find(timers_.begin(), timers_.end(), watcher) != timers_.end();
 }
 
+uint64_t timer_wheel::floor_tick(clock::time_point tp) noexcept {
+	constexpr auto kResolutionTicks = std::chrono::duration_cast<clock::duration>(kResolution).count();
+	return uint64_t(tp.time_since_epoch().count()) / kResolutionTicks;
+}
+
+uint64_t timer_wheel::ceil_tick(clock::time_point tp) noexcept {
+	constexpr auto kResolutionTicks = std::chrono::duration_cast<clock::duration>(kResolution).count();
+	return (uint64_t(tp.time_since_epoch().count()) + kResolutionTicks - 1) / kResolutionTicks;
+}
+
+void timer_wheel::add(timer *watcher) {
+	assertrx(watcher->wheel_slot_ < 0);
+	if (!size_) {
+		// There are no timers to fire on the skipped ticks
+		cur_ = std::max(cur_, floor_tick(clock::now()));
+	}
+	schedule(watcher);
+}
+
+void timer_wheel::schedule(timer *watcher) noexcept {
+	const uint64_t tick = std::max(ceil_tick(watcher->deadline_), cur_ + 1);
+	if (tick - cur_ <= kNearSlots) {
+		link(watcher, tick & (kNearSlots - 1));
+	} else {
+		const uint64_t turn = std::min(tick >> kNearBits, (cur_ >> kNearBits) + kFarSlots - 1);
+		link(watcher, kNearSlots + (turn & (kFarSlots - 1)));
+	}
+}
+
+void timer_wheel::link(timer *watcher, int slot) noexcept {
+	watcher->wheel_slot_ = slot;
+	watcher->wheel_prev_ = nullptr;
+	watcher->wheel_next_ = slots_[slot];
+	if (slots_[slot]) slots_[slot]->wheel_prev_ = watcher;
+	slots_[slot] = watcher;
+	++size_;
+}
+
+void timer_wheel::remove(timer *watcher) noexcept {
+	if (watcher->wheel_slot_ < 0) return;
+	if (watcher->wheel_prev_) {
+		watcher->wheel_prev_->wheel_next_ = watcher->wheel_next_;
+	} else {
+		slots_[watcher->wheel_slot_] = watcher->wheel_next_;
+	}
+	if (watcher->wheel_next_) watcher->wheel_next_->wheel_prev_ = watcher->wheel_prev_;
+	watcher->wheel_slot_ = -1;
+	watcher->wheel_prev_ = watcher->wheel_next_ = nullptr;
+	--size_;
+}
+
+timer_wheel::clock::time_point timer_wheel::next_expiration() const noexcept {
+	// Far slot is cascaded at the start of the next near wheel turn, so there is no need to look further
+	const uint64_t turnEnd = (cur_ | (kNearSlots - 1)) + 1;
+	uint64_t tick = cur_ + 1;
+	while (tick < turnEnd && !slots_[tick & (kNearSlots - 1)]) ++tick;
+	return clock::time_point(std::chrono::duration_cast<clock::duration>(kResolution * int64_t(tick)));
+}
+
+void timer_wheel::expire(clock::time_point now) {
+	const uint64_t target = floor_tick(now);
+	while (cur_ < target) {
+		if (!size_) {
+			cur_ = target;
+			break;
+		}
+		const uint64_t tick = cur_ + 1;
+		if (!(tick & (kNearSlots - 1))) {
+			// Cascade the timers of the far slot of the new turn to the near slots
+			const int farSlot = kNearSlots + ((tick >> kNearBits) & (kFarSlots - 1));
+			while (timer *watcher = slots_[farSlot]) {
+				remove(watcher);
+				schedule(watcher);
+			}
+		}
+		cur_ = tick;
+
+		// Expired timers are moved to the separate list, so the timers, which are restarted by the callbacks, are not fired twice
+		timer *expired = std::exchange(slots_[tick & (kNearSlots - 1)], nullptr);
+		for (timer *watcher = expired; watcher; watcher = watcher->wheel_next_) watcher->wheel_slot_ = kExpiredSlot;
+		slots_[kExpiredSlot] = expired;
+		while (timer *watcher = slots_[kExpiredSlot]) {
+			remove(watcher);
+			watcher->callback(1);
+		}
+	}
+}
+
 void dynamic_loop::io_callback(int fd, int events) {
 	if ((fd < 0) || (fd > int(fds_.size()))) {
 		return;
@@ -634,7 +1044,8 @@ void dynamic_loop::async_callback() {
 void dynamic_loop::set_coro_cb() {
 	[[maybe_unused]] bool res = coroutine::set_loop_completion_callback([this](coroutine::routine_t id) {
 		auto found = std::find(running_tasks_.begin(), running_tasks_.end(), id);
-		assertrx(found != running_tasks_.end());
+		// Coroutines, which were not spawned by the loop (i.e. calls of the server connections), are not tracked
+		if (found == running_tasks_.end()) return;
 		running_tasks_.erase(found);
 		if (new_tasks_.empty() && running_tasks_.empty()) {
 			coroTid_ = std::thread::id();
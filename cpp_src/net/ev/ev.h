@@ -24,6 +24,11 @@
 #ifdef __linux__
 #define HAVE_EPOLL_LOOP 1
 #define HAVE_EVENT_FD 1
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_URING_LOOP 1
+#endif
+#endif
 #elif defined(__APPLE__) || (defined __unix__)
 #define HAVE_POLL_LOOP 1
 #endif
@@ -118,6 +123,31 @@ protected:
 };
 #endif
 
+#ifdef HAVE_URING_LOOP
+class loop_uring_backend_private;
+/// Readiness notifications via io_uring poll requests. All of the poll (re)arming requests of the loop iteration are submitted by the
+/// single io_uring_enter() call, which also waits for the completions, so there are no dedicated syscalls for the watchers updates.
+/// Enabled by REINDEXER_IO_URING=1 environment variable. Falls back to epoll, if io_uring is not supported by the kernel
+class loop_uring_backend : public loop_posix_base {
+public:
+	loop_uring_backend();
+	~loop_uring_backend();
+	void init(dynamic_loop *owner);
+	void set(int fd, int events, int oldevents);
+	void stop(int fd);
+	int runonce(int64_t tv);
+	void enable_asyncs();
+	void send_async();
+	bool uring_enabled() const noexcept;
+	static int capacity();
+	static bool supported();
+
+protected:
+	std::unique_ptr<loop_uring_backend_private> private_;
+	loop_epoll_backend epoll_;
+};
+#endif
+
 #ifdef HAVE_WSA_LOOP
 class loop_wsa_backend_private;
 class loop_wsa_backend {
@@ -143,9 +173,55 @@ class io;
 class timer;
 class async;
 class sig;
+
+/// Hierarchical timing wheel for the coarse timers (idle and keep-alive timeouts of the connections, periodic expiration checks).
+/// Timers are started and stopped in O(1) regardless of the count of the active timers, but are fired with the kResolution
+/// accuracy (never earlier, than their deadlines)
+class timer_wheel {
+public:
+	using clock = std::chrono::steady_clock;
+	static constexpr std::chrono::milliseconds kResolution{100};
+	static constexpr unsigned kNearBits = 8;
+	static constexpr unsigned kFarBits = 6;
+	// Near slots cover ~25 seconds with the kResolution accuracy
+	static constexpr size_t kNearSlots = size_t(1) << kNearBits;
+	// Far slots cover ~27 minutes with the accuracy of the near wheel turn. Longer timers are rescheduled after this interval
+	static constexpr size_t kFarSlots = size_t(1) << kFarBits;
+
+	timer_wheel() = default;
+	timer_wheel(const timer_wheel &) = delete;
+	timer_wheel &operator=(const timer_wheel &) = delete;
+
+	/// Add timer with the deadline, which is already set
+	void add(timer *watcher);
+	/// Remove timer. Does nothing, if timer is not active
+	void remove(timer *watcher) noexcept;
+	bool empty() const noexcept { return !size_; }
+	size_t size() const noexcept { return size_; }
+	/// @returns Time point of the next tick, which may expire some of the timers
+	clock::time_point next_expiration() const noexcept;
+	/// Fire all the timers with the deadlines before 'now'
+	void expire(clock::time_point now);
+
+private:
+	static constexpr int kExpiredSlot = kNearSlots + kFarSlots;
+
+	static uint64_t floor_tick(clock::time_point tp) noexcept;
+	static uint64_t ceil_tick(clock::time_point tp) noexcept;
+	void schedule(timer *watcher) noexcept;
+	void link(timer *watcher, int slot) noexcept;
+
+	// Near and far slots and the list of the timers, which are expired on the current tick
+	timer *slots_[kNearSlots + kFarSlots + 1] = {};
+	// Last processed tick
+	uint64_t cur_ = 0;
+	size_t size_ = 0;
+};
+
 class dynamic_loop {
 	friend class loop_ref;
 	friend class loop_epoll_backend;
+	friend class loop_uring_backend;
 	friend class loop_poll_backend;
 	friend class loop_select_backend;
 	friend class loop_wsa_backend;
@@ -198,6 +274,7 @@ protected:
 
 	std::vector<fd_handler> fds_;
 	std::vector<timer *> timers_;
+	timer_wheel coarse_timers_;
 	std::vector<async *> asyncs_;
 	std::vector<sig *> sigs_;
 	bool break_ = false;
@@ -209,7 +286,9 @@ protected:
 	tasks_container running_tasks_;
 	std::thread::id coroTid_;
 
-#ifdef HAVE_EPOLL_LOOP
+#ifdef HAVE_URING_LOOP
+	loop_uring_backend backend_;
+#elif defined(HAVE_EPOLL_LOOP)
 	loop_epoll_backend backend_;
 #elif defined(HAVE_POLL_LOOP)
 	loop_poll_backend backend_;
@@ -298,6 +377,7 @@ protected:
 };
 class timer {
 	friend class dynamic_loop;
+	friend class timer_wheel;
 
 public:
 	timer() = default;
@@ -319,6 +399,14 @@ public:
 		func_ = [object](timer &watcher, int t) { (static_cast<K *>(object)->*func)(watcher, t); };
 	}
 	void set(std::function<void(timer &, int)> func) noexcept { func_ = std::move(func); }
+	/// Coarse timer is kept in the timing wheel of the loop: it's started and stopped in O(1), but is fired up to
+	/// timer_wheel::kResolution later, than its deadline. Active timer is stopped, if its kind is changed
+	void set_coarse(bool coarse) {
+		if (coarse != coarse_) {
+			stop();
+			coarse_ = coarse;
+		}
+	}
 
 	bool is_active() const noexcept { return loop.is_active(this); }
 
@@ -345,6 +433,11 @@ protected:
 	std::function<void(timer &watcher, int t)> func_ = nullptr;
 	double period_ = 0;
 	bool in_coro_storage_ = false;
+	bool coarse_ = false;
+	// Links of the timing wheel's slot
+	int wheel_slot_ = -1;
+	timer *wheel_prev_ = nullptr;
+	timer *wheel_next_ = nullptr;
 };
 
 using periodic = timer;
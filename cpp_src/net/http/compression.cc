@@ -0,0 +1,100 @@
+#include "compression.h"
+#include "tools/errors.h"
+#include "tools/serializer.h"
+#include "tools/stringstools.h"
+
+#if REINDEX_WITH_ZLIB
+#include <zlib.h>
+#endif	// REINDEX_WITH_ZLIB
+
+namespace reindexer {
+namespace net {
+namespace http {
+
+using namespace std::string_view_literals;
+
+#if REINDEX_WITH_ZLIB
+
+// Gzip header is requested by the window bits above 15
+constexpr int kGzipWindowBits = 15 + 16;
+constexpr int kMemLevel = 8;
+constexpr size_t kMinOutBlockSize = 0x1000;
+
+struct GzipEncoder::Stream {
+	z_stream zs{};
+};
+
+GzipEncoder::GzipEncoder(int level) : stream_(std::make_unique<Stream>()) {
+	if (deflateInit2(&stream_->zs, level, Z_DEFLATED, kGzipWindowBits, kMemLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+		throw Error(errLogic, "Unable to init gzip stream: %s", stream_->zs.msg ? stream_->zs.msg : "unknown error");
+	}
+}
+
+GzipEncoder::~GzipEncoder() { deflateEnd(&stream_->zs); }
+
+bool GzipEncoder::Available() noexcept { return true; }
+
+void GzipEncoder::Encode(std::string_view data, WrSerializer &out, bool finish) {
+	z_stream &zs = stream_->zs;
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+	zs.avail_in = data.size();
+	int ret;
+	do {
+		out.Reserve(out.Len() + std::max(deflateBound(&zs, zs.avail_in), kMinOutBlockSize));
+		const size_t avail = out.Cap() - out.Len();
+		zs.next_out = out.Buf() + out.Len();
+		zs.avail_out = avail;
+		ret = deflate(&zs, finish ? Z_FINISH : Z_NO_FLUSH);
+		if (ret == Z_STREAM_ERROR) throw Error(errLogic, "Gzip stream error");
+		out.Reset(out.Len() + avail - zs.avail_out);
+	} while (zs.avail_out == 0 || (finish && ret != Z_STREAM_END));
+}
+
+#else	// REINDEX_WITH_ZLIB
+
+struct GzipEncoder::Stream {};
+
+GzipEncoder::GzipEncoder(int) { throw Error(errParams, "Reindexer was built without zlib, so the responses can't be compressed"); }
+
+GzipEncoder::~GzipEncoder() = default;
+
+bool GzipEncoder::Available() noexcept { return false; }
+
+void GzipEncoder::Encode(std::string_view, WrSerializer &, bool) {}
+
+#endif	// REINDEX_WITH_ZLIB
+
+static std::string_view trimSpaces(std::string_view str) noexcept {
+	while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) str.remove_prefix(1);
+	while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) str.remove_suffix(1);
+	return str;
+}
+
+bool AcceptsGzip(std::string_view acceptEncoding) noexcept {
+	while (!acceptEncoding.empty()) {
+		const auto pos = acceptEncoding.find(',');
+		std::string_view coding = acceptEncoding.substr(0, pos);
+		acceptEncoding = pos == std::string_view::npos ? std::string_view() : acceptEncoding.substr(pos + 1);
+
+		std::string_view params;
+		const auto paramsPos = coding.find(';');
+		if (paramsPos != std::string_view::npos) {
+			params = coding.substr(paramsPos + 1);
+			coding = coding.substr(0, paramsPos);
+		}
+		coding = trimSpaces(coding);
+		if (!iequals(coding, "gzip"sv) && !iequals(coding, "x-gzip"sv)) continue;
+		// 'q=0' means 'not acceptable'
+		params = trimSpaces(params);
+		if (params.size() < 2 || !iequals(params.substr(0, 2), "q="sv)) return true;
+		for (char c : params.substr(2)) {
+			if (c != '0' && c != '.') return true;
+		}
+		return false;
+	}
+	return false;
+}
+
+}  // namespace http
+}  // namespace net
+}  // namespace reindexer
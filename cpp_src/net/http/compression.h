@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <memory>
+#include <string_view>
+
+namespace reindexer {
+
+class WrSerializer;
+
+namespace net {
+namespace http {
+
+struct CompressionOpts {
+	/// Level of the gzip compression of the responses (1-9). 0 disables the compression
+	int level = 0;
+	/// Responses with the known size below this threshold are sent uncompressed
+	size_t minSize = 1024;
+};
+
+/// Streaming gzip encoder of the responses. Each part of the response is compressed as soon as it's written, so the response is never
+/// buffered as a whole
+class GzipEncoder {
+public:
+	explicit GzipEncoder(int level);
+	~GzipEncoder();
+	GzipEncoder(const GzipEncoder &) = delete;
+	GzipEncoder &operator=(const GzipEncoder &) = delete;
+
+	/// @return false, if the server is built without zlib
+	static bool Available() noexcept;
+	/// Appends the compressed data to the output. Output of the 'finish' call completes the gzip stream
+	void Encode(std::string_view data, WrSerializer &out, bool finish);
+
+private:
+	struct Stream;
+	std::unique_ptr<Stream> stream_;
+};
+
+/// @return true, if the gzip encoding is acceptable according to the value of 'Accept-Encoding' header
+bool AcceptsGzip(std::string_view acceptEncoding) noexcept;
+
+}  // namespace http
+}  // namespace net
+}  // namespace reindexer
@@ -129,6 +129,8 @@ public:
 
 	virtual int RespCode() = 0;
 	virtual ssize_t Written() = 0;
+	/// @return true, if the response with the unknown length will be compressed, so it may be sent by parts while it's encoded
+	virtual bool IsCompressed() = 0;
 	virtual ~Writer() = default;
 };
 
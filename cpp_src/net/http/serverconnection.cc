@@ -19,10 +19,11 @@ using namespace std::string_view_literals;
 static const std::string_view kStrEOL = "\r\n"sv;
 extern std::unordered_map<int, std::string_view> kHTTPCodes;
 
-ServerConnection::ServerConnection(int fd, ev::dynamic_loop &loop, Router &router, size_t maxRequestSize)
+ServerConnection::ServerConnection(int fd, ev::dynamic_loop &loop, Router &router, size_t maxRequestSize, CompressionOpts compression)
 	: ConnectionST(fd, loop, false, maxRequestSize < kConnReadbufSize ? maxRequestSize : kConnReadbufSize),
 	  router_(router),
-	  maxRequestSize_(maxRequestSize) {
+	  maxRequestSize_(maxRequestSize),
+	  compression_(GzipEncoder::Available() ? compression : CompressionOpts()) {
 	callback(io_, ev::READ);
 }
 
@@ -30,7 +31,7 @@ bool ServerConnection::Restart(int fd) {
 	restart(fd);
 	bodyLeft_ = 0;
 	formData_ = false;
-	enableHttp11_ = false;
+	keepAlive_ = false;
 	expectContinue_ = false;
 	callback(io_, ev::READ);
 	return true;
@@ -57,6 +58,9 @@ void ServerConnection::setJsonStatus(Context &ctx, bool success, int responseCod
 
 void ServerConnection::handleRequest(Request &req) {
 	ResponseWriter writer(this);
+	if (compression_.level > 0 && AcceptsGzip(req.headers.Get("Accept-Encoding"sv))) {
+		writer.EnableCompression(compression_);
+	}
 	BodyReader reader(this);
 	Context ctx;
 	ctx.request = &req;
@@ -133,6 +137,21 @@ void ServerConnection::parseParams(std::string_view str) {
 	}
 }
 
+// Date has one second resolution, so it is formatted once per second for all of the responses of the thread
+static std::string_view httpDate() {
+	thread_local std::time_t cachedTime = 0;
+	thread_local char dtBuf[128];
+	thread_local size_t dtLen = 0;
+	const std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+	if (t != cachedTime || !dtLen) {
+		std::tm tm;
+		fast_gmtime_r(&t, &tm);				// gmtime_r(&t, &tm);
+		dtLen = fast_strftime(dtBuf, &tm);	// strftime(tmpBuf, sizeof(tmpBuf), "%a %c", &tm);
+		cachedTime = t;
+	}
+	return std::string_view(dtBuf, dtLen);
+}
+
 void ServerConnection::writeHttpResponse(int code) {
 	WrSerializer ser(wrBuf_.get_chunk());
 
@@ -150,7 +169,9 @@ void ServerConnection::onRead() {
 	int minor_version = 0;
 	struct phr_header headers[kHttpMaxHeaders];
 
-	while (rdBuf_.size()) {
+	// Pipelined requests are handled one by one and their responses are sent in the same order.
+	// Requests after 'Connection: close' are not handled
+	while (rdBuf_.size() && !closeConn_) {
 		if (!bodyLeft_) {
 			auto chunk = rdBuf_.tail();
 
@@ -183,7 +204,8 @@ void ServerConnection::onRead() {
 				return;
 			}
 
-			enableHttp11_ = (minor_version >= 1);
+			keepAlive_ = (minor_version >= 1);
+			expectContinue_ = false;
 			request_.clientAddr = clientAddr_;
 			request_.method = std::string_view(method, method_len);
 			request_.uri = std::string_view(uri, path_len);
@@ -211,8 +233,13 @@ void ServerConnection::onRead() {
 					return;
 				} else if (iequals(hdr.name, "content-type"sv) && iequals(hdr.val, "application/x-www-form-urlencoded"sv)) {
 					formData_ = true;
-				} else if (iequals(hdr.name, "connection"sv) && iequals(hdr.val, "close"sv)) {
-					enableHttp11_ = false;
+				} else if (iequals(hdr.name, "connection"sv)) {
+					// HTTP/1.0 clients may request persistent connection explicitly
+					if (iequals(hdr.val, "close"sv)) {
+						keepAlive_ = false;
+					} else if (iequals(hdr.val, "keep-alive"sv)) {
+						keepAlive_ = true;
+					}
 				} else if (iequals(hdr.name, "expect"sv) && iequals(hdr.val, "100-continue"sv)) {
 					expectContinue_ = true;
 				}
@@ -271,6 +298,8 @@ void ServerConnection::onRead() {
 
 bool ServerConnection::ResponseWriter::SetHeader(const Header &hdr) {
 	if (respSend_) return false;
+	// Response is already encoded by the handler
+	if (!encoder_ && iequals(hdr.name, "Content-Encoding"sv)) compression_.level = 0;
 	headers_ << hdr.name << ": "sv << hdr.val << kStrEOL;
 	return true;
 }
@@ -287,12 +316,22 @@ bool ServerConnection::ResponseWriter::SetContentLength(size_t length) {
 }
 
 ssize_t ServerConnection::ResponseWriter::Write(chunk &&chunk) {
-	char szBuf[64], dtBuf[128];
+	char szBuf[64];
 	if (!respSend_) {
+		if (compression_.level > 0 && (isChunkedResponse() || size_t(contentLength_) >= compression_.minSize)) {
+			encoder_ = std::make_unique<GzipEncoder>(compression_.level);
+			SetHeader(Header{"Content-Encoding"sv, "gzip"sv});
+			SetHeader(Header{"Vary"sv, "Accept-Encoding"sv});
+			encoded_ = true;
+			// Size of the compressed response is unknown
+			contentLength_ = -1;
+		}
 		conn_->writeHttpResponse(code_);
 
-		if (conn_->enableHttp11_ && !conn_->closeConn_) {
-			SetHeader(Header{"ServerConnection"sv, "keep-alive"sv});
+		if (conn_->keepAlive_ && !conn_->closeConn_) {
+			SetHeader(Header{"Connection"sv, "keep-alive"sv});
+		} else {
+			SetHeader(Header{"Connection"sv, "close"sv});
 		}
 		if (!isChunkedResponse()) {
 			size_t l = u64toa(contentLength_, szBuf) - szBuf;
@@ -301,11 +340,7 @@ ssize_t ServerConnection::ResponseWriter::Write(chunk &&chunk) {
 			SetHeader(Header{"Transfer-Encoding"sv, "chunked"sv});
 		}
 
-		std::tm tm;
-		std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-		fast_gmtime_r(&t, &tm);				   // gmtime_r(&t, &tm);
-		size_t l = fast_strftime(dtBuf, &tm);  // strftime(tmpBuf, sizeof(tmpBuf), "%a %c", &tm);
-		SetHeader(Header{"Date"sv, {dtBuf, l}});
+		SetHeader(Header{"Date"sv, httpDate()});
 		SetHeader(Header{"Server"sv, "reindex"sv});
 
 		headers_ << kStrEOL;
@@ -313,7 +348,26 @@ ssize_t ServerConnection::ResponseWriter::Write(chunk &&chunk) {
 		respSend_ = true;
 	}
 
-	size_t len = chunk.len_;
+	const size_t len = chunk.len_;
+	if (encoded_) {
+		// Empty write completes the response
+		if (!encoder_) return 0;
+		WrSerializer ser(conn_->wrBuf_.get_chunk());
+		encoder_->Encode(std::string_view(reinterpret_cast<const char *>(chunk.data()), len), ser, !len);
+		if (ser.Len()) writeChunk(ser.DetachChunk());
+		if (len) return len;
+		encoder_.reset();
+	}
+	writeChunk(std::move(chunk));
+	if (!len && !conn_->keepAlive_) {
+		conn_->closeConn_ = true;
+	}
+	return len;
+}
+
+void ServerConnection::ResponseWriter::writeChunk(chunk &&chunk) {
+	char szBuf[64];
+	const size_t len = chunk.len_;
 	if (isChunkedResponse()) {
 		size_t l = u32toax(len, szBuf) - szBuf;
 		conn_->wrBuf_.write({szBuf, l});
@@ -326,10 +380,6 @@ ssize_t ServerConnection::ResponseWriter::Write(chunk &&chunk) {
 	if (isChunkedResponse()) {
 		conn_->wrBuf_.write(kStrEOL);
 	}
-	if (!len && !conn_->enableHttp11_) {
-		conn_->closeConn_ = true;
-	}
-	return len;
 }
 ssize_t ServerConnection::ResponseWriter::Write(std::string_view data) {
 	WrSerializer ser(conn_->wrBuf_.get_chunk());
@@ -2,6 +2,7 @@
 
 #include <string.h>
 #include "net/connection.h"
+#include "compression.h"
 #include "net/iserverconnection.h"
 #include "picohttpparser/picohttpparser.h"
 #include "router.h"
@@ -14,10 +15,12 @@ namespace http {
 const ssize_t kHttpMaxHeaders = 128;
 class ServerConnection : public IServerConnection, public ConnectionST {
 public:
-	ServerConnection(int fd, ev::dynamic_loop &loop, Router &router, size_t maxRequestSize);
+	ServerConnection(int fd, ev::dynamic_loop &loop, Router &router, size_t maxRequestSize, CompressionOpts compression = CompressionOpts());
 
-	static ConnectionFactory NewFactory(Router &router, size_t maxRequestSize) {
-		return [&router, maxRequestSize](ev::dynamic_loop &loop, int fd) { return new ServerConnection(fd, loop, router, maxRequestSize); };
+	static ConnectionFactory NewFactory(Router &router, size_t maxRequestSize, CompressionOpts compression = CompressionOpts()) {
+		return [&router, maxRequestSize, compression](ev::dynamic_loop &loop, int fd) {
+			return new ServerConnection(fd, loop, router, maxRequestSize, compression);
+		};
 	}
 
 	bool IsFinished() override final { return !sock_.valid(); }
@@ -50,11 +53,19 @@ protected:
 		bool IsRespSent() { return respSend_; }
 		virtual int RespCode() override final { return code_; }
 		virtual ssize_t Written() override final { return written_; }
+		virtual bool IsCompressed() override final { return compression_.level > 0; }
+		/// Enables the gzip compression of the response, which is accepted by the client
+		void EnableCompression(const CompressionOpts &opts) noexcept { compression_ = opts; }
 
 	protected:
 		bool isChunkedResponse() { return contentLength_ == -1; }
+		void writeChunk(chunk &&chunk);
 
 		int code_ = StatusOK;
+		CompressionOpts compression_;
+		// Encoder of the compressed response. It's released, when the response is completed
+		std::unique_ptr<GzipEncoder> encoder_;
+		bool encoded_ = false;
 
 		WrSerializer headers_;
 		bool respSend_ = false;
@@ -75,10 +86,11 @@ protected:
 	Request request_;
 	ssize_t bodyLeft_ = 0;
 	bool formData_ = false;
-	bool enableHttp11_ = false;
+	bool keepAlive_ = false;
 	bool expectContinue_ = false;
 	phr_chunked_decoder chunked_decoder_{0, 0, 0, 0};
 	const size_t maxRequestSize_ = 0;
+	const CompressionOpts compression_;
 };
 }  // namespace http
 }  // namespace net
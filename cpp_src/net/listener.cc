@@ -1,5 +1,10 @@
 #include "listener.h"
 #include <fcntl.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#endif
 #include <chrono>
 #include <cstdlib>
 #include <thread>
@@ -30,8 +35,8 @@ Listener::Listener(ev::dynamic_loop &loop, std::shared_ptr<Shared> shared) : loo
 	shared_->listeners_.push_back(this);
 }
 
-Listener::Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, int maxListeners)
-	: Listener(loop, std::make_shared<Shared>(connFactory, maxListeners ? maxListeners : std::thread::hardware_concurrency())) {}
+Listener::Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, int maxListeners, debug::ThreadRole role)
+	: Listener(loop, std::make_shared<Shared>(connFactory, maxListeners ? maxListeners : std::thread::hardware_concurrency(), role)) {}
 
 Listener::~Listener() { io_.stop(); }
 
@@ -198,6 +203,7 @@ void Listener::clone(std::shared_ptr<Shared> shared) {
 	{
 		ev::dynamic_loop loop;
 		Listener listener(loop, shared);
+		debug::CPUSampler::RegisterThread(shared->role_);
 #if REINDEX_WITH_GPERFTOOLS
 		if (alloc_ext::TCMallocIsAvailable()) {
 			reindexer_server::pprof::ProfilerRegisterThread();
@@ -220,12 +226,13 @@ void Listener::reserveStack() {
 	for (size_t i = 0; i < sizeof(placeholder); i += 4096) placeholder[i] = i & 0xFF;
 }
 
-Listener::Shared::Shared(ConnectionFactory connFactory, int maxListeners)
-	: maxListeners_(maxListeners), count_(1), connFactory_(connFactory), terminating_(false) {}
+Listener::Shared::Shared(ConnectionFactory connFactory, int maxListeners, debug::ThreadRole role)
+	: maxListeners_(maxListeners), count_(1), connFactory_(connFactory), terminating_(false), role_(role) {}
 
 Listener::Shared::~Shared() { sock_.close(); }
 
-ForkedListener::ForkedListener(ev::dynamic_loop &loop, ConnectionFactory connFactory) : connFactory_(connFactory), loop_(loop) {
+ForkedListener::ForkedListener(ev::dynamic_loop &loop, ConnectionFactory connFactory, debug::ThreadRole role)
+	: connFactory_(connFactory), role_(role), loop_(loop) {
 	io_.set<ForkedListener, &ForkedListener::io_accept>(this);
 	io_.set(loop);
 	async_.set<ForkedListener, &ForkedListener::async_cb>(this);
@@ -274,7 +281,7 @@ void ForkedListener::io_accept(ev::io & /*watcher*/, int revents) {
 	}
 
 	std::thread th([this, client] {
-
+		debug::CPUSampler::RegisterThread(role_);
 #if REINDEX_WITH_GPERFTOOLS
 		if (alloc_ext::TCMallocIsAvailable()) {
 			reindexer_server::pprof::ProfilerRegisterThread();
@@ -331,5 +338,161 @@ void ForkedListener::Stop() {
 	}
 }
 
+ReusePortListener::ReusePortListener(ConnectionFactory connFactory, int maxListeners, debug::ThreadRole role)
+	: connFactory_(connFactory),
+	  maxListeners_(maxListeners > 0 ? maxListeners : std::max(1u, std::thread::hardware_concurrency())),
+	  role_(role) {}
+
+ReusePortListener::~ReusePortListener() { stopWorkers(); }
+
+bool ReusePortListener::IsSupported() noexcept {
+#if defined(__linux__) && defined(SO_REUSEPORT)
+	return true;
+#else
+	// Other platforms does not balance connections between the sockets with SO_REUSEPORT
+	return false;
+#endif
+}
+
+bool ReusePortListener::Bind(string addr) {
+	if (!workers_.empty()) {
+		return false;
+	}
+
+	addr_ = addr;
+	for (int i = 0; i < maxListeners_; ++i) {
+		socket sock;
+		if (sock.bind(addr, true) < 0 || sock.listen(kListenCount) < 0) {
+			perror("listen error");
+			sock.close();
+			stopWorkers();
+			return false;
+		}
+		workers_.emplace_back(new Worker(*this, sock, i));
+	}
+	for (auto &w : workers_) {
+		w->thread = std::thread(&Worker::run, w.get());
+	}
+	return true;
+}
+
+void ReusePortListener::Stop() { stopWorkers(); }
+
+void ReusePortListener::stopWorkers() {
+	terminating_ = true;
+	for (auto &w : workers_) {
+		if (w->thread.joinable()) {
+			w->async.send();
+			w->thread.join();
+		}
+		w->sock.close();
+	}
+	workers_.clear();
+}
+
+ReusePortListener::Worker::Worker(ReusePortListener &owner, socket sock, int id) : owner(owner), sock(sock), id(id) {
+	// Watchers are set before the start of the worker's thread
+	io.set<Worker, &Worker::io_accept>(this);
+	io.set(loop);
+	timer.set<Worker, &Worker::timeout_cb>(this);
+	timer.set(loop);
+	async.set([](ev::async &a) { a.loop.break_loop(); });
+	async.set(loop);
+	async.start();
+	timer.start(5., 5.);
+	io.start(sock.fd(), ev::READ);
+}
+
+void ReusePortListener::Worker::run() {
+#ifdef __linux__
+	const unsigned cores = std::thread::hardware_concurrency();
+	if (cores) {
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(id % cores, &cpuset);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0) {
+			logPrintf(LogWarning, "Listener(%s) %d: unable to set CPU affinity", owner.addr_, id);
+		}
+	}
+#endif
+	debug::CPUSampler::RegisterThread(owner.role_);
+#if REINDEX_WITH_GPERFTOOLS
+	if (alloc_ext::TCMallocIsAvailable()) {
+		reindexer_server::pprof::ProfilerRegisterThread();
+	}
+#endif
+	while (!owner.terminating_) {
+		loop.run();
+	}
+	io.stop();
+	timer.stop();
+	async.stop();
+	connections.clear();
+	idle.clear();
+}
+
+void ReusePortListener::Worker::io_accept(ev::io & /*watcher*/, int revents) {
+	if (ev::ERROR & revents) {
+		perror("got invalid event");
+		return;
+	}
+
+	auto client = sock.accept();
+	if (!client.valid()) {
+		return;
+	}
+
+	if (owner.terminating_) {
+		client.close();
+		logPrintf(LogWarning, "Can't accept connection. Listener is terminating!");
+		return;
+	}
+
+	// Connections are owned by this worker only, so the idle connections pool does not require locks
+	if (idle.size()) {
+		auto conn = std::move(idle.back());
+		idle.pop_back();
+		conn->Attach(loop);
+		conn->Restart(client.fd());
+		connections.emplace_back(std::move(conn));
+	} else {
+		auto conn = std::unique_ptr<IServerConnection>(owner.connFactory_(loop, client.fd()));
+		if (!conn->IsFinished()) {
+			connections.emplace_back(std::move(conn));
+		}
+	}
+}
+
+void ReusePortListener::Worker::timeout_cb(ev::periodic &, int) {
+	const bool enableReuseIdle = !std::getenv("REINDEXER_NOREUSEIDLE");
+
+	for (unsigned i = 0; i < connections.size();) {
+		if (connections[i]->IsFinished()) {
+			connections[i]->Detach();
+			if (enableReuseIdle) {
+				idle.push_back(std::move(connections[i]));
+			} else {
+				connections[i].reset();
+			}
+
+			if (i != connections.size() - 1) connections[i] = std::move(connections.back());
+			connections.pop_back();
+			idleTs = std::chrono::steady_clock::now();
+		} else {
+			i++;
+		}
+	}
+
+	// Clear all idle connections, after 300 sec
+	if (idle.size() && std::chrono::steady_clock::now() - idleTs > std::chrono::seconds(300)) {
+		logPrintf(LogInfo, "Cleanup idle connections. %d cleared", idle.size());
+		idle.clear();
+	}
+
+	if (connections.size()) {
+		logPrintf(LogTrace, "Listener(%s) %d stats: %d connections", owner.addr_, id, connections.size());
+	}
+}
+
 }  // namespace net
 }  // namespace reindexer
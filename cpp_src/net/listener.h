@@ -4,7 +4,9 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
+#include "debug/sampler.h"
 #include "iserverconnection.h"
 #include "net/ev/ev.h"
 #include "socket.h"
@@ -33,7 +35,8 @@ public:
 	/// @param loop - ev::loop of caller's thread, listener's socket will be binded to that loop.
 	/// @param connFactory - Connection factory, will create objects with IServerConnection interface implementation.
 	/// @param maxListeners - Maximum number of threads, which listener will utilize. std::thread::hardware_concurrency() by default
-	Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, int maxListeners = 0);
+	/// @param role - Role of the listener's threads for the sampling profiler
+	Listener(ev::dynamic_loop &loop, ConnectionFactory connFactory, int maxListeners = 0, debug::ThreadRole role = debug::ThreadRole::Other);
 	~Listener();
 	/// Bind listener to specified host:port
 	/// @param addr - tcp host:port for bind
@@ -50,7 +53,7 @@ protected:
 	void rebalance();
 
 	struct Shared {
-		Shared(ConnectionFactory connFactory, int maxListeners);
+		Shared(ConnectionFactory connFactory, int maxListeners, debug::ThreadRole role);
 		~Shared();
 		socket sock_;
 		const int maxListeners_;
@@ -62,6 +65,7 @@ protected:
 		std::string addr_;
 		vector<std::unique_ptr<IServerConnection>> idle_;
 		std::chrono::time_point<std::chrono::steady_clock> ts_;
+		const debug::ThreadRole role_;
 	};
 	Listener(ev::dynamic_loop &loop, std::shared_ptr<Shared> shared);
 	static void clone(std::shared_ptr<Shared>);
@@ -81,7 +85,8 @@ public:
 	/// Constructs new listner object.
 	/// @param loop - ev::loop of caller's thread, listener's socket will be binded to that loop.
 	/// @param connFactory - Connection factory, will create objects with IServerConnection interface implementation.
-	ForkedListener(ev::dynamic_loop &loop, ConnectionFactory connFactory);
+	/// @param role - Role of the connections' threads for the sampling profiler
+	ForkedListener(ev::dynamic_loop &loop, ConnectionFactory connFactory, debug::ThreadRole role = debug::ThreadRole::Other);
 	~ForkedListener();
 	/// Bind listener to specified host:port
 	/// @param addr - tcp host:port for bind
@@ -112,6 +117,7 @@ protected:
 	socket sock_;
 	std::mutex lck_;
 	ConnectionFactory connFactory_;
+	const debug::ThreadRole role_;
 	std::atomic<bool> terminating_{false};
 	std::string addr_;
 
@@ -121,5 +127,55 @@ protected:
 	vector<Worker> workers_;
 };
 
+/// Network listener implementation with the kernel-side balancing of the incoming connections. Each worker thread owns its own SO_REUSEPORT
+/// socket and ev::dynamic_loop and is pinned to the separate CPU core, so there are no shared accepting socket, locks or cross-thread
+/// wakeups on accept. Connections are never moved between the workers
+class ReusePortListener : public IListener {
+public:
+	/// Constructs new listner object.
+	/// @param connFactory - Connection factory, will create objects with IServerConnection interface implementation.
+	/// @param maxListeners - Number of the worker threads. std::thread::hardware_concurrency() by default
+	/// @param role - Role of the worker threads for the sampling profiler
+	ReusePortListener(ConnectionFactory connFactory, int maxListeners = 0, debug::ThreadRole role = debug::ThreadRole::Other);
+	~ReusePortListener();
+	/// Bind listener to specified host:port
+	/// @param addr - tcp host:port for bind
+	/// @return true - if bind successful, false - on bind error
+	bool Bind(std::string addr);
+	/// Stop synchroniusly stops listener
+	void Stop();
+	/// Checks if SO_REUSEPORT balancing is supported by the platform
+	static bool IsSupported() noexcept;
+
+protected:
+	struct Worker {
+		Worker(ReusePortListener &owner, socket sock, int id);
+		void run();
+		void io_accept(ev::io &watcher, int revents);
+		void timeout_cb(ev::periodic &watcher, int);
+
+		ReusePortListener &owner;
+		socket sock;
+		const int id;
+		ev::dynamic_loop loop;
+		ev::io io;
+		ev::periodic timer;
+		ev::async async;
+		vector<std::unique_ptr<IServerConnection>> connections;
+		vector<std::unique_ptr<IServerConnection>> idle;
+		std::chrono::time_point<std::chrono::steady_clock> idleTs;
+		std::thread thread;
+	};
+
+	void stopWorkers();
+
+	ConnectionFactory connFactory_;
+	const int maxListeners_;
+	const debug::ThreadRole role_;
+	std::atomic<bool> terminating_{false};
+	std::string addr_;
+	vector<std::unique_ptr<Worker>> workers_;
+};
+
 }  // namespace net
 }  // namespace reindexer
@@ -12,9 +12,14 @@
 namespace reindexer {
 namespace net {
 
-int socket::bind(std::string_view addr) {
+int socket::bind(std::string_view addr, bool reusePort) {
 	struct addrinfo *results = nullptr;
 	int ret = create(addr, &results);
+	if (!ret && reusePort && set_reuseport() < 0) {
+		perror("setsockopt(SO_REUSEPORT) failed");
+		close();
+		ret = -1;
+	}
 	if (!ret) {
 		assertrx(results != nullptr);
 		if (::bind(fd_, results->ai_addr, results->ai_addrlen) != 0) {	// -V595
@@ -207,6 +212,16 @@ int socket::set_nodelay() {
 	return setsockopt(fd_, SOL_TCP, TCP_NODELAY, reinterpret_cast<char *>(&flag), sizeof(flag));
 }
 
+int socket::set_reuseport() {
+#ifdef SO_REUSEPORT
+	int flag = 1;
+	return setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<char *>(&flag), sizeof(flag));
+#else
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
+
 int socket::last_error() {
 #ifndef _WIN32
 	return errno;
@@ -14,7 +14,9 @@ public:
 	socket &operator=(const socket &other) = default;
 	socket(int fd = -1) : fd_(fd) {}
 
-	int bind(std::string_view addr);
+	/// @param reusePort - allows to bind multiple sockets to the same addr (SO_REUSEPORT). Incoming connections are balanced between
+	/// them by the kernel
+	int bind(std::string_view addr, bool reusePort = false);
 	int connect(std::string_view addr) noexcept;
 	socket accept();
 	int listen(int backlog);
@@ -26,6 +28,7 @@ public:
 
 	int set_nonblock();
 	int set_nodelay();
+	int set_reuseport();
 	int fd() const { return fd_; }
 	bool valid() const { return fd_ >= 0; }
 
@@ -0,0 +1,109 @@
+#include "replicationstat.h"
+#include "core/cjson/jsonbuilder.h"
+
+namespace reindexer {
+
+void NamespaceReplicationStat::GetJSON(WrSerializer &ser) const {
+	JsonBuilder builder(ser);
+	builder.Put("name", name);
+	{
+		auto obj = builder.Object("master_lsn");
+		masterLSN.GetJSON(obj);
+	}
+	{
+		auto obj = builder.Object("applied_lsn");
+		appliedLSN.GetJSON(obj);
+	}
+	builder.Put("lsn_lag", lsnLag);
+	builder.Put("pended_updates", pendedUpdates);
+	builder.Put("queued_updates", queuedUpdates);
+	builder.Put("applied_records", appliedRecords);
+	builder.Put("applied_records_rate", appliedRecordsRate);
+	builder.Put("recv_records", recvRecords);
+	builder.Put("recv_bytes", recvBytes);
+	builder.Put("recv_rate", recvBytesRate);
+	builder.Put("tx_count", txCount);
+	builder.Put("tx_apply_time_us", txApplyTimeUs);
+	builder.Put("tx_avg_apply_time_us", txCount ? txApplyTimeUs / txCount : 0);
+}
+
+void ReplicationStatTracker::RateCounter::Count(uint64_t value, ClockT::time_point now) {
+	const auto elapsed = now - start_;
+	if (elapsed >= std::chrono::seconds(1)) {
+		// Values of the interval without updates are not reported as the current rate
+		lastRate_ = elapsed < std::chrono::seconds(2) ? current_ : 0;
+		current_ = 0;
+		start_ = now;
+	}
+	current_ += value;
+	total_ += value;
+}
+
+uint64_t ReplicationStatTracker::RateCounter::Rate(ClockT::time_point now) const noexcept {
+	const auto elapsed = now - start_;
+	if (elapsed < std::chrono::seconds(1)) return lastRate_;
+	return elapsed < std::chrono::seconds(2) ? current_ : 0;
+}
+
+void ReplicationStatTracker::OnReceived(std::string_view nsName, lsn_t masterLSN, size_t recordsCount, size_t bytes) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	auto &counters = getCounters(nsName);
+	if (!masterLSN.isEmpty()) counters.masterLSN = masterLSN;
+	counters.recvBytes.Count(bytes, ClockT::now());
+	counters.recvRecords += recordsCount;
+}
+
+void ReplicationStatTracker::OnApplied(std::string_view nsName, lsn_t appliedLSN, size_t recordsCount) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	auto &counters = getCounters(nsName);
+	if (!appliedLSN.isEmpty()) counters.appliedLSN = appliedLSN;
+	counters.applied.Count(recordsCount, ClockT::now());
+}
+
+void ReplicationStatTracker::OnTxApplied(std::string_view nsName, std::chrono::microseconds time, bool committed) {
+	std::lock_guard<std::mutex> lck(mtx_);
+	auto &counters = getCounters(nsName);
+	counters.txApplyTime += time;
+	if (committed) ++counters.txCount;
+}
+
+void ReplicationStatTracker::Reset() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	counters_.clear();
+}
+
+std::vector<NamespaceReplicationStat> ReplicationStatTracker::Get() const {
+	const auto now = ClockT::now();
+	std::vector<NamespaceReplicationStat> stats;
+	std::lock_guard<std::mutex> lck(mtx_);
+	stats.reserve(counters_.size());
+	for (auto &c : counters_) {
+		NamespaceReplicationStat stat;
+		stat.name = c.first;
+		stat.masterLSN = c.second.masterLSN;
+		stat.appliedLSN = c.second.appliedLSN;
+		if (!stat.masterLSN.isEmpty()) {
+			stat.lsnLag = stat.appliedLSN.isEmpty() ? stat.masterLSN.Counter() + 1 : stat.masterLSN.Counter() - stat.appliedLSN.Counter();
+			if (stat.lsnLag < 0) stat.lsnLag = 0;
+		}
+		stat.appliedRecords = c.second.applied.Total();
+		stat.appliedRecordsRate = c.second.applied.Rate(now);
+		stat.recvRecords = c.second.recvRecords;
+		stat.recvBytes = c.second.recvBytes.Total();
+		stat.recvBytesRate = c.second.recvBytes.Rate(now);
+		stat.txCount = c.second.txCount;
+		stat.txApplyTimeUs = c.second.txApplyTime.count();
+		stats.emplace_back(std::move(stat));
+	}
+	return stats;
+}
+
+ReplicationStatTracker::NsCounters &ReplicationStatTracker::getCounters(std::string_view nsName) {
+	auto it = counters_.find(nsName);
+	if (it == counters_.end()) {
+		it = counters_.emplace(std::string(nsName), NsCounters()).first;
+	}
+	return it.value();
+}
+
+}  // namespace reindexer
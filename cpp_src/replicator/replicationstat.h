@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/lsn.h"
+#include "estl/fast_hash_map.h"
+#include "tools/stringstools.h"
+
+namespace reindexer {
+
+class WrSerializer;
+
+/// Live replication statistics of the slave's namespace. Located in '#replicationstats' system namespace
+struct NamespaceReplicationStat {
+	void GetJSON(WrSerializer &ser) const;
+
+	std::string name;
+	// Last LSN of the master, which was received by the slave
+	lsn_t masterLSN;
+	// Last LSN of the master, which was applied by the slave
+	lsn_t appliedLSN;
+	// Count of the received master's records, which are not applied yet
+	int64_t lsnLag = 0;
+	// Online updates, which are buffered while the namespace is syncing
+	size_t pendedUpdates = 0;
+	// Online updates, which are waiting in the queue of the updates applier
+	size_t queuedUpdates = 0;
+	uint64_t appliedRecords = 0;
+	uint64_t appliedRecordsRate = 0;
+	uint64_t recvRecords = 0;
+	uint64_t recvBytes = 0;
+	uint64_t recvBytesRate = 0;
+	uint64_t txCount = 0;
+	uint64_t txApplyTimeUs = 0;
+};
+
+/// Collects live per-namespace replication counters on the slave. Rates are calculated over the last completed second
+class ReplicationStatTracker {
+public:
+	using ClockT = std::chrono::steady_clock;
+
+	void OnReceived(std::string_view nsName, lsn_t masterLSN, size_t recordsCount, size_t bytes);
+	void OnApplied(std::string_view nsName, lsn_t appliedLSN, size_t recordsCount);
+	void OnTxApplied(std::string_view nsName, std::chrono::microseconds time, bool committed);
+	void Reset();
+	std::vector<NamespaceReplicationStat> Get() const;
+
+private:
+	class RateCounter {
+	public:
+		void Count(uint64_t value, ClockT::time_point now);
+		uint64_t Rate(ClockT::time_point now) const noexcept;
+		uint64_t Total() const noexcept { return total_; }
+
+	private:
+		uint64_t total_ = 0;
+		uint64_t current_ = 0;
+		uint64_t lastRate_ = 0;
+		ClockT::time_point start_;
+	};
+	struct NsCounters {
+		lsn_t masterLSN;
+		lsn_t appliedLSN;
+		RateCounter applied;
+		RateCounter recvBytes;
+		uint64_t recvRecords = 0;
+		uint64_t txCount = 0;
+		std::chrono::microseconds txApplyTime{0};
+	};
+
+	NsCounters &getCounters(std::string_view nsName);
+
+	mutable std::mutex mtx_;
+	fast_hash_map<std::string, NsCounters, nocase_hash_str, nocase_equal_str> counters_;
+};
+
+}  // namespace reindexer
@@ -6,8 +6,10 @@
 #include "core/namespace/namespaceimpl.h"
 #include "core/namespacedef.h"
 #include "core/reindexerimpl.h"
+#include "gason/gason.h"
 #include "tools/logger.h"
 #include "tools/stringstools.h"
+#include "tools/threadpool.h"
 #include "walrecord.h"
 
 namespace reindexer {
@@ -16,6 +18,9 @@ using namespace net;
 using namespace std::string_view_literals;
 
 static constexpr size_t kTmpNsPostfixLen = 20;
+static constexpr unsigned kForcedSyncLoadingThreads = 6;
+// Minimal count of the transaction's steps per each decoding thread
+static constexpr size_t kMinTxItemsPerDecodeThread = 10000;
 
 Replicator::Replicator(ReindexerImpl *slave)
 	: slave_(slave),
@@ -23,7 +28,8 @@ Replicator::Replicator(ReindexerImpl *slave)
 	  terminate_(false),
 	  state_(StateInit),
 	  enabled_(false),
-	  dummyCtx_(true, LSNPair(lsn_t(), lsn_t())) {
+	  dummyCtx_(true, LSNPair(lsn_t(), lsn_t())),
+	  updatesApplier_([this](std::string_view nsName, span<UpdatesApplier::Update> updates) { applyOnlineUpdates(nsName, updates); }) {
 	stop_.set(loop_);
 	resync_.set(loop_);
 	resyncTimer_.set(loop_);
@@ -103,6 +109,7 @@ void Replicator::run() {
 	stop_.set([&](ev::async &sig) { sig.loop.break_loop(); });
 	stop_.start();
 	logPrintf(LogInfo, "[repl] Replicator with %s started", config_.masterDSN);
+	replStats_.Reset();
 
 	if (config_.namespaces.empty()) {
 		master_->SubscribeUpdates(this, UpdatesFilters());
@@ -136,6 +143,7 @@ void Replicator::run() {
 	walSyncAsync_.start();
 	resyncUpdatesLostAsync_.set([this](ev::async &) { syncDatabase(); });
 	resyncUpdatesLostAsync_.start();
+	updatesApplier_.Start(config_.onlineUpdatesApplyThreads);
 	syncDatabase();
 
 	while (!terminate_) {
@@ -148,6 +156,7 @@ void Replicator::run() {
 	walSyncAsync_.stop();
 	resyncUpdatesLostAsync_.stop();
 	master_->UnsubscribeUpdates(this);
+	updatesApplier_.Stop();
 	logPrintf(LogInfo, "[repl] Replicator with %s stopped", config_.masterDSN);
 }
 
@@ -193,6 +202,17 @@ Error Replicator::syncNamespace(const NamespaceDef &ns, std::string_view forceSy
 		// Perform startup sync
 		if (forceSyncReason.empty()) {
 			err = syncNamespaceByWAL(ns);
+			if (err.code() == errDataHashMismatch && config_.forceSyncOnWrongDataHash && !terminate_) {
+				// Minor divergence is fixed by the resync of the divergent buckets only. Forced sync is the fallback
+				logPrintf(LogWarning, "[repl:%s:%s] %s. Resyncing divergent data hash buckets", ns.name, slave_->storagePath_, err.what());
+				auto bucketsErr = syncDataHashBuckets(ns);
+				if (bucketsErr.ok() || terminate_) {
+					err = bucketsErr;
+				} else {
+					logPrintf(LogWarning, "[repl:%s:%s] Unable to resync data hash buckets: %s", ns.name, slave_->storagePath_,
+							  bucketsErr.what());
+				}
+			}
 		} else {
 			err = syncNamespaceForced(ns, forceSyncReason);
 			forceSyncReason = std::string_view();
@@ -271,7 +291,7 @@ Error Replicator::syncNamespace(const NamespaceDef &ns, std::string_view forceSy
 				walUpdates.clear();
 				if (!lastLsn.upstreamLSN_.isEmpty()) {
 					logPrintf(LogTrace, "[repl:%s] Setting new lsn %d after updates apply", ns.name, lastLsn.upstreamLSN_.Counter());
-					slaveNs->SetReplLSNs(lastLsn, dummyCtx_);
+					setReplLSNs(slaveNs, lastLsn);
 				}
 			}
 		}
@@ -300,6 +320,8 @@ Error Replicator::syncDatabase() {
 		currentSyncNs_.clear();
 		pendedUpdates_.clear();
 	}
+	// Online updates, which were accepted before the resync, must not be applied concurrently with it
+	updatesApplier_.WaitIdle();
 
 	Error err = master_->EnumNamespaces(nses, EnumNamespacesOpts());
 	if (!err.ok()) {
@@ -418,6 +440,67 @@ Error Replicator::syncNamespaceByWAL(const NamespaceDef &nsDef) {
 	}
 }
 
+Error Replicator::syncDataHashBuckets(const NamespaceDef &nsDef) {
+	auto slaveNs = slave_->getNamespaceNoThrow(nsDef.name, dummyCtx_);
+	if (!slaveNs) return Error(errNotFound, "Namespace %s not found", nsDef.name);
+
+	VariantArray hashes;
+	for (auto hash : slaveNs->GetDataHashBuckets(dummyCtx_)) {
+		hashes.emplace_back(int64_t(hash));
+	}
+	//  Make query to the items of the master's buckets, which hashes differ from the slave's ones
+	client::QueryResults qr(kResultsWithPayloadTypes | kResultsCJson | kResultsWithItemID | kResultsWithRaw);
+	Error err = master_->Select(Query(nsDef.name).Where("#data_hash_buckets", CondSet, hashes), qr);
+	if (!err.ok()) return err;
+
+	SyncStat stat;
+	std::vector<unsigned> buckets;
+	std::vector<Item> items;
+	try {
+		WrSerializer ser;
+		for (auto it = qr.begin(); it != qr.end(); ++it) {
+			if (terminate_) return Error(errCanceled, "terminated");
+			if (!qr.Status().ok()) return qr.Status();
+			if (it.IsRaw()) {
+				WALRecord wrec(it.GetRaw());
+				if (wrec.type == WalDataHashBuckets) {
+					gason::JsonParser parser;
+					for (auto &bucket : parser.Parse(giftStr(wrec.data))["buckets"]) {
+						buckets.emplace_back(bucket.As<unsigned>());
+					}
+				} else {
+					err = applyWALRecord(LSNPair(), nsDef.name, slaveNs, wrec, stat);
+				}
+			} else {
+				ser.Reset();
+				err = it.GetCJSON(ser, false);
+				if (err.ok()) {
+					items.emplace_back(slaveNs->NewItem(dummyCtx_));
+					err = unpackItem(items.back(), lsn_t(), ser.Slice(), qr.getTagsMatcher(0));
+				}
+			}
+			if (!err.ok()) return err;
+		}
+		slaveNs->ReplaceDataHashBuckets(buckets, items, RdxContext(true, LSNPair()));
+	} catch (const gason::Exception &e) {
+		return Error(errParseJson, "Data hash buckets: %s", e.what());
+	} catch (const Error &e) {
+		return e;
+	}
+
+	ReplicationState slaveState = slaveNs->GetReplState(dummyCtx_);
+	if (stat.masterState.lastLsn.isEmpty() || slaveState.dataHash != stat.masterState.dataHash) {
+		return Error(errDataHashMismatch, "[repl:%s]:%d dataHash mismatch with master after buckets resync %u != %u; itemsCount %d %d;",
+					 nsDef.name, config_.serverId, stat.masterState.dataHash, slaveState.dataHash, stat.masterState.dataCount,
+					 slaveState.dataCount);
+	}
+	setReplLSNs(slaveNs, LSNPair(stat.masterState.lastLsn, stat.masterState.originLSN));
+	logPrintf(LogInfo, "[repl:%s:%s]:%d %d divergent data hash buckets were resynced (%d items)", nsDef.name, slave_->storagePath_,
+			  config_.serverId, buckets.size(), items.size());
+	slave_->syncDownstream(nsDef.name, false);
+	return errOK;
+}
+
 // Forced namespace sync
 // This will completely drop slave namespace
 // read all indexes and data from master, then apply to slave
@@ -478,6 +561,7 @@ Error Replicator::syncNamespaceForced(const NamespaceDef &ns, std::string_view r
 		}
 	}
 	if (err.ok()) err = slave_->renameNamespace(tmpNsDef.name, ns.name, true);
+	if (err.ok()) notifyLSNWaiters();
 	if (err.ok()) err = slave_->syncDownstream(ns.name, true);
 
 	if (!err.ok()) {
@@ -497,16 +581,29 @@ Error Replicator::applyWAL(Namespace::Ptr slaveNs, client::QueryResults &qr, con
 	auto replSt = slaveNs->GetReplState(dummyCtx_);
 	logPrintf(LogTrace, "[repl:%s:%s]:%d applyWAL  lastUpstreamLSN = %s walRecordCount = %d", nsName, slave_->storagePath_,
 			  config_.serverId, replSt.lastUpstreamLSN, qr.Count());
-	for (auto it : qr) {
+	// Items of the forced sync are loaded into the empty temporary namespace, so they don't have to be upserted one by one
+	const bool forcedSync = nsDef;
+	// Items of the forced sync are loaded into the temporary namespace, but they are accounted to the target one
+	const std::string statNsName = forcedSync ? nsDef->name : std::string(nsName);
+	for (auto it = qr.begin(); it != qr.end(); ++it) {
 		if (terminate_) break;
 		if (qr.Status().ok()) {
 			try {
 				if (it.IsRaw()) {
+					stat.recvBytes += it.GetRaw().size();
 					err = applyWALRecord(LSNPair(), nsName, slaveNs, WALRecord(it.GetRaw()), stat, nsDef);
+				} else if (forcedSync) {
+					err = bulkLoadItems(slaveNs, qr, it, stat);
+					if (!err.ok()) {
+						stat.lastError = err;
+						stat.errors++;
+					}
+					break;
 				} else {
 					// Simple item updated
 					ser.Reset();
 					err = it.GetCJSON(ser, false);
+					stat.recvBytes += ser.Len();
 					if (err.ok()) err = modifyItem(LSNPair(), slaveNs, ser.Slice(), ModeUpsert, qr.getTagsMatcher(0), stat);
 				}
 			} catch (const Error &e) {
@@ -540,8 +637,10 @@ Error Replicator::applyWAL(Namespace::Ptr slaveNs, client::QueryResults &qr, con
 		logPrintf(LogTrace, "[repl:%s]:%d applyWal SetReplLSNs upstreamLsn = %s originLsn = %s", nsName, config_.serverId,
 				  stat.masterState.lastLsn, stat.masterState.originLSN);
 		// counters from the upstream node (from WalReplState)
-		slaveNs->SetReplLSNs(LSNPair(stat.masterState.lastLsn, stat.masterState.originLSN), dummyCtx_);
+		setReplLSNs(slaveNs, LSNPair(stat.masterState.lastLsn, stat.masterState.originLSN));
 	}
+	replStats_.OnReceived(statNsName, stat.masterState.lastLsn, stat.processed, stat.recvBytes);
+	replStats_.OnApplied(statNsName, stat.lastError.ok() && !terminate_ ? stat.masterState.lastLsn : lsn_t(), stat.processed - stat.errors);
 
 	ser.Reset();
 	stat.Dump(ser) << "lsn #" << int64_t(slaveState.lastLsn);
@@ -553,43 +652,99 @@ Error Replicator::applyWAL(Namespace::Ptr slaveNs, client::QueryResults &qr, con
 	return stat.lastError;
 }
 
+Error Replicator::bulkLoadItems(Namespace::Ptr slaveNs, client::QueryResults &qr, client::QueryResults::Iterator &it, SyncStat &stat) {
+	const auto nsName = slaveNs->GetName(dummyCtx_);
+	// Raw records can't be applied, while the namespace is loading, so they are delayed until the end of the load
+	std::vector<PackedWALRecord> delayedRecords;
+	WrSerializer ser;
+	Error err;
+	const NamespaceImpl::ItemsSourceT source = [&](const std::function<bool(std::string_view)> &f) {
+		for (; it != qr.end(); ++it) {
+			if (terminate_) {
+				err = Error(errCanceled, "terminated");
+				return;
+			}
+			if (!qr.Status().ok()) {
+				err = qr.Status();
+				return;
+			}
+			stat.processed++;
+			if (it.IsRaw()) {
+				stat.recvBytes += it.GetRaw().size();
+				delayedRecords.emplace_back();
+				delayedRecords.back().Pack(WALRecord(it.GetRaw()));
+				continue;
+			}
+			ser.Reset();
+			err = it.GetCJSON(ser, false);
+			if (!err.ok()) return;
+			stat.recvBytes += ser.Len();
+			stat.updated++;
+			if (!f(ser.Slice())) return;
+		}
+	};
+	try {
+		slaveNs->BulkLoad(source, kForcedSyncLoadingThreads, RdxContext(true, LSNPair()));
+	} catch (const Error &e) {
+		return e;
+	}
+	if (!err.ok()) return err;
+
+	for (auto &rec : delayedRecords) {
+		try {
+			err = applyWALRecord(LSNPair(), nsName, slaveNs, WALRecord(span<uint8_t>(rec)), stat);
+		} catch (const Error &e) {
+			err = e;
+		}
+		if (!err.ok()) return err;
+	}
+	return err;
+}
+
 Error Replicator::applyTxWALRecord(LSNPair LSNs, std::string_view nsName, Namespace::Ptr slaveNs, const WALRecord &rec) {
+	const auto start = std::chrono::steady_clock::now();
+	Error err = doApplyTxWALRecord(LSNs, nsName, slaveNs, rec);
+	replStats_.OnTxApplied(nsName, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start),
+						   err.ok() && rec.type == WalCommitTransaction);
+	return err;
+}
+
+Error Replicator::doApplyTxWALRecord(LSNPair LSNs, std::string_view nsName, Namespace::Ptr slaveNs, const WALRecord &rec) {
 	switch (rec.type) {
-		// Modify item
-		case WalItemModify: {
-			std::lock_guard<std::mutex> lck(syncMtx_);
-			Transaction &tx = transactions_[slaveNs.get()];
-			if (tx.IsFree()) return Error(errLogic, "[repl:%s]:%d Transaction was not initiated.", nsName, config_.serverId);
-			Item item = tx.NewItem();
-			const Error err = unpackItem(item, LSNs.upstreamLSN_, rec.itemModify.itemCJson, master_->NewItem(nsName).impl_->tagsMatcher());
-			if (!err.ok()) return err;
-			tx.Modify(std::move(item), static_cast<ItemModifyMode>(rec.itemModify.modifyMode));
-		} break;
-		// Update query
+		// Modify item or update query. Steps are decoded on commit
+		case WalItemModify:
 		case WalUpdateQuery: {
-			QueryResults result;
-			Query q;
-			q.FromSQL(rec.data);
 			std::lock_guard<std::mutex> lck(syncMtx_);
-			Transaction &tx = transactions_[slaveNs.get()];
-			if (tx.IsFree()) return Error(errLogic, "[repl:%s]:%d Transaction was not initiated.", nsName, config_.serverId);
-			tx.Modify(std::move(q));
+			ReplTransaction &rtx = transactions_[slaveNs.get()];
+			if (rtx.tx.IsFree()) return Error(errLogic, "[repl:%s]:%d Transaction was not initiated.", nsName, config_.serverId);
+			rtx.steps.emplace_back(LSNs.upstreamLSN_, PackedWALRecord());
+			rtx.steps.back().second.Pack(rec);
 		} break;
 		case WalInitTransaction: {
 			std::lock_guard<std::mutex> lck(syncMtx_);
-			Transaction &tx = transactions_[slaveNs.get()];
-			if (!tx.IsFree()) logPrintf(LogError, "[repl:%s]:%d Init transaction befor commit of previous one.", nsName, config_.serverId);
+			ReplTransaction &rtx = transactions_[slaveNs.get()];
+			if (!rtx.tx.IsFree()) logPrintf(LogError, "[repl:%s]:%d Init transaction befor commit of previous one.", nsName, config_.serverId);
 			RdxContext rdxContext(true, LSNs);
-			tx = slaveNs->NewTransaction(rdxContext);
+			rtx.tx = slaveNs->NewTransaction(rdxContext);
+			rtx.steps.clear();
 		} break;
 		case WalCommitTransaction: {
+			ReplTransaction rtx;
+			{
+				std::lock_guard<std::mutex> lck(syncMtx_);
+				auto it = transactions_.find(slaveNs.get());
+				if (it == transactions_.end() || it->second.tx.IsFree()) {
+					return Error(errLogic, "[repl:%s]:%d Commit of transaction befor initiate it.", nsName, config_.serverId);
+				}
+				// Transaction is built and committed without syncMtx_, so it doesn't block the updates of the other namespaces
+				rtx = std::move(it->second);
+				transactions_.erase(it);
+			}
+			Error err = buildTransaction(nsName, rtx);
+			if (!err.ok()) return err;
 			QueryResults res;
-			std::lock_guard<std::mutex> lck(syncMtx_);
-			Transaction &tx = transactions_[slaveNs.get()];
-			if (tx.IsFree()) return Error(errLogic, "[repl:%s]:%d Commit of transaction befor initiate it.", nsName, config_.serverId);
 			RdxContext rdxContext(true, LSNs);
-			slaveNs->CommitTransaction(tx, res, rdxContext);
-			tx = Transaction{};
+			slaveNs->CommitTransaction(rtx.tx, res, rdxContext);
 		} break;
 		default:
 			return Error(errLogic, "Unexpected for transaction WAL rec type %d\n", int(rec.type));
@@ -597,12 +752,67 @@ Error Replicator::applyTxWALRecord(LSNPair LSNs, std::string_view nsName, Namesp
 	return {};
 }
 
+Error Replicator::buildTransaction(std::string_view nsName, ReplTransaction &rtx) {
+	const auto tm = master_->NewItem(nsName).impl_->tagsMatcher();
+	std::vector<Item> items(rtx.steps.size());
+	auto decodeItem = [&](size_t i) -> Error {
+		auto &step = rtx.steps[i];
+		WALRecord rec(span<uint8_t>(step.second));
+		if (rec.type != WalItemModify) return {};
+		try {
+			items[i] = rtx.tx.NewItem();
+			return unpackItem(items[i], step.first, rec.itemModify.itemCJson, tm);
+		} catch (const Error &err) {
+			return err;
+		}
+	};
+
+	const size_t threadsCount = std::min<size_t>(config_.txDecodeThreads, rtx.steps.size() / kMinTxItemsPerDecodeThread);
+	if (threadsCount > 1) {
+		// CJSON of the large transactions is decoded concurrently, while the steps are added to the transaction in the original order
+		constexpr size_t kChunkSize = 256;
+		TaskGroup group(threadsCount, ThreadPool::Priority::High);
+		for (size_t begin = 0; begin < items.size(); begin += kChunkSize) {
+			group.Add([&, begin] {
+				const size_t end = std::min(begin + kChunkSize, items.size());
+				for (size_t i = begin; i < end; ++i) {
+					Error err = decodeItem(i);
+					if (!err.ok()) throw err;
+				}
+			});
+		}
+		try {
+			group.Wait();
+		} catch (const Error &err) {
+			return err;
+		}
+	} else {
+		for (size_t i = 0; i < items.size(); ++i) {
+			Error err = decodeItem(i);
+			if (!err.ok()) return err;
+		}
+	}
+
+	for (size_t i = 0; i < rtx.steps.size(); ++i) {
+		WALRecord rec(span<uint8_t>(rtx.steps[i].second));
+		if (rec.type == WalItemModify) {
+			rtx.tx.Modify(std::move(items[i]), static_cast<ItemModifyMode>(rec.itemModify.modifyMode));
+		} else {
+			Query q;
+			q.FromSQL(rec.data);
+			rtx.tx.Modify(std::move(q));
+		}
+	}
+	rtx.steps.clear();
+	return {};
+}
+
 void Replicator::checkNoOpenedTransaction(std::string_view nsName, Namespace::Ptr slaveNs) {
 	std::lock_guard<std::mutex> lck(syncMtx_);
-	Transaction &tx = transactions_[slaveNs.get()];
-	if (!tx.IsFree()) {
+	auto it = transactions_.find(slaveNs.get());
+	if (it != transactions_.end() && !it->second.tx.IsFree()) {
 		logPrintf(LogError, "[repl:%s]:%d Transaction started but not commited", nsName, config_.serverId);
-		tx = Transaction{};
+		transactions_.erase(it);
 	}
 }
 
@@ -837,6 +1047,17 @@ Error Replicator::syncMetaForced(Namespace::Ptr slaveNs, std::string_view nsName
 	return errOK;
 }
 
+std::vector<NamespaceReplicationStat> Replicator::GetReplicationStats() {
+	auto stats = replStats_.Get();
+	std::lock_guard<std::mutex> lck(syncMtx_);
+	for (auto &stat : stats) {
+		auto it = pendedUpdates_.find(stat.name);
+		if (it != pendedUpdates_.end()) stat.pendedUpdates = it->second.container.size();
+		stat.queuedUpdates = updatesApplier_.PendingCount(stat.name);
+	}
+	return stats;
+}
+
 // Callback from WAL updates pusher
 void Replicator::OnWALUpdate(LSNPair LSNs, std::string_view nsName, const WALRecord &wrec) {
 	auto sId = LSNs.originLSN_.Server();
@@ -849,23 +1070,106 @@ void Replicator::OnWALUpdate(LSNPair LSNs, std::string_view nsName, const WALRec
 	}
 	logPrintf(LogTrace, "[repl:%s:%s]:%d OnWALUpdate state = %d upstreamLSN = %s", nsName, slave_->storagePath_, config_.serverId,
 			  state_.load(std::memory_order_acquire), LSNs.upstreamLSN_);
+	replStats_.OnReceived(nsName, LSNs.upstreamLSN_, 1, wrec.DataSize());
 	if (!canApplyUpdate(LSNs, nsName, wrec)) return;
-	Error err;
-	auto slaveNs = slave_->getNamespaceNoThrow(nsName, dummyCtx_);
 
-	// necessary for cutting off onWALUpdate already arrived in applyWal (it is possible!)
-	if (slaveNs && !LSNs.upstreamLSN_.isEmpty()) {
-		auto replState = slaveNs->GetReplState(dummyCtx_);
-		if (!replState.lastUpstreamLSN.isEmpty()) {
-			if (replState.lastUpstreamLSN >= LSNs.upstreamLSN_) {
-				logPrintf(LogTrace,
-						  "[repl:%s:%s]:%d OnWALUpdate old record state = %d upstreamLSN = %s replState.lastUpstreamLSN=%d wrec.type = %d",
-						  nsName, slave_->storagePath_, config_.serverId, state_.load(std::memory_order_acquire), LSNs.upstreamLSN_,
-						  replState.lastUpstreamLSN, wrec.type);
+	if (updatesApplier_.IsRunning()) {
+		switch (wrec.type) {
+			case WalNamespaceAdd:
+			case WalNamespaceDrop:
+			case WalNamespaceRename:
+			case WalForceSync:
+			case WalWALSync:
+				// Records, which affect the set of namespaces, are applied after all the previous updates
+				updatesApplier_.WaitIdle();
+				break;
+			default:
+				updatesApplier_.Push(LSNs, nsName, wrec);
 				return;
-			}
 		}
 	}
+	applyOnlineUpdate(LSNs, nsName, wrec);
+}
+
+void Replicator::applyOnlineUpdates(std::string_view nsName, span<UpdatesApplier::Update> updates) {
+	// Consecutive item modifications are applied as a single batch under one namespace lock
+	for (size_t i = 0; i < updates.size();) {
+		size_t end = i;
+		while (end < updates.size() && updates[end].rec.type == WalItemModify && !updates[end].rec.inTransaction) {
+			++end;
+		}
+		if (end - i > 1) {
+			applyItemsBatch(nsName, updates.subspan(i, end - i));
+			i = end;
+		} else {
+			applyOnlineUpdate(updates[i].LSNs, nsName, updates[i].rec);
+			++i;
+		}
+	}
+}
+
+void Replicator::applyItemsBatch(std::string_view nsName, span<UpdatesApplier::Update> updates) {
+	auto slaveNs = slave_->getNamespaceNoThrow(nsName, dummyCtx_);
+	if (!slaveNs) {
+		for (auto &upd : updates) applyOnlineUpdate(upd.LSNs, nsName, upd.rec);
+		return;
+	}
+	checkNoOpenedTransaction(nsName, slaveNs);
+
+	const lsn_t lastUpstreamLSN = slaveNs->GetReplState(dummyCtx_).lastUpstreamLSN;
+	const auto tm = master_->NewItem(nsName).impl_->tagsMatcher();
+	std::vector<ItemModification> mods;
+	mods.reserve(updates.size());
+	for (auto &upd : updates) {
+		if (isStaleUpdate(upd.LSNs, nsName, lastUpstreamLSN, upd.rec)) continue;
+		Item item = slaveNs->NewItem(dummyCtx_);
+		Error err = unpackItem(item, upd.LSNs.upstreamLSN_, upd.rec.itemModify.itemCJson, tm);
+		if (!err.ok()) {
+			onOnlineUpdateError(nsName, slaveNs, err);
+			continue;
+		}
+		mods.push_back({std::move(item), static_cast<ItemModifyMode>(upd.rec.itemModify.modifyMode), upd.LSNs, Error()});
+	}
+	if (mods.empty()) return;
+
+	try {
+		slaveNs->ModifyBatch(mods, dummyCtx_);
+	} catch (const Error &err) {
+		onOnlineUpdateError(nsName, slaveNs, err);
+		return;
+	}
+	LSNPair lastApplied;
+	size_t appliedCount = 0;
+	for (auto &mod : mods) {
+		if (mod.err.ok()) {
+			++appliedCount;
+			if (!mod.LSNs.upstreamLSN_.isEmpty()) lastApplied = mod.LSNs;
+		} else {
+			onOnlineUpdateError(nsName, slaveNs, mod.err);
+		}
+	}
+	if (!lastApplied.upstreamLSN_.isEmpty()) setReplLSNs(slaveNs, lastApplied);
+	replStats_.OnApplied(nsName, lastApplied.upstreamLSN_, appliedCount);
+}
+
+bool Replicator::isStaleUpdate(LSNPair LSNs, std::string_view nsName, lsn_t lastUpstreamLSN, const WALRecord &wrec) {
+	// necessary for cutting off onWALUpdate already arrived in applyWal (it is possible!)
+	if (!LSNs.upstreamLSN_.isEmpty() && !lastUpstreamLSN.isEmpty() && lastUpstreamLSN >= LSNs.upstreamLSN_) {
+		logPrintf(LogTrace, "[repl:%s:%s]:%d OnWALUpdate old record state = %d upstreamLSN = %s replState.lastUpstreamLSN=%d wrec.type = %d",
+				  nsName, slave_->storagePath_, config_.serverId, state_.load(std::memory_order_acquire), LSNs.upstreamLSN_,
+				  lastUpstreamLSN, wrec.type);
+		return true;
+	}
+	return false;
+}
+
+void Replicator::applyOnlineUpdate(LSNPair LSNs, std::string_view nsName, const WALRecord &wrec) {
+	Error err;
+	auto slaveNs = slave_->getNamespaceNoThrow(nsName, dummyCtx_);
+
+	if (slaveNs && !LSNs.upstreamLSN_.isEmpty() && isStaleUpdate(LSNs, nsName, slaveNs->GetReplState(dummyCtx_).lastUpstreamLSN, wrec)) {
+		return;
+	}
 
 	SyncStat stat;
 	try {
@@ -875,43 +1179,91 @@ void Replicator::OnWALUpdate(LSNPair LSNs, std::string_view nsName, const WALRec
 	}
 	if (err.ok()) {
 		if (slaveNs && shouldUpdateLsn(wrec)) {
-			if (!LSNs.upstreamLSN_.isEmpty()) slaveNs->SetReplLSNs(LSNs, dummyCtx_);
+			if (!LSNs.upstreamLSN_.isEmpty()) setReplLSNs(slaveNs, LSNs);
 		}
+		replStats_.OnApplied(nsName, LSNs.upstreamLSN_, 1);
 	} else {
-		if (slaveNs) {
-			auto replState = slaveNs->GetReplState(dummyCtx_);
-			if (replState.status != ReplicationState::Status::Fatal) {
-				if (replState.replicatorEnabled)
-					slaveNs->SetSlaveReplStatus(ReplicationState::Status::Fatal, err, dummyCtx_);
-				else
-					logPrintf(LogError, "[repl:%s:%s]:%d OnWALUpdate logical error. Replication not allowed for nanespace. Err = %s",
-							  nsName, slave_->storagePath_, config_.serverId, err.what());
+		onOnlineUpdateError(nsName, slaveNs, err);
+	}
+}
+
+void Replicator::setReplLSNs(const Namespace::Ptr &slaveNs, LSNPair LSNs) {
+	slaveNs->SetReplLSNs(LSNs, dummyCtx_);
+	notifyLSNWaiters();
+}
+
+void Replicator::notifyLSNWaiters() {
+	if (lsnWaitersCount_.load(std::memory_order_acquire) > 0) {
+		// Mutex guarantees, that the waiter has either seen the new LSN or is already waiting for the notification
+		std::lock_guard<std::mutex> lck(lsnWaitMtx_);
+		lsnWaitCond_.notify_all();
+	}
+}
+
+void Replicator::WaitUpstreamLSN(const Namespace::Ptr &ns, lsn_t lsn, std::chrono::milliseconds timeout, const RdxContext &ctx) {
+	auto isApplied = [&] {
+		const auto replState = ns->GetReplState(ctx);
+		if (!replState.slaveMode) return true;
+		return !replState.lastUpstreamLSN.isEmpty() && replState.lastUpstreamLSN.Counter() >= lsn.Counter();
+	};
+	if (isApplied()) return;
+
+	// Waiting is interrupted periodically to check the query's cancellation
+	constexpr auto kCancelCheckPeriod = std::chrono::milliseconds(100);
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	lsnWaitersCount_.fetch_add(1, std::memory_order_acq_rel);
+	std::unique_lock<std::mutex> lck(lsnWaitMtx_);
+	try {
+		while (!isApplied()) {
+			const auto now = std::chrono::steady_clock::now();
+			if (now >= deadline) {
+				throw Error(errTimeout, "LSN %s was not applied to namespace '%s' during %dms", lsn, ns->GetName(ctx), timeout.count());
 			}
+			ThrowOnCancel(ctx, "Waiting for LSN was canceled");
+			lsnWaitCond_.wait_until(lck, std::min(deadline, now + kCancelCheckPeriod));
 		}
-		auto lastErrIt = lastNsErrMsg_.find(nsName);
-		if (lastErrIt == lastNsErrMsg_.end()) {
-			lastErrIt = lastNsErrMsg_.emplace(string(nsName), NsErrorMsg{}).first;
+	} catch (...) {
+		lsnWaitersCount_.fetch_sub(1, std::memory_order_acq_rel);
+		throw;
+	}
+	lsnWaitersCount_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void Replicator::onOnlineUpdateError(std::string_view nsName, const Namespace::Ptr &slaveNs, const Error &err) {
+	if (slaveNs) {
+		auto replState = slaveNs->GetReplState(dummyCtx_);
+		if (replState.status != ReplicationState::Status::Fatal) {
+			if (replState.replicatorEnabled)
+				slaveNs->SetSlaveReplStatus(ReplicationState::Status::Fatal, err, dummyCtx_);
+			else
+				logPrintf(LogError, "[repl:%s:%s]:%d OnWALUpdate logical error. Replication not allowed for nanespace. Err = %s", nsName,
+						  slave_->storagePath_, config_.serverId, err.what());
 		}
-		auto &lastErr = lastErrIt->second;
-		bool isDifferentError = lastErr.err.what() != err.what();
-		if (isDifferentError || lastErr.count == static_cast<uint64_t>(config_.onlineReplErrorsThreshold)) {
-			if (!lastErr.err.ok() && lastErr.count > 1) {
-				logPrintf(LogError, "[repl:%s]:%d Error apply WAL update: %s. Repeated %d times", nsName, config_.serverId, err.what(),
-						  lastErr.count - 1);
-			} else {
-				logPrintf(LogError, "[repl:%s]:%d Error apply WAL update: %s", nsName, config_.serverId, err.what());
-			}
-			lastErr.count = 1;
-			if (!isDifferentError) {
-				lastErr.err = err;
-			}
+	}
+	std::lock_guard<std::mutex> lck(lastNsErrMsgMtx_);
+	auto lastErrIt = lastNsErrMsg_.find(nsName);
+	if (lastErrIt == lastNsErrMsg_.end()) {
+		lastErrIt = lastNsErrMsg_.emplace(string(nsName), NsErrorMsg{}).first;
+	}
+	auto &lastErr = lastErrIt->second;
+	bool isDifferentError = lastErr.err.what() != err.what();
+	if (isDifferentError || lastErr.count == static_cast<uint64_t>(config_.onlineReplErrorsThreshold)) {
+		if (!lastErr.err.ok() && lastErr.count > 1) {
+			logPrintf(LogError, "[repl:%s]:%d Error apply WAL update: %s. Repeated %d times", nsName, config_.serverId, err.what(),
+					  lastErr.count - 1);
 		} else {
-			++lastErr.count;
+			logPrintf(LogError, "[repl:%s]:%d Error apply WAL update: %s", nsName, config_.serverId, err.what());
 		}
-
-		if (config_.forceSyncOnLogicError) {
-			resync_.send();
+		lastErr.count = 1;
+		if (!isDifferentError) {
+			lastErr.err = err;
 		}
+	} else {
+		++lastErr.count;
+	}
+
+	if (config_.forceSyncOnLogicError) {
+		resync_.send();
 	}
 }
 
@@ -1,20 +1,23 @@
 #pragma once
 
+#include <condition_variable>
 #include <string>
 #include <thread>
+#include "client/queryresults.h"
 #include "core/dbconfig.h"
 #include "core/namespace/namespace.h"
 #include "core/namespace/namespacestat.h"
 #include "estl/atomic_unique_ptr.h"
 #include "estl/fast_hash_map.h"
 #include "net/ev/ev.h"
+#include "replicationstat.h"
 #include "tools/errors.h"
+#include "updatesapplier.h"
 #include "updatesobserver.h"
 
 namespace reindexer {
 namespace client {
 class Reindexer;
-class QueryResults;
 }  // namespace client
 
 class ReindexerImpl;
@@ -27,18 +30,28 @@ public:
 	Error Start();
 	void Stop();
 	void Enable() { enabled_.store(true, std::memory_order_release); }
+	// Live replication statistics of the namespaces, which were updated by the master
+	std::vector<NamespaceReplicationStat> GetReplicationStats();
+	// Wait until the master's LSN is applied to the slave namespace. Returns immediately for the non-slave namespaces
+	void WaitUpstreamLSN(const Namespace::Ptr &ns, lsn_t lsn, std::chrono::milliseconds timeout, const RdxContext &ctx);
 
 protected:
 	struct SyncStat {
 		ReplicationState masterState;
 		Error lastError;
 		int updated = 0, deleted = 0, errors = 0, updatedIndexes = 0, deletedIndexes = 0, updatedMeta = 0, processed = 0, schemasSet = 0;
+		size_t recvBytes = 0;
 		WrSerializer &Dump(WrSerializer &ser);
 	};
 	struct NsErrorMsg {
 		Error err;
 		uint64_t count = 0;
 	};
+	struct ReplTransaction {
+		Transaction tx;
+		// Item modifications and update queries of the transaction with their upstream LSNs. They are added to tx on commit
+		std::vector<std::pair<lsn_t, PackedWALRecord>> steps;
+	};
 
 	void run();
 	void stop();
@@ -48,8 +61,12 @@ protected:
 	Error syncDatabase();
 	// Read and apply WAL from master
 	Error syncNamespaceByWAL(const NamespaceDef &ns);
+	// Replace items of the data hash buckets, which differ from master's ones
+	Error syncDataHashBuckets(const NamespaceDef &ns);
 	// Apply WAL from master to namespace
 	Error applyWAL(Namespace::Ptr slaveNs, client::QueryResults &qr, const NamespaceDef *nsDef = nullptr);
+	// Bulk load the rest of the forced sync results into the empty namespace
+	Error bulkLoadItems(Namespace::Ptr slaveNs, client::QueryResults &qr, client::QueryResults::Iterator &it, SyncStat &stat);
 	// Sync indexes of namespace
 	Error syncIndexesForced(Namespace::Ptr slaveNs, const NamespaceDef &masterNsDef);
 	// Sync namespace schema
@@ -63,11 +80,27 @@ protected:
 						 const NamespaceDef * = nullptr);
 	// Apply single transaction WAL record
 	Error applyTxWALRecord(LSNPair LSNs, std::string_view nsName, Namespace::Ptr ns, const WALRecord &wrec);
+	Error doApplyTxWALRecord(LSNPair LSNs, std::string_view nsName, Namespace::Ptr ns, const WALRecord &wrec);
+	// Decode buffered steps of the replicated transaction and add them to the transaction
+	Error buildTransaction(std::string_view nsName, ReplTransaction &rtx);
 	void checkNoOpenedTransaction(std::string_view nsName, Namespace::Ptr slaveNs);
 	// Apply single cjson item
 	Error modifyItem(LSNPair LSNs, Namespace::Ptr ns, std::string_view cjson, int modifyMode, const TagsMatcher &tm, SyncStat &stat);
 	static Error unpackItem(Item &, lsn_t, std::string_view cjson, const TagsMatcher &tm);
 
+	// Apply online WAL update from master
+	void applyOnlineUpdate(LSNPair LSNs, std::string_view nsName, const WALRecord &wrec);
+	// Apply consecutive online WAL updates of the single namespace
+	void applyOnlineUpdates(std::string_view nsName, span<UpdatesApplier::Update> updates);
+	// Apply online item modifications under the single namespace lock
+	void applyItemsBatch(std::string_view nsName, span<UpdatesApplier::Update> updates);
+	// Check if update was already applied by the WAL sync
+	bool isStaleUpdate(LSNPair LSNs, std::string_view nsName, lsn_t lastUpstreamLSN, const WALRecord &wrec);
+	void onOnlineUpdateError(std::string_view nsName, const Namespace::Ptr &slaveNs, const Error &err);
+	// Set namespace's upstream LSNs and wake up the queries, which wait for them
+	void setReplLSNs(const Namespace::Ptr &slaveNs, LSNPair LSNs);
+	void notifyLSNWaiters();
+
 	void OnWALUpdate(LSNPair LSNs, std::string_view nsName, const WALRecord &walRec) override final;
 	void OnUpdatesLost(std::string_view nsName) override final;
 	void OnConnectionState(const Error &err) override final;
@@ -110,8 +143,14 @@ protected:
 	std::atomic<bool> enabled_;
 
 	const RdxContext dummyCtx_;
-	std::unordered_map<const Namespace *, Transaction> transactions_;
+	std::unordered_map<const Namespace *, ReplTransaction> transactions_;
 	fast_hash_map<string, NsErrorMsg, nocase_hash_str, nocase_equal_str> lastNsErrMsg_;
+	std::mutex lastNsErrMsgMtx_;
+	UpdatesApplier updatesApplier_;
+	ReplicationStatTracker replStats_;
+	std::mutex lsnWaitMtx_;
+	std::condition_variable lsnWaitCond_;
+	std::atomic<int> lsnWaitersCount_ = {0};
 
 	class SyncQuery {
 	public:
@@ -0,0 +1,111 @@
+#include "updatesapplier.h"
+#include "tools/assertrx.h"
+
+namespace reindexer {
+
+void UpdatesApplier::Start(int workersCount) {
+	assertrx(workers_.empty());
+	if (workersCount <= 0) return;
+	{
+		std::lock_guard lck(mtx_);
+		stopped_ = false;
+	}
+	workers_.reserve(workersCount);
+	for (int i = 0; i < workersCount; ++i) {
+		workers_.emplace_back([this] { run(); });
+	}
+}
+
+void UpdatesApplier::Stop() {
+	{
+		std::lock_guard lck(mtx_);
+		stopped_ = true;
+	}
+	readyCond_.notify_all();
+	pendingCond_.notify_all();
+	for (auto &worker : workers_) worker.join();
+	workers_.clear();
+
+	std::lock_guard lck(mtx_);
+	queues_.clear();
+	ready_.clear();
+	pendingCount_ = 0;
+}
+
+void UpdatesApplier::Push(LSNPair LSNs, std::string_view nsName, const WALRecord &wrec) {
+	PackedWALRecord pwrec;
+	pwrec.Pack(wrec);
+
+	std::unique_lock lck(mtx_);
+	pendingCond_.wait(lck, [this] { return stopped_ || pendingCount_ < kMaxPendingUpdates; });
+	if (stopped_) return;
+	auto it = queues_.find(nsName);
+	if (it == queues_.end()) {
+		it = queues_.emplace(std::string(nsName), NsQueue()).first;
+	}
+	auto &queue = it.value();
+	queue.records.emplace_back(LSNs, std::move(pwrec));
+	++pendingCount_;
+	if (!queue.scheduled) {
+		queue.scheduled = true;
+		ready_.emplace_back(it->first);
+		readyCond_.notify_one();
+	}
+}
+
+void UpdatesApplier::WaitIdle() {
+	std::unique_lock lck(mtx_);
+	pendingCond_.wait(lck, [this] { return stopped_ || pendingCount_ == 0; });
+}
+
+size_t UpdatesApplier::PendingCount(std::string_view nsName) const {
+	std::lock_guard lck(mtx_);
+	auto it = queues_.find(nsName);
+	return it == queues_.end() ? 0 : it->second.records.size();
+}
+
+void UpdatesApplier::run() {
+	std::unique_lock lck(mtx_);
+	for (;;) {
+		readyCond_.wait(lck, [this] { return stopped_ || !ready_.empty(); });
+		if (stopped_) return;
+
+		std::string nsName = std::move(ready_.front());
+		ready_.pop_front();
+		auto it = queues_.find(nsName);
+		assertrx(it != queues_.end());
+		auto records = std::move(it.value().records);
+		it.value().records.clear();
+		lck.unlock();
+
+		// Updates, which were queued while the previous batch was applied, are applied together without waiting for the new ones
+		std::vector<Update> batch;
+		batch.reserve(std::min(records.size(), kMaxBatchSize));
+		for (auto &rec : records) {
+			batch.push_back({rec.first, WALRecord(span<uint8_t>(rec.second))});
+			if (batch.size() == kMaxBatchSize) {
+				applyFn_(nsName, batch);
+				batch.clear();
+			}
+		}
+		if (!batch.empty()) {
+			applyFn_(nsName, batch);
+		}
+
+		lck.lock();
+		if (stopped_) return;
+		pendingCount_ -= records.size();
+		// Namespace is rescheduled to the end of the ready list, so the other namespaces are not starved
+		it = queues_.find(nsName);
+		assertrx(it != queues_.end());
+		if (it->second.records.empty()) {
+			queues_.erase(it);
+		} else {
+			ready_.emplace_back(std::move(nsName));
+			readyCond_.notify_one();
+		}
+		pendingCond_.notify_all();
+	}
+}
+
+}  // namespace reindexer
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/lsn.h"
+#include "estl/fast_hash_map.h"
+#include "tools/stringstools.h"
+#include "walrecord.h"
+
+namespace reindexer {
+
+/// Applies online WAL updates of the different namespaces concurrently. Each namespace has its own queue, which is drained by a single
+/// worker at a time, so the updates of the namespace are applied in the order of arrival (i.e. in the LSN order), while the independent
+/// namespaces are applied by the different workers of the pool
+class UpdatesApplier {
+public:
+	struct Update {
+		LSNPair LSNs;
+		WALRecord rec;
+	};
+	/// Receives the consecutive updates of the single namespace, so they may be applied as a batch
+	using ApplyFnT = std::function<void(std::string_view nsName, span<Update> updates)>;
+
+	/// Maximum count of the queued updates. Push blocks, when it is reached
+	static constexpr size_t kMaxPendingUpdates = 100000;
+	/// Maximum count of the updates, passed to ApplyFnT at once. Limits the time, while the namespace is locked by the batch
+	static constexpr size_t kMaxBatchSize = 1000;
+
+	explicit UpdatesApplier(ApplyFnT applyFn) : applyFn_(std::move(applyFn)) {}
+	UpdatesApplier(const UpdatesApplier &) = delete;
+	UpdatesApplier &operator=(const UpdatesApplier &) = delete;
+	~UpdatesApplier() { Stop(); }
+
+	void Start(int workersCount);
+	/// Stops the workers. Updates, which were not applied yet, are dropped
+	void Stop();
+	bool IsRunning() const noexcept { return !workers_.empty(); }
+	/// Adds update to the queue of its namespace. Update is dropped, if applier is stopped
+	void Push(LSNPair LSNs, std::string_view nsName, const WALRecord &wrec);
+	/// Waits until all of the queued updates are applied
+	void WaitIdle();
+	/// Count of the queued updates of the namespace, which are not taken by the workers yet
+	size_t PendingCount(std::string_view nsName) const;
+
+private:
+	struct NsQueue {
+		std::deque<std::pair<LSNPair, PackedWALRecord>> records;
+		// Namespace is in the ready list or is processed by one of the workers
+		bool scheduled = false;
+	};
+
+	void run();
+
+	ApplyFnT applyFn_;
+	fast_hash_map<std::string, NsQueue, nocase_hash_str, nocase_equal_str> queues_;
+	std::deque<std::string> ready_;
+	size_t pendingCount_ = 0;
+	bool stopped_ = true;
+	mutable std::mutex mtx_;
+	std::condition_variable readyCond_, pendingCond_;
+	std::vector<std::thread> workers_;
+};
+
+}  // namespace reindexer
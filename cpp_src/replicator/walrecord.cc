@@ -31,6 +31,7 @@ void WALRecord::Pack(WrSerializer &ser) const {
 		case WalForceSync:
 		case WalWALSync:
 		case WalSetSchema:
+		case WalDataHashBuckets:
 			ser.PutVString(data);
 			break;
 		case WalPutMeta:
@@ -56,6 +57,28 @@ void WALRecord::Pack(WrSerializer &ser) const {
 	}
 }
 
+size_t WALRecord::DataSize() const noexcept {
+	switch (type) {
+		case WalUpdateQuery:
+		case WalIndexAdd:
+		case WalIndexDrop:
+		case WalIndexUpdate:
+		case WalReplState:
+		case WalNamespaceRename:
+		case WalForceSync:
+		case WalWALSync:
+		case WalSetSchema:
+		case WalDataHashBuckets:
+			return data.size();
+		case WalPutMeta:
+			return putMeta.key.size() + putMeta.value.size();
+		case WalItemModify:
+			return itemModify.itemCJson.size();
+		default:
+			return 0;
+	}
+}
+
 WALRecord::WALRecord(span<uint8_t> packed) {
 	if (!packed.size()) {
 		type = WalEmpty;
@@ -83,6 +106,7 @@ WALRecord::WALRecord(span<uint8_t> packed) {
 		case WalForceSync:
 		case WalWALSync:
 		case WalSetSchema:
+		case WalDataHashBuckets:
 			data = ser.GetVString();
 			break;
 		case WalPutMeta:
@@ -143,6 +167,8 @@ static std::string_view wrecType2Str(WALRecType t) {
 			return "WalWALSync"sv;
 		case WalSetSchema:
 			return "WalSetSchema"sv;
+		case WalDataHashBuckets:
+			return "WalDataHashBuckets"sv;
 		default:
 			return "<Unknown>"sv;
 	}
@@ -170,6 +196,7 @@ WrSerializer &WALRecord::Dump(WrSerializer &ser, std::function<string(std::strin
 		case WalForceSync:
 		case WalWALSync:
 		case WalSetSchema:
+		case WalDataHashBuckets:
 			return ser << ' ' << data;
 		case WalPutMeta:
 			return ser << ' ' << putMeta.key << "=" << putMeta.value;
@@ -225,6 +252,9 @@ void WALRecord::GetJSON(JsonBuilder &jb, std::function<string(std::string_view)>
 		case WalSetSchema:
 			jb.Raw("schema", data);
 			return;
+		case WalDataHashBuckets:
+			jb.Raw("data_hash_buckets", data);
+			return;
 		default:
 			fprintf(stderr, "Unexpected WAL rec type %d\n", int(type));
 			std::abort();
@@ -30,6 +30,7 @@ enum WALRecType {
 	WalForceSync = 14,
 	WalSetSchema = 15,
 	WalWALSync = 16,
+	WalDataHashBuckets = 17,
 };
 
 class WrSerializer;
@@ -60,6 +61,8 @@ struct WALRecord {
 	WrSerializer &Dump(WrSerializer &ser, std::function<std::string(std::string_view)> cjsonViewer) const;
 	void GetJSON(JsonBuilder &jb, std::function<string(std::string_view)> cjsonViewer) const;
 	void Pack(WrSerializer &ser) const;
+	// Size of the record's variable length data (cjson, query, meta, etc.)
+	size_t DataSize() const noexcept;
 	SharedWALRecord GetShared(int64_t lsn, int64_t upstreamLSN, std::string_view nsName) const;
 
 	WALRecType type;
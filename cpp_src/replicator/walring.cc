@@ -0,0 +1,103 @@
+#include "walring.h"
+#include <snappy.h>
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+void WALRing::Reset(int64_t capacity, int64_t allocated) {
+	assertrx(allocated <= capacity);
+	blocks_.clear();
+	openBlocks_.clear();
+	capacity_ = capacity;
+	allocated_ = allocated;
+	heapSize_ = 0;
+}
+
+PackedWALRecord WALRing::Put(int64_t pos, const WALRecord &rec) {
+	assertrx(pos >= 0 && pos < capacity_);
+	const int64_t idx = pos / kBlockSize;
+	const size_t i = pos % kBlockSize;
+	if (idx >= int64_t(blocks_.size())) blocks_.resize(idx + 1);
+	allocated_ = std::max(allocated_, pos + 1);
+
+	Block &block = blocks_[idx];
+	if (block.sealed && rec.type == WalEmpty) {
+		// Records of the removed items are emptied often, so it's done without the decompression
+		if (int64_t(i) < block.count) block.emptied.set(i);
+		return PackedWALRecord();
+	}
+	if (!block.open) open(idx);
+	if (i >= block.records.size()) block.records.resize(i + 1);
+
+	PackedWALRecord &packed = block.records[i];
+	PackedWALRecord prev = std::move(packed);
+	heapSize_ -= prev.heap_size();
+	packed = PackedWALRecord();
+	packed.Pack(rec);
+	heapSize_ += packed.heap_size();
+	return prev;
+}
+
+span<uint8_t> WALRing::Get(int64_t pos, ReadCache &cache) const {
+	const int64_t idx = pos / kBlockSize;
+	const size_t i = pos % kBlockSize;
+	if (idx >= int64_t(blocks_.size())) return {};
+	const Block &block = blocks_[idx];
+	if (!block.sealed) return i < block.records.size() ? span<uint8_t>(block.records[i]) : span<uint8_t>();
+	if (cache.block != idx) {
+		unpack(block, cache.records);
+		cache.block = idx;
+	}
+	return i < cache.records.size() ? span<uint8_t>(cache.records[i]) : span<uint8_t>();
+}
+
+void WALRing::open(int64_t idx) {
+	Block &block = blocks_[idx];
+	if (block.sealed) {
+		unpack(block, block.records);
+		for (const auto &rec : block.records) heapSize_ += rec.heap_size();
+		heapSize_ -= block.compressed.capacity();
+		std::string().swap(block.compressed);
+		block.emptied.reset();
+		block.sealed = false;
+	}
+	block.open = true;
+	openBlocks_.push_back(idx);
+	while (openBlocks_.size() > kMaxOpenBlocks) {
+		seal(openBlocks_.front());
+		openBlocks_.pop_front();
+	}
+}
+
+void WALRing::seal(int64_t idx) {
+	Block &block = blocks_[idx];
+	assertrx(block.open);
+	WrSerializer ser;
+	for (const auto &rec : block.records) {
+		ser.PutVString(std::string_view(reinterpret_cast<const char *>(rec.data()), rec.size()));
+		heapSize_ -= rec.heap_size();
+	}
+	snappy::Compress(reinterpret_cast<const char *>(ser.Buf()), ser.Len(), &block.compressed);
+	block.compressed.shrink_to_fit();
+	heapSize_ += block.compressed.capacity();
+	block.count = block.records.size();
+	std::vector<PackedWALRecord>().swap(block.records);
+	block.sealed = true;
+	block.open = false;
+}
+
+void WALRing::unpack(const Block &block, std::vector<PackedWALRecord> &records) const {
+	std::string data;
+	if (!snappy::Uncompress(block.compressed.data(), block.compressed.size(), &data)) {
+		throw Error(errLogic, "Can't decompress WAL block");
+	}
+	Serializer ser(data);
+	records.clear();
+	records.resize(block.count);
+	for (int64_t i = 0; i < block.count; ++i) {
+		const std::string_view rec = ser.GetVString();
+		if (!block.emptied.test(i)) records[i].assign(rec.begin(), rec.end());
+	}
+}
+
+}  // namespace reindexer
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <bitset>
+#include <deque>
+#include <string>
+#include <vector>
+#include "walrecord.h"
+
+namespace reindexer {
+
+/// Ring buffer of the WAL records. Positions are grouped into the blocks of kBlockSize records. Recently written blocks keep the packed
+/// records as is, and the rest of them are sealed: their records are serialized into one buffer and compressed. Sealed block is
+/// decompressed on demand into the reader's cache, and it's opened again only to overwrite its records
+class WALRing {
+public:
+	static constexpr int64_t kBlockSize = 256;
+	/// Max count of the open blocks. The block, which was opened first, is sealed, when this count is exceeded
+	static constexpr size_t kMaxOpenBlocks = 8;
+
+	/// Decompressed sealed block, which is kept by the reader between the calls
+	struct ReadCache {
+		int64_t block = -1;
+		std::vector<PackedWALRecord> records;
+	};
+
+	/// Clears the ring
+	/// @param capacity - Count of the positions
+	/// @param allocated - Count of the positions, which are treated as written (with empty records)
+	void Reset(int64_t capacity, int64_t allocated);
+	int64_t Capacity() const noexcept { return capacity_; }
+	/// Count of the positions, which were written at least once
+	int64_t Allocated() const noexcept { return allocated_; }
+	/// Puts the record into the position
+	/// @return previous record of the position. It's not returned for the empty record, which is put into the sealed block
+	PackedWALRecord Put(int64_t pos, const WALRecord &rec);
+	/// Gets the packed record from the position. Span is valid until the next modification of the ring or the next call with the same
+	/// cache
+	span<uint8_t> Get(int64_t pos, ReadCache &cache) const;
+	/// @return memory consumption of the records
+	size_t HeapSize() const noexcept { return heapSize_ + blocks_.capacity() * sizeof(Block); }
+
+private:
+	struct Block {
+		// Records of the open block
+		std::vector<PackedWALRecord> records;
+		// Sizes and data of the records of the sealed block, compressed with snappy
+		std::string compressed;
+		// Records, which were emptied after the block was sealed
+		std::bitset<kBlockSize> emptied;
+		// Count of the records of the sealed block
+		int64_t count = 0;
+		bool sealed = false;
+		bool open = false;
+	};
+
+	void open(int64_t idx);
+	void seal(int64_t idx);
+	void unpack(const Block &block, std::vector<PackedWALRecord> &records) const;
+
+	std::vector<Block> blocks_;
+	std::deque<int64_t> openBlocks_;
+	int64_t capacity_ = 0;
+	int64_t allocated_ = 0;
+	size_t heapSize_ = 0;
+};
+
+}  // namespace reindexer
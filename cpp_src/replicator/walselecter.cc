@@ -27,20 +27,28 @@ void WALSelecter::operator()(QueryResults &result, SelectCtx &params) {
 
 	int lsnIdx = -1;
 	int versionIdx = -1;
+	int bucketsIdx = -1;
 	for (size_t i = 0; i < q.entries.Size(); ++i) {
 		q.entries.InvokeAppropriate<void>(
 			i,
-			[&lsnIdx, &versionIdx, i](const QueryEntry &qe) {
+			[&lsnIdx, &versionIdx, &bucketsIdx, i](const QueryEntry &qe) {
 				if ("#lsn"sv == qe.index) {
 					lsnIdx = i;
 				} else if ("#slave_version"sv == qe.index) {
 					versionIdx = i;
+				} else if ("#data_hash_buckets"sv == qe.index) {
+					bucketsIdx = i;
 				} else {
 					throw Error(errLogic, "Unexpected index in WAL select query: %s", qe.index);
 				}
 			},
 			[&q](const auto &) { throw Error(errLogic, "Unexpected WAL select query: %s", q.GetSQL()); });
 	}
+	if (bucketsIdx >= 0) {
+		selectDataHashBuckets(result, q.entries.Get<QueryEntry>(bucketsIdx), start, count);
+		putReplState(result);
+		return;
+	}
 	auto slaveVersion = versionIdx < 0 ? SemVersion() : SemVersion(q.entries.Get<QueryEntry>(versionIdx).values[0].As<string>());
 	auto &lsnEntry = q.entries.Get<QueryEntry>(lsnIdx);
 	if (lsnEntry.values.size() == 1 && lsnEntry.condition == CondGt) {
@@ -51,18 +59,21 @@ void WALSelecter::operator()(QueryResults &result, SelectCtx &params) {
 			throw Error(errOutdatedWAL, "Query to WAL with outdated LSN %ld, LSN counter %ld walSize = %d count = %d", int64_t(fromLSN),
 						ns_->wal_.LSNCounter(), ns_->wal_.size(), count);
 
-		const auto walEnd = ns_->wal_.end();
-		for (auto it = ns_->wal_.upper_bound(fromLSN.Counter()); count && it != walEnd; ++it) {
-			WALRecord rec = *it;
+		auto addRecord = [&](int64_t lsn, const WALRecord &rec, span<uint8_t> data, bool spilled) {
 			switch (rec.type) {
 				case WalItemUpdate:
+					// Spilled record is stale, if item was removed or updated after it
+					if (spilled && (rec.id < 0 || size_t(rec.id) >= ns_->items_.size() || ns_->items_[rec.id].IsFree() ||
+									lsn_t(ns_->items_[rec.id].GetLSN()).Counter() != lsn)) {
+						break;
+					}
 					if (ns_->items_[rec.id].IsFree()) break;
 					if (start) {
 						start--;
 					} else if (count) {
 						// Put as usual ItemRef
-						assertf(lsn_t(ns_->items_[rec.id].GetLSN()).Counter() == (lsn_t(it.GetLSN()).Counter()), "lsn %ld != %ld, ns=%s",
-								ns_->items_[rec.id].GetLSN(), it.GetLSN(), ns_->name_);
+						assertf(lsn_t(ns_->items_[rec.id].GetLSN()).Counter() == lsn, "lsn %ld != %ld, ns=%s", ns_->items_[rec.id].GetLSN(),
+								lsn, ns_->name_);
 						result.Add(ItemRef(rec.id, ns_->items_[rec.id]));
 						count--;
 					}
@@ -90,10 +101,9 @@ void WALSelecter::operator()(QueryResults &result, SelectCtx &params) {
 					if (start) {
 						start--;
 					} else if (count) {
-						auto data = it.GetRaw();
 						// Put as ItemRef with raw container
 						PayloadValue pv(data.size(), data.data());
-						pv.SetLSN(it.GetLSN());
+						pv.SetLSN(lsn);
 						result.Add(ItemRef(rec.id, pv, 0, 0, true));
 						count--;
 					}
@@ -104,6 +114,19 @@ void WALSelecter::operator()(QueryResults &result, SelectCtx &params) {
 				default:
 					std::abort();
 			}
+		};
+
+		// Records, which are aged out of the ring buffer, are read from storage
+		const bool fromSpilled = ns_->wal_.is_spilled(fromLSN.Counter() + 1);
+		if (fromSpilled) {
+			ns_->wal_.ForEachSpilled(fromLSN.Counter() + 1, [&](int64_t lsn, span<uint8_t> data) {
+				addRecord(lsn, WALRecord(data), data, true);
+				return count != 0;
+			});
+		}
+		const auto walEnd = ns_->wal_.end();
+		for (auto it = fromSpilled ? ns_->wal_.begin() : ns_->wal_.upper_bound(fromLSN.Counter()); count && it != walEnd; ++it) {
+			addRecord(it.GetLSN(), *it, it.GetRaw(), false);
 		}
 	} else if (lsnEntry.condition == CondAny) {
 		if (start == 0 && !(slaveVersion < kMinUnknownReplSupportRxVersion)) {
@@ -150,6 +173,45 @@ void WALSelecter::operator()(QueryResults &result, SelectCtx &params) {
 	putReplState(result);
 }
 
+void WALSelecter::selectDataHashBuckets(QueryResults &result, const QueryEntry &qe, int start, int count) {
+	// Query contains data hash buckets of the slave. Items of the buckets, which differ from the master's ones, are returned
+	if (qe.condition != CondSet || qe.values.size() != NamespaceImpl::kDataHashBucketsCount) {
+		throw Error(errParams, "Query to data hash buckets should contain condition '#data_hash_buckets IN (...)' with %d values",
+					NamespaceImpl::kDataHashBucketsCount);
+	}
+	std::vector<bool> divergent(NamespaceImpl::kDataHashBucketsCount, false);
+	std::vector<unsigned> divergentBuckets;
+	for (unsigned i = 0; i < NamespaceImpl::kDataHashBucketsCount; ++i) {
+		if (uint64_t(qe.values[i].As<int64_t>()) != ns_->dataHashBuckets_[i]) {
+			divergent[i] = true;
+			divergentBuckets.emplace_back(i);
+		}
+	}
+
+	// List of the divergent buckets precedes their items
+	WrSerializer ser;
+	JsonBuilder jb(ser);
+	jb.Array("buckets", span<unsigned>(divergentBuckets));
+	jb.End();
+	PackedWALRecord wr;
+	wr.Pack(WALRecord(WalDataHashBuckets, ser.Slice()));
+	PayloadValue pv(wr.size(), wr.data());
+	pv.SetLSN(-1);
+	result.Add(ItemRef(-1, pv, 0, 0, true));
+
+	if (divergentBuckets.empty()) return;
+	for (size_t id = 0; count && id < ns_->items_.size(); ++id) {
+		if (ns_->items_[id].IsFree() || !divergent[ns_->dataHashBucket(ns_->items_[id])]) continue;
+		if (start) {
+			start--;
+		} else if (count) {
+			result.Add(ItemRef(id, ns_->items_[id]));
+			count--;
+		}
+		result.totalCount++;
+	}
+}
+
 void WALSelecter::putReplState(QueryResults &result) {
 	WrSerializer ser;
 	JsonBuilder jb(ser);
@@ -5,6 +5,7 @@ namespace reindexer {
 class NamespaceImpl;
 class QueryResults;
 class RdxContext;
+struct QueryEntry;
 struct SelectCtx;
 class WALSelecter {
 public:
@@ -12,6 +13,7 @@ public:
 	void operator()(QueryResults &result, SelectCtx &params);
 
 protected:
+	void selectDataHashBuckets(QueryResults &result, const QueryEntry &qe, int start, int count);
 	void putReplState(QueryResults &result);
 	const NamespaceImpl *ns_;
 };
@@ -1,26 +1,55 @@
 
 #include "waltracker.h"
+#include <chrono>
+#include <thread>
+#include "core/storage/prefetchingreader.h"
 #include "tools/logger.h"
 #include "tools/serializer.h"
 
 #define kStorageWALPrefix "W"
+#define kStorageSpilledWALPrefix "V"
 
 namespace reindexer {
 
+// LSN is stored in big endian, so the order of storage keys matches the order of LSNs
+static std::string spilledKey(int64_t lsn) {
+	std::string key(kStorageSpilledWALPrefix);
+	for (int shift = 56; shift >= 0; shift -= 8) {
+		key.push_back(char((uint64_t(lsn) >> shift) & 0xFF));
+	}
+	return key;
+}
+
+static int64_t spilledKeyLSN(std::string_view key) {
+	uint64_t lsn = 0;
+	for (size_t i = 1; i < key.size(); ++i) {
+		lsn = (lsn << 8) | uint8_t(key[i]);
+	}
+	return int64_t(lsn);
+}
+
+static int64_t spillTime() {
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
 WALTracker::WALTracker(int64_t sz) : walSize_(sz) { logPrintf(LogTrace, "[WALTracker] Create LSN=%ld", lsnCounter_); }
 
 int64_t WALTracker::Add(const WALRecord &rec, lsn_t oldLsn) {
+	// Ring buffer is full and its oldest record is going to be overwritten
+	const bool spillOldest = spillMaxBytes_ > 0 && available(lsnCounter_ - walSize_);
 	int64_t lsn = lsnCounter_++;
 	if (lsnCounter_ > 1 && walOffset_ == (lsnCounter_ - 1) % walSize_) {
 		walOffset_ = lsnCounter_ % walSize_;
 	}
 
-	put(lsn, rec);
+	PackedWALRecord oldest = put(lsn, rec);
+	if (spillOldest) spill(lsn - walSize_, oldest);
 	if (!oldLsn.isEmpty() && available(oldLsn.Counter())) {
 		put(oldLsn.Counter(), WALRecord());
 	}
 	if (rec.type != WalItemUpdate) {
-		writeToStorage(lsn);
+		WALRing::ReadCache cache;
+		writeToStorage(lsn, ring_.Get(lsn % walSize_, cache));
 	}
 	return lsn;
 }
@@ -51,13 +80,21 @@ bool WALTracker::Resize(int64_t sz) {
 	if (filledSize) {
 		maxLSN = lsnCounter_ - 1;
 		minLSN = maxLSN - ((sz > filledSize ? filledSize : sz) - 1);
+		if (spillMaxBytes_ > 0) {
+			WALRing::ReadCache cache;
+			for (auto lsn = maxLSN - filledSize + 1; lsn < minLSN; ++lsn) {
+				const span<uint8_t> rec = ring_.Get(lsn % oldSz, cache);
+				spill(lsn, PackedWALRecord(rec.begin(), rec.end()));
+			}
+		}
 	}
 
-	std::vector<PackedWALRecord> oldRecords;
-	std::swap(records_, oldRecords);
+	WALRing oldRing;
+	std::swap(ring_, oldRing);
 	initPositions(sz, minLSN, maxLSN);
+	WALRing::ReadCache cache;
 	for (auto lsn = minLSN; lsn <= maxLSN; ++lsn) {
-		Set(WALRecord(span<uint8_t>(oldRecords[lsn % oldSz])), lsn);
+		Set(WALRecord(oldRing.Get(lsn % oldSz, cache)), lsn);
 	}
 	return true;
 }
@@ -69,76 +106,195 @@ void WALTracker::SetStorage(std::weak_ptr<datastorage::IDataStorage> storage, bo
 }
 
 void WALTracker::Init(int64_t sz, int64_t minLSN, int64_t maxLSN, std::weak_ptr<datastorage::IDataStorage> storage) {
+	auto stored = ReadFromStorage(storage.lock(), 1);
+	Init(sz, minLSN, maxLSN, std::move(storage), std::move(stored));
+}
+
+void WALTracker::Init(int64_t sz, int64_t minLSN, int64_t maxLSN, std::weak_ptr<datastorage::IDataStorage> storage,
+					  StoredRecords &&stored) {
 	logPrintf(LogTrace, "WALTracker::Init minLSN=%ld, maxLSN=%ld, size=%ld", minLSN, maxLSN, sz);
-	storage_ = storage;
+	storage_ = std::move(storage);
 
 	// input maxLSN of namespace Item or -1 if namespace is empty
-	auto data = readFromStorage(maxLSN);  // return maxLSN of wal record or input value
-										  // new table
+	maxLSN = std::max(maxLSN, stored.maxLSN);
 	initPositions(sz, minLSN, maxLSN);
 	// Fill records from storage
-	for (auto &rec : data) {
+	for (auto &rec : stored.records) {
 		Set(WALRecord(std::string_view(rec.second)), rec.first);
 	}
+	readSpilledFromStorage();
 }
 
-void WALTracker::put(int64_t lsn, const WALRecord &rec) {
-	int64_t pos = lsn % walSize_;
-	if (pos >= int64_t(records_.size())) {
-		records_.resize(uint64_t(pos + 1));
-	}
+void WALTracker::SetSpillLimits(int64_t maxBytes, int64_t ttlSec) {
+	spillMaxBytes_ = maxBytes;
+	spillTTL_ = ttlSec;
+	trimSpilled();
+}
 
-	heapSize_ -= records_[pos].heap_size();
-	records_[pos].Pack(rec);
-	heapSize_ += records_[pos].heap_size();
+void WALTracker::ForEachSpilled(int64_t fromLSN, const std::function<bool(int64_t lsn, span<uint8_t> rec)> &fn) const {
+	if (spilled_.empty() || fromLSN > spilled_.back().lsn) return;
+	auto storage = storage_.lock();
+	if (!storage) return;
+
+	StorageOpts opts;
+	opts.FillCache(false);
+	std::unique_ptr<datastorage::Cursor> cursor(storage->GetCursor(opts));
+	datastorage::Comparator &cmp = cursor->GetComparator();
+	const std::string to = spilledKey(spilled_.back().lsn + 1);
+	for (cursor->Seek(spilledKey(std::max(fromLSN, spilled_.front().lsn))); cursor->Valid() && cmp.Compare(cursor->Key(), to) < 0;
+		 cursor->Next()) {
+		std::string_view value = cursor->Value();
+		if (value.size() < sizeof(int64_t)) continue;
+		value = value.substr(sizeof(int64_t));
+		if (!fn(spilledKeyLSN(cursor->Key()), span<uint8_t>(reinterpret_cast<const uint8_t *>(value.data()), value.size()))) {
+			break;
+		}
+	}
 }
 
-void WALTracker::writeToStorage(int64_t lsn) {
+void WALTracker::writeToStorage(int64_t lsn, span<uint8_t> rec) {
 	uint64_t pos = lsn % walSize_;
 
 	WrSerializer key, data;
 	key << kStorageWALPrefix;
 	key.PutUInt32(pos);
 	data.PutUInt64(lsn);
-	data.Write(std::string_view(reinterpret_cast<char *>(records_[pos].data()), records_[pos].size()));
+	data.Write(std::string_view(reinterpret_cast<const char *>(rec.data()), rec.size()));
 	auto storage = storage_.lock();
 	if (storage) storage->Write(StorageOpts(), key.Slice(), data.Slice());
 }
 
-std::vector<std::pair<int64_t, std::string>> WALTracker::readFromStorage(int64_t &maxLSN) {
-	std::vector<std::pair<int64_t, std::string>> data;
+WALTracker::StoredRecords WALTracker::ReadFromStorage(const std::shared_ptr<datastorage::IDataStorage> &storage, unsigned threadsCount) {
+	if (!storage) return StoredRecords();
 
-	StorageOpts opts;
-	opts.FillCache(false);
+	// Keys are ordered by the first byte of the ring position, so the range is split by it
+	const unsigned chunks = std::max(1u, std::min(threadsCount, kMaxReadThreads));
+	std::vector<StoredRecords> parts(chunks);
+	std::vector<std::exception_ptr> errors(chunks);
+	auto readChunk = [&](unsigned idx) {
+		try {
+			std::string from(kStorageWALPrefix), to(kStorageWALPrefix);
+			if (idx) from.push_back(char(idx * 256 / chunks));
+			to.push_back(idx + 1 < chunks ? char((idx + 1) * 256 / chunks) : '\xFF');
 
-	auto storage = storage_.lock();
-	if (!storage) return data;
-
-	std::unique_ptr<datastorage::Cursor> dbIter(storage->GetCursor(opts));
-
-	for (dbIter->Seek(kStorageWALPrefix);
-		 dbIter->Valid() && dbIter->GetComparator().Compare(dbIter->Key(), std::string_view(kStorageWALPrefix "\xFF")) < 0;
-		 dbIter->Next()) {
-		std::string_view dataSlice = dbIter->Value();
-		if (dataSlice.size() >= sizeof(int64_t)) {
-			// Read LSN
-			int64_t lsn = *reinterpret_cast<const int64_t *>(dataSlice.data());
-			assertrx(lsn >= 0);
-			maxLSN = std::max(maxLSN, lsn);
-			dataSlice = dataSlice.substr(sizeof(lsn));
-			data.push_back({lsn, string(dataSlice)});
+			StorageOpts opts;
+			opts.FillCache(false);
+			StoredRecords &part = parts[idx];
+			datastorage::PrefetchingReader reader(std::unique_ptr<datastorage::Cursor>(storage->GetCursor(opts)), std::move(from),
+												  std::move(to));
+			reader.ForEach([&part](std::string_view, std::string_view dataSlice) {
+				if (dataSlice.size() >= sizeof(int64_t)) {
+					// Read LSN
+					int64_t lsn;
+					memcpy(&lsn, dataSlice.data(), sizeof(lsn));
+					assertrx(lsn >= 0);
+					part.maxLSN = std::max(part.maxLSN, lsn);
+					dataSlice = dataSlice.substr(sizeof(lsn));
+					part.records.push_back({lsn, string(dataSlice)});
+				}
+				return true;
+			});
+		} catch (...) {
+			errors[idx] = std::current_exception();
 		}
+	};
+	std::vector<std::thread> threads;
+	threads.reserve(chunks - 1);
+	for (unsigned i = 1; i < chunks; ++i) threads.emplace_back(readChunk, i);
+	readChunk(0);
+	for (auto &th : threads) th.join();
+	for (auto &err : errors) {
+		if (err) std::rethrow_exception(err);
 	}
 
-	return data;
+	StoredRecords stored = std::move(parts[0]);
+	for (unsigned i = 1; i < chunks; ++i) {
+		stored.maxLSN = std::max(stored.maxLSN, parts[i].maxLSN);
+		stored.records.insert(stored.records.end(), std::make_move_iterator(parts[i].records.begin()),
+							  std::make_move_iterator(parts[i].records.end()));
+	}
+	return stored;
+}
+
+void WALTracker::spill(int64_t lsn, const PackedWALRecord &rec) {
+	auto storage = storage_.lock();
+	if (!storage) return;
+	if (!spilled_.empty() && spilled_.back().lsn + 1 != lsn) {
+		// Lagging slave may be served from spilled records only if there are no gaps between them and ring buffer
+		while (!spilled_.empty()) popSpilled(storage.get());
+	}
+
+	const int64_t time = spillTime();
+	WrSerializer data;
+	data.PutUInt64(time);
+	data.Write(std::string_view(reinterpret_cast<const char *>(rec.data()), rec.size()));
+	storage->Write(StorageOpts(), spilledKey(lsn), data.Slice());
+	spilled_.push_back({lsn, int64_t(data.Len()), time});
+	spilledBytes_ += data.Len();
+	trimSpilled();
+}
+
+void WALTracker::trimSpilled() {
+	if (spilled_.empty()) return;
+	auto storage = storage_.lock();
+	const int64_t expired = spillTTL_ > 0 ? spillTime() - spillTTL_ : std::numeric_limits<int64_t>::min();
+	while (!spilled_.empty() && (spillMaxBytes_ <= 0 || spilledBytes_ > spillMaxBytes_ || spilled_.front().time < expired)) {
+		popSpilled(storage.get());
+	}
+}
+
+void WALTracker::popSpilled(datastorage::IDataStorage *storage) {
+	if (storage) storage->Delete(StorageOpts(), spilledKey(spilled_.front().lsn));
+	spilledBytes_ -= spilled_.front().size;
+	spilled_.pop_front();
+}
+
+void WALTracker::readSpilledFromStorage() {
+	spilled_.clear();
+	spilledBytes_ = 0;
+
+	auto storage = storage_.lock();
+	if (!storage) return;
+
+	StorageOpts opts;
+	opts.FillCache(false);
+	datastorage::PrefetchingReader reader(std::unique_ptr<datastorage::Cursor>(storage->GetCursor(opts)), kStorageSpilledWALPrefix,
+										  kStorageSpilledWALPrefix "\xFF");
+	std::vector<int64_t> staleLSNs;
+	const int64_t ringBegin = lsnCounter_ - size();
+	reader.ForEach([&](std::string_view key, std::string_view dataSlice) {
+		const int64_t lsn = spilledKeyLSN(key);
+		if (dataSlice.size() < sizeof(int64_t) || lsn >= ringBegin) {
+			staleLSNs.emplace_back(lsn);
+			return true;
+		}
+		if (!spilled_.empty() && spilled_.back().lsn + 1 != lsn) {
+			// Records before the gap can not be served
+			for (auto &rec : spilled_) staleLSNs.emplace_back(rec.lsn);
+			spilled_.clear();
+			spilledBytes_ = 0;
+		}
+		int64_t time;
+		memcpy(&time, dataSlice.data(), sizeof(time));
+		spilled_.push_back({lsn, int64_t(dataSlice.size()), time});
+		spilledBytes_ += dataSlice.size();
+		return true;
+	});
+	if (!spilled_.empty() && spilled_.back().lsn + 1 != ringBegin) {
+		for (auto &rec : spilled_) staleLSNs.emplace_back(rec.lsn);
+		spilled_.clear();
+		spilledBytes_ = 0;
+	}
+	for (auto lsn : staleLSNs) {
+		storage->Delete(StorageOpts(), spilledKey(lsn));
+	}
+	trimSpilled();
 }
 
 void WALTracker::initPositions(int64_t sz, int64_t minLSN, int64_t maxLSN) {
 	lsnCounter_ = maxLSN + 1;
 	walSize_ = sz;
-	records_.clear();
-	records_.resize(std::min(lsnCounter_, walSize_));
-	heapSize_ = 0;
+	ring_.Reset(walSize_, std::min(lsnCounter_, walSize_));
 	if (minLSN == std::numeric_limits<int64_t>::max()) {
 		walOffset_ = 0;
 	} else {
@@ -1,24 +1,46 @@
 #pragma once
 
 #include <core/keyvalue/variant.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 #include "core/lsn.h"
 #include "core/storage/idatastorage.h"
 #include "tools/errors.h"
 #include "walrecord.h"
+#include "walring.h"
 
 namespace reindexer {
 
 /// WAL trakcer
 class WALTracker {
 public:
+	/// WAL records, which are read from the storage
+	struct StoredRecords {
+		std::vector<std::pair<int64_t, std::string>> records;
+		/// Max LSN of the records or -1
+		int64_t maxLSN = -1;
+	};
+	/// Max count of the threads, which read the WAL records from the storage
+	static constexpr unsigned kMaxReadThreads = 8;
+
 	WALTracker(int64_t sz);
+	/// Read WAL records from the storage. Storage keys range is split into the chunks, which are read in parallel, so it may be called
+	/// before Init in the background of the items loading
+	/// @param storage - Storage object with WAL records
+	/// @param threadsCount - Count of the reading threads (at most kMaxReadThreads)
+	static StoredRecords ReadFromStorage(const std::shared_ptr<datastorage::IDataStorage> &storage, unsigned threadsCount);
 	/// Initialize WAL tracker.
 	/// @param sz - Max WAL size
 	/// @param minLSN - Min available LSN number
 	/// @param maxLSN - Current LSN counter value
 	/// @param storage - Storage object for store WAL records
 	void Init(int64_t sz, int64_t minLSN, int64_t maxLSN, std::weak_ptr<datastorage::IDataStorage> storage);
+	/// Initialize WAL tracker with the records, which were read by ReadFromStorage
+	void Init(int64_t sz, int64_t minLSN, int64_t maxLSN, std::weak_ptr<datastorage::IDataStorage> storage, StoredRecords &&stored);
 	/// Add new record to WAL tracker
 	/// @param rec - Record to be added
 	/// @param oldLsn - Optional, previous LSN value of changed object
@@ -41,27 +63,39 @@ public:
 	int64_t Capacity() const { return walSize_; }
 	/// Reset storage without WAL reload
 	void SetStorage(std::weak_ptr<datastorage::IDataStorage> storage, bool expectingReset);
+	/// Set limits of the spill mode. In this mode records, which are aged out of the ring buffer, are kept in storage
+	/// @param maxBytes - Max total size of spilled records. 0 - spill mode is disabled and spilled records are removed
+	/// @param ttlSec - Max age of spilled records in seconds. 0 - records are not expired by age
+	void SetSpillLimits(int64_t maxBytes, int64_t ttlSec);
+	/// Iterate spilled records in LSN order
+	/// @param fromLSN - LSN of first record to visit
+	/// @param fn - Visitor. Returns false to stop iteration
+	void ForEachSpilled(int64_t fromLSN, const std::function<bool(int64_t lsn, span<uint8_t> rec)> &fn) const;
 
-	/// Iterator for WAL records
+	/// Iterator for WAL records. Record and its raw data are valid until the iterator is moved to the next block of the ring buffer
 	class iterator {
 	public:
 		iterator &operator++() { return idx_++, *this; }
 		bool operator!=(const iterator &other) const { return idx_ != other.idx_; }
 		WALRecord operator*() const {
-			assertf(idx_ % wt_->walSize_ < int(wt_->records_.size()), "idx=%d,wt_->records_.size()=%d,lsnCounter=%d", idx_,
-					wt_->records_.size(), wt_->lsnCounter_);
+			assertf(idx_ % wt_->walSize_ < wt_->ring_.Allocated(), "idx=%d,wt_->ring_.Allocated()=%d,lsnCounter=%d", idx_,
+					wt_->ring_.Allocated(), wt_->lsnCounter_);
 
-			return WALRecord(span<uint8_t>(wt_->records_[idx_ % wt_->walSize_]));
+			return WALRecord(GetRaw());
 		}
-		span<uint8_t> GetRaw() const { return wt_->records_[idx_ % wt_->walSize_]; }
+		span<uint8_t> GetRaw() const { return wt_->ring_.Get(idx_ % wt_->walSize_, cache_); }
 		int64_t GetLSN() const { return idx_; }
 		int64_t idx_;
 		const WALTracker *wt_;
+		mutable WALRing::ReadCache cache_ = {};
 	};
 
 	/// Get end iterator
 	/// @return iterator pointing to end of WAL
 	iterator end() const { return {lsnCounter_, this}; }
+	/// Get begin iterator
+	/// @return iterator pointing to the oldest record of ring buffer
+	iterator begin() const { return {lsnCounter_ - size(), this}; }
 	/// Get upper_bound
 	/// @param lsn LSN of record
 	/// @return iterator pointing LSN record greate than lsn
@@ -69,7 +103,14 @@ public:
 	/// Check is LSN outdated, and complete log is not available
 	/// @param lsn LSN of record
 	/// @return true if LSN is outdated
-	bool is_outdated(int64_t lsn) const { return !available(lsn); }
+	bool is_outdated(int64_t lsn) const { return !available(lsn) && !is_spilled(lsn); }
+	/// Check is LSN record aged out of ring buffer and available in storage
+	/// @param lsn LSN of record
+	/// @return true if LSN is spilled
+	bool is_spilled(int64_t lsn) const { return !spilled_.empty() && lsn >= spilled_.front().lsn && lsn <= spilled_.back().lsn; }
+	/// Get size of spilled records
+	/// @return total size of spilled records in bytes
+	int64_t spilled_size() const { return spilledBytes_; }
 
 	/// Get WAL size
 	/// @return count of actual records in WAL
@@ -82,35 +123,52 @@ public:
 		} else if (walOffset_ < walEnd) {
 			return walEnd - walOffset_;
 		}
-		return walEnd + (int64_t(records_.size()) - walOffset_);
+		return walEnd + (ring_.Allocated() - walOffset_);
 	}
 	/// Get WAL heap size
 	/// @return WAL memory consumption
-	size_t heap_size() const { return heapSize_ + records_.capacity() * sizeof(PackedWALRecord); }
+	size_t heap_size() const { return ring_.HeapSize(); }
 
 protected:
 	/// put WAL record into lsn position, grow ring buffer, if neccessary
 	/// @param lsn LSN value
 	/// @param rec - Record to be added
-	void put(int64_t lsn, const WALRecord &rec);
+	/// @return previous record of the position
+	PackedWALRecord put(int64_t lsn, const WALRecord &rec) { return ring_.Put(lsn % walSize_, rec); }
 	/// check if lsn is available. e.g. in range of ring buffer
 	bool available(int64_t lsn) const { return lsn < lsnCounter_ && lsnCounter_ - lsn <= size(); }
 	/// flushes lsn value to storage
 	/// @param lsn - lsn value
-	void writeToStorage(int64_t lsn);
-	std::vector<std::pair<int64_t, std::string>> readFromStorage(int64_t &maxLsn);
+	/// @param rec - packed record
+	void writeToStorage(int64_t lsn, span<uint8_t> rec);
 	void initPositions(int64_t sz, int64_t minLSN, int64_t maxLSN);
+	/// moves record, which is aged out of ring buffer, to storage
+	/// @param lsn - lsn value
+	void spill(int64_t lsn, const PackedWALRecord &rec);
+	/// removes spilled records, which are out of spill limits
+	void trimSpilled();
+	void popSpilled(datastorage::IDataStorage *storage);
+	void readSpilledFromStorage();
+
+	struct SpilledRecord {
+		int64_t lsn;
+		int64_t size;
+		int64_t time;
+	};
 
 	/// Ring buffer of WAL records
-	std::vector<PackedWALRecord> records_;
+	WALRing ring_;
 	/// LSN counter value. Contains LSN of next record
 	int64_t lsnCounter_ = 0;
 	/// Size of ring buffer
 	int64_t walSize_ = 0;
 	/// Current start position in buffer
 	int64_t walOffset_ = 0;
-	/// Cached heap size of WAL object
-	size_t heapSize_ = 0;
+	/// Records, spilled to storage. Contains consecutive LSNs, which precede LSNs of ring buffer
+	std::deque<SpilledRecord> spilled_;
+	int64_t spilledBytes_ = 0;
+	int64_t spillMaxBytes_ = 0;
+	int64_t spillTTL_ = 0;
 
 	std::weak_ptr<datastorage::IDataStorage> storage_;
 };
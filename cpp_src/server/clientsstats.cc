@@ -21,11 +21,16 @@ void ClientsStats::GetClientInfo(std::vector<reindexer::ClientStat>& datas) {
 			d.lastRecvTs = c.second.connectionStat->last_recv_ts.load(std::memory_order_relaxed);
 			d.startTime = c.second.connectionStat->start_time;
 			d.updatesLost = c.second.connectionStat->updates_lost.load(std::memory_order_relaxed);
+			const auto rawBytes = c.second.connectionStat->compression_raw_bytes.load(std::memory_order_relaxed);
+			if (rawBytes) {
+				d.compressionRatio = double(c.second.connectionStat->compression_sent_bytes.load(std::memory_order_relaxed)) / rawBytes;
+			}
 		}
 		if (c.second.txStats) {
 			d.txCount = c.second.txStats->txCount.load();
 		}
 		d.updatesPusher = c.second.updatesPusher;
+		if (c.second.resources) d.resources = c.second.resources->Get();
 		reindexer::deepCopy(d.dbName, c.second.dbName);
 		reindexer::deepCopy(d.ip, c.second.ip);
 		reindexer::deepCopy(d.userName, c.second.userName);
@@ -19,6 +19,7 @@ void ServerConfig::Reset() {
 	LogLevel = "info";
 	ServerLog = "stdout";
 	CoreLog = "stdout";
+	AsyncCoreLog = false;
 	HttpLog = "stdout";
 	RpcLog = "stdout";
 #ifndef _WIN32
@@ -35,21 +36,42 @@ void ServerConfig::Reset() {
 	StartWithErrors = false;
 	EnableSecurity = false;
 	DebugPprof = false;
+	SamplingProfilerHz = 0;
+	MemoryAccounting = false;
+	HugePages = reindexer::hugepages::Mode::Off;
 	EnablePrometheus = false;
 	PrometheusCollectPeriod = std::chrono::milliseconds(1000);
+	PrometheusMemstatsPeriod = std::chrono::milliseconds(10000);
 	DebugAllocs = false;
 	Autorepair = false;
+	StartupDBThreads = 4;
+	StartupNsLoaders = 0;
+	RocksDB = reindexer::datastorage::RocksDbTuning();
 	EnableConnectionsStats = true;
+	ResourcesAccounting = false;
+	Quotas = reindexer::ResourceQuotas();
+	QuotasOverrides.clear();
 	TxIdleTimeout = std::chrono::seconds(600);
 	RPCQrIdleTimeout = std::chrono::seconds(600);
+	RPCQrSpillTimeout = std::chrono::seconds(0);
+	RPCQrSpillItemsLimit = 0;
 	MaxUpdatesSize = 1024 * 1024 * 1024;
+	RPCParallelThreads = 0;
+	RPCCoroutines = false;
+	ExecutionPools.clear();
+	UserPools.clear();
+	AppPools.clear();
+	NamespacePools.clear();
 	EnableGRPC = false;
 	MaxHttpReqSize = 2 * 1024 * 1024;
+	HttpCompressionLevel = 0;
+	HttpCompressionMinSize = 1024;
 }
 
 const string ServerConfig::kDedicatedThreading = "dedicated";
 const string ServerConfig::kSharedThreading = "shared";
 const string ServerConfig::kPoolThreading = "pool";
+const string ServerConfig::kReusePortThreading = "reuseport";
 
 reindexer::Error ServerConfig::ParseYaml(const std::string &yaml) {
 	Error err;
@@ -101,17 +123,28 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	args::ValueFlag<string> storageEngineF(dbGroup, "NAME", "'reindexer' storage engine (" + availabledStorages + ")", {'e', "engine"},
 										   StorageEngine, args::Options::Single);
 	args::Flag autorepairF(dbGroup, "", "Enable autorepair for storages after unexpected shutdowns", {"autorepair"});
+	args::ValueFlag<size_t> startupDBThreadsF(dbGroup, "", "Count of the databases, which are opened concurrently at the startup",
+											  {"startup-db-threads"}, StartupDBThreads, args::Options::Single);
+	args::ValueFlag<size_t> startupNsLoadersF(
+		dbGroup, "",
+		"Count of the namespaces of all the databases, which are loaded concurrently at the startup. 0 means 'hardware concurrency'",
+		{"startup-ns-loaders"}, StartupNsLoaders, args::Options::Single);
 
 	args::Group netGroup(parser, "Network options");
 	args::ValueFlag<string> httpAddrF(netGroup, "PORT", "http listen host:port", {'p', "httpaddr"}, HTTPAddr, args::Options::Single);
 	args::ValueFlag<string> rpcAddrF(netGroup, "RPORT", "RPC listen host:port", {'r', "rpcaddr"}, RPCAddr, args::Options::Single);
-	args::ValueFlag<string> rpcThreadingModeF(netGroup, "RTHREADING", "RPC connections threading mode: shared or dedicated",
+	args::ValueFlag<string> rpcThreadingModeF(netGroup, "RTHREADING", "RPC connections threading mode: shared, dedicated or reuseport",
 											  {'X', "rpc-threading"}, RPCThreadingMode, args::Options::Single);
-	args::ValueFlag<string> httpThreadingModeF(netGroup, "HTHREADING", "HTTP connections threading mode: shared or dedicated",
+	args::ValueFlag<string> httpThreadingModeF(netGroup, "HTHREADING", "HTTP connections threading mode: shared, dedicated or reuseport",
 											   {"http-threading"}, HttpThreadingMode, args::Options::Single);
 	args::ValueFlag<size_t> MaxHttpReqSizeF(
 		netGroup, "", "Max HTTP request size in bytes. Default value is 2 MB. 0 is 'unlimited', hovewer, stream mode is not supported",
 		{"max-http-req"}, MaxHttpReqSize, args::Options::Single);
+	args::ValueFlag<int> httpCompressionLevelF(
+		netGroup, "", "Gzip compression level (1-9) of the HTTP responses for the clients, which accept it. 0 disables the compression",
+		{"http-compression-level"}, HttpCompressionLevel, args::Options::Single);
+	args::ValueFlag<size_t> httpCompressionMinSizeF(netGroup, "", "Min size of the compressed HTTP responses in bytes",
+													{"http-compression-min-size"}, HttpCompressionMinSize, args::Options::Single);
 #ifdef WITH_GRPC
 	args::ValueFlag<string> grpcAddrF(netGroup, "GPORT", "GRPC listen host:port", {'g', "grpcaddr"}, RPCAddr, args::Options::Single);
 	args::Flag grpcF(netGroup, "", "Enable gRpc service", {"grpc"});
@@ -121,18 +154,40 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	args::ValueFlag<size_t> maxUpdatesSizeF(netGroup, "", "Maximum cached updates size", {"updatessize"}, MaxUpdatesSize,
 											args::Options::Single);
 	args::Flag pprofF(netGroup, "", "Enable pprof http handler", {'f', "pprof"});
+	args::ValueFlag<int> samplingProfilerHzF(netGroup, "", "Frequency (Hz) of the sampling CPU profiler. 0 means 'disabled'",
+											 {"sampling-profiler-hz"}, SamplingProfilerHz, args::Options::Single);
+	args::Flag memAccountingF(netGroup, "", "Enable allocator-level memory accounting of the namespaces (requires tcmalloc)",
+							  {"memory-accounting"});
 	args::ValueFlag<int> txIdleTimeoutF(netGroup, "", "http transactions idle timeout (s)", {"tx-idle-timeout"}, TxIdleTimeout.count(),
 										args::Options::Single);
 	args::ValueFlag<int> rpcQrIdleTimeoutF(netGroup, "",
 										   "RPC query results idle timeout (s). Expiration check timer has dynamic period, so this timeout "
 										   "may float in range of ~20 seconds. 0 means 'disabled'. Default values is 600 seconds",
 										   {"rpc-qr-idle-timeout"}, RPCQrIdleTimeout.count(), args::Options::Single);
+	args::ValueFlag<int> rpcQrSpillTimeoutF(netGroup, "",
+											"RPC query results spill timeout (s). Remaining items of the idle query results are serialized, "
+											"so the results don't hold the namespaces' data. 0 means 'disabled'",
+											{"rpc-qr-spill-timeout"}, RPCQrSpillTimeout.count(), args::Options::Single);
+	args::ValueFlag<size_t> rpcQrSpillItemsLimitF(
+		netGroup, "",
+		"Total count of the items of the RPC query results, after which idle results are spilled without the timeout. 0 means 'no limit'",
+		{"rpc-qr-spill-items-limit"}, RPCQrSpillItemsLimit, args::Options::Single);
+	args::ValueFlag<size_t> rpcParallelThreadsF(
+		netGroup, "", "Count of threads, which execute read-only RPC calls of the single connection in parallel. 0 means 'disabled'",
+		{"rpc-parallel-threads"}, RPCParallelThreads, args::Options::Single);
+	args::Flag rpcCoroutinesF(netGroup, "", "Handle RPC calls as coroutines, which yield to the connection's thread while their queries are executed",
+							  {"rpc-coroutines"});
 
 	args::Group metricsGroup(parser, "Metrics options");
 	args::Flag prometheusF(metricsGroup, "", "Enable prometheus handler", {"prometheus"});
 	args::ValueFlag<int> prometheusPeriodF(metricsGroup, "", "Prometheus stats collect period (ms)", {"prometheus-period"},
 										   PrometheusCollectPeriod.count(), args::Options::Single);
+	args::ValueFlag<int> prometheusMemstatsPeriodF(metricsGroup, "",
+												   "Prometheus namespaces memory stats collect period (ms). 0 disables these metrics",
+												   {"prometheus-memstats-period"}, PrometheusMemstatsPeriod.count(), args::Options::Single);
 	args::Flag clientsConnectionsStatF(metricsGroup, "", "Enable client connection statistic", {"clientsstats"});
+	args::Flag resourcesAccountingF(metricsGroup, "", "Enable accounting of CPU time, examined rows and results memory of RPC clients",
+									{"resources-accounting"});
 
 	args::Group logGroup(parser, "Logging options");
 	args::ValueFlag<string> logLevelF(logGroup, "", "log level (none, warning, error, info, trace)", {'l', "loglevel"}, LogLevel,
@@ -173,6 +228,8 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	if (storageEngineF) StorageEngine = args::get(storageEngineF);
 	if (startWithErrorsF) StartWithErrors = args::get(startWithErrorsF);
 	if (autorepairF) Autorepair = args::get(autorepairF);
+	if (startupDBThreadsF) StartupDBThreads = args::get(startupDBThreadsF);
+	if (startupNsLoadersF) StartupNsLoaders = args::get(startupNsLoadersF);
 	if (logLevelF) LogLevel = args::get(logLevelF);
 	if (httpAddrF) HTTPAddr = args::get(httpAddrF);
 	if (rpcAddrF) RPCAddr = args::get(rpcAddrF);
@@ -180,6 +237,8 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	if (httpThreadingModeF) HttpThreadingMode = args::get(httpThreadingModeF);
 	if (webRootF) WebRoot = args::get(webRootF);
 	if (MaxHttpReqSizeF) MaxHttpReqSize = args::get(MaxHttpReqSizeF);
+	if (httpCompressionLevelF) HttpCompressionLevel = args::get(httpCompressionLevelF);
+	if (httpCompressionMinSizeF) HttpCompressionMinSize = args::get(httpCompressionMinSizeF);
 #ifndef _WIN32
 	if (userF) UserName = args::get(userF);
 	if (daemonizeF) Daemonize = args::get(daemonizeF);
@@ -200,31 +259,59 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	if (httpLogF) HttpLog = args::get(httpLogF);
 	if (rpcLogF) RpcLog = args::get(rpcLogF);
 	if (pprofF) DebugPprof = args::get(pprofF);
+	if (samplingProfilerHzF) SamplingProfilerHz = args::get(samplingProfilerHzF);
+	if (memAccountingF) MemoryAccounting = args::get(memAccountingF);
 	if (prometheusF) EnablePrometheus = args::get(prometheusF);
 	if (prometheusPeriodF) PrometheusCollectPeriod = std::chrono::milliseconds(args::get(prometheusPeriodF));
+	if (prometheusMemstatsPeriodF) PrometheusMemstatsPeriod = std::chrono::milliseconds(args::get(prometheusMemstatsPeriodF));
 	if (clientsConnectionsStatF) EnableConnectionsStats = args::get(clientsConnectionsStatF);
+	if (resourcesAccountingF) ResourcesAccounting = args::get(resourcesAccountingF);
 	if (logAllocsF) DebugAllocs = args::get(logAllocsF);
 	if (txIdleTimeoutF) TxIdleTimeout = std::chrono::seconds(args::get(txIdleTimeoutF));
 	if (rpcQrIdleTimeoutF) RPCQrIdleTimeout = std::chrono::seconds(args::get(rpcQrIdleTimeoutF));
+	if (rpcQrSpillTimeoutF) RPCQrSpillTimeout = std::chrono::seconds(args::get(rpcQrSpillTimeoutF));
+	if (rpcQrSpillItemsLimitF) RPCQrSpillItemsLimit = args::get(rpcQrSpillItemsLimitF);
 	if (maxUpdatesSizeF) MaxUpdatesSize = args::get(maxUpdatesSizeF);
+	if (rpcParallelThreadsF) RPCParallelThreads = args::get(rpcParallelThreadsF);
+	if (rpcCoroutinesF) RPCCoroutines = args::get(rpcCoroutinesF);
 
 	return 0;
 }
 
+static reindexer::ResourceQuotas quotasFromYaml(Yaml::Node &node, const reindexer::ResourceQuotas &defaults) {
+	reindexer::ResourceQuotas ret;
+	ret.cpuUsPerOp = node["cpu_us_per_op"].As<uint64_t>(defaults.cpuUsPerOp);
+	ret.rowsPerOp = node["rows_per_op"].As<uint64_t>(defaults.rowsPerOp);
+	ret.cpuUsPerSec = node["cpu_us_per_sec"].As<uint64_t>(defaults.cpuUsPerSec);
+	ret.resultsBytes = node["results_bytes"].As<uint64_t>(defaults.resultsBytes);
+	return ret;
+}
+
 reindexer::Error ServerConfig::fromYaml(Yaml::Node &root) {
 	try {
 		StoragePath = root["storage"]["path"].As<std::string>(StoragePath);
 		StorageEngine = root["storage"]["engine"].As<std::string>(StorageEngine);
 		StartWithErrors = root["storage"]["startwitherrors"].As<bool>(StartWithErrors);
 		Autorepair = root["storage"]["autorepair"].As<bool>(Autorepair);
+		StartupDBThreads = root["storage"]["startup_db_threads"].As<size_t>(StartupDBThreads);
+		StartupNsLoaders = root["storage"]["startup_ns_loaders"].As<size_t>(StartupNsLoaders);
+		auto &rocksdbNode = root["storage"]["rocksdb"];
+		RocksDB.compaction = reindexer::datastorage::RocksDbTuning::CompactionFromString(rocksdbNode["compaction_style"].As<std::string>());
+		RocksDB.compression = reindexer::datastorage::RocksDbTuning::CompressionFromString(rocksdbNode["compression"].As<std::string>());
+		RocksDB.bloomFilterBits = rocksdbNode["bloom_filter_bits"].As<int>(RocksDB.bloomFilterBits);
+		RocksDB.sharedBlockCacheSize = rocksdbNode["block_cache_size"].As<size_t>(RocksDB.sharedBlockCacheSize);
+		RocksDB.writeBufferSize = rocksdbNode["write_buffer_size"].As<size_t>(RocksDB.writeBufferSize);
 		LogLevel = root["logger"]["loglevel"].As<std::string>(LogLevel);
 		ServerLog = root["logger"]["serverlog"].As<std::string>(ServerLog);
 		CoreLog = root["logger"]["corelog"].As<std::string>(CoreLog);
+		AsyncCoreLog = root["logger"]["async_corelog"].As<bool>(AsyncCoreLog);
 		HttpLog = root["logger"]["httplog"].As<std::string>(HttpLog);
 		RpcLog = root["logger"]["rpclog"].As<std::string>(RpcLog);
 		HTTPAddr = root["net"]["httpaddr"].As<std::string>(HTTPAddr);
 		RPCAddr = root["net"]["rpcaddr"].As<std::string>(RPCAddr);
 		RPCThreadingMode = root["net"]["rpc_threading"].As<std::string>(RPCThreadingMode);
+		RPCParallelThreads = root["net"]["rpc_parallel_threads"].As<size_t>(RPCParallelThreads);
+		RPCCoroutines = root["net"]["rpc_coroutines"].As<bool>(RPCCoroutines);
 		HttpThreadingMode = root["net"]["http_threading"].As<std::string>(HttpThreadingMode);
 		WebRoot = root["net"]["webroot"].As<std::string>(WebRoot);
 		MaxUpdatesSize = root["net"]["maxupdatessize"].As<size_t>(MaxUpdatesSize);
@@ -233,10 +320,51 @@ reindexer::Error ServerConfig::fromYaml(Yaml::Node &root) {
 		GRPCAddr = root["net"]["grpcaddr"].As<std::string>(GRPCAddr);
 		TxIdleTimeout = std::chrono::seconds(root["net"]["tx_idle_timeout"].As<int>(TxIdleTimeout.count()));
 		RPCQrIdleTimeout = std::chrono::seconds(root["net"]["rpc_qr_idle_timeout"].As<int>(RPCQrIdleTimeout.count()));
+		RPCQrSpillTimeout = std::chrono::seconds(root["net"]["rpc_qr_spill_timeout"].As<int>(RPCQrSpillTimeout.count()));
+		RPCQrSpillItemsLimit = root["net"]["rpc_qr_spill_items_limit"].As<size_t>(RPCQrSpillItemsLimit);
 		MaxHttpReqSize = root["net"]["max_http_body_size"].As<std::size_t>(MaxHttpReqSize);
+		HttpCompressionLevel = root["net"]["http_compression_level"].As<int>(HttpCompressionLevel);
+		HttpCompressionMinSize = root["net"]["http_compression_min_size"].As<std::size_t>(HttpCompressionMinSize);
 		EnablePrometheus = root["metrics"]["prometheus"].As<bool>(EnablePrometheus);
 		PrometheusCollectPeriod = std::chrono::milliseconds(root["metrics"]["collect_period"].As<int>(PrometheusCollectPeriod.count()));
+		PrometheusMemstatsPeriod =
+			std::chrono::milliseconds(root["metrics"]["memstats_period"].As<int>(PrometheusMemstatsPeriod.count()));
 		EnableConnectionsStats = root["metrics"]["clientsstats"].As<bool>(EnableConnectionsStats);
+		ResourcesAccounting = root["metrics"]["resources_accounting"].As<bool>(ResourcesAccounting);
+		auto &quotasNode = root["quotas"];
+		Quotas = quotasFromYaml(quotasNode, Quotas);
+		auto &overridesNode = quotasNode["overrides"];
+		if (overridesNode.IsMap()) {
+			for (auto it = overridesNode.Begin(); it != overridesNode.End(); it++) {
+				QuotasOverrides[(*it).first] = quotasFromYaml((*it).second, Quotas);
+			}
+		}
+		auto &poolsNode = root["execution_pools"];
+		auto &poolsListNode = poolsNode["pools"];
+		if (poolsListNode.IsMap()) {
+			for (auto it = poolsListNode.Begin(); it != poolsListNode.End(); it++) {
+				auto &poolNode = (*it).second;
+				ExecutionPoolConfig pool;
+				pool.threads = std::max(poolNode["threads"].As<size_t>(pool.threads), size_t(1));
+				pool.maxQueue = poolNode["max_queue"].As<size_t>(pool.maxQueue);
+				pool.maxQueueWait = std::chrono::milliseconds(poolNode["max_queue_wait_ms"].As<int>(pool.maxQueueWait.count()));
+				pool.numaNode = poolNode["numa_node"].As<int>(pool.numaNode);
+				ExecutionPools[(*it).first] = pool;
+			}
+		}
+		auto parseRoutes = [this](Yaml::Node &routesNode, std::unordered_map<string, string> &routes) {
+			if (!routesNode.IsMap()) return;
+			for (auto it = routesNode.Begin(); it != routesNode.End(); it++) {
+				auto pool = (*it).second.As<std::string>();
+				if (ExecutionPools.find(pool) == ExecutionPools.end()) {
+					throw Error(errParams, "Execution pool '%s' of '%s' is not configured", pool, (*it).first);
+				}
+				routes[(*it).first] = std::move(pool);
+			}
+		};
+		parseRoutes(poolsNode["users"], UserPools);
+		parseRoutes(poolsNode["apps"], AppPools);
+		parseRoutes(poolsNode["namespaces"], NamespacePools);
 #ifndef _WIN32
 		UserName = root["system"]["user"].As<std::string>(UserName);
 		Daemonize = root["system"]["daemonize"].As<bool>(Daemonize);
@@ -244,8 +372,22 @@ reindexer::Error ServerConfig::fromYaml(Yaml::Node &root) {
 #endif
 		DebugAllocs = root["debug"]["allocs"].As<bool>(DebugAllocs);
 		DebugPprof = root["debug"]["pprof"].As<bool>(DebugPprof);
+		SamplingProfilerHz = root["debug"]["sampling_profiler_hz"].As<int>(SamplingProfilerHz);
+		MemoryAccounting = root["debug"]["memory_accounting"].As<bool>(MemoryAccounting);
+		const auto hugePages = root["memory"]["huge_pages"].As<std::string>("");
+		if (hugePages == "off") {
+			HugePages = reindexer::hugepages::Mode::Off;
+		} else if (hugePages == "madvise") {
+			HugePages = reindexer::hugepages::Mode::Madvise;
+		} else if (hugePages == "explicit") {
+			HugePages = reindexer::hugepages::Mode::Explicit;
+		} else if (!hugePages.empty()) {
+			throw Error(errParams, "Unknown huge pages mode '%s'. Supported modes: off, madvise, explicit", hugePages);
+		}
 	} catch (const Yaml::Exception &ex) {
 		return Error(errParams, "%s", ex.Message());
+	} catch (const Error &err) {
+		return err;
 	}
 	return 0;
 }
@@ -2,8 +2,12 @@
 
 #include <chrono>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include "core/resourceusage.h"
+#include "core/storage/rocksdbtuning.h"
 #include "tools/errors.h"
+#include "tools/hugepages.h"
 
 using std::string;
 using std::vector;
@@ -15,6 +19,17 @@ class Node;
 
 namespace reindexer_server {
 
+// Named pool of the threads, which execute the RPC selects, queries and transactions commits of the routed clients
+struct ExecutionPoolConfig {
+	size_t threads = 1;
+	// Max count of the queued operations. New operations are rejected, when it's reached. 0 means 'no limit'
+	size_t maxQueue = 0;
+	// New operations are rejected, while the oldest queued operation is waiting for longer than this time. 0 means 'no limit'
+	std::chrono::milliseconds maxQueueWait{0};
+	// NUMA node, to which the threads of the pool are pinned. Memory allocations of the threads prefer this node. -1 means 'no binding'
+	int numaNode = -1;
+};
+
 struct ServerConfig {
 	ServerConfig() { Reset(); }
 
@@ -34,11 +49,18 @@ struct ServerConfig {
 	string LogLevel;
 	string ServerLog;
 	string CoreLog;
+	// Core log records are written by the background thread and are dropped, when the thread's buffer is full
+	bool AsyncCoreLog;
 	string HttpLog;
 	string RpcLog;
 	string StoragePath;
 	bool StartWithErrors;
 	bool Autorepair;
+	// Count of the databases, which are opened concurrently at the startup
+	size_t StartupDBThreads;
+	// Count of the namespaces of all the databases, which are loaded concurrently at the startup. 0 means 'hardware concurrency'
+	size_t StartupNsLoaders;
+	reindexer::datastorage::RocksDbTuning RocksDB;
 #ifndef _WIN32
 	string UserName;
 	string DaemonPidFile;
@@ -50,20 +72,44 @@ struct ServerConfig {
 #endif
 	bool EnableSecurity;
 	bool DebugPprof;
+	int SamplingProfilerHz;
+	bool MemoryAccounting;
+	// Backing of the large namespaces' and fulltext indexes' arrays
+	reindexer::hugepages::Mode HugePages;
 	bool EnablePrometheus;
 	bool EnableConnectionsStats;
+	bool ResourcesAccounting;
+	// Quotas of the RPC clients. Overrides are looked up by 'user/app' and by 'user' keys
+	reindexer::ResourceQuotas Quotas;
+	std::unordered_map<string, reindexer::ResourceQuotas> QuotasOverrides;
 	std::chrono::milliseconds PrometheusCollectPeriod;
+	// Period of the collection of the namespaces memory stats, which walk the indexes and the caches. 0 disables these metrics
+	std::chrono::milliseconds PrometheusMemstatsPeriod;
 	bool DebugAllocs;
 	std::chrono::seconds TxIdleTimeout;
 	size_t MaxUpdatesSize;
 	bool EnableGRPC;
 	string GRPCAddr;
 	size_t MaxHttpReqSize;
+	// Gzip compression of the HTTP responses, which is negotiated by 'Accept-Encoding' header. Level 0 disables the compression
+	int HttpCompressionLevel;
+	size_t HttpCompressionMinSize;
 	std::chrono::seconds RPCQrIdleTimeout;
+	std::chrono::seconds RPCQrSpillTimeout;
+	size_t RPCQrSpillItemsLimit;
+	size_t RPCParallelThreads;
+	bool RPCCoroutines;
+	std::unordered_map<string, ExecutionPoolConfig> ExecutionPools;
+	// Pools of the users and of the applications (by the application name of the connection). Application's pool is preferred
+	std::unordered_map<string, string> UserPools;
+	std::unordered_map<string, string> AppPools;
+	// Pools of the namespaces. Used for the operations of the clients, which are not routed to any pool by the user or the application
+	std::unordered_map<string, string> NamespacePools;
 
 	static const string kDedicatedThreading;
 	static const string kSharedThreading;
 	static const string kPoolThreading;
+	static const string kReusePortThreading;
 
 protected:
 	Error fromYaml(Yaml::Node& root);
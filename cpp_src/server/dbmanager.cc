@@ -23,7 +23,7 @@ const std::string kUsersJSONFilename = "users.json";
 DBManager::DBManager(const string &dbpath, bool noSecurity, IClientsStats *clientsStats)
 	: dbpath_(dbpath), noSecurity_(noSecurity), storageType_(datastorage::StorageType::LevelDB), clientsStats_(clientsStats) {}
 
-Error DBManager::Init(const std::string &storageEngine, bool allowDBErrors, bool withAutorepair) {
+Error DBManager::Init(const std::string &storageEngine, bool allowDBErrors, bool withAutorepair, size_t openThreads) {
 	if (!noSecurity_) {
 		auto status = readUsers();
 		if (!status.ok()) {
@@ -42,17 +42,38 @@ Error DBManager::Init(const std::string &storageEngine, bool allowDBErrors, bool
 		return err;
 	}
 
+	vector<string> dbNames;
 	for (auto &de : foundDb) {
-		if (de.isDir && validateObjectName(de.name, false)) {
-			auto status = loadOrCreateDatabase(de.name, allowDBErrors, withAutorepair);
+		if (de.isDir && validateObjectName(de.name, false)) dbNames.emplace_back(std::move(de.name));
+	}
+	// Databases are opened concurrently. Their namespaces are admitted by the process-wide NamespacesLoadingScheduler
+	vector<unique_ptr<Reindexer>> dbs(dbNames.size());
+	std::atomic<size_t> next{0};
+	std::atomic<bool> hasFatalErrors{false};
+	Error fatalError;
+	std::mutex errMtx;
+	auto worker = [&] {
+		for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < dbNames.size() && !hasFatalErrors.load(std::memory_order_relaxed);
+			 i = next.fetch_add(1, std::memory_order_relaxed)) {
+			auto status = createDatabase(dbNames[i], allowDBErrors, withAutorepair, AuthContext(), dbs[i]);
 			if (!status.ok()) {
-				logPrintf(LogError, "Failed to open database '%s' - %s", de.name, status.what());
+				logPrintf(LogError, "Failed to open database '%s' - %s", dbNames[i], status.what());
 				if (status.code() == errNotValid) {
 					logPrintf(LogError, "Try to run:\t`reindexer_tool --dsn \"builtin://%s\" --repair`  to restore data", dbpath_);
-					return status;
+					std::lock_guard lck(errMtx);
+					if (!hasFatalErrors.exchange(true, std::memory_order_relaxed)) fatalError = std::move(status);
 				}
 			}
 		}
+	};
+	vector<std::thread> threads;
+	for (size_t i = 1; i < std::min(openThreads, dbNames.size()); ++i) threads.emplace_back(worker);
+	worker();
+	for (auto &th : threads) th.join();
+	if (hasFatalErrors.load(std::memory_order_relaxed)) return fatalError;
+
+	for (size_t i = 0; i < dbNames.size(); ++i) {
+		if (dbs[i]) dbs_[dbNames[i]] = std::move(dbs[i]);
 	}
 
 	return 0;
@@ -112,10 +133,20 @@ Error DBManager::OpenDatabase(const string &dbName, AuthContext &auth, bool canC
 }
 
 Error DBManager::loadOrCreateDatabase(const string &dbName, bool allowDBErrors, bool withAutorepair, const AuthContext &auth) {
+	unique_ptr<Reindexer> db;
+	auto status = createDatabase(dbName, allowDBErrors, withAutorepair, auth, db);
+	if (status.ok()) {
+		dbs_[dbName] = std::move(db);
+	}
+	return status;
+}
+
+Error DBManager::createDatabase(const string &dbName, bool allowDBErrors, bool withAutorepair, const AuthContext &auth,
+								unique_ptr<Reindexer> &db) {
 	string storagePath = !dbpath_.empty() ? fs::JoinPath(dbpath_, dbName) : "";
 
 	logPrintf(LogInfo, "Loading database %s", dbName);
-	auto db = unique_ptr<reindexer::Reindexer>(new reindexer::Reindexer(clientsStats_));
+	db.reset(new reindexer::Reindexer(clientsStats_));
 	StorageTypeOpt storageType = kStorageTypeOptLevelDB;
 	switch (storageType_) {
 		case datastorage::StorageType::LevelDB:
@@ -130,10 +161,9 @@ Error DBManager::loadOrCreateDatabase(const string &dbName, bool allowDBErrors,
 		opts = opts.WithExpectedClusterID(auth.expectedClusterID_);
 	}
 	auto status = db->Connect(storagePath, opts);
-	if (status.ok()) {
-		dbs_[dbName] = std::move(db);
+	if (!status.ok()) {
+		db.reset();
 	}
-
 	return status;
 }
 
@@ -166,6 +196,14 @@ vector<string> DBManager::EnumDatabases() {
 	return dbs;
 }
 
+bool DBManager::IsWarmedUp() {
+	shared_lock<shared_timed_mutex> lck(mtx_);
+	for (auto &it : dbs_) {
+		if (!it.second->IsWarmedUp()) return false;
+	}
+	return true;
+}
+
 Error DBManager::Login(const string &dbName, AuthContext &auth) {
 	if (kRoleSystem == auth.role_) {
 		auth.dbName_ = dbName;
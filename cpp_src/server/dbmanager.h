@@ -123,8 +123,9 @@ public:
 	/// @param storageEngine - underlying storage engine ("leveldb"/"rocksdb")
 	/// @param allowDBErrors - true: Ignore errors during existing DBs load; false: Return error if error occures during DBs load
 	/// @param withAutorepair - true: Enable storage autorepair feature for this DB; false: Disable storage autorepair feature for this DB
+	/// @param openThreads - count of the databases, which are opened concurrently
 	/// @return Error - error object
-	Error Init(const std::string &storageEngine, bool allowDBErrors, bool withAutorepair);
+	Error Init(const std::string &storageEngine, bool allowDBErrors, bool withAutorepair, size_t openThreads = 1);
 	/// Authenticate user, and grant roles to database with specified dbName
 	/// @param dbName - database name. Can be empty.
 	/// @param auth - AuthContext with user credentials
@@ -146,6 +147,9 @@ public:
 	/// Enum list of available databases
 	/// @return names of available databases
 	vector<string> EnumDatabases();
+	/// Check if the warm states of all the databases are replayed
+	/// @return true, if all the databases are warmed up
+	bool IsWarmedUp();
 
 private:
 	using Mutex = MarkedMutex<shared_timed_mutex, MutexMark::DbManager>;
@@ -155,6 +159,7 @@ private:
 	Error createDefaultUsersYAML() noexcept;
 	static UserRole userRoleFromString(std::string_view strRole);
 	Error loadOrCreateDatabase(const string &name, bool allowDBErrors, bool withAutorepair, const AuthContext &auth = AuthContext());
+	Error createDatabase(const string &name, bool allowDBErrors, bool withAutorepair, const AuthContext &auth, unique_ptr<Reindexer> &db);
 
 	unordered_map<string, unique_ptr<Reindexer>, nocase_hash_str, nocase_equal_str> dbs_;
 	unordered_map<string, UserRecord> users_;
@@ -0,0 +1,62 @@
+#include "executionpools.h"
+#include "tools/logger.h"
+#include "tools/numa.h"
+
+namespace reindexer_server {
+
+static std::function<void()> numaThreadInit(const std::string &poolName, int node) {
+	if (node < 0) return nullptr;
+	auto cpus = reindexer::numa::NodeCPUs(node);
+	if (cpus.empty()) {
+		reindexer::logPrintf(LogWarning, "Execution pool '%s': NUMA node %d is not available, threads of the pool are not pinned", poolName,
+							 node);
+		return nullptr;
+	}
+	return [poolName, node, cpus = std::move(cpus)] {
+		// Memory, which is first touched by the pool's threads, is allocated on their node
+		if (!reindexer::numa::PinCurrentThread(cpus) || !reindexer::numa::PreferNodeMemory(node)) {
+			reindexer::logPrintf(LogWarning, "Execution pool '%s': unable to bind the thread to NUMA node %d", poolName, node);
+		}
+	};
+}
+
+ExecutionPool::ExecutionPool(std::string name, const ExecutionPoolConfig &cfg)
+	: name_(std::move(name)), cfg_(cfg), executor_(cfg.threads, numaThreadInit(name_, cfg.numaNode)) {}
+
+Error ExecutionPool::Admit() {
+	if (cfg_.maxQueue && executor_.QueueSize() >= cfg_.maxQueue) {
+		return Error(errQuotaExceeded, "Execution pool '%s' is overloaded: %d operations are queued, retry later", name_, cfg_.maxQueue);
+	}
+	if (cfg_.maxQueueWait.count() && executor_.QueueWait() > cfg_.maxQueueWait) {
+		return Error(errQuotaExceeded, "Execution pool '%s' is overloaded: queue wait exceeds %d ms, retry later", name_,
+					 cfg_.maxQueueWait.count());
+	}
+	return Error();
+}
+
+ExecutionPools::ExecutionPools(const ServerConfig &cfg) : cfg_(cfg) {
+	for (const auto &pool : cfg.ExecutionPools) {
+		pools_.emplace(pool.first, std::make_unique<ExecutionPool>(pool.first, pool.second));
+	}
+	for (const auto &route : cfg.NamespacePools) {
+		auto poolIt = pools_.find(route.second);
+		if (poolIt != pools_.end()) nsPools_.emplace(route.first, poolIt->second.get());
+	}
+}
+
+ExecutionPool *ExecutionPools::Get(const std::string &user, const std::string &app) const {
+	auto routeIt = app.empty() ? cfg_.AppPools.end() : cfg_.AppPools.find(app);
+	if (routeIt == cfg_.AppPools.end()) {
+		routeIt = cfg_.UserPools.find(user);
+		if (routeIt == cfg_.UserPools.end()) return nullptr;
+	}
+	auto poolIt = pools_.find(routeIt->second);
+	return poolIt == pools_.end() ? nullptr : poolIt->second.get();
+}
+
+ExecutionPool *ExecutionPools::GetByNamespace(std::string_view nsName) const {
+	auto it = nsPools_.find(nsName);
+	return it == nsPools_.end() ? nullptr : it->second;
+}
+
+}  // namespace reindexer_server
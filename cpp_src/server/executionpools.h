@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "config.h"
+#include "estl/fast_hash_map.h"
+#include "net/cproto/callsexecutor.h"
+#include "tools/stringstools.h"
+
+namespace reindexer_server {
+
+/// Named pool of the threads with its own queue. Heavy operations of the routed clients are executed by the pool, so they don't compete
+/// with the other clients for the connections' threads and the common calls executor
+class ExecutionPool {
+public:
+	ExecutionPool(std::string name, const ExecutionPoolConfig &cfg);
+
+	/// Admission control. Rejects the new operation with errQuotaExceeded, while the pool's queue is overloaded
+	Error Admit();
+	reindexer::net::cproto::CallsExecutor &Executor() noexcept { return executor_; }
+	const std::string &Name() const noexcept { return name_; }
+
+private:
+	const std::string name_;
+	const ExecutionPoolConfig cfg_;
+	reindexer::net::cproto::CallsExecutor executor_;
+};
+
+/// Execution pools of the RPC server and the routing of the clients to them
+class ExecutionPools {
+public:
+	explicit ExecutionPools(const ServerConfig &cfg);
+
+	static bool Required(const ServerConfig &cfg) noexcept { return !cfg.ExecutionPools.empty(); }
+	/// Pool of the client. Pool of the application is preferred to the pool of the user
+	/// @return nullptr, if the client is not routed to any pool
+	ExecutionPool *Get(const std::string &user, const std::string &app) const;
+	/// Pool of the namespace for the clients, which are not routed by the user or the application
+	/// @return nullptr, if the namespace is not bound to any pool
+	ExecutionPool *GetByNamespace(std::string_view nsName) const;
+
+private:
+	const ServerConfig &cfg_;
+	std::unordered_map<std::string, std::unique_ptr<ExecutionPool>> pools_;
+	reindexer::fast_hash_map<std::string, ExecutionPool *, reindexer::nocase_hash_str, reindexer::nocase_equal_str> nsPools_;
+};
+
+}  // namespace reindexer_server
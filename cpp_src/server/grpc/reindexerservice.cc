@@ -17,6 +17,7 @@ ReindexerService::ReindexerService(reindexer_server::DBManager& dbMgr, std::chro
 								   reindexer::net::ev::dynamic_loop& loop)
 	: Reindexer::Service(), dbMgr_(dbMgr), txID_(0), txIdleTimeout_(txIdleTimeout) {
 	expirationChecker_.set<ReindexerService, &ReindexerService::removeExpiredTxCb>(this);
+	expirationChecker_.set_coarse(true);
 	expirationChecker_.set(loop);
 	expirationChecker_.start(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::seconds(1)).count(),
 							 std::chrono::duration_cast<std::chrono::seconds>(std::chrono::seconds(1)).count());
@@ -461,34 +462,37 @@ Error ReindexerService::packCJSONItem(WrSerializer& wrser, reindexer::QueryResul
 	return it.GetCJSON(wrser);
 }
 
-Error ReindexerService::buildItems(WrSerializer& wrser, const reindexer::QueryResults& qr, const OutputFlags& opts) {
+Error ReindexerService::buildItems(WrSerializer& wrser, const reindexer::QueryResults& qr, const OutputFlags& opts, size_t begin,
+								   size_t end, bool withAggregations) {
 	Error status;
+	const auto itBegin = qr.begin() + int(begin);
+	const auto itEnd = qr.begin() + int(end);
 	switch (opts.encodingtype()) {
 		case EncodingType::JSON: {
 			JsonBuilder builder(wrser, ObjType::TypeObject);
-			if (qr.Count() > 0) {
+			if (end > begin) {
 				JsonBuilder array = builder.Array("items");
-				for (auto& item : qr) {
+				for (auto item = itBegin; item != itEnd; ++item) {
 					array.Raw(nullptr, "");
 					status = item.GetJSON(wrser, false);
 					if (!status.ok()) break;
 				}
 			}
-			if (qr.GetAggregationResults().size() > 0) {
+			if (withAggregations && qr.GetAggregationResults().size() > 0) {
 				buildAggregation(builder, wrser, qr, opts);
 			}
 			break;
 		}
 		case EncodingType::MSGPACK: {
 			int fields = 0;
-			bool withItems = (qr.Count() > 0);
+			bool withItems = (end > begin);
 			if (withItems) ++fields;
-			bool withAggregation = (qr.GetAggregationResults().size() > 0);
+			bool withAggregation = withAggregations && (qr.GetAggregationResults().size() > 0);
 			if (withAggregation) ++fields;
 			MsgPackBuilder builder(wrser, ObjType::TypeObject, fields);
 			if (withItems) {
-				MsgPackBuilder array = builder.Array("items", qr.Count());
-				for (auto& item : qr) {
+				MsgPackBuilder array = builder.Array("items", end - begin);
+				for (auto item = itBegin; item != itEnd; ++item) {
 					status = item.GetMsgPack(wrser, false);
 					if (!status.ok()) break;
 				}
@@ -501,17 +505,18 @@ Error ReindexerService::buildItems(WrSerializer& wrser, const reindexer::QueryRe
 		case EncodingType::PROTOBUF: {
 			ProtobufBuilder builder(&wrser, ObjType::TypeObject);
 			ProtobufBuilder array = builder.Array("items");
-			for (auto& it : qr) {
+			for (auto it = itBegin; it != itEnd; ++it) {
 				status = it.GetProtobuf(wrser, false);
 				if (!status.ok()) break;
 			}
 			break;
 		}
 		case EncodingType::CJSON: {
-			if (qr.Count() > 0) {
+			// Payload types are sent only within the first response of the stream
+			if (begin == 0 && end > begin) {
 				packPayloadTypes(wrser, qr);
 			}
-			for (auto& item : qr) {
+			for (auto item = itBegin; item != itEnd; ++item) {
 				status = packCJSONItem(wrser, item, opts);
 				if (!status.ok()) break;
 
@@ -571,25 +576,43 @@ Error ReindexerService::buildAggregation(Builder& builder, WrSerializer& wrser,
 												   const OutputFlags& flags) {
 	WrSerializer wrser;
 	QueryResultsResponse response;
-	Error status = buildItems(wrser, qr, flags);
-	if (status.ok()) {
-		response.set_data(string(wrser.Slice().data(), wrser.Slice().length()));
-		QueryResultsResponse::QueryResultsOptions* opts = response.options().New();
-		bool isWALQuery = (qr.Count() && qr.begin().IsRaw());
-		opts->set_cacheenabled(qr.IsCacheEnabled() && !isWALQuery);
-		if (!qr.GetExplainResults().empty()) {
-			opts->set_explain(qr.GetExplainResults());
-		}
-		opts->set_totalitems(qr.Count());
-		opts->set_querytotalitems(qr.TotalCount());
-		response.set_allocated_options(opts);
-	}
 	ErrorResponse* responseCode = response.errorresponse().New();
-	responseCode->set_code(ErrorResponse::ErrorCode(status.code()));
-	responseCode->set_what(status.what());
 	response.set_allocated_errorresponse(responseCode);
-	writer->Write(response);
-	return status.ok() ? ::grpc::Status::OK : ::grpc::Status::CANCELLED;
+	// Large results are streamed by the batches, so neither the whole encoded result nor its protobuf copy are kept in memory
+	const size_t count = qr.Count();
+	const size_t batchSize = flags.streambatchsize() ? flags.streambatchsize() : std::max(count, size_t(1));
+	size_t begin = 0;
+	do {
+		const size_t end = std::min(begin + batchSize, count);
+		wrser.Reset();
+		Error status = buildItems(wrser, qr, flags, begin, end, end == count);
+		if (status.ok()) {
+			response.set_data(wrser.Slice().data(), wrser.Slice().length());
+			if (begin == 0) {
+				QueryResultsResponse::QueryResultsOptions* opts = response.options().New();
+				bool isWALQuery = (qr.Count() && qr.begin().IsRaw());
+				opts->set_cacheenabled(qr.IsCacheEnabled() && !isWALQuery);
+				if (!qr.GetExplainResults().empty()) {
+					opts->set_explain(qr.GetExplainResults());
+				}
+				opts->set_totalitems(qr.Count());
+				opts->set_querytotalitems(qr.TotalCount());
+				response.set_allocated_options(opts);
+			} else {
+				response.clear_options();
+			}
+		} else {
+			response.clear_data();
+		}
+		responseCode->set_code(ErrorResponse::ErrorCode(status.code()));
+		responseCode->set_what(status.what());
+		if (!writer->Write(response) || !status.ok()) {
+			// Stream was closed by the client or the items can not be encoded
+			return ::grpc::Status::CANCELLED;
+		}
+		begin = end;
+	} while (begin < count);
+	return ::grpc::Status::OK;
 }
 
 Error ReindexerService::executeQuery(const std::string& dbName, const Query& query, QueryType type, reindexer::QueryResults& qr) {
@@ -74,7 +74,8 @@ private:
 
 	static ::grpc::Status buildQueryResults(const reindexer::QueryResults& qr, ::grpc::ServerWriter<QueryResultsResponse>* writer,
 											const OutputFlags& opts);
-	static Error buildItems(WrSerializer& wrser, const reindexer::QueryResults& qr, const OutputFlags& opts);
+	static Error buildItems(WrSerializer& wrser, const reindexer::QueryResults& qr, const OutputFlags& opts, size_t begin, size_t end,
+							bool withAggregations);
 
 	template <typename Builder>
 	static Error buildAggregation(Builder& builder, WrSerializer& wrser, const reindexer::QueryResults& qr, const OutputFlags& opts);
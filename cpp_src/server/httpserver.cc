@@ -1,7 +1,10 @@
 #include "httpserver.h"
 #include <sys/stat.h>
+#include <condition_variable>
+#include <deque>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 #include "base64/base64.h"
 #include "core/cjson/jsonbuilder.h"
 #include "core/cjson/msgpackbuilder.h"
@@ -10,6 +13,7 @@
 #include "core/cjson/protobufschemabuilder.h"
 #include "core/itemimpl.h"
 #include "core/namespace/namespace.h"
+#include "core/queryresults/columnarencoder.h"
 #include "core/queryresults/tableviewbuilder.h"
 #include "core/schema.h"
 #include "core/type_consts.h"
@@ -39,6 +43,11 @@ namespace reindexer_server {
 
 constexpr size_t kTxIdLen = 20;
 constexpr auto kTxDeadlineCheckPeriod = std::chrono::seconds(1);
+constexpr size_t kModifyItemsBatchSize = 1024;
+constexpr size_t kPipelinedModifyMinSize = 1 << 20;
+constexpr size_t kMaxPendingDecodedBatches = 2;
+// Encoded part of the compressed query results, which is sent before the rest of the results is encoded
+constexpr size_t kStreamedResultsPartSize = 1 << 16;
 
 HTTPServer::HTTPServer(DBManager &dbMgr, LoggerWrapper &logger, const ServerConfig &serverConfig, Prometheus *prometheus,
 					   IStatsWatcher *statsWatcher)
@@ -786,6 +795,11 @@ int HTTPServer::Check(http::Context &ctx) {
 		builder.Put("log_level", serverConfig_.LogLevel);
 		builder.Put("core_log", serverConfig_.CoreLog);
 		builder.Put("server_log", serverConfig_.ServerLog);
+		builder.Put("warmed_up", dbMgr_.IsWarmedUp());
+		if (serverConfig_.HugePages != hugepages::Mode::Off) {
+			builder.Put("huge_pages_mapped_bytes", hugepages::MappedBytes());
+			builder.Put("huge_pages_resident_bytes", hugepages::ResidentBytes());
+		}
 
 #if REINDEX_WITH_JEMALLOC
 		if (alloc_ext::JEMallocIsAvailable()) {
@@ -943,16 +957,26 @@ bool HTTPServer::Start(const string &addr, ev::dynamic_loop &loop) {
 	if (serverConfig_.DebugPprof) {
 		pprof_.Attach(router_);
 	}
+	if (serverConfig_.SamplingProfilerHz > 0) {
+		pprof_.AttachSampler(router_);
+	}
 	if (prometheus_) {
 		prometheus_->Attach(router_);
 	}
 
+	http::CompressionOpts compression;
+	compression.level = std::clamp(serverConfig_.HttpCompressionLevel, 0, 9);
+	compression.minSize = serverConfig_.HttpCompressionMinSize;
+	auto connFactory = http::ServerConnection::NewFactory(router_, serverConfig_.MaxHttpReqSize, compression);
 	if (serverConfig_.HttpThreadingMode == ServerConfig::kDedicatedThreading) {
-		listener_.reset(new ForkedListener(loop, http::ServerConnection::NewFactory(router_, serverConfig_.MaxHttpReqSize)));
+		listener_.reset(new ForkedListener(loop, std::move(connFactory), debug::ThreadRole::HTTP));
+	} else if (serverConfig_.HttpThreadingMode == ServerConfig::kReusePortThreading && ReusePortListener::IsSupported()) {
+		listener_.reset(new ReusePortListener(std::move(connFactory), 0, debug::ThreadRole::HTTP));
 	} else {
-		listener_.reset(new Listener(loop, http::ServerConnection::NewFactory(router_, serverConfig_.MaxHttpReqSize)));
+		listener_.reset(new Listener(loop, std::move(connFactory), 0, debug::ThreadRole::HTTP));
 	}
 	deadlineChecker_.set<HTTPServer, &HTTPServer::deadlineTimerCb>(this);
+	deadlineChecker_.set_coarse(true);
 	deadlineChecker_.set(loop);
 	deadlineChecker_.start(std::chrono::duration_cast<std::chrono::seconds>(kTxDeadlineCheckPeriod).count(),
 						   std::chrono::duration_cast<std::chrono::seconds>(kTxDeadlineCheckPeriod).count());
@@ -1005,36 +1029,102 @@ int HTTPServer::modifyItemsJSON(http::Context &ctx, string &nsName, const vector
 	vector<string> updatedItems;
 
 	if (itemJson.size()) {
+		// Decoded items are modified by batches under the single namespace lock
+		auto modifyBatch = [&](vector<Item> &batch) {
+			if (batch.empty()) return Error();
+			auto status = db.ModifyItems(nsName, batch, mode);
+			for (auto &item : batch) {
+				if (item.GetID() != -1) {
+					++cnt;
+					if (!precepts.empty()) updatedItems.push_back(string(item.GetJSON()));
+				}
+			}
+			batch.clear();
+			return status;
+		};
+
 		char *jsonPtr = &itemJson[0];
 		size_t jsonLeft = itemJson.size();
-		while (jsonPtr && *jsonPtr) {
-			Item item = db.NewItem(nsName);
-			if (!item.Status().ok()) {
-				return jsonStatus(ctx, http::HttpStatus(item.Status()));
-			}
-			char *prevPtr = jsonPtr;
-			auto str = std::string_view(jsonPtr, jsonLeft);
-			if (jsonPtr != &itemJson[0] && isBlank(str)) {
-				break;
-			}
-			auto status = item.Unsafe().FromJSON(str, &jsonPtr, mode == ModeDelete);
-			jsonLeft -= (jsonPtr - prevPtr);
+		// Decodes the next batch of items. Returns false, when there are no more items or on error
+		auto decodeBatch = [&](vector<Item> &batch, Error &status) {
+			batch.reserve(kModifyItemsBatchSize);
+			while (jsonPtr && *jsonPtr && batch.size() < kModifyItemsBatchSize) {
+				Item item = db.NewItem(nsName);
+				if (!item.Status().ok()) {
+					status = item.Status();
+					return false;
+				}
+				char *prevPtr = jsonPtr;
+				auto str = std::string_view(jsonPtr, jsonLeft);
+				if (jsonPtr != &itemJson[0] && isBlank(str)) {
+					jsonPtr = nullptr;
+					break;
+				}
+				status = item.Unsafe().FromJSON(str, &jsonPtr, mode == ModeDelete);
+				jsonLeft -= (jsonPtr - prevPtr);
+				if (!status.ok()) return false;
 
-			if (!status.ok()) {
-				return jsonStatus(ctx, http::HttpStatus(status));
+				item.SetPrecepts(precepts);
+				batch.emplace_back(std::move(item));
 			}
-
-			item.SetPrecepts(precepts);
-			status = modifyItem(db, nsName, item, mode);
-
-			if (!status.ok()) {
-				return jsonStatus(ctx, http::HttpStatus(status));
+			return jsonPtr && *jsonPtr;
+		};
+
+		Error decodeStatus, modifyStatus;
+		if (itemJson.size() < kPipelinedModifyMinSize) {
+			vector<Item> batch;
+			bool hasMore = true;
+			while (hasMore && modifyStatus.ok()) {
+				hasMore = decodeBatch(batch, decodeStatus);
+				modifyStatus = modifyBatch(batch);
+				if (!decodeStatus.ok()) break;
 			}
-
-			if (item.GetID() != -1) {
-				++cnt;
-				if (!precepts.empty()) updatedItems.push_back(string(item.GetJSON()));
+		} else {
+			// Large bodies are decoded by the separate thread, while the previous batches are modified. Count of the decoded
+			// batches, waiting for modification, is limited, so the decoder does not run ahead of the namespace
+			std::mutex mtx;
+			std::condition_variable cv;
+			std::deque<vector<Item>> decoded;
+			bool decodingDone = false, modifyingStopped = false;
+			std::thread decoder([&] {
+				bool hasMore = true;
+				while (hasMore) {
+					vector<Item> batch;
+					hasMore = decodeBatch(batch, decodeStatus);
+					std::unique_lock<std::mutex> lck(mtx);
+					cv.wait(lck, [&] { return decoded.size() < kMaxPendingDecodedBatches || modifyingStopped; });
+					if (modifyingStopped) break;
+					decoded.emplace_back(std::move(batch));
+					cv.notify_all();
+				}
+				std::lock_guard<std::mutex> lck(mtx);
+				decodingDone = true;
+				cv.notify_all();
+			});
+			for (;;) {
+				std::unique_lock<std::mutex> lck(mtx);
+				cv.wait(lck, [&] { return !decoded.empty() || decodingDone; });
+				if (decoded.empty()) break;
+				vector<Item> batch = std::move(decoded.front());
+				decoded.pop_front();
+				cv.notify_all();
+				lck.unlock();
+
+				modifyStatus = modifyBatch(batch);
+				if (!modifyStatus.ok()) {
+					lck.lock();
+					modifyingStopped = true;
+					cv.notify_all();
+					break;
+				}
 			}
+			decoder.join();
+		}
+		if (!modifyStatus.ok()) {
+			return jsonStatus(ctx, http::HttpStatus(modifyStatus));
+		}
+		if (!decodeStatus.ok()) {
+			return jsonStatus(ctx, http::HttpStatus(decodeStatus));
 		}
 		db.Commit(nsName);
 	}
@@ -1233,37 +1323,56 @@ int HTTPServer::modifyItemsTx(http::Context &ctx, ItemModifyMode mode) {
 	return format == "msgpack"sv ? modifyItemsTxMsgPack(ctx, *tx, precepts, mode) : modifyItemsTxJSON(ctx, *tx, precepts, mode);
 }
 
+// Compressed response has no content length, so the results are compressed and sent by parts, while they're encoded
+static void streamResultsPart(http::Context &ctx, WrSerializer &wrSer, std::string_view contentType) {
+	if (!ctx.writer->IsCompressed() || wrSer.Len() < kStreamedResultsPartSize) return;
+	ctx.writer->SetRespCode(http::StatusOK);
+	ctx.writer->SetHeader(http::Header{"Content-Type"sv, contentType});
+	ctx.writer->Write(wrSer.Slice());
+	wrSer.Reset();
+}
+
 int HTTPServer::queryResultsJSON(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults, unsigned limit, unsigned offset,
-								 bool withColumns, int width) {
+								 bool withColumns, int width, bool columnar) {
+	constexpr auto kContentType = "application/json; charset=utf-8"sv;
 	WrSerializer wrSer(ctx.writer->GetChunk());
 	JsonBuilder builder(wrSer);
 
-	auto iarray = builder.Array(kParamItems);
-	// TODO: normal check for query type
-	bool isWALQuery = res.Count() && res[0].IsRaw();
-	for (size_t i = offset; i < res.Count() && i < offset + limit; i++) {
-		if (!isWALQuery) {
-			iarray.Raw(nullptr, "");
-			res[i].GetJSON(wrSer, false);
-		} else {
-			auto obj = iarray.Object(nullptr);
-			obj.Put(kParamLsn, res[i].GetLSN());
-			if (!res[i].IsRaw()) {
-				iarray.Raw(kParamItem, "");
+	if (columnar) {
+		// Columns are sent instead of the items array
+		ColumnarEncoder(res, offset, limit).Encode(builder, kParamColumnar);
+	} else {
+		auto iarray = builder.Array(kParamItems);
+		// TODO: normal check for query type
+		bool isWALQuery = res.Count() && res[0].IsRaw();
+		for (size_t i = offset; i < res.Count() && i < offset + limit; i++) {
+			if (!isWALQuery) {
+				iarray.Raw(nullptr, "");
 				res[i].GetJSON(wrSer, false);
 			} else {
-				reindexer::WALRecord rec(res[i].GetRaw());
-				rec.GetJSON(obj, [this, &res, &ctx](std::string_view cjson) {
-					auto item = getDB(ctx, kRoleDataRead).NewItem(res.GetNamespaces()[0]);
-					item.FromCJSON(cjson);
-					return string(item.GetJSON());
-				});
+				auto obj = iarray.Object(nullptr);
+				obj.Put(kParamLsn, res[i].GetLSN());
+				if (!res[i].IsRaw()) {
+					iarray.Raw(kParamItem, "");
+					res[i].GetJSON(wrSer, false);
+				} else {
+					reindexer::WALRecord rec(res[i].GetRaw());
+					rec.GetJSON(obj, [this, &res, &ctx](std::string_view cjson) {
+						auto item = getDB(ctx, kRoleDataRead).NewItem(res.GetNamespaces()[0]);
+						item.FromCJSON(cjson);
+						return string(item.GetJSON());
+					});
+				}
 			}
-		}
 
-		if (i == offset) wrSer.Reserve(wrSer.Len() * (std::min(limit, unsigned(res.Count() - offset)) + 1));
+			if (ctx.writer->IsCompressed()) {
+				streamResultsPart(ctx, wrSer, kContentType);
+			} else if (i == offset) {
+				wrSer.Reserve(wrSer.Len() * (std::min(limit, unsigned(res.Count() - offset)) + 1));
+			}
+		}
+		iarray.End();
 	}
-	iarray.End();
 
 	if (!res.aggregationResults.empty()) {
 		auto arrNode = builder.Array(kParamAggregations);
@@ -1280,7 +1389,7 @@ int HTTPServer::queryResultsJSON(http::Context &ctx, reindexer::QueryResults &re
 }
 
 int HTTPServer::queryResultsMsgPack(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults, unsigned limit, unsigned offset,
-									bool withColumns, int width) {
+									bool withColumns, int width, bool columnar) {
 	int paramsToSend = 3;
 	bool withTotalItems = (!isQueryResults || limit != kDefaultLimit);
 	if (!res.aggregationResults.empty()) ++paramsToSend;
@@ -1292,14 +1401,21 @@ int HTTPServer::queryResultsMsgPack(http::Context &ctx, reindexer::QueryResults
 		++paramsToSend;
 	}
 
+	constexpr auto kContentType = "application/x-msgpack; charset=utf-8"sv;
 	WrSerializer wrSer(ctx.writer->GetChunk());
 	MsgPackBuilder msgpackBuilder(wrSer, ObjType::TypeObject, paramsToSend);
 
-	auto itemsArray = msgpackBuilder.Array(kParamItems, std::min(size_t(limit), size_t(res.Count() - offset)));
-	for (size_t i = offset; i < res.Count() && i < offset + limit; i++) {
-		res[i].GetMsgPack(wrSer, false);
+	if (columnar) {
+		// Columns are sent instead of the items array
+		ColumnarEncoder(res, offset, limit).Encode(msgpackBuilder, kParamColumnar);
+	} else {
+		auto itemsArray = msgpackBuilder.Array(kParamItems, std::min(size_t(limit), size_t(res.Count() - offset)));
+		for (size_t i = offset; i < res.Count() && i < offset + limit; i++) {
+			res[i].GetMsgPack(wrSer, false);
+			streamResultsPart(ctx, wrSer, kContentType);
+		}
+		itemsArray.End();
 	}
-	itemsArray.End();
 
 	if (!res.aggregationResults.empty()) {
 		auto aggregationsArray = msgpackBuilder.Array(kParamAggregations, res.aggregationResults.size());
@@ -1431,13 +1547,17 @@ int HTTPServer::queryResults(http::Context &ctx, reindexer::QueryResults &res, b
 	std::string_view format = ctx.request->params.Get("format");
 	std::string_view withColumnsParam = ctx.request->params.Get("with_columns");
 	bool withColumns = ((withColumnsParam == "1") && (width > 0)) ? true : false;
+	bool columnar = ctx.request->params.Get("columnar"sv) == "1"sv;
 
 	if (format == "msgpack"sv) {
-		return queryResultsMsgPack(ctx, res, isQueryResults, limit, offset, withColumns, width);
+		return queryResultsMsgPack(ctx, res, isQueryResults, limit, offset, withColumns, width, columnar);
 	} else if (format == "protobuf"sv) {
+		if (columnar) {
+			return status(ctx, http::HttpStatus(http::StatusBadRequest, "Columnar output is not supported for protobuf format"));
+		}
 		return queryResultsProtobuf(ctx, res, isQueryResults, limit, offset, withColumns, width);
 	} else {
-		return queryResultsJSON(ctx, res, isQueryResults, limit, offset, withColumns, width);
+		return queryResultsJSON(ctx, res, isQueryResults, limit, offset, withColumns, width, columnar);
 	}
 }
 
@@ -90,11 +90,11 @@ protected:
 	int queryResults(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults = false, unsigned limit = kDefaultLimit,
 					 unsigned offset = kDefaultOffset);
 	int queryResultsMsgPack(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults, unsigned limit, unsigned offset,
-							bool withColumns, int width = 0);
+							bool withColumns, int width = 0, bool columnar = false);
 	int queryResultsProtobuf(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults, unsigned limit, unsigned offset,
 							 bool withColumns, int width = 0);
 	int queryResultsJSON(http::Context &ctx, reindexer::QueryResults &res, bool isQueryResults, unsigned limit, unsigned offset,
-						 bool withColumns, int width = 0);
+						 bool withColumns, int width = 0, bool columnar = false);
 	template <typename Builder>
 	void queryResultParams(Builder &builder, reindexer::QueryResults &res, bool isQueryResults, unsigned limit, bool withColumns,
 						   int width);
@@ -7,6 +7,7 @@ namespace reindexer {
 
 const std::string_view kParamNamespaces = "namespaces";
 const std::string_view kParamItems = "items";
+const std::string_view kParamColumnar = "columnar";
 const std::string_view kParamCacheEnabled = "cache_enabled";
 const std::string_view kParamAggregations = "aggregations";
 const std::string_view kParamExplain = "explain";
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <thread>
 #include "debug/resolver.h"
+#include "debug/sampler.h"
 #include "estl/chunk_buf.h"
 #include "gperf_profiler.h"
 #include "pprof/gperf_profiler.h"
@@ -37,6 +38,11 @@ void Pprof::Attach(http::Router &router) {
 	router.POST<Pprof, &Pprof::Symbol>("/symbolz", this);
 }
 
+void Pprof::AttachSampler(http::Router &router) {
+	router.GET<Pprof, &Pprof::Sampled>("/debug/pprof/sampled", this);
+	router.GET<Pprof, &Pprof::Sampled>("/pprof/sampled", this);
+}
+
 int Pprof::Profile(http::Context &ctx) {
 #if REINDEX_WITH_GPERFTOOLS
 	long long seconds = 30;
@@ -144,6 +150,39 @@ int Pprof::Symbol(http::Context &ctx) {
 	return ctx.String(http::StatusOK, ser.DetachChunk());
 }
 
+// Returns the samples of the always-on sampler for the last 'seconds' without waiting. 'role' filters the threads by their role,
+// 'format=collapsed' returns the folded stacks for the flamegraph tools instead of the pprof profile
+int Pprof::Sampled(http::Context &ctx) {
+	using namespace std::string_view_literals;
+	auto &sampler = debug::CPUSampler::Instance();
+	if (!debug::CPUSampler::IsSupported()) {
+		return ctx.String(http::StatusInternalServerError, "Sampling profiler is not supported on this platform");
+	}
+
+	std::chrono::seconds window(60);
+	std::optional<debug::ThreadRole> role;
+	bool collapsed = false;
+	for (auto &p : ctx.request->params) {
+		if (p.name == "seconds"sv) {
+			const int seconds = stoi(p.val);
+			if (seconds > 0) window = std::chrono::seconds(seconds);
+		} else if (p.name == "role"sv) {
+			role = debug::ParseThreadRole(p.val);
+			if (!role) return ctx.String(http::StatusBadRequest, "Unknown thread role");
+		} else if (p.name == "format"sv) {
+			if (p.val == "collapsed"sv) {
+				collapsed = true;
+			} else if (p.val != "pprof"sv) {
+				return ctx.String(http::StatusBadRequest, "Unknown profile format");
+			}
+		}
+	}
+	if (!sampler.Frequency()) {
+		return ctx.String(http::StatusBadRequest, "Sampling profiler is disabled. Set debug.sampling_profiler_hz to enable it");
+	}
+	return ctx.String(http::StatusOK, collapsed ? sampler.Collapsed(window, role) : sampler.Profile(window, role));
+}
+
 void Pprof::resolveSymbol(uintptr_t ptr, WrSerializer &out) {
 	auto te = debug::TraceEntry(ptr);
 	std::string_view symbol = te.FuncName();
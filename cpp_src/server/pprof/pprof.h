@@ -13,12 +13,14 @@ using reindexer::WrSerializer;
 class Pprof {
 public:
 	void Attach(http::Router &router);
+	void AttachSampler(http::Router &router);
 
 	int Profile(http::Context &ctx);
 	int ProfileHeap(http::Context &ctx);
 	int Growth(http::Context &ctx);
 	int CmdLine(http::Context &ctx);
 	int Symbol(http::Context &ctx);
+	int Sampled(http::Context &ctx);
 
 protected:
 	void resolveSymbol(uintptr_t ptr, WrSerializer &out);
@@ -0,0 +1,22 @@
+#include "resourceaccounts.h"
+
+namespace reindexer_server {
+
+bool ResourceAccounts::Required(const ServerConfig &cfg) noexcept {
+	const auto &q = cfg.Quotas;
+	return cfg.ResourcesAccounting || q.cpuUsPerOp || q.rowsPerOp || q.cpuUsPerSec || q.resultsBytes || !cfg.QuotasOverrides.empty();
+}
+
+std::shared_ptr<reindexer::ResourceAccount> ResourceAccounts::Get(const std::string &user, const std::string &app) {
+	std::string key = app.empty() ? user : user + "/" + app;
+	std::lock_guard lck(mtx_);
+	auto it = accounts_.find(key);
+	if (it != accounts_.end()) return it->second;
+
+	auto quotasIt = cfg_.QuotasOverrides.find(key);
+	if (quotasIt == cfg_.QuotasOverrides.end()) quotasIt = cfg_.QuotasOverrides.find(user);
+	const auto &quotas = quotasIt == cfg_.QuotasOverrides.end() ? cfg_.Quotas : quotasIt->second;
+	return accounts_.emplace(std::move(key), std::make_shared<reindexer::ResourceAccount>(quotas)).first->second;
+}
+
+}  // namespace reindexer_server
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "config.h"
+#include "core/resourceusage.h"
+
+namespace reindexer_server {
+
+/// Resource accounts of the RPC clients. Client is identified by the user name and the application name, so all the connections of the
+/// client share its account and quotas
+class ResourceAccounts {
+public:
+	explicit ResourceAccounts(const ServerConfig &cfg) : cfg_(cfg) {}
+
+	/// @return true, if the accounting is enabled or some quotas are configured
+	static bool Required(const ServerConfig &cfg) noexcept;
+	std::shared_ptr<reindexer::ResourceAccount> Get(const std::string &user, const std::string &app);
+
+private:
+	const ServerConfig &cfg_;
+	std::mutex mtx_;
+	std::unordered_map<std::string, std::shared_ptr<reindexer::ResourceAccount>> accounts_;
+};
+
+}  // namespace reindexer_server
@@ -12,6 +12,7 @@ constexpr double kTimerPeriod = 0.1;
 
 void RPCQrWatcher::Register(net::ev::dynamic_loop& loop, LoggerWrapper logger) {
 	timer_.set(loop);
+	timer_.set_coarse(true);
 	timer_.set([this, logger = std::move(logger)](net::ev::timer&, int) {
 		thread_local static auto lastCbCallTime = std::chrono::steady_clock::now();
 		constexpr auto secCount = std::chrono::duration_cast<std::chrono::seconds>(kTimeIncrementPeriod).count();
@@ -30,7 +31,8 @@ void RPCQrWatcher::Register(net::ev::dynamic_loop& loop, LoggerWrapper logger) {
 			logger.info("Allocated qrs: {} ", allocated_.load(std::memory_order_relaxed));
 		}
 
-		if (idleTimeout_.count() > 0 && now % kSingleStepDelay == 0) {
+		const bool spillingEnabled = spillTimeout_.count() > 0 || spillItemsLimit_;
+		if ((idleTimeout_.count() > 0 || spillingEnabled) && now % kSingleStepDelay == 0) {
 			const uint32_t size = allocated_.load(std::memory_order_acquire);
 			uint32_t from = 0;
 			uint32_t to = size;
@@ -44,9 +46,17 @@ void RPCQrWatcher::Register(net::ev::dynamic_loop& loop, LoggerWrapper logger) {
 				to = std::min(from + partSize, size);
 			}
 			prevToValue = (to == size) ? 0 : to;
-			const auto cnt = removeExpired(now, from, to);
-			if (cnt) {
-				logger.info("{} query results were removed due to idle timeout", cnt);
+			if (idleTimeout_.count() > 0) {
+				const auto cnt = removeExpired(now, from, to);
+				if (cnt) {
+					logger.info("{} query results were removed due to idle timeout", cnt);
+				}
+			}
+			if (spillingEnabled) {
+				const auto cnt = spillIdle(now, from, to);
+				if (cnt) {
+					logger.trace("{} query results were spilled", cnt);
+				}
 			}
 		}
 	});
@@ -78,7 +88,7 @@ uint32_t RPCQrWatcher::removeExpired(uint32_t now, uint32_t from, uint32_t to) {
 				}
 			} while (!qrs.uid.compare_exchange_strong(curUID, newUID, std::memory_order_acq_rel));
 			if (shouldClearQRs) {
-				qrs.qr = QueryResults();
+				clearQueryResults(qrs);
 				newUID.state = UID::Uninitialized;
 				qrs.uid.store(newUID, std::memory_order_release);
 				++expiredCnt;
@@ -91,4 +101,49 @@ uint32_t RPCQrWatcher::removeExpired(uint32_t now, uint32_t from, uint32_t to) {
 	return expiredCnt;
 }
 
+uint32_t RPCQrWatcher::spillIdle(uint32_t now, uint32_t from, uint32_t to) {
+	uint32_t spilledCnt = 0;
+	[[maybe_unused]] const auto allocated = allocated_.load(std::memory_order_acquire);
+	assertf(to <= allocated, "to: %d, allocated: %d", to, allocated);
+	for (uint32_t i = from; i < to; ++i) {
+		// While the limit of the items is exceeded, results are spilled right after the client stops using them
+		const bool overLimit = spillItemsLimit_ && openItems_.load(std::memory_order_relaxed) > spillItemsLimit_;
+		if (!overLimit && spillTimeout_.count() <= 0) break;
+		if (trySpill(qrs_[i], now, overLimit ? 1 : spillTimeout_.count())) {
+			++spilledCnt;
+		}
+	}
+	return spilledCnt;
+}
+
+bool RPCQrWatcher::trySpill(QrStorage& qrs, uint32_t now, int64_t idleTimeout) {
+	// Results, which were not fetched yet or were already spilled, have no accounted items
+	if (!qrs.itemsCount.load(std::memory_order_relaxed)) return false;
+	if (!SpilledQueryResults::CanSpill(qrs.fetchFlags.load(std::memory_order_relaxed))) return false;
+	UID curUID = qrs.uid.load(std::memory_order_acquire);
+	UID newUID;
+	do {
+		if (!qrs.IsIdle(curUID, now, idleTimeout)) return false;
+		newUID = curUID;
+		newUID.state = UID::SpillingInProgress;
+	} while (!qrs.uid.compare_exchange_strong(curUID, newUID, std::memory_order_acq_rel));
+
+	bool spilled = false;
+	const int flags = qrs.fetchFlags.load(std::memory_order_relaxed);
+	if (!qrs.spilled && flags >= 0) {
+		try {
+			qrs.spilled = std::make_unique<SpilledQueryResults>(qrs.qr, flags, qrs.fetchedTo.load(std::memory_order_relaxed));
+			openItems_.fetch_sub(qrs.itemsCount.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+			// Namespaces' payloads are released here
+			qrs.qr = QueryResults();
+			spilled = true;
+		} catch (...) {
+			// Results are kept as is, if they can not be serialized
+			qrs.spilled.reset();
+		}
+	}
+	qrs.uid.store(curUID, std::memory_order_release);
+	return spilled;
+}
+
 }  // namespace reindexer_server
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <thread>
 #include <vector>
+#include "core/cbinding/resultserializer.h"
 #include "core/queryresults/queryresults.h"
 #include "core/type_consts.h"
 #include "loggerwrapper.h"
@@ -21,9 +23,19 @@ public:
 	static_assert(kMaxConcurrentQRCount % kChuncksCount == 0, "Each chunck will must have the same size");
 	constexpr static uint32_t kChunkSize = kMaxConcurrentQRCount / kChuncksCount;
 
-	RPCQrWatcher(std::chrono::seconds idleTimeout)
-		: idleTimeout_(idleTimeout.count() > 0 ? (idleTimeout + std::chrono::seconds(1)) : idleTimeout) {}
+	/// @param idleTimeout - Idle query results are removed after this timeout. 0 means 'disabled'
+	/// @param spillTimeout - Idle query results are spilled after this timeout (see SpilledQueryResults). 0 means 'disabled'
+	/// @param spillItemsLimit - Idle query results are spilled without the timeout, while the total count of the items of the query
+	/// results, which are not spilled, exceeds this limit. 0 means 'no limit'
+	RPCQrWatcher(std::chrono::seconds idleTimeout, std::chrono::seconds spillTimeout = std::chrono::seconds(0), size_t spillItemsLimit = 0)
+		: idleTimeout_(idleTimeout.count() > 0 ? (idleTimeout + std::chrono::seconds(1)) : idleTimeout),
+		  spillTimeout_(spillTimeout),
+		  spillItemsLimit_(spillItemsLimit) {}
 
+private:
+	struct QrStorage;
+
+public:
 	class Ref {
 	public:
 		Ref() = default;
@@ -31,36 +43,49 @@ public:
 		Ref& operator=(const Ref&) = delete;
 		Ref(Ref&& o) noexcept : d_(std::move(o.d_)) {
 			o.d_.owner = nullptr;
-			o.d_.qr = nullptr;
+			o.d_.storage = nullptr;
 		}
 		Ref& operator=(Ref&& o) noexcept {
 			if (this != &o) {
 				d_ = std::move(o.d_);
 				o.d_.owner = nullptr;
-				o.d_.qr = nullptr;
+				o.d_.storage = nullptr;
 			}
 			return *this;
 		}
 		~Ref() {
 			if (d_.owner) {
-				assertrx(d_.qr);
+				assertrx(d_.storage);
 				d_.owner->onRefDestroyed(d_.id);
 			}
 		}
 		QueryResults& operator*() {
-			if (!d_.qr) throw Error(errLogic, "Query results' pointer is nullptr");
-			return *d_.qr;
+			if (!d_.storage) throw Error(errLogic, "Query results' pointer is nullptr");
+			return d_.storage->qr;
 		}
 		uint32_t ID() const noexcept { return d_.id; }
+		/// @return Spilled query results or nullptr, if the results were not spilled. Spilled results are never replaced, while the
+		/// reference exists
+		const SpilledQueryResults* Spilled() const noexcept { return d_.storage ? d_.storage->spilled.get() : nullptr; }
+		/// Remembers the flags and the end of the fetched page. Remaining items are spilled in this format
+		void OnFetched(const ResultFetchOpts& opts) noexcept {
+			if (!d_.storage || !d_.owner) return;
+			const auto count = Spilled() ? Spilled()->Count() : d_.storage->qr.Count();
+			d_.storage->fetchFlags.store(opts.flags & ~kResultsWithPayloadTypes, std::memory_order_relaxed);
+			d_.storage->fetchedTo.store(uint32_t(std::min(size_t(opts.fetchOffset) + opts.fetchLimit, count)), std::memory_order_relaxed);
+			if (!Spilled() && d_.storage->itemsCount.exchange(count, std::memory_order_relaxed) == 0) {
+				d_.owner->openItems_.fetch_add(count, std::memory_order_relaxed);
+			}
+		}
 
 	private:
-		Ref(uint32_t id, QueryResults& qr, RPCQrWatcher& owner) noexcept : d_{id, &qr, &owner} {}
+		Ref(uint32_t id, QrStorage& storage, RPCQrWatcher& owner) noexcept : d_{id, &storage, &owner} {}
 
 		friend class RPCQrWatcher;
 
 		struct Data {
 			uint32_t id = 0;
-			QueryResults* qr = nullptr;
+			QrStorage* storage = nullptr;
 			RPCQrWatcher* owner = nullptr;
 		};
 
@@ -92,6 +117,7 @@ public:
 		}
 		UID newUID;
 		do {
+			curUID = awaitSpilling(qrs.uid, curUID);
 			shouldClearQRs = (curUID.refs == 0);
 			if ((id.uid >= 0 && curUID.state == UID::InitializedUIDEnabled) ||
 				(id.uid == kDisabled && curUID.state == UID::InitializedUIDDisabled)) {
@@ -104,7 +130,7 @@ public:
 			}
 		} while (!qrs.uid.compare_exchange_strong(curUID, newUID, std::memory_order_acq_rel));
 		if (shouldClearQRs) {
-			qrs.qr = QueryResults();
+			clearQueryResults(qrs);
 			curUID = newUID;
 			do {
 				newUID.state = UID::Uninitialized;
@@ -126,6 +152,8 @@ private:
 			InitializedUIDEnabled = 1,
 			InitializedUIDDisabled = 2,
 			ClearingInProgress = 3,
+			// Results are exclusively owned by the watcher's timer, which spills them. Previous state is restored after that
+			SpillingInProgress = 4,
 		};
 
 		UID() noexcept : freed(0), state(Uninitialized), refs(0), val(0) {}
@@ -147,7 +175,11 @@ private:
 		QrStorage(QrStorage&& o)
 			: uid(o.uid.load(std::memory_order_relaxed)),
 			  lastAccessTime(o.lastAccessTime.load(std::memory_order_relaxed)),
-			  qr(std::move(o.qr)) {}
+			  fetchFlags(o.fetchFlags.load(std::memory_order_relaxed)),
+			  fetchedTo(o.fetchedTo.load(std::memory_order_relaxed)),
+			  itemsCount(o.itemsCount.load(std::memory_order_relaxed)),
+			  qr(std::move(o.qr)),
+			  spilled(std::move(o.spilled)) {}
 
 		bool IsExpired(int64_t now, int64_t idleTimeout) const noexcept {
 			return IsExpired(uid.load(std::memory_order_acquire), now, idleTimeout);
@@ -159,10 +191,24 @@ private:
 			}
 			return false;
 		}
+		bool IsIdle(UID curUID, int64_t now, int64_t idleTimeout) const noexcept {
+			if (curUID.refs == 0 && !curUID.freed &&
+				(curUID.state == UID::InitializedUIDEnabled || curUID.state == UID::InitializedUIDDisabled)) {
+				const auto lastAccess = lastAccessTime.load(std::memory_order_relaxed);
+				return lastAccess >= 0 && (now > lastAccess) && (now - lastAccess >= idleTimeout);
+			}
+			return false;
+		}
 
 		std::atomic<UID> uid;
 		std::atomic<int32_t> lastAccessTime = {kUninitialized};
+		// Flags and the end of the last fetched page (see Ref::OnFetched). -1 means 'not fetched yet'
+		std::atomic<int32_t> fetchFlags = {-1};
+		std::atomic<uint32_t> fetchedTo = {0};
+		// Count of the items, which are accounted in the openItems_
+		std::atomic<size_t> itemsCount = {0};
 		QueryResults qr;
+		std::unique_ptr<SpilledQueryResults> spilled;
 	};
 	template <typename T>
 	class PartitionedArray {
@@ -222,7 +268,7 @@ private:
 			}
 		} while (!qrs.uid.compare_exchange_strong(curUID, newUID, std::memory_order_acq_rel));
 		if (shouldClearQRs) {
-			qrs.qr = QueryResults();
+			clearQueryResults(qrs);
 			newUID.state = UID::Uninitialized;
 			qrs.uid.store(newUID, std::memory_order_release);
 
@@ -230,6 +276,21 @@ private:
 			putFreeID(id);
 		}
 	}
+	void clearQueryResults(QrStorage& qrs) {
+		openItems_.fetch_sub(qrs.itemsCount.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+		qrs.qr = QueryResults();
+		qrs.spilled.reset();
+		qrs.fetchFlags.store(-1, std::memory_order_relaxed);
+		qrs.fetchedTo.store(0, std::memory_order_relaxed);
+	}
+	static UID awaitSpilling(const std::atomic<UID>& uid, UID curUID) noexcept {
+		// Spilling doesn't take long, comparing to the lifetime of the results
+		while (curUID.state == UID::SpillingInProgress) {
+			std::this_thread::yield();
+			curUID = uid.load(std::memory_order_acquire);
+		}
+		return curUID;
+	}
 	Ref createQueryResults(int64_t uid) {
 		std::pair<uint32_t, bool> freeIDP;
 		{
@@ -247,7 +308,7 @@ private:
 		if (!freeIDP.second) {
 			allocated_.fetch_add(1, std::memory_order_release);
 		}
-		return Ref(freeIDP.first, qrs.qr, *this);
+		return Ref(freeIDP.first, qrs, *this);
 	}
 	Ref getQueryResults(uint32_t id, int64_t uid) {
 		checkIDs(int32_t(id), uid);
@@ -255,6 +316,7 @@ private:
 		UID curUID = qrs.uid.load(std::memory_order_acquire);
 		UID newUID;
 		do {
+			curUID = awaitSpilling(qrs.uid, curUID);
 			newUID = curUID;
 			if ((uid >= 0 && curUID.state == UID::InitializedUIDEnabled && uint64_t(uid) == curUID.val) ||
 				(uid == kDisabled && curUID.state == UID::InitializedUIDDisabled)) {
@@ -269,9 +331,11 @@ private:
 			}
 		} while (!qrs.uid.compare_exchange_strong(curUID, newUID, std::memory_order_acq_rel));
 		qrs.lastAccessTime.store(now(), std::memory_order_relaxed);
-		return Ref(id, qrs.qr, *this);
+		return Ref(id, qrs, *this);
 	}
 	uint32_t removeExpired(uint32_t now, uint32_t from, uint32_t to);
+	uint32_t spillIdle(uint32_t now, uint32_t from, uint32_t to);
+	bool trySpill(QrStorage& qrs, uint32_t now, int64_t idleTimeout);
 	uint32_t now() const noexcept { return nowSeconds_.load(std::memory_order_relaxed); }
 
 	void putFreeID(uint32_t id) noexcept { freeIDs_[freeIDsCnt_++] = id; }
@@ -283,6 +347,10 @@ private:
 	}
 
 	const std::chrono::seconds idleTimeout_;
+	const std::chrono::seconds spillTimeout_;
+	const size_t spillItemsLimit_;
+	// Count of the items of the fetched query results, which are not spilled
+	std::atomic<size_t> openItems_ = {0};
 	std::array<uint32_t, kMaxConcurrentQRCount> freeIDs_ = {};
 	uint32_t freeIDsCnt_ = 0;
 	PartitionedArray<QrStorage> qrs_;
@@ -19,12 +19,14 @@ const size_t kMaxTxCount = 1024;
 RPCServer::RPCServer(DBManager &dbMgr, LoggerWrapper &logger, IClientsStats *clientsStats, const ServerConfig &scfg,
 					 IStatsWatcher *statsCollector)
 	: dbMgr_(dbMgr),
+	  executionPools_(ExecutionPools::Required(scfg) ? std::make_unique<ExecutionPools>(scfg) : nullptr),
 	  serverConfig_(scfg),
 	  logger_(logger),
 	  statsWatcher_(statsCollector),
 	  clientsStats_(clientsStats),
+	  resourceAccounts_(ResourceAccounts::Required(scfg) ? std::make_unique<ResourceAccounts>(scfg) : nullptr),
 	  startTs_(std::chrono::system_clock::now()),
-	  qrWatcher_(serverConfig_.RPCQrIdleTimeout) {}
+	  qrWatcher_(serverConfig_.RPCQrIdleTimeout, serverConfig_.RPCQrSpillTimeout, serverConfig_.RPCQrSpillItemsLimit) {}
 
 RPCServer::~RPCServer() { listener_.reset(); }
 
@@ -65,6 +67,13 @@ Error RPCServer::Login(cproto::Context &ctx, p_string login, p_string password,
 	} else {
 		clientData->rxVersion = SemVersion();
 	}
+	const string app = appName.hasValue() ? appName.value().toString() : string();
+	if (resourceAccounts_) {
+		clientData->resources = resourceAccounts_->Get(clientData->auth.Login(), app);
+	}
+	if (executionPools_) {
+		clientData->pool = executionPools_->Get(clientData->auth.Login(), app);
+	}
 	if (clientData->rxVersion < kMinUnknownReplSupportRxVersion) {
 		clientData->pusher.SetFilter([](WALRecord &rec) {
 			if (rec.type == WalCommitTransaction || rec.type == WalInitTransaction || rec.type == WalSetSchema) {
@@ -83,9 +92,10 @@ Error RPCServer::Login(cproto::Context &ctx, p_string login, p_string password,
 		conn.dbName = clientData->auth.DBName();
 		conn.userRights = string(UserRoleName(clientData->auth.UserRights()));
 		conn.clientVersion = clientData->rxVersion.StrippedString();
-		conn.appName = appName.hasValue() ? appName.value().toString() : string();
+		conn.appName = app;
 		conn.txStats = clientData->txStats;
 		conn.updatesPusher = &clientData->pusher;
+		conn.resources = clientData->resources;
 		clientsStats_->AddConnection(clientData->connID, std::move(conn));
 	}
 
@@ -169,6 +179,11 @@ void RPCServer::OnClose(cproto::Context &ctx, const Error &err) {
 				}
 			}
 		}
+		if (clientData->resources) {
+			std::lock_guard<std::mutex> lck(clientData->resultsMtx);
+			for (auto &charge : clientData->resultsBytes) clientData->resources->AddResultsBytes(-charge.second);
+			clientData->resultsBytes.clear();
+		}
 	}
 	logger_.info("RPC: Client disconnected");
 }
@@ -396,7 +411,7 @@ Error RPCServer::CommitTx(cproto::Context &ctx, int64_t txId, cproto::optional<i
 
 	Transaction &tr = getTx(ctx, txId);
 	QueryResults qres;
-	auto err = db.CommitTransaction(tr, qres);
+	Error err = execOperation(ctx, db, tr.GetName(), false, [&](Reindexer &rx) { return rx.CommitTransaction(tr, qres); });
 	if (err.ok()) {
 		int32_t ptVers = -1;
 		ResultFetchOpts opts;
@@ -549,7 +564,8 @@ Error RPCServer::DeleteQuery(cproto::Context &ctx, p_string queryBin, cproto::op
 	query.type_ = QueryDelete;
 
 	QueryResults qres;
-	auto err = getDB(ctx, kRoleDataWrite).Delete(query, qres);
+	auto db = getDB(ctx, kRoleDataWrite);
+	Error err = execOperation(ctx, db, query._namespace, false, [&](Reindexer &rx) { return rx.Delete(query, qres); });
 	if (!err.ok()) {
 		return err;
 	}
@@ -572,7 +588,8 @@ Error RPCServer::UpdateQuery(cproto::Context &ctx, p_string queryBin, cproto::op
 	query.type_ = QueryUpdate;
 
 	QueryResults qres;
-	auto err = getDB(ctx, kRoleDataWrite).Update(query, qres);
+	auto db = getDB(ctx, kRoleDataWrite);
+	Error err = execOperation(ctx, db, query._namespace, false, [&](Reindexer &rx) { return rx.Update(query, qres); });
 	if (!err.ok()) {
 		return err;
 	}
@@ -605,15 +622,37 @@ Reindexer RPCServer::getDB(cproto::Context &ctx, UserRole role) {
 }
 
 Error RPCServer::sendResults(cproto::Context &ctx, QueryResults &qres, RPCQrId id, const ResultFetchOpts &opts) {
-	WrResultSerializer rser(opts);
+	// Results are encoded directly into the connection's send buffer
+	WrResultSerializer rser(ctx.writer->GetDataChunk(), opts);
 	bool doClose = rser.PutResults(&qres);
 	if (doClose && id.main >= 0) {
 		freeQueryResults(ctx, id);
 		id.main = -1;
 		id.uid = RPCQrWatcher::kUninitialized;
 	}
-	std::string_view resSlice = rser.Slice();
-	ctx.Return({cproto::Arg(p_string(&resSlice)), cproto::Arg(int(id.main)), cproto::Arg(int64_t(id.uid))});
+	ctx.Return(rser.DetachChunk(), {cproto::Arg(int(id.main)), cproto::Arg(int64_t(id.uid))});
+
+	return errOK;
+}
+
+Error RPCServer::sendResults(cproto::Context &ctx, RPCQrWatcher::Ref &qres, RPCQrId id, const ResultFetchOpts &opts) {
+	qres.OnFetched(opts);
+	const SpilledQueryResults *spilled = qres.Spilled();
+	if (!spilled) return sendResults(ctx, *qres, id, opts);
+
+	WrSerializer ser(ctx.writer->GetDataChunk());
+	bool doClose = false;
+	try {
+		doClose = spilled->PutResults(ser, opts);
+	} catch (const Error &err) {
+		return err;
+	}
+	if (doClose && id.main >= 0) {
+		freeQueryResults(ctx, id);
+		id.main = -1;
+		id.uid = RPCQrWatcher::kUninitialized;
+	}
+	ctx.Return(ser.DetachChunk(), {cproto::Arg(int(id.main)), cproto::Arg(int64_t(id.uid))});
 
 	return errOK;
 }
@@ -641,6 +680,7 @@ Error RPCServer::processTxItem(DataFormat format, std::string_view itemData, Ite
 
 RPCQrWatcher::Ref RPCServer::createQueryResults(cproto::Context &ctx, RPCQrId &id) {
 	auto data = getClientDataSafe(ctx);
+	std::lock_guard<std::mutex> lck(data->resultsMtx);
 
 	assertrx(id.main < 0);
 
@@ -665,6 +705,7 @@ RPCQrWatcher::Ref RPCServer::createQueryResults(cproto::Context &ctx, RPCQrId &i
 		} catch (Error &e) {
 			if (e.code() == errParams) {
 				// Timed out query results were found
+				releaseResultsCharge(*data, data->results[idx].main);
 				data->results[idx] = id;
 				return qres;
 			} else {
@@ -681,18 +722,68 @@ RPCQrWatcher::Ref RPCServer::createQueryResults(cproto::Context &ctx, RPCQrId &i
 
 void RPCServer::freeQueryResults(cproto::Context &ctx, RPCQrId id) {
 	auto data = getClientDataSafe(ctx);
+	std::lock_guard<std::mutex> lck(data->resultsMtx);
 	for (auto &qrId : data->results) {
 		if (qrId.main == id.main) {
 			if (qrId.uid != id.uid) {
 				throw Error(errLogic, "Invalid query uid: %d vs %d", qrId.uid, id.uid);
 			}
 			qrId.main = -1;
+			releaseResultsCharge(*data, id.main);
 			qrWatcher_.FreeQueryResults(id);
 			return;
 		}
 	}
 }
 
+void RPCServer::releaseResultsCharge(RPCClientData &data, int qrId) {
+	if (!data.resources) return;
+	auto it = data.resultsBytes.find(qrId);
+	if (it != data.resultsBytes.end()) {
+		data.resources->AddResultsBytes(-it->second);
+		data.resultsBytes.erase(it);
+	}
+}
+
+void RPCServer::chargeResults(cproto::Context &ctx, RPCQrId id, const QueryResults &qr) {
+	auto data = getClientDataSafe(ctx);
+	if (!data->resources || id.main < 0) return;
+	// Items of the results refer to the namespace's payloads, so only the results' own memory is estimated
+	const int64_t bytes = int64_t(sizeof(QueryResults) + qr.Count() * sizeof(ItemRef) + qr.GetExplainResults().size());
+	std::lock_guard<std::mutex> lck(data->resultsMtx);
+	data->resultsBytes[id.main] += bytes;
+	data->resources->AddResultsBytes(bytes);
+}
+
+Error RPCServer::execOperation(cproto::Context &ctx, Reindexer &db, std::string_view nsName, bool withResults,
+							   const std::function<Error(Reindexer &)> &op) {
+	auto data = getClientDataSafe(ctx);
+	Error ret;
+	cproto::CallsExecutor *executor = nullptr;
+	ExecutionPool *pool = data->pool;
+	if (!pool && executionPools_ && !nsName.empty()) pool = executionPools_->GetByNamespace(nsName);
+	if (pool) {
+		ret = pool->Admit();
+		if (!ret.ok()) return ret;
+		executor = &pool->Executor();
+	}
+	if (!data->resources) {
+		ctx.Await([&] { ret = op(db); }, executor);
+		return ret;
+	}
+	ret = data->resources->Admit(withResults);
+	if (!ret.ok()) return ret;
+	ctx.Await(
+		[&] {
+			// Scope has to be created by the thread, which executes the operation, to measure its CPU time
+			ResourceUsageScope scope(*data->resources);
+			auto accountedDb = db.WithContext(&scope);
+			ret = scope.Result(op(accountedDb));
+		},
+		executor);
+	return ret;
+}
+
 Transaction &RPCServer::getTx(cproto::Context &ctx, int64_t id) {
 	auto data = getClientDataSafe(ctx);
 
@@ -748,6 +839,16 @@ static h_vector<int32_t, 4> pack2vec(p_string pack) {
 	return vec;
 }
 
+static VariantArray pack2params(p_string pack) {
+	// Get array of the SQL placeholders values
+	Serializer ser(pack.data(), pack.size());
+	VariantArray params;
+	const int cnt = ser.GetVarUint();
+	params.reserve(cnt);
+	for (int i = 0; i < cnt; i++) params.emplace_back(ser.GetVariant().EnsureHold());
+	return params;
+}
+
 Error RPCServer::Select(cproto::Context &ctx, p_string queryBin, int flags, int limit, p_string ptVersionsPck) {
 	Query query;
 	Serializer ser(queryBin);
@@ -773,18 +874,21 @@ Error RPCServer::Select(cproto::Context &ctx, p_string queryBin, int flags, int
 		throw e;
 	}
 
-	auto ret = getDB(ctx, kRoleDataRead).Select(query, *qres);
+	auto db = getDB(ctx, kRoleDataRead);
+	Error ret = execOperation(ctx, db, query._namespace, true, [&](Reindexer &rx) { return rx.Select(query, *qres); });
 	if (!ret.ok()) {
 		freeQueryResults(ctx, id);
 		return ret;
 	}
+	chargeResults(ctx, id, *qres);
 	auto ptVersions = pack2vec(ptVersionsPck);
 	ResultFetchOpts opts{flags, ptVersions, 0, unsigned(limit)};
 
-	return sendResults(ctx, *qres, id, opts);
+	return sendResults(ctx, qres, id, opts);
 }
 
-Error RPCServer::SelectSQL(cproto::Context &ctx, p_string querySql, int flags, int limit, p_string ptVersionsPck) {
+Error RPCServer::SelectSQL(cproto::Context &ctx, p_string querySql, int flags, int limit, p_string ptVersionsPck,
+						  cproto::optional<p_string> paramsPack) {
 	RPCQrId id{-1, (flags & kResultsSupportIdleTimeout) ? RPCQrWatcher::kUninitialized : RPCQrWatcher::kDisabled};
 	RPCQrWatcher::Ref qres;
 	try {
@@ -795,15 +899,29 @@ Error RPCServer::SelectSQL(cproto::Context &ctx, p_string querySql, int flags, i
 		}
 		throw e;
 	}
-	auto ret = getDB(ctx, kRoleDataRead).Select(querySql, *qres);
+	auto db = getDB(ctx, kRoleDataRead);
+	Error ret;
+	if (paramsPack.hasValue() && paramsPack.value().size()) {
+		VariantArray params;
+		try {
+			params = pack2params(paramsPack.value());
+		} catch (Error &e) {
+			freeQueryResults(ctx, id);
+			return e;
+		}
+		ret = execOperation(ctx, db, {}, true, [&](Reindexer &rx) { return rx.Select(querySql, params, *qres); });
+	} else {
+		ret = execOperation(ctx, db, {}, true, [&](Reindexer &rx) { return rx.Select(querySql, *qres); });
+	}
 	if (!ret.ok()) {
 		freeQueryResults(ctx, id);
 		return ret;
 	}
+	chargeResults(ctx, id, *qres);
 	auto ptVersions = pack2vec(ptVersionsPck);
 	ResultFetchOpts opts{flags, ptVersions, 0, unsigned(limit)};
 
-	return sendResults(ctx, *qres, id, opts);
+	return sendResults(ctx, qres, id, opts);
 }
 
 Error RPCServer::FetchResults(cproto::Context &ctx, int reqId, int flags, int offset, int limit, cproto::optional<int64_t> qrUID) {
@@ -819,16 +937,130 @@ Error RPCServer::FetchResults(cproto::Context &ctx, int reqId, int flags, int of
 		throw e;
 	}
 
+	if (isStreamed(ctx, reqId)) {
+		return Error(errParams, "Query results %d are streamed and can not be fetched", reqId);
+	}
+
 	ResultFetchOpts opts = {flags, {}, unsigned(offset), unsigned(limit)};
-	return sendResults(ctx, *qres, id, opts);
+	return sendResults(ctx, qres, id, opts);
 }
 
 Error RPCServer::CloseResults(cproto::Context &ctx, int reqId, cproto::optional<int64_t> qrUID) {
 	const RPCQrId id{reqId, qrUID.hasValue() ? qrUID.value() : RPCQrWatcher::kDisabled};
+	auto data = getClientDataSafe(ctx);
+	{
+		std::lock_guard<std::mutex> lck(data->resultsMtx);
+		auto it = std::find_if(data->streams.begin(), data->streams.end(), [reqId](const RPCResultsStream &s) { return s.id.main == reqId; });
+		if (it != data->streams.end()) data->streams.erase(it);
+	}
 	freeQueryResults(ctx, id);
 	return errOK;
 }
 
+Error RPCServer::StreamResults(cproto::Context &ctx, int reqId, int64_t qrUID, int flags, int offset, int chunkSize, int window) {
+	if (offset < 0 || chunkSize <= 0 || window <= 0) {
+		return Error(errParams, "Invalid results stream params: offset %d, chunk size %d, window %d", offset, chunkSize, window);
+	}
+	RPCQrId id{reqId, qrUID};
+	try {
+		[[maybe_unused]] RPCQrWatcher::Ref qres = qrWatcher_.GetQueryResults(id);
+	} catch (Error &e) {
+		if (e.code() == errParams) {
+			return e;
+		}
+		throw e;
+	}
+
+	auto data = getClientDataSafe(ctx);
+	{
+		std::lock_guard<std::mutex> lck(data->resultsMtx);
+		for (auto &stream : data->streams) {
+			if (stream.id.main == reqId) {
+				return Error(errParams, "Query results %d are already streamed", reqId);
+			}
+		}
+		// Payload types were sent with the first page of the results
+		data->streams.emplace_back(RPCResultsStream{id, ctx.call->seq, flags & ~kResultsWithPayloadTypes, unsigned(offset),
+													unsigned(chunkSize), int64_t(window)});
+	}
+	ctx.Return({});
+	pushResultsChunks(ctx, *data, data->streams.size() - 1);
+	return errOK;
+}
+
+Error RPCServer::StreamCredit(cproto::Context &ctx, int reqId, int64_t qrUID, int credits) {
+	if (credits <= 0) {
+		return Error(errParams, "Invalid results stream credits: %d", credits);
+	}
+	auto data = getClientDataSafe(ctx);
+	size_t idx = 0;
+	for (; idx < data->streams.size(); ++idx) {
+		if (data->streams[idx].id.main == reqId) break;
+	}
+	if (idx == data->streams.size() || data->streams[idx].id.uid != qrUID) {
+		return Error(errParams, "Query results %d are not streamed", reqId);
+	}
+	data->streams[idx].credits += credits;
+	ctx.Return({});
+	pushResultsChunks(ctx, *data, idx);
+	return errOK;
+}
+
+bool RPCServer::isStreamed(cproto::Context &ctx, int reqId) {
+	auto data = getClientDataSafe(ctx);
+	std::lock_guard<std::mutex> lck(data->resultsMtx);
+	return std::any_of(data->streams.begin(), data->streams.end(), [reqId](const RPCResultsStream &s) { return s.id.main == reqId; });
+}
+
+void RPCServer::pushResultsChunks(cproto::Context &ctx, RPCClientData &data, size_t streamIdx) {
+	auto &stream = data.streams[streamIdx];
+	const RPCQrId id = stream.id;
+	// Chunks are pushed with the seq of the kCmdStreamResults call, so the client is able to route them to the awaiting cursor
+	cproto::RPCCall call{cproto::kCmdResultsChunk, stream.seq, {}, milliseconds(0)};
+	auto removeStream = [&data, streamIdx] {
+		std::lock_guard<std::mutex> lck(data.resultsMtx);
+		data.streams.erase(data.streams.begin() + streamIdx);
+	};
+
+	RPCQrWatcher::Ref qres;
+	try {
+		RPCQrId tmpId = id;
+		qres = qrWatcher_.GetQueryResults(tmpId);
+	} catch (Error &e) {
+		// Results were expired by the watcher
+		removeStream();
+		cproto::Context chunkCtx{ctx.clientAddr, &call, ctx.writer, {}, false};
+		chunkCtx.Return({cproto::Arg(std::string()), cproto::Arg(int(id.main)), cproto::Arg(int64_t(id.uid)), cproto::Arg(true)}, e);
+		return;
+	}
+
+	while (stream.credits > 0) {
+		ResultFetchOpts opts{stream.flags, {}, stream.offset, stream.chunkSize};
+		qres.OnFetched(opts);
+		WrResultSerializer rser(ctx.writer->GetDataChunk(), opts);
+		QueryResults &qr = *qres;
+		const SpilledQueryResults *spilled = qres.Spilled();
+		// Stream's flags are the same for each chunk, so the spilled results are always readable by the stream
+		const bool last = spilled ? spilled->PutResults(rser, opts) : rser.PutResults(&qr);
+		const size_t count = spilled ? spilled->Count() : qr.Count();
+		const size_t begin = std::min(size_t(stream.offset), count);
+		const size_t end = std::min(begin + stream.chunkSize, count);
+		// Items are never sent twice, so their payloads are not required after serialization
+		if (!spilled) qr.ReleaseItemsData(begin, end);
+		stream.offset = end;
+		--stream.credits;
+
+		cproto::Context chunkCtx{ctx.clientAddr, &call, ctx.writer, {}, false};
+		if (last) {
+			qres = RPCQrWatcher::Ref();
+			removeStream();
+			freeQueryResults(ctx, id);
+		}
+		chunkCtx.Return(rser.DetachChunk(), {cproto::Arg(int(id.main)), cproto::Arg(int64_t(id.uid)), cproto::Arg(last)});
+		if (last) break;
+	}
+}
+
 Error RPCServer::GetSQLSuggestions(cproto::Context &ctx, p_string query, int pos) {
 	vector<string> suggests;
 	Error err = getDB(ctx, kRoleDataRead).GetSqlSuggestions(query, pos, suggests);
@@ -894,7 +1126,10 @@ Error RPCServer::SubscribeUpdates(cproto::Context &ctx, int flag, cproto::option
 	} else {
 		ret = db.UnsubscribeUpdates(&clientData->pusher);
 	}
-	if (ret.ok()) clientData->subscribed = bool(flag);
+	if (ret.ok()) {
+		clientData->subscribed = bool(flag);
+		ctx.writer->SetUpdatesBatching(flag && opts.IsBatchedUpdates());
+	}
 	return ret;
 }
 
@@ -933,6 +1168,8 @@ bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop) {
 	dispatcher_.Register(cproto::kCmdSelectSQL, this, &RPCServer::SelectSQL);
 	dispatcher_.Register(cproto::kCmdFetchResults, this, &RPCServer::FetchResults, true);
 	dispatcher_.Register(cproto::kCmdCloseResults, this, &RPCServer::CloseResults, true);
+	dispatcher_.Register(cproto::kCmdStreamResults, this, &RPCServer::StreamResults);
+	dispatcher_.Register(cproto::kCmdStreamCredit, this, &RPCServer::StreamCredit);
 
 	dispatcher_.Register(cproto::kCmdGetSQLSuggestions, this, &RPCServer::GetSQLSuggestions);
 
@@ -948,11 +1185,27 @@ bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop) {
 		dispatcher_.Logger(this, &RPCServer::Logger);
 	}
 
+	if (serverConfig_.RPCParallelThreads || serverConfig_.RPCCoroutines) {
+		// Read-only calls of the single connection may be executed at the same time and answered out of order
+		for (auto cmd : {cproto::kCmdPing, cproto::kCmdSelect, cproto::kCmdFetchResults, cproto::kCmdGetSQLSuggestions, cproto::kCmdGetMeta,
+						 cproto::kCmdEnumNamespaces}) {
+			dispatcher_.AllowParallel(cmd);
+		}
+		const size_t threads = serverConfig_.RPCParallelThreads ? serverConfig_.RPCParallelThreads
+																: std::max(std::thread::hardware_concurrency(), 1u);
+		callsExecutor_.reset(new cproto::CallsExecutor(threads));
+		dispatcher_.SetExecutor(callsExecutor_.get());
+		// Calls are suspended, while their queries are executed by the executor, so the loop's thread serves the other connections
+		dispatcher_.EnableCoroutines(serverConfig_.RPCCoroutines);
+	}
+
 	auto factory = cproto::ServerConnection::NewFactory(dispatcher_, serverConfig_.EnableConnectionsStats, serverConfig_.MaxUpdatesSize);
 	if (serverConfig_.RPCThreadingMode == ServerConfig::kDedicatedThreading) {
-		listener_.reset(new ForkedListener(loop, factory));
+		listener_.reset(new ForkedListener(loop, factory, debug::ThreadRole::RPC));
+	} else if (serverConfig_.RPCThreadingMode == ServerConfig::kReusePortThreading && ReusePortListener::IsSupported()) {
+		listener_.reset(new ReusePortListener(factory, 0, debug::ThreadRole::RPC));
 	} else {
-		listener_.reset(new Listener(loop, factory));
+		listener_.reset(new Listener(loop, factory, 0, debug::ThreadRole::RPC));
 	}
 
 	assert(!qrWatcherThread_.joinable());
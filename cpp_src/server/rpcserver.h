@@ -7,7 +7,9 @@
 #include "core/keyvalue/variant.h"
 #include "core/reindexer.h"
 #include "dbmanager.h"
+#include "executionpools.h"
 #include "net/cproto/dispatcher.h"
+#include "resourceaccounts.h"
 #include "net/listener.h"
 #include "rpcqrwatcher.h"
 #include "rpcupdatespusher.h"
@@ -25,11 +27,30 @@ using std::pair;
 using namespace reindexer::net;
 using namespace reindexer;
 
+// Query results, which are pushed to the client by the chunks. Each chunk consumes one credit, granted by the client
+struct RPCResultsStream {
+	RPCQrId id;
+	uint32_t seq;
+	int flags;
+	unsigned offset;
+	unsigned chunkSize;
+	int64_t credits;
+};
+
 struct RPCClientData : public cproto::ClientData {
 	~RPCClientData();
 	h_vector<RPCQrId, 1> results;
+	// Protects results of the parallel selects
+	std::mutex resultsMtx;
+	h_vector<RPCResultsStream, 1> streams;
 	vector<Transaction> txs;
 	std::shared_ptr<TxStats> txStats;
+	// Account of the client's resources, if the accounting is enabled, and the estimated sizes of the results, which are charged to it
+	std::shared_ptr<ResourceAccount> resources;
+	std::unordered_map<int, int64_t> resultsBytes;
+	// Execution pool of the client's heavy operations. Operations are executed by the common executor or by the connection's thread,
+	// if it's not set
+	ExecutionPool *pool = nullptr;
 
 	AuthContext auth;
 	cproto::RPCUpdatesPusher pusher;
@@ -96,9 +117,12 @@ public:
 	Error UpdateQuery(cproto::Context &ctx, p_string query, cproto::optional<int> flags);
 
 	Error Select(cproto::Context &ctx, p_string query, int flags, int limit, p_string ptVersions);
-	Error SelectSQL(cproto::Context &ctx, p_string query, int flags, int limit, p_string ptVersions);
+	Error SelectSQL(cproto::Context &ctx, p_string query, int flags, int limit, p_string ptVersions,
+				   cproto::optional<p_string> paramsPack);
 	Error FetchResults(cproto::Context &ctx, int reqId, int flags, int offset, int limit, cproto::optional<int64_t> qrUID);
 	Error CloseResults(cproto::Context &ctx, int reqId, cproto::optional<int64_t> qrUID);
+	Error StreamResults(cproto::Context &ctx, int reqId, int64_t qrUID, int flags, int offset, int chunkSize, int window);
+	Error StreamCredit(cproto::Context &ctx, int reqId, int64_t qrUID, int credits);
 	Error GetSQLSuggestions(cproto::Context &ctx, p_string query, int pos);
 
 	Error GetMeta(cproto::Context &ctx, p_string ns, p_string key);
@@ -113,7 +137,18 @@ public:
 
 protected:
 	Error sendResults(cproto::Context &ctx, QueryResults &qr, RPCQrId id, const ResultFetchOpts &opts);
+	/// Sends the results of the watcher. Spilled results are sent from the spill
+	Error sendResults(cproto::Context &ctx, RPCQrWatcher::Ref &qres, RPCQrId id, const ResultFetchOpts &opts);
+	void pushResultsChunks(cproto::Context &ctx, RPCClientData &data, size_t streamIdx);
+	bool isStreamed(cproto::Context &ctx, int reqId);
 	Error processTxItem(DataFormat format, std::string_view itemData, Item &item, ItemModifyMode mode, int stateToken) const noexcept;
+	/// Executes the operation via Context::Await by the client's execution pool or by the pool of the namespace. If the resources accounting
+	/// is enabled, the operation is charged to the client's account and is rejected or canceled, when it exceeds the quotas
+	Error execOperation(cproto::Context &ctx, Reindexer &db, std::string_view nsName, bool withResults,
+						const std::function<Error(Reindexer &)> &op);
+	void chargeResults(cproto::Context &ctx, RPCQrId id, const QueryResults &qr);
+	// Must be called under the results mutex
+	void releaseResultsCharge(RPCClientData &data, int qrId);
 
 	RPCQrWatcher::Ref createQueryResults(cproto::Context &ctx, RPCQrId &id);
 	void freeQueryResults(cproto::Context &ctx, RPCQrId id);
@@ -126,6 +161,9 @@ protected:
 
 	DBManager &dbMgr_;
 	cproto::Dispatcher dispatcher_;
+	// Executor of the parallel calls has to outlive the listener's connections
+	std::unique_ptr<cproto::CallsExecutor> callsExecutor_;
+	std::unique_ptr<ExecutionPools> executionPools_;
 	std::unique_ptr<IListener> listener_;
 	const ServerConfig &serverConfig_;
 
@@ -133,6 +171,7 @@ protected:
 	IStatsWatcher *statsWatcher_;
 
 	IClientsStats *clientsStats_;
+	std::unique_ptr<ResourceAccounts> resourceAccounts_;
 
 	std::chrono::system_clock::time_point startTs_;
 	std::thread qrWatcherThread_;
@@ -12,11 +12,17 @@ void RPCUpdatesPusher::OnWALUpdate(LSNPair LSNs, std::string_view nsName, const
 	SharedWALRecord pwalRec;
 	if (filter_) {
 		WALRecord rec = walRec;
-		(void)walRec;  // walRec should not be used after this moment
+		// Packed record of the original walRec may be copied here, so it must not be reused for the filtered record
+		rec.shared_ = SharedWALRecord();
 		if (filter_(rec)) {
 			return;
 		}
-		pwalRec = rec.GetShared(int64_t(LSNs.upstreamLSN_), int64_t(LSNs.originLSN_), nsName);
+		if (rec.inTransaction == walRec.inTransaction) {
+			// Record was not changed by filter, so the packed record is shared with the other subscribers
+			pwalRec = walRec.GetShared(int64_t(LSNs.upstreamLSN_), int64_t(LSNs.originLSN_), nsName);
+		} else {
+			pwalRec = rec.GetShared(int64_t(LSNs.upstreamLSN_), int64_t(LSNs.originLSN_), nsName);
+		}
 	} else {
 		pwalRec = walRec.GetShared(int64_t(LSNs.upstreamLSN_), int64_t(LSNs.originLSN_), nsName);
 	}
@@ -17,6 +17,8 @@ public:
 	void OnWALUpdate(LSNPair LSNs, std::string_view nsName, const WALRecord &walRec) override final;
 	void OnUpdatesLost(std::string_view nsName) override final;
 	void OnConnectionState(const Error &err) override final;
+	/// Filter returns true, if record should be skipped. Filter may only reset inTransaction flag of the record. Unchanged records are packed
+	/// once and shared between all of the subscribers (including relayed updates, which are re-published by the slaves)
 	void SetFilter(std::function<bool(WALRecord &)> filter) { filter_ = std::move(filter); }
 
 protected:
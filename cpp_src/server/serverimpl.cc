@@ -8,9 +8,13 @@
 
 #include "args/args.hpp"
 #include "clientsstats.h"
+#include "core/memaccounting.h"
+#include "core/namespacesloadingscheduler.h"
+#include "core/storage/storagefactory.h"
 #include "dbmanager.h"
 #include "debug/allocdebug.h"
 #include "debug/backtrace.h"
+#include "debug/sampler.h"
 #include "httpserver.h"
 #include "loggerwrapper.h"
 #include "reindexer_version.h"
@@ -249,14 +253,32 @@ int ServerImpl::run() {
 #endif
 	}
 
+	if (config_.SamplingProfilerHz > 0) {
+		auto err = reindexer::debug::CPUSampler::Instance().Start(config_.SamplingProfilerHz);
+		if (!err.ok()) {
+			logger_.warn("Unable to start sampling profiler: {}", err.what());
+		}
+		// Main thread serves the shared HTTP and RPC listeners
+		reindexer::debug::CPUSampler::RegisterThread(reindexer::debug::ThreadRole::Other);
+	}
+	if (config_.MemoryAccounting && !reindexer::MemAccountingScope::Enable()) {
+		logger_.warn("debug.memory_accounting is enabled in config, but tcmalloc hooks are not available - Can't enable feature.");
+	}
+	// Has to be set before the loading of the databases
+	reindexer::hugepages::SetMode(config_.HugePages);
+
 	initCoreLogger();
 	logger_.info("Initializing databases...");
 	std::unique_ptr<ClientsStats> clientsStats;
 	if (config_.EnableConnectionsStats) clientsStats.reset(new ClientsStats());
 	try {
+		reindexer::datastorage::StorageFactory::setRocksDbTuning(config_.RocksDB);
 		dbMgr_.reset(new DBManager(config_.StoragePath, !config_.EnableSecurity, clientsStats.get()));
 
-		auto status = dbMgr_->Init(config_.StorageEngine, config_.StartWithErrors, config_.Autorepair);
+		const size_t nsLoaders = config_.StartupNsLoaders ? config_.StartupNsLoaders : std::thread::hardware_concurrency();
+		reindexer::NamespacesLoadingScheduler::Instance().SetLimit(nsLoaders);
+		auto status =
+			dbMgr_->Init(config_.StorageEngine, config_.StartWithErrors, config_.Autorepair, std::max(config_.StartupDBThreads, size_t(1)));
 		if (!status.ok()) {
 			logger_.error("Error init database manager: {0}", status.what());
 			std::cout << status.what() << std::endl;
@@ -271,7 +293,7 @@ int ServerImpl::run() {
 		std::unique_ptr<StatsCollector> statsCollector;
 		if (config_.EnablePrometheus) {
 			prometheus.reset(new Prometheus);
-			statsCollector.reset(new StatsCollector(prometheus.get(), config_.PrometheusCollectPeriod));
+			statsCollector.reset(new StatsCollector(prometheus.get(), config_.PrometheusCollectPeriod, config_.PrometheusMemstatsPeriod));
 		}
 
 		LoggerWrapper httpLogger("http");
@@ -473,10 +495,17 @@ void ServerImpl::initCoreLogger() {
 			}
 		}
 	};
-	if (coreLogLevel_ && logger.lock()) reindexer::logInstallWriter(callback);
+	// Records of the disabled levels are not even formatted
+	reindexer::logSetMaxLevel(coreLogLevel_);
+	if (coreLogLevel_ && logger.lock()) {
+		reindexer::logInstallWriter(callback);
+		if (config_.AsyncCoreLog) reindexer::logEnableAsync();
+	}
 }
 
 ServerImpl::~ServerImpl() {
+	reindexer::logDisableAsync();
+	reindexer::logSetMaxLevel(LogTrace);
 	if (coreLogLevel_) reindexer::logInstallWriter(nullptr);
 	async_.reset();
 }
@@ -37,7 +37,8 @@ public:
 	void Stop();
 	void EnableHandleSignals(bool enable = true) { enableHandleSignals_ = enable; }
 	DBManager& GetDBManager() { return *dbMgr_; }
-	bool IsReady() const { return storageLoaded_.load(); }
+	// Databases are loaded and the warm states of their previous runs are replayed
+	bool IsReady() const { return storageLoaded_.load() && dbMgr_->IsWarmedUp(); }
 	bool IsRunning() const { return running_.load(); }
 	void ReopenLogFiles();
 
@@ -8,10 +8,42 @@ void Prometheus::Attach(http::Router& router) {
 	using prometheus::BuildGauge;
 	qps_ = &BuildGauge().Name("reindexer_qps_total").Help("Shows queries per second").Register(registry_);
 	latency_ = &BuildGauge().Name("reindexer_avg_latency").Help("Average requests latency (seconds)").Register(registry_);
+	latencyQuantile_ = &BuildGauge()
+							.Name("reindexer_latency_quantile")
+							.Help("Quantiles of requests latency since the last stats reset (seconds)")
+							.Register(registry_);
+	storageFlushSize_ = &prometheus::BuildHistogram()
+							 .Name("reindexer_storage_flush_size_bytes")
+							 .Help("Size of the namespace storage flushes in bytes")
+							 .Register(registry_);
+	storageFlushDuration_ = &prometheus::BuildHistogram()
+								 .Name("reindexer_storage_flush_duration_seconds")
+								 .Help("Duration of the namespace storage flushes (seconds)")
+								 .Register(registry_);
 	caches_ = &BuildGauge().Name("reindexer_caches_size_bytes").Help("Namespace caches size in bytes").Register(registry_);
 	indexes_ = &BuildGauge().Name("reindexer_indexes_size_bytes").Help("Namespace indexes size in bytes").Register(registry_);
 	data_ = &BuildGauge().Name("reindexer_data_size_bytes").Help("Namespace data size in bytes").Register(registry_);
 	itemsCount_ = &BuildGauge().Name("reindexer_items_count").Help("Items count in namespace").Register(registry_);
+	replLag_ = &BuildGauge()
+					.Name("reindexer_replication_lsn_lag")
+					.Help("Count of the master's WAL records, which are not applied by slave yet")
+					.Register(registry_);
+	replQueuedUpdates_ = &BuildGauge()
+							  .Name("reindexer_replication_queued_updates")
+							  .Help("Count of the online replication updates, which are waiting to be applied")
+							  .Register(registry_);
+	replApplyRate_ = &BuildGauge()
+						  .Name("reindexer_replication_applied_records_rate")
+						  .Help("Count of the WAL records, applied by slave during the last second")
+						  .Register(registry_);
+	replRecvRate_ = &BuildGauge()
+						 .Name("reindexer_replication_recv_rate_bytes")
+						 .Help("Size of the replicated data, received by slave during the last second in bytes")
+						 .Register(registry_);
+	replTxApplyTime_ = &BuildGauge()
+							.Name("reindexer_replication_tx_avg_apply_time")
+							.Help("Average time of the replicated transactions apply (seconds)")
+							.Register(registry_);
 	memory_ = &BuildGauge()
 				   .Name("reindexer_memory_allocated_bytes")
 				   .Help("Currently allocated bytes, according to allocator library")
@@ -26,10 +58,24 @@ void Prometheus::Attach(http::Router& router) {
 	router.GET<Prometheus, &Prometheus::collect>("/metrics", this);
 }
 
-void Prometheus::NextEpoch() { registry_.RemoveOutdated(currentEpoch_++ - 1); }
+void Prometheus::NextEpoch() {
+	const int64_t outdatedEpoch = currentEpoch_++ - 1;
+	for (PCollectable* family : std::initializer_list<PCollectable*>{
+			 qps_, latency_, latencyQuantile_, storageFlushSize_, storageFlushDuration_, itemsCount_, memory_, rpcClients_, inputTraffic_,
+			 outputTraffic_, replLag_, replQueuedUpdates_, replApplyRate_, replRecvRate_, replTxApplyTime_, rxInfo_}) {
+		if (family) family->RemoveOutdated(outdatedEpoch);
+	}
+}
+
+void Prometheus::NextMemstatsEpoch() {
+	const int64_t outdatedEpoch = memstatsEpoch_++ - 1;
+	for (PCollectable* family : std::initializer_list<PCollectable*>{caches_, indexes_, data_}) {
+		if (family) family->RemoveOutdated(outdatedEpoch);
+	}
+}
 
 void Prometheus::setMetricValue(PFamily<Prometheus::PGauge>* metricFamily, double value, int64_t epoch, const std::string& db,
-								const std::string& ns, std::string_view queryType) {
+								const std::string& ns, std::string_view queryType, std::string_view quantile) {
 	if (metricFamily) {
 		std::map<std::string, std::string> labels;
 		if (!db.empty()) {
@@ -41,6 +87,9 @@ void Prometheus::setMetricValue(PFamily<Prometheus::PGauge>* metricFamily, doubl
 		if (!queryType.empty()) {
 			labels.emplace("query", std::string(queryType));
 		}
+		if (!quantile.empty()) {
+			labels.emplace("quantile", std::string(quantile));
+		}
 		metricFamily->Add(std::move(labels), epoch).Set(value);
 	}
 }
@@ -58,6 +107,13 @@ void Prometheus::setMetricValue(PFamily<PGauge>* metricFamily, double value, int
 	}
 }
 
+void Prometheus::setHistogramValue(PFamily<PHistogram>* metricFamily, const std::vector<double>& bounds, const std::vector<double>& counts,
+								   double sum, int64_t epoch, const string& db, const string& ns) {
+	if (metricFamily && counts.size() == bounds.size() + 1) {
+		metricFamily->Add({{"db", db}, {"ns", ns}}, epoch, bounds).Set(counts, sum);
+	}
+}
+
 void Prometheus::fillRxInfo() {
 	assertrx(rxInfo_);
 	rxInfo_->Add({{"version", REINDEX_VERSION}}, prometheus::kNoEpoch).Set(1.0);
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <string_view>
 #include "core/namespacedef.h"
 #include "net/http/router.h"
+#include "prometheus/histogram.h"
 #include "prometheus/registry.h"
 #include "prometheus/text_serializer.h"
 
@@ -15,6 +17,7 @@ public:
 	template <typename T>
 	using PFamily = prometheus::Family<T>;
 	using PGauge = prometheus::Gauge;
+	using PHistogram = prometheus::Histogram;
 	using PTextSerializer = prometheus::TextSerializer;
 	using PRegistry = prometheus::Registry;
 	using PCollectable = prometheus::Collectable;
@@ -26,10 +29,37 @@ public:
 	void RegisterLatency(const string &db, const string &ns, std::string_view queryType, size_t latencyUS) {
 		setMetricValue(latency_, static_cast<double>(latencyUS) / 1e6, currentEpoch_, db, ns, queryType);
 	}
-	void RegisterCachesSize(const string &db, const string &ns, size_t size) { setMetricValue(caches_, size, currentEpoch_, db, ns); }
-	void RegisterIndexesSize(const string &db, const string &ns, size_t size) { setMetricValue(indexes_, size, currentEpoch_, db, ns); }
-	void RegisterDataSize(const string &db, const string &ns, size_t size) { setMetricValue(data_, size, currentEpoch_, db, ns); }
+	void RegisterLatencyQuantile(const string &db, const string &ns, std::string_view queryType, std::string_view quantile,
+								 size_t latencyUS) {
+		setMetricValue(latencyQuantile_, static_cast<double>(latencyUS) / 1e6, currentEpoch_, db, ns, queryType, quantile);
+	}
+	void RegisterStorageFlushSize(const string &db, const string &ns, const std::vector<double> &bounds, const std::vector<double> &counts,
+								  double sum) {
+		setHistogramValue(storageFlushSize_, bounds, counts, sum, currentEpoch_, db, ns);
+	}
+	void RegisterStorageFlushDuration(const string &db, const string &ns, const std::vector<double> &boundsUS,
+									  const std::vector<double> &counts, double sumUS) {
+		std::vector<double> bounds(boundsUS.size());
+		std::transform(boundsUS.begin(), boundsUS.end(), bounds.begin(), [](double us) { return us / 1e6; });
+		setHistogramValue(storageFlushDuration_, bounds, counts, sumUS / 1e6, currentEpoch_, db, ns);
+	}
+	void RegisterCachesSize(const string &db, const string &ns, size_t size) { setMetricValue(caches_, size, memstatsEpoch_, db, ns); }
+	void RegisterIndexesSize(const string &db, const string &ns, size_t size) { setMetricValue(indexes_, size, memstatsEpoch_, db, ns); }
+	void RegisterDataSize(const string &db, const string &ns, size_t size) { setMetricValue(data_, size, memstatsEpoch_, db, ns); }
 	void RegisterItemsCount(const string &db, const string &ns, size_t count) { setMetricValue(itemsCount_, count, currentEpoch_, db, ns); }
+	void RegisterReplicationLag(const string &db, const string &ns, int64_t lag) { setMetricValue(replLag_, lag, currentEpoch_, db, ns); }
+	void RegisterReplicationQueuedUpdates(const string &db, const string &ns, size_t count) {
+		setMetricValue(replQueuedUpdates_, count, currentEpoch_, db, ns);
+	}
+	void RegisterReplicationApplyRate(const string &db, const string &ns, size_t recordsPerSec) {
+		setMetricValue(replApplyRate_, recordsPerSec, currentEpoch_, db, ns);
+	}
+	void RegisterReplicationRecvRate(const string &db, const string &ns, size_t bytesPerSec) {
+		setMetricValue(replRecvRate_, bytesPerSec, currentEpoch_, db, ns);
+	}
+	void RegisterReplicationTxApplyTime(const string &db, const string &ns, size_t avgTimeUS) {
+		setMetricValue(replTxApplyTime_, static_cast<double>(avgTimeUS) / 1e6, currentEpoch_, db, ns);
+	}
 	void RegisterAllocatedMemory(size_t memoryConsumationBytes) { setMetricValue(memory_, memoryConsumationBytes, prometheus::kNoEpoch); }
 	void RegisterRPCClients(const string &db, size_t count) { setMetricValue(rpcClients_, count, currentEpoch_, db); }
 	void RegisterInputTraffic(const string &db, std::string_view type, size_t bytes) {
@@ -40,18 +70,26 @@ public:
 	}
 
 	void NextEpoch();
+	/// Memory stats are collected with the own period, so they are outdated separately from the other per-namespace metrics
+	void NextMemstatsEpoch();
 
 private:
 	static void setMetricValue(PFamily<PGauge> *metricFamily, double value, int64_t epoch, const string &db = "", const string &ns = "",
-							   std::string_view queryType = "");
+							   std::string_view queryType = "", std::string_view quantile = "");
 	static void setMetricValue(PFamily<PGauge> *metricFamily, double value, int64_t epoch, const string &db, std::string_view type);
+	static void setHistogramValue(PFamily<PHistogram> *metricFamily, const std::vector<double> &bounds, const std::vector<double> &counts,
+								  double sum, int64_t epoch, const string &db, const string &ns);
 	void fillRxInfo();
 	int collect(http::Context &ctx);
 
 	PRegistry registry_;
 	int64_t currentEpoch_ = 1;
+	int64_t memstatsEpoch_ = 1;
 	PFamily<PGauge> *qps_{nullptr};
 	PFamily<PGauge> *latency_{nullptr};
+	PFamily<PGauge> *latencyQuantile_{nullptr};
+	PFamily<PHistogram> *storageFlushSize_{nullptr};
+	PFamily<PHistogram> *storageFlushDuration_{nullptr};
 	PFamily<PGauge> *caches_{nullptr};
 	PFamily<PGauge> *indexes_{nullptr};
 	PFamily<PGauge> *data_{nullptr};
@@ -60,6 +98,11 @@ private:
 	PFamily<PGauge> *inputTraffic_{nullptr};
 	PFamily<PGauge> *outputTraffic_{nullptr};
 	PFamily<PGauge> *itemsCount_{nullptr};
+	PFamily<PGauge> *replLag_{nullptr};
+	PFamily<PGauge> *replQueuedUpdates_{nullptr};
+	PFamily<PGauge> *replApplyRate_{nullptr};
+	PFamily<PGauge> *replRecvRate_{nullptr};
+	PFamily<PGauge> *replTxApplyTime_{nullptr};
 	PFamily<PGauge> *rxInfo_{nullptr};
 };
 
@@ -1,4 +1,5 @@
 #include "statscollector.h"
+#include "core/namespace/namespacestat.h"
 #include "dbmanager.h"
 #include "prometheus.h"
 #include "tools/alloc_ext/je_malloc_extension.h"
@@ -18,8 +19,9 @@ void StatsCollector::Start(DBManager& dbMngr) {
 			while (!terminate_.load(std::memory_order_acquire)) {
 				std::this_thread::sleep_for(kSleepTime);
 				now += kSleepTime;
-				if (now.count() % collectPeriod_.count() == 0) {
-					this->collectStats(dbMngr);
+				const bool withMemstats = memstatsPeriod_.count() > 0 && now.count() % memstatsPeriod_.count() == 0;
+				if (withMemstats || now.count() % collectPeriod_.count() == 0) {
+					this->collectStats(dbMngr, withMemstats);
 				}
 			}
 		});
@@ -63,10 +65,10 @@ void StatsCollector::OnClientDisconnected(const std::string& db, std::string_vie
 	}
 }
 
-void StatsCollector::collectStats(DBManager& dbMngr) {
+void StatsCollector::collectStats(DBManager& dbMngr, bool withMemstats) {
 	using namespace std::string_view_literals;
 	auto dbNames = dbMngr.EnumDatabases();
-	NSMap collectedDBs;
+	std::vector<reindexer::NamespaceMetrics> metrics;
 	for (auto& dbName : dbNames) {
 		auto ctx = MakeSystemAuthContext();
 		auto status = dbMngr.OpenDatabase(dbName, ctx, false);
@@ -80,42 +82,66 @@ void StatsCollector::collectStats(DBManager& dbMngr) {
 		assertrx(db);
 		(void)status;
 
-		{
-			vector<NamespaceDef> nsDefs;
-			status = db->EnumNamespaces(nsDefs, EnumNamespacesOpts().OnlyNames().WithClosed());
-			if (!status.ok()) {
-				collectedDBs.emplace(dbName, vector<NamespaceDef>());
-				continue;
+		// Counters of the namespaces are read directly, so the namespaces are not locked and #perfstats is not refilled
+		metrics.clear();
+		status = db->GetNamespacesMetrics(metrics);
+		if (status.ok()) {
+			for (const auto& m : metrics) {
+				prometheus_->RegisterItemsCount(dbName, m.name, m.itemsCount);
+				if (!m.perfStats) continue;
+				constexpr auto kSelectQueryType = "select"sv;
+				constexpr auto kUpdateQueryType = "update"sv;
+				prometheus_->RegisterQPS(dbName, m.name, kSelectQueryType, m.selects.avgHitCount);
+				prometheus_->RegisterQPS(dbName, m.name, kUpdateQueryType, m.updates.avgHitCount);
+				prometheus_->RegisterLatency(dbName, m.name, kSelectQueryType, m.selects.avgTimeUs);
+				prometheus_->RegisterLatency(dbName, m.name, kUpdateQueryType, m.updates.avgTimeUs);
+				struct {
+					std::string_view quantile;
+					size_t reindexer::PerfStat::*value;
+				} constexpr kLatencyQuantiles[] = {{"0.5"sv, &reindexer::PerfStat::p50TimeUs},
+												   {"0.9"sv, &reindexer::PerfStat::p90TimeUs},
+												   {"0.99"sv, &reindexer::PerfStat::p99TimeUs},
+												   {"0.999"sv, &reindexer::PerfStat::p999TimeUs}};
+				for (const auto& q : kLatencyQuantiles) {
+					prometheus_->RegisterLatencyQuantile(dbName, m.name, kSelectQueryType, q.quantile, m.selects.*q.value);
+					prometheus_->RegisterLatencyQuantile(dbName, m.name, kUpdateQueryType, q.quantile, m.updates.*q.value);
+				}
+				auto asDoubles = [](const std::vector<uint64_t>& values) { return std::vector<double>(values.begin(), values.end()); };
+				const auto& flushes = m.storageFlushes;
+				prometheus_->RegisterStorageFlushSize(dbName, m.name, asDoubles(flushes.sizeBytes.bounds),
+													  asDoubles(flushes.sizeBytes.counts), flushes.sizeBytes.sum);
+				prometheus_->RegisterStorageFlushDuration(dbName, m.name, asDoubles(flushes.durationUs.bounds),
+														  asDoubles(flushes.durationUs.counts), flushes.durationUs.sum);
 			}
-			collectedDBs.emplace(dbName, std::move(nsDefs));
 		}
 
-		constexpr static auto kPerfstatsNs = "#perfstats"sv;
 		constexpr static auto kMemstatsNs = "#memstats"sv;
+		constexpr static auto kReplicationstatsNs = "#replicationstats"sv;
 		QueryResults qr;
-		status = db->Select(Query(string(kPerfstatsNs)), qr);
-		if (status.ok() && qr.Count()) {
-			for (auto it = qr.begin(); it != qr.end(); ++it) {
-				auto item = it.GetItem(false);
-				std::string nsName = item["name"].As<std::string>();
-				constexpr auto kSelectQueryType = "select"sv;
-				constexpr auto kUpdateQueryType = "update"sv;
-				prometheus_->RegisterQPS(dbName, nsName, kSelectQueryType, item["selects.last_sec_qps"].As<int64_t>());
-				prometheus_->RegisterQPS(dbName, nsName, kUpdateQueryType, item["updates.last_sec_qps"].As<int64_t>());
-				prometheus_->RegisterLatency(dbName, nsName, kSelectQueryType, item["selects.last_sec_avg_latency_us"].As<int64_t>());
-				prometheus_->RegisterLatency(dbName, nsName, kUpdateQueryType, item["updates.last_sec_avg_latency_us"].As<int64_t>());
+		if (withMemstats) {
+			status = db->Select(Query(string(kMemstatsNs)), qr);
+			if (status.ok() && qr.Count()) {
+				for (auto it = qr.begin(); it != qr.end(); ++it) {
+					auto item = it.GetItem(false);
+					auto nsName = item["name"].As<std::string>();
+					prometheus_->RegisterCachesSize(dbName, nsName, item["total.cache_size"].As<int64_t>());
+					prometheus_->RegisterIndexesSize(dbName, nsName, item["total.indexes_size"].As<int64_t>());
+					prometheus_->RegisterDataSize(dbName, nsName, item["total.data_size"].As<int64_t>());
+				}
 			}
 		}
 		qr.Clear();
-		status = db->Select(Query(string(kMemstatsNs)), qr);
+		status = db->Select(Query(string(kReplicationstatsNs)), qr);
 		if (status.ok() && qr.Count()) {
 			for (auto it = qr.begin(); it != qr.end(); ++it) {
 				auto item = it.GetItem(false);
 				auto nsName = item["name"].As<std::string>();
-				prometheus_->RegisterCachesSize(dbName, nsName, item["total.cache_size"].As<int64_t>());
-				prometheus_->RegisterIndexesSize(dbName, nsName, item["total.indexes_size"].As<int64_t>());
-				prometheus_->RegisterDataSize(dbName, nsName, item["total.data_size"].As<int64_t>());
-				prometheus_->RegisterItemsCount(dbName, nsName, item["items_count"].As<int64_t>());
+				prometheus_->RegisterReplicationLag(dbName, nsName, item["lsn_lag"].As<int64_t>());
+				prometheus_->RegisterReplicationQueuedUpdates(
+					dbName, nsName, item["pended_updates"].As<int64_t>() + item["queued_updates"].As<int64_t>());
+				prometheus_->RegisterReplicationApplyRate(dbName, nsName, item["applied_records_rate"].As<int64_t>());
+				prometheus_->RegisterReplicationRecvRate(dbName, nsName, item["recv_rate"].As<int64_t>());
+				prometheus_->RegisterReplicationTxApplyTime(dbName, nsName, item["tx_avg_apply_time_us"].As<int64_t>());
 			}
 		}
 	}
@@ -149,6 +175,7 @@ void StatsCollector::collectStats(DBManager& dbMngr) {
 	}
 
 	prometheus_->NextEpoch();
+	if (withMemstats) prometheus_->NextMemstatsEpoch();
 }
 
 StatsCollector::DBCounters& StatsCollector::getCounters(const std::string& db, std::string_view source) {
@@ -4,8 +4,6 @@
 #include <mutex>
 #include <thread>
 #include <unordered_map>
-#include "core/namespacedef.h"
-#include "estl/fast_hash_map.h"
 #include "istatswatcher.h"
 #include "tools/stringstools.h"
 
@@ -16,8 +14,8 @@ class Prometheus;
 
 class StatsCollector : public IStatsWatcher {
 public:
-	StatsCollector(Prometheus* prometheus, std::chrono::milliseconds collectPeriod)
-		: prometheus_(prometheus), terminate_(false), enabled_(false), collectPeriod_(collectPeriod) {}
+	StatsCollector(Prometheus* prometheus, std::chrono::milliseconds collectPeriod, std::chrono::milliseconds memstatsPeriod)
+		: prometheus_(prometheus), terminate_(false), enabled_(false), collectPeriod_(collectPeriod), memstatsPeriod_(memstatsPeriod) {}
 	~StatsCollector() override { Stop(); }
 	void Start(DBManager& dbMngr);
 	void Stop();
@@ -28,7 +26,6 @@ public:
 	void OnClientDisconnected(const std::string& db, std::string_view source) noexcept override final;
 
 private:
-	using NSMap = reindexer::fast_hash_map<std::string, std::vector<reindexer::NamespaceDef>>;
 	struct DBCounters {
 		size_t clients{0};
 		uint64_t inputTraffic{0};
@@ -37,7 +34,7 @@ private:
 	using CountersByDB = std::unordered_map<std::string, DBCounters, reindexer::nocase_hash_str, reindexer::nocase_equal_str>;
 	using Counters = std::vector<std::pair<std::string, CountersByDB>>;
 
-	void collectStats(DBManager& dbMngr);
+	void collectStats(DBManager& dbMngr, bool withMemstats);
 	DBCounters& getCounters(const std::string& db, std::string_view source);
 
 	Prometheus* prometheus_;
@@ -45,6 +42,7 @@ private:
 	std::atomic<bool> terminate_;
 	std::atomic<bool> enabled_;
 	std::chrono::milliseconds collectPeriod_;
+	std::chrono::milliseconds memstatsPeriod_;
 	Counters counters_;
 	std::mutex mtx_;
 };
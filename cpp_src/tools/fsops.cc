@@ -40,6 +40,24 @@ int RmDirAll(const string &path) {
 #endif
 }
 
+int64_t DirSize(const string &path) {
+#ifndef _WIN32
+	static thread_local int64_t size;
+	size = 0;
+	const int ret = nftw(
+		path.c_str(),
+		[](const char *, const struct stat *st, int type, struct FTW *) {
+			if (type == FTW_F) size += st->st_size;
+			return 0;
+		},
+		64, FTW_PHYS);
+	return ret < 0 ? -1 : size;
+#else
+	(void)path;
+	return 0;
+#endif
+}
+
 int ReadFile(const string &path, string &content) {
 	FILE *f = fopen(path.c_str(), "rb");
 	if (!f) {
@@ -29,6 +29,8 @@ struct TimeStats {
 
 int MkDirAll(const string &path);
 int RmDirAll(const string &path);
+/// @return Total size of the files in the directory and its subdirectories or -1 on error
+int64_t DirSize(const string &path);
 int ReadFile(const string &path, string &content);
 int64_t WriteFile(const string &path, std::string_view content);
 int ReadDir(const string &path, vector<DirEntry> &content);
@@ -0,0 +1,107 @@
+#include "hugepages.h"
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace reindexer {
+namespace hugepages {
+
+static std::atomic<Mode> mode{Mode::Off};
+static std::atomic<size_t> mappedBytes{0};
+// Regions, which were mapped by Allocate. Deallocate can't rely on the current mode, because it may be changed after the allocation.
+// Large allocations are rare, so the single mutex is fine
+static std::mutex regionsMtx;
+static std::unordered_set<void *> regions;
+
+void SetMode(Mode m) noexcept { mode.store(m, std::memory_order_relaxed); }
+Mode GetMode() noexcept { return mode.load(std::memory_order_relaxed); }
+
+#ifdef __linux__
+constexpr size_t kHugePageSize = size_t(2) << 20;
+
+static void *mapRegion(size_t bytes, Mode m) noexcept {
+	const size_t len = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+	void *ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+	if (m == Mode::Explicit) {
+		ptr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	}
+#endif
+	if (ptr == MAP_FAILED) {
+		ptr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (ptr == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+		// Regular pages are used, if THP is disabled by the system
+		madvise(ptr, len, MADV_HUGEPAGE);
+#endif
+	}
+	return ptr;
+}
+#endif
+
+void *Allocate(size_t bytes) {
+#ifdef __linux__
+	const Mode m = GetMode();
+	if (m != Mode::Off && bytes >= kMinAllocationSize) {
+		if (void *ptr = mapRegion(bytes, m)) {
+			{
+				std::lock_guard<std::mutex> lck(regionsMtx);
+				regions.insert(ptr);
+			}
+			mappedBytes.fetch_add(bytes, std::memory_order_relaxed);
+			return ptr;
+		}
+	}
+#endif
+	return ::operator new(bytes);
+}
+
+void Deallocate(void *ptr, size_t bytes) noexcept {
+	if (!ptr) return;
+#ifdef __linux__
+	if (bytes >= kMinAllocationSize) {
+		bool mapped = false;
+		{
+			std::lock_guard<std::mutex> lck(regionsMtx);
+			mapped = regions.erase(ptr);
+		}
+		if (mapped) {
+			munmap(ptr, (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1));
+			mappedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+			return;
+		}
+	}
+#endif
+	::operator delete(ptr);
+}
+
+size_t MappedBytes() noexcept { return mappedBytes.load(std::memory_order_relaxed); }
+
+size_t ResidentBytes() {
+#ifdef __linux__
+	constexpr std::string_view kKey = "AnonHugePages:";
+	std::ifstream f("/proc/self/smaps_rollup");
+	std::string line;
+	while (std::getline(f, line)) {
+		if (std::string_view(line).substr(0, kKey.size()) == kKey) {
+			try {
+				// Value is in kB
+				return std::stoull(line.substr(kKey.size())) * 1024;
+			} catch (...) {
+				return 0;
+			}
+		}
+	}
+#endif
+	return 0;
+}
+
+}  // namespace hugepages
+}  // namespace reindexer
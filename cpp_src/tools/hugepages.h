@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace reindexer {
+namespace hugepages {
+
+enum class Mode {
+	Off,
+	// Transparent huge pages for the regions of the large allocations, i.e. madvise(MADV_HUGEPAGE)
+	Madvise,
+	// Explicit huge pages from the preallocated pool (MAP_HUGETLB). Falls back to Madvise, when the pool is exhausted
+	Explicit,
+};
+
+/// Allocations, which are smaller than this size, are always served by the regular heap
+constexpr size_t kMinAllocationSize = size_t(2) << 20;
+
+/// Sets the mode of the large allocations. Previously allocated regions are not changed
+void SetMode(Mode mode) noexcept;
+Mode GetMode() noexcept;
+/// Allocates the memory for the large structure. If the mode is not Off and the size is not less than kMinAllocationSize, the memory
+/// is mapped separately and is backed by the huge pages, when they are available. Otherwise the regular heap is used
+void *Allocate(size_t bytes);
+/// Releases the memory of the Allocate call with the same size
+void Deallocate(void *ptr, size_t bytes) noexcept;
+/// Total size of the regions, which are currently mapped by Allocate
+size_t MappedBytes() noexcept;
+/// Size of the process' anonymous memory, which is actually backed by the huge pages (AnonHugePages of /proc/self/smaps_rollup)
+/// @return 0, if it's not available on this platform
+size_t ResidentBytes();
+
+}  // namespace hugepages
+
+/// Allocator of the large contiguous containers, which may be backed by the huge pages
+template <typename T>
+class HugePageAllocator {
+public:
+	using value_type = T;
+
+	HugePageAllocator() noexcept = default;
+	template <typename U>
+	HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+	T *allocate(size_t n) { return static_cast<T *>(hugepages::Allocate(n * sizeof(T))); }
+	void deallocate(T *p, size_t n) noexcept { hugepages::Deallocate(p, n * sizeof(T)); }
+
+	template <typename U>
+	bool operator==(const HugePageAllocator<U> &) const noexcept {
+		return true;
+	}
+	template <typename U>
+	bool operator!=(const HugePageAllocator<U> &) const noexcept {
+		return false;
+	}
+};
+
+}  // namespace reindexer
@@ -1,19 +1,28 @@
 #include "tools/logger.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "estl/shared_mutex.h"
 #include "estl/smart_lock.h"
+#include "core/type_consts.h"
 
 namespace reindexer {
 
 LogWriter g_logWriter;
 shared_timed_mutex g_LoggerLock;
 std::atomic_bool g_MtLogger = {true};
+static std::atomic<int> g_MaxLogLevel = {LogTrace};
 
 void write(int level, char *buf) {
 	if (!g_logWriter) return;
 	g_logWriter(level, buf);
 }
 
-void logPrint(int level, char *buf) {
+static void writeLocked(int level, char *buf) {
 	if (g_MtLogger) {
 		smart_lock<shared_timed_mutex> lk(g_LoggerLock, false);
 		write(level, buf);
@@ -22,6 +31,143 @@ void logPrint(int level, char *buf) {
 	}
 }
 
+// Single producer single consumer ring buffer of the thread's records
+class LogRing {
+public:
+	explicit LogRing(size_t size) : records_(size) {}
+
+	bool Push(int level, std::string &&msg) noexcept {
+		const size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) == records_.size()) return false;
+		auto &rec = records_[tail % records_.size()];
+		rec.level = level;
+		rec.msg = std::move(msg);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+	template <typename F>
+	void Drain(F &&f) {
+		size_t head = head_.load(std::memory_order_relaxed);
+		const size_t tail = tail_.load(std::memory_order_acquire);
+		for (; head != tail; ++head) {
+			auto &rec = records_[head % records_.size()];
+			const int level = rec.level;
+			std::string msg = std::move(rec.msg);
+			head_.store(head + 1, std::memory_order_release);
+			f(level, msg);
+		}
+	}
+	bool Empty() const noexcept { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+	// Thread of the ring is finished, so it may be removed after the draining
+	std::atomic<bool> orphaned{false};
+
+private:
+	struct Record {
+		int level = LogNone;
+		std::string msg;
+	};
+
+	std::vector<Record> records_;
+	alignas(64) std::atomic<size_t> head_{0};
+	alignas(64) std::atomic<size_t> tail_{0};
+};
+
+class AsyncLogger {
+public:
+	static AsyncLogger &Instance() {
+		static AsyncLogger logger;
+		return logger;
+	}
+	~AsyncLogger() { Stop(); }
+
+	void Start(size_t ringSize) {
+		std::lock_guard<std::mutex> lck(mtx_);
+		ringSize_ = std::max(ringSize, size_t(1));
+		if (thread_.joinable()) return;
+		terminate_ = false;
+		thread_ = std::thread([this] { drainLoop(); });
+		enabled_.store(true, std::memory_order_release);
+	}
+	void Stop() {
+		{
+			std::lock_guard<std::mutex> lck(mtx_);
+			if (!thread_.joinable()) return;
+			enabled_.store(false, std::memory_order_release);
+			terminate_ = true;
+		}
+		cond_.notify_all();
+		thread_.join();
+		thread_ = std::thread();
+	}
+	bool Enabled() const noexcept { return enabled_.load(std::memory_order_acquire); }
+	bool Push(int level, std::string &&msg) {
+		if (!Enabled()) return false;
+		if (!threadRing_) {
+			threadRing_ = std::make_shared<RingHolder>(*this);
+		}
+		if (!threadRing_->ring->Push(level, std::move(msg))) {
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+		}
+		return true;
+	}
+	size_t Dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr auto kDrainPeriod = std::chrono::milliseconds(5);
+
+	// Owned by the thread local storage, so the ring of the finished thread is marked as orphaned
+	struct RingHolder {
+		explicit RingHolder(AsyncLogger &owner) : ring(std::make_shared<LogRing>(owner.ringSize_)) {
+			std::lock_guard<std::mutex> lck(owner.mtx_);
+			owner.rings_.emplace_back(ring);
+		}
+		~RingHolder() { ring->orphaned.store(true, std::memory_order_release); }
+
+		std::shared_ptr<LogRing> ring;
+	};
+
+	void drainLoop() {
+		std::unique_lock<std::mutex> lck(mtx_);
+		for (;;) {
+			const bool terminate = terminate_;
+			auto rings = rings_;
+			lck.unlock();
+			for (auto &ring : rings) {
+				ring->Drain([](int level, std::string &msg) { writeLocked(level, &msg[0]); });
+			}
+			lck.lock();
+			rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+										[](const std::shared_ptr<LogRing> &r) { return r->orphaned.load() && r->Empty(); }),
+						 rings_.end());
+			if (terminate) return;
+			cond_.wait_for(lck, kDrainPeriod, [this] { return terminate_; });
+		}
+	}
+
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	std::thread thread_;
+	std::vector<std::shared_ptr<LogRing>> rings_;
+	size_t ringSize_ = kDefaultAsyncLogRingSize;
+	bool terminate_ = false;
+	std::atomic<bool> enabled_{false};
+	std::atomic<size_t> dropped_{0};
+	static thread_local std::shared_ptr<RingHolder> threadRing_;
+};
+
+thread_local std::shared_ptr<AsyncLogger::RingHolder> AsyncLogger::threadRing_;
+
+void logPrint(int level, char *buf) {
+	auto &async = AsyncLogger::Instance();
+	if (async.Enabled() && async.Push(level, std::string(buf))) return;
+	writeLocked(level, buf);
+}
+
+bool logLevelEnabled(int level) noexcept { return level <= g_MaxLogLevel.load(std::memory_order_relaxed); }
+
+void logSetMaxLevel(int level) noexcept { g_MaxLogLevel.store(level, std::memory_order_relaxed); }
+
 void logInstallWriter(LogWriter writer, bool multithreaded) {
 	if (g_MtLogger || multithreaded) {
 		smart_lock<shared_timed_mutex> lk(g_LoggerLock, true);
@@ -33,4 +179,10 @@ void logInstallWriter(LogWriter writer, bool multithreaded) {
 	}
 }
 
+void logEnableAsync(size_t ringSize) { AsyncLogger::Instance().Start(ringSize); }
+
+void logDisableAsync() { AsyncLogger::Instance().Stop(); }
+
+size_t logDroppedRecords() noexcept { return AsyncLogger::Instance().Dropped(); }
+
 }  // namespace reindexer
@@ -9,12 +9,27 @@ typedef std::function<void(int level, char *msg)> LogWriter;
 namespace reindexer {
 
 void logPrint(int level, char *buf);
+/// Records with the greater level are skipped without formatting
+bool logLevelEnabled(int level) noexcept;
 template <typename... Args>
 void logPrintf(int level, const char *fmt, const Args &... args) {
+	if (!logLevelEnabled(level)) return;
 	auto str = fmt::sprintf(fmt, args...);
 	logPrint(level, &str[0]);
 }
 
 void logInstallWriter(LogWriter writer, bool multithreaded = true);
+/// Sets the max level of the records, which are passed to the writer. All of the records are passed by default
+void logSetMaxLevel(int level) noexcept;
+
+constexpr size_t kDefaultAsyncLogRingSize = 4096;
+/// Enables asynchronous logging: formatted records are pushed into the ring buffer of the calling thread without locks and are passed
+/// to the writer by the background thread. Records are dropped, when the ring buffer of the thread is full, so the logging never
+/// blocks the caller
+void logEnableAsync(size_t ringSize = kDefaultAsyncLogRingSize);
+/// Writes the queued records and stops the background thread
+void logDisableAsync();
+/// Count of the records, which were dropped due to the full ring buffers
+size_t logDroppedRecords() noexcept;
 
 }  // namespace reindexer
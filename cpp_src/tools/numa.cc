@@ -0,0 +1,75 @@
+#include "numa.h"
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace reindexer {
+namespace numa {
+
+std::vector<int> NodeCPUs(int node) {
+	std::vector<int> cpus;
+#ifdef __linux__
+	if (node < 0) return cpus;
+	// List of the CPUs ranges, i.e. "0-7,16-23"
+	std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+	std::string list;
+	if (!std::getline(f, list)) return cpus;
+	size_t pos = 0;
+	while (pos < list.size()) {
+		size_t end = list.find(',', pos);
+		if (end == std::string::npos) end = list.size();
+		const std::string range = list.substr(pos, end - pos);
+		const size_t dash = range.find('-');
+		try {
+			const int first = std::stoi(range.substr(0, dash));
+			const int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+			for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+		} catch (...) {
+			return {};
+		}
+		pos = end + 1;
+	}
+#else
+	(void)node;
+#endif
+	return cpus;
+}
+
+bool PinCurrentThread(const std::vector<int> &cpus) {
+#ifdef __linux__
+	if (cpus.empty()) return false;
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	for (int cpu : cpus) {
+		if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &cpuset);
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#else
+	(void)cpus;
+	return false;
+#endif
+}
+
+bool PreferNodeMemory(int node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+	// The same value as MPOL_PREFERRED of <numaif.h>, so there is no dependency on libnuma
+	constexpr int kMPolPreferred = 1;
+	constexpr int kMaxNode = sizeof(unsigned long) * 8;
+	// Kernel uses maxnode - 1 bits of the mask
+	if (node < 0 || node >= kMaxNode - 1) return false;
+	const unsigned long nodemask = 1UL << node;
+	return syscall(SYS_set_mempolicy, kMPolPreferred, &nodemask, kMaxNode) == 0;
+#else
+	(void)node;
+	return false;
+#endif
+}
+
+}  // namespace numa
+}  // namespace reindexer
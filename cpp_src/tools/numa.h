@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+namespace reindexer {
+namespace numa {
+
+/// CPUs of the NUMA node
+/// @return empty vector, if the node does not exist or NUMA topology is not available on this platform
+std::vector<int> NodeCPUs(int node);
+/// Pins the calling thread to the CPUs
+/// @return false, if the affinity can not be set
+bool PinCurrentThread(const std::vector<int> &cpus);
+/// Makes the node preferred for the memory allocations of the calling thread. Memory is still allocated on the other nodes,
+/// when the preferred one is out of memory
+/// @return false, if the memory policy can not be set
+bool PreferNodeMemory(int node);
+
+}  // namespace numa
+}  // namespace reindexer
@@ -88,25 +88,29 @@ double Serializer::GetDouble() {
 	return ret;
 }
 
-int64_t Serializer::GetVarint() {
+uint64_t Serializer::getVarUint() {
 	int l = scan_varint(len - pos, buf + pos);
 	if (l == 0) {
 		throw Error(errParseBin, "Binary buffer broken - scan_varint failed: pos=%d,len=%d", pos, len);
 	}
-
 	checkbound(pos, l, len);
 	pos += l;
-	return unzigzag64(parse_uint64(l, buf + pos - l));
+	return parse_uint64(l, buf + pos - l);
 }
 
-uint64_t Serializer::GetVarUint() {
-	int l = scan_varint(len - pos, buf + pos);
+void Serializer::GetVarUints(span<uint64_t> values) {
+	if (values.empty()) return;
+	const size_t l = parse_uint64_batch(len - pos, buf + pos, values.data(), values.size());
 	if (l == 0) {
-		throw Error(errParseBin, "Binary buffer broken - scan_varint failed: pos=%d,len=%d", pos, len);
+		throw Error(errParseBin, "Binary buffer broken - parse_uint64_batch failed: pos=%d,len=%d,count=%d", pos, len, values.size());
 	}
-	checkbound(pos, l, len);
 	pos += l;
-	return parse_uint64(l, buf + pos - l);
+}
+
+void Serializer::GetVarints(span<int64_t> values) {
+	static_assert(sizeof(int64_t) == sizeof(uint64_t), "Values are unzigzagged in place");
+	GetVarUints(span<uint64_t>(reinterpret_cast<uint64_t *>(values.data()), values.size()));
+	for (auto &v : values) v = unzigzag64(uint64_t(v));
 }
 
 std::string_view Serializer::GetVString() {
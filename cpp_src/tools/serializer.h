@@ -3,6 +3,7 @@
 #include <functional>
 #include <string_view>
 #include "core/keyvalue/variant.h"
+#include "estl/span.h"
 #include "tools/varint.h"
 
 char *i32toa(int32_t value, char *buffer);
@@ -28,8 +29,15 @@ public:
 	uint64_t GetUInt64();
 	double GetDouble();
 
-	int64_t GetVarint();
-	uint64_t GetVarUint();
+	int64_t GetVarint() { return unzigzag64(GetVarUint()); }
+	uint64_t GetVarUint() {
+		// Most of the tags and lengths take the single byte
+		if (pos < len && buf[pos] < 0x80) return buf[pos++];
+		return getVarUint();
+	}
+	/// Reads the consecutive varints, e.g. the values of the CJSON array of integers, in one pass
+	void GetVarUints(span<uint64_t> values);
+	void GetVarints(span<int64_t> values);
 	std::string_view GetVString();
 	p_string GetPVString();
 	p_string GetPSlice();
@@ -40,6 +48,8 @@ public:
 	size_t Len() const { return len; }
 
 protected:
+	uint64_t getVarUint();
+
 	const uint8_t *buf;
 	size_t len;
 	size_t pos;
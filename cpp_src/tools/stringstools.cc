@@ -281,6 +281,9 @@ int collateCompare(std::string_view lhs, std::string_view rhs, const CollateOpts
 			if (chl > chr) return 1;
 			if (chl < chr) return -1;
 		}
+		// String, which is the prefix of the other one by characters, is less, even if its lowercase form is longer
+		const bool lhsLeft = itl < lhs.data() + lhs.size(), rhsLeft = itr < rhs.data() + rhs.size();
+		if (lhsLeft != rhsLeft) return lhsLeft ? 1 : -1;
 
 		if (lhs.size() > rhs.size()) {
 			return 1;
@@ -319,6 +322,8 @@ int collateCompare(std::string_view lhs, std::string_view rhs, const CollateOpts
 			if (chlPriority > chrPriority) return 1;
 			if (chlPriority < chrPriority) return -1;
 		}
+		const bool lhsLeft = itl < lhs.data() + lhs.size(), rhsLeft = itr < rhs.data() + rhs.size();
+		if (lhsLeft != rhsLeft) return lhsLeft ? 1 : -1;
 
 		if (lhs.size() > rhs.size()) {
 			return 1;
@@ -334,6 +339,51 @@ int collateCompare(std::string_view lhs, std::string_view rhs, const CollateOpts
 	return res ? res : ((l1 < l2) ? -1 : (l1 > l2) ? 1 : 0);
 }
 
+// Characters of the sort key are stored as 3 bytes in the big-endian order. Code point or priority is incremented, so the zero
+// terminator of the characters is less, than any of them
+static void putSortKeyChar(std::string &key, uint32_t ch) {
+	++ch;
+	key.push_back(char(ch >> 16));
+	key.push_back(char(ch >> 8));
+	key.push_back(char(ch));
+}
+
+static void putSortKeyLength(std::string &key, size_t len) {
+	key.append(3, '\0');
+	for (int shift = 24; shift >= 0; shift -= 8) key.push_back(char(len >> shift));
+}
+
+bool collateSortKey(std::string_view str, const CollateOpts &collateOpts, std::string &key) {
+	key.clear();
+	switch (collateOpts.mode) {
+		case CollateASCII:
+			// Characters are compared as the signed values by collateCompare, so they are shifted to the unsigned ones
+			key.reserve(str.size());
+			for (char ch : str) key.push_back(char(tolower(ch) + 128));
+			return true;
+		case CollateUTF8: {
+			key.reserve(str.size() * 3 + 7);
+			for (auto it = str.data(), end = str.data() + str.size(); it < end;) putSortKeyChar(key, ToLower(utf8::unchecked::next(it)));
+			putSortKeyLength(key, str.size());
+			return true;
+		}
+		case CollateCustom: {
+			key.reserve(str.size() * 4 + 7);
+			for (auto it = str.data(), end = str.data() + str.size(); it < end;) {
+				putSortKeyChar(key, collateOpts.sortOrderTable.GetPriority(utf8::unchecked::next(it)));
+			}
+			putSortKeyLength(key, str.size());
+			// Strings with the same priorities are compared by their bytes
+			key.append(str);
+			return true;
+		}
+		case CollateNone:
+		case CollateNumeric:
+		default:
+			return false;
+	}
+}
+
 static std::string_view urldecode2(char *buf, std::string_view str) {
 	char a, b;
 	const char *src = str.data();
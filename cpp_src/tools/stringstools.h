@@ -68,6 +68,10 @@ protected:
 };
 
 int collateCompare(std::string_view lhs, std::string_view rhs, const CollateOpts& collateOpts);
+/// Builds the key, which is compared by bytes (see std::string::compare) the same way, as the source string is compared by collateCompare.
+/// Key is computed once per string, so the comparisons of the ordered index don't decode UTF-8 and don't look up the collation tables
+/// @return false, if the mode has no such key (CollateNone and CollateNumeric)
+bool collateSortKey(std::string_view str, const CollateOpts& collateOpts, std::string& key);
 
 wstring utf8_to_utf16(std::string_view src);
 string utf16_to_utf8(const wstring& src);
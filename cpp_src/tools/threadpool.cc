@@ -0,0 +1,180 @@
+#include "threadpool.h"
+#include "core/rdxcontext.h"
+
+namespace reindexer {
+
+struct ThreadPool::GroupState {
+	GroupState(size_t _maxPoolWorkers, Priority _priority, std::function<bool()> &&_isCanceled)
+		: maxPoolWorkers(_maxPoolWorkers), priority(_priority), isCanceled(std::move(_isCanceled)) {}
+
+	// Executes the first task of the queue. Lock is released during the execution
+	void runOne(std::unique_lock<std::mutex> &lck) {
+		TaskGroup::Task task = std::move(tasks.front());
+		tasks.pop_front();
+		++running;
+		lck.unlock();
+		bool canceled = false;
+		std::exception_ptr err;
+		if (isCanceled && isCanceled()) {
+			canceled = true;
+		} else {
+			try {
+				task();
+			} catch (...) {
+				err = std::current_exception();
+			}
+		}
+		task = nullptr;
+		lck.lock();
+		if (canceled || err) {
+			stop = true;
+			tasks.clear();
+			if (err && !error) error = std::move(err);
+		}
+		if (!--running && tasks.empty()) cv.notify_all();
+	}
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<TaskGroup::Task> tasks;
+	const size_t maxPoolWorkers;
+	// Count of the pool's threads, which serve the group or are scheduled to do it
+	size_t poolWorkers = 0;
+	size_t running = 0;
+	bool stop = false;
+	std::exception_ptr error;
+	const Priority priority;
+	const std::function<bool()> isCanceled;
+};
+
+ThreadPool &ThreadPool::Instance() {
+	static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+	return pool;
+}
+
+ThreadPool::ThreadPool(size_t threads) : threadsCount_(threads) {
+	for (auto &s : lanesSizes_) s.store(0, std::memory_order_relaxed);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		terminate_ = true;
+	}
+	cv_.notify_all();
+	for (auto &th : threads_) th.join();
+}
+
+void ThreadPool::schedule(std::shared_ptr<GroupState> group, Priority priority) {
+	// Threads are started lazily, so the process may be forked (daemonized) before the first usage of the pool
+	std::call_once(startFlag_, [this] {
+		threads_.reserve(threadsCount_);
+		for (size_t i = 0; i < threadsCount_; ++i) threads_.emplace_back([this] { work(); });
+	});
+	const auto lane = size_t(priority);
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		lanes_[lane].emplace_back(std::move(group));
+		lanesSizes_[lane].fetch_add(1, std::memory_order_relaxed);
+	}
+	cv_.notify_one();
+}
+
+bool ThreadPool::hasHigherPriority(Priority priority) const noexcept {
+	for (size_t lane = 0; lane < size_t(priority); ++lane) {
+		if (lanesSizes_[lane].load(std::memory_order_relaxed)) return true;
+	}
+	return false;
+}
+
+void ThreadPool::work() {
+	for (;;) {
+		std::shared_ptr<GroupState> group;
+		{
+			std::unique_lock<std::mutex> lck(mtx_);
+			size_t lane = 0;
+			cv_.wait(lck, [this, &lane] {
+				if (terminate_) return true;
+				for (lane = 0; lane < kLanesCount; ++lane) {
+					if (!lanes_[lane].empty()) return true;
+				}
+				return false;
+			});
+			if (terminate_) return;
+			group = std::move(lanes_[lane].front());
+			lanes_[lane].pop_front();
+			lanesSizes_[lane].fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		std::unique_lock<std::mutex> lck(group->mtx);
+		bool rescheduled = false;
+		while (!group->stop && !group->tasks.empty()) {
+			if (hasHigherPriority(group->priority)) {
+				// Leave the group to serve more important one. The group keeps its slot for the pool's thread
+				lck.unlock();
+				schedule(group, group->priority);
+				rescheduled = true;
+				break;
+			}
+			group->runOne(lck);
+		}
+		if (!rescheduled) --group->poolWorkers;
+	}
+}
+
+TaskGroup::TaskGroup(size_t maxConcurrency, ThreadPool::Priority priority, std::function<bool()> isCanceled)
+	: pool_(ThreadPool::Instance()), priority_(priority) {
+	const size_t maxPoolWorkers = maxConcurrency ? std::min(maxConcurrency - 1, pool_.Threads()) : pool_.Threads();
+	state_ = std::make_shared<ThreadPool::GroupState>(maxPoolWorkers, priority, std::move(isCanceled));
+}
+
+TaskGroup::~TaskGroup() {
+	std::unique_lock<std::mutex> lck(state_->mtx);
+	state_->tasks.clear();
+	state_->cv.wait(lck, [this] { return !state_->running; });
+}
+
+void TaskGroup::Add(Task &&task) {
+	bool needWorker = false;
+	{
+		std::lock_guard<std::mutex> lck(state_->mtx);
+		state_->tasks.emplace_back(std::move(task));
+		if (state_->poolWorkers < state_->maxPoolWorkers && state_->poolWorkers < state_->tasks.size()) {
+			++state_->poolWorkers;
+			needWorker = true;
+		}
+	}
+	if (needWorker) pool_.schedule(state_, priority_);
+}
+
+void TaskGroup::Wait() {
+	std::unique_lock<std::mutex> lck(state_->mtx);
+	for (;;) {
+		if (!state_->stop && !state_->tasks.empty()) {
+			state_->runOne(lck);
+		} else if (state_->running) {
+			state_->cv.wait(lck);
+		} else {
+			break;
+		}
+	}
+	state_->stop = false;
+	if (state_->error) {
+		auto err = std::move(state_->error);
+		state_->error = nullptr;
+		std::rethrow_exception(err);
+	}
+}
+
+void TaskGroup::Cancel() {
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	state_->stop = true;
+	state_->tasks.clear();
+}
+
+std::function<bool()> TaskGroup::CancelChecker(const RdxContext &ctx) {
+	if (!ctx.isCancelable()) return nullptr;
+	return [&ctx] { return ctx.checkCancel() != CancelType::None; };
+}
+
+}  // namespace reindexer
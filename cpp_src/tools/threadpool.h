@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reindexer {
+
+class RdxContext;
+class TaskGroup;
+
+/// Process-wide pool of threads for the parallel parts of the core operations (indexes optimization, fulltext build, etc).
+/// Threads are started on the first use. The pool does not own the tasks: it only lends its threads to the task groups, which have queued
+/// tasks. Idle thread steals the next task from the group of the highest priority lane, so the total count of the threads, used by the
+/// concurrent operations, never exceeds the size of the pool (plus the waiting threads of the groups)
+class ThreadPool {
+public:
+	enum class Priority { High = 0, Normal, Low };
+
+	static ThreadPool &Instance();
+	size_t Threads() const noexcept { return threadsCount_; }
+
+	~ThreadPool();
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+private:
+	friend class TaskGroup;
+	struct GroupState;
+	static constexpr size_t kLanesCount = 3;
+
+	explicit ThreadPool(size_t threads);
+	void schedule(std::shared_ptr<GroupState> group, Priority priority);
+	bool hasHigherPriority(Priority priority) const noexcept;
+	void work();
+
+	const size_t threadsCount_;
+	std::mutex mtx_;
+	std::condition_variable cv_;
+	std::array<std::deque<std::shared_ptr<GroupState>>, kLanesCount> lanes_;
+	std::array<std::atomic<size_t>, kLanesCount> lanesSizes_;
+	std::vector<std::thread> threads_;
+	std::once_flag startFlag_;
+	bool terminate_ = false;
+};
+
+/// Set of independent tasks of the single operation, executed by the threads of the shared pool and by the thread, which waits
+/// for the group.
+/// Tasks may be executed as soon as they are added
+class TaskGroup {
+public:
+	using Task = std::function<void()>;
+
+	/// @param maxConcurrency - max count of threads (including the waiting one), which execute tasks of the group simultaneously.
+	/// 0 means the size of the pool plus one
+	/// @param priority - lane of the pool, which is used for the group's tasks
+	/// @param isCanceled - checked before each task. Remaining tasks are skipped, if it returns true. Must be thread safe
+	explicit TaskGroup(size_t maxConcurrency = 0, ThreadPool::Priority priority = ThreadPool::Priority::Normal,
+					   std::function<bool()> isCanceled = nullptr);
+	/// Not executed tasks are skipped, running ones are awaited
+	~TaskGroup();
+	TaskGroup(const TaskGroup &) = delete;
+	TaskGroup &operator=(const TaskGroup &) = delete;
+
+	void Add(Task &&task);
+	/// Executes the group's tasks by the calling thread along with the pool's threads and waits for all of them to complete.
+	/// Rethrows the first exception, thrown by the tasks. Group may be reused after this call
+	void Wait();
+	/// Skips all the not started tasks
+	void Cancel();
+
+	/// Creates checker, which ties the group to the cancellation of the operation's context. Context must outlive the group
+	static std::function<bool()> CancelChecker(const RdxContext &ctx);
+
+private:
+	std::shared_ptr<ThreadPool::GroupState> state_;
+	ThreadPool &pool_;
+	const ThreadPool::Priority priority_;
+};
+
+}  // namespace reindexer
@@ -262,6 +262,44 @@ static inline unsigned scan_varint(unsigned len, const uint8_t *data) {
 	return i + 1;
 }
 
+/**
+ * Parse up to `count` consecutive base-128 varints. Runs of the single byte
+ * varints, which are the most of the tags, lengths and small numbers, are
+ * detected by one 64-bit load and are decoded without the per byte scan (SWAR
+ * variant of the masked VByte decoding).
+ *
+ * \param len
+ *      Length of `data`.
+ * \param data
+ *      Packed values.
+ * \param[out] out
+ *      Parsed values.
+ * \param count
+ *      Number of values to parse.
+ * \return
+ *      Number of bytes consumed or 0, if `data` ends before the last value.
+ */
+static inline size_t parse_uint64_batch(size_t len, const uint8_t *data, uint64_t *out, size_t count) {
+	size_t pos = 0, i = 0;
+	while (i < count) {
+		if (count - i >= 8 && len - pos >= 8) {
+			uint64_t word;
+			memcpy(&word, data + pos, 8);
+			if ((word & 0x8080808080808080ULL) == 0) {
+				for (unsigned j = 0; j < 8; j++) out[i + j] = data[pos + j];
+				i += 8;
+				pos += 8;
+				continue;
+			}
+		}
+		unsigned l = scan_varint(len - pos > 10 ? 10 : (unsigned)(len - pos), data + pos);
+		if (l == 0) return 0;
+		out[i++] = parse_uint64(l, data + pos);
+		pos += l;
+	}
+	return pos;
+}
+
 #ifndef _MSC_VER
 #pragma GCC diagnostic pop
 #else
@@ -0,0 +1,20 @@
+#include "workstealingscheduler.h"
+#include "tools/assertrx.h"
+
+namespace reindexer {
+
+WorkStealingScheduler::WorkStealingScheduler(size_t workers, ThreadPool::Priority priority) : workers_(workers), priority_(priority) {
+	assertrx(workers);
+}
+
+void WorkStealingScheduler::Add(Task &&task) { tasks_.emplace_back(std::move(task)); }
+
+void WorkStealingScheduler::Run(const std::function<bool()> &isCanceled) {
+	auto tasks = std::move(tasks_);
+	tasks_.clear();
+	TaskGroup group(workers_, priority_, isCanceled);
+	for (auto &task : tasks) group.Add(std::move(task));
+	group.Wait();
+}
+
+}  // namespace reindexer
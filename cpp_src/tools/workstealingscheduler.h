@@ -0,0 +1,33 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "tools/threadpool.h"
+
+namespace reindexer {
+
+/// Executes set of independent tasks by the limited count of threads of the shared ThreadPool.
+/// Tasks are taken from the common queue of the group by the calling thread and by the idle pool's threads, so one large set of tasks
+/// does not keep other threads idle and concurrent operations do not oversubscribe CPUs
+class WorkStealingScheduler {
+public:
+	using Task = std::function<void()>;
+
+	/// @param workers - max count of threads (including the calling one)
+	/// @param priority - lane of the pool, used for the tasks
+	explicit WorkStealingScheduler(size_t workers, ThreadPool::Priority priority = ThreadPool::Priority::Normal);
+
+	void Add(Task &&task);
+	/// Executes all the added tasks and waits for their completion. Calling thread is used as one of the workers
+	/// @param isCanceled - checked before each task. Remaining tasks are skipped, if it returns true
+	/// Rethrows the first exception, thrown by the tasks
+	void Run(const std::function<bool()> &isCanceled);
+	size_t TasksCount() const noexcept { return tasks_.size(); }
+
+private:
+	const size_t workers_;
+	const ThreadPool::Priority priority_;
+	std::vector<Task> tasks_;
+};
+
+}  // namespace reindexer
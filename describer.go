@@ -12,6 +12,9 @@ const (
 	PerfstatsNamespaceName        = "#perfstats"
 	QueriesperfstatsNamespaceName = "#queriesperfstats"
 	ClientsStatsNamespaceName     = "#clientsstats"
+	ReplicationStatsNamespaceName = "#replicationstats"
+	QueryTracesNamespaceName      = "#querytraces"
+	SlowQueriesNamespaceName      = "#slowqueries"
 )
 
 // Map from cond name to index type
@@ -29,6 +32,7 @@ var queryTypes = map[string]int{
 	"MATCH":   EQ,
 	"LIKE":    LIKE,
 	"DWITHIN": DWITHIN,
+	"KNN":     KNN,
 }
 
 func GetCondType(name string) (int, error) {
@@ -53,6 +57,7 @@ var queryNames = map[int]string{
 	EMPTY:   "EMPTY",
 	LIKE:    "LIKE",
 	DWITHIN: "DWITHIN",
+	KNN:     "KNN",
 }
 
 type IndexDescription struct {
@@ -79,6 +84,24 @@ type CacheMemStat struct {
 	EmptyCount int64 `json:"empty_count"`
 	// Number of hits of queries, to store results in cache
 	HitCountLimit int64 `json:"hit_count_limit"`
+	// Count of the lookups, which returned the cached results. Filled only for the query results cache
+	HitsCount int64 `json:"hits_count,omitempty"`
+	// Count of the lookups, which did not find the actual results in cache. Filled only for the query results cache
+	MissesCount int64 `json:"misses_count,omitempty"`
+	// Per-shard stats. Filled only for the caches, splitted into several shards
+	Shards []CacheShardMemStat `json:"shards,omitempty"`
+}
+
+// CacheShardMemStat information about memory consumption of the single cache shard
+type CacheShardMemStat struct {
+	// Memory consumption by this shard
+	TotalSize int64 `json:"total_size"`
+	// Count of elements stored in this shard
+	ItemsCount int64 `json:"items_count"`
+	// Number of hits of queries, to store results in this shard
+	HitCountLimit int64 `json:"hit_count_limit"`
+	// Count of elements evicted from this shard
+	EvictionsCount int64 `json:"evictions_count"`
 }
 
 //Operation counter and server id
@@ -129,6 +152,17 @@ type NamespaceMemStat struct {
 		// Total memory consumption of namespace's caches. e.g. idset and join caches
 		CacheSize int64 `json:"cache_size"`
 	} `json:"total"`
+	// Memory of namespace, measured by the allocator. Present only if memory accounting is enabled. Caches are not included
+	Allocator *struct {
+		// Total memory allocated by namespace
+		TotalSize int64 `json:"total_size"`
+		// Memory allocated for stored documents and other namespace structures
+		DataSize int64 `json:"data_size"`
+		// Memory allocated for namespace's indexes, except fulltext
+		IndexesSize int64 `json:"indexes_size"`
+		// Memory allocated for namespace's fulltext indexes
+		FulltextSize int64 `json:"fulltext_size"`
+	} `json:"allocator,omitempty"`
 	// Replication status of namespace
 	Replication struct {
 		// Last Log Sequence Number (LSN) of applied namespace modification
@@ -194,6 +228,8 @@ type NamespaceMemStat struct {
 	JoinCache CacheMemStat `json:"join_cache"`
 	// Query cache stats. Stores results of SELECT COUNT(*) by Where conditions
 	QueryCache CacheMemStat `json:"query_cache"`
+	// Query results cache stats. Stores full results of SELECT queries (see NamespaceConfig.QueryResultsCacheSize)
+	QueryResultsCache CacheMemStat `json:"query_results_cache"`
 }
 
 // PerfStat is information about different reinexer's objects performance statistics
@@ -214,6 +250,14 @@ type PerfStat struct {
 	MinLatencyUs int64 `json:"min_latency_us"`
 	// Maximum latency value
 	MaxLatencyUs int64 `json:"max_latency_us"`
+	// Median of latency values since the last stats reset
+	LatencyP50Us int64 `json:"latency_p50_us"`
+	// 90th percentile of latency values since the last stats reset
+	LatencyP90Us int64 `json:"latency_p90_us"`
+	// 99th percentile of latency values since the last stats reset
+	LatencyP99Us int64 `json:"latency_p99_us"`
+	// 99.9th percentile of latency values since the last stats reset
+	LatencyP999Us int64 `json:"latency_p999_us"`
 	// Standard deviation of latency values
 	LatencyStddev int64 `json:"latency_stddev"`
 }
@@ -314,6 +358,56 @@ type ClientConnectionStat struct {
 	} `json:"updates_filter"`
 	// Updates lost call count
 	UpdatesLost int `json:"updates_lost"`
+	// Ratio of compressed to raw size of the sent messages. 1.0 if compression is disabled
+	CompressionRatio float64 `json:"compression_ratio"`
+	// Resources, consumed by the client (all the connections with the same user and application name). Set, if the accounting is enabled
+	Resources *struct {
+		// CPU time of the operations' executing threads (us)
+		CPUTimeUs int64 `json:"cpu_time_us"`
+		// Rows, examined by the selects
+		RowsExamined int64 `json:"rows_examined"`
+		// Estimated memory of the query results, which are kept by the server until they are fetched or closed
+		ResultsBytes int64 `json:"results_bytes"`
+		// Count of the accounted operations
+		Ops int64 `json:"ops"`
+		// Count of the operations, canceled by the single operation quotas
+		CanceledOps int64 `json:"canceled_ops"`
+		// Count of the operations, rejected by the CPU time per second or results memory quotas
+		RejectedOps int64 `json:"rejected_ops"`
+	} `json:"resources,omitempty"`
+}
+
+// NamespaceReplicationStat is live replication statistics of the slave's namespace
+// and located in '#replicationstats' system namespace
+type NamespaceReplicationStat struct {
+	// Name of namespace
+	Name string `json:"name"`
+	// Last LSN of the master, which was received by the slave
+	MasterLSN LsnT `json:"master_lsn"`
+	// Last LSN of the master, which was applied by the slave
+	AppliedLSN LsnT `json:"applied_lsn"`
+	// Count of the received master's records, which are not applied yet
+	LSNLag int64 `json:"lsn_lag"`
+	// Online updates, which are buffered while the namespace is syncing
+	PendedUpdates int64 `json:"pended_updates"`
+	// Online updates, which are waiting in the queue of the updates applier
+	QueuedUpdates int64 `json:"queued_updates"`
+	// Total count of the applied WAL records
+	AppliedRecords int64 `json:"applied_records"`
+	// Count of the WAL records, applied during the last second
+	AppliedRecordsRate int64 `json:"applied_records_rate"`
+	// Total count of the received WAL records
+	RecvRecords int64 `json:"recv_records"`
+	// Total size of the received WAL records data
+	RecvBytes int64 `json:"recv_bytes"`
+	// Current recv rate (bytes/s)
+	RecvRate int64 `json:"recv_rate"`
+	// Count of the applied transactions
+	TxCount int64 `json:"tx_count"`
+	// Total time of the transactions apply
+	TxApplyTimeUs int64 `json:"tx_apply_time_us"`
+	// Average time of the transaction apply
+	TxAvgApplyTimeUs int64 `json:"tx_avg_apply_time_us"`
 }
 
 // QueryPerfStat is information about query's performance statistics
@@ -329,6 +423,7 @@ type DBConfigItem struct {
 	Profiling   *DBProfilingConfig    `json:"profiling,omitempty"`
 	Namespaces  *[]DBNamespacesConfig `json:"namespaces,omitempty"`
 	Replication *DBReplicationConfig  `json:"replication,omitempty"`
+	Maintenance *DBMaintenanceConfig  `json:"maintenance,omitempty"`
 }
 
 // DBProfilingConfig is part of reindexer configuration contains profiling options
@@ -341,6 +436,25 @@ type DBProfilingConfig struct {
 	PerfStats bool `json:"perfstats"`
 	// Enables record queries perofrmance statistics
 	QueriesPerfStats bool `json:"queriesperfstats"`
+	// Part of the SELECT queries, which execution stages are traced into #querytraces namespace (from 0 to 1)
+	QueryTracesSampleRate float64 `json:"query_traces_sample_rate"`
+	// Minimum SELECT query execution time to be logged with its plans and explain into #slowqueries namespace. 0 means 'disabled'
+	SlowQueriesThresholdUS int `json:"slow_queries_threshold_us"`
+}
+
+// DBMaintenanceConfig is part of reindexer configuration contains options of the namespaces background maintenance
+type DBMaintenanceConfig struct {
+	// Count of the workers, which execute indexes optimization, TTL expiration, snapshots, etc. Tasks of one namespace are never executed concurrently
+	Workers int `json:"workers"`
+	// Count of the running foreground operations, since which indexes optimization and snapshots are deferred. 0 means 'never defer'
+	DeferLoadThreshold int `json:"defer_load_threshold"`
+	// Max time, for which the background task may be deferred
+	MaxDeferralMs int `json:"max_deferral_ms"`
+	// Count of the most frequent selects from #queriesperfstats, which are stored into the warm state file of the database and replayed after the restart
+	// before the database reports, that it is warmed up. 0 means 'warm state is disabled'
+	WarmupQueries int `json:"warmup_queries"`
+	// Period of the warm state file update. The file is also updated on shutdown
+	WarmStatePeriodSec int `json:"warm_state_period_sec"`
 }
 
 // DBNamespacesConfig is part of reindexer configuration contains namespaces options
@@ -361,6 +475,9 @@ type DBNamespacesConfig struct {
 	CopyPolicyMultiplier int `json:"copy_policy_multiplier"`
 	// Force namespace copying for transaction with steps count greater than this value
 	TxSizeToAlwaysCopy int `json:"tx_size_to_always_copy"`
+	// Disables namespace copying for transaction, if there were no selects from the namespace during this timeout in seconds
+	// Such transaction is committed under the namespace's write lock. 0 - namespace copying does not depend on selects (default)
+	TxCopySelectIdleThreshold int `json:"tx_copy_select_idle_threshold"`
 	// Timeout before background indexes optimization start after last update. 0 - disable optimizations
 	OptimizationTimeout int `json:"optimization_timeout_ms"`
 	// Maximum number of background threads of sort indexes optimization. 0 - disable sort optimizations
@@ -378,6 +495,64 @@ type DBNamespacesConfig struct {
 	// Enables synchronous storage flush inside write-calls, if async updates count is more than SyncStorageFlushLimit
 	// 0 - disables synchronous storage flush (default). In this case storage will be flushed in background thread only
 	SyncStorageFlushLimit int `json:"sync_storage_flush_limit"`
+	// Enables synchronous storage flush inside write-calls, if size of the async updates in bytes is more than SyncStorageFlushBytesLimit
+	// 0 - disables size based synchronous storage flush (default)
+	SyncStorageFlushBytesLimit int64 `json:"sync_storage_flush_bytes_limit"`
+	// Enables durable mode of the storage: each storage flush is synced to disk and transaction commit returns after the flush of its updates
+	StorageDurableCommit bool `json:"storage_durable_commit"`
+	// Enables group commit of the background storage flush: async updates are accumulated into the larger storage batches and
+	// are flushed, when the oldest of them is older than StorageGroupCommitDeadlineMs (or when their count reaches StorageGroupCommitSize)
+	// 0 - disables group commit (default). In this case updates are flushed on each cycle of the background thread
+	StorageGroupCommitDeadlineMs int `json:"storage_group_commit_deadline_ms"`
+	// Count of the accumulated async updates, which triggers background storage flush before the deadline
+	// 0 - updates are flushed by deadline only (default)
+	StorageGroupCommitSize int `json:"storage_group_commit_size"`
+	// Enables snappy compression of the items in storage. Affects only the items written after the change
+	StorageCompression bool `json:"storage_compression"`
+	// Memory budget in bytes for the tuples (non-indexed fields) of the items. Tuples of the least recently read items
+	// are evicted to the storage, when budget is exceeded. 0 - disables tiered mode (default)
+	TieredTuplesMemoryBudget int64 `json:"tiered_tuples_memory_budget"`
+	// Maximum number of threads for the parallel execution of the single query, which requires full scan of non-indexed fields
+	// 0 - disables parallel execution (default)
+	ParallelScanWorkers int `json:"parallel_scan_workers"`
+	// Minimum count of the scanned items to execute query in parallel
+	ParallelScanThreshold int64 `json:"parallel_scan_threshold"`
+	// Maximum number of threads, which build the modified items of the update query, setting the non-indexed fields by the constant values,
+	// and decode the items of the transaction on commit. 0 - items are built by the single thread (default)
+	ParallelUpdateWorkers int `json:"parallel_update_workers"`
+	// Maximum number of threads, which execute the merged queries and the preselects of the joined queries of the select to this namespace
+	// concurrently. 0 - sub-queries are executed one after another (default)
+	SubqueriesWorkers int `json:"subqueries_workers"`
+	// Minimum period (in seconds) between writes of the items snapshot, which is used to speed up namespace loading from storage
+	// 0 - disables items snapshots (default)
+	ItemsSnapshotPeriod int `json:"items_snapshot_period_sec"`
+	// Maximum total size in bytes of the WAL records, which are aged out of the in-memory WAL and are kept in the storage
+	// for the lagging slaves. 0 - disables WAL spilling (default)
+	WALSpillBytesLimit int64 `json:"wal_spill_bytes_limit"`
+	// Maximum age (in seconds) of the WAL records, spilled to the storage. 0 - records are not expired by age (default)
+	WALSpillTTL int64 `json:"wal_spill_ttl_sec"`
+	// Maximum count of the expired items, which are deleted under the single hold of the namespace write lock
+	// 0 - all expired items are deleted at once (default)
+	TTLExpirationChunkSize int `json:"ttl_expiration_chunk_size"`
+	// Maximum count of the expired items, which are deleted per second. 0 - rate is not limited (default)
+	TTLExpirationRateLimit int `json:"ttl_expiration_rate_limit"`
+	// Maximum count of the items, which are deleted by the delete query under the single hold of the namespace write lock
+	// 0 - all the items of the query are deleted at once (default)
+	DeleteChunkSize int `json:"delete_chunk_size"`
+	// Names of the indexes (dense or array, not composite), which values are counted on each modification of the namespace.
+	// Facet, sum, avg, min and max aggregations over the whole namespace by these indexes are answered without scan
+	MaterializedAggregations []string `json:"materialized_aggregations,omitempty"`
+	// Enables the inverted index of the values of all non-indexed fields, which is used by EQ, SET and range conditions on them
+	PathsIndex bool `json:"paths_index"`
+	// Maximum size (in bytes) of the cache of the full results of the selects from the namespace (including joined and merged items
+	// and aggregations). Cached results are dropped on any modification of the namespaces of the query. 0 - cache is disabled (default)
+	QueryResultsCacheSize int64 `json:"query_results_cache_size"`
+	// Percent of the free rows of the namespace, which triggers the background compaction of the items into the dense range of ids.
+	// Compaction rebuilds all the indexes of the namespace under the write lock. 0 - compaction is disabled (default)
+	ItemsCompactionFreePercent int `json:"items_compaction_free_percent"`
+	// Maximum count of the items, which are cached for the lookups by the primary key. Cached items are read without the lock
+	// of the namespace, so the lookups of the hot keys are not blocked by the writers. 0 - cache is disabled (default)
+	PointReadsCacheSize int64 `json:"point_reads_cache_size"`
 }
 
 // DBReplicationConfig is part of reindexer configuration contains replication options
@@ -392,6 +567,10 @@ type DBReplicationConfig struct {
 	ForceSyncOnLogicError bool `json:"force_sync_on_logic_error"`
 	// force resync on wrong data hash conditions
 	ForceSyncOnWrongDataHash bool `json:"force_sync_on_wrong_data_hash"`
+	// Count of threads, which apply online updates of the different namespaces concurrently. 0 - updates are applied serially
+	OnlineUpdatesApplyThreads int `json:"online_updates_apply_threads"`
+	// Count of threads, which decode items of the large replicated transactions before the commit. 0 - items are decoded serially
+	TxDecodeThreads int `json:"tx_decode_threads"`
 	// List of namespaces for replication. If emply, all namespaces. All replicated namespaces will become read only for slave
 	Namespaces []string `json:"namespaces"`
 }
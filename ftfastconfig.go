@@ -62,10 +62,15 @@ type FtFastConfig struct {
 	MaxTypos int `json:"max_typos"`
 	// Maximum word length for building and matching variants with typos. Default value is 15
 	MaxTypoLen int `json:"max_typo_len"`
+	// Store typos as sorted array of their hashes instead of hash map. Takes several times less memory, but slows down typos lookup
+	CompactTypos bool `json:"compact_typos,omitempty"`
 	// Maximum commit steps - set it 1 for always full rebuild - it can be from 1 to 500
 	MaxRebuildSteps int `json:"max_rebuild_steps"`
 	// Maximum words in one commit - it can be from 5 to DOUBLE_MAX
 	MaxStepSize int `json:"max_step_size"`
+	// Keep cached search results on the incremental index update, if the updated documents can not affect them.
+	// Ranks of the kept results are not recalculated after the update
+	IncrementalCacheInvalidation bool `json:"incremental_cache_invalidation,omitempty"`
 	// Maximum documents which will be processed in merge query results
 	// Default value is 20000. Increasing this value may refine ranking
 	// of queries with high frequency words
@@ -95,6 +100,13 @@ type FtFastConfig struct {
 	ExtraWordSymbols string `json:"extra_word_symbols"`
 	// Ratio of summation of ranks of match one term in several fields
 	SumRanksByFieldsRatio float64 `json:"sum_ranks_by_fields_ratio"`
+	// Count of threads for the single query's terms variants processing and merge - it can be from 0 to 64
+	// 0 or 1 - query is processed by the single thread
+	SelectWorkers int `json:"select_workers"`
+	// Minimal count of the term's variants to lookup them in several threads
+	ParallelVariantsThreshold int `json:"parallel_variants_threshold,omitempty"`
+	// Minimal count of the matched documents ids of the term to merge them in several threads
+	ParallelMergeThreshold int `json:"parallel_merge_threshold,omitempty"`
 	// Configuration for certain field
 	FieldsCfg []FtFastFieldConfig `json:"fields,omitempty"`
 	// Optimize the index by memory or by cpu
@@ -103,29 +115,32 @@ type FtFastConfig struct {
 
 func DefaultFtFastConfig() FtFastConfig {
 	return FtFastConfig{
-		Bm25Boost:             1.0,
-		Bm25Weight:            0.1,
-		DistanceBoost:         1.0,
-		DistanceWeight:        0.5,
-		TermLenBoost:          1.0,
-		TermLenWeight:         0.3,
-		PositionBoost:         1.0,
-		PositionWeight:        0.1,
-		FullMatchBoost:        1.1,
-		PartialMatchDecrease:  15,
-		MinRelevancy:          0.05,
-		MaxTypos:              2,
-		MaxTypoLen:            15,
-		MaxRebuildSteps:       50,
-		MaxStepSize:           4000,
-		MergeLimit:            20000,
-		Stemmers:              []string{"en", "ru"},
-		EnableTranslit:        true,
-		EnableKbLayout:        true,
-		LogLevel:              0,
-		ExtraWordSymbols:      "/-+",
-		SumRanksByFieldsRatio: 0.0,
-		Optimization:          "Memory",
+		Bm25Boost:                 1.0,
+		Bm25Weight:                0.1,
+		DistanceBoost:             1.0,
+		DistanceWeight:            0.5,
+		TermLenBoost:              1.0,
+		TermLenWeight:             0.3,
+		PositionBoost:             1.0,
+		PositionWeight:            0.1,
+		FullMatchBoost:            1.1,
+		PartialMatchDecrease:      15,
+		MinRelevancy:              0.05,
+		MaxTypos:                  2,
+		MaxTypoLen:                15,
+		MaxRebuildSteps:           50,
+		MaxStepSize:               4000,
+		MergeLimit:                20000,
+		Stemmers:                  []string{"en", "ru"},
+		EnableTranslit:            true,
+		EnableKbLayout:            true,
+		LogLevel:                  0,
+		ExtraWordSymbols:          "/-+",
+		SumRanksByFieldsRatio:     0.0,
+		SelectWorkers:             0,
+		ParallelVariantsThreshold: 32,
+		ParallelMergeThreshold:    100000,
+		Optimization:              "Memory",
 	}
 }
 
@@ -29,6 +29,12 @@ type FtFuzzyConfig struct {
 	//terminator SpaceSize=2 __t _te ter   ... tor or_ r__
 	//terminator SpaceSize=1 _te  ter  ... tor or_
 	SpaceSize int `json:"space_size"`
+	// Count of threads for the index build - it can be from 0 to 64
+	// 0 or 1 - index is built by the single thread
+	BuildWorkers int `json:"build_workers"`
+	// Count of threads for the single query's results merge - it can be from 0 to 64
+	// 0 or 1 - query is processed by the single thread
+	SelectWorkers int `json:"select_workers"`
 	// Maximum documents which will be processed in merge query results
 	// Default value is 20000. Increasing this value may refine ranking
 	// of queries with high frequency words
@@ -60,6 +66,8 @@ func DefaultFtFuzzyConfig() FtFuzzyConfig {
 		MinOkProc:            10,
 		BufferSize:           4,
 		SpaceSize:            1,
+		BuildWorkers:         0,
+		SelectWorkers:        0,
 		MergeLimit:           20000,
 		Stemmers:             []string{"en", "ru"},
 		EnableTranslit:       true,
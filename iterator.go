@@ -23,6 +23,8 @@ type ExplainSelector struct {
 	Cost float64 `json:"cost"`
 	// Count of processed documents, matched this selector
 	Matched int `json:"matched"`
+	// Expected count of documents, matched this selector (estimated by the index keys statistics, if selector uses comparators)
+	Estimated int `json:"estimated"`
 	// Count of scanned documents by this selector
 	Items int `json:"items"`
 	// Preselect in joined namespace execution explainings
@@ -140,11 +142,14 @@ type Iterator struct {
 	}
 	err     error
 	userCtx context.Context
+	// Joined items of the current page, which may be referred by the following ones (see ResultsJoinedRefs)
+	joinedRefs []rawResultItemParams
 }
 
 func (it *Iterator) setBuffer(result bindings.RawBuffer) {
 	it.ser = newSerializer(result.GetBuf())
 	it.result = result
+	it.joinedRefs = it.joinedRefs[:0]
 	it.rawQueryParams = it.ser.readRawQueryParams(func(nsid int) {
 		it.nsArray[nsid].localCjsonState = it.nsArray[nsid].cjsonState.ReadPayloadType(&it.ser.Serializer)
 	})
@@ -222,7 +227,15 @@ func (it *Iterator) readItem(toObj interface{}) (item interface{}, rank int) {
 		}
 		subitems := make([]interface{}, siRes)
 		for i := 0; i < siRes; i++ {
-			subparams := it.ser.readRawtItemParams()
+			var subparams rawResultItemParams
+			if (it.rawQueryParams.flags & bindings.ResultsJoinedRefs) == 0 {
+				subparams = it.ser.readRawtItemParams()
+			} else if ref := int(it.ser.GetVarUInt()); ref != 0 {
+				subparams = it.joinedRefs[ref-1]
+			} else {
+				subparams = it.ser.readRawtItemParams()
+				it.joinedRefs = append(it.joinedRefs, subparams)
+			}
 			subitems[i], it.err = unpackItem(&it.nsArray[nsIndex+nsIndexOffset], &subparams, it.allowUnsafe, (it.rawQueryParams.flags&bindings.ResultsWithItemID) == 0, toObj)
 			if it.err != nil {
 				return
@@ -439,6 +452,11 @@ func (it *Iterator) GetExplainResults() (*ExplainResults, error) {
 	return nil, nil
 }
 
+// IsIncomplete returns true, if the deadline of the best-effort query was exceeded and only the part of the results is returned
+func (it *Iterator) IsIncomplete() bool {
+	return it.rawQueryParams.incomplete
+}
+
 // Error returns query error if it's present.
 func (it *Iterator) Error() error {
 	return it.err
@@ -8,8 +8,10 @@ import (
 	"os"
 	"reflect"
 	"runtime"
+	"strconv"
 	"strings"
 	"sync"
+	"time"
 	"unsafe"
 
 	"github.com/restream/reindexer/bindings"
@@ -26,6 +28,15 @@ const (
 	QueryStrictModeIndexes                 = bindings.QueryStrictModeIndexes // Allows only indexes in conditions. Otherwise query will return error
 )
 
+// Parallel scan modes for queries
+type QueryParallelScanMode int
+
+const (
+	queryParallelScanNotSet QueryParallelScanMode = bindings.QueryParallelScanNotSet
+	QueryParallelScanOff                          = bindings.QueryParallelScanOff // Always executes full scan in the single thread
+	QueryParallelScanOn                           = bindings.QueryParallelScanOn  // Allows parallel full scan regardless of the namespace's parallel_scan_threshold
+)
+
 // Constants for query serialization
 const (
 	queryCondition              = bindings.QueryCondition
@@ -55,6 +66,9 @@ const (
 	queryUpdateFieldV2          = bindings.QueryUpdateFieldV2
 	queryBetweenFieldsCondition = bindings.QueryBetweenFieldsCondition
 	queryAlwaysFalseCondition   = bindings.QueryAlwaysFalseCondition
+	queryParallelScan           = bindings.QueryParallelScan
+	queryWaitLSN                = bindings.QueryWaitLSN
+	queryBestEffort             = bindings.QueryBestEffort
 )
 
 // Constants for calc total
@@ -491,6 +505,23 @@ func (q *Query) DWithin(index string, point [2]float64, distance float64) *Query
 	return q
 }
 
+// Knn - Add condition, which selects k items with the nearest vectors of the hnsw index (approximately).
+// Other conditions of the query are applied to these items. ef is the size of the candidates list of the search (0 - default size)
+func (q *Query) Knn(index string, vector []float32, k int, ef int) *Query {
+
+	q.ser.PutVarCUInt(queryCondition).PutVString(index).PutVarCUInt(q.nextOp).PutVarCUInt(KNN)
+	q.nextOp = opAND
+	q.queriesCount++
+
+	q.ser.PutVarCUInt(len(vector) + 2)
+	q.ser.PutVarCUInt(valueInt64).PutVarInt(int64(k))
+	q.ser.PutVarCUInt(valueInt64).PutVarInt(int64(ef))
+	for _, v := range vector {
+		q.ser.PutVarCUInt(valueDouble).PutDouble(float64(v))
+	}
+	return q
+}
+
 func (q *Query) AggregateSum(field string) {
 	q.ser.PutVarCUInt(queryAggregation).PutVarCUInt(AggSum).PutVarCUInt(1).PutVString(field)
 }
@@ -507,6 +538,17 @@ func (q *Query) AggregateMax(field string) {
 	q.ser.PutVarCUInt(queryAggregation).PutVarCUInt(AggMax).PutVarCUInt(1).PutVString(field)
 }
 
+// AggregateApproxCountDistinct - approximate count of distinct values of the field (HyperLogLog, relative error is about 1%)
+func (q *Query) AggregateApproxCountDistinct(field string) {
+	q.ser.PutVarCUInt(queryAggregation).PutVarCUInt(AggApproxCountDistinct).PutVarCUInt(1).PutVString(field)
+}
+
+// AggregateQuantile - approximate quantile of the field values (t-digest). quantile should be in [0, 1], e.g. 0.95 for p95
+func (q *Query) AggregateQuantile(field string, quantile float64) {
+	q.ser.PutVarCUInt(queryAggregation).PutVarCUInt(AggQuantile).PutVarCUInt(2).PutVString(field)
+	q.ser.PutVString(strconv.FormatFloat(quantile, 'g', -1, 64))
+}
+
 type AggregateFacetRequest struct {
 	query *Query
 }
@@ -636,6 +678,29 @@ func (q *Query) Strict(mode QueryStrictMode) *Query {
 	return q
 }
 
+// ParallelScan - Set query parallel scan mode. Parallel scan also requires non-zero parallel_scan_workers in the namespace config
+func (q *Query) ParallelScan(mode QueryParallelScanMode) *Query {
+	q.ser.PutVarCUInt(queryParallelScan).PutVarCUInt(int(mode))
+	return q
+}
+
+// WaitLSN - Make slave wait until master's LSN (e.g. LSN of the item, modified on master) is applied before the query execution.
+// Query fails with timeout error, if LSN was not applied during the timeout. Ignored by the non-slave namespaces
+func (q *Query) WaitLSN(lsn int64, timeout time.Duration) *Query {
+	q.ser.PutVarCUInt(queryWaitLSN)
+	q.ser.PutVarInt(lsn)
+	q.ser.PutVarCUInt(int(timeout / time.Millisecond))
+	return q
+}
+
+// BestEffort - Return partial results instead of the timeout error, if query's deadline is exceeded during the namespace scan.
+// Such results are marked as incomplete (see Iterator.IsIncomplete)
+func (q *Query) BestEffort() *Query {
+	q.ser.PutVarCUInt(queryBestEffort)
+	q.ser.PutVarCUInt(1)
+	return q
+}
+
 // Explain - Request explain for query
 func (q *Query) Explain() *Query {
 	q.ser.PutVarCUInt(queryExplain)
@@ -29,12 +29,18 @@ var collateModes = map[string]int{
 }
 
 type indexOptions struct {
-	isArray     bool
-	isAppenable bool
-	isDense     bool
-	isPk        bool
-	isSparse    bool
-	rtreeType   string
+	isArray       bool
+	isAppenable   bool
+	isDense       bool
+	isPk          bool
+	isSparse      bool
+	isColumnar    bool
+	isFlatHash    bool
+	isLearned     bool
+	isBloomFilter bool
+	isTrigram     bool
+	rtreeType     string
+	hnswConfig    map[string]interface{}
 }
 
 func parseRxTags(field reflect.StructField) (idxName string, idxType string, expireAfter string, idxSettings []string) {
@@ -134,6 +140,13 @@ func parseIndexesImpl(indexDefs *[]bindings.IndexDef, st reflect.Type, subArray
 				return fmt.Errorf("'rtree' index allowed only for [2]float64 field type")
 			}
 		}
+		if idxType == "hnsw" {
+			if (t.Kind() != reflect.Slice && t.Kind() != reflect.Array) || (t.Elem().Kind() != reflect.Float32 && t.Elem().Kind() != reflect.Float64) {
+				return fmt.Errorf("'hnsw' index allowed only for float32 and float64 slice or array field types")
+			}
+		} else if opts.hnswConfig != nil {
+			return fmt.Errorf("Hnsw index settings are found on '%s' index %s", idxType, idxName)
+		}
 		if parseByKeyWord(&idxSettings, "composite") {
 			if t.Kind() != reflect.Struct || t.NumField() != 0 {
 				return fmt.Errorf("'composite' tag allowed only on empty on structs: Invalid tags %v on field %s", strings.SplitN(st.Field(i).Tag.Get("reindex"), ",", 3), st.Field(i).Name)
@@ -223,12 +236,39 @@ func parseOpts(idxSettingsBuf *[]string) indexOptions {
 			opts.isDense = true
 		case "sparse":
 			opts.isSparse = true
+		case "columnar":
+			opts.isColumnar = true
+		case "flat_hash":
+			opts.isFlatHash = true
+		case "learned":
+			opts.isLearned = true
+		case "bloom_filter":
+			opts.isBloomFilter = true
+		case "trigram":
+			opts.isTrigram = true
 		case "appendable":
 			opts.isAppenable = true
 		case "linear", "quadratic", "greene", "rstar":
 			opts.rtreeType = idxSetting
 		default:
-			newIdxSettingsBuf = append(newIdxSettingsBuf, idxSetting)
+			// k-v settings of hnsw index config
+			kvIdxSettings := strings.SplitN(idxSetting, "=", 2)
+			if len(kvIdxSettings) != 2 {
+				newIdxSettingsBuf = append(newIdxSettingsBuf, idxSetting)
+				continue
+			}
+			switch kvIdxSettings[0] {
+			case "dimension", "m", "ef_construction":
+				value, err := strconv.Atoi(kvIdxSettings[1])
+				if err != nil {
+					panic(fmt.Errorf("Hnsw index setting '%s' should be an integer value", kvIdxSettings[0]))
+				}
+				opts.setHnswConfig(kvIdxSettings[0], value)
+			case "metric":
+				opts.setHnswConfig(kvIdxSettings[0], kvIdxSettings[1])
+			default:
+				newIdxSettingsBuf = append(newIdxSettingsBuf, idxSetting)
+			}
 		}
 	}
 
@@ -237,6 +277,13 @@ func parseOpts(idxSettingsBuf *[]string) indexOptions {
 	return opts
 }
 
+func (opts *indexOptions) setHnswConfig(key string, value interface{}) {
+	if opts.hnswConfig == nil {
+		opts.hnswConfig = make(map[string]interface{})
+	}
+	opts.hnswConfig[key] = value
+}
+
 func parseCompositeName(indexName string) string {
 	indexConents := strings.Split(indexName, "=")
 	if len(indexConents) > 1 {
@@ -371,18 +418,24 @@ func makeIndexDef(index string, jsonPaths []string, indexType, fieldType string,
 	}
 
 	return bindings.IndexDef{
-		Name:        index,
-		JSONPaths:   jsonPaths,
-		IndexType:   indexType,
-		FieldType:   fieldType,
-		IsArray:     opts.isArray,
-		IsPK:        opts.isPk,
-		IsDense:     opts.isDense,
-		IsSparse:    opts.isSparse,
-		CollateMode: cm,
-		SortOrder:   sortOrder,
-		ExpireAfter: expireAfter,
-		RTreeType:   opts.rtreeType,
+		Name:          index,
+		JSONPaths:     jsonPaths,
+		IndexType:     indexType,
+		FieldType:     fieldType,
+		IsArray:       opts.isArray,
+		IsPK:          opts.isPk,
+		IsDense:       opts.isDense,
+		IsSparse:      opts.isSparse,
+		IsColumnar:    opts.isColumnar,
+		IsFlatHash:    opts.isFlatHash,
+		IsLearned:     opts.isLearned,
+		IsBloomFilter: opts.isBloomFilter,
+		IsTrigram:     opts.isTrigram,
+		CollateMode:   cm,
+		SortOrder:     sortOrder,
+		ExpireAfter:   expireAfter,
+		RTreeType:     opts.rtreeType,
+		Config:        opts.hnswConfig,
 	}
 }
 
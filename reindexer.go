@@ -35,6 +35,8 @@ const (
 	LIKE = bindings.LIKE
 	// Geometry DWithin
 	DWITHIN = bindings.DWITHIN
+	// Approximate nearest neighbors of the vector by hnsw index
+	KNN = bindings.KNN
 )
 
 const (
@@ -50,12 +52,14 @@ const (
 
 // Aggregation funcs
 const (
-	AggAvg      = bindings.AggAvg
-	AggSum      = bindings.AggSum
-	AggFacet    = bindings.AggFacet
-	AggMin      = bindings.AggMin
-	AggMax      = bindings.AggMax
-	AggDistinct = bindings.AggDistinct
+	AggAvg                 = bindings.AggAvg
+	AggSum                 = bindings.AggSum
+	AggFacet               = bindings.AggFacet
+	AggMin                 = bindings.AggMin
+	AggMax                 = bindings.AggMax
+	AggDistinct            = bindings.AggDistinct
+	AggApproxCountDistinct = bindings.AggApproxCountDistinct
+	AggQuantile            = bindings.AggQuantile
 )
 
 // Reindexer error codes
@@ -288,6 +292,13 @@ func (db *Reindexer) Upsert(namespace string, item interface{}, precepts ...stri
 	return db.impl.upsert(db.ctx, namespace, item, precepts...)
 }
 
+// UpsertBatch (Insert or Update) items to index by the single call of the binding under the single namespace lock
+// Items must be the same type as item passed to OpenNamespace, or []byte with json. All of the items have to be of the same kind
+// Returns the status of each item. The whole batch is applied, even if some of the items can not be modified
+func (db *Reindexer) UpsertBatch(namespace string, items []interface{}) ([]error, error) {
+	return db.impl.upsertBatch(db.ctx, namespace, items)
+}
+
 // Insert item to namespace by PK
 // Item must be the same type as item passed to OpenNamespace, or []byte with json data
 // Return 0, if no item was inserted, 1 if item was inserted
@@ -6,6 +6,7 @@ import (
 	"log"
 	"net/url"
 	"reflect"
+	"strconv"
 	"strings"
 	"sync"
 
@@ -366,6 +367,12 @@ func (db *reindexerImpl) upsert(ctx context.Context, namespace string, item inte
 	return err
 }
 
+// upsertBatch items to namespace by the single binding call
+// Returns the status of each item
+func (db *reindexerImpl) upsertBatch(ctx context.Context, namespace string, items []interface{}) ([]error, error) {
+	return db.modifyItemsBatch(ctx, namespace, items, modeUpsert)
+}
+
 // insert item to namespace by PK
 // Item must be the same type as item passed to OpenNamespace, or []byte with json data
 // Return 0, if no item was inserted, 1 if item was inserted
@@ -590,6 +597,17 @@ func (db *reindexerImpl) queryFrom(d dsl.DSL) (*Query, error) {
 			q.AggregateMax(agg.Fields[0])
 		case AggDistinct:
 			q.Distinct(agg.Fields[0])
+		case AggApproxCountDistinct:
+			q.AggregateApproxCountDistinct(agg.Fields[0])
+		case AggQuantile:
+			if len(agg.Fields) != 2 {
+				return nil, ErrAggInvalid
+			}
+			quantile, err := strconv.ParseFloat(agg.Fields[1], 64)
+			if err != nil {
+				return nil, ErrAggInvalid
+			}
+			q.AggregateQuantile(agg.Fields[0], quantile)
 		default:
 			return nil, ErrAggInvalid
 		}
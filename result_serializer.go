@@ -2,6 +2,7 @@ package reindexer
 
 import (
 	"fmt"
+	"unsafe"
 
 	"github.com/restream/reindexer/bindings"
 	"github.com/restream/reindexer/cjson"
@@ -29,11 +30,26 @@ type rawResultQueryParams struct {
 	count          int
 	aggResults     [][]byte
 	explainResults []byte
+	incomplete     bool
 }
 
+// itemView - layout of reindexer_item_view (see cpp_src/core/cbinding/reindexer_ctypes.h)
+type itemView struct {
+	cptr uint64
+	lsn  int64
+	id   int32
+	nsid uint16
+	proc uint16
+}
+
+// Must be the same as kItemViewsAlignment in cpp_src/core/cbinding/resultserializer.cc
+const itemViewsAlignment = 8
+
 type resultSerializer struct {
 	cjson.Serializer
 	flags int
+	// Items of ResultsItemViews format. Views point to the results buffer of builtin binding
+	views []itemView
 }
 
 type updatePayloadTypeFunc func(nsid int)
@@ -44,6 +60,22 @@ func newSerializer(buf []byte) resultSerializer {
 	}
 }
 func (s *resultSerializer) readRawtItemParams() (v rawResultItemParams) {
+	if len(s.views) != 0 {
+		view := &s.views[0]
+		s.views = s.views[1:]
+		if (s.flags & bindings.ResultsWithItemID) != 0 {
+			v.id = int(view.id)
+			v.version = int(view.lsn)
+		}
+		if (s.flags & bindings.ResultsWithNsID) != 0 {
+			v.nsid = int(view.nsid)
+		}
+		if (s.flags & bindings.ResultsWithPercents) != 0 {
+			v.proc = int(view.proc)
+		}
+		v.cptr = uintptr(view.cptr)
+		return v
+	}
 
 	if (s.flags & bindings.ResultsWithItemID) != 0 {
 		v.id = int(s.GetVarUInt())
@@ -89,6 +121,10 @@ func (s *resultSerializer) readRawQueryParams(updatePayloadType ...updatePayload
 	}
 	s.readExtraResults(&v)
 	s.flags = v.flags
+	if (v.flags&bindings.ResultsFormatMask) == bindings.ResultsItemViews && v.count > 0 {
+		views := s.GetAlignedBytes(itemViewsAlignment, v.count*int(unsafe.Sizeof(itemView{})))
+		s.views = (*[1 << 26]itemView)(unsafe.Pointer(&views[0]))[:v.count:v.count]
+	}
 
 	return v
 }
@@ -106,6 +142,8 @@ func (s *resultSerializer) readExtraResults(v *rawResultQueryParams) {
 		switch tag {
 		case bindings.QueryResultExplain:
 			v.explainResults = data
+		case bindings.QueryResultIncomplete:
+			v.incomplete = true
 		case bindings.QueryResultAggregation:
 			v.aggResults = append(v.aggResults, data)
 		}